@@ -14,8 +14,12 @@ SHAPE_ORDERING = ['obj',
                   'cylinder',
                   'disk',
                   'rectangle',
+                  'bsplinecurve',
+                  'pointcloud',
+                  'displaced',
                   'shapegroup',
-                  'instance']
+                  'instance',
+                  'instancer']
 
 BSDF_ORDERING = ['diffuse',
                  'dielectric',
@@ -63,10 +67,18 @@ SAMPLER_ORDERING = ['independent',
                     'stratified',
                     'multijitter',
                     'orthogonal',
-                    'ldsampler']
+                    'ldsampler',
+                    'sobol',
+                    'halton',
+                    'bluenoise',
+                    'counter']
 
 INTEGRATOR_ORDERING = ['direct',
                        'path',
+                       'guided_path',
+                       'radiance_cache',
+                       'bdpt',
+                       'sppm',
                        'aov']
 
 FILM_ORDERING = ['hdrfilm']
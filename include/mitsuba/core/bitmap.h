@@ -2,8 +2,10 @@
 
 #include <mitsuba/core/struct.h>
 #include <mitsuba/core/vector.h>
+#include <mitsuba/core/mmap.h>
 #include <mitsuba/core/properties.h>
 #include <mitsuba/core/rfilter.h>
+#include <functional>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -150,6 +152,20 @@ public:
          */
         BMP,
 
+        /**
+         * \brief Mitsuba tensor file format (see \ref TensorFile)
+         *
+         * The following is supported:
+         * <ul>
+         *   <li>Loading of a field named \c data (or of the only field) with
+         *   shape <tt>[height, width]</tt> or <tt>[height, width, channels]</tt>
+         *   and any component format</li>
+         *   <li>Saving of all bitmaps (as a field named \c data)</li>
+         *   <li>Memory-mapped loading without copies, see \ref memory_mapped()</li>
+         * </ul>
+         */
+        Tensor,
+
         /// Unknown file format
         Unknown,
 
@@ -162,7 +178,35 @@ public:
         Auto
     };
 
+    /// Compression methods for writing OpenEXR files
+    enum class EXRCompression : uint32_t {
+        /**
+         * \brief Lossless PIZ compression, or lossy DWAB compression when a
+         * positive quality level is given (default)
+         */
+        Default,
+
+        /// No compression
+        None,
+
+        /// Run-length encoding (lossless, fast but weak)
+        RLE,
+
+        /// Zlib compression of individual scanlines (lossless)
+        ZIPS,
+
+        /// Zlib compression of blocks of 16 scanlines (lossless)
+        ZIP,
 
+        /// Wavelet compression (lossless, good for noisy images)
+        PIZ,
+
+        /// Lossy DCT-based compression of blocks of 32 scanlines
+        DWAA,
+
+        /// Lossy DCT-based compression of blocks of 256 scanlines
+        DWAB
+    };
 
     /// Type of alpha transformation
     enum class AlphaTransform : uint32_t {
@@ -257,6 +301,17 @@ public:
     /// Return a pointer to the underlying data (const)
     const uint8_t *uint8_data() const { return m_data.get(); }
 
+    /**
+     * \brief Does the bitmap reference the memory-mapped contents of the
+     * file it was loaded from?
+     *
+     * Uncompressed PPM and tensor files loaded via \ref Bitmap(const
+     * fs::path &, FileFormat) are mapped with copy-on-write semantics
+     * instead of being read into memory, which lets processes loading the
+     * same file share its pages.
+     */
+    bool memory_mapped() const { return m_mmap.get() != nullptr; }
+
     /// Return the bitmap dimensions in pixels
     const Vector2u &size() const { return m_size; }
 
@@ -342,9 +397,16 @@ public:
      *            The default argument (-1) causes the implementation to switch
      *            to the lossless PIZ compressor.</li>
      *    </ul>
+     *
+     * \param compression
+     *    Compression method of OpenEXR images. When set to \ref
+     *    EXRCompression::DWAA or \ref EXRCompression::DWAB, \c quality
+     *    specifies the compression level (45 when not specified). Ignored by the
+     *    other file formats.
      */
     void write(Stream *stream, FileFormat format = FileFormat::Auto,
-               int quality = -1) const;
+               int quality = -1,
+               EXRCompression compression = EXRCompression::Default) const;
 
     /**
      * Write an encoded form of the bitmap to a file using the specified file format
@@ -372,13 +434,45 @@ public:
      *            The default argument (-1) causes the implementation to switch
      *            to the lossless PIZ compressor.</li>
      *    </ul>
+     *
+     * \param compression
+     *    Compression method of OpenEXR images. When set to \ref
+     *    EXRCompression::DWAA or \ref EXRCompression::DWAB, \c quality
+     *    specifies the compression level (45 when not specified). Ignored by the
+     *    other file formats.
      */
     void write(const fs::path &path, FileFormat format = FileFormat::Auto,
-               int quality = -1) const;
+               int quality = -1,
+               EXRCompression compression = EXRCompression::Default) const;
 
     /// Equivalent to \ref write(), but executes asynchronously on a different thread
     void write_async(const fs::path &path, FileFormat format = FileFormat::Auto,
-                     int quality = -1) const;
+                     int quality = -1,
+                     EXRCompression compression = EXRCompression::Default) const;
+
+    /// Callback that stores \c rows scanlines starting at scanline \c y, see \ref write_openexr_blocks()
+    using ScanlineCallback = std::function<void(uint32_t y, uint32_t rows)>;
+
+    /**
+     * \brief Write an OpenEXR file incrementally, one block of scanlines at a time
+     *
+     * This bitmap serves as the buffer of a single block of scanlines: it
+     * specifies the width, channels and metadata of the file, and its height
+     * determines the number of scanlines per block. For every block, \c fill
+     * is invoked with the index of the block's first scanline and its number
+     * of scanlines (less than the bitmap's height for the last block), and
+     * must store them at the beginning of this bitmap. Hence, images can be
+     * written without ever holding all of their scanlines in memory.
+     *
+     * \param height
+     *    Total number of scanlines of the file
+     *
+     * \param quality
+     *    Quality level of the DWAA and DWAB compressors, see \ref write()
+     */
+    void write_openexr_blocks(const fs::path &path, uint32_t height,
+                              const ScanlineCallback &fill, int quality = -1,
+                              EXRCompression compression = EXRCompression::Default);
 
     /**
      * \brief Up- or down-sample this image to a different resolution
@@ -573,6 +667,9 @@ public:
     /// Return a human-readable summary of this bitmap
     virtual std::string to_string() const override;
 
+    /// Account the pixel storage as texture memory
+    virtual void account_memory(MemoryReport *report) const override;
+
     /// Static initialization of bitmap-related data structures (thread pools, etc.)
     static void static_initialization();
 
@@ -593,8 +690,18 @@ public:
      /// Read a file encoded using the OpenEXR file format
      void read_openexr(Stream *stream);
 
-     /// Write a file using the OpenEXR file format
-     void write_openexr(Stream *stream, int compression = -1) const;
+     /**
+      * \brief Write a file using the OpenEXR file format
+      *
+      * When \c stream is \c nullptr, OpenEXR writes directly to the file at
+      * \c path, which avoids the indirection through \ref Stream. When \c
+      * fill is specified, the file has \c height scanlines that are produced
+      * in blocks (see \ref write_openexr_blocks()).
+      */
+     void write_openexr(Stream *stream, int quality = -1,
+                        EXRCompression compression = EXRCompression::Default,
+                        const fs::path &path = fs::path(), uint32_t height = 0,
+                        const ScanlineCallback &fill = ScanlineCallback()) const;
 
      /// Read a file encoded using the JPEG file format
      void read_jpeg(Stream *stream);
@@ -631,6 +738,20 @@ public:
 
      /// Save a file using the PFM file format
      void write_pfm(Stream *stream) const;
+
+     /// Read a file encoded using the tensor file format
+     void read_tensor(Stream *stream);
+
+     /// Save a file using the tensor file format
+     void write_tensor(Stream *stream) const;
+
+     /**
+      * \brief When loading from a memory-mapped file, reference the next \c
+      * size bytes of \c stream instead of reading them
+      *
+      * \return \c false if the data must be read (e.g. for other streams)
+      */
+     bool map_data(Stream *stream, size_t size);
  protected:
      std::unique_ptr<uint8_t[]> m_data;
      PixelFormat m_pixel_format;
@@ -641,6 +762,7 @@ public:
      bool m_premultiplied_alpha;
      bool m_owns_data;
      Properties m_metadata;
+     ref<MemoryMappedFile> m_mmap;
 };
 
 
@@ -718,5 +840,6 @@ void accumulate_2d(ConstT source,
 extern MTS_EXPORT_CORE std::ostream &operator<<(std::ostream &os, Bitmap::PixelFormat value);
 extern MTS_EXPORT_CORE std::ostream &operator<<(std::ostream &os, Bitmap::FileFormat value);
 extern MTS_EXPORT_CORE std::ostream &operator<<(std::ostream &os, Bitmap::AlphaTransform value);
+extern MTS_EXPORT_CORE std::ostream &operator<<(std::ostream &os, Bitmap::EXRCompression value);
 
 NAMESPACE_END(mitsuba)
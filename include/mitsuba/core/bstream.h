@@ -0,0 +1,145 @@
+#pragma once
+
+#include <mitsuba/core/stream.h>
+#include <memory>
+
+NAMESPACE_BEGIN(mitsuba)
+
+NAMESPACE_BEGIN(detail)
+/// Default read-ahead buffer size of \ref BufferedStream (1 MiB)
+constexpr size_t kBufferedStreamDefaultSize = 1024 * 1024;
+NAMESPACE_END(detail)
+
+/**
+ * \brief Read-ahead buffer around a nested stream
+ *
+ * Loaders often issue a large number of small \ref read() calls (headers,
+ * individual elements, single characters when parsing text). When the nested
+ * stream is backed by a file on a network file system, each of these can turn
+ * into a separate request. This class instead fetches large contiguous chunks
+ * from the nested stream and serves small reads directly from memory. Reads
+ * that are larger than the buffer bypass it entirely.
+ *
+ * Seeking only updates the logical position; already buffered data is reused
+ * when the new position falls inside of it. Writes are passed through to the
+ * nested stream and invalidate the buffer.
+ */
+class MTS_EXPORT_CORE BufferedStream : public Stream {
+public:
+    using Stream::read;
+    using Stream::write;
+
+    /** \brief Creates a new buffered stream with the given underlying stream.
+     * This new instance takes ownership of the child stream.
+     *
+     * \param buffer_size
+     *     Size of the read-ahead buffer in bytes
+     */
+    BufferedStream(Stream *child_stream,
+                   size_t buffer_size = detail::kBufferedStreamDefaultSize);
+
+    /// Returns a string representation
+    std::string to_string() const override;
+
+    /** \brief Closes the stream and the underlying child stream.
+     * No further read or write operations are permitted.
+     *
+     * This function is idempotent.
+     * It is called automatically by the destructor.
+     */
+    virtual void close() override;
+
+    /// Whether the stream is closed (no read or write are then permitted).
+    virtual bool is_closed() const override { return m_child_stream->is_closed(); }
+
+    /// Convenience function for reading a line of text from an ASCII file
+    virtual std::string read_line() override;
+
+    // =========================================================================
+    //! @{ \name Buffered stream-specific features
+    // =========================================================================
+
+    /// Returns the child stream of this buffered stream
+    const Stream *child_stream() const { return m_child_stream.get(); }
+
+    /// Returns the child stream of this buffered stream
+    Stream *child_stream() { return m_child_stream; }
+
+    /// Return the size of the read-ahead buffer in bytes
+    size_t buffer_size() const { return m_buffer_size; }
+
+    //! @}
+    // =========================================================================
+
+    // =========================================================================
+    //! @{ \name Implementation of the Stream interface
+    // =========================================================================
+
+    /**
+     * \brief Reads a specified amount of data from the stream, refilling the
+     * read-ahead buffer when necessary.
+     * Throws an exception when the stream ended prematurely.
+     */
+    virtual void read(void *p, size_t size) override;
+
+    /**
+     * \brief Writes a specified amount of data into the child stream at the
+     * current position. Invalidates the read-ahead buffer.
+     * Throws an exception when not all data could be written.
+     */
+    virtual void write(const void *p, size_t size) override;
+
+    /// Seeks to a position inside the stream. The child stream is only
+    /// repositioned by the next operation that needs to access it.
+    virtual void seek(size_t pos) override { m_pos = pos; }
+
+    /// Truncates the child stream. Invalidates the read-ahead buffer.
+    virtual void truncate(size_t size) override;
+
+    /// Gets the current position inside the stream
+    virtual size_t tell() const override { return m_pos; }
+
+    /// Returns the size of the child stream
+    virtual size_t size() const override { return m_child_stream->size(); }
+
+    /// Flushes the child stream
+    virtual void flush() override { m_child_stream->flush(); }
+
+    /// Can we write to the stream?
+    virtual bool can_write() const override {
+        return m_child_stream->can_write();
+    }
+
+    /// Can we read from the stream?
+    virtual bool can_read() const override {
+        return m_child_stream->can_read();
+    }
+
+    //! @}
+    // =========================================================================
+
+    MTS_DECLARE_CLASS()
+protected:
+    /// Protected destructor
+    virtual ~BufferedStream();
+
+private:
+    /// Refill the buffer starting at the current position, returns the number of bytes
+    size_t fill();
+
+    /// Move the child stream to the current position if necessary
+    void sync_child();
+
+private:
+    ref<Stream> m_child_stream;
+    std::unique_ptr<uint8_t[]> m_buffer;
+    size_t m_buffer_size;
+    /// Position of the first buffered byte within the child stream
+    size_t m_buffer_start;
+    /// Number of valid bytes in the buffer
+    size_t m_buffer_fill;
+    /// Current (logical) position
+    size_t m_pos;
+};
+
+NAMESPACE_END(mitsuba)
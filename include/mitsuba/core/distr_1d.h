@@ -6,6 +6,102 @@
 
 NAMESPACE_BEGIN(mitsuba)
 
+NAMESPACE_BEGIN(detail)
+
+/**
+ * \brief Build the alias table of a discrete distribution using Vose's method
+ *
+ * \param masses
+ *     Probability masses (up to a constant factor) of the \c size entries
+ *
+ * \param prob
+ *     Receives the probability of keeping each entry of the table
+ *
+ * \param alias
+ *     Receives the entry that is chosen instead of each entry otherwise
+ */
+template <typename FloatStorage, typename IndexStorage>
+void build_alias_table(const double *masses, size_t size, double sum,
+                       FloatStorage &prob, IndexStorage &alias) {
+    using ScalarFloat = scalar_t<FloatStorage>;
+
+    if (prob.size() != size)
+        prob = enoki::empty<FloatStorage>(size);
+    if (alias.size() != size)
+        alias = enoki::empty<IndexStorage>(size);
+
+    // Ensure that we can access these arrays on the CPU
+    prob.managed();
+    alias.managed();
+
+    ScalarFloat *prob_ptr = prob.data();
+    uint32_t *alias_ptr = alias.data();
+
+    std::vector<double> scaled(size);
+    std::vector<uint32_t> small, large;
+    uint32_t fallback = 0;
+    for (uint32_t i = 0; i < size; ++i) {
+        scaled[i] = masses[i] * (double) size / sum;
+        (scaled[i] < 1.0 ? small : large).push_back(i);
+        if (masses[i] > masses[fallback])
+            fallback = i;
+    }
+
+    while (!small.empty() && !large.empty()) {
+        uint32_t s = small.back(), l = large.back();
+        small.pop_back();
+
+        prob_ptr[s] = (ScalarFloat) scaled[s];
+        alias_ptr[s] = l;
+
+        scaled[l] -= 1.0 - scaled[s];
+        if (scaled[l] < 1.0) {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+
+    /* The remaining entries are kept with probability one, except for entries
+       without mass that are left over due to roundoff errors */
+    for (std::vector<uint32_t> *list : { &small, &large }) {
+        for (uint32_t i : *list) {
+            bool empty = masses[i] == 0.0;
+            prob_ptr[i] = empty ? 0.f : 1.f;
+            alias_ptr[i] = empty ? fallback : i;
+        }
+    }
+}
+
+/**
+ * \brief Sample an alias table built by \ref build_alias_table()
+ *
+ * \return
+ *     The sampled index and the re-scaled sample value, which is again
+ *     uniformly distributed on the interval [0, 1].
+ */
+template <typename Float, typename FloatStorage, typename IndexStorage,
+          typename Index = uint32_array_t<Float>>
+std::pair<Index, Float> sample_alias_table(const FloatStorage &prob,
+                                           const IndexStorage &alias,
+                                           Float value, mask_t<Float> active) {
+    uint32_t size = (uint32_t) prob.size();
+
+    value = clamp(value, 0.f, math::OneMinusEpsilon<Float>) * (scalar_t<Float>) size;
+    Index index = enoki::min(Index(value), size - 1u);
+    value -= Float(index);
+
+    Float p = gather<Float>(prob, index, active);
+    mask_t<Float> use_alias = value >= p && p < 1.f;
+
+    return {
+        select(use_alias, gather<Index>(alias, index, active), index),
+        min(select(use_alias, (value - p) / (1.f - p), value / p),
+            math::OneMinusEpsilon<Float>)
+    };
+}
+
+NAMESPACE_END(detail)
+
 /**
  * \brief Discrete 1D probability distribution
  *
@@ -15,10 +111,16 @@ NAMESPACE_BEGIN(mitsuba)
  * probability mass functions (PMFs) will automatically be normalized during
  * initialization. The associated scale factor can be retrieved using the
  * function \ref normalization().
+ *
+ * Samples are generated by inverting the CDF with a binary search by
+ * default. Large distributions can instead build an alias table (see \ref
+ * set_alias_table()), which samples in constant time at the cost of no
+ * longer being monotonic in the sample value.
  */
 template <typename Float> struct DiscreteDistribution {
     using FloatStorage = DynamicBuffer<Float>;
     using Index = uint32_array_t<Float>;
+    using IndexStorage = DynamicBuffer<Index>;
     using Mask = mask_t<Float>;
 
     using ScalarFloat = scalar_t<Float>;
@@ -85,8 +187,37 @@ public:
 
         m_sum = ScalarFloat(sum);
         m_normalization = ScalarFloat(1.0 / sum);
+
+        if (m_alias_table) {
+            std::vector<double> masses(size);
+            for (size_t i = 0; i < size; ++i)
+                masses[i] = (double) m_pmf.data()[i];
+            detail::build_alias_table(masses.data(), size, sum, m_alias_prob, m_alias_index);
+        }
     }
 
+    /**
+     * \brief Sample the distribution using an alias table?
+     *
+     * Building the table takes linear time, after which \ref sample() and
+     * related functions take constant time instead of performing a binary
+     * search over the CDF. The sampled index is no longer monotonic in the
+     * sample value, which loses some of the stratification of the input
+     * samples. The table is rebuilt by \ref update().
+     */
+    void set_alias_table(bool value) {
+        m_alias_table = value;
+        if (value && !m_pmf.empty()) {
+            update();
+        } else if (!value) {
+            m_alias_prob = FloatStorage();
+            m_alias_index = IndexStorage();
+        }
+    }
+
+    /// Does the distribution use an alias table? (see \ref set_alias_table())
+    bool has_alias_table() const { return m_alias_table; }
+
     /// Return the unnormalized probability mass function
     FloatStorage &pmf() { return m_pmf; }
 
@@ -144,6 +275,9 @@ public:
     Index sample(Float value, Mask active = true) const {
         MTS_MASK_ARGUMENT(active);
 
+        if (m_alias_table)
+            return detail::sample_alias_table(m_alias_prob, m_alias_index, value, active).first;
+
         value *= m_sum;
 
         return enoki::binary_search(
@@ -194,6 +328,9 @@ public:
     sample_reuse(Float value, Mask active = true) const {
         MTS_MASK_ARGUMENT(active);
 
+        if (m_alias_table)
+            return detail::sample_alias_table(m_alias_prob, m_alias_index, value, active);
+
         Index index = sample(value, active);
 
         Float pmf = eval_pmf_normalized(index, active),
@@ -223,6 +360,12 @@ public:
     sample_reuse_pmf(Float value, Mask active = true) const {
         MTS_MASK_ARGUMENT(active);
 
+        if (m_alias_table) {
+            auto [index, reused] =
+                detail::sample_alias_table(m_alias_prob, m_alias_index, value, active);
+            return { index, reused, eval_pmf_normalized(index, active) };
+        }
+
         auto [index, pdf] = sample_pmf(value, active);
 
         Float pmf = eval_pmf_normalized(index, active),
@@ -241,6 +384,10 @@ private:
     ScalarFloat m_sum = 0.f;
     ScalarFloat m_normalization = 0.f;
     ScalarVector2u m_valid;
+    /// Alias table (see \ref set_alias_table())
+    bool m_alias_table = false;
+    FloatStorage m_alias_prob;
+    IndexStorage m_alias_index;
 };
 
 /**
@@ -525,6 +672,7 @@ private:
 template <typename Float> struct IrregularContinuousDistribution {
     using FloatStorage = DynamicBuffer<Float>;
     using Index = uint32_array_t<Float>;
+    using IndexStorage = DynamicBuffer<Index>;
     using Mask = mask_t<Float>;
 
     using ScalarFloat = scalar_t<Float>;
@@ -619,8 +767,39 @@ public:
 
         m_integral = ScalarFloat(integral);
         m_normalization = ScalarFloat(1. / integral);
+
+        if (m_alias_table) {
+            // Alias table over the intervals, weighted by their integral
+            std::vector<double> masses(size - 1);
+            const ScalarFloat *nodes = m_nodes.data(), *pdf = m_pdf.data();
+            for (size_t i = 0; i < size - 1; ++i)
+                masses[i] = 0.5 * ((double) nodes[i + 1] - (double) nodes[i]) *
+                            ((double) pdf[i] + (double) pdf[i + 1]);
+            detail::build_alias_table(masses.data(), size - 1, integral,
+                                      m_alias_prob, m_alias_index);
+        }
     }
 
+    /**
+     * \brief Select the interval of a sample using an alias table?
+     *
+     * This replaces the binary search over the CDF of the intervals by a
+     * constant-time lookup, see \ref DiscreteDistribution::set_alias_table().
+     * The table is rebuilt by \ref update().
+     */
+    void set_alias_table(bool value) {
+        m_alias_table = value;
+        if (value && !m_pdf.empty()) {
+            update();
+        } else if (!value) {
+            m_alias_prob = FloatStorage();
+            m_alias_index = IndexStorage();
+        }
+    }
+
+    /// Does the distribution use an alias table? (see \ref set_alias_table())
+    bool has_alias_table() const { return m_alias_table; }
+
     /// Return the nodes of the underlying discretization
     FloatStorage &nodes() { return m_nodes; }
 
@@ -729,23 +908,15 @@ public:
     Float sample(Float value, Mask active = true) const {
         MTS_MASK_ARGUMENT(active);
 
-        value *= m_integral;
-
-        Index index = enoki::binary_search(
-            m_valid.x(), m_valid.y(),
-            [&](Index index) ENOKI_INLINE_LAMBDA {
-                return gather<Float>(m_cdf, index, active) < value;
-            }
-        );
+        Index index = sample_interval(value, active);
 
         Float x0 = gather<Float>(m_nodes, index,      active),
               x1 = gather<Float>(m_nodes, index + 1u, active),
               y0 = gather<Float>(m_pdf,   index,      active),
               y1 = gather<Float>(m_pdf,   index + 1u, active),
-              c0 = gather<Float>(m_cdf,   index - 1u, active && index > 0),
               w  = x1 - x0;
 
-        value = (value - c0) / w;
+        value /= w;
 
         Float t_linear = (y0 - safe_sqrt(sqr(y0) + 2.f * value * (y1 - y0))) / (y0 - y1),
               t_const  = value / y0,
@@ -770,23 +941,15 @@ public:
     std::pair<Float, Float> sample_pdf(Float value, Mask active = true) const {
         MTS_MASK_ARGUMENT(active);
 
-        value *= m_integral;
-
-        Index index = enoki::binary_search(
-            m_valid.x(), m_valid.y(),
-            [&](Index index) ENOKI_INLINE_LAMBDA {
-                return gather<Float>(m_cdf, index, active) < value;
-            }
-        );
+        Index index = sample_interval(value, active);
 
         Float x0 = gather<Float>(m_nodes, index,      active),
               x1 = gather<Float>(m_nodes, index + 1u, active),
               y0 = gather<Float>(m_pdf,   index,      active),
               y1 = gather<Float>(m_pdf,   index + 1u, active),
-              c0 = gather<Float>(m_cdf,   index - 1u, active && index > 0),
               w  = x1 - x0;
 
-        value = (value - c0) / w;
+        value /= w;
 
         Float t_linear = (y0 - safe_sqrt(sqr(y0) + 2.f * value * (y1 - y0))) / (y0 - y1),
               t_const  = value / y0,
@@ -796,6 +959,34 @@ public:
             fmadd(t, y1 - y0, y0) * m_normalization };
     }
 
+private:
+    /**
+     * \brief Select the interval containing a sample
+     *
+     * Replaces \c value by the unnormalized integral of the density from the
+     * start of the interval to the sampled position.
+     */
+    Index sample_interval(Float &value, Mask active) const {
+        Index index;
+        if (m_alias_table) {
+            std::tie(index, value) =
+                detail::sample_alias_table(m_alias_prob, m_alias_index, value, active);
+            Float c0 = gather<Float>(m_cdf, index - 1u, active && index > 0),
+                  c1 = gather<Float>(m_cdf, index, active);
+            value *= c1 - c0;
+        } else {
+            value *= m_integral;
+            index = enoki::binary_search(
+                m_valid.x(), m_valid.y(),
+                [&](Index index) ENOKI_INLINE_LAMBDA {
+                    return gather<Float>(m_cdf, index, active) < value;
+                }
+            );
+            value -= gather<Float>(m_cdf, index - 1u, active && index > 0);
+        }
+        return index;
+    }
+
 private:
     FloatStorage m_nodes;
     FloatStorage m_pdf;
@@ -804,6 +995,10 @@ private:
     ScalarFloat m_normalization = 0.f;
     ScalarVector2f m_range { 0.f, 0.f };
     ScalarVector2u m_valid;
+    /// Alias table over the intervals (see \ref set_alias_table())
+    bool m_alias_table = false;
+    FloatStorage m_alias_prob;
+    IndexStorage m_alias_index;
 };
 
 template <typename Float>
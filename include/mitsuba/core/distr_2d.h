@@ -2,9 +2,50 @@
 
 #include <mitsuba/core/warp.h>
 #include <mitsuba/core/util.h>
+#include <mitsuba/core/stream.h>
+#include <tbb/parallel_for.h>
 
 NAMESPACE_BEGIN(mitsuba)
 
+NAMESPACE_BEGIN(detail)
+/// Invoke \c func(y) for the rows <tt>[0, height)</tt> of an array in parallel
+template <typename Func> void parallel_rows(uint32_t width, uint32_t height, Func func) {
+    // Avoid scheduling overheads for small arrays/coarse levels
+    uint32_t grain_size = std::max(1u, 16384u / std::max(width, 1u));
+    tbb::parallel_for(
+        tbb::blocked_range<uint32_t>(0, height, grain_size),
+        [&](const tbb::blocked_range<uint32_t> &range) {
+            for (uint32_t y = range.begin(); y != range.end(); ++y)
+                func(y);
+        }
+    );
+}
+
+/// Compute <tt>out[i] = in[i] * scale</tt> in parallel (\c in may equal \c out)
+template <typename Value>
+void parallel_scale(const Value *in, Value *out, size_t count, Value scale) {
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, count, 16384),
+        [&](const tbb::blocked_range<size_t> &range) {
+            for (size_t i = range.begin(); i != range.end(); ++i)
+                out[i] = in[i] * scale;
+        }
+    );
+}
+
+/// Compute <tt>out[i] = Out(in[i] * scale)</tt> in parallel (e.g. to encode half precision data)
+template <typename In, typename Out>
+void parallel_convert(const In *in, Out *out, size_t count, In scale) {
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, count, 16384),
+        [&](const tbb::blocked_range<size_t> &range) {
+            for (size_t i = range.begin(); i != range.end(); ++i)
+                out[i] = Out(in[i] * scale);
+        }
+    );
+}
+NAMESPACE_END(detail)
+
 /** =======================================================================
  * @{ \name Data-driven warping techniques for two dimensions
  *
@@ -171,6 +212,11 @@ public:
         return { Point2u(col, row), (col_cdf_1 - col_cdf_0) * m_normalization, sample };
     }
 
+    /// Return the size of the tables (in bytes)
+    size_t memory_usage() const {
+        return (m_data.size() + m_marg_cdf.size() + m_cond_cdf.size()) * sizeof(ScalarFloat);
+    }
+
     std::string to_string() const {
         std::ostringstream oss;
         oss << "DiscreteDistribution2D" << "[" << std::endl
@@ -380,9 +426,6 @@ public:
         // The linear interpolant has 'size-1' patches
         ScalarVector2u n_patches = size - 1;
 
-        // Keep track of the dependence on additional parameters (optional)
-        uint32_t max_level = math::log2i_ceil(hmax(n_patches));
-
         m_max_patch_index = n_patches - 1;
 
         if (!enable_sampling) {
@@ -399,53 +442,51 @@ public:
                         sum += (double) data[offset + i];
                     scale = hprod(n_patches) / (ScalarFloat) sum;
                 }
-                for (uint32_t i = 0; i < m_levels[0].size; ++i)
-                    m_levels[0].data_ptr[offset + i] = data[offset + i] * scale;
+                detail::parallel_scale(data + offset, m_levels[0].data_ptr + offset,
+                                       m_levels[0].size, scale);
             }
 
             return;
         }
 
         // Allocate memory for input array and MIP hierarchy
-        m_levels.reserve(max_level + 2);
-        m_levels.emplace_back(size, m_slices);
+        allocate_levels(size);
 
-        ScalarVector2u level_size = n_patches;
-        for (int level = max_level; level >= 0; --level) {
-            level_size += level_size & 1u; // zero-pad
-            m_levels.emplace_back(level_size, m_slices);
-            level_size = sr<1>(level_size);
-        }
+        std::unique_ptr<double[]> row_sum(new double[n_patches.y()]);
 
         for (uint32_t slice = 0; slice < m_slices; ++slice) {
             uint32_t offset0 = m_levels[0].size * slice,
                      offset1 = m_levels[1].size * slice;
 
-            // Integrate linear interpolant
+            /* Integrate linear interpolant. Rows are processed in parallel,
+               their sums are accumulated in order to remain deterministic. */
             const ScalarFloat *in = data + offset0;
-
-            double sum = 0.0;
-            for (uint32_t y = 0; y < n_patches.y(); ++y) {
+            detail::parallel_rows(n_patches.x(), n_patches.y(), [&](uint32_t y) {
+                const ScalarFloat *row = in + y * size.x();
+                double sum = 0.0;
                 for (uint32_t x = 0; x < n_patches.x(); ++x) {
-                    ScalarFloat avg = (in[0] + in[1] + in[size.x()] +
-                                 in[size.x() + 1]) * .25f;
+                    ScalarFloat avg = (row[x] + row[x + 1] + row[x + size.x()] +
+                                       row[x + size.x() + 1]) * .25f;
                     sum += (double) avg;
                     *(m_levels[1].ptr(ScalarVector2u(x, y)) + offset1) = avg;
-                    ++in;
                 }
-                ++in;
-            }
+                row_sum[y] = sum;
+            });
+
+            double sum = 0.0;
+            for (uint32_t y = 0; y < n_patches.y(); ++y)
+                sum += row_sum[y];
 
             // Copy and normalize fine resolution interpolant
             ScalarFloat scale = normalize ? (ScalarFloat) (hprod(n_patches) / sum) : 1.f;
-            for (uint32_t i = 0; i < m_levels[0].size; ++i)
-                m_levels[0].data_ptr[offset0 + i] = data[offset0 + i] * scale;
-            for (uint32_t i = 0; i < m_levels[1].size; ++i)
-                m_levels[1].data_ptr[offset1 + i] *= scale;
+            detail::parallel_scale(data + offset0, m_levels[0].data_ptr + offset0,
+                                   m_levels[0].size, scale);
+            detail::parallel_scale(m_levels[1].data_ptr + offset1, m_levels[1].data_ptr + offset1,
+                                   m_levels[1].size, scale);
 
             // Build a MIP hierarchy
-            level_size = n_patches;
-            for (uint32_t level = 2; level <= max_level + 1; ++level) {
+            ScalarVector2u level_size = n_patches;
+            for (uint32_t level = 2; level < m_levels.size(); ++level) {
                 const Level &l0 = m_levels[level - 1];
                 Level &l1 = m_levels[level];
                 offset0 = l0.size * slice;
@@ -453,17 +494,58 @@ public:
                 level_size = sr<1>(level_size + 1u);
 
                 // Downsample
-                for (uint32_t y = 0; y < level_size.y(); ++y) {
+                detail::parallel_rows(level_size.x(), level_size.y(), [&](uint32_t y) {
                     for (uint32_t x = 0; x < level_size.x(); ++x) {
                         ScalarFloat *d1 = l1.ptr(ScalarVector2u(x, y)) + offset1;
                         const ScalarFloat *d0 = l0.ptr(ScalarVector2u(x*2, y*2)) + offset0;
                         *d1 = d0[0] + d0[1] + d0[2] + d0[3];
                     }
-                }
+                });
             }
         }
     }
 
+    /**
+     * \brief Load a hierarchy that was previously serialized via \ref write()
+     *
+     * \c size, \c param_res and \c param_values must match the arguments
+     * that were used to construct the original hierarchy.
+     */
+    Hierarchical2D(Stream *stream,
+                   const ScalarVector2u &size,
+                   const std::array<uint32_t, Dimension> &param_res = { },
+                   const std::array<const ScalarFloat *, Dimension> &param_values = { })
+        : Base(size, param_res, param_values) {
+        m_max_patch_index = size - 2u;
+        allocate_levels(size);
+
+        uint32_t level_count;
+        stream->read(level_count);
+        if (level_count != m_levels.size())
+            Throw("Hierarchical2D(): the serialized hierarchy has an incompatible "
+                  "number of levels!");
+
+        for (Level &level : m_levels) {
+            uint32_t level_size, level_width;
+            stream->read(level_size);
+            stream->read(level_width);
+            if (level_size != level.size || level_width != level.width)
+                Throw("Hierarchical2D(): the serialized hierarchy has an "
+                      "incompatible resolution!");
+            stream->read_array(level.data_ptr, (size_t) level.size * m_slices);
+        }
+    }
+
+    /// Serialize the hierarchy (e.g. to avoid rebuilding it for the same data)
+    void write(Stream *stream) const {
+        stream->write((uint32_t) m_levels.size());
+        for (const Level &level : m_levels) {
+            stream->write(level.size);
+            stream->write(level.width);
+            stream->write_array(level.data_ptr, (size_t) level.size * m_slices);
+        }
+    }
+
     /**
      * \brief Given a uniformly distributed 2D sample, draw a sample from the
      * distribution (parameterized by \c param if applicable)
@@ -681,13 +763,20 @@ public:
         return warp::square_to_bilinear_pdf(v00, v10, v01, v11, pos);
     }
 
+    /// Return the size of the MIP hierarchy (in bytes)
+    size_t memory_usage() const {
+        size_t size = 0;
+        for (size_t i = 0; i < m_levels.size(); ++i)
+            size += m_levels[i].size * m_slices;
+        return size * sizeof(ScalarFloat);
+    }
+
     std::string to_string() const {
         std::ostringstream oss;
         oss << "Hierarchical2D" << Dimension << "[" << std::endl
             << "  size = [" << m_levels[0].width << ", "
             << m_levels[0].size / m_levels[0].width << "]," << std::endl
             << "  levels = " << m_levels.size() << "," << std::endl;
-        size_t size = 0;
         if (Dimension > 0) {
             oss << "  param_size = [";
             for (size_t i = 0; i<Dimension; ++i) {
@@ -705,15 +794,28 @@ public:
             oss << "]," << std::endl;
         }
         oss << "  storage = { " << m_slices << " slice" << (m_slices > 1 ? "s" : "")
-            << ", ";
-        for (size_t i = 0; i < m_levels.size(); ++i)
-            size += m_levels[i].size * m_slices;
-        oss << util::mem_string(size * sizeof(ScalarFloat)) << " }" << std::endl
+            << ", " << util::mem_string(memory_usage()) << " }" << std::endl
             << "]";
         return oss.str();
     }
 
 protected:
+    /// Allocate the input array and the (zero-padded) MIP hierarchy
+    void allocate_levels(const ScalarVector2u &size) {
+        ScalarVector2u n_patches = size - 1;
+        uint32_t max_level = math::log2i_ceil(hmax(n_patches));
+
+        m_levels.reserve(max_level + 2);
+        m_levels.emplace_back(size, m_slices);
+
+        ScalarVector2u level_size = n_patches;
+        for (int level = max_level; level >= 0; --level) {
+            level_size += level_size & 1u; // zero-pad
+            m_levels.emplace_back(level_size, m_slices);
+            level_size = sr<1>(level_size);
+        }
+    }
+
     struct Level {
         uint32_t size;
         uint32_t width;
@@ -815,7 +917,8 @@ protected:
  * \c MarginalContinuous2D0 to \c MarginalContinuous2D3 for data that depends
  * on 0 to 3 parameters.
  */
-template <typename Float_, size_t Dimension_ = 0, bool Continuous = false>
+template <typename Float_, size_t Dimension_ = 0, bool Continuous = false,
+          typename Storage_ = scalar_t<Float_>>
 class Marginal2D : public Distribution2D<Float_, Dimension_> {
 public:
     using Base = Distribution2D<Float_, Dimension_>;
@@ -825,6 +928,14 @@ public:
         Point2u, ScalarVector2f, ScalarVector2u, FloatStorage
     )
 
+    /// Scalar type used to store the density values (e.g. \c enoki::half)
+    using Storage = Storage_;
+
+    /// Are the density values stored at reduced precision?
+    static constexpr bool CompactStorage = !std::is_same_v<Storage, ScalarFloat>;
+
+    using DataStorage = DynamicBuffer<replace_scalar_t<Float, Storage>>;
+
     ENOKI_USING_MEMBERS(Base,
         Dimension, DimensionInt, m_patch_size, m_inv_patch_size,
         m_param_strides, m_param_values, m_slices, interpolate_weights
@@ -848,6 +959,14 @@ public:
      * construct the cdf needed for sample warping, which saves memory in case
      * this functionality is not needed (e.g. if only the interpolation in
      * ``eval()`` is used).
+     *
+     * When the class is instantiated with a reduced-precision \c Storage type
+     * (e.g. <tt>enoki::half</tt>), the density values are rescaled by a
+     * common factor to make good use of its exponent range, and converted.
+     * This halves the memory footprint of large eval-only tables. The
+     * marginal and conditional CDFs would have to be stored at full
+     * precision to keep sampling consistent with \ref eval(), hence this
+     * mode requires <tt>enable_sampling=false</tt>.
      */
     Marginal2D(const ScalarFloat *data,
                const ScalarVector2u &size,
@@ -865,7 +984,11 @@ public:
         double scale_x = .5 / (w - 1),
                scale_y = .5 / (h - 1);
 
-        m_data = empty<FloatStorage>(m_slices * n_data);
+        if (CompactStorage && enable_sampling)
+            Throw("Marginal2D(): reduced-precision storage requires "
+                  "enable_sampling=false!");
+
+        m_data = empty<DataStorage>(m_slices * n_data);
         m_data.managed();
 
         if (enable_sampling) {
@@ -876,8 +999,8 @@ public:
             m_cond_cdf.managed();
 
             ScalarFloat *marg_cdf = m_marg_cdf.data(),
-                        *cond_cdf = m_cond_cdf.data(),
-                        *data_out = m_data.data();
+                        *cond_cdf = m_cond_cdf.data();
+            Storage *data_out = m_data.data();
 
             std::unique_ptr<double[]> cond_cdf_sum(new double[h]);
 
@@ -885,10 +1008,11 @@ public:
                 ScalarFloat norm = 1.f;
 
                 /* The marginal/probability distribution computation
-                   differs for the Continuous=false/true cases */
+                   differs for the Continuous=false/true cases. The rows of
+                   the conditional CDF are constructed in parallel. */
                 if constexpr (Continuous) {
                     // Construct conditional CDF
-                    for (uint32_t y = 0; y < h; ++y) {
+                    detail::parallel_rows(w, h, [&](uint32_t y) {
                         double accum = 0.0;
                         uint32_t i = y * w, j = y * (w - 1);
                         for (uint32_t x = 0; x < w - 1; ++x, ++i, ++j) {
@@ -897,7 +1021,7 @@ public:
                             cond_cdf[j] = (ScalarFloat) accum;
                         }
                         cond_cdf_sum[y] = accum;
-                    }
+                    });
 
                     // Construct marginal CDF
                     double accum = 0.0;
@@ -912,7 +1036,7 @@ public:
                     double scale = scale_x * scale_y;
 
                     // Construct conditional CDF
-                    for (uint32_t y = 0; y < h - 1; ++y) {
+                    detail::parallel_rows(w, h - 1, [&](uint32_t y) {
                         double accum = 0.0;
                         uint32_t i = y * w, j = y * (w - 1);
                         for (uint32_t x = 0; x < w - 1; ++x, ++i, ++j) {
@@ -923,7 +1047,7 @@ public:
                             cond_cdf[j] = (ScalarFloat) accum;
                         }
                         cond_cdf_sum[y] = accum;
-                    }
+                    });
 
                     // Construct marginal CDF
                     double accum = 0.0;
@@ -936,17 +1060,20 @@ public:
                         norm = ScalarFloat(1.0 / accum);
                 }
 
-                for (size_t i = 0; i < n_cond; ++i)
-                    *cond_cdf++ *= norm;
-                for (size_t i = 0; i < n_marg; ++i)
-                    *marg_cdf++ *= norm;
-                for (size_t i = 0; i < n_data; ++i)
-                    *data_out++ = *data++ * norm;
+                detail::parallel_scale(cond_cdf, cond_cdf, n_cond, norm);
+                detail::parallel_scale(marg_cdf, marg_cdf, n_marg, norm);
+                detail::parallel_convert(data, data_out, n_data, norm);
+                cond_cdf += n_cond;
+                marg_cdf += n_marg;
+                data_out += n_data;
+                data += n_data;
             }
         } else {
-            ScalarFloat *data_out = m_data.data();
+            Storage *data_out = m_data.data();
+            std::unique_ptr<ScalarFloat[]> norms(new ScalarFloat[m_slices]);
 
             for (uint32_t slice = 0; slice < m_slices; ++slice) {
+                const ScalarFloat *slice_data = data + slice * (size_t) n_data;
                 ScalarFloat norm = 1.f;
 
                 if (normalize) {
@@ -954,17 +1081,36 @@ public:
                     for (uint32_t y = 0; y < h - 1; ++y) {
                         size_t i = y * w;
                         for (uint32_t x = 0; x < w - 1; ++x, ++i) {
-                            sum += (double) data[i] +
-                                   (double) data[i + 1] +
-                                   (double) data[i + w] +
-                                   (double) data[i + w + 1];
+                            sum += (double) slice_data[i] +
+                                   (double) slice_data[i + 1] +
+                                   (double) slice_data[i + w] +
+                                   (double) slice_data[i + w + 1];
                         }
                     }
                     norm = ScalarFloat(1.0 / (scale_x * scale_y * sum));
                 }
 
-                for (uint32_t k = 0; k < n_data; ++k)
-                    *data_out++ = *data++ * norm;
+                norms[slice] = norm;
+            }
+
+            if constexpr (CompactStorage) {
+                /* Map the largest magnitude to 2^15, which leaves ~30 binary
+                   orders of magnitude below it before values become denormal */
+                ScalarFloat max_value = 0.f;
+                for (uint32_t slice = 0; slice < m_slices; ++slice) {
+                    const ScalarFloat *slice_data = data + slice * (size_t) n_data;
+                    for (uint32_t i = 0; i < n_data; ++i)
+                        max_value = std::max(max_value, std::abs(slice_data[i] * norms[slice]));
+                }
+                if (max_value > 0.f && std::isfinite(max_value))
+                    m_data_scale = max_value / 32768.f;
+            }
+
+            for (uint32_t slice = 0; slice < m_slices; ++slice) {
+                detail::parallel_convert(data, data_out, n_data,
+                                         norms[slice] / m_data_scale);
+                data_out += n_data;
+                data += n_data;
             }
         }
     }
@@ -1035,6 +1181,12 @@ public:
         return warp::square_to_bilinear_pdf(v00, v10, v01, v11, pos);
     }
 
+    /// Return the size of the density and CDF tables (in bytes)
+    size_t memory_usage() const {
+        return m_data.size() * sizeof(Storage) +
+               (m_marg_cdf.size() + m_cond_cdf.size()) * sizeof(ScalarFloat);
+    }
+
     std::string to_string() const {
         std::ostringstream oss;
         oss << "Marginal2D" << Dimension << "[" << std::endl
@@ -1056,16 +1208,14 @@ public:
             oss << "]," << std::endl;
         }
         oss << "  storage = { " << m_slices << " slice" << (m_slices > 1 ? "s" : "")
-            << ", ";
-        size_t size = m_slices * (hprod(m_size) * 2 + m_size.y());
-        oss << util::mem_string(size * sizeof(ScalarFloat)) << " }" << std::endl
+            << ", " << util::mem_string(memory_usage()) << " }" << std::endl
             << "]";
         return oss.str();
     }
 
 protected:
-    template <size_t Dim = Dimension>
-    MTS_INLINE Float lookup(const ScalarFloat *data,
+    template <size_t Dim = Dimension, typename Value>
+    MTS_INLINE Float lookup(const Value *data,
                             UInt32 i0,
                             uint32_t size,
                             const Float *param_weight,
@@ -1082,7 +1232,11 @@ protected:
         } else {
             ENOKI_MARK_USED(param_weight);
             ENOKI_MARK_USED(size);
-            return gather<Float>(data, i0, active);
+            if constexpr (std::is_same_v<Value, ScalarFloat>)
+                return gather<Float>(data, i0, active);
+            else
+                return Float(gather<replace_scalar_t<Float, Value>>(data, i0, active)) *
+                       m_data_scale;
         }
     }
 
@@ -1425,7 +1579,10 @@ protected:
     ScalarVector2u m_size;
 
     /// Density values
-    FloatStorage m_data;
+    DataStorage m_data;
+
+    /// Factor that converts the stored density values back (compact storage)
+    ScalarFloat m_data_scale = 1.f;
 
     /// Marginal and conditional PDFs
     FloatStorage m_marg_cdf;
@@ -0,0 +1,339 @@
+#pragma once
+
+#include <mitsuba/core/object.h>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/// Role of a process taking part in a distributed render
+enum class DistributedRole : uint32_t {
+    /// Render locally (default)
+    None = 0,
+
+    /// Hand out work to the workers and merge their results into the film
+    Coordinator,
+
+    /// Render the work items received from a coordinator
+    Worker
+};
+
+/// A unit of work of a distributed render: one image block of one pass
+struct RenderWorkItem {
+    /// Index of the item in the coordinator's list of work
+    uint64_t index;
+
+    /// Offset and size of the image block (in pixels)
+    int32_t offset[2], size[2];
+
+    /// Identifier of the block that seeds its sampler
+    uint64_t block_id;
+};
+
+/**
+ * \brief Coordinator of a distributed render
+ *
+ * The coordinator binds a ZeroMQ socket at the given address (e.g.
+ * <tt>tcp://\*:5555</tt>) and hands out work items to the \ref RenderWorker
+ * instances that connect to it. These run in other processes (usually on
+ * other machines) that have loaded the same scene. Every worker thread asks
+ * for one item at a time, so that fast machines automatically receive more
+ * work. Once all items have been handed out, unfinished ones are handed out
+ * again to idle workers, which tolerates crashed workers and shortens the
+ * tail of the render. Duplicate results are ignored.
+ *
+ * Workers announce a configuration string (e.g. describing the film and
+ * sample count), which must match the one of the coordinator.
+ *
+ * Addresses of the form <tt>inproc://name</tt> connect the coordinator
+ * to workers of the same process, e.g. ones that render the same scene
+ * loaded into another variant on a different device. These use a shared
+ * in-memory queue with the same protocol, and the callback is still
+ * invoked on the thread that called \ref run(). A coordinator can be run
+ * repeatedly at the same address, workers only take part in the first run
+ * they see and must be created anew for the next one.
+ *
+ * \remark Apart from <tt>inproc://</tt> addresses, this class is only
+ * functional when Mitsuba was compiled with ZeroMQ support
+ * (<tt>MTS_ENABLE_ZMQ</tt>).
+ */
+class MTS_EXPORT_CORE RenderCoordinator : public Object {
+public:
+    /// Invoked for the first result of every work item
+    using ResultCallback =
+        std::function<void(const RenderWorkItem &item, const uint8_t *data, size_t size)>;
+
+    /// Create a coordinator listening at \c address
+    RenderCoordinator(const std::string &address, const std::string &configuration);
+
+    /**
+     * \brief Distribute the given work items and wait for their results
+     *
+     * \param callback
+     *     Function that is invoked (on the calling thread) for every result
+     *
+     * \param should_stop
+     *     Polled regularly; distributing work stops once it returns \c true
+     *
+     * \return \c true if the results of all work items were received
+     */
+    bool run(const std::vector<RenderWorkItem> &items, const ResultCallback &callback,
+             const std::function<bool()> &should_stop);
+
+    /// Return the number of worker threads that connected to the coordinator
+    size_t worker_count() const { return m_worker_count; }
+
+    MTS_DECLARE_CLASS()
+protected:
+    ~RenderCoordinator();
+
+protected:
+    std::string m_address;
+    std::string m_configuration;
+    size_t m_worker_count = 0;
+};
+
+/**
+ * \brief Worker of a distributed render, see \ref RenderCoordinator
+ *
+ * A worker is meant to be used by a single thread, which alternates between
+ * requesting a work item via \ref next() and rendering it.
+ */
+class MTS_EXPORT_CORE RenderWorker : public Object {
+public:
+    /**
+     * \brief Create a worker connected to the coordinator at \c address
+     *
+     * \param timeout
+     *     Time (in milliseconds) after which an unresponsive coordinator
+     *     is assumed to be gone. The first request waits indefinitely,
+     *     since the coordinator may still be loading the scene (except
+     *     for <tt>inproc://</tt> addresses, see \ref RenderCoordinator).
+     */
+    RenderWorker(const std::string &address, const std::string &configuration,
+                 int timeout = 60000);
+
+    /**
+     * \brief Submit the result of the previous work item (if \c data is
+     * non-null) and request the next one
+     *
+     * \return \c false when there is no more work, or when the coordinator
+     *     is no longer reachable
+     */
+    bool next(RenderWorkItem &item, const uint8_t *data = nullptr, size_t size = 0);
+
+    MTS_DECLARE_CLASS()
+protected:
+    ~RenderWorker();
+
+    /// Implementation of \ref next() for <tt>inproc://</tt> addresses
+    bool next_local(RenderWorkItem &item, const uint8_t *data, size_t size);
+
+protected:
+    struct RenderWorkerPrivate;
+    std::unique_ptr<RenderWorkerPrivate> d;
+    std::string m_configuration;
+    RenderWorkItem m_item;
+    int m_timeout;
+    bool m_first_request = true;
+};
+
+// =============================================================================
+
+/// A render job submitted to a \ref RenderServer
+struct RenderRequest {
+    /// Path of the scene file (as seen by the server)
+    std::string scene;
+
+    /// Parameters substituted into the scene description (like <tt>-D key=value</tt>)
+    std::vector<std::pair<std::string, std::string>> parameters;
+
+    /// Sensors to render: an index, a list of indices and ranges, or "all"
+    std::string sensors = "0";
+};
+
+/**
+ * \brief Server that receives render jobs from \ref RenderClient instances
+ *
+ * The server binds a ZeroMQ socket at the given address (e.g.
+ * <tt>tcp://\*:5556</tt>) and processes one request at a time, while further
+ * requests queue up in the socket. The images of a request are streamed back
+ * to its client as they become available, followed by a final message that
+ * reports success or an error.
+ *
+ * \remark This class is only functional when Mitsuba was compiled with
+ * ZeroMQ support (<tt>MTS_ENABLE_ZMQ</tt>).
+ */
+class MTS_EXPORT_CORE RenderServer : public Object {
+public:
+    /// Create a server listening at \c address
+    RenderServer(const std::string &address);
+
+    /**
+     * \brief Wait for the next request
+     *
+     * \param should_stop
+     *     Polled regularly; waiting stops once it returns \c true
+     *
+     * \return \c false if waiting was stopped
+     */
+    bool next(RenderRequest &request, const std::function<bool()> &should_stop);
+
+    /// Send an (encoded) image of the current request to its client
+    void send_image(size_t sensor, const uint8_t *data, size_t size);
+
+    /// Finish the current request. A non-empty \c error reports a failure.
+    void finish(const std::string &error = "");
+
+    MTS_DECLARE_CLASS()
+protected:
+    ~RenderServer();
+
+protected:
+    struct RenderServerPrivate;
+    std::unique_ptr<RenderServerPrivate> d;
+};
+
+/**
+ * \brief Client of a \ref RenderServer
+ *
+ * Submits a request and receives the resulting images one by one.
+ */
+class MTS_EXPORT_CORE RenderClient : public Object {
+public:
+    /**
+     * \brief Create a client connected to the server at \c address
+     *
+     * \param timeout
+     *     Time (in milliseconds) to wait for each message of the server
+     *     (negative: wait indefinitely)
+     */
+    RenderClient(const std::string &address, int timeout = -1);
+
+    /// Submit a request to the server
+    void submit(const RenderRequest &request);
+
+    /**
+     * \brief Receive the next image of the submitted request
+     *
+     * Throws an exception when the server reports an error or does not
+     * respond in time.
+     *
+     * \return \c false once all images of the request were received
+     */
+    bool receive(size_t &sensor, std::vector<uint8_t> &data);
+
+    MTS_DECLARE_CLASS()
+protected:
+    ~RenderClient();
+
+protected:
+    struct RenderClientPrivate;
+    std::unique_ptr<RenderClientPrivate> d;
+    int m_timeout;
+};
+
+// =============================================================================
+
+/// Description of an image block published by a \ref BlockPublisher
+struct PublishedBlock {
+    /// Index of the pass that rendered the block
+    uint32_t pass;
+
+    /// Offset and size of the block on the film (in pixels, excluding the border)
+    int32_t offset[2], size[2];
+
+    /// Size of the border of the block (in pixels)
+    int32_t border;
+
+    /// Number of channels per pixel (including the sample weight)
+    uint32_t channel_count;
+
+    /// Size of the channel values (in bytes, 4 or 8)
+    uint32_t component_size;
+
+    /// Size of the uncompressed \ref ImageBlock data (in bytes)
+    uint64_t data_size;
+};
+
+/**
+ * \brief Publishes finished image blocks to any number of subscribers
+ *
+ * This makes it possible to watch a long render progressively from another
+ * machine, without extra passes or reading back the whole film. The
+ * publisher binds a ZeroMQ PUB socket at the given address (e.g.
+ * <tt>tcp://\*:5557</tt>), and \ref BlockSubscriber instances connect to it.
+ * The blocks contain the accumulated samples and weights of one pass, a
+ * preview is obtained by accumulating them and dividing by the weights.
+ *
+ * \ref publish() only copies the block into a bounded queue, which a
+ * background thread compresses and sends. Blocks are dropped when the queue
+ * is full or when a subscriber doesn't keep up, so that render threads never
+ * wait for the network.
+ *
+ * \remark This class is only functional when Mitsuba was compiled with
+ * ZeroMQ support (<tt>MTS_ENABLE_ZMQ</tt>).
+ */
+class MTS_EXPORT_CORE BlockPublisher : public Object {
+public:
+    /**
+     * \brief Create a publisher listening at \c address
+     *
+     * \param queue_size
+     *     Maximum number of blocks that are waiting to be sent
+     */
+    BlockPublisher(const std::string &address, size_t queue_size = 256);
+
+    /**
+     * \brief Queue a block for publication (thread-safe, never blocks)
+     *
+     * \return \c false when the block was dropped since the queue is full
+     */
+    bool publish(const PublishedBlock &block, const void *data);
+
+    /// Return the number of blocks that were sent so far
+    size_t published_count() const;
+
+    /// Return the number of blocks that were dropped so far
+    size_t dropped_count() const;
+
+    MTS_DECLARE_CLASS()
+protected:
+    /// Send the remaining blocks (for a short while) and stop the background thread
+    ~BlockPublisher();
+
+protected:
+    struct BlockPublisherPrivate;
+    std::unique_ptr<BlockPublisherPrivate> d;
+};
+
+/// Receives the image blocks of a \ref BlockPublisher
+class MTS_EXPORT_CORE BlockSubscriber : public Object {
+public:
+    /// Create a subscriber connected to the publisher at \c address
+    BlockSubscriber(const std::string &address);
+
+    /**
+     * \brief Receive the next block and decompress its data
+     *
+     * \param timeout
+     *     Time (in milliseconds) to wait for a block (negative: wait
+     *     indefinitely)
+     *
+     * \return \c false if no block arrived in time
+     */
+    bool receive(PublishedBlock &block, std::vector<uint8_t> &data, int timeout = -1);
+
+    MTS_DECLARE_CLASS()
+protected:
+    ~BlockSubscriber();
+
+protected:
+    struct BlockSubscriberPrivate;
+    std::unique_ptr<BlockSubscriberPrivate> d;
+};
+
+NAMESPACE_END(mitsuba)
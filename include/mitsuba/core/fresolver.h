@@ -3,6 +3,8 @@
 #include <mitsuba/core/filesystem.h>
 #include <mitsuba/core/object.h>
 #include <iosfwd>
+#include <mutex>
+#include <unordered_map>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -12,6 +14,12 @@ NAMESPACE_BEGIN(mitsuba)
  * This convenience class looks for a file or directory given its name
  * and a set of search paths. The implementation walks through the
  * search paths in order and stops once the file is found.
+ *
+ * Each lookup queries the file system once per search path, which can be
+ * slow on network file systems. When caching is enabled (see \ref
+ * set_cache_enabled()), the result of every \ref resolve() call is memoized
+ * until the search path list changes or \ref clear_cache() is called. The
+ * scene loader enables this on the resolver it uses while loading a scene.
  */
 class MTS_EXPORT_CORE FileResolver : public Object {
 public:
@@ -31,10 +39,10 @@ public:
     size_t size() const { return m_paths.size(); }
 
     /// Return an iterator at the beginning of the list of search paths
-    iterator begin() { return m_paths.begin(); }
+    iterator begin() { clear_cache(); return m_paths.begin(); }
 
     /// Return an iterator at the end of the list of search paths
-    iterator end()   { return m_paths.end(); }
+    iterator end()   { clear_cache(); return m_paths.end(); }
 
     /// Return an iterator at the beginning of the list of search paths (const)
     const_iterator begin() const { return m_paths.begin(); }
@@ -46,32 +54,47 @@ public:
     bool contains(const fs::path &p) const;
 
     /// Erase the entry at the given iterator position
-    void erase(iterator it) { m_paths.erase(it); }
+    void erase(iterator it) { clear_cache(); m_paths.erase(it); }
 
     /// Erase the search path from the list
     void erase(const fs::path &p);
 
     /// Clear the list of search paths
-    void clear() { m_paths.clear(); }
+    void clear() { clear_cache(); m_paths.clear(); }
 
     /// Prepend an entry at the beginning of the list of search paths
-    void prepend(const fs::path &path) { m_paths.insert(m_paths.begin(), path); }
+    void prepend(const fs::path &path) {
+        clear_cache();
+        m_paths.insert(m_paths.begin(), path);
+    }
 
     /// Append an entry to the end of the list of search paths
-    void append(const fs::path &path) { m_paths.push_back(path); }
+    void append(const fs::path &path) { clear_cache(); m_paths.push_back(path); }
 
     /// Return an entry from the list of search paths
-    fs::path &operator[](size_t index) { return m_paths[index]; }
+    fs::path &operator[](size_t index) { clear_cache(); return m_paths[index]; }
 
     /// Return an entry from the list of search paths (const)
     const fs::path &operator[](size_t index) const { return m_paths[index]; }
 
+    /// Enable or disable the memoization of \ref resolve() results
+    void set_cache_enabled(bool value);
+
+    /// Is the memoization of \ref resolve() results enabled?
+    bool cache_enabled() const { return m_cache_enabled; }
+
+    /// Discard all memoized \ref resolve() results
+    void clear_cache();
+
     /// Return a human-readable representation of this instance
     std::string to_string() const override;
 
     MTS_DECLARE_CLASS()
 private:
     std::vector<fs::path> m_paths;
+    bool m_cache_enabled = false;
+    mutable std::unordered_map<std::string, fs::path> m_cache;
+    mutable std::mutex m_cache_mutex;
 };
 
 NAMESPACE_END(mitsuba)
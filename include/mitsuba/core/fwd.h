@@ -25,12 +25,15 @@ class AnnotatedStream;
 class Appender;
 class ArgParser;
 class Bitmap;
+class BufferedStream;
 class DefaultFormatter;
 class DummyStream;
 class FileResolver;
 class FileStream;
 class Formatter;
 class Logger;
+class MemoryMappedFile;
+class MemoryReport;
 class MemoryStream;
 class Mutex;
 class PluginManager;
@@ -40,8 +43,10 @@ class Stream;
 class StreamAppender;
 class Struct;
 class StructConverter;
+class TextureCache;
 class Thread;
 class ThreadLocalBase;
+class TiledTexture;
 class TraversalCallback;
 class ZStream;
 enum LogLevel : int;
@@ -293,6 +298,13 @@ template <typename Float_> struct CoreAliases {
     if constexpr (is_scalar_v<Float>)                                                              \
         mask = true;
 
+/// Like \ref MTS_MASKED_FUNCTION, but also tracks the calls of the current object instance
+#define MTS_MASKED_METHOD(profiler_phase, mask)                                                    \
+    ScopedInstancePhase scope_phase(profiler_phase, this);                                         \
+    (void) mask;                                                                                   \
+    if constexpr (is_scalar_v<Float>)                                                              \
+        mask = true;
+
 NAMESPACE_BEGIN(filesystem)
 class path;
 NAMESPACE_END(filesystem)
@@ -2,6 +2,7 @@
 
 #include <mitsuba/core/object.h>
 #include <functional>
+#include <string>
 #include <vector>
 #include <tuple>
 #include <iostream>
@@ -51,6 +52,37 @@ size_t hash(const std::vector<T, Allocator> &v) {
     return value;
 }
 
+/// 32-bit MurmurHash3 (x86 variant) of a string, e.g. to derive Cryptomatte IDs
+inline uint32_t murmur_hash3(const std::string &str, uint32_t seed = 0) {
+    auto rotl = [](uint32_t x, int r) { return (x << r) | (x >> (32 - r)); };
+    const uint8_t *data = (const uint8_t *) str.data();
+    size_t size = str.size();
+    const uint32_t c1 = 0xcc9e2d51, c2 = 0x1b873593;
+    uint32_t h = seed;
+
+    for (size_t i = 0; i + 4 <= size; i += 4) {
+        uint32_t k = (uint32_t) data[i] | ((uint32_t) data[i + 1] << 8) |
+                     ((uint32_t) data[i + 2] << 16) | ((uint32_t) data[i + 3] << 24);
+        k = rotl(k * c1, 15) * c2;
+        h = rotl(h ^ k, 13) * 5 + 0xe6546b64;
+    }
+
+    uint32_t k = 0;
+    const uint8_t *tail = data + (size & ~(size_t) 3);
+    switch (size & 3) {
+        case 3: k ^= (uint32_t) tail[2] << 16; [[fallthrough]];
+        case 2: k ^= (uint32_t) tail[1] << 8;  [[fallthrough]];
+        case 1: k ^= (uint32_t) tail[0];
+                h ^= rotl(k * c1, 15) * c2;
+    }
+
+    h ^= (uint32_t) size;
+    h ^= h >> 16; h *= 0x85ebca6b;
+    h ^= h >> 13; h *= 0xc2b2ae35;
+    h ^= h >> 16;
+    return h;
+}
+
 template <typename T> struct hasher {
     size_t operator()(const T &t) const {
         return hash(t);
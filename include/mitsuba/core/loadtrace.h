@@ -0,0 +1,108 @@
+#pragma once
+
+#include <mitsuba/core/object.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/// Timings and sizes of the creation of one scene object, see \ref LoadTrace
+struct MTS_EXPORT_CORE LoadRecord {
+    /// Identifier of the object (\c id attribute, or a generated name)
+    std::string id;
+
+    /// Plugin name and class name (e.g. "ply" and "Shape") of the object
+    std::string plugin, class_name;
+
+    /// Resolved path of the file loaded by the object (if any)
+    std::string filename;
+
+    /// Name of the thread that created the object
+    std::string thread;
+
+    /// Identifiers of the objects referenced by this object
+    std::vector<std::string> references;
+
+    /// Index of the scene load (see \ref LoadTrace::begin_load())
+    uint32_t load = 0;
+
+    /// Start of the creation relative to the enabling of the trace (in milliseconds)
+    double start = 0.0;
+
+    /// Wall time spent creating the object (in milliseconds)
+    double time = 0.0;
+
+    /// Wall time spent by the prefetch stage reading or decoding the file (in milliseconds)
+    double prefetch_time = 0.0;
+
+    /// Size of the file that was read (in bytes)
+    uint64_t bytes_read = 0;
+
+    /// Host and device memory owned by the object, excluding referenced objects (in bytes)
+    uint64_t decoded_bytes = 0;
+
+    /// Return the end of the creation relative to the enabling of the trace
+    double end() const { return start + time; }
+};
+
+/**
+ * \brief Optional trace of the objects that are created while loading scenes
+ *
+ * The profiler only distinguishes aggregate phases such as geometry and
+ * texture loading, which doesn't reveal which of thousands of objects slowed
+ * down the initialization of a scene. When the trace is enabled, the scene
+ * loader records the wall time, the file size, the decoded size and the
+ * thread of every object it creates, together with the references between
+ * objects. This makes it possible to reconstruct the critical path of the
+ * parallel object creation, i.e. the chain of dependent objects that
+ * determines the total load time.
+ */
+class MTS_EXPORT_CORE LoadTrace : public Object {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /// Enable or disable the trace (enabling it also discards all records)
+    static void set_enabled(bool value);
+
+    /// Is the trace being recorded?
+    static bool enabled() { return m_enabled; }
+
+    /// Start a new scene load and return its index (used by the scene loader)
+    static uint32_t begin_load();
+
+    /// Convert a time point into milliseconds since the trace was enabled
+    static double time(Clock::time_point t);
+
+    /// Add a record (used by the scene loader)
+    static void add(LoadRecord &&record);
+
+    /// Return all records, sorted by their start time
+    static std::vector<LoadRecord> records();
+
+    /**
+     * \brief Return the critical path of the last scene load
+     *
+     * Starting from the object that finished last, the path repeatedly
+     * follows the referenced object that finished last, until reaching an
+     * object without references. The records are returned in the order in
+     * which the objects were created.
+     */
+    static std::vector<LoadRecord> critical_path();
+
+    /// Discard all records
+    static void clear();
+
+    /// Print the \c count slowest objects and the critical path of the last load
+    static void print_report(size_t count = 20);
+
+    /// Write all records and the critical path of the last load to a JSON file
+    static void write_json(const std::string &filename);
+
+    MTS_DECLARE_CLASS()
+private:
+    LoadTrace() = delete;
+    static bool m_enabled;
+};
+
+NAMESPACE_END(mitsuba)
@@ -111,6 +111,23 @@ public:
      */
     std::string read_log();
 
+    /**
+     * \brief Enable or disable asynchronous logging
+     *
+     * When enabled, log and progress messages are formatted by the calling
+     * thread and then pushed onto a lock-free queue, which is handed to the
+     * appenders by a background thread. This prevents rendering threads from
+     * stalling on slow output streams. Disabling asynchronous mode (and
+     * destructing the logger) delivers all pending messages.
+     */
+    void set_asynchronous(bool value);
+
+    /// Return whether asynchronous logging is enabled
+    bool asynchronous() const;
+
+    /// Deliver all messages that are queued in asynchronous mode
+    void flush();
+
     /// Initialize logging
     static void static_initialization();
 
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <mitsuba/core/object.h>
+#include <enoki/array.h>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/// Subsystems distinguished by \ref MemoryReport
+enum class MemoryCategory : uint32_t {
+    /// Vertices, faces and attributes of meshes
+    Geometry,
+
+    /// Ray tracing acceleration data structures
+    Acceleration,
+
+    /// Bitmaps and texel data of textures
+    Textures,
+
+    /// Volumetric grids
+    Volumes,
+
+    /// Tabulated distributions used for importance sampling
+    Distributions,
+
+    /// Accumulation buffers of films
+    Film,
+
+    /// Anything else
+    Other,
+
+    /// Number of categories
+    Count
+};
+
+/// Return a human-readable name of a memory category
+extern MTS_EXPORT_CORE const char *memory_category_name(MemoryCategory category);
+
+/**
+ * \brief Summary of the memory used by a graph of objects
+ *
+ * The report is created by visiting the root of the graph (e.g. a scene),
+ * whose \ref Object::account_memory() implementation records the storage it
+ * owns and visits the objects it references in turn. Objects that are
+ * referenced several times (e.g. a texture shared by several materials) are
+ * only accounted once.
+ *
+ * Memory is split into host and device memory: the storage of CUDA arrays
+ * counts as device memory.
+ */
+class MTS_EXPORT_CORE MemoryReport : public Object {
+public:
+    MemoryReport();
+
+    /// Account an object and the objects it references, unless it was already visited
+    void visit(const Object *object);
+
+    /// Record memory that is owned by the object that is currently visited
+    void add(MemoryCategory category, size_t size, bool device = false);
+
+    /// Record the storage of an Enoki array (device memory in CUDA variants)
+    template <typename Array> void add_array(MemoryCategory category, const Array &array) {
+        add(category, enoki::slices(array) * sizeof(enoki::scalar_t<Array>),
+            enoki::is_cuda_array_v<Array>);
+    }
+
+    /// Return the host memory of a category (in bytes)
+    size_t host(MemoryCategory category) const;
+
+    /// Return the device memory of a category (in bytes)
+    size_t device(MemoryCategory category) const;
+
+    /// Return the host memory of all categories (in bytes)
+    size_t total_host() const;
+
+    /// Return the device memory of all categories (in bytes)
+    size_t total_device() const;
+
+    /// Return the number of objects that have been visited
+    size_t object_count() const { return m_visited.size(); }
+
+    /// Return a summary listing the categories and the largest object types
+    std::string to_string() const override;
+
+    MTS_DECLARE_CLASS()
+protected:
+    virtual ~MemoryReport();
+
+protected:
+    std::unordered_set<const Object *> m_visited;
+    size_t m_host[(size_t) MemoryCategory::Count];
+    size_t m_device[(size_t) MemoryCategory::Count];
+
+    /// Total memory per class name (host + device)
+    std::unordered_map<std::string, size_t> m_classes;
+
+    /// Class of the object that is currently visited
+    const Class *m_current = nullptr;
+};
+
+NAMESPACE_END(mitsuba)
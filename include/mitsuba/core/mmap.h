@@ -55,6 +55,16 @@ public:
      */
     static ref<MemoryMappedFile> create_temporary(size_t size);
 
+    /**
+     * \brief Map the specified file into memory with copy-on-write semantics
+     *
+     * The memory region can be modified, but changes are private to the
+     * process and never written back to the file. Until a page is modified,
+     * it is shared with all other processes that map the same file (via the
+     * page cache of the OS).
+     */
+    static ref<MemoryMappedFile> map_copy_on_write(const fs::path &filename);
+
     MTS_DECLARE_CLASS()
 protected:
     /// Internal constructor
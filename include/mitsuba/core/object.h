@@ -95,6 +95,21 @@ public:
      */
     virtual void parameters_changed(const std::vector<std::string> &/*keys*/ = {});
 
+    /**
+     * \brief Account the memory used by this instance
+     *
+     * Implementations record the storage they own via \ref
+     * MemoryReport::add() and forward the objects they reference to \ref
+     * MemoryReport::visit(). This is e.g. used to summarize the memory
+     * footprint of a scene.
+     *
+     * \remark The default implementation visits the objects reported by \ref
+     * traverse().
+     *
+     * \sa MemoryReport
+     */
+    virtual void account_memory(MemoryReport *report) const;
+
     /**
      * \brief Return a \ref Class instance containing run-time type information
      * about this Object
@@ -26,7 +26,21 @@ public:
     /// Ensure that a plugin is loaded and ready
     void ensure_plugin_loaded(const std::string &name);
 
-    /// Return the class corresponding to a plugin for a specific variant
+    /**
+     * \brief Load a set of plugins ahead of time
+     *
+     * The XML loader calls this function with the plugins referenced by a
+     * scene before instantiating its objects in parallel, so that the
+     * tasks don't wait on each other while libraries are being loaded.
+     * Plugins that cannot be found are skipped here: the error is raised
+     * when the corresponding object is created.
+     */
+    void preload_plugins(const std::vector<std::string> &names);
+
+    /**
+     * \brief Return the class corresponding to a plugin for a specific
+     * variant (cached after the first lookup)
+     */
     const Class *get_plugin_class(const std::string &name, const std::string &variant);
 
     /// Return the list of loaded plugins
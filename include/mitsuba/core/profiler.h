@@ -3,11 +3,24 @@
 #pragma once
 
 #include <mitsuba/core/object.h>
+#include <chrono>
 
 #if !defined(MTS_PROFILE_HASH_SIZE)
 #  define MTS_PROFILE_HASH_SIZE 256
 #endif
 
+#if !defined(MTS_PROFILE_TRACE_SIZE)
+#  define MTS_PROFILE_TRACE_SIZE 65536
+#endif
+
+/* Bit mask of the profiler phases that are instrumented, where bit 'i' refers
+   to the i-th entry of 'ProfilerPhase'. Scopes of the other phases compile to
+   nothing, e.g. -DMTS_PROFILE_PHASES=0xff only keeps the coarse phases up to
+   Film::develop(). */
+#if !defined(MTS_PROFILE_PHASES)
+#  define MTS_PROFILE_PHASES 0xffffffffffffffffull
+#endif
+
 NAMESPACE_BEGIN(mitsuba)
 
 /**
@@ -21,6 +34,9 @@ enum class ProfilerPhase : int {
     LoadTexture,                /* Texture loading */
     InitKDTree,                 /* kd-tree construction */
     Render,                     /* Integrator::render() */
+    RenderPass,                 /* One pass of a progressive render */
+    RenderBlock,                /* SamplingIntegrator::render_block() */
+    FilmDevelop,                /* Film::develop() */
     SamplingIntegratorSample,   /* SamplingIntegrator::sample() */
     SampleEmitterRay,           /* Scene::sample_emitter_ray() */
     SampleEmitterDirection,     /* Scene::sample_emitter_direction() */
@@ -50,6 +66,9 @@ constexpr const char
         "Texture loading",
         "kd-tree construction",
         "Integrator::render()",
+        "Render pass",
+        "SamplingIntegrator::render_block()",
+        "Film::develop()",
         "SamplingIntegrator::sample()",
         "Scene::sample_emitter_ray()",
         "Scene::sample_emitter_direction()",
@@ -87,17 +106,132 @@ static_assert(std::extent_v<decltype(profiler_phase_id)> ==
 extern MTS_EXPORT_CORE uint64_t *profiler_flags()
     __attribute__((noinline, weak, const));
 
+class MTS_EXPORT_CORE Profiler : public Object {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static void static_initialization();
+    static void static_shutdown();
+    static void print_report();
+
+    /**
+     * \brief Enable or disable the sampling profiler
+     *
+     * The profiler is disabled by default. While disabled, a \ref ScopedPhase
+     * reduces to a branch on a global flag and doesn't touch the thread-local
+     * phase state, hence one build can be used for production renders and
+     * for profiling runs. Phases that are active while the profiler is
+     * enabled aren't recorded until they are entered again.
+     */
+    static void set_enabled(bool value);
+
+    /// Is the sampling profiler enabled?
+    static bool enabled() { return m_enabled; }
+
+    /// Is the given phase instrumented by this build (see \c MTS_PROFILE_PHASES)?
+    static constexpr bool instrumented(ProfilerPhase phase) {
+        return (uint64_t(MTS_PROFILE_PHASES) >> int(phase)) & 1;
+    }
+
+    /**
+     * \brief Enable or disable the recording of a timeline trace
+     *
+     * When enabled (and when the profiler is enabled), every \ref
+     * ScopedPhase of the phases up to (and including) \c max_phase records a begin/end event into a ring buffer
+     * of the current thread, which holds the last \c MTS_PROFILE_TRACE_SIZE
+     * events. Since fine-grained phases come last in the list of phases, the
+     * default only traces scene loading, kd-tree construction, render passes
+     * and blocks, and film development.
+     */
+    static void set_tracing(bool value, ProfilerPhase max_phase = ProfilerPhase::FilmDevelop) {
+        m_trace_mask = value ? ((2ull << int(max_phase)) - 1) : 0;
+    }
+
+    /// Is the timeline trace being recorded?
+    static bool tracing() { return m_trace_mask != 0; }
+
+    /// Bit mask of the traced phases (used by \ref ScopedPhase)
+    static uint64_t trace_mask() { return m_trace_mask; }
+
+    /// Record a trace event of the current thread (used by \ref ScopedPhase)
+    static void record_trace(ProfilerPhase phase, Clock::time_point begin,
+                             Clock::time_point end);
+
+    /**
+     * \brief Write the recorded timeline to a file in the Chrome trace event
+     * format, which can be opened with chrome://tracing or ui.perfetto.dev
+     *
+     * Must not be called while a render is in progress.
+     */
+    static void write_trace(const std::string &filename);
+
+    /// Discard all recorded trace events
+    static void clear_trace();
+
+    /**
+     * \brief Enable or disable the per-instance call statistics
+     *
+     * When enabled, every call of an instrumented method (see \ref
+     * ScopedInstancePhase) is counted and timed separately for each object
+     * instance, e.g. to find the single BSDF that dominates the render time.
+     * This is disabled by default, since the timer queries are quite costly.
+     */
+    static void set_instance_statistics(bool value) { m_instance_statistics = value; }
+
+    /// Are per-instance call statistics enabled?
+    static bool instance_statistics() { return m_instance_statistics; }
+
+    /// Record a call of an instrumented method (used by \ref ScopedInstancePhase)
+    static void record_instance(const Object *object, ProfilerPhase phase,
+                                uint64_t time_ns);
+
+    /**
+     * \brief Print the per-instance call statistics, sorted by total time
+     *
+     * Timings are inclusive, i.e. the time spent by an object (e.g. a blend
+     * BSDF) includes the time spent by the objects that it calls. Must not
+     * be called while a render is in progress.
+     */
+    static void print_instance_report();
+
+    /// Write the per-instance call statistics to a JSON file
+    static void write_instance_report(const std::string &filename);
+
+    /// Discard all per-instance call statistics
+    static void clear_instance_statistics();
+
+    MTS_DECLARE_CLASS()
+private:
+    Profiler() = delete;
+    static bool m_enabled;
+    static bool m_instance_statistics;
+    static uint64_t m_trace_mask;
+};
+
 struct ScopedPhase {
     ScopedPhase(ProfilerPhase phase)
-        : m_target(profiler_flags()), m_flag(1ull << int(phase)) {
-        if ((*m_target & m_flag) == 0)
-            *m_target |= m_flag;
-        else
-            m_flag = 0;
+        : m_target(nullptr), m_flag(0), m_phase(phase) {
+        // Constant-folded for the phases excluded by MTS_PROFILE_PHASES
+        if (!Profiler::instrumented(phase) || likely(!Profiler::enabled()))
+            return;
+
+        uint64_t flag = 1ull << int(phase);
+        m_target = profiler_flags();
+        if ((*m_target & flag) == 0) {
+            *m_target |= flag;
+            m_flag = flag;
+            if (unlikely(Profiler::trace_mask() & m_flag))
+                m_begin = Profiler::Clock::now();
+        }
     }
 
     ~ScopedPhase() {
+        if (!Profiler::instrumented(m_phase) || likely(m_flag == 0))
+            return;
         *m_target &= ~m_flag;
+        if (unlikely(Profiler::trace_mask() & m_flag) &&
+            m_begin != Profiler::Clock::time_point())
+            Profiler::record_trace(m_phase, m_begin, Profiler::Clock::now());
     }
 
     ScopedPhase(const ScopedPhase &) = delete;
@@ -106,27 +240,62 @@ struct ScopedPhase {
 private:
     uint64_t* m_target;
     uint64_t  m_flag;
+    ProfilerPhase m_phase;
+    Profiler::Clock::time_point m_begin;
 };
 
-class MTS_EXPORT_CORE Profiler : public Object {
-public:
-    static void static_initialization();
-    static void static_shutdown();
-    static void print_report();
-    MTS_DECLARE_CLASS()
+/**
+ * \brief Variant of \ref ScopedPhase which additionally counts and times the
+ * call for the given object instance when per-instance statistics are enabled
+ * (see \ref Profiler::set_instance_statistics())
+ */
+struct ScopedInstancePhase : ScopedPhase {
+    using Clock = std::chrono::steady_clock;
+
+    ScopedInstancePhase(ProfilerPhase phase, const Object *object)
+        : ScopedPhase(phase), m_object(nullptr), m_phase(phase) {
+        if (unlikely(Profiler::instance_statistics())) {
+            m_object = object;
+            m_start = Clock::now();
+        }
+    }
+
+    ~ScopedInstancePhase() {
+        if (unlikely(m_object != nullptr))
+            Profiler::record_instance(
+                m_object, m_phase,
+                (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    Clock::now() - m_start).count());
+    }
+
 private:
-    Profiler() = delete;
+    const Object *m_object;
+    ProfilerPhase m_phase;
+    Clock::time_point m_start;
 };
 
 #else
 
 /* Profiler not supported on this platform */
 struct ScopedPhase { ScopedPhase(ProfilerPhase) { } };
+struct ScopedInstancePhase { ScopedInstancePhase(ProfilerPhase, const Object *) { } };
 class Profiler {
 public:
     static void static_initialization() { }
     static void static_shutdown() { }
     static void print_report() { }
+    static void set_enabled(bool) { }
+    static bool enabled() { return false; }
+    static constexpr bool instrumented(ProfilerPhase) { return false; }
+    static void set_instance_statistics(bool) { }
+    static bool instance_statistics() { return false; }
+    static void print_instance_report() { }
+    static void write_instance_report(const std::string &) { }
+    static void clear_instance_statistics() { }
+    static void set_tracing(bool, ProfilerPhase = ProfilerPhase::FilmDevelop) { }
+    static bool tracing() { return false; }
+    static void write_trace(const std::string &) { }
+    static void clear_trace() { }
 };
 
 #endif
@@ -2,6 +2,7 @@
 
 #include <mitsuba/core/timer.h>
 #include <mitsuba/core/object.h>
+#include <atomic>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -11,6 +12,10 @@ NAMESPACE_BEGIN(mitsuba)
  * This class is used to track the progress of various operations that might
  * take longer than a second or so. It provides interactive feedback when
  * Mitsuba is run on the console, via the OpenGL GUI, or in Jupyter Notebook.
+ *
+ * \ref update() may be called concurrently by multiple threads. It does not
+ * take any locks: redundant updates are coalesced, and an update arriving
+ * while another thread redraws the progress bar is dropped.
  */
 class MTS_EXPORT_CORE ProgressReporter : public Object {
 public:
@@ -36,8 +41,9 @@ protected:
     std::string m_line;
     size_t m_bar_start;
     size_t m_bar_size;
-    size_t m_last_update;
-    float m_last_progress;
+    std::atomic<size_t> m_last_update;
+    std::atomic<float> m_last_progress;
+    std::atomic<bool> m_busy;
     void *m_payload;
 };
 
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <mitsuba/core/filesystem.h>
+#include <mitsuba/core/object.h>
+#include <functional>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**
+ * \brief Process-wide cache of resources that can be shared by plugin instances
+ *
+ * Scenes frequently reference the same file from many plugins, e.g. when
+ * every object of a material library has its own copy of a material. This
+ * class maps a key, which captures the source file (see \ref file_key()) and
+ * all options that affect the loaded representation, to an object storing
+ * the result, so that identical resources are only loaded, converted and
+ * stored once.
+ *
+ * Entries are held weakly: the cache releases an object once it is no longer
+ * referenced anywhere else. Concurrent lookups of the same key (e.g. by the
+ * parallel scene loader) wait for a single invocation of the creation
+ * function, while lookups of other keys proceed independently.
+ */
+class MTS_EXPORT_CORE ResourceCache : public Object {
+public:
+    /// Return the global resource cache
+    static ResourceCache *instance() { return m_instance; }
+
+    /**
+     * \brief Return a key identifying the current contents of a file
+     *
+     * The key consists of the absolute path, size and modification time of
+     * the file, hence modified files are loaded again.
+     */
+    static std::string file_key(const fs::path &path);
+
+    /**
+     * \brief Look up the resource with the given key
+     *
+     * When the cache contains no such resource, \c create is invoked to
+     * produce it. Exceptions raised by \c create are propagated to the caller
+     * and leave the cache unchanged.
+     */
+    ref<Object> get(const std::string &key, const std::function<ref<Object>()> &create);
+
+    /// Typed convenience wrapper of \ref get()
+    template <typename T, typename Func>
+    ref<T> get(const std::string &key, Func &&create) {
+        ref<Object> object = get(key, [&]() -> ref<Object> { return create(); });
+        return ref<T>(static_cast<T *>(object.get()));
+    }
+
+    /// Return the number of resources that are currently cached
+    size_t size() const;
+
+    /// Release all resources (plugins that reference them are unaffected)
+    void clear();
+
+    /// Return a string representation including cache statistics
+    std::string to_string() const override;
+
+    MTS_DECLARE_CLASS()
+protected:
+    ResourceCache();
+    virtual ~ResourceCache();
+
+    /// Release the resources that aren't referenced anymore (lock must be held)
+    void prune() const;
+
+protected:
+    struct ResourceCachePrivate;
+    std::unique_ptr<ResourceCachePrivate> d;
+    static ref<ResourceCache> m_instance;
+};
+
+NAMESPACE_END(mitsuba)
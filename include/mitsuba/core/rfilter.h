@@ -9,6 +9,14 @@ NAMESPACE_BEGIN(mitsuba)
 /// Reconstruction filters will be tabulated at this resolution
 #define MTS_FILTER_RESOLUTION 31
 
+/**
+ * Number of sub-pixel offsets at which \ref ImageBlock tabulates the weights
+ * of its splat footprint. This is a multiple of \ref MTS_FILTER_RESOLUTION,
+ * so that the tabulated weights of filters with an integer or half-integer
+ * radius match \ref ReconstructionFilter::eval_discretized() exactly.
+ */
+#define MTS_FILTER_OFFSET_RESOLUTION (2 * MTS_FILTER_RESOLUTION)
+
 /**
  * \brief When resampling data to a different resolution using \ref
  * Resampler::resample(), this enumeration specifies how lookups
@@ -137,6 +137,15 @@ extern MTS_EXPORT_CORE const float *cie1931_x_data;
 extern MTS_EXPORT_CORE const float *cie1931_y_data;
 extern MTS_EXPORT_CORE const float *cie1931_z_data;
 
+/**
+ * \brief Interleaved CIE 1931 table used by \ref spectrum_to_xyz() in scalar
+ * variants
+ *
+ * Every sample occupies 8 floats aligned to a 16 byte boundary: the XYZ values
+ * followed by a zero, and the differences to the next sample followed by a zero.
+ */
+extern MTS_EXPORT_CORE const float *cie1931_xyz_data;
+
 /// Allocate GPU memory for the CIE 1931 tables
 extern MTS_EXPORT_CORE void cie_alloc();
 
@@ -210,6 +219,31 @@ template <typename Float, size_t Size>
 Color<Float, 3> spectrum_to_xyz(const Spectrum<Float, Size> &value,
                                 const Spectrum<Float, Size> &wavelengths,
                                 mask_t<Float> active = true) {
+    if constexpr (std::is_same_v<Float, float>) {
+        /* Scalar variants: accumulate the (X, Y, Z) rows of the interleaved
+           table, which requires two aligned 4-wide loads per wavelength
+           instead of six gathers. */
+        using Vector4f = Array<float, 4>;
+        Vector4f result(0.f);
+
+        for (size_t i = 0; i < Size; ++i) {
+            float lambda = wavelengths.coeff(i);
+            if (!active || !(lambda >= MTS_CIE_MIN && lambda <= MTS_CIE_MAX))
+                continue;
+
+            float t = (lambda - MTS_CIE_MIN) *
+                      ((MTS_CIE_SAMPLES - 1) / (MTS_CIE_MAX - MTS_CIE_MIN));
+            uint32_t i0 = std::min((uint32_t) t, (uint32_t) MTS_CIE_SAMPLES - 2);
+
+            const float *ptr = cie1931_xyz_data + i0 * 8;
+            Vector4f v = load<Vector4f>(ptr), d = load<Vector4f>(ptr + 4);
+            result = fmadd(fmadd(d, Vector4f(t - (float) i0), v), Vector4f(value.coeff(i)), result);
+        }
+
+        result *= 1.f / Size;
+        return { result.x(), result.y(), result.z() };
+    }
+
     Array<Spectrum<Float, Size>, 3> XYZ = cie1931_xyz(wavelengths, active);
     return { hmean(XYZ.x() * value),
              hmean(XYZ.y() * value),
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <mitsuba/core/object.h>
+#include <enoki/array.h>
+#include <string>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/// Kinds of rays that are counted by \ref Statistics
+enum class RayCounter : int {
+    Primary = 0,  /* Rays generated by sensors */
+    Intersect,    /* All calls to Scene::ray_intersect*(), including primary rays */
+    Shadow,       /* Scene::ray_test() */
+
+    RayCounterCount
+};
+
+/// Width of the ray queries that are counted by \ref Statistics
+enum class RayWidth : int {
+    Scalar = 0,   /* One ray per query (scalar variants) */
+    Packet,       /* SIMD packets (packet variants) */
+    Wavefront,    /* Dynamic arrays (e.g. GPU variants) */
+
+    RayWidthCount
+};
+
+/// Snapshot of the ray counters, see \ref Statistics::ray_statistics()
+struct MTS_EXPORT_CORE RayStatistics {
+    static constexpr size_t CounterCount = size_t(RayCounter::RayCounterCount),
+                            WidthCount   = size_t(RayWidth::RayWidthCount);
+
+    /// Number of rays by kind and query width
+    uint64_t rays[CounterCount][WidthCount] = { };
+
+    /// Number of queries (i.e. function calls) by kind and query width
+    uint64_t queries[CounterCount][WidthCount] = { };
+
+    /// Time span covered by the counts in seconds (0 if unknown)
+    double time = 0.0;
+
+    /// Return the number of rays of the given kind over all widths
+    uint64_t total(RayCounter counter) const {
+        uint64_t result = 0;
+        for (size_t i = 0; i < WidthCount; ++i)
+            result += rays[size_t(counter)][i];
+        return result;
+    }
+
+    /// Number of primary rays
+    uint64_t primary() const { return total(RayCounter::Primary); }
+
+    /// Number of secondary (i.e. non-primary) intersection rays
+    uint64_t secondary() const {
+        uint64_t intersect = total(RayCounter::Intersect), primary_ = primary();
+        return intersect > primary_ ? intersect - primary_ : 0;
+    }
+
+    /// Number of shadow rays
+    uint64_t shadow() const { return total(RayCounter::Shadow); }
+
+    /// Total number of traced rays
+    uint64_t traced() const { return total(RayCounter::Intersect) + shadow(); }
+
+    /// Traced rays per second (0 if \ref time is unknown)
+    double rays_per_second() const { return time > 0.0 ? traced() / time : 0.0; }
+
+    /// Return the difference of two snapshots (keeping the time of \c this)
+    RayStatistics operator-(const RayStatistics &other) const;
+
+    /// Return a human-readable summary
+    std::string to_string() const;
+};
+
+/**
+ * \brief Machine-readable statistics about the current render
+ *
+ * Collects timings (scene loading, acceleration data structure construction,
+ * rendering, individual passes), ray counts and other values of a render,
+ * and turns them into a JSON report (e.g. for tracking performance
+ * regressions on a render farm). Statistics are disabled by default, in which
+ * case counting rays is essentially free.
+ *
+ * Ray counters are accumulated by each thread separately, hence they are
+ * only exact once rendering has finished. They are always active in the CPU
+ * variants, where the overhead of an increment per query is negligible. In
+ * the GPU variants, counting rays forces the evaluation of the masks of all
+ * ray queries, hence rays are only counted when statistics are enabled.
+ */
+class MTS_EXPORT_CORE Statistics : public Object {
+public:
+    /// Enable or disable the collection of statistics
+    static void set_enabled(bool value) { m_enabled = value; }
+
+    /// Are statistics being collected?
+    static bool enabled() { return m_enabled; }
+
+    /// Record a ray query of the given kind and width with \c count rays
+    static void add_rays(RayCounter counter, RayWidth width, uint64_t count);
+
+    /// Count the active lanes of a ray query
+    template <typename Mask>
+    static void count_rays(RayCounter counter, const Mask &active) {
+        if constexpr (enoki::is_cuda_array_v<Mask>) {
+            if (likely(!m_enabled))
+                return;
+            add_rays(counter, RayWidth::Wavefront, (uint64_t) enoki::count(active));
+        } else if constexpr (enoki::is_dynamic_array_v<Mask>) {
+            add_rays(counter, RayWidth::Wavefront, (uint64_t) enoki::count(active));
+        } else if constexpr (enoki::is_array_v<Mask>) {
+            add_rays(counter, RayWidth::Packet, (uint64_t) enoki::count(active));
+        } else {
+            add_rays(counter, RayWidth::Scalar, active ? 1u : 0u);
+        }
+    }
+
+    /// Return the number of rays of the given kind over all threads
+    static uint64_t rays(RayCounter counter);
+
+    /// Return a snapshot of all ray counters, aggregated over all threads
+    static RayStatistics ray_statistics();
+
+    /// Accumulate the time (in milliseconds) spent in a named phase
+    static void add_time(const std::string &name, float time_ms);
+
+    /// Append the duration (in milliseconds) of a rendering pass
+    static void add_pass_time(float time_ms);
+
+    /// Set a named numerical value (e.g. the sample count)
+    static void set_value(const std::string &name, double value);
+
+    /// Discard all statistics including the ray counters (e.g. before loading the next scene)
+    static void reset();
+
+    /**
+     * \brief Return a JSON object with all statistics
+     *
+     * Besides the recorded values, the report contains the number of primary,
+     * indirect and shadow rays, the ray throughput during rendering, and the
+     * peak resident memory of the process.
+     *
+     * \param label
+     *     Optional label (e.g. a filename) stored in a \c "label" entry
+     */
+    static std::string to_json(const std::string &label = "");
+
+    MTS_DECLARE_CLASS()
+private:
+    Statistics() = delete;
+    static bool m_enabled;
+};
+
+NAMESPACE_END(mitsuba)
@@ -98,5 +98,8 @@ extern MTS_EXPORT_CORE std::string trim(const std::string &s,
 /// Check if a list of keys contains a specific key
 extern MTS_EXPORT_CORE bool contains(const std::vector<std::string> &keys, const std::string &key);
 
+/// Escape quotes, backslashes and control characters for use in a JSON string
+extern MTS_EXPORT_CORE std::string json_escape(const std::string &s);
+
 NAMESPACE_END(string)
 NAMESPACE_END(mitsuba)
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <mitsuba/core/object.h>
+#include <memory>
 #include <vector>
 #include <limits>
 
@@ -131,7 +132,7 @@ public:
         bool operator==(const Field &f) const {
             return name == f.name && type == f.type && size == f.size &&
                    offset == f.offset && flags == f.flags &&
-                   default_ == f.default_;
+                   default_ == f.default_ && blend == f.blend;
         }
 
         /// Equality operator
@@ -395,15 +396,8 @@ public:
      *
      * \return \c true upon success
      */
-#if MTS_STRUCTCONVERTER_USE_JIT == 1
-    bool convert_2d(size_t width, size_t height, const void *src,
-                    void *dest) const {
-        return m_func(width, height, src, dest);
-    }
-#else
     bool convert_2d(size_t width, size_t height, const void *src,
                     void *dest) const;
-#endif
 
     /// Return the source \c Struct descriptor
     const Struct *source() const { return m_source.get(); }
@@ -416,6 +410,22 @@ public:
 
     MTS_DECLARE_CLASS()
 protected:
+    /// Vectorized routines for common layouts that bypass the generic code
+    enum class FastPath : uint32_t {
+        None,
+        /// 8-bit integers (optionally normalized/gamma-corrected) to floats
+        UInt8ToFloat32,
+        /// Half precision to single precision
+        Float16ToFloat32,
+        /// Single precision to half precision
+        Float32ToFloat16
+    };
+
+    /// Check if the conversion is covered by one of the fast paths
+    void init_fast_path();
+
+    /// Convert \c count records using the selected fast path
+    void convert_fast_path(size_t count, const uint8_t *src, uint8_t *dest) const;
 
 #if MTS_STRUCTCONVERTER_USE_JIT == 0
     // Support data structures/functions for non-accelerated conversion backend
@@ -445,6 +455,16 @@ protected:
 #else
     bool m_dither;
 #endif
+
+    FastPath m_fast_path = FastPath::None;
+    /// Fields are stored in the same order without gaps on both sides
+    bool m_fast_flat = false;
+    /// Interleaved source and target offsets of the target fields
+    std::vector<uint32_t> m_fast_offsets;
+    /// Per-field lookup tables (256 entries each) for 8-bit sources
+    std::shared_ptr<const float> m_fast_lut;
+    /// Number of distinct lookup tables that repeat along a flat record
+    uint32_t m_fast_period = 1;
 };
 
 extern MTS_EXPORT_CORE std::ostream &operator<<(std::ostream &os, Struct::Type value);
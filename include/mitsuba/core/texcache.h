@@ -0,0 +1,170 @@
+#pragma once
+
+#include <mitsuba/core/object.h>
+#include <mitsuba/core/filesystem.h>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**
+ * \brief Tiled, MIP-mapped texture that is stored on disk and paged into
+ * memory on demand by the global \ref TextureCache
+ *
+ * Instances are created via \ref TextureCache::open() from files that were
+ * previously generated using \ref TextureCache::write(). Every MIP level is
+ * split into square tiles of <tt>tile_size() x tile_size()</tt> pixels with
+ * <tt>channel_count()</tt> single precision components each. The file is
+ * memory-mapped, hence reading a tile doesn't require any locking.
+ */
+class MTS_EXPORT_CORE TiledTexture : public Object {
+public:
+    /// Return the number of channels per pixel
+    uint32_t channel_count() const { return m_channel_count; }
+
+    /// Return the number of MIP levels (level 0 has the full resolution)
+    uint32_t level_count() const { return (uint32_t) m_levels.size(); }
+
+    /// Return the side length of a tile in pixels
+    uint32_t tile_size() const { return 1u << m_tile_shift; }
+
+    /// Return the horizontal resolution of the given MIP level
+    uint32_t width(uint32_t level = 0) const { return m_levels[level].width; }
+
+    /// Return the vertical resolution of the given MIP level
+    uint32_t height(uint32_t level = 0) const { return m_levels[level].height; }
+
+    /// Return the average value that was specified when creating the file
+    float mean() const { return m_mean; }
+
+    /// Return the path of the underlying tiled texture file
+    const fs::path &filename() const { return m_filename; }
+
+    /**
+     * \brief Fetch the channels of a pixel of the given MIP level
+     *
+     * The coordinates must lie within the resolution of the level. The
+     * containing tile is first looked up in a small per-thread micro-cache
+     * and then in the global texture cache, which loads it from disk if
+     * necessary.
+     */
+    void fetch(uint32_t level, uint32_t x, uint32_t y, float *out) const;
+
+    /// Copy a tile from the file (used by \ref TextureCache)
+    void read_tile(uint32_t level, uint32_t index, float *out) const;
+
+    /// Return the size of a tile in bytes
+    size_t tile_bytes() const {
+        return sizeof(float) * m_channel_count << (2 * m_tile_shift);
+    }
+
+    /// Return a string representation
+    std::string to_string() const override;
+
+    MTS_DECLARE_CLASS()
+protected:
+    friend class TextureCache;
+
+    /// Open a tiled texture file, throws if it is invalid
+    TiledTexture(const fs::path &filename, uint64_t key, uint32_t id);
+
+    /// Release all resources
+    virtual ~TiledTexture();
+
+    struct Level {
+        uint32_t width, height;
+        uint32_t tiles_x, tiles_y;
+        size_t offset;
+    };
+
+    fs::path m_filename;
+    ref<MemoryMappedFile> m_mmap;
+    std::vector<Level> m_levels;
+    uint32_t m_channel_count;
+    uint32_t m_tile_shift;
+    uint32_t m_id;
+    float m_mean;
+};
+
+/**
+ * \brief Global cache of tiled, MIP-mapped textures with a bounded memory
+ * footprint
+ *
+ * Large texture sets (e.g. hundreds of high-resolution UDIM tiles) often don't
+ * fit into memory alongside the scene geometry. This class converts textures
+ * into a tiled MIP map representation on disk (\ref write()), loads individual
+ * tiles on demand, and evicts the least recently used tiles once the total
+ * size of all resident tiles exceeds a global memory budget.
+ *
+ * Tile lookups first consult a small per-thread micro-cache, hence the lock
+ * protecting the shared tile table is only acquired upon a micro-cache miss.
+ * Disk I/O happens outside of this lock.
+ */
+class MTS_EXPORT_CORE TextureCache : public Object {
+public:
+    /// Return the global texture cache
+    static TextureCache *instance() { return m_instance; }
+
+    /**
+     * \brief Open a tiled texture file
+     *
+     * Returns \c nullptr when the file does not exist, or when it is stale,
+     * i.e. it was created with a different \c key.
+     */
+    ref<TiledTexture> open(const fs::path &filename, uint64_t key);
+
+    /**
+     * \brief Convert a bitmap into a tiled MIP map file
+     *
+     * \param bitmap
+     *     Source image using a \c Float32 component format
+     *
+     * \param filename
+     *     Target path. The file is first written to a temporary location and
+     *     then moved into place, so that concurrent readers never observe a
+     *     partially written file.
+     *
+     * \param key
+     *     User-specified key that is checked by \ref open()
+     *
+     * \param mean
+     *     Average value of the texture, returned by \ref TiledTexture::mean()
+     */
+    static void write(const Bitmap *bitmap, const fs::path &filename,
+                      uint64_t key, float mean, uint32_t tile_size = 64);
+
+    /// Return a tile, loading it from disk (used by \ref TiledTexture)
+    std::shared_ptr<const float> tile(const TiledTexture *texture,
+                                      uint32_t level, uint32_t index);
+
+    /// Set the maximum amount of memory used by resident tiles (in bytes)
+    void set_max_memory(size_t size);
+
+    /// Return the maximum amount of memory used by resident tiles (in bytes)
+    size_t max_memory() const;
+
+    /// Return the amount of memory currently used by resident tiles (in bytes)
+    size_t memory_usage() const;
+
+    /// Evict all resident tiles
+    void clear();
+
+    /// Return a string representation including cache statistics
+    std::string to_string() const override;
+
+    MTS_DECLARE_CLASS()
+protected:
+    TextureCache();
+    virtual ~TextureCache();
+
+    /// Evict tiles until the memory budget is respected (lock must be held)
+    void evict();
+
+protected:
+    struct TextureCachePrivate;
+    std::unique_ptr<TextureCachePrivate> d;
+    static ref<TextureCache> m_instance;
+};
+
+NAMESPACE_END(mitsuba)
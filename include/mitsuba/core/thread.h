@@ -2,6 +2,7 @@
 
 #include <mitsuba/core/object.h>
 #include <memory>
+#include <vector>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -63,6 +64,27 @@ public:
     /// Return the core affinity
     int core_affinity() const;
 
+    /**
+     * \brief Restrict the thread to the processor cores of a NUMA node
+     *
+     * See \ref numa_nodes() for the list of nodes. The value -1 removes the
+     * restriction. Only supported on Linux.
+     */
+    void set_numa_node(int node);
+
+    /// Return the NUMA node that the thread is restricted to (or -1)
+    int numa_node() const;
+
+    /**
+     * \brief Return the (logical) processor cores of every NUMA node that
+     * are available to this process
+     *
+     * The topology is read from <tt>/sys/devices/system/node</tt> on Linux.
+     * On other platforms and on machines without NUMA support, a single node
+     * holding all cores is returned.
+     */
+    static const std::vector<std::vector<int>> &numa_nodes();
+
     /**
      * \brief Specify whether or not this thread is critical
      *
@@ -37,6 +37,9 @@ extern MTS_EXPORT_CORE void trap_debugger();
 /// Return the absolute path to <tt>libmitsuba-core.dylib/so/dll<tt>
 extern MTS_EXPORT_CORE fs::path library_path();
 
+/// Return the peak resident set size of the process in bytes (0 if unknown)
+extern MTS_EXPORT_CORE uint64_t peak_memory_usage();
+
 /// Determine the width of the terminal window that is used to run Mitsuba
 extern MTS_EXPORT_CORE int terminal_width();
 
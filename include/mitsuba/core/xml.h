@@ -1,6 +1,8 @@
 #pragma once
 
 #include <mitsuba/mitsuba.h>
+#include <mitsuba/core/filesystem.h>
+#include <mitsuba/core/properties.h>
 #include <string>
 #include <vector>
 
@@ -29,17 +31,52 @@ using ParameterList = std::vector<std::pair<std::string, std::string>>;
  * \param update_scene
  *     When Mitsuba updates scene to a newer version, should the
  *     updated XML file be written back to disk?
+ *
+ * \param cache_dir
+ *     Optional directory holding binary snapshots of parsed scene
+ *     descriptions. The snapshot contains the resolved properties of all
+ *     objects (after expanding includes and substituting parameters) and is
+ *     keyed by the scene path, variant, parameters and search paths. It is
+ *     used in place of the XML parse as long as none of the files that were
+ *     read while parsing changed their size or modification time.
  */
 extern MTS_EXPORT_CORE ref<Object> load_file(const fs::path &path,
                                              const std::string &variant,
                                              ParameterList parameters = ParameterList(),
-                                             bool update_scene = false);
+                                             bool update_scene = false,
+                                             const fs::path &cache_dir = fs::path());
 
 /// Load a Mitsuba scene from an XML string
 extern MTS_EXPORT_CORE ref<Object> load_string(const std::string &string,
                                                const std::string &variant,
                                                ParameterList parameters = ParameterList());
 
+/**
+ * \brief Create a set of objects from their properties
+ *
+ * This function gives other scene front-ends (e.g. \c load_dict() in Python)
+ * access to the instantiation stage of \ref load_file(): objects are created
+ * by parallel tasks as soon as all objects they reference exist.
+ *
+ * \param objects
+ *     Identifiers and properties of the objects. References to other objects
+ *     of the list are named references to their identifiers (see \ref
+ *     Properties::set_named_reference()). The plugin name \c "scene" denotes
+ *     a scene.
+ *
+ * \param root
+ *     Identifier of the returned object. Objects that it doesn't (directly or
+ *     indirectly) reference are not created.
+ *
+ * \param variant
+ *     Specifies the variant of plugins to instantiate (e.g. "scalar_rgb")
+ *
+ * \param source
+ *     Name of the scene description used in error messages
+ */
+extern MTS_EXPORT_CORE ref<Object> load_properties(
+    std::vector<std::pair<std::string, Properties>> objects, const std::string &root,
+    const std::string &variant, const std::string &source = "<properties>");
 
 
 NAMESPACE_BEGIN(detail)
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <mitsuba/core/stream.h>
+#include <vector>
 
 extern "C" {
     struct z_stream_s;
@@ -19,6 +20,12 @@ NAMESPACE_END(detail)
  *
  * This class transparently decompresses and compresses reads and writes
  * to a nested stream, respectively.
+ *
+ * When a nonzero \c parallel_block_size is specified, writes are instead
+ * buffered and compressed as independent blocks of that size on multiple
+ * threads (in the style of \c pigz). Each block is primed with the preceding
+ * 32 KiB of data, and the blocks are joined into a single regular deflate or
+ * gzip stream that can be read back by any \c ZStream.
  */
 class MTS_EXPORT_CORE ZStream : public Stream {
 public:
@@ -34,9 +41,12 @@ public:
     /** \brief Creates a new compression stream with the given underlying stream.
      * This new instance takes ownership of the child stream. The child stream
      * must outlive the ZStream.
+     *
+     * \param parallel_block_size
+     *     When nonzero, compress writes in parallel using blocks of this size
      */
     ZStream(Stream *child_stream, EStreamType stream_type = EDeflateStream,
-            int level = -1);
+            int level = -1, size_t parallel_block_size = 0);
 
     /// Returns a string representation
     std::string to_string() const override;
@@ -62,6 +72,9 @@ public:
     /// Returns the child stream of this compression stream
     Stream *child_stream() { return m_child_stream; }
 
+    /// Return the block size used for parallel compression (0 if disabled)
+    size_t parallel_block_size() const { return m_block_size; }
+
     //! @}
     // =========================================================================
 
@@ -126,12 +139,78 @@ protected:
     /// Protected destructor
     virtual ~ZStream();
 
+private:
+    /**
+     * \brief Compress buffered data on multiple threads
+     *
+     * Only complete blocks are processed unless \c partial is set. When
+     * \c finish is set, the final block and the stream trailer are written.
+     */
+    void deflate_pending(bool partial, bool finish);
+
 private:
     ref<Stream> m_child_stream;
     std::unique_ptr<z_stream> m_deflate_stream, m_inflate_stream;
     uint8_t m_deflate_buffer[detail::kZStreamBufferSize];
     uint8_t m_inflate_buffer[detail::kZStreamBufferSize];
     bool m_did_write;
+
+    // State of the parallel compression mode
+    EStreamType m_stream_type;
+    int m_level;
+    size_t m_block_size;
+    std::vector<uint8_t> m_pending, m_window;
+    uint32_t m_checksum;
+    uint64_t m_total_in;
+    bool m_header_written;
 };
 
+NAMESPACE_BEGIN(compression)
+
+/// Codecs supported by the block compression container
+enum class Codec : uint32_t {
+    /// Uncompressed blocks
+    Stored = 0,
+
+    /// Blocks compressed using \c zlib
+    Deflate = 1
+};
+
+/**
+ * \brief Write a buffer as a sequence of independently compressed blocks
+ *
+ * Unlike \ref ZStream, the resulting container can be decompressed in
+ * parallel. It consists of a small header (codec, block count, uncompressed
+ * size, block size) followed by the compressed size of every block and the
+ * block contents. The blocks are compressed in parallel.
+ *
+ * \param stream
+ *     Stream receiving the container
+ * \param data
+ *     Pointer to the data that should be compressed
+ * \param size
+ *     Size of the data in bytes
+ * \param codec
+ *     Compression codec used for every block
+ * \param block_size
+ *     Uncompressed size of every block except for the last one
+ * \param level
+ *     Compression level (-1 selects the codec's default)
+ */
+extern MTS_EXPORT_CORE void write_blocks(Stream *stream, const void *data, size_t size,
+                                         Codec codec = Codec::Deflate,
+                                         size_t block_size = 1024 * 1024,
+                                         int level = -1);
+
+/**
+ * \brief Read a container created by \ref write_blocks() and decompress it
+ * in parallel
+ *
+ * Returns a seekable memory stream holding the uncompressed contents. It
+ * uses the byte order of \c stream.
+ */
+extern MTS_EXPORT_CORE ref<Stream> read_blocks(Stream *stream);
+
+NAMESPACE_END(compression)
+
 NAMESPACE_END(mitsuba)
@@ -459,6 +459,16 @@ static const char *__doc_mitsuba_BSDFSample3_wo = R"doc(Normalized outgoing dire
 
 static const char *__doc_mitsuba_BSDF_BSDF = R"doc(//! @})doc";
 
+static const char *__doc_mitsuba_BSDF_alpha_mask =
+R"doc(Return a texture marking the perfectly transparent regions of the
+surface, where it evaluates to zero
+
+An intersection in such a region is equivalent to no intersection at
+all. The ray tracing backends use this to skip these intersections
+during traversal instead of returning them to the integrator, which
+would then have to continue the ray. The default implementation
+returns ``nullptr`` (no such regions).)doc";
+
 static const char *__doc_mitsuba_BSDF_class = R"doc()doc";
 
 static const char *__doc_mitsuba_BSDF_component_count = R"doc(Number of components this BSDF is comprised of.)doc";
@@ -500,6 +510,28 @@ Parameter ``si``:
     surface position. The incident direction is obtained from the
     field ``si.wi``.)doc";
 
+static const char *__doc_mitsuba_BSDF_eval_pdf =
+R"doc(Jointly evaluate the BSDF and the probability per unit solid angle of
+sampling a given direction
+
+This is equivalent to calling eval() and pdf(), but it only dispatches
+once over the BSDF pointers of a packet (vectorized variants), and
+allows implementations to share the work of both queries (e.g. the
+texture lookups and the microfacet distribution). The default
+implementation simply invokes both methods.
+
+Parameter ``ctx``:
+    A context data structure describing which lobes to evalute, and
+    whether radiance or importance are being transported.
+
+Parameter ``si``:
+    A surface interaction data structure describing the underlying
+    surface position. The incident direction is obtained from the
+    field ``si.wi``.
+
+Parameter ``wo``:
+    The outgoing direction)doc";
+
 static const char *__doc_mitsuba_BSDF_flags = R"doc(Flags for all components combined.)doc";
 
 static const char *__doc_mitsuba_BSDF_flags_2 = R"doc(Flags for a specific component of this BSDF.)doc";
@@ -668,6 +700,26 @@ static const char *__doc_mitsuba_Bitmap_Bitmap_4 = R"doc(Copy constructor (copie
 
 static const char *__doc_mitsuba_Bitmap_Bitmap_5 = R"doc(Move constructor)doc";
 
+static const char *__doc_mitsuba_Bitmap_EXRCompression = R"doc(Compression methods for writing OpenEXR files)doc";
+
+static const char *__doc_mitsuba_Bitmap_EXRCompression_DWAA = R"doc(Lossy DCT-based compression of blocks of 32 scanlines)doc";
+
+static const char *__doc_mitsuba_Bitmap_EXRCompression_DWAB = R"doc(Lossy DCT-based compression of blocks of 256 scanlines)doc";
+
+static const char *__doc_mitsuba_Bitmap_EXRCompression_Default =
+R"doc(Lossless PIZ compression, or lossy DWAB compression when a positive
+quality level is given (default))doc";
+
+static const char *__doc_mitsuba_Bitmap_EXRCompression_None = R"doc(No compression)doc";
+
+static const char *__doc_mitsuba_Bitmap_EXRCompression_PIZ = R"doc(Wavelet compression (lossless, good for noisy images))doc";
+
+static const char *__doc_mitsuba_Bitmap_EXRCompression_RLE = R"doc(Run-length encoding (lossless, fast but weak))doc";
+
+static const char *__doc_mitsuba_Bitmap_EXRCompression_ZIP = R"doc(Zlib compression of blocks of 16 scanlines (lossless))doc";
+
+static const char *__doc_mitsuba_Bitmap_EXRCompression_ZIPS = R"doc(Zlib compression of individual scanlines (lossless))doc";
+
 static const char *__doc_mitsuba_Bitmap_FileFormat = R"doc(Supported image file formats)doc";
 
 static const char *__doc_mitsuba_Bitmap_FileFormat_Auto =
@@ -753,6 +805,19 @@ The following is supported:
 
 * Loading of uncompressed 8-bit RGB/RGBA files)doc";
 
+static const char *__doc_mitsuba_Bitmap_FileFormat_Tensor =
+R"doc(Mitsuba tensor file format (see TensorFile)
+
+The following is supported:
+
+* Loading of a field named ``data`` (or of the only field) with shape
+``[height, width]`` or ``[height, width, channels]`` and any component
+format
+
+* Saving of all bitmaps (as a field named ``data``)
+
+* Memory-mapped loading without copies, see memory_mapped())doc";
+
 static const char *__doc_mitsuba_Bitmap_FileFormat_Unknown = R"doc(Unknown file format)doc";
 
 static const char *__doc_mitsuba_Bitmap_PixelFormat =
@@ -776,6 +841,8 @@ static const char *__doc_mitsuba_Bitmap_PixelFormat_Y = R"doc(Single-channel lum
 
 static const char *__doc_mitsuba_Bitmap_PixelFormat_YA = R"doc(Two-channel luminance + alpha bitmap)doc";
 
+static const char *__doc_mitsuba_Bitmap_account_memory = R"doc(Account the pixel storage as texture memory)doc";
+
 static const char *__doc_mitsuba_Bitmap_accumulate =
 R"doc(Accumulate the contents of another bitmap into the region with the
 specified offset
@@ -886,6 +953,8 @@ static const char *__doc_mitsuba_Bitmap_m_data = R"doc()doc";
 
 static const char *__doc_mitsuba_Bitmap_m_metadata = R"doc()doc";
 
+static const char *__doc_mitsuba_Bitmap_m_mmap = R"doc()doc";
+
 static const char *__doc_mitsuba_Bitmap_m_owns_data = R"doc()doc";
 
 static const char *__doc_mitsuba_Bitmap_m_pixel_format = R"doc()doc";
@@ -898,6 +967,22 @@ static const char *__doc_mitsuba_Bitmap_m_srgb_gamma = R"doc()doc";
 
 static const char *__doc_mitsuba_Bitmap_m_struct = R"doc()doc";
 
+static const char *__doc_mitsuba_Bitmap_map_data =
+R"doc(When loading from a memory-mapped file, reference the next ``size``
+bytes of ``stream`` instead of reading them
+
+Returns:
+    ``False`` if the data must be read (e.g. for other streams))doc";
+
+static const char *__doc_mitsuba_Bitmap_memory_mapped =
+R"doc(Does the bitmap reference the memory-mapped contents of the file it
+was loaded from?
+
+Uncompressed PPM and tensor files loaded via Bitmap(const fs::path &,
+FileFormat) are mapped with copy-on-write semantics instead of being
+read into memory, which lets processes loading the same file share its
+pages.)doc";
+
 static const char *__doc_mitsuba_Bitmap_metadata = R"doc(Return a Properties object containing the image metadata)doc";
 
 static const char *__doc_mitsuba_Bitmap_metadata_2 =
@@ -930,6 +1015,8 @@ static const char *__doc_mitsuba_Bitmap_read_ppm = R"doc(Read a file encoded usi
 
 static const char *__doc_mitsuba_Bitmap_read_rgbe = R"doc(Read a file encoded using the RGBE file format)doc";
 
+static const char *__doc_mitsuba_Bitmap_read_tensor = R"doc(Read a file encoded using the tensor file format)doc";
+
 static const char *__doc_mitsuba_Bitmap_read_tga = R"doc(Read a file encoded using the TGA file format)doc";
 
 static const char *__doc_mitsuba_Bitmap_rebuild_struct = R"doc(Rebuild the 'm_struct' field based on the pixel format etc.)doc";
@@ -1057,7 +1144,13 @@ default argument (-1) uses the highest quality (100).
 with higher values corresponding to a lower quality. A value of 45 is
 recommended as the default for lossy compression. The default argument
 (-1) causes the implementation to switch to the lossless PIZ
-compressor.)doc";
+compressor.
+
+Parameter ``compression``:
+    Compression method of OpenEXR images. When set to
+    EXRCompression::DWAA or EXRCompression::DWAB, ``quality``
+    specifies the compression level (45 when not specified). Ignored by
+    the other file formats.)doc";
 
 static const char *__doc_mitsuba_Bitmap_write_2 =
 R"doc(Write an encoded form of the bitmap to a file using the specified file
@@ -1085,7 +1178,13 @@ default argument (-1) uses the highest quality (100).
 with higher values corresponding to a lower quality. A value of 45 is
 recommended as the default for lossy compression. The default argument
 (-1) causes the implementation to switch to the lossless PIZ
-compressor.)doc";
+compressor.
+
+Parameter ``compression``:
+    Compression method of OpenEXR images. When set to
+    EXRCompression::DWAA or EXRCompression::DWAB, ``quality``
+    specifies the compression level (45 when not specified). Ignored by
+    the other file formats.)doc";
 
 static const char *__doc_mitsuba_Bitmap_write_async =
 R"doc(Equivalent to write(), but executes asynchronously on a different
@@ -1093,7 +1192,11 @@ thread)doc";
 
 static const char *__doc_mitsuba_Bitmap_write_jpeg = R"doc(Save a file using the JPEG file format)doc";
 
-static const char *__doc_mitsuba_Bitmap_write_openexr = R"doc(Write a file using the OpenEXR file format)doc";
+static const char *__doc_mitsuba_Bitmap_write_openexr =
+R"doc(Write a file using the OpenEXR file format
+
+When ``stream`` is ``nullptr``, OpenEXR writes directly to the file at
+``path``, which avoids the indirection through Stream.)doc";
 
 static const char *__doc_mitsuba_Bitmap_write_pfm = R"doc(Save a file using the PFM file format)doc";
 
@@ -1103,6 +1206,8 @@ static const char *__doc_mitsuba_Bitmap_write_ppm = R"doc(Save a file using the
 
 static const char *__doc_mitsuba_Bitmap_write_rgbe = R"doc(Save a file using the RGBE file format)doc";
 
+static const char *__doc_mitsuba_Bitmap_write_tensor = R"doc(Save a file using the tensor file format)doc";
+
 static const char *__doc_mitsuba_BoundingBox =
 R"doc(Generic n-dimensional bounding box data structure
 
@@ -1295,6 +1400,91 @@ static const char *__doc_mitsuba_BoundingSphere_radius = R"doc()doc";
 
 static const char *__doc_mitsuba_BoundingSphere_ray_intersect = R"doc(Check if a ray intersects a bounding box)doc";
 
+static const char *__doc_mitsuba_BufferedStream =
+R"doc(Read-ahead buffer around a nested stream
+
+Loaders often issue a large number of small read() calls (headers,
+individual elements, single characters when parsing text). When the
+nested stream is backed by a file on a network file system, each of
+these can turn into a separate request. This class instead fetches
+large contiguous chunks from the nested stream and serves small reads
+directly from memory. Reads that are larger than the buffer bypass it
+entirely.
+
+Seeking only updates the logical position; already buffered data is
+reused when the new position falls inside of it. Writes are passed
+through to the nested stream and invalidate the buffer.)doc";
+
+static const char *__doc_mitsuba_BufferedStream_BufferedStream =
+R"doc(Creates a new buffered stream with the given underlying stream. This
+new instance takes ownership of the child stream.
+
+Parameter ``buffer_size``:
+    Size of the read-ahead buffer in bytes)doc";
+
+static const char *__doc_mitsuba_BufferedStream_buffer_size = R"doc(Return the size of the read-ahead buffer in bytes)doc";
+
+static const char *__doc_mitsuba_BufferedStream_can_read = R"doc(Can we read from the stream?)doc";
+
+static const char *__doc_mitsuba_BufferedStream_can_write = R"doc(Can we write to the stream?)doc";
+
+static const char *__doc_mitsuba_BufferedStream_child_stream = R"doc(Returns the child stream of this buffered stream)doc";
+
+static const char *__doc_mitsuba_BufferedStream_child_stream_2 = R"doc(Returns the child stream of this buffered stream)doc";
+
+static const char *__doc_mitsuba_BufferedStream_class = R"doc()doc";
+
+static const char *__doc_mitsuba_BufferedStream_close =
+R"doc(Closes the stream and the underlying child stream. No further read or
+write operations are permitted.
+
+This function is idempotent. It is called automatically by the
+destructor.)doc";
+
+static const char *__doc_mitsuba_BufferedStream_fill = R"doc(Refill the buffer starting at the current position, returns the number of bytes)doc";
+
+static const char *__doc_mitsuba_BufferedStream_flush = R"doc(Flushes the child stream)doc";
+
+static const char *__doc_mitsuba_BufferedStream_is_closed = R"doc(Whether the stream is closed (no read or write are then permitted).)doc";
+
+static const char *__doc_mitsuba_BufferedStream_m_buffer = R"doc()doc";
+
+static const char *__doc_mitsuba_BufferedStream_m_buffer_fill = R"doc(Number of valid bytes in the buffer)doc";
+
+static const char *__doc_mitsuba_BufferedStream_m_buffer_size = R"doc()doc";
+
+static const char *__doc_mitsuba_BufferedStream_m_buffer_start = R"doc(Position of the first buffered byte within the child stream)doc";
+
+static const char *__doc_mitsuba_BufferedStream_m_child_stream = R"doc()doc";
+
+static const char *__doc_mitsuba_BufferedStream_m_pos = R"doc(Current (logical) position)doc";
+
+static const char *__doc_mitsuba_BufferedStream_read =
+R"doc(Reads a specified amount of data from the stream, refilling the read-
+ahead buffer when necessary. Throws an exception when the stream ended
+prematurely.)doc";
+
+static const char *__doc_mitsuba_BufferedStream_read_line = R"doc(Convenience function for reading a line of text from an ASCII file)doc";
+
+static const char *__doc_mitsuba_BufferedStream_seek =
+R"doc(Seeks to a position inside the stream. The child stream is only
+repositioned by the next operation that needs to access it.)doc";
+
+static const char *__doc_mitsuba_BufferedStream_size = R"doc(Returns the size of the child stream)doc";
+
+static const char *__doc_mitsuba_BufferedStream_sync_child = R"doc(Move the child stream to the current position if necessary)doc";
+
+static const char *__doc_mitsuba_BufferedStream_tell = R"doc(Gets the current position inside the stream)doc";
+
+static const char *__doc_mitsuba_BufferedStream_to_string = R"doc(Returns a string representation)doc";
+
+static const char *__doc_mitsuba_BufferedStream_truncate = R"doc(Truncates the child stream. Invalidates the read-ahead buffer.)doc";
+
+static const char *__doc_mitsuba_BufferedStream_write =
+R"doc(Writes a specified amount of data into the child stream at the
+current position. Invalidates the read-ahead buffer. Throws an
+exception when not all data could be written.)doc";
+
 static const char *__doc_mitsuba_Class =
 R"doc(Stores meta-information about Object instances.
 
@@ -1638,7 +1828,12 @@ and provides various routines for transforming uniformly distributed
 samples so that they follow the stored distribution. Note that
 unnormalized probability mass functions (PMFs) will automatically be
 normalized during initialization. The associated scale factor can be
-retrieved using the function normalization().)doc";
+retrieved using the function normalization().
+
+Samples are generated by inverting the CDF with a binary search by
+default. Large distributions can instead build an alias table (see
+set_alias_table()), which samples in constant time at the cost of no
+longer being monotonic in the sample value.)doc";
 
 static const char *__doc_mitsuba_DiscreteDistribution2D =
 R"doc(======================================================================
@@ -1721,6 +1916,8 @@ static const char *__doc_mitsuba_DiscreteDistribution2D_m_normalization = R"doc(
 
 static const char *__doc_mitsuba_DiscreteDistribution2D_m_size = R"doc(Resolution of the discretized density function)doc";
 
+static const char *__doc_mitsuba_DiscreteDistribution2D_memory_usage = R"doc(Return the size of the tables (in bytes))doc";
+
 static const char *__doc_mitsuba_DiscreteDistribution2D_pdf = R"doc(Evaluate the normalized function value at the given integer position)doc";
 
 static const char *__doc_mitsuba_DiscreteDistribution2D_sample =
@@ -1765,6 +1962,14 @@ static const char *__doc_mitsuba_DiscreteDistribution_eval_pmf_normalized =
 R"doc(Evaluate the normalized probability mass function (PMF) at index
 ``index``)doc";
 
+static const char *__doc_mitsuba_DiscreteDistribution_has_alias_table = R"doc(Does the distribution use an alias table? (see set_alias_table()))doc";
+
+static const char *__doc_mitsuba_DiscreteDistribution_m_alias_index = R"doc()doc";
+
+static const char *__doc_mitsuba_DiscreteDistribution_m_alias_prob = R"doc()doc";
+
+static const char *__doc_mitsuba_DiscreteDistribution_m_alias_table = R"doc(Alias table (see set_alias_table()))doc";
+
 static const char *__doc_mitsuba_DiscreteDistribution_m_cdf = R"doc()doc";
 
 static const char *__doc_mitsuba_DiscreteDistribution_m_normalization = R"doc()doc";
@@ -1832,6 +2037,15 @@ Returns:
 1. the discrete index associated with the sample 2. the re-scaled
 sample value 3. the normalized probability value of the sample)doc";
 
+static const char *__doc_mitsuba_DiscreteDistribution_set_alias_table =
+R"doc(Sample the distribution using an alias table?
+
+Building the table takes linear time, after which sample() and related
+functions take constant time instead of performing a binary search
+over the CDF. The sampled index is no longer monotonic in the sample
+value, which loses some of the stratification of the input samples.
+The table is rebuilt by update().)doc";
+
 static const char *__doc_mitsuba_DiscreteDistribution_size = R"doc(Return the number of entries)doc";
 
 static const char *__doc_mitsuba_DiscreteDistribution_sum = R"doc(Return the original sum of PMF entries before normalization)doc";
@@ -1944,6 +2158,44 @@ static const char *__doc_mitsuba_Emitter_is_environment = R"doc(Is this an envir
 
 static const char *__doc_mitsuba_Emitter_m_flags = R"doc(Combined flags for all properties of this emitter.)doc";
 
+static const char *__doc_mitsuba_Emitter_m_selection_pmf = R"doc(Probability of selecting this emitter when sampling the scene's emitters)doc";
+
+static const char *__doc_mitsuba_Emitter_pdf_direction_lobe =
+R"doc(Evaluate the density of sample_direction_lobe() for the given lobe
+
+The default implementation ignores the lobe and calls pdf_direction().)doc";
+
+static const char *__doc_mitsuba_Emitter_power =
+R"doc(Return an estimate of the total power emitted by this emitter
+
+The value is averaged over the spectrum and only needs to be accurate
+up to a constant factor shared by all emitters: it is used by Scene to
+select emitters proportionally to their power. Infinite emitters
+report the power that enters the bounding sphere of the scene.)doc";
+
+static const char *__doc_mitsuba_Emitter_sample_direction_lobe =
+R"doc(Direction sampling with a lobe of the reference point
+
+Like sample_direction(), but the emitter may additionally importance
+sample the product of its emission and the lobe ``max(0, dot(d,
+lobe_axis))^lobe_exponent`` (e.g. the cosine foreshortening or a
+glossy BSDF lobe at the reference point). Lanes with ``lobe_exponent
+== 0`` ignore the lobe.
+
+The density of the samples is given by pdf_direction_lobe(), which
+must be called with the same lobe. The default implementation ignores
+the lobe and calls sample_direction().
+
+Parameter ``lobe_axis``:
+    Normalized axis of the lobe in world space
+
+Parameter ``lobe_exponent``:
+    Exponent of the lobe (``1`` for the cosine foreshortening))doc";
+
+static const char *__doc_mitsuba_Emitter_selection_pmf = R"doc(Probability of selecting this emitter in Scene::sample_emitter_direction())doc";
+
+static const char *__doc_mitsuba_Emitter_set_selection_pmf = R"doc(Set the emitter selection probability (used by Scene))doc";
+
 static const char *__doc_mitsuba_Endpoint =
 R"doc(Endpoint: an abstract interface to light sources and sensors
 
@@ -2052,6 +2304,26 @@ implemented by the sample_direction() method.
 Parameter ``ds``:
     A direct sampling record, which specifies the query location.)doc";
 
+static const char *__doc_mitsuba_Endpoint_pdf_ray =
+R"doc(Evaluate the densities of the ray sampling method implemented by the
+sample_ray() method.
+
+This is e.g. needed by bidirectional techniques, which must know how
+likely the endpoint would have generated a given path segment.
+
+The default implementation throws an exception.
+
+Parameter ``ps``:
+    The ray origin on the endpoint
+
+Parameter ``d``:
+    The (normalized) direction of the ray
+
+Returns:
+    The density of the ray origin per unit area (1 for endpoints at a
+    single point in space) and the density of the direction per unit
+    solid angle.)doc";
+
 static const char *__doc_mitsuba_Endpoint_sample_direction =
 R"doc(Given a reference point in the scene, sample a direction from the
 reference point towards the endpoint (ideally proportional to the
@@ -2142,7 +2414,14 @@ R"doc(Simple class for resolving paths on Linux/Windows/Mac OS
 
 This convenience class looks for a file or directory given its name
 and a set of search paths. The implementation walks through the search
-paths in order and stops once the file is found.)doc";
+paths in order and stops once the file is found.
+
+Each lookup queries the file system once per search path, which can be
+slow on network file systems. When caching is enabled (see
+set_cache_enabled()), the result of every resolve() call is memoized
+until the search path list changes or clear_cache() is called. The
+scene loader enables this on the resolver it uses while loading a
+scene.)doc";
 
 static const char *__doc_mitsuba_FileResolver_FileResolver = R"doc(Initialize a new file resolver with the current working directory)doc";
 
@@ -2156,10 +2435,14 @@ static const char *__doc_mitsuba_FileResolver_begin_2 =
 R"doc(Return an iterator at the beginning of the list of search paths
 (const))doc";
 
+static const char *__doc_mitsuba_FileResolver_cache_enabled = R"doc(Is the memoization of resolve() results enabled?)doc";
+
 static const char *__doc_mitsuba_FileResolver_class = R"doc()doc";
 
 static const char *__doc_mitsuba_FileResolver_clear = R"doc(Clear the list of search paths)doc";
 
+static const char *__doc_mitsuba_FileResolver_clear_cache = R"doc(Discard all memoized resolve() results)doc";
+
 static const char *__doc_mitsuba_FileResolver_contains = R"doc(Check if a given path is included in the search path list)doc";
 
 static const char *__doc_mitsuba_FileResolver_end = R"doc(Return an iterator at the end of the list of search paths)doc";
@@ -2170,6 +2453,12 @@ static const char *__doc_mitsuba_FileResolver_erase = R"doc(Erase the entry at t
 
 static const char *__doc_mitsuba_FileResolver_erase_2 = R"doc(Erase the search path from the list)doc";
 
+static const char *__doc_mitsuba_FileResolver_m_cache = R"doc()doc";
+
+static const char *__doc_mitsuba_FileResolver_m_cache_enabled = R"doc()doc";
+
+static const char *__doc_mitsuba_FileResolver_m_cache_mutex = R"doc()doc";
+
 static const char *__doc_mitsuba_FileResolver_m_paths = R"doc()doc";
 
 static const char *__doc_mitsuba_FileResolver_operator_array = R"doc(Return an entry from the list of search paths)doc";
@@ -2182,6 +2471,8 @@ static const char *__doc_mitsuba_FileResolver_resolve =
 R"doc(Walk through the list of search paths and try to resolve the input
 path)doc";
 
+static const char *__doc_mitsuba_FileResolver_set_cache_enabled = R"doc(Enable or disable the memoization of resolve() results)doc";
+
 static const char *__doc_mitsuba_FileResolver_size = R"doc(Return the number of search paths)doc";
 
 static const char *__doc_mitsuba_FileResolver_to_string = R"doc(Return a human-readable representation of this instance)doc";
@@ -2281,16 +2572,39 @@ static const char *__doc_mitsuba_Film_4 = R"doc()doc";
 
 static const char *__doc_mitsuba_Film_Film = R"doc(Create a film)doc";
 
+static const char *__doc_mitsuba_Film_add_id_layer =
+R"doc(Declare an ID layer (e.g. a Cryptomatte layer produced by the ``aov``
+integrator)
+
+The layer occupies the channels <tt>name00.R</tt>, <tt>name00.G</tt>,
+<tt>name00.B</tt>, <tt>name00.A</tt>, <tt>name01.R</tt>, etc., which
+store the per-pixel (ID, sample count) pairs and bypass the
+reconstruction filter (see ImageBlock::set_unfiltered_channels()).
+
+Parameter ``manifest``:
+    Cryptomatte manifest of the layer (a JSON object mapping the names
+    of the objects to their hexadecimal IDs), or an empty string.)doc";
+
 static const char *__doc_mitsuba_Film_bitmap = R"doc(Return a bitmap object storing the developed contents of the film)doc";
 
 static const char *__doc_mitsuba_Film_class = R"doc()doc";
 
+static const char *__doc_mitsuba_Film_configure_block =
+R"doc(Configure an image block that will be merged into the film
+
+Integrators call this for their blocks after prepare(), which lets the
+film request additional per-block state (e.g. the deep samples of
+``hdrfilm``, see ImageBlock::set_deep_samples()). The default
+implementation does nothing.)doc";
+
 static const char *__doc_mitsuba_Film_crop_offset = R"doc(Return the offset of the crop window)doc";
 
 static const char *__doc_mitsuba_Film_crop_size = R"doc(Return the size of the crop window)doc";
 
 static const char *__doc_mitsuba_Film_destination_exists = R"doc(Does the destination file already exist?)doc";
 
+static const char *__doc_mitsuba_Film_destination_file = R"doc(Return the target filename (empty if not known))doc";
+
 static const char *__doc_mitsuba_Film_develop =
 R"doc(Develop the film and write the result to the previously specified
 filename)doc";
@@ -2306,39 +2620,142 @@ image)
 Returns:
     ``True`` upon success)doc";
 
+static const char *__doc_mitsuba_Film_has_deferred_filter =
+R"doc(Is the reconstruction filter applied when developing the film, rather
+than when splatting the samples? In this case, image blocks accumulate
+per-pixel sample sums using the box filter returned by
+sample_filter(), which avoids overlapping blocks.)doc";
+
 static const char *__doc_mitsuba_Film_has_high_quality_edges =
 R"doc(Should regions slightly outside the image plane be sampled to improve
 the quality of the reconstruction at the edges? This only makes sense
 when reconstruction filters other than the box filter are used.)doc";
 
+static const char *__doc_mitsuba_Film_id_channels =
+R"doc(Return the (1-based) index of the ID layer that each of the given
+channels belongs to, or zero for other channels
+
+An empty vector is returned when none of the channels belong to an ID
+layer.)doc";
+
+static const char *__doc_mitsuba_Film_id_layers = R"doc(Return the ID layers and their manifests, see add_id_layer())doc";
+
+static const char *__doc_mitsuba_Film_m_box_filter = R"doc(Box filter used to accumulate samples when ``m_deferred_filter`` is set)doc";
+
 static const char *__doc_mitsuba_Film_m_crop_offset = R"doc()doc";
 
 static const char *__doc_mitsuba_Film_m_crop_size = R"doc()doc";
 
+static const char *__doc_mitsuba_Film_m_deferred_filter = R"doc()doc";
+
 static const char *__doc_mitsuba_Film_m_filter = R"doc()doc";
 
 static const char *__doc_mitsuba_Film_m_high_quality_edges = R"doc()doc";
 
+static const char *__doc_mitsuba_Film_m_id_layers = R"doc(Names and manifests of the ID layers)doc";
+
+static const char *__doc_mitsuba_Film_m_metadata = R"doc(R"doc(Metadata of the developed images (see metadata()))doc")doc";
+
 static const char *__doc_mitsuba_Film_m_size = R"doc()doc";
 
+static const char *__doc_mitsuba_Film_m_splats = R"doc(Per-thread splat blocks (see splat_block()))doc";
+
+static const char *__doc_mitsuba_Film_m_unfiltered_aovs = R"doc(Names of the AOVs that bypass the reconstruction filter)doc";
+
+static const char *__doc_mitsuba_Film_merge_splats =
+R"doc(Accumulate the splat blocks of all threads into the film and clear
+them
+
+This is called by the integrator at the end of every rendering pass
+and must not be called while other threads are splatting.)doc";
+
+static const char *__doc_mitsuba_Film_m_priority_map = R"doc(Priorities of the regions of the film (see set_priority_map()))doc";
+
+static const char *__doc_mitsuba_Film_m_priority_mutex = R"doc()doc";
+
+static const char *__doc_mitsuba_Film_metadata =
+R"doc(R"doc(Return the metadata that is stored in the developed images
+
+Integrators use this to record information about the render, e.g. the
+final sample count of a render that stopped early.)doc")doc";
+
+static const char *__doc_mitsuba_Film_metadata_2 =
+R"doc(R"doc(Return the metadata that is stored in the developed images (const
+version))doc")doc";
+
 static const char *__doc_mitsuba_Film_prepare = R"doc(Configure the film for rendering a specified set of channels)doc";
 
+static const char *__doc_mitsuba_Film_priority_map = R"doc(Return the priority map (see set_priority_map()), or ``nullptr``)doc";
+
 static const char *__doc_mitsuba_Film_put =
 R"doc(Merge an image block into the film. This methods should be thread-
 safe.)doc";
 
 static const char *__doc_mitsuba_Film_reconstruction_filter = R"doc(Return the image reconstruction filter (const version))doc";
 
+static const char *__doc_mitsuba_Film_restore = R"doc(Replace the film contents by a bitmap returned by snapshot())doc";
+
+static const char *__doc_mitsuba_Film_sample_filter =
+R"doc(Return the filter that should be used to splat samples into image
+blocks that are then passed to put()
+
+This is the reconstruction filter, or a box filter when the film
+defers the reconstruction to the development (see
+has_deferred_filter()).)doc";
+
 static const char *__doc_mitsuba_Film_set_crop_window = R"doc(Set the size and offset of the crop window.)doc";
 
 static const char *__doc_mitsuba_Film_set_destination_file = R"doc(Set the target filename (with or without extension))doc";
 
+static const char *__doc_mitsuba_Film_set_priority_map =
+R"doc(Set a map that prioritizes regions of the film while rendering
+
+The map is a bitmap of arbitrary resolution (e.g. a coarse mask around
+the cursor of a viewer) that is stretched over the full film, and whose
+first channel specifies the priority of every region. Sampling
+integrators that start rendering while a map is set render their
+passes one after the other, and hand out the blocks of each pass by
+decreasing priority (see Spiral::set_priority_map()). The map can be
+replaced while rendering, the new order then takes effect in the next
+pass. Passing ``nullptr`` restores the spiral order.)doc";
+
 static const char *__doc_mitsuba_Film_size =
 R"doc(Ignoring the crop window, return the resolution of the underlying
 sensor)doc";
 
+static const char *__doc_mitsuba_Film_snapshot =
+R"doc(Return a copy of the accumulated (i.e. unnormalized and, in the case
+of a deferred filter, unfiltered) film contents
+
+Together with restore(), this allows to checkpoint a render. It should
+not be called while image blocks are being merged into the film. The
+default implementation throws an exception.)doc";
+
+static const char *__doc_mitsuba_Film_splat_block =
+R"doc(Return the calling thread's block for samples that can land anywhere
+on the film (e.g. light tracing contributions, see
+ImageBlock::splat())
+
+Each thread accumulates its splats into a separate block covering the
+crop window, which avoids any synchronization between the threads.
+The block is created upon the first call and added to the film by
+merge_splats(). Splats are only supported by films without AOV
+channels.)doc";
+
 static const char *__doc_mitsuba_Film_to_string = R"doc(//! @})doc";
 
+static const char *__doc_mitsuba_Film_unfiltered_channels =
+R"doc(Return which of the given channels bypass the reconstruction filter
+
+These are the channels of the AOVs listed in the film's
+``unfiltered_aovs`` parameter and of the ID layers (see
+add_id_layer()), which are accumulated into the pixel containing each
+sample (see ImageBlock::set_unfiltered_channels()), as
+well as the channel ``W.unfiltered`` counting their samples.
+Integrators append the latter to the channels passed to prepare() when
+the mask is not empty. An empty mask is returned when none of the
+channels belong to an unfiltered AOV.)doc";
+
 static const char *__doc_mitsuba_FilterBoundaryCondition =
 R"doc(When resampling data to a different resolution using
 Resampler::resample(), this enumeration specifies how lookups
@@ -2580,6 +2997,8 @@ static const char *__doc_mitsuba_Hierarchical2D_m_levels = R"doc(MIP hierarchy o
 
 static const char *__doc_mitsuba_Hierarchical2D_m_max_patch_index = R"doc(Number of bilinear patches in the X/Y dimension - 1)doc";
 
+static const char *__doc_mitsuba_Hierarchical2D_memory_usage = R"doc(Return the size of the MIP hierarchy (in bytes))doc";
+
 static const char *__doc_mitsuba_Hierarchical2D_sample =
 R"doc(Given a uniformly distributed 2D sample, draw a sample from the
 distribution (parameterized by ``param`` if applicable)
@@ -2602,6 +3021,12 @@ static const char *__doc_mitsuba_HitComputeFlags_AllNonDifferentiable =
 R"doc(Compute all fields of the surface interaction data structure in a non
 differentiable way)doc";
 
+static const char *__doc_mitsuba_HitComputeFlags_Connection =
+R"doc(Compute the fields needed to evaluate emitters and null transmission
+at an intersection that does not continue the path (e.g. along shadow
+connections). The shading frame is built around the shading normal
+without position partials.)doc";
+
 static const char *__doc_mitsuba_HitComputeFlags_Minimal = R"doc(Compute position and geometric normal)doc";
 
 static const char *__doc_mitsuba_HitComputeFlags_NonDifferentiable = R"doc(Force computed fields to not be be differentiable)doc";
@@ -2675,6 +3100,8 @@ Parameter ``normalize``:
     will eventually be divided by the accumulated sample weight to
     remove any non-uniformity.)doc";
 
+static const char *__doc_mitsuba_ImageBlock_account_memory = R"doc(Account the pixel buffer as film memory)doc";
+
 static const char *__doc_mitsuba_ImageBlock_border_size = R"doc(Return the border region used by the reconstruction filter)doc";
 
 static const char *__doc_mitsuba_ImageBlock_channel_count = R"doc(Return the number of channels stored by the image block)doc";
@@ -2687,6 +3114,19 @@ static const char *__doc_mitsuba_ImageBlock_data = R"doc(Return the underlying p
 
 static const char *__doc_mitsuba_ImageBlock_data_2 = R"doc(Return the underlying pixel buffer (const version))doc";
 
+static const char *__doc_mitsuba_ImageBlock_deep_pixel =
+R"doc(Return the deep samples of a pixel (in the coordinates of data(), i.e.
+including the border)
+
+The first value is the number of samples of the pixel. It is followed
+by deep_samples() records consisting of the depth, the sample count,
+and the accumulated XYZ and alpha values. The used records are sorted
+by depth and precede the unused ones, which have a zero count.)doc";
+
+static const char *__doc_mitsuba_ImageBlock_deep_samples = R"doc(Return the maximum number of deep samples per pixel (see set_deep_samples()))doc";
+
+static const char *__doc_mitsuba_ImageBlock_has_unfiltered_channels = R"doc(Are some of the channels excluded from the reconstruction filter?)doc";
+
 static const char *__doc_mitsuba_ImageBlock_height = R"doc(Return the bitmap's height in pixels)doc";
 
 static const char *__doc_mitsuba_ImageBlock_m_border_size = R"doc()doc";
@@ -2697,12 +3137,26 @@ static const char *__doc_mitsuba_ImageBlock_m_data = R"doc()doc";
 
 static const char *__doc_mitsuba_ImageBlock_m_filter = R"doc()doc";
 
+static const char *__doc_mitsuba_ImageBlock_m_filtered_ranges = R"doc(Ranges of consecutive filtered / unfiltered channels (see set_unfiltered_channels()))doc";
+
+static const char *__doc_mitsuba_ImageBlock_m_deep = R"doc(Deep samples of every pixel (see set_deep_samples() and deep_pixel()))doc";
+
+static const char *__doc_mitsuba_ImageBlock_m_deep_merge_tolerance = R"doc()doc";
+
+static const char *__doc_mitsuba_ImageBlock_m_deep_samples = R"doc()doc";
+
+static const char *__doc_mitsuba_ImageBlock_m_depth_channel = R"doc()doc";
+
+static const char *__doc_mitsuba_ImageBlock_m_id_ranges = R"doc(Channel ranges of the ID layers (see set_unfiltered_channels()))doc";
+
 static const char *__doc_mitsuba_ImageBlock_m_normalize = R"doc()doc";
 
 static const char *__doc_mitsuba_ImageBlock_m_offset = R"doc()doc";
 
 static const char *__doc_mitsuba_ImageBlock_m_size = R"doc()doc";
 
+static const char *__doc_mitsuba_ImageBlock_m_unfiltered_ranges = R"doc()doc";
+
 static const char *__doc_mitsuba_ImageBlock_m_warn_invalid = R"doc()doc";
 
 static const char *__doc_mitsuba_ImageBlock_m_warn_negative = R"doc()doc";
@@ -2769,18 +3223,114 @@ instance.)doc";
 
 static const char *__doc_mitsuba_ImageBlock_set_size = R"doc(Set the block size. This potentially destroys the block's content.)doc";
 
+static const char *__doc_mitsuba_ImageBlock_set_unfiltered_channels =
+R"doc(Exclude channels from the reconstruction filter
+
+The flagged channels are accumulated into the pixel containing the
+sample with unit weight, rather than over the footprint of the filter.
+This is cheaper and avoids blending values that should not be
+interpolated across edges (e.g. depth). The last channel must be
+flagged and receive unit values: it counts the samples of every pixel,
+which is used to normalize the unfiltered channels.
+
+An empty mask (the default) filters all channels.
+
+Parameter ``id_layers``:
+    Optionally assigns unfiltered channels to ID layers (e.g. for
+    Cryptomatte), where each run of consecutive channels with the same
+    nonzero layer number forms a layer. Instead of being summed, such
+    a layer stores a per-pixel list of (ID, weight) pairs in its
+    channels: a sample passes the ID in the first channel of the layer
+    and its weight in the second one (the remaining values are
+    ignored), and its weight is added to the pair with the same ID.
+    Samples of new IDs are dropped once all pairs are in use. Only
+    supported in scalar variants.)doc";
+
+static const char *__doc_mitsuba_ImageBlock_set_deep_samples =
+R"doc(Additionally record a bounded, depth-sorted list of samples in every
+pixel (i.e. a deep image)
+
+Each sample passed to put() is also recorded in the pixel containing
+it, along with its depth taken from channel ``depth_channel``. A
+record accumulates the XYZ and alpha values of the samples falling
+into its depth bin, i.e. whose depths differ from its (average) depth
+by at most a fraction ``merge_tolerance`` of the larger one. Once all
+``max_samples`` records of a pixel are in use, the two records with
+the smallest relative separation are merged. Samples with zero alpha
+(that didn't hit a surface) are only counted. Merging blocks via
+put(const ImageBlock *) merges their records in the same way.
+
+A value of zero for ``max_samples`` (the default) disables the deep
+samples. Only supported in scalar variants.)doc";
+
 static const char *__doc_mitsuba_ImageBlock_set_warn_invalid = R"doc(Warn when writing invalid (NaN, +/- infinity) sample values?)doc";
 
 static const char *__doc_mitsuba_ImageBlock_set_warn_negative = R"doc(Warn when writing negative sample values?)doc";
 
+static const char *__doc_mitsuba_ImageBlock_set_wavefront_layout =
+R"doc(Declare that the samples passed to put() form a wavefront in pixel
+order (GPU variants)
+
+With a nonzero ``spp``, a call to put() whose samples cover all pixels
+of the block in scanline order, with ``spp`` consecutive samples per
+pixel inside that pixel (as generated by the wavefront rendering loop),
+computes the value of every pixel by gathering the samples of its
+neighbors. This avoids the atomic scatter operations into the footprint
+of every sample, which collide heavily when many samples contribute to
+the same pixels. Calls with other sample counts, normalized blocks and
+footprints exceeding ``max_gathers`` samples per pixel use the regular
+implementation. A value of zero (the default) disables this.)doc";
+
+static const char *__doc_mitsuba_ImageBlock_set_wavefront_tile_size =
+R"doc(Order the pixels of the wavefront layout in square tiles
+
+With a nonzero ``tile_size``, the wavefront visits the tiles of the
+block in scanline order and the pixels of each tile in scanline order
+(tiles at the right and bottom edges are cropped). Neighboring lanes
+then trace rays from a compact region of the image, which improves the
+coherence of the traversal and texture lookups. Zero (the default)
+selects the scanline order of the whole block.)doc";
+
 static const char *__doc_mitsuba_ImageBlock_size = R"doc(Return the current block size)doc";
 
+static const char *__doc_mitsuba_ImageBlock_splat =
+R"doc(Accumulate a sample that was not generated by sampling the image
+plane (e.g. by tracing a path from an emitter)
+
+In contrast to put(), only the color channels are incremented, while
+the alpha and weight channels remain unchanged. Once the block is
+merged into a film, the splats are hence normalized by the weight of
+the regular samples, i.e. a pixel should receive splats whose sum
+equals its sample count times its value. Like put(), this method is
+not thread-safe, see Film::splat_block() for per-thread blocks that
+cover the entire film.
+
+\note This method is only valid if a reconstruction filter was given
+at the construction of the block.)doc";
+
 static const char *__doc_mitsuba_ImageBlock_to_string = R"doc(//! @})doc";
 
+static const char *__doc_mitsuba_ImageBlock_to_xyz = R"doc(Convert a sample value into the XYZ color space)doc";
+
 static const char *__doc_mitsuba_ImageBlock_warn_invalid = R"doc(Warn when writing invalid (NaN, +/- infinity) sample values?)doc";
 
 static const char *__doc_mitsuba_ImageBlock_warn_negative = R"doc(Warn when writing negative sample values?)doc";
 
+static const char *__doc_mitsuba_ImageBlock_wavefront_index = R"doc(Inverse of wavefront_pixel())doc";
+
+static const char *__doc_mitsuba_ImageBlock_wavefront_layout = R"doc(Return the samples per pixel of the wavefront layout (see set_wavefront_layout()))doc";
+
+static const char *__doc_mitsuba_ImageBlock_wavefront_pixel =
+R"doc(Return the pixel (relative to the block) of the given position in the
+wavefront layout, see set_wavefront_tile_size()
+
+``index`` counts pixels, i.e. it is the index of a sample divided by
+the number of samples per pixel.)doc";
+
+static const char *__doc_mitsuba_ImageBlock_wavefront_tile_size =
+R"doc(Return the tile size of the wavefront layout (see
+set_wavefront_tile_size()))doc";
+
 static const char *__doc_mitsuba_ImageBlock_width = R"doc(Return the bitmap's width in pixels)doc";
 
 static const char *__doc_mitsuba_Integrator =
@@ -2898,6 +3448,14 @@ R"doc(Evaluate the normalized probability mass function (PDF) at position
 
 static const char *__doc_mitsuba_IrregularContinuousDistribution_integral = R"doc(Return the original integral of PDF entries before normalization)doc";
 
+static const char *__doc_mitsuba_IrregularContinuousDistribution_has_alias_table = R"doc(Does the distribution use an alias table? (see set_alias_table()))doc";
+
+static const char *__doc_mitsuba_IrregularContinuousDistribution_m_alias_index = R"doc()doc";
+
+static const char *__doc_mitsuba_IrregularContinuousDistribution_m_alias_prob = R"doc()doc";
+
+static const char *__doc_mitsuba_IrregularContinuousDistribution_m_alias_table = R"doc(Alias table over the intervals (see set_alias_table()))doc";
+
 static const char *__doc_mitsuba_IrregularContinuousDistribution_m_cdf = R"doc()doc";
 
 static const char *__doc_mitsuba_IrregularContinuousDistribution_m_integral = R"doc()doc";
@@ -2945,6 +3503,19 @@ Returns:
 1. the sampled position. 2. the normalized probability density of the
 sample.)doc";
 
+static const char *__doc_mitsuba_IrregularContinuousDistribution_sample_interval =
+R"doc(Select the interval containing a sample
+
+Replaces ``value`` by the unnormalized integral of the density from
+the start of the interval to the sampled position.)doc";
+
+static const char *__doc_mitsuba_IrregularContinuousDistribution_set_alias_table =
+R"doc(Select the interval of a sample using an alias table?
+
+This replaces the binary search over the CDF of the intervals by a
+constant-time lookup, see DiscreteDistribution::set_alias_table(). The
+table is rebuilt by update().)doc";
+
 static const char *__doc_mitsuba_IrregularContinuousDistribution_size = R"doc(Return the number of discretizations)doc";
 
 static const char *__doc_mitsuba_IrregularContinuousDistribution_update =
@@ -2972,6 +3543,76 @@ time. If not, the application is terminated via ``abort()``.)doc";
 
 static const char *__doc_mitsuba_Jit_static_shutdown = R"doc(Release all memory used by JIT-compiled routines)doc";
 
+static const char *__doc_mitsuba_LoadRecord = R"doc(Timings and sizes of the creation of one scene object, see LoadTrace)doc";
+
+static const char *__doc_mitsuba_LoadRecord_bytes_read = R"doc(Size of the file that was read (in bytes))doc";
+
+static const char *__doc_mitsuba_LoadRecord_class_name = R"doc(Plugin name and class name (e.g. "ply" and "Shape") of the object)doc";
+
+static const char *__doc_mitsuba_LoadRecord_decoded_bytes = R"doc(Host and device memory owned by the object, excluding referenced objects (in bytes))doc";
+
+static const char *__doc_mitsuba_LoadRecord_end = R"doc(Return the end of the creation relative to the enabling of the trace)doc";
+
+static const char *__doc_mitsuba_LoadRecord_filename = R"doc(Resolved path of the file loaded by the object (if any))doc";
+
+static const char *__doc_mitsuba_LoadRecord_id = R"doc(Identifier of the object (``id`` attribute, or a generated name))doc";
+
+static const char *__doc_mitsuba_LoadRecord_load = R"doc(Index of the scene load (see LoadTrace::begin_load()))doc";
+
+static const char *__doc_mitsuba_LoadRecord_plugin = R"doc(Plugin name and class name (e.g. "ply" and "Shape") of the object)doc";
+
+static const char *__doc_mitsuba_LoadRecord_prefetch_time = R"doc(Wall time spent by the prefetch stage reading or decoding the file (in milliseconds))doc";
+
+static const char *__doc_mitsuba_LoadRecord_references = R"doc(Identifiers of the objects referenced by this object)doc";
+
+static const char *__doc_mitsuba_LoadRecord_start = R"doc(Start of the creation relative to the enabling of the trace (in milliseconds))doc";
+
+static const char *__doc_mitsuba_LoadRecord_thread = R"doc(Name of the thread that created the object)doc";
+
+static const char *__doc_mitsuba_LoadRecord_time = R"doc(Wall time spent creating the object (in milliseconds))doc";
+
+static const char *__doc_mitsuba_LoadTrace =
+R"doc(Optional trace of the objects that are created while loading scenes
+
+The profiler only distinguishes aggregate phases such as geometry and
+texture loading, which doesn't reveal which of thousands of objects slowed
+down the initialization of a scene. When the trace is enabled, the scene
+loader records the wall time, the file size, the decoded size and the
+thread of every object it creates, together with the references between
+objects. This makes it possible to reconstruct the critical path of the
+parallel object creation, i.e. the chain of dependent objects that
+determines the total load time.)doc";
+
+static const char *__doc_mitsuba_LoadTrace_LoadTrace = R"doc()doc";
+
+static const char *__doc_mitsuba_LoadTrace_add = R"doc(Add a record (used by the scene loader))doc";
+
+static const char *__doc_mitsuba_LoadTrace_begin_load = R"doc(Start a new scene load and return its index (used by the scene loader))doc";
+
+static const char *__doc_mitsuba_LoadTrace_class = R"doc()doc";
+
+static const char *__doc_mitsuba_LoadTrace_clear = R"doc(Discard all records)doc";
+
+static const char *__doc_mitsuba_LoadTrace_critical_path =
+R"doc(Return the critical path of the last scene load
+
+Starting from the object that finished last, the path repeatedly
+follows the referenced object that finished last, until reaching an
+object without references. The records are returned in the order in
+which the objects were created.)doc";
+
+static const char *__doc_mitsuba_LoadTrace_enabled = R"doc(Is the trace being recorded?)doc";
+
+static const char *__doc_mitsuba_LoadTrace_print_report = R"doc(Print the ``count`` slowest objects and the critical path of the last load)doc";
+
+static const char *__doc_mitsuba_LoadTrace_records = R"doc(Return all records, sorted by their start time)doc";
+
+static const char *__doc_mitsuba_LoadTrace_set_enabled = R"doc(Enable or disable the trace (enabling it also discards all records))doc";
+
+static const char *__doc_mitsuba_LoadTrace_time = R"doc(Convert a time point into milliseconds since the trace was enabled)doc";
+
+static const char *__doc_mitsuba_LoadTrace_write_json = R"doc(Write all records and the critical path of the last load to a JSON file)doc";
+
 static const char *__doc_mitsuba_LogLevel = R"doc(Available Log message types)doc";
 
 static const char *__doc_mitsuba_LogLevel_Debug = R"doc(< Debug message, usually turned off)doc";
@@ -3003,6 +3644,8 @@ static const char *__doc_mitsuba_Logger_appender_2 = R"doc(Return one of the app
 
 static const char *__doc_mitsuba_Logger_appender_count = R"doc(Return the number of registered appenders)doc";
 
+static const char *__doc_mitsuba_Logger_asynchronous = R"doc(Return whether asynchronous logging is enabled)doc";
+
 static const char *__doc_mitsuba_Logger_class = R"doc()doc";
 
 static const char *__doc_mitsuba_Logger_clear_appenders = R"doc(Remove all appenders from this logger)doc";
@@ -3011,6 +3654,8 @@ static const char *__doc_mitsuba_Logger_d = R"doc()doc";
 
 static const char *__doc_mitsuba_Logger_error_level = R"doc(Return the current error level)doc";
 
+static const char *__doc_mitsuba_Logger_flush = R"doc(Deliver all messages that are queued in asynchronous mode)doc";
+
 static const char *__doc_mitsuba_Logger_formatter = R"doc(Return the logger's formatter implementation)doc";
 
 static const char *__doc_mitsuba_Logger_formatter_2 = R"doc(Return the logger's formatter implementation (const))doc";
@@ -3067,6 +3712,15 @@ Throws a runtime exception upon failure)doc";
 
 static const char *__doc_mitsuba_Logger_remove_appender = R"doc(Remove an appender from this logger)doc";
 
+static const char *__doc_mitsuba_Logger_set_asynchronous =
+R"doc(Enable or disable asynchronous logging
+
+When enabled, log and progress messages are formatted by the calling
+thread and then pushed onto a lock-free queue, which is handed to the
+appenders by a background thread. This prevents rendering threads from
+stalling on slow output streams. Disabling asynchronous mode (and
+destructing the logger) delivers all pending messages.)doc";
+
 static const char *__doc_mitsuba_Logger_set_error_level =
 R"doc(Set the error log level (this level and anything above will throw
 exceptions).
@@ -3167,6 +3821,8 @@ static const char *__doc_mitsuba_Marginal2D_m_normalized = R"doc(Are the probabi
 
 static const char *__doc_mitsuba_Marginal2D_m_size = R"doc(Resolution of the discretized density function)doc";
 
+static const char *__doc_mitsuba_Marginal2D_memory_usage = R"doc(Return the size of the density and CDF tables (in bytes))doc";
+
 static const char *__doc_mitsuba_Marginal2D_sample =
 R"doc(Given a uniformly distributed 2D sample, draw a sample from the
 distribution (parameterized by ``param`` if applicable)
@@ -3288,6 +3944,38 @@ static const char *__doc_mitsuba_Medium_operator_new_4 = R"doc()doc";
 
 static const char *__doc_mitsuba_Medium_phase_function = R"doc(Return the phase function of this medium)doc";
 
+static const char *__doc_mitsuba_Medium_sample_distance =
+R"doc(Sample a tentative free-flight distance against the majorant
+
+This function is used by sample_interaction() and can be overridden by
+media with a spatially varying majorant. The default implementation
+samples an exponential distribution based on the majorant returned by
+get_combined_extinction().
+
+Parameter ``mi``:
+    Medium interaction specifying the time and wavelengths
+
+Parameter ``ray``:
+    Ray, along which a distance should be sampled
+
+Parameter ``mint``:
+    Start of the ray segment within the medium
+
+Parameter ``maxt``:
+    End of the ray segment within the medium
+
+Parameter ``sample``:
+    A uniformly distributed random sample
+
+Parameter ``channel``:
+    The channel according to which we will sample the free-flight
+    distance (RGB modes only).
+
+Returns:
+    A pair containing the sampled distance, which exceeds ``maxt``
+    when no interaction occurs on the segment, and the majorant at
+    this location.)doc";
+
 static const char *__doc_mitsuba_Medium_sample_interaction =
 R"doc(Sample a free-flight distance in the medium.
 
@@ -3315,6 +4003,24 @@ static const char *__doc_mitsuba_Medium_to_string = R"doc(Return a human-readabl
 
 static const char *__doc_mitsuba_Medium_use_emitter_sampling = R"doc(Returns whether this specific medium instance uses emitter sampling)doc";
 
+static const char *__doc_mitsuba_MemoryCategory = R"doc(Subsystems distinguished by MemoryReport)doc";
+
+static const char *__doc_mitsuba_MemoryCategory_Acceleration = R"doc(Ray tracing acceleration data structures)doc";
+
+static const char *__doc_mitsuba_MemoryCategory_Count = R"doc(Number of categories)doc";
+
+static const char *__doc_mitsuba_MemoryCategory_Distributions = R"doc(Tabulated distributions used for importance sampling)doc";
+
+static const char *__doc_mitsuba_MemoryCategory_Film = R"doc(Accumulation buffers of films)doc";
+
+static const char *__doc_mitsuba_MemoryCategory_Geometry = R"doc(Vertices, faces and attributes of meshes)doc";
+
+static const char *__doc_mitsuba_MemoryCategory_Other = R"doc(Anything else)doc";
+
+static const char *__doc_mitsuba_MemoryCategory_Textures = R"doc(Bitmaps and texel data of textures)doc";
+
+static const char *__doc_mitsuba_MemoryCategory_Volumes = R"doc(Volumetric grids)doc";
+
 static const char *__doc_mitsuba_MemoryMappedFile =
 R"doc(Basic cross-platform abstraction for memory mapped files
 
@@ -3352,6 +4058,14 @@ static const char *__doc_mitsuba_MemoryMappedFile_data_2 = R"doc(Return a pointe
 
 static const char *__doc_mitsuba_MemoryMappedFile_filename = R"doc(Return the associated filename)doc";
 
+static const char *__doc_mitsuba_MemoryMappedFile_map_copy_on_write =
+R"doc(Map the specified file into memory with copy-on-write semantics
+
+The memory region can be modified, but changes are private to the
+process and never written back to the file. Until a page is modified,
+it is shared with all other processes that map the same file (via the
+page cache of the OS).)doc";
+
 static const char *__doc_mitsuba_MemoryMappedFile_resize =
 R"doc(Resize the memory-mapped file
 
@@ -3362,6 +4076,50 @@ static const char *__doc_mitsuba_MemoryMappedFile_size = R"doc(Return the size o
 
 static const char *__doc_mitsuba_MemoryMappedFile_to_string = R"doc(Return a string representation)doc";
 
+static const char *__doc_mitsuba_MemoryReport =
+R"doc(Summary of the memory used by a graph of objects
+
+The report is created by visiting the root of the graph (e.g. a
+scene), whose Object::account_memory() implementation records the
+storage it owns and visits the objects it references in turn. Objects
+that are referenced several times (e.g. a texture shared by several
+materials) are only accounted once.
+
+Memory is split into host and device memory: the storage of CUDA
+arrays counts as device memory.)doc";
+
+static const char *__doc_mitsuba_MemoryReport_MemoryReport = R"doc()doc";
+
+static const char *__doc_mitsuba_MemoryReport_add = R"doc(Record memory that is owned by the object that is currently visited)doc";
+
+static const char *__doc_mitsuba_MemoryReport_add_array = R"doc(Record the storage of an Enoki array (device memory in CUDA variants))doc";
+
+static const char *__doc_mitsuba_MemoryReport_class = R"doc()doc";
+
+static const char *__doc_mitsuba_MemoryReport_device = R"doc(Return the device memory of a category (in bytes))doc";
+
+static const char *__doc_mitsuba_MemoryReport_host = R"doc(Return the host memory of a category (in bytes))doc";
+
+static const char *__doc_mitsuba_MemoryReport_m_classes = R"doc(Total memory per class name (host + device))doc";
+
+static const char *__doc_mitsuba_MemoryReport_m_current = R"doc(Class of the object that is currently visited)doc";
+
+static const char *__doc_mitsuba_MemoryReport_m_device = R"doc()doc";
+
+static const char *__doc_mitsuba_MemoryReport_m_host = R"doc()doc";
+
+static const char *__doc_mitsuba_MemoryReport_m_visited = R"doc()doc";
+
+static const char *__doc_mitsuba_MemoryReport_object_count = R"doc(Return the number of objects that have been visited)doc";
+
+static const char *__doc_mitsuba_MemoryReport_to_string = R"doc(Return a summary listing the categories and the largest object types)doc";
+
+static const char *__doc_mitsuba_MemoryReport_total_device = R"doc(Return the device memory of all categories (in bytes))doc";
+
+static const char *__doc_mitsuba_MemoryReport_total_host = R"doc(Return the host memory of all categories (in bytes))doc";
+
+static const char *__doc_mitsuba_MemoryReport_visit = R"doc(Account an object and the objects it references, unless it was already visited)doc";
+
 static const char *__doc_mitsuba_MemoryStream =
 R"doc(Simple memory buffer-based stream with automatic memory management. It
 always has read & write capabilities.
@@ -3468,6 +4226,16 @@ static const char *__doc_mitsuba_Mesh_Mesh_3 = R"doc()doc";
 
 static const char *__doc_mitsuba_Mesh_MeshAttribute = R"doc()doc";
 
+static const char *__doc_mitsuba_Mesh_MeshAttributeFormat = R"doc(Storage formats of mesh attributes, see add_attribute())doc";
+
+static const char *__doc_mitsuba_Mesh_MeshAttributeFormat_Float16 = R"doc(Half precision values, packed in pairs into 32 bit words)doc";
+
+static const char *__doc_mitsuba_Mesh_MeshAttributeFormat_Float32 = R"doc(Single precision values (the default))doc";
+
+static const char *__doc_mitsuba_Mesh_MeshAttributeFormat_UInt32 = R"doc(Unsigned 32 bit integers (e.g. object or material IDs))doc";
+
+static const char *__doc_mitsuba_Mesh_MeshAttributeFormat_UNorm8 = R"doc(8 bit values mapped to the [0, 1] range, up to four per 32 bit word)doc";
+
 static const char *__doc_mitsuba_Mesh_MeshAttributeType = R"doc()doc";
 
 static const char *__doc_mitsuba_Mesh_MeshAttributeType_Face = R"doc()doc";
@@ -3476,14 +4244,42 @@ static const char *__doc_mitsuba_Mesh_MeshAttributeType_Vertex = R"doc()doc";
 
 static const char *__doc_mitsuba_Mesh_MeshAttribute_buf = R"doc()doc";
 
+static const char *__doc_mitsuba_Mesh_MeshAttribute_format = R"doc()doc";
+
+static const char *__doc_mitsuba_Mesh_MeshAttribute_packed = R"doc(Compact storage used instead of ``buf`` by the other formats)doc";
+
 static const char *__doc_mitsuba_Mesh_MeshAttribute_size = R"doc()doc";
 
 static const char *__doc_mitsuba_Mesh_MeshAttribute_type = R"doc()doc";
 
+static const char *__doc_mitsuba_Mesh_account_memory = R"doc()doc";
+
 static const char *__doc_mitsuba_Mesh_add_attribute = R"doc(Add an attribute buffer with the given ``name`` and ``dim``)doc";
 
+static const char *__doc_mitsuba_Mesh_add_attribute_2 =
+R"doc(Add an attribute stored in a compact ``format``
+
+The buffer holds attribute_words() 32 bit words per vertex or face;
+the values are decoded on the fly when the attribute is evaluated. In
+spectral variants, compact color attributes are expanded since they
+must store spectral upsampling coefficients.)doc";
+
+static const char *__doc_mitsuba_Mesh_add_keyframe =
+R"doc(Append a keyframe of world-space vertex positions (and optionally
+vertex normals) for deformation motion blur
+
+The current vertex positions form the first keyframe. The keyframes
+are spaced evenly over the time interval specified via
+set_motion_range(), and the mesh is linearly interpolated between
+them. All keyframes must share the topology of the mesh, and normals
+are only interpolated if they are provided for every keyframe.)doc";
+
 static const char *__doc_mitsuba_Mesh_attribute_buffer = R"doc(Return the mesh attribute associated with ``name``)doc";
 
+static const char *__doc_mitsuba_Mesh_attribute_values = R"doc(Return the values of the attribute ``name``, decoding compact formats)doc";
+
+static const char *__doc_mitsuba_Mesh_attribute_words = R"doc(Number of 32 bit words used per element by an attribute of the given format)doc";
+
 static const char *__doc_mitsuba_Mesh_barycentric_coordinates = R"doc()doc";
 
 static const char *__doc_mitsuba_Mesh_bbox = R"doc(//! @{ \name Shape interface implementation)doc";
@@ -3505,8 +4301,39 @@ R"doc(Build internal tables for sampling uniformly wrt. area.
 Computes the surface area and sets up ``m_area_pmf`` Thread-safe,
 since it uses a mutex.)doc";
 
+static const char *__doc_mitsuba_Mesh_build_radiance_pmf =
+R"doc(Sample faces proportionally to the integral of a texture over their UV
+footprint instead of proportionally to their surface area
+
+This is used by area emitters with spatially varying radiance. The
+weight of every face is its area times the average of the texture's
+sampling density (Texture::pdf_position()) at ``sample_count``
+stratified positions within the face. A small fraction of area-based
+sampling is mixed in, so that faces whose samples missed all emission
+remain reachable. Positions within a face are sampled uniformly.
+
+Pass ``nullptr`` to revert to sampling wrt. area. The distribution is
+rebuilt automatically when the vertex positions change.)doc";
+
 static const char *__doc_mitsuba_Mesh_class = R"doc()doc";
 
+static const char *__doc_mitsuba_Mesh_compress =
+R"doc(Convert the vertex and face data into a compact quantized
+representation
+
+Positions are quantized to 21 bits per axis relative to the bounding
+box, normals are stored using an octahedral encoding with 16 bits per
+component, and texture coordinates are stored as half precision
+values. Face indices are packed into 64 bit words when the mesh has at
+most 2^21 vertices. This reduces the vertex storage from 32 to 16
+bytes.
+
+All accessors (vertex_position(), vertex_normal(), ..) transparently
+decode the packed data. The full precision buffers are released, which
+means that the mesh can no longer be modified or exported afterwards.
+Compression is only supported by the native CPU ray tracing backend
+and is otherwise ignored with a warning.)doc";
+
 static const char *__doc_mitsuba_Mesh_compute_surface_interaction = R"doc()doc";
 
 static const char *__doc_mitsuba_Mesh_ensure_pmf_built = R"doc()doc";
@@ -3531,11 +4358,34 @@ static const char *__doc_mitsuba_Mesh_faces_buffer = R"doc(Return face indices b
 
 static const char *__doc_mitsuba_Mesh_faces_buffer_2 = R"doc(Const variant of faces_buffer.)doc";
 
+static const char *__doc_mitsuba_Mesh_gather_attribute = R"doc(Fetch and decode the value of an attribute at the given element)doc";
+
+static const char *__doc_mitsuba_Mesh_geometry_hash = R"doc(Return a hash of the vertex positions and face indices)doc";
+
+static const char *__doc_mitsuba_Mesh_has_attribute = R"doc(Does the mesh have an attribute with the given ``name``?)doc";
+
 static const char *__doc_mitsuba_Mesh_has_vertex_normals = R"doc(Does this mesh have per-vertex normals?)doc";
 
 static const char *__doc_mitsuba_Mesh_has_vertex_texcoords = R"doc(Does this mesh have per-vertex texture coordinates?)doc";
 
-static const char *__doc_mitsuba_Mesh_interpolate_attribute = R"doc()doc";
+static const char *__doc_mitsuba_Mesh_interpolate_attribute = R"doc()doc";
+
+static const char *__doc_mitsuba_Mesh_interpolate_keyframes = R"doc(Interpolate a per-vertex quantity between the keyframes surrounding ``time``)doc";
+
+static const char *__doc_mitsuba_Mesh_is_compressed = R"doc(Is the mesh stored in the compressed representation of compress()?)doc";
+
+static const char *__doc_mitsuba_Mesh_is_deforming = R"doc(Does this mesh deform over time, i.e. does it have more than one keyframe?)doc";
+
+static const char *__doc_mitsuba_Mesh_keyframe_count = R"doc(Return the number of position keyframes (1 for static meshes))doc";
+
+static const char *__doc_mitsuba_Mesh_load_keyframes =
+R"doc(Load the additional keyframes listed in the ``keyframes`` property of a
+mesh loader plugin
+
+Every keyframe is loaded by instantiating the same plugin with the
+``filename`` property replaced, so that it is subject to the same
+``to_world`` transformation. Must be called once the first keyframe
+has been loaded.)doc";
 
 static const char *__doc_mitsuba_Mesh_m_area_pmf = R"doc()doc";
 
@@ -3557,6 +4407,12 @@ static const char *__doc_mitsuba_Mesh_m_name = R"doc()doc";
 
 static const char *__doc_mitsuba_Mesh_m_parameterization = R"doc(Optional: used in eval_parameterization())doc";
 
+static const char *__doc_mitsuba_Mesh_m_radiance_pmf = R"doc(Optional: face distribution used instead, see build_radiance_pmf())doc";
+
+static const char *__doc_mitsuba_Mesh_m_radiance_sample_count = R"doc()doc";
+
+static const char *__doc_mitsuba_Mesh_m_radiance_texture = R"doc()doc";
+
 static const char *__doc_mitsuba_Mesh_m_vertex_count = R"doc()doc";
 
 static const char *__doc_mitsuba_Mesh_m_vertex_normals_buf = R"doc()doc";
@@ -3594,28 +4450,44 @@ Returns:
 
 static const char *__doc_mitsuba_Mesh_recompute_bbox = R"doc(Recompute the bounding box (e.g. after modifying the vertex positions))doc";
 
+static const char *__doc_mitsuba_Mesh_motion_range = R"doc(Return the time interval spanned by the keyframes)doc";
+
 static const char *__doc_mitsuba_Mesh_recompute_vertex_normals = R"doc(Compute smooth vertex normals and replace the current normal values)doc";
 
 static const char *__doc_mitsuba_Mesh_sample_position = R"doc()doc";
 
 static const char *__doc_mitsuba_Mesh_surface_area = R"doc()doc";
 
+static const char *__doc_mitsuba_Mesh_set_motion_range = R"doc(Set the time interval spanned by the keyframes (default: ``[0, 1]``))doc";
+
 static const char *__doc_mitsuba_Mesh_to_string = R"doc(Return a human-readable string representation of the shape contents.)doc";
 
 static const char *__doc_mitsuba_Mesh_traverse = R"doc(@})doc";
 
+static const char *__doc_mitsuba_Mesh_unpack_attribute = R"doc(Decode a compact attribute into a single precision buffer)doc";
+
 static const char *__doc_mitsuba_Mesh_vertex_count = R"doc(Return the total number of vertices)doc";
 
 static const char *__doc_mitsuba_Mesh_vertex_data_bytes = R"doc()doc";
 
 static const char *__doc_mitsuba_Mesh_vertex_normal = R"doc(Returns the normal direction of the vertex with index ``index``)doc";
 
+static const char *__doc_mitsuba_Mesh_vertex_normal_at = R"doc(Returns the (unnormalized) vertex normal at the given ``time``, see vertex_position_at())doc";
+
 static const char *__doc_mitsuba_Mesh_vertex_normals_buffer = R"doc(Return vertex normals buffer)doc";
 
 static const char *__doc_mitsuba_Mesh_vertex_normals_buffer_2 = R"doc(Const variant of vertex_normals_buffer.)doc";
 
 static const char *__doc_mitsuba_Mesh_vertex_position = R"doc(Returns the world-space position of the vertex with index ``index``)doc";
 
+static const char *__doc_mitsuba_Mesh_vertex_position_at =
+R"doc(Returns the world-space position of the vertex with index ``index``
+at the given ``time``
+
+For meshes without keyframes (see add_keyframe()), this is identical
+to vertex_position(). Otherwise, the position is linearly interpolated
+between the two keyframes surrounding ``time``.)doc";
+
 static const char *__doc_mitsuba_Mesh_vertex_positions_buffer = R"doc(Return vertex positions buffer)doc";
 
 static const char *__doc_mitsuba_Mesh_vertex_positions_buffer_2 = R"doc(Const variant of vertex_positions_buffer.)doc";
@@ -3854,6 +4726,20 @@ static const char *__doc_mitsuba_Object_Object = R"doc(Default constructor)doc";
 
 static const char *__doc_mitsuba_Object_Object_2 = R"doc(Copy constructor)doc";
 
+static const char *__doc_mitsuba_Object_account_memory =
+R"doc(Record the memory used by this object and the objects it references
+
+Implementations record the storage they own via MemoryReport::add()
+and forward the objects they reference to MemoryReport::visit(). This
+is e.g. used to summarize the memory footprint of a scene.
+
+Remark:
+    The default implementation visits the objects reported by
+    traverse().
+
+See also:
+    MemoryReport)doc";
+
 static const char *__doc_mitsuba_Object_class =
 R"doc(Return a Class instance containing run-time type information about
 this Object
@@ -3929,7 +4815,12 @@ See also:
 
 static const char *__doc_mitsuba_PCG32Sampler =
 R"doc(Interface for sampler plugins based on the PCG32 random number
-generator)doc";
+generator
+
+The generator is seeded again for every sample, based on the seed
+offset and the sample index. The random numbers of a sample hence
+don't depend on the number of values that were drawn by earlier
+samples, which makes it possible to seek() to any sample.)doc";
 
 static const char *__doc_mitsuba_PCG32Sampler_2 = R"doc()doc";
 
@@ -3939,12 +4830,20 @@ static const char *__doc_mitsuba_PCG32Sampler_4 = R"doc()doc";
 
 static const char *__doc_mitsuba_PCG32Sampler_PCG32Sampler = R"doc()doc";
 
+static const char *__doc_mitsuba_PCG32Sampler_advance = R"doc()doc";
+
 static const char *__doc_mitsuba_PCG32Sampler_class = R"doc()doc";
 
 static const char *__doc_mitsuba_PCG32Sampler_m_rng = R"doc()doc";
 
+static const char *__doc_mitsuba_PCG32Sampler_m_seed_value = R"doc(Seed value of the current sequence (base seed plus seed offset))doc";
+
 static const char *__doc_mitsuba_PCG32Sampler_seed = R"doc()doc";
 
+static const char *__doc_mitsuba_PCG32Sampler_seed_rng = R"doc(Seed m_rng for the current sample)doc";
+
+static const char *__doc_mitsuba_PCG32Sampler_seek = R"doc()doc";
+
 static const char *__doc_mitsuba_PhaseFunction = R"doc()doc";
 
 static const char *__doc_mitsuba_PhaseFunction_2 = R"doc()doc";
@@ -4106,12 +5005,23 @@ static const char *__doc_mitsuba_PluginManager_d = R"doc()doc";
 
 static const char *__doc_mitsuba_PluginManager_ensure_plugin_loaded = R"doc(Ensure that a plugin is loaded and ready)doc";
 
-static const char *__doc_mitsuba_PluginManager_get_plugin_class = R"doc(Return the class corresponding to a plugin for a specific variant)doc";
+static const char *__doc_mitsuba_PluginManager_get_plugin_class =
+R"doc(Return the class corresponding to a plugin for a specific variant
+(cached after the first lookup))doc";
 
 static const char *__doc_mitsuba_PluginManager_instance = R"doc(Return the global plugin manager)doc";
 
 static const char *__doc_mitsuba_PluginManager_loaded_plugins = R"doc(Return the list of loaded plugins)doc";
 
+static const char *__doc_mitsuba_PluginManager_preload_plugins =
+R"doc(Load a set of plugins ahead of time
+
+The XML loader calls this function with the plugins referenced by a
+scene before instantiating its objects in parallel, so that the tasks
+don't wait on each other while libraries are being loaded. Plugins
+that cannot be found are skipped here: the error is raised when the
+corresponding object is created.)doc";
+
 static const char *__doc_mitsuba_PluginManager_register_python_plugin = R"doc(Register a Python plugin)doc";
 
 static const char *__doc_mitsuba_Point = R"doc()doc";
@@ -4176,6 +5086,13 @@ static const char *__doc_mitsuba_PositionSample_p = R"doc(Sampled position)doc";
 
 static const char *__doc_mitsuba_PositionSample_pdf = R"doc(Probability density at the sample)doc";
 
+static const char *__doc_mitsuba_PositionSample_prim_index =
+R"doc(Optional: primitive index of the sampled position, e.g. the triangle
+ID (if applicable)
+
+Shapes whose sampling density varies between primitives (see
+Mesh::build_radiance_pmf()) use it to evaluate Shape::pdf_position().)doc";
+
 static const char *__doc_mitsuba_PositionSample_time = R"doc(Associated time value)doc";
 
 static const char *__doc_mitsuba_PositionSample_uv =
@@ -4327,6 +5244,8 @@ static const char *__doc_mitsuba_ProgressReporter_m_bar_size = R"doc()doc";
 
 static const char *__doc_mitsuba_ProgressReporter_m_bar_start = R"doc()doc";
 
+static const char *__doc_mitsuba_ProgressReporter_m_busy = R"doc()doc";
+
 static const char *__doc_mitsuba_ProgressReporter_m_label = R"doc()doc";
 
 static const char *__doc_mitsuba_ProgressReporter_m_last_progress = R"doc()doc";
@@ -4343,6 +5262,53 @@ static const char *__doc_mitsuba_ProgressReporter_update =
 R"doc(Update the progress to ``progress`` (which should be in the range [0,
 1]))doc";
 
+static const char *__doc_mitsuba_ProgressiveRenderer =
+R"doc(Progressive rendering of a loaded scene for interactive previews
+
+Every call to render_pass() renders the scene once more with the
+scene's sampling integrator (using the sample count of the sensor's
+sampler, which should be set to 1 for the fastest feedback) and a new
+sampler seed, and adds the result to a running average. Edits to the
+camera, materials or geometry that are applied through
+ParameterMap::update() (which invokes the objects'
+``parameters_changed()`` callbacks) do not require reloading the
+scene: afterwards, restart() discards the accumulated passes, while
+the scene and its acceleration data structure are reused.)doc";
+
+static const char *__doc_mitsuba_ProgressiveRenderer_ProgressiveRenderer =
+R"doc(Prepare the progressive rendering of a scene
+
+Parameter ``sensor``:
+    The sensor to render (by default, the first sensor of the scene))doc";
+
+static const char *__doc_mitsuba_ProgressiveRenderer_bitmap =
+R"doc(Return the running average of all passes since the last restart
+
+The bitmap is updated in place by render_pass(), so that a viewer can
+upload it without copying it first. Returns ``nullptr`` before the
+first pass.)doc";
+
+static const char *__doc_mitsuba_ProgressiveRenderer_class = R"doc()doc";
+
+static const char *__doc_mitsuba_ProgressiveRenderer_mutex = R"doc(Mutex that is held while render_pass() updates the bitmap)doc";
+
+static const char *__doc_mitsuba_ProgressiveRenderer_pass_count = R"doc(Return the number of passes accumulated since the last restart)doc";
+
+static const char *__doc_mitsuba_ProgressiveRenderer_render_pass =
+R"doc(Render one more pass and add it to the running average
+
+Returns:
+    ``False`` when the pass was canceled (e.g. by restart()) or
+    failed, in which case it is not accumulated.)doc";
+
+static const char *__doc_mitsuba_ProgressiveRenderer_restart =
+R"doc(Discard the accumulated passes
+
+This is cheap and should be called after every edit of the scene. A
+pass that is currently being rendered on another thread is canceled.)doc";
+
+static const char *__doc_mitsuba_ProgressiveRenderer_to_string = R"doc()doc";
+
 static const char *__doc_mitsuba_ProjectiveCamera =
 R"doc(Projective camera interface
 
@@ -4933,6 +5899,57 @@ static const char *__doc_mitsuba_Resampler_target_resolution = R"doc(Return the
 
 static const char *__doc_mitsuba_Resampler_to_string = R"doc(Return a human-readable summary)doc";
 
+static const char *__doc_mitsuba_ResourceCache =
+R"doc(Process-wide cache of resources that can be shared by plugin instances
+
+Scenes frequently reference the same file from many plugins, e.g. when
+every object of a material library has its own copy of a material.
+This class maps a key, which captures the source file (see
+file_key()) and all options that affect the loaded representation, to
+an object storing the result, so that identical resources are only
+loaded, converted and stored once.
+
+Entries are held weakly: the cache releases an object once it is no
+longer referenced anywhere else. Concurrent lookups of the same key
+(e.g. by the parallel scene loader) wait for a single invocation of
+the creation function, while lookups of other keys proceed
+independently.)doc";
+
+static const char *__doc_mitsuba_ResourceCache_ResourceCache = R"doc()doc";
+
+static const char *__doc_mitsuba_ResourceCache_ResourceCachePrivate = R"doc()doc";
+
+static const char *__doc_mitsuba_ResourceCache_class = R"doc()doc";
+
+static const char *__doc_mitsuba_ResourceCache_clear = R"doc(Release all resources (plugins that reference them are unaffected))doc";
+
+static const char *__doc_mitsuba_ResourceCache_d = R"doc()doc";
+
+static const char *__doc_mitsuba_ResourceCache_file_key =
+R"doc(Return a key identifying the current contents of a file
+
+The key consists of the absolute path, size and modification time of
+the file, hence modified files are loaded again.)doc";
+
+static const char *__doc_mitsuba_ResourceCache_get =
+R"doc(Look up the resource with the given key
+
+When the cache contains no such resource, ``create`` is invoked to
+produce it. Exceptions raised by ``create`` are propagated to the
+caller and leave the cache unchanged.)doc";
+
+static const char *__doc_mitsuba_ResourceCache_get_2 = R"doc(Typed convenience wrapper of get())doc";
+
+static const char *__doc_mitsuba_ResourceCache_instance = R"doc(Return the global resource cache)doc";
+
+static const char *__doc_mitsuba_ResourceCache_m_instance = R"doc()doc";
+
+static const char *__doc_mitsuba_ResourceCache_prune = R"doc(Release the resources that aren't referenced anymore (lock must be held))doc";
+
+static const char *__doc_mitsuba_ResourceCache_size = R"doc(Return the number of resources that are currently cached)doc";
+
+static const char *__doc_mitsuba_ResourceCache_to_string = R"doc(Return a string representation including cache statistics)doc";
+
 static const char *__doc_mitsuba_Sampler =
 R"doc(Base class of all sample generators.
 
@@ -4979,6 +5996,8 @@ static const char *__doc_mitsuba_Sampler_4 = R"doc()doc";
 
 static const char *__doc_mitsuba_Sampler_Sampler = R"doc()doc";
 
+static const char *__doc_mitsuba_Sampler_base_seed = R"doc(Return the base seed)doc";
+
 static const char *__doc_mitsuba_Sampler_advance =
 R"doc(Advance to the next sample.
 
@@ -5008,6 +6027,8 @@ static const char *__doc_mitsuba_Sampler_m_base_seed = R"doc(Base seed value)doc
 
 static const char *__doc_mitsuba_Sampler_m_dimension_index = R"doc(Index of the current dimension in the sample)doc";
 
+static const char *__doc_mitsuba_Sampler_m_pass_index = R"doc(Index of the current rendering pass)doc";
+
 static const char *__doc_mitsuba_Sampler_m_sample_count = R"doc(Number of samples per pixel)doc";
 
 static const char *__doc_mitsuba_Sampler_m_sample_index = R"doc(Index of the current sample in the sequence)doc";
@@ -5020,8 +6041,12 @@ static const char *__doc_mitsuba_Sampler_next_1d = R"doc(Retrieve the next compo
 
 static const char *__doc_mitsuba_Sampler_next_2d = R"doc(Retrieve the next two component values from the current sample)doc";
 
+static const char *__doc_mitsuba_Sampler_pass_index = R"doc(Return the index of the current rendering pass)doc";
+
 static const char *__doc_mitsuba_Sampler_sample_count = R"doc(Return the number of samples per pixel)doc";
 
+static const char *__doc_mitsuba_Sampler_sample_index = R"doc(Return the number of calls to advance() since the sampler was seeded)doc";
+
 static const char *__doc_mitsuba_Sampler_seed =
 R"doc(Deterministically seed the underlying RNG, if applicable.
 
@@ -5031,6 +6056,32 @@ the wavefront.)doc";
 
 static const char *__doc_mitsuba_Sampler_seeded = R"doc(Return whether the sampler was seeded)doc";
 
+static const char *__doc_mitsuba_Sampler_seek =
+R"doc(Position the sampler at sample ``sample_index`` of the sequence with
+the given seed offset
+
+This produces the same state as a call to seed() followed by
+``sample_index`` calls to advance(), but in constant time. A render
+can thus be resumed at an arbitrary sample of a pixel (e.g. from a
+checkpoint), and the samples of a pixel can be split across machines
+while reproducing the result of a single render. In wavefront modes,
+``sample_index`` counts the calls to advance(), i.e. the passes of
+``samples_per_wavefront`` samples.)doc";
+
+static const char *__doc_mitsuba_Sampler_set_base_seed =
+R"doc(Set the base seed, which is inherited by clones (the ``seed``
+parameter))doc";
+
+static const char *__doc_mitsuba_Sampler_set_pass_index = R"doc(Set the index of the current rendering pass (default is 0))doc";
+
+static const char *__doc_mitsuba_Sampler_set_pixel =
+R"doc(Inform the sampler about the pixel of the upcoming sample
+
+Called by the integrator before every sample. Samplers that correlate
+the samples of neighboring pixels (e.g. to distribute the error as
+blue noise in screen space) need this information, the default
+implementation ignores it.)doc";
+
 static const char *__doc_mitsuba_Sampler_set_samples_per_wavefront = R"doc(Set the number of samples per pass in wavefront modes (default is 1))doc";
 
 static const char *__doc_mitsuba_Sampler_wavefront_size = R"doc(Return the size of the wavefront (or 0, if not seeded))doc";
@@ -5060,6 +6111,18 @@ static const char *__doc_mitsuba_SamplingIntegrator_cancel = R"doc()doc";
 
 static const char *__doc_mitsuba_SamplingIntegrator_class = R"doc()doc";
 
+static const char *__doc_mitsuba_SamplingIntegrator_heatmap =
+R"doc(Return the render time heatmap of the last call to render()
+
+When the ``heatmap`` parameter is set, the CPU variants measure the wall
+time of every render_block() call and spread it evenly over the pixels
+of the block. The result is a single-channel image of the film's crop
+size holding the time (in milliseconds, summed over all passes) that
+was spent on each pixel. It is also written to ``heatmap_file`` (by
+default, the film's destination with the extension
+<tt>.heatmap.exr</tt>). Returns ``nullptr`` when no heatmap was
+recorded.)doc";
+
 static const char *__doc_mitsuba_SamplingIntegrator_m_block_size = R"doc(Size of (square) image blocks to render per core.)doc";
 
 static const char *__doc_mitsuba_SamplingIntegrator_m_hide_emitters = R"doc(Flag for disabling direct visibility of emitters)doc";
@@ -5144,16 +6207,33 @@ static const char *__doc_mitsuba_Scene_4 = R"doc()doc";
 
 static const char *__doc_mitsuba_Scene_Scene = R"doc(Instantiate a scene from a Properties object)doc";
 
+static const char *__doc_mitsuba_Scene_accel_account_memory_cpu = R"doc(Account the memory of the ray-intersection acceleration data structure)doc";
+
+static const char *__doc_mitsuba_Scene_accel_build_pending =
+R"doc(Build the pending acceleration data structures as a single job
+
+Collects the kd-trees of all shape groups that are reachable from the
+scene (directly, through instances, and as levels of detail) together
+with the top-level data structure ``top_level`` (if specified), whose
+cost is given by ``top_level_cost`` primitives. The builds are taken
+from a shared queue in the order of decreasing primitive count, so
+that the smaller ones fill up the threads while the large builds go
+through their sequential phases.)doc";
+
 static const char *__doc_mitsuba_Scene_accel_init_cpu = R"doc(Create the ray-intersection acceleration data structure)doc";
 
 static const char *__doc_mitsuba_Scene_accel_init_gpu = R"doc()doc";
 
-static const char *__doc_mitsuba_Scene_accel_parameters_changed_gpu = R"doc(Updates the ray-intersection acceleration data structure)doc";
+static const char *__doc_mitsuba_Scene_accel_parameters_changed_cpu = R"doc(Updates the ray-intersection acceleration data structure)doc";
+
+static const char *__doc_mitsuba_Scene_accel_parameters_changed_gpu = R"doc()doc";
 
 static const char *__doc_mitsuba_Scene_accel_release_cpu = R"doc(Release the ray-intersection acceleration data structure)doc";
 
 static const char *__doc_mitsuba_Scene_accel_release_gpu = R"doc()doc";
 
+static const char *__doc_mitsuba_Scene_account_memory = R"doc(Account the acceleration data structure and all children of the scene)doc";
+
 static const char *__doc_mitsuba_Scene_bbox = R"doc(Return a bounding box surrounding the scene)doc";
 
 static const char *__doc_mitsuba_Scene_class = R"doc()doc";
@@ -5164,6 +6244,13 @@ static const char *__doc_mitsuba_Scene_emitters_2 = R"doc(Return the list of emi
 
 static const char *__doc_mitsuba_Scene_environment = R"doc(Return the environment emitter (if any))doc";
 
+static const char *__doc_mitsuba_Scene_geometry_revision =
+R"doc(Return an identifier of the current geometry of the scene
+
+The identifier changes whenever the geometry is updated (see
+update_geometry()) and is unique among all scenes, which allows caches
+of ray intersections to detect that they are outdated.)doc";
+
 static const char *__doc_mitsuba_Scene_integrator = R"doc(Return the scene's integrator)doc";
 
 static const char *__doc_mitsuba_Scene_integrator_2 = R"doc(Return the scene's integrator)doc";
@@ -5174,18 +6261,38 @@ static const char *__doc_mitsuba_Scene_m_bbox = R"doc()doc";
 
 static const char *__doc_mitsuba_Scene_m_children = R"doc()doc";
 
+static const char *__doc_mitsuba_Scene_m_emitter_distr = R"doc(Power-proportional distribution over ``m_emitters`` (if enabled))doc";
+
+static const char *__doc_mitsuba_Scene_m_emitter_power_sampling = R"doc(Select emitters proportionally to their power?)doc";
+
 static const char *__doc_mitsuba_Scene_m_emitters = R"doc()doc";
 
 static const char *__doc_mitsuba_Scene_m_environment = R"doc()doc";
 
+static const char *__doc_mitsuba_Scene_m_geometry_revision = R"doc(Identifier of the current geometry (see geometry_revision()))doc";
+
 static const char *__doc_mitsuba_Scene_m_integrator = R"doc()doc";
 
+static const char *__doc_mitsuba_Scene_m_scattering_hit_flags = R"doc(Fields computed at the scattering vertices of paths (see scattering_hit_flags()))doc";
+
 static const char *__doc_mitsuba_Scene_m_sensors = R"doc()doc";
 
 static const char *__doc_mitsuba_Scene_m_shapes = R"doc()doc";
 
 static const char *__doc_mitsuba_Scene_m_shapes_grad_enabled = R"doc()doc";
 
+static const char *__doc_mitsuba_Scene_memory_report =
+R"doc(Summarize the memory used by the scene
+
+The report lists the host and device memory of the geometry, the
+acceleration data structure, textures, volumes, sampling distributions
+and films. Objects shared by several parts of the scene are only
+accounted once. The acceleration data structures of Embree and OptiX
+are managed by these libraries and are not included.
+
+The summary is also logged after loading when the scene is created
+with ``memory_report = true``.)doc";
+
 static const char *__doc_mitsuba_Scene_parameters_changed = R"doc(Update internal state following a parameter update)doc";
 
 static const char *__doc_mitsuba_Scene_pdf_emitter_direction =
@@ -5201,6 +6308,10 @@ Parameter ``ds``:
 Returns:
     The solid angle density expressed of the sample)doc";
 
+static const char *__doc_mitsuba_Scene_pdf_emitter_direction_lobe =
+R"doc(Evaluate the probability density of the
+sample_emitter_direction_lobe() technique for the given lobe)doc";
+
 static const char *__doc_mitsuba_Scene_ray_intersect =
 R"doc(Intersect a ray against all primitives stored in the scene and return
 information about the resulting surface interaction
@@ -5216,6 +6327,38 @@ Returns:
 
 static const char *__doc_mitsuba_Scene_ray_intersect_2 = R"doc()doc";
 
+static const char *__doc_mitsuba_Scene_ray_intersect_batch =
+R"doc(Intersect a large batch of rays given as contiguous arrays
+
+This function is meant for applications that use the scene as a
+general purpose ray casting engine (visibility analysis, LiDAR
+simulation, etc.). The rays are split into chunks that are traced in
+parallel on the TBB worker threads, and compact hit records are
+written into caller-provided buffers. It is only available in the
+scalar variants; the vectorized variants should instead pass wide
+arrays to ray_intersect(), which traces all rays at once.
+
+Parameter ``o``:
+    Array of ``count`` ray origins
+
+Parameter ``d``:
+    Array of ``count`` normalized ray directions
+
+Parameter ``t``:
+    Output array receiving the hit distances, or infinity for rays
+    that miss the scene
+
+Parameter ``shape_index``:
+    Optional output array receiving the index of the hit shape in
+    shapes(), or ``(uint32_t) -1`` for rays that miss the scene
+
+Parameter ``prim_index``:
+    Optional output array receiving the primitive index within the hit
+    shape
+
+Parameter ``uv``:
+    Optional output array receiving the UV coordinates of the hit)doc";
+
 static const char *__doc_mitsuba_Scene_ray_intersect_cpu = R"doc(Trace a ray)doc";
 
 static const char *__doc_mitsuba_Scene_ray_intersect_gpu = R"doc()doc";
@@ -5235,6 +6378,10 @@ static const char *__doc_mitsuba_Scene_ray_intersect_preliminary_cpu = R"doc(Tra
 
 static const char *__doc_mitsuba_Scene_ray_intersect_preliminary_gpu = R"doc()doc";
 
+static const char *__doc_mitsuba_Scene_ray_statistics =
+R"doc(Return the ray counts and throughput of the most recent call to
+SamplingIntegrator::render() on this scene)doc";
+
 static const char *__doc_mitsuba_Scene_ray_test =
 R"doc(Intersect a ray against all primitives stored in the scene and *only*
 determine whether or not there is an intersection.
@@ -5251,6 +6398,23 @@ Parameter ``ray``:
 Returns:
     ``True`` if an intersection was found)doc";
 
+static const char *__doc_mitsuba_Scene_ray_test_batch =
+R"doc(Perform ray_test() for a batch of independent rays
+
+This is equivalent to testing the rays one by one, but lets the
+acceleration data structure process them together. In the scalar
+variants, Embree traces the batch using its stream interface, which
+amortizes the per-query overhead and exploits coherence between rays
+(e.g. shadow rays towards the same emitter).
+
+Parameter ``rays``:
+    Array of ``count`` rays
+
+Parameter ``hit``:
+    Output array receiving ``True`` for every ray that is occluded)doc";
+
+static const char *__doc_mitsuba_Scene_ray_test_batch_cpu = R"doc(Trace a batch of shadow rays (scalar CPU variants))doc";
+
 static const char *__doc_mitsuba_Scene_ray_test_cpu = R"doc(Trace a shadow ray)doc";
 
 static const char *__doc_mitsuba_Scene_ray_test_gpu = R"doc()doc";
@@ -5265,6 +6429,10 @@ Ideally, the implementation should importance sample the product of
 the emission profile and the geometry term between the reference point
 and the position on the emitter.
 
+The emitter is either chosen uniformly, or proportionally to its
+estimated power (see Emitter::power()) when the scene was created with
+``emitter_sampling = "power"``.
+
 Parameter ``ref``:
     A reference point somewhere within the scene
 
@@ -5280,10 +6448,67 @@ Returns:
     Radiance received along the sampled ray divided by the sample
     probability.)doc";
 
+static const char *__doc_mitsuba_Scene_sample_emitter_direction_lobe =
+R"doc(Direct illumination sampling routine that additionally importance
+samples a lobe of the reference point
+
+Like sample_emitter_direction(), but the chosen emitter samples the
+product of its emission and the lobe ``max(0, dot(d,
+lobe_axis))^lobe_exponent`` when it supports this (see
+Emitter::sample_direction_lobe()). Lanes with ``lobe_exponent == 0``
+are equivalent to sample_emitter_direction().)doc";
+
+static const char *__doc_mitsuba_Scene_sample_emitter_index =
+R"doc(Choose an emitter based on ``sample``, which is rescaled to lie in
+``[0, 1)`` again. Returns its index and discrete probability.)doc";
+
+static const char *__doc_mitsuba_Scene_sample_emitter_ray =
+R"doc(Sample a ray leaving one of the emitters of the scene
+
+This is e.g. used to trace photons or light subpaths. The emitter is
+chosen in the same way as in sample_emitter_direction(), reusing
+``wavelength_sample``, after which Endpoint::sample_ray() is invoked on
+it.
+
+Parameter ``time``:
+    The scene time associated with the ray
+
+Parameter ``wavelength_sample``:
+    A uniformly distributed 1D value that is used to choose the emitter
+    and then to sample the wavelengths of the ray
+
+Parameter ``sample2``:
+    A uniformly distributed sample on the domain ``[0,1]^2``, which is
+    passed to the emitter's Endpoint::sample_ray()
+
+Parameter ``sample3``:
+    A uniformly distributed sample on the domain ``[0,1]^2``, which is
+    passed to the emitter's Endpoint::sample_ray()
+
+Returns:
+    The sampled ray and the emitted flux divided by the sample
+    probability (including the discrete probability of choosing the
+    emitter).)doc";
+
+static const char *__doc_mitsuba_Scene_scattering_hit_flags =
+R"doc(Return the fields of SurfaceInteraction that integrators need to
+compute at the scattering vertices of a path
+
+The position partials only orient the tangents of the shading frame,
+which just matters to anisotropic BSDFs (this includes bump and normal
+maps). Scenes without such BSDFs hence return
+HitComputeFlags::Connection, which keeps these fields and their
+computation out of the per-bounce interaction. Texture-space
+differentials require ray differentials, which integrators only track
+for the primary hit (see SamplingIntegrator::ray_intersect_primary()).
+Differentiable variants always return HitComputeFlags::All.)doc";
+
 static const char *__doc_mitsuba_Scene_sensors = R"doc(Return the list of sensors)doc";
 
 static const char *__doc_mitsuba_Scene_sensors_2 = R"doc(Return the list of sensors (const version))doc";
 
+static const char *__doc_mitsuba_Scene_set_ray_statistics = R"doc(Set the ray statistics (called by the integrator at the end of a render))doc";
+
 static const char *__doc_mitsuba_Scene_shapes = R"doc(Return the list of shapes)doc";
 
 static const char *__doc_mitsuba_Scene_shapes_2 = R"doc(Return the list of shapes)doc";
@@ -5294,6 +6519,24 @@ static const char *__doc_mitsuba_Scene_to_string = R"doc(Return a human-readable
 
 static const char *__doc_mitsuba_Scene_traverse = R"doc(Perform a custom traversal over the scene graph)doc";
 
+static const char *__doc_mitsuba_Scene_update_emitter_sampling = R"doc(Recompute the emitter selection probabilities)doc";
+
+static const char *__doc_mitsuba_Scene_update_geometry =
+R"doc(Update the ray-intersection acceleration data structure after the
+geometry of existing shapes changed
+
+This function should be called after modifying vertex positions (e.g.
+via Mesh::vertex_positions_buffer() followed by
+Mesh::parameters_changed()) or instance transforms. It is considerably
+cheaper than creating a new scene: the Embree and OptiX backends and
+the native BVH refit their existing hierarchies, and the native kd-tree
+is only rebuilt when the geometry actually changed.
+
+The number of primitives of each shape is expected to stay the same.
+Create a new scene when the topology changes.)doc";
+
+static const char *__doc_mitsuba_Scene_update_scattering_hit_flags = R"doc(Recompute m_scattering_hit_flags from the BSDFs of the shapes)doc";
+
 static const char *__doc_mitsuba_ScopedPhase = R"doc()doc";
 
 static const char *__doc_mitsuba_ScopedPhase_ScopedPhase = R"doc()doc";
@@ -5420,6 +6663,28 @@ This class provides core functionality for sampling positions on
 surfaces, computing ray intersections, and bounding shapes within ray
 intersection acceleration data structures.)doc";
 
+static const char *__doc_mitsuba_ShapeBVH_account_memory = R"doc(Account the nodes and indices (the shapes belong to the scene))doc";
+
+static const char *__doc_mitsuba_ShapeGroup_accel_build =
+R"doc(Build the kd-tree of the group
+
+The construction is deferred to the scene, which builds the trees of
+all of its groups together with the top-level data structure (see
+Scene::accel_build_pending()). Does nothing when the tree was already
+built, and when Embree is used.)doc";
+
+static const char *__doc_mitsuba_ShapeGroup_accel_ready = R"doc(Has the kd-tree of the group been built (always ``True`` with Embree)?)doc";
+
+static const char *__doc_mitsuba_ShapeGroup_account_memory = R"doc(Account the acceleration data structure and the shapes of the group)doc";
+
+static const char *__doc_mitsuba_ShapeGroup_lod = R"doc(Return the coarser level of detail with index ``i`` (starting at 0 for ``lod_1``))doc";
+
+static const char *__doc_mitsuba_ShapeGroup_m_nested_bsdf_flags = R"doc(Union of the flags of the nested BSDFs, see nested_bsdf_flags())doc";
+
+static const char *__doc_mitsuba_ShapeGroup_nested_bsdf_flags = R"doc(Return the union of the flags of the BSDFs of all shapes and levels of detail)doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_account_memory = R"doc(Account the nodes, indices and triangle packets (the shapes belong to the scene))doc";
+
 static const char *__doc_mitsuba_Shape_2 = R"doc()doc";
 
 static const char *__doc_mitsuba_Shape_3 = R"doc()doc";
@@ -5487,6 +6752,15 @@ static const char *__doc_mitsuba_Shape_Shape = R"doc(//! @})doc";
 
 static const char *__doc_mitsuba_Shape_Shape_2 = R"doc()doc";
 
+static const char *__doc_mitsuba_Shape_alpha_test =
+R"doc(Alpha test a tentative intersection with this shape
+
+Evaluates the alpha mask of the shape's BSDF at the intersection.
+
+Returns:
+    A mask that is ``False`` for the lanes where the intersection lies
+    in a perfectly transparent region and should be ignored)doc";
+
 static const char *__doc_mitsuba_Shape_bbox =
 R"doc(Return an axis aligned box that bounds all shape primitives (including
 any transformations that may have been applied to them))doc";
@@ -5539,6 +6813,14 @@ Parameter ``flags``:
 Returns:
     A data structure containing the detailed information)doc";
 
+static const char *__doc_mitsuba_Shape_dirty =
+R"doc(Has the geometry of this shape changed since the scene last updated its
+acceleration data structure?
+
+Set by the default implementation of parameters_changed(), which
+shapes only invoke when a geometric parameter was modified. Updates of
+e.g. the BSDF therefore do not cause a rebuild.)doc";
+
 static const char *__doc_mitsuba_Shape_effective_primitive_count =
 R"doc(Return the number of primitives (triangles, hairs, ..) contributed to
 the scene by this shape
@@ -5619,20 +6901,41 @@ static const char *__doc_mitsuba_Shape_exterior_medium = R"doc(Return the medium
 
 static const char *__doc_mitsuba_Shape_get_children_string = R"doc()doc";
 
+static const char *__doc_mitsuba_Shape_has_alpha_mask =
+R"doc(Should intersections with this shape be alpha tested during ray
+traversal? (see BSDF::alpha_mask())
+
+This is never the case for emitters, sensors and medium transitions,
+since the integrator must see every intersection with them.)doc";
+
 static const char *__doc_mitsuba_Shape_id = R"doc(Return a string identifier)doc";
 
+static const char *__doc_mitsuba_Shape_instanced_group = R"doc(Return the shape group referenced by an instance or instancer (``nullptr`` otherwise))doc";
+
+static const char *__doc_mitsuba_Shape_to_world = R"doc(Return the object-to-world transformation specified via ``to_world``)doc";
+
 static const char *__doc_mitsuba_Shape_interior_medium = R"doc(Return the medium that lies on the interior of this shape)doc";
 
 static const char *__doc_mitsuba_Shape_is_emitter = R"doc(Is this shape also an area emitter?)doc";
 
+static const char *__doc_mitsuba_Shape_is_instance = R"doc(Is this shape an instance?)doc";
+
+static const char *__doc_mitsuba_Shape_is_instancer = R"doc(Is this shape an instancer, i.e. a set of instances of a shape group?)doc";
+
 static const char *__doc_mitsuba_Shape_is_medium_transition = R"doc(Does the surface of this shape mark a medium transition?)doc";
 
 static const char *__doc_mitsuba_Shape_is_mesh = R"doc(Is this shape a triangle mesh?)doc";
 
+static const char *__doc_mitsuba_Shape_is_shapegroup = R"doc(Is this shape a shapegroup?)doc";
+
 static const char *__doc_mitsuba_Shape_is_sensor = R"doc(Is this shape also an area sensor?)doc";
 
+static const char *__doc_mitsuba_Shape_m_alpha_mask = R"doc(Alpha mask of the BSDF used to skip transparent intersections (if any))doc";
+
 static const char *__doc_mitsuba_Shape_m_bsdf = R"doc()doc";
 
+static const char *__doc_mitsuba_Shape_m_dirty = R"doc(Whether the geometry changed since the last acceleration data structure update)doc";
+
 static const char *__doc_mitsuba_Shape_m_emitter = R"doc()doc";
 
 static const char *__doc_mitsuba_Shape_m_exterior_medium = R"doc()doc";
@@ -5649,6 +6952,8 @@ static const char *__doc_mitsuba_Shape_m_to_object = R"doc()doc";
 
 static const char *__doc_mitsuba_Shape_m_to_world = R"doc()doc";
 
+static const char *__doc_mitsuba_Shape_mark_dirty = R"doc(Flag the geometry of this shape as modified (see dirty()))doc";
+
 static const char *__doc_mitsuba_Shape_operator_delete = R"doc()doc";
 
 static const char *__doc_mitsuba_Shape_operator_delete_2 = R"doc()doc";
@@ -5843,6 +7148,14 @@ frame, and block size)doc";
 
 static const char *__doc_mitsuba_Spiral_Spiral_2 = R"doc()doc";
 
+static const char *__doc_mitsuba_Spiral_block =
+R"doc(Return the offset, size and unique identifer of the work item with the
+given index (in <tt>[0, work_count())</tt>).
+
+The spiral order is precomputed, hence this function does not modify
+the spiral's state and can be called concurrently from multiple
+threads, e.g. with indices provided by a parallel range.)doc";
+
 static const char *__doc_mitsuba_Spiral_block_count = R"doc(Return the total number of blocks)doc";
 
 static const char *__doc_mitsuba_Spiral_class = R"doc()doc";
@@ -5851,25 +7164,27 @@ static const char *__doc_mitsuba_Spiral_m_block_count = R"doc()doc";
 
 static const char *__doc_mitsuba_Spiral_m_block_counter = R"doc()doc";
 
+static const char *__doc_mitsuba_Spiral_m_block_list = R"doc(Relative offset and size of the blocks, in spiral order.)doc";
+
 static const char *__doc_mitsuba_Spiral_m_block_size = R"doc()doc";
 
 static const char *__doc_mitsuba_Spiral_m_blocks = R"doc()doc";
 
-static const char *__doc_mitsuba_Spiral_m_current_direction = R"doc(Direction where the spiral is currently headed.)doc";
-
 static const char *__doc_mitsuba_Spiral_m_mutex = R"doc(Protects the spiral's state (thread safety).)doc";
 
 static const char *__doc_mitsuba_Spiral_m_offset = R"doc()doc";
 
-static const char *__doc_mitsuba_Spiral_m_position = R"doc()doc";
+static const char *__doc_mitsuba_Spiral_m_order = R"doc(Indices of the blocks in the order of their priority (empty: spiral order).)doc";
+
+static const char *__doc_mitsuba_Spiral_m_passes = R"doc(Total number of passes.)doc";
 
 static const char *__doc_mitsuba_Spiral_m_remaining_passes = R"doc(Number of times the spiral should automatically restart.)doc";
 
 static const char *__doc_mitsuba_Spiral_m_size = R"doc()doc";
 
-static const char *__doc_mitsuba_Spiral_m_steps = R"doc(Step counters.)doc";
+static const char *__doc_mitsuba_Spiral_m_tail_blocks = R"doc(Quadrants replacing the last m_tail_count blocks of the final pass.)doc";
 
-static const char *__doc_mitsuba_Spiral_m_steps_left = R"doc(Step counters.)doc";
+static const char *__doc_mitsuba_Spiral_m_tail_count = R"doc()doc";
 
 static const char *__doc_mitsuba_Spiral_max_block_size = R"doc(Return the maximum block size)doc";
 
@@ -5886,6 +7201,40 @@ static const char *__doc_mitsuba_Spiral_set_passes =
 R"doc(Sets the number of time the spiral should automatically reset. Not
 affected by a call to reset.)doc";
 
+static const char *__doc_mitsuba_Spiral_set_priorities =
+R"doc(Hand out the blocks of every pass by decreasing priority
+
+``priorities`` specifies the priority of each block, in spiral order
+(i.e. the order of the blocks returned by block() before the first
+call to this function). Blocks of equal priority keep their spiral
+order, and an empty vector restores it. The unique identifiers of the
+blocks don't depend on their order.
+
+This function is not thread-safe: it must be called while no blocks
+are being rendered, e.g. between two passes.)doc";
+
+static const char *__doc_mitsuba_Spiral_set_priority_map =
+R"doc(Prioritize the blocks according to a map over the film
+
+The priority of a block is the maximum of the first channel of ``map``
+(stretched over the film of size ``film_size``) over the region of the
+block. A ``nullptr`` map restores the spiral order. See
+set_priorities() and Film::set_priority_map().)doc";
+
+static const char *__doc_mitsuba_Spiral_set_tail_subdivision =
+R"doc(Split the last ``count`` blocks of the final pass into four quadrants
+each.
+
+The finer granularity at the end of the render makes it easier to keep
+all threads busy while the last (potentially expensive) blocks finish.
+Only affects block() and work_count().)doc";
+
+static const char *__doc_mitsuba_Spiral_work_count =
+R"doc(Return the total number of work items of all passes
+
+This accounts for the additional items created by
+set_tail_subdivision().)doc";
+
 static const char *__doc_mitsuba_Stream =
 R"doc(Abstract seekable stream class
 
@@ -6409,10 +7758,17 @@ static const char *__doc_mitsuba_SurfaceInteraction_has_n_partials = R"doc()doc"
 
 static const char *__doc_mitsuba_SurfaceInteraction_has_uv_partials = R"doc()doc";
 
-static const char *__doc_mitsuba_SurfaceInteraction_initialize_sh_frame = R"doc(Initialize local shading frame using Gram-schmidt orthogonalization)doc";
+static const char *__doc_mitsuba_SurfaceInteraction_initialize_sh_frame =
+R"doc(Initialize local shading frame using Gram-schmidt orthogonalization
+
+Parameter ``has_dp_du``:
+    Whether dp_du was computed. Otherwise, an arbitrary tangent
+    perpendicular to the shading normal is used.)doc";
 
 static const char *__doc_mitsuba_SurfaceInteraction_instance = R"doc(Stores a pointer to the parent instance (if applicable))doc";
 
+static const char *__doc_mitsuba_SurfaceInteraction_instance_index = R"doc(Index of the instance within its parent instancer (if applicable))doc";
+
 static const char *__doc_mitsuba_SurfaceInteraction_is_medium_transition = R"doc(Does the surface mark a transition between two media?)doc";
 
 static const char *__doc_mitsuba_SurfaceInteraction_is_sensor = R"doc(Is the intersected shape also a sensor?)doc";
@@ -7001,6 +8357,70 @@ static const char *__doc_mitsuba_TensorFile_m_fields = R"doc()doc";
 
 static const char *__doc_mitsuba_TensorFile_to_string = R"doc(Return a human-readable summary)doc";
 
+static const char *__doc_mitsuba_TextureCache =
+R"doc(Global cache of tiled, MIP-mapped textures with a bounded memory
+footprint
+
+Large texture sets (e.g. hundreds of high-resolution UDIM tiles) often
+don't fit into memory alongside the scene geometry. This class converts
+textures into a tiled MIP map representation on disk (write()), loads
+individual tiles on demand, and evicts the least recently used tiles
+once the total size of all resident tiles exceeds a global memory
+budget.
+
+Tile lookups first consult a small per-thread micro-cache, hence the
+lock protecting the shared tile table is only acquired upon a micro-
+cache miss. Disk I/O happens outside of this lock.)doc";
+
+static const char *__doc_mitsuba_TextureCache_TextureCache = R"doc()doc";
+
+static const char *__doc_mitsuba_TextureCache_TextureCachePrivate = R"doc()doc";
+
+static const char *__doc_mitsuba_TextureCache_class = R"doc()doc";
+
+static const char *__doc_mitsuba_TextureCache_clear = R"doc(Evict all resident tiles)doc";
+
+static const char *__doc_mitsuba_TextureCache_d = R"doc()doc";
+
+static const char *__doc_mitsuba_TextureCache_evict = R"doc(Evict tiles until the memory budget is respected (lock must be held))doc";
+
+static const char *__doc_mitsuba_TextureCache_instance = R"doc(Return the global texture cache)doc";
+
+static const char *__doc_mitsuba_TextureCache_m_instance = R"doc()doc";
+
+static const char *__doc_mitsuba_TextureCache_max_memory = R"doc(Return the maximum amount of memory used by resident tiles (in bytes))doc";
+
+static const char *__doc_mitsuba_TextureCache_memory_usage = R"doc(Return the amount of memory currently used by resident tiles (in bytes))doc";
+
+static const char *__doc_mitsuba_TextureCache_open =
+R"doc(Open a tiled texture file
+
+Returns ``None`` when the file does not exist, or when it is stale,
+i.e. it was created with a different ``key``.)doc";
+
+static const char *__doc_mitsuba_TextureCache_set_max_memory = R"doc(Set the maximum amount of memory used by resident tiles (in bytes))doc";
+
+static const char *__doc_mitsuba_TextureCache_tile = R"doc(Return a tile, loading it from disk (used by TiledTexture))doc";
+
+static const char *__doc_mitsuba_TextureCache_to_string = R"doc(Return a string representation including cache statistics)doc";
+
+static const char *__doc_mitsuba_TextureCache_write =
+R"doc(Convert a bitmap into a tiled MIP map file
+
+Parameter ``bitmap``:
+    Source image using a ``Float32`` component format
+
+Parameter ``filename``:
+    Target path. The file is first written to a temporary location and
+    then moved into place, so that concurrent readers never observe a
+    partially written file.
+
+Parameter ``key``:
+    User-specified key that is checked by open()
+
+Parameter ``mean``:
+    Average value of the texture, returned by TiledTexture::mean())doc";
+
 static const char *__doc_mitsuba_Texture =
 R"doc(Base class of all surface texture implementations
 
@@ -7305,6 +8725,16 @@ static const char *__doc_mitsuba_Thread_logger = R"doc(Return the thread's logge
 
 static const char *__doc_mitsuba_Thread_name = R"doc(Return the name of this thread)doc";
 
+static const char *__doc_mitsuba_Thread_numa_node = R"doc(Return the NUMA node that the thread is restricted to (or -1))doc";
+
+static const char *__doc_mitsuba_Thread_numa_nodes =
+R"doc(Return the (logical) processor cores of every NUMA node that are
+available to this process
+
+The topology is read from <tt>/sys/devices/system/node</tt> on Linux. On
+other platforms and on machines without NUMA support, a single node
+holding all cores is returned.)doc";
+
 static const char *__doc_mitsuba_Thread_parent = R"doc(Return the parent thread)doc";
 
 static const char *__doc_mitsuba_Thread_parent_2 = R"doc(Return the parent thread (const version))doc";
@@ -7325,6 +8755,12 @@ the thread should preferably run on the specified processor core. By
 default, the parameter is set to -1, which means that there is no
 affinity.)doc";
 
+static const char *__doc_mitsuba_Thread_set_numa_node =
+R"doc(Restrict the thread to the processor cores of a NUMA node
+
+See numa_nodes() for the list of nodes. The value -1 removes the
+restriction. Only supported on Linux.)doc";
+
 static const char *__doc_mitsuba_Thread_set_critical =
 R"doc(Specify whether or not this thread is critical
 
@@ -7364,6 +8800,49 @@ static const char *__doc_mitsuba_Thread_unregister_external_thread = R"doc(Unreg
 
 static const char *__doc_mitsuba_Thread_yield = R"doc(Yield to another processor)doc";
 
+static const char *__doc_mitsuba_TiledTexture =
+R"doc(Tiled, MIP-mapped texture that is stored on disk and paged into memory
+on demand by the global TextureCache
+
+Instances are created via TextureCache::open() from files that were
+previously generated using TextureCache::write(). Every MIP level is
+split into square tiles of ``tile_size() x tile_size()`` pixels with
+``channel_count()`` single precision components each.)doc";
+
+static const char *__doc_mitsuba_TiledTexture_Level = R"doc()doc";
+
+static const char *__doc_mitsuba_TiledTexture_TiledTexture = R"doc(Open a tiled texture file, throws if it is invalid)doc";
+
+static const char *__doc_mitsuba_TiledTexture_channel_count = R"doc(Return the number of channels per pixel)doc";
+
+static const char *__doc_mitsuba_TiledTexture_class = R"doc()doc";
+
+static const char *__doc_mitsuba_TiledTexture_fetch =
+R"doc(Fetch the channels of a pixel of the given MIP level
+
+The coordinates must lie within the resolution of the level. The
+containing tile is first looked up in a small per-thread micro-cache
+and then in the global texture cache, which loads it from disk if
+necessary.)doc";
+
+static const char *__doc_mitsuba_TiledTexture_filename = R"doc(Return the path of the underlying tiled texture file)doc";
+
+static const char *__doc_mitsuba_TiledTexture_height = R"doc(Return the vertical resolution of the given MIP level)doc";
+
+static const char *__doc_mitsuba_TiledTexture_level_count = R"doc(Return the number of MIP levels (level 0 has the full resolution))doc";
+
+static const char *__doc_mitsuba_TiledTexture_mean = R"doc(Return the average value that was specified when creating the file)doc";
+
+static const char *__doc_mitsuba_TiledTexture_read_tile = R"doc(Read a tile from disk (used by TextureCache))doc";
+
+static const char *__doc_mitsuba_TiledTexture_tile_bytes = R"doc(Return the size of a tile in bytes)doc";
+
+static const char *__doc_mitsuba_TiledTexture_tile_size = R"doc(Return the side length of a tile in pixels)doc";
+
+static const char *__doc_mitsuba_TiledTexture_to_string = R"doc(Return a string representation)doc";
+
+static const char *__doc_mitsuba_TiledTexture_width = R"doc(Return the horizontal resolution of the given MIP level)doc";
+
 static const char *__doc_mitsuba_Timer = R"doc()doc";
 
 static const char *__doc_mitsuba_Timer_Timer = R"doc()doc";
@@ -7605,6 +9084,13 @@ gradients of the linear interpolant as well.)doc";
 
 static const char *__doc_mitsuba_Volume_is_inside = R"doc()doc";
 
+static const char *__doc_mitsuba_Volume_local_max =
+R"doc(Returns an upper bound of the texture within a region of its local
+coordinate system (where the texture occupies the unit cube)
+
+This enables tighter bounds than max() for sparse volumes. The default
+implementation returns max().)doc";
+
 static const char *__doc_mitsuba_Volume_m_bbox = R"doc(Bounding box)doc";
 
 static const char *__doc_mitsuba_Volume_m_world_to_local = R"doc(Used to bring points in world coordinates to local coordinates.)doc";
@@ -7621,11 +9107,20 @@ static const char *__doc_mitsuba_Volume_to_string = R"doc(Returns a human-reable
 
 static const char *__doc_mitsuba_Volume_update_bbox = R"doc()doc";
 
+static const char *__doc_mitsuba_Volume_world_to_local = R"doc(Returns the transformation from world space into the unit cube)doc";
+
 static const char *__doc_mitsuba_ZStream =
 R"doc(Transparent compression/decompression stream based on ``zlib``.
 
 This class transparently decompresses and compresses reads and writes
-to a nested stream, respectively.)doc";
+to a nested stream, respectively.
+
+When a nonzero ``parallel_block_size`` is specified, writes are
+instead buffered and compressed as independent blocks of that size on
+multiple threads (in the style of ``pigz``). Each block is primed with
+the preceding 32 KiB of data, and the blocks are joined into a single
+regular deflate or gzip stream that can be read back by any
+``ZStream``.)doc";
 
 static const char *__doc_mitsuba_ZStream_EStreamType = R"doc()doc";
 
@@ -7636,7 +9131,11 @@ static const char *__doc_mitsuba_ZStream_EStreamType_EGZipStream = R"doc(< A gzi
 static const char *__doc_mitsuba_ZStream_ZStream =
 R"doc(Creates a new compression stream with the given underlying stream.
 This new instance takes ownership of the child stream. The child
-stream must outlive the ZStream.)doc";
+stream must outlive the ZStream.
+
+Parameter ``parallel_block_size``:
+    When nonzero, compress writes in parallel using blocks of this
+    size)doc";
 
 static const char *__doc_mitsuba_ZStream_can_read = R"doc(Can we read from the stream?)doc";
 
@@ -7655,10 +9154,20 @@ read or write operations are permitted.
 This function is idempotent. It is called automatically by the
 destructor.)doc";
 
+static const char *__doc_mitsuba_ZStream_deflate_pending =
+R"doc(Compress buffered data on multiple threads
+
+Only complete blocks are processed unless ``partial`` is set. When
+``finish`` is set, the final block and the stream trailer are written.)doc";
+
 static const char *__doc_mitsuba_ZStream_flush = R"doc(Flushes any buffered data)doc";
 
 static const char *__doc_mitsuba_ZStream_is_closed = R"doc(Whether the stream is closed (no read or write are then permitted).)doc";
 
+static const char *__doc_mitsuba_ZStream_m_block_size = R"doc()doc";
+
+static const char *__doc_mitsuba_ZStream_m_checksum = R"doc()doc";
+
 static const char *__doc_mitsuba_ZStream_m_child_stream = R"doc()doc";
 
 static const char *__doc_mitsuba_ZStream_m_deflate_buffer = R"doc()doc";
@@ -7667,10 +9176,24 @@ static const char *__doc_mitsuba_ZStream_m_deflate_stream = R"doc()doc";
 
 static const char *__doc_mitsuba_ZStream_m_did_write = R"doc()doc";
 
+static const char *__doc_mitsuba_ZStream_m_header_written = R"doc()doc";
+
 static const char *__doc_mitsuba_ZStream_m_inflate_buffer = R"doc()doc";
 
 static const char *__doc_mitsuba_ZStream_m_inflate_stream = R"doc()doc";
 
+static const char *__doc_mitsuba_ZStream_m_level = R"doc()doc";
+
+static const char *__doc_mitsuba_ZStream_m_pending = R"doc()doc";
+
+static const char *__doc_mitsuba_ZStream_m_stream_type = R"doc()doc";
+
+static const char *__doc_mitsuba_ZStream_m_total_in = R"doc()doc";
+
+static const char *__doc_mitsuba_ZStream_m_window = R"doc()doc";
+
+static const char *__doc_mitsuba_ZStream_parallel_block_size = R"doc(Return the block size used for parallel compression (0 if disabled))doc";
+
 static const char *__doc_mitsuba_ZStream_read =
 R"doc(Reads a specified amount of data from the stream, decompressing it
 first using ZLib. Throws an exception when the stream ended
@@ -7738,6 +9261,46 @@ static const char *__doc_mitsuba_comparator_operator_call = R"doc()doc";
 
 static const char *__doc_mitsuba_complex_ior_from_file = R"doc()doc";
 
+static const char *__doc_mitsuba_compression_Codec = R"doc(Codecs supported by the block compression container)doc";
+
+static const char *__doc_mitsuba_compression_Codec_Deflate = R"doc(Blocks compressed using ``zlib``)doc";
+
+static const char *__doc_mitsuba_compression_Codec_Stored = R"doc(Uncompressed blocks)doc";
+
+static const char *__doc_mitsuba_compression_read_blocks =
+R"doc(Read a container created by write_blocks() and decompress it in
+parallel
+
+Returns a seekable memory stream holding the uncompressed contents. It
+uses the byte order of ``stream``.)doc";
+
+static const char *__doc_mitsuba_compression_write_blocks =
+R"doc(Write a buffer as a sequence of independently compressed blocks
+
+Unlike ZStream, the resulting container can be decompressed in
+parallel. It consists of a small header (codec, block count,
+uncompressed size, block size) followed by the compressed size of
+every block and the block contents. The blocks are compressed in
+parallel.
+
+Parameter ``stream``:
+    Stream receiving the container
+
+Parameter ``data``:
+    Pointer to the data that should be compressed
+
+Parameter ``size``:
+    Size of the data in bytes
+
+Parameter ``codec``:
+    Compression codec used for every block
+
+Parameter ``block_size``:
+    Uncompressed size of every block except for the last one
+
+Parameter ``level``:
+    Compression level (-1 selects the codec's default))doc";
+
 static const char *__doc_mitsuba_compute_shading_frame =
 R"doc(Given a smoothly varying shading normal and a tangent of a shape
 parameterization, compute a smoothly varying orthonormal frame.
@@ -9647,6 +11210,16 @@ R"doc(Look up the model coefficients for a sRGB color value @param c An sRGB
 color value where all components are in [0, 1]. @return Coefficients
 for use with srgb_model_eval)doc";
 
+static const char *__doc_mitsuba_srgb_model_fetch_2 =
+R"doc(Convert an array of ``count`` packed sRGB color values into model
+coefficients in place
+
+This is equivalent to calling srgb_model_fetch() for every color, but
+evaluates the lookups in SIMD packets and in parallel, which is
+preferable for the large arrays of textures and mesh attributes.)doc";
+
+static const char *__doc_mitsuba_srgb_model_fetch_3 = R"doc(Double precision version of srgb_model_fetch(float *, size_t))doc";
+
 static const char *__doc_mitsuba_srgb_model_mean = R"doc()doc";
 
 static const char *__doc_mitsuba_srgb_to_xyz = R"doc(Convert ITU-R Rec. BT.709 linear RGB to XYZ tristimulus values)doc";
@@ -9932,7 +11505,39 @@ Parameter ``variant``:
 
 Parameter ``update_scene``:
     When Mitsuba updates scene to a newer version, should the updated
-    XML file be written back to disk?)doc";
+    XML file be written back to disk?
+
+Parameter ``cache_dir``:
+    Optional directory holding binary snapshots of parsed scene
+    descriptions. The snapshot contains the resolved properties of all
+    objects (after expanding includes and substituting parameters) and
+    is keyed by the scene path, variant, parameters and search paths. It
+    is used in place of the XML parse as long as none of the files that
+    were read while parsing changed their size or modification time.)doc";
+
+static const char *__doc_mitsuba_xml_load_properties =
+R"doc(Create a set of objects from their properties
+
+This function gives other scene front-ends (e.g. ``load_dict()`` in
+Python) access to the instantiation stage of load_file(): objects are
+created by parallel tasks as soon as all objects they reference exist.
+
+Parameter ``objects``:
+    Identifiers and properties of the objects. References to other
+    objects of the list are named references to their identifiers (see
+    Properties::set_named_reference()). The plugin name ``"scene"``
+    denotes a scene.
+
+Parameter ``root``:
+    Identifier of the returned object. Objects that it doesn't
+    (directly or indirectly) reference are not created.
+
+Parameter ``variant``:
+    Specifies the variant of plugins to instantiate (e.g.
+    "scalar_rgb")
+
+Parameter ``source``:
+    Name of the scene description used in error messages)doc";
 
 static const char *__doc_mitsuba_xml_load_string = R"doc(Load a Mitsuba scene from an XML string)doc";
 
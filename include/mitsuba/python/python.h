@@ -10,6 +10,7 @@
 #include <pybind11/pybind11.h>
 #include <pybind11/operators.h>
 #include <pybind11/functional.h>
+#include <pybind11/numpy.h>
 #include <pybind11/stl.h>
 #include <enoki/stl.h>
 
@@ -118,6 +119,56 @@ template <typename Type> pybind11::handle get_type_handle() {
     return pybind11::detail::get_type_handle(typeid(Type), false);
 }
 
+/**
+ * \brief Create a view of the contents of a contiguous Enoki buffer that
+ * does not copy any data
+ *
+ * By default, the result is a NumPy array aliasing the buffer. In GPU
+ * variants, the buffer is moved to managed memory (accessible by both the
+ * CPU and the GPU) beforehand. When \c cuda is set, the result is instead an
+ * object implementing the \c __cuda_array_interface__ protocol, which can be
+ * passed to CuPy, Numba or PyTorch without a copy.
+ *
+ * The view keeps the object \c base alive, but it will refer to stale memory
+ * when the buffer is reallocated, or extended by subsequent computation of
+ * the JIT compiler.
+ */
+template <typename Buffer>
+py::object array_view(Buffer &buffer, const std::vector<size_t> &shape, py::handle base,
+                      bool cuda = false) {
+    using Scalar = scalar_t<Buffer>;
+    Scalar *ptr;
+
+    if constexpr (is_cuda_array_v<Buffer>) {
+        cuda_eval();
+        cuda_sync();
+        ptr = (Scalar *) buffer.managed().data();
+    } else {
+        if (cuda)
+            throw std::runtime_error("array_view(): CUDA views are only "
+                                     "supported in GPU variants!");
+        ptr = (Scalar *) buffer.data();
+    }
+
+    size_t size = 1;
+    for (size_t s : shape)
+        size *= s;
+    if (size != slices(buffer))
+        throw std::runtime_error("array_view(): shape does not match the buffer size!");
+
+    if (!cuda)
+        return py::array_t<Scalar>(shape, ptr, base);
+
+    py::dict interface;
+    interface["shape"]   = py::tuple(py::cast(shape));
+    interface["typestr"] = py::dtype::of<Scalar>().attr("str");
+    interface["data"]    = py::make_tuple((size_t) ptr, false);
+    interface["version"] = 2;
+
+    return py::module::import("types").attr("SimpleNamespace")(
+        "__cuda_array_interface__"_a = interface, "base"_a = base);
+}
+
 #define MTS_PY_DECLARE(Name) extern void python_export_##Name(py::module &m)
 #define MTS_PY_EXPORT(Name) void python_export_##Name(py::module &m)
 #define MTS_PY_IMPORT(Name) python_export_##Name(m)
@@ -279,7 +279,7 @@ template <typename Float, typename Spectrum> struct BSDFSample3 {
 template <typename Float, typename Spectrum>
 class MTS_EXPORT_RENDER BSDF : public Object {
 public:
-    MTS_IMPORT_TYPES()
+    MTS_IMPORT_TYPES(Texture)
 
     /**
      * \brief Importance sample the BSDF model
@@ -393,6 +393,33 @@ public:
                       const Vector3f &wo,
                       Mask active = true) const = 0;
 
+    /**
+     * \brief Jointly evaluate the BSDF and the probability per unit solid
+     * angle of sampling a given direction
+     *
+     * This is equivalent to calling \ref eval() and \ref pdf(), but it only
+     * dispatches once over the BSDF pointers of a packet (vectorized
+     * variants), and allows implementations to share the work of both
+     * queries (e.g. the texture lookups and the microfacet distribution).
+     * The default implementation simply invokes both methods.
+     *
+     * \param ctx
+     *     A context data structure describing which lobes to evalute,
+     *     and whether radiance or importance are being transported.
+     *
+     * \param si
+     *     A surface interaction data structure describing the underlying
+     *     surface position. The incident direction is obtained from
+     *     the field <tt>si.wi</tt>.
+     *
+     * \param wo
+     *     The outgoing direction
+     */
+    virtual std::pair<Spectrum, Float> eval_pdf(const BSDFContext &ctx,
+                                                const SurfaceInteraction3f &si,
+                                                const Vector3f &wo,
+                                                Mask active = true) const;
+
     /**
      * \brief Evaluate un-scattered transmission component of the BSDF
      *
@@ -408,6 +435,18 @@ public:
     virtual Spectrum eval_null_transmission(const SurfaceInteraction3f &si,
                              Mask active = true) const;
 
+    /**
+     * \brief Return a texture marking the perfectly transparent regions of
+     * the surface, where it evaluates to zero
+     *
+     * An intersection in such a region is equivalent to no intersection at
+     * all. The ray tracing backends use this to skip these intersections
+     * during traversal instead of returning them to the integrator, which
+     * would then have to continue the ray. The default implementation
+     * returns \c nullptr (no such regions).
+     */
+    virtual const Texture *alpha_mask() const { return nullptr; }
+
 
     // -----------------------------------------------------------------------
     //! @{ \name BSDF property accessors (components, flags, etc)
@@ -524,6 +563,7 @@ ENOKI_CALL_SUPPORT_TEMPLATE_BEGIN(mitsuba::BSDF)
     ENOKI_CALL_SUPPORT_METHOD(eval)
     ENOKI_CALL_SUPPORT_METHOD(eval_null_transmission)
     ENOKI_CALL_SUPPORT_METHOD(pdf)
+    ENOKI_CALL_SUPPORT_METHOD(eval_pdf)
     ENOKI_CALL_SUPPORT_GETTER(flags, m_flags)
 
     auto needs_differentials() const {
@@ -0,0 +1,410 @@
+#pragma once
+
+#include <mitsuba/core/bbox.h>
+#include <mitsuba/core/fwd.h>
+#include <mitsuba/core/logger.h>
+#include <mitsuba/core/math.h>
+#include <mitsuba/core/object.h>
+#include <mitsuba/core/ray.h>
+#include <mitsuba/render/interaction.h>
+#include <mitsuba/render/mesh.h>
+#include <mitsuba/render/shape.h>
+#include <memory>
+#include <vector>
+
+/// Compile-time BVH depth limit to enable traversal with stack memory
+#define MTS_BVH_MAXDEPTH 64u
+
+/// Nodes with more primitives than this are built in parallel
+#define MTS_BVH_GRAIN_SIZE 4096u
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**
+ * \brief Bounding volume hierarchy over the primitives of a set of shapes
+ *
+ * This class provides an alternative to \ref ShapeKDTree that exposes the same
+ * query interface and is used by the native CPU backend when the scene sets
+ * <tt>accel="bvh"</tt>. Compared to the kd-tree, every primitive is referenced
+ * exactly once, which reduces the memory footprint and allows for a
+ * considerably faster construction.
+ *
+ * The tree is constructed top-down using the binned surface area heuristic
+ * (SAH). Large nodes are binned in parallel, and subtrees are built as
+ * independent TBB tasks. The resulting binary tree is then collapsed into a
+ * tree with \ref Width children per node, whose bounding boxes are stored in
+ * a structure-of-arrays layout so that a ray can be tested against all
+ * children of a node at once.
+ */
+template <typename Float, typename Spectrum>
+class MTS_EXPORT_RENDER ShapeBVH : public Object {
+public:
+    MTS_IMPORT_TYPES(Shape, Mesh)
+
+    using Size  = uint32_t;
+    using Index = uint32_t;
+
+    /// Number of children per node
+    static constexpr size_t Width = 4;
+
+    /// Marker for unused child slots
+    static constexpr Index InvalidNode = Index(-1);
+
+    /// SIMD type used to process the children of a node
+    using FloatW = Packet<ScalarFloat, Width>;
+    using MaskW  = mask_t<FloatW>;
+
+    /**
+     * \brief BVH node storing the bounds of \ref Width children
+     *
+     * Unused child slots have an empty (inverted) bounding box and are marked
+     * with \ref InvalidNode. Leaf children reference a contiguous range of
+     * \c m_indices.
+     */
+    struct alignas(16) BVHNode {
+        /// Bounding boxes of the children: <tt>bounds[min/max][axis][child]</tt>
+        ScalarFloat bounds[2][3][Width];
+
+        /// Node index of inner children, primitive offset of leaf children
+        Index child[Width];
+
+        /// Number of primitives of leaf children (zero for inner children)
+        Index prim_count[Width];
+    };
+
+    /// Create an empty BVH and take build-related parameters from \c props.
+    ShapeBVH(const Properties &props);
+
+    /// Register a new shape with the BVH (to be called before \ref build())
+    void add_shape(Shape *shape);
+
+    /// Build the BVH
+    void build();
+
+    /**
+     * \brief Update the BVH after the registered shapes were modified
+     *
+     * When the primitive counts of all shapes are unchanged (e.g. deformed
+     * vertex positions or transformed shapes), the bounds of the existing
+     * nodes are refit in a single bottom-up pass. Otherwise, the BVH is
+     * rebuilt from scratch.
+     */
+    void update();
+
+    /// Return the number of registered shapes
+    Size shape_count() const { return Size(m_shapes.size()); }
+
+    /// Return the number of registered primitives
+    Size primitive_count() const { return m_primitive_map.back(); }
+
+    /// Return the i-th shape (const version)
+    const Shape *shape(size_t i) const { Assert(i < m_shapes.size()); return m_shapes[i]; }
+
+    /// Return the i-th shape
+    Shape *shape(size_t i) { Assert(i < m_shapes.size()); return m_shapes[i]; }
+
+    /// Return the bounding box of the entire BVH
+    const ScalarBoundingBox3f &bbox() const { return m_bbox; }
+
+    /// Return the bounding box of the i-th primitive
+    MTS_INLINE ScalarBoundingBox3f bbox(Index i) const {
+        Index shape_index = find_shape(i);
+        return m_shapes[shape_index]->bbox(i);
+    }
+
+    /// Return the number of nodes
+    size_t node_count() const { return m_nodes.size(); }
+
+    template <bool ShadowRay>
+    MTS_INLINE PreliminaryIntersection3f ray_intersect_preliminary(const Ray3f &ray,
+                                                                   Mask active) const {
+        ENOKI_MARK_USED(active);
+        if constexpr (!is_array_v<Float>)
+            return ray_intersect_scalar<ShadowRay>(ray);
+        else
+            return ray_intersect_packet<ShadowRay>(ray, active);
+    }
+
+    template <bool ShadowRay>
+    MTS_INLINE PreliminaryIntersection3f ray_intersect_scalar(Ray3f ray) const {
+        /// Ray traversal stack entry
+        struct BVHStackEntry {
+            // Ray distance associated with the node entry point
+            Float mint;
+            // Index of the node
+            Index node;
+        };
+
+        BVHStackEntry stack[MTS_BVH_MAXDEPTH * (Width - 1) + 1];
+        int32_t stack_index = 0;
+
+        PreliminaryIntersection3f pi;
+        if (unlikely(m_nodes.empty()))
+            return pi;
+
+        FloatW o[3], d_rcp[3];
+        for (size_t k = 0; k < 3; ++k) {
+            o[k] = ray.o[k];
+            d_rcp[k] = ray.d_rcp[k];
+        }
+        // Select the near/far bounds per axis based on the ray direction
+        size_t near_bound[3] = { ray.d_rcp[0] < 0.f, ray.d_rcp[1] < 0.f, ray.d_rcp[2] < 0.f };
+
+        stack[stack_index++] = { ray.mint, 0 };
+
+        while (stack_index > 0) {
+            const BVHStackEntry &entry = stack[--stack_index];
+            if (entry.mint > ray.maxt)
+                continue;
+
+            const BVHNode &node = m_nodes[entry.node];
+
+            FloatW t_near(ray.mint), t_far(ray.maxt);
+            for (size_t k = 0; k < 3; ++k) {
+                FloatW t0 = (load<FloatW>(node.bounds[near_bound[k]][k]) - o[k]) * d_rcp[k],
+                       t1 = (load<FloatW>(node.bounds[1 - near_bound[k]][k]) - o[k]) * d_rcp[k];
+                t_near = max(t_near, t0);
+                t_far  = min(t_far,  t1);
+            }
+
+            MaskW hit = t_near <= t_far;
+            if (none(hit))
+                continue;
+
+            // Visit leaves right away, and postpone inner nodes (nearest on top)
+            int32_t stack_start = stack_index;
+            for (size_t i = 0; i < Width; ++i) {
+                if (!hit.coeff(i) || node.child[i] == InvalidNode)
+                    continue;
+
+                if (node.prim_count[i] > 0) {
+                    Index prim_start = node.child[i],
+                          prim_end   = prim_start + node.prim_count[i];
+
+                    for (Index j = prim_start; j < prim_end; j++) {
+                        PreliminaryIntersection3f prim_pi =
+                            intersect_prim<ShadowRay>(m_indices[j], ray, true);
+
+                        if (unlikely(prim_pi.is_valid())) {
+                            if constexpr (ShadowRay)
+                                return prim_pi;
+
+                            pi = prim_pi;
+                            ray.maxt = pi.t;
+                        }
+                    }
+                } else {
+                    // Insertion sort by decreasing distance
+                    BVHStackEntry value = { t_near.coeff(i), node.child[i] };
+                    int32_t k = stack_index++;
+                    while (k > stack_start && stack[k - 1].mint < value.mint) {
+                        stack[k] = stack[k - 1];
+                        --k;
+                    }
+                    stack[k] = value;
+                }
+            }
+        }
+
+        return pi;
+    }
+
+    template <bool ShadowRay>
+    MTS_INLINE PreliminaryIntersection3f ray_intersect_packet(Ray3f ray,
+                                                              Mask active) const {
+        /// Ray traversal stack entry
+        struct BVHStackEntry {
+            // Ray distances associated with the node entry point
+            Float mint;
+            // Is the corresponding SIMD lane enabled?
+            Mask active;
+            // Index of the node
+            Index node;
+        };
+
+        BVHStackEntry stack[MTS_BVH_MAXDEPTH * (Width - 1) + 1];
+        int32_t stack_index = 0;
+
+        PreliminaryIntersection3f pi;
+        if (unlikely(m_nodes.empty()))
+            return pi;
+
+        stack[stack_index++] = { ray.mint, active, 0 };
+
+        while (stack_index > 0) {
+            --stack_index;
+            const BVHNode &node = m_nodes[stack[stack_index].node];
+            active = stack[stack_index].active && stack[stack_index].mint <= ray.maxt;
+            if constexpr (ShadowRay)
+                active &= !pi.is_valid();
+            if (none(active))
+                continue;
+
+            for (size_t i = 0; i < Width; ++i) {
+                if (node.child[i] == InvalidNode)
+                    continue;
+
+                Float t_near = ray.mint, t_far = ray.maxt;
+                for (size_t k = 0; k < 3; ++k) {
+                    Float t0 = (node.bounds[0][k][i] - ray.o[k]) * ray.d_rcp[k],
+                          t1 = (node.bounds[1][k][i] - ray.o[k]) * ray.d_rcp[k];
+                    t_near = max(t_near, min(t0, t1));
+                    t_far  = min(t_far,  max(t0, t1));
+                }
+
+                Mask hit = active && t_near <= t_far;
+                if (none(hit))
+                    continue;
+
+                if (node.prim_count[i] > 0) {
+                    Index prim_start = node.child[i],
+                          prim_end   = prim_start + node.prim_count[i];
+
+                    for (Index j = prim_start; j < prim_end; j++) {
+                        PreliminaryIntersection3f prim_pi =
+                            intersect_prim<ShadowRay>(m_indices[j], ray, hit);
+
+                        masked(pi, prim_pi.is_valid()) = prim_pi;
+                        if constexpr (!ShadowRay)
+                            masked(ray.maxt, prim_pi.is_valid()) = prim_pi.t;
+                    }
+                } else {
+                    stack[stack_index++] = { t_near, hit, node.child[i] };
+                }
+            }
+        }
+
+        return pi;
+    }
+
+    /// Brute force intersection routine for debugging purposes
+    template <bool ShadowRay>
+    MTS_INLINE PreliminaryIntersection3f ray_intersect_naive(Ray3f ray,
+                                                             Mask active) const {
+        PreliminaryIntersection3f pi;
+
+        for (Size i = 0; i < primitive_count(); ++i) {
+            PreliminaryIntersection3f prim_pi =
+                intersect_prim<ShadowRay>(i, ray, active);
+
+            if constexpr (is_array_v<Float>) {
+                masked(pi, prim_pi.is_valid()) = prim_pi;
+            } else if (prim_pi.is_valid()) {
+                pi = prim_pi;
+                ray.maxt = prim_pi.t;
+            }
+
+            if (ShadowRay && all(pi.is_valid() || !active))
+                break;
+        }
+
+        return pi;
+    }
+
+    /// Return a human-readable string representation of the scene contents.
+    virtual std::string to_string() const override;
+
+    /// Account the nodes and indices (the shapes belong to the scene)
+    virtual void account_memory(MemoryReport *report) const override;
+
+    MTS_DECLARE_CLASS()
+protected:
+    /// Temporary binary tree node used during the construction
+    struct BuildNode;
+
+    /// Primitive reference used during the construction
+    struct BuildPrimitive {
+        ScalarBoundingBox3f bbox;
+        ScalarPoint3f center;
+        Index index;
+    };
+
+    /// Recursively build the binary BVH over the primitive range [begin, end)
+    std::unique_ptr<BuildNode> build_recursive(BuildPrimitive *begin, BuildPrimitive *end,
+                                               size_t depth);
+
+    /// Convert the binary tree into a tree with \ref Width children per node
+    Index collapse(const BuildNode *node);
+
+    /**
+     * \brief Map an abstract primitive index to a specific shape managed by
+     * the \ref ShapeBVH.
+     *
+     * The function returns the shape index and updates the \a idx parameter to
+     * point to the primitive index (e.g. triangle ID) within the shape.
+     */
+    MTS_INLINE Index find_shape(Index &i) const {
+        Assert(i < primitive_count());
+
+        Index shape_index = math::find_interval(
+            Size(m_primitive_map.size()),
+            [&](Index k) ENOKI_INLINE_LAMBDA {
+                return m_primitive_map[k] <= i;
+            }
+        );
+
+        Assert(i >= m_primitive_map[shape_index]);
+        Assert(i <  m_primitive_map[shape_index + 1]);
+        i -= m_primitive_map[shape_index];
+
+        return shape_index;
+    }
+
+    /// Check whether a primitive is intersected by the given ray.
+    template <bool ShadowRay = false>
+    MTS_INLINE PreliminaryIntersection3f
+    intersect_prim(Index prim_index, const Ray3f &ray, Mask active) const {
+        Index shape_index  = find_shape(prim_index);
+        const Shape *shape = this->shape(shape_index);
+
+        PreliminaryIntersection3f pi;
+
+        if constexpr (ShadowRay) {
+            Mask hit;
+            if (shape->is_mesh()) {
+                const Mesh *mesh = (const Mesh *) shape;
+                pi = mesh->ray_intersect_triangle(prim_index, ray, active);
+                hit = pi.is_valid();
+                if (unlikely(mesh->has_alpha_mask()))
+                    hit &= mesh->alpha_test(ray, pi, hit);
+            } else {
+                hit = shape->ray_test_primitive(prim_index, ray, active);
+            }
+
+            pi.t = select(hit, Float(0.f), math::Infinity<Float>);
+            return pi;
+        } else {
+            if (shape->is_mesh()) {
+                const Mesh *mesh = (const Mesh *) shape;
+                pi = mesh->ray_intersect_triangle(prim_index, ray, active);
+
+                // Skip intersections with transparent regions and continue the traversal
+                if (unlikely(mesh->has_alpha_mask()))
+                    masked(pi.t, !mesh->alpha_test(ray, pi, active)) = math::Infinity<Float>;
+            } else {
+                pi = shape->ray_intersect_primitive(prim_index, ray, active);
+            }
+
+            return pi;
+        }
+    }
+
+protected:
+    std::vector<ref<Shape>> m_shapes;
+    std::vector<Size> m_primitive_map;
+    std::vector<BVHNode> m_nodes;
+    std::vector<Index> m_indices;
+    ScalarBoundingBox3f m_bbox;
+
+    /// Number of bins used by the binned SAH builder
+    uint32_t m_bin_count;
+    /// Nodes with this many or fewer primitives become leaves
+    uint32_t m_max_leaf_size;
+    /// Relative costs of node traversal and primitive intersection (SAH)
+    ScalarFloat m_traversal_cost, m_intersection_cost;
+    /// Start of the primitive array while the tree is being built
+    const BuildPrimitive *m_build_prims = nullptr;
+};
+
+MTS_EXTERN_CLASS_RENDER(ShapeBVH)
+NAMESPACE_END(mitsuba)
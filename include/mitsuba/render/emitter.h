@@ -60,7 +60,8 @@ constexpr auto has_flag(UInt32 flags, EmitterFlags f)            { return neq(fl
 template <typename Float, typename Spectrum>
 class MTS_EXPORT_RENDER Emitter : public Endpoint<Float, Spectrum> {
 public:
-    MTS_IMPORT_BASE(Endpoint)
+    MTS_IMPORT_TYPES()
+    MTS_IMPORT_BASE(Endpoint, sample_direction, pdf_direction)
 
     /// Is this an environment map light emitter?
     bool is_environment() const {
@@ -70,6 +71,57 @@ public:
     /// Flags for all components combined.
     uint32_t flags(mask_t<Float> /*active*/ = true) const { return m_flags; }
 
+    /**
+     * \brief Return an estimate of the total power emitted by this emitter
+     *
+     * The value is averaged over the spectrum and only needs to be accurate
+     * up to a constant factor shared by all emitters: it is used by \ref Scene
+     * to select emitters proportionally to their power. Infinite emitters
+     * report the power that enters the bounding sphere of the scene.
+     */
+    virtual scalar_t<Float> power() const;
+
+    /// Probability of selecting this emitter in \ref Scene::sample_emitter_direction()
+    scalar_t<Float> selection_pmf(mask_t<Float> /*active*/ = true) const { return m_selection_pmf; }
+
+    /// Set the emitter selection probability (used by \ref Scene)
+    void set_selection_pmf(scalar_t<Float> pmf) { m_selection_pmf = pmf; }
+
+    /**
+     * \brief Direction sampling with a lobe of the reference point
+     *
+     * Like \ref sample_direction(), but the emitter may additionally
+     * importance sample the product of its emission and the lobe
+     * <tt>max(0, dot(d, lobe_axis))^lobe_exponent</tt> (e.g. the cosine
+     * foreshortening or a glossy BSDF lobe at the reference point). Lanes
+     * with <tt>lobe_exponent == 0</tt> ignore the lobe.
+     *
+     * The density of the samples is given by \ref pdf_direction_lobe(),
+     * which must be called with the same lobe. The default implementation
+     * ignores the lobe and calls \ref sample_direction().
+     *
+     * \param lobe_axis
+     *    Normalized axis of the lobe in world space
+     *
+     * \param lobe_exponent
+     *    Exponent of the lobe (\c 1 for the cosine foreshortening)
+     */
+    virtual std::pair<DirectionSample3f, Spectrum>
+    sample_direction_lobe(const Interaction3f &ref, const Point2f &sample,
+                          const Vector3f &lobe_axis, Float lobe_exponent,
+                          Mask active = true) const;
+
+    /**
+     * \brief Evaluate the density of \ref sample_direction_lobe() for the
+     * given lobe
+     *
+     * The default implementation ignores the lobe and calls \ref
+     * pdf_direction().
+     */
+    virtual Float pdf_direction_lobe(const Interaction3f &ref, const DirectionSample3f &ds,
+                                     const Vector3f &lobe_axis, Float lobe_exponent,
+                                     Mask active = true) const;
+
 
     ENOKI_CALL_SUPPORT_FRIEND()
     MTS_DECLARE_CLASS()
@@ -81,6 +133,9 @@ protected:
 protected:
     /// Combined flags for all properties of this emitter.
     uint32_t m_flags;
+
+    /// Probability of selecting this emitter when sampling the scene's emitters
+    scalar_t<Float> m_selection_pmf = 1.f;
 };
 
 MTS_EXTERN_CLASS_RENDER(Emitter)
@@ -96,8 +151,11 @@ ENOKI_CALL_SUPPORT_TEMPLATE_BEGIN(mitsuba::Emitter)
     ENOKI_CALL_SUPPORT_METHOD(eval)
     ENOKI_CALL_SUPPORT_METHOD(sample_direction)
     ENOKI_CALL_SUPPORT_METHOD(pdf_direction)
+    ENOKI_CALL_SUPPORT_METHOD(sample_direction_lobe)
+    ENOKI_CALL_SUPPORT_METHOD(pdf_direction_lobe)
     ENOKI_CALL_SUPPORT_METHOD(is_environment)
     ENOKI_CALL_SUPPORT_GETTER(flags, m_flags)
+    ENOKI_CALL_SUPPORT_GETTER(selection_pmf, m_selection_pmf)
 ENOKI_CALL_SUPPORT_TEMPLATE_END(mitsuba::Emitter)
 
 //! @}
@@ -136,6 +136,30 @@ public:
                                 const DirectionSample3f &ds,
                                 Mask active = true) const;
 
+    /**
+     * \brief Evaluate the densities of the ray sampling method implemented
+     * by the \ref sample_ray() method.
+     *
+     * This is e.g. needed by bidirectional techniques, which must know how
+     * likely the endpoint would have generated a given path segment.
+     *
+     * The default implementation throws an exception.
+     *
+     * \param ps
+     *    The ray origin on the endpoint
+     *
+     * \param d
+     *    The (normalized) direction of the ray
+     *
+     * \return
+     *    The density of the ray origin per unit area (1 for endpoints
+     *    at a single point in space) and the density of the direction
+     *    per unit solid angle.
+     */
+    virtual std::pair<Float, Float> pdf_ray(const PositionSample3f &ps,
+                                            const Vector3f &d,
+                                            Mask active = true) const;
+
     //! @}
     // =============================================================
 
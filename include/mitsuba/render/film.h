@@ -3,10 +3,12 @@
 #include <mitsuba/mitsuba.h>
 #include <mitsuba/core/logger.h>
 #include <mitsuba/core/object.h>
+#include <mitsuba/core/properties.h>
 #include <mitsuba/core/rfilter.h>
 #include <mitsuba/core/vector.h>
 #include <mitsuba/render/sampler.h>
 #include <mitsuba/render/fwd.h>
+#include <mutex>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -28,6 +30,16 @@ public:
     /// Merge an image block into the film. This methods should be thread-safe.
     virtual void put(const ImageBlock *block) = 0;
 
+    /**
+     * \brief Configure an image block that will be merged into the film
+     *
+     * Integrators call this for their blocks after \ref prepare(), which
+     * lets the film request additional per-block state (e.g. the deep
+     * samples of \c hdrfilm, see \ref ImageBlock::set_deep_samples()). The
+     * default implementation does nothing.
+     */
+    virtual void configure_block(ImageBlock *block) const;
+
     /// Develop the film and write the result to the previously specified filename
     virtual void develop() = 0;
 
@@ -55,6 +67,43 @@ public:
     /// Does the destination file already exist?
     virtual bool destination_exists(const fs::path &basename) const = 0;
 
+    /// Return the target filename (empty if not known)
+    virtual fs::path destination_file() const;
+
+    /**
+     * \brief Return a copy of the accumulated (i.e. unnormalized and, in the
+     * case of a deferred filter, unfiltered) film contents
+     *
+     * Together with \ref restore(), this allows to checkpoint a render. It
+     * should not be called while image blocks are being merged into the film.
+     * The default implementation throws an exception.
+     */
+    virtual ref<Bitmap> snapshot();
+
+    /// Replace the film contents by a bitmap returned by \ref snapshot()
+    virtual void restore(const Bitmap *snapshot);
+
+    /**
+     * \brief Return the calling thread's block for samples that can land
+     * anywhere on the film (e.g. light tracing contributions, see \ref
+     * ImageBlock::splat())
+     *
+     * Each thread accumulates its splats into a separate block covering the
+     * crop window, which avoids any synchronization between the threads. The
+     * block is created upon the first call and added to the film by \ref
+     * merge_splats(). Splats are only supported by films without AOV channels.
+     */
+    ImageBlock *splat_block();
+
+    /**
+     * \brief Accumulate the splat blocks of all threads into the film and
+     * clear them
+     *
+     * This is called by the integrator at the end of every rendering pass and
+     * must not be called while other threads are splatting.
+     */
+    void merge_splats();
+
     /**
      * Should regions slightly outside the image plane be sampled to improve
      * the quality of the reconstruction at the edges? This only makes
@@ -62,6 +111,86 @@ public:
      */
     bool has_high_quality_edges() const { return m_high_quality_edges; }
 
+    /**
+     * Is the reconstruction filter applied when developing the film, rather
+     * than when splatting the samples? In this case, image blocks accumulate
+     * per-pixel sample sums using the box filter returned by \ref
+     * sample_filter(), which avoids overlapping blocks.
+     */
+    bool has_deferred_filter() const { return m_deferred_filter; }
+
+    /**
+     * \brief Return which of the given channels bypass the reconstruction
+     * filter
+     *
+     * These are the channels of the AOVs listed in the film's \c
+     * unfiltered_aovs parameter and of the ID layers (see \ref
+     * add_id_layer()), which are accumulated into the pixel
+     * containing each sample (see \ref ImageBlock::set_unfiltered_channels()),
+     * as well as the channel \c W.unfiltered counting their samples.
+     * Integrators append the latter to the channels passed to \ref prepare()
+     * when the mask is not empty. An empty mask is returned when none of the
+     * channels belong to an unfiltered AOV.
+     */
+    std::vector<bool> unfiltered_channels(const std::vector<std::string> &channels) const;
+
+    /**
+     * \brief Declare an ID layer (e.g. a Cryptomatte layer produced by the
+     * \c aov integrator)
+     *
+     * The layer occupies the channels <tt>name00.R</tt>, <tt>name00.G</tt>,
+     * <tt>name00.B</tt>, <tt>name00.A</tt>, <tt>name01.R</tt>, etc., which
+     * store the per-pixel (ID, sample count) pairs and bypass the
+     * reconstruction filter (see \ref ImageBlock::set_unfiltered_channels()).
+     *
+     * \param manifest
+     *    Cryptomatte manifest of the layer (a JSON object mapping the names of
+     *    the objects to their hexadecimal IDs), or an empty string.
+     */
+    void add_id_layer(const std::string &name, const std::string &manifest);
+
+    /// Return the ID layers and their manifests, see \ref add_id_layer()
+    const std::vector<std::pair<std::string, std::string>> &id_layers() const {
+        return m_id_layers;
+    }
+
+    /**
+     * \brief Return the (1-based) index of the ID layer that each of the
+     * given channels belongs to, or zero for other channels
+     *
+     * An empty vector is returned when none of the channels belong to an ID
+     * layer.
+     */
+    std::vector<uint32_t> id_channels(const std::vector<std::string> &channels) const;
+
+    /**
+     * \brief Set a map that prioritizes regions of the film while rendering
+     *
+     * The map is a bitmap of arbitrary resolution (e.g. a coarse mask around
+     * the cursor of a viewer) that is stretched over the full film, and whose
+     * first channel specifies the priority of every region. Sampling
+     * integrators that start rendering while a map is set render their passes
+     * one after the other, and hand out the blocks of each pass by decreasing
+     * priority (see \ref Spiral::set_priority_map()). The map can be replaced
+     * while rendering, the new order then takes effect in the next pass.
+     * Passing \c nullptr restores the spiral order.
+     */
+    void set_priority_map(const Bitmap *map);
+
+    /// Return the priority map (see \ref set_priority_map()), or \c nullptr
+    ref<Bitmap> priority_map() const;
+
+    /**
+     * \brief Return the metadata that is stored in the developed images
+     *
+     * Integrators use this to record information about the render, e.g.
+     * the final sample count of a render that stopped early.
+     */
+    Properties &metadata() { return m_metadata; }
+
+    /// Return the metadata that is stored in the developed images (const version)
+    const Properties &metadata() const { return m_metadata; }
+
     // =============================================================
     //! @{ \name Accessor functions
     // =============================================================
@@ -84,6 +213,18 @@ public:
         return m_filter.get();
     }
 
+    /**
+     * \brief Return the filter that should be used to splat samples into
+     * image blocks that are then passed to \ref put()
+     *
+     * This is the reconstruction filter, or a box filter when the film
+     * defers the reconstruction to the development (see \ref
+     * has_deferred_filter()).
+     */
+    const ReconstructionFilter *sample_filter() const {
+        return m_deferred_filter ? m_box_filter.get() : m_filter.get();
+    }
+
     //! @}
     // =============================================================
 
@@ -102,7 +243,25 @@ protected:
     ScalarVector2i m_crop_size;
     ScalarPoint2i m_crop_offset;
     bool m_high_quality_edges;
+    bool m_deferred_filter;
     ref<ReconstructionFilter> m_filter;
+    /// Box filter used to accumulate samples when \c m_deferred_filter is set
+    ref<ReconstructionFilter> m_box_filter;
+    /// Names of the AOVs that bypass the reconstruction filter
+    std::vector<std::string> m_unfiltered_aovs;
+    /// Names and manifests of the ID layers
+    std::vector<std::pair<std::string, std::string>> m_id_layers;
+    /// Priorities of the regions of the film (see \ref set_priority_map())
+    ref<Bitmap> m_priority_map;
+    mutable std::mutex m_priority_mutex;
+    /// Metadata of the developed images (see \ref metadata())
+    Properties m_metadata;
+
+private:
+    struct SplatBlocks;
+
+    /// Per-thread splat blocks (see \ref splat_block())
+    std::unique_ptr<SplatBlocks> m_splats;
 };
 
 MTS_EXTERN_CLASS_RENDER(Film)
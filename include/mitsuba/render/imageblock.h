@@ -100,23 +100,38 @@ public:
         if (unlikely(m_channel_count != 5))
             Throw("ImageBlock::put(): non-standard image block configuration! (AOVs?)");
 
-        UnpolarizedSpectrum value_u = depolarize(value);
-
-        Color3f xyz;
-        if constexpr (is_monochromatic_v<Spectrum>) {
-            ENOKI_MARK_USED(wavelengths);
-            xyz = value_u.x();
-        } else if constexpr (is_rgb_v<Spectrum>) {
-            ENOKI_MARK_USED(wavelengths);
-            xyz = srgb_to_xyz(value_u, active);
-        } else {
-            static_assert(is_spectral_v<Spectrum>);
-            xyz = spectrum_to_xyz(value_u, wavelengths, active);
-        }
+        Color3f xyz = to_xyz(wavelengths, value, active);
         Float values[5] = { xyz.x(), xyz.y(), xyz.z(), alpha, 1.f };
         return put(pos, values, active);
     }
 
+    /**
+     * \brief Accumulate a sample that was not generated by sampling the
+     * image plane (e.g. by tracing a path from an emitter)
+     *
+     * In contrast to \ref put(), only the color channels are incremented,
+     * while the alpha and weight channels remain unchanged. Once the block
+     * is merged into a film, the splats are hence normalized by the weight
+     * of the regular samples, i.e. a pixel should receive splats whose sum
+     * equals its sample count times its value. Like \ref put(), this method
+     * is not thread-safe, see \ref Film::splat_block() for per-thread blocks
+     * that cover the entire film.
+     *
+     * \note This method is only valid if a reconstruction filter was given at
+     * the construction of the block.
+     */
+    Mask splat(const Point2f &pos,
+               const Wavelength &wavelengths,
+               const Spectrum &value,
+               Mask active = true) {
+        if (unlikely(m_channel_count != 5))
+            Throw("ImageBlock::splat(): non-standard image block configuration! (AOVs?)");
+
+        Color3f xyz = to_xyz(wavelengths, value, active);
+        Float values[5] = { xyz.x(), xyz.y(), xyz.z(), 0.f, 0.f };
+        return put(pos, values, active);
+    }
+
     /**
      * \brief Store a single sample inside the block.
      *
@@ -141,6 +156,121 @@ public:
     /// Clear everything to zero.
     void clear();
 
+    /**
+     * \brief Exclude channels from the reconstruction filter
+     *
+     * The flagged channels are accumulated into the pixel containing the
+     * sample with unit weight, rather than over the footprint of the filter.
+     * This is cheaper and avoids blending values that should not be
+     * interpolated across edges (e.g. depth). The last channel must be
+     * flagged and receive unit values: it counts the samples of every pixel,
+     * which is used to normalize the unfiltered channels.
+     *
+     * An empty mask (the default) filters all channels.
+     *
+     * \param id_layers
+     *    Optionally assigns unfiltered channels to ID layers (e.g. for
+     *    Cryptomatte), where each run of consecutive channels with the same
+     *    nonzero layer number forms a layer. Instead of being summed, such a
+     *    layer stores a per-pixel list of (ID, weight) pairs in its channels:
+     *    a sample passes the ID in the first channel of the layer and its
+     *    weight in the second one (the remaining values are ignored), and
+     *    its weight is added to the pair with the same ID. Samples of new IDs
+     *    are dropped once all pairs are in use. Only supported in scalar
+     *    variants.
+     */
+    void set_unfiltered_channels(const std::vector<bool> &unfiltered,
+                                 const std::vector<uint32_t> &id_layers = { });
+
+    /// Are some of the channels excluded from the reconstruction filter?
+    bool has_unfiltered_channels() const { return !m_unfiltered_ranges.empty(); }
+
+    /**
+     * \brief Additionally record a bounded, depth-sorted list of samples in
+     * every pixel (i.e. a deep image)
+     *
+     * Each sample passed to \ref put() is also recorded in the pixel
+     * containing it, along with its depth taken from channel \c
+     * depth_channel. A record accumulates the XYZ and alpha values of the
+     * samples falling into its depth bin, i.e. whose depths differ from its
+     * (average) depth by at most a fraction \c merge_tolerance of the larger
+     * one. Once all \c max_samples records of a pixel are in use, the two
+     * records with the smallest relative separation are merged. Samples
+     * with zero alpha (that didn't hit a surface) are only counted. Merging
+     * blocks via \ref put(const ImageBlock *) merges their records in the
+     * same way.
+     *
+     * A value of zero for \c max_samples (the default) disables the deep
+     * samples. Only supported in scalar variants.
+     */
+    void set_deep_samples(uint32_t max_samples, uint32_t depth_channel,
+                          ScalarFloat merge_tolerance = 0.01f);
+
+    /// Return the maximum number of deep samples per pixel (see \ref set_deep_samples())
+    uint32_t deep_samples() const { return m_deep_samples; }
+
+    /**
+     * \brief Declare that the samples passed to \ref put() form a wavefront
+     * in pixel order (GPU variants)
+     *
+     * With a nonzero \c spp, a call to \ref put() whose samples cover all
+     * pixels of the block in scanline order, with \c spp consecutive
+     * samples per pixel inside that pixel (as generated by the wavefront
+     * rendering loop), computes the value of every pixel by gathering the
+     * samples of its neighbors. This avoids the atomic scatter operations
+     * into the footprint of every sample, which collide heavily when many
+     * samples contribute to the same pixels. Calls with other sample counts,
+     * normalized blocks and footprints exceeding \c max_gathers samples per
+     * pixel use the regular implementation. A value of zero (the default)
+     * disables this.
+     */
+    void set_wavefront_layout(uint32_t spp, uint32_t max_gathers = 256) {
+        m_wavefront_spp = spp;
+        m_wavefront_max_gathers = max_gathers;
+    }
+
+    /// Return the samples per pixel of the wavefront layout (see \ref set_wavefront_layout())
+    uint32_t wavefront_layout() const { return m_wavefront_spp; }
+
+    /**
+     * \brief Order the pixels of the wavefront layout in square tiles
+     *
+     * With a nonzero \c tile_size, the wavefront visits the tiles of the
+     * block in scanline order and the pixels of each tile in scanline order
+     * (tiles at the right and bottom edges are cropped). Neighboring lanes
+     * then trace rays from a compact region of the image, which improves
+     * the coherence of the traversal and texture lookups. Zero (the default)
+     * selects the scanline order of the whole block.
+     */
+    void set_wavefront_tile_size(uint32_t tile_size) { m_wavefront_tile = tile_size; }
+
+    /// Return the tile size of the wavefront layout (see \ref set_wavefront_tile_size())
+    uint32_t wavefront_tile_size() const { return m_wavefront_tile; }
+
+    /**
+     * \brief Return the pixel (relative to the block) of the given position
+     * in the wavefront layout, see \ref set_wavefront_tile_size()
+     *
+     * \c index counts pixels, i.e. it is the index of a sample divided by
+     * the number of samples per pixel.
+     */
+    Point2u wavefront_pixel(const UInt32 &index) const;
+
+    /**
+     * \brief Return the deep samples of a pixel (in the coordinates of \ref
+     * data(), i.e. including the border)
+     *
+     * The first value is the number of samples of the pixel. It is followed
+     * by \ref deep_samples() records consisting of the depth, the sample
+     * count, and the accumulated XYZ and alpha values. The used records are
+     * sorted by depth and precede the unused ones, which have a zero count.
+     */
+    const ScalarFloat *deep_pixel(const ScalarPoint2i &p) const {
+        Assert(m_deep_samples != 0);
+        ScalarVector2i size = m_size + 2 * m_border_size;
+        return m_deep.data() + (p.y() * size.x() + p.x()) * (1 + 6 * m_deep_samples);
+    }
+
     // =============================================================
     //! @{ \name Accesors
     // =============================================================
@@ -196,10 +326,64 @@ public:
 
     std::string to_string() const override;
 
+    /// Account the pixel buffer as film memory
+    void account_memory(MemoryReport *report) const override;
+
     MTS_DECLARE_CLASS()
 protected:
     /// Virtual destructor
     virtual ~ImageBlock();
+
+    /// Accumulate the channels of a sample that bypass the filter
+    void put_unfiltered(const Point2f &pos, const Float *value, Mask active);
+
+    /**
+     * \brief Accumulate a wavefront of samples in pixel order without atomics
+     * (see \ref set_wavefront_layout(), \c pos is relative to the block)
+     *
+     * Returns \c false when the samples don't match the layout.
+     */
+    bool put_wavefront(const Point2f &pos, const Float *value, Mask active);
+
+    /// Inverse of \ref wavefront_pixel()
+    UInt32 wavefront_index(const UInt32 &x, const UInt32 &y) const;
+
+    /// Accumulate another image block into this one, merging its ID layers
+    void put_ids(const ImageBlock *block);
+
+    /// Record a sample in the deep samples of the pixel containing it
+    void put_deep(const ScalarPoint2f &pos, const ScalarFloat *value);
+
+    /// Merge the deep samples of another image block into this one
+    void put_deep(const ImageBlock *block);
+
+    /**
+     * \brief Splat a sample in the scalar variants
+     *
+     * When \c Size is nonzero, it fixes the number of pixels of the filter
+     * footprint along each axis at compile time (it must then be equal to
+     * \c n), and the weights are kept on the stack unless they are read from
+     * the table of precomputed weights (see \ref m_filter_table).
+     */
+    template <uint32_t Size>
+    void put_scalar(const ScalarPoint2f &pos, const ScalarFloat *value, uint32_t n);
+
+    /// Convert a sample value into the XYZ color space
+    Color3f to_xyz(const Wavelength &wavelengths, const Spectrum &value, Mask active) const {
+        UnpolarizedSpectrum value_u = depolarize(value);
+
+        if constexpr (is_monochromatic_v<Spectrum>) {
+            ENOKI_MARK_USED(wavelengths);
+            ENOKI_MARK_USED(active);
+            return value_u.x();
+        } else if constexpr (is_rgb_v<Spectrum>) {
+            ENOKI_MARK_USED(wavelengths);
+            return srgb_to_xyz(value_u, active);
+        } else {
+            static_assert(is_spectral_v<Spectrum>);
+            return spectrum_to_xyz(value_u, wavelengths, active);
+        }
+    }
 protected:
     ScalarPoint2i m_offset;
     ScalarVector2i m_size;
@@ -208,9 +392,30 @@ protected:
     DynamicBuffer<Float> m_data;
     const ReconstructionFilter *m_filter;
     Float *m_weights_x, *m_weights_y;
+    /**
+     * \brief Precomputed weight vectors of the splat footprint
+     *
+     * Lists the weights of the \c m_filter_taps pixels of the footprint along
+     * one axis for \ref MTS_FILTER_OFFSET_RESOLUTION sub-pixel offsets of the
+     * sample (normalized if \c m_normalize is set). Empty when the filter
+     * radius is not a multiple of 0.5, in which case the weights are
+     * evaluated per sample.
+     */
+    std::vector<ScalarFloat> m_filter_table;
+    uint32_t m_filter_taps;
     bool m_warn_negative;
     bool m_warn_invalid;
     bool m_normalize;
+    /// Ranges of consecutive filtered / unfiltered channels (see \ref set_unfiltered_channels())
+    std::vector<std::pair<uint32_t, uint32_t>> m_filtered_ranges, m_unfiltered_ranges;
+    /// Channel ranges of the ID layers (see \ref set_unfiltered_channels())
+    std::vector<std::pair<uint32_t, uint32_t>> m_id_ranges;
+    /// Deep samples of every pixel (see \ref set_deep_samples() and \ref deep_pixel())
+    std::vector<ScalarFloat> m_deep;
+    uint32_t m_deep_samples;
+    uint32_t m_wavefront_spp, m_wavefront_max_gathers, m_wavefront_tile;
+    uint32_t m_depth_channel;
+    ScalarFloat m_deep_merge_tolerance;
 };
 
 MTS_EXTERN_CLASS_RENDER(ImageBlock)
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <mitsuba/core/distributed.h>
+#include <mitsuba/core/filesystem.h>
 #include <mitsuba/core/fwd.h>
 #include <mitsuba/core/object.h>
 #include <mitsuba/core/properties.h>
@@ -14,6 +16,7 @@
 #include <mitsuba/render/scene.h>
 #include <mitsuba/render/shape.h>
 #include <mitsuba/render/medium.h>
+#include <atomic>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -70,7 +73,7 @@ template <typename Float, typename Spectrum>
 class MTS_EXPORT_RENDER SamplingIntegrator : public Integrator<Float, Spectrum> {
 public:
     MTS_IMPORT_BASE(Integrator)
-    MTS_IMPORT_TYPES(Scene, Sensor, Film, ImageBlock, Medium, Sampler)
+    MTS_IMPORT_TYPES(Scene, Sensor, Film, ImageBlock, Medium, Sampler, BSDFPtr)
 
     /**
      * \brief Sample the incident radiance along a ray.
@@ -145,6 +148,50 @@ public:
                           m_render_timer.value() > 1000.f * m_timeout);
     }
 
+    /**
+     * \brief Take part in a distributed render
+     *
+     * As a \ref DistributedRole::Coordinator, \ref render() binds a socket
+     * at \c address, hands out the image blocks of all passes to the workers
+     * and accumulates their results in the film. As a \ref
+     * DistributedRole::Worker, it connects to the coordinator at \c address
+     * and renders the blocks it receives, leaving the local film untouched.
+     * All processes must load the same scene, using variants with the same
+     * color representation (e.g. \c packet_rgb and \c gpu_rgb). Only
+     * supported when Mitsuba was compiled with ZeroMQ support, except for
+     * <tt>inproc://</tt> addresses, which connect to workers of the same
+     * process (see \ref RenderCoordinator).
+     *
+     * \param render_locally
+     *     Whether a coordinator also renders blocks itself, using a worker
+     *     that runs on a separate thread
+     *
+     * \param block_size
+     *     Block size to use unless one is specified by the integrator. It
+     *     must agree between all processes and defaults to a value that
+     *     depends on the variant.
+     */
+    void set_distributed(DistributedRole role, const std::string &address,
+                         bool render_locally = false, uint32_t block_size = 0) {
+        m_distributed_role = role;
+        m_distributed_address = address;
+        m_distributed_local = render_locally;
+        m_distributed_block_size = block_size;
+    }
+
+    /**
+     * \brief Return the render time heatmap of the last call to \ref render()
+     *
+     * When the \c heatmap parameter is set, the CPU variants measure the wall
+     * time of every \ref render_block() call and spread it evenly over the
+     * pixels of the block. The result is a single-channel image of the film's
+     * crop size holding the time (in milliseconds, summed over all passes)
+     * that was spent on each pixel. It is also written to \c heatmap_file
+     * (by default, the film's destination with the extension
+     * <tt>.heatmap.exr</tt>). Returns \c nullptr when no heatmap was recorded.
+     */
+    ref<Bitmap> heatmap() const;
+
     //! @}
     // =========================================================================
 
@@ -153,13 +200,21 @@ protected:
     SamplingIntegrator(const Properties &props);
     virtual ~SamplingIntegrator();
 
+    /**
+     * \brief Render a single image block
+     *
+     * \param pixel_mask
+     *    Optional per-pixel mask (in row-major order within the block).
+     *    Pixels with a zero entry are skipped. Used by adaptive sampling.
+     */
     virtual void render_block(const Scene *scene,
                               const Sensor *sensor,
                               Sampler *sampler,
                               ImageBlock *block,
                               Float *aovs,
                               size_t sample_count,
-                              size_t block_id) const;
+                              size_t block_id,
+                              const uint32_t *pixel_mask = nullptr) const;
 
     void render_sample(const Scene *scene,
                        const Sensor *sensor,
@@ -170,6 +225,259 @@ protected:
                        ScalarFloat diff_scale_factor,
                        Mask active = true) const;
 
+    /// Per-block convergence statistics used by adaptive sampling
+    struct AdaptiveState {
+        std::unique_ptr<ScalarFloat[]> mean, m2;
+        std::unique_ptr<uint32_t[]> pixel_mask;
+        size_t size = 0;
+
+        /// Prepare for a new block with the given pixel count
+        void reset(size_t pixel_count) {
+            if (pixel_count > size) {
+                mean.reset(new ScalarFloat[pixel_count]);
+                m2.reset(new ScalarFloat[pixel_count]);
+                pixel_mask.reset(new uint32_t[pixel_count]);
+                size = pixel_count;
+            }
+            std::fill(mean.get(), mean.get() + pixel_count, 0.f);
+            std::fill(m2.get(), m2.get() + pixel_count, 0.f);
+            std::fill(pixel_mask.get(), pixel_mask.get() + pixel_count, 1u);
+        }
+    };
+
+    /**
+     * \brief Update the per-pixel statistics of an adaptively rendered block
+     * after a pass and retire the pixels that have converged.
+     *
+     * \return \c true when all pixels of the block have converged
+     */
+    bool update_adaptive_state(const ImageBlock *block, size_t pass,
+                               AdaptiveState &state) const;
+
+    /**
+     * \brief Publish a finished block of the given pass to the subscribers
+     * of the \c block_tap address (CPU variants only, see \ref BlockPublisher)
+     */
+    void publish_block(const ImageBlock *block, size_t pass) const;
+
+    /// Per-pixel statistics of the passes of a render with an error target
+    struct ErrorState {
+        /// Luminance and weight sums of the film after the previous pass
+        std::vector<ScalarFloat> y, w;
+        /// Mean and sum of squared deviations of the per-pass pixel estimates
+        std::vector<ScalarFloat> mean, m2;
+        size_t passes = 0;
+    };
+
+    /**
+     * \brief Update the statistics of a render with an error target after a
+     * pass, using the difference between the current and previous film contents
+     *
+     * The first call only records the film contents. Returns the estimated
+     * relative RMSE of the image (see \ref m_error_target), or a negative
+     * value while fewer than two passes were recorded.
+     */
+    ScalarFloat update_error_estimate(Film *film, ErrorState &state) const;
+
+    /**
+     * \brief Indicates whether the passes of a progressive render must be
+     * rendered one after another
+     *
+     * When this function returns \c true, \ref render() waits until all
+     * blocks of a pass are finished and invokes \ref pass_finished() before
+     * starting the next pass (except in adaptive mode, where every block
+     * renders all of its passes at once). This enables integrators that learn
+     * from the samples of earlier passes. The default implementation returns
+     * \c false, which lets the blocks of different passes overlap.
+     */
+    virtual bool sequential_passes() const { return false; }
+
+    /**
+     * \brief Callback invoked after every pass if \ref sequential_passes()
+     * returns \c true
+     *
+     * \param pass
+     *    Index of the pass that was just finished
+     *
+     * \param pass_count
+     *    Total number of passes of the render
+     */
+    virtual void pass_finished(size_t pass, size_t pass_count);
+
+    /**
+     * \brief Intersect the camera ray of the current sample with the scene
+     *
+     * Integrators should use this function instead of \ref Scene::ray_intersect()
+     * for the first intersection of the ray passed to \ref sample(). When the
+     * primary hit cache is enabled (scalar variants only), the preliminary
+     * intersection of every sample is stored, and reused when a later pass or
+     * render traces exactly the same ray through an unchanged scene. This skips
+     * the traversal of the acceleration data structure, but still computes the
+     * surface interaction (which depends on the ray differentials).
+     */
+    SurfaceInteraction3f ray_intersect_primary(const Scene *scene,
+                                               const Ray3f &ray,
+                                               Mask active = true) const;
+
+    /// Cached first intersection of a camera ray (see \ref ray_intersect_primary())
+    struct PrimaryHit {
+        Point3f o;
+        Vector3f d;
+        Float mint, maxt, time;
+        PreliminaryIntersection3f pi;
+        bool valid = false;
+    };
+
+    /**
+     * \brief Add the contribution of an emitter sample to \c result, unless
+     * the shadow ray between \c ref and the sampled position is occluded
+     *
+     * Integrators should use this function instead of passing
+     * <tt>test_visibility=true</tt> to \ref Scene::sample_emitter_direction().
+     * When shadow ray batching is enabled (scalar variants only),
+     * \ref render_block() collects the shadow rays of many samples and traces
+     * them together using \ref Scene::ray_test_batch(). The contribution is
+     * then added to the result of the current sample once the batch has been
+     * traced, hence \ref sample() must return \c result without processing it
+     * any further.
+     *
+     * Shadow rays with a zero contribution are not traced at all.
+     */
+    void add_unoccluded(const Scene *scene, const Interaction3f &ref,
+                        const DirectionSample3f &ds, const Spectrum &value,
+                        Spectrum &result, Mask active = true) const;
+
+    /**
+     * \brief Sample an emitter direction for next event estimation using
+     * resampled importance sampling (RIS)
+     *
+     * Draws \ref m_ris_candidates candidates using
+     * \ref Scene::sample_emitter_direction() (or \ref
+     * Scene::sample_emitter_direction_lobe() with the given lobe when product
+     * sampling is enabled, see \ref emitter_lobe()) without testing their
+     * visibility, and resamples one of them proportionally to its unshadowed
+     * contribution (BSDF times emitted radiance). Only the returned
+     * direction then requires a shadow ray.
+     *
+     * The returned emitter weight is scaled such that the product with the
+     * returned BSDF value is an unbiased estimate of the direct illumination.
+     * The density in the direction sample is the one of an individual
+     * candidate, which is the one that multiple importance sampling with BSDF
+     * sampling must use (via \ref pdf_emitter_lobe()).
+     *
+     * With a single candidate, this function is equivalent to sampling the
+     * emitter and evaluating the BSDF in the sampled direction.
+     *
+     * \return
+     *     The direction sample (with a zero density if no candidate contributes),
+     *     the scaled emitter weight, and the BSDF value and density (both
+     *     already including the cosine foreshortening factor).
+     */
+    std::tuple<DirectionSample3f, Spectrum, Spectrum, Float>
+    sample_emitter_ris(const Scene *scene, Sampler *sampler,
+                       const SurfaceInteraction3f &si, const BSDFPtr &bsdf,
+                       const Vector3f &lobe_axis, const Float &lobe_exponent,
+                       Mask active = true) const;
+
+    /**
+     * \brief Lobe of the BSDF at \c si that emitters importance sample at
+     * the same time as their emission (see \ref Emitter::sample_direction_lobe())
+     *
+     * This is the cosine foreshortening around the shading normal for
+     * reflective BSDFs, or a Phong-like lobe with exponent \ref
+     * m_lobe_exponent around the mirror direction for glossy BSDFs without a
+     * diffuse component. The exponent is zero (i.e. emitters ignore the lobe)
+     * for BSDFs that transmit light, or when product sampling is disabled.
+     *
+     * \return The axis of the lobe in world space and its exponent
+     */
+    std::pair<Vector3f, Float> emitter_lobe(const SurfaceInteraction3f &si,
+                                            const UInt32 &bsdf_flags) const;
+
+    /**
+     * \brief Density of sampling \c ds in \ref sample_emitter_ris() with
+     * the lobe returned by \ref emitter_lobe(), as needed by multiple
+     * importance sampling with BSDF sampling
+     */
+    Float pdf_emitter_lobe(const Scene *scene, const Interaction3f &ref,
+                           const DirectionSample3f &ds, const Vector3f &lobe_axis,
+                           const Float &lobe_exponent, Mask active = true) const;
+
+    /// Samples and shadow rays deferred by \ref render_block() (see \ref add_unoccluded())
+    struct ShadowQueue {
+        /// Integrator whose samples are deferred (nested integrators trace immediately)
+        const SamplingIntegrator *owner = nullptr;
+
+        // Per shadow ray: ray, contribution and index of the sample
+        std::vector<Ray3f> rays;
+        std::vector<Spectrum> values;
+        std::vector<uint32_t> targets;
+        std::unique_ptr<Mask[]> hit;
+        size_t hit_size = 0;
+
+        // Per sample: state needed to splat it into the image block
+        std::vector<Vector2f> positions;
+        std::vector<Wavelength> wavelengths;
+        std::vector<Spectrum> ray_weights, results;
+        std::vector<Mask> valid;
+        std::vector<Float> aovs;
+
+        /// Discard all queued samples and shadow rays
+        void clear() {
+            rays.clear();
+            values.clear();
+            targets.clear();
+            positions.clear();
+            wavelengths.clear();
+            ray_weights.clear();
+            results.clear();
+            valid.clear();
+            aovs.clear();
+        }
+    };
+
+    /// Trace the shadow rays of the queue and splat its samples into \c block
+    void flush_shadow_queue(const Scene *scene, ImageBlock *block, Float *aovs,
+                            ShadowQueue &queue) const;
+
+    /// Convert the radiance of a sample to XYZ and splat it into \c block
+    void put_sample(ImageBlock *block, Float *aovs, const Vector2f &position,
+                    const Wavelength &wavelengths, const Spectrum &value,
+                    Mask valid, Mask active) const;
+
+    /// Return the checkpoint file of the given film (empty if unknown)
+    fs::path checkpoint_path(const Film *film) const;
+
+    /**
+     * \brief Load the checkpoint of a previous, interrupted render into the film
+     *
+     * \return
+     *    The number of passes that were already rendered (zero if no
+     *    checkpoint exists)
+     */
+    size_t restore_checkpoint(Film *film, size_t pass_count, size_t samples_per_pass) const;
+
+    /**
+     * \brief Snapshot the film after \c passes_done passes and write it to
+     * the checkpoint file on a background thread
+     *
+     * The checkpoint is skipped when the previous one is still being written.
+     */
+    void write_checkpoint(Film *film, size_t passes_done, size_t pass_count,
+                          size_t samples_per_pass);
+
+    /// Implementation of \ref render() for the coordinator and workers of a distributed render
+    void render_distributed(const Scene *scene, Sensor *sensor,
+                            const std::vector<std::string> &channels,
+                            size_t samples_per_pass, size_t pass_count);
+
+    /// Render the blocks of the coordinator at \c address, returns the number of blocks
+    size_t render_distributed_worker(const Scene *scene, Sensor *sensor,
+                                     const std::vector<std::string> &channels,
+                                     const std::string &address,
+                                     const std::string &configuration,
+                                     size_t samples_per_pass, size_t pass_count);
+
 protected:
     /// Integrators should stop all work when this flag is set to true.
     bool m_stop;
@@ -185,6 +493,33 @@ protected:
      */
     uint32_t m_samples_per_pass;
 
+    /**
+     * \brief Memory budget (in MiB) of a wavefront in the GPU variants
+     *
+     * Frames whose wavefront would exceed the budget are rendered as a
+     * sequence of horizontal slabs (and, if needed, of smaller sample batches).
+     * Zero disables the partitioning.
+     */
+    size_t m_wavefront_budget;
+
+    /**
+     * \brief Size of the square pixel tiles that the wavefronts of the GPU
+     * variants traverse (see \ref ImageBlock::set_wavefront_tile_size())
+     *
+     * Zero selects the scanline order.
+     */
+    uint32_t m_wavefront_tile_size;
+
+    /**
+     * \brief Seed the sampler of every pixel based on its film coordinates
+     * and the pass index (CPU variants)
+     *
+     * The result then no longer depends on the block size, the thread count
+     * or the spiral order, and sub-rectangles or pass ranges of a frame can be
+     * rendered separately and merged to the same image.
+     */
+    bool m_pixel_seeds;
+
     /**
      * \brief Maximum amount of time to spend rendering (excluding scene parsing).
      *
@@ -197,6 +532,86 @@ protected:
 
     /// Flag for disabling direct visibility of emitters
     bool m_hide_emitters;
+
+    /**
+     * \brief Relative error threshold used by adaptive sampling
+     *
+     * A non-positive value disables adaptive sampling (default).
+     */
+    float m_adaptive_threshold;
+
+    /// Minimum number of passes before a pixel can be retired (or the error target is tested)
+    uint32_t m_adaptive_min_passes;
+
+    /**
+     * \brief Relative RMSE at which a progressive render stops (CPU variants)
+     *
+     * After every pass, the variance of each pixel is estimated from the
+     * results of the individual passes. The render stops once the root mean
+     * square of the standard errors relative to the pixel values drops below
+     * this target, or when the timeout expires. A non-positive value
+     * disables this (default).
+     */
+    float m_error_target;
+
+    /// Write a checkpoint of the film every N passes (0: disabled)
+    uint32_t m_checkpoint_passes;
+
+    /// Write a checkpoint when this many seconds passed since the last one (<= 0: disabled)
+    float m_checkpoint_interval;
+
+    /// Checkpoint filename (by default derived from the film's destination)
+    fs::path m_checkpoint_file;
+
+    /// Continue from an existing checkpoint?
+    bool m_checkpoint_resume;
+
+    /// Is a checkpoint currently being written?
+    std::atomic<bool> m_checkpoint_pending;
+
+    /// Role and address for distributed rendering (see \ref set_distributed())
+    DistributedRole m_distributed_role = DistributedRole::None;
+    std::string m_distributed_address;
+    bool m_distributed_local = false;
+    uint32_t m_distributed_block_size = 0;
+
+    /// Publisher of finished blocks for remote previews (\c block_tap property)
+    ref<BlockPublisher> m_block_tap;
+
+    /// Cache the primary hits of all samples (see \ref ray_intersect_primary())
+    bool m_primary_cache;
+
+    /// Primary hits of all samples of the film, in pixel-major order
+    std::unique_ptr<PrimaryHit[]> m_primary_hits;
+    size_t m_primary_hit_count = 0;
+
+    /// Geometry revision of the scene that the cached primary hits refer to
+    uint32_t m_primary_hit_revision = 0;
+
+    /// Record the time spent on each image block (see \ref heatmap())
+    bool m_heatmap;
+
+    /// Heatmap filename (by default derived from the film's destination)
+    fs::path m_heatmap_file;
+
+    /// Accumulated per-pixel render time in milliseconds (row-major, crop size)
+    std::vector<float> m_heatmap_data;
+    ScalarVector2i m_heatmap_size = 0;
+
+    /// Pin the render threads to NUMA nodes on multi-socket machines (CPU variants)
+    bool m_numa;
+
+    /// Number of shadow rays traced together (scalar variants, 0: disabled)
+    size_t m_shadow_batch;
+
+    /// Number of emitter candidates per shading point (see \ref sample_emitter_ris())
+    size_t m_ris_candidates;
+
+    /// Sample the emitters proportionally to a BSDF lobe (see \ref emitter_lobe())
+    bool m_product_sampling;
+
+    /// Exponent of the lobe of glossy BSDFs (see \ref emitter_lobe())
+    ScalarFloat m_lobe_exponent;
 };
 
 /*
@@ -130,6 +130,9 @@ struct SurfaceInteraction : Interaction<Float_, Spectrum_> {
     /// Stores a pointer to the parent instance (if applicable)
     ShapePtr instance = nullptr;
 
+    /// Index of the instance within its parent instancer (if applicable)
+    Index instance_index;
+
     //! @}
     // =============================================================
 
@@ -147,10 +150,20 @@ struct SurfaceInteraction : Interaction<Float_, Spectrum_> {
     explicit SurfaceInteraction(const PositionSample3f &ps,
                                 const Wavelength &wavelengths)
         : Base(0.f, ps.time, wavelengths, ps.p), uv(ps.uv), n(ps.n),
-          sh_frame(Frame3f(ps.n)) { }
+          sh_frame(Frame3f(ps.n)), prim_index(ps.prim_index) { }
 
-    /// Initialize local shading frame using Gram-schmidt orthogonalization
-    void initialize_sh_frame() {
+    /**
+     * \brief Initialize local shading frame using Gram-schmidt orthogonalization
+     *
+     * \param has_dp_du
+     *     Whether \ref dp_du was computed. Otherwise, an arbitrary tangent
+     *     perpendicular to the shading normal is used.
+     */
+    void initialize_sh_frame(bool has_dp_du = true) {
+        if (!has_dp_du) {
+            sh_frame = Frame3f(sh_frame.n);
+            return;
+        }
         sh_frame.s = normalize(fnmadd(sh_frame.n, dot(sh_frame.n, dp_du), dp_du));
         sh_frame.t = cross(sh_frame.n, sh_frame.s);
     }
@@ -357,7 +370,7 @@ struct SurfaceInteraction : Interaction<Float_, Spectrum_> {
     ENOKI_DERIVED_STRUCT(SurfaceInteraction, Base,
         ENOKI_BASE_FIELDS(t, time, wavelengths, p),
         ENOKI_DERIVED_FIELDS(shape, uv, n, sh_frame, dp_du, dp_dv, dn_du, dn_dv,
-                             duv_dx, duv_dy, wi, prim_index, instance)
+                             duv_dx, duv_dy, wi, prim_index, instance, instance_index)
     )
 };
 
@@ -469,7 +482,7 @@ enum class HitComputeFlags : uint32_t {
     // =============================================================
 
     /// Force computed fields to not be be differentiable
-    NonDifferentiable     = 0x00020,
+    NonDifferentiable     = 0x00040,
 
     // =============================================================
     //!                 Compound compute flags
@@ -480,6 +493,14 @@ enum class HitComputeFlags : uint32_t {
 
     /// Compute all fields of the surface interaction data structure in a non differentiable way
     AllNonDifferentiable = UV | dPdUV | ShadingFrame | NonDifferentiable,
+
+    /**
+     * Compute the fields needed to evaluate emitters and null transmission at
+     * an intersection that does not continue the path (e.g. along shadow
+     * connections). The shading frame is built around the shading normal
+     * without position partials.
+     */
+    Connection = UV | ShadingFrame,
 };
 
 constexpr HitComputeFlags operator|(HitComputeFlags f1, HitComputeFlags f2) {
@@ -585,7 +606,7 @@ struct PreliminaryIntersection {
         si.wavelengths = ray.wavelengths;
 
         if (has_flag(flags, HitComputeFlags::ShadingFrame))
-            si.initialize_sh_frame();
+            si.initialize_sh_frame(has_flag(flags, HitComputeFlags::dPdUV));
 
         // Incident direction in local coordinates
         si.wi = select(active, si.to_local(-ray.d), -ray.d);
@@ -697,7 +718,7 @@ ENOKI_STRUCT_SUPPORT(mitsuba::Interaction, t, time, wavelengths, p)
 
 ENOKI_STRUCT_SUPPORT(mitsuba::SurfaceInteraction, t, time, wavelengths, p,
                      shape, uv, n, sh_frame, dp_du, dp_dv, dn_du, dn_dv, duv_dx, duv_dy, wi,
-                     prim_index, instance)
+                     prim_index, instance, instance_index)
 
 ENOKI_STRUCT_SUPPORT(mitsuba::MediumInteraction, t, time, wavelengths, p,
                      medium, sh_frame, wi, sigma_s, sigma_n, sigma_t, combined_extinction, mint)
@@ -2,6 +2,7 @@
 
 #include <unordered_set>
 #include <mitsuba/core/bbox.h>
+#include <mitsuba/core/filesystem.h>
 #include <mitsuba/core/fwd.h>
 #include <mitsuba/core/logger.h>
 #include <mitsuba/core/math.h>
@@ -32,6 +33,19 @@
  */
 #define MTS_KD_INTERSECTION_CACHE_SIZE 6
 
+/**
+ * Number of recently tested primitives that every ray (packet) remembers, so
+ * that primitives referenced by several leaves are only tested once
+ */
+#define MTS_KD_MAILBOX_SIZE 8
+
+/// Number of triangles that are tested at once in kd-tree leaves (scalar variants)
+#if defined(ENOKI_X86_AVX)
+#  define MTS_KD_TRIANGLE_PACKET 8
+#else
+#  define MTS_KD_TRIANGLE_PACKET 4
+#endif
+
 NAMESPACE_BEGIN(mitsuba)
 
 /**
@@ -183,6 +197,24 @@ public:
         m_exact_prim_threshold = value;
     }
 
+    /**
+     * \brief Return the maximum number of primitive references per
+     * primitive (0: unlimited)
+     */
+    Scalar max_duplication() const { return m_max_duplication; }
+
+    /**
+     * \brief Limit the number of primitive references per primitive
+     *
+     * Primitives that straddle split planes are referenced by several
+     * leaves. Once the tree would exceed the given budget (e.g. \c 2 for
+     * twice as many references as primitives), nodes whose best split
+     * duplicates primitives become leaves instead. This bounds the memory
+     * usage of the build and of the final tree at the cost of traversal
+     * performance. The default (\c 0) doesn't limit duplication.
+     */
+    void set_max_duplication(Scalar value) { m_max_duplication = value; }
+
     /// Return the log level of kd-tree status messages
     LogLevel log_level() const { return m_log_level; }
 
@@ -567,6 +599,8 @@ protected:
         std::atomic<size_t> pruned {0};
         std::atomic<size_t> temp_storage {0};
         std::atomic<size_t> work_units {0};
+        std::atomic<size_t> references {0};
+        size_t max_references = 0;
         double exp_traversal_steps = 0;
         double exp_leaves_visited = 0;
         double exp_primitives_queried = 0;
@@ -576,6 +610,21 @@ protected:
         Size prim_buckets[16] { };
 
         BuildContext(const Derived &derived) : derived(derived) { }
+
+        /**
+         * \brief Account for \c count additional primitive references
+         *
+         * Returns \c false (and changes nothing) when this would exceed the
+         * budget set via \ref set_max_duplication().
+         */
+        bool reserve_references(size_t count) {
+            if (max_references == 0 || count == 0)
+                return true;
+            if (references.fetch_add(count) + count <= max_references)
+                return true;
+            references -= count;
+            return false;
+        }
     };
 
     /// Data type for split candidates suggested by the tree cost model
@@ -1066,6 +1115,13 @@ protected:
                 m_ctx.bad_refines++;
             }
 
+            /* Stop duplicating primitives once the memory budget is used up */
+            if (best.left_count + best.right_count > prim_count &&
+                !m_ctx.reserve_references(best.left_count + best.right_count - prim_count)) {
+                make_leaf(std::move(m_indices));
+                return nullptr;
+            }
+
             /* ==================================================================== */
             /*                            Partitioning                              */
             /* ==================================================================== */
@@ -1270,6 +1326,13 @@ protected:
                 m_ctx.bad_refines++;
             }
 
+            /* Stop duplicating primitives once the memory budget is used up */
+            if (best.left_count + best.right_count > prim_count &&
+                !m_ctx.reserve_references(best.left_count + best.right_count - prim_count)) {
+                make_leaf(node, prim_count, events_start, events_end);
+                return leaf_cost;
+            }
+
             /* ==================================================================== */
             /*                      Primitive Classification                        */
             /* ==================================================================== */
@@ -1483,8 +1546,8 @@ protected:
                 m_ctx.pruned += pruned_left + pruned_right;
 
                 /* Sort the events due to primitives which overlap the split plane */
-                std::sort(new_left_events_start, new_left_events_end);
-                std::sort(new_right_events_start, new_right_events_end);
+                sort_events(new_left_events_start, new_left_events_end);
+                sort_events(new_right_events_start, new_right_events_end);
 
                 /* Merge the left list */
                 left_events_end = std::merge(temp_left_events_start,
@@ -1580,38 +1643,52 @@ protected:
                 m_local->left_alloc.template allocate<EdgeEvent>(initial_size),
                 *events_end = events_start + initial_size;
 
-            for (Size i = 0; i<prim_count; ++i) {
-                Index prim_index = m_indices[i];
-                BoundingBox prim_bbox = derived.bbox(prim_index, m_bbox);
-                bool valid = prim_bbox.valid() && prim_bbox.surface_area() > 0;
-
-                if (unlikely(!valid)) {
-                    --final_prim_count;
-                    m_ctx.pruned++;
-                }
-
-                for (Index axis = 0; axis < Dimension; ++axis) {
-                    Scalar min = prim_bbox.min[axis], max = prim_bbox.max[axis];
-                    Index offset = (Index) (axis * prim_count + i) * 2;
-
-                    if (unlikely(!valid)) {
-                        events_start[offset  ].set_invalid();
-                        events_start[offset+1].set_invalid();
-                    } else if (min == max) {
-                        events_start[offset  ] = EdgeEvent(EdgeEvent::Type::EdgePlanar, axis, min, prim_index);
-                        events_start[offset+1].set_invalid();
-                    } else {
-                        events_start[offset  ] = EdgeEvent(EdgeEvent::Type::EdgeStart, axis, min, prim_index);
-                        events_start[offset+1] = EdgeEvent(EdgeEvent::Type::EdgeEnd,   axis, max, prim_index);
+            /* Clipping the primitives against the node bounds is costly, so
+               the events are created in parallel */
+            std::atomic<Size> invalid_count { 0 };
+            tbb::this_task_arena::isolate([&]() {
+                tbb::parallel_for(
+                    tbb::blocked_range<Size>(0u, prim_count, MTS_KD_GRAIN_SIZE),
+                    [&](const tbb::blocked_range<Size> &range) {
+                        Size invalid = 0;
+                        for (Size i = range.begin(); i != range.end(); ++i) {
+                            Index prim_index = m_indices[i];
+                            BoundingBox prim_bbox = derived.bbox(prim_index, m_bbox);
+                            bool valid = prim_bbox.valid() && prim_bbox.surface_area() > 0;
+
+                            if (unlikely(!valid))
+                                invalid++;
+
+                            for (Index axis = 0; axis < Dimension; ++axis) {
+                                Scalar min = prim_bbox.min[axis], max = prim_bbox.max[axis];
+                                Index offset = (Index) (axis * prim_count + i) * 2;
+
+                                if (unlikely(!valid)) {
+                                    events_start[offset  ].set_invalid();
+                                    events_start[offset+1].set_invalid();
+                                } else if (min == max) {
+                                    events_start[offset  ] = EdgeEvent(EdgeEvent::Type::EdgePlanar, axis, min, prim_index);
+                                    events_start[offset+1].set_invalid();
+                                } else {
+                                    events_start[offset  ] = EdgeEvent(EdgeEvent::Type::EdgeStart, axis, min, prim_index);
+                                    events_start[offset+1] = EdgeEvent(EdgeEvent::Type::EdgeEnd,   axis, max, prim_index);
+                                }
+                            }
+                        }
+                        if (invalid > 0)
+                            invalid_count += invalid;
                     }
-                }
-            }
+                );
+            });
+
+            final_prim_count -= invalid_count;
+            m_ctx.pruned += invalid_count;
 
             /* Release index list */
             IndexVector().swap(m_indices);
 
             /* Sort the events list and remove invalid ones from the end */
-            std::sort(events_start, events_end);
+            sort_events(events_start, events_end);
             while (events_start != events_end && !(events_end-1)->valid())
                 --events_end;
 
@@ -1628,6 +1705,19 @@ protected:
             return cost;
         }
 
+        /**
+         * \brief Sort a list of edge events (in parallel if it is large)
+         *
+         * Waiting threads are isolated so that they can't pick up another
+         * build task, which would reuse the thread-local build context.
+         */
+        static void sort_events(EdgeEvent *start, EdgeEvent *end) {
+            if (end - start < (std::ptrdiff_t) MTS_KD_GRAIN_SIZE)
+                std::sort(start, end);
+            else
+                tbb::this_task_arena::isolate([&]() { tbb::parallel_sort(start, end); });
+        }
+
         /// Create a leaf node using the given set of indices (called by min-max binning)
         template <typename T> void make_leaf(T &&indices) {
             auto it = m_ctx.index_storage.grow_by(indices.begin(), indices.end());
@@ -1738,6 +1828,8 @@ protected:
             m_clip_primitives ? "yes" : "no");
         Log(m_log_level, "   Retract bad splits       : %s",
             m_retract_bad_splits ? "yes" : "no");
+        if (m_max_duplication > 0)
+            Log(m_log_level, "   Max. duplication         : %.2f", m_max_duplication);
         Log(m_log_level, "");
 
         /* ==================================================================== */
@@ -1751,6 +1843,11 @@ protected:
 
         ctx.node_storage.grow_by(1);
 
+        ctx.references = prim_count;
+        if (m_max_duplication > 0)
+            ctx.max_references =
+                std::max((size_t) prim_count, (size_t) (m_max_duplication * prim_count));
+
         /* ==================================================================== */
         /*                      Build the tree in parallel                      */
         /* ==================================================================== */
@@ -1766,8 +1863,13 @@ protected:
                 util::mem_string(prim_count * sizeof(Index)).c_str());
 
             IndexVector indices(prim_count);
-            for (size_t i = 0; i < prim_count; ++i)
-                indices[i] = (Index) i;
+            tbb::parallel_for(
+                tbb::blocked_range<Size>(0u, prim_count, MTS_KD_GRAIN_SIZE),
+                [&](const tbb::blocked_range<Size> &range) {
+                    for (Size i = range.begin(); i != range.end(); ++i)
+                        indices[i] = (Index) i;
+                }
+            );
 
             BuildTask &task = *new (tbb::task::allocate_root()) BuildTask(
                 ctx, ctx.node_storage.begin(), std::move(indices),
@@ -1778,6 +1880,10 @@ protected:
 
         Log(m_log_level, "Structural kd-tree statistics:");
 
+        /* Release the per-thread build memory before the final copy, which
+           otherwise determines the peak memory usage of the build */
+        ctx.local.clear();
+
         /* ==================================================================== */
         /*     Store the node and index lists in a compact contiguous format    */
         /* ==================================================================== */
@@ -1819,9 +1925,6 @@ protected:
         if (Thread::thread()->logger()->log_level() <= m_log_level) {
             compute_statistics(ctx, m_nodes.get(), m_bbox, 0);
 
-            // Trigger per-thread data release
-            ctx.local.clear();
-
             ctx.exp_traversal_steps /= (double) CostModel::eval(m_bbox);
             ctx.exp_leaves_visited /= (double) CostModel::eval(m_bbox);
             ctx.exp_primitives_queried /= (double) CostModel::eval(m_bbox);
@@ -1894,6 +1997,7 @@ protected:
     Size m_max_bad_refines = 0;
     Size m_exact_prim_threshold = 65536;
     Size m_min_max_bins = 128;
+    Scalar m_max_duplication = 0;
     LogLevel m_log_level = Debug;
     BoundingBox m_bbox;
 };
@@ -2018,6 +2122,29 @@ public:
 
     using Base = TShapeKDTree<ScalarBoundingBox3f, uint32_t, SurfaceAreaHeuristic3f, ShapeKDTree>;
     using typename Base::KDNode;
+
+    using PacketFloat    = Packet<ScalarFloat, MTS_KD_TRIANGLE_PACKET>;
+    using PacketUInt32   = Packet<uint32_t, MTS_KD_TRIANGLE_PACKET>;
+    using PacketMask     = mask_t<PacketFloat>;
+    using PacketVector3f = Vector<PacketFloat, 3>;
+
+    /**
+     * \brief Triangles of a kd-tree leaf in SoA layout, which are tested
+     * against a single ray at once (Moeller-Trumbore)
+     *
+     * Unused lanes have a NaN vertex position so that they never report an
+     * intersection.
+     */
+    struct TrianglePacket {
+        PacketVector3f p0, e1, e2;
+        PacketUInt32 prim_index, shape_index;
+    };
+
+    /// Triangle packets of a kd-tree leaf (indexed by its primitive offset)
+    struct LeafTriangles {
+        Index packet_offset;
+        Index triangle_count;
+    };
     using Base::ready;
     using Base::set_clip_primitives;
     using Base::set_exact_primitive_threshold;
@@ -2025,6 +2152,14 @@ public:
     using Base::set_min_max_bins;
     using Base::set_retract_bad_splits;
     using Base::set_stop_primitives;
+    using Base::clip_primitives;
+    using Base::cost_model;
+    using Base::exact_primitive_threshold;
+    using Base::max_bad_refines;
+    using Base::max_depth;
+    using Base::min_max_bins;
+    using Base::retract_bad_splits;
+    using Base::stop_primitives;
     using Base::bbox;
     using Base::m_bbox;
     using Base::m_nodes;
@@ -2041,6 +2176,16 @@ public:
     /// Build the kd-tree
     void build();
 
+    /**
+     * \brief Update the kd-tree after the registered shapes were modified
+     *
+     * A kd-tree cannot be refit, hence the tree is rebuilt. This only happens
+     * when the geometry actually changed since the last build.
+     *
+     * \return \c true when the tree was rebuilt
+     */
+    bool update();
+
     /// Return the number of registered shapes
     Size shape_count() const { return Size(m_shapes.size()); }
 
@@ -2092,6 +2237,10 @@ public:
         // Resulting intersection struct
         PreliminaryIntersection3f pi;
 
+        // Primitives are only tested repeatedly when some are referenced by several leaves
+        Mailbox mailbox;
+        bool use_mailbox = m_index_count > primitive_count();
+
         // Intersect against the scene bounding box
         auto bbox_result = m_bbox.ray_intersect(ray);
 
@@ -2139,8 +2288,29 @@ public:
             } else if (node->primitive_count() > 0) { // Arrived at a leaf node
                 Index prim_start = node->primitive_offset();
                 Index prim_end = prim_start + node->primitive_count();
+
+                /* The triangles come first in the leaf and are intersected
+                   several at a time (if enabled), then the other shapes */
+                if (m_leaf_triangles) {
+                    const LeafTriangles &leaf = m_leaf_triangles[prim_start];
+                    const TrianglePacket *packet = m_triangle_packets.data() + leaf.packet_offset;
+                    for (Index i = 0; i < leaf.triangle_count;
+                         i += MTS_KD_TRIANGLE_PACKET, ++packet) {
+                        if (unlikely(intersect_triangle_packet<ShadowRay>(*packet, ray, pi))) {
+                            if constexpr (ShadowRay)
+                                return pi;
+
+                            Assert(pi.t >= ray.mint && pi.t <= ray.maxt);
+                            ray.maxt = pi.t;
+                        }
+                    }
+                    prim_start += leaf.triangle_count;
+                }
+
                 for (Index i = prim_start; i < prim_end; i++) {
                     Index prim_index = m_indices[i];
+                    if (use_mailbox && !mailbox.insert(prim_index, true))
+                        continue;
 
                     PreliminaryIntersection3f prim_pi =
                         intersect_prim<ShadowRay>(prim_index, ray, true);
@@ -2171,8 +2341,45 @@ public:
     }
 
     template <bool ShadowRay>
-    MTS_INLINE PreliminaryIntersection3f ray_intersect_packet(Ray3f ray,
+    MTS_INLINE PreliminaryIntersection3f ray_intersect_packet(const Ray3f &ray,
                                                               Mask active) const {
+        if (!m_split_packets)
+            return traverse_packet<ShadowRay, false>(ray, active);
+
+        /* Lanes whose directions lie in different octants go different ways
+           through the tree. Trace each octant separately so that (divergent)
+           secondary rays don't visit the union of all nodes of the packet. */
+        UInt32 octant = select(ray.d_rcp.x() < 0.f, UInt32(1u), UInt32(0u)) |
+                        select(ray.d_rcp.y() < 0.f, UInt32(2u), UInt32(0u)) |
+                        select(ray.d_rcp.z() < 0.f, UInt32(4u), UInt32(0u));
+
+        PreliminaryIntersection3f pi;
+        while (true) {
+            uint32_t first = hmin(select(active, octant, UInt32(8u)));
+            if (first == 8u)
+                break;
+
+            Mask group = active && eq(octant, first);
+            if (all(group || !active))
+                return traverse_packet<ShadowRay, true>(ray, active);
+
+            masked(pi, group) = traverse_packet<ShadowRay, true>(ray, group);
+            active &= !group;
+        }
+
+        return pi;
+    }
+
+    /**
+     * \brief Traverse the tree with a packet of rays
+     *
+     * When \c Coherent is set, the directions of all active lanes must lie
+     * in the same octant. The children of an inner node are then visited in
+     * the same order by all lanes, which avoids the majority vote.
+     */
+    template <bool ShadowRay, bool Coherent>
+    MTS_INLINE PreliminaryIntersection3f traverse_packet(Ray3f ray,
+                                                         Mask active) const {
         /// Ray traversal stack entry
         struct KDStackEntry {
             // Ray distance associated with the node entry and exit point
@@ -2190,6 +2397,10 @@ public:
         // Resulting intersection struct
         PreliminaryIntersection3f pi;
 
+        // Primitives are only tested repeatedly when some are referenced by several leaves
+        Mailbox mailbox;
+        bool use_mailbox = m_index_count > primitive_count();
+
         const KDNode *node = m_nodes.get();
 
         /* Intersect against the scene bounding box */
@@ -2203,7 +2414,48 @@ public:
                 active = active && !pi.is_valid();
 
             if (likely(any(active))) {
-                if (likely(!node->leaf())) { // Inner node
+                if (Coherent && likely(!node->leaf())) { // Inner node (coherent)
+                    const scalar_t<Float> split = node->split();
+                    const uint32_t axis = node->axis();
+
+                    // Compute parametric distance along the rays to the split plane
+                    Float t_plane = (split - ray.o[axis]) * ray.d_rcp[axis];
+
+                    /* All lanes enter the near child first. NaNs (ray origin on
+                       the plane, parallel direction) only visit the near child */
+                    Mask only_near  = !(t_plane <= maxt),
+                         only_far   = !only_near && (t_plane < mint || t_plane < 0.f),
+                         visit_both = !(only_near || only_far),
+                         visit_near = active && !only_far,
+                         visit_far  = active && !only_near;
+
+                    bool near_left = none(active && ray.d_rcp[axis] < 0.f);
+                    const KDNode *left   = node->left(),
+                                 *n_near = left + (near_left ? 0 : 1),
+                                 *n_far  = left + (near_left ? 1 : 0);
+
+                    /* If we only need to visit one node, just pick the correct one and continue */
+                    if (none(visit_far)) {
+                        node = n_near;
+                        continue;
+                    } else if (none(visit_near)) {
+                        node = n_far;
+                        continue;
+                    }
+
+                    /* Postpone visit to 'n_far' */
+                    KDStackEntry& entry = stack[stack_index++];
+                    entry.mint = select(visit_both, t_plane, mint);
+                    entry.maxt = maxt;
+                    entry.active = visit_far;
+                    entry.node = n_far;
+
+                    /* Visit 'n_near' now */
+                    maxt = select(visit_both, t_plane, maxt);
+                    active = visit_near;
+                    node = n_near;
+                    continue;
+                } else if (likely(!node->leaf())) { // Inner node
                     const scalar_t<Float> split = node->split();
                     const uint32_t axis = node->axis();
 
@@ -2265,9 +2517,15 @@ public:
                     Index prim_end = prim_start + node->primitive_count();
                     for (Index i = prim_start; i < prim_end; i++) {
                         Index prim_index = m_indices[i];
+                        Mask prim_active = active;
+                        if (use_mailbox) {
+                            prim_active = mailbox.insert(prim_index, active);
+                            if (none(prim_active))
+                                continue;
+                        }
 
                         PreliminaryIntersection3f prim_pi =
-                            intersect_prim<ShadowRay>(prim_index, ray, active);
+                            intersect_prim<ShadowRay>(prim_index, ray, prim_active);
 
                         masked(pi, prim_pi.is_valid()) = prim_pi;
 
@@ -2323,6 +2581,9 @@ public:
     /// Return a human-readable string representation of the scene contents.
     virtual std::string to_string() const override;
 
+    /// Account the nodes, indices and triangle packets (the shapes belong to the scene)
+    virtual void account_memory(MemoryReport *report) const override;
+
     MTS_DECLARE_CLASS()
 protected:
     /**
@@ -2370,9 +2631,12 @@ protected:
             Mask hit;
             if (shape->is_mesh()) {
                 const Mesh *mesh = (const Mesh *) shape;
-                hit = mesh->ray_intersect_triangle(prim_index, ray, active).is_valid();
+                pi = mesh->ray_intersect_triangle(prim_index, ray, active);
+                hit = pi.is_valid();
+                if (unlikely(mesh->has_alpha_mask()))
+                    hit &= mesh->alpha_test(ray, pi, hit);
             } else {
-                hit = shape->ray_test(ray, active);
+                hit = shape->ray_test_primitive(prim_index, ray, active);
             }
 
             pi.t = select(hit, Float(0.f), math::Infinity<Float>);
@@ -2381,17 +2645,166 @@ protected:
             if (shape->is_mesh()) {
                 const Mesh *mesh = (const Mesh *) shape;
                 pi = mesh->ray_intersect_triangle(prim_index, ray, active);
+
+                // Skip intersections with transparent regions and continue the traversal
+                if (unlikely(mesh->has_alpha_mask()))
+                    masked(pi.t, !mesh->alpha_test(ray, pi, active)) = math::Infinity<Float>;
             } else {
-                pi = shape->ray_intersect_preliminary(ray, active);
+                pi = shape->ray_intersect_primitive(prim_index, ray, active);
             }
 
             return pi;
         }
     }
 
+    /**
+     * \brief Ring buffer of the primitives that were recently tested by a
+     * ray (packet) during the traversal
+     *
+     * When \ref clip_primitives() is enabled, large primitives are referenced
+     * by many leaves. The outcome of their intersection test doesn't depend
+     * on the leaf (it covers the whole ray segment), hence it suffices to
+     * test every primitive once per lane.
+     */
+    struct Mailbox {
+        Index prim[MTS_KD_MAILBOX_SIZE];
+        Mask tested[MTS_KD_MAILBOX_SIZE];
+        uint32_t next = 0;
+
+        Mailbox() {
+            for (size_t k = 0; k < MTS_KD_MAILBOX_SIZE; ++k) {
+                prim[k] = (Index) -1;
+                tested[k] = Mask(false);
+            }
+        }
+
+        /**
+         * \brief Record that the lanes \c active test the given primitive
+         *
+         * Returns the subset of \c active that haven't tested it before.
+         */
+        MTS_INLINE Mask insert(Index prim_index, const Mask &active) {
+            for (size_t k = 0; k < MTS_KD_MAILBOX_SIZE; ++k) {
+                if (prim[k] == prim_index) {
+                    Mask result = active && !tested[k];
+                    tested[k] = tested[k] || active;
+                    return result;
+                }
+            }
+
+            prim[next] = prim_index;
+            tested[next] = active;
+            next = (next + 1) % MTS_KD_MAILBOX_SIZE;
+            return active;
+        }
+    };
+
+    /**
+     * \brief Intersect a (scalar) ray against a packet of triangles
+     *
+     * Updates \c pi and returns \c true when one of the triangles is hit
+     * closer than <tt>ray.maxt</tt>.
+     */
+    template <bool ShadowRay>
+    MTS_INLINE bool intersect_triangle_packet(const TrianglePacket &packet,
+                                              const Ray3f &ray,
+                                              PreliminaryIntersection3f &pi) const {
+        PacketVector3f d(ray.d[0], ray.d[1], ray.d[2]),
+                       o(ray.o[0], ray.o[1], ray.o[2]);
+
+        PacketVector3f pvec = cross(d, packet.e2);
+        PacketFloat inv_det = rcp(dot(packet.e1, pvec));
+
+        PacketVector3f tvec = o - packet.p0;
+        PacketFloat u = dot(tvec, pvec) * inv_det;
+        PacketMask active = u >= 0.f && u <= 1.f;
+
+        PacketVector3f qvec = cross(tvec, packet.e1);
+        PacketFloat v = dot(d, qvec) * inv_det;
+        active &= v >= 0.f && u + v <= 1.f;
+
+        PacketFloat t = dot(packet.e2, qvec) * inv_det;
+        active &= t >= ray.mint && t <= ray.maxt;
+
+        if (likely(none(active)))
+            return false;
+
+        if constexpr (ShadowRay) {
+            pi.t = 0.f;
+        } else {
+            // Find the closest of the intersected triangles
+            t = select(active, t, math::Infinity<ScalarFloat>);
+            ScalarFloat t_min = hmin(t);
+            size_t lane = 0;
+            while (t[lane] != t_min)
+                ++lane;
+
+            pi = zero<PreliminaryIntersection3f>();
+            pi.t = t_min;
+            pi.prim_uv = Point2f(u[lane], v[lane]);
+            pi.prim_index = packet.prim_index[lane];
+            pi.shape = m_shapes[packet.shape_index[lane]].get();
+        }
+
+        return true;
+    }
+
+    /**
+     * \brief Move the triangles of every leaf to its front and store them
+     * in the SoA packets used by \ref ray_intersect_scalar()
+     */
+    void build_triangle_packets();
+
+    /**
+     * \brief Compute a key identifying the tree that \ref build() would
+     * produce for the given geometry and the current build parameters
+     *
+     * The key is used to address the on-disk cache.
+     */
+    uint64_t cache_key(uint64_t geo_hash) const;
+
+    /**
+     * \brief Compute a hash of the geometry of the registered shapes
+     *
+     * This covers the mesh contents (vertex positions and faces) and the
+     * bounds of all other shapes.
+     */
+    uint64_t geometry_hash() const;
+
+    /// Try to load the tree with the given key from \c path
+    bool load_cache(const fs::path &path, uint64_t key);
+
+    /// Write the tree to \c path (the file is replaced atomically)
+    void save_cache(const fs::path &path, uint64_t key) const;
+
+    /// Detach the nodes and indices from a shared cache file (see \c kd_cache_shared)
+    void release_cache_mapping();
+
+    virtual ~ShapeKDTree();
+
 protected:
     std::vector<ref<Shape>> m_shapes;
     std::vector<Size> m_primitive_map;
+
+    /// Directory of the on-disk kd-tree cache (disabled when empty)
+    fs::path m_cache_dir;
+
+    /// Reference the nodes and indices in the cache file instead of copying them?
+    bool m_cache_shared = false;
+
+    /// Cache file that holds the nodes and indices when \ref m_cache_shared is set
+    ref<MemoryMappedFile> m_cache_mapping;
+
+    /// Value of \ref geometry_hash() at the time of the last build
+    uint64_t m_geometry_hash = 0;
+
+    /// Intersect triangles in packets in the scalar variants?
+    bool m_use_triangle_packets = true;
+
+    /// Trace the direction octants of packets separately in the packet variants?
+    bool m_split_packets = true;
+    std::vector<TrianglePacket> m_triangle_packets;
+    std::unique_ptr<LeafTriangles[]> m_leaf_triangles;
 };
 
 MTS_EXTERN_CLASS_RENDER(ShapeKDTree)
@@ -49,6 +49,31 @@ public:
     MediumInteraction3f sample_interaction(const Ray3f &ray, Float sample,
                                            UInt32 channel, Mask active) const;
 
+    /**
+     * \brief Sample a tentative free-flight distance against the majorant
+     *
+     * This function is used by \ref sample_interaction() and can be
+     * overridden by media with a spatially varying majorant. The default
+     * implementation samples an exponential distribution based on the
+     * majorant returned by \ref get_combined_extinction().
+     *
+     * \param mi       Medium interaction specifying the time and wavelengths
+     * \param ray      Ray, along which a distance should be sampled
+     * \param mint     Start of the ray segment within the medium
+     * \param maxt     End of the ray segment within the medium
+     * \param sample   A uniformly distributed random sample
+     * \param channel  The channel according to which we will sample the
+     * free-flight distance (RGB modes only).
+     *
+     * \return A pair containing the sampled distance, which exceeds \c
+     * maxt when no interaction occurs on the segment, and the majorant
+     * at this location.
+     */
+    virtual std::pair<Float, UnpolarizedSpectrum>
+    sample_distance(const MediumInteraction3f &mi, const Ray3f &ray,
+                    Float mint, Float maxt, Float sample, UInt32 channel,
+                    Mask active) const;
+
     /**
      * \brief Compute the transmittance and PDF
      *
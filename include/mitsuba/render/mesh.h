@@ -8,10 +8,16 @@
 #include <mitsuba/core/distr_1d.h>
 #include <mitsuba/core/properties.h>
 #include <tbb/spin_mutex.h>
+#include <atomic>
+#include <mutex>
 #include <unordered_map>
 
 NAMESPACE_BEGIN(mitsuba)
 
+#if defined(MTS_ENABLE_OPTIX)
+struct OptixMeshBatch;
+#endif
+
 template <typename Float, typename Spectrum>
 class MTS_EXPORT_RENDER Mesh : public Shape<Float, Spectrum> {
 public:
@@ -26,6 +32,8 @@ public:
     using InputNormal3f = Normal<InputFloat, 3>;
 
     using FloatStorage = DynamicBuffer<replace_scalar_t<Float, InputFloat>>;
+    using PackedStorage32 = DynamicBuffer<UInt32>;
+    using PackedStorage64 = DynamicBuffer<UInt64>;
 
     using typename Base::ScalarSize;
     using typename Base::ScalarIndex;
@@ -64,21 +72,72 @@ public:
     /// Const variant of \ref faces_buffer.
     const DynamicBuffer<UInt32>& faces_buffer() const { return m_faces_buf; }
 
+    /// Storage formats of mesh attributes, see \ref add_attribute()
+    enum class MeshAttributeFormat : uint32_t {
+        /// Single precision values (the default)
+        Float32,
+        /// Half precision values, packed in pairs into 32 bit words
+        Float16,
+        /// 8 bit values mapped to the [0, 1] range, up to four per 32 bit word
+        UNorm8,
+        /// Unsigned 32 bit integers (e.g. object or material IDs)
+        UInt32
+    };
+
     /// Return the mesh attribute associated with \c name
     FloatStorage& attribute_buffer(const std::string& name) {
         auto attribute = m_mesh_attributes.find(name);
         if (attribute == m_mesh_attributes.end())
             Throw("attribute_buffer(): attribute %s doesn't exist.", name.c_str());
+        if (attribute->second.format != MeshAttributeFormat::Float32)
+            Throw("attribute_buffer(): attribute %s is stored in a compact "
+                  "format and has no single precision buffer.", name.c_str());
         return attribute->second.buf;
     }
 
+    /// Return the values of the attribute \c name, decoding compact formats
+    FloatStorage attribute_values(const std::string& name) const {
+        auto attribute = m_mesh_attributes.find(name);
+        if (attribute == m_mesh_attributes.end())
+            Throw("attribute_values(): attribute %s doesn't exist.", name.c_str());
+        return unpack_attribute(attribute->second);
+    }
+
+    /// Does the mesh have an attribute with the given \c name?
+    bool has_attribute(const std::string &name) const {
+        return m_mesh_attributes.find(name) != m_mesh_attributes.end();
+    }
+
     /// Add an attribute buffer with the given \c name and \c dim
     void add_attribute(const std::string& name, size_t dim, const FloatStorage& buf);
 
+    /**
+     * \brief Add an attribute stored in a compact \c format
+     *
+     * The buffer holds \ref attribute_words() 32 bit words per vertex or
+     * face; the values are decoded on the fly when the attribute is
+     * evaluated. In spectral variants, compact color attributes are
+     * expanded since they must store spectral upsampling coefficients.
+     */
+    void add_attribute(const std::string& name, size_t dim,
+                       MeshAttributeFormat format, const PackedStorage32& buf);
+
+    /// Number of 32 bit words used per element by an attribute of the given format
+    static size_t attribute_words(MeshAttributeFormat format, size_t dim) {
+        switch (format) {
+            case MeshAttributeFormat::Float16: return (dim + 1) / 2;
+            case MeshAttributeFormat::UNorm8:  return (dim + 3) / 4;
+            default:                           return dim;
+        }
+    }
+
     /// Returns the face indices associated with triangle \c index
     template <typename Index>
     MTS_INLINE auto face_indices(Index index, mask_t<Index> active = true) const {
         using Result = Array<replace_scalar_t<Index, uint32_t>, 3>;
+        if (unlikely(m_compressed_faces))
+            return unpack_21<Result>(gather<replace_scalar_t<Index, uint64_t>>(
+                m_faces_packed, index, active));
         return gather<Result>(m_faces_buf, index, active);
     }
 
@@ -86,20 +145,63 @@ public:
     template <typename Index>
     MTS_INLINE auto vertex_position(Index index, mask_t<Index> active = true) const {
         using Result = Point<replace_scalar_t<Index, InputFloat>, 3>;
+        if (unlikely(m_compressed)) {
+            Result q(unpack_21<Array<replace_scalar_t<Index, uint32_t>, 3>>(
+                gather<replace_scalar_t<Index, uint64_t>>(m_vertex_positions_packed,
+                                                          index, active)));
+            return fmadd(q, Result(m_position_scale), Result(m_position_offset));
+        }
         return gather<Result>(m_vertex_positions_buf, index, active);
     }
 
+    /**
+     * \brief Returns the world-space position of the vertex with index \c
+     * index at the given \c time
+     *
+     * For meshes without keyframes (see \ref add_keyframe()), this is
+     * identical to \ref vertex_position(). Otherwise, the position is
+     * linearly interpolated between the two keyframes surrounding \c time.
+     */
+    template <typename Index, typename Value>
+    MTS_INLINE auto vertex_position_at(Index index, const Value &time,
+                                       mask_t<Index> active = true) const {
+        using Result = Point<replace_scalar_t<Index, InputFloat>, 3>;
+        if (likely(m_keyframe_count == 1))
+            return vertex_position(index, active);
+        return interpolate_keyframes<Result>(m_vertex_positions_buf,
+                                             m_keyframe_positions_buf,
+                                             index, time, active);
+    }
+
     /// Returns the normal direction of the vertex with index \c index
     template <typename Index>
     MTS_INLINE auto vertex_normal(Index index, mask_t<Index> active = true) const {
         using Result = Normal<replace_scalar_t<Index, InputFloat>, 3>;
+        if (unlikely(m_compressed))
+            return decode_normal<Result>(gather<replace_scalar_t<Index, uint32_t>>(
+                m_vertex_normals_packed, index, active));
         return gather<Result>(m_vertex_normals_buf, index, active);
     }
 
+    /// Returns the (unnormalized) vertex normal at the given \c time, see \ref vertex_position_at()
+    template <typename Index, typename Value>
+    MTS_INLINE auto vertex_normal_at(Index index, const Value &time,
+                                     mask_t<Index> active = true) const {
+        using Result = Normal<replace_scalar_t<Index, InputFloat>, 3>;
+        if (likely(m_keyframe_count == 1 || slices(m_keyframe_normals_buf) == 0))
+            return vertex_normal(index, active);
+        return interpolate_keyframes<Result>(m_vertex_normals_buf,
+                                             m_keyframe_normals_buf,
+                                             index, time, active);
+    }
+
     /// Returns the UV texture coordinates of the vertex with index \c index
     template <typename Index>
     MTS_INLINE auto vertex_texcoord(Index index, mask_t<Index> active = true) const {
         using Result = Point<replace_scalar_t<Index, InputFloat>, 2>;
+        if (unlikely(m_compressed))
+            return decode_texcoord<Result>(gather<replace_scalar_t<Index, uint32_t>>(
+                m_vertex_texcoords_packed, index, active));
         return gather<Result>(m_vertex_texcoords_buf, index, active);
     }
 
@@ -116,10 +218,61 @@ public:
     }
 
     /// Does this mesh have per-vertex normals?
-    bool has_vertex_normals() const { return slices(m_vertex_normals_buf) != 0; }
+    bool has_vertex_normals() const {
+        return slices(m_vertex_normals_buf) != 0 || slices(m_vertex_normals_packed) != 0;
+    }
 
     /// Does this mesh have per-vertex texture coordinates?
-    bool has_vertex_texcoords() const { return slices(m_vertex_texcoords_buf) != 0; }
+    bool has_vertex_texcoords() const {
+        return slices(m_vertex_texcoords_buf) != 0 || slices(m_vertex_texcoords_packed) != 0;
+    }
+
+    /// Is the mesh stored in the compressed representation of \ref compress()?
+    bool is_compressed() const { return m_compressed; }
+
+    /**
+     * \brief Append a keyframe of world-space vertex positions (and
+     * optionally vertex normals) for deformation motion blur
+     *
+     * The current vertex positions form the first keyframe. The keyframes
+     * are spaced evenly over the time interval specified via \ref
+     * set_motion_range(), and the mesh is linearly interpolated between
+     * them. All keyframes must share the topology of the mesh, and normals
+     * are only interpolated if they are provided for every keyframe.
+     */
+    void add_keyframe(const FloatStorage &positions,
+                      const FloatStorage &normals = FloatStorage());
+
+    /// Set the time interval spanned by the keyframes (default: <tt>[0, 1]</tt>)
+    void set_motion_range(ScalarFloat start, ScalarFloat end);
+
+    /// Return the number of position keyframes (1 for static meshes)
+    ScalarSize keyframe_count() const { return m_keyframe_count; }
+
+    /// Does this mesh deform over time, i.e. does it have more than one keyframe?
+    bool is_deforming() const { return m_keyframe_count > 1; }
+
+    /// Return the time interval spanned by the keyframes
+    std::pair<ScalarFloat, ScalarFloat> motion_range() const {
+        return { m_motion_start, m_motion_end };
+    }
+
+    /**
+     * \brief Return a key that identifies the file and load options of this
+     * mesh
+     *
+     * Meshes loaded from the same (unmodified) file using the same options
+     * share their key, which allows the scene to turn duplicate references
+     * into instances. The key is empty for meshes that were not loaded from a
+     * file, or that were modified after loading.
+     */
+    const std::string &source_key() const { return m_source_key; }
+
+    /// Release all meshes retained by the cache of loaded files
+    static void clear_cache();
+
+    /// Return a hash of the vertex positions and face indices
+    uint64_t geometry_hash() const;
 
     /// @}
     // =========================================================================
@@ -133,6 +286,24 @@ public:
     /// Recompute the bounding box (e.g. after modifying the vertex positions)
     void recompute_bbox();
 
+    /**
+     * \brief Convert the vertex and face data into a compact quantized
+     * representation
+     *
+     * Positions are quantized to 21 bits per axis relative to the bounding
+     * box, normals are stored using an octahedral encoding with 16 bits per
+     * component, and texture coordinates are stored as half precision values.
+     * Face indices are packed into 64 bit words when the mesh has at most
+     * 2^21 vertices. This reduces the vertex storage from 32 to 16 bytes.
+     *
+     * All accessors (\ref vertex_position(), \ref vertex_normal(), ..)
+     * transparently decode the packed data. The full precision buffers are
+     * released, which means that the mesh can no longer be modified or
+     * exported afterwards. Compression is only supported by the native CPU
+     * ray tracing backend and is otherwise ignored with a warning.
+     */
+    void compress();
+
     // =============================================================
     //! @{ \name Shape interface implementation
     // =============================================================
@@ -153,6 +324,23 @@ public:
 
     virtual Float pdf_position(const PositionSample3f &ps, Mask active = true) const override;
 
+    /**
+     * \brief Sample faces proportionally to the integral of a texture over
+     * their UV footprint instead of proportionally to their surface area
+     *
+     * This is used by area emitters with spatially varying radiance. The
+     * weight of every face is its area times the average of the texture's
+     * sampling density (\ref Texture::pdf_position()) at \c sample_count
+     * stratified positions within the face. A small fraction of area-based
+     * sampling is mixed in, so that faces whose samples missed all emission
+     * remain reachable. Positions within a face are sampled uniformly.
+     *
+     * Pass \c nullptr to revert to sampling wrt. area. The distribution is
+     * rebuilt automatically when the vertex positions change.
+     */
+    void build_radiance_pmf(const Texture<Float, Spectrum> *texture,
+                            uint32_t sample_count = 16);
+
     virtual Point3f
     barycentric_coordinates(const SurfaceInteraction3f &si,
                             Mask active = true) const;
@@ -196,9 +384,9 @@ public:
                            Mask active = true) const {
         auto fi = face_indices(index);
 
-        Point3f p0 = vertex_position(fi[0]),
-                p1 = vertex_position(fi[1]),
-                p2 = vertex_position(fi[2]);
+        Point3f p0 = vertex_position_at(fi[0], ray.time),
+                p1 = vertex_position_at(fi[1], ray.time),
+                p2 = vertex_position_at(fi[2], ray.time);
 
         Vector3f e1 = p1 - p0, e2 = p2 - p0;
 
@@ -228,12 +416,19 @@ public:
 #if defined(MTS_ENABLE_EMBREE)
     /// Return the Embree version of this shape
     virtual RTCGeometry embree_geometry(RTCDevice device) override;
+    virtual void embree_update_geometry(RTCGeometry geom) override;
 #endif
 
 #if defined(MTS_ENABLE_OPTIX)
     using Base::m_optix_data_ptr;
     virtual void optix_prepare_geometry() override;
     virtual void optix_build_input(OptixBuildInput&) const override;
+
+    /// Allocate the shared buffers of a batch of small meshes (see \ref OptixMeshBatch)
+    static void optix_prepare_batch(OptixMeshBatch &batch);
+
+    /// Copy the geometry of this mesh into the buffers of a batch at the given position
+    void optix_fill_batch(OptixMeshBatch &batch, uint32_t index) const;
 #endif
 
     /// @}
@@ -242,6 +437,7 @@ public:
     void traverse(TraversalCallback *callback) override;
     void parameters_changed(const std::vector<std::string> &/*keys*/ = {}) override;
     bool parameters_grad_enabled() const override;
+    void account_memory(MemoryReport *report) const override;
 
     /// Return a human-readable string representation of the shape contents.
     virtual std::string to_string() const override;
@@ -254,11 +450,89 @@ protected:
     inline Mesh() {}
     virtual ~Mesh();
 
+    /**
+     * \brief Load the additional keyframes listed in the \c keyframes
+     * property of a mesh loader plugin
+     *
+     * Every keyframe is loaded by instantiating the same plugin with the
+     * \c filename property replaced, so that it is subject to the same
+     * \c to_world transformation. Must be called once the first keyframe
+     * has been loaded.
+     */
+    void load_keyframes(const Properties &props);
+
+    /**
+     * \brief Look up the process-wide cache of loaded mesh files
+     *
+     * Sets the \ref source_key() of this mesh based on \c path, its
+     * modification time and a string representation of the load \c options.
+     * When another mesh with the same key is still alive, its geometry is
+     * copied (and re-transformed to the \c to_world transformation of this
+     * mesh) instead of loading the file again, and the function returns \c
+     * true.
+     */
+    bool load_from_cache(const fs::path &path, const std::string &options);
+
+    /// Make the geometry of this mesh available to \ref load_from_cache()
+    void add_to_cache();
+
+    /**
+     * \brief Return the path of the shared geometry file of this mesh and set
+     * its \c key, or an empty path when the mesh can't be shared
+     *
+     * Shared geometry files (see the \c shared_cache_dir property) store the
+     * buffers of a mesh, such that other processes that load the same file
+     * with the same options and transformation can memory-map them instead
+     * of holding their own copy. With a directory in \c /dev/shm or another
+     * on-disk location, all of them use the same physical pages.
+     */
+    fs::path shared_cache_path(uint64_t &key) const;
+
+    /// Try to map the buffers of this mesh from the shared geometry file \c path
+    bool load_shared_cache(const fs::path &path, uint64_t key);
+
+    /// Write the buffers of this mesh to \c path (the file is replaced atomically)
+    bool save_shared_cache(const fs::path &path, uint64_t key) const;
+
+#if defined(MTS_ENABLE_EMBREE)
+    /// Attach the vertex buffers of all keyframes as Embree time steps
+    void embree_set_vertex_buffers(RTCGeometry geom);
+#endif
+
+    /// Interpolate a per-vertex quantity between the keyframes surrounding \c time
+    template <typename Result, typename Index, typename Value>
+    MTS_INLINE Result interpolate_keyframes(const FloatStorage &first,
+                                            const FloatStorage &rest,
+                                            Index index, const Value &time,
+                                            mask_t<Index> active) const {
+        using FloatX  = value_t<Result>;
+        using UInt32X = replace_scalar_t<Index, uint32_t>;
+
+        uint32_t segments = (uint32_t) m_keyframe_count - 1;
+        FloatX u = clamp((FloatX(time) - InputFloat(m_motion_start)) *
+                             InputFloat(m_motion_scale), 0.f, 1.f) * InputFloat(segments);
+        UInt32X segment = min(UInt32X(u), segments - 1);
+        u -= FloatX(segment);
+
+        // Keyframe 0 lives in the regular buffer, the others in 'rest'
+        mask_t<Index> in_first = eq(segment, 0u);
+        Result v0 = select(in_first,
+                           gather<Result>(first, index, active && in_first),
+                           gather<Result>(rest, index + select(in_first, UInt32X(0u), segment - 1u) *
+                                                           m_vertex_count,
+                                          active && !in_first)),
+               v1 = gather<Result>(rest, index + segment * m_vertex_count, active);
+
+        return fmadd(v1 - v0, u, v0);
+    }
+
     /**
      * \brief Build internal tables for sampling uniformly wrt. area.
      *
-     * Computes the surface area and sets up \c m_area_pmf
-     * Thread-safe, since it uses a mutex.
+     * Computes the surface area and sets up \c m_area_pmf. This happens
+     * on the first call to \ref sample_position() or \ref pdf_position(),
+     * and for emitters and sensors also \ref surface_area(). Thread-safe,
+     * since it uses a mutex.
      */
     void build_pmf();
 
@@ -271,9 +545,44 @@ protected:
      */
     void build_parameterization();
 
+    /// Decode three 21 bit integers packed into a 64 bit word
+    template <typename Result, typename Value>
+    static MTS_INLINE Result unpack_21(const Value &v) {
+        using UInt32I = value_t<Result>;
+        return Result(UInt32I(v & 0x1fffffu),
+                      UInt32I((v >> 21) & 0x1fffffu),
+                      UInt32I(v >> 42));
+    }
+
+    /// Decode an octahedral normal with two 16 bit components
+    template <typename Result, typename Value>
+    static MTS_INLINE Result decode_normal(const Value &v) {
+        using FloatI = value_t<Result>;
+        FloatI x = fmadd(FloatI(v & 0xffffu), 2.f / 65535.f, -1.f),
+               y = fmadd(FloatI(v >> 16), 2.f / 65535.f, -1.f),
+               z = 1.f - abs(x) - abs(y),
+               t = max(-z, 0.f);
+        x -= mulsign(t, x);
+        y -= mulsign(t, y);
+        return normalize(Result(x, y, z));
+    }
+
+    /// Decode a pair of half precision values (denormals are flushed on encoding)
+    template <typename Result, typename Value>
+    static MTS_INLINE Result decode_texcoord(const Value &v) {
+        using FloatI = value_t<Result>;
+        auto half_to_float = [](const Value &h) {
+            Value em = h & 0x7fffu;
+            Value bits = ((h & 0x8000u) << 16) |
+                         select(em == 0u, Value(0u), (em + (112u << 10)) << 13);
+            return reinterpret_array<FloatI>(bits);
+        };
+        return Result(half_to_float(v & 0xffffu), half_to_float(v >> 16));
+    }
+
     // Ensures that the sampling table are ready.
     ENOKI_INLINE void ensure_pmf_built() const {
-        if (unlikely(m_area_pmf.empty()))
+        if (unlikely(!m_area_pmf_ready.load(std::memory_order_acquire)))
             const_cast<Mesh *>(this)->build_pmf();
     }
 
@@ -288,11 +597,46 @@ protected:
         size_t size;
         MeshAttributeType type;
         FloatStorage buf;
+        MeshAttributeFormat format = MeshAttributeFormat::Float32;
+        /// Compact storage used instead of \c buf by the other formats
+        PackedStorage32 packed;
     };
 
+    /// Fetch and decode the value of an attribute at the given element
+    template <uint32_t Size, typename Result, typename Index>
+    MTS_INLINE Result gather_attribute(const MeshAttribute &attr, const Index &index,
+                                       mask_t<Index> active) const {
+        using Value = replace_scalar_t<Index, InputFloat>;
+        using UInt32X = replace_scalar_t<Index, uint32_t>;
+
+        if (likely(attr.format == MeshAttributeFormat::Float32))
+            return gather<Result>(attr.buf, index, active);
+
+        Index offset = index * (uint32_t) attribute_words(attr.format, Size);
+        Array<Value, Size> result;
+        for (uint32_t i = 0; i < Size; ++i) {
+            if (attr.format == MeshAttributeFormat::Float16) {
+                UInt32X v = gather<UInt32X>(attr.packed, offset + uint32_t(i / 2), active);
+                result[i] = decode_texcoord<Array<Value, 2>>(v)[i % 2];
+            } else if (attr.format == MeshAttributeFormat::UNorm8) {
+                UInt32X v = gather<UInt32X>(attr.packed, offset, active);
+                result[i] = Value((v >> uint32_t(8 * i)) & 0xffu) * (1.f / 255.f);
+            } else {
+                result[i] = Value(gather<UInt32X>(attr.packed, offset + uint32_t(i), active));
+            }
+        }
+
+        if constexpr (Size == 1)
+            return result[0];
+        else
+            return Result(result);
+    }
+
+    /// Decode a compact attribute into a single precision buffer
+    FloatStorage unpack_attribute(const MeshAttribute &attr) const;
+
     template <uint32_t Size, bool Raw>
-    auto interpolate_attribute(MeshAttributeType type,
-                               const FloatStorage &buf,
+    auto interpolate_attribute(const MeshAttribute &attr,
                                const SurfaceInteraction3f &si,
                                Mask active) const {
         using StorageType =
@@ -301,13 +645,13 @@ protected:
                                replace_scalar_t<Color3f, InputFloat>>;
         using ReturnType = std::conditional_t<Size == 1, Float, Color3f>;
 
-        if (type == MeshAttributeType::Vertex) {
+        if (attr.type == MeshAttributeType::Vertex) {
             auto fi = face_indices(si.prim_index, active);
             Point3f b = barycentric_coordinates(si, active);
 
-            StorageType v0 = gather<StorageType>(buf, fi[0], active),
-                        v1 = gather<StorageType>(buf, fi[1], active),
-                        v2 = gather<StorageType>(buf, fi[2], active);
+            StorageType v0 = gather_attribute<Size, StorageType>(attr, fi[0], active),
+                        v1 = gather_attribute<Size, StorageType>(attr, fi[1], active),
+                        v2 = gather_attribute<Size, StorageType>(attr, fi[2], active);
 
             // Barycentric interpolation
             if constexpr (is_spectral_v<Spectrum> && Size == 3 && !Raw) {
@@ -325,7 +669,7 @@ protected:
                 return (ReturnType) fmadd(v0, b[0], fmadd(v1, b[1], v2 * b[2]));
             }
         } else {
-            StorageType v = gather<StorageType>(buf, si.prim_index, active);
+            StorageType v = gather_attribute<Size, StorageType>(attr, si.prim_index, active);
             if constexpr (is_spectral_v<Spectrum> && Size == 3 && !Raw) {
                 return srgb_model_eval<UnpolarizedSpectrum>(v, si.wavelengths);
             } else {
@@ -347,18 +691,59 @@ protected:
 
     DynamicBuffer<UInt32> m_faces_buf;
 
+    /// Quantized storage, see \ref compress()
+    PackedStorage64 m_vertex_positions_packed;
+    PackedStorage32 m_vertex_normals_packed;
+    PackedStorage32 m_vertex_texcoords_packed;
+    PackedStorage64 m_faces_packed;
+    InputVector3f m_position_scale = 0.f;
+    InputPoint3f m_position_offset = 0.f;
+    bool m_compressed = false;
+    bool m_compressed_faces = false;
+
+    /// Keyframes 1..N-1 for deformation motion blur, see \ref add_keyframe()
+    FloatStorage m_keyframe_positions_buf;
+    FloatStorage m_keyframe_normals_buf;
+    ScalarSize m_keyframe_count = 1;
+    ScalarFloat m_motion_start = 0.f;
+    ScalarFloat m_motion_end = 1.f;
+    ScalarFloat m_motion_scale = 1.f;
+
+    /// Identifies the file and load options, see \ref source_key()
+    std::string m_source_key;
+
+    /// Directory of shared geometry files, see \ref shared_cache_path()
+    fs::path m_shared_cache_dir;
+
+    /// Shared geometry file that holds the buffers of this mesh (if any)
+    ref<MemoryMappedFile> m_shared_mapping;
+
     std::unordered_map<std::string, MeshAttribute> m_mesh_attributes;
 
 #if defined(MTS_ENABLE_OPTIX)
     void* m_vertex_buffer_ptr;
+    std::once_flag m_optix_motion_warning;
 #endif
 
     /// Flag that can be set by the user to disable loading/computation of vertex normals
     bool m_disable_vertex_normals = false;
 
+    /// Flag that can be set by the user to request \ref compress() after loading
+    bool m_compress = false;
+
+    /// Flag that can be set by the user to sample faces using an alias table
+    bool m_alias_sampling = false;
+
     /* Surface area distribution -- generated on demand when \ref
-       prepare_area_pmf() is first called. */
+       build_pmf() is first called. */
     DiscreteDistribution<Float> m_area_pmf;
+    /// Set once \c m_area_pmf is ready, checked without locking
+    std::atomic<bool> m_area_pmf_ready { false };
+
+    /// Optional: face distribution used instead, see \ref build_radiance_pmf()
+    DiscreteDistribution<Float> m_radiance_pmf;
+    ref<const Texture<Float, Spectrum>> m_radiance_texture;
+    uint32_t m_radiance_sample_count = 0;
     tbb::spin_mutex m_mutex;
 
     /// Optional: used in eval_parameterization()
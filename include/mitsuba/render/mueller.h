@@ -38,6 +38,19 @@ template <typename Float> MuellerMatrix<Float> depolarizer(Float value = 1.f) {
     return result;
 }
 
+/**
+* \brief Checks whether a Mueller matrix is a multiple of the ideal
+* depolarizer, i.e. whether all its entries except (0, 0) are zero
+*/
+template <typename Float> mask_t<Float> is_depolarizer(const MuellerMatrix<Float> &M) {
+    mask_t<Float> result = true;
+    for (size_t i = 0; i < 4; ++i)
+        for (size_t j = 0; j < 4; ++j)
+            if (i != 0 || j != 0)
+                result &= eq(M(i, j), 0.f);
+    return result;
+}
+
 /**
 * \brief Constructs the Mueller matrix of an ideal absorber
 *
@@ -55,6 +55,8 @@ struct OptixParams {
     unsigned long long *out_shape_ptr;
     unsigned int *out_prim_index;
     unsigned int *out_inst_index;
+    /// Output index of the hit \c OptixInstance (only requested for scenes with instancers)
+    unsigned int *out_inst_local;
     /// Output boolean data pointer for ray_test
     bool *out_hit;
     /// Handle for the acceleration data structure to trace against
@@ -106,8 +108,11 @@ __device__ void write_output_pi_params(OptixParams &params,
     if (params.out_inst_index[launch_index] > 0) {
         // Check whether the current instance ID is a valid instance index
         unsigned int inst_index = optixGetInstanceId();
-        if (inst_index < params.out_inst_index[launch_index])
+        if (inst_index < params.out_inst_index[launch_index]) {
             params.out_inst_index[launch_index] = inst_index;
+            if (params.out_inst_local)
+                params.out_inst_local[launch_index] = optixGetInstanceIndex();
+        }
     }
 
     params.out_prim_uv[0][launch_index] = prim_uv.x();
@@ -169,6 +174,8 @@ __device__ void write_output_si_params(OptixParams &params,
             }
 
             params.out_inst_index[launch_index] = inst_index;
+            if (params.out_inst_local)
+                params.out_inst_local[launch_index] = optixGetInstanceIndex();
         }
     }
 
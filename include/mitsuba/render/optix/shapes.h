@@ -12,7 +12,9 @@
 
 #include <mitsuba/render/optix/common.h>
 #include <mitsuba/render/optix_api.h>
-#include <mitsuba/render/shape.h>
+#include <mitsuba/render/mesh.h>
+#include <algorithm>
+#include <memory>
 
 NAMESPACE_BEGIN(mitsuba)
 /// List of the custom shapes supported by OptiX
@@ -33,34 +35,231 @@ size_t get_shape_descr_idx(Shape *shape) {
           "'custom_optix_shapes' table.", name);
 }
 
+/// Meshes with at most this many faces are merged into batches (see \ref OptixMeshBatch)
+static constexpr uint32_t optix_batch_max_faces = 1024;
+
+static const uint32_t optix_batch_input_flags = OPTIX_GEOMETRY_FLAG_DISABLE_ANYHIT;
+
+/**
+ * \brief Small meshes that share a single OptiX build input and hit group record
+ *
+ * Every shape otherwise has its own build input and hit group record, which
+ * makes the GAS builds and the shader binding table of scenes with many
+ * separate meshes very large. Meshes with the same vertex attributes are
+ * merged instead: their geometry is copied into shared buffers (see \ref
+ * Mesh::optix_fill_batch()), and the closest hit program maps every face back
+ * to the shape pointer and primitive index of its mesh.
+ */
+struct OptixMeshBatch {
+    /// Indices of the meshes in the list of shapes, and their shape pointers
+    std::vector<uint32_t> shapes;
+    std::vector<unsigned long long> shape_ptrs;
+    /// First vertex and face of every mesh in the shared buffers
+    std::vector<uint32_t> vertex_offsets, face_offsets;
+    uint32_t vertex_count = 0, face_count = 0;
+    bool has_normals = false, has_texcoords = false;
+
+    /// Shared device buffers (allocated by \ref Mesh::optix_prepare_batch())
+    void *faces = nullptr, *vertex_positions = nullptr, *vertex_normals = nullptr,
+         *vertex_texcoords = nullptr, *face_mesh = nullptr, *mesh_shape_ptr = nullptr,
+         *mesh_face_offset = nullptr;
+    /// Device copy of the \c OptixMeshData of the batch
+    void *data_ptr = nullptr;
+
+    OptixMeshBatch() = default;
+    OptixMeshBatch(const OptixMeshBatch &) = delete;
+    OptixMeshBatch &operator=(const OptixMeshBatch &) = delete;
+
+    ~OptixMeshBatch() {
+        for (void *ptr : { faces, vertex_positions, vertex_normals, vertex_texcoords,
+                           face_mesh, mesh_shape_ptr, mesh_face_offset, data_ptr })
+            if (ptr)
+                cuda_free(ptr);
+    }
+
+    /// Fill the triangle build input of the batch
+    void build_input(OptixBuildInput &build_input) const {
+        build_input = {};
+        build_input.type                           = OPTIX_BUILD_INPUT_TYPE_TRIANGLES;
+        build_input.triangleArray.vertexFormat     = OPTIX_VERTEX_FORMAT_FLOAT3;
+        build_input.triangleArray.indexFormat      = OPTIX_INDICES_FORMAT_UNSIGNED_INT3;
+        build_input.triangleArray.numVertices      = vertex_count;
+        build_input.triangleArray.vertexBuffers    = (CUdeviceptr*) &vertex_positions;
+        build_input.triangleArray.numIndexTriplets = face_count;
+        build_input.triangleArray.indexBuffer      = (CUdeviceptr) faces;
+        build_input.triangleArray.flags            = &optix_batch_input_flags;
+        build_input.triangleArray.numSbtRecords    = 1;
+    }
+};
+
 /// Stores two OptiXTraversables: one for the meshes and one for the custom shapes (e.g. sphere)
 struct OptixAccelData {
     struct HandleData {
         OptixTraversableHandle handle = 0ull;
         void* buffer = nullptr;
+        size_t buffer_size = 0;
         uint32_t count = 0u;
     };
     HandleData meshes;
     HandleData others;
 
+    /// Batches of small meshes, and which shapes are part of a batch
+    std::vector<std::unique_ptr<OptixMeshBatch>> batches;
+    std::vector<bool> batched;
+
     ~OptixAccelData() {
         if (meshes.buffer) cuda_free(meshes.buffer);
         if (others.buffer) cuda_free(others.buffer);
     }
 };
 
-/// Creates and appends the HitGroupSbtRecord for a given list of shapes
+/**
+ * \brief Build an OptiX acceleration structure (GAS or IAS) and compact it
+ *
+ * Compaction typically halves the memory footprint of the acceleration
+ * structure. Its storage is returned in \c out_buffer and \c out_buffer_size.
+ * The build options must include \c OPTIX_BUILD_FLAG_ALLOW_COMPACTION.
+ */
+inline OptixTraversableHandle build_compacted_accel(const OptixDeviceContext &context,
+                                                    const OptixAccelBuildOptions &accel_options,
+                                                    const OptixBuildInput *build_inputs,
+                                                    unsigned int build_input_count,
+                                                    void *&out_buffer,
+                                                    size_t &out_buffer_size) {
+    OptixAccelBufferSizes buffer_sizes;
+    rt_check(optixAccelComputeMemoryUsage(
+        context,
+        &accel_options,
+        build_inputs,
+        build_input_count,
+        &buffer_sizes
+    ));
+
+    void* d_temp_buffer = cuda_malloc(buffer_sizes.tempSizeInBytes);
+    void* output_buffer = cuda_malloc(buffer_sizes.outputSizeInBytes + 8);
+
+    OptixAccelEmitDesc emit_property = {};
+    emit_property.type   = OPTIX_PROPERTY_TYPE_COMPACTED_SIZE;
+    emit_property.result = (CUdeviceptr)((char*)output_buffer + buffer_sizes.outputSizeInBytes);
+
+    OptixTraversableHandle accel;
+    rt_check(optixAccelBuild(
+        context,
+        0,              // CUDA stream
+        &accel_options,
+        build_inputs,
+        build_input_count, // num build inputs
+        (CUdeviceptr)d_temp_buffer,
+        buffer_sizes.tempSizeInBytes,
+        (CUdeviceptr)output_buffer,
+        buffer_sizes.outputSizeInBytes,
+        &accel,
+        &emit_property,  // emitted property list
+        1                // num emitted properties
+    ));
+
+    cuda_free(d_temp_buffer);
+
+    size_t compact_size;
+    cuda_memcpy_from_device(&compact_size, (void*)emit_property.result, sizeof(size_t));
+    if (compact_size < buffer_sizes.outputSizeInBytes) {
+        void* compact_buffer = cuda_malloc(compact_size);
+        // Use handle as input and output
+        rt_check(optixAccelCompact(
+            context,
+            0, // CUDA stream
+            accel,
+            (CUdeviceptr)compact_buffer,
+            compact_size,
+            &accel
+        ));
+        cuda_free(output_buffer);
+        output_buffer = compact_buffer;
+    } else {
+        compact_size = buffer_sizes.outputSizeInBytes;
+    }
+
+    out_buffer = output_buffer;
+    out_buffer_size = compact_size;
+    return accel;
+}
+
+/// Merge the small meshes of a list of shapes into batches (see \ref OptixMeshBatch)
+template <typename Shape>
+void prepare_mesh_batches(const std::vector<ref<Shape>> &shapes, OptixAccelData &accel) {
+    using Mesh = typename Shape::Mesh;
+
+    accel.batches.clear();
+    accel.batched.assign(shapes.size(), false);
+
+    // One batch per combination of vertex attributes
+    std::unique_ptr<OptixMeshBatch> batches[4];
+    for (uint32_t i = 0; i < (uint32_t) shapes.size(); ++i) {
+        const Shape *shape = shapes[i].get();
+        if (!shape->is_mesh() || shape->primitive_count() > optix_batch_max_faces)
+            continue;
+
+        const Mesh *mesh = static_cast<const Mesh *>(shape);
+        size_t layout = (mesh->has_vertex_normals() ? 1 : 0) +
+                        (mesh->has_vertex_texcoords() ? 2 : 0);
+        std::unique_ptr<OptixMeshBatch> &batch = batches[layout];
+        if (!batch) {
+            batch.reset(new OptixMeshBatch());
+            batch->has_normals   = mesh->has_vertex_normals();
+            batch->has_texcoords = mesh->has_vertex_texcoords();
+        }
+
+        batch->shapes.push_back(i);
+        batch->shape_ptrs.push_back((unsigned long long) (uintptr_t) shape);
+        batch->vertex_offsets.push_back(batch->vertex_count);
+        batch->face_offsets.push_back(batch->face_count);
+        batch->vertex_count += mesh->vertex_count();
+        batch->face_count += mesh->face_count();
+    }
+
+    for (auto &batch : batches) {
+        // A single mesh is cheaper to trace without the indirection
+        if (!batch || batch->shapes.size() < 2)
+            continue;
+        for (uint32_t i : batch->shapes)
+            accel.batched[i] = true;
+        Mesh::optix_prepare_batch(*batch);
+        accel.batches.push_back(std::move(batch));
+    }
+
+    if (!accel.batches.empty())
+        Log(Debug, "Merged %i meshes into %i OptiX build inputs.",
+            std::count(accel.batched.begin(), accel.batched.end(), true),
+            accel.batches.size());
+}
+
+/**
+ * \brief Creates and appends the HitGroupSbtRecord for a given list of shapes
+ *
+ * The records are ordered like the build inputs of \ref build_gas(): the
+ * meshes that aren't part of a batch, one record per batch of small meshes,
+ * and finally the custom shapes.
+ */
 template <typename Shape>
 void fill_hitgroup_records(std::vector<ref<Shape>> &shapes,
+                           OptixAccelData &accel,
                            std::vector<HitGroupSbtRecord> &out_hitgroup_records,
                            const OptixProgramGroup *program_groups) {
-    for (size_t i = 0; i < 2; i++) {
-        for (Shape* shape: shapes) {
-            // This trick allows meshes to be processed first
-            if (i == !shape->is_mesh())
-                shape->optix_fill_hitgroup_records(out_hitgroup_records, program_groups);
-        }
+    prepare_mesh_batches(shapes, accel);
+
+    for (size_t i = 0; i < shapes.size(); ++i)
+        if (shapes[i]->is_mesh() && !accel.batched[i])
+            shapes[i]->optix_fill_hitgroup_records(out_hitgroup_records, program_groups);
+
+    for (auto &batch : accel.batches) {
+        out_hitgroup_records.push_back(HitGroupSbtRecord());
+        out_hitgroup_records.back().data = { 0ull, batch->data_ptr };
+        rt_check(optixSbtRecordPackHeader(program_groups[2], &out_hitgroup_records.back()));
     }
+
+    for (Shape *shape : shapes)
+        if (!shape->is_mesh())
+            shape->optix_fill_hitgroup_records(out_hitgroup_records, program_groups);
 }
 
 /**
@@ -68,105 +267,120 @@ void fill_hitgroup_records(std::vector<ref<Shape>> &shapes,
  *
  * Two different GAS will be created for the meshes and the custom shapes. Optix
  * handles to those GAS will be stored in an \ref OptixAccelData.
+ *
+ * The small meshes that \ref fill_hitgroup_records() merged into batches are
+ * copied into the buffers of their batch, which is a single build input.
+ *
+ * When \c update is set, existing GAS over the same number of shapes are
+ * refit in place (\c OPTIX_BUILD_OPERATION_UPDATE) instead of being rebuilt.
+ * This requires the primitive counts of the shapes to be unchanged.
  */
 template <typename Shape>
 void build_gas(const OptixDeviceContext &context,
                const std::vector<ref<Shape>> &shapes,
-               OptixAccelData& out_accel) {
+               OptixAccelData& out_accel,
+               bool update = false) {
+    using Mesh = typename Shape::Mesh;
 
     // Separate meshes and custom shapes
     std::vector<ref<Shape>> shape_meshes, shape_others;
-    for (auto shape: shapes) {
-        if (shape->is_mesh())           shape_meshes.push_back(shape);
-        else if (!shape->is_instance()) shape_others.push_back(shape);
+    for (size_t i = 0; i < shapes.size(); ++i) {
+        const ref<Shape> &shape = shapes[i];
+        if (shape->is_mesh()) {
+            if (i >= out_accel.batched.size() || !out_accel.batched[i])
+                shape_meshes.push_back(shape);
+        } else if (!shape->is_instance() && !shape->is_instancer()) {
+            shape_others.push_back(shape);
+        }
     }
 
+    // Gather the (possibly modified) geometry of the batched meshes
+    for (auto &batch : out_accel.batches)
+        for (uint32_t i = 0; i < (uint32_t) batch->shapes.size(); ++i)
+            static_cast<const Mesh *>(shapes[batch->shapes[i]].get())->optix_fill_batch(*batch, i);
+    if (!out_accel.batches.empty())
+        cuda_eval();
 
     // Build a GAS given a subset of shape pointers
-    auto build_single_gas = [&context](const std::vector<ref<Shape>> &shape_subset,
-                                       OptixAccelData::HandleData &handle) {
+    auto build_single_gas = [&context, update](const std::vector<ref<Shape>> &shape_subset,
+                                               const std::vector<std::unique_ptr<OptixMeshBatch>> &batches,
+                                               OptixAccelData::HandleData &handle) {
+
+        size_t shapes_count = shape_subset.size() + batches.size();
 
         OptixAccelBuildOptions accel_options = {};
-        accel_options.buildFlags = OPTIX_BUILD_FLAG_ALLOW_COMPACTION;
+        accel_options.buildFlags = OPTIX_BUILD_FLAG_ALLOW_COMPACTION |
+                                   OPTIX_BUILD_FLAG_ALLOW_UPDATE;
         accel_options.operation  = OPTIX_BUILD_OPERATION_BUILD;
         accel_options.motionOptions.numKeys = 0;
-        if (handle.buffer) {
-            cuda_free(handle.buffer);
-            handle.handle = 0ull;
-            handle.buffer = nullptr;
-            handle.count = 0;
-        }
-
-        size_t shapes_count = shape_subset.size();
-
-        if (shapes_count == 0)
-            return;
 
         std::vector<OptixBuildInput> build_inputs(shapes_count);
-        for (size_t i = 0; i < shapes_count; i++)
+        for (size_t i = 0; i < shape_subset.size(); i++)
             shape_subset[i]->optix_build_input(build_inputs[i]);
+        for (size_t i = 0; i < batches.size(); i++)
+            batches[i]->build_input(build_inputs[shape_subset.size() + i]);
 
-        OptixAccelBufferSizes buffer_sizes;
-        rt_check(optixAccelComputeMemoryUsage(
-            context,
-            &accel_options,
-            build_inputs.data(),
-            (unsigned int) shapes_count,
-            &buffer_sizes
-        ));
-
-        void* d_temp_buffer = cuda_malloc(buffer_sizes.tempSizeInBytes);
-        void* output_buffer = cuda_malloc(buffer_sizes.outputSizeInBytes + 8);
+        if (update && handle.buffer && handle.count == shapes_count) {
+            // Refit the existing GAS in place
+            accel_options.operation = OPTIX_BUILD_OPERATION_UPDATE;
 
-        OptixAccelEmitDesc emit_property = {};
-        emit_property.type   = OPTIX_PROPERTY_TYPE_COMPACTED_SIZE;
-        emit_property.result = (CUdeviceptr)((char*)output_buffer + buffer_sizes.outputSizeInBytes);
-
-        OptixTraversableHandle accel;
-        rt_check(optixAccelBuild(
-            context,
-            0,              // CUDA stream
-            &accel_options,
-            build_inputs.data(),
-            (unsigned int) shapes_count, // num build inputs
-            (CUdeviceptr)d_temp_buffer,
-            buffer_sizes.tempSizeInBytes,
-            (CUdeviceptr)output_buffer,
-            buffer_sizes.outputSizeInBytes,
-            &accel,
-            &emit_property,  // emitted property list
-            1                // num emitted properties
-        ));
-
-        cuda_free(d_temp_buffer);
+            OptixAccelBufferSizes buffer_sizes;
+            rt_check(optixAccelComputeMemoryUsage(
+                context,
+                &accel_options,
+                build_inputs.data(),
+                (unsigned int) shapes_count,
+                &buffer_sizes
+            ));
 
-        size_t compact_size;
-        cuda_memcpy_from_device(&compact_size, (void*)emit_property.result, sizeof(size_t));
-        if (compact_size < buffer_sizes.outputSizeInBytes) {
-            void* compact_buffer = cuda_malloc(compact_size);
-            // Use handle as input and output
-            rt_check(optixAccelCompact(
+            void* d_temp_buffer = cuda_malloc(buffer_sizes.tempUpdateSizeInBytes);
+            rt_check(optixAccelBuild(
                 context,
-                0, // CUDA stream
-                accel,
-                (CUdeviceptr)compact_buffer,
-                compact_size,
-                &accel
+                0,              // CUDA stream
+                &accel_options,
+                build_inputs.data(),
+                (unsigned int) shapes_count, // num build inputs
+                (CUdeviceptr)d_temp_buffer,
+                buffer_sizes.tempUpdateSizeInBytes,
+                (CUdeviceptr)handle.buffer,
+                handle.buffer_size,
+                &handle.handle,
+                0,  // emitted property list
+                0   // num emitted properties
             ));
-            cuda_free(output_buffer);
-            output_buffer = compact_buffer;
+            cuda_free(d_temp_buffer);
+            return;
         }
 
-        handle.handle = accel;
-        handle.buffer = output_buffer;
+        if (handle.buffer) {
+            cuda_free(handle.buffer);
+            handle.handle = 0ull;
+            handle.buffer = nullptr;
+            handle.buffer_size = 0;
+            handle.count = 0;
+        }
+
+        if (shapes_count == 0)
+            return;
+
+        handle.handle = build_compacted_accel(context, accel_options, build_inputs.data(),
+                                              (unsigned int) shapes_count, handle.buffer,
+                                              handle.buffer_size);
         handle.count = (uint32_t) shapes_count;
     };
 
-    build_single_gas(shape_meshes, out_accel.meshes);
-    build_single_gas(shape_others, out_accel.others);
+    build_single_gas(shape_meshes, out_accel.batches, out_accel.meshes);
+    build_single_gas(shape_others, {}, out_accel.others);
 }
 
-/// Prepares and fills the \ref OptixInstance array associated with a given list of shapes.
+/**
+ * \brief Prepares and fills the \ref OptixInstance array associated with a given list of shapes.
+ *
+ * When \c instancer_ranges is specified, the entry of every instancer of
+ * \c shapes receives the index of its first \ref OptixInstance in
+ * \c out_instances and the number of entries per instance, which maps the
+ * instance index reported by OptiX back to the instance of the instancer.
+ */
 template <typename Shape, typename Transform4f>
 void prepare_ias(const OptixDeviceContext &context,
                        std::vector<ref<Shape>> &shapes,
@@ -174,13 +388,14 @@ void prepare_ias(const OptixDeviceContext &context,
                        const OptixAccelData &accel,
                        uint32_t instance_id,
                        const Transform4f& transf,
-                       std::vector<OptixInstance> &out_instances) {
+                       std::vector<OptixInstance> &out_instances,
+                       std::vector<std::pair<uint32_t, uint32_t>> *instancer_ranges = nullptr) {
     // Find all instances in the list of shapes
     std::vector<Shape*> instances;
     std::vector<uint32_t> instance_offsets;
     uint32_t offset = 0;
     for (Shape* shape: shapes) {
-        if (shape->is_instance()) {
+        if (shape->is_instance() || shape->is_instancer()) {
             instances.push_back(shape);
             instance_offsets.push_back(offset);
         }
@@ -223,8 +438,17 @@ void prepare_ias(const OptixDeviceContext &context,
     }
 
     // Apply the same process to every shape instances
-    for (uint32_t i = 0; i < instances.size(); ++i)
+    for (uint32_t i = 0; i < instances.size(); ++i) {
+        size_t first = out_instances.size();
         instances[i]->optix_prepare_ias(context, out_instances, instance_offsets[i], transf);
+
+        if (instancer_ranges && instances[i]->is_instancer()) {
+            size_t count = instances[i]->primitive_count();
+            (*instancer_ranges)[instance_offsets[i]] = {
+                (uint32_t) first, (uint32_t) ((out_instances.size() - first) / count)
+            };
+        }
+    }
 }
 
 NAMESPACE_END(mitsuba)
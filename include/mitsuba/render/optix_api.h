@@ -3,6 +3,7 @@
 #if defined(MTS_ENABLE_OPTIX)
 
 #include <iomanip>
+#include <string>
 #include <mitsuba/core/platform.h>
 
 #if defined(MTS_USE_OPTIX_HEADERS)
@@ -228,6 +229,9 @@ extern MTS_EXPORT_RENDER const char* (*optixGetErrorName)(OptixResult);
 extern MTS_EXPORT_RENDER const char* (*optixGetErrorString)(OptixResult);
 extern MTS_EXPORT_RENDER OptixResult (*optixDeviceContextCreate)(CUcontext, const OptixDeviceContextOptions*, OptixDeviceContext*);
 extern MTS_EXPORT_RENDER OptixResult (*optixDeviceContextDestroy)(OptixDeviceContext);
+extern MTS_EXPORT_RENDER OptixResult (*optixDeviceContextSetCacheEnabled)(OptixDeviceContext, int);
+extern MTS_EXPORT_RENDER OptixResult (*optixDeviceContextSetCacheLocation)(OptixDeviceContext, const char*);
+extern MTS_EXPORT_RENDER OptixResult (*optixDeviceContextSetCacheDatabaseSizes)(OptixDeviceContext, size_t, size_t);
 extern MTS_EXPORT_RENDER OptixResult (*optixModuleCreateFromPTX)(OptixDeviceContext, const OptixModuleCompileOptions*, const OptixPipelineCompileOptions*, const char*, size_t, char*, size_t*, OptixModule*);
 extern MTS_EXPORT_RENDER OptixResult (*optixModuleDestroy)(OptixModule);
 extern MTS_EXPORT_RENDER OptixResult (*optixProgramGroupCreate)(OptixDeviceContext, const OptixProgramGroupDesc*, unsigned int, const OptixProgramGroupOptions*, char*, size_t*, OptixProgramGroup*);
@@ -248,6 +252,24 @@ NAMESPACE_BEGIN(mitsuba)
 extern MTS_EXPORT_RENDER bool optix_initialize();
 extern MTS_EXPORT_RENDER void optix_shutdown();
 
+/// Destroy the OptiX context and pipeline shared by all scenes (called by \ref optix_shutdown())
+extern MTS_EXPORT_RENDER void optix_release_shared_config();
+
+/**
+ * \brief Store compiled GPU kernels in the given directory
+ *
+ * Both the OptiX modules of the ray tracing pipeline and the kernels that
+ * Enoki's CUDA backend JIT-compiles are cached on disk, keyed by a hash of
+ * their PTX code, compile options and the device architecture. Pointing all
+ * processes of a render farm to a shared directory lets identical jobs skip
+ * compilation. The \c MTS_KERNEL_CACHE environment variable has the same
+ * effect. Must be called before CUDA is initialized.
+ */
+extern MTS_EXPORT_RENDER void optix_set_cache_path(const std::string &path);
+
+/// Return the directory set by \ref optix_set_cache_path() (empty: default location)
+extern MTS_EXPORT_RENDER const std::string &optix_cache_path();
+
 static size_t optix_log_buffer_size;
 static char optix_log_buffer[2024];
 
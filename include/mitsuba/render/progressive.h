@@ -0,0 +1,86 @@
+#pragma once
+
+#include <mitsuba/core/bitmap.h>
+#include <mitsuba/core/object.h>
+#include <mitsuba/render/fwd.h>
+#include <mutex>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**
+ * \brief Progressive rendering of a loaded scene for interactive previews
+ *
+ * Every call to \ref render_pass() renders the scene once more with the
+ * scene's sampling integrator (using the sample count of the sensor's
+ * sampler, which should be set to 1 for the fastest feedback) and a new
+ * sampler seed, and adds the result to a running average. Edits to the
+ * camera, materials or geometry that are applied through \ref
+ * ParameterMap::update() (which invokes the objects' \c parameters_changed()
+ * callbacks) do not require reloading the scene: afterwards, \ref restart()
+ * discards the accumulated passes, while the scene and its acceleration
+ * data structure are reused.
+ */
+template <typename Float, typename Spectrum>
+class MTS_EXPORT_RENDER ProgressiveRenderer : public Object {
+public:
+    MTS_IMPORT_TYPES(Scene, Sensor, SamplingIntegrator)
+
+    /**
+     * \brief Prepare the progressive rendering of a scene
+     *
+     * \param sensor
+     *    The sensor to render (by default, the first sensor of the scene)
+     */
+    ProgressiveRenderer(Scene *scene, Sensor *sensor = nullptr);
+
+    /**
+     * \brief Render one more pass and add it to the running average
+     *
+     * \return \c false when the pass was canceled (e.g. by \ref restart())
+     *    or failed, in which case it is not accumulated.
+     */
+    bool render_pass();
+
+    /**
+     * \brief Discard the accumulated passes
+     *
+     * This is cheap and should be called after every edit of the scene. A
+     * pass that is currently being rendered on another thread is canceled.
+     */
+    void restart();
+
+    /// Return the number of passes accumulated since the last restart
+    size_t pass_count() const { return m_pass_count; }
+
+    /**
+     * \brief Return the running average of all passes since the last restart
+     *
+     * The bitmap is updated in place by \ref render_pass(), so that a
+     * viewer can upload it without copying it first. Returns \c nullptr
+     * before the first pass.
+     */
+    Bitmap *bitmap() { return m_accum; }
+
+    /// Mutex that is held while \ref render_pass() updates the bitmap
+    std::mutex &mutex() { return m_mutex; }
+
+    std::string to_string() const override;
+
+    MTS_DECLARE_CLASS()
+protected:
+    virtual ~ProgressiveRenderer();
+
+protected:
+    ref<Scene> m_scene;
+    ref<Sensor> m_sensor;
+    ref<SamplingIntegrator> m_integrator;
+    ref<Bitmap> m_accum;
+    uint64_t m_base_seed;
+    size_t m_pass_count = 0;
+    size_t m_seed_index = 0;
+    std::atomic<bool> m_restart { false };
+    std::mutex m_mutex;
+};
+
+MTS_EXTERN_CLASS_RENDER(ProgressiveRenderer)
+NAMESPACE_END(mitsuba)
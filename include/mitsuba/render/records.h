@@ -27,6 +27,7 @@ struct PositionSample {
     MTS_IMPORT_RENDER_BASIC_TYPES()
     using ObjectPtr            = typename RenderAliases::ObjectPtr;
     using SurfaceInteraction3f = typename RenderAliases::SurfaceInteraction3f;
+    using Index                = typename CoreAliases::UInt32;
 
     //! @}
     // =============================================================
@@ -75,6 +76,16 @@ struct PositionSample {
       */
     ObjectPtr object = nullptr;
 
+    /**
+     * \brief Optional: primitive index of the sampled position, e.g. the
+     * triangle ID (if applicable)
+     *
+     * Shapes whose sampling density varies between primitives (see \ref
+     * Mesh::build_radiance_pmf()) use it to evaluate \ref
+     * Shape::pdf_position().
+     */
+    Index prim_index = 0;
+
     //! @}
     // =============================================================
 
@@ -91,12 +102,13 @@ struct PositionSample {
      */
     PositionSample(const SurfaceInteraction3f &si)
         : p(si.p), n(si.sh_frame.n), uv(si.uv), time(si.time), pdf(0.f),
-          delta(false), object(reinterpret_array<ObjectPtr>(si.shape)) { }
+          delta(false), object(reinterpret_array<ObjectPtr>(si.shape)),
+          prim_index(si.prim_index) { }
 
     //! @}
     // =============================================================
 
-    ENOKI_STRUCT(PositionSample, p, n, uv, time, pdf, delta, object)
+    ENOKI_STRUCT(PositionSample, p, n, uv, time, pdf, delta, object, prim_index)
 };
 
 // -----------------------------------------------------------------------------
@@ -124,11 +136,12 @@ struct DirectionSample : public PositionSample<Float_, Spectrum_> {
     // =============================================================
     using Float    = Float_;
     using Spectrum = Spectrum_;
-    MTS_IMPORT_BASE(PositionSample, p, n, uv, time, pdf, delta, object)
+    MTS_IMPORT_BASE(PositionSample, p, n, uv, time, pdf, delta, object, prim_index)
     MTS_IMPORT_RENDER_BASIC_TYPES()
     using Interaction3f        = typename RenderAliases::Interaction3f;
     using SurfaceInteraction3f = typename RenderAliases::SurfaceInteraction3f;
     using ObjectPtr            = typename RenderAliases::ObjectPtr;
+    using Index                = typename Base::Index;
 
     //! @}
     // =============================================================
@@ -177,7 +190,7 @@ struct DirectionSample : public PositionSample<Float_, Spectrum_> {
     DirectionSample(const Point3f &p, const Normal3f &n, const Point2f &uv,
                     const Float &time, const Float &pdf, const Mask &delta,
                     const ObjectPtr &object, const Vector3f &d, const Float &dist)
-        : Base(p, n, uv, time, pdf, delta, object), d(d), dist(dist) { }
+        : Base(p, n, uv, time, pdf, delta, object, Index(0)), d(d), dist(dist) { }
 
     /// Construct from a position sample
     DirectionSample(const Base &base) : Base(base) { }
@@ -203,7 +216,7 @@ struct DirectionSample : public PositionSample<Float_, Spectrum_> {
     // =============================================================
 
     ENOKI_DERIVED_STRUCT(DirectionSample, Base,
-        ENOKI_BASE_FIELDS(p, n, uv, time, pdf, delta, object),
+        ENOKI_BASE_FIELDS(p, n, uv, time, pdf, delta, object, prim_index),
         ENOKI_DERIVED_FIELDS(d, dist)
     )
 };
@@ -249,10 +262,10 @@ NAMESPACE_END(mitsuba)
 // -----------------------------------------------------------------------
 
 ENOKI_STRUCT_SUPPORT(mitsuba::PositionSample, p, n, uv, time,
-                     pdf, delta, object)
+                     pdf, delta, object, prim_index)
 
 ENOKI_STRUCT_SUPPORT(mitsuba::DirectionSample, p, n, uv, time, pdf,
-                     delta, object, d, dist)
+                     delta, object, prim_index, d, dist)
 
 //! @}
 // -----------------------------------------------------------------------
@@ -79,6 +79,21 @@ public:
      */
     virtual void advance();
 
+    /**
+     * \brief Position the sampler at sample \c sample_index of the
+     * sequence with the given seed offset
+     *
+     * This produces the same state as a call to \ref seed() followed by
+     * \c sample_index calls to \ref advance(), but in constant time. A
+     * render can thus be resumed at an arbitrary sample of a pixel (e.g.
+     * from a checkpoint), and the samples of a pixel can be split across
+     * machines while reproducing the result of a single render. In
+     * wavefront modes, \c sample_index counts the calls to \ref advance(),
+     * i.e. the passes of \c samples_per_wavefront samples.
+     */
+    virtual void seek(uint64_t seed_offset, uint32_t sample_index,
+                      size_t wavefront_size = 1);
+
     /// Retrieve the next component value from the current sample
     virtual Float next_1d(Mask active = true);
 
@@ -88,6 +103,9 @@ public:
     /// Return the number of samples per pixel
     uint32_t sample_count() const { return m_sample_count; }
 
+    /// Return the number of calls to \ref advance() since the sampler was seeded
+    uint32_t sample_index() const { return m_sample_index; }
+
     /// Return the size of the wavefront (or 0, if not seeded)
     uint32_t wavefront_size() const { return m_wavefront_size; };
 
@@ -97,6 +115,28 @@ public:
     /// Set the number of samples per pass in wavefront modes (default is 1)
     void set_samples_per_wavefront(uint32_t samples_per_wavefront);
 
+    /**
+     * \brief Inform the sampler about the pixel of the upcoming sample
+     *
+     * Called by the integrator before every sample. Samplers that correlate
+     * the samples of neighboring pixels (e.g. to distribute the error as blue
+     * noise in screen space) need this information, the default
+     * implementation ignores it.
+     */
+    virtual void set_pixel(const Point2u &pixel);
+
+    /// Set the index of the current rendering pass (default is 0)
+    void set_pass_index(uint32_t pass_index) { m_pass_index = pass_index; }
+
+    /// Return the index of the current rendering pass
+    uint32_t pass_index() const { return m_pass_index; }
+
+    /// Set the base seed, which is inherited by clones (the \c seed parameter)
+    void set_base_seed(uint64_t base_seed) { m_base_seed = base_seed; }
+
+    /// Return the base seed
+    uint64_t base_seed() const { return m_base_seed; }
+
     MTS_DECLARE_CLASS()
 protected:
     Sampler(const Properties &props);
@@ -120,24 +160,41 @@ protected:
     uint32_t m_dimension_index;
     /// Index of the current sample in the sequence
     uint32_t m_sample_index;
+    /// Index of the current rendering pass
+    uint32_t m_pass_index;
 };
 
-/// Interface for sampler plugins based on the PCG32 random number generator
+/**
+ * \brief Interface for sampler plugins based on the PCG32 random number generator
+ *
+ * The generator is seeded again for every sample, based on the seed offset
+ * and the sample index. The random numbers of a sample hence don't depend on
+ * the number of values that were drawn by earlier samples, which makes it
+ * possible to \ref seek() to any sample.
+ */
 template <typename Float, typename Spectrum>
 class MTS_EXPORT_RENDER PCG32Sampler : public Sampler<Float, Spectrum> {
 public:
-    MTS_IMPORT_BASE(Sampler, m_base_seed)
+    MTS_IMPORT_BASE(Sampler, m_base_seed, m_sample_index, m_wavefront_size)
     MTS_IMPORT_TYPES()
     using PCG32 = mitsuba::PCG32<UInt32>;
 
     virtual void seed(uint64_t seed_offset, size_t wavefront_size = 1) override;
+    virtual void advance() override;
+    virtual void seek(uint64_t seed_offset, uint32_t sample_index,
+                      size_t wavefront_size = 1) override;
 
     MTS_DECLARE_CLASS()
 protected:
     PCG32Sampler(const Properties &props);
 
+    /// Seed \ref m_rng for the current sample
+    void seed_rng();
+
 protected:
     PCG32 m_rng;
+    /// Seed value of the current sequence (base seed plus seed offset)
+    uint64_t m_seed_value = 0;
 };
 
 MTS_EXTERN_CLASS_RENDER(Sampler)
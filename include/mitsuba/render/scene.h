@@ -1,10 +1,13 @@
 #pragma once
 
+#include <mitsuba/core/distr_1d.h>
 #include <mitsuba/core/spectrum.h>
+#include <mitsuba/core/statistics.h>
 #include <mitsuba/render/emitter.h>
 #include <mitsuba/render/shapegroup.h>
 #include <mitsuba/render/fwd.h>
 #include <mitsuba/render/sensor.h>
+#include <functional>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -72,6 +75,60 @@ public:
      */
     Mask ray_test(const Ray3f &ray, Mask active = true) const;
 
+    /**
+     * \brief Perform \ref ray_test() for a batch of independent rays
+     *
+     * This is equivalent to testing the rays one by one, but lets the
+     * acceleration data structure process them together. In the scalar
+     * variants, Embree traces the batch using its stream interface, which
+     * amortizes the per-query overhead and exploits coherence between rays
+     * (e.g. shadow rays towards the same emitter).
+     *
+     * \param rays
+     *    Array of \c count rays
+     *
+     * \param hit
+     *    Output array receiving \c true for every ray that is occluded
+     */
+    void ray_test_batch(const Ray3f *rays, size_t count, Mask *hit) const;
+
+    /**
+     * \brief Intersect a large batch of rays given as contiguous arrays
+     *
+     * This function is meant for applications that use the scene as a
+     * general purpose ray casting engine (visibility analysis, LiDAR
+     * simulation, etc.). The rays are split into chunks that are traced in
+     * parallel on the TBB worker threads, and compact hit records are
+     * written into caller-provided buffers. It is only available in the
+     * scalar variants; the vectorized variants should instead pass wide
+     * arrays to \ref ray_intersect(), which traces all rays at once.
+     *
+     * \param o
+     *    Array of \c count ray origins
+     *
+     * \param d
+     *    Array of \c count normalized ray directions
+     *
+     * \param t
+     *    Output array receiving the hit distances, or infinity for rays
+     *    that miss the scene
+     *
+     * \param shape_index
+     *    Optional output array receiving the index of the hit shape in \ref
+     *    shapes(), or <tt>(uint32_t) -1</tt> for rays that miss the scene
+     *
+     * \param prim_index
+     *    Optional output array receiving the primitive index within the hit
+     *    shape
+     *
+     * \param uv
+     *    Optional output array receiving the UV coordinates of the hit
+     */
+    void ray_intersect_batch(const ScalarPoint3f *o, const ScalarVector3f *d, size_t count,
+                             ScalarFloat *t, uint32_t *shape_index = nullptr,
+                             uint32_t *prim_index = nullptr,
+                             ScalarPoint2f *uv = nullptr) const;
+
     //! @}
     // =============================================================
 
@@ -79,6 +136,40 @@ public:
     //! @{ \name Sampling interface
     // =============================================================
 
+    /**
+     * \brief Sample a ray leaving one of the emitters of the scene
+     *
+     * This is e.g. used to trace photons or light subpaths. The emitter is
+     * chosen in the same way as in \ref sample_emitter_direction(), reusing
+     * \c wavelength_sample, after which \ref Endpoint::sample_ray() is
+     * invoked on it.
+     *
+     * \param time
+     *    The scene time associated with the ray
+     *
+     * \param wavelength_sample
+     *    A uniformly distributed 1D value that is used to choose the emitter
+     *    and then to sample the wavelengths of the ray
+     *
+     * \param sample2
+     *    A uniformly distributed sample on the domain <tt>[0,1]^2</tt>, which
+     *    is passed to the emitter's \ref Endpoint::sample_ray()
+     *
+     * \param sample3
+     *    A uniformly distributed sample on the domain <tt>[0,1]^2</tt>, which
+     *    is passed to the emitter's \ref Endpoint::sample_ray()
+     *
+     * \return
+     *    The sampled ray and the emitted flux divided by the sample
+     *    probability (including the discrete probability of choosing the
+     *    emitter).
+     */
+    std::pair<Ray3f, Spectrum> sample_emitter_ray(Float time,
+                                                  Float wavelength_sample,
+                                                  const Point2f &sample2,
+                                                  const Point2f &sample3,
+                                                  Mask active = true) const;
+
     /**
      * \brief Direct illumination sampling routine
      *
@@ -89,6 +180,10 @@ public:
      * emission profile and the geometry term between the reference point and
      * the position on the emitter.
      *
+     * The emitter is either chosen uniformly, or proportionally to its
+     * estimated power (see \ref Emitter::power()) when the scene was created
+     * with <tt>emitter_sampling = "power"</tt>.
+     *
      * \param ref
      *    A reference point somewhere within the scene
      *
@@ -127,6 +222,35 @@ public:
                                 const DirectionSample3f &ds,
                                 Mask active = true) const;
 
+    /**
+     * \brief Direct illumination sampling routine that additionally
+     * importance samples a lobe of the reference point
+     *
+     * Like \ref sample_emitter_direction(), but the chosen emitter samples
+     * the product of its emission and the lobe
+     * <tt>max(0, dot(d, lobe_axis))^lobe_exponent</tt> when it supports this
+     * (see \ref Emitter::sample_direction_lobe()). Lanes with
+     * <tt>lobe_exponent == 0</tt> are equivalent to \ref
+     * sample_emitter_direction().
+     */
+    std::pair<DirectionSample3f, Spectrum>
+    sample_emitter_direction_lobe(const Interaction3f &ref,
+                                  const Point2f &sample,
+                                  const Vector3f &lobe_axis,
+                                  Float lobe_exponent,
+                                  bool test_visibility = true,
+                                  Mask active = true) const;
+
+    /**
+     * \brief Evaluate the probability density of the \ref
+     * sample_emitter_direction_lobe() technique for the given lobe
+     */
+    Float pdf_emitter_direction_lobe(const Interaction3f &ref,
+                                     const DirectionSample3f &ds,
+                                     const Vector3f &lobe_axis,
+                                     Float lobe_exponent,
+                                     Mask active = true) const;
+
     //! @}
     // =============================================================
 
@@ -160,6 +284,15 @@ public:
     /// Return the scene's integrator
     const Integrator* integrator() const { return m_integrator; }
 
+    /**
+     * \brief Return the ray counts and throughput of the most recent call to
+     * \ref SamplingIntegrator::render() on this scene
+     */
+    const RayStatistics &ray_statistics() const { return m_ray_statistics; }
+
+    /// Set the ray statistics (called by the integrator at the end of a render)
+    void set_ray_statistics(const RayStatistics &stats) { m_ray_statistics = stats; }
+
     //! @}
     // =============================================================
 
@@ -169,9 +302,66 @@ public:
     /// Update internal state following a parameter update
     void parameters_changed(const std::vector<std::string> &/*keys*/ = {}) override;
 
+    /**
+     * \brief Update the ray-intersection acceleration data structure after
+     * the geometry of existing shapes changed
+     *
+     * This function should be called after modifying vertex positions (e.g.
+     * via \ref Mesh::vertex_positions_buffer() followed by \ref
+     * Mesh::parameters_changed()) or instance transforms. It is considerably
+     * cheaper than creating a new scene: the Embree and OptiX backends and
+     * the native BVH refit their existing hierarchies, and the native kd-tree
+     * is only rebuilt when the geometry actually changed.
+     *
+     * The number of primitives of each shape is expected to stay the same.
+     * Create a new scene when the topology changes.
+     */
+    void update_geometry();
+
+    /**
+     * \brief Return an identifier of the current geometry of the scene
+     *
+     * The identifier changes whenever the geometry is updated (see \ref
+     * update_geometry()) and is unique among all scenes, which allows caches
+     * of ray intersections to detect that they are outdated.
+     */
+    uint32_t geometry_revision() const { return m_geometry_revision; }
+
     /// Return whether any of the shape's parameters require gradient
     bool shapes_grad_enabled() const { return m_shapes_grad_enabled; };
 
+    /**
+     * \brief Return the fields of \ref SurfaceInteraction that integrators
+     * need to compute at the scattering vertices of a path
+     *
+     * The position partials only orient the tangents of the shading frame,
+     * which just matters to anisotropic BSDFs (this includes bump and normal
+     * maps). Scenes without such BSDFs hence return \ref
+     * HitComputeFlags::Connection, which keeps these fields and their
+     * computation out of the per-bounce interaction. Texture-space
+     * differentials require ray differentials, which integrators only track
+     * for the primary hit (see \ref SamplingIntegrator::ray_intersect_primary()).
+     * Differentiable variants always return \ref HitComputeFlags::All.
+     */
+    HitComputeFlags scattering_hit_flags() const { return m_scattering_hit_flags; }
+
+    /**
+     * \brief Summarize the memory used by the scene
+     *
+     * The report lists the host and device memory of the geometry, the
+     * acceleration data structure, textures, volumes, sampling
+     * distributions and films. Objects shared by several parts of the scene
+     * are only accounted once. The acceleration data structures of Embree
+     * and OptiX are managed by these libraries and are not included.
+     *
+     * The summary is also logged after loading when the scene is created with
+     * <tt>memory_report = true</tt>.
+     */
+    ref<MemoryReport> memory_report() const;
+
+    /// Account the acceleration data structure and all children of the scene
+    void account_memory(MemoryReport *report) const override;
+
     /// Return a human-readable string representation of the scene contents.
     virtual std::string to_string() const override;
 
@@ -185,12 +375,54 @@ protected:
     void accel_init_gpu(const Properties &props);
 
     /// Updates the ray-intersection acceleration data structure
-    void accel_parameters_changed_gpu();
+    void accel_parameters_changed_cpu();
+    void accel_parameters_changed_gpu(bool refit = false);
 
     /// Release the ray-intersection acceleration data structure
     void accel_release_cpu();
     void accel_release_gpu();
 
+    /// Account the memory of the ray-intersection acceleration data structure
+    void accel_account_memory_cpu(MemoryReport *report) const;
+
+    /// Recompute the emitter selection probabilities
+    void update_emitter_sampling();
+
+    /**
+     * \brief Build the pending acceleration data structures as a single job
+     *
+     * Collects the kd-trees of all shape groups that are reachable from the
+     * scene (directly, through instances, and as levels of detail) together
+     * with the top-level data structure \c top_level (if specified), whose
+     * cost is given by \c top_level_cost primitives. The builds are taken
+     * from a shared queue in the order of decreasing primitive count, so
+     * that the smaller ones fill up the threads while the large builds go
+     * through their sequential phases.
+     */
+    void accel_build_pending(const std::function<void()> &top_level = { },
+                             size_t top_level_cost = 0);
+
+    /// Recompute \ref m_scattering_hit_flags from the BSDFs of the shapes
+    void update_scattering_hit_flags();
+
+    /**
+     * \brief Replace meshes that were loaded from the same file by instances
+     * of a shared \ref ShapeGroup
+     *
+     * Meshes are only merged when they share their \ref Mesh::source_key()
+     * and BSDF, and don't carry emitters, sensors or media. The first mesh of
+     * every set is kept in world space, and the instance transformations map
+     * it onto the other references. Disabled via <tt>auto_instancing =
+     * false</tt>, and in differentiable variants.
+     */
+    void instance_duplicate_meshes();
+
+    /**
+     * \brief Choose an emitter based on \c sample, which is rescaled to lie
+     * in <tt>[0, 1)</tt> again. Returns its index and discrete probability.
+     */
+    std::pair<UInt32, Float> sample_emitter_index(Float &sample, Mask active) const;
+
     /// Trace a ray and only return a preliminary intersection data structure
     MTS_INLINE PreliminaryIntersection3f ray_intersect_preliminary_cpu(const Ray3f &ray, Mask active) const;
     MTS_INLINE PreliminaryIntersection3f ray_intersect_preliminary_gpu(const Ray3f &ray, Mask active) const;
@@ -204,12 +436,19 @@ protected:
     MTS_INLINE Mask ray_test_cpu(const Ray3f &ray, Mask active) const;
     MTS_INLINE Mask ray_test_gpu(const Ray3f &ray, Mask active) const;
 
+    /// Trace a batch of shadow rays (scalar CPU variants)
+    void ray_test_batch_cpu(const Ray3f *rays, size_t count, Mask *hit) const;
+
     using ShapeKDTree = mitsuba::ShapeKDTree<Float, Spectrum>;
+    using ShapeBVH = mitsuba::ShapeBVH<Float, Spectrum>;
 
 protected:
     /// Acceleration data structure (type depends on implementation)
     void *m_accel = nullptr;
 
+    /// Does \c m_accel refer to a \ref ShapeBVH (native CPU backend only)?
+    bool m_accel_bvh = false;
+
     ScalarBoundingBox3f m_bbox;
 
     host_vector<ref<Emitter>, Float> m_emitters;
@@ -220,7 +459,25 @@ protected:
     ref<Integrator> m_integrator;
     ref<Emitter> m_environment;
 
+    /// Power-proportional distribution over \c m_emitters (if enabled)
+    DiscreteDistribution<Float> m_emitter_distr;
+
+    /// Select emitters proportionally to their power?
+    bool m_emitter_power_sampling = false;
+
+    /// Sample \c m_emitter_distr using an alias table?
+    bool m_emitter_alias_sampling = false;
+
+    /// Ray counts of the most recent render
+    RayStatistics m_ray_statistics;
+
     bool m_shapes_grad_enabled;
+
+    /// Fields computed at the scattering vertices of paths (see \ref scattering_hit_flags())
+    HitComputeFlags m_scattering_hit_flags = HitComputeFlags::All;
+
+    /// Identifier of the current geometry (see \ref geometry_revision())
+    uint32_t m_geometry_revision;
 };
 
 /// Dummy function which can be called to ensure that the librender shared library is loaded
@@ -229,13 +486,14 @@ extern MTS_EXPORT_RENDER void librender_nop();
 // See records.h
 template <typename Float, typename Spectrum>
 void DirectionSample<Float, Spectrum>::set_query(const Ray3f &ray, const SurfaceInteraction3f &si) {
-    p      = si.p;
-    n      = si.sh_frame.n;
-    uv     = si.uv;
-    time   = si.time;
-    object = static_cast<ObjectPtr>(si.shape->emitter());
-    d      = ray.d;
-    dist   = si.t;
+    p          = si.p;
+    n          = si.sh_frame.n;
+    uv         = si.uv;
+    time       = si.time;
+    object     = static_cast<ObjectPtr>(si.shape->emitter());
+    prim_index = si.prim_index;
+    d          = ray.d;
+    dist       = si.t;
 }
 
 // See interaction.h
@@ -22,7 +22,7 @@ NAMESPACE_BEGIN(mitsuba)
 template <typename Float, typename Spectrum>
 class MTS_EXPORT_RENDER Shape : public Object {
 public:
-    MTS_IMPORT_TYPES(BSDF, Medium, Emitter, Sensor, MeshAttribute);
+    MTS_IMPORT_TYPES(BSDF, Medium, Emitter, Sensor, MeshAttribute, Texture);
 
     // Use 32 bit indices to keep track of indices to conserve memory
     using ScalarIndex = uint32_t;
@@ -155,6 +155,28 @@ public:
      */
     virtual Mask ray_test(const Ray3f &ray, Mask active = true) const;
 
+    /**
+     * \brief Intersect a single primitive of the shape
+     *
+     * Used by Mitsuba's acceleration data structures, which store the
+     * primitives of a shape (see \ref primitive_count()) individually. The
+     * default implementation ignores \c index and forwards the call to
+     * \ref ray_intersect_preliminary(), which is adequate for shapes made of
+     * a single primitive. Meshes are handled separately.
+     */
+    virtual PreliminaryIntersection3f ray_intersect_primitive(ScalarIndex index,
+                                                              const Ray3f &ray,
+                                                              Mask active = true) const;
+
+    /**
+     * \brief Shadow ray test against a single primitive of the shape
+     *
+     * The default implementation ignores \c index and forwards the call to
+     * \ref ray_test().
+     */
+    virtual Mask ray_test_primitive(ScalarIndex index, const Ray3f &ray,
+                                    Mask active = true) const;
+
     /**
      * \brief Compute and return detailed information related to a surface interaction
      *
@@ -328,6 +350,9 @@ public:
     /// Return a string identifier
     std::string id() const override;
 
+    /// Return the object-to-world transformation specified via \c to_world
+    const ScalarTransform4f &to_world() const { return m_to_world; }
+
     /// Is this shape a triangle mesh?
     bool is_mesh() const { return class_()->derives_from(Mesh<Float, Spectrum>::m_class); }
 
@@ -337,6 +362,12 @@ public:
     /// Is this shape an instance?
     bool is_instance() const { return class_()->name() == "Instance"; };
 
+    /// Is this shape an instancer, i.e. a set of instances of a shape group?
+    bool is_instancer() const { return class_()->name() == "Instancer"; };
+
+    /// Return the shape group referenced by an instance or instancer (\c nullptr otherwise)
+    virtual ShapeGroup<Float, Spectrum> *instanced_group() { return nullptr; }
+
     /// Does the surface of this shape mark a medium transition?
     bool is_medium_transition() const { return m_interior_medium.get() != nullptr ||
                                                m_exterior_medium.get() != nullptr; }
@@ -353,6 +384,26 @@ public:
     /// Return the shape's BSDF
     BSDF *bsdf() { return m_bsdf.get(); }
 
+    /**
+     * \brief Should intersections with this shape be alpha tested during
+     * ray traversal? (see \ref BSDF::alpha_mask())
+     *
+     * This is never the case for emitters, sensors and medium transitions,
+     * since the integrator must see every intersection with them.
+     */
+    bool has_alpha_mask() const { return m_alpha_mask != nullptr; }
+
+    /**
+     * \brief Alpha test a tentative intersection with this shape
+     *
+     * Evaluates the alpha mask of the shape's BSDF at the intersection.
+     *
+     * \return A mask that is \c false for the lanes where the intersection
+     *         lies in a perfectly transparent region and should be ignored
+     */
+    Mask alpha_test(const Ray3f &ray, const PreliminaryIntersection3f &pi,
+                    Mask active = true) const;
+
     /// Is this shape also an area emitter?
     bool is_emitter() const { return (bool) m_emitter; }
 
@@ -391,6 +442,12 @@ public:
 #if defined(MTS_ENABLE_EMBREE)
     /// Return the Embree version of this shape
     virtual RTCGeometry embree_geometry(RTCDevice device);
+
+    /**
+     * \brief Update an Embree geometry previously created by \ref
+     * embree_geometry() after the shape was modified, and commit it
+     */
+    virtual void embree_update_geometry(RTCGeometry geom);
 #endif
 
 #if defined(MTS_ENABLE_OPTIX)
@@ -483,6 +540,19 @@ public:
     /// Return whether shape's parameters require gradients (default implementation return false)
     virtual bool parameters_grad_enabled() const;
 
+    /**
+     * \brief Has the geometry of this shape changed since the scene last
+     * updated its acceleration data structure?
+     *
+     * Set by the default implementation of \ref parameters_changed(), which
+     * shapes only invoke when a geometric parameter was modified. Updates
+     * of e.g. the BSDF therefore do not cause a rebuild.
+     */
+    bool dirty() const { return m_dirty; }
+
+    /// Flag the geometry of this shape as modified (see \ref dirty())
+    void mark_dirty(bool value = true) { m_dirty = value; }
+
     //! @}
     // =============================================================
 
@@ -506,9 +576,15 @@ protected:
     ref<Medium> m_exterior_medium;
     std::string m_id;
 
+    /// Alpha mask of the BSDF used to skip transparent intersections (if any)
+    const Texture *m_alpha_mask = nullptr;
+
     ScalarTransform4f m_to_world;
     ScalarTransform4f m_to_object;
 
+    /// Whether the geometry changed since the last acceleration data structure update
+    bool m_dirty = false;
+
 #if defined(MTS_ENABLE_OPTIX)
     /// OptiX hitgroup data buffer
     void* m_optix_data_ptr = nullptr;
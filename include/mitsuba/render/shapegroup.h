@@ -24,6 +24,9 @@ public:
 
 #if defined(MTS_ENABLE_EMBREE)
     RTCGeometry embree_geometry(RTCDevice device) override;
+
+    /// Return the Embree scene of the shapes of the group (built on first use)
+    RTCScene embree_scene(RTCDevice device);
 #else
     PreliminaryIntersection3f ray_intersect_preliminary(const Ray3f &ray,
                                                         Mask active) const override;
@@ -40,12 +43,69 @@ public:
 
     ScalarBoundingBox3f bbox() const override{ return m_bbox; }
 
+    /**
+     * \brief Return a bounding box of the group's contents after applying
+     * the transformation \c to_world
+     *
+     * Transforming the corners of \ref bbox() yields a loose bound when the
+     * transformation involves a rotation. This function instead transforms a
+     * small set of boxes that tightly cover the primitives of the group,
+     * which results in considerably tighter bounds for instances.
+     */
+    ScalarBoundingBox3f transformed_bbox(const ScalarTransform4f &to_world) const;
+
     ScalarFloat surface_area() const override { return 0.f; }
 
+    /// Return the number of coarser levels of detail of this group
+    size_t lod_count() const { return m_lods.size(); }
+
+    /// Return the coarser level of detail with index \c i (starting at 0 for \c lod_1)
+    ShapeGroup *lod(size_t i) const { return m_lods[i].get(); }
+
+    /**
+     * \brief Select the level of detail that is used to intersect \c ray
+     *
+     * The footprint of the ray where it enters the bounding box of the group
+     * is estimated from the angular spread \c lod_spread of the ray and
+     * compared against \c lod_threshold. Level 0 is the full-resolution
+     * geometry; every following level is used for a footprint that is twice as
+     * large. When \c lod_blend is enabled, the level is chosen stochastically
+     * between the two nearest ones based on a hash of the ray.
+     *
+     * \param ray
+     *     A ray in the local coordinate system of the group, whose direction
+     *     has been transformed from a normalized world-space direction.
+     */
+    UInt32 lod_level(const Ray3f &ray, Mask active = true) const;
+
     MTS_INLINE ScalarSize effective_primitive_count() const override { return 0; }
 
+#if defined(MTS_ENABLE_EMBREE) || defined(MTS_ENABLE_OPTIX)
+    /// Return the number of shapes of the group
+    size_t shape_count() const { return m_shapes.size(); }
+#endif
+
+    /**
+     * \brief Build the kd-tree of the group
+     *
+     * The construction is deferred to the scene, which builds the trees of
+     * all of its groups together with the top-level data structure (see
+     * \ref Scene::accel_build_pending()). Does nothing when the tree was
+     * already built, and when Embree is used.
+     */
+    void accel_build();
+
+    /// Has the kd-tree of the group been built (always \c true with Embree)?
+    bool accel_ready() const;
+
+    /// Return the union of the flags of the BSDFs of all shapes and levels of detail
+    uint32_t nested_bsdf_flags() const { return m_nested_bsdf_flags; }
+
     std::string to_string() const override;
 
+    /// Account the acceleration data structure and the shapes of the group
+    void account_memory(MemoryReport *report) const override;
+
 #if defined(MTS_ENABLE_OPTIX)
     void optix_prepare_ias(const OptixDeviceContext& context,
                            std::vector<OptixInstance>& instances,
@@ -65,9 +125,27 @@ public:
 #endif
 
     MTS_DECLARE_CLASS()
+private:
+    /// Compute \ref m_bbox_cover from the bounding boxes of all primitives
+    void compute_bbox_cover(std::vector<ScalarBoundingBox3f> &prim_bboxes);
+
 private:
     ScalarBoundingBox3f m_bbox;
 
+    /// Small set of boxes covering the primitives, used by \ref transformed_bbox()
+    std::vector<ScalarBoundingBox3f> m_bbox_cover;
+
+    /// Coarser levels of detail (\c lod_1, \c lod_2, ...)
+    std::vector<ref<ShapeGroup>> m_lods;
+    /// Angular spread of rays (in radians) used to estimate their footprint
+    ScalarFloat m_lod_spread;
+    /// Footprint (in local units) at which the first coarser level is used
+    ScalarFloat m_lod_threshold;
+    /// Blend stochastically between neighboring levels?
+    bool m_lod_blend;
+    /// Union of the flags of the nested BSDFs, see \ref nested_bsdf_flags()
+    uint32_t m_nested_bsdf_flags = 0;
+
 #if defined(MTS_ENABLE_EMBREE) || defined(MTS_ENABLE_OPTIX)
     std::vector<ref<Base>> m_shapes;
 #endif
@@ -5,6 +5,7 @@
 #include <mitsuba/render/film.h>
 #include <mitsuba/render/imageblock.h>
 #include <tbb/spin_mutex.h>
+#include <vector>
 
 #if !defined(MTS_BLOCK_SIZE)
 #  define MTS_BLOCK_SIZE 32
@@ -38,7 +39,60 @@ public:
     size_t max_block_size() const { return m_block_size; }
 
     /// Return the total number of blocks
-    size_t block_count() { return m_block_count; }
+    size_t block_count() const { return m_block_count; }
+
+    /**
+     * \brief Return the total number of work items of all passes
+     *
+     * This accounts for the additional items created by \ref set_tail_subdivision().
+     */
+    size_t work_count() const {
+        return m_passes * m_block_count - m_tail_count + m_tail_blocks.size();
+    }
+
+    /**
+     * \brief Return the offset, size and unique identifer of the work item
+     * with the given index (in <tt>[0, work_count())</tt>).
+     *
+     * The spiral order is precomputed, hence this function does not modify
+     * the spiral's state and can be called concurrently from multiple threads,
+     * e.g. with indices provided by a parallel range.
+     */
+    std::tuple<Vector2i, Vector2i, size_t> block(size_t index) const;
+
+    /**
+     * \brief Split the last \c count blocks of the final pass into four
+     * quadrants each.
+     *
+     * The finer granularity at the end of the render makes it easier to keep
+     * all threads busy while the last (potentially expensive) blocks finish.
+     * Only affects \ref block() and \ref work_count().
+     */
+    void set_tail_subdivision(size_t count);
+
+    /**
+     * \brief Hand out the blocks of every pass by decreasing priority
+     *
+     * \c priorities specifies the priority of each block, in spiral order
+     * (i.e. the order of the blocks returned by \ref block() before the
+     * first call to this function). Blocks of equal priority keep their
+     * spiral order, and an empty vector restores it. The unique identifiers
+     * of the blocks don't depend on their order.
+     *
+     * This function is not thread-safe: it must be called while no blocks
+     * are being rendered, e.g. between two passes.
+     */
+    void set_priorities(const std::vector<float> &priorities);
+
+    /**
+     * \brief Prioritize the blocks according to a map over the film
+     *
+     * The priority of a block is the maximum of the first channel of \c map
+     * (stretched over the film of size \c film_size) over the region of the
+     * block. A \c nullptr map restores the spiral order.
+     * See \ref set_priorities() and \ref Film::set_priority_map().
+     */
+    void set_priority_map(const Bitmap *map, const Vector2i &film_size);
 
     /// Reset the spiral to its initial state. Does not affect the number of passes.
     void reset();
@@ -48,7 +102,7 @@ public:
      * Not affected by a call to \ref reset.
      */
     void set_passes(size_t passes) {
-        m_remaining_passes = passes;
+        m_passes = m_remaining_passes = passes;
     }
 
     /**
@@ -75,11 +129,18 @@ protected:
              m_offset,      //< Offset to the crop region on the sensor (pixels).
              m_blocks;      //< Number of blocks in each direction.
 
-    Point2i  m_position;    //< Relative position of the current block.
-    /// Direction where the spiral is currently headed.
-    Direction m_current_direction;
-    /// Step counters.
-    int m_steps_left, m_steps;
+    /// Relative offset and size of the blocks, in spiral order.
+    std::vector<std::pair<Vector2i, Vector2i>> m_block_list;
+
+    /// Indices of the blocks in the order of their priority (empty: spiral order).
+    std::vector<uint32_t> m_order;
+
+    /// Quadrants replacing the last \c m_tail_count blocks of the final pass.
+    std::vector<std::pair<Vector2i, Vector2i>> m_tail_blocks;
+    size_t m_tail_count;
+
+    /// Total number of passes.
+    size_t m_passes;
 
     /// Number of times the spiral should automatically restart.
     size_t m_remaining_passes;
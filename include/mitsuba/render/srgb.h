@@ -34,6 +34,32 @@ MTS_INLINE value_t<Array3f> srgb_model_mean(const Array3f &coeff) {
     return hmean(result);
 }
 
+/**
+ * \brief Check whether the spectrum of the given model coefficients is
+ * constant over the range of wavelengths
+ *
+ * This is the case for gray colors, whose spectra can be evaluated once
+ * instead of for every lane and wavelength. Returns the constant value of
+ * the spectrum, or NaN when it varies by more than \c tolerance.
+ */
+template <typename Array3f>
+value_t<Array3f> srgb_model_constant(const Array3f &coeff, value_t<Array3f> tolerance = 1e-5f) {
+    using Float = value_t<Array3f>;
+    using Vec = Array<Float, 64>;
+    static_assert(std::is_floating_point_v<Float>, "srgb_model_constant(): expected scalar coefficients!");
+
+    if (enoki::isinf(coeff.z()))
+        return fmadd(sign(coeff.z()), .5f, .5f);
+
+    Vec lambda = linspace<Vec>(MTS_WAVELENGTH_MIN, MTS_WAVELENGTH_MAX);
+    Vec v = fmadd(fmadd(coeff.x(), lambda, coeff.y()), lambda, coeff.z());
+    Vec result = max(0.f, fmadd(.5f * v, rsqrt(fmadd(v, v, 1.f)), .5f));
+
+    if (hmax(result) - hmin(result) > tolerance)
+        return std::numeric_limits<Float>::quiet_NaN();
+    return hmean(result);
+}
+
 /**
  * Look up the model coefficients for a sRGB color value
  * @param  c An sRGB color value where all components are in [0, 1].
@@ -41,6 +67,19 @@ MTS_INLINE value_t<Array3f> srgb_model_mean(const Array3f &coeff) {
  */
 MTS_EXPORT_RENDER Array<float, 3> srgb_model_fetch(const Color<float, 3> &);
 
+/**
+ * \brief Convert an array of \c count packed sRGB color values into model
+ * coefficients in place
+ *
+ * This is equivalent to calling \ref srgb_model_fetch() for every color, but
+ * evaluates the lookups in SIMD packets and in parallel, which is preferable
+ * for the large arrays of textures and mesh attributes.
+ */
+MTS_EXPORT_RENDER void srgb_model_fetch(float *data, size_t count);
+
+/// Double precision version of \ref srgb_model_fetch(float *, size_t)
+MTS_EXPORT_RENDER void srgb_model_fetch(double *data, size_t count);
+
 /// Sanity check: convert the coefficients back to sRGB
 // MTS_EXPORT_RENDER Color<float, 3> srgb_model_eval_rgb(const Array<float, 3> &);
 
@@ -234,9 +234,21 @@ public:
     /// Returns the maximum value of the texture over all dimensions.
     virtual ScalarFloat max() const;
 
+    /**
+     * \brief Returns an upper bound of the texture within a region of its
+     * local coordinate system (where the texture occupies the unit cube)
+     *
+     * This enables tighter bounds than \ref max() for sparse volumes. The
+     * default implementation returns \ref max().
+     */
+    virtual ScalarFloat local_max(const ScalarBoundingBox3f &bbox) const;
+
     /// Returns the bounding box of the 3d texture
     ScalarBoundingBox3f bbox() const { return m_bbox; }
 
+    /// Returns the transformation from world space into the unit cube
+    const ScalarTransform4f &world_to_local() const { return m_world_to_local; }
+
     /**
      * \brief Returns the resolution of the volume, assuming that it is based
      * on a discrete representation.
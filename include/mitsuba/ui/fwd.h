@@ -9,5 +9,6 @@ namespace ng = nanogui;
 
 class MitsubaViewer;
 class GUITexture;
+class GPUTexture;
 
 NAMESPACE_END(mitsuba)
@@ -22,6 +22,16 @@ public:
             InterpolationMode mag_interpolation_mode = InterpolationMode::Bilinear,
             WrapMode wrap_mode                       = WrapMode::ClampToEdge);
 
+    /**
+     * \brief Upload new contents from a bitmap of the same size
+     *
+     * The bitmap is converted if its pixel or component format differs
+     * from the texture's. Returns \c false (and leaves the texture
+     * unchanged) when the size differs.
+     */
+    bool upload(const Bitmap *bitmap);
+    using Base::upload;
+
 protected:
     virtual ~GPUTexture();
 };
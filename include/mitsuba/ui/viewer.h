@@ -1,7 +1,12 @@
 #pragma once
 
 #include <mitsuba/ui/fwd.h>
+#include <mitsuba/core/object.h>
 #include <nanogui/screen.h>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <thread>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -23,6 +28,38 @@ public:
     /// Load content (a scene or an image) into a tab
     void load(Tab *tab, const fs::path &scene);
 
+    /**
+     * \brief Enable the interactive progressive mode
+     *
+     * While the "Render" button is active, a background thread repeatedly
+     * invokes \c render_pass, which renders one more pass and returns the
+     * running average of all passes since the last restart (or \c nullptr
+     * when the pass was canceled). Each result is uploaded to the existing
+     * texture of the image view, which is only recreated when the image
+     * size changes. \c bitmap_mutex (if specified) is held during the
+     * upload, so that \c render_pass can update the bitmap in place.
+     *
+     * \c restart discards the accumulated passes and must be safe to call
+     * while \c render_pass runs. It is invoked by \ref restart_interactive(),
+     * which should be called after every edit of the scene (e.g. after
+     * changing the camera or a material through its parameters). See \ref
+     * ProgressiveRenderer for an implementation of both callbacks.
+     */
+    void set_interactive(std::function<ref<Bitmap>()> render_pass,
+                         std::function<void()> restart,
+                         std::mutex *bitmap_mutex = nullptr);
+
+    /// Restart the accumulation of the interactive mode
+    void restart_interactive();
+
+    /// Start rendering passes in the interactive mode
+    void start_interactive();
+
+    /// Pause the interactive mode (waits for the current pass to finish)
+    void stop_interactive();
+
+    virtual ~MitsubaViewer();
+
     using ng::Screen::perform_layout;
     virtual void perform_layout(NVGcontext* ctx) override;
     virtual bool keyboard_event(int key, int scancode, int action, int modifiers) override;
@@ -30,6 +67,9 @@ public:
 protected:
     void close_tab_impl(Tab *tab);
 
+    /// Upload a rendered pass to the image view (called on the UI thread)
+    void upload_pass(const Bitmap *bitmap);
+
 protected:
     ng::ref<ng::Button> m_btn_play, m_btn_stop, m_btn_reload;
     ng::ref<ng::PopupButton> m_btn_menu, m_btn_settings;
@@ -38,6 +78,14 @@ protected:
     ng::ref<ng::TabWidgetBase> m_tab_widget;
     ng::ref<ng::ImageView> m_view;
     std::vector<Tab *> m_tabs;
+
+    /// State of the interactive mode (see \ref set_interactive())
+    std::function<ref<Bitmap>()> m_render_pass;
+    std::function<void()> m_restart;
+    std::mutex *m_bitmap_mutex = nullptr;
+    std::thread m_render_thread;
+    std::atomic<bool> m_render_active { false }, m_upload_pending { false };
+    ng::ref<GPUTexture> m_texture;
 };
 
 NAMESPACE_END(mitsuba)
@@ -48,6 +48,11 @@ The following XML snippet describes the material shown above:
             <spectrum name="diffuse_reflectance" value="0.1"/>
         </bsdf>
     </bsdf>
+
+Blend materials can be nested to mix more than two BSDFs. In this case, the tree of nested blends is
+flattened into a single list of BSDFs with combined mixture weights when the scene is loaded: every
+weight texture is evaluated only once per interaction, a single BSDF is selected when sampling, and
+BSDFs with a vanishing weight are skipped during evaluation.
  */
 
 template <typename Float, typename Spectrum>
@@ -78,6 +83,8 @@ public:
                 m_components.push_back(m_nested_bsdf[i]->flags(j));
 
         m_flags = m_nested_bsdf[0]->flags() | m_nested_bsdf[1]->flags();
+
+        flatten();
     }
 
     std::pair<BSDFSample3f, Spectrum> sample(const BSDFContext &ctx,
@@ -85,39 +92,42 @@ public:
                                              Float sample1,
                                              const Point2f &sample2,
                                              Mask active) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::BSDFSample, active);
+        MTS_MASKED_METHOD(ProfilerPhase::BSDFSample, active);
+
+        Float weights[max_leaves];
+        eval_leaf_weights(si, active, weights);
 
-        Float weight = eval_weight(si, active);
         if (unlikely(ctx.component != (uint32_t) -1)) {
-            bool sample_first = ctx.component < m_nested_bsdf[0]->component_count();
-            BSDFContext ctx2(ctx);
-            if (!sample_first)
-                ctx2.component -= (uint32_t) m_nested_bsdf[0]->component_count();
-            else
-                weight = 1.f - weight;
-            auto [bs, result] = m_nested_bsdf[sample_first ? 0 : 1]->sample(ctx2, si, sample1, sample2, active);
-            result *= weight;
+            auto [index, ctx2] = leaf_context(ctx);
+            auto [bs, result] = m_leaves[index].bsdf->sample(ctx2, si, sample1, sample2, active);
+            result *= weights[index];
             return { bs, result };
         }
 
         BSDFSample3f bs = zero<BSDFSample3f>();
         Spectrum result(0.f);
 
-        Mask m0 = active && sample1 >  weight,
-             m1 = active && sample1 <= weight;
-
-        if (any_or<true>(m0)) {
-            auto [bs0, result0] = m_nested_bsdf[0]->sample(
-                ctx, si, (sample1 - weight) / (1 - weight), sample2, m0);
-            masked(bs, m0) = bs0;
-            masked(result, m0) = result0;
-        }
+        /* Stochastically select one of the leaves. The subintervals of [0, 1)
+           are assigned from the last leaf to the first one, which matches
+           the (1 - weight, weight) split of a single blend. */
+        Float cdf = 0.f;
+        Mask remaining = active;
+        for (size_t i = m_leaves.size(); i-- > 0; ) {
+            Mask selected = remaining;
+            if (i > 0)
+                selected &= sample1 < cdf + weights[i];
+            remaining &= !selected;
+
+            if (any_or<true>(selected)) {
+                Float sample1_leaf = min((sample1 - cdf) / weights[i],
+                                         math::OneMinusEpsilon<Float>);
+                auto [bs_leaf, result_leaf] = m_leaves[i].bsdf->sample(
+                    ctx, si, sample1_leaf, sample2, selected);
+                masked(bs, selected) = bs_leaf;
+                masked(result, selected) = result_leaf;
+            }
 
-        if (any_or<true>(m1)) {
-            auto [bs1, result1] = m_nested_bsdf[1]->sample(
-                ctx, si, sample1 / weight, sample2, m1);
-            masked(bs, m1) = bs1;
-            masked(result, m1) = result1;
+            cdf += weights[i];
         }
 
         return { bs, result };
@@ -125,42 +135,79 @@ public:
 
     Spectrum eval(const BSDFContext &ctx, const SurfaceInteraction3f &si,
                   const Vector3f &wo, Mask active) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::BSDFEvaluate, active);
+        MTS_MASKED_METHOD(ProfilerPhase::BSDFEvaluate, active);
+
+        Float weights[max_leaves];
+        eval_leaf_weights(si, active, weights);
 
-        Float weight = eval_weight(si, active);
         if (unlikely(ctx.component != (uint32_t) -1)) {
-            bool sample_first = ctx.component < m_nested_bsdf[0]->component_count();
-            BSDFContext ctx2(ctx);
-            if (!sample_first)
-                ctx2.component -= (uint32_t) m_nested_bsdf[0]->component_count();
-            else
-                weight = 1.f - weight;
-            return weight * m_nested_bsdf[sample_first ? 0 : 1]->eval(ctx2, si, wo, active);
+            auto [index, ctx2] = leaf_context(ctx);
+            return weights[index] * m_leaves[index].bsdf->eval(ctx2, si, wo, active);
         }
 
-        return m_nested_bsdf[0]->eval(ctx, si, wo, active) * (1 - weight) +
-               m_nested_bsdf[1]->eval(ctx, si, wo, active) * weight;
+        Spectrum result(0.f);
+        for (size_t i = 0; i < m_leaves.size(); ++i) {
+            // Skip the dispatch for leaves that don't contribute
+            Mask active_leaf = active && weights[i] > 0.f;
+            if (any_or<true>(active_leaf))
+                masked(result, active_leaf) +=
+                    weights[i] * m_leaves[i].bsdf->eval(ctx, si, wo, active_leaf);
+        }
+
+        return result;
     }
 
     Float pdf(const BSDFContext &ctx, const SurfaceInteraction3f &si,
               const Vector3f &wo, Mask active) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::BSDFEvaluate, active);
+        MTS_MASKED_METHOD(ProfilerPhase::BSDFEvaluate, active);
 
         if (unlikely(ctx.component != (uint32_t) -1)) {
-            bool sample_first = ctx.component < m_nested_bsdf[0]->component_count();
-            BSDFContext ctx2(ctx);
-            if (!sample_first)
-                ctx2.component -= (uint32_t) m_nested_bsdf[0]->component_count();
-            return m_nested_bsdf[sample_first ? 0 : 1]->pdf(ctx2, si, wo, active);
+            auto [index, ctx2] = leaf_context(ctx);
+            return m_leaves[index].bsdf->pdf(ctx2, si, wo, active);
+        }
+
+        Float weights[max_leaves];
+        eval_leaf_weights(si, active, weights);
+
+        Float result = 0.f;
+        for (size_t i = 0; i < m_leaves.size(); ++i) {
+            Mask active_leaf = active && weights[i] > 0.f;
+            if (any_or<true>(active_leaf))
+                masked(result, active_leaf) +=
+                    weights[i] * m_leaves[i].bsdf->pdf(ctx, si, wo, active_leaf);
         }
 
-        Float weight = eval_weight(si, active);
-        return m_nested_bsdf[0]->pdf(ctx, si, wo, active) * (1 - weight) +
-               m_nested_bsdf[1]->pdf(ctx, si, wo, active) * weight;
+        return result;
     }
 
-    MTS_INLINE Float eval_weight(const SurfaceInteraction3f &si, const Mask &active) const {
-        return clamp(m_weight->eval_1(si, active), 0.f, 1.f);
+    std::pair<Spectrum, Float> eval_pdf(const BSDFContext &ctx,
+                                        const SurfaceInteraction3f &si,
+                                        const Vector3f &wo,
+                                        Mask active) const override {
+        MTS_MASKED_METHOD(ProfilerPhase::BSDFEvaluate, active);
+
+        Float weights[max_leaves];
+        eval_leaf_weights(si, active, weights);
+
+        if (unlikely(ctx.component != (uint32_t) -1)) {
+            auto [index, ctx2] = leaf_context(ctx);
+            auto [value, pdf] = m_leaves[index].bsdf->eval_pdf(ctx2, si, wo, active);
+            return { weights[index] * value, pdf };
+        }
+
+        Spectrum value(0.f);
+        Float pdf = 0.f;
+        for (size_t i = 0; i < m_leaves.size(); ++i) {
+            Mask active_leaf = active && weights[i] > 0.f;
+            if (any_or<true>(active_leaf)) {
+                auto [value_leaf, pdf_leaf] =
+                    m_leaves[i].bsdf->eval_pdf(ctx, si, wo, active_leaf);
+                masked(value, active_leaf) += weights[i] * value_leaf;
+                masked(pdf, active_leaf) += weights[i] * pdf_leaf;
+            }
+        }
+
+        return { value, pdf };
     }
 
     void traverse(TraversalCallback *callback) override {
@@ -180,9 +227,97 @@ public:
     }
 
     MTS_DECLARE_CLASS()
+protected:
+    /// Maximum number of leaves of a flattened blend tree
+    static constexpr size_t max_leaves = 16;
+
+    /// Non-blend BSDF of a flattened blend tree
+    struct Leaf {
+        ref<Base> bsdf;
+        /// Index of the first component of the leaf within this BSDF
+        uint32_t component_offset;
+        /**
+         * Factors of the mixture weight of the leaf: an index into
+         * \c m_weights, and whether the weight (\c true) or its
+         * complement (\c false) is used.
+         */
+        std::vector<std::pair<uint32_t, bool>> factors;
+    };
+
+    /**
+     * \brief Flatten nested blend BSDFs into a single list of leaves
+     *
+     * Nested instances are constructed (and flattened) before their parent,
+     * hence their leaves can simply be adopted. Weight textures shared by
+     * several blends are only stored (and evaluated) once.
+     */
+    void flatten() {
+        auto weight_index = [&](Texture *texture) {
+            for (size_t i = 0; i < m_weights.size(); ++i)
+                if (m_weights[i] == texture)
+                    return (uint32_t) i;
+            m_weights.push_back(texture);
+            return (uint32_t) m_weights.size() - 1;
+        };
+
+        m_leaves.clear();
+        m_weights.clear();
+        uint32_t own_weight = weight_index(m_weight.get()),
+                 component_offset = 0;
+
+        for (size_t i = 0; i < 2; ++i) {
+            std::pair<uint32_t, bool> factor(own_weight, i == 1);
+            auto *nested = dynamic_cast<BlendBSDF *>(m_nested_bsdf[i].get());
+            size_t other_leaves = i == 0 ? 1 : 0;
+
+            if (nested && m_leaves.size() + nested->m_leaves.size() + other_leaves <= max_leaves) {
+                for (const Leaf &leaf : nested->m_leaves) {
+                    Leaf result{ leaf.bsdf, component_offset + leaf.component_offset, { factor } };
+                    for (auto [index, second] : leaf.factors)
+                        result.factors.emplace_back(weight_index(nested->m_weights[index].get()),
+                                                    second);
+                    m_leaves.push_back(std::move(result));
+                }
+            } else {
+                m_leaves.push_back(Leaf{ m_nested_bsdf[i], component_offset, { factor } });
+            }
+
+            component_offset += (uint32_t) m_nested_bsdf[i]->component_count();
+        }
+    }
+
+    /// Evaluate the mixture weights of all leaves
+    void eval_leaf_weights(const SurfaceInteraction3f &si, const Mask &active,
+                           Float *weights) const {
+        Float values[max_leaves];
+        for (size_t i = 0; i < m_weights.size(); ++i)
+            values[i] = clamp(m_weights[i]->eval_1(si, active), 0.f, 1.f);
+
+        for (size_t i = 0; i < m_leaves.size(); ++i) {
+            weights[i] = 1.f;
+            for (auto [index, second] : m_leaves[i].factors)
+                weights[i] *= second ? values[index] : 1.f - values[index];
+        }
+    }
+
+    /// Find the leaf of the component selected by \c ctx and adjust its index
+    std::pair<size_t, BSDFContext> leaf_context(const BSDFContext &ctx) const {
+        size_t index = m_leaves.size() - 1;
+        while (index > 0 && ctx.component < m_leaves[index].component_offset)
+            --index;
+        BSDFContext ctx2(ctx);
+        ctx2.component -= m_leaves[index].component_offset;
+        return { index, ctx2 };
+    }
+
 protected:
     ref<Texture> m_weight;
     ref<Base> m_nested_bsdf[2];
+
+    /// Leaves of the flattened blend tree
+    std::vector<Leaf> m_leaves;
+    /// Distinct weight textures of the flattened blend tree
+    std::vector<ref<Texture>> m_weights;
 };
 
 MTS_IMPLEMENT_CLASS_VARIANT(BlendBSDF, BSDF)
@@ -58,6 +58,11 @@ map. Note the we set the ``raw`` properties of the bump map ``bitmap`` object to
         </texture>
         <bsdf type="roughplastic"/>
     </bsdf>
+
+The gradient of the height field is evaluated by every BSDF query, including the ones of shadow
+rays. Bitmap textures can precompute the required texel differences at load time to turn this
+into a single texture lookup (see the ``precompute_gradient`` parameter of the
+:ref:`bitmap <texture-bitmap>` plugin).
 */
 
 template <typename Float, typename Spectrum>
@@ -95,6 +100,9 @@ public:
         for (size_t i = 0; i < m_nested_bsdf->component_count(); ++i)
             m_components.push_back(m_nested_bsdf->flags(i));
         m_flags = m_nested_bsdf->flags();
+
+        // The perturbed frame depends on the orientation of the tangents
+        m_flags = m_flags | BSDFFlags::Anisotropic;
     }
 
     std::pair<BSDFSample3f, Spectrum> sample(const BSDFContext &ctx,
@@ -102,7 +110,7 @@ public:
                                              Float sample1,
                                              const Point2f &sample2,
                                              Mask active) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::BSDFSample, active);
+        MTS_MASKED_METHOD(ProfilerPhase::BSDFSample, active);
 
         // Sample nested BSDF with perturbed shading frame
         SurfaceInteraction3f perturbed_si(si);
@@ -123,7 +131,7 @@ public:
 
     Spectrum eval(const BSDFContext &ctx, const SurfaceInteraction3f &si,
                   const Vector3f &wo, Mask active) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::BSDFEvaluate, active);
+        MTS_MASKED_METHOD(ProfilerPhase::BSDFEvaluate, active);
 
         // Evaluate nested BSDF with perturbed shading frame
         SurfaceInteraction3f perturbed_si(si);
@@ -139,7 +147,7 @@ public:
 
     Float pdf(const BSDFContext &ctx, const SurfaceInteraction3f &si,
               const Vector3f &wo, Mask active) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::BSDFEvaluate, active);
+        MTS_MASKED_METHOD(ProfilerPhase::BSDFEvaluate, active);
 
         // Evaluate nested BSDF pdf with perturbed shading frame
         SurfaceInteraction3f perturbed_si(si);
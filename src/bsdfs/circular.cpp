@@ -67,7 +67,7 @@ public:
     std::pair<BSDFSample3f, Spectrum> sample(const BSDFContext &ctx, const SurfaceInteraction3f &si,
                                              Float /* sample1 */, const Point2f &/* sample2 */,
                                              Mask active) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::BSDFSample, active);
+        MTS_MASKED_METHOD(ProfilerPhase::BSDFSample, active);
 
         BSDFSample3f bs = zero<BSDFSample3f>();
         bs.wo = -si.wi;
@@ -122,7 +122,7 @@ public:
     }
 
     Spectrum eval_null_transmission(const SurfaceInteraction3f &si, Mask active) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::BSDFEvaluate, active);
+        MTS_MASKED_METHOD(ProfilerPhase::BSDFEvaluate, active);
 
         UnpolarizedSpectrum transmittance = m_transmittance->eval(si, active);
         if constexpr (is_polarized_v<Spectrum>) {
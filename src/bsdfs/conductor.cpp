@@ -219,7 +219,7 @@ public:
                                              Float /* sample1 */,
                                              const Point2f &/* sample2 */,
                                              Mask active) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::BSDFSample, active);
+        MTS_MASKED_METHOD(ProfilerPhase::BSDFSample, active);
 
         Float cos_theta_i = Frame3f::cos_theta(si.wi);
         active &= cos_theta_i > 0.f;
@@ -279,6 +279,13 @@ public:
         return 0.f;
     }
 
+    std::pair<Spectrum, Float> eval_pdf(const BSDFContext & /*ctx*/,
+                                        const SurfaceInteraction3f & /*si*/,
+                                        const Vector3f & /*wo*/,
+                                        Mask /*active*/) const override {
+        return { 0.f, 0.f };
+    }
+
     void traverse(TraversalCallback *callback) override {
         callback->put_object("specular_reflectance", m_specular_reflectance.get());
         callback->put_object("eta", m_eta.get());
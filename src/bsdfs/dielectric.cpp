@@ -203,7 +203,7 @@ public:
                                              Float sample1,
                                              const Point2f & /* sample2 */,
                                              Mask active) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::BSDFSample, active);
+        MTS_MASKED_METHOD(ProfilerPhase::BSDFSample, active);
 
         bool has_reflection   = ctx.is_enabled(BSDFFlags::DeltaReflection, 0),
              has_transmission = ctx.is_enabled(BSDFFlags::DeltaTransmission, 1);
@@ -211,7 +211,7 @@ public:
         // Evaluate the Fresnel equations for unpolarized illumination
         Float cos_theta_i = Frame3f::cos_theta(si.wi);
 
-        auto [r_i, cos_theta_t, eta_it, eta_ti] = fresnel(cos_theta_i, Float(m_eta));
+        auto [r_i, cos_theta_t, eta_it, eta_ti] = fresnel(cos_theta_i, m_eta);
         Float t_i = 1.f - r_i;
 
         // Lobe selection
@@ -341,7 +341,8 @@ public:
 
     MTS_DECLARE_CLASS()
 private:
-    ScalarFloat m_eta;
+    /// Stored as an array so that updates of 'eta' don't require recompilation (GPU variants)
+    Float m_eta;
     ref<Texture> m_specular_reflectance;
     ref<Texture> m_specular_transmittance;
 };
@@ -20,6 +20,10 @@ Opacity mask (:monosp:`mask`)
  * - (Nested plugin)
    - |bsdf|
    - A base BSDF model that represents the non-transparent portion of the scattering
+ * - alpha_test
+   - |bool|
+   - Skip intersections with perfectly transparent regions (opacity 0) already during ray
+     traversal. Only textured opacities are tested. (Default: |true|)
 
 .. subfigstart::
 .. subfigure:: ../../resources/data/docs/images/render/bsdf_mask_before.jpg
@@ -37,6 +41,13 @@ Note that the standard :ref:`path tracer <integrator-path>` does not have a good
 but the (:ref:`volumetric path tracer <integrator-volpath>`) does. It may thus be preferable when rendering
 scenes that contain the :ref:`mask <bsdf-mask>` plugin, even if there is nothing *volumetric* in the scene.
 
+Cutouts such as foliage are usually either fully opaque or fully transparent. With
+:monosp:`alpha_test` enabled, the ray tracer evaluates the opacity texture for every tentative
+intersection with a triangle mesh and directly continues the traversal when it is zero, so these
+regions cost neither a return to the integrator nor a new ray. Partially transparent regions are
+still handled stochastically as described above. Intersections are not alpha tested when the
+shape is an emitter or a medium transition, or when rendering with the GPU variants.
+
 The following XML snippet describes a material configuration for a transparent leaf:
 
 .. code-block:: xml
@@ -68,6 +79,7 @@ public:
     MaskBSDF(const Properties &props) : Base(props) {
         // Scalar-typed opacity texture
         m_opacity = props.texture<Texture>("opacity", 0.5f);
+        m_alpha_test = props.bool_("alpha_test", true);
 
         for (auto &[name, obj] : props.objects(false)) {
             auto *bsdf = dynamic_cast<Base *>(obj.get());
@@ -95,7 +107,7 @@ public:
                                              Float sample1,
                                              const Point2f &sample2,
                                              Mask active) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::BSDFSample, active);
+        MTS_MASKED_METHOD(ProfilerPhase::BSDFSample, active);
 
         uint32_t null_index = (uint32_t) component_count() - 1;
 
@@ -131,7 +143,7 @@ public:
 
     Spectrum eval(const BSDFContext &ctx, const SurfaceInteraction3f &si,
                   const Vector3f &wo, Mask active) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::BSDFEvaluate, active);
+        MTS_MASKED_METHOD(ProfilerPhase::BSDFEvaluate, active);
 
         Float opacity = eval_opacity(si, active);
         return m_nested_bsdf->eval(ctx, si, wo, active) * opacity;
@@ -139,7 +151,7 @@ public:
 
     Float pdf(const BSDFContext &ctx, const SurfaceInteraction3f &si,
               const Vector3f &wo, Mask active) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::BSDFEvaluate, active);
+        MTS_MASKED_METHOD(ProfilerPhase::BSDFEvaluate, active);
 
         uint32_t null_index      = (uint32_t) component_count() - 1;
         bool sample_transmission = ctx.is_enabled(BSDFFlags::Null, null_index);
@@ -161,6 +173,12 @@ public:
         return 1 - opacity * (1 - m_nested_bsdf->eval_null_transmission(si, active));
     }
 
+    const Texture *alpha_mask() const override {
+        if (m_alpha_test && m_opacity->is_spatially_varying())
+            return m_opacity.get();
+        return nullptr;
+    }
+
     MTS_INLINE Float eval_opacity(const SurfaceInteraction3f &si, Mask active) const {
         return clamp(m_opacity->eval_1(si, active), 0.f, 1.f);
     }
@@ -174,6 +192,7 @@ public:
         std::ostringstream oss;
         oss << "Mask[" << std::endl
             << "  opacity = " << m_opacity << "," << std::endl
+            << "  alpha_test = " << m_alpha_test << "," << std::endl
             << "  nested_bsdf = " << string::indent(m_nested_bsdf) << std::endl
             << "]";
         return oss.str();
@@ -183,6 +202,7 @@ public:
 private:
     ref<Texture> m_opacity;
     ref<Base> m_nested_bsdf;
+    bool m_alpha_test;
 };
 
 MTS_IMPLEMENT_CLASS_VARIANT(MaskBSDF, BSDF)
@@ -1,5 +1,6 @@
 #include <mitsuba/core/properties.h>
 #include <mitsuba/core/fresolver.h>
+#include <mitsuba/core/rescache.h>
 #include <mitsuba/core/tensor.h>
 #include <mitsuba/core/distr_2d.h>
 #include <mitsuba/core/warp.h>
@@ -19,9 +20,28 @@ public:
     MTS_IMPORT_BASE(BSDF, m_flags, m_components)
     MTS_IMPORT_TYPES()
 
-    using Warp2D0 = Marginal2D<Float, 0, true>;
     using Warp2D2 = Marginal2D<Float, 2, true>;
-    using Warp2D3 = Marginal2D<Float, 3, true>;
+
+    /* Interpolants that are only evaluated (never sampled) store their
+       values at half precision, which halves the footprint of the large
+       spectral table. This is far below the noise of the measurements. */
+    using Interp2D0 = Marginal2D<Float, 0, true, enoki::half>;
+    using Interp2D3 = Marginal2D<Float, 3, true, enoki::half>;
+
+    /**
+     * Tables of a measured material, which are shared by all materials that
+     * load the same file (see \ref ResourceCache)
+     */
+    struct Tables : public Object {
+        Interp2D0 ndf;
+        Interp2D0 sigma;
+        Warp2D2 vndf;
+        Warp2D2 luminance;
+        Interp2D3 spectra;
+        bool isotropic;
+        bool jacobian;
+        int reduction = 0;
+    };
 
     Measured(const Properties &props) : Base(props) {
         if constexpr (is_polarized_v<Spectrum>)
@@ -34,126 +54,11 @@ public:
         fs::path file_path = fs->resolve(props.string("filename"));
         m_name             = file_path.filename().string();
 
-        ref<TensorFile> tf = new TensorFile(file_path);
-        auto theta_i       = tf->field("theta_i");
-        auto phi_i         = tf->field("phi_i");
-        auto ndf           = tf->field("ndf");
-        auto sigma         = tf->field("sigma");
-        auto vndf          = tf->field("vndf");
-        auto spectra       = tf->field("spectra");
-        auto luminance     = tf->field("luminance");
-        auto wavelengths   = tf->field("wavelengths");
-        auto description   = tf->field("description");
-        auto jacobian      = tf->field("jacobian");
-
-        if (!(description.shape.size() == 1 &&
-              description.dtype == Struct::Type::UInt8 &&
-
-              theta_i.shape.size() == 1 &&
-              theta_i.dtype == Struct::Type::Float32 &&
-
-              phi_i.shape.size() == 1 &&
-              phi_i.dtype == Struct::Type::Float32 &&
-
-              wavelengths.shape.size() == 1 &&
-              wavelengths.dtype == Struct::Type::Float32 &&
-
-              ndf.shape.size() == 2 &&
-              ndf.dtype == Struct::Type::Float32 &&
-
-              sigma.shape.size() == 2 &&
-              sigma.dtype == Struct::Type::Float32 &&
-
-              vndf.shape.size() == 4 &&
-              vndf.dtype == Struct::Type::Float32 &&
-              vndf.shape[0] == phi_i.shape[0] &&
-              vndf.shape[1] == theta_i.shape[0] &&
-
-              luminance.shape.size() == 4 &&
-              luminance.dtype == Struct::Type::Float32 &&
-              luminance.shape[0] == phi_i.shape[0] &&
-              luminance.shape[1] == theta_i.shape[0] &&
-              luminance.shape[2] == luminance.shape[3] &&
-
-              spectra.dtype == Struct::Type::Float32 &&
-              spectra.shape.size() == 5 &&
-              spectra.shape[0] == phi_i.shape[0] &&
-              spectra.shape[1] == theta_i.shape[0] &&
-              spectra.shape[2] == wavelengths.shape[0] &&
-              spectra.shape[3] == spectra.shape[4] &&
-
-              luminance.shape[2] == spectra.shape[3] &&
-              luminance.shape[3] == spectra.shape[4] &&
-
-              jacobian.shape.size() == 1 &&
-              jacobian.shape[0] == 1 &&
-              jacobian.dtype == Struct::Type::UInt8))
-              Throw("Invalid file structure: %s", tf);
-
-        m_isotropic = phi_i.shape[0] <= 2;
-        m_jacobian  = ((uint8_t *) jacobian.data)[0];
-
-        if (!m_isotropic) {
-            ScalarFloat *phi_i_data = (ScalarFloat *) phi_i.data;
-            m_reduction = (int) std::rint((2 * math::Pi<ScalarFloat>) /
-                (phi_i_data[phi_i.shape[0] - 1] - phi_i_data[0]));
-        }
-
-        // Construct NDF interpolant data structure
-        m_ndf = Warp2D0(
-            (ScalarFloat *) ndf.data,
-            ScalarVector2u(ndf.shape[1], ndf.shape[0]),
-            { }, { }, false, false
-        );
-
-        // Construct projected surface area interpolant data structure
-        m_sigma = Warp2D0(
-            (ScalarFloat *) sigma.data,
-            ScalarVector2u(sigma.shape[1], sigma.shape[0]),
-            { }, { }, false, false
-        );
-
-        // Construct VNDF warp data structure
-        m_vndf = Warp2D2(
-            (ScalarFloat *) vndf.data,
-            ScalarVector2u(vndf.shape[3], vndf.shape[2]),
-            {{ (uint32_t) phi_i.shape[0],
-               (uint32_t) theta_i.shape[0] }},
-            {{ (const ScalarFloat *) phi_i.data,
-               (const ScalarFloat *) theta_i.data }}
-        );
-
-        // Construct Luminance warp data structure
-        m_luminance = Warp2D2(
-            (ScalarFloat *) luminance.data,
-            ScalarVector2u(luminance.shape[3], luminance.shape[2]),
-            {{ (uint32_t) phi_i.shape[0],
-               (uint32_t) theta_i.shape[0] }},
-            {{ (const ScalarFloat *) phi_i.data,
-               (const ScalarFloat *) theta_i.data }}
-        );
-
-        // Construct spectral interpolant
-        m_spectra = Warp2D3(
-            (ScalarFloat *) spectra.data,
-            ScalarVector2u(spectra.shape[4], spectra.shape[3]),
-            {{ (uint32_t) phi_i.shape[0],
-               (uint32_t) theta_i.shape[0],
-               (uint32_t) wavelengths.shape[0] }},
-            {{ (const ScalarFloat *) phi_i.data,
-               (const ScalarFloat *) theta_i.data,
-               (const ScalarFloat *) wavelengths.data }},
-            false, false
-        );
-
-        std::string description_str(
-            (const char *) description.data,
-            (const char *) description.data + description.shape[0]
-        );
-
-        Log(Info, "Loaded material \"%s\" (resolution %i x %i x %i x %i x %i)",
-            description_str, spectra.shape[0], spectra.shape[1],
-            spectra.shape[3], spectra.shape[4], spectra.shape[2]);
+        /* Materials that load the same file share its tables, e.g. when
+           every object of a material library has its own copy */
+        std::string key = tfm::format("measured|%s|%s", ResourceCache::file_key(file_path),
+                                      class_()->variant());
+        m_tables = ResourceCache::instance()->get<Tables>(key, [&]() { return load(file_path); });
     }
 
     /**
@@ -172,7 +77,7 @@ public:
                                              Float /*sample1*/,
                                              const Point2f &sample2,
                                              Mask active) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::BSDFSample, active);
+        MTS_MASKED_METHOD(ProfilerPhase::BSDFSample, active);
 
         BSDFSample3f bs = zero<BSDFSample3f>();
         Vector3f wi = si.wi;
@@ -183,9 +88,9 @@ public:
 
         Float sx = -1.f, sy = -1.f;
 
-        if (m_reduction >= 2) {
+        if (m_tables->reduction >= 2) {
             sy = wi.y();
-            sx = (m_reduction == 4) ? wi.x() : sy;
+            sx = (m_tables->reduction == 4) ? wi.x() : sy;
             wi.x() = mulsign_neg(wi.x(), sx);
             wi.y() = mulsign_neg(wi.y(), sy);
         }
@@ -203,15 +108,15 @@ public:
         Float pdf = 1.f;
 
         #if MTS_SAMPLE_LUMINANCE == 1
-        std::tie(sample, pdf) = m_luminance.sample(sample, params, active);
+        std::tie(sample, pdf) = m_tables->luminance.sample(sample, params, active);
         #endif
 
-        auto [u_m, ndf_pdf] = m_vndf.sample(sample, params, active);
+        auto [u_m, ndf_pdf] = m_tables->vndf.sample(sample, params, active);
 
         Float phi_m   = u2phi(u_m.y()),
             theta_m = u2theta(u_m.x());
 
-        if (m_isotropic)
+        if (m_tables->isotropic)
             phi_m += phi_i;
 
         // Spherical -> Cartesian coordinates
@@ -240,11 +145,11 @@ public:
             phi_m   = atan2(m.y(), m.x());
 
         Vector2f u_m(theta2u(theta_m),
-                    phi2u(m_isotropic ? (phi_m - phi_i) : phi_m));
+                    phi2u(m_tables->isotropic ? (phi_m - phi_i) : phi_m));
 
         u_m[1] = u_m[1] - floor(u_m[1]);
 
-    std::tie(sample, std::ignore) = m_vndf.invert(u_m, params, active);
+    std::tie(sample, std::ignore) = m_tables->vndf.invert(u_m, params, active);
 #endif // MTS_SAMPLE_DIFFUSE
 
         bs.eta               = 1.f;
@@ -254,12 +159,12 @@ public:
         UnpolarizedSpectrum spec;
         for (size_t i = 0; i < array_size_v<UnpolarizedSpectrum>; ++i) {
             Float params_spec[3] = { phi_i, theta_i, si.wavelengths[i] };
-            spec[i] = m_spectra.eval(sample, params_spec, active);
+            spec[i] = m_tables->spectra.eval(sample, params_spec, active);
         }
 
-        if (m_jacobian)
-            spec *= m_ndf.eval(u_m, params, active) /
-                    (4 * m_sigma.eval(u_wi, params, active));
+        if (m_tables->jacobian)
+            spec *= m_tables->ndf.eval(u_m, params, active) /
+                    (4 * m_tables->sigma.eval(u_wi, params, active));
 
         bs.wo.x() = mulsign_neg(bs.wo.x(), sx);
         bs.wo.y() = mulsign_neg(bs.wo.y(), sy);
@@ -271,7 +176,7 @@ public:
 
     Spectrum eval(const BSDFContext &ctx, const SurfaceInteraction3f &si,
                   const Vector3f &wo_, Mask active) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::BSDFEvaluate, active);
+        MTS_MASKED_METHOD(ProfilerPhase::BSDFEvaluate, active);
 
         Vector3f wi = si.wi, wo = wo_;
 
@@ -281,9 +186,9 @@ public:
         if (!ctx.is_enabled(BSDFFlags::GlossyReflection) || none_or<false>(active))
             return Spectrum(0.f);
 
-        if (m_reduction >= 2) {
+        if (m_tables->reduction >= 2) {
             Float sy = wi.y(),
-                sx = (m_reduction == 4) ? wi.x() : sy;
+                sx = (m_tables->reduction == 4) ? wi.x() : sy;
 
             wi.x() = mulsign_neg(wi.x(), sx);
             wi.y() = mulsign_neg(wi.y(), sy);
@@ -302,29 +207,29 @@ public:
         // Spherical coordinates -> unit coordinate system
         Vector2f u_wi(theta2u(theta_i), phi2u(phi_i)),
                 u_m (theta2u(theta_m), phi2u(
-                    m_isotropic ? (phi_m - phi_i) : phi_m));
+                    m_tables->isotropic ? (phi_m - phi_i) : phi_m));
 
         u_m[1] = u_m[1] - floor(u_m[1]);
 
         Float params[2] = { phi_i, theta_i };
-        auto [sample, unused] = m_vndf.invert(u_m, params, active);
+        auto [sample, unused] = m_tables->vndf.invert(u_m, params, active);
 
         UnpolarizedSpectrum spec;
         for (size_t i = 0; i < array_size_v<UnpolarizedSpectrum>; ++i) {
             Float params_spec[3] = { phi_i, theta_i, si.wavelengths[i] };
-            spec[i] = m_spectra.eval(sample, params_spec, active);
+            spec[i] = m_tables->spectra.eval(sample, params_spec, active);
         }
 
-        if (m_jacobian)
-            spec *= m_ndf.eval(u_m, params, active) /
-                    (4 * m_sigma.eval(u_wi, params, active));
+        if (m_tables->jacobian)
+            spec *= m_tables->ndf.eval(u_m, params, active) /
+                    (4 * m_tables->sigma.eval(u_wi, params, active));
 
         return unpolarized<Spectrum>(spec) & active;
     }
 
     Float pdf(const BSDFContext &ctx, const SurfaceInteraction3f &si,
               const Vector3f &wo_, Mask active) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::BSDFEvaluate, active);
+        MTS_MASKED_METHOD(ProfilerPhase::BSDFEvaluate, active);
 
         Vector3f wi = si.wi, wo = wo_;
 
@@ -334,9 +239,9 @@ public:
         if (!ctx.is_enabled(BSDFFlags::GlossyReflection) || none_or<false>(active))
             return 0.f;
 
-        if (m_reduction >= 2) {
+        if (m_tables->reduction >= 2) {
             Float sy = wi.y(),
-                sx = (m_reduction == 4) ? wi.x() : sy;
+                sx = (m_tables->reduction == 4) ? wi.x() : sy;
 
             wi.x() = mulsign_neg(wi.x(), sx);
             wi.y() = mulsign_neg(wi.y(), sy);
@@ -358,16 +263,16 @@ public:
         // Spherical coordinates -> unit coordinate system
         Vector2f u_wi(theta2u(theta_i), phi2u(phi_i));
         Vector2f u_m (theta2u(theta_m),
-                    phi2u(m_isotropic ? (phi_m - phi_i) : phi_m));
+                    phi2u(m_tables->isotropic ? (phi_m - phi_i) : phi_m));
 
         u_m[1] = u_m[1] - floor(u_m[1]);
 
         Float params[2] = { phi_i, theta_i };
-        auto [sample, vndf_pdf] = m_vndf.invert(u_m, params, active);
+        auto [sample, vndf_pdf] = m_tables->vndf.invert(u_m, params, active);
 
         Float pdf = 1.f;
         #if MTS_SAMPLE_LUMINANCE == 1
-        pdf = m_luminance.eval(sample, params, active);
+        pdf = m_tables->luminance.eval(sample, params, active);
         #endif
 
         Float jacobian =
@@ -384,17 +289,144 @@ public:
         std::ostringstream oss;
         oss << "Measured[" << std::endl
             << "  filename = \"" << m_name << "\"," << std::endl
-            << "  ndf = " << string::indent(m_ndf.to_string()) << "," << std::endl
-            << "  sigma = " << string::indent(m_sigma.to_string()) << "," << std::endl
-            << "  vndf = " << string::indent(m_vndf.to_string()) << "," << std::endl
-            << "  luminance = " << string::indent(m_luminance.to_string()) << "," << std::endl
-            << "  spectra = " << string::indent(m_spectra.to_string()) << std::endl
+            << "  ndf = " << string::indent(m_tables->ndf.to_string()) << "," << std::endl
+            << "  sigma = " << string::indent(m_tables->sigma.to_string()) << "," << std::endl
+            << "  vndf = " << string::indent(m_tables->vndf.to_string()) << "," << std::endl
+            << "  luminance = " << string::indent(m_tables->luminance.to_string()) << "," << std::endl
+            << "  spectra = " << string::indent(m_tables->spectra.to_string()) << std::endl
             << "]";
         return oss.str();
     }
 
     MTS_DECLARE_CLASS()
 private:
+    /// Load the tables of a measured material
+    static ref<Tables> load(const fs::path &file_path) {
+        ref<TensorFile> tf = new TensorFile(file_path);
+        auto theta_i       = tf->field("theta_i");
+        auto phi_i         = tf->field("phi_i");
+        auto ndf           = tf->field("ndf");
+        auto sigma         = tf->field("sigma");
+        auto vndf          = tf->field("vndf");
+        auto spectra       = tf->field("spectra");
+        auto luminance     = tf->field("luminance");
+        auto wavelengths   = tf->field("wavelengths");
+        auto description   = tf->field("description");
+        auto jacobian      = tf->field("jacobian");
+
+        if (!(description.shape.size() == 1 &&
+              description.dtype == Struct::Type::UInt8 &&
+
+              theta_i.shape.size() == 1 &&
+              theta_i.dtype == Struct::Type::Float32 &&
+
+              phi_i.shape.size() == 1 &&
+              phi_i.dtype == Struct::Type::Float32 &&
+
+              wavelengths.shape.size() == 1 &&
+              wavelengths.dtype == Struct::Type::Float32 &&
+
+              ndf.shape.size() == 2 &&
+              ndf.dtype == Struct::Type::Float32 &&
+
+              sigma.shape.size() == 2 &&
+              sigma.dtype == Struct::Type::Float32 &&
+
+              vndf.shape.size() == 4 &&
+              vndf.dtype == Struct::Type::Float32 &&
+              vndf.shape[0] == phi_i.shape[0] &&
+              vndf.shape[1] == theta_i.shape[0] &&
+
+              luminance.shape.size() == 4 &&
+              luminance.dtype == Struct::Type::Float32 &&
+              luminance.shape[0] == phi_i.shape[0] &&
+              luminance.shape[1] == theta_i.shape[0] &&
+              luminance.shape[2] == luminance.shape[3] &&
+
+              spectra.dtype == Struct::Type::Float32 &&
+              spectra.shape.size() == 5 &&
+              spectra.shape[0] == phi_i.shape[0] &&
+              spectra.shape[1] == theta_i.shape[0] &&
+              spectra.shape[2] == wavelengths.shape[0] &&
+              spectra.shape[3] == spectra.shape[4] &&
+
+              luminance.shape[2] == spectra.shape[3] &&
+              luminance.shape[3] == spectra.shape[4] &&
+
+              jacobian.shape.size() == 1 &&
+              jacobian.shape[0] == 1 &&
+              jacobian.dtype == Struct::Type::UInt8))
+              Throw("Invalid file structure: %s", tf);
+
+        ref<Tables> tables = new Tables();
+        tables->isotropic = phi_i.shape[0] <= 2;
+        tables->jacobian  = ((uint8_t *) jacobian.data)[0];
+
+        if (!tables->isotropic) {
+            ScalarFloat *phi_i_data = (ScalarFloat *) phi_i.data;
+            tables->reduction = (int) std::rint((2 * math::Pi<ScalarFloat>) /
+                (phi_i_data[phi_i.shape[0] - 1] - phi_i_data[0]));
+        }
+
+        // Construct NDF interpolant data structure
+        tables->ndf = Interp2D0(
+            (ScalarFloat *) ndf.data,
+            ScalarVector2u(ndf.shape[1], ndf.shape[0]),
+            { }, { }, false, false
+        );
+
+        // Construct projected surface area interpolant data structure
+        tables->sigma = Interp2D0(
+            (ScalarFloat *) sigma.data,
+            ScalarVector2u(sigma.shape[1], sigma.shape[0]),
+            { }, { }, false, false
+        );
+
+        // Construct VNDF warp data structure
+        tables->vndf = Warp2D2(
+            (ScalarFloat *) vndf.data,
+            ScalarVector2u(vndf.shape[3], vndf.shape[2]),
+            {{ (uint32_t) phi_i.shape[0],
+               (uint32_t) theta_i.shape[0] }},
+            {{ (const ScalarFloat *) phi_i.data,
+               (const ScalarFloat *) theta_i.data }}
+        );
+
+        // Construct Luminance warp data structure
+        tables->luminance = Warp2D2(
+            (ScalarFloat *) luminance.data,
+            ScalarVector2u(luminance.shape[3], luminance.shape[2]),
+            {{ (uint32_t) phi_i.shape[0],
+               (uint32_t) theta_i.shape[0] }},
+            {{ (const ScalarFloat *) phi_i.data,
+               (const ScalarFloat *) theta_i.data }}
+        );
+
+        // Construct spectral interpolant
+        tables->spectra = Interp2D3(
+            (ScalarFloat *) spectra.data,
+            ScalarVector2u(spectra.shape[4], spectra.shape[3]),
+            {{ (uint32_t) phi_i.shape[0],
+               (uint32_t) theta_i.shape[0],
+               (uint32_t) wavelengths.shape[0] }},
+            {{ (const ScalarFloat *) phi_i.data,
+               (const ScalarFloat *) theta_i.data,
+               (const ScalarFloat *) wavelengths.data }},
+            false, false
+        );
+
+        std::string description_str(
+            (const char *) description.data,
+            (const char *) description.data + description.shape[0]
+        );
+
+        Log(Info, "Loaded material \"%s\" (resolution %i x %i x %i x %i x %i)",
+            description_str, spectra.shape[0], spectra.shape[1],
+            spectra.shape[3], spectra.shape[4], spectra.shape[2]);
+
+        return tables;
+    }
+
     template <typename Value> Value u2theta(Value u) const {
         return sqr(u) * (math::Pi<Float> / 2.f);
     }
@@ -413,14 +445,7 @@ private:
 
 private:
     std::string m_name;
-    Warp2D0 m_ndf;
-    Warp2D0 m_sigma;
-    Warp2D2 m_vndf;
-    Warp2D2 m_luminance;
-    Warp2D3 m_spectra;
-    bool m_isotropic;
-    bool m_jacobian;
-    int m_reduction;
+    ref<const Tables> m_tables;
 };
 
 MTS_IMPLEMENT_CLASS_VARIANT(Measured, BSDF)
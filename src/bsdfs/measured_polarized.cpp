@@ -1,6 +1,7 @@
 #include <mitsuba/core/properties.h>
 #include <mitsuba/core/warp.h>
 #include <mitsuba/core/fresolver.h>
+#include <mitsuba/core/rescache.h>
 #include <mitsuba/core/tensor.h>
 #include <mitsuba/core/distr_2d.h>
 #include <mitsuba/render/bsdf.h>
@@ -98,6 +99,14 @@ public:
 
     using Interpolator = Marginal2D<Float, 4, true>;
 
+    /**
+     * Tabulated pBRDF, which is shared by all materials that load the same
+     * file (see \ref ResourceCache)
+     */
+    struct Tables : public Object {
+        Interpolator interpolator;
+    };
+
     MeasuredPolarized(const Properties &props) : Base(props) {
         if constexpr (!is_spectral_v<Spectrum>)
             Throw("The measured polarized BSDF model is only supported in spectral modes!");
@@ -115,55 +124,11 @@ public:
         fs::path file_path = fs->resolve(props.string("filename"));
         m_name = file_path.filename().string();
 
-        ref<TensorFile> tf = new TensorFile(file_path);
-
-        auto theta_h = tf->field("theta_h");
-        auto theta_d = tf->field("theta_d");
-        auto phi_d   = tf->field("phi_d");
-        auto wvls    = tf->field("wvls");
-        auto pbrdf   = tf->field("M");
-
-        if (!(theta_h.shape.size() == 2 &&
-              theta_h.dtype == Struct::Type::Float32 &&
-
-              theta_d.shape.size() == 2 &&
-              theta_d.dtype == Struct::Type::Float32 &&
-
-              phi_d.shape.size() == 2 &&
-              phi_d.dtype == Struct::Type::Float32 &&
-
-              wvls.shape.size() == 1 &&
-              wvls.dtype == Struct::Type::UInt16 &&
-
-              pbrdf.dtype == Struct::Type::Float32 &&
-              pbrdf.shape.size() == 6 &&
-              pbrdf.shape[0] == phi_d.shape[1] &&
-              pbrdf.shape[1] == theta_d.shape[1] &&
-              pbrdf.shape[2] == theta_h.shape[1] &&
-              pbrdf.shape[3] == wvls.shape[0]) &&
-              pbrdf.shape[4] == 4 &&
-              pbrdf.shape[5] == 4) {
-            Throw("Invalid file structure: %s", tf->to_string());
-        }
-
-        ScalarFloat wavelengths[5];
-        for (size_t i = 0; i < 5; ++i) {
-            wavelengths[i] = ScalarFloat(((uint16_t *) wvls.data)[i]);
-        }
-
-        m_interpolator = Interpolator(
-            (ScalarFloat *) pbrdf.data,
-            ScalarVector2u(4, 4),
-            {{ (uint32_t) phi_d.shape[1],
-               (uint32_t) theta_d.shape[1],
-               (uint32_t) theta_h.shape[1],
-               (uint32_t) wvls.shape[0] }},
-            {{ (const ScalarFloat *) phi_d.data,
-               (const ScalarFloat *) theta_d.data,
-               (const ScalarFloat *) theta_h.data,
-               (const ScalarFloat *) wavelengths }},
-            false, false
-        );
+        /* Materials that load the same file share its table, e.g. when
+           every object of a material library has its own copy */
+        std::string key = tfm::format("measured_polarized|%s|%s",
+                                      ResourceCache::file_key(file_path), class_()->variant());
+        m_tables = ResourceCache::instance()->get<Tables>(key, [&]() { return load(file_path); });
     }
 
     std::pair<BSDFSample3f, Spectrum> sample(const BSDFContext &ctx,
@@ -171,7 +136,7 @@ public:
                                              Float sample1,
                                              const Point2f &sample2,
                                              Mask active) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::BSDFSample, active);
+        MTS_MASKED_METHOD(ProfilerPhase::BSDFSample, active);
 
         Float cos_theta_i = Frame3f::cos_theta(si.wi);
         active &= cos_theta_i > 0.f;
@@ -206,7 +171,7 @@ public:
 
     Spectrum eval(const BSDFContext &ctx, const SurfaceInteraction3f &si,
                   const Vector3f &wo, Mask active) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::BSDFEvaluate, active);
+        MTS_MASKED_METHOD(ProfilerPhase::BSDFEvaluate, active);
 
         Float cos_theta_i = Frame3f::cos_theta(si.wi),
               cos_theta_o = Frame3f::cos_theta(wo);
@@ -254,7 +219,7 @@ public:
                                 phi_d, theta_d, theta_h,
                                 si.wavelengths[k]
                             };
-                            tmp[k] = m_interpolator.eval(Point2f(Float(j)/3.f, Float(i)/3.f), params, active);
+                            tmp[k] = m_tables->interpolator.eval(Point2f(Float(j)/3.f, Float(i)/3.f), params, active);
                         }
                         value(i, j) = tmp;
                     }
@@ -266,7 +231,7 @@ public:
                             phi_d, theta_d, theta_h,
                             Float(m_wavelength)
                         };
-                        value(i, j) = m_interpolator.eval(Point2f(Float(j)/3.f, Float(i)/3.f), params, active);
+                        value(i, j) = m_tables->interpolator.eval(Point2f(Float(j)/3.f, Float(i)/3.f), params, active);
                     }
                 }
             }
@@ -294,14 +259,14 @@ public:
                         phi_d, theta_d, theta_h,
                         si.wavelengths[k]
                     };
-                    value[k] = m_interpolator.eval(Point2f(0.f, 0.f), params, active);
+                    value[k] = m_tables->interpolator.eval(Point2f(0.f, 0.f), params, active);
                 }
             } else {
                 Float params[4] = {
                     phi_d, theta_d, theta_h,
                     Float(m_wavelength)
                 };
-                Float value_ = m_interpolator.eval(Point2f(0.f, 0.f), params, active);
+                Float value_ = m_tables->interpolator.eval(Point2f(0.f, 0.f), params, active);
                 value = Spectrum(value_);
             }
 
@@ -314,7 +279,7 @@ public:
 
     Float pdf(const BSDFContext &ctx, const SurfaceInteraction3f &si,
               const Vector3f &wo, Mask active) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::BSDFEvaluate, active);
+        MTS_MASKED_METHOD(ProfilerPhase::BSDFEvaluate, active);
 
         if (unlikely(none_or<false>(active) || !ctx.is_enabled(BSDFFlags::GlossyReflection)))
             return 0.f;
@@ -346,6 +311,62 @@ public:
     }
 
 private:
+    /// Load the tabulated pBRDF
+    static ref<Tables> load(const fs::path &file_path) {
+        ref<TensorFile> tf = new TensorFile(file_path);
+
+        auto theta_h = tf->field("theta_h");
+        auto theta_d = tf->field("theta_d");
+        auto phi_d   = tf->field("phi_d");
+        auto wvls    = tf->field("wvls");
+        auto pbrdf   = tf->field("M");
+
+        if (!(theta_h.shape.size() == 2 &&
+              theta_h.dtype == Struct::Type::Float32 &&
+
+              theta_d.shape.size() == 2 &&
+              theta_d.dtype == Struct::Type::Float32 &&
+
+              phi_d.shape.size() == 2 &&
+              phi_d.dtype == Struct::Type::Float32 &&
+
+              wvls.shape.size() == 1 &&
+              wvls.dtype == Struct::Type::UInt16 &&
+
+              pbrdf.dtype == Struct::Type::Float32 &&
+              pbrdf.shape.size() == 6 &&
+              pbrdf.shape[0] == phi_d.shape[1] &&
+              pbrdf.shape[1] == theta_d.shape[1] &&
+              pbrdf.shape[2] == theta_h.shape[1] &&
+              pbrdf.shape[3] == wvls.shape[0]) &&
+              pbrdf.shape[4] == 4 &&
+              pbrdf.shape[5] == 4) {
+            Throw("Invalid file structure: %s", tf->to_string());
+        }
+
+        ScalarFloat wavelengths[5];
+        for (size_t i = 0; i < 5; ++i) {
+            wavelengths[i] = ScalarFloat(((uint16_t *) wvls.data)[i]);
+        }
+
+        ref<Tables> tables = new Tables();
+        tables->interpolator = Interpolator(
+            (ScalarFloat *) pbrdf.data,
+            ScalarVector2u(4, 4),
+            {{ (uint32_t) phi_d.shape[1],
+               (uint32_t) theta_d.shape[1],
+               (uint32_t) theta_h.shape[1],
+               (uint32_t) wvls.shape[0] }},
+            {{ (const ScalarFloat *) phi_d.data,
+               (const ScalarFloat *) theta_d.data,
+               (const ScalarFloat *) theta_h.data,
+               (const ScalarFloat *) wavelengths }},
+            false, false
+        );
+
+        return tables;
+    }
+
     template <typename Vector3,
               typename Value = value_t<Vector3>>
     Value phi(const Vector3 &v) const {
@@ -388,7 +409,7 @@ private:
     std::string m_name;
     ScalarFloat m_wavelength;
     ScalarFloat m_alpha_sample;
-    Interpolator  m_interpolator;
+    ref<const Tables> m_tables;
 };
 
 MTS_IMPLEMENT_CLASS_VARIANT(MeasuredPolarized, BSDF)
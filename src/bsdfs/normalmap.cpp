@@ -90,6 +90,9 @@ public:
             m_components.push_back((m_nested_bsdf->flags(i)));
             m_flags |= m_components.back();
         }
+
+        // The perturbed frame depends on the orientation of the tangents
+        m_flags = m_flags | BSDFFlags::Anisotropic;
     }
 
     std::pair<BSDFSample3f, Spectrum> sample(const BSDFContext &ctx,
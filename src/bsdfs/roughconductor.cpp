@@ -48,6 +48,13 @@ Rough conductor material (:monosp:`roughconductor`)
    - Enables a sampling technique proposed by Heitz and D'Eon :cite:`Heitz1014Importance`, which
      focuses computation on the visible parts of the microfacet normal distribution, considerably
      reducing variance in some cases. (Default: |true|, i.e. use visible normal sampling)
+ * - fresnel_table
+   - |int|
+   - When set to a value :math:`\ge 2`, the Fresnel reflectance is tabulated at this many incident
+     angles (and at every wavelength in steps of 5nm in spectral modes) and evaluated by linear
+     interpolation, which avoids evaluating the index of refraction and the complex-valued Fresnel
+     equations for every sample. Only supported when :monosp:`eta` and :monosp:`k` are constant,
+     and ignored in polarized modes. (Default: 0, i.e. disabled)
 
 This plugin implements a realistic microfacet scattering model for rendering
 rough conducting materials, such as metals.
@@ -191,6 +198,27 @@ public:
 
         m_components.clear();
         m_components.push_back(m_flags);
+
+        int fresnel_table = props.int_("fresnel_table", 0);
+        if (fresnel_table < 0 || fresnel_table == 1)
+            Throw("The 'fresnel_table' parameter must be 0 (disabled) or at least 2!");
+
+        if (fresnel_table > 0) {
+            if (is_polarized_v<Spectrum>)
+                Log(Warn, "The 'fresnel_table' parameter is ignored in polarized variants.");
+            else if (m_eta->is_spatially_varying() || m_k->is_spatially_varying())
+                Log(Warn, "The 'fresnel_table' parameter requires a constant index of "
+                          "refraction, falling back to the analytic Fresnel equations.");
+            else
+                m_fresnel_table_res = (uint32_t) fresnel_table;
+        }
+
+        parameters_changed();
+    }
+
+    void parameters_changed(const std::vector<std::string> &/*keys*/ = {}) override {
+        if (m_fresnel_table_res > 0)
+            build_fresnel_table();
     }
 
     std::pair<BSDFSample3f, Spectrum> sample(const BSDFContext &ctx,
@@ -198,7 +226,7 @@ public:
                                              Float /* sample1 */,
                                              const Point2f &sample2,
                                              Mask active) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::BSDFSample, active);
+        MTS_MASKED_METHOD(ProfilerPhase::BSDFSample, active);
 
         BSDFSample3f bs = zero<BSDFSample3f>();
         Float cos_theta_i = Frame3f::cos_theta(si.wi);
@@ -238,34 +266,7 @@ public:
         bs.pdf /= 4.f * dot(bs.wo, m);
 
         // Evaluate the Fresnel factor
-        Complex<UnpolarizedSpectrum> eta_c(m_eta->eval(si, active),
-                                           m_k->eval(si, active));
-
-        Spectrum F;
-        if constexpr (is_polarized_v<Spectrum>) {
-            /* Due to the coordinate system rotations for polarization-aware
-               pBSDFs below we need to know the propagation direction of light.
-               In the following, light arrives along `-wo_hat` and leaves along
-               `+wi_hat`. */
-            Vector3f wo_hat = ctx.mode == TransportMode::Radiance ? bs.wo : si.wi,
-                     wi_hat = ctx.mode == TransportMode::Radiance ? si.wi : bs.wo;
-
-            // Mueller matrix for specular reflection.
-            F = mueller::specular_reflection(UnpolarizedSpectrum(dot(wo_hat, m)), eta_c);
-
-            /* The Stokes reference frame vector of this matrix lies perpendicular
-               to the plane of reflection. */
-            Vector3f s_axis_in = normalize(cross(m, -wo_hat)),
-                     s_axis_out = normalize(cross(m, wi_hat));
-
-            /* Rotate in/out reference vector of F s.t. it aligns with the implicit
-               Stokes bases of -wo_hat & wi_hat. */
-            F = mueller::rotate_mueller_basis(F,
-                                              -wo_hat, s_axis_in, mueller::stokes_basis(-wo_hat),
-                                               wi_hat, s_axis_out, mueller::stokes_basis(wi_hat));
-        } else {
-            F = fresnel_conductor(UnpolarizedSpectrum(dot(si.wi, m)), eta_c);
-        }
+        Spectrum F = fresnel(ctx, si, bs.wo, m, active);
 
         /* If requested, include the specular reflectance component */
         if (m_specular_reflectance)
@@ -276,7 +277,7 @@ public:
 
     Spectrum eval(const BSDFContext &ctx, const SurfaceInteraction3f &si,
                   const Vector3f &wo, Mask active) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::BSDFEvaluate, active);
+        MTS_MASKED_METHOD(ProfilerPhase::BSDFEvaluate, active);
 
         Float cos_theta_i = Frame3f::cos_theta(si.wi),
               cos_theta_o = Frame3f::cos_theta(wo);
@@ -307,46 +308,16 @@ public:
         // Evaluate the full microfacet model (except Fresnel)
         UnpolarizedSpectrum result = D * G / (4.f * Frame3f::cos_theta(si.wi));
 
-        // Evaluate the Fresnel factor
-        Complex<UnpolarizedSpectrum> eta_c(m_eta->eval(si, active),
-                                           m_k->eval(si, active));
-
-        Spectrum F;
-        if constexpr (is_polarized_v<Spectrum>) {
-            /* Due to the coordinate system rotations for polarization-aware
-               pBSDFs below we need to know the propagation direction of light.
-               In the following, light arrives along `-wo_hat` and leaves along
-               `+wi_hat`. */
-            Vector3f wo_hat = ctx.mode == TransportMode::Radiance ? wo : si.wi,
-                     wi_hat = ctx.mode == TransportMode::Radiance ? si.wi : wo;
-
-            // Mueller matrix for specular reflection.
-            F = mueller::specular_reflection(UnpolarizedSpectrum(dot(wo_hat, H)), eta_c);
-
-            /* The Stokes reference frame vector of this matrix lies perpendicular
-               to the plane of reflection. */
-            Vector3f s_axis_in  = normalize(cross(H, -wo_hat)),
-                     s_axis_out = normalize(cross(H, wi_hat));
-
-            /* Rotate in/out reference vector of F s.t. it aligns with the implicit
-               Stokes bases of -wo_hat & wi_hat. */
-            F = mueller::rotate_mueller_basis(F,
-                                              -wo_hat, s_axis_in, mueller::stokes_basis(-wo_hat),
-                                               wi_hat, s_axis_out, mueller::stokes_basis(wi_hat));
-        } else {
-            F = fresnel_conductor(UnpolarizedSpectrum(dot(si.wi, H)), eta_c);
-        }
-
         /* If requested, include the specular reflectance component */
         if (m_specular_reflectance)
             result *= m_specular_reflectance->eval(si, active);
 
-        return (F * result) & active;
+        return (fresnel(ctx, si, wo, H, active) * result) & active;
     }
 
     Float pdf(const BSDFContext &ctx, const SurfaceInteraction3f &si,
               const Vector3f &wo, Mask active) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::BSDFEvaluate, active);
+        MTS_MASKED_METHOD(ProfilerPhase::BSDFEvaluate, active);
 
         Float cos_theta_i = Frame3f::cos_theta(si.wi),
               cos_theta_o = Frame3f::cos_theta(wo);
@@ -381,6 +352,51 @@ public:
         return select(active, result, 0.f);
     }
 
+    std::pair<Spectrum, Float> eval_pdf(const BSDFContext &ctx,
+                                        const SurfaceInteraction3f &si,
+                                        const Vector3f &wo,
+                                        Mask active) const override {
+        MTS_MASKED_METHOD(ProfilerPhase::BSDFEvaluate, active);
+
+        Float cos_theta_i = Frame3f::cos_theta(si.wi),
+              cos_theta_o = Frame3f::cos_theta(wo);
+
+        // Calculate the half-direction vector
+        Vector3f H = normalize(wo + si.wi);
+
+        // Same side conditions as in pdf(), see the comment there
+        active &= cos_theta_i   > 0.f && cos_theta_o   > 0.f &&
+                  dot(si.wi, H) > 0.f && dot(wo,    H) > 0.f;
+
+        if (unlikely(!ctx.is_enabled(BSDFFlags::GlossyReflection) || none_or<false>(active)))
+            return { 0.f, 0.f };
+
+        /* Construct a single microfacet distribution for both queries, which
+           avoids evaluating the roughness textures twice. */
+        MicrofacetDistribution distr(m_type,
+                                     m_alpha_u->eval_1(si, active),
+                                     m_alpha_v->eval_1(si, active),
+                                     m_sample_visible);
+
+        Float D = distr.eval(H);
+
+        Float pdf;
+        if (likely(m_sample_visible))
+            pdf = D * distr.smith_g1(si.wi, H) / (4.f * cos_theta_i);
+        else
+            pdf = distr.pdf(si.wi, H) / (4.f * dot(wo, H));
+
+        Mask active_e = active && neq(D, 0.f);
+
+        UnpolarizedSpectrum result = D * distr.G(si.wi, wo, H) / (4.f * cos_theta_i);
+
+        if (m_specular_reflectance)
+            result *= m_specular_reflectance->eval(si, active_e);
+
+        return { (fresnel(ctx, si, wo, H, active_e) * result) & active_e,
+                 select(active, pdf, 0.f) };
+    }
+
     void traverse(TraversalCallback *callback) override {
         if (!has_flag(m_flags, BSDFFlags::Anisotropic))
             callback->put_object("alpha", m_alpha_u.get());
@@ -410,6 +426,132 @@ public:
     }
 
     MTS_DECLARE_CLASS()
+private:
+    /// Evaluate the Fresnel term (or its Mueller matrix) for the half-direction vector \c H
+    Spectrum fresnel(const BSDFContext &ctx, const SurfaceInteraction3f &si,
+                     const Vector3f &wo, const Vector3f &H, Mask active) const {
+        if constexpr (!is_polarized_v<Spectrum>) {
+            if (m_fresnel_table_res > 0)
+                return fresnel_lookup(si, dot(si.wi, H), active);
+        }
+
+        Complex<UnpolarizedSpectrum> eta_c(m_eta->eval(si, active),
+                                           m_k->eval(si, active));
+
+        Spectrum F;
+        if constexpr (is_polarized_v<Spectrum>) {
+            /* Due to the coordinate system rotations for polarization-aware
+               pBSDFs below we need to know the propagation direction of light.
+               In the following, light arrives along `-wo_hat` and leaves along
+               `+wi_hat`. */
+            Vector3f wo_hat = ctx.mode == TransportMode::Radiance ? wo : si.wi,
+                     wi_hat = ctx.mode == TransportMode::Radiance ? si.wi : wo;
+
+            // Mueller matrix for specular reflection.
+            F = mueller::specular_reflection(UnpolarizedSpectrum(dot(wo_hat, H)), eta_c);
+
+            /* The Stokes reference frame vector of this matrix lies perpendicular
+               to the plane of reflection. */
+            Vector3f s_axis_in  = normalize(cross(H, -wo_hat)),
+                     s_axis_out = normalize(cross(H, wi_hat));
+
+            /* Rotate in/out reference vector of F s.t. it aligns with the implicit
+               Stokes bases of -wo_hat & wi_hat. */
+            F = mueller::rotate_mueller_basis(F,
+                                              -wo_hat, s_axis_in, mueller::stokes_basis(-wo_hat),
+                                               wi_hat, s_axis_out, mueller::stokes_basis(wi_hat));
+        } else {
+            F = fresnel_conductor(UnpolarizedSpectrum(dot(si.wi, H)), eta_c);
+        }
+
+        return F;
+    }
+
+    /**
+     * \brief Tabulate the unpolarized Fresnel reflectance of the (constant)
+     * complex index of refraction
+     *
+     * The table stores one row with \c m_fresnel_table_res uniformly spaced
+     * incident cosines for every wavelength (spectral variants, with a
+     * spacing of \c fresnel_table_spacing nanometers) or color channel.
+     */
+    void build_fresnel_table() {
+        constexpr size_t channels = array_size_v<UnpolarizedSpectrum>;
+        size_t res  = m_fresnel_table_res,
+               rows = channels;
+        if constexpr (is_spectral_v<Spectrum>)
+            rows = (size_t) std::ceil((MTS_WAVELENGTH_MAX - MTS_WAVELENGTH_MIN) /
+                                      fresnel_table_spacing) + 1;
+
+        // Evaluate a channel of a texture (the first lane in vectorized variants)
+        auto eval_channel = [](const Texture *texture, ScalarFloat wavelength,
+                               size_t channel) -> ScalarFloat {
+            SurfaceInteraction3f si = zero<SurfaceInteraction3f>();
+            if constexpr (is_spectral_v<Spectrum>)
+                si.wavelengths = wavelength;
+            else
+                ENOKI_MARK_USED(wavelength);
+            UnpolarizedSpectrum value = texture->eval(si);
+            if constexpr (is_array_v<Float>)
+                return value[channel].coeff(0);
+            else
+                return value[channel];
+        };
+
+        std::unique_ptr<ScalarFloat[]> table(new ScalarFloat[rows * res]);
+        for (size_t row = 0; row < rows; ++row) {
+            ScalarFloat wavelength = MTS_WAVELENGTH_MIN + row * fresnel_table_spacing;
+            size_t channel = is_spectral_v<Spectrum> ? 0 : row;
+
+            Complex<ScalarFloat> eta(eval_channel(m_eta.get(), wavelength, channel),
+                                     eval_channel(m_k.get(), wavelength, channel));
+
+            for (size_t i = 0; i < res; ++i)
+                table[row * res + i] =
+                    fresnel_conductor(ScalarFloat(i) / ScalarFloat(res - 1), eta);
+        }
+
+        m_fresnel_table_rows = (uint32_t) rows;
+        m_fresnel_table = DynamicBuffer<Float>::copy(table.get(), rows * res);
+    }
+
+    /// Bilinearly interpolate the tabulated Fresnel reflectance
+    UnpolarizedSpectrum fresnel_lookup(const SurfaceInteraction3f &si,
+                                       const Float &cos_theta_i,
+                                       const Mask &active) const {
+        uint32_t res = m_fresnel_table_res;
+
+        Float x = clamp(cos_theta_i, 0.f, 1.f) * ScalarFloat(res - 1);
+        UInt32 x0 = min(UInt32(x), res - 2);
+        Float wx = x - Float(x0);
+
+        // Linear interpolation along the cosine axis of a given row
+        auto lookup_row = [&](const UInt32 &row) {
+            UInt32 index = row * res + x0;
+            Float v0 = gather<Float>(m_fresnel_table, index, active),
+                  v1 = gather<Float>(m_fresnel_table, index + 1u, active);
+            return fmadd(wx, v1 - v0, v0);
+        };
+
+        UnpolarizedSpectrum result;
+        for (size_t i = 0; i < array_size_v<UnpolarizedSpectrum>; ++i) {
+            if constexpr (is_spectral_v<Spectrum>) {
+                Float y = clamp((si.wavelengths[i] - MTS_WAVELENGTH_MIN) /
+                                    fresnel_table_spacing,
+                                0.f, ScalarFloat(m_fresnel_table_rows - 1));
+                UInt32 y0 = min(UInt32(y), m_fresnel_table_rows - 2);
+                Float v0 = lookup_row(y0),
+                      v1 = lookup_row(y0 + 1u);
+                result[i] = fmadd(y - Float(y0), v1 - v0, v0);
+            } else {
+                ENOKI_MARK_USED(si);
+                result[i] = lookup_row(UInt32((uint32_t) i));
+            }
+        }
+
+        return result;
+    }
+
 private:
     /// Specifies the type of microfacet distribution
     MicrofacetType m_type;
@@ -423,6 +565,15 @@ private:
     ref<Texture> m_k;
     /// Specular reflectance component
     ref<Texture> m_specular_reflectance;
+
+    /// Wavelength spacing of the rows of the Fresnel table (spectral variants)
+    static constexpr ScalarFloat fresnel_table_spacing = 5.f;
+    /// Tabulated Fresnel reflectance, see \ref build_fresnel_table()
+    DynamicBuffer<Float> m_fresnel_table;
+    /// Number of incident cosines per row of the Fresnel table (0 = disabled)
+    uint32_t m_fresnel_table_res = 0;
+    /// Number of rows of the Fresnel table
+    uint32_t m_fresnel_table_rows = 0;
 };
 
 MTS_IMPLEMENT_CLASS_VARIANT(RoughConductor, BSDF)
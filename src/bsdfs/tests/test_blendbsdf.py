@@ -194,3 +194,59 @@ def test05_sample_components(variant_scalar_rgb):
     expected_b = weight*1.0    # InvPi will cancel out with sampling pdf, but still need to apply weight
     bs_b, weight_b = bsdf.sample(ctx, si, 0.3, [0.5, 0.5])
     assert ek.allclose(weight_b, expected_b)
+
+
+def test06_nested(variant_scalar_rgb):
+    from mitsuba.core import Frame3f
+    from mitsuba.render import BSDFContext, SurfaceInteraction3f
+    from mitsuba.core.xml import load_string
+    from mitsuba.core.math import InvPi
+
+    # Nested blends are flattened into a single mixture of three BSDFs
+    bsdf = load_string("""<bsdf version="2.0.0" type="blendbsdf">
+        <bsdf type="blendbsdf">
+            <bsdf type="diffuse">
+                <spectrum name="reflectance" value="0.25"/>
+            </bsdf>
+            <bsdf type="diffuse">
+                <spectrum name="reflectance" value="0.5"/>
+            </bsdf>
+            <spectrum name="weight" value="0.4"/>
+        </bsdf>
+        <bsdf type="diffuse">
+            <spectrum name="reflectance" value="1.0"/>
+        </bsdf>
+        <spectrum name="weight" value="0.2"/>
+    </bsdf>""")
+    assert bsdf.component_count() == 3
+
+    si = SurfaceInteraction3f()
+    si.t = 0.1
+    si.p = [0, 0, 0]
+    si.n = [0, 0, 1]
+    si.sh_frame = Frame3f(si.n)
+    si.wi = [0, 0, 1]
+
+    wo = [0, 0, 1]
+    ctx = BSDFContext()
+
+    weights = [0.8 * 0.6, 0.8 * 0.4, 0.2]
+    albedos = [0.25, 0.5, 1.0]
+
+    expected = sum(w * a for w, a in zip(weights, albedos)) * InvPi
+    assert ek.allclose(bsdf.eval(ctx, si, wo), expected)
+    assert ek.allclose(bsdf.pdf(ctx, si, wo), InvPi)
+
+    value, pdf = bsdf.eval_pdf(ctx, si, wo)
+    assert ek.allclose(value, expected)
+    assert ek.allclose(pdf, InvPi)
+
+    for i in range(3):
+        ctx.component = i
+        assert ek.allclose(bsdf.eval(ctx, si, wo), weights[i] * albedos[i] * InvPi)
+
+    # The last BSDF owns the first subinterval of the sample, and so on
+    ctx = BSDFContext()
+    for sample1, albedo in [(0.1, 1.0), (0.3, 0.5), (0.6, 0.25)]:
+        bs, weight = bsdf.sample(ctx, si, sample1, [0.5, 0.5])
+        assert ek.allclose(weight, albedo)
@@ -0,0 +1,61 @@
+import mitsuba
+import pytest
+import enoki as ek
+
+
+def write_quad(tmpdir):
+    # Unit quad in the XY plane whose UV coordinates match its XY coordinates
+    lines = ['ply', 'format ascii 1.0', 'element vertex 4',
+             'property float x', 'property float y', 'property float z',
+             'property float u', 'property float v',
+             'element face 2', 'property list uchar int vertex_indices',
+             'end_header',
+             '0 0 0 0 0', '1 0 0 1 0', '1 1 0 1 1', '0 1 0 0 1',
+             '3 0 1 2', '3 0 2 3']
+    filename = str(tmpdir.join('quad.ply'))
+    with open(filename, 'w') as f:
+        f.write('\n'.join(lines) + '\n')
+    return filename
+
+
+def make_mask(opacity, alpha_test=True):
+    return {
+        "type" : "mask",
+        "opacity" : opacity,
+        "alpha_test" : alpha_test,
+        "bsdf" : {"type" : "diffuse"}
+    }
+
+
+checkerboard = {"type" : "checkerboard", "color0" : 0.0, "color1" : 1.0}
+
+
+def test01_has_alpha_mask(variant_scalar_rgb, tmpdir):
+    from mitsuba.core import xml
+
+    filename = write_quad(tmpdir)
+    for opacity, alpha_test, expected in [(checkerboard, True, True),
+                                          (checkerboard, False, False),
+                                          (0.5, True, False)]:
+        shape = xml.load_dict({"type" : "ply", "filename" : filename,
+                               "bsdf" : make_mask(opacity, alpha_test)})
+        assert shape.has_alpha_mask() == expected
+
+
+def test02_ray_intersect_alpha_test(variant_scalar_rgb, tmpdir):
+    from mitsuba.core import xml, Ray3f
+
+    filename = write_quad(tmpdir)
+    for alpha_test in [True, False]:
+        scene = xml.load_dict({
+            "type" : "scene",
+            "quad" : {"type" : "ply", "filename" : filename,
+                      "bsdf" : make_mask(checkerboard, alpha_test)}
+        })
+
+        for x, y, opaque in [(0.25, 0.25, True), (0.75, 0.75, True),
+                             (0.75, 0.25, False), (0.25, 0.75, False)]:
+            ray = Ray3f(o=[x, y, 1], d=[0, 0, -1], time=0.0, wavelengths=[])
+            hit = opaque or not alpha_test
+            assert scene.ray_intersect(ray).is_valid() == hit
+            assert scene.ray_test(ray) == hit
@@ -95,3 +95,34 @@ def test05_chi2_aniso_ggx_visible(variant_packet_rgb):
     )
 
     assert chi2.run()
+
+
+def test06_fresnel_table(variants_scalar_all):
+    from mitsuba.core import Frame3f
+    from mitsuba.core.xml import load_string
+    from mitsuba.render import BSDFContext, SurfaceInteraction3f
+
+    def make(table):
+        return load_string("""<bsdf version="2.0.0" type="roughconductor">
+                                  <string name="material" value="Au"/>
+                                  <float name="alpha" value="0.3"/>
+                                  <integer name="fresnel_table" value="%i"/>
+                              </bsdf>""" % table)
+
+    bsdf_ref, bsdf_table = make(0), make(256)
+
+    si = SurfaceInteraction3f()
+    si.p = [0, 0, 0]
+    si.n = [0, 0, 1]
+    si.wi = ek.normalize([0.5, 0.1, 0.4])
+    si.sh_frame = Frame3f(si.n)
+    if 'spectral' in variants_scalar_all:
+        si.wavelengths = [452, 517, 603, 688]
+    ctx = BSDFContext()
+
+    # The tabulated Fresnel term must closely match the analytic one
+    for i in range(10):
+        theta = i / 9.0 * (ek.pi / 2) * 0.95
+        wo = [-ek.sin(theta), 0, ek.cos(theta)]
+        assert ek.allclose(bsdf_table.eval(ctx, si, wo=wo),
+                           bsdf_ref.eval(ctx, si, wo=wo), rtol=1e-3, atol=1e-5)
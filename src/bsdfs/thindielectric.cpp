@@ -103,12 +103,12 @@ public:
                                              Float sample1,
                                              const Point2f & /* sample2 */,
                                              Mask active) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::BSDFSample, active);
+        MTS_MASKED_METHOD(ProfilerPhase::BSDFSample, active);
 
         bool has_reflection   = ctx.is_enabled(BSDFFlags::DeltaReflection, 0),
              has_transmission = ctx.is_enabled(BSDFFlags::Null, 1);
 
-        Float r = std::get<0>(fresnel(abs(Frame3f::cos_theta(si.wi)), Float(m_eta)));
+        Float r = std::get<0>(fresnel(abs(Frame3f::cos_theta(si.wi)), m_eta));
 
         // Account for internal reflections: r' = r + trt + tr^3t + ..
         r *= 2.f / (1.f + r);
@@ -162,7 +162,7 @@ public:
     Spectrum eval_null_transmission(const SurfaceInteraction3f & si,
                                 Mask active) const override {
 
-        Float r = std::get<0>(fresnel(abs(Frame3f::cos_theta(si.wi)), Float(m_eta)));
+        Float r = std::get<0>(fresnel(abs(Frame3f::cos_theta(si.wi)), m_eta));
 
         // Account for internal reflections: r' = r + trt + tr^3t + ..
         r *= 2.f / (1.f + r);
@@ -197,7 +197,8 @@ public:
 
     MTS_DECLARE_CLASS()
 private:
-    ScalarFloat m_eta;
+    /// Stored as an array so that updates of 'eta' don't require recompilation (GPU variants)
+    Float m_eta;
     ref<Texture> m_specular_transmittance;
     ref<Texture> m_specular_reflectance;
 };
@@ -96,7 +96,7 @@ public:
                                              Float sample1,
                                              const Point2f &sample2,
                                              Mask active) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::BSDFSample, active);
+        MTS_MASKED_METHOD(ProfilerPhase::BSDFSample, active);
 
         using Result = std::pair<BSDFSample3f, Spectrum>;
 
@@ -126,7 +126,7 @@ public:
 
     Spectrum eval(const BSDFContext &ctx_, const SurfaceInteraction3f &si_,
                   const Vector3f &wo_, Mask active) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::BSDFEvaluate, active);
+        MTS_MASKED_METHOD(ProfilerPhase::BSDFEvaluate, active);
 
         SurfaceInteraction3f si(si_);
         BSDFContext ctx(ctx_);
@@ -154,7 +154,7 @@ public:
 
     Float pdf(const BSDFContext &ctx_, const SurfaceInteraction3f &si_,
               const Vector3f &wo_, Mask active) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::BSDFEvaluate, active);
+        MTS_MASKED_METHOD(ProfilerPhase::BSDFEvaluate, active);
 
         SurfaceInteraction3f si(si_);
         BSDFContext ctx(ctx_);
@@ -3,6 +3,7 @@
 #include <mitsuba/core/spectrum.h>
 #include <mitsuba/render/emitter.h>
 #include <mitsuba/render/medium.h>
+#include <mitsuba/render/mesh.h>
 #include <mitsuba/render/shape.h>
 #include <mitsuba/render/texture.h>
 
@@ -20,6 +21,17 @@ Area light (:monosp:`area`)
    - |spectrum|
    - Specifies the emitted radiance in units of power per unit area per unit steradian.
 
+ * - triangle_sampling
+   - |bool|
+   - When the radiance is textured and the emitter is attached to a mesh,
+     sample triangles proportionally to the radiance they emit instead of
+     importance sampling the texture in UV space. (Default: false)
+
+ * - triangle_samples
+   - |int|
+   - Number of stratified texture lookups per triangle used to estimate
+     its emitted radiance. (Default: 16)
+
 This plugin implements an area light, i.e. a light source that emits
 diffuse illumination from the exterior of an arbitrary shape.
 Since the emission profile of an area light is completely diffuse, it
@@ -27,6 +39,14 @@ has the same apparent brightness regardless of the observer's viewing
 direction. Furthermore, since it occupies a nonzero amount of space, an
 area light generally causes scene objects to cast soft shadows.
 
+Textured emitters are normally sampled by importance sampling the texture in
+UV space and mapping the result onto the shape, which requires a UV
+parameterization lookup for every sample and density evaluation. For large
+meshes with an emissive texture (e.g. screens, signage), enable
+:monosp:`triangle_sampling` instead: the triangles of the mesh are then
+chosen according to the integral of the texture over their UV footprint, and
+positions are sampled uniformly within them.
+
 To create an area light source, simply instantiate the desired
 emitter shape and specify an :monosp:`area` instance as its child:
 
@@ -45,7 +65,7 @@ template <typename Float, typename Spectrum>
 class AreaLight final : public Emitter<Float, Spectrum> {
 public:
     MTS_IMPORT_BASE(Emitter, m_flags, m_shape, m_medium)
-    MTS_IMPORT_TYPES(Scene, Shape, Texture)
+    MTS_IMPORT_TYPES(Scene, Shape, Mesh, Texture)
 
     AreaLight(const Properties &props) : Base(props) {
         if (props.has_property("to_world"))
@@ -58,10 +78,31 @@ public:
         m_flags = +EmitterFlags::Surface;
         if (m_radiance->is_spatially_varying())
             m_flags |= +EmitterFlags::SpatiallyVarying;
+
+        m_triangle_sampling = props.bool_("triangle_sampling", false);
+        m_triangle_samples = props.int_("triangle_samples", 16);
+        if (m_triangle_samples < 1)
+            Throw("The \"triangle_samples\" parameter must be positive!");
+        m_sample_shape = !m_radiance->is_spatially_varying();
+    }
+
+    void set_scene(const Scene * /*scene*/) override {
+        if (!m_triangle_sampling || !m_radiance->is_spatially_varying())
+            return;
+
+        Mesh *mesh = dynamic_cast<Mesh *>(m_shape);
+        if (!mesh) {
+            Log(Warn, "\"triangle_sampling\" requires the area emitter to be "
+                      "attached to a mesh, ignoring it.");
+            return;
+        }
+
+        mesh->build_radiance_pmf(m_radiance.get(), (uint32_t) m_triangle_samples);
+        m_sample_shape = true;
     }
 
     Spectrum eval(const SurfaceInteraction3f &si, Mask active) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::EndpointEvaluate, active);
+        MTS_MASKED_METHOD(ProfilerPhase::EndpointEvaluate, active);
 
         return select(
             Frame3f::cos_theta(si.wi) > 0.f,
@@ -81,10 +122,11 @@ public:
         Float pdf = 1.f;
 
         // 1. Two strategies to sample spatial component based on 'm_radiance'
-        if (!m_radiance->is_spatially_varying()) {
+        if (m_sample_shape) {
             PositionSample3f ps = m_shape->sample_position(time, sample2, active);
 
-            // Radiance not spatially varying, use area-based sampling of shape
+            /* Radiance not spatially varying (or accounted for by the mesh's
+               face distribution), use sampling of shape */
             si = SurfaceInteraction3f(ps, zero<Wavelength>());
             pdf = ps.pdf;
         } else {
@@ -120,14 +162,15 @@ public:
 
     std::pair<DirectionSample3f, Spectrum>
     sample_direction(const Interaction3f &it, const Point2f &sample, Mask active) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::EndpointSampleDirection, active);
+        MTS_MASKED_METHOD(ProfilerPhase::EndpointSampleDirection, active);
         Assert(m_shape, "Can't sample from an area emitter without an associated Shape.");
         DirectionSample3f ds;
         Spectrum spec;
 
         // One of two very different strategies is used depending on 'm_radiance'
-        if (!m_radiance->is_spatially_varying()) {
-            // Texture is uniform, try to importance sample the shape wrt. solid angle at 'it'
+        if (m_sample_shape) {
+            /* Texture is uniform (or accounted for by the mesh's face distribution),
+               try to importance sample the shape wrt. solid angle at 'it' */
             ds = m_shape->sample_direction(it, sample, active);
             active &= dot(ds.d, ds.n) < 0.f && neq(ds.pdf, 0.f);
 
@@ -167,12 +210,12 @@ public:
 
     Float pdf_direction(const Interaction3f &it, const DirectionSample3f &ds,
                         Mask active) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::EndpointEvaluate, active);
+        MTS_MASKED_METHOD(ProfilerPhase::EndpointEvaluate, active);
         Float dp = dot(ds.d, ds.n);
         active &= dp < 0.f;
 
         Float value;
-        if (!m_radiance->is_spatially_varying()) {
+        if (m_sample_shape) {
             value = m_shape->pdf_direction(it, ds, active);
         } else {
             // This surface intersection would be nice to avoid..
@@ -188,6 +231,10 @@ public:
 
     ScalarBoundingBox3f bbox() const override { return m_shape->bbox(); }
 
+    ScalarFloat power() const override {
+        return m_radiance->mean() * math::Pi<ScalarFloat> * m_shape->surface_area();
+    }
+
     void traverse(TraversalCallback *callback) override {
         callback->put_object("radiance", m_radiance.get());
     }
@@ -209,6 +256,11 @@ public:
     MTS_DECLARE_CLASS()
 private:
     ref<Texture> m_radiance;
+
+    /// Sample the shape instead of the texture (see \c triangle_sampling)
+    bool m_sample_shape;
+    bool m_triangle_sampling;
+    int m_triangle_samples;
 };
 
 MTS_IMPLEMENT_CLASS_VARIANT(AreaLight, Emitter)
@@ -51,7 +51,7 @@ public:
     }
 
     Spectrum eval(const SurfaceInteraction3f &si, Mask active) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::EndpointEvaluate, active);
+        MTS_MASKED_METHOD(ProfilerPhase::EndpointEvaluate, active);
 
         return unpolarized<Spectrum>(m_radiance->eval(si, active));
     }
@@ -79,7 +79,7 @@ public:
 
     std::pair<DirectionSample3f, Spectrum>
     sample_direction(const Interaction3f &it, const Point2f &sample, Mask active) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::EndpointSampleDirection, active);
+        MTS_MASKED_METHOD(ProfilerPhase::EndpointSampleDirection, active);
 
         Vector3f d = warp::square_to_uniform_sphere(sample);
         Float dist = 2.f * m_bsphere.radius;
@@ -106,7 +106,7 @@ public:
 
     Float pdf_direction(const Interaction3f &, const DirectionSample3f &ds,
                         Mask active) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::EndpointEvaluate, active);
+        MTS_MASKED_METHOD(ProfilerPhase::EndpointEvaluate, active);
 
         return warp::square_to_uniform_sphere_pdf(ds.d);
     }
@@ -116,6 +116,10 @@ public:
         return ScalarBoundingBox3f();
     }
 
+    ScalarFloat power() const override {
+        return m_radiance->mean() * 4.f * sqr(math::Pi<ScalarFloat> * m_bsphere.radius);
+    }
+
     void traverse(TraversalCallback *callback) override {
         callback->put_object("radiance", m_radiance.get());
     }
@@ -108,7 +108,7 @@ public:
     std::pair<DirectionSample3f, Spectrum>
     sample_direction(const Interaction3f &it, const Point2f & /*sample*/,
                      Mask active) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::EndpointSampleDirection, active);
+        MTS_MASKED_METHOD(ProfilerPhase::EndpointSampleDirection, active);
 
         Vector3f d = m_world_transform->eval(it.time, active)
                          .transform_affine(Vector3f{ 0.f, 0.f, 1.f });
@@ -146,6 +146,10 @@ public:
         return ScalarBoundingBox3f();
     }
 
+    ScalarFloat power() const override {
+        return m_irradiance->mean() * math::Pi<ScalarFloat> * sqr(m_bsphere.radius);
+    }
+
     void traverse(TraversalCallback *callback) override {
         callback->put_object("irradiance", m_irradiance.get());
     }
@@ -2,11 +2,17 @@
 #include <mitsuba/core/bsphere.h>
 #include <mitsuba/core/distr_2d.h>
 #include <mitsuba/core/fresolver.h>
+#include <mitsuba/core/fstream.h>
+#include <mitsuba/core/hash.h>
+#include <mitsuba/core/memreport.h>
 #include <mitsuba/core/plugin.h>
 #include <mitsuba/render/emitter.h>
 #include <mitsuba/render/scene.h>
 #include <mitsuba/render/texture.h>
 #include <mitsuba/render/srgb.h>
+#include <tbb/parallel_for.h>
+#include <random>
+#include <string_view>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -31,6 +37,16 @@ Environment emitter (:monosp:`envmap`)
    - |transform|
    - Specifies an optional emitter-to-world transformation.  (Default: none, i.e. emitter space = world space)
 
+ * - cache_dir
+   - |string|
+   - Directory in which the sample warping hierarchy built from the luminance
+     of the map is cached (see below). (Default: none, i.e. no caching)
+
+ * - (Nested plugin)
+   - |shape|
+   - One or more :ref:`rectangles <shape-rectangle>` that specify light portals
+     (see below). Their normals must point towards the environment.
+
 This plugin provides a HDRI (high dynamic range imaging) environment map,
 which is a type of light source that is well-suited for representing "natural"
 illumination.
@@ -56,6 +72,49 @@ High quality free light probes are available on
 `Paul Debevec's <http://gl.ict.usc.edu/Data/HighResProbes>`_ and
 `Bernhard Vogl's <http://dativ.at/lightprobes/>`_ websites.
 
+Building the hierarchy that importance samples the map takes a noticeable
+amount of time for very large maps. When :paramtype:`cache_dir` is specified,
+it is stored in a ``.mwarp`` file named after a hash of the luminance of the
+map, and reused by all later renders (e.g. of other frames) with the same map.
+
+Integrators that enable :monosp:`product_sampling` (e.g. the :ref:`path tracer
+<sec-path-product>`) additionally pass a lobe of the BSDF at the shading point
+to the emitter, such as the cosine foreshortening or a glossy lobe around the
+mirror direction. The map is then sampled proportionally to the product of its
+luminance and this lobe by descending a second hierarchy over the luminance
+(box-filtered to at most 1024 cells along each axis), whose node weights are
+multiplied at query time by a bound of the lobe over every node. This avoids
+wasting samples on bright regions of the map that lie below the surface or
+far from the reflection lobe.
+
+**Light portals**: in interiors that are lit through windows, only a small
+solid angle of the map is visible from most shading points, thus most samples
+of the map end up occluded. Nested rectangles mark the openings of the scene,
+and the emitter then only samples directions through them, using the
+rectified parameterization of Bitterli et al. ("Portal-Masked Environment Map
+Sampling", 2015): for every portal, the map is resampled over the hemisphere
+on its outer side in coordinates in which the directions through the portal
+from any point form a rectangle, and a summed-area table samples that
+rectangle proportionally to the luminance. The portals themselves are not part
+of the rendered geometry. Points that see no portal (e.g. ones outside the
+building) fall back to the plain sampling strategy, and lobe-aware product
+sampling is not used when portals are present. Directions that don't pass
+through a portal are still reached by BSDF sampling, hence portals never bias
+the result, but all openings should be covered to make the most of them.
+
+.. code-block:: xml
+
+    <emitter type="envmap">
+        <string name="filename" value="sky.exr"/>
+        <shape type="rectangle">
+            <transform name="to_world">
+                <scale x="0.8" y="1.2"/>
+                <rotate y="1" angle="90"/>
+                <translate x="3" y="1.5"/>
+            </transform>
+        </shape>
+    </emitter>
+
  */
 
 template <typename Float, typename Spectrum>
@@ -66,6 +125,12 @@ public:
 
     using Warp = Hierarchical2D<Float, 0>;
 
+    /// Maximum resolution of the leaves of the product sampling tree along each axis
+    static constexpr uint32_t ProductTreeResolution = 1024;
+
+    /// Resolution of the rectified map of every light portal along each axis
+    static constexpr uint32_t PortalResolution = 256;
+
     EnvironmentMapEmitter(const Properties &props) : Base(props) {
         /* Until `set_scene` is called, we have no information
            about the scene and default to the unit bounding sphere. */
@@ -74,53 +139,101 @@ public:
         FileResolver *fs = Thread::thread()->file_resolver();
         fs::path file_path = fs->resolve(props.string("filename"));
 
-        ref<Bitmap> bitmap = new Bitmap(file_path);
+        ref<Bitmap> bitmap;
+        if (props.has_property("bitmap")) {
+            // Decoded ahead of time by the staged scene loader of the GPU variants
+            ref<Object> object = props.object("bitmap");
+            bitmap = dynamic_cast<Bitmap *>(object.get());
+            if (!bitmap)
+                Throw("Property \"bitmap\" must be a Bitmap instance!");
+        } else {
+            bitmap = new Bitmap(file_path);
+        }
 
         /* Convert to linear RGBA float bitmap, will undergo further
            conversion into coefficients of a spectral upsampling model below */
         bitmap = bitmap->convert(Bitmap::PixelFormat::RGBA, struct_type_v<ScalarFloat>, false);
         m_filename = file_path.filename().string();
+        if (props.has_property("cache_dir"))
+            m_cache_dir = fs->resolve(props.string("cache_dir"));
 
         std::unique_ptr<ScalarFloat[]> luminance(new ScalarFloat[bitmap->pixel_count()]);
 
-        ScalarFloat *ptr     = (ScalarFloat *) bitmap->data(),
-                    *lum_ptr = (ScalarFloat *) luminance.get();
-
-        for (size_t y = 0; y < bitmap->size().y(); ++y) {
-            ScalarFloat sin_theta =
-                std::sin(y / ScalarFloat(bitmap->size().y() - 1) * math::Pi<ScalarFloat>);
-
-            for (size_t x = 0; x < bitmap->size().x(); ++x) {
-                ScalarColor3f rgb = load_unaligned<ScalarVector3f>(ptr);
-                ScalarFloat lum   = mitsuba::luminance(rgb);
-
-                ScalarVector4f coeff;
-                if constexpr (is_monochromatic_v<Spectrum>) {
-                    coeff = ScalarVector4f(lum, lum, lum, 1.f);
-                } else if constexpr (is_rgb_v<Spectrum>) {
-                    coeff = concat(rgb, ScalarFloat(1.f));
-                } else {
-                    static_assert(is_spectral_v<Spectrum>);
-                    /* Evaluate the spectral upsampling model. This requires a
-                       reflectance value (colors in [0, 1]) which is accomplished here by
-                       scaling. We use a color where the highest component is 50%,
-                       which generally yields a fairly smooth spectrum. */
-                    ScalarFloat scale = hmax(rgb) * 2.f;
-                    ScalarColor3f rgb_norm = rgb / std::max((ScalarFloat) 1e-8, scale);
-                    coeff = concat((ScalarColor3f) srgb_model_fetch(rgb_norm), scale);
-                }
+        size_t width = bitmap->width(), height = bitmap->height();
+        std::vector<std::pair<double, double>> row_sums(height);
+
+        // Process the rows in parallel, which matters for large (e.g. 16K) maps
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, height, 16),
+            [&](const tbb::blocked_range<size_t> &range) {
+                for (size_t y = range.begin(); y != range.end(); ++y) {
+                    ScalarFloat sin_theta =
+                        std::sin(y / ScalarFloat(height - 1) * math::Pi<ScalarFloat>);
+
+                    ScalarFloat *ptr     = (ScalarFloat *) bitmap->data() + y * width * 4,
+                                *lum_ptr = luminance.get() + y * width;
+                    double lum_sum = 0.0, weight_sum = 0.0;
+
+                    for (size_t x = 0; x < width; ++x) {
+                        ScalarColor3f rgb = load_unaligned<ScalarVector3f>(ptr);
+                        ScalarFloat lum   = mitsuba::luminance(rgb);
+
+                        ScalarVector4f coeff;
+                        if constexpr (is_monochromatic_v<Spectrum>) {
+                            coeff = ScalarVector4f(lum, lum, lum, 1.f);
+                        } else if constexpr (is_rgb_v<Spectrum>) {
+                            coeff = concat(rgb, ScalarFloat(1.f));
+                        } else {
+                            static_assert(is_spectral_v<Spectrum>);
+                            /* Evaluate the spectral upsampling model. This requires a
+                               reflectance value (colors in [0, 1]) which is accomplished
+                               here by scaling. We use a color where the highest component
+                               is 50%, which generally yields a fairly smooth spectrum. */
+                            ScalarFloat scale = hmax(rgb) * 2.f;
+                            ScalarColor3f rgb_norm = rgb / std::max((ScalarFloat) 1e-8, scale);
+                            coeff = concat((ScalarColor3f) srgb_model_fetch(rgb_norm), scale);
+                        }
+
+                        *lum_ptr++ = lum * sin_theta;
+                        store_unaligned(ptr, coeff);
+                        ptr += 4;
+
+                        lum_sum += lum * sin_theta;
+                        weight_sum += sin_theta;
+                    }
 
-                *lum_ptr++ = lum * sin_theta;
-                store_unaligned(ptr, coeff);
-                ptr += 4;
+                    row_sums[y] = { lum_sum, weight_sum };
+                }
             }
+        );
+
+        double lum_sum = 0.0, weight_sum = 0.0;
+        for (const auto &[row_lum, row_weight] : row_sums) {
+            lum_sum += row_lum;
+            weight_sum += row_weight;
         }
 
+        m_mean_luminance = (ScalarFloat) (lum_sum / std::max(weight_sum, 1e-8));
+
         m_resolution = bitmap->size();
         m_data = DynamicBuffer<Float>::copy(bitmap->data(), hprod(m_resolution) * 4);
 
         m_scale = props.float_("scale", 1.f);
-        m_warp = Warp(luminance.get(), m_resolution);
+
+        // Nested rectangles are light portals (see above)
+        for (auto &[name, object] : props.objects()) {
+            if (name == "bitmap")
+                continue;
+            Shape *shape = dynamic_cast<Shape *>(object.get());
+            if (!shape || shape->class_()->name() != "Rectangle")
+                Throw("Only \"rectangle\" shapes (light portals) can be nested in an "
+                      "environment map!");
+            add_portal(shape->to_world());
+        }
+
+        build_warp(luminance.get());
+        build_product_tree(luminance.get());
+        build_portals(luminance.get());
         m_d65 = Texture::D65(1.f);
         m_flags = EmitterFlags::Infinite | EmitterFlags::SpatiallyVarying;
     }
@@ -132,7 +245,7 @@ public:
     }
 
     Spectrum eval(const SurfaceInteraction3f &si, Mask active) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::EndpointEvaluate, active);
+        MTS_MASKED_METHOD(ProfilerPhase::EndpointEvaluate, active);
 
         Vector3f v = m_world_transform->eval(si.time, active)
                          .inverse()
@@ -155,43 +268,44 @@ public:
 
     std::pair<DirectionSample3f, Spectrum>
     sample_direction(const Interaction3f &it, const Point2f &sample, Mask active) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::EndpointSampleDirection, active);
+        MTS_MASKED_METHOD(ProfilerPhase::EndpointSampleDirection, active);
 
-        auto [uv, pdf] = m_warp.sample(sample);
+        if (!m_portals.empty())
+            return sample_portals(it, sample, active);
 
-        Float theta = uv.y() * math::Pi<Float>,
-              phi = uv.x() * (2.f * math::Pi<Float>);
-
-        Vector3f d = math::sphdir(theta, phi);
-        d = Vector3f(d.y(), d.z(), -d.x());
-
-        Float dist = 2.f * m_bsphere.radius;
-
-        Float inv_sin_theta =
-            safe_rsqrt(max(sqr(d.x()) + sqr(d.z()), sqr(math::Epsilon<Float>)));
-
-        d = m_world_transform->eval(it.time, active).transform_affine(d);
+        auto [uv, pdf] = m_warp.sample(sample);
+        return direction_sample(it, uv, pdf, active);
+    }
 
-        DirectionSample3f ds;
-        ds.p      = it.p + d * dist;
-        ds.n      = -d;
-        ds.uv     = uv;
-        ds.time   = it.time;
-        ds.pdf = select(pdf > 0.f, pdf * inv_sin_theta * (1.f / (2.f * sqr(math::Pi<Float>))), 0.f);
-        ds.delta  = false;
-        ds.object = this;
-        ds.d      = d;
-        ds.dist   = dist;
+    std::pair<DirectionSample3f, Spectrum>
+    sample_direction_lobe(const Interaction3f &it, const Point2f &sample,
+                          const Vector3f &lobe_axis, Float lobe_exponent,
+                          Mask active) const override {
+        MTS_MASKED_METHOD(ProfilerPhase::EndpointSampleDirection, active);
+
+        // Light portals take precedence over the lobe
+        Mask product = active && lobe_exponent > 0.f;
+        if (none_or<false>(product) || !m_portals.empty())
+            return sample_direction(it, sample, active);
+
+        Vector3f axis = normalize(m_world_transform->eval(it.time, active)
+                                      .inverse()
+                                      .transform_affine(lobe_axis));
+        auto [uv, pdf] = sample_product(sample, axis, lobe_exponent, product);
+
+        Mask plain = active && !product;
+        if (any_or<true>(plain)) {
+            auto [uv_w, pdf_w] = m_warp.sample(sample, nullptr, plain);
+            masked(uv, plain)  = uv_w;
+            masked(pdf, plain) = pdf_w;
+        }
 
-        return std::make_pair(
-            ds,
-            unpolarized<Spectrum>(eval_spectrum(uv, it.wavelengths, active)) / ds.pdf
-        );
+        return direction_sample(it, uv, pdf, active);
     }
 
     Float pdf_direction(const Interaction3f &it, const DirectionSample3f &ds,
                         Mask active) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::EndpointEvaluate, active);
+        MTS_MASKED_METHOD(ProfilerPhase::EndpointEvaluate, active);
 
         Vector3f d = m_world_transform->eval(it.time, active)
                          .inverse()
@@ -204,7 +318,42 @@ public:
 
         Float inv_sin_theta =
             safe_rsqrt(max(sqr(d.x()) + sqr(d.z()), sqr(math::Epsilon<Float>)));
-        return m_warp.eval(uv) * inv_sin_theta * (1.f / (2.f * sqr(math::Pi<Float>)));
+        Float pdf = m_warp.eval(uv) * inv_sin_theta * (1.f / (2.f * sqr(math::Pi<Float>)));
+
+        if (!m_portals.empty()) {
+            auto [pdf_p, total] = pdf_portals(it.p, ds.d, active);
+            masked(pdf, total > 0.f) = pdf_p;
+        }
+
+        return pdf;
+    }
+
+    Float pdf_direction_lobe(const Interaction3f &it, const DirectionSample3f &ds,
+                             const Vector3f &lobe_axis, Float lobe_exponent,
+                             Mask active) const override {
+        MTS_MASKED_METHOD(ProfilerPhase::EndpointEvaluate, active);
+
+        Mask product = active && lobe_exponent > 0.f;
+        if (none_or<false>(product) || !m_portals.empty())
+            return pdf_direction(it, ds, active);
+
+        Transform4f trafo = m_world_transform->eval(it.time, active).inverse();
+        Vector3f d    = trafo.transform_affine(ds.d),
+                 axis = normalize(trafo.transform_affine(lobe_axis));
+
+        Point2f uv = Point2f(atan2(d.x(), -d.z()) * math::InvTwoPi<Float>,
+                             safe_acos(d.y()) * math::InvPi<Float>);
+        uv -= floor(uv);
+
+        Float pdf = pdf_product(uv, axis, lobe_exponent, product);
+
+        Mask plain = active && !product;
+        if (any_or<true>(plain))
+            masked(pdf, plain) = m_warp.eval(uv, nullptr, plain);
+
+        Float inv_sin_theta =
+            safe_rsqrt(max(sqr(d.x()) + sqr(d.z()), sqr(math::Epsilon<Float>)));
+        return pdf * inv_sin_theta * (1.f / (2.f * sqr(math::Pi<Float>)));
     }
 
     ScalarBoundingBox3f bbox() const override {
@@ -213,45 +362,82 @@ public:
         return ScalarBoundingBox3f();
     }
 
+    ScalarFloat power() const override {
+        return m_scale * m_mean_luminance * 4.f *
+               sqr(math::Pi<ScalarFloat> * m_bsphere.radius);
+    }
+
     void traverse(TraversalCallback *callback) override {
         callback->put_parameter("scale", m_scale);
         callback->put_parameter("data", m_data);
         callback->put_parameter("resolution", m_resolution);
     }
 
+    void account_memory(MemoryReport *report) const override {
+        report->add_array(MemoryCategory::Textures, m_data);
+        report->add(MemoryCategory::Distributions, m_warp.memory_usage(),
+                    is_cuda_array_v<Float>);
+        for (const DynamicBuffer<Float> &level : m_tree)
+            report->add_array(MemoryCategory::Distributions, level);
+        report->visit(m_d65.get());
+        Base::account_memory(report);
+    }
+
     void parameters_changed(const std::vector<std::string> &keys = {}) override {
         if (keys.empty() || string::contains(keys, "data")) {
             m_data.managed();
 
             std::unique_ptr<ScalarFloat[]> luminance(new ScalarFloat[hprod(m_resolution)]);
 
-            ScalarFloat *ptr     = (ScalarFloat *) m_data.data(),
-                        *lum_ptr = (ScalarFloat *) luminance.get();
-
-
-            for (size_t y = 0; y < m_resolution.y(); ++y) {
-                ScalarFloat sin_theta =
-                    std::sin(y / ScalarFloat(m_resolution.y() - 1) * math::Pi<ScalarFloat>);
-
-                for (size_t x = 0; x < m_resolution.x(); ++x) {
-                    ScalarVector4f coeff = load<ScalarVector4f>(ptr);
-                    ScalarFloat lum;
-
-                    if constexpr (is_monochromatic_v<Spectrum>) {
-                        lum = coeff.x();
-                    } else if constexpr (is_rgb_v<Spectrum>) {
-                        lum = mitsuba::luminance(ScalarColor3f(head<3>(coeff)));
-                    } else {
-                        static_assert(is_spectral_v<Spectrum>);
-                        lum = srgb_model_mean(head<3>(coeff)) * coeff.w();
+            size_t width = m_resolution.x(), height = m_resolution.y();
+            std::vector<std::pair<double, double>> row_sums(height);
+
+            tbb::parallel_for(
+                tbb::blocked_range<size_t>(0, height, 16),
+                [&](const tbb::blocked_range<size_t> &range) {
+                    for (size_t y = range.begin(); y != range.end(); ++y) {
+                        ScalarFloat sin_theta =
+                            std::sin(y / ScalarFloat(height - 1) * math::Pi<ScalarFloat>);
+
+                        const ScalarFloat *ptr = (const ScalarFloat *) m_data.data() + y * width * 4;
+                        ScalarFloat *lum_ptr   = luminance.get() + y * width;
+                        double lum_sum = 0.0, weight_sum = 0.0;
+
+                        for (size_t x = 0; x < width; ++x) {
+                            ScalarVector4f coeff = load<ScalarVector4f>(ptr);
+                            ScalarFloat lum;
+
+                            if constexpr (is_monochromatic_v<Spectrum>) {
+                                lum = coeff.x();
+                            } else if constexpr (is_rgb_v<Spectrum>) {
+                                lum = mitsuba::luminance(ScalarColor3f(head<3>(coeff)));
+                            } else {
+                                static_assert(is_spectral_v<Spectrum>);
+                                lum = srgb_model_mean(head<3>(coeff)) * coeff.w();
+                            }
+
+                            *lum_ptr++ = lum * sin_theta;
+                            ptr += 4;
+
+                            lum_sum += lum * sin_theta;
+                            weight_sum += sin_theta;
+                        }
+
+                        row_sums[y] = { lum_sum, weight_sum };
                     }
-
-                    *lum_ptr++ = lum * sin_theta;
-                    ptr += 4;
                 }
+            );
+
+            double lum_sum = 0.0, weight_sum = 0.0;
+            for (const auto &[row_lum, row_weight] : row_sums) {
+                lum_sum += row_lum;
+                weight_sum += row_weight;
             }
 
-            m_warp = Warp(luminance.get(), m_resolution);
+            m_mean_luminance = (ScalarFloat) (lum_sum / std::max(weight_sum, 1e-8));
+            build_warp(luminance.get());
+            build_product_tree(luminance.get());
+            build_portals(luminance.get());
         }
     }
 
@@ -260,6 +446,7 @@ public:
         oss << "EnvironmentMapEmitter[" << std::endl
             << "  filename = \"" << m_filename << "\"," << std::endl
             << "  resolution = \"" << m_resolution << "\"," << std::endl
+            << "  portals = " << m_portals.size() << "," << std::endl
             << "  bsphere = " << string::indent(m_bsphere) << std::endl
             << "]";
         return oss.str();
@@ -319,14 +506,615 @@ protected:
     }
 
     MTS_DECLARE_CLASS()
+protected:
+    /// Complete a direction sample given its texture coordinates and their density
+    std::pair<DirectionSample3f, Spectrum> direction_sample(const Interaction3f &it,
+                                                            const Point2f &uv,
+                                                            const Float &pdf,
+                                                            Mask active) const {
+        Float theta = uv.y() * math::Pi<Float>,
+              phi = uv.x() * (2.f * math::Pi<Float>);
+
+        Vector3f d = math::sphdir(theta, phi);
+        d = Vector3f(d.y(), d.z(), -d.x());
+
+        Float dist = 2.f * m_bsphere.radius;
+
+        Float inv_sin_theta =
+            safe_rsqrt(max(sqr(d.x()) + sqr(d.z()), sqr(math::Epsilon<Float>)));
+
+        d = m_world_transform->eval(it.time, active).transform_affine(d);
+
+        DirectionSample3f ds;
+        ds.p      = it.p + d * dist;
+        ds.n      = -d;
+        ds.uv     = uv;
+        ds.time   = it.time;
+        ds.pdf = select(pdf > 0.f, pdf * inv_sin_theta * (1.f / (2.f * sqr(math::Pi<Float>))), 0.f);
+        ds.delta  = false;
+        ds.object = this;
+        ds.d      = d;
+        ds.dist   = dist;
+
+        return std::make_pair(
+            ds,
+            unpolarized<Spectrum>(eval_spectrum(uv, it.wavelengths, active)) / ds.pdf
+        );
+    }
+
+
+
+    /// Product of the luminance of a node of the product tree and a bound of the lobe over it
+    Float node_weight(size_t level, const UInt32 &x, const UInt32 &y, const Vector3f &axis,
+                      const Float &exponent, Mask active) const {
+        ScalarVector2u res = m_tree_res[level];
+        ScalarVector2f extent = ScalarVector2f(m_tree_res[0] / res) /
+                                ScalarVector2f(m_tree_leaf_res);
+
+        Float value = gather<Float>(m_tree[level], y * res.x() + x, active);
+
+        Point2f center = (Point2f(Float(x), Float(y)) + .5f) * extent;
+        Vector3f d = math::sphdir(center.y() * math::Pi<Float>,
+                                  center.x() * (2.f * math::Pi<Float>));
+        d = Vector3f(d.y(), d.z(), -d.x());
+
+        /* Bound the lobe by its value at the smallest angle between the axis
+           and any direction within the node, so that all directions with a
+           nonzero product retain a nonzero density */
+        ScalarFloat radius = .5f * math::Pi<ScalarFloat> * (extent.y() + 2.f * extent.x());
+        Float cos_angle = cos(max(safe_acos(dot(d, axis)) - radius, 0.f));
+        Float lobe = select(cos_angle > 0.f, pow(max(cos_angle, 0.f), exponent), 0.f);
+
+        return select(active, value * lobe, 0.f);
+    }
+
+    /**
+     * \brief Sample texture coordinates proportionally to the product of the
+     * luminance and a lobe (in local coordinates) by descending the product tree
+     *
+     * The weights of the children of every visited node are multiplied by
+     * the lobe at query time. Returns the density per unit area in texture space.
+     */
+    std::pair<Point2f, Float> sample_product(Point2f sample, const Vector3f &axis,
+                                             const Float &exponent, Mask active) const {
+        sample = min(sample, math::OneMinusEpsilon<Float>);
+        UInt32 x = zero<UInt32>(), y = zero<UInt32>();
+        Float pdf(1.f);
+
+        for (size_t level = m_tree.size() - 1; level-- > 0; ) {
+            bool split_x = m_tree_res[level].x() > m_tree_res[level + 1].x(),
+                 split_y = m_tree_res[level].y() > m_tree_res[level + 1].y();
+            if (split_x)
+                x = x * 2u;
+            if (split_y)
+                y = y * 2u;
+
+            Float w00 = node_weight(level, x, y, axis, exponent, active),
+                  w10 = 0.f, w01 = 0.f, w11 = 0.f;
+            if (split_x)
+                w10 = node_weight(level, x + 1u, y, axis, exponent, active);
+            if (split_y)
+                w01 = node_weight(level, x, y + 1u, axis, exponent, active);
+            if (split_x && split_y)
+                w11 = node_weight(level, x + 1u, y + 1u, axis, exponent, active);
+
+            Float w_left = w00 + w01,
+                  total  = w_left + w10 + w11;
+            active &= total > 0.f;
+
+            // Choose the column using the first dimension and reuse the sample
+            Float p_left = w_left / total;
+            Mask right = sample.x() >= p_left;
+            sample.x() = select(right, (sample.x() - p_left) / (1.f - p_left),
+                                sample.x() / p_left);
+            x = select(right, x + 1u, x);
+
+            // Choose the row within the column using the second dimension
+            Float w_top    = select(right, w10, w00),
+                  w_bottom = select(right, w11, w01),
+                  p_top    = w_top / (w_top + w_bottom);
+            Mask bottom = sample.y() >= p_top;
+            sample.y() = select(bottom, (sample.y() - p_top) / (1.f - p_top),
+                                sample.y() / p_top);
+            y = select(bottom, y + 1u, y);
+
+            pdf *= select(bottom, w_bottom, w_top) / total;
+            sample = min(sample, math::OneMinusEpsilon<Float>);
+        }
+
+        Point2f uv = (Point2f(Float(x), Float(y)) + sample) / ScalarVector2f(m_tree_leaf_res);
+        return { uv, select(active, pdf * (ScalarFloat) hprod(m_tree_leaf_res), 0.f) };
+    }
+
+    /// Density of \ref sample_product() per unit area in texture space
+    Float pdf_product(const Point2f &uv, const Vector3f &axis, const Float &exponent,
+                      Mask active) const {
+        Point2u leaf = min(Point2u(uv * ScalarVector2f(m_tree_leaf_res)), m_tree_leaf_res - 1u);
+        Float pdf(1.f);
+
+        for (size_t level = m_tree.size() - 1; level-- > 0; ) {
+            bool split_x = m_tree_res[level].x() > m_tree_res[level + 1].x(),
+                 split_y = m_tree_res[level].y() > m_tree_res[level + 1].y();
+            ScalarVector2u ratio = m_tree_res[0] / m_tree_res[level];
+
+            // Node containing the texture coordinates and the first of its siblings
+            UInt32 x = leaf.x() / ratio.x(), y = leaf.y() / ratio.y(),
+                   x0 = split_x ? (x & ~1u) : x, y0 = split_y ? (y & ~1u) : y;
+
+            Float w00 = node_weight(level, x0, y0, axis, exponent, active),
+                  w10 = 0.f, w01 = 0.f, w11 = 0.f;
+            if (split_x)
+                w10 = node_weight(level, x0 + 1u, y0, axis, exponent, active);
+            if (split_y)
+                w01 = node_weight(level, x0, y0 + 1u, axis, exponent, active);
+            if (split_x && split_y)
+                w11 = node_weight(level, x0 + 1u, y0 + 1u, axis, exponent, active);
+
+            Float total = w00 + w10 + w01 + w11,
+                  w     = select(eq(x, x0), select(eq(y, y0), w00, w01),
+                                            select(eq(y, y0), w10, w11));
+            active &= total > 0.f;
+            pdf *= w / total;
+        }
+
+        return select(active, pdf * (ScalarFloat) hprod(m_tree_leaf_res), 0.f);
+    }
+
+    /**
+     * \brief Build the hierarchy that is used to sample the product of the
+     * luminance and a lobe (see \ref sample_direction_lobe())
+     *
+     * Its leaves box-filter the luminance to at most \ref ProductTreeResolution
+     * cells along each axis, which are padded with zeros to a power of two.
+     * Every coarser level sums up to 2x2 nodes of the next finer one.
+     */
+    void build_product_tree(const ScalarFloat *luminance) {
+        uint32_t width = m_resolution.x(), height = m_resolution.y();
+        m_tree_leaf_res = min(m_resolution, ProductTreeResolution);
+
+        ScalarVector2u res(math::round_to_power_of_two(m_tree_leaf_res.x()),
+                           math::round_to_power_of_two(m_tree_leaf_res.y()));
+        std::vector<std::vector<ScalarFloat>> levels(1);
+        levels[0].resize(hprod(res), 0.f);
+        m_tree_res = { res };
+
+        tbb::parallel_for(
+            tbb::blocked_range<uint32_t>(0, m_tree_leaf_res.y()),
+            [&](const tbb::blocked_range<uint32_t> &range) {
+                for (uint32_t j = range.begin(); j != range.end(); ++j) {
+                    ScalarFloat *row = levels[0].data() + (size_t) j * res.x();
+                    size_t y0 = (size_t) j * height / m_tree_leaf_res.y(),
+                           y1 = (size_t) (j + 1) * height / m_tree_leaf_res.y();
+                    for (size_t y = y0; y < y1; ++y)
+                        for (size_t x = 0; x < width; ++x)
+                            row[x * m_tree_leaf_res.x() / width] += luminance[y * width + x];
+                }
+            }
+        );
+
+        while (hmax(res) > 1) {
+            ScalarVector2u child_res = res;
+            res = max(res / 2u, 1u);
+            ScalarVector2u split = child_res / res;
+
+            const std::vector<ScalarFloat> &child = levels.back();
+            std::vector<ScalarFloat> level(hprod(res), 0.f);
+            for (uint32_t y = 0; y < res.y(); ++y)
+                for (uint32_t x = 0; x < res.x(); ++x)
+                    for (uint32_t j = 0; j < split.y(); ++j)
+                        for (uint32_t i = 0; i < split.x(); ++i)
+                            level[y * res.x() + x] +=
+                                child[(y * split.y() + j) * child_res.x() + x * split.x() + i];
+
+            levels.push_back(std::move(level));
+            m_tree_res.push_back(res);
+        }
+
+        m_tree.clear();
+        for (const std::vector<ScalarFloat> &level : levels)
+            m_tree.push_back(DynamicBuffer<Float>::copy(level.data(), level.size()));
+    }
+
+    /// Light portal that restricts the sampled directions (see \ref build_portals())
+    struct Portal {
+        ScalarPoint3f center;
+        /// Edges along 's' and 't', the normal points towards the environment
+        ScalarFrame3f frame;
+        /// Half of the side lengths along 's' and 't'
+        ScalarVector2f extent;
+        /// Summed-area table of the rectified map (PortalResolution + 1 entries per row)
+        DynamicBuffer<Float> sat;
+    };
+
+    void add_portal(const ScalarTransform4f &to_world) {
+        Portal portal;
+        portal.center = to_world.transform_affine(ScalarPoint3f(0.f));
+
+        ScalarVector3f s = to_world.transform_affine(ScalarVector3f(1.f, 0.f, 0.f)),
+                       t = to_world.transform_affine(ScalarVector3f(0.f, 1.f, 0.f));
+        portal.extent = ScalarVector2f(norm(s), norm(t));
+        if (!(hmin(portal.extent) > 0.f))
+            Throw("Light portals must have a nonzero area!");
+        s /= portal.extent.x();
+        t /= portal.extent.y();
+        if (std::abs(dot(s, t)) > 1e-3f)
+            Throw("Light portals must be rectangles (got a parallelogram)!");
+
+        portal.frame = ScalarFrame3f(s, t, normalize(to_world * ScalarNormal3f(0.f, 0.f, 1.f)));
+        m_portals.push_back(std::move(portal));
+    }
+
+    /**
+     * \brief Build the rectified maps of the light portals
+     *
+     * Following Bitterli et al. ("Portal-Masked Environment Map Sampling",
+     * 2015), directions in the hemisphere around the normal of a portal are
+     * parameterized by the angles <tt>x = atan(d.s / d.n)</tt> and
+     * <tt>y = atan(d.t / d.n)</tt>. In these coordinates, the directions
+     * through the portal from any point behind it form an axis-aligned
+     * rectangle. Every cell stores the luminance times the Jacobian of the
+     * parameterization, and a summed-area table lets \ref sample_portals()
+     * sample arbitrary rectangles of cells.
+     */
+    void build_portals(const ScalarFloat *luminance) {
+        if (m_portals.empty())
+            return;
+
+        const uint32_t res = PortalResolution, width = m_resolution.x(),
+                       height = m_resolution.y();
+        ScalarTransform4f to_local = m_world_transform->eval(ScalarFloat(0.f)).inverse();
+
+        // Luminance of a direction (the stored one is weighted by the sine of the elevation)
+        auto lookup = [&](const ScalarVector3f &d_world) {
+            ScalarVector3f d = normalize(to_local.transform_affine(d_world));
+            ScalarPoint2f uv(std::atan2(d.x(), -d.z()) * math::InvTwoPi<ScalarFloat>,
+                             safe_acos(d.y()) * math::InvPi<ScalarFloat>);
+            uv -= floor(uv);
+
+            uint32_t x = std::min((uint32_t) (uv.x() * (width - 1) + .5f), width - 1),
+                     y = std::min((uint32_t) (uv.y() * (height - 1) + .5f), height - 1);
+            if (height > 2)
+                y = std::clamp(y, 1u, height - 2u);
+            ScalarFloat sin_theta = std::sin(y / ScalarFloat(height - 1) * math::Pi<ScalarFloat>);
+            return luminance[y * width + x] / std::max(sin_theta, math::Epsilon<ScalarFloat>);
+        };
+
+        for (Portal &portal : m_portals) {
+            std::vector<double> cells((size_t) res * res);
+
+            // Average 2x2 directions within every cell
+            tbb::parallel_for(
+                tbb::blocked_range<uint32_t>(0, res),
+                [&](const tbb::blocked_range<uint32_t> &range) {
+                    for (uint32_t j = range.begin(); j != range.end(); ++j) {
+                        for (uint32_t i = 0; i < res; ++i) {
+                            double value = 0.0;
+                            for (uint32_t k = 0; k < 4; ++k) {
+                                ScalarFloat x = ((i + ((k & 1) + .5f) * .5f) / res - .5f) *
+                                                math::Pi<ScalarFloat>,
+                                            y = ((j + ((k >> 1) + .5f) * .5f) / res - .5f) *
+                                                math::Pi<ScalarFloat>;
+                                ScalarFloat u = std::tan(x), v = std::tan(y);
+                                ScalarVector3f d = normalize(portal.frame.s * u +
+                                                             portal.frame.t * v + portal.frame.n);
+                                value += lookup(d) *
+                                         portal_jacobian(u, v, dot(d, portal.frame.n));
+                            }
+                            cells[(size_t) j * res + i] = value * .25;
+                        }
+                    }
+                }
+            );
+
+            /* Keep a small density in dark regions of the window, whose
+               contributions would otherwise rest on BSDF sampling alone */
+            double mean = 0.0;
+            for (double value : cells)
+                mean += value;
+            mean /= cells.size();
+
+            std::vector<ScalarFloat> sat((size_t) (res + 1) * (res + 1), 0.f);
+            std::vector<double> sum_above(res + 1, 0.0);
+            for (uint32_t j = 0; j < res; ++j) {
+                double row_sum = 0.0;
+                for (uint32_t i = 0; i < res; ++i) {
+                    row_sum += cells[(size_t) j * res + i] + 1e-3 * mean;
+                    sum_above[i + 1] += row_sum;
+                    sat[(size_t) (j + 1) * (res + 1) + i + 1] = (ScalarFloat) sum_above[i + 1];
+                }
+            }
+
+            portal.sat = DynamicBuffer<Float>::copy(sat.data(), sat.size());
+        }
+    }
+
+    /// Solid angle per unit area of the rectified coordinates (see \ref build_portals())
+    template <typename Value>
+    static Value portal_jacobian(const Value &u, const Value &v, const Value &cos_theta) {
+        return (1.f + sqr(u)) * (1.f + sqr(v)) * cos_theta * sqr(cos_theta);
+    }
+
+    /// Evaluate the summed-area table of a portal at a position (in cells)
+    Float portal_sat(const Portal &portal, const Float &x, const Float &y, Mask active) const {
+        const uint32_t res = PortalResolution;
+        Float xc = clamp(x, 0.f, (ScalarFloat) res),
+              yc = clamp(y, 0.f, (ScalarFloat) res);
+        UInt32 i = min(UInt32(xc), res - 1), j = min(UInt32(yc), res - 1),
+               index = j * (res + 1) + i;
+        Float fx = xc - Float(i), fy = yc - Float(j);
+
+        // The table is bilinear within every cell of a piecewise constant function
+        Float v00 = gather<Float>(portal.sat, index, active),
+              v10 = gather<Float>(portal.sat, index + 1, active),
+              v01 = gather<Float>(portal.sat, index + res + 1, active),
+              v11 = gather<Float>(portal.sat, index + res + 2, active);
+        return lerp(lerp(v00, v10, fx), lerp(v01, v11, fx), fy);
+    }
+
+    /**
+     * \brief Rectangle of cells visible through a portal from \c p, as
+     * <tt>(x0, x1, y0, y1)</tt>, and the integral of the rectified map over it
+     */
+    std::pair<Vector4f, Float> portal_window(const Portal &portal, const Point3f &p,
+                                             Mask active) const {
+        Vector3f o = Point3f(portal.center) - p;
+        Float h = dot(o, Vector3f(portal.frame.n)),
+              os = dot(o, Vector3f(portal.frame.s)),
+              ot = dot(o, Vector3f(portal.frame.t));
+        active &= h > 0.f;
+
+        ScalarFloat scale = PortalResolution * math::InvPi<ScalarFloat>;
+        Float inv_h = rcp(h);
+        Vector4f window(atan((os - portal.extent.x()) * inv_h),
+                        atan((os + portal.extent.x()) * inv_h),
+                        atan((ot - portal.extent.y()) * inv_h),
+                        atan((ot + portal.extent.y()) * inv_h));
+        window = (window + .5f * math::Pi<Float>) * scale;
+
+        Float integral = portal_sat(portal, window.y(), window.w(), active) -
+                         portal_sat(portal, window.x(), window.w(), active) -
+                         portal_sat(portal, window.y(), window.z(), active) +
+                         portal_sat(portal, window.x(), window.z(), active);
+        return { window, select(active && integral > 0.f, integral, 0.f) };
+    }
+
+    /// Sample a position (in cells) within a window proportionally to the rectified map
+    Point2f portal_sample(const Portal &portal, const Vector4f &window, const Point2f &sample,
+                          Mask active) const {
+        const uint32_t res = PortalResolution;
+
+        // Marginal in x: integral over the rows of the window up to a column
+        auto marginal = [&](const Float &x) {
+            return portal_sat(portal, x, window.w(), active) -
+                   portal_sat(portal, x, window.z(), active);
+        };
+
+        Float m0 = marginal(window.x()),
+              target_x = fmadd(sample.x(), marginal(window.y()) - m0, m0);
+        UInt32 i = math::find_interval(res + 1, [&](UInt32 k) ENOKI_INLINE_LAMBDA {
+            return marginal(Float(k)) <= target_x;
+        });
+        i = clamp(i, UInt32(window.x()), min(UInt32(window.y()), res - 1));
+
+        Float mi = marginal(Float(i)), mi1 = marginal(Float(i + 1));
+        Float x = Float(i) + select(mi1 > mi, (target_x - mi) / (mi1 - mi), .5f);
+        x = clamp(x, max(Float(i), window.x()), min(Float(i + 1), window.y()));
+
+        // Conditional in y: integral over column 'i' up to a row
+        auto conditional = [&](const Float &y) {
+            return portal_sat(portal, Float(i + 1), y, active) -
+                   portal_sat(portal, Float(i), y, active);
+        };
+
+        Float c0 = conditional(window.z()),
+              target_y = fmadd(sample.y(), conditional(window.w()) - c0, c0);
+        UInt32 j = math::find_interval(res + 1, [&](UInt32 k) ENOKI_INLINE_LAMBDA {
+            return conditional(Float(k)) <= target_y;
+        });
+        j = clamp(j, UInt32(window.z()), min(UInt32(window.w()), res - 1));
+
+        Float cj = conditional(Float(j)), cj1 = conditional(Float(j + 1));
+        Float y = Float(j) + select(cj1 > cj, (target_y - cj) / (cj1 - cj), .5f);
+        y = clamp(y, max(Float(j), window.z()), min(Float(j + 1), window.w()));
+
+        return Point2f(x, y);
+    }
+
+    /**
+     * \brief Solid angle density of \ref sample_portals() and the combined
+     * integral of the rectified maps over the windows visible from \c p
+     *
+     * A direction may pass through several portals, hence the density sums
+     * up their contributions. Lanes with a zero integral (e.g. points in front
+     * of all portals) use the plain sample warping scheme instead.
+     */
+    std::pair<Float, Float> pdf_portals(const Point3f &p, const Vector3f &d, Mask active) const {
+        const uint32_t res = PortalResolution;
+        ScalarFloat scale = res * math::InvPi<ScalarFloat>;
+        Float total(0.f), sum(0.f);
+
+        for (const Portal &portal : m_portals) {
+            auto [window, integral] = portal_window(portal, p, active);
+            total += integral;
+
+            Float cos_theta = dot(d, Vector3f(portal.frame.n)),
+                  u = dot(d, Vector3f(portal.frame.s)) / cos_theta,
+                  v = dot(d, Vector3f(portal.frame.t)) / cos_theta,
+                  x = (atan(u) + .5f * math::Pi<Float>) * scale,
+                  y = (atan(v) + .5f * math::Pi<Float>) * scale;
+
+            Mask inside = active && integral > 0.f && cos_theta > 0.f &&
+                          x >= window.x() && x <= window.y() &&
+                          y >= window.z() && y <= window.w();
+
+            // Value of the cell containing the direction
+            UInt32 i = min(UInt32(max(x, 0.f)), res - 1),
+                   j = min(UInt32(max(y, 0.f)), res - 1),
+                   index = j * (res + 1) + i;
+            Float value = gather<Float>(portal.sat, index + res + 2, inside) -
+                          gather<Float>(portal.sat, index + res + 1, inside) -
+                          gather<Float>(portal.sat, index + 1, inside) +
+                          gather<Float>(portal.sat, index, inside);
+
+            sum += select(inside, value / portal_jacobian(u, v, cos_theta), 0.f);
+        }
+
+        return { select(total > 0.f, sum * sqr(scale) / total, 0.f), total };
+    }
+
+    /// Sample a direction through one of the light portals visible from the reference point
+    std::pair<DirectionSample3f, Spectrum>
+    sample_portals(const Interaction3f &it, Point2f sample, Mask active) const {
+        const uint32_t res = PortalResolution;
+        size_t count = m_portals.size();
+
+        std::vector<Vector4f> windows(count);
+        std::vector<Float> integrals(count);
+        Float total(0.f);
+        for (size_t k = 0; k < count; ++k) {
+            std::tie(windows[k], integrals[k]) = portal_window(m_portals[k], it.p, active);
+            total += integrals[k];
+        }
+
+        // Choose a portal proportionally to the integral over its window
+        Mask through_portal = active && total > 0.f, selected = false;
+        sample.x() = min(sample.x(), math::OneMinusEpsilon<Float>);
+        Float target = sample.x() * total, cdf(0.f);
+        Vector3f d(0.f);
+
+        for (size_t k = 0; k < count; ++k) {
+            const Portal &portal = m_portals[k];
+            Mask chosen = through_portal && !selected && integrals[k] > 0.f &&
+                          target < cdf + integrals[k];
+
+            if (any_or<true>(chosen)) {
+                Point2f xy = portal_sample(
+                    portal, windows[k],
+                    Point2f((target - cdf) / integrals[k], sample.y()), chosen);
+                Point2f angles = xy * (math::Pi<ScalarFloat> / res) - .5f * math::Pi<Float>;
+                Vector3f d_k = normalize(Vector3f(portal.frame.s) * tan(angles.x()) +
+                                         Vector3f(portal.frame.t) * tan(angles.y()) +
+                                         Vector3f(portal.frame.n));
+                masked(d, chosen) = d_k;
+            }
+
+            selected |= chosen;
+            cdf += integrals[k];
+        }
+
+        // Convert to latitude-longitude texture coordinates and their density
+        Vector3f d_local = m_world_transform->eval(it.time, active)
+                               .inverse()
+                               .transform_affine(d);
+        Point2f uv = Point2f(atan2(d_local.x(), -d_local.z()) * math::InvTwoPi<Float>,
+                             safe_acos(d_local.y()) * math::InvPi<Float>);
+        uv -= floor(uv);
+
+        Float sin_theta = safe_sqrt(sqr(d_local.x()) + sqr(d_local.z()));
+        Float pdf = pdf_portals(it.p, d, selected).first * sin_theta *
+                    (2.f * sqr(math::Pi<Float>));
+
+        // Points that don't see any portal use the plain strategy
+        Mask plain = active && !selected;
+        if (any_or<true>(plain)) {
+            auto [uv_w, pdf_w] = m_warp.sample(sample, nullptr, plain);
+            masked(uv, plain)  = uv_w;
+            masked(pdf, plain) = pdf_w;
+        }
+
+        return direction_sample(it, uv, pdf, active);
+    }
+
+    /// Build the sample warping scheme, or load it from the cache directory
+    void build_warp(const ScalarFloat *luminance) {
+        if (m_cache_dir.empty()) {
+            m_warp = Warp(luminance, m_resolution);
+            return;
+        }
+
+        uint64_t key = warp_cache_key(luminance);
+        char filename[32];
+        snprintf(filename, sizeof(filename), "%016llx.mwarp", (unsigned long long) key);
+        fs::path path = m_cache_dir / fs::path(filename);
+
+        if (fs::is_regular_file(path)) {
+            try {
+                ref<FileStream> stream = new FileStream(path);
+                uint64_t stored_key;
+                stream->read(stored_key);
+                if (stored_key == key) {
+                    m_warp = Warp(stream.get(), m_resolution);
+                    Log(Debug, "Loaded the sample warping scheme of \"%s\" from \"%s\"",
+                        m_filename, path.string());
+                    return;
+                }
+            } catch (const std::exception &e) {
+                Log(Warn, "Ignoring invalid sample warping cache \"%s\": %s",
+                    path.string(), e.what());
+            }
+        }
+
+        m_warp = Warp(luminance, m_resolution);
+
+        /* Write to a temporary file first, since other processes (e.g.
+           rendering other frames) may be reading or writing the same file */
+        fs::path tmp_path = path;
+        tmp_path.replace_extension(tfm::format(".%08x.tmp", std::random_device()()));
+        try {
+            if (!fs::exists(m_cache_dir))
+                fs::create_directory(m_cache_dir);
+            {
+                ref<FileStream> stream = new FileStream(tmp_path, FileStream::ETruncReadWrite);
+                stream->write(key);
+                m_warp.write(stream);
+            }
+        } catch (const std::exception &e) {
+            Log(Warn, "Could not write the sample warping cache \"%s\": %s",
+                path.string(), e.what());
+            fs::remove(tmp_path);
+            return;
+        }
+
+        // Fails when another process was faster, which is fine
+        if (!fs::rename(tmp_path, path))
+            fs::remove(tmp_path);
+    }
+
+    /// Key of the cached sample warping scheme, changes whenever the luminance does
+    uint64_t warp_cache_key(const ScalarFloat *luminance) const {
+        size_t width = m_resolution.x(), height = m_resolution.y();
+        std::vector<size_t> row_hashes(height);
+        tbb::parallel_for(size_t(0), height, [&](size_t y) {
+            row_hashes[y] = hash(std::string_view((const char *) (luminance + y * width),
+                                                  width * sizeof(ScalarFloat)));
+        });
+
+        size_t value = hash(std::string("mwarp"));
+        value = hash_combine(value, hash(width));
+        value = hash_combine(value, hash(height));
+        value = hash_combine(value, hash(sizeof(ScalarFloat)));
+        for (size_t row_hash : row_hashes)
+            value = hash_combine(value, row_hash);
+        return (uint64_t) value;
+    }
+
 protected:
     std::string m_filename;
+    fs::path m_cache_dir;
     ScalarBoundingSphere3f m_bsphere;
     DynamicBuffer<Float> m_data;
     ScalarVector2u m_resolution;
     Warp m_warp;
+    /// Levels of the product sampling tree (finest first) and their resolution
+    std::vector<DynamicBuffer<Float>> m_tree;
+    std::vector<ScalarVector2u> m_tree_res;
+    /// Resolution of the leaves of the product sampling tree without padding
+    ScalarVector2u m_tree_leaf_res;
+    std::vector<Portal> m_portals;
     ref<Texture> m_d65;
     ScalarFloat m_scale;
+    /// Average luminance of the map over the sphere of directions
+    ScalarFloat m_mean_luminance;
 };
 
 MTS_IMPLEMENT_CLASS_VARIANT(EnvironmentMapEmitter, Emitter)
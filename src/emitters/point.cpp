@@ -80,7 +80,7 @@ public:
     std::pair<DirectionSample3f, Spectrum> sample_direction(const Interaction3f &it,
                                                             const Point2f & /*sample*/,
                                                             Mask active) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::EndpointSampleDirection, active);
+        MTS_MASKED_METHOD(ProfilerPhase::EndpointSampleDirection, active);
 
         auto trafo = m_world_transform->eval(it.time, active);
 
@@ -112,6 +112,11 @@ public:
         return 0.f;
     }
 
+    std::pair<Float, Float> pdf_ray(const PositionSample3f &, const Vector3f &d,
+                                    Mask) const override {
+        return { 1.f, warp::square_to_uniform_sphere_pdf(d) };
+    }
+
     Spectrum eval(const SurfaceInteraction3f &, Mask) const override {
         return 0.f;
     }
@@ -120,6 +125,10 @@ public:
         return m_world_transform->translation_bounds();
     }
 
+    ScalarFloat power() const override {
+        return m_intensity->mean() * 4.f * math::Pi<ScalarFloat>;
+    }
+
     void traverse(TraversalCallback *callback) override {
         callback->put_object("intensity", m_intensity.get());
     }
@@ -154,7 +154,7 @@ public:
     std::pair<DirectionSample3f, Spectrum>
     sample_direction(const Interaction3f &it, const Point2f & /*sample*/,
                      Mask active) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::EndpointSampleDirection, active);
+        MTS_MASKED_METHOD(ProfilerPhase::EndpointSampleDirection, active);
 
         // 1. Transform the reference point into the local coordinate system
         Transform4f trafo = m_world_transform->eval(it.time, active);
@@ -198,6 +198,15 @@ public:
         return ScalarBoundingBox3f();
     }
 
+    ScalarFloat power() const override {
+        // Area of the projected image on the plane z=1
+        ScalarPoint3f p0 = m_sample_to_camera * ScalarPoint3f(0.f, 0.f, 0.f),
+                      p1 = m_sample_to_camera * ScalarPoint3f(1.f, 1.f, 0.f);
+        ScalarFloat area = hprod(abs(head<2>(p1) / p1.z() - head<2>(p0) / p0.z()));
+
+        return math::Pi<ScalarFloat> * m_intensity->mean() * m_irradiance->mean() * area;
+    }
+
     void traverse(TraversalCallback *callback) override {
         callback->put_object("irradiance", m_irradiance.get());
     }
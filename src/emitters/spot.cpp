@@ -139,7 +139,7 @@ public:
     std::pair<DirectionSample3f, Spectrum> sample_direction(const Interaction3f &it,
                                                             const Point2f &/*sample*/,
                                                             Mask active) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::EndpointSampleDirection, active);
+        MTS_MASKED_METHOD(ProfilerPhase::EndpointSampleDirection, active);
 
         Transform4f trafo = m_world_transform->eval(it.time, active);
 
@@ -165,12 +165,29 @@ public:
         return 0.f;
     }
 
+    std::pair<Float, Float> pdf_ray(const PositionSample3f &ps, const Vector3f &d,
+                                    Mask active) const override {
+        MTS_MASKED_FUNCTION(ProfilerPhase::EndpointEvaluate, active);
+
+        Transform4f trafo = m_world_transform->eval(ps.time, active);
+        Vector3f local_dir = trafo.inverse() * d;
+        Float pdf_dir = warp::square_to_uniform_cone_pdf(local_dir, (Float) m_cos_cutoff_angle);
+
+        return { 1.f, select(local_dir.z() >= m_cos_cutoff_angle, pdf_dir, 0.f) };
+    }
+
     Spectrum eval(const SurfaceInteraction3f &, Mask) const override { return 0.f; }
 
     ScalarBoundingBox3f bbox() const override {
         return m_world_transform->translation_bounds();
     }
 
+    ScalarFloat power() const override {
+        // Ignores the falloff between the beam width and the cutoff angle
+        return m_intensity->mean() * m_texture->mean() * 2.f *
+               math::Pi<ScalarFloat> * (1.f - m_cos_cutoff_angle);
+    }
+
     void traverse(TraversalCallback *callback) override {
         callback->put_object("intensity", m_intensity.get());
         callback->put_object("texture", m_texture.get());
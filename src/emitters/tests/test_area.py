@@ -137,3 +137,60 @@ def test04_sample_direction(variant_packet_spectral, spectrum_key):
     # Evalutate the spectrum (divide by the pdf)
     spec = spectrum.eval(it) / ds.pdf
     assert ek.allclose(res, spec)
+
+
+def test05_triangle_sampling(variant_scalar_rgb, tmpdir):
+    from mitsuba.core import Bitmap
+    from mitsuba.core.xml import load_string
+    from mitsuba.render import Interaction3f
+    import numpy as np
+
+    # Unit square made of two triangles, only the right half emits
+    mesh_file = str(tmpdir.join('square.obj'))
+    with open(mesh_file, 'w') as f:
+        f.write('v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\n'
+                'vt 0 0\nvt 1 0\nvt 1 1\nvt 0 1\n'
+                'f 1/1 2/2 3/3\nf 1/1 3/3 4/4\n')
+    texture_file = str(tmpdir.join('radiance.exr'))
+    Bitmap(np.array([[[0, 0, 0], [1, 1, 1]]], dtype=np.float32)).write(texture_file)
+
+    def load(triangle_sampling):
+        scene = load_string("""<scene version='2.0.0'>
+            <shape type='obj'>
+                <string name='filename' value='{}'/>
+                <emitter type='area'>
+                    <texture type='bitmap' name='radiance'>
+                        <string name='filename' value='{}'/>
+                        <string name='filter_type' value='nearest'/>
+                    </texture>
+                    <boolean name='triangle_sampling' value='{}'/>
+                    <integer name='triangle_samples' value='256'/>
+                </emitter>
+            </shape>
+        </scene>""".format(mesh_file, texture_file, triangle_sampling))
+        return scene.emitters()[0]
+
+    it = Interaction3f.zero()
+    it.p = [0.5, 0.5, 1]
+
+    np.random.seed(0)
+    samples = np.random.rand(4096, 2)
+    estimates = []
+    for triangle_sampling in ['false', 'true']:
+        emitter = load(triangle_sampling)
+        total, lower = 0.0, 0
+        for sample in samples:
+            ds, spec = emitter.sample_direction(it, sample)
+            if ds.pdf == 0:
+                continue
+            assert ek.allclose(emitter.pdf_direction(it, ds), ds.pdf, rtol=1e-4)
+            total += spec[0] * -ds.d[2]
+            lower += ds.p[0] > ds.p[1]
+        estimates.append(total / len(samples))
+
+    # The lower right triangle covers 75% of the emitting half, hence it
+    # receives ~75% of the samples (1% are spent on area-based sampling)
+    assert lower > 0.7 * len(samples)
+
+    # Both strategies estimate the same irradiance
+    assert ek.allclose(estimates[0], estimates[1], rtol=0.05)
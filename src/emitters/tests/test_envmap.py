@@ -0,0 +1,121 @@
+import mitsuba
+import pytest
+import enoki as ek
+
+
+def test01_warp_cache(variant_scalar_rgb, tmpdir):
+    from mitsuba.core import Bitmap
+    from mitsuba.core.xml import load_dict
+    from mitsuba.render import SurfaceInteraction3f
+    import numpy as np
+    import os
+
+    np.random.seed(12345)
+    envmap_file = str(tmpdir.join('envmap.exr'))
+    Bitmap(np.float32(np.random.random((16, 32, 3)))).write(envmap_file)
+    cache_dir = str(tmpdir.join('cache'))
+
+    def load(cache):
+        props = { 'type': 'envmap', 'filename': envmap_file }
+        if cache:
+            props['cache_dir'] = cache_dir
+        return load_dict(props)
+
+    reference = load(False)
+    built = load(True)
+    assert len(os.listdir(cache_dir)) == 1
+    loaded = load(True)
+    assert len(os.listdir(cache_dir)) == 1
+
+    # The cached sample warping scheme produces the same samples and densities
+    it = SurfaceInteraction3f.zero()
+    for sample in [[0.1, 0.5], [0.7, 0.2], [0.95, 0.99]]:
+        ds_ref, _ = reference.sample_direction(it, sample)
+        for emitter in [built, loaded]:
+            ds, _ = emitter.sample_direction(it, sample)
+            assert ek.allclose(ds.d, ds_ref.d)
+            assert ek.allclose(ds.pdf, ds_ref.pdf)
+
+
+def test02_product_sampling(variant_scalar_rgb, tmpdir):
+    from mitsuba.core import Bitmap, warp
+    from mitsuba.core.xml import load_dict
+    from mitsuba.render import SurfaceInteraction3f, DirectionSample3f
+    import numpy as np
+
+    # Resolution that isn't a power of two, so that the tree is padded
+    np.random.seed(12345)
+    envmap_file = str(tmpdir.join('envmap.exr'))
+    Bitmap(np.float32(np.random.random((12, 30, 3)))).write(envmap_file)
+    emitter = load_dict({ 'type': 'envmap', 'filename': envmap_file })
+
+    it = SurfaceInteraction3f.zero()
+    axis, exponent = [0.6, 0, 0.8], 8.0
+
+    # Sampled densities are consistent with the evaluated ones
+    for i in range(100):
+        sample = np.random.random(2)
+        ds, weight = emitter.sample_direction_lobe(it, sample, axis, exponent)
+        assert ds.pdf > 0
+        assert ek.allclose(ds.pdf, emitter.pdf_direction_lobe(it, ds, axis, exponent),
+                           rtol=1e-4)
+
+        # Without a lobe, this is the plain sampling strategy
+        ds_ref, _ = emitter.sample_direction(it, sample)
+        ds_0, _ = emitter.sample_direction_lobe(it, sample, axis, 0.0)
+        assert ek.allclose(ds_0.d, ds_ref.d) and ek.allclose(ds_0.pdf, ds_ref.pdf)
+
+    # The density integrates to one over the sphere of directions
+    n, integral = 10000, 0.0
+    for i in range(n):
+        ds = DirectionSample3f()
+        ds.d = warp.square_to_uniform_sphere(np.random.random(2))
+        integral += emitter.pdf_direction_lobe(it, ds, axis, exponent)
+    assert ek.allclose(integral * 4 * ek.pi / n, 1, rtol=0.05)
+
+
+def test03_portals(variant_scalar_rgb, tmpdir):
+    from mitsuba.core import Bitmap, ScalarTransform4f
+    from mitsuba.core.xml import load_dict
+    from mitsuba.render import SurfaceInteraction3f
+    import numpy as np
+
+    np.random.seed(12345)
+    envmap_file = str(tmpdir.join('envmap.exr'))
+    Bitmap(np.float32(np.random.random((16, 32, 3)))).write(envmap_file)
+    constant_file = str(tmpdir.join('constant.exr'))
+    Bitmap(np.ones((16, 32, 3), dtype=np.float32)).write(constant_file)
+
+    def load(filename, portal=True):
+        props = { 'type': 'envmap', 'filename': filename }
+        if portal:
+            # Unit square at z=2 facing towards +z
+            props['portal'] = { 'type': 'rectangle',
+                                'to_world': ScalarTransform4f.translate([0, 0, 2]) }
+        return load_dict(props)
+
+    emitter, plain = load(envmap_file), load(envmap_file, False)
+    it = SurfaceInteraction3f.zero()
+
+    # All samples pass through the portal and have consistent densities
+    for i in range(100):
+        ds, _ = emitter.sample_direction(it, np.random.random(2))
+        assert ds.d[2] > 0
+        p = ds.d * (2 / ds.d[2])
+        assert abs(p[0]) <= 1 + 1e-4 and abs(p[1]) <= 1 + 1e-4
+        assert ek.allclose(ds.pdf, emitter.pdf_direction(it, ds), rtol=1e-3)
+
+    # Points in front of the portal use the plain strategy
+    it.p = [0, 0, 3]
+    for sample in [[0.1, 0.5], [0.7, 0.2]]:
+        ds, _ = emitter.sample_direction(it, sample)
+        ds_ref, _ = plain.sample_direction(it, sample)
+        assert ek.allclose(ds.d, ds_ref.d) and ek.allclose(ds.pdf, ds_ref.pdf)
+
+    # The density of a constant map is uniform over the solid angle of the portal
+    emitter = load(constant_file)
+    it.p = [0, 0, 0]
+    solid_angle = 4 * np.arcsin(1 / 5)
+    for i in range(20):
+        ds, _ = emitter.sample_direction(it, np.random.random(2))
+        assert ek.allclose(ds.pdf * solid_angle, 1, rtol=0.05)
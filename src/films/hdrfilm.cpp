@@ -1,6 +1,9 @@
 #include <mitsuba/core/bitmap.h>
 #include <mitsuba/core/filesystem.h>
 #include <mitsuba/core/fstream.h>
+#include <mitsuba/core/hash.h>
+#include <mitsuba/core/memreport.h>
+#include <mitsuba/core/profiler.h>
 #include <mitsuba/core/spectrum.h>
 #include <mitsuba/core/string.h>
 #include <mitsuba/render/film.h>
@@ -8,6 +11,33 @@
 #include <mitsuba/render/imageblock.h>
 
 #include <mutex>
+#include <numeric>
+#include <enoki/half.h>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+/* OpenEXR is only used directly for deep output, which isn't supported by
+   the Bitmap class */
+#if defined(__clang__)
+#  pragma clang diagnostic push
+#  pragma clang diagnostic ignored "-Wdeprecated-register"
+#  pragma clang diagnostic ignored "-Wunused-parameter"
+#elif defined(__GNUG__)
+#  pragma GCC diagnostic push
+#  pragma GCC diagnostic ignored "-Wdeprecated"
+#endif
+
+#include <ImfChannelList.h>
+#include <ImfDeepFrameBuffer.h>
+#include <ImfDeepScanLineOutputFile.h>
+#include <ImfHeader.h>
+#include <ImfPartType.h>
+
+#if defined(__clang__)
+#  pragma clang diagnostic pop
+#elif defined(__GNUG__)
+#  pragma GCC diagnostic pop
+#endif
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -37,6 +67,17 @@ High dynamic range film (:monosp:`hdrfilm`)
    - |string|
    - Specifies the desired floating  point component format of output images. The options are
      :monosp:`float16`, :monosp:`float32`, or :monosp:`uint32`. (Default: :monosp:`float16`)
+ * - compression
+   - |string|
+   - Compression method of OpenEXR output. The options are :monosp:`none`, :monosp:`rle`,
+     :monosp:`zips`, :monosp:`zip`, :monosp:`piz` (lossless), as well as :monosp:`dwaa` and
+     :monosp:`dwab` (lossy). Blocks of scanlines are compressed in parallel, hence the cheaper
+     methods (e.g. :monosp:`zip` or :monosp:`none`) can noticeably reduce the time spent
+     writing images with many channels. (Default: :monosp:`piz`)
+ * - compression_level
+   - |int|
+   - Compression level of the lossy :monosp:`dwaa` and :monosp:`dwab` methods, with higher values
+     corresponding to a lower quality. (Default: 45)
  * - crop_offset_y, crop_offset_y, crop_width, crop_height
    - |int|
    - These parameters can optionally be provided to select a sub-rectangle
@@ -47,6 +88,64 @@ High dynamic range film (:monosp:`hdrfilm`)
    - If set to |true|, regions slightly outside of the film plane will also be sampled. This may
      improve the image quality at the edges, especially when using very large reconstruction
      filters. In general, this is not needed though. (Default: |false|, i.e. disabled)
+ * - lock_tile_size
+   - |int|
+   - Granularity (in pixels) of the locks protecting the film storage. Image blocks are merged
+     while holding only the locks of the tiles they overlap, so that non-overlapping blocks
+     can be accumulated concurrently and only the reconstruction filter's border region needs
+     to be synchronized. A value of zero falls back to a single lock for the whole film.
+     (Default: 32)
+ * - deferred_filter
+   - |bool|
+   - If set to |true|, samples are accumulated per pixel (i.e. using a box filter), and the
+     reconstruction filter is only applied once when the film is developed, as a separable
+     convolution of the per-pixel sums. This makes splatting considerably cheaper and removes
+     the overlap between image blocks, at the cost of ignoring the sub-pixel positions of the
+     samples in the reconstruction. (Default: |false|)
+ * - unfiltered_aovs
+   - |string|
+   - Comma-separated names of AOVs (see the :ref:`aov <integrator-aov>` integrator) that bypass
+     the reconstruction filter. Their samples are accumulated into the pixel containing them and
+     averaged separately, which is cheaper than splatting them over the footprint of the filter
+     and avoids blending values that shouldn't be interpolated across edges, e.g. depth.
+     (Default: none)
+ * - half_aovs
+   - |string|
+   - Comma-separated names of AOVs that are accumulated in half precision, which reduces the
+     memory footprint of films with many (e.g. depth, normal or albedo) AOVs at a high
+     resolution. Their values are kept normalized by the sample weight, which is merged along
+     with them when image blocks are added to the film. The image itself, the weights and the
+     remaining AOVs stay in full precision. Not supported in GPU variants, with deep output or
+     with ID layers. (Default: none)
+ * - split_aovs
+   - |bool|
+   - If set to |true|, the developed image and each of its AOVs are written to separate OpenEXR
+     files, named :monosp:`<filename>_<aov>.exr` in the case of the AOVs. (Default: |false|)
+ * - deep
+   - |bool|
+   - If set to |true|, the film additionally writes a deep OpenEXR image named
+     :monosp:`<filename>_deep.exr` (see below). (Default: |false|)
+ * - deep_samples
+   - |int|
+   - Maximum number of deep samples per pixel. (Default: 8)
+ * - deep_depth
+   - |string|
+   - Name of the depth AOV that provides the depth of the deep samples. (Default:
+     :monosp:`depth`)
+ * - deep_merge
+   - |float|
+   - Relative depth difference below which samples are merged into the same deep sample.
+     (Default: 0.01)
+ * - denoise
+   - |bool|
+   - If set to |true|, the developed image is denoised by an edge-avoiding wavelet filter that
+     is guided by the albedo and normal AOVs of the film, if present (see below).
+     (Default: |false|)
+ * - denoise_albedo, denoise_normals
+   - |string|
+   - Names of the AOVs holding the albedo (:monosp:`<name>.R`, :monosp:`<name>.G`,
+     :monosp:`<name>.B`) and the normals (:monosp:`<name>.X`, :monosp:`<name>.Y`,
+     :monosp:`<name>.Z`) that guide the denoiser. (Default: :monosp:`albedo` and :monosp:`nn`)
  * - (Nested plugin)
    - :paramtype:`rfilter`
    - Reconstruction filter that should be used by the film. (Default: :monosp:`gaussian`, a windowed
@@ -79,6 +178,45 @@ When RGB(A) output is selected, the measured spectral power distributions are
 converted to linear RGB based on the CIE 1931 XYZ color matching curves and
 the ITU-R Rec. BT.709-3 primaries with a D65 white point.
 
+For volumetric and holdout compositing, the film can also produce a deep image, which stores a
+depth-sorted list of RGBA samples per pixel instead of their flat accumulation. This requires a
+depth AOV produced by the :ref:`aov <integrator-aov>` integrator:
+
+.. code-block:: xml
+
+    <integrator type="aov">
+        <string name="aovs" value="depth:depth"/>
+        <integrator type="path" name="image"/>
+    </integrator>
+
+Every pixel keeps up to :monosp:`deep_samples` samples. Samples whose depths are within a
+fraction :monosp:`deep_merge` of each other are merged (their colors are summed, and depths
+averaged by count); when the list is full, the two closest samples are merged. Samples are
+accumulated into the pixel containing them (i.e. they aren't filtered), and those that don't hit
+any surface are only counted, which leaves the background to the compositor. The alphas are
+chosen such that flattening the deep image by compositing its samples front to back reproduces
+the color of the pixel. Deep output is only available in scalar variants, it isn't stored in
+checkpoints and it isn't supported by distributed rendering.
+
+For quick previews at low sample counts, the film can denoise the image while it is developed.
+The denoiser works on the normalized contents of the film's storage (i.e. without writing and
+reading back an intermediate image), and is guided by the feature AOVs produced by the
+:ref:`aov <integrator-aov>` integrator:
+
+.. code-block:: xml
+
+    <integrator type="aov">
+        <string name="aovs" value="albedo:albedo,nn:sh_normal"/>
+        <integrator type="path" name="image"/>
+    </integrator>
+
+It implements the edge-avoiding A-Trous wavelet transform of Dammertz et al.: five passes of a
+5x5 B-spline kernel with increasing spacing, whose weights are reduced across differences of
+the color, normal and albedo values of neighboring pixels. The color is divided by the albedo
+before filtering and multiplied by it afterwards, which preserves texture detail. Only the
+tristimulus values of the developed image are denoised; the alpha channel, the AOVs and the
+raw storage returned by ``bitmap(raw=True)`` are left untouched.
+
 The following XML snippet discribes a film that writes a full-HD RGBA OpenEXR file:
 
 .. code-block:: xml
@@ -94,7 +232,8 @@ The following XML snippet discribes a film that writes a full-HD RGBA OpenEXR fi
 template <typename Float, typename Spectrum>
 class HDRFilm final : public Film<Float, Spectrum> {
 public:
-    MTS_IMPORT_BASE(Film, m_size, m_crop_size, m_crop_offset, m_high_quality_edges, m_filter)
+    MTS_IMPORT_BASE(Film, m_size, m_crop_size, m_crop_offset, m_high_quality_edges,
+                    m_deferred_filter, m_filter)
     MTS_IMPORT_TYPES(ImageBlock)
 
     HDRFilm(const Properties &props) : Base(props) {
@@ -104,9 +243,17 @@ public:
             props.string("pixel_format", "rgba"));
         std::string component_format = string::to_lower(
             props.string("component_format", "float16"));
+        std::string compression = string::to_lower(
+            props.string("compression", "piz"));
 
         m_dest_file = props.string("filename", "");
 
+        int lock_tile_size = props.int_("lock_tile_size", 32);
+        if (lock_tile_size < 0)
+            Throw("The \"lock_tile_size\" parameter must be non-negative, found %i.",
+                  lock_tile_size);
+        m_lock_tile_size = lock_tile_size;
+
         if (file_format == "openexr" || file_format == "exr")
             m_file_format = Bitmap::FileFormat::OpenEXR;
         else if (file_format == "rgbe")
@@ -155,6 +302,31 @@ public:
                   " Found %s instead.", component_format);
         }
 
+        if (compression == "none")
+            m_compression = Bitmap::EXRCompression::None;
+        else if (compression == "rle")
+            m_compression = Bitmap::EXRCompression::RLE;
+        else if (compression == "zips")
+            m_compression = Bitmap::EXRCompression::ZIPS;
+        else if (compression == "zip")
+            m_compression = Bitmap::EXRCompression::ZIP;
+        else if (compression == "piz")
+            m_compression = Bitmap::EXRCompression::PIZ;
+        else if (compression == "dwaa")
+            m_compression = Bitmap::EXRCompression::DWAA;
+        else if (compression == "dwab")
+            m_compression = Bitmap::EXRCompression::DWAB;
+        else {
+            Throw("The \"compression\" parameter must either be equal to "
+                  "\"none\", \"rle\", \"zips\", \"zip\", \"piz\", \"dwaa\" or "
+                  "\"dwab\". Found %s instead.", compression);
+        }
+
+        m_compression_level = props.int_("compression_level", 45);
+        if (m_compression_level <= 0)
+            Throw("The \"compression_level\" parameter must be positive, found %i.",
+                  m_compression_level);
+
         if (m_file_format == Bitmap::FileFormat::RGBE) {
             if (m_pixel_format != Bitmap::PixelFormat::RGB) {
                 Log(Warn, "The RGBE format only supports pixel_format=\"rgb\"."
@@ -180,6 +352,37 @@ public:
             }
         }
 
+        m_half_aovs = string::tokenize(props.string("half_aovs", ""), ", ");
+        if (!m_half_aovs.empty() && is_cuda_array_v<Float>)
+            Throw("The \"half_aovs\" parameter is not supported in GPU variants!");
+        m_half_count = 0;
+
+        m_split_aovs = props.bool_("split_aovs", false);
+        if (m_split_aovs && m_file_format != Bitmap::FileFormat::OpenEXR) {
+            Log(Warn, "AOVs can only be split into separate OpenEXR files. Ignoring "
+                      "the \"split_aovs\" parameter..");
+            m_split_aovs = false;
+        }
+
+        m_denoise = props.bool_("denoise", false);
+        m_denoise_albedo = props.string("denoise_albedo", "albedo");
+        m_denoise_normals = props.string("denoise_normals", "nn");
+        m_albedo_channel = m_normal_channel = -1;
+
+        m_deep = props.bool_("deep", false);
+        m_deep_samples = (uint32_t) props.size_("deep_samples", 8);
+        m_deep_depth = props.string("deep_depth", "depth");
+        m_deep_merge = props.float_("deep_merge", 0.01f);
+        m_depth_channel = 0;
+        if (m_deep) {
+            if constexpr (is_array_v<Float>)
+                Throw("Deep output is only supported in scalar variants!");
+            if (m_file_format != Bitmap::FileFormat::OpenEXR)
+                Throw("Deep output requires file_format=\"openexr\"!");
+            if (m_deep_samples == 0)
+                Throw("The \"deep_samples\" parameter must be positive!");
+        }
+
         props.mark_queried("banner"); // no banner in Mitsuba 2
     }
 
@@ -187,6 +390,67 @@ public:
         m_dest_file = dest_file;
     }
 
+    fs::path destination_file() const override { return m_dest_file; }
+
+    ref<Bitmap> snapshot() override {
+        Assert(m_storage != nullptr);
+        if constexpr (is_cuda_array_v<Float>) {
+            cuda_eval();
+            cuda_sync();
+        }
+
+        /* Use generic channel names whose alphabetical order matches the
+           storage, since OpenEXR files store their channels sorted by name */
+        size_t channel_count = m_channels.size();
+        ref<Bitmap> result = new Bitmap(Bitmap::PixelFormat::MultiChannel, Struct::Type::Float32,
+                                        m_storage->size(), channel_count);
+        for (size_t i = 0; i < channel_count; ++i)
+            result->struct_()->operator[](i).name = tfm::format("channel_%03i", i);
+
+        std::vector<ScalarFloat> expanded;
+        const ScalarFloat *source = storage_rows(expanded, 0, (uint32_t) m_storage->height());
+        float *target = (float *) result->data();
+        for (size_t i = 0, n = channel_count * hprod(m_storage->size()); i < n; ++i)
+            target[i] = (float) source[i];
+
+        return result;
+    }
+
+    void restore(const Bitmap *snapshot) override {
+        Assert(m_storage != nullptr);
+        if (any(snapshot->size() != ScalarVector2u(m_storage->size())) ||
+            snapshot->channel_count() != m_channels.size() ||
+            snapshot->component_format() != Struct::Type::Float32)
+            Throw("HDRFilm::restore(): the snapshot (%s, %i channels) does not match the "
+                  "film (%s, %i channels)!", snapshot->size(), snapshot->channel_count(),
+                  m_storage->size(), m_channels.size());
+
+        ScalarFloat *target = (ScalarFloat *) m_storage->data().managed().data();
+        const float *source = (const float *) snapshot->data();
+        if (m_half_count == 0) {
+            for (size_t i = 0, n = m_channels.size() * hprod(m_storage->size()); i < n; ++i)
+                target[i] = (ScalarFloat) source[i];
+            return;
+        }
+
+        // Split the channels into the storage and (normalized) half precision AOVs
+        size_t channel_count = m_channels.size();
+        uint16_t *half = m_half_storage.data();
+        for (size_t i = 0, n = hprod(m_storage->size()); i < n; ++i) {
+            const float *pixel = source + i * channel_count;
+            float weight = pixel[4],
+                  weight_unfiltered = m_unfiltered.empty() ? 0.f : pixel[channel_count - 1];
+            for (size_t k = 0; k < channel_count; ++k) {
+                if (!m_half[k]) {
+                    *target++ = (ScalarFloat) pixel[k];
+                    continue;
+                }
+                float w = !m_unfiltered.empty() && m_unfiltered[k] ? weight_unfiltered : weight;
+                *half++ = enoki::half::float32_to_float16(w != 0.f ? pixel[k] / w : 0.f);
+            }
+        }
+    }
+
     void prepare(const std::vector<std::string> &channels) override {
         std::vector<std::string> channels_sorted = channels;
         channels_sorted.push_back("R");
@@ -198,16 +462,210 @@ public:
                 Throw("Film::prepare(): duplicate channel name \"%s\"", channels_sorted[i]);
         }
 
-        m_storage = new ImageBlock(m_crop_size, channels.size());
+        m_channels = channels;
+
+        // Channels that are normalized by the sample count in "W.unfiltered"
+        m_unfiltered.clear();
+        m_id_channels.clear();
+        if (channels.back() == "W.unfiltered") {
+            m_unfiltered = Base::unfiltered_channels(channels);
+            m_id_channels = Base::id_channels(channels);
+        }
+
+        // Channels of the AOVs that are accumulated in half precision
+        m_half.assign(channels.size(), false);
+        m_half_count = 0;
+        for (size_t i = 5; i < channels.size(); ++i) {
+            const std::string &name = channels[i];
+            if (name == "W.unfiltered")
+                continue;
+            std::string aov = name.substr(0, name.find('.'));
+            if (std::find(m_half_aovs.begin(), m_half_aovs.end(), aov) != m_half_aovs.end()) {
+                m_half[i] = true;
+                m_half_count++;
+            }
+        }
+
+        if (m_half_count > 0 && (m_deep || !m_id_channels.empty()))
+            Throw("Half precision AOVs cannot be combined with deep output or ID layers!");
+
+        m_storage = new ImageBlock(m_crop_size, channels.size() - m_half_count);
         m_storage->set_offset(m_crop_offset);
         m_storage->clear();
-        m_channels = channels;
+        m_half_storage.assign(hprod(m_crop_size) * m_half_count, 0);
+
+        // Merging blocks into the storage must combine the (ID, weight) pairs
+        if (!m_id_channels.empty())
+            m_storage->set_unfiltered_channels(m_unfiltered, m_id_channels);
+
+        // Locate the feature AOVs of the denoiser
+        auto find_channels = [&](const std::string &name, const char *suffixes) {
+            for (size_t i = 0; i + 2 < channels.size(); ++i) {
+                if (channels[i] == name + "." + suffixes[0] &&
+                    channels[i + 1] == name + "." + suffixes[1] &&
+                    channels[i + 2] == name + "." + suffixes[2])
+                    return (int) i;
+            }
+            return -1;
+        };
+        m_albedo_channel = find_channels(m_denoise_albedo, "RGB");
+        m_normal_channel = find_channels(m_denoise_normals, "XYZ");
+        if (m_denoise && m_albedo_channel < 0 && m_normal_channel < 0)
+            Log(Warn, "The film has no \"%s\" or \"%s\" AOV, the denoiser will only be "
+                "guided by the color of the image.", m_denoise_albedo, m_denoise_normals);
+
+        if (m_deep) {
+            auto it = std::find(channels.begin(), channels.end(), m_deep_depth);
+            if (it == channels.end())
+                Throw("Deep output requires a depth AOV named \"%s\" (see the \"deep_depth\" "
+                      "parameter)!", m_deep_depth);
+            m_depth_channel = (uint32_t) (it - channels.begin());
+            configure_block(m_storage.get());
+        }
+
+        if (m_lock_tile_size > 0) {
+            m_tile_count = (m_crop_size + m_lock_tile_size - 1) / m_lock_tile_size;
+            m_tile_mutexes.reset(new std::mutex[hprod(m_tile_count)]);
+        } else {
+            m_tile_count = 0;
+            m_tile_mutexes.reset();
+        }
+    }
+
+    void configure_block(ImageBlock *block) const override {
+        if (m_deep)
+            block->set_deep_samples(m_deep_samples, m_depth_channel, m_deep_merge);
     }
 
     void put(const ImageBlock *block) override {
         Assert(m_storage != nullptr);
-        std::lock_guard<std::mutex> lock(m_mutex);
-        m_storage->put(block);
+
+        if (is_cuda_array_v<Float> || !m_tile_mutexes) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            put_storage(block);
+            return;
+        }
+
+        // Determine the range of storage tiles touched by the block (including its border)
+        ScalarPoint2i lo = block->offset() - block->border_size() - m_storage->offset(),
+                      hi = lo + block->size() + 2 * block->border_size() - 1;
+        lo = max(lo, 0);
+        hi = min(hi, m_crop_size - 1);
+        if (any(hi < lo))
+            return;
+        lo /= m_lock_tile_size;
+        hi /= m_lock_tile_size;
+
+        /* Acquire the tile locks in row-major order to avoid deadlocks. Blocks
+           that don't overlap (including their borders) proceed concurrently. */
+        for (int y = lo.y(); y <= hi.y(); ++y)
+            for (int x = lo.x(); x <= hi.x(); ++x)
+                m_tile_mutexes[y * m_tile_count.x() + x].lock();
+
+        put_storage(block);
+
+        for (int y = lo.y(); y <= hi.y(); ++y)
+            for (int x = lo.x(); x <= hi.x(); ++x)
+                m_tile_mutexes[y * m_tile_count.x() + x].unlock();
+    }
+
+    /// Merge an image block into the storage and the half precision AOVs
+    void put_storage(const ImageBlock *block) {
+        if (likely(m_half_count == 0)) {
+            m_storage->put(block);
+            return;
+        }
+
+        if (unlikely(block->channel_count() != m_channels.size()))
+            Throw("HDRFilm::put(): mismatched channel counts!");
+
+        // Position of the block (including its border) within the storage
+        ScalarVector2i source_size = block->size() + 2 * block->border_size();
+        ScalarPoint2i delta = block->offset() - block->border_size() - m_storage->offset(),
+                      lo = max(delta, 0),
+                      hi = min(delta + source_size, m_crop_size);
+
+        const ScalarFloat *source = (const ScalarFloat *) block->data().managed().data();
+        ScalarFloat *target = (ScalarFloat *) m_storage->data().managed().data();
+        size_t channel_count = m_channels.size(),
+               storage_channels = m_storage->channel_count();
+
+        for (int y = lo.y(); y < hi.y(); ++y) {
+            for (int x = lo.x(); x < hi.x(); ++x) {
+                size_t pixel = (size_t) y * m_crop_size.x() + x;
+                const ScalarFloat *src = source + channel_count *
+                    ((y - delta.y()) * source_size.x() + (x - delta.x()));
+                ScalarFloat *dst = target + storage_channels * pixel;
+                uint16_t *half = m_half_storage.data() + m_half_count * pixel;
+
+                /* The half precision channels store averages, which are
+                   renormalized by the weights before and after the merge */
+                ScalarFloat weight[2] = { dst[4], dst[4] + src[4] },
+                            weight_unfiltered[2] = { 0.f, 0.f };
+                if (!m_unfiltered.empty()) {
+                    weight_unfiltered[0] = dst[storage_channels - 1];
+                    weight_unfiltered[1] = weight_unfiltered[0] + src[channel_count - 1];
+                }
+
+                for (size_t k = 0; k < channel_count; ++k) {
+                    if (!m_half[k]) {
+                        *dst++ += src[k];
+                        continue;
+                    }
+                    const ScalarFloat *w = !m_unfiltered.empty() && m_unfiltered[k]
+                                               ? weight_unfiltered : weight;
+                    ScalarFloat sum = enoki::half::float16_to_float32(*half) * w[0] + src[k];
+                    *half++ = enoki::half::float32_to_float16(
+                        (float) (w[1] != 0.f ? sum / w[1] : 0.f));
+                }
+            }
+        }
+    }
+
+    /**
+     * \brief Return the scanlines <tt>[y, y + rows)</tt> of the storage with
+     * all channels of the film
+     *
+     * Points into the storage unless the film has half precision AOVs, whose
+     * weighted sums are then reconstructed into \c temp along with the other
+     * channels.
+     */
+    const ScalarFloat *storage_rows(std::vector<ScalarFloat> &temp, uint32_t y,
+                                    uint32_t rows) const {
+        const ScalarFloat *storage = (const ScalarFloat *) m_storage->data().managed().data();
+        size_t width = (size_t) m_storage->width(),
+               channel_count = m_channels.size(),
+               storage_channels = m_storage->channel_count();
+
+        if (m_half_count == 0)
+            return storage + (size_t) y * width * channel_count;
+
+        temp.resize(width * rows * channel_count);
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, width * rows, 1024),
+            [&](const tbb::blocked_range<size_t> &range) {
+                for (size_t i = range.begin(); i != range.end(); ++i) {
+                    size_t pixel = (size_t) y * width + i;
+                    const ScalarFloat *src = storage + storage_channels * pixel;
+                    const uint16_t *half = m_half_storage.data() + m_half_count * pixel;
+                    ScalarFloat *dst = temp.data() + channel_count * i,
+                                weight = src[4],
+                                weight_unfiltered = m_unfiltered.empty()
+                                                        ? 0.f : src[storage_channels - 1];
+
+                    for (size_t k = 0; k < channel_count; ++k) {
+                        if (!m_half[k])
+                            dst[k] = *src++;
+                        else
+                            dst[k] = (ScalarFloat) enoki::half::float16_to_float32(*half++) *
+                                     (!m_unfiltered.empty() && m_unfiltered[k]
+                                          ? weight_unfiltered : weight);
+                    }
+                }
+            }
+        );
+
+        return temp.data();
     }
 
     bool develop(const ScalarPoint2i  &source_offset,
@@ -250,29 +708,280 @@ public:
 
     ref<Bitmap> bitmap(bool raw = false) override {
         if constexpr (is_cuda_array_v<Float>) {
+            if (!raw) {
+                ref<Bitmap> result = bitmap_gpu();
+                if (result)
+                    return result;
+            }
             cuda_eval();
             cuda_sync();
         }
 
-        ref<Bitmap> source = new Bitmap(m_channels.size() != 5 ? Bitmap::PixelFormat::MultiChannel
-                                                               : Bitmap::PixelFormat::XYZAW,
-                          struct_type_v<ScalarFloat>, m_storage->size(), m_storage->channel_count(),
-                          (uint8_t *) m_storage->data().managed().data());
+        std::vector<ScalarFloat> expanded;
+        const ScalarFloat *storage = storage_rows(expanded, 0, (uint32_t) m_storage->height());
+        Bitmap::PixelFormat source_format = m_channels.size() != 5
+                                                ? Bitmap::PixelFormat::MultiChannel
+                                                : Bitmap::PixelFormat::XYZAW;
+
+        ref<Bitmap> source;
+        bool denoise = m_denoise && !raw,
+             unfiltered = !m_unfiltered.empty() && !raw;
+        if (m_deferred_filter || denoise || unfiltered || m_half_count > 0) {
+            source = new Bitmap(source_format, struct_type_v<ScalarFloat>, m_storage->size(),
+                                m_channels.size());
+            ScalarFloat *data = (ScalarFloat *) source->data();
+            if (m_deferred_filter)
+                apply_filter(storage, data);
+            else
+                std::copy(storage, storage + hprod(m_storage->size()) *
+                                             m_channels.size(), data);
+            if (unfiltered)
+                normalize_unfiltered(data);
+            if (denoise)
+                apply_denoiser(data);
+        } else {
+            source = new Bitmap(source_format, struct_type_v<ScalarFloat>, m_storage->size(),
+                                m_storage->channel_count(), (uint8_t *) storage);
+        }
 
         if (raw)
             return source;
 
-        bool has_aovs = m_channels.size() != 5;
+        ref<Bitmap> target = new Bitmap(target_pixel_format(), m_component_format,
+                                        m_storage->size(), target_channel_count());
+        if (!develop_xyzaw((const ScalarFloat *) source->data(), target)) {
+            prepare_conversion(source, target);
+            source->convert(target);
+        }
+        target->metadata().merge(m_metadata);
+
+        return target;
+     };
+
+    /**
+     * \brief Develop the film on the GPU
+     *
+     * Runs the normalization, the color conversion and the packing into the
+     * component format of the output as a kernel, so that only the developed
+     * image is copied to the host rather than the whole accumulation buffer.
+     * Returns \c nullptr when the film requires the host implementation
+     * (AOVs, deferred filtering, denoising, integer component formats).
+     */
+    ref<Bitmap> bitmap_gpu() {
+        if constexpr (is_cuda_array_v<Float>) {
+            if (m_channels.size() != 5 || m_deferred_filter || m_denoise ||
+                !m_unfiltered.empty() || (m_component_format != Struct::Type::Float16 &&
+                                          m_component_format != Struct::Type::Float32))
+                return nullptr;
+
+            ref<Bitmap> target = new Bitmap(m_pixel_format, m_component_format,
+                                            m_storage->size());
+            uint32_t channels = (uint32_t) target->channel_count();
+            bool rgb = m_pixel_format == Bitmap::PixelFormat::RGB ||
+                       m_pixel_format == Bitmap::PixelFormat::RGBA,
+                 luminance = m_pixel_format == Bitmap::PixelFormat::Y ||
+                             m_pixel_format == Bitmap::PixelFormat::YA;
+            size_t value_count = hprod(m_storage->size()) * (size_t) channels;
+            const DynamicBuffer<Float> &storage = m_storage->data();
 
-        ref<Bitmap> target = new Bitmap(
-            has_aovs ? Bitmap::PixelFormat::MultiChannel : m_pixel_format,
-            m_component_format, m_storage->size(),
-            has_aovs ? (m_storage->channel_count() - 1) : 0);
+            // Developed value at the given index of the (interleaved) output image
+            auto value = [&](const UInt32 &index) {
+                Mask valid = index < (uint32_t) value_count;
+                UInt32 pixel = index / channels, channel = index - pixel * channels;
+                Float X = gather<Float>(storage, pixel * 5 + 0, valid),
+                      Y = gather<Float>(storage, pixel * 5 + 1, valid),
+                      Z = gather<Float>(storage, pixel * 5 + 2, valid),
+                      A = gather<Float>(storage, pixel * 5 + 3, valid),
+                      W = gather<Float>(storage, pixel * 5 + 4, valid);
+                Color3f c(X, Y, Z);
+                if (rgb)
+                    c = xyz_to_srgb(c);
+                else if (luminance)
+                    c.x() = Y;
+                Float result = select(channel == 0, c.x(),
+                               select(channel == 1 && !luminance, c.y(),
+                               select(channel == 2, c.z(), A)));
+                return select(W != 0.f, result / W, 0.f);
+            };
 
-        if (has_aovs) {
+            DynamicBuffer<Float> f32;
+            DynamicBuffer<UInt32> f16;
+            if (m_component_format == Struct::Type::Float32) {
+                f32 = value(arange<UInt32>(value_count));
+            } else {
+                // Pack two half precision values into every output word
+                UInt32 index = arange<UInt32>((value_count + 1) / 2) * 2;
+                f16 = float_to_half(value(index)) | (float_to_half(value(index + 1)) << 16);
+            }
+
+            cuda_eval();
+            cuda_sync();
+            const void *ptr = m_component_format == Struct::Type::Float32
+                                  ? (const void *) f32.data() : (const void *) f16.data();
+            cuda_memcpy_from_device(target->data(), ptr, target->buffer_size());
+            target->metadata().merge(m_metadata);
+            return target;
+        } else {
+            return nullptr;
+        }
+    }
+
+    /**
+     * \brief Convert single precision values into the bit patterns of the nearest
+     * half precision values (in the lower 16 bits)
+     *
+     * Rounds to even and handles denormals, infinities and NaNs like the
+     * host conversion of \ref Bitmap.
+     */
+    static UInt32 float_to_half(const Float &value) {
+        UInt32 bits = reinterpret_array<UInt32>(value),
+               sign = bits & 0x80000000u;
+        bits ^= sign;
+
+        // Too large for half precision: infinity, or a quiet NaN
+        UInt32 overflow = select(bits > 0x7f800000u, UInt32(0x7e00u), UInt32(0x7c00u));
+
+        // Denormals: let the floating point addition round the mantissa
+        UInt32 denormal = reinterpret_array<UInt32>(
+            reinterpret_array<Float>(bits) + reinterpret_array<Float>(UInt32(126u << 23))) -
+            (126u << 23);
+
+        // Normalized values: rebias the exponent and round to nearest even
+        UInt32 mant_odd = (bits >> 13) & 1u,
+               normal   = (bits + ((uint32_t) (15 - 127) << 23) + 0xfffu + mant_odd) >> 13;
+
+        UInt32 result = select(bits >= (143u << 23), overflow,
+                        select(bits < (113u << 23), denormal, normal));
+        return result | (sign >> 16);
+    }
+
+    /**
+     * \brief Develop XYZAW pixels on the host without \ref Bitmap::convert()
+     *
+     * Fuses the normalization by the weight, the conversion into the pixel
+     * format of the target and the packing into its component format into a
+     * single pass that is specialized for the output layout, and processes
+     * blocks of pixels in parallel. Pixels with a zero weight are developed
+     * as zero, like on the GPU. Returns \c false when the target requires the
+     * generic conversion (AOVs, integer component formats, gamma correction).
+     */
+    bool develop_xyzaw(const ScalarFloat *source, Bitmap *target) const {
+        if (m_channels.size() != 5 || target->srgb_gamma())
+            return false;
+
+        bool half = target->component_format() == Struct::Type::Float16;
+        if (!half && target->component_format() != Struct::Type::Float32)
+            return false;
+
+        size_t pixel_count = target->pixel_count();
+        void *data = target->data();
+        switch (target->pixel_format()) {
+            case Bitmap::PixelFormat::Y:
+                half ? develop_xyzaw<uint16_t, 1, false>(source, pixel_count, data)
+                     : develop_xyzaw<float, 1, false>(source, pixel_count, data);
+                break;
+            case Bitmap::PixelFormat::YA:
+                half ? develop_xyzaw<uint16_t, 2, false>(source, pixel_count, data)
+                     : develop_xyzaw<float, 2, false>(source, pixel_count, data);
+                break;
+            case Bitmap::PixelFormat::RGB:
+                half ? develop_xyzaw<uint16_t, 3, true>(source, pixel_count, data)
+                     : develop_xyzaw<float, 3, true>(source, pixel_count, data);
+                break;
+            case Bitmap::PixelFormat::RGBA:
+                half ? develop_xyzaw<uint16_t, 4, true>(source, pixel_count, data)
+                     : develop_xyzaw<float, 4, true>(source, pixel_count, data);
+                break;
+            case Bitmap::PixelFormat::XYZ:
+                half ? develop_xyzaw<uint16_t, 3, false>(source, pixel_count, data)
+                     : develop_xyzaw<float, 3, false>(source, pixel_count, data);
+                break;
+            case Bitmap::PixelFormat::XYZA:
+                half ? develop_xyzaw<uint16_t, 4, false>(source, pixel_count, data)
+                     : develop_xyzaw<float, 4, false>(source, pixel_count, data);
+                break;
+            default:
+                return false;
+        }
+        return true;
+    }
+
+    /**
+     * Kernel of \ref develop_xyzaw(). \c Value is \c uint16_t for half
+     * precision output, \c Channels selects luminance (1, 2) or tristimulus
+     * values (3, 4) with an optional alpha channel, and \c RGB enables the
+     * conversion of the latter into linear sRGB.
+     */
+    template <typename Value, size_t Channels, bool RGB>
+    static void develop_xyzaw(const ScalarFloat *source, size_t pixel_count, void *target_) {
+        Value *target = (Value *) target_;
+
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, pixel_count, 16384),
+            [&](const tbb::blocked_range<size_t> &range) {
+                for (size_t i = range.begin(); i != range.end(); ++i) {
+                    const ScalarFloat *p = source + i * 5;
+                    ScalarFloat inv_w = p[4] != 0.f ? 1.f / p[4] : 0.f;
+                    ScalarColor3f c(p[0] * inv_w, p[1] * inv_w, p[2] * inv_w);
+                    if constexpr (RGB)
+                        c = xyz_to_srgb(c);
+
+                    float value[Channels];
+                    if constexpr (Channels <= 2) {
+                        value[0] = (float) c.y();
+                    } else {
+                        value[0] = (float) c.x();
+                        value[1] = (float) c.y();
+                        value[2] = (float) c.z();
+                    }
+                    if constexpr (Channels == 2 || Channels == 4)
+                        value[Channels - 1] = (float) (p[3] * inv_w);
+
+                    Value *out = target + i * Channels;
+                    for (size_t k = 0; k < Channels; ++k) {
+                        if constexpr (std::is_same_v<Value, uint16_t>)
+                            out[k] = enoki::half::float32_to_float16(value[k]);
+                        else
+                            out[k] = value[k];
+                    }
+                }
+            }
+        );
+    }
+
+    /// Pixel format of the developed image
+    Bitmap::PixelFormat target_pixel_format() const {
+        return m_channels.size() != 5 ? Bitmap::PixelFormat::MultiChannel : m_pixel_format;
+    }
+
+    /// Channel count of the developed image (0: implied by the pixel format)
+    size_t target_channel_count() const {
+        if (m_channels.size() == 5)
+            return 0;
+        // Drop the weight channel(s) and the ID layers, which are written separately
+        size_t id_count = m_id_channels.size() -
+            std::count(m_id_channels.begin(), m_id_channels.end(), 0u);
+        return m_channels.size() - (m_unfiltered.empty() ? 1 : 2) - id_count;
+    }
+
+    /// Name the channels of the storage and the developed image for \ref Bitmap::convert()
+    void prepare_conversion(Bitmap *source, Bitmap *target) const {
+        if (m_channels.size() != 5) {
             for (size_t i = 0, j = 0; i < m_channels.size(); ++i, ++j) {
-                Struct::Field &source_field = source->struct_()->operator[](i),
-                              &dest_field   = target->struct_()->operator[](j);
+                Struct::Field &source_field = source->struct_()->operator[](i);
+                source_field.name = m_channels[i];
+
+                // The sample count of the unfiltered AOVs isn't part of the output
+                if (!m_unfiltered.empty() && i + 1 == m_channels.size())
+                    break;
+
+                // Neither are the ID layers (see develop_id_layers())
+                if (!m_id_channels.empty() && m_id_channels[i] != 0) {
+                    j--;
+                    continue;
+                }
+
+                Struct::Field &dest_field = target->struct_()->operator[](j);
 
                 switch (i) {
                     case 0:
@@ -311,17 +1020,70 @@ public:
                         dest_field.name = m_channels[i];
                         break;
                 }
+            }
+        }
+    }
 
-                source_field.name = m_channels[i];
+    /**
+     * \brief Develop the film into an OpenEXR file in blocks of scanlines
+     *
+     * Every block is converted from the storage straight into the buffer of
+     * the output file, so that the developed image never exists in memory
+     * at full resolution.
+     */
+    void develop_exr_blocks(const fs::path &filename) {
+        if constexpr (is_cuda_array_v<Float>) {
+            // The GPU develops the complete image, without copying the storage
+            ref<Bitmap> result = bitmap_gpu();
+            if (result) {
+                result->write(filename, m_file_format, m_compression_level, m_compression);
+                return;
             }
+            cuda_eval();
+            cuda_sync();
         }
 
-        source->convert(target);
+        std::vector<ScalarFloat> expanded;
+        Bitmap::PixelFormat source_format = m_channels.size() != 5
+                                                ? Bitmap::PixelFormat::MultiChannel
+                                                : Bitmap::PixelFormat::XYZAW;
+        size_t channel_count = m_channels.size();
 
-        return target;
-     };
+        /* Scanlines per block: a multiple of the blocks of all EXR compressors,
+           so that OpenEXR can compress the blocks of a chunk in parallel */
+        uint32_t width  = (uint32_t) m_storage->width(),
+                 height = (uint32_t) m_storage->height(),
+                 block_rows = std::min(height, 256u);
+
+        ref<Bitmap> block = new Bitmap(target_pixel_format(), m_component_format,
+                                       ScalarVector2u(width, block_rows),
+                                       target_channel_count());
+        block->metadata().merge(m_metadata);
+
+        // Name the channels of the output file
+        ref<Bitmap> first_row = new Bitmap(source_format, struct_type_v<ScalarFloat>,
+                                           ScalarVector2u(width, 1), channel_count,
+                                           (uint8_t *) storage_rows(expanded, 0, 1));
+        prepare_conversion(first_row, block);
+
+        block->write_openexr_blocks(filename, height, [&](uint32_t y, uint32_t rows) {
+            ref<Bitmap> source = new Bitmap(
+                source_format, struct_type_v<ScalarFloat>, ScalarVector2u(width, rows),
+                channel_count, (uint8_t *) storage_rows(expanded, y, rows));
+            ref<Bitmap> target = block;
+            if (rows != block_rows)
+                target = new Bitmap(target_pixel_format(), m_component_format,
+                                    ScalarVector2u(width, rows), target_channel_count(),
+                                    block->uint8_data());
+            if (!develop_xyzaw((const ScalarFloat *) source->data(), target)) {
+                prepare_conversion(source, target);
+                source->convert(target);
+            }
+        }, m_compression_level, m_compression);
+    }
 
     void develop() override {
+        ScopedPhase sp(ProfilerPhase::FilmDevelop);
         if (m_dest_file.empty())
             Throw("Destination file not specified, cannot develop.");
 
@@ -340,7 +1102,179 @@ public:
 
         Log(Info, "\U00002714  Developing \"%s\" ..", filename.string());
 
-        bitmap()->write(filename, m_file_format);
+        fs::path basename = filename;
+        basename.replace_extension("");
+
+        if (m_split_aovs && m_channels.size() != 5) {
+            // Write the image and every AOV into a separate file
+            for (auto &[name, layer] : bitmap()->split()) {
+                fs::path layer_file = filename;
+                if (name != "<root>")
+                    layer_file = fs::path(basename.string() + "_" + name + proper_extension);
+                layer->write(layer_file, m_file_format, m_compression_level, m_compression);
+            }
+        } else if (m_file_format == Bitmap::FileFormat::OpenEXR && !m_deferred_filter &&
+                   !m_denoise && m_unfiltered.empty()) {
+            /* Stream OpenEXR output, unless the deferred filter, the denoiser or the
+               unfiltered AOVs need the whole image (they allocate a copy of the
+               storage anyways) */
+            develop_exr_blocks(filename);
+        } else {
+            bitmap()->write(filename, m_file_format, m_compression_level, m_compression);
+        }
+
+        if (!m_id_channels.empty())
+            develop_id_layers(basename);
+        if (m_deep)
+            develop_deep(fs::path(basename.string() + "_deep.exr"));
+    }
+
+    /**
+     * \brief Write the deep samples of the storage into a deep OpenEXR file
+     *
+     * The records of each pixel become RGBA samples at their average depth.
+     * A record covers the fraction of the pixel's samples that it merged,
+     * which is converted into the alpha of a sample composited \a over the
+     * ones behind it, so that flattening the deep image reproduces the
+     * (unfiltered) color of the pixel.
+     */
+    void develop_deep(const fs::path &filename) const {
+        ScalarVector2i size = m_storage->size();
+        uint32_t max_samples = m_storage->deep_samples();
+        Log(Info, "\U00002714  Developing \"%s\" ..", filename.string());
+
+        std::vector<unsigned int> counts(hprod(size));
+        std::vector<float> samples(hprod(size) * max_samples * 5);
+
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, counts.size(), 1024),
+            [&](const tbb::blocked_range<size_t> &range) {
+                for (size_t i = range.begin(); i != range.end(); ++i) {
+                    const ScalarFloat *pixel = m_storage->deep_pixel(
+                        ScalarPoint2i(int(i % size.x()), int(i / size.x())));
+                    float *out = samples.data() + i * max_samples * 5;
+                    ScalarFloat inv_count = pixel[0] > 0.f ? 1.f / pixel[0] : 0.f,
+                                remaining = 1.f;
+                    unsigned int n = 0;
+
+                    for (; n < max_samples && pixel[2 + 6 * n] != 0.f; ++n) {
+                        const ScalarFloat *record = pixel + 1 + 6 * n;
+                        ScalarFloat scale = inv_count / std::max(remaining, ScalarFloat(1e-6f)),
+                                    x = record[2] * scale, y = record[3] * scale,
+                                    z = record[4] * scale;
+
+                        // Same primaries as the RGB conversion of the developed image
+                        out[0] = (float) ( 3.240479f * x - 1.537150f * y - 0.498535f * z);
+                        out[1] = (float) (-0.969256f * x + 1.875991f * y + 0.041556f * z);
+                        out[2] = (float) ( 0.055648f * x - 0.204043f * y + 1.057311f * z);
+                        out[3] = (float) std::min(record[5] * scale, ScalarFloat(1.f));
+                        out[4] = (float) record[0];
+                        out += 5;
+
+                        remaining -= record[5] * inv_count;
+                    }
+                    counts[i] = n;
+                }
+            }
+        );
+
+        Imf::Header header(size.x(), size.y());
+        header.setType(Imf::DEEPSCANLINE);
+        header.compression() = Imf::ZIPS_COMPRESSION;
+        const char *names[5] = { "R", "G", "B", "A", "Z" };
+        for (const char *name : names)
+            header.channels().insert(name, Imf::Channel(Imf::FLOAT));
+
+        // Per-pixel pointers to the interleaved samples of each channel
+        std::vector<float *> pointers(hprod(size) * 5);
+        for (size_t i = 0; i < counts.size(); ++i)
+            for (size_t c = 0; c < 5; ++c)
+                pointers[c * counts.size() + i] = samples.data() + i * max_samples * 5 + c;
+
+        Imf::DeepFrameBuffer frame_buffer;
+        frame_buffer.insertSampleCountSlice(
+            Imf::Slice(Imf::UINT, (char *) counts.data(), sizeof(unsigned int),
+                       sizeof(unsigned int) * size.x()));
+        for (size_t c = 0; c < 5; ++c)
+            frame_buffer.insert(names[c],
+                Imf::DeepSlice(Imf::FLOAT, (char *) (pointers.data() + c * counts.size()),
+                               sizeof(float *), sizeof(float *) * size.x(),
+                               5 * sizeof(float)));
+
+        Imf::DeepScanLineOutputFile file(filename.string().c_str(), header);
+        file.setFrameBuffer(frame_buffer);
+        file.writePixels(size.y());
+    }
+
+    /**
+     * \brief Write each ID layer into a Cryptomatte OpenEXR file named
+     * <tt><basename>_<layer>.exr</tt>
+     *
+     * The (ID, sample count) pairs of every pixel are ranked by their count,
+     * which is normalized into a coverage by the "W.unfiltered" channel. IDs
+     * must stay exact, hence the files are always stored losslessly in single
+     * precision, regardless of the format of the film.
+     */
+    void develop_id_layers(const fs::path &basename) const {
+        const ScalarFloat *storage = (const ScalarFloat *) m_storage->data().managed().data();
+        size_t channel_count = m_storage->channel_count(),
+               pixel_count   = hprod(m_storage->size());
+        const auto &layers = Base::id_layers();
+
+        for (uint32_t layer = 1; layer <= layers.size(); ++layer) {
+            auto it = std::find(m_id_channels.begin(), m_id_channels.end(), layer);
+            if (it == m_id_channels.end())
+                continue;
+            size_t begin = it - m_id_channels.begin(),
+                   size  = std::count(m_id_channels.begin(), m_id_channels.end(), layer),
+                   ranks = size / 2;
+            const std::string &name = layers[layer - 1].first;
+
+            ref<Bitmap> bitmap = new Bitmap(Bitmap::PixelFormat::MultiChannel,
+                                            Struct::Type::Float32, m_storage->size(), size);
+            for (size_t k = 0; k < size; ++k)
+                bitmap->struct_()->operator[](k).name = m_channels[begin + k];
+            float *target = (float *) bitmap->data();
+
+            tbb::parallel_for(
+                tbb::blocked_range<size_t>(0, pixel_count, 1024),
+                [&](const tbb::blocked_range<size_t> &range) {
+                    std::vector<size_t> order(ranks);
+                    for (size_t i = range.begin(); i != range.end(); ++i) {
+                        const ScalarFloat *pixel = storage + i * channel_count,
+                                          *slots = pixel + begin;
+                        ScalarFloat count = pixel[channel_count - 1];
+
+                        std::iota(order.begin(), order.end(), (size_t) 0);
+                        std::stable_sort(order.begin(), order.end(),
+                                         [&](size_t a, size_t b) {
+                                             return slots[2 * a + 1] > slots[2 * b + 1];
+                                         });
+
+                        float *out = target + i * size;
+                        for (size_t r = 0; r < ranks; ++r) {
+                            out[2 * r]     = (float) slots[2 * order[r]];
+                            out[2 * r + 1] = count > 0.f
+                                ? (float) (slots[2 * order[r] + 1] / count) : 0.f;
+                        }
+                    }
+                }
+            );
+
+            std::string key = tfm::format("%08x", murmur_hash3(name)).substr(0, 7),
+                        prefix = "cryptomatte/" + key + "/";
+            Properties &metadata = bitmap->metadata();
+            metadata.set_string(prefix + "name", name);
+            metadata.set_string(prefix + "hash", "MurmurHash3_32");
+            metadata.set_string(prefix + "conversion", "uint32_to_float32");
+            if (!layers[layer - 1].second.empty())
+                metadata.set_string(prefix + "manifest", layers[layer - 1].second);
+
+            fs::path file = fs::path(basename.string() + "_" + name + ".exr");
+            Log(Info, "\U00002714  Developing \"%s\" ..", file.string());
+            bitmap->write(file, Bitmap::FileFormat::OpenEXR, -1,
+                          Bitmap::EXRCompression::ZIP);
+        }
     }
 
     bool destination_exists(const fs::path &base_name) const override {
@@ -361,6 +1295,226 @@ public:
         return fs::exists(filename);
     }
 
+    /**
+     * \brief Convolve the per-pixel sample sums with the reconstruction filter
+     * (deferred filtering mode)
+     *
+     * The filter is applied separably using its values at integer pixel
+     * offsets. Since the weight channel is filtered as well, normalizing by it
+     * yields the filtered image, including at the boundary of the film.
+     */
+    void apply_filter(const ScalarFloat *source, ScalarFloat *target) const {
+        ScalarVector2i size = m_storage->size();
+        uint32_t channel_count = (uint32_t) m_channels.size();
+        int radius = (int) std::floor(m_filter->radius() - 2.f * math::RayEpsilon<ScalarFloat>);
+
+        std::vector<ScalarFloat> weights(2 * radius + 1);
+        for (int i = -radius; i <= radius; ++i) {
+            Float value = m_filter->eval(Float((ScalarFloat) i));
+            if constexpr (is_array_v<Float>)
+                weights[i + radius] = slice(value, 0);
+            else
+                weights[i + radius] = value;
+        }
+
+        size_t row_size = (size_t) size.x() * channel_count;
+        std::unique_ptr<ScalarFloat[]> temp(new ScalarFloat[row_size * size.y()]);
+        std::fill(target, target + row_size * size.y(), 0.f);
+        std::fill(temp.get(), temp.get() + row_size * size.y(), 0.f);
+
+        // Horizontal pass (source -> temp)
+        tbb::parallel_for(
+            tbb::blocked_range<int>(0, size.y(), 16),
+            [&](const tbb::blocked_range<int> &range) {
+                for (int y = range.begin(); y != range.end(); ++y) {
+                    const ScalarFloat *src = source + y * row_size;
+                    ScalarFloat *dst = temp.get() + y * row_size;
+                    for (int x = 0; x < size.x(); ++x) {
+                        ScalarFloat *pixel = dst + x * channel_count;
+                        int i0 = std::max(-radius, -x),
+                            i1 = std::min(radius, size.x() - 1 - x);
+                        for (int i = i0; i <= i1; ++i) {
+                            const ScalarFloat *in = src + (x + i) * channel_count;
+                            ScalarFloat weight = weights[i + radius];
+                            for (uint32_t k = 0; k < channel_count; ++k)
+                                pixel[k] += weight * in[k];
+                        }
+                    }
+                }
+            }
+        );
+
+        // Vertical pass (temp -> target), accumulating entire rows at once
+        tbb::parallel_for(
+            tbb::blocked_range<int>(0, size.y(), 16),
+            [&](const tbb::blocked_range<int> &range) {
+                for (int y = range.begin(); y != range.end(); ++y) {
+                    ScalarFloat *dst = target + y * row_size;
+                    int i0 = std::max(-radius, -y),
+                        i1 = std::min(radius, size.y() - 1 - y);
+                    for (int i = i0; i <= i1; ++i) {
+                        const ScalarFloat *in = temp.get() + (y + i) * row_size;
+                        ScalarFloat weight = weights[i + radius];
+                        for (size_t k = 0; k < row_size; ++k)
+                            dst[k] += weight * in[k];
+                    }
+
+                    // Channels of unfiltered AOVs keep their per-pixel sums
+                    if (!m_unfiltered.empty()) {
+                        const ScalarFloat *src = source + y * row_size;
+                        for (size_t k = 0; k < row_size; ++k) {
+                            if (m_unfiltered[k % channel_count])
+                                dst[k] = src[k];
+                        }
+                    }
+                }
+            }
+        );
+    }
+
+    /**
+     * \brief Normalize the channels of the unfiltered AOVs by their sample
+     * count
+     *
+     * The values are scaled by the weight channel, which is divided out when
+     * the film is converted into the output format.
+     */
+    void normalize_unfiltered(ScalarFloat *data) const {
+        size_t pixel_count = hprod(m_storage->size()),
+               channel_count = m_channels.size();
+
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, pixel_count, 1024),
+            [&](const tbb::blocked_range<size_t> &range) {
+                for (size_t i = range.begin(); i != range.end(); ++i) {
+                    ScalarFloat *pixel = data + i * channel_count,
+                                count = pixel[channel_count - 1],
+                                scale = count > 0.f ? pixel[4] / count : 0.f;
+                    for (size_t k = 0; k + 1 < channel_count; ++k) {
+                        if (m_unfiltered[k])
+                            pixel[k] *= scale;
+                    }
+                }
+            }
+        );
+    }
+
+    /**
+     * \brief Denoise the tristimulus values of the (unnormalized) film contents
+     * using the edge-avoiding A-Trous wavelet transform of Dammertz et al.
+     *
+     * The color is demodulated by the albedo AOV (if available), and the
+     * weights of the B-spline kernel are attenuated based on the differences
+     * of the tone mapped colors, normals and albedos of the pixels.
+     */
+    void apply_denoiser(ScalarFloat *data) const {
+        using ScalarColor3f = Color<ScalarFloat, 3>;
+
+        ScalarVector2i size = m_storage->size();
+        size_t pixel_count = hprod(size),
+               channel_count = m_channels.size();
+
+        std::vector<ScalarColor3f> color(pixel_count), temp(pixel_count),
+                                   albedo(pixel_count, ScalarColor3f(1.f));
+        std::vector<ScalarVector3f> normal(pixel_count, ScalarVector3f(0.f));
+
+        // Normalize the pixels and divide by the albedo
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, pixel_count, 1024),
+            [&](const tbb::blocked_range<size_t> &range) {
+                for (size_t i = range.begin(); i != range.end(); ++i) {
+                    const ScalarFloat *pixel = data + i * channel_count;
+                    ScalarFloat inv_weight = pixel[4] > 0.f ? rcp(pixel[4]) : 0.f;
+
+                    if (m_albedo_channel >= 0) {
+                        const ScalarFloat *a = pixel + m_albedo_channel;
+                        albedo[i] = max(ScalarColor3f(a[0], a[1], a[2]) * inv_weight, 1e-2f);
+                    }
+                    if (m_normal_channel >= 0) {
+                        const ScalarFloat *n = pixel + m_normal_channel;
+                        ScalarVector3f value(n[0], n[1], n[2]);
+                        ScalarFloat length = norm(value);
+                        if (length > 0.f)
+                            normal[i] = value / length;
+                    }
+
+                    ScalarColor3f rgb =
+                        xyz_to_srgb(ScalarColor3f(pixel[0], pixel[1], pixel[2]) * inv_weight);
+                    color[i] = max(rgb, 0.f) / albedo[i];
+                }
+            }
+        );
+
+        const ScalarFloat kernel[3] = { 3.f / 8.f, 1.f / 4.f, 1.f / 16.f };
+        const ScalarFloat inv_sigma_n = 1.f / sqr(.1f), inv_sigma_a = 1.f / sqr(.1f);
+
+        for (int it = 0; it < 5; ++it) {
+            int step = 1 << it;
+            ScalarFloat inv_sigma_c = 1.f / sqr(.5f / step);
+
+            tbb::parallel_for(
+                tbb::blocked_range<int>(0, size.y(), 16),
+                [&](const tbb::blocked_range<int> &range) {
+                    for (int y = range.begin(); y != range.end(); ++y) {
+                        for (int x = 0; x < size.x(); ++x) {
+                            size_t p = (size_t) y * size.x() + x;
+                            ScalarColor3f tm_p = color[p] / (1.f + color[p]), sum(0.f);
+                            ScalarFloat weight_sum = 0.f;
+
+                            for (int dy = -2; dy <= 2; ++dy) {
+                                int qy = y + dy * step;
+                                if (qy < 0 || qy >= size.y())
+                                    continue;
+                                for (int dx = -2; dx <= 2; ++dx) {
+                                    int qx = x + dx * step;
+                                    if (qx < 0 || qx >= size.x())
+                                        continue;
+                                    size_t q = (size_t) qy * size.x() + qx;
+
+                                    ScalarColor3f tm_q = color[q] / (1.f + color[q]);
+                                    ScalarFloat exponent = squared_norm(tm_q - tm_p) * inv_sigma_c;
+                                    if (m_normal_channel >= 0)
+                                        exponent += std::max(ScalarFloat(0), 1.f - dot(normal[p], normal[q])) *
+                                                    inv_sigma_n;
+                                    if (m_albedo_channel >= 0)
+                                        exponent += squared_norm(albedo[q] - albedo[p]) *
+                                                    inv_sigma_a;
+
+                                    ScalarFloat weight = kernel[std::abs(dx)] *
+                                                         kernel[std::abs(dy)] * std::exp(-exponent);
+                                    sum += weight * color[q];
+                                    weight_sum += weight;
+                                }
+                            }
+
+                            // The center pixel always has a positive weight
+                            temp[p] = sum / weight_sum;
+                        }
+                    }
+                }
+            );
+            color.swap(temp);
+        }
+
+        // Multiply by the albedo and store the result (scaled by the sample weights)
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, pixel_count, 1024),
+            [&](const tbb::blocked_range<size_t> &range) {
+                for (size_t i = range.begin(); i != range.end(); ++i) {
+                    ScalarFloat *pixel = data + i * channel_count;
+                    ScalarColor3f xyz = srgb_to_xyz(color[i] * albedo[i]) * pixel[4];
+                    for (size_t k = 0; k < 3; ++k)
+                        pixel[k] = xyz[k];
+                }
+            }
+        );
+    }
+
+    void account_memory(MemoryReport *report) const override {
+        report->visit(m_storage.get());
+        report->add(MemoryCategory::Film, m_half_storage.size() * sizeof(uint16_t));
+    }
+
     std::string to_string() const override {
         std::ostringstream oss;
         oss << "HDRFilm[" << std::endl
@@ -368,10 +1522,17 @@ public:
             << "  crop_size = " << m_crop_size   << "," << std::endl
             << "  crop_offset = " << m_crop_offset << "," << std::endl
             << "  high_quality_edges = " << m_high_quality_edges << "," << std::endl
+            << "  deferred_filter = " << m_deferred_filter << "," << std::endl
             << "  filter = " << m_filter << "," << std::endl
             << "  file_format = " << m_file_format << "," << std::endl
             << "  pixel_format = " << m_pixel_format << "," << std::endl
             << "  component_format = " << m_component_format << "," << std::endl
+            << "  compression = " << m_compression << "," << std::endl
+            << "  lock_tile_size = " << m_lock_tile_size << "," << std::endl
+            << "  half_aovs = " << m_half_aovs << "," << std::endl
+            << "  split_aovs = " << m_split_aovs << "," << std::endl
+            << "  deep = " << m_deep << "," << std::endl
+            << "  denoise = " << m_denoise << "," << std::endl
             << "  dest_file = \"" << m_dest_file << "\"" << std::endl
             << "]";
         return oss.str();
@@ -382,10 +1543,36 @@ protected:
     Bitmap::FileFormat m_file_format;
     Bitmap::PixelFormat m_pixel_format;
     Struct::Type m_component_format;
+    Bitmap::EXRCompression m_compression;
+    int m_compression_level;
     fs::path m_dest_file;
     ref<ImageBlock> m_storage;
     std::mutex m_mutex;
+    /// Striped locks protecting tiles of \c m_storage (see \c lock_tile_size)
+    std::unique_ptr<std::mutex[]> m_tile_mutexes;
+    ScalarVector2i m_tile_count;
+    int m_lock_tile_size;
     std::vector<std::string> m_channels;
+    /// Channels that bypass the reconstruction filter (see Film::unfiltered_channels())
+    std::vector<bool> m_unfiltered;
+    /// ID layer of each channel of the storage (see Film::id_channels())
+    std::vector<uint32_t> m_id_channels;
+    /// Half precision AOVs: names, mask of their channels and averages of each pixel
+    std::vector<std::string> m_half_aovs;
+    std::vector<bool> m_half;
+    size_t m_half_count;
+    std::vector<uint16_t> m_half_storage;
+    bool m_split_aovs;
+    /// Deep output: samples per pixel, name and index of the depth AOV, merge tolerance
+    bool m_deep;
+    uint32_t m_deep_samples;
+    std::string m_deep_depth;
+    uint32_t m_depth_channel;
+    ScalarFloat m_deep_merge;
+    bool m_denoise;
+    std::string m_denoise_albedo, m_denoise_normals;
+    /// Index of the first albedo and normal channel of the storage (or -1)
+    int m_albedo_channel, m_normal_channel;
 };
 
 MTS_IMPLEMENT_CLASS_VARIANT(HDRFilm, Film)
@@ -142,3 +142,499 @@ def test03_develop(variant_scalar_rgb, file_format, tmpdir):
             assert ek.allclose(img[:, :, :3], contents[:, :, :3], atol=1e-5)
         # Alpha channel was ignored, alpha and weights should default to 1.0.
         assert ek.allclose(img[:, :, 3:5], 1.0, atol=1e-6)
+
+
+@pytest.mark.parametrize('lock_tile_size', [0, 1, 7, 32])
+def test04_put_tiled_locks(variant_scalar_rgb, lock_tile_size):
+    from mitsuba.core.xml import load_string
+    from mitsuba.render import ImageBlock
+    import numpy as np
+
+    """Merging overlapping blocks must give the same result regardless of the
+    granularity of the film's tile locks."""
+    film = load_string("""<film version="2.0.0" type="hdrfilm">
+            <integer name="width" value="23"/>
+            <integer name="height" value="19"/>
+            <integer name="lock_tile_size" value="{}"/>
+            <rfilter type="gaussian"/>
+        </film>""".format(lock_tile_size))
+    film.prepare(['X', 'Y', 'Z', 'A', 'W'])
+
+    expected = np.zeros((film.size()[1], film.size()[0], 5))
+    for oy in range(0, film.size()[1], 8):
+        for ox in range(0, film.size()[0], 8):
+            block = ImageBlock([8, 8], 5, film.reconstruction_filter())
+            block.set_offset([ox, oy])
+            block.clear()
+            block.put([ox + 4.0, oy + 4.0], [1.0, 2.0, 3.0, 1.0, 1.0])
+            film.put(block)
+
+            # Re-create the splat footprint on a full-size reference block
+            ref = ImageBlock(film.size(), 5, film.reconstruction_filter(), border=False)
+            ref.clear()
+            ref.put([ox + 4.0, oy + 4.0], [1.0, 2.0, 3.0, 1.0, 1.0])
+            expected += np.array(ref.data()).reshape(expected.shape)
+
+    img = np.array(film.bitmap(raw=True), copy=False)
+    assert ek.allclose(img, expected, atol=1e-5)
+
+
+def test05_deferred_filter(variant_scalar_rgb):
+    from mitsuba.core.xml import load_string
+    from mitsuba.render import ImageBlock
+    import numpy as np
+
+    """In deferred mode, samples are accumulated per pixel and the
+    reconstruction filter is applied as a separable convolution when the
+    film is developed."""
+    film = load_string("""<film version="2.0.0" type="hdrfilm">
+            <integer name="width" value="13"/>
+            <integer name="height" value="9"/>
+            <boolean name="deferred_filter" value="true"/>
+            <rfilter type="gaussian"/>
+        </film>""")
+    assert film.has_deferred_filter()
+    assert film.sample_filter().radius() < 0.51
+    assert film.reconstruction_filter().radius() == 2
+    film.prepare(['X', 'Y', 'Z', 'A', 'W'])
+
+    np.random.seed(0)
+    sums = np.zeros((film.size()[1], film.size()[0], 5))
+    block = ImageBlock(film.size(), 5, film.sample_filter())
+    assert block.border_size() == 0
+    block.clear()
+    for i in range(40):
+        pos = np.random.uniform(size=(2,), low=0, high=film.size())
+        value = np.random.uniform(size=(5,))
+        value[4] = 1.0
+        block.put(pos, list(value))
+        sums[int(pos[1]), int(pos[0]), :] += value
+    film.put(block)
+
+    rfilter = film.reconstruction_filter()
+    weights = [rfilter.eval(i) for i in range(-1, 2)]
+    tmp = np.zeros(sums.shape)
+    expected = np.zeros(sums.shape)
+    for i, w in zip(range(-1, 2), weights):
+        tmp[:, max(-i, 0):sums.shape[1] + min(-i, 0)] += \
+            w * sums[:, max(i, 0):sums.shape[1] + min(i, 0)]
+    for i, w in zip(range(-1, 2), weights):
+        expected[max(-i, 0):sums.shape[0] + min(-i, 0)] += \
+            w * tmp[max(i, 0):sums.shape[0] + min(i, 0)]
+
+    img = np.array(film.bitmap(raw=True), copy=False)
+    assert ek.allclose(img, expected, atol=1e-5)
+
+
+@pytest.mark.parametrize('compression', ['none', 'zip', 'piz'])
+def test06_develop_exr_blocks(variant_scalar_rgb, compression, tmpdir):
+    from mitsuba.core.xml import load_string
+    from mitsuba.core import Bitmap
+    from mitsuba.render import ImageBlock
+    import numpy as np
+
+    """OpenEXR files are developed in blocks of scanlines, which must give the
+    same result as developing the full image at once (here with a partial
+    last block)."""
+    film = load_string("""<film version="2.0.0" type="hdrfilm">
+            <integer name="width" value="5"/>
+            <integer name="height" value="301"/>
+            <string name="component_format" value="float32"/>
+            <string name="compression" value="{}"/>
+            <rfilter type="box"/>
+        </film>""".format(compression))
+    channels = ['X', 'Y', 'Z', 'A', 'W', 'aov.x', 'aov.y']
+    film.prepare(channels)
+
+    np.random.seed(0)
+    block = ImageBlock(film.size(), len(channels), film.reconstruction_filter())
+    block.clear()
+    for y in range(film.size()[1]):
+        for x in range(film.size()[0]):
+            value = np.random.uniform(size=(len(channels),))
+            value[4] = 1.0
+            block.put([x + 0.5, y + 0.5], list(value))
+    film.put(block)
+
+    filename = str(tmpdir.join('test_image.exr'))
+    film.set_destination_file(filename)
+    film.develop()
+
+    expected = np.array(film.bitmap(), copy=False)
+    img = np.array(Bitmap(filename), copy=False)
+    assert img.shape == (301, 5, 6)
+    assert ek.allclose(img, expected, atol=1e-6)
+
+
+def test07_splat_blocks(variant_scalar_rgb):
+    from mitsuba.core import srgb_to_xyz
+    from mitsuba.core.xml import load_string
+    from mitsuba.render import ImageBlock
+    import numpy as np
+    import threading
+
+    """Every thread splats into its own block, which only reaches the film
+    once the splats are merged."""
+    film = load_string("""<film version="2.0.0" type="hdrfilm">
+            <integer name="width" value="4"/>
+            <integer name="height" value="3"/>
+            <rfilter type="box"/>
+        </film>""")
+    film.prepare(['X', 'Y', 'Z', 'A', 'W'])
+
+    block = ImageBlock(film.size(), 5, film.reconstruction_filter())
+    block.clear()
+    for y in range(film.size()[1]):
+        for x in range(film.size()[0]):
+            block.put([x + 0.5, y + 0.5], [0.0, 0.0, 0.0, 1.0, 2.0])
+    film.put(block)
+
+    def splat():
+        film.splat_block().splat([1.5, 2.5], [], [1.0, 2.0, 3.0])
+
+    threads = [threading.Thread(target=splat) for i in range(3)]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+
+    img = np.array(film.bitmap(raw=True), copy=False)
+    assert np.all(img[..., :3] == 0)
+
+    # Splats don't change the alpha and weight channels
+    expected = np.zeros((film.size()[1], film.size()[0], 5))
+    expected[..., 3] = 1.0
+    expected[..., 4] = 2.0
+    expected[2, 1, :3] = 3 * np.array(srgb_to_xyz([1.0, 2.0, 3.0]))
+    for i in range(2):
+        film.merge_splats()
+        img = np.array(film.bitmap(raw=True), copy=False)
+        assert ek.allclose(img, expected, atol=1e-5)
+
+
+def test08_denoise(variant_scalar_rgb):
+    from mitsuba.core import srgb_to_xyz
+    from mitsuba.core.xml import load_string
+    from mitsuba.render import ImageBlock
+    import numpy as np
+
+    """The denoiser removes the noise of the developed image, but keeps the
+    edges of the albedo and normal AOVs."""
+    film = load_string("""<film version="2.0.0" type="hdrfilm">
+            <integer name="width" value="32"/>
+            <integer name="height" value="16"/>
+            <string name="component_format" value="float32"/>
+            <boolean name="denoise" value="true"/>
+            <rfilter type="box"/>
+        </film>""")
+    channels = ['X', 'Y', 'Z', 'A', 'W', 'albedo.R', 'albedo.G', 'albedo.B',
+                'nn.X', 'nn.Y', 'nn.Z']
+    film.prepare(channels)
+
+    np.random.seed(0)
+    clean = np.zeros((16, 32, 3))
+    block = ImageBlock(film.size(), len(channels), film.reconstruction_filter())
+    block.clear()
+    for y in range(16):
+        for x in range(32):
+            albedo = 0.2 if x < 16 else 0.8
+            clean[y, x] = albedo
+            rgb = albedo * np.random.exponential(size=(3,))
+            value = list(srgb_to_xyz(rgb)) + [1.0, 1.0] + [albedo] * 3 + [0.0, 0.0, 1.0]
+            block.put([x + 0.5, y + 0.5], value)
+    film.put(block)
+
+    raw = np.array(film.bitmap(raw=True), copy=False)
+    img = np.array(film.bitmap(), copy=False)
+    assert img.shape == (16, 32, 10)
+
+    # The mean absolute error of the noisy pixels is 2/e times the albedo
+    for half in [slice(0, 16), slice(16, 32)]:
+        albedo = clean[0, half.start, 0]
+        assert np.mean(np.abs(img[:, half, :3] - albedo)) < 0.35 * albedo
+        assert ek.allclose(np.mean(img[:, half, :3]), albedo, rtol=0.15)
+
+    # Only the developed color is denoised
+    assert ek.allclose(img[..., 3:], raw[..., [3, 5, 6, 7, 8, 9, 10]], atol=1e-5)
+
+
+def test09_unfiltered_aovs(variant_scalar_rgb, tmpdir):
+    from mitsuba.core.xml import load_string
+    from mitsuba.render import ImageBlock
+    import numpy as np
+
+    """Unfiltered AOVs are accumulated into the pixel containing the samples
+    and averaged by their own sample count. With 'split_aovs', every AOV is
+    written to a separate file."""
+    film = load_string("""<film version="2.0.0" type="hdrfilm">
+            <integer name="width" value="8"/>
+            <integer name="height" value="6"/>
+            <string name="component_format" value="float32"/>
+            <string name="unfiltered_aovs" value="dd"/>
+            <boolean name="split_aovs" value="true"/>
+            <rfilter type="gaussian"/>
+        </film>""")
+    channels = ['X', 'Y', 'Z', 'A', 'W', 'dd.y', 'nn.X', 'nn.Y', 'nn.Z']
+    assert film.unfiltered_channels(channels) == [False] * 5 + [True] + [False] * 3
+    assert film.unfiltered_channels(channels[:5]) == []
+
+    channels.append('W.unfiltered')
+    mask = film.unfiltered_channels(channels)
+    assert mask == [False] * 5 + [True] + [False] * 3 + [True]
+    film.prepare(channels)
+
+    block = ImageBlock(film.size(), len(channels), film.reconstruction_filter())
+    block.set_unfiltered_channels(mask)
+    assert block.has_unfiltered_channels()
+    block.clear()
+    for depth in [2.0, 4.0]:
+        block.put([3.3, 2.6], [1.0, 1.0, 1.0, 1.0, 1.0, depth, 0.0, 0.0, 1.0, 1.0])
+    film.put(block)
+
+    # Only the pixel containing the samples receives the depth and its count
+    raw = np.array(film.bitmap(raw=True), copy=False)
+    assert np.count_nonzero(raw[:, :, 5]) == 1
+    assert np.count_nonzero(raw[:, :, 9]) == 1
+    assert ek.allclose(raw[2, 3, [5, 9]], [6.0, 2.0])
+    assert np.count_nonzero(raw[:, :, 8]) > 1
+
+    # The developed image drops both weight channels and averages the depth
+    img = np.array(film.bitmap(), copy=False)
+    assert img.shape == (6, 8, 8)
+    assert ek.allclose(img[2, 3, 4], 3.0, atol=1e-5)
+    assert ek.allclose(img[2, 3, 7], 1.0, atol=1e-5)
+
+    filename = str(tmpdir.join('layers.exr'))
+    film.set_destination_file(filename)
+    film.develop()
+    for name in ['layers.exr', 'layers_dd.y.exr', 'layers_nn.exr']:
+        assert os.path.exists(str(tmpdir.join(name)))
+
+
+def test10_id_layers(variant_scalar_rgb, tmpdir):
+    from mitsuba.core import Bitmap
+    from mitsuba.core.xml import load_string
+    from mitsuba.render import ImageBlock
+    import numpy as np
+
+    """The (ID, sample count) pairs of an ID layer are merged by ID and written
+    to a Cryptomatte file, ranked by their coverage."""
+    film = load_string("""<film version="2.0.0" type="hdrfilm">
+            <integer name="width" value="8"/>
+            <integer name="height" value="6"/>
+            <rfilter type="gaussian"/>
+        </film>""")
+    film.add_id_layer('obj', '{"a":"3f800000"}')
+    assert film.id_layers() == [('obj', '{"a":"3f800000"}')]
+
+    channels = ['X', 'Y', 'Z', 'A', 'W', 'obj00.R', 'obj00.G', 'obj00.B', 'obj00.A',
+                'W.unfiltered']
+    ids = film.id_channels(channels)
+    assert ids == [0] * 5 + [1] * 4 + [0]
+    assert film.id_channels(channels[:5]) == []
+    mask = film.unfiltered_channels(channels)
+    assert mask == [False] * 5 + [True] * 5
+    film.prepare(channels)
+
+    block = ImageBlock(film.size(), len(channels), film.reconstruction_filter())
+    block.set_unfiltered_channels(mask, ids)
+    block.clear()
+    for id_ in [5.0, 7.0, 7.0]:
+        block.put([3.3, 2.6], [1.0, 1.0, 1.0, 1.0, 1.0, id_, 1.0, 0.0, 0.0, 1.0])
+    # Merging into the film sums the counts of matching IDs
+    film.put(block)
+    film.put(block)
+
+    raw = np.array(film.bitmap(raw=True), copy=False)
+    assert ek.allclose(raw[2, 3, 5:10], [5.0, 2.0, 7.0, 4.0, 6.0])
+
+    # The ID layer isn't part of the developed image
+    assert np.array(film.bitmap(), copy=False).shape == (6, 8, 4)
+
+    film.set_destination_file(str(tmpdir.join('ids.exr')))
+    film.develop()
+    b = Bitmap(str(tmpdir.join('ids_obj.exr')))
+    values = np.array(b, copy=False)[2, 3]
+    pixel = { b.struct_()[i].name : values[i] for i in range(b.channel_count()) }
+    assert ek.allclose([pixel['obj00.R'], pixel['obj00.G'], pixel['obj00.B'],
+                        pixel['obj00.A']], [7.0, 2.0 / 3.0, 5.0, 1.0 / 3.0])
+
+    # Cryptomatte metadata, keyed by the hash of the layer name
+    metadata = b.metadata()
+    keys = [k for k in metadata.property_names() if k.startswith('cryptomatte/')]
+    prefix = keys[0][:keys[0].rfind('/') + 1]
+    assert len(prefix) == len('cryptomatte/') + 8
+    assert metadata[prefix + 'name'] == 'obj'
+    assert metadata[prefix + 'hash'] == 'MurmurHash3_32'
+    assert metadata[prefix + 'conversion'] == 'uint32_to_float32'
+    assert metadata[prefix + 'manifest'] == '{"a":"3f800000"}'
+
+
+def test11_deep(variant_scalar_rgb, tmpdir):
+    from mitsuba.core.xml import load_string
+    import struct
+
+    """Deep films record the samples of the blocks configured by them and write
+    a deep OpenEXR file along with the flat image."""
+    film = load_string("""<film version="2.0.0" type="hdrfilm">
+            <integer name="width" value="4"/>
+            <integer name="height" value="3"/>
+            <boolean name="deep" value="true"/>
+            <integer name="deep_samples" value="4"/>
+            <rfilter type="box"/>
+        </film>""")
+    with pytest.raises(RuntimeError):
+        film.prepare(['X', 'Y', 'Z', 'A', 'W'])
+    film.prepare(['X', 'Y', 'Z', 'A', 'W', 'depth'])
+
+    from mitsuba.render import ImageBlock
+    block = ImageBlock(film.size(), 6, film.reconstruction_filter())
+    film.configure_block(block)
+    assert block.deep_samples() == 4
+    block.clear()
+    block.put([1.5, 1.5], [1, 1, 1, 1, 1, 2.0])
+    block.put([1.5, 1.5], [1, 1, 1, 1, 1, 3.0])
+    film.put(block)
+
+    film.set_destination_file(str(tmpdir.join('deep.exr')))
+    film.develop()
+    assert os.path.exists(str(tmpdir.join('deep.exr')))
+    with open(str(tmpdir.join('deep_deep.exr')), 'rb') as f:
+        magic, version = struct.unpack('<ii', f.read(8))
+    assert magic == 20000630
+    assert version & 0x800  # Deep data
+
+    # Deep output is only written to OpenEXR files
+    with pytest.raises(RuntimeError):
+        load_string("""<film version="2.0.0" type="hdrfilm">
+                <string name="file_format" value="pfm"/>
+                <boolean name="deep" value="true"/>
+            </film>""")
+
+
+@pytest.mark.parametrize('pixel_format', ['rgba', 'xyz', 'y'])
+@pytest.mark.parametrize('component_format', ['float16', 'float32'])
+def test12_develop_gpu(variant_gpu_rgb, pixel_format, component_format):
+    from mitsuba.core import Bitmap, Struct, Float, UInt32, Vector2f, PCG32
+    from mitsuba.core.xml import load_dict
+    from mitsuba.render import ImageBlock
+    import numpy as np
+
+    """The GPU development must match the host conversion of the raw storage"""
+
+    film = load_dict({
+        "type" : "hdrfilm", "width" : 13, "height" : 7,
+        "pixel_format" : pixel_format, "component_format" : component_format,
+        "rfilter" : {"type" : "box"}
+    })
+    film.prepare(['X', 'Y', 'Z', 'A', 'W'])
+
+    count = film.size()[0] * film.size()[1]
+    rng = PCG32(count)
+    idx = ek.arange(UInt32, count)
+    pos = Vector2f(Float(idx % film.size()[0]), Float(idx // film.size()[0])) + .5
+    values = [rng.next_float32() * 2 for k in range(4)] + [rng.next_float32() + .5]
+
+    block = ImageBlock(film.size(), 5, film.reconstruction_filter())
+    block.clear()
+    block.put(pos, values)
+    film.put(block)
+
+    formats = {'rgba' : Bitmap.PixelFormat.RGBA, 'xyz' : Bitmap.PixelFormat.XYZ,
+               'y' : Bitmap.PixelFormat.Y}
+    types = {'float16' : Struct.Type.Float16, 'float32' : Struct.Type.Float32}
+    ref = film.bitmap(raw=True).convert(formats[pixel_format], types[component_format],
+                                        srgb_gamma=False)
+    result = film.bitmap()
+
+    assert result.pixel_format() == ref.pixel_format()
+    assert result.component_format() == ref.component_format()
+    ref, result = np.array(ref, copy=False), np.array(result, copy=False)
+    assert ek.allclose(result.astype(np.float32), ref.astype(np.float32),
+                       rtol=1e-3 if component_format == 'float16' else 1e-5, atol=1e-5)
+
+
+@pytest.mark.parametrize('pixel_format', ['rgb', 'rgba', 'xyza', 'ya'])
+@pytest.mark.parametrize('component_format', ['float16', 'float32'])
+def test13_develop_host(variant_scalar_rgb, pixel_format, component_format):
+    from mitsuba.core import Bitmap, Struct, PCG32
+    from mitsuba.core.xml import load_dict
+    from mitsuba.render import ImageBlock
+    import numpy as np
+
+    """The fused host development must match the generic conversion of the raw storage"""
+
+    film = load_dict({
+        "type" : "hdrfilm", "width" : 13, "height" : 7,
+        "pixel_format" : pixel_format, "component_format" : component_format,
+        "rfilter" : {"type" : "box"}
+    })
+    film.prepare(['X', 'Y', 'Z', 'A', 'W'])
+
+    rng = PCG32()
+    block = ImageBlock(film.size(), 5, film.reconstruction_filter())
+    block.clear()
+    for y in range(film.size()[1]):
+        for x in range(film.size()[0]):
+            values = [rng.next_float32() * 2 for k in range(4)] + [rng.next_float32() + .5]
+            block.put([x + .5, y + .5], values)
+    film.put(block)
+
+    formats = {'rgb' : Bitmap.PixelFormat.RGB, 'rgba' : Bitmap.PixelFormat.RGBA,
+               'xyza' : Bitmap.PixelFormat.XYZA, 'ya' : Bitmap.PixelFormat.YA}
+    types = {'float16' : Struct.Type.Float16, 'float32' : Struct.Type.Float32}
+    ref = film.bitmap(raw=True).convert(formats[pixel_format], types[component_format],
+                                        srgb_gamma=False)
+    result = film.bitmap()
+
+    assert result.pixel_format() == ref.pixel_format()
+    assert result.component_format() == ref.component_format()
+    ref, result = np.array(ref, copy=False), np.array(result, copy=False)
+    assert ek.allclose(result.astype(np.float32), ref.astype(np.float32),
+                       rtol=1e-3 if component_format == 'float16' else 1e-5, atol=1e-5)
+
+
+def test14_half_aovs(variant_scalar_rgb):
+    from mitsuba.core import PCG32
+    from mitsuba.core.xml import load_dict
+    from mitsuba.render import ImageBlock
+    import numpy as np
+
+    """AOVs accumulated in half precision must match the full precision film
+    up to the precision of their storage"""
+
+    channels = ['X', 'Y', 'Z', 'A', 'W', 'dd.y', 'nn.X', 'nn.Y', 'nn.Z', 'W.unfiltered']
+    films = []
+    for half_aovs in ['', 'dd,nn']:
+        film = load_dict({
+            "type" : "hdrfilm", "width" : 11, "height" : 7,
+            "unfiltered_aovs" : "dd", "half_aovs" : half_aovs,
+            "rfilter" : {"type" : "gaussian"}
+        })
+        film.prepare(channels)
+        films.append(film)
+
+    rng = PCG32()
+    mask = films[0].unfiltered_channels(channels)
+    for i in range(3):
+        block = ImageBlock([6, 4], len(channels), films[0].reconstruction_filter())
+        block.set_offset([i * 3, i * 2])
+        block.set_unfiltered_channels(mask)
+        block.clear()
+        for k in range(50):
+            pos = [i * 3 + rng.next_float32() * 6, i * 2 + rng.next_float32() * 4]
+            values = [rng.next_float32() for j in range(4)] + [1.0, 50 + rng.next_float32() * 10] + \
+                     [rng.next_float32() * 2 - 1 for j in range(3)] + [1.0]
+            block.put(pos, values)
+        for film in films:
+            film.put(block)
+
+    ref, result = [np.array(film.bitmap(raw=True), copy=False) for film in films]
+    assert ek.allclose(result[:, :, :5], ref[:, :, :5])
+    assert ek.allclose(result[:, :, 5:], ref[:, :, 5:], rtol=2e-3, atol=1e-3)
+
+    # Snapshots contain all channels in full precision
+    snapshot = films[1].snapshot()
+    assert snapshot.channel_count() == len(channels)
+    films[1].restore(snapshot)
+    assert ek.allclose(np.array(films[1].bitmap(raw=True), copy=False), result, rtol=1e-3)
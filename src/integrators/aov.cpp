@@ -1,5 +1,11 @@
+#include <mitsuba/core/hash.h>
+#include <mitsuba/render/bsdf.h>
+#include <mitsuba/render/film.h>
 #include <mitsuba/render/integrator.h>
 #include <mitsuba/render/records.h>
+#include <mitsuba/render/scene.h>
+#include <mitsuba/render/sensor.h>
+#include <unordered_map>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -16,6 +22,10 @@ Arbitrary Output Variables integrator (:monosp:`aov`)
  * - aovs
    - |string|
    - List of :monosp:`<name>:<type>` pairs denoting the enabled AOVs.
+ * - id_ranks
+   - |int|
+   - Number of (ID, coverage) pairs stored per pixel by the :monosp:`object_id` and
+     :monosp:`material_id` AOVs, rounded up to an even number. (Default: 6)
  * - (Nested plugin)
    - :paramtype:`integrator`
    - Sub-integrators (can have more than one) which will be sampled along the AOV integrator. Their
@@ -58,6 +68,22 @@ Currently, the following AOVs types are available:
     - :monosp:`sh_normal`: Shading normal.
     - :monosp:`dp_du`, :monosp:`dp_dv`: Position partials wrt. the UV parameterization.
     - :monosp:`duv_dx`, :monosp:`duv_dy`: UV partials wrt. changes in screen-space.
+    - :monosp:`albedo`: Directional albedo of the BSDF (in RGB), estimated from one BSDF sample.
+    - :monosp:`object_id`, :monosp:`material_id`: Cryptomatte ID layers of the shapes and of
+      their BSDFs (scalar variants only, see below).
+
+The :monosp:`albedo` and :monosp:`sh_normal` AOVs are the features that guide the denoiser of
+the :ref:`hdrfilm <film-hdrfilm>` plugin. AOVs that should not be blended by the reconstruction
+filter (e.g. depth) can be listed in its :monosp:`unfiltered_aovs` parameter.
+
+The ID AOVs identify the visible shape or BSDF by the MurmurHash3 hash of its :monosp:`id`,
+following the `Cryptomatte <https://github.com/Psyop/Cryptomatte>`_ specification. Every pixel
+keeps :monosp:`id_ranks` (ID, coverage) pairs in the channels
+:monosp:`<name>00.R`, :monosp:`<name>00.G`, ..., where the coverage of an ID is the fraction of
+the pixel's samples that hit it (i.e. the layers are not filtered). The
+:ref:`hdrfilm <film-hdrfilm>` plugin writes each layer, ranked by coverage and along with its
+manifest, to a separate single precision OpenEXR file named :monosp:`<filename>_<name>.exr`,
+which can be loaded by the usual compositing tools to extract mattes of individual objects.
 
  */
 
@@ -65,7 +91,7 @@ template <typename Float, typename Spectrum>
 class AOVIntegrator final : public SamplingIntegrator<Float, Spectrum> {
 public:
     MTS_IMPORT_BASE(SamplingIntegrator)
-    MTS_IMPORT_TYPES(Scene, Sampler, Medium)
+    MTS_IMPORT_TYPES(Scene, Sampler, Medium, BSDFPtr)
 
     enum class Type {
         Depth,
@@ -77,10 +103,16 @@ public:
         dPdV,
         dUVdx,
         dUVdy,
+        Albedo,
+        ObjectID,
+        MaterialID,
         IntegratorRGBA
     };
 
     AOVIntegrator(const Properties &props) : Base(props) {
+        m_id_ranks = props.size_("id_ranks", 6);
+        m_id_ranks += m_id_ranks % 2;
+
         std::vector<std::string> tokens = string::tokenize(props.string("aovs"));
 
         for (const std::string &token: tokens) {
@@ -129,6 +161,22 @@ public:
                 m_aov_types.push_back(Type::dUVdy);
                 m_aov_names.push_back(item[0] + ".U");
                 m_aov_names.push_back(item[0] + ".V");
+            } else if (item[1] == "albedo") {
+                m_aov_types.push_back(Type::Albedo);
+                m_aov_names.push_back(item[0] + ".R");
+                m_aov_names.push_back(item[0] + ".G");
+                m_aov_names.push_back(item[0] + ".B");
+            } else if (item[1] == "object_id" || item[1] == "material_id") {
+                if constexpr (is_array_v<Float>)
+                    Throw("The \"%s\" AOV is only supported in scalar variants!", item[1]);
+                m_aov_types.push_back(item[1] == "object_id" ? Type::ObjectID : Type::MaterialID);
+                m_id_names.push_back(item[0]);
+                // Two (ID, coverage) pairs per group of channels
+                for (size_t k = 0; k < m_id_ranks / 2; ++k) {
+                    std::string prefix = tfm::format("%s%02i.", item[0], k);
+                    for (const char *c : { "R", "G", "B", "A" })
+                        m_aov_names.push_back(prefix + c);
+                }
             } else {
                 Throw("Invalid AOV type \"%s\"!", item[1]);
             }
@@ -164,7 +212,8 @@ public:
         std::pair<Spectrum, Mask> result { 0.f, false };
 
         SurfaceInteraction3f si = scene->ray_intersect(ray, active);
-        si[!si.is_valid()] = zero<SurfaceInteraction3f>();
+        Mask valid = si.is_valid();
+        si[!valid] = zero<SurfaceInteraction3f>();
         size_t ctr = 0;
 
         for (size_t i = 0; i < m_aov_types.size(); ++i) {
@@ -218,25 +267,43 @@ public:
                     *aovs++ = si.duv_dy.y();
                     break;
 
+                case Type::Albedo: {
+                        // The expected weight of a BSDF sample is the directional albedo
+                        Color3f rgb(0.f);
+                        if (any_or<true>(valid)) {
+                            BSDFContext ctx;
+                            BSDFPtr bsdf = si.bsdf();
+                            auto [bs, bsdf_val] = bsdf->sample(ctx, si, sampler->next_1d(valid),
+                                                               sampler->next_2d(valid), valid);
+                            rgb = select(valid, to_rgb(bsdf_val, ray.wavelengths, valid), 0.f);
+                        }
+                        *aovs++ = rgb.r(); *aovs++ = rgb.g(); *aovs++ = rgb.b();
+                    }
+                    break;
+
+                case Type::ObjectID:
+                case Type::MaterialID: {
+                        if constexpr (!is_array_v<Float>) {
+                            const void *key = nullptr;
+                            if (valid)
+                                key = m_aov_types[i] == Type::ObjectID
+                                          ? (const void *) si.shape
+                                          : (const void *) si.shape->bsdf();
+                            auto it = m_ids.find(key);
+                            *aovs++ = it != m_ids.end() ? it->second : 0.f;
+                            *aovs++ = it != m_ids.end() ? 1.f : 0.f;
+                            for (size_t k = 2; k < 2 * m_id_ranks; ++k)
+                                *aovs++ = 0.f;
+                        }
+                    }
+                    break;
+
                 case Type::IntegratorRGBA: {
                         std::pair<Spectrum, Mask> result_sub =
                             m_integrators[ctr].first->sample(scene, sampler, ray, medium, aovs, active);
                         aovs += m_integrators[ctr].second;
 
-                        UnpolarizedSpectrum spec_u = depolarize(result_sub.first);
-
-                        Color3f rgb;
-                        if constexpr (is_monochromatic_v<Spectrum>) {
-                            rgb = spec_u.x();
-                        } else if constexpr (is_rgb_v<Spectrum>) {
-                            rgb = spec_u;
-                        } else {
-                            static_assert(is_spectral_v<Spectrum>);
-                            /// Note: this assumes that sensor used sample_rgb_spectrum() to generate 'ray.wavelengths'
-                            auto pdf = pdf_rgb_spectrum(ray.wavelengths);
-                            spec_u *= select(neq(pdf, 0.f), rcp(pdf), 0.f);
-                            rgb = xyz_to_srgb(spectrum_to_xyz(spec_u, ray.wavelengths, active));
-                        }
+                        Color3f rgb = to_rgb(result_sub.first, ray.wavelengths, active);
 
                         *aovs++ = rgb.r(); *aovs++ = rgb.g(); *aovs++ = rgb.b();
                         *aovs++ = select(result_sub.second, Float(1.f), Float(0.f));
@@ -257,6 +324,46 @@ public:
         return m_aov_names;
     }
 
+    bool render(Scene *scene, Sensor *sensor) override {
+        if constexpr (!is_array_v<Float>) {
+            if (!m_id_names.empty()) {
+                // Hash the IDs of the shapes and BSDFs and register the ID layers with the film
+                m_ids.clear();
+                std::string manifests[2];
+                auto add_id = [&](const void *key, const std::string &id, std::string &manifest) {
+                    if (!key || m_ids.count(key))
+                        return;
+                    uint32_t hash = murmur_hash3(id);
+                    m_ids[key] = hash_to_float(hash);
+                    std::string escaped;
+                    for (char c : id) {
+                        if (c == '"' || c == '\\')
+                            escaped += '\\';
+                        escaped += c;
+                    }
+                    manifest += tfm::format("%s\"%s\":\"%08x\"",
+                                            manifest.empty() ? "" : ",", escaped, hash);
+                };
+                for (auto &shape : scene->shapes()) {
+                    add_id(shape.get(), shape->id(), manifests[0]);
+                    add_id(shape->bsdf(), shape->bsdf() ? shape->bsdf()->id() : "",
+                           manifests[1]);
+                }
+
+                size_t ctr = 0;
+                for (Type type : m_aov_types) {
+                    if (type != Type::ObjectID && type != Type::MaterialID)
+                        continue;
+                    sensor->film()->add_id_layer(
+                        m_id_names[ctr++],
+                        "{" + manifests[type == Type::ObjectID ? 0 : 1] + "}");
+                }
+            }
+        }
+
+        return Base::render(scene, sensor);
+    }
+
     void traverse(TraversalCallback *callback) override {
         for (size_t i = 0; i < m_integrators.size(); ++i)
             callback->put_object("integrator_" + std::to_string(i), m_integrators[i].first.get());
@@ -266,6 +373,7 @@ public:
         std::ostringstream oss;
         oss << "Scene[" << std::endl
             << "  aovs = " << m_aov_names << "," << std::endl
+            << "  id_ranks = " << m_id_ranks << "," << std::endl
             << "  integrators = [" << std::endl;
         for (size_t i = 0; i < m_integrators.size(); ++i) {
             oss << "    " << string::indent(m_integrators[i].first, 4);
@@ -279,10 +387,43 @@ public:
     }
 
     MTS_DECLARE_CLASS()
+private:
+    /// Reinterpret a Cryptomatte ID hash as a float, avoiding denormals, infinities and NaNs
+    static ScalarFloat hash_to_float(uint32_t hash) {
+        uint32_t exponent = (hash >> 23) & 0xFF;
+        if (exponent == 0 || exponent == 0xFF)
+            hash ^= 1u << 23;
+        return (ScalarFloat) memcpy_cast<float>(hash);
+    }
+
+    /// Convert a (possibly spectral or polarized) value into linear sRGB
+    Color3f to_rgb(const Spectrum &value, const Wavelength &wavelengths, Mask active) const {
+        UnpolarizedSpectrum spec_u = depolarize(value);
+
+        Color3f rgb;
+        if constexpr (is_monochromatic_v<Spectrum>) {
+            rgb = spec_u.x();
+        } else if constexpr (is_rgb_v<Spectrum>) {
+            rgb = spec_u;
+        } else {
+            static_assert(is_spectral_v<Spectrum>);
+            /// Note: this assumes that sensor used sample_rgb_spectrum() to generate 'ray.wavelengths'
+            auto pdf = pdf_rgb_spectrum(wavelengths);
+            spec_u *= select(neq(pdf, 0.f), rcp(pdf), 0.f);
+            rgb = xyz_to_srgb(spectrum_to_xyz(spec_u, wavelengths, active));
+        }
+        return rgb;
+    }
+
 private:
     std::vector<Type> m_aov_types;
     std::vector<std::string> m_aov_names;
     std::vector<std::pair<ref<Base>, size_t>> m_integrators;
+    /// Names of the ID AOVs and number of (ID, coverage) pairs per pixel
+    std::vector<std::string> m_id_names;
+    size_t m_id_ranks;
+    /// Float-converted ID hashes of the shapes and BSDFs of the scene
+    std::unordered_map<const void *, ScalarFloat> m_ids;
 };
 
 MTS_IMPLEMENT_CLASS_VARIANT(AOVIntegrator, SamplingIntegrator)
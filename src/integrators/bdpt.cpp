@@ -0,0 +1,650 @@
+#include <mitsuba/core/distr_1d.h>
+#include <mitsuba/core/ray.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/profiler.h>
+#include <mitsuba/core/spectrum.h>
+#include <mitsuba/core/warp.h>
+#include <mitsuba/render/bsdf.h>
+#include <mitsuba/render/emitter.h>
+#include <mitsuba/render/film.h>
+#include <mitsuba/render/imageblock.h>
+#include <mitsuba/render/integrator.h>
+#include <mitsuba/render/records.h>
+#include <mitsuba/render/scene.h>
+#include <mitsuba/render/sensor.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+
+.. _integrator-bdpt:
+
+Bidirectional path tracer (:monosp:`bdpt`)
+------------------------------------------
+
+.. pluginparameters::
+
+ * - max_depth
+   - |int|
+   - Specifies the longest path depth in the generated output image (where -1 corresponds to
+     :math:`\infty`). A value of 1 will only render directly visible light sources. 2 will lead
+     to single-bounce (direct-only) illumination, and so on. (Default: -1)
+ * - rr_depth
+   - |int|
+   - Specifies the minimum path depth, after which the implementation will start to use the
+     *russian roulette* path termination criterion. (Default: 5)
+ * - hide_emitters
+   - |bool|
+   - Hide directly visible emitters. (Default: no, i.e. |false|)
+
+This integrator implements bidirectional path tracing (Veach and Guibas 1995). For every
+camera sample, it traces a subpath from the sensor and another one from an emitter (whose
+origin is sampled using the emitter selection probabilities of the scene and, for area lights,
+uniformly on the surface of the emitting shape). Every vertex of the camera subpath is then
+connected to every vertex of the light subpath, and the resulting estimators for paths of the
+same length are combined using multiple importance sampling with the balance heuristic. This
+includes the strategies of the :ref:`path tracer <integrator-path>` (unidirectional sampling
+and emitter sampling), but also *light tracing*, where the vertices of the light subpath are
+connected to the sensor.
+
+Bidirectional path tracing is considerably more robust than path tracing in scenes where light
+reaches the visible surfaces along paths that are hard to find from the sensor, e.g. caustics
+or scenes that are lit by small emitters that are mostly hidden behind other objects.
+
+The light tracing contributions usually fall onto a different pixel than the camera sample that
+generated them. Every render thread splats them into its own buffer covering the film (see
+``Film::splat_block()``), and the buffers are added to the film at the end of every pass.
+Since splats are normalized by the sample weights of the film, they require the sample count
+of all pixels to be the same.
+
+The vertices of both subpaths are stored in per-thread arrays that are only allocated once,
+hence the cost of the many connections is dominated by the evaluation of the BSDFs and the
+visibility tests.
+
+.. note:: This integrator is only available in the scalar (non-polarized) variants. It requires
+   a :ref:`perspective <sensor-perspective>` sensor and does not support environment or
+   directional emitters, participating media, adaptive sampling and distributed rendering.
+
+ */
+
+template <typename Float, typename Spectrum>
+class BidirectionalPathIntegrator : public MonteCarloIntegrator<Float, Spectrum> {
+public:
+    MTS_IMPORT_BASE(MonteCarloIntegrator, m_max_depth, m_rr_depth, m_hide_emitters,
+                    m_adaptive_threshold, m_error_target, m_distributed_role)
+    MTS_IMPORT_TYPES(Scene, Sensor, Sampler, Medium, Emitter, EmitterPtr, Shape, BSDF, BSDFPtr)
+
+    // =============================================================
+    //! @{ \name Subpath vertices
+    // =============================================================
+
+    enum class VertexType : uint8_t { Camera, Light, Surface };
+
+    /// Vertex of a camera or light subpath
+    struct Vertex {
+        /// Location (and local frame for surface vertices)
+        SurfaceInteraction3f si;
+
+        /// Emitter of light vertices and of emissive surfaces
+        const Emitter *emitter;
+
+        /// Throughput of the subpath up to (and including) this vertex
+        Spectrum beta;
+
+        /// Area densities of sampling this vertex from either end of the path
+        Float pdf_fwd, pdf_rev;
+
+        VertexType type;
+
+        /// Was the next direction sampled from a Dirac delta distribution?
+        bool delta;
+
+        bool on_surface() const { return any(neq(si.n, 0.f)); }
+
+        bool is_light() const { return emitter != nullptr; }
+
+        bool is_delta_light() const {
+            return type == VertexType::Light &&
+                   has_flag(emitter->flags(), EmitterFlags::DeltaPosition);
+        }
+
+        bool is_connectible() const {
+            return type != VertexType::Surface ||
+                   has_flag(si.bsdf()->flags(), BSDFFlags::Smooth);
+        }
+    };
+
+    //! @}
+    // =============================================================
+
+    BidirectionalPathIntegrator(const Properties &props) : Base(props) {
+        if constexpr (is_array_v<Float> || is_polarized_v<Spectrum>)
+            Throw("The bidirectional path tracer is only available in scalar "
+                  "(non-polarized) variants!");
+    }
+
+    bool render(Scene *scene, Sensor *sensor) override {
+        if (m_adaptive_threshold > 0.f)
+            Throw("The bidirectional path tracer does not support adaptive sampling!");
+        if (m_error_target > 0.f)
+            Throw("The bidirectional path tracer does not support error targets!");
+        if (m_distributed_role != DistributedRole::None)
+            Throw("The bidirectional path tracer does not support distributed rendering!");
+
+        std::vector<ScalarFloat> pmf;
+        for (Emitter *emitter : scene->emitters()) {
+            if (has_flag(emitter->flags(), EmitterFlags::Infinite) ||
+                has_flag(emitter->flags(), EmitterFlags::DeltaDirection))
+                Throw("The bidirectional path tracer does not support environment or "
+                      "directional emitters!");
+            if (!has_flag(emitter->flags(), EmitterFlags::DeltaPosition) && !emitter->shape())
+                Throw("The bidirectional path tracer only supports point-like emitters and "
+                      "emitters that are attached to a shape!");
+            pmf.push_back(emitter->selection_pmf());
+        }
+
+        if (sensor->medium())
+            Throw("The bidirectional path tracer does not support participating media!");
+        for (Shape *shape : scene->shapes()) {
+            if (shape->is_medium_transition())
+                Throw("The bidirectional path tracer does not support participating media!");
+        }
+
+        if (!pmf.empty())
+            m_emitter_distr = DiscreteDistribution<Float>(pmf.data(), pmf.size());
+
+        m_sensor = sensor;
+        bool result = Base::render(scene, sensor);
+        m_sensor = nullptr;
+        return result;
+    }
+
+    std::pair<Spectrum, Mask> sample(const Scene *scene,
+                                     Sampler *sampler,
+                                     const RayDifferential3f &ray,
+                                     const Medium * /* medium */,
+                                     Float * /* aovs */,
+                                     Mask active) const override {
+        MTS_MASKED_FUNCTION(ProfilerPhase::SamplingIntegratorSample, active);
+
+        if constexpr (!is_array_v<Float> && !is_polarized_v<Spectrum>) {
+            if (!active)
+                return { Spectrum(0.f), false };
+            return sample_bdpt(scene, sampler, ray);
+        } else {
+            ENOKI_MARK_USED(scene);
+            ENOKI_MARK_USED(sampler);
+            ENOKI_MARK_USED(ray);
+            Throw("The bidirectional path tracer is only available in scalar "
+                  "(non-polarized) variants!");
+        }
+    }
+
+    /// Scalar implementation of \ref sample()
+    std::pair<Spectrum, Mask> sample_bdpt(const Scene *scene, Sampler *sampler,
+                                          const RayDifferential3f &ray) const {
+        if (unlikely(!m_sensor))
+            Throw("The bidirectional path tracer must be invoked through render()!");
+
+        /* The subpaths are kept in per-thread arrays that are reused by all
+           samples, which avoids any allocations once they reached their
+           maximum length */
+        static thread_local std::vector<Vertex> camera_path, light_path;
+        camera_path.clear();
+        light_path.clear();
+
+        size_t max_depth = (uint32_t) m_max_depth;
+        generate_camera_subpath(scene, sampler, ray, max_depth + 1, camera_path);
+        generate_light_subpath(scene, sampler, ray, max_depth, light_path);
+
+        // Spectral sampling weight of the splats (applied by the caller otherwise)
+        Spectrum splat_weight(1.f);
+        if constexpr (is_spectral_v<Spectrum>)
+            splat_weight = rcp(pdf_rgb_spectrum(ray.wavelengths));
+
+        Spectrum result(0.f);
+        for (size_t t = 1; t <= camera_path.size(); ++t) {
+            for (size_t s = 0; s <= light_path.size(); ++s) {
+                // The sensor can't be intersected, and paths should have 'max_depth' edges
+                if ((s == 1 && t == 1) || s + t < 2 || s + t - 1 > max_depth)
+                    continue;
+                if (s == 0 && t == 2 && m_hide_emitters)
+                    continue;
+
+                Point2f splat_pos;
+                Spectrum value = connect(scene, sampler, light_path, camera_path, s, t,
+                                         splat_pos);
+                if (t != 1)
+                    result += value;
+                else if (any(neq(value, 0.f)))
+                    m_sensor->film()->splat_block()->splat(splat_pos, ray.wavelengths,
+                                                           value * splat_weight);
+            }
+        }
+
+        return { result, camera_path.size() > 1 };
+    }
+
+    std::string to_string() const override {
+        return tfm::format("BidirectionalPathIntegrator[\n"
+            "  max_depth = %i,\n"
+            "  rr_depth = %i\n"
+            "]", m_max_depth, m_rr_depth);
+    }
+
+    MTS_DECLARE_CLASS()
+
+protected:
+    // =============================================================
+    //! @{ \name Subpath generation
+    // =============================================================
+
+    void generate_camera_subpath(const Scene *scene, Sampler *sampler, const Ray3f &ray,
+                                 size_t max_vertices, std::vector<Vertex> &path) const {
+        Vertex camera = empty_vertex(VertexType::Camera, ray.wavelengths, ray.time);
+        camera.si.p  = ray.o;
+        camera.beta  = 1.f;
+        path.push_back(camera);
+
+        Float pdf_dir = m_sensor->pdf_ray(position_sample(camera), ray.d).second;
+        random_walk(scene, sampler, ray, Spectrum(1.f), pdf_dir, max_vertices,
+                    TransportMode::Radiance, path);
+    }
+
+    void generate_light_subpath(const Scene *scene, Sampler *sampler, const Ray3f &camera_ray,
+                                size_t max_vertices, std::vector<Vertex> &path) const {
+        if (scene->emitters().empty() || max_vertices == 0)
+            return;
+
+        auto [index, emitter_pmf] = m_emitter_distr.sample_pmf(sampler->next_1d());
+        const Emitter *emitter = scene->emitters()[index].get();
+
+        Vertex light = empty_vertex(VertexType::Light, camera_ray.wavelengths, camera_ray.time);
+        light.emitter = emitter;
+
+        Ray3f ray;
+        Spectrum beta;
+        Float pdf_dir;
+        if (has_flag(emitter->flags(), EmitterFlags::DeltaPosition)) {
+            ray = emitter->sample_ray(camera_ray.time, sampler->next_1d(), sampler->next_2d(),
+                                      sampler->next_2d()).first;
+            light.si.p = ray.o;
+
+            /* The emitter samples its own wavelengths, evaluate the
+               intensity at the wavelengths of the camera subpath instead */
+            Interaction3f it = zero<Interaction3f>();
+            it.p           = ray(1.f);
+            it.time        = ray.time;
+            it.wavelengths = camera_ray.wavelengths;
+            Spectrum intensity = emitter->sample_direction(it, sampler->next_2d()).second;
+
+            light.pdf_fwd = emitter_pmf;
+            light.beta    = intensity * rcp(emitter_pmf);
+            pdf_dir       = emitter->pdf_ray(position_sample(light), ray.d).second;
+            beta          = intensity * rcp(emitter_pmf * pdf_dir);
+        } else {
+            // Uniformly sample the shape, then a cosine-weighted direction
+            PositionSample3f ps = emitter->shape()->sample_position(camera_ray.time,
+                                                                    sampler->next_2d());
+            light.si      = SurfaceInteraction3f(ps, camera_ray.wavelengths);
+            light.pdf_fwd = ps.pdf * emitter_pmf;
+
+            Vector3f local = warp::square_to_cosine_hemisphere(sampler->next_2d());
+            pdf_dir = warp::square_to_cosine_hemisphere_pdf(local);
+            light.si.wi = local;
+            Spectrum radiance = emitter->eval(light.si);
+
+            light.beta = radiance * rcp(light.pdf_fwd);
+            beta       = radiance * math::Pi<Float> * rcp(light.pdf_fwd);
+            ray        = light.si.spawn_ray(light.si.to_world(local));
+        }
+
+        path.push_back(light);
+        if (!(pdf_dir > 0.f) || all(eq(beta, 0.f)))
+            return;
+
+        random_walk(scene, sampler, ray, beta, pdf_dir, max_vertices,
+                    TransportMode::Importance, path);
+    }
+
+    /**
+     * \brief Extend a subpath by sampling the BSDFs at its vertices
+     *
+     * \param pdf_dir
+     *     Solid angle density of the direction of \c ray at the last vertex
+     *     of \c path
+     */
+    void random_walk(const Scene *scene, Sampler *sampler, Ray3f ray, Spectrum beta,
+                     Float pdf_dir, size_t max_vertices, TransportMode mode,
+                     std::vector<Vertex> &path) const {
+        BSDFContext ctx(mode);
+        Float eta = 1.f;
+
+        while (path.size() < max_vertices) {
+            SurfaceInteraction3f si = scene->ray_intersect(ray);
+            if (!si.is_valid())
+                break;
+
+            Vertex vertex;
+            vertex.si      = si;
+            vertex.emitter = si.emitter(scene);
+            vertex.beta    = beta;
+            vertex.pdf_fwd = convert_density(pdf_dir, path.back(), vertex);
+            vertex.pdf_rev = 0.f;
+            vertex.type    = VertexType::Surface;
+            vertex.delta   = false;
+            path.push_back(vertex);
+
+            if (path.size() >= max_vertices)
+                break;
+
+            BSDFPtr bsdf = si.bsdf(ray);
+            auto [bs, bsdf_val] = bsdf->sample(ctx, si, sampler->next_1d(), sampler->next_2d());
+            if (all(eq(bsdf_val, 0.f)) || bs.pdf <= 0.f)
+                break;
+
+            Vector3f wo = si.to_world(bs.wo);
+            if (mode == TransportMode::Importance)
+                bsdf_val *= shading_normal_correction(si, wo);
+
+            beta *= bsdf_val;
+            eta *= bs.eta;
+            pdf_dir = bs.pdf;
+
+            // Density of sampling the opposite direction
+            SurfaceInteraction3f si_rev(si);
+            si_rev.wi = bs.wo;
+            Float pdf_rev = bsdf->pdf(ctx, si_rev, si.wi);
+
+            if (has_flag(bs.sampled_type, BSDFFlags::Delta)) {
+                path.back().delta = true;
+                pdf_dir = pdf_rev = 0.f;
+            }
+
+            size_t n = path.size();
+            path[n - 2].pdf_rev = convert_density(pdf_rev, path[n - 1], path[n - 2]);
+
+            // Russian roulette (see the path tracer)
+            if ((int) n - 1 > m_rr_depth) {
+                Float q = min(hmax(beta) * sqr(eta), .95f);
+                if (sampler->next_1d() >= q)
+                    break;
+                beta *= rcp(q);
+            }
+
+            ray = si.spawn_ray(wo);
+        }
+    }
+
+    //! @}
+    // =============================================================
+
+    // =============================================================
+    //! @{ \name Connection strategies
+    // =============================================================
+
+    /**
+     * \brief Evaluate the MIS-weighted contribution of the path that
+     * connects the first \c s light vertices to the first \c t camera
+     * vertices
+     *
+     * \param splat_pos
+     *     Set to the film position of the contribution when <tt>t == 1</tt>
+     */
+    Spectrum connect(const Scene *scene, Sampler *sampler, std::vector<Vertex> &light_path,
+                     std::vector<Vertex> &camera_path, size_t s, size_t t,
+                     Point2f &splat_pos) const {
+        Spectrum value(0.f);
+        Vertex sampled;
+
+        if (s == 0) {
+            // The camera subpath hit an emitter
+            const Vertex &pt = camera_path[t - 1];
+            if (pt.is_light())
+                value = pt.beta * pt.emitter->eval(pt.si);
+        } else if (t == 1) {
+            // Connect a light vertex to the sensor
+            const Vertex &qs = light_path[s - 1];
+            if (!qs.is_connectible())
+                return 0.f;
+
+            auto [ds, importance] = m_sensor->sample_direction(qs.si, sampler->next_2d());
+            if (ds.pdf <= 0.f || all(eq(importance, 0.f)))
+                return 0.f;
+
+            sampled = empty_vertex(VertexType::Camera, qs.si.wavelengths, ds.time);
+            sampled.si.p = ds.p;
+            sampled.beta = importance;
+            splat_pos = ds.uv;
+
+            value = qs.beta * f(qs, sampled, TransportMode::Importance) * sampled.beta;
+            if (any(neq(value, 0.f)) && scene->ray_test(qs.si.spawn_ray_to(ds.p)))
+                return 0.f;
+        } else if (s == 1) {
+            // Emitter sampling at a camera vertex
+            const Vertex &pt = camera_path[t - 1];
+            if (!pt.is_connectible())
+                return 0.f;
+
+            auto [ds, spec] = scene->sample_emitter_direction(pt.si, sampler->next_2d(), true);
+            if (ds.pdf <= 0.f || all(eq(spec, 0.f)))
+                return 0.f;
+
+            sampled = empty_vertex(VertexType::Light, pt.si.wavelengths, ds.time);
+            sampled.si.p        = ds.p;
+            sampled.si.n        = ds.n;
+            sampled.si.sh_frame = Frame3f(ds.n);
+            sampled.si.uv       = ds.uv;
+            sampled.emitter     = reinterpret_array<EmitterPtr>(ds.object);
+            sampled.beta        = spec;
+            sampled.pdf_fwd     = pdf_light_origin(sampled);
+
+            value = pt.beta * f(pt, sampled, TransportMode::Radiance) * sampled.beta;
+        } else {
+            // Connect two subpath vertices with a deterministic edge
+            const Vertex &qs = light_path[s - 1], &pt = camera_path[t - 1];
+            if (!qs.is_connectible() || !pt.is_connectible())
+                return 0.f;
+
+            value = qs.beta * f(qs, pt, TransportMode::Importance) *
+                    f(pt, qs, TransportMode::Radiance) * pt.beta *
+                    rcp(squared_norm(qs.si.p - pt.si.p));
+            if (any(neq(value, 0.f)) && scene->ray_test(qs.si.spawn_ray_to(pt.si.p)))
+                return 0.f;
+        }
+
+        if (all(eq(value, 0.f)))
+            return 0.f;
+
+        return value * mis_weight(light_path, camera_path, sampled, s, t);
+    }
+
+    /**
+     * \brief Balance heuristic weight of the (s, t) strategy
+     *
+     * Walks along the path and accumulates the ratios between the densities
+     * of the other strategies that could have produced it and the one of the
+     * current strategy (Veach's thesis, Section 10.2). The affected vertices
+     * are temporarily updated to reflect the connection.
+     */
+    Float mis_weight(std::vector<Vertex> &light_path, std::vector<Vertex> &camera_path,
+                     const Vertex &sampled, size_t s, size_t t) const {
+        if (s + t == 2)
+            return 1.f;
+
+        auto remap0 = [](Float value) { return value != 0.f ? value : 1.f; };
+
+        Vertex *qs       = s > 0 ? &light_path[s - 1] : nullptr,
+               *pt       = t > 0 ? &camera_path[t - 1] : nullptr,
+               *qs_minus = s > 1 ? &light_path[s - 2] : nullptr,
+               *pt_minus = t > 1 ? &camera_path[t - 2] : nullptr;
+
+        // Backup of the vertices that are modified below
+        Vertex qs_backup, pt_backup;
+        Float qs_minus_pdf_rev = 0.f, pt_minus_pdf_rev = 0.f;
+        if (qs) qs_backup = *qs;
+        if (pt) pt_backup = *pt;
+        if (qs_minus) qs_minus_pdf_rev = qs_minus->pdf_rev;
+        if (pt_minus) pt_minus_pdf_rev = pt_minus->pdf_rev;
+
+        // Substitute the vertex that was sampled by the s = 1 or t = 1 strategies
+        if (s == 1)
+            *qs = sampled;
+        else if (t == 1)
+            *pt = sampled;
+
+        // The connection vertices are never sampled from a Dirac delta distribution
+        if (pt) pt->delta = false;
+        if (qs) qs->delta = false;
+
+        // Reverse densities of the vertices next to the connection
+        if (pt)
+            pt->pdf_rev = s > 0 ? pdf(*qs, qs_minus, *pt) : pdf_light_origin(*pt);
+        if (pt_minus)
+            pt_minus->pdf_rev = s > 0 ? pdf(*pt, qs, *pt_minus) : pdf_light(*pt, *pt_minus);
+        if (qs)
+            qs->pdf_rev = pdf(*pt, pt_minus, *qs);
+        if (qs_minus)
+            qs_minus->pdf_rev = pdf(*qs, pt, *qs_minus);
+
+        Float sum_ri = 0.f, ri = 1.f;
+        for (size_t i = t - 1; i > 0; --i) {
+            ri *= remap0(camera_path[i].pdf_rev) / remap0(camera_path[i].pdf_fwd);
+            if (!camera_path[i].delta && !camera_path[i - 1].delta)
+                sum_ri += ri;
+        }
+
+        ri = 1.f;
+        for (size_t i = s; i-- > 0;) {
+            ri *= remap0(light_path[i].pdf_rev) / remap0(light_path[i].pdf_fwd);
+            bool delta_light = i > 0 ? light_path[i - 1].delta : light_path[0].is_delta_light();
+            if (!light_path[i].delta && !delta_light)
+                sum_ri += ri;
+        }
+
+        if (qs) *qs = qs_backup;
+        if (pt) *pt = pt_backup;
+        if (qs_minus) qs_minus->pdf_rev = qs_minus_pdf_rev;
+        if (pt_minus) pt_minus->pdf_rev = pt_minus_pdf_rev;
+
+        return rcp(1.f + sum_ri);
+    }
+
+    //! @}
+    // =============================================================
+
+    // =============================================================
+    //! @{ \name Vertex densities and BSDFs
+    // =============================================================
+
+    /// Evaluate the (cosine-weighted) BSDF at \c v towards \c next
+    Spectrum f(const Vertex &v, const Vertex &next, TransportMode mode) const {
+        if (v.type != VertexType::Surface)
+            return 1.f;
+
+        Vector3f wo = normalize(next.si.p - v.si.p);
+        Spectrum value = v.si.bsdf()->eval(BSDFContext(mode), v.si, v.si.to_local(wo));
+        if (mode == TransportMode::Importance)
+            value *= shading_normal_correction(v.si, wo);
+        return value;
+    }
+
+    /**
+     * \brief Area density of sampling \c next from \c v, given that \c v was
+     * reached from \c prev (which is \c nullptr for the end points)
+     */
+    Float pdf(const Vertex &v, const Vertex *prev, const Vertex &next) const {
+        if (v.type == VertexType::Light)
+            return pdf_light(v, next);
+
+        Vector3f wn = normalize(next.si.p - v.si.p);
+        Float pdf_dir;
+        if (v.type == VertexType::Camera) {
+            pdf_dir = m_sensor->pdf_ray(position_sample(v), wn).second;
+        } else {
+            Assert(prev);
+            SurfaceInteraction3f si(v.si);
+            si.wi = si.to_local(normalize(prev->si.p - v.si.p));
+            pdf_dir = si.bsdf()->pdf(BSDFContext(), si, si.to_local(wn));
+        }
+
+        return convert_density(pdf_dir, v, next);
+    }
+
+    /// Area density of emitting light from the emitter at \c v towards \c next
+    Float pdf_light(const Vertex &v, const Vertex &next) const {
+        Vector3f d = normalize(next.si.p - v.si.p);
+        Float pdf_dir;
+        if (has_flag(v.emitter->flags(), EmitterFlags::DeltaPosition))
+            pdf_dir = v.emitter->pdf_ray(position_sample(v), d).second;
+        else
+            pdf_dir = max(dot(v.si.sh_frame.n, d), 0.f) * math::InvPi<Float>;
+        return convert_density(pdf_dir, v, next);
+    }
+
+    /// Area density of sampling \c v as the origin of a light subpath
+    Float pdf_light_origin(const Vertex &v) const {
+        ScalarFloat pmf = v.emitter->selection_pmf();
+        if (has_flag(v.emitter->flags(), EmitterFlags::DeltaPosition))
+            return pmf;
+        return v.emitter->shape()->pdf_position(position_sample(v)) * pmf;
+    }
+
+    /// Convert a solid angle density at \c from into an area density at \c to
+    static Float convert_density(Float pdf, const Vertex &from, const Vertex &to) {
+        Vector3f d = to.si.p - from.si.p;
+        Float inv_dist2 = rcp(squared_norm(d));
+        if (to.on_surface())
+            pdf *= abs_dot(to.si.n, d * sqrt(inv_dist2));
+        return pdf * inv_dist2;
+    }
+
+    /**
+     * \brief Correction factor of the adjoint BSDF for shading normals
+     * (Veach's thesis, Section 5.3), where \c wo points away from \c si
+     */
+    static Float shading_normal_correction(const SurfaceInteraction3f &si, const Vector3f &wo) {
+        Vector3f wi = si.to_world(si.wi);
+        Float num   = abs_dot(wi, si.sh_frame.n) * abs_dot(wo, si.n),
+              denom = abs_dot(wi, si.n) * abs_dot(wo, si.sh_frame.n);
+        return denom != 0.f ? num / denom : 0.f;
+    }
+
+    /// Create a vertex that does not lie on a surface
+    static Vertex empty_vertex(VertexType type, const Wavelength &wavelengths, Float time) {
+        Vertex v;
+        v.si             = zero<SurfaceInteraction3f>();
+        v.si.wavelengths = wavelengths;
+        v.si.time        = time;
+        v.emitter        = nullptr;
+        v.beta           = 0.f;
+        v.pdf_fwd        = 0.f;
+        v.pdf_rev        = 0.f;
+        v.type           = type;
+        v.delta          = false;
+        return v;
+    }
+
+    static PositionSample3f position_sample(const Vertex &v) {
+        PositionSample3f ps = zero<PositionSample3f>();
+        ps.p    = v.si.p;
+        ps.n    = v.si.n;
+        ps.uv   = v.si.uv;
+        ps.time = v.si.time;
+        return ps;
+    }
+
+    //! @}
+    // =============================================================
+
+private:
+    /// Distribution used to pick the emitter of the light subpaths
+    DiscreteDistribution<Float> m_emitter_distr;
+
+    /// Sensor of the current render, whose film receives the light tracing splats
+    Sensor *m_sensor = nullptr;
+};
+
+MTS_IMPLEMENT_CLASS_VARIANT(BidirectionalPathIntegrator, MonteCarloIntegrator)
+MTS_EXPORT_PLUGIN(BidirectionalPathIntegrator, "Bidirectional Path Tracer integrator");
+NAMESPACE_END(mitsuba)
@@ -33,6 +33,20 @@ Direct illumination integrator (:monosp:`direct`)
    - |bool|
    - Hide directly visible emitters.
      (Default: no, i.e. |false|)
+ * - ris_candidates
+   - |int|
+   - Number of candidate emitter samples that are drawn for each emitter sample. One of them is
+     chosen proportionally to its unshadowed contribution (*resampled importance sampling*), so
+     that only a single shadow ray is traced. Larger values help in scenes with many emitters.
+     (Default: 1, i.e. plain emitter sampling)
+ * - product_sampling
+   - |bool|
+   - Ask environment emitters to importance sample the product of their emission and a lobe of
+     the BSDF (see the :ref:`path tracer <sec-path-product>`). (Default: |false|)
+ * - lobe_exponent
+   - |float|
+   - Exponent of the lobe around the mirror direction that is used by
+     :paramtype:`product_sampling` for glossy BSDFs. (Default: 20)
 
 .. subfigstart::
 .. subfigure:: ../../resources/data/docs/images/render/integrator_direct_bsdf.jpg
@@ -68,7 +82,8 @@ or BSDF sampling-only integrator.
 template <typename Float, typename Spectrum>
 class DirectIntegrator : public SamplingIntegrator<Float, Spectrum> {
 public:
-    MTS_IMPORT_BASE(SamplingIntegrator, m_hide_emitters)
+    MTS_IMPORT_BASE(SamplingIntegrator, m_hide_emitters, ray_intersect_primary,
+                    add_unoccluded, sample_emitter_ris, emitter_lobe, pdf_emitter_lobe)
     MTS_IMPORT_TYPES(Scene, Sampler, Medium, Emitter, EmitterPtr, BSDF, BSDFPtr)
 
     // =============================================================
@@ -110,7 +125,7 @@ public:
                                      Mask active) const override {
         MTS_MASKED_FUNCTION(ProfilerPhase::SamplingIntegratorSample, active);
 
-        SurfaceInteraction3f si = scene->ray_intersect(ray, active);
+        SurfaceInteraction3f si = ray_intersect_primary(scene, ray, active);
         Mask valid_ray = si.is_valid();
 
         Spectrum result(0.f);
@@ -130,32 +145,28 @@ public:
 
         BSDFContext ctx;
         BSDFPtr bsdf = si.bsdf(ray);
-        Mask sample_emitter = active && has_flag(bsdf->flags(), BSDFFlags::Smooth);
+        UInt32 bsdf_flags = bsdf->flags(active);
+        Mask sample_emitter = active && has_flag(bsdf_flags, BSDFFlags::Smooth);
+        auto [lobe_axis, lobe_exponent] = emitter_lobe(si, bsdf_flags);
 
         if (any_or<true>(sample_emitter)) {
             for (size_t i = 0; i < m_emitter_samples; ++i) {
                 Mask active_e = sample_emitter;
-                DirectionSample3f ds;
-                Spectrum emitter_val;
-                std::tie(ds, emitter_val) = scene->sample_emitter_direction(
-                    si, sampler->next_2d(active_e), true, active_e);
+
+                /* Sample the emitters (resampling several candidates if
+                   requested), and query the BSDF for that direction along
+                   with the probability of sampling it using BSDF sampling. */
+                auto [ds, emitter_val, bsdf_val, bsdf_pdf] =
+                    sample_emitter_ris(scene, sampler, si, bsdf, lobe_axis, lobe_exponent,
+                                       active_e);
                 active_e &= neq(ds.pdf, 0.f);
                 if (none_or<false>(active_e))
                     continue;
 
-                // Query the BSDF for that emitter-sampled direction
-                Vector3f wo = si.to_local(ds.d);
-
-                Spectrum bsdf_val = bsdf->eval(ctx, si, wo, active_e);
-                bsdf_val = si.to_world_mueller(bsdf_val, -wo, si.wi);
-
-                /* Determine probability of having sampled that same
-                   direction using BSDF sampling. */
-                Float bsdf_pdf = bsdf->pdf(ctx, si, wo, active_e);
-
                 Float mis = select(ds.delta, Float(1.f), mis_weight(
                     ds.pdf * m_frac_lum, bsdf_pdf * m_frac_bsdf) * m_weight_lum);
-                result[active_e] += mis * bsdf_val * emitter_val;
+                add_unoccluded(scene, si, ds, mis * bsdf_val * emitter_val, result,
+                               active_e);
             }
         }
 
@@ -168,9 +179,11 @@ public:
 
             Mask active_b = active && any(neq(depolarize(bsdf_val), 0.f));
 
-            // Trace the ray in the sampled direction and intersect against the scene
+            /* Trace the ray in the sampled direction and intersect against the
+               scene. The hit is only used to evaluate an emitter there. */
             SurfaceInteraction si_bsdf =
-                scene->ray_intersect(si.spawn_ray(si.to_world(bs.wo)), active_b);
+                scene->ray_intersect(si.spawn_ray(si.to_world(bs.wo)),
+                                     HitComputeFlags::Connection, active_b);
 
             // Retain only rays that hit an emitter
             EmitterPtr emitter = si_bsdf.emitter(scene, active_b);
@@ -186,7 +199,8 @@ public:
                 ds.object = emitter;
 
                 Float emitter_pdf =
-                    select(delta, 0.f, scene->pdf_emitter_direction(si, ds, active_b));
+                    select(delta, 0.f, pdf_emitter_lobe(scene, si, ds, lobe_axis,
+                                                        lobe_exponent, active_b));
 
                 result[active_b] +=
                     bsdf_val * emitter_val *
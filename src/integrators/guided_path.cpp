@@ -0,0 +1,846 @@
+#include <atomic>
+#include <mitsuba/core/ray.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/profiler.h>
+#include <mitsuba/core/warp.h>
+#include <mitsuba/render/bsdf.h>
+#include <mitsuba/render/emitter.h>
+#include <mitsuba/render/integrator.h>
+#include <mitsuba/render/records.h>
+#include <mitsuba/render/scene.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+
+.. _integrator-guided_path:
+
+Guided path tracer (:monosp:`guided_path`)
+------------------------------------------
+
+.. pluginparameters::
+
+ * - max_depth
+   - |int|
+   - Specifies the longest path depth in the generated output image (where -1 corresponds to
+     :math:`\infty`). A value of 1 will only render directly visible light sources. 2 will lead
+     to single-bounce (direct-only) illumination, and so on. (Default: -1)
+ * - rr_depth
+   - |int|
+   - Specifies the minimum path depth, after which the implementation will start to use the
+     *russian roulette* path termination criterion. (Default: 5)
+ * - hide_emitters
+   - |bool|
+   - Hide directly visible emitters. (Default: no, i.e. |false|)
+ * - bsdf_sampling_fraction
+   - |float|
+   - Probability of sampling the BSDF instead of the learned distribution at
+     surfaces where guiding is available. Must lie in :math:`(0, 1]`. (Default: 0.5)
+ * - spatial_threshold
+   - |int|
+   - Number of samples that a cell of the spatial tree must receive during a
+     pass before it is split in half. (Default: 12000)
+ * - directional_threshold
+   - |float|
+   - Fraction of the energy of a directional distribution above which one of
+     its quadtree nodes is subdivided. (Default: 0.01)
+ * - adrrs
+   - |bool|
+   - Use the learned radiance for adjoint-driven Russian roulette and
+     splitting (see below). (Default: |false|)
+ * - adrrs_window
+   - |float|
+   - Ratio between the upper and lower bound of the weight window of
+     adjoint-driven Russian roulette and splitting. (Default: 5)
+ * - max_split
+   - |int|
+   - Maximum number of paths that a path is split into at a vertex. (Default: 8)
+
+This integrator extends the :ref:`path tracer <integrator-path>` with
+*practical path guiding* (Müller et al. 2017): it learns the distribution of
+incident radiance throughout the scene while rendering, and uses it to sample
+directions at subsequent surface interactions. This can drastically reduce the
+noise in scenes dominated by indirect illumination, e.g. an interior that is
+lit through a small opening.
+
+The incident radiance is stored in a *spatio-directional tree* (SD-tree): a
+binary tree that adaptively partitions the bounding box of the scene, whose
+leaves contain quadtrees over the sphere of directions. The image is rendered
+in multiple passes (see the ``samples_per_pass`` parameter). The paths of every
+pass record their incident radiance into one copy of the tree, while directions
+are sampled from the tree that was learned during the previous pass. The
+trees are refined in between passes: spatial cells that received many samples
+are split, and quadtree nodes are subdivided where a large fraction of the
+energy arrives. At each smooth surface interaction, the BSDF and the learned
+distribution are selected with probability :paramtype:`bsdf_sampling_fraction`
+and combined using the resulting one-sample mixture density. Like the path
+tracer, this integrator relies on multiple importance sampling to combine
+these directions with emitter samples.
+
+Guiding is only useful when the render consists of several passes, hence the
+``samples_per_pass`` parameter should be set to a fraction of the sample count
+of the sampler, for example:
+
+.. code-block:: xml
+
+    <integrator type="guided_path">
+        <integer name="samples_per_pass" value="4"/>
+    </integrator>
+
+The contributions of all passes (including the early ones that were rendered
+with a poorly trained distribution) are accumulated into the image.
+
+**Adjoint-driven Russian roulette and splitting**: the spatial cells also learn
+the average radiance that is reflected by the surfaces they contain. When
+:paramtype:`adrrs` is enabled, this estimate replaces the throughput-based
+Russian roulette after the first pass (Vorba and Křivánek 2016): the expected
+contribution of a path (its throughput times the reflected radiance at its
+current vertex) is compared to the estimated value of its pixel, taken from the
+first vertex of the path. Paths whose contribution falls below a window around
+the pixel estimate are terminated with a correspondingly high probability, while
+paths above the window are split into several paths with a fraction of the
+weight. This spends more samples on the paths that carry much of the light
+(e.g. into a dim interior) and fewer on deep bounces that barely contribute.
+
+.. note:: This integrator does not handle participating media and is only
+   available in the scalar variants. Adaptive sampling disables learning.
+
+ */
+
+template <typename Float, typename Spectrum>
+class GuidedPathIntegrator : public MonteCarloIntegrator<Float, Spectrum> {
+public:
+    MTS_IMPORT_BASE(MonteCarloIntegrator, m_max_depth, m_rr_depth)
+    MTS_IMPORT_TYPES(Scene, Sensor, Sampler, Medium, Emitter, EmitterPtr, BSDF, BSDFPtr)
+
+    /// Maximum depth of the directional quadtrees
+    static constexpr int MaxQuadtreeDepth = 20;
+
+    /// Maximum depth of the spatial binary tree
+    static constexpr uint32_t MaxSpatialDepth = 60;
+
+    /// Maximum number of vertices per path whose radiance is recorded
+    static constexpr size_t MaxVertices = 32;
+
+    // =============================================================
+    //! @{ \name Directional quadtree
+    // =============================================================
+
+    /// Node of a directional quadtree. Each child quadrant stores its energy.
+    struct QuadNode {
+        std::atomic<ScalarFloat> sum[4];
+        uint32_t child[4];
+
+        QuadNode() {
+            for (int i = 0; i < 4; ++i) {
+                sum[i].store(0.f, std::memory_order_relaxed);
+                child[i] = 0;
+            }
+        }
+
+        QuadNode(const QuadNode &node) { *this = node; }
+
+        QuadNode &operator=(const QuadNode &node) {
+            for (int i = 0; i < 4; ++i) {
+                sum[i].store(node.sum[i].load(std::memory_order_relaxed),
+                             std::memory_order_relaxed);
+                child[i] = node.child[i];
+            }
+            return *this;
+        }
+
+        ScalarFloat total() const {
+            ScalarFloat result = 0.f;
+            for (int i = 0; i < 4; ++i)
+                result += sum[i].load(std::memory_order_relaxed);
+            return result;
+        }
+
+        /// Return the quadrant containing \c p and map \c p to its unit square
+        static uint32_t quadrant(ScalarPoint2f &p) {
+            uint32_t index = 0;
+            for (int i = 0; i < 2; ++i) {
+                if (p[i] < .5f) {
+                    p[i] *= 2.f;
+                } else {
+                    p[i] = p[i] * 2.f - 1.f;
+                    index |= 1u << i;
+                }
+            }
+            return index;
+        }
+    };
+
+    /**
+     * \brief Piecewise constant distribution over the unit square, which is
+     * mapped onto the sphere using \ref warp::square_to_uniform_sphere().
+     *
+     * Recording is thread-safe, while sampling must only be done on trees
+     * that aren't modified concurrently.
+     */
+    struct DTree {
+        std::vector<QuadNode> nodes;
+
+        DTree() : nodes(1) { }
+
+        /// Return the total energy stored in the tree
+        ScalarFloat total() const { return nodes[0].total(); }
+
+        /// Add energy to all nodes containing \c p
+        void record(ScalarPoint2f p, ScalarFloat value) {
+            if (!(value > 0.f) || !std::isfinite(value))
+                return;
+
+            uint32_t index = 0;
+            while (true) {
+                uint32_t q = QuadNode::quadrant(p);
+                std::atomic<ScalarFloat> &sum = nodes[index].sum[q];
+                ScalarFloat current = sum.load(std::memory_order_relaxed);
+                while (!sum.compare_exchange_weak(current, current + value,
+                                                  std::memory_order_relaxed))
+                    ;
+                if (nodes[index].child[q] == 0)
+                    break;
+                index = nodes[index].child[q];
+            }
+        }
+
+        /// Sample a point proportionally to the stored energy
+        ScalarPoint2f sample(ScalarPoint2f u) const {
+            ScalarPoint2f origin(0.f);
+            ScalarFloat size = 1.f;
+            uint32_t index = 0;
+
+            while (true) {
+                const QuadNode &node = nodes[index];
+                ScalarFloat s[4];
+                for (int i = 0; i < 4; ++i)
+                    s[i] = node.sum[i].load(std::memory_order_relaxed);
+
+                // Choose the column, and then the quadrant within the column
+                ScalarFloat total = s[0] + s[1] + s[2] + s[3],
+                            p_left = (s[0] + s[2]) / total;
+
+                uint32_t q = 0;
+                if (u.x() < p_left) {
+                    u.x() /= p_left;
+                } else {
+                    u.x() = (u.x() - p_left) / (1.f - p_left);
+                    q |= 1;
+                }
+
+                ScalarFloat p_bottom = s[q] / (s[q] + s[q | 2]);
+                if (u.y() < p_bottom) {
+                    u.y() /= p_bottom;
+                } else {
+                    u.y() = (u.y() - p_bottom) / (1.f - p_bottom);
+                    q |= 2;
+                }
+                u = min(u, math::OneMinusEpsilon<ScalarFloat>);
+
+                size *= .5f;
+                origin += ScalarVector2f(ScalarFloat(q & 1), ScalarFloat(q >> 1)) * size;
+
+                if (node.child[q] == 0)
+                    break;
+                index = node.child[q];
+            }
+
+            return min(origin + u * size, math::OneMinusEpsilon<ScalarFloat>);
+        }
+
+        /// Density of \ref sample() with respect to the area of the unit square
+        ScalarFloat pdf(ScalarPoint2f p) const {
+            ScalarFloat result = 1.f;
+            uint32_t index = 0;
+
+            while (true) {
+                const QuadNode &node = nodes[index];
+                uint32_t q = QuadNode::quadrant(p);
+                ScalarFloat total = node.total();
+                if (!(total > 0.f))
+                    return 0.f;
+                result *= 4.f * node.sum[q].load(std::memory_order_relaxed) / total;
+
+                if (node.child[q] == 0 || result == 0.f)
+                    break;
+                index = node.child[q];
+            }
+
+            return result;
+        }
+
+        /**
+         * \brief Rebuild the structure of this tree (with zero energy) from
+         * the energy distribution of another one
+         *
+         * Nodes holding more than a fraction \c threshold of the total energy
+         * are subdivided, while the others are collapsed into leaves.
+         */
+        void build_from(const DTree &source, ScalarFloat threshold) {
+            nodes.assign(1, QuadNode());
+            if (!(source.total() > 0.f))
+                return;
+
+            struct Entry {
+                uint32_t node, source;
+                ScalarFloat fraction;
+                int depth;
+            };
+
+            /* Child indices are never zero, hence a source index of zero
+               (except for the root) denotes regions below a source leaf */
+            std::vector<Entry> stack = { { 0u, 0u, 1.f, 1 } };
+
+            while (!stack.empty()) {
+                Entry entry = stack.back();
+                stack.pop_back();
+
+                bool has_source = entry.node == 0 || entry.source != 0;
+
+                ScalarFloat total = has_source ? source.nodes[entry.source].total() : 0.f;
+
+                for (uint32_t q = 0; q < 4; ++q) {
+                    ScalarFloat fraction = entry.fraction * .25f;
+                    if (total > 0.f)
+                        fraction = entry.fraction *
+                            source.nodes[entry.source].sum[q].load(std::memory_order_relaxed) /
+                            total;
+
+                    if (entry.depth >= MaxQuadtreeDepth || !(fraction > threshold))
+                        continue;
+
+                    uint32_t child = (uint32_t) nodes.size();
+                    nodes.emplace_back();
+                    nodes[entry.node].child[q] = child;
+                    stack.push_back({ child,
+                                      has_source ? source.nodes[entry.source].child[q] : 0u,
+                                      fraction, entry.depth + 1 });
+                }
+            }
+        }
+    };
+
+    /// Directional distributions associated with a leaf of the spatial tree
+    struct GuidingLeaf {
+        /// Distribution learned during the previous pass, used for sampling
+        DTree sampling;
+
+        /// Distribution that is being learned during the current pass
+        DTree building;
+
+        /// Number of samples that were recorded during the current pass
+        std::atomic<uint32_t> sample_count;
+
+        /// Average reflected radiance in the cell, learned during the previous pass
+        ScalarFloat radiance = 0.f;
+
+        /// Sum and number of the reflected radiance samples of the current pass
+        std::atomic<ScalarFloat> radiance_sum;
+        std::atomic<uint32_t> radiance_count;
+
+        GuidingLeaf() : sample_count(0), radiance_sum(0.f), radiance_count(0) { }
+
+        GuidingLeaf(const GuidingLeaf &leaf)
+            : sampling(leaf.sampling), building(leaf.building),
+              sample_count(leaf.sample_count.load()), radiance(leaf.radiance),
+              radiance_sum(leaf.radiance_sum.load()),
+              radiance_count(leaf.radiance_count.load()) { }
+
+        /// Record a sample of the reflected radiance
+        void record_radiance(ScalarFloat value) {
+            if (!(value >= 0.f) || !std::isfinite(value))
+                return;
+            ScalarFloat current = radiance_sum.load(std::memory_order_relaxed);
+            while (!radiance_sum.compare_exchange_weak(current, current + value,
+                                                       std::memory_order_relaxed))
+                ;
+            radiance_count++;
+        }
+    };
+
+    //! @}
+    // =============================================================
+
+    // =============================================================
+    //! @{ \name Spatial binary tree
+    // =============================================================
+
+    struct SpatialNode {
+        /// Child nodes (zero for leaves)
+        uint32_t child[2] = { 0, 0 };
+
+        /// Index into \ref SDTree::leaves (only valid for leaves)
+        uint32_t leaf = 0;
+
+        /// Split axis of this node and depth within the tree
+        uint32_t axis = 0, depth = 0;
+    };
+
+    /// Binary tree over the cube enclosing the scene with directional leaves
+    struct SDTree {
+        std::vector<SpatialNode> nodes;
+        std::vector<GuidingLeaf> leaves;
+        ScalarPoint3f origin;
+        ScalarFloat extent;
+
+        SDTree(const ScalarBoundingBox3f &bbox) : nodes(1), leaves(1) {
+            if (bbox.valid()) {
+                extent = hmax(bbox.extents()) * 1.001f;
+                origin = bbox.center() - .5f * extent;
+            }
+            if (!bbox.valid() || !(extent > 0.f)) {
+                extent = 1.f;
+                origin = ScalarPoint3f(-.5f);
+            }
+        }
+
+        /// Find the leaf containing the given world space position
+        GuidingLeaf &lookup(const ScalarPoint3f &p_) {
+            ScalarPoint3f p = clamp((p_ - origin) / extent, 0.f,
+                                    math::OneMinusEpsilon<ScalarFloat>);
+            uint32_t index = 0;
+            while (nodes[index].child[0] != 0) {
+                const SpatialNode &node = nodes[index];
+                ScalarFloat &value = p[node.axis];
+                if (value < .5f) {
+                    value *= 2.f;
+                    index = node.child[0];
+                } else {
+                    value = value * 2.f - 1.f;
+                    index = node.child[1];
+                }
+            }
+            return leaves[nodes[index].leaf];
+        }
+
+        /**
+         * \brief Refine the tree at the end of a pass
+         *
+         * Splits all cells that received more than \c spatial_threshold
+         * samples, and then turns the distributions learned during the pass
+         * into the sampling distributions of the next one.
+         */
+        void refine(uint32_t spatial_threshold, ScalarFloat directional_threshold) {
+            std::vector<uint32_t> stack;
+            for (uint32_t i = 0; i < (uint32_t) nodes.size(); ++i)
+                if (nodes[i].child[0] == 0)
+                    stack.push_back(i);
+
+            while (!stack.empty()) {
+                uint32_t index = stack.back();
+                stack.pop_back();
+
+                SpatialNode node = nodes[index];
+                uint32_t count = leaves[node.leaf].sample_count.load();
+                if (count <= spatial_threshold || node.depth >= MaxSpatialDepth)
+                    continue;
+
+                // Both halves start out with the distributions of the parent
+                leaves[node.leaf].sample_count.store(count / 2);
+                GuidingLeaf copy(leaves[node.leaf]);
+                leaves.push_back(copy);
+
+                for (uint32_t i = 0; i < 2; ++i) {
+                    SpatialNode child;
+                    child.leaf  = i == 0 ? node.leaf : (uint32_t) leaves.size() - 1;
+                    child.axis  = (node.axis + 1) % 3;
+                    child.depth = node.depth + 1;
+                    nodes[index].child[i] = (uint32_t) nodes.size();
+                    stack.push_back((uint32_t) nodes.size());
+                    nodes.push_back(child);
+                }
+            }
+
+            for (GuidingLeaf &leaf : leaves) {
+                leaf.sampling = leaf.building;
+                leaf.building.build_from(leaf.sampling, directional_threshold);
+                leaf.sample_count.store(0);
+
+                // Cells that weren't visited keep their previous estimate
+                uint32_t radiance_count = leaf.radiance_count.load();
+                if (radiance_count > 0)
+                    leaf.radiance = leaf.radiance_sum.load() / radiance_count;
+                leaf.radiance_sum.store(0.f);
+                leaf.radiance_count.store(0);
+            }
+        }
+    };
+
+    /// Path vertex whose incident radiance is recorded at the end of the path
+    struct GuidingVertex {
+        GuidingLeaf *leaf;
+        ScalarPoint2f direction;
+        UnpolarizedSpectrum throughput, radiance;
+        Float pdf;
+
+        /// Emitter sampling contribution and BSDF weight (relative to the arrival throughput)
+        UnpolarizedSpectrum direct, weight;
+
+        void commit() {
+            leaf->building.record(direction, hmean(radiance) / pdf);
+            leaf->sample_count++;
+            leaf->record_radiance(hmean(direct + weight * radiance));
+        }
+    };
+
+    /// State of a path at the point where it arrives at a vertex
+    struct PathState {
+        RayDifferential3f ray;
+        SurfaceInteraction3f si;
+        EmitterPtr emitter;
+        Float emission_weight, eta;
+        Spectrum throughput;
+    };
+
+    //! @}
+    // =============================================================
+
+    GuidedPathIntegrator(const Properties &props) : Base(props) {
+        if constexpr (is_array_v<Float>)
+            Throw("The guided path tracer is only available in scalar variants!");
+
+        m_bsdf_sampling_fraction = props.float_("bsdf_sampling_fraction", .5f);
+        if (!(m_bsdf_sampling_fraction > 0.f && m_bsdf_sampling_fraction <= 1.f))
+            Throw("\"bsdf_sampling_fraction\" must lie in (0, 1]!");
+
+        int spatial_threshold = props.int_("spatial_threshold", 12000);
+        if (spatial_threshold <= 0)
+            Throw("\"spatial_threshold\" must be positive!");
+        m_spatial_threshold = (uint32_t) spatial_threshold;
+
+        m_directional_threshold = props.float_("directional_threshold", .01f);
+        if (!(m_directional_threshold > 0.f && m_directional_threshold < 1.f))
+            Throw("\"directional_threshold\" must lie in (0, 1)!");
+
+        m_adrrs = props.bool_("adrrs", false);
+        m_adrrs_window = props.float_("adrrs_window", 5.f);
+        if (!(m_adrrs_window > 1.f))
+            Throw("\"adrrs_window\" must be larger than 1!");
+        int max_split = props.int_("max_split", 8);
+        if (max_split < 1)
+            Throw("\"max_split\" must be at least 1!");
+        m_max_split = (uint32_t) max_split;
+    }
+
+    bool render(Scene *scene, Sensor *sensor) override {
+        // Learn the distribution of every render from scratch
+        m_tree.reset(new SDTree(scene->bbox()));
+        m_trained = false;
+        return Base::render(scene, sensor);
+    }
+
+    bool sequential_passes() const override { return true; }
+
+    void pass_finished(size_t pass, size_t pass_count) override {
+        if (pass + 1 >= pass_count)
+            return;
+
+        m_tree->refine(m_spatial_threshold, m_directional_threshold);
+        m_trained = true;
+
+        Log(Debug, "Guiding distribution after pass %i: %i spatial cells.", pass + 1,
+            m_tree->leaves.size());
+    }
+
+    std::pair<Spectrum, Mask> sample(const Scene *scene,
+                                     Sampler *sampler,
+                                     const RayDifferential3f &ray,
+                                     const Medium * /* medium */,
+                                     Float * /* aovs */,
+                                     Mask active) const override {
+        MTS_MASKED_FUNCTION(ProfilerPhase::SamplingIntegratorSample, active);
+
+        if constexpr (!is_array_v<Float>) {
+            if (!active)
+                return { Spectrum(0.f), false };
+            return sample_guided(scene, sampler, ray);
+        } else {
+            ENOKI_MARK_USED(scene);
+            ENOKI_MARK_USED(sampler);
+            ENOKI_MARK_USED(ray);
+            Throw("The guided path tracer is only available in scalar variants!");
+        }
+    }
+
+    /// Scalar implementation of \ref sample()
+    std::pair<Spectrum, Mask> sample_guided(const Scene *scene,
+                                            Sampler *sampler,
+                                            const RayDifferential3f &ray) const {
+        PathState state;
+        state.ray = ray;
+        state.si = scene->ray_intersect(ray);
+        state.emitter = state.si.emitter(scene);
+        state.emission_weight = 1.f;
+        state.eta = 1.f;
+        state.throughput = Spectrum(1.f);
+
+        // Vertices whose incident radiance is recorded into the guiding tree
+        GuidingVertex vertices[MaxVertices];
+
+        Spectrum result = trace(scene, sampler, state, 1, 0.f, vertices, 0, false);
+        return { result, state.si.is_valid() };
+    }
+
+    /**
+     * \brief Continue a path from the vertex described by \c state
+     *
+     * \param pixel_estimate
+     *     Estimate of the pixel value used by the adjoint-driven Russian
+     *     roulette and splitting (zero if none is available yet)
+     *
+     * \param vertex_count
+     *     Number of (already recorded) vertices of the path prefix
+     *
+     * \param split_branch
+     *     Whether \c state is a branch created by splitting, whose emission
+     *     and roulette decision at the current vertex were already handled
+     */
+    Spectrum trace(const Scene *scene, Sampler *sampler, PathState state, int depth,
+                   Float pixel_estimate, GuidingVertex *vertices, size_t vertex_count,
+                   bool split_branch) const {
+        RayDifferential3f &ray = state.ray;
+        SurfaceInteraction3f &si = state.si;
+        Spectrum &throughput = state.throughput;
+        Spectrum result(0.f);
+
+        // The vertices of the prefix are committed by the caller
+        size_t first_vertex = vertex_count;
+
+        // Account for a contribution in the incident radiance of all vertices
+        auto add_radiance = [&](const Spectrum &value) {
+            UnpolarizedSpectrum value_u = depolarize(value);
+            for (size_t i = 0; i < vertex_count; ++i)
+                vertices[i].radiance +=
+                    select(neq(vertices[i].throughput, 0.f),
+                           value_u / vertices[i].throughput, 0.f);
+        };
+
+        for (;; ++depth, split_branch = false) {
+            BSDFContext ctx;
+            BSDFPtr bsdf = nullptr;
+            GuidingLeaf *leaf = nullptr;
+            bool smooth = false;
+
+            if (!split_branch) {
+                // ---------------- Intersection with emitters ----------------
+
+                Spectrum emitted(0.f);
+                if (state.emitter) {
+                    emitted = state.emission_weight * throughput * state.emitter->eval(si);
+                    result += emitted;
+                    add_radiance(emitted);
+                }
+
+                if (!si.is_valid())
+                    break;
+
+                bsdf = si.bsdf(ray);
+                smooth = has_flag(bsdf->flags(), BSDFFlags::Smooth);
+                leaf = smooth ? &m_tree->lookup(si.p) : nullptr;
+
+                /* The first vertex provides the pixel estimate: its emission and
+                   the reflected radiance learned by the cache */
+                if (depth == 1)
+                    pixel_estimate = hmean(depolarize(emitted)) + (leaf ? leaf->radiance : 0.f);
+
+                uint32_t split = 1;
+                if (m_adrrs && m_trained && depth > 1 && leaf && leaf->radiance > 0.f &&
+                    pixel_estimate > 0.f) {
+                    /* Adjoint-driven Russian roulette and splitting: compare the
+                       expected contribution of the path to the pixel estimate,
+                       and keep it within a window around the pixel estimate */
+                    Float ratio = hmean(depolarize(throughput)) * leaf->radiance /
+                                  pixel_estimate,
+                          window_low  = 2.f / (1.f + m_adrrs_window),
+                          window_high = window_low * m_adrrs_window;
+
+                    if (ratio < window_low) {
+                        if (sampler->next_1d() >= ratio)
+                            break;
+                        throughput *= rcp(ratio);
+                    } else if (ratio > window_high) {
+                        split = std::min((uint32_t) ratio, m_max_split);
+                    }
+                } else if (depth > m_rr_depth) {
+                    /* Russian roulette (see the path tracer) */
+                    Float q = min(hmax(depolarize(throughput)) * sqr(state.eta), .95f);
+                    if (sampler->next_1d() >= q)
+                        break;
+                    throughput *= rcp(q);
+                }
+
+                if ((uint32_t) depth >= (uint32_t) m_max_depth)
+                    break;
+
+                if (split > 1) {
+                    // Continue the path several times, each with a fraction of the weight
+                    throughput /= (Float) split;
+                    for (uint32_t i = 0; i < split; ++i)
+                        result += trace(scene, sampler, state, depth, pixel_estimate,
+                                        vertices, vertex_count, true);
+                    break;
+                }
+            } else {
+                bsdf = si.bsdf(ray);
+                smooth = has_flag(bsdf->flags(), BSDFFlags::Smooth);
+                leaf = smooth ? &m_tree->lookup(si.p) : nullptr;
+            }
+
+            // Look up the learned distribution (if there is one yet)
+            const DTree *guide =
+                leaf && m_trained && leaf->sampling.total() > 0.f ? &leaf->sampling : nullptr;
+            Float bsdf_fraction = guide ? m_bsdf_sampling_fraction : 1.f;
+
+            // --------------------- Emitter sampling ---------------------
+
+            UnpolarizedSpectrum direct(0.f);
+            if (smooth) {
+                auto [ds, emitter_val] =
+                    scene->sample_emitter_direction(si, sampler->next_2d(), true);
+
+                if (ds.pdf != 0.f) {
+                    // Query the BSDF for that emitter-sampled direction
+                    Vector3f wo = si.to_local(ds.d);
+                    Spectrum bsdf_val = bsdf->eval(ctx, si, wo);
+                    bsdf_val = si.to_world_mueller(bsdf_val, -wo, si.wi);
+
+                    // Density of sampling that same direction using the mixture
+                    Float mixture_pdf =
+                        guided_pdf(bsdf_fraction, bsdf->pdf(ctx, si, wo), guide, ds.d);
+
+                    Float mis = ds.delta ? 1.f : mis_weight(ds.pdf, mixture_pdf);
+                    Spectrum value = mis * throughput * bsdf_val * emitter_val;
+                    result += value;
+                    add_radiance(value);
+                    direct = select(neq(depolarize(throughput), 0.f),
+                                    depolarize(value) / depolarize(throughput), 0.f);
+                }
+            }
+
+            // ------------------ BSDF and guided sampling ----------------
+
+            Float guide_sample = sampler->next_1d(),
+                  sample_1     = sampler->next_1d();
+            Point2f sample_2   = sampler->next_2d();
+
+            BSDFSample3f bs;
+            Spectrum bsdf_val;
+            if (!guide || guide_sample < bsdf_fraction) {
+                std::tie(bs, bsdf_val) = bsdf->sample(ctx, si, sample_1, sample_2);
+
+                if (has_flag(bs.sampled_type, BSDFFlags::Delta)) {
+                    // Guiding never produces these directions
+                    bsdf_val /= bsdf_fraction;
+                    bs.pdf *= bsdf_fraction;
+                } else if (guide && bs.pdf > 0.f) {
+                    bs.pdf = guided_pdf(bsdf_fraction, bsdf->pdf(ctx, si, bs.wo), guide,
+                                        si.to_world(bs.wo));
+                    bsdf_val = bsdf->eval(ctx, si, bs.wo) / bs.pdf;
+                }
+            } else {
+                Vector3f d = warp::square_to_uniform_sphere(guide->sample(sample_2));
+                bs = BSDFSample3f(si.to_local(d));
+                bs.sampled_type =
+                    Frame3f::cos_theta(bs.wo) * Frame3f::cos_theta(si.wi) > 0.f
+                        ? +BSDFFlags::GlossyReflection
+                        : +BSDFFlags::GlossyTransmission;
+                bs.pdf = guided_pdf(bsdf_fraction, bsdf->pdf(ctx, si, bs.wo), guide, d);
+                bsdf_val = bs.pdf > 0.f ? bsdf->eval(ctx, si, bs.wo) / bs.pdf : Spectrum(0.f);
+            }
+            bsdf_val = si.to_world_mueller(bsdf_val, -bs.wo, si.wi);
+
+            throughput = throughput * bsdf_val;
+            if (!(bs.pdf > 0.f) || all(eq(depolarize(throughput), 0.f)))
+                break;
+
+            state.eta *= bs.eta;
+
+            Vector3f wo_world = si.to_world(bs.wo);
+            bool delta = has_flag(bs.sampled_type, BSDFFlags::Delta);
+
+            // Remember the vertex, so that its incident radiance can be recorded
+            if (leaf && !delta && vertex_count < MaxVertices)
+                vertices[vertex_count++] = { leaf, warp::uniform_sphere_to_square(wo_world),
+                                             depolarize(throughput),
+                                             UnpolarizedSpectrum(0.f), bs.pdf,
+                                             direct, depolarize(bsdf_val) };
+
+            // Intersect the sampled ray against the scene geometry
+            ray = si.spawn_ray(wo_world);
+            SurfaceInteraction3f si_bsdf = scene->ray_intersect(ray);
+
+            /* Determine probability of having sampled that same
+               direction using emitter sampling. */
+            state.emitter = si_bsdf.emitter(scene);
+            if (state.emitter) {
+                DirectionSample3f ds(si_bsdf, si);
+                ds.object = state.emitter;
+                Float emitter_pdf = delta ? 0.f : scene->pdf_emitter_direction(si, ds);
+                state.emission_weight = mis_weight(bs.pdf, emitter_pdf);
+            }
+
+            si = std::move(si_bsdf);
+        }
+
+        for (size_t i = first_vertex; i < vertex_count; ++i)
+            vertices[i].commit();
+
+        return result;
+    }
+
+    /// Density of the mixture of BSDF and guided sampling w.r.t. solid angles
+    Float guided_pdf(Float bsdf_fraction, Float bsdf_pdf, const DTree *guide,
+                     const Vector3f &d) const {
+        if (!guide)
+            return bsdf_pdf;
+        return bsdf_fraction * bsdf_pdf +
+               (1.f - bsdf_fraction) * math::InvFourPi<Float> *
+                   guide->pdf(warp::uniform_sphere_to_square(d));
+    }
+
+    //! @}
+    // =============================================================
+
+    std::string to_string() const override {
+        return tfm::format("GuidedPathIntegrator[\n"
+            "  max_depth = %i,\n"
+            "  rr_depth = %i,\n"
+            "  bsdf_sampling_fraction = %f,\n"
+            "  spatial_threshold = %i,\n"
+            "  directional_threshold = %f,\n"
+            "  adrrs = %s,\n"
+            "  adrrs_window = %f,\n"
+            "  max_split = %i\n"
+            "]", m_max_depth, m_rr_depth, m_bsdf_sampling_fraction,
+            m_spatial_threshold, m_directional_threshold, m_adrrs ? "true" : "false",
+            m_adrrs_window, m_max_split);
+    }
+
+    Float mis_weight(Float pdf_a, Float pdf_b) const {
+        pdf_a *= pdf_a;
+        pdf_b *= pdf_b;
+        return select(pdf_a > 0.f, pdf_a / (pdf_a + pdf_b), 0.f);
+    }
+
+    MTS_DECLARE_CLASS()
+protected:
+    ScalarFloat m_bsdf_sampling_fraction;
+    uint32_t m_spatial_threshold;
+    ScalarFloat m_directional_threshold;
+
+    /// Adjoint-driven Russian roulette and splitting
+    bool m_adrrs;
+    ScalarFloat m_adrrs_window;
+    uint32_t m_max_split;
+
+    /// Guiding distribution, reset at the beginning of every render
+    std::unique_ptr<SDTree> m_tree;
+
+    /// Whether the sampling distributions contain data of a finished pass
+    bool m_trained = false;
+};
+
+MTS_IMPLEMENT_CLASS_VARIANT(GuidedPathIntegrator, MonteCarloIntegrator)
+MTS_EXPORT_PLUGIN(GuidedPathIntegrator, "Guided path tracer integrator");
+NAMESPACE_END(mitsuba)
@@ -1,11 +1,19 @@
 #include <random>
+#include <enoki/morton.h>
 #include <enoki/stl.h>
 #include <mitsuba/core/ray.h>
 #include <mitsuba/core/properties.h>
+#include <mitsuba/core/profiler.h>
+#include <mitsuba/core/spectrum.h>
+#include <mitsuba/core/statistics.h>
 #include <mitsuba/render/bsdf.h>
 #include <mitsuba/render/emitter.h>
+#include <mitsuba/render/film.h>
+#include <mitsuba/render/imageblock.h>
 #include <mitsuba/render/integrator.h>
+#include <mitsuba/render/mueller.h>
 #include <mitsuba/render/records.h>
+#include <mitsuba/render/sensor.h>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -30,6 +38,30 @@ Path tracer (:monosp:`path`)
  * - hide_emitters
    - |bool|
    - Hide directly visible emitters. (Default: no, i.e. |false|)
+ * - ris_candidates
+   - |int|
+   - Number of candidate emitter samples that are drawn at each path vertex. One of them is
+     chosen proportionally to its unshadowed contribution (*resampled importance sampling*), so
+     that only a single shadow ray is traced. Larger values help in scenes with many emitters.
+     Not supported by the wavefront mode. (Default: 1, i.e. plain emitter sampling)
+ * - wavefront
+   - |bool|
+   - Only used by the packet variants: trace the paths of each image block in wavefront order
+     instead of one packet of paths at a time. See below for details. (Default: |false|)
+ * - coalesce_bsdfs
+   - |bool|
+   - Only used by the GPU variants: dispatch the BSDF calls of each bounce once per material
+     instead of once per BSDF method. See below for details. Not supported in combination
+     with :paramtype:`ris_candidates` > 1 or :paramtype:`product_sampling`. (Default: |false|)
+ * - product_sampling
+   - |bool|
+   - Ask environment emitters to importance sample the product of their emission and a lobe of
+     the BSDF at each path vertex (see below). Not supported by the wavefront mode.
+     (Default: |false|)
+ * - lobe_exponent
+   - |float|
+   - Exponent of the lobe around the mirror direction that is used by
+     :paramtype:`product_sampling` for glossy BSDFs. (Default: 20)
 
 This integrator implements a basic path tracer and is a **good default choice**
 when there is no strong reason to prefer another method.
@@ -63,6 +95,48 @@ sampling to combine BSDF and emitter samples. The main difference in comparison
 to the former plugin is that it considers light paths of arbitrary length to compute
 both direct and indirect illumination.
 
+.. _sec-path-wavefront:
+
+**Wavefront mode**: in the packet variants, the default implementation traces
+a fixed packet of paths until all of them have terminated, hence SIMD lanes
+become idle as soon as some of the paths are absorbed or leave the scene. When
+:paramtype:`wavefront` is enabled, all paths of an image block are instead
+stored in a persistent queue and advanced one bounce at a time: the queue is
+intersected against the scene at full SIMD width, sorted by the intersected
+shape (so that lanes evaluate the same BSDF), shaded, and finally compacted so
+that only live paths are carried over to the next bounce. Note that the lanes
+of the sampler are no longer associated with a fixed path in this mode, hence
+it should be combined with the :ref:`independent <sampler-independent>` sampler.
+
+.. _sec-path-coalesce:
+
+**Material-coalesced dispatch**: in the GPU variants, every call of a BSDF
+method on the wavefront is dispatched separately: the lanes are partitioned by
+their BSDF, and the surface interaction is gathered for each material before
+the method is evaluated on the compacted lanes. A bounce of the path tracer
+calls three such methods (the BSDF flags, the evaluation at the emitter sample
+and the sampling of the next direction). When :paramtype:`coalesce_bsdfs` is
+enabled, the wavefront is partitioned only once per bounce, and both the
+evaluation and the sampling step of a material run on the same contiguous
+subset of lanes, which is gathered a single time. This reduces the number of
+kernels and the memory traffic in scenes with many materials.
+
+.. _sec-path-product:
+
+**Product sampling**: an :ref:`environment map <emitter-envmap>` is normally
+sampled proportionally to its luminance, which wastes samples on the half of
+the map below the surface of diffuse objects and on bright regions far from
+the reflection lobe of glossy objects. When :paramtype:`product_sampling` is
+enabled, the path tracer passes a lobe of the BSDF at every vertex to the
+emitters: the cosine foreshortening around the shading normal for reflective
+BSDFs, or a Phong-like lobe with exponent :paramtype:`lobe_exponent` around
+the mirror direction for glossy BSDFs without a diffuse component. The
+environment map then samples the product of its luminance and this lobe, and
+BSDFs that transmit light keep the plain strategy. The lobe only guides the
+sampling (the densities used for multiple importance sampling account for
+it), hence a poorly matching exponent increases the noise but never biases
+the result.
+
 .. _sec-path-strictnormals:
 
 .. Commented out for now
@@ -92,10 +166,26 @@ both direct and indirect illumination.
 template <typename Float, typename Spectrum>
 class PathIntegrator : public MonteCarloIntegrator<Float, Spectrum> {
 public:
-    MTS_IMPORT_BASE(MonteCarloIntegrator, m_max_depth, m_rr_depth)
-    MTS_IMPORT_TYPES(Scene, Sampler, Medium, Emitter, EmitterPtr, BSDF, BSDFPtr)
-
-    PathIntegrator(const Properties &props) : Base(props) { }
+    MTS_IMPORT_BASE(MonteCarloIntegrator, m_max_depth, m_rr_depth, should_stop,
+                    ray_intersect_primary, add_unoccluded, sample_emitter_ris,
+                    emitter_lobe, pdf_emitter_lobe, m_ris_candidates, m_product_sampling)
+    MTS_IMPORT_TYPES(Scene, Sensor, Film, ImageBlock, Sampler, Medium, Emitter, EmitterPtr,
+                     BSDF, BSDFPtr)
+
+    PathIntegrator(const Properties &props) : Base(props) {
+        m_wavefront = props.bool_("wavefront", false);
+        m_coalesce_bsdfs = props.bool_("coalesce_bsdfs", false);
+        if (m_coalesce_bsdfs && m_ris_candidates > 1) {
+            Log(Warn, "Material-coalesced dispatch does not support \"ris_candidates\" > 1, "
+                      "disabling it.");
+            m_coalesce_bsdfs = false;
+        }
+        if (m_coalesce_bsdfs && m_product_sampling) {
+            Log(Warn, "Material-coalesced dispatch does not support \"product_sampling\", "
+                      "disabling it.");
+            m_coalesce_bsdfs = false;
+        }
+    }
 
     std::pair<Spectrum, Mask> sample(const Scene *scene,
                                      Sampler *sampler,
@@ -115,9 +205,19 @@ public:
 
         Spectrum throughput(1.f), result(0.f);
 
+        /* In polarized variants, the throughput of a path is a multiple of the
+           ideal depolarizer as long as all its interactions are depolarizing
+           (e.g. diffuse surfaces). Only its intensity 'throughput_u' is
+           tracked then, and it is promoted to a full Mueller matrix at the
+           first polarizing interaction. Radiance is always accumulated
+           into the Stokes vector (first column) of 'result'. */
+        constexpr bool track_depolarized = is_polarized_v<Spectrum> && !is_cuda_array_v<Float>;
+        bool depolarized = false;
+        UnpolarizedSpectrum throughput_u(1.f);
+
         // ---------------------- First intersection ----------------------
 
-        SurfaceInteraction3f si = scene->ray_intersect(ray, active);
+        SurfaceInteraction3f si = ray_intersect_primary(scene, ray, active);
         Mask valid_ray = si.is_valid();
         EmitterPtr emitter = si.emitter(scene);
 
@@ -125,8 +225,14 @@ public:
 
             // ---------------- Intersection with emitters ----------------
 
-            if (any_or<true>(neq(emitter, nullptr)))
-                result[active] += emission_weight * throughput * emitter->eval(si, active);
+            if (any_or<true>(neq(emitter, nullptr))) {
+                Spectrum emitted = emitter->eval(si, active);
+                if (depolarized)
+                    result[active] += unpolarized<Spectrum>(emission_weight * throughput_u *
+                                                            depolarize(emitted));
+                else
+                    result[active] += emission_weight * throughput * emitted;
+            }
 
             active &= si.is_valid();
 
@@ -135,9 +241,11 @@ public:
                index boundaries. Stop with at least some probability to avoid
                getting stuck (e.g. due to total internal reflection) */
             if (depth > m_rr_depth) {
-                Float q = min(hmax(depolarize(throughput)) * sqr(eta), .95f);
+                Float q = min(hmax(depolarized ? throughput_u : depolarize(throughput)) *
+                              sqr(eta), .95f);
                 active &= sampler->next_1d(active) < q;
                 throughput *= rcp(q);
+                throughput_u *= rcp(q);
             }
 
             // Stop if we've exceeded the number of requested bounces, or
@@ -152,42 +260,79 @@ public:
 
             BSDFContext ctx;
             BSDFPtr bsdf = si.bsdf(ray);
-            Mask active_e = active && has_flag(bsdf->flags(), BSDFFlags::Smooth);
-
-            if (likely(any_or<true>(active_e))) {
-                auto [ds, emitter_val] = scene->sample_emitter_direction(
-                    si, sampler->next_2d(active_e), true, active_e);
-                active_e &= neq(ds.pdf, 0.f);
-
-                // Query the BSDF for that emitter-sampled direction
-                Vector3f wo = si.to_local(ds.d);
-                Spectrum bsdf_val = bsdf->eval(ctx, si, wo, active_e);
-                bsdf_val = si.to_world_mueller(bsdf_val, -wo, si.wi);
-
-                // Determine density of sampling that same direction using BSDF sampling
-                Float bsdf_pdf = bsdf->pdf(ctx, si, wo, active_e);
-
-                Float mis = select(ds.delta, 1.f, mis_weight(ds.pdf, bsdf_pdf));
-                result[active_e] += mis * throughput * bsdf_val * emitter_val;
+            BSDFSample3f bs;
+            Spectrum bsdf_val;
+            bool coalesced = false;
+
+            // Lobe for product sampling of the emitters (not used by coalesced dispatch)
+            Vector3f lobe_axis(0.f);
+            Float lobe_exponent(0.f);
+
+            if constexpr (is_cuda_array_v<Float>) {
+                if (m_coalesce_bsdfs) {
+                    std::tie(bs, bsdf_val) =
+                        sample_coalesced(scene, sampler, si, bsdf, throughput, result, active);
+                    coalesced = true;
+                }
             }
 
-            // ----------------------- BSDF sampling ----------------------
+            if (!coalesced) {
+                UInt32 bsdf_flags = bsdf->flags(active);
+                Mask active_e = active && has_flag(bsdf_flags, BSDFFlags::Smooth);
+                std::tie(lobe_axis, lobe_exponent) = emitter_lobe(si, bsdf_flags);
+
+                if (likely(any_or<true>(active_e))) {
+                    /* Sample the emitters (resampling several candidates if
+                       requested), and query the BSDF for that direction along
+                       with the density of sampling it using BSDF sampling */
+                    auto [ds, emitter_val, bsdf_val_e, bsdf_pdf] =
+                        sample_emitter_ris(scene, sampler, si, bsdf, lobe_axis,
+                                           lobe_exponent, active_e);
+                    active_e &= neq(ds.pdf, 0.f);
+
+                    Float mis = select(ds.delta, 1.f, mis_weight(ds.pdf, bsdf_pdf));
+                    Spectrum value;
+                    if (depolarized)
+                        value = unpolarized<Spectrum>(mis * throughput_u *
+                                                      product_intensity(bsdf_val_e, emitter_val));
+                    else
+                        value = mis * throughput * bsdf_val_e * emitter_val;
+                    add_unoccluded(scene, si, ds, value, result, active_e);
+                }
+
+                // ----------------------- BSDF sampling ----------------------
+
+                // Sample BSDF * cos(theta)
+                std::tie(bs, bsdf_val) = bsdf->sample(ctx, si, sampler->next_1d(active),
+                                                      sampler->next_2d(active), active);
+            }
 
-            // Sample BSDF * cos(theta)
-            auto [bs, bsdf_val] = bsdf->sample(ctx, si, sampler->next_1d(active),
-                                               sampler->next_2d(active), active);
             bsdf_val = si.to_world_mueller(bsdf_val, -bs.wo, si.wi);
 
-            throughput = throughput * bsdf_val;
-            active &= any(neq(depolarize(throughput), 0.f));
+            if constexpr (track_depolarized) {
+                if (depolarized && all_nested(mueller::is_depolarizer(bsdf_val))) {
+                    throughput_u *= depolarize(bsdf_val);
+                } else {
+                    if (depolarized)
+                        throughput = unpolarized<Spectrum>(throughput_u);
+                    throughput = throughput * bsdf_val;
+                    depolarized = all_nested(mueller::is_depolarizer(throughput));
+                    throughput_u = depolarize(throughput);
+                }
+            } else {
+                throughput = throughput * bsdf_val;
+            }
+            active &= any(neq(depolarized ? throughput_u : depolarize(throughput), 0.f));
             if (none_or<false>(active))
                 break;
 
             eta *= bs.eta;
 
-            // Intersect the BSDF ray against the scene geometry
+            /* Intersect the BSDF ray against the scene geometry, only
+               computing the fields needed to continue the path */
             ray = si.spawn_ray(si.to_world(bs.wo));
-            SurfaceInteraction3f si_bsdf = scene->ray_intersect(ray, active);
+            SurfaceInteraction3f si_bsdf =
+                scene->ray_intersect(ray, scene->scattering_hit_flags(), active);
 
             /* Determine probability of having sampled that same
                direction using emitter sampling. */
@@ -196,10 +341,11 @@ public:
             ds.object = emitter;
 
             if (any_or<true>(neq(emitter, nullptr))) {
-                Float emitter_pdf =
-                    select(neq(emitter, nullptr) && !has_flag(bs.sampled_type, BSDFFlags::Delta),
-                           scene->pdf_emitter_direction(si, ds),
-                           0.f);
+                Mask active_mis =
+                    neq(emitter, nullptr) && !has_flag(bs.sampled_type, BSDFFlags::Delta);
+                Float emitter_pdf = select(
+                    active_mis,
+                    pdf_emitter_lobe(scene, si, ds, lobe_axis, lobe_exponent, active_mis), 0.f);
 
                 emission_weight = mis_weight(bs.pdf, emitter_pdf);
             }
@@ -210,14 +356,363 @@ public:
         return { result, valid_ray };
     }
 
+    /**
+     * \brief Emitter and BSDF sampling step of \ref sample() with a single
+     * dispatch per material (GPU variants, see \c coalesce_bsdfs)
+     *
+     * The lanes are partitioned by their BSDF once. Every material then
+     * gathers the surface interaction of its lanes a single time, evaluates
+     * itself at the emitter sample and samples the next direction on that
+     * compacted subset, and scatters the results back into the wavefront.
+     * Emitter sampling itself still runs on the full wavefront.
+     *
+     * \return The BSDF sample and its weight (in local coordinates)
+     */
+    std::pair<BSDFSample3f, Spectrum>
+    sample_coalesced(const Scene *scene, Sampler *sampler, const SurfaceInteraction3f &si,
+                     const BSDFPtr &bsdf, const Spectrum &throughput, Spectrum &result,
+                     Mask active) const {
+        BSDFContext ctx;
+        size_t size = slices(active);
+        auto materials = partition(bsdf);
+
+        // Flags of the BSDF of every lane (without another dispatch)
+        UInt32 flags = zero<UInt32>(size);
+        for (auto [ptr, perm] : materials) {
+            if (ptr != nullptr)
+                scatter(flags, UInt32(ptr->flags()), perm);
+        }
+
+        Mask active_e = active && has_flag(flags, BSDFFlags::Smooth);
+        auto [ds, emitter_val] = scene->sample_emitter_direction(
+            si, sampler->next_2d(active_e), false, active_e);
+        active_e &= neq(ds.pdf, 0.f);
+
+        // Samples are drawn on the full wavefront to keep the sequences in step
+        Float sample1 = sampler->next_1d(active);
+        Point2f sample2 = sampler->next_2d(active);
+        Vector3f wo_e = si.to_local(ds.d);
+
+        Spectrum bsdf_val_e = zero<Spectrum>(size), bsdf_val = zero<Spectrum>(size);
+        Float bsdf_pdf_e = zero<Float>(size);
+        BSDFSample3f bs = zero<BSDFSample3f>(size);
+
+        for (auto [ptr, perm] : materials) {
+            if (ptr == nullptr)
+                continue;
+
+            SurfaceInteraction3f si_p = gather<SurfaceInteraction3f>(si, perm);
+            Mask active_p   = gather<Mask>(active, perm),
+                 active_e_p = gather<Mask>(active_e, perm);
+
+            auto [bsdf_val_p, bsdf_pdf_p] =
+                ptr->eval_pdf(ctx, si_p, gather<Vector3f>(wo_e, perm), active_e_p);
+            auto [bs_p, bsdf_weight_p] =
+                ptr->sample(ctx, si_p, gather<Float>(sample1, perm),
+                            gather<Point2f>(sample2, perm), active_p);
+
+            scatter(bsdf_val_e, bsdf_val_p, perm);
+            scatter(bsdf_pdf_e, bsdf_pdf_p, perm);
+            scatter(bs, bs_p, perm);
+            scatter(bsdf_val, bsdf_weight_p, perm);
+        }
+
+        bsdf_val_e = si.to_world_mueller(bsdf_val_e, -wo_e, si.wi);
+
+        Float mis = select(ds.delta, 1.f, mis_weight(ds.pdf, bsdf_pdf_e));
+        add_unoccluded(scene, si, ds, mis * throughput * bsdf_val_e * emitter_val, result,
+                       active_e);
+
+        return { bs, bsdf_val };
+    }
+
     //! @}
     // =============================================================
 
+    void render_block(const Scene *scene, const Sensor *sensor, Sampler *sampler,
+                      ImageBlock *block, Float *aovs, size_t sample_count,
+                      size_t block_id, const uint32_t *pixel_mask) const override {
+        if constexpr (is_static_array_v<Float> && !is_polarized_v<Spectrum>) {
+            if (m_wavefront) {
+                render_block_wavefront(scene, sensor, sampler, block, sample_count,
+                                       block_id, pixel_mask);
+                return;
+            }
+        }
+
+        Base::render_block(scene, sensor, sampler, block, aovs, sample_count,
+                           block_id, pixel_mask);
+    }
+
+    /**
+     * \brief Wavefront implementation of \ref render_block() for packet variants
+     *
+     * All paths of the block are kept in a persistent (structure of arrays)
+     * state. Each bounce intersects the queue of live paths, sorts it by the
+     * intersected shape, shades it, and compacts it.
+     */
+    void render_block_wavefront(const Scene *scene, const Sensor *sensor, Sampler *sampler,
+                                ImageBlock *block, size_t sample_count_, size_t block_id,
+                                const uint32_t *pixel_mask) const {
+        using FloatX    = make_dynamic_t<Float>;
+        using SpectrumX = make_dynamic_t<Spectrum>;
+        using Point2fX  = make_dynamic_t<Point2f>;
+        using Point3fX  = make_dynamic_t<Point3f>;
+        using Ray3fX    = make_dynamic_t<Ray3f>;
+        using PreliminaryIntersection3fX = make_dynamic_t<PreliminaryIntersection3f>;
+
+        block->clear();
+
+        uint32_t block_size   = math::round_to_power_of_two((uint32_t) hmax(block->size())),
+                 pixel_count  = block_size * block_size,
+                 sample_count = (uint32_t)(sample_count_ == (size_t) -1
+                                               ? sampler->sample_count()
+                                               : sample_count_),
+                 path_count   = pixel_count * sample_count;
+
+        const Film *film = sensor->film();
+        ScalarVector2f crop_offset = film->crop_offset(),
+                       crop_size   = film->crop_size();
+
+        // Ensure that the sample generation is fully deterministic
+        sampler->seed(block_id);
+
+        // Persistent state of all paths of the block
+        Ray3fX rays;
+        SpectrumX weight, throughput, result;
+        FloatX eta, mis_pdf, alpha;
+        Point2fX position;
+        Point3fX prev_p;
+        PreliminaryIntersection3fX pis;
+
+        set_slices(rays, path_count);
+        set_slices(weight, path_count);
+        set_slices(throughput, path_count);
+        set_slices(result, path_count);
+        set_slices(eta, path_count);
+        set_slices(mis_pdf, path_count);
+        set_slices(alpha, path_count);
+        set_slices(position, path_count);
+        set_slices(prev_p, path_count);
+        set_slices(pis, path_count);
+
+        std::unique_ptr<uint32_t[]> queue(new uint32_t[path_count]);
+        uint32_t *queue_end = queue.get();
+
+        // ------------------ Generate camera rays ------------------
+
+        for (auto [index, active] : range<UInt32>(path_count)) {
+            Point2u pos = enoki::morton_decode<Point2u>(index / UInt32(sample_count));
+            active &= !any(pos >= block->size());
+            if (pixel_mask) {
+                UInt32 pixel_index = pos.x() + pos.y() * UInt32(block->width());
+                active &= neq(gather<UInt32>(pixel_mask, pixel_index, active), 0u);
+            }
+            if (none(active))
+                continue;
+            pos += block->offset();
+
+            Vector2f position_sample = pos + sampler->next_2d(active);
+
+            Point2f aperture_sample(.5f);
+            if (sensor->needs_aperture_sample())
+                aperture_sample = sampler->next_2d(active);
+
+            Float time = sensor->shutter_open();
+            if (sensor->shutter_open_time() > 0.f)
+                time += sampler->next_1d(active) * sensor->shutter_open_time();
+
+            Float wavelength_sample = sampler->next_1d(active);
+
+            auto [ray, ray_weight] = sensor->sample_ray(
+                time, wavelength_sample, (position_sample - crop_offset) / crop_size,
+                aperture_sample, active);
+            Statistics::count_rays(RayCounter::Primary, active);
+
+            scatter(rays, ray, index, active);
+            scatter(weight, ray_weight, index, active);
+            scatter(throughput, Spectrum(1.f), index, active);
+            scatter(result, Spectrum(0.f), index, active);
+            scatter(eta, Float(1.f), index, active);
+            scatter(mis_pdf, Float(0.f), index, active);
+            scatter(position, Point2f(position_sample), index, active);
+
+            compress(queue_end, index, active);
+            sampler->advance();
+        }
+
+        // ---------------------- Bounce loop -----------------------
+
+        for (int depth = 1; queue_end != queue.get() && !should_stop(); ++depth) {
+            uint32_t queue_size = (uint32_t) (queue_end - queue.get());
+
+            // Intersect all live paths at full SIMD width
+            for (auto [index, active] : range<UInt32>(queue_size)) {
+                UInt32 idx = gather<UInt32>(queue.get(), index, active);
+                Ray3f ray = gather<Ray3f>(rays, idx, active);
+                scatter(pis, scene->ray_intersect_preliminary(ray, active), idx, active);
+            }
+
+            // Sort by the intersected shape so that lanes shade the same BSDF
+            const Shape *const *shapes = (const Shape *const *) pis.shape.data();
+            std::sort(queue.get(), queue_end, [shapes](uint32_t a, uint32_t b) {
+                return std::less<const Shape *>()(shapes[a], shapes[b]);
+            });
+
+            // Shade and compact the queue in place (entries are read before being overwritten)
+            queue_end = queue.get();
+            for (auto [index, active] : range<UInt32>(queue_size)) {
+                UInt32 idx = gather<UInt32>(queue.get(), index, active);
+                Mask active_in = active;
+
+                Ray3f ray = gather<Ray3f>(rays, idx, active);
+                PreliminaryIntersection3f pi = gather<PreliminaryIntersection3f>(pis, idx, active);
+                Spectrum throughput_p = gather<Spectrum>(throughput, idx, active),
+                         result_p     = gather<Spectrum>(result, idx, active);
+                Float eta_p = gather<Float>(eta, idx, active),
+                      mis_pdf_p = gather<Float>(mis_pdf, idx, active);
+
+                Mask hit = active && pi.is_valid();
+                SurfaceInteraction3f si;
+                if (any(hit)) {
+                    ScopedPhase sp(ProfilerPhase::CreateSurfaceInteraction);
+                    si = pi.compute_surface_interaction(ray, scene->scattering_hit_flags(), hit);
+                } else {
+                    si.wavelengths = ray.wavelengths;
+                    si.wi = -ray.d;
+                    si.t = math::Infinity<Float>;
+                }
+
+                if (depth == 1)
+                    scatter(alpha, select(si.is_valid(), Float(1.f), Float(0.f)), idx, active);
+
+                // ---------------- Intersection with emitters ----------------
+
+                EmitterPtr emitter = si.emitter(scene, active);
+                if (any_or<true>(neq(emitter, nullptr))) {
+                    /* MIS weight for intersected emitters. A zero density marks
+                       camera rays and rays sampled from delta BSDF lobes. */
+                    Float emission_weight(1.f);
+                    Mask active_mis = active && neq(emitter, nullptr) && mis_pdf_p > 0.f;
+                    if (any_or<true>(active_mis)) {
+                        Interaction3f ref;
+                        ref.t = 0.f;
+                        ref.p = gather<Point3f>(prev_p, idx, active_mis);
+                        ref.time = ray.time;
+                        ref.wavelengths = ray.wavelengths;
+
+                        DirectionSample3f ds(si, ref);
+                        ds.object = emitter;
+                        Float emitter_pdf = scene->pdf_emitter_direction(ref, ds, active_mis);
+                        emission_weight[active_mis] = mis_weight(mis_pdf_p, emitter_pdf);
+                    }
+
+                    result_p[active] += emission_weight * throughput_p * emitter->eval(si, active);
+                }
+
+                active &= si.is_valid();
+
+                // Russian roulette (see sample())
+                if (depth > m_rr_depth) {
+                    Float q = min(hmax(depolarize(throughput_p)) * sqr(eta_p), .95f);
+                    active &= sampler->next_1d(active) < q;
+                    throughput_p *= rcp(q);
+                }
+
+                if ((uint32_t) depth >= (uint32_t) m_max_depth)
+                    active = false;
+
+                if (any(active)) {
+                    // --------------------- Emitter sampling ---------------------
+
+                    BSDFContext ctx;
+                    BSDFPtr bsdf = si.bsdf();
+                    Mask active_e = active && has_flag(bsdf->flags(), BSDFFlags::Smooth);
+
+                    if (likely(any_or<true>(active_e))) {
+                        auto [ds, emitter_val] = scene->sample_emitter_direction(
+                            si, sampler->next_2d(active_e), true, active_e);
+                        active_e &= neq(ds.pdf, 0.f);
+
+                        Vector3f wo = si.to_local(ds.d);
+                        auto [bsdf_val, bsdf_pdf] = bsdf->eval_pdf(ctx, si, wo, active_e);
+
+                        Float mis = select(ds.delta, 1.f, mis_weight(ds.pdf, bsdf_pdf));
+                        result_p[active_e] += mis * throughput_p * bsdf_val * emitter_val;
+                    }
+
+                    // ----------------------- BSDF sampling ----------------------
+
+                    auto [bs, bsdf_val] = bsdf->sample(ctx, si, sampler->next_1d(active),
+                                                       sampler->next_2d(active), active);
+
+                    throughput_p = throughput_p * bsdf_val;
+                    active &= any(neq(depolarize(throughput_p), 0.f));
+                    eta_p *= bs.eta;
+
+                    scatter(rays, si.spawn_ray(si.to_world(bs.wo)), idx, active);
+                    scatter(throughput, throughput_p, idx, active);
+                    scatter(eta, eta_p, idx, active);
+                    scatter(prev_p, si.p, idx, active);
+                    scatter(mis_pdf,
+                            select(has_flag(bs.sampled_type, BSDFFlags::Delta), 0.f, bs.pdf),
+                            idx, active);
+                }
+
+                scatter(result, result_p, idx, active);
+
+                // Splat the contribution of paths that terminated during this bounce
+                Mask done = active_in && !active;
+                if (any(done))
+                    splat(block, gather<Point2f>(position, idx, done),
+                          gather<Spectrum>(weight, idx, done) * result_p,
+                          ray.wavelengths, gather<Float>(alpha, idx, done), done);
+
+                compress(queue_end, idx, active);
+            }
+        }
+    }
+
     std::string to_string() const override {
         return tfm::format("PathIntegrator[\n"
             "  max_depth = %i,\n"
-            "  rr_depth = %i\n"
-            "]", m_max_depth, m_rr_depth);
+            "  rr_depth = %i,\n"
+            "  wavefront = %s,\n"
+            "  coalesce_bsdfs = %s\n"
+            "]", m_max_depth, m_rr_depth, m_wavefront, m_coalesce_bsdfs);
+    }
+
+    /// Convert a path contribution to XYZ and store it in the image block
+    void splat(ImageBlock *block, const Point2f &pos, const Spectrum &value,
+               const Wavelength &wavelengths, const Float &alpha, Mask active) const {
+        UnpolarizedSpectrum spec_u = depolarize(value);
+
+        Color3f xyz;
+        if constexpr (is_monochromatic_v<Spectrum>) {
+            ENOKI_MARK_USED(wavelengths);
+            xyz = spec_u.x();
+        } else if constexpr (is_rgb_v<Spectrum>) {
+            ENOKI_MARK_USED(wavelengths);
+            xyz = srgb_to_xyz(spec_u, active);
+        } else {
+            static_assert(is_spectral_v<Spectrum>);
+            xyz = spectrum_to_xyz(spec_u, wavelengths, active);
+        }
+
+        Float values[5] = { xyz.x(), xyz.y(), xyz.z(), alpha, 1.f };
+        block->put(pos, values, active);
+    }
+
+    /// Intensity of the product of two Mueller matrices, i.e. <tt>depolarize(a * b)</tt>
+    static UnpolarizedSpectrum product_intensity(const Spectrum &a, const Spectrum &b) {
+        if constexpr (is_polarized_v<Spectrum>) {
+            UnpolarizedSpectrum result = a(0, 0) * b(0, 0);
+            for (size_t k = 1; k < 4; ++k)
+                result += a(0, k) * b(k, 0);
+            return result;
+        } else {
+            return a * b;
+        }
     }
 
     Float mis_weight(Float pdf_a, Float pdf_b) const {
@@ -227,6 +722,9 @@ public:
     }
 
     MTS_DECLARE_CLASS()
+protected:
+    bool m_wavefront;
+    bool m_coalesce_bsdfs;
 };
 
 MTS_IMPLEMENT_CLASS_VARIANT(PathIntegrator, MonteCarloIntegrator)
@@ -0,0 +1,507 @@
+#include <atomic>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/profiler.h>
+#include <mitsuba/render/bsdf.h>
+#include <mitsuba/render/emitter.h>
+#include <mitsuba/render/integrator.h>
+#include <mitsuba/render/records.h>
+#include <mitsuba/render/scene.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+
+.. _integrator-radiance_cache:
+
+Radiance cache path tracer (:monosp:`radiance_cache`)
+-----------------------------------------------------
+
+.. pluginparameters::
+
+ * - max_depth
+   - |int|
+   - Specifies the longest path depth in the generated output image (where -1 corresponds to
+     :math:`\infty`). A value of 1 will only render directly visible light sources. 2 will lead
+     to single-bounce (direct-only) illumination, and so on. (Default: -1)
+ * - rr_depth
+   - |int|
+   - Specifies the minimum path depth, after which the implementation will start to use the
+     *russian roulette* path termination criterion. (Default: 5)
+ * - cell_size
+   - |float|
+   - Edge length of the cells of the spatial hash grid in world units. (Default: 1/256 of the
+     largest extent of the scene's bounding box)
+ * - cache_size
+   - |int|
+   - Number of entries of the hash table, rounded up to the next power of two. (Default: 1048576)
+ * - cache_depth
+   - |int|
+   - Path depth starting from which paths may be terminated into the cache. The default
+     only stops paths at the second interaction with the scene, which keeps the blocky
+     structure of the cache out of directly visible surfaces. (Default: 2)
+ * - min_samples
+   - |int|
+   - Number of samples that a cell must have received in earlier passes before it is used.
+     (Default: 16)
+
+This integrator extends the :ref:`path tracer <integrator-path>` with a cache
+of the low-frequency indirect illumination on diffuse surfaces, which is
+intended for fast renders of diffuse-dominant scenes such as architectural
+interiors.
+
+The cache is a hash grid: the scene is divided into cubical cells of size
+:paramtype:`cell_size`, which are further split by the dominant axis of the
+surface normal (so that the two sides of a wall do not share a cell). Only
+the cells that are actually reached by paths are stored, in a fixed-size hash
+table that all render threads update concurrently without locks. Every path
+records the radiance reflected at its purely diffuse vertices, divided by the
+albedo of the surface, which turns it into a (scaled) irradiance estimate that
+is independent of textures.
+
+The image is rendered in multiple passes (see the ``samples_per_pass``
+parameter). The first pass renders full paths and fills the cache. In all
+subsequent passes, paths that reach a diffuse surface at depth
+:paramtype:`cache_depth` or beyond are terminated there, and their remaining
+contribution is taken from the cache (the albedo at the vertex times the
+cached irradiance). The records of each pass are merged into the cache once
+the pass is done, hence the cache keeps improving over the course of the
+render. For example:
+
+.. code-block:: xml
+
+    <integrator type="radiance_cache">
+        <integer name="samples_per_pass" value="4"/>
+    </integrator>
+
+Terminating paths into the cache introduces bias (mostly a slight blurring
+of indirect illumination across a cell), but the number of traced rays drops
+substantially since long diffuse interreflections are replaced by a single
+lookup.
+
+.. note:: This integrator does not handle participating media and is only
+   available in the scalar RGB and monochromatic variants.
+
+ */
+
+template <typename Float, typename Spectrum>
+class RadianceCacheIntegrator : public MonteCarloIntegrator<Float, Spectrum> {
+public:
+    MTS_IMPORT_BASE(MonteCarloIntegrator, m_max_depth, m_rr_depth)
+    MTS_IMPORT_TYPES(Scene, Sensor, Sampler, Medium, Emitter, EmitterPtr, BSDF, BSDFPtr)
+
+    /// Number of color channels stored per cache entry
+    static constexpr size_t Channels = array_size_v<UnpolarizedSpectrum>;
+
+    /// Maximum number of table entries visited when looking up a cell
+    static constexpr uint32_t MaxProbes = 32;
+
+    /// Maximum number of vertices per path whose radiance is recorded
+    static constexpr size_t MaxVertices = 32;
+
+    /// Number of cells of the grid along each axis (20 bits of the key)
+    static constexpr int32_t GridResolution = 1 << 20;
+
+    // =============================================================
+    //! @{ \name Hash grid
+    // =============================================================
+
+    /// Entry of the hash table. A zero key marks an unused entry.
+    struct CacheEntry {
+        std::atomic<uint64_t> key;
+        std::atomic<ScalarFloat> value[Channels];
+        std::atomic<uint32_t> count;
+
+        CacheEntry() { clear(); }
+
+        void clear() {
+            key.store(0, std::memory_order_relaxed);
+            for (size_t i = 0; i < Channels; ++i)
+                value[i].store(0.f, std::memory_order_relaxed);
+            count.store(0, std::memory_order_relaxed);
+        }
+    };
+
+    /**
+     * \brief Lock-free hash table with open addressing (linear probing)
+     *
+     * Entries are claimed by atomically setting their key and are never
+     * removed, hence concurrent insertions and lookups don't need locks.
+     * When all probed entries are taken by other cells, records are dropped.
+     */
+    struct HashGrid {
+        std::unique_ptr<CacheEntry[]> entries;
+        uint32_t mask;
+
+        HashGrid(uint32_t size) : entries(new CacheEntry[size]), mask(size - 1) { }
+
+        /// Find the entry of the given cell, optionally claiming a new one
+        CacheEntry *find(uint64_t key, bool insert) {
+            // Finalizer of MurmurHash3 to spread neighboring cells over the table
+            uint64_t hash = key;
+            hash ^= hash >> 33;
+            hash *= 0xff51afd7ed558ccdull;
+            hash ^= hash >> 33;
+            hash *= 0xc4ceb9fe1a85ec53ull;
+            hash ^= hash >> 33;
+
+            uint32_t index = (uint32_t) hash & mask;
+            for (uint32_t i = 0; i < MaxProbes; ++i, index = (index + 1) & mask) {
+                CacheEntry &entry = entries[index];
+                uint64_t current = entry.key.load(std::memory_order_relaxed);
+                if (current == key)
+                    return &entry;
+                if (current == 0) {
+                    if (!insert)
+                        return nullptr;
+                    if (entry.key.compare_exchange_strong(current, key,
+                                                          std::memory_order_relaxed) ||
+                        current == key)
+                        return &entry;
+                }
+            }
+            return nullptr;
+        }
+
+        /// Add a record to the entry of the given cell
+        void record(uint64_t key, const ScalarFloat *value, uint32_t count = 1) {
+            CacheEntry *entry = find(key, true);
+            if (!entry)
+                return;
+            for (size_t i = 0; i < Channels; ++i) {
+                std::atomic<ScalarFloat> &sum = entry->value[i];
+                ScalarFloat current = sum.load(std::memory_order_relaxed);
+                while (!sum.compare_exchange_weak(current, current + value[i],
+                                                  std::memory_order_relaxed))
+                    ;
+            }
+            entry->count.fetch_add(count, std::memory_order_relaxed);
+        }
+    };
+
+    /// Diffuse path vertex whose reflected radiance is recorded into the cache
+    struct CacheVertex {
+        uint64_t key;
+        UnpolarizedSpectrum throughput, albedo, radiance;
+    };
+
+    //! @}
+    // =============================================================
+
+    RadianceCacheIntegrator(const Properties &props) : Base(props) {
+        if constexpr (is_array_v<Float> || is_spectral_v<Spectrum>)
+            Throw("The radiance cache is only available in the scalar RGB and "
+                  "monochromatic variants!");
+
+        m_cell_size = props.float_("cell_size", 0.f);
+        if (m_cell_size < 0.f)
+            Throw("\"cell_size\" must be positive!");
+
+        size_t cache_size = props.size_("cache_size", 1 << 20);
+        if (cache_size == 0 || cache_size > (1u << 31))
+            Throw("\"cache_size\" must lie in [1, 2^31]!");
+        m_cache_size = math::round_to_power_of_two((uint32_t) cache_size);
+
+        m_cache_depth = props.int_("cache_depth", 2);
+        if (m_cache_depth < 1)
+            Throw("\"cache_depth\" must be at least 1!");
+
+        m_min_samples = (uint32_t) props.size_("min_samples", 16);
+    }
+
+    bool render(Scene *scene, Sensor *sensor) override {
+        // Fill the cache of every render from scratch
+        ScalarBoundingBox3f bbox = scene->bbox();
+        ScalarFloat extent = bbox.valid() ? hmax(bbox.extents()) : 0.f;
+        if (!(extent > 0.f))
+            extent = 1.f;
+
+        m_cell = m_cell_size > 0.f ? m_cell_size : extent / 256.f;
+        m_origin = bbox.valid() ? bbox.min - ScalarVector3f(m_cell) : ScalarPoint3f(0.f);
+        m_cache.reset(new HashGrid(m_cache_size));
+        m_update.reset(new HashGrid(m_cache_size));
+        m_trained = false;
+
+        return Base::render(scene, sensor);
+    }
+
+    bool sequential_passes() const override { return true; }
+
+    void pass_finished(size_t pass, size_t pass_count) override {
+        if (pass + 1 >= pass_count)
+            return;
+
+        // Merge the records of the pass into the cache used by the next passes
+        size_t cells = 0;
+        for (uint32_t i = 0; i <= m_update->mask; ++i) {
+            CacheEntry &entry = m_update->entries[i];
+            uint64_t key = entry.key.load(std::memory_order_relaxed);
+            if (key == 0)
+                continue;
+
+            ScalarFloat value[Channels];
+            for (size_t j = 0; j < Channels; ++j)
+                value[j] = entry.value[j].load(std::memory_order_relaxed);
+            m_cache->record(key, value, entry.count.load(std::memory_order_relaxed));
+            entry.clear();
+            cells++;
+        }
+        m_trained = true;
+
+        Log(Debug, "Radiance cache after pass %i: %i cells were updated.", pass + 1, cells);
+    }
+
+    std::pair<Spectrum, Mask> sample(const Scene *scene,
+                                     Sampler *sampler,
+                                     const RayDifferential3f &ray,
+                                     const Medium * /* medium */,
+                                     Float * /* aovs */,
+                                     Mask active) const override {
+        MTS_MASKED_FUNCTION(ProfilerPhase::SamplingIntegratorSample, active);
+
+        if constexpr (!is_array_v<Float> && !is_spectral_v<Spectrum>) {
+            if (!active)
+                return { Spectrum(0.f), false };
+            return sample_cached(scene, sampler, ray);
+        } else {
+            ENOKI_MARK_USED(scene);
+            ENOKI_MARK_USED(sampler);
+            ENOKI_MARK_USED(ray);
+            Throw("The radiance cache is only available in the scalar RGB and "
+                  "monochromatic variants!");
+        }
+    }
+
+    /// Scalar implementation of \ref sample()
+    std::pair<Spectrum, Mask> sample_cached(const Scene *scene,
+                                            Sampler *sampler,
+                                            const RayDifferential3f &ray_) const {
+        RayDifferential3f ray = ray_;
+        Float eta(1.f), emission_weight(1.f);
+        Spectrum throughput(1.f), result(0.f);
+
+        SurfaceInteraction3f si = this->ray_intersect_primary(scene, ray);
+        Mask valid_ray = si.is_valid();
+        EmitterPtr emitter = si.emitter(scene);
+
+        // Diffuse vertices whose reflected radiance is recorded into the cache
+        CacheVertex vertices[MaxVertices];
+        size_t vertex_count = 0;
+
+        // Account for a contribution in the reflected radiance of all vertices
+        auto add_radiance = [&](const Spectrum &value) {
+            UnpolarizedSpectrum value_u = depolarize(value);
+            for (size_t i = 0; i < vertex_count; ++i)
+                vertices[i].radiance +=
+                    select(neq(vertices[i].throughput, 0.f),
+                           value_u / vertices[i].throughput, 0.f);
+        };
+
+        for (int depth = 1;; ++depth) {
+            // ---------------- Intersection with emitters ----------------
+
+            if (emitter) {
+                Spectrum emitted = emission_weight * throughput * emitter->eval(si);
+                result += emitted;
+                add_radiance(emitted);
+            }
+
+            if (!si.is_valid())
+                break;
+
+            BSDFContext ctx;
+            BSDFPtr bsdf = si.bsdf(ray);
+
+            /* Vertices on purely diffuse surfaces can be cached. The albedo
+               is the cosine-weighted BSDF value at normal incidence. */
+            UnpolarizedSpectrum albedo(0.f);
+            if (is_diffuse(bsdf->flags()))
+                albedo = depolarize(bsdf->eval(ctx, si, Vector3f(0.f, 0.f, 1.f))) *
+                         math::Pi<ScalarFloat>;
+            bool cacheable = any(albedo > 0.f);
+            uint64_t key = cacheable ? cell_key(si) : 0;
+
+            // --------------------- Cache lookup ---------------------
+
+            if (cacheable && m_trained && depth >= m_cache_depth) {
+                const CacheEntry *entry = m_cache->find(key, false);
+                uint32_t count = entry ? entry->count.load(std::memory_order_relaxed) : 0;
+                if (count > 0 && count >= m_min_samples) {
+                    UnpolarizedSpectrum irradiance;
+                    for (size_t i = 0; i < Channels; ++i)
+                        irradiance[i] = entry->value[i].load(std::memory_order_relaxed) /
+                                        (ScalarFloat) count;
+
+                    Spectrum cached = throughput * unpolarized<Spectrum>(albedo * irradiance);
+                    result += cached;
+                    add_radiance(cached);
+                    break;
+                }
+            }
+
+            /* Russian roulette: try to keep path weights equal to one,
+               while accounting for the solid angle compression at refractive
+               index boundaries. */
+            if (depth > m_rr_depth) {
+                Float q = min(hmax(depolarize(throughput)) * sqr(eta), .95f);
+                if (sampler->next_1d() >= q)
+                    break;
+                throughput *= rcp(q);
+            }
+
+            if ((uint32_t) depth >= (uint32_t) m_max_depth)
+                break;
+
+            // Remember the vertex, so that its reflected radiance can be recorded
+            if (cacheable && vertex_count < MaxVertices)
+                vertices[vertex_count++] = { key, depolarize(throughput), albedo,
+                                             UnpolarizedSpectrum(0.f) };
+
+            // --------------------- Emitter sampling ---------------------
+
+            if (has_flag(bsdf->flags(), BSDFFlags::Smooth)) {
+                auto [ds, emitter_val] =
+                    scene->sample_emitter_direction(si, sampler->next_2d(), true);
+
+                if (ds.pdf != 0.f) {
+                    Vector3f wo = si.to_local(ds.d);
+                    auto [bsdf_val, bsdf_pdf] = bsdf->eval_pdf(ctx, si, wo);
+                    bsdf_val = si.to_world_mueller(bsdf_val, -wo, si.wi);
+
+                    Float mis = ds.delta ? 1.f : mis_weight(ds.pdf, bsdf_pdf);
+                    Spectrum value = mis * throughput * bsdf_val * emitter_val;
+                    result += value;
+                    add_radiance(value);
+                }
+            }
+
+            // ----------------------- BSDF sampling ----------------------
+
+            auto [bs, bsdf_val] = bsdf->sample(ctx, si, sampler->next_1d(),
+                                               sampler->next_2d());
+            bsdf_val = si.to_world_mueller(bsdf_val, -bs.wo, si.wi);
+
+            throughput = throughput * bsdf_val;
+            if (!(bs.pdf > 0.f) || all(eq(depolarize(throughput), 0.f)))
+                break;
+
+            eta *= bs.eta;
+
+            // Intersect the BSDF ray against the scene geometry
+            ray = si.spawn_ray(si.to_world(bs.wo));
+            SurfaceInteraction3f si_bsdf = scene->ray_intersect(ray);
+
+            /* Determine probability of having sampled that same
+               direction using emitter sampling. */
+            emitter = si_bsdf.emitter(scene);
+            if (emitter) {
+                DirectionSample3f ds(si_bsdf, si);
+                ds.object = emitter;
+                Float emitter_pdf = has_flag(bs.sampled_type, BSDFFlags::Delta)
+                                        ? 0.f
+                                        : scene->pdf_emitter_direction(si, ds);
+                emission_weight = mis_weight(bs.pdf, emitter_pdf);
+            }
+
+            si = std::move(si_bsdf);
+        }
+
+        // Record the irradiance (reflected radiance divided by the albedo)
+        for (size_t i = 0; i < vertex_count; ++i) {
+            const CacheVertex &v = vertices[i];
+            UnpolarizedSpectrum irradiance =
+                select(v.albedo > 0.f, v.radiance / v.albedo, 0.f);
+            if (!all(enoki::isfinite(irradiance)))
+                continue;
+
+            ScalarFloat value[Channels];
+            for (size_t j = 0; j < Channels; ++j)
+                value[j] = irradiance[j];
+            m_update->record(v.key, value);
+        }
+
+        return { result, valid_ray };
+    }
+
+    /// Does the BSDF only scatter diffusely into the upper hemisphere?
+    static bool is_diffuse(uint32_t flags) {
+        return has_flag(flags, BSDFFlags::DiffuseReflection) &&
+               !has_flag(flags, BSDFFlags::Glossy) &&
+               !has_flag(flags, BSDFFlags::Delta) &&
+               !has_flag(flags, BSDFFlags::Delta1D) &&
+               !has_flag(flags, BSDFFlags::DiffuseTransmission);
+    }
+
+    /**
+     * \brief Key of the hash grid cell containing an interaction
+     *
+     * The key combines the integer cell coordinates (20 bits each) with the
+     * dominant axis and sign of the normal facing the incident direction.
+     */
+    uint64_t cell_key(const SurfaceInteraction3f &si) const {
+        Vector3f n = si.n;
+        if (dot(n, si.to_world(si.wi)) < 0.f)
+            n = -n;
+
+        Vector3f n_abs = abs(n);
+        uint32_t axis = n_abs.x() > n_abs.y() ? (n_abs.x() > n_abs.z() ? 0 : 2)
+                                              : (n_abs.y() > n_abs.z() ? 1 : 2);
+        uint64_t normal = axis * 2 + (n[axis] < 0.f ? 1 : 0);
+
+        ScalarVector3f pos = (si.p - m_origin) / m_cell;
+        uint64_t key = normal << 60;
+        for (size_t i = 0; i < 3; ++i) {
+            int32_t c = (int32_t) std::floor(
+                std::min(std::max(pos[i], 0.f), (ScalarFloat) (GridResolution - 1)));
+            key |= (uint64_t) c << (20 * i);
+        }
+
+        // Zero marks unused entries of the table
+        return key + 1;
+    }
+
+    //! @}
+    // =============================================================
+
+    std::string to_string() const override {
+        return tfm::format("RadianceCacheIntegrator[\n"
+            "  max_depth = %i,\n"
+            "  rr_depth = %i,\n"
+            "  cell_size = %f,\n"
+            "  cache_size = %i,\n"
+            "  cache_depth = %i,\n"
+            "  min_samples = %i\n"
+            "]", m_max_depth, m_rr_depth, m_cell_size, m_cache_size,
+            m_cache_depth, m_min_samples);
+    }
+
+    Float mis_weight(Float pdf_a, Float pdf_b) const {
+        pdf_a *= pdf_a;
+        pdf_b *= pdf_b;
+        return select(pdf_a > 0.f, pdf_a / (pdf_a + pdf_b), 0.f);
+    }
+
+    MTS_DECLARE_CLASS()
+protected:
+    /// Requested cell size (zero: derived from the scene's bounding box)
+    ScalarFloat m_cell_size;
+    uint32_t m_cache_size;
+    int m_cache_depth;
+    uint32_t m_min_samples;
+
+    /// Cell size and grid origin of the current render
+    ScalarFloat m_cell = 1.f;
+    ScalarPoint3f m_origin = 0.f;
+
+    /// Cache filled by the finished passes (only read while rendering a pass)
+    std::unique_ptr<HashGrid> m_cache;
+
+    /// Records of the current pass, merged into \ref m_cache after each pass
+    std::unique_ptr<HashGrid> m_update;
+
+    /// Whether the cache contains data of a finished pass
+    bool m_trained = false;
+};
+
+MTS_IMPLEMENT_CLASS_VARIANT(RadianceCacheIntegrator, MonteCarloIntegrator)
+MTS_EXPORT_PLUGIN(RadianceCacheIntegrator, "Radiance cache path tracer integrator");
+NAMESPACE_END(mitsuba)
@@ -0,0 +1,697 @@
+#include <atomic>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/profiler.h>
+#include <mitsuba/core/progress.h>
+#include <mitsuba/core/spectrum.h>
+#include <mitsuba/core/thread.h>
+#include <mitsuba/core/timer.h>
+#include <mitsuba/core/util.h>
+#include <mitsuba/render/bsdf.h>
+#include <mitsuba/render/emitter.h>
+#include <mitsuba/render/film.h>
+#include <mitsuba/render/imageblock.h>
+#include <mitsuba/render/integrator.h>
+#include <mitsuba/render/records.h>
+#include <mitsuba/render/sampler.h>
+#include <mitsuba/render/scene.h>
+#include <mitsuba/render/sensor.h>
+#include <tbb/blocked_range.h>
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/parallel_for.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+
+.. _integrator-sppm:
+
+Stochastic progressive photon mapping (:monosp:`sppm`)
+------------------------------------------------------
+
+.. pluginparameters::
+
+ * - max_depth
+   - |int|
+   - Specifies the longest path depth in the generated output image (where -1 corresponds to
+     :math:`\infty`). A value of 1 will only render directly visible light sources. 2 will lead
+     to single-bounce (direct-only) illumination, and so on. (Default: -1)
+ * - rr_depth
+   - |int|
+   - Specifies the minimum path depth, after which the implementation will start to use the
+     *russian roulette* path termination criterion. (Default: 5)
+ * - photon_count
+   - |int|
+   - Number of photons that are shot in every pass. (Default: 250000)
+ * - initial_radius
+   - |float|
+   - Initial radius of the photon lookups in world space units. (Default: 0, i.e. five times
+     the size of a pixel projected onto the bounding sphere of the scene)
+ * - alpha
+   - |float|
+   - Fraction of the photons of every pass that is kept when the lookup radius is reduced.
+     Must lie in :math:`(0, 1)`, smaller values shrink the radius faster. (Default: 0.7)
+
+This integrator implements stochastic progressive photon mapping (Hachisuka and Jensen 2009).
+It renders paths that are notoriously hard to find from the sensor, in particular caustics
+caused by :ref:`dielectric <bsdf-dielectric>` or :ref:`conductor <bsdf-conductor>` surfaces
+and caustics that are themselves only visible through specular reflection or refraction
+(e.g. light focused by a glass onto a table, seen through the glass).
+
+Each pass consists of three steps, where the number of passes is given by the sample count of
+the sensor's sampler:
+
+1. A ray is traced through every pixel until it reaches a surface with a non-specular BSDF,
+   which becomes the *visible point* of the pixel. Emission and direct illumination are
+   accumulated along the way.
+2. Photons are traced from the emitters using ``Scene::sample_emitter_ray()`` and deposited
+   on all non-specular surfaces except the first one they hit.
+3. The photons are sorted into a spatial hash grid, and every pixel gathers the photons that
+   lie within its current radius around the visible point. The radius and the accumulated
+   flux of the pixel are then reduced following the progressive update rule.
+
+All three steps run in parallel. The photons are traced into per-thread buffers, and the hash
+grid is rebuilt in every pass by a counting sort that stores the photons of every grid cell
+contiguously in separate arrays per component. The density estimation therefore only streams
+over a few short, contiguous arrays and needs no synchronization, since every pixel only
+updates its own statistics.
+
+The estimate is biased, but consistent: the error vanishes as the number of passes grows.
+Low pass counts produce blotchy artifacts in indirectly lit regions, and large radii blur
+the illumination close to geometric edges.
+
+.. note:: This integrator is only available in the scalar RGB and monochromatic variants, and
+   does not support environment or directional emitters and participating media. Pixels are
+   not reconstructed with the film's filter, but directly written to the film.
+
+ */
+
+template <typename Float, typename Spectrum>
+class SPPMIntegrator final : public Integrator<Float, Spectrum> {
+public:
+    MTS_IMPORT_BASE(Integrator)
+    MTS_IMPORT_TYPES(Scene, Sensor, Film, ImageBlock, Sampler, Emitter, EmitterPtr, Shape,
+                     BSDF, BSDFPtr)
+
+    /// Visible point of a pixel along with its progressive statistics
+    struct Pixel {
+        /// Surface that gathers the photons of the current pass
+        SurfaceInteraction3f si;
+
+        /// Throughput of the camera subpath up to the visible point
+        Spectrum beta;
+
+        /// Number of edges of the camera subpath
+        uint32_t depth;
+
+        /// Emission and direct illumination of the current pass
+        Spectrum ld;
+
+        /// Did the current pass find a visible point / hit any surface?
+        bool valid, hit;
+
+        /// Emission and direct illumination, summed over all passes
+        Spectrum direct;
+
+        /// Accumulated flux, photon count and radius of the lookups
+        Spectrum flux;
+        Float photons, radius;
+
+        /// Number of passes where the camera ray hit the scene
+        uint32_t hits;
+    };
+
+    /// Photon of the current pass
+    struct Photon {
+        Point3f p;
+
+        /// Direction towards the previous vertex of the light subpath
+        Vector3f wi;
+
+        Spectrum power;
+
+        /// Number of edges of the light subpath
+        uint32_t depth;
+    };
+
+    /// Photons of the current pass, ordered by the hash bucket of their grid cell
+    struct PhotonGrid {
+        std::vector<Float> x, y, z;
+        std::vector<Vector3f> wi;
+        std::vector<Spectrum> power;
+        std::vector<uint32_t> depth;
+
+        /// Index of the first photon of every bucket (plus a final entry)
+        std::vector<uint32_t> offsets;
+
+        ScalarPoint3f origin;
+        ScalarFloat inv_cell_size;
+        uint32_t bucket_mask;
+    };
+
+    SPPMIntegrator(const Properties &props) : Base(props) {
+        if constexpr (is_array_v<Float> || is_spectral_v<Spectrum> || is_polarized_v<Spectrum>)
+            Throw("The photon mapper is only available in the scalar RGB and monochromatic "
+                  "variants!");
+
+        m_max_depth = props.int_("max_depth", -1);
+        if (m_max_depth < 0 && m_max_depth != -1)
+            Throw("\"max_depth\" must be set to -1 (infinite) or a value >= 0");
+
+        m_rr_depth = props.int_("rr_depth", 5);
+        if (m_rr_depth <= 0)
+            Throw("\"rr_depth\" must be set to a value greater than zero!");
+
+        m_photon_count = props.size_("photon_count", 250000);
+        if (m_photon_count == 0 || m_photon_count > 0x7fffffffu)
+            Throw("\"photon_count\" must be a positive 31 bit integer!");
+
+        m_initial_radius = props.float_("initial_radius", 0.f);
+        if (m_initial_radius < 0.f)
+            Throw("\"initial_radius\" must not be negative!");
+
+        m_alpha = props.float_("alpha", .7f);
+        if (!(m_alpha > 0.f && m_alpha < 1.f))
+            Throw("\"alpha\" must lie in the open interval (0, 1)!");
+    }
+
+    bool render(Scene *scene, Sensor *sensor) override {
+        ScopedPhase sp(ProfilerPhase::Render);
+        m_stop = false;
+
+        if constexpr (!is_array_v<Float> && !is_spectral_v<Spectrum> &&
+                      !is_polarized_v<Spectrum>) {
+            for (Emitter *emitter : scene->emitters()) {
+                if (has_flag(emitter->flags(), EmitterFlags::Infinite) ||
+                    has_flag(emitter->flags(), EmitterFlags::DeltaDirection))
+                    Throw("The photon mapper does not support environment or directional "
+                          "emitters!");
+            }
+
+            if (sensor->medium())
+                Throw("The photon mapper does not support participating media!");
+            for (Shape *shape : scene->shapes()) {
+                if (shape->is_medium_transition())
+                    Throw("The photon mapper does not support participating media!");
+            }
+
+            ref<Film> film = sensor->film();
+            ScalarVector2i film_size = film->crop_size();
+            size_t pixel_count = hprod(film_size),
+                   pass_count  = sensor->sampler()->sample_count();
+
+            film->prepare({ "X", "Y", "Z", "A", "W" });
+
+            ScalarFloat radius = m_initial_radius;
+            if (radius == 0.f) {
+                ScalarFloat scene_radius = norm(scene->bbox().extents()) * .5f;
+                radius = 5.f * scene_radius / hmax(film_size);
+            }
+
+            std::unique_ptr<Pixel[]> pixels(new Pixel[pixel_count]);
+            for (size_t i = 0; i < pixel_count; ++i) {
+                Pixel &pixel   = pixels[i];
+                pixel.valid    = pixel.hit = false;
+                pixel.direct   = 0.f;
+                pixel.flux     = 0.f;
+                pixel.photons  = 0.f;
+                pixel.radius   = radius;
+                pixel.hits     = 0;
+            }
+
+            Log(Info, "Starting render job (%ix%i, %i pass%s, %i photons per pass, %i thread%s)",
+                film_size.x(), film_size.y(), pass_count, pass_count == 1 ? "" : "es",
+                m_photon_count, __global_thread_count, __global_thread_count == 1 ? "" : "s");
+
+            ThreadEnvironment env;
+            ref<ProgressReporter> progress = new ProgressReporter("Rendering");
+            Timer timer;
+
+            size_t passes_done = 0;
+            for (size_t pass = 0; pass < pass_count && !m_stop; ++pass) {
+                trace_camera_paths(scene, sensor, pixels.get(), pass, env);
+                if (m_stop)
+                    break;
+
+                PhotonGrid grid = trace_photons(scene, sensor, pixels.get(), pass, env);
+                if (m_stop)
+                    break;
+
+                gather_photons(grid, pixels.get(), pixel_count);
+                passes_done++;
+                progress->update(passes_done / (ScalarFloat) pass_count);
+            }
+
+            if (passes_done > 0)
+                develop(film, pixels.get(), passes_done);
+
+            Log(Info, "Rendering finished. (took %s)",
+                util::time_string(timer.value(), true));
+        } else {
+            ENOKI_MARK_USED(scene);
+            ENOKI_MARK_USED(sensor);
+            Throw("The photon mapper is only available in the scalar RGB and monochromatic "
+                  "variants!");
+        }
+
+        return !m_stop;
+    }
+
+    void cancel() override { m_stop = true; }
+
+    std::string to_string() const override {
+        std::ostringstream oss;
+        oss << "SPPMIntegrator[" << std::endl
+            << "  max_depth = " << m_max_depth << "," << std::endl
+            << "  rr_depth = " << m_rr_depth << "," << std::endl
+            << "  photon_count = " << m_photon_count << "," << std::endl
+            << "  initial_radius = " << m_initial_radius << "," << std::endl
+            << "  alpha = " << m_alpha << std::endl
+            << "]";
+        return oss.str();
+    }
+
+    MTS_DECLARE_CLASS()
+
+protected:
+    /// Seed of the camera and light subpaths of a pass
+    uint64_t path_seed(size_t pixel_count, size_t pass, size_t index) const {
+        return (uint64_t) pass * (pixel_count + m_photon_count) + index;
+    }
+
+    // =============================================================
+    //! @{ \name Camera pass
+    // =============================================================
+
+    void trace_camera_paths(const Scene *scene, const Sensor *sensor, Pixel *pixels,
+                            size_t pass, ThreadEnvironment &env) const {
+        ScalarVector2i film_size  = sensor->film()->crop_size();
+        ScalarPoint2i crop_offset = sensor->film()->crop_offset();
+        size_t pixel_count        = hprod(film_size);
+
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, pixel_count, 64),
+            [&](const tbb::blocked_range<size_t> &range) {
+                ScopedSetThreadEnvironment set_env(env);
+                ref<Sampler> sampler = sensor->sampler()->clone();
+                sampler->set_pass_index((uint32_t) pass);
+                scoped_flush_denormals flush_denormals(true);
+
+                for (size_t i = range.begin(); i != range.end() && !m_stop; ++i) {
+                    ScalarPoint2u pos(uint32_t(i % film_size.x()), uint32_t(i / film_size.x()));
+                    sampler->seed(path_seed(pixel_count, pass, i));
+                    sampler->set_pixel(pos + ScalarPoint2u(crop_offset));
+                    trace_camera_path(scene, sensor, sampler, pos, film_size, pixels[i]);
+                }
+            });
+    }
+
+    /// Trace the camera subpath of a pixel up to its visible point
+    void trace_camera_path(const Scene *scene, const Sensor *sensor, Sampler *sampler,
+                           const ScalarPoint2u &pos, const ScalarVector2i &film_size,
+                           Pixel &pixel) const {
+        Point2f position_sample = (Point2f(pos) + sampler->next_2d()) / ScalarVector2f(film_size);
+
+        Point2f aperture_sample(.5f);
+        if (sensor->needs_aperture_sample())
+            aperture_sample = sampler->next_2d();
+
+        Float time = sensor->shutter_open();
+        if (sensor->shutter_open_time() > 0.f)
+            time += sampler->next_1d() * sensor->shutter_open_time();
+
+        Float wavelength_sample = sampler->next_1d();
+
+        auto [ray, ray_weight] =
+            sensor->sample_ray(time, wavelength_sample, position_sample, aperture_sample);
+
+        pixel.valid = pixel.hit = false;
+        pixel.ld = 0.f;
+
+        BSDFContext ctx;
+        Spectrum beta = ray_weight;
+        Float eta = 1.f;
+        bool specular = true;
+
+        // 'depth' is the number of edges of the path before tracing the next one
+        for (uint32_t depth = 0; depth < (uint32_t) m_max_depth; ++depth) {
+            SurfaceInteraction3f si = scene->ray_intersect(ray);
+
+            /* Emission is only counted when it can't have been found by
+               emitter sampling at the previous vertex */
+            EmitterPtr emitter = si.emitter(scene);
+            if (specular && emitter)
+                pixel.ld += beta * emitter->eval(si);
+
+            if (!si.is_valid())
+                break;
+            pixel.hit |= depth == 0;
+
+            BSDFPtr bsdf = si.bsdf(ray);
+            uint32_t flags = bsdf->flags();
+
+            // Emitter sampling (creates a path with 'depth + 2' edges)
+            if (has_flag(flags, BSDFFlags::Smooth) && depth + 2 <= (uint32_t) m_max_depth) {
+                auto [ds, emitter_val] = scene->sample_emitter_direction(si, sampler->next_2d(), true);
+                if (ds.pdf != 0.f) {
+                    Vector3f wo = si.to_local(ds.d);
+                    pixel.ld += beta * bsdf->eval(ctx, si, wo) * emitter_val;
+                }
+            }
+
+            /* Diffuse surfaces become the visible point, glossy ones are
+               traversed like specular ones, which avoids blurring glossy
+               reflections by the photon lookups */
+            if (has_flag(flags, BSDFFlags::Diffuse)) {
+                pixel.si    = si;
+                pixel.beta  = beta;
+                pixel.depth = depth + 1;
+                pixel.valid = true;
+                break;
+            }
+
+            auto [bs, bsdf_val] = bsdf->sample(ctx, si, sampler->next_1d(), sampler->next_2d());
+            beta *= bsdf_val;
+            eta *= bs.eta;
+            if (all(eq(beta, 0.f)))
+                break;
+
+            specular = has_flag(bs.sampled_type, BSDFFlags::Delta);
+
+            if (depth + 1 > (uint32_t) m_rr_depth) {
+                Float q = min(hmax(beta) * sqr(eta), .95f);
+                if (sampler->next_1d() >= q)
+                    break;
+                beta *= rcp(q);
+            }
+
+            ray = si.spawn_ray(si.to_world(bs.wo));
+        }
+    }
+
+    //! @}
+    // =============================================================
+
+    // =============================================================
+    //! @{ \name Photon pass
+    // =============================================================
+
+    PhotonGrid trace_photons(const Scene *scene, const Sensor *sensor, const Pixel *pixels,
+                             size_t pass, ThreadEnvironment &env) const {
+        size_t pixel_count = hprod(sensor->film()->crop_size());
+
+        tbb::enumerable_thread_specific<std::vector<Photon>> thread_photons;
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, m_photon_count, 256),
+            [&](const tbb::blocked_range<size_t> &range) {
+                ScopedSetThreadEnvironment set_env(env);
+                ref<Sampler> sampler = sensor->sampler()->clone();
+                sampler->set_pass_index((uint32_t) pass);
+                scoped_flush_denormals flush_denormals(true);
+                std::vector<Photon> &photons = thread_photons.local();
+
+                for (size_t i = range.begin(); i != range.end() && !m_stop; ++i) {
+                    sampler->seed(path_seed(pixel_count, pass, pixel_count + i));
+                    trace_photon(scene, sensor, sampler, photons);
+                }
+            });
+
+        // The grid cells are large enough so that every lookup touches at most 2x2x2 cells
+        ScalarFloat max_radius = 0.f;
+        for (size_t i = 0; i < pixel_count; ++i) {
+            if (pixels[i].valid)
+                max_radius = std::max(max_radius, pixels[i].radius);
+        }
+
+        PhotonGrid grid;
+        build_grid(scene, thread_photons, 2.f * max_radius, grid);
+        return grid;
+    }
+
+    /// Trace a photon from the emitters and deposit it on all non-specular surfaces
+    void trace_photon(const Scene *scene, const Sensor *sensor, Sampler *sampler,
+                      std::vector<Photon> &photons) const {
+        Float time = sensor->shutter_open();
+        if (sensor->shutter_open_time() > 0.f)
+            time += sampler->next_1d() * sensor->shutter_open_time();
+
+        auto [ray, power] = scene->sample_emitter_ray(time, sampler->next_1d(),
+                                                      sampler->next_2d(), sampler->next_2d());
+
+        BSDFContext ctx(TransportMode::Importance);
+
+        /* 'depth' is the number of edges of the light subpath after tracing
+           the next one. Every photon is seen through at least one camera edge */
+        for (uint32_t depth = 1; depth < (uint32_t) m_max_depth; ++depth) {
+            if (hmax(power) <= 0.f)
+                break;
+
+            SurfaceInteraction3f si = scene->ray_intersect(ray);
+            if (!si.is_valid())
+                break;
+
+            BSDFPtr bsdf = si.bsdf(ray);
+
+            // The first hit is already accounted for by emitter sampling
+            if (depth > 1 && has_flag(bsdf->flags(), BSDFFlags::Smooth))
+                photons.push_back({ si.p, -ray.d, power, depth });
+
+            auto [bs, bsdf_val] = bsdf->sample(ctx, si, sampler->next_1d(), sampler->next_2d());
+            Vector3f wo = si.to_world(bs.wo);
+            bsdf_val *= shading_normal_correction(si, wo);
+            Spectrum power_new = power * bsdf_val;
+
+            // Russian roulette, which keeps the power of the photons roughly constant
+            if (depth > (uint32_t) m_rr_depth) {
+                Float q = min(hmax(power_new) / hmax(power), 1.f);
+                if (sampler->next_1d() >= q)
+                    break;
+                power_new *= rcp(q);
+            }
+
+            power = power_new;
+            ray = si.spawn_ray(wo);
+        }
+    }
+
+    /**
+     * \brief Correction factor of the adjoint BSDF for shading normals
+     * (Veach's thesis, Section 5.3), where \c wo points away from \c si
+     */
+    static Float shading_normal_correction(const SurfaceInteraction3f &si, const Vector3f &wo) {
+        Vector3f wi = si.to_world(si.wi);
+        Float num   = abs_dot(wi, si.sh_frame.n) * abs_dot(wo, si.n),
+              denom = abs_dot(wi, si.n) * abs_dot(wo, si.sh_frame.n);
+        return denom != 0.f ? num / denom : 0.f;
+    }
+
+    //! @}
+    // =============================================================
+
+    // =============================================================
+    //! @{ \name Photon grid and density estimation
+    // =============================================================
+
+    static Point3i grid_cell(const PhotonGrid &grid, const Point3f &p) {
+        return floor2int<Point3i>((p - grid.origin) * grid.inv_cell_size);
+    }
+
+    static uint32_t grid_bucket(const PhotonGrid &grid, const Point3i &cell) {
+        uint32_t hash = ((uint32_t) cell.x() * 73856093u) ^
+                        ((uint32_t) cell.y() * 19349663u) ^
+                        ((uint32_t) cell.z() * 83492791u);
+        return hash & grid.bucket_mask;
+    }
+
+    /// Sort the photons of all threads into the hash grid (counting sort)
+    void build_grid(const Scene *scene,
+                    tbb::enumerable_thread_specific<std::vector<Photon>> &thread_photons,
+                    ScalarFloat cell_size, PhotonGrid &grid) const {
+        std::vector<const std::vector<Photon> *> lists;
+        std::vector<size_t> list_offsets;
+        size_t photon_count = 0;
+        for (const std::vector<Photon> &photons : thread_photons) {
+            lists.push_back(&photons);
+            list_offsets.push_back(photon_count);
+            photon_count += photons.size();
+        }
+
+        grid.origin        = scene->bbox().min;
+        grid.inv_cell_size = cell_size > 0.f ? rcp(cell_size) : 0.f;
+        grid.bucket_mask   = math::round_to_power_of_two((uint32_t) std::max(photon_count,
+                                                                            (size_t) 1)) - 1;
+
+        std::unique_ptr<uint32_t[]> buckets(new uint32_t[photon_count]);
+        std::unique_ptr<std::atomic<uint32_t>[]> counts(
+            new std::atomic<uint32_t>[grid.bucket_mask + 1]);
+        for (uint32_t i = 0; i <= grid.bucket_mask; ++i)
+            counts[i].store(0, std::memory_order_relaxed);
+
+        tbb::parallel_for(size_t(0), lists.size(), [&](size_t l) {
+            const std::vector<Photon> &photons = *lists[l];
+            for (size_t i = 0; i < photons.size(); ++i) {
+                uint32_t bucket = grid_bucket(grid, grid_cell(grid, photons[i].p));
+                buckets[list_offsets[l] + i] = bucket;
+                counts[bucket].fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+
+        // Exclusive prefix sum; 'counts' then serves as the insertion cursor of every bucket
+        grid.offsets.resize(grid.bucket_mask + 2);
+        uint32_t sum = 0;
+        for (uint32_t i = 0; i <= grid.bucket_mask; ++i) {
+            grid.offsets[i] = sum;
+            sum += counts[i].load(std::memory_order_relaxed);
+            counts[i].store(grid.offsets[i], std::memory_order_relaxed);
+        }
+        grid.offsets[grid.bucket_mask + 1] = sum;
+
+        grid.x.resize(photon_count);
+        grid.y.resize(photon_count);
+        grid.z.resize(photon_count);
+        grid.wi.resize(photon_count);
+        grid.power.resize(photon_count);
+        grid.depth.resize(photon_count);
+
+        tbb::parallel_for(size_t(0), lists.size(), [&](size_t l) {
+            const std::vector<Photon> &photons = *lists[l];
+            for (size_t i = 0; i < photons.size(); ++i) {
+                const Photon &photon = photons[i];
+                uint32_t j = counts[buckets[list_offsets[l] + i]].fetch_add(
+                    1, std::memory_order_relaxed);
+                grid.x[j]     = photon.p.x();
+                grid.y[j]     = photon.p.y();
+                grid.z[j]     = photon.p.z();
+                grid.wi[j]    = photon.wi;
+                grid.power[j] = photon.power;
+                grid.depth[j] = photon.depth;
+            }
+        });
+
+        Log(Debug, "Photon grid: %i photons in %i buckets, cell size %f.", photon_count,
+            grid.bucket_mask + 1, cell_size);
+    }
+
+    /// Density estimation at the visible points and progressive radius reduction
+    void gather_photons(const PhotonGrid &grid, Pixel *pixels, size_t pixel_count) const {
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, pixel_count, 64),
+            [&](const tbb::blocked_range<size_t> &range) {
+                BSDFContext ctx;
+                for (size_t i = range.begin(); i != range.end(); ++i) {
+                    Pixel &pixel = pixels[i];
+                    pixel.direct += pixel.ld;
+                    pixel.hits += pixel.hit ? 1 : 0;
+                    if (!pixel.valid)
+                        continue;
+
+                    const SurfaceInteraction3f &si = pixel.si;
+                    const BSDF *bsdf = si.bsdf();
+                    Float r2 = sqr(pixel.radius);
+                    Point3i lo = grid_cell(grid, si.p - pixel.radius),
+                            hi = grid_cell(grid, si.p + pixel.radius);
+
+                    // Up to 2x2x2 cells, some of which may share a bucket
+                    uint32_t visited[8];
+                    size_t visited_count = 0;
+
+                    Spectrum phi(0.f);
+                    Float m = 0.f;
+                    for (int z = lo.z(); z <= hi.z(); ++z) {
+                        for (int y = lo.y(); y <= hi.y(); ++y) {
+                            for (int x = lo.x(); x <= hi.x(); ++x) {
+                                uint32_t bucket = grid_bucket(grid, Point3i(x, y, z));
+                                if (std::find(visited, visited + visited_count, bucket) !=
+                                    visited + visited_count)
+                                    continue;
+                                if (visited_count < 8)
+                                    visited[visited_count++] = bucket;
+
+                                uint32_t begin = grid.offsets[bucket],
+                                         end   = grid.offsets[bucket + 1];
+                                for (uint32_t j = begin; j < end; ++j) {
+                                    Float dx = grid.x[j] - si.p.x(),
+                                          dy = grid.y[j] - si.p.y(),
+                                          dz = grid.z[j] - si.p.z();
+                                    if (dx * dx + dy * dy + dz * dz > r2 ||
+                                        pixel.depth + grid.depth[j] > (uint32_t) m_max_depth)
+                                        continue;
+
+                                    Vector3f wo = si.to_local(grid.wi[j]);
+                                    Float cos_theta = Frame3f::cos_theta(wo);
+                                    if (cos_theta == 0.f)
+                                        continue;
+
+                                    phi += bsdf->eval(ctx, si, wo) * grid.power[j] *
+                                           rcp(abs(cos_theta));
+                                    m += 1.f;
+                                }
+                            }
+                        }
+                    }
+
+                    if (m > 0.f) {
+                        Float photons = pixel.photons + m_alpha * m,
+                              radius  = pixel.radius * sqrt(photons / (pixel.photons + m));
+                        pixel.flux    = (pixel.flux + pixel.beta * phi) *
+                                        sqr(radius / pixel.radius);
+                        pixel.photons = photons;
+                        pixel.radius  = radius;
+                    }
+                }
+            });
+    }
+
+    //! @}
+    // =============================================================
+
+    /// Write the radiance estimates of all pixels to the film
+    void develop(Film *film, const Pixel *pixels, size_t pass_count) const {
+        ScalarVector2i film_size = film->crop_size();
+        size_t pixel_count = hprod(film_size);
+
+        ref<ImageBlock> block = new ImageBlock(film_size, 5, nullptr, true, true, false);
+        block->set_offset(film->crop_offset());
+        block->clear();
+
+        Float *data = block->data().data();
+        ScalarFloat inv_passes = 1.f / pass_count,
+                    inv_photons = 1.f / ((ScalarFloat) pass_count * m_photon_count);
+
+        for (size_t i = 0; i < pixel_count; ++i) {
+            const Pixel &pixel = pixels[i];
+            Spectrum result = pixel.direct * inv_passes;
+            if (pixel.photons > 0.f)
+                result += pixel.flux * inv_photons *
+                          rcp(math::Pi<ScalarFloat> * sqr(pixel.radius));
+
+            UnpolarizedSpectrum spec_u = depolarize(result);
+
+            Color3f xyz(0.f);
+            if constexpr (is_monochromatic_v<Spectrum>)
+                xyz = spec_u.x();
+            else if constexpr (is_rgb_v<Spectrum>)
+                xyz = srgb_to_xyz(spec_u);
+
+            Float *values = data + i * 5;
+            values[0] = xyz.x();
+            values[1] = xyz.y();
+            values[2] = xyz.z();
+            values[3] = pixel.hits * inv_passes;
+            values[4] = 1.f;
+        }
+
+        film->put(block);
+    }
+
+protected:
+    int m_max_depth;
+    int m_rr_depth;
+    size_t m_photon_count;
+    ScalarFloat m_initial_radius;
+    ScalarFloat m_alpha;
+    std::atomic<bool> m_stop;
+};
+
+MTS_IMPLEMENT_CLASS_VARIANT(SPPMIntegrator, Integrator)
+MTS_EXPORT_PLUGIN(SPPMIntegrator, "Stochastic progressive photon mapper");
+NAMESPACE_END(mitsuba)
@@ -95,9 +95,18 @@ public:
             Vector3f current_basis = mueller::stokes_basis(-ray.d);
             Vector3f vertical = transform->eval(ray.time) * Vector3f(0.f, 1.f, 0.f);
             Vector3f target_basis = cross(ray.d, vertical);
-            spec = mueller::rotate_stokes_basis(-ray.d,
-                                                 current_basis,
-                                                 target_basis) * spec;
+            auto rotation = mueller::rotate_stokes_basis(-ray.d,
+                                                         current_basis,
+                                                         target_basis);
+
+            /* Only the Stokes vector (first column) is meaningful, so the
+               rotation is applied to it instead of the whole matrix */
+            auto stokes_in = spec.coeff(0);
+            for (size_t i = 0; i < 4; ++i) {
+                spec(i, 0) = rotation(i, 0) * stokes_in[0];
+                for (size_t k = 1; k < 4; ++k)
+                    spec(i, 0) += rotation(i, k) * stokes_in[k];
+            }
 
             auto const &stokes = spec.coeff(0);
             for (int i = 0; i < 4; ++i) {
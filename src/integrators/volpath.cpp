@@ -21,6 +21,7 @@ public:
                      Medium, MediumPtr, PhaseFunctionContext)
 
     VolumetricPathIntegrator(const Properties &props) : Base(props) {
+        m_use_spectral_mis = props.bool_("use_spectral_mis", true);
     }
 
     MTS_INLINE
@@ -35,6 +36,45 @@ public:
         return m;
     }
 
+    /// Uniformly choose the color channel that drives free-flight sampling
+    MTS_INLINE
+    UInt32 sample_channel(Sampler *sampler, Mask active) const {
+        uint32_t n_channels = (uint32_t) array_size_v<Spectrum>;
+        return (UInt32) min(sampler->next_1d(active) * n_channels, n_channels - 1);
+    }
+
+    /**
+     * \brief Probability of a free-flight sampling decision, given its density
+     * \c p for each of the channels
+     *
+     * With spectral MIS, a new channel is picked uniformly for every sampling
+     * decision in RGB modes, and the decision is weighted by the average over
+     * all channels (i.e. the one-sample balance heuristic). Chromatic media
+     * then no longer produce large weights when the chosen channel has a
+     * much lower extinction than one of the others.
+     */
+    MTS_INLINE
+    Float technique_pdf(const UnpolarizedSpectrum &p, const UInt32 &channel) const {
+        if constexpr (is_rgb_v<Spectrum>) {
+            if (m_use_spectral_mis)
+                return hmean(p);
+        }
+        return index_spectrum(p, channel);
+    }
+
+    /// Draw a new channel for the next medium event when using spectral MIS
+    MTS_INLINE
+    void resample_channel(UInt32 &channel, Sampler *sampler, Mask active) const {
+        if constexpr (is_rgb_v<Spectrum>) {
+            if (m_use_spectral_mis && any_or<true>(active))
+                masked(channel, active) = sample_channel(sampler, active);
+        } else {
+            ENOKI_MARK_USED(channel);
+            ENOKI_MARK_USED(sampler);
+            ENOKI_MARK_USED(active);
+        }
+    }
+
     std::pair<Spectrum, Mask> sample(const Scene *scene,
                                      Sampler *sampler,
                                      const RayDifferential3f &ray_,
@@ -61,10 +101,8 @@ public:
         UInt32 depth = 0;
 
         UInt32 channel = 0;
-        if (is_rgb_v<Spectrum>) {
-            uint32_t n_channels = (uint32_t) array_size_v<Spectrum>;
-            channel = (UInt32) min(sampler->next_1d(active) * n_channels, n_channels - 1);
-        }
+        if (is_rgb_v<Spectrum>)
+            channel = sample_channel(sampler, active);
 
         SurfaceInteraction3f si = zero<SurfaceInteraction3f>();
         si.t = math::Infinity<Float>;
@@ -101,7 +139,10 @@ public:
                 not_spectral = !is_spectral && active_medium;
             }
 
+            // Transmittance along the sampled segment (spectral extinction only)
+            UnpolarizedSpectrum tr(1.f);
             if (any_or<true>(active_medium)) {
+                resample_channel(channel, sampler, active_medium);
                 mi = medium->sample_interaction(ray, sampler->next_1d(active_medium), channel, active_medium);
                 masked(ray.maxt, active_medium && medium->is_homogeneous() && mi.is_valid()) = mi.t;
                 Mask intersect = needs_intersection && active_medium;
@@ -110,25 +151,32 @@ public:
                 needs_intersection &= !active_medium;
 
                 masked(mi.t, active_medium && (si.t < mi.t)) = math::Infinity<Float>;
-                if (any_or<true>(is_spectral)) {
-                    auto [tr, free_flight_pdf] = medium->eval_tr_and_pdf(mi, si, is_spectral);
-                    Float tr_pdf = index_spectrum(free_flight_pdf, channel);
-                    masked(throughput, is_spectral) *= select(tr_pdf > 0.f, tr / tr_pdf, 0.f);
-                }
-
                 escaped_medium = active_medium && !mi.is_valid();
                 active_medium &= mi.is_valid();
 
+                /* The weights of spectral media are applied once the type of
+                   the event is known, since the probability of choosing a null
+                   or a real collision also depends on the sampling channel */
+                if (any_or<true>(is_spectral)) {
+                    UnpolarizedSpectrum free_flight_pdf;
+                    std::tie(tr, free_flight_pdf) = medium->eval_tr_and_pdf(mi, si, is_spectral);
+                    Mask escaped = is_spectral && escaped_medium;
+                    Float tr_pdf = technique_pdf(free_flight_pdf, channel);
+                    masked(throughput, escaped) *= select(tr_pdf > 0.f, tr / tr_pdf, 0.f);
+                }
+
                 // Handle null and real scatter events
                 Mask null_scatter = sampler->next_1d(active_medium) >= index_spectrum(mi.sigma_t, channel) / index_spectrum(mi.combined_extinction, channel);
 
                 act_null_scatter |= null_scatter && active_medium;
                 act_medium_scatter |= !act_null_scatter && active_medium;
 
-                if (any_or<true>(is_spectral && act_null_scatter))
+                if (any_or<true>(is_spectral && act_null_scatter)) {
+                    UnpolarizedSpectrum f = tr * mi.sigma_n;
+                    Float pdf = technique_pdf(f, channel);
                     masked(throughput, is_spectral && act_null_scatter) *=
-                        mi.sigma_n * index_spectrum(mi.combined_extinction, channel) /
-                        index_spectrum(mi.sigma_n, channel);
+                        select(pdf > 0.f, f / pdf, 0.f);
+                }
 
                 masked(depth, act_medium_scatter) += 1;
             }
@@ -144,9 +192,11 @@ public:
             }
 
             if (any_or<true>(act_medium_scatter)) {
-                if (any_or<true>(is_spectral))
+                if (any_or<true>(is_spectral && act_medium_scatter)) {
+                    Float pdf = technique_pdf(tr * mi.sigma_t, channel);
                     masked(throughput, is_spectral && act_medium_scatter) *=
-                        mi.sigma_s * index_spectrum(mi.combined_extinction, channel) / index_spectrum(mi.sigma_t, channel);
+                        select(pdf > 0.f, tr * mi.sigma_s / pdf, 0.f);
+                }
                 if (any_or<true>(not_spectral))
                     masked(throughput, not_spectral && act_medium_scatter) *= mi.sigma_s / mi.sigma_t;
 
@@ -291,22 +341,31 @@ public:
             Mask active_surface = active && !active_medium;
 
             if (any_or<true>(active_medium)) {
+                resample_channel(channel, sampler, active_medium);
                 auto mi = medium->sample_interaction(ray, sampler->next_1d(active_medium), channel, active_medium);
-                masked(ray.maxt, active_medium && medium->is_homogeneous() && mi.is_valid()) = min(mi.t, remaining_dist);
                 Mask intersect = needs_intersection && active_medium;
                 if (any_or<true>(intersect))
-                    masked(si, intersect) = scene->ray_intersect(ray, intersect);
+                    masked(si, intersect) = scene->ray_intersect(ray, HitComputeFlags::Connection, intersect);
 
                 masked(mi.t, active_medium && (si.t < mi.t)) = math::Infinity<Float>;
                 needs_intersection &= !active_medium;
 
-                Mask is_spectral = medium->has_spectral_extinction() && active_medium;
+                // The transmittance of homogeneous media is known in closed form:
+                // skip the tracking and continue directly to the next surface
+                Mask homogeneous = active_medium && medium->is_homogeneous();
+                if (any_or<true>(homogeneous)) {
+                    masked(transmittance, homogeneous) *=
+                        homogeneous_transmittance(mi, min(remaining_dist, si.t) - mi.mint);
+                    masked(mi.t, homogeneous) = math::Infinity<Float>;
+                }
+
+                Mask is_spectral = medium->has_spectral_extinction() && active_medium && !homogeneous;
                 Mask not_spectral = !is_spectral && active_medium;
                 if (any_or<true>(is_spectral)) {
                     Float t      = min(remaining_dist, min(mi.t, si.t)) - mi.mint;
                     UnpolarizedSpectrum tr  = exp(-t * mi.combined_extinction);
                     UnpolarizedSpectrum free_flight_pdf = select(si.t < mi.t || mi.t > remaining_dist, tr, tr * mi.combined_extinction);
-                    Float tr_pdf = index_spectrum(free_flight_pdf, channel);
+                    Float tr_pdf = technique_pdf(free_flight_pdf, channel);
                     masked(transmittance, is_spectral) *= select(tr_pdf > 0.f, tr / tr_pdf, 0.f);
                 }
 
@@ -336,7 +395,7 @@ public:
             // Handle interactions with surfaces
             Mask intersect = active_surface && needs_intersection;
             if (any_or<true>(intersect))
-                masked(si, intersect)    = scene->ray_intersect(ray, intersect);
+                masked(si, intersect)    = scene->ray_intersect(ray, HitComputeFlags::Connection, intersect);
             needs_intersection &= !intersect;
             active_surface |= escaped_medium;
             masked(total_dist, active_surface) += si.t;
@@ -388,19 +447,27 @@ public:
             Mask active_surface = active && !active_medium;
             SurfaceInteraction3f si_medium;
             if (any_or<true>(active_medium)) {
+                resample_channel(channel, sampler, active_medium);
                 auto mi = medium->sample_interaction(ray, sampler->next_1d(active_medium), channel, active_medium);
-                masked(ray.maxt, active_medium && medium->is_homogeneous() && mi.is_valid()) = mi.t;
                 Mask intersect = needs_intersection && active_medium;
                 if (any_or<true>(intersect))
-                    masked(si, intersect) = scene->ray_intersect(ray, intersect);
+                    masked(si, intersect) = scene->ray_intersect(ray, HitComputeFlags::Connection, intersect);
 
                 masked(mi.t, active_medium && (si.t < mi.t)) = math::Infinity<Float>;
 
-                Mask is_spectral = medium->has_spectral_extinction() && active_medium;
+                // Closed-form transmittance up to the next surface (see sample_emitter())
+                Mask homogeneous = active_medium && medium->is_homogeneous();
+                if (any_or<true>(homogeneous)) {
+                    masked(transmittance, homogeneous) *=
+                        homogeneous_transmittance(mi, si.t - mi.mint);
+                    masked(mi.t, homogeneous) = math::Infinity<Float>;
+                }
+
+                Mask is_spectral = medium->has_spectral_extinction() && active_medium && !homogeneous;
                 Mask not_spectral = !is_spectral && active_medium;
                 if (any_or<true>(is_spectral)) {
                     auto [tr, free_flight_pdf] = medium->eval_tr_and_pdf(mi, si, is_spectral);
-                    Float tr_pdf = index_spectrum(free_flight_pdf, channel);
+                    Float tr_pdf = technique_pdf(free_flight_pdf, channel);
                     masked(transmittance, is_spectral) *= select(tr_pdf > 0.f, tr / tr_pdf, 0.f);
                 }
 
@@ -422,7 +489,7 @@ public:
 
             // Handle interactions with surfaces
             Mask intersect = active_surface && needs_intersection;
-            masked(si, intersect)    = scene->ray_intersect(ray, intersect);
+            masked(si, intersect)    = scene->ray_intersect(ray, HitComputeFlags::Connection, intersect);
             needs_intersection &= !intersect;
             active_surface |= escaped_medium;
 
@@ -465,15 +532,22 @@ public:
     }
 
 
+    /// Transmittance of a homogeneous medium over a distance \c t (which may be infinite)
+    MTS_INLINE
+    UnpolarizedSpectrum homogeneous_transmittance(const MediumInteraction3f &mi, Float t) const {
+        return exp(-select(neq(mi.combined_extinction, 0.f), t * mi.combined_extinction, 0.f));
+    }
+
     //! @}
     // =============================================================
 
     std::string to_string() const override {
         return tfm::format("VolumetricSimplePathIntegrator[\n"
                            "  max_depth = %i,\n"
-                           "  rr_depth = %i\n"
+                           "  rr_depth = %i,\n"
+                           "  use_spectral_mis = %s\n"
                            "]",
-                           m_max_depth, m_rr_depth);
+                           m_max_depth, m_rr_depth, m_use_spectral_mis);
     }
 
     Float mis_weight(Float pdf_a, Float pdf_b) const {
@@ -483,6 +557,8 @@ public:
     };
 
     MTS_DECLARE_CLASS()
+private:
+    bool m_use_spectral_mis;
 };
 
 MTS_IMPLEMENT_CLASS_VARIANT(VolumetricPathIntegrator, MonteCarloIntegrator);
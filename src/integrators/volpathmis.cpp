@@ -24,7 +24,39 @@ class VolpathMisIntegratorImpl;
 Volumetric path tracer with null scattering (:monosp:`volpath`)
 ---------------------------------------------------------------
 
-.. todo:: Not documented yet.
+.. pluginparameters::
+
+ * - max_depth
+   - |int|
+   - Specifies the longest path depth in the generated output image (where -1 corresponds to
+     :math:`\infty`). (Default: -1)
+ * - rr_depth
+   - |int|
+   - Specifies the minimum path depth, after which the implementation will start to use the
+     *russian roulette* path termination criterion. (Default: 5)
+ * - hide_emitters
+   - |bool|
+   - Hide directly visible emitters. (Default: no, i.e. |false|)
+ * - use_spectral_mis
+   - |bool|
+   - Combine the sampling techniques of all wavelengths using spectral multiple importance
+     sampling. (Default: |true|)
+ * - equiangular
+   - |bool|
+   - Use equiangular sampling for point and spot lights inside participating media.
+     (Default: |false|)
+ * - equiangular_samples
+   - |int|
+   - Number of equiangular light samples per ray segment. (Default: 1)
+
+Free-flight sampling rarely places scattering events close to small light sources, which makes
+e.g. spot lights in fog converge very slowly. When :monosp:`equiangular` is enabled, point and spot
+lights (i.e. emitters with a delta position) are no longer sampled from the scattering events in
+media. Instead, for every ray segment that crosses a medium, the integrator picks one of these
+lights and places :monosp:`equiangular_samples` stratified points along the segment with a density
+proportional to the inverse squared distance to the light :cite:`Kulla2012Importance`.
+A single ratio tracking walk along the segment estimates the transmittance to all of these points
+in turn, so only the shadow rays towards the light are traced per sample.
 */
 template <typename Float, typename Spectrum>
 class VolumetricMisPathIntegrator final : public MonteCarloIntegrator<Float, Spectrum> {
@@ -62,14 +94,32 @@ class VolpathMisIntegratorImpl final : public MonteCarloIntegrator<Float, Spectr
 
 public:
     MTS_IMPORT_BASE(MonteCarloIntegrator, m_max_depth, m_rr_depth, m_hide_emitters)
-    MTS_IMPORT_TYPES(Scene, Sampler, Emitter, EmitterPtr, BSDF, BSDFPtr,
+    MTS_IMPORT_TYPES(Scene, Sensor, Sampler, Emitter, EmitterPtr, BSDF, BSDFPtr,
                      Medium, MediumPtr, PhaseFunctionContext)
 
     using WeightMatrix =
         std::conditional_t<SpectralMis, Matrix<Float, array_size_v<UnpolarizedSpectrum>>,
                            UnpolarizedSpectrum>;
 
-    VolpathMisIntegratorImpl(const Properties &props) : Base(props) {}
+    VolpathMisIntegratorImpl(const Properties &props) : Base(props) {
+        m_equiangular = props.bool_("equiangular", false);
+        int equiangular_samples = props.int_("equiangular_samples", 1);
+        if (equiangular_samples < 1)
+            Throw("\"equiangular_samples\" must be at least 1!");
+        m_equiangular_samples = (uint32_t) equiangular_samples;
+    }
+
+    bool render(Scene *scene, Sensor *sensor) override {
+        // Collect the emitters handled by equiangular sampling
+        m_delta_emitters.clear();
+        if (m_equiangular) {
+            for (auto &emitter : scene->emitters()) {
+                if (has_flag(emitter->flags(), EmitterFlags::DeltaPosition))
+                    m_delta_emitters.push_back(emitter);
+            }
+        }
+        return Base::render(scene, sensor);
+    }
 
     MTS_INLINE
     Float index_spectrum(const UnpolarizedSpectrum &spec, const UInt32 &idx) const {
@@ -163,6 +213,23 @@ public:
                 not_spectral = !is_spectral && active_medium;
             }
 
+            // ------------------ Equiangular light sampling -------------------
+            bool equiangular = m_equiangular && !m_delta_emitters.empty();
+            if (equiangular) {
+                Mask segment = needs_intersection && active_medium;
+                if (any_or<true>(segment)) {
+                    // Find the end of the new segment, the intersection is reused below
+                    masked(si, segment) = scene->ray_intersect(ray, segment);
+                    needs_intersection &= !segment;
+
+                    Mask active_eq = segment && medium->use_emitter_sampling() &&
+                                     (depth + 1 < (uint32_t) m_max_depth);
+                    if (any_or<true>(active_eq))
+                        masked(result, active_eq) += sample_equiangular(
+                            scene, sampler, ray, si.t, medium, p_over_f, channel, active_eq);
+                }
+            }
+
             if (any_or<true>(active_medium)) {
                 mi = medium->sample_interaction(ray, sampler->next_1d(active_medium), channel, active_medium);
                 masked(ray.maxt, active_medium && medium->is_homogeneous() && mi.is_valid()) = mi.t;
@@ -226,7 +293,7 @@ public:
                     valid_ray |= act_medium_scatter;
                     Mask active_e = act_medium_scatter && sample_emitters;
                     if (any_or<true>(active_e)) {
-                        auto [p_over_f_nee_end, p_over_f_end, emitted, ds] = sample_emitter(mi, true, scene, sampler, medium, p_over_f, channel, active_e);
+                        auto [p_over_f_nee_end, p_over_f_end, emitted, ds] = sample_emitter(mi, true, scene, sampler, medium, p_over_f, channel, active_e, equiangular);
                         Float phase_val = phase->eval(phase_ctx, mi, ds.d, active_e);
                         update_weights(p_over_f_nee_end, 1.0f, phase_val, channel, active_e);
                         update_weights(p_over_f_end, select(ds.delta, 0.f, phase_val), phase_val, channel, active_e);
@@ -329,11 +396,30 @@ public:
 
 
     std::tuple<WeightMatrix, WeightMatrix, Spectrum, DirectionSample3f> sample_emitter(const Interaction3f &ref_interaction, Mask is_medium_interaction,
-                const Scene *scene, Sampler *sampler,  MediumPtr medium, const WeightMatrix &p_over_f, UInt32 channel, Mask active) const {
+                const Scene *scene, Sampler *sampler,  MediumPtr medium, const WeightMatrix &p_over_f, UInt32 channel, Mask active,
+                bool skip_delta_position = false) const {
         using EmitterPtr = replace_scalar_t<Float, const Emitter *>;
-        WeightMatrix p_over_f_nee = p_over_f, p_over_f_uni = p_over_f;
 
         auto [ds, emitter_sample_weight] = scene->sample_emitter_direction(ref_interaction, sampler->next_2d(active), false, active);
+        if (skip_delta_position) {
+            // Point and spot lights are handled by equiangular sampling instead
+            EmitterPtr emitter  = reinterpret_array<EmitterPtr>(ds.object);
+            Mask delta_position = active && has_flag(emitter->flags(active), EmitterFlags::DeltaPosition);
+            masked(ds.pdf, delta_position) = 0.f;
+        }
+        return trace_emitter_sample(ref_interaction, is_medium_interaction, scene, sampler, medium,
+                                    p_over_f, ds, emitter_sample_weight, channel, active);
+    }
+
+    /**
+     * \brief Compute the transmittance towards an emitter sample and return the
+     * weights of the NEE and unidirectional techniques along with the emitted radiance
+     */
+    std::tuple<WeightMatrix, WeightMatrix, Spectrum, DirectionSample3f> trace_emitter_sample(const Interaction3f &ref_interaction, Mask is_medium_interaction,
+                const Scene *scene, Sampler *sampler,  MediumPtr medium, const WeightMatrix &p_over_f,
+                const DirectionSample3f &ds, const Spectrum &emitter_sample_weight, UInt32 channel, Mask active) const {
+        WeightMatrix p_over_f_nee = p_over_f, p_over_f_uni = p_over_f;
+
         Spectrum emitter_val = emitter_sample_weight * ds.pdf;
         masked(emitter_val, eq(ds.pdf, 0.f)) = 0.f;
         active &= neq(ds.pdf, 0.f);
@@ -367,7 +453,7 @@ public:
                 masked(ray.maxt, active_medium && medium->is_homogeneous() && mi.is_valid()) = min(mi.t, remaining_dist);
                 Mask intersect = needs_intersection && active_medium;
                 if (any_or<true>(intersect))
-                    masked(si, intersect) = scene->ray_intersect(ray, intersect);
+                    masked(si, intersect) = scene->ray_intersect(ray, HitComputeFlags::Connection, intersect);
                 masked(mi.t, active_medium && (si.t < mi.t)) = math::Infinity<Float>;
                 needs_intersection &= !active_medium;
 
@@ -410,7 +496,7 @@ public:
             // Handle interactions with surfaces
             Mask intersect = active_surface && needs_intersection;
             if (any_or<true>(intersect))
-                masked(si, intersect)    = scene->ray_intersect(ray, intersect);
+                masked(si, intersect)    = scene->ray_intersect(ray, HitComputeFlags::Connection, intersect);
             active_surface |= escaped_medium;
             masked(total_dist, active_surface) += si.t;
 
@@ -443,6 +529,126 @@ public:
         return { p_over_f_nee, p_over_f_uni, emitter_val, ds};
     }
 
+    /**
+     * \brief Estimate the single scattered light of a point or spot light along
+     * a ray segment inside a medium
+     *
+     * The scattering locations are placed using stratified equiangular sampling
+     * with respect to a randomly chosen light. Since they are visited in
+     * increasing order along the segment, a single ratio tracking walk provides
+     * the transmittance estimates to all of them.
+     *
+     * \param maxt  Distance to the end of the segment (i.e. the next surface)
+     */
+    Spectrum sample_equiangular(const Scene *scene, Sampler *sampler, const Ray3f &ray,
+                                Float maxt, MediumPtr medium, const WeightMatrix &p_over_f,
+                                UInt32 channel, Mask active) const {
+        using EmitterPtr = replace_scalar_t<Float, const Emitter *>;
+        Spectrum result(0.f);
+
+        // Randomly pick one of the lights, which all have a delta position
+        uint32_t emitter_count = (uint32_t) m_delta_emitters.size();
+        UInt32 index = min(UInt32(sampler->next_1d(active) * (ScalarFloat) emitter_count),
+                           emitter_count - 1);
+        EmitterPtr emitter = gather<EmitterPtr>(m_delta_emitters.data(), index, active);
+
+        Interaction3f it = zero<Interaction3f>();
+        it.p           = ray.o;
+        it.time        = ray.time;
+        it.wavelengths = ray.wavelengths;
+        Point3f light_p = emitter->sample_direction(it, Point2f(.5f), active).first.p;
+
+        // Parameterize the segment by the angle as seen from the light
+        Float delta   = dot(light_p - ray.o, ray.d),
+              h       = max(norm(ray(delta) - light_p), math::RayEpsilon<Float>),
+              theta_a = atan2(ray.mint - delta, h),
+              theta_b = atan2(maxt - delta, h);
+        active &= theta_b > theta_a;
+
+        ScalarFloat inv_sample_count = 1.f / (ScalarFloat) m_equiangular_samples;
+        Float scale = (ScalarFloat) m_equiangular_samples / (ScalarFloat) emitter_count;
+
+        WeightMatrix p_over_f_walk = p_over_f;
+        Float t_walk = ray.mint;
+
+        PhaseFunctionContext phase_ctx(sampler);
+        auto phase = medium->phase_function();
+
+        for (uint32_t i = 0; i < m_equiangular_samples; ++i) {
+            if (none_or<false>(active))
+                break;
+
+            Float u     = (i + sampler->next_1d(active)) * inv_sample_count,
+                  theta = theta_a + u * (theta_b - theta_a),
+                  t     = min(delta + h * tan(theta), maxt),
+                  pdf   = h / ((theta_b - theta_a) * (sqr(h) + sqr(t - delta)));
+
+            // Continue the ratio tracking walk up to the new sample
+            Mask active_walk = active && t > t_walk;
+            while (any(active_walk)) {
+                Ray3f walk_ray(ray.o, ray.d, t_walk, t, ray.time, ray.wavelengths);
+                auto mi = medium->sample_interaction(walk_ray, sampler->next_1d(active_walk),
+                                                     channel, active_walk);
+                Mask collided = active_walk && mi.is_valid();
+
+                // The transmittance of homogeneous media is known in closed form
+                Mask homogeneous = active_walk && medium->is_homogeneous();
+                if (any_or<true>(homogeneous)) {
+                    UnpolarizedSpectrum tr = exp(-(t - t_walk) * mi.combined_extinction);
+                    update_weights(p_over_f_walk, 1.f, tr, channel, homogeneous);
+                    collided &= !homogeneous;
+                }
+
+                Mask is_spectral  = active_walk && !homogeneous && medium->has_spectral_extinction();
+                Mask not_spectral = active_walk && !homogeneous && !is_spectral;
+                if (any_or<true>(is_spectral)) {
+                    UnpolarizedSpectrum tr = exp(-(min(mi.t, t) - mi.mint) * mi.combined_extinction);
+                    UnpolarizedSpectrum free_flight_pdf = select(collided, tr * mi.combined_extinction, tr);
+                    update_weights(p_over_f_walk, free_flight_pdf, tr, channel, is_spectral);
+                    update_weights(p_over_f_walk, 1.f, mi.sigma_n, channel, is_spectral && collided);
+                }
+                if (any_or<true>(not_spectral))
+                    update_weights(p_over_f_walk, 1.f, mi.sigma_n / mi.combined_extinction, channel,
+                                   not_spectral && collided);
+
+                masked(t_walk, collided) = mi.t;
+                active &= any(neq(mis_weight(p_over_f_walk), 0.f));
+                active_walk = collided && active;
+            }
+            masked(t_walk, active) = max(t_walk, t);
+
+            // Scatter at the sampled location and connect it to the light
+            MediumInteraction3f mi = zero<MediumInteraction3f>();
+            mi.t           = t;
+            mi.p           = ray(t);
+            mi.sh_frame    = Frame3f(ray.d);
+            mi.wi          = -ray.d;
+            mi.time        = ray.time;
+            mi.wavelengths = ray.wavelengths;
+            mi.medium      = medium;
+            mi.mint        = ray.mint;
+            std::tie(mi.sigma_s, mi.sigma_n, mi.sigma_t) =
+                medium->get_scattering_coefficients(mi, active);
+            mi.combined_extinction = medium->get_combined_extinction(mi, active);
+
+            WeightMatrix p_over_f_scatter = p_over_f_walk;
+            update_weights(p_over_f_scatter, pdf * scale, mi.sigma_s, channel, active);
+
+            auto [ds, emitter_weight] = emitter->sample_direction(mi, sampler->next_2d(active), active);
+            auto [p_over_f_nee, p_over_f_uni, emitted, ds_nee] = trace_emitter_sample(
+                mi, true, scene, sampler, medium, p_over_f_scatter, ds, emitter_weight, channel, active);
+            ENOKI_MARK_USED(p_over_f_uni);
+            ENOKI_MARK_USED(ds_nee);
+
+            // Lights with a delta position can only be reached via NEE
+            Float phase_val = phase->eval(phase_ctx, mi, ds.d, active);
+            update_weights(p_over_f_nee, 1.f, phase_val, channel, active);
+            masked(result, active) += mis_weight(p_over_f_nee) * emitted;
+        }
+
+        return result;
+    }
+
     MTS_INLINE
     void update_weights(WeightMatrix &p_over_f,
                         const UnpolarizedSpectrum &p,
@@ -504,12 +710,21 @@ public:
     std::string to_string() const override {
         return tfm::format("VolumetricMisPathIntegrator[\n"
                            "  max_depth = %i,\n"
-                           "  rr_depth = %i\n"
+                           "  rr_depth = %i,\n"
+                           "  equiangular = %s,\n"
+                           "  equiangular_samples = %i\n"
                            "]",
-                           m_max_depth, m_rr_depth);
+                           m_max_depth, m_rr_depth, m_equiangular, m_equiangular_samples);
     }
 
     MTS_DECLARE_CLASS()
+
+private:
+    bool m_equiangular;
+    uint32_t m_equiangular_samples;
+
+    /// Point and spot lights that are sampled using equiangular sampling
+    host_vector<ref<Emitter>, Float> m_delta_emitters;
 };
 
 MTS_IMPLEMENT_CLASS_VARIANT(VolumetricMisPathIntegrator, MonteCarloIntegrator);
@@ -1,12 +1,16 @@
 #include <mitsuba/core/bitmap.h>
 #include <mitsuba/core/stream.h>
 #include <mitsuba/core/logger.h>
+#include <mitsuba/core/memreport.h>
 #include <mitsuba/core/util.h>
 #include <mitsuba/core/plugin.h>
 #include <mitsuba/core/rfilter.h>
 #include <mitsuba/core/transform.h>
 #include <mitsuba/core/fstream.h>
+#include <mitsuba/core/bstream.h>
+#include <mitsuba/core/mstream.h>
 #include <tbb/tbb.h>
+#include <atomic>
 #include <unordered_map>
 
 /* libpng */
@@ -56,6 +60,14 @@ extern "C" {
 
 NAMESPACE_BEGIN(mitsuba)
 
+/// Return the path of a (possibly buffered) file stream for log messages
+static std::string stream_name(Stream *stream) {
+    if (auto bs = dynamic_cast<BufferedStream *>(stream))
+        stream = bs->child_stream();
+    auto fs = dynamic_cast<FileStream *>(stream);
+    return fs ? fs->path().string() : "<stream>";
+}
+
 Bitmap::Bitmap(PixelFormat pixel_format, Struct::Type component_format,
                const Vector2u &size, size_t channel_count, uint8_t *data)
     : m_data(data), m_pixel_format(pixel_format),
@@ -98,7 +110,8 @@ Bitmap::Bitmap(Bitmap &&bitmap)
       m_size(bitmap.m_size),
       m_struct(std::move(bitmap.m_struct)),
       m_srgb_gamma(bitmap.m_srgb_gamma),
-      m_owns_data(bitmap.m_owns_data) {
+      m_owns_data(bitmap.m_owns_data),
+      m_mmap(std::move(bitmap.m_mmap)) {
 }
 
 Bitmap::Bitmap(Stream *stream, FileFormat format) {
@@ -107,7 +120,30 @@ Bitmap::Bitmap(Stream *stream, FileFormat format) {
 
 Bitmap::Bitmap(const fs::path &filename, FileFormat format) {
     ref<FileStream> fs = new FileStream(filename);
-    read(fs, format);
+    if (format == FileFormat::Auto)
+        format = detect_file_format(fs);
+
+    /* Uncompressed formats that store pixels in their in-memory layout:
+       reference the file contents instead of reading them, so that the
+       pages are shared with other processes loading the same file */
+    if (format == FileFormat::PPM || format == FileFormat::Tensor) {
+        fs = nullptr;
+        m_mmap = MemoryMappedFile::map_copy_on_write(filename);
+        ref<MemoryStream> ms = new MemoryStream(m_mmap->data(), m_mmap->size());
+        read(ms, format);
+        Log(Debug, "Mapped %s file \"%s\" (%ix%i, %s, %s)%s", format,
+            filename.string(), m_size.x(), m_size.y(), m_pixel_format,
+            m_component_format, m_owns_data ? ", but copied its contents" : "");
+        if (m_owns_data)
+            m_mmap = nullptr;
+        return;
+    }
+
+    /* The remaining loaders issue many small reads (scanlines, chunk
+       headers, individual characters): serve them from a large read-ahead
+       buffer instead of going through the file stream every time */
+    ref<BufferedStream> bs = new BufferedStream(fs);
+    read(bs, format);
 }
 
 Bitmap::~Bitmap() {
@@ -196,6 +232,11 @@ size_t Bitmap::buffer_size() const {
     return pixel_count() * bytes_per_pixel();
 }
 
+void Bitmap::account_memory(MemoryReport *report) const {
+    if (m_owns_data)
+        report->add(MemoryCategory::Textures, buffer_size());
+}
+
 size_t Bitmap::bytes_per_pixel() const {
     size_t result;
     switch (m_component_format) {
@@ -497,8 +538,28 @@ void Bitmap::convert(Bitmap *target) const {
     }
 
     StructConverter conv(m_struct, target_struct, true);
-    bool rv = conv.convert_2d(m_size.x(), m_size.y(), uint8_data(), target->uint8_data());
-    if (!rv)
+
+    /* Convert blocks of rows in parallel. They start at multiples of the
+       dither matrix size (256), so that the result matches a serial run */
+    size_t source_row = (size_t) m_size.x() * bytes_per_pixel(),
+           target_row = (size_t) m_size.x() * target->bytes_per_pixel(),
+           block_count = (m_size.y() + 255) / 256;
+    std::atomic<bool> success(true);
+
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, block_count, 1),
+        [&](const tbb::blocked_range<size_t> &range) {
+            size_t y0 = range.begin() * 256,
+                   y1 = std::min(range.end() * 256, (size_t) m_size.y());
+            bool rv = conv.convert_2d(m_size.x(), y1 - y0,
+                                      uint8_data() + y0 * source_row,
+                                      target->uint8_data() + y0 * target_row);
+            if (!rv)
+                success = false;
+        }
+    );
+
+    if (!success)
         Throw("Bitmap::convert(): conversion kernel indicated a failure!");
 }
 
@@ -697,11 +758,32 @@ void Bitmap::read(Stream *stream, FileFormat format) {
         case FileFormat::PPM:     read_ppm(stream);     break;
         case FileFormat::TGA:     read_tga(stream);     break;
         case FileFormat::PNG:     read_png(stream);     break;
+        case FileFormat::Tensor:  read_tensor(stream);  break;
         default:
             Throw("Bitmap: Unknown file format!");
     }
 }
 
+bool Bitmap::map_data(Stream *stream, size_t size) {
+    if (!m_mmap)
+        return false;
+
+    size_t offset = stream->tell();
+    if (offset + size > m_mmap->size())
+        Throw("Bitmap: the file \"%s\" is truncated!", m_mmap->filename().string());
+
+    // Components must be naturally aligned to be accessed in place
+    size_t component_size = bytes_per_pixel() / channel_count();
+    uint8_t *ptr = (uint8_t *) m_mmap->data() + offset;
+    if ((uintptr_t) ptr % component_size != 0)
+        return false;
+
+    m_data = std::unique_ptr<uint8_t[]>(ptr);
+    m_owns_data = false;
+    stream->seek(offset + size);
+    return true;
+}
+
 Bitmap::FileFormat Bitmap::detect_file_format(Stream *stream) {
     FileFormat format = FileFormat::Unknown;
 
@@ -724,6 +806,8 @@ Bitmap::FileFormat Bitmap::detect_file_format(Stream *stream) {
         format = FileFormat::PNG;
     } else if (Imf::isImfMagic((const char *) start)) {
         format = FileFormat::OpenEXR;
+    } else if (memcmp(start, "tensor_f", 8) == 0) {
+        format = FileFormat::Tensor;
     } else {
         // Check for a TGAv2 file
         char footer[18];
@@ -736,34 +820,57 @@ Bitmap::FileFormat Bitmap::detect_file_format(Stream *stream) {
     return format;
 }
 
-void Bitmap::write(const fs::path &path, FileFormat format, int quality) const {
+/// Determine the file format of an output file from its extension
+static Bitmap::FileFormat file_format_from_path(const fs::path &path) {
+    using FileFormat = Bitmap::FileFormat;
+    std::string extension = string::to_lower(path.extension().string());
+    if (extension == ".exr")
+        return FileFormat::OpenEXR;
+    else if (extension == ".png")
+        return FileFormat::PNG;
+    else if (extension == ".jpg" || extension == ".jpeg")
+        return FileFormat::JPEG;
+    else if (extension == ".hdr" || extension == ".rgbe")
+        return FileFormat::RGBE;
+    else if (extension == ".pfm")
+        return FileFormat::PFM;
+    else if (extension == ".ppm")
+        return FileFormat::PPM;
+    else if (extension == ".tensor")
+        return FileFormat::Tensor;
+    else
+        Throw("Bitmap::write(): unsupported bitmap file extension \"%s\"",
+              extension);
+}
+
+void Bitmap::write(const fs::path &path, FileFormat format, int quality,
+                   EXRCompression compression) const {
+    if (format == FileFormat::Auto)
+        format = file_format_from_path(path);
+
+    /* Let OpenEXR write to the file by itself: it issues one large write per
+       block of compressed scanlines, which are compressed in parallel */
+    if (format == FileFormat::OpenEXR) {
+        Log(Debug, "Writing %s file \"%s\" (%ix%i, %s, %s, %s compression) ..",
+            format, path.string(), m_size.x(), m_size.y(), m_pixel_format,
+            m_component_format, compression);
+        write_openexr(nullptr, quality, compression, path);
+        return;
+    }
+
     ref<FileStream> fs = new FileStream(path, FileStream::ETruncReadWrite);
-    write(fs, format, quality);
+    write(fs, format, quality, compression);
 }
 
-void Bitmap::write(Stream *stream, FileFormat format, int quality) const {
+void Bitmap::write(Stream *stream, FileFormat format, int quality,
+                   EXRCompression compression) const {
     auto fs = dynamic_cast<FileStream *>(stream);
 
     if (format == FileFormat::Auto) {
         if (!fs)
             Throw("Bitmap::write(): can't decide file format based on filename "
                   "since the target stream is not a file stream");
-        std::string extension = string::to_lower(fs->path().extension().string());
-        if (extension == ".exr")
-            format = FileFormat::OpenEXR;
-        else if (extension == ".png")
-            format = FileFormat::PNG;
-        else if (extension == ".jpg" || extension == ".jpeg")
-            format = FileFormat::JPEG;
-        else if (extension == ".hdr" || extension == ".rgbe")
-            format = FileFormat::RGBE;
-        else if (extension == ".pfm")
-            format = FileFormat::PFM;
-        else if (extension == ".ppm")
-            format = FileFormat::PPM;
-        else
-            Throw("Bitmap::write(): unsupported bitmap file extension \"%s\"",
-                  extension);
+        format = file_format_from_path(fs->path());
     }
 
     Log(Debug, "Writing %s file \"%s\" (%ix%i, %s, %s) ..",
@@ -774,7 +881,7 @@ void Bitmap::write(Stream *stream, FileFormat format, int quality) const {
 
     switch (format) {
         case FileFormat::OpenEXR:
-            write_openexr(stream, quality);
+            write_openexr(stream, quality, compression);
             break;
 
         case FileFormat::PNG:
@@ -801,30 +908,38 @@ void Bitmap::write(Stream *stream, FileFormat format, int quality) const {
             write_pfm(stream);
             break;
 
+        case FileFormat::Tensor:
+            write_tensor(stream);
+            break;
+
         default:
             Throw("Bitmap::write(): Invalid file format!");
     }
 }
 
-void Bitmap::write_async(const fs::path &path_, FileFormat format_, int quality_) const {
+void Bitmap::write_async(const fs::path &path_, FileFormat format_, int quality_,
+                         EXRCompression compression_) const {
     class WriteTask : public tbb::task {
         ref<const Bitmap> bitmap;
         fs::path path;
         FileFormat format;
         int quality;
+        EXRCompression compression;
 
     public:
-        WriteTask(const Bitmap *bitmap, fs::path path, FileFormat format, int quality)
-            : bitmap(bitmap), path(path), format(format), quality(quality) { }
+        WriteTask(const Bitmap *bitmap, fs::path path, FileFormat format, int quality,
+                  EXRCompression compression)
+            : bitmap(bitmap), path(path), format(format), quality(quality),
+              compression(compression) { }
 
         tbb::task* execute() override {
-            bitmap->write(path, format, quality);
+            bitmap->write(path, format, quality, compression);
             return nullptr;
         }
     };
 
     WriteTask *t = new (tbb::task::allocate_root())
-        WriteTask(this, path_, format_, quality_);
+        WriteTask(this, path_, format_, quality_, compression_);
     tbb::task::enqueue(*t);
 }
 
@@ -916,9 +1031,15 @@ private:
     ref<Stream> m_stream;
 };
 
-void Bitmap::read_openexr(Stream *stream) {
+/* (De)compression of the scanline blocks of OpenEXR files uses the library's
+   global thread pool, which is shared by all reads and writes */
+static void openexr_init_threads() {
     if (Imf::globalThreadCount() == 0)
-        Imf::setGlobalThreadCount(std::min(8, util::core_count()));
+        Imf::setGlobalThreadCount(util::core_count());
+}
+
+void Bitmap::read_openexr(Stream *stream) {
+    openexr_init_threads();
 
     EXRIStream istr(stream);
     Imf::InputFile file(istr);
@@ -1136,9 +1257,8 @@ void Bitmap::read_openexr(Stream *stream) {
         framebuffer.insert(field.name, slice);
     }
 
-    auto fs = dynamic_cast<FileStream *>(stream);
     Log(Debug, "Loading OpenEXR file \"%s\" (%ix%i, %s, %s) ..",
-        fs ? fs->path().string() : "<stream>", m_size.x(), m_size.y(),
+        stream_name(stream), m_size.x(), m_size.y(),
         m_pixel_format, m_component_format);
 
     file.setFrameBuffer(framebuffer);
@@ -1278,9 +1398,26 @@ void Bitmap::read_openexr(Stream *stream) {
     }
 }
 
-void Bitmap::write_openexr(Stream *stream, int quality) const {
-    if (Imf::globalThreadCount() == 0)
-        Imf::setGlobalThreadCount(std::min(8, util::core_count()));
+void Bitmap::write_openexr_blocks(const fs::path &path, uint32_t height,
+                                  const ScanlineCallback &fill, int quality,
+                                  EXRCompression compression) {
+    if (!fill || m_size.y() == 0)
+        Throw("Bitmap::write_openexr_blocks(): invalid arguments!");
+
+    Log(Debug, "Writing OpenEXR file \"%s\" (%ix%i, %s, %s, %s compression) in blocks "
+        "of %i scanlines ..", path.string(), m_size.x(), height, m_pixel_format,
+        m_component_format, compression, m_size.y());
+
+    write_openexr(nullptr, quality, compression, path, height, fill);
+}
+
+void Bitmap::write_openexr(Stream *stream, int quality, EXRCompression compression,
+                           const fs::path &path, uint32_t height,
+                           const ScanlineCallback &fill) const {
+    openexr_init_threads();
+
+    if (!fill)
+        height = m_size.y();
 
     PixelFormat pixel_format = m_pixel_format;
 
@@ -1292,16 +1429,31 @@ void Bitmap::write_openexr(Stream *stream, int quality) const {
 
     Imf::Header header(
         (int) m_size.x(),  // width
-        (int) m_size.y(),  // height,
+        (int) height,      // height,
         1.f,               // pixelAspectRatio
         Imath::V2f(0, 0),  // screenWindowCenter,
         1.f,               // screenWindowWidth
-        Imf::INCREASING_Y, // lineOrder
-        quality <= 0 ? Imf::PIZ_COMPRESSION : Imf::DWAB_COMPRESSION // compression
+        Imf::INCREASING_Y  // lineOrder
     );
 
-    if (quality > 0)
-        Imf::addDwaCompressionLevel(header, float(quality));
+    Imf::Compression exr_compression;
+    switch (compression) {
+        case EXRCompression::Default:
+            exr_compression = quality <= 0 ? Imf::PIZ_COMPRESSION : Imf::DWAB_COMPRESSION;
+            break;
+        case EXRCompression::None: exr_compression = Imf::NO_COMPRESSION;   break;
+        case EXRCompression::RLE:  exr_compression = Imf::RLE_COMPRESSION;  break;
+        case EXRCompression::ZIPS: exr_compression = Imf::ZIPS_COMPRESSION; break;
+        case EXRCompression::ZIP:  exr_compression = Imf::ZIP_COMPRESSION;  break;
+        case EXRCompression::PIZ:  exr_compression = Imf::PIZ_COMPRESSION;  break;
+        case EXRCompression::DWAA: exr_compression = Imf::DWAA_COMPRESSION; break;
+        case EXRCompression::DWAB: exr_compression = Imf::DWAB_COMPRESSION; break;
+        default: Throw("Bitmap::write_openexr(): invalid compression method!");
+    }
+    header.compression() = exr_compression;
+
+    if (exr_compression == Imf::DWAA_COMPRESSION || exr_compression == Imf::DWAB_COMPRESSION)
+        Imf::addDwaCompressionLevel(header, quality > 0 ? float(quality) : 45.f);
 
     for (auto it = keys.begin(); it != keys.end(); ++it) {
         using Type = Properties::Type;
@@ -1361,8 +1513,7 @@ void Bitmap::write_openexr(Stream *stream, int quality) const {
            row_stride = pixel_stride * m_size.x();
 
     Imf::ChannelList &channels = header.channels();
-    Imf::FrameBuffer framebuffer;
-    const uint8_t *ptr = uint8_data();
+    std::vector<Imf::PixelType> comp_types;
     for (auto field : *m_struct) {
         Imf::PixelType comp_type;
         switch (field.type) {
@@ -1372,15 +1523,46 @@ void Bitmap::write_openexr(Stream *stream, int quality) const {
             default: Throw("Unexpected field type!");
         }
 
-        Imf::Slice slice(comp_type, (char *) (ptr + field.offset), pixel_stride, row_stride);
         channels.insert(field.name, Imf::Channel(comp_type));
-        framebuffer.insert(field.name, slice);
-    }
+        comp_types.push_back(comp_type);
+    }
+
+    /* Frame buffer that maps scanline 'y' to the first row of the bitmap.
+       OpenEXR addresses slices using absolute scanline indices. */
+    auto framebuffer = [&](uint32_t y) {
+        Imf::FrameBuffer result;
+        const char *ptr = (const char *) uint8_data() - (ptrdiff_t) y * (ptrdiff_t) row_stride;
+        size_t i = 0;
+        for (auto field : *m_struct) {
+            result.insert(field.name, Imf::Slice(comp_types[i++], (char *) (ptr + field.offset),
+                                                 pixel_stride, row_stride));
+        }
+        return result;
+    };
 
-    EXROStream ostr(stream);
-    Imf::OutputFile file(ostr, header);
-    file.setFrameBuffer(framebuffer);
-    file.writePixels((int) m_size.y());
+    auto write_pixels = [&](Imf::OutputFile &file) {
+        if (!fill) {
+            file.setFrameBuffer(framebuffer(0));
+            file.writePixels((int) height);
+            return;
+        }
+
+        for (uint32_t y = 0; y < height; y += m_size.y()) {
+            uint32_t rows = std::min(m_size.y(), height - y);
+            fill(y, rows);
+            file.setFrameBuffer(framebuffer(y));
+            file.writePixels((int) rows);
+        }
+    };
+
+    if (stream) {
+        EXROStream ostr(stream);
+        Imf::OutputFile file(ostr, header, Imf::globalThreadCount());
+        write_pixels(file);
+    } else {
+        Imf::OutputFile file(path.string().c_str(), header, Imf::globalThreadCount());
+        write_pixels(file);
+    }
 }
 
 // -----------------------------------------------------------------------------
@@ -1476,10 +1658,16 @@ extern "C" {
     }
 };
 
+/// Minimum number of rows per stripe when decoding large JPEG files in parallel
+static const size_t jpeg_stripe_height = 1024;
+
 void Bitmap::read_jpeg(Stream *stream) {
     struct jpeg_decompress_struct cinfo;
     struct jpeg_error_mgr jerr;
     jbuf_in_t jbuf;
+#if defined(LIBJPEG_TURBO_VERSION_NUMBER)
+    size_t start = stream->tell();
+#endif
 
     memset(&jbuf, 0, sizeof(jbuf_in_t));
 
@@ -1495,7 +1683,7 @@ void Bitmap::read_jpeg(Stream *stream) {
     jbuf.stream = stream;
 
     jpeg_read_header(&cinfo, TRUE);
-    jpeg_start_decompress(&cinfo);
+    jpeg_calc_output_dimensions(&cinfo);
 
     m_size = Vector2u(cinfo.output_width, cinfo.output_height);
     m_component_format = Struct::Type::UInt8;
@@ -1510,9 +1698,8 @@ void Bitmap::read_jpeg(Stream *stream) {
 
     rebuild_struct();
 
-    auto fs = dynamic_cast<FileStream *>(stream);
     Log(Debug, "Loading JPEG file \"%s\" (%ix%i, %s, %s) ..",
-        fs ? fs->path().string() : "<stream>", m_size.x(), m_size.y(),
+        stream_name(stream), m_size.x(), m_size.y(),
         m_pixel_format, m_component_format);
 
     size_t row_stride =
@@ -1526,15 +1713,74 @@ void Bitmap::read_jpeg(Stream *stream) {
     for (size_t i = 0; i < m_size.y(); ++i)
         scanlines[i] = uint8_data() + row_stride*i;
 
-    // Process scanline by scanline
-    int counter = 0;
-    while (cinfo.output_scanline < cinfo.output_height)
-        counter += jpeg_read_scanlines(&cinfo, scanlines.get() + counter,
-            (JDIMENSION) (m_size.y() - cinfo.output_scanline));
+    size_t stripe_count = 1;
+#if defined(LIBJPEG_TURBO_VERSION_NUMBER)
+    /* Large baseline files are decoded in horizontal stripes with separate
+       decompressors, each of which skips to its first row using
+       jpeg_skip_scanlines(). Skipped rows are only entropy-decoded, which is
+       cheap compared to the inverse DCT, upsampling and color conversion of
+       the rows that are kept. This requires random access to the file. */
+    if (!cinfo.progressive_mode && m_size.y() >= 2 * jpeg_stripe_height &&
+        (dynamic_cast<FileStream *>(stream) || dynamic_cast<MemoryStream *>(stream)))
+        stripe_count = std::min((size_t) util::core_count(),
+                                (size_t) m_size.y() / jpeg_stripe_height);
+#endif
+
+    if (stripe_count == 1) {
+        jpeg_start_decompress(&cinfo);
 
-    // Release the libjpeg data structures
-    jpeg_finish_decompress(&cinfo);
+        // Process scanline by scanline
+        int counter = 0;
+        while (cinfo.output_scanline < cinfo.output_height)
+            counter += jpeg_read_scanlines(&cinfo, scanlines.get() + counter,
+                (JDIMENSION) (m_size.y() - cinfo.output_scanline));
+
+        // Release the libjpeg data structures
+        jpeg_finish_decompress(&cinfo);
+        jpeg_destroy_decompress(&cinfo);
+        return;
+    }
+
+#if defined(LIBJPEG_TURBO_VERSION_NUMBER)
+    // Stripes start at the boundaries of the rows of MCUs
+    size_t mcu_height = (size_t) cinfo.max_v_samp_factor * DCTSIZE;
     jpeg_destroy_decompress(&cinfo);
+
+    size_t size = stream->size() - start;
+    std::unique_ptr<uint8_t[]> data(new uint8_t[size]);
+    stream->seek(start);
+    stream->read(data.get(), size);
+
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, stripe_count, 1),
+        [&](const tbb::blocked_range<size_t> &range) {
+            for (size_t i = range.begin(); i != range.end(); ++i) {
+                JDIMENSION y0 = (JDIMENSION) (m_size.y() * i / stripe_count / mcu_height * mcu_height),
+                           y1 = (JDIMENSION) (i + 1 == stripe_count ? m_size.y() :
+                                m_size.y() * (i + 1) / stripe_count / mcu_height * mcu_height);
+
+                struct jpeg_decompress_struct cinfo_stripe;
+                struct jpeg_error_mgr jerr_stripe;
+                cinfo_stripe.err = jpeg_std_error(&jerr_stripe);
+                jerr_stripe.error_exit = jpeg_error_exit;
+                jpeg_create_decompress(&cinfo_stripe);
+                jpeg_mem_src(&cinfo_stripe, data.get(), (unsigned long) size);
+                jpeg_read_header(&cinfo_stripe, TRUE);
+                jpeg_start_decompress(&cinfo_stripe);
+
+                if (y0 > 0)
+                    jpeg_skip_scanlines(&cinfo_stripe, y0);
+                while (cinfo_stripe.output_scanline < y1)
+                    jpeg_read_scanlines(&cinfo_stripe, scanlines.get() + cinfo_stripe.output_scanline,
+                                        y1 - cinfo_stripe.output_scanline);
+
+                // The remainder of the file belongs to the other stripes
+                jpeg_abort_decompress(&cinfo_stripe);
+                jpeg_destroy_decompress(&cinfo_stripe);
+            }
+        }
+    );
+#endif
 }
 
 void Bitmap::write_jpeg(Stream *stream, int quality) const {
@@ -1702,9 +1948,8 @@ void Bitmap::read_png(Stream *stream) {
     for (int i = 0; i < text_idx; ++i, text_ptr++)
         m_metadata.set_string(text_ptr->key, text_ptr->text);
 
-    auto fs = dynamic_cast<FileStream *>(stream);
     Log(Debug, "Loading PNG file \"%s\" (%ix%i, %s, %s) ..",
-        fs ? fs->path().string() : "<stream>", m_size.x(), m_size.y(),
+        stream_name(stream), m_size.x(), m_size.y(),
         m_pixel_format, m_component_format);
 
     size_t size = buffer_size();
@@ -1861,15 +2106,16 @@ void Bitmap::read_ppm(Stream *stream) {
     m_component_format = int_values[2] <= 0xFF ? Struct::Type::UInt8 : Struct::Type::UInt16;
     rebuild_struct();
 
-    auto fs = dynamic_cast<FileStream *>(stream);
     Log(Debug, "Loading PPM file \"%s\" (%ix%i, %s, %s) ..",
-        fs ? fs->path().string() : "<stream>", m_size.x(), m_size.y(),
+        stream_name(stream), m_size.x(), m_size.y(),
         m_pixel_format, m_component_format);
 
     size_t size = buffer_size();
-    m_data = std::unique_ptr<uint8_t[]>(new uint8_t[size]);
-    m_owns_data = true;
-    stream->read(uint8_data(), size);
+    if (!map_data(stream, size)) {
+        m_data = std::unique_ptr<uint8_t[]>(new uint8_t[size]);
+        m_owns_data = true;
+        stream->read(uint8_data(), size);
+    }
 }
 
 void Bitmap::write_ppm(Stream *stream) const {
@@ -2010,9 +2256,8 @@ void Bitmap::read_rgbe(Stream *stream) {
     m_data = std::unique_ptr<uint8_t[]>(new uint8_t[buffer_size()]);
     m_owns_data = true;
 
-    auto fs = dynamic_cast<FileStream *>(stream);
     Log(Debug, "Loading RGBE file \"%s\" (%ix%i, %s, %s) ..",
-        fs ? fs->path().string() : "<stream>", m_size.x(), m_size.y(),
+        stream_name(stream), m_size.x(), m_size.y(),
         m_pixel_format, m_component_format);
 
     float *data = (float *) m_data.get();
@@ -2176,9 +2421,8 @@ void Bitmap::read_pfm(Stream *stream) {
     m_data = std::unique_ptr<uint8_t[]>(new uint8_t[size_in_bytes]);
     m_owns_data = true;
 
-    auto fs = dynamic_cast<FileStream *>(stream);
     Log(Debug, "Loading PFM file \"%s\" (%ix%i, %s, %s) ..",
-        fs ? fs->path().string() : "<stream>", m_size.x(), m_size.y(),
+        stream_name(stream), m_size.x(), m_size.y(),
         m_pixel_format, m_component_format);
 
     size_t size = size_in_bytes / sizeof(float);
@@ -2308,9 +2552,8 @@ void Bitmap::read_bmp(Stream *stream) {
         m_data = std::unique_ptr<uint8_t[]>(new uint8_t[size]);
         m_owns_data = true;
 
-        auto fs = dynamic_cast<FileStream *>(stream);
         Log(Debug, "Loading BMP file \"%s\" (%ix%i, %s, %s) ..",
-            fs ? fs->path().string() : "<stream>", m_size.x(), m_size.y(),
+            stream_name(stream), m_size.x(), m_size.y(),
             m_pixel_format, m_component_format);
 
         size_t row_size = size / m_size.y();
@@ -2382,9 +2625,8 @@ void Bitmap::read_tga(Stream *stream) {
 
         rebuild_struct();
 
-        auto fs = dynamic_cast<FileStream *>(stream);
         Log(Debug, "Loading TGA file \"%s\" (%ix%i, %s, %s) ..",
-            fs ? fs->path().string() : "<stream>", m_size.x(), m_size.y(),
+            stream_name(stream), m_size.x(), m_size.y(),
             m_pixel_format, m_component_format);
 
         size_t size = buffer_size(),
@@ -2439,6 +2681,100 @@ void Bitmap::read_tga(Stream *stream) {
     }
 }
 
+// -----------------------------------------------------------------------------
+//   Tensor bitmap I/O
+// -----------------------------------------------------------------------------
+
+void Bitmap::read_tensor(Stream *stream) {
+    uint8_t header[12], version[2];
+    uint32_t n_fields;
+    stream->read(header, 12);
+    stream->read(version, 2);
+    stream->read(n_fields);
+
+    if (memcmp(header, "tensor_file", 12) != 0)
+        Throw("read_tensor(): invalid header!");
+    else if (version[1] != 0)
+        Throw("read_tensor(): unknown file version!");
+
+    // Use the field named "data", or the only field of the file
+    bool found = false;
+    uint8_t dtype = 0;
+    uint64_t offset = 0;
+    std::vector<uint64_t> shape;
+
+    for (uint32_t i = 0; i < n_fields && !found; ++i) {
+        uint16_t name_length, ndim;
+        stream->read(name_length);
+        std::string name(name_length, '\0');
+        stream->read((char *) name.data(), name_length);
+        stream->read(ndim);
+        stream->read(dtype);
+        stream->read(offset);
+        shape.resize(ndim);
+        stream->read_array(shape.data(), ndim);
+        found = name == "data" || n_fields == 1;
+    }
+
+    if (!found)
+        Throw("read_tensor(): the file must contain a field named \"data\" "
+              "or a single field!");
+    if (shape.size() != 2 && shape.size() != 3)
+        Throw("read_tensor(): expected a tensor of shape [height, width] or "
+              "[height, width, channels], got %i dimensions!", shape.size());
+    if (dtype == (uint8_t) Struct::Type::Invalid || dtype > (uint8_t) Struct::Type::Float64)
+        Throw("read_tensor(): unknown component type!");
+
+    size_t channel_count = shape.size() == 3 ? (size_t) shape[2] : 1;
+    switch (channel_count) {
+        case 1: m_pixel_format = PixelFormat::Y; break;
+        case 2: m_pixel_format = PixelFormat::YA; break;
+        case 3: m_pixel_format = PixelFormat::RGB; break;
+        case 4: m_pixel_format = PixelFormat::RGBA; break;
+        default: m_pixel_format = PixelFormat::MultiChannel; break;
+    }
+
+    m_size = Vector2u((uint32_t) shape[1], (uint32_t) shape[0]);
+    m_component_format = (Struct::Type) dtype;
+    m_srgb_gamma = m_component_format == Struct::Type::UInt8;
+    m_premultiplied_alpha = true;
+    rebuild_struct(m_pixel_format == PixelFormat::MultiChannel ? channel_count : 0);
+
+    Log(Debug, "Loading tensor file \"%s\" (%ix%i, %s, %s) ..",
+        stream_name(stream), m_size.x(), m_size.y(),
+        m_pixel_format, m_component_format);
+
+    size_t size = buffer_size();
+    stream->seek((size_t) offset);
+    if (!map_data(stream, size)) {
+        m_data = std::unique_ptr<uint8_t[]>(new uint8_t[size]);
+        m_owns_data = true;
+        stream->read(uint8_data(), size);
+    }
+}
+
+void Bitmap::write_tensor(Stream *stream) const {
+    const char *name = "data";
+    uint64_t shape[3] = { m_size.y(), m_size.x(), channel_count() };
+    size_t header_size = 12 + 2 + 4 + 2 + 4 + 2 + 1 + 8 + sizeof(shape);
+
+    // Align the pixel data, so that it can be memory-mapped and accessed in place
+    uint64_t offset = (header_size + 63) / 64 * 64;
+    uint8_t version[2] = { 1, 0 }, padding[64] = { };
+
+    stream->write("tensor_file", 12);
+    stream->write(version, 2);
+    stream->write((uint32_t) 1);
+    stream->write((uint16_t) 4);
+    stream->write(name, 4);
+    stream->write((uint16_t) 3);
+    stream->write((uint8_t) m_component_format);
+    stream->write(offset);
+    stream->write_array(shape, 3);
+    stream->write(padding, offset - header_size);
+    stream->write(uint8_data(), buffer_size());
+}
+
 std::ostream &operator<<(std::ostream &os, Bitmap::PixelFormat value) {
     switch (value) {
         case Bitmap::PixelFormat::Y:            os << "y"; break;
@@ -2463,12 +2799,28 @@ std::ostream &operator<<(std::ostream &os, Bitmap::FileFormat value) {
         case Bitmap::FileFormat::PFM:     os << "PFM"; break;
         case Bitmap::FileFormat::PPM:     os << "PPM"; break;
         case Bitmap::FileFormat::RGBE:    os << "RGBE"; break;
+        case Bitmap::FileFormat::Tensor:  os << "Tensor"; break;
         case Bitmap::FileFormat::Auto:    os << "Auto"; break;
         default: Throw("Unknown file format!");
     }
     return os;
 }
 
+std::ostream &operator<<(std::ostream &os, Bitmap::EXRCompression value) {
+    switch (value) {
+        case Bitmap::EXRCompression::Default: os << "default"; break;
+        case Bitmap::EXRCompression::None:    os << "none"; break;
+        case Bitmap::EXRCompression::RLE:     os << "rle"; break;
+        case Bitmap::EXRCompression::ZIPS:    os << "zips"; break;
+        case Bitmap::EXRCompression::ZIP:     os << "zip"; break;
+        case Bitmap::EXRCompression::PIZ:     os << "piz"; break;
+        case Bitmap::EXRCompression::DWAA:    os << "dwaa"; break;
+        case Bitmap::EXRCompression::DWAB:    os << "dwab"; break;
+        default: Throw("Unknown EXR compression method!");
+    }
+    return os;
+}
+
 std::ostream &operator<<(std::ostream &os, Bitmap::AlphaTransform value) {
     switch (value) {
         case Bitmap::AlphaTransform::None:    os << "none";    break;
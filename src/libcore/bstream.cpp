@@ -0,0 +1,135 @@
+#include <mitsuba/core/bstream.h>
+#include <mitsuba/core/string.h>
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
+NAMESPACE_BEGIN(mitsuba)
+
+BufferedStream::BufferedStream(Stream *child_stream, size_t buffer_size)
+    : m_child_stream(child_stream), m_buffer_size(buffer_size),
+      m_buffer_start(0), m_buffer_fill(0) {
+    if (!child_stream)
+        Throw("BufferedStream: the child stream must not be null!");
+    if (buffer_size == 0)
+        Throw("BufferedStream: the buffer size must be nonzero!");
+    set_byte_order(child_stream->byte_order());
+    m_buffer.reset(new uint8_t[buffer_size]);
+    m_pos = child_stream->tell();
+}
+
+BufferedStream::~BufferedStream() { }
+
+void BufferedStream::close() {
+    m_buffer_fill = 0;
+    m_child_stream->close();
+}
+
+void BufferedStream::sync_child() {
+    if (m_child_stream->tell() != m_pos)
+        m_child_stream->seek(m_pos);
+}
+
+size_t BufferedStream::fill() {
+    size_t total = m_child_stream->size();
+
+    m_buffer_start = m_pos;
+    m_buffer_fill = 0;
+    if (m_pos >= total)
+        return 0;
+
+    size_t count = std::min(m_buffer_size, total - m_pos);
+    sync_child();
+    m_child_stream->read(m_buffer.get(), count);
+    m_buffer_fill = count;
+    return count;
+}
+
+void BufferedStream::read(void *p, size_t size) {
+    uint8_t *target = (uint8_t *) p;
+
+    while (size > 0) {
+        if (m_pos >= m_buffer_start && m_pos < m_buffer_start + m_buffer_fill) {
+            size_t offset = m_pos - m_buffer_start,
+                   count  = std::min(size, m_buffer_fill - offset);
+            std::memcpy(target, m_buffer.get() + offset, count);
+            target += count;
+            m_pos += count;
+            size -= count;
+        } else if (size >= m_buffer_size) {
+            // Large reads go straight to the child stream
+            sync_child();
+            m_child_stream->read(target, size);
+            m_pos += size;
+            return;
+        } else if (fill() == 0) {
+            Throw("Read less data than expected (%i more bytes required)", size);
+        }
+    }
+}
+
+std::string BufferedStream::read_line() {
+    std::string result;
+
+    while (true) {
+        if (!(m_pos >= m_buffer_start && m_pos < m_buffer_start + m_buffer_fill) &&
+            fill() == 0) {
+            if (result.empty())
+                Throw("read_line(): reached the end of the stream");
+            break;
+        }
+
+        const char *begin = (const char *) m_buffer.get() + (m_pos - m_buffer_start),
+                   *end   = (const char *) m_buffer.get() + m_buffer_fill,
+                   *nl    = (const char *) std::memchr(begin, '\n', end - begin);
+
+        result.append(begin, nl ? nl : end);
+        m_pos += (nl ? nl : end) - begin;
+        if (nl) {
+            m_pos++;
+            break;
+        }
+    }
+
+    result.erase(std::remove(result.begin(), result.end(), '\r'), result.end());
+    return result;
+}
+
+void BufferedStream::write(const void *p, size_t size) {
+    m_buffer_fill = 0;
+    sync_child();
+    m_child_stream->write(p, size);
+    m_pos += size;
+}
+
+void BufferedStream::truncate(size_t size) {
+    m_buffer_fill = 0;
+    m_child_stream->truncate(size);
+    m_pos = std::min(m_pos, size);
+}
+
+std::string BufferedStream::to_string() const {
+    std::ostringstream oss;
+
+    oss << class_()->name() << "[" << std::endl;
+    if (is_closed()) {
+        oss << "  closed" << std::endl;
+    } else {
+        oss << "  child_stream = " << string::indent(m_child_stream) << "," << std::endl
+            << "  buffer_size = " << m_buffer_size << "," << std::endl
+            << "  host_byte_order = " << host_byte_order() << "," << std::endl
+            << "  byte_order = " << byte_order() << "," << std::endl
+            << "  can_read = " << can_read() << "," << std::endl
+            << "  can_write = " << can_write() << "," << std::endl
+            << "  pos = " << tell() << "," << std::endl
+            << "  size = " << size() << std::endl;
+    }
+
+    oss << "]";
+
+    return oss.str();
+}
+
+MTS_IMPLEMENT_CLASS(BufferedStream, Stream)
+
+NAMESPACE_END(mitsuba)
@@ -0,0 +1,757 @@
+#include <mitsuba/core/distributed.h>
+#include <mitsuba/core/logger.h>
+#include <mitsuba/core/string.h>
+#include <mitsuba/core/timer.h>
+#include <mitsuba/core/util.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+#if defined(MTS_ENABLE_ZMQ)
+#  include <mitsuba/core/zmq11.h>
+#  include <zlib.h>
+#endif
+
+NAMESPACE_BEGIN(mitsuba)
+
+#if defined(MTS_ENABLE_ZMQ)
+/* Protocol: workers (DEALER sockets) send [""]["ready"][configuration] or
+   [""]["result"][item][data]. The coordinator (ROUTER socket) answers every
+   message with ["work"][item], ["done"] or ["error"][message]. */
+static const std::string msg_ready  = "ready",
+                         msg_result = "result",
+                         msg_work   = "work",
+                         msg_done   = "done",
+                         msg_error  = "error";
+
+/* Render server protocol: clients (DEALER sockets) send [""]["render"][scene]
+   [sensors][parameter count][key][value]... The server (ROUTER socket) answers
+   with any number of ["image"][sensor][data] messages followed by ["done"] or
+   ["error"][message]. */
+static const std::string msg_render = "render",
+                         msg_image  = "image";
+
+/* Block publisher protocol: the publisher (PUB socket) sends ["block"][header]
+   [data compressed with zlib]. Subscribers (SUB sockets) that don't keep up
+   lose messages once the high water mark is reached. */
+static const std::string msg_block = "block";
+#endif
+
+/// Time (in milliseconds) to keep answering the workers after the last result
+static const float coordinator_linger = 5000.f;
+
+// =============================================================================
+
+/* Coordinators and workers of the same process (e.g. rendering on the CPU and
+   the GPU) communicate through a shared queue when the address starts with
+   "inproc://", which works without ZeroMQ. Every run of a coordinator at the
+   address starts a new generation, workers only take part in one of them. */
+struct LocalChannel {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::string configuration;
+
+    /// Items of the current run (\c nullptr when no coordinator is running)
+    const std::vector<RenderWorkItem> *items = nullptr;
+    std::vector<bool> finished;
+    size_t next = 0, reissue = 0;
+    uint64_t generation = 0;
+    size_t workers = 0, busy = 0;
+    bool done = false;
+
+    /// Results that are waiting to be merged by the coordinator
+    std::deque<std::pair<size_t, std::vector<uint8_t>>> results;
+
+    /// Same policy as the ZeroMQ coordinator: each item once, then the unfinished ones
+    const RenderWorkItem *next_item() {
+        for (; next < items->size(); ++next) {
+            if (!finished[next])
+                return &(*items)[next++];
+        }
+        for (size_t i = 0; i < items->size(); ++i) {
+            size_t index = reissue++ % items->size();
+            if (!finished[index])
+                return &(*items)[index];
+        }
+        return nullptr;
+    }
+};
+
+static bool is_local_address(const std::string &address) {
+    return string::starts_with(address, "inproc://");
+}
+
+static std::shared_ptr<LocalChannel> local_channel(const std::string &address) {
+    static std::mutex mutex;
+    static std::unordered_map<std::string, std::shared_ptr<LocalChannel>> channels;
+    std::lock_guard<std::mutex> guard(mutex);
+    std::shared_ptr<LocalChannel> &channel = channels[address];
+    if (!channel)
+        channel = std::make_shared<LocalChannel>();
+    return channel;
+}
+
+static bool run_local(const std::string &address, const std::string &configuration,
+                      size_t &worker_count, const std::vector<RenderWorkItem> &items,
+                      const RenderCoordinator::ResultCallback &callback,
+                      const std::function<bool()> &should_stop) {
+    std::shared_ptr<LocalChannel> channel = local_channel(address);
+    std::unique_lock<std::mutex> lock(channel->mutex);
+    if (channel->items)
+        Throw("RenderCoordinator: another coordinator is running at \"%s\"!", address);
+
+    channel->configuration = configuration;
+    channel->items = &items;
+    channel->finished.assign(items.size(), false);
+    channel->next = channel->reissue = 0;
+    channel->generation++;
+    channel->workers = channel->busy = 0;
+    channel->done = false;
+    channel->results.clear();
+    channel->cv.notify_all();
+
+    size_t remaining = items.size();
+    while (remaining > 0 && !should_stop()) {
+        channel->cv.wait_for(lock, std::chrono::milliseconds(100),
+                             [&]() { return !channel->results.empty(); });
+        worker_count = channel->workers;
+
+        // Merge the results without blocking the workers
+        while (!channel->results.empty()) {
+            auto [index, data] = std::move(channel->results.front());
+            channel->results.pop_front();
+            if (channel->finished[index])
+                continue;
+            channel->finished[index] = true;
+            remaining--;
+
+            lock.unlock();
+            callback(items[index], data.data(), data.size());
+            lock.lock();
+        }
+    }
+
+    // Tell the workers that the render is over and wait for the busy ones
+    channel->done = true;
+    channel->cv.notify_all();
+    channel->cv.wait_for(lock, std::chrono::milliseconds((int) coordinator_linger),
+                         [&]() { return channel->busy == 0; });
+    channel->items = nullptr;
+    channel->results.clear();
+
+    return remaining == 0;
+}
+
+// =============================================================================
+
+RenderCoordinator::RenderCoordinator(const std::string &address,
+                                     const std::string &configuration)
+    : m_address(address), m_configuration(configuration) { }
+
+RenderCoordinator::~RenderCoordinator() { }
+
+bool RenderCoordinator::run(const std::vector<RenderWorkItem> &items,
+                            const ResultCallback &callback,
+                            const std::function<bool()> &should_stop) {
+    if (is_local_address(m_address))
+        return run_local(m_address, m_configuration, m_worker_count, items, callback,
+                         should_stop);
+
+#if defined(MTS_ENABLE_ZMQ)
+    zmq::context context;
+    zmq::socket socket(context, zmq::socket::router);
+    socket.setsockopt<int>(ZMQ_LINGER, 1000);
+    socket.bind(m_address);
+
+    std::vector<bool> finished(items.size(), false);
+    size_t remaining = items.size(), next = 0, reissue = 0;
+
+    // Workers that passed the configuration check / that are currently busy
+    std::unordered_set<std::string> workers, busy;
+
+    /* Hand out every item once, then cycle over the unfinished ones (whose
+       worker may be slow or gone) */
+    auto next_item = [&]() -> const RenderWorkItem * {
+        for (; next < items.size(); ++next) {
+            if (!finished[next])
+                return &items[next++];
+        }
+        for (size_t i = 0; i < items.size(); ++i) {
+            size_t index = reissue++ % items.size();
+            if (!finished[index])
+                return &items[index];
+        }
+        return nullptr;
+    };
+
+    Timer linger_timer;
+    bool stopping = false;
+
+    while (true) {
+        if (!stopping && (remaining == 0 || should_stop())) {
+            stopping = true;
+            linger_timer.reset();
+        }
+
+        /* Tell the busy workers that the render is over (they may be
+           rendering a duplicate of the last items), but don't wait forever */
+        if (stopping && (busy.empty() || linger_timer.value() > coordinator_linger))
+            break;
+
+        zmq::pollitem poll_item = { (void *) socket, 0, zmq::pollin, 0 };
+        if (zmq::poll(&poll_item, 1, 100) == 0)
+            continue;
+
+        zmq::envelope envelope;
+        std::string type, reply_error;
+        try {
+            socket.recv(envelope);
+            socket.recvmore(type);
+            const std::string &identity = envelope[0];
+
+            if (type == msg_ready) {
+                std::string configuration;
+                socket.recv(configuration);
+                if (configuration != m_configuration) {
+                    reply_error = "mismatched configuration: coordinator renders \"" +
+                                  m_configuration + "\", worker renders \"" +
+                                  configuration + "\"";
+                } else {
+                    workers.insert(identity);
+                    m_worker_count = workers.size();
+                }
+            } else if (type == msg_result) {
+                RenderWorkItem item;
+                zmq::message data;
+                socket.recvmore(item);
+                socket.recv(data);
+
+                if (workers.find(identity) == workers.end()) {
+                    reply_error = "unknown worker";
+                } else if (item.index < items.size() && !finished[item.index]) {
+                    finished[item.index] = true;
+                    remaining--;
+                    callback(items[item.index], data.data<uint8_t>(), data.size());
+                }
+            } else {
+                socket.discard_remainder();
+                Log(Warn, "RenderCoordinator: ignoring a message of unknown type \"%s\".", type);
+                continue;
+            }
+        } catch (const zmq::exception &e) {
+            Log(Warn, "RenderCoordinator: ignoring a malformed message: %s", e.what());
+            continue;
+        }
+
+        const std::string &identity = envelope[0];
+        socket.sendmore(envelope);
+        if (!reply_error.empty()) {
+            Log(Warn, "RenderCoordinator: rejecting a worker (%s).", reply_error);
+            socket.sendmore(msg_error);
+            socket.send(reply_error);
+            busy.erase(identity);
+            continue;
+        }
+
+        const RenderWorkItem *work = stopping || remaining == 0 ? nullptr : next_item();
+        if (work) {
+            socket.sendmore(msg_work);
+            socket.send(*work);
+            busy.insert(identity);
+        } else {
+            socket.send(msg_done);
+            busy.erase(identity);
+        }
+    }
+
+    return remaining == 0;
+#else
+    ENOKI_MARK_USED(items);
+    ENOKI_MARK_USED(callback);
+    ENOKI_MARK_USED(should_stop);
+    Throw("RenderCoordinator: Mitsuba was compiled without ZeroMQ support "
+          "(MTS_ENABLE_ZMQ)!");
+#endif
+}
+
+// =============================================================================
+
+struct RenderWorker::RenderWorkerPrivate {
+#if defined(MTS_ENABLE_ZMQ)
+    zmq::context context;
+    zmq::socket socket;
+
+    RenderWorkerPrivate() : socket(context, zmq::socket::dealer) { }
+#endif
+
+    /// Channel of an "inproc://" address, and the generation this worker takes part in
+    std::shared_ptr<LocalChannel> channel;
+    uint64_t generation = 0;
+    bool busy = false;
+};
+
+RenderWorker::RenderWorker(const std::string &address, const std::string &configuration,
+                           int timeout)
+    : d(new RenderWorkerPrivate()), m_configuration(configuration), m_timeout(timeout) {
+    m_item = RenderWorkItem();
+    if (is_local_address(address)) {
+        d->channel = local_channel(address);
+        return;
+    }
+
+#if defined(MTS_ENABLE_ZMQ)
+    d->socket.setsockopt<int>(ZMQ_LINGER, timeout);
+    d->socket.connect(address);
+#else
+    ENOKI_MARK_USED(address);
+    Throw("RenderWorker: Mitsuba was compiled without ZeroMQ support (MTS_ENABLE_ZMQ)!");
+#endif
+}
+
+RenderWorker::~RenderWorker() { }
+
+bool RenderWorker::next(RenderWorkItem &item, const uint8_t *data, size_t size) {
+    if (d->channel)
+        return next_local(item, data, size);
+
+#if defined(MTS_ENABLE_ZMQ)
+    zmq::socket &socket = d->socket;
+
+    socket.sendmore(); // Empty delimiter frame
+    if (data) {
+        socket.sendmore(msg_result);
+        socket.sendmore(m_item);
+        socket.send((const void *) data, size);
+    } else {
+        socket.sendmore(msg_ready);
+        socket.send(m_configuration);
+    }
+
+    zmq::pollitem poll_item = { (void *) socket, 0, zmq::pollin, 0 };
+    if (zmq::poll(&poll_item, 1, m_first_request ? -1 : (long) m_timeout) == 0) {
+        Log(Warn, "RenderWorker: the coordinator did not respond within %s, giving up.",
+            util::time_string((float) m_timeout));
+        return false;
+    }
+    m_first_request = false;
+
+    std::string delimiter, type;
+    socket.recvmore(delimiter);
+    socket.recv(type);
+
+    if (type == msg_work) {
+        socket.recv(m_item);
+        item = m_item;
+        return true;
+    } else if (type == msg_error) {
+        std::string message;
+        socket.recv(message);
+        Throw("RenderWorker: the coordinator rejected this worker: %s", message);
+    }
+
+    return false;
+#else
+    ENOKI_MARK_USED(item);
+    ENOKI_MARK_USED(data);
+    ENOKI_MARK_USED(size);
+    return false;
+#endif
+}
+
+bool RenderWorker::next_local(RenderWorkItem &item, const uint8_t *data, size_t size) {
+    LocalChannel &channel = *d->channel;
+    std::unique_lock<std::mutex> lock(channel.mutex);
+    bool current = d->generation != 0 && channel.generation == d->generation && channel.items;
+
+    if (d->busy && current) {
+        channel.busy--;
+        if (data)
+            channel.results.emplace_back((size_t) m_item.index,
+                                         std::vector<uint8_t>(data, data + size));
+        channel.cv.notify_all();
+    }
+    d->busy = false;
+
+    if (d->generation == 0) {
+        // Wait for a coordinator (in-process, hence it shouldn't take long)
+        if (!channel.cv.wait_for(lock, std::chrono::milliseconds(m_timeout),
+                                 [&]() { return channel.items && !channel.done; })) {
+            Log(Warn, "RenderWorker: the coordinator did not respond within %s, giving up.",
+                util::time_string((float) m_timeout));
+            return false;
+        }
+        if (channel.configuration != m_configuration)
+            Throw("RenderWorker: the coordinator rejected this worker: mismatched "
+                  "configuration: coordinator renders \"%s\", worker renders \"%s\"",
+                  channel.configuration, m_configuration);
+        d->generation = channel.generation;
+        channel.workers++;
+    } else if (!current) {
+        return false;
+    }
+
+    const RenderWorkItem *work = channel.done ? nullptr : channel.next_item();
+    if (!work)
+        return false;
+
+    m_item = item = *work;
+    d->busy = true;
+    channel.busy++;
+    return true;
+}
+
+// =============================================================================
+
+struct RenderServer::RenderServerPrivate {
+#if defined(MTS_ENABLE_ZMQ)
+    zmq::context context;
+    zmq::socket socket;
+
+    /// Envelope of the client whose request is being processed
+    zmq::envelope client;
+
+    RenderServerPrivate() : socket(context, zmq::socket::router) { }
+#endif
+};
+
+RenderServer::RenderServer(const std::string &address) : d(new RenderServerPrivate()) {
+#if defined(MTS_ENABLE_ZMQ)
+    d->socket.setsockopt<int>(ZMQ_LINGER, 1000);
+    d->socket.bind(address);
+#else
+    ENOKI_MARK_USED(address);
+    Throw("RenderServer: Mitsuba was compiled without ZeroMQ support (MTS_ENABLE_ZMQ)!");
+#endif
+}
+
+RenderServer::~RenderServer() { }
+
+bool RenderServer::next(RenderRequest &request, const std::function<bool()> &should_stop) {
+#if defined(MTS_ENABLE_ZMQ)
+    zmq::socket &socket = d->socket;
+
+    while (!should_stop()) {
+        zmq::pollitem poll_item = { (void *) socket, 0, zmq::pollin, 0 };
+        if (zmq::poll(&poll_item, 1, 100) == 0)
+            continue;
+
+        std::string type;
+        try {
+            socket.recv(d->client);
+            socket.recv(type);
+            if (type != msg_render) {
+                socket.discard_remainder();
+                Log(Warn, "RenderServer: ignoring a message of unknown type \"%s\".", type);
+                continue;
+            }
+
+            RenderRequest result;
+            uint32_t parameter_count;
+            socket.recvmore(result.scene);
+            socket.recvmore(result.sensors);
+            socket.recv(parameter_count);
+            for (uint32_t i = 0; i < parameter_count; ++i) {
+                std::string key, value;
+                socket.recvmore(key);
+                socket.recv(value);
+                result.parameters.emplace_back(std::move(key), std::move(value));
+            }
+            socket.discard_remainder();
+            request = std::move(result);
+            return true;
+        } catch (const zmq::exception &e) {
+            Log(Warn, "RenderServer: ignoring a malformed request: %s", e.what());
+            socket.discard_remainder();
+        }
+    }
+
+    return false;
+#else
+    ENOKI_MARK_USED(request);
+    ENOKI_MARK_USED(should_stop);
+    return false;
+#endif
+}
+
+void RenderServer::send_image(size_t sensor, const uint8_t *data, size_t size) {
+#if defined(MTS_ENABLE_ZMQ)
+    zmq::socket &socket = d->socket;
+    socket.sendmore(d->client);
+    socket.sendmore(msg_image);
+    socket.sendmore((uint64_t) sensor);
+    socket.send((const void *) data, size);
+#else
+    ENOKI_MARK_USED(sensor);
+    ENOKI_MARK_USED(data);
+    ENOKI_MARK_USED(size);
+#endif
+}
+
+void RenderServer::finish(const std::string &error) {
+#if defined(MTS_ENABLE_ZMQ)
+    zmq::socket &socket = d->socket;
+    socket.sendmore(d->client);
+    if (error.empty()) {
+        socket.send(msg_done);
+    } else {
+        socket.sendmore(msg_error);
+        socket.send(error);
+    }
+#else
+    ENOKI_MARK_USED(error);
+#endif
+}
+
+// =============================================================================
+
+struct RenderClient::RenderClientPrivate {
+#if defined(MTS_ENABLE_ZMQ)
+    zmq::context context;
+    zmq::socket socket;
+
+    RenderClientPrivate() : socket(context, zmq::socket::dealer) { }
+#endif
+};
+
+RenderClient::RenderClient(const std::string &address, int timeout)
+    : d(new RenderClientPrivate()), m_timeout(timeout) {
+#if defined(MTS_ENABLE_ZMQ)
+    d->socket.setsockopt<int>(ZMQ_LINGER, 1000);
+    d->socket.connect(address);
+#else
+    ENOKI_MARK_USED(address);
+    Throw("RenderClient: Mitsuba was compiled without ZeroMQ support (MTS_ENABLE_ZMQ)!");
+#endif
+}
+
+RenderClient::~RenderClient() { }
+
+void RenderClient::submit(const RenderRequest &request) {
+#if defined(MTS_ENABLE_ZMQ)
+    zmq::socket &socket = d->socket;
+    socket.sendmore(); // Empty delimiter frame
+    socket.sendmore(msg_render);
+    socket.sendmore(request.scene);
+    socket.sendmore(request.sensors);
+    if (request.parameters.empty()) {
+        socket.send((uint32_t) 0);
+        return;
+    }
+    socket.sendmore((uint32_t) request.parameters.size());
+    for (size_t i = 0; i < request.parameters.size(); ++i) {
+        socket.sendmore(request.parameters[i].first);
+        if (i + 1 < request.parameters.size())
+            socket.sendmore(request.parameters[i].second);
+        else
+            socket.send(request.parameters[i].second);
+    }
+#else
+    ENOKI_MARK_USED(request);
+#endif
+}
+
+bool RenderClient::receive(size_t &sensor, std::vector<uint8_t> &data) {
+#if defined(MTS_ENABLE_ZMQ)
+    zmq::socket &socket = d->socket;
+
+    zmq::pollitem poll_item = { (void *) socket, 0, zmq::pollin, 0 };
+    if (zmq::poll(&poll_item, 1, (long) m_timeout) == 0)
+        Throw("RenderClient: the server did not respond within %s!",
+              util::time_string((float) m_timeout));
+
+    std::string delimiter, type;
+    socket.recvmore(delimiter);
+    socket.recv(type);
+
+    if (type == msg_image) {
+        uint64_t index;
+        zmq::message message;
+        socket.recvmore(index);
+        socket.recv(message);
+        sensor = (size_t) index;
+        data.assign(message.data<uint8_t>(), message.data<uint8_t>() + message.size());
+        return true;
+    } else if (type == msg_error) {
+        std::string message;
+        socket.recv(message);
+        Throw("RenderClient: the server could not render the request: %s", message);
+    }
+
+    return false;
+#else
+    ENOKI_MARK_USED(sensor);
+    ENOKI_MARK_USED(data);
+    return false;
+#endif
+}
+
+// =============================================================================
+
+struct BlockPublisher::BlockPublisherPrivate {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<std::pair<PublishedBlock, std::vector<uint8_t>>> queue;
+    size_t queue_size = 0;
+    std::atomic<size_t> published { 0 }, dropped { 0 };
+    bool stop = false;
+    std::thread thread;
+#if defined(MTS_ENABLE_ZMQ)
+    zmq::context context;
+    zmq::socket socket;
+
+    BlockPublisherPrivate() : socket(context, zmq::socket::pub) { }
+
+    /// Body of the background thread: compress and send the queued blocks
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            cv.wait(lock, [&]() { return stop || !queue.empty(); });
+            if (queue.empty())
+                break;
+            auto [block, data] = std::move(queue.front());
+            queue.pop_front();
+            lock.unlock();
+
+            // Fast compression, previews favor latency over bandwidth
+            uLongf size = compressBound((uLong) data.size());
+            std::vector<uint8_t> compressed(size);
+            bool sent = false;
+            if (compress2(compressed.data(), &size, data.data(), (uLong) data.size(), 1) == Z_OK) {
+                try {
+                    socket.sendmore(msg_block);
+                    socket.sendmore(block);
+                    sent = socket.send(compressed.data(), (size_t) size, ZMQ_DONTWAIT);
+                } catch (const zmq::exception &) { }
+            }
+            (sent ? published : dropped)++;
+
+            lock.lock();
+        }
+    }
+#endif
+};
+
+BlockPublisher::BlockPublisher(const std::string &address, size_t queue_size)
+    : d(new BlockPublisherPrivate()) {
+#if defined(MTS_ENABLE_ZMQ)
+    d->queue_size = std::max(queue_size, (size_t) 1);
+    d->socket.setsockopt<int>(ZMQ_SNDHWM, (int) d->queue_size);
+    d->socket.setsockopt<int>(ZMQ_LINGER, 1000);
+    d->socket.bind(address);
+
+    BlockPublisherPrivate *p = d.get();
+    d->thread = std::thread([p]() { p->run(); });
+#else
+    ENOKI_MARK_USED(address);
+    ENOKI_MARK_USED(queue_size);
+    Throw("BlockPublisher: Mitsuba was compiled without ZeroMQ support (MTS_ENABLE_ZMQ)!");
+#endif
+}
+
+BlockPublisher::~BlockPublisher() {
+    {
+        std::lock_guard<std::mutex> guard(d->mutex);
+        d->stop = true;
+    }
+    d->cv.notify_all();
+    if (d->thread.joinable())
+        d->thread.join();
+}
+
+bool BlockPublisher::publish(const PublishedBlock &block, const void *data) {
+    auto full = [&]() {
+        if (d->queue.size() < d->queue_size)
+            return false;
+        d->dropped++;
+        return true;
+    };
+
+    {
+        std::lock_guard<std::mutex> guard(d->mutex);
+        if (full())
+            return false;
+    }
+
+    // Copy outside of the lock, so that render threads don't wait for each other
+    const uint8_t *ptr = (const uint8_t *) data;
+    std::vector<uint8_t> copy(ptr, ptr + block.data_size);
+
+    {
+        std::lock_guard<std::mutex> guard(d->mutex);
+        if (full())
+            return false;
+        d->queue.emplace_back(block, std::move(copy));
+    }
+    d->cv.notify_one();
+    return true;
+}
+
+size_t BlockPublisher::published_count() const { return d->published; }
+
+size_t BlockPublisher::dropped_count() const { return d->dropped; }
+
+// =============================================================================
+
+struct BlockSubscriber::BlockSubscriberPrivate {
+#if defined(MTS_ENABLE_ZMQ)
+    zmq::context context;
+    zmq::socket socket;
+
+    BlockSubscriberPrivate() : socket(context, zmq::socket::sub) { }
+#endif
+};
+
+BlockSubscriber::BlockSubscriber(const std::string &address)
+    : d(new BlockSubscriberPrivate()) {
+#if defined(MTS_ENABLE_ZMQ)
+    d->socket.setsockopt(ZMQ_SUBSCRIBE, msg_block.data(), msg_block.size());
+    d->socket.setsockopt<int>(ZMQ_LINGER, 0);
+    d->socket.connect(address);
+#else
+    ENOKI_MARK_USED(address);
+    Throw("BlockSubscriber: Mitsuba was compiled without ZeroMQ support (MTS_ENABLE_ZMQ)!");
+#endif
+}
+
+BlockSubscriber::~BlockSubscriber() { }
+
+bool BlockSubscriber::receive(PublishedBlock &block, std::vector<uint8_t> &data, int timeout) {
+#if defined(MTS_ENABLE_ZMQ)
+    zmq::socket &socket = d->socket;
+
+    zmq::pollitem poll_item = { (void *) socket, 0, zmq::pollin, 0 };
+    if (zmq::poll(&poll_item, 1, (long) timeout) == 0)
+        return false;
+
+    std::string type;
+    zmq::message message;
+    socket.recv(type);
+    socket.recvmore(block);
+    socket.recv(message);
+
+    data.resize(block.data_size);
+    uLongf size = (uLongf) block.data_size;
+    if (uncompress(data.data(), &size, message.data<uint8_t>(), (uLong) message.size()) != Z_OK ||
+        size != block.data_size)
+        Throw("BlockSubscriber: received a corrupted image block!");
+
+    return true;
+#else
+    ENOKI_MARK_USED(block);
+    ENOKI_MARK_USED(data);
+    ENOKI_MARK_USED(timeout);
+    return false;
+#endif
+}
+
+MTS_IMPLEMENT_CLASS(RenderCoordinator, Object)
+MTS_IMPLEMENT_CLASS(RenderWorker, Object)
+MTS_IMPLEMENT_CLASS(RenderServer, Object)
+MTS_IMPLEMENT_CLASS(RenderClient, Object)
+MTS_IMPLEMENT_CLASS(BlockPublisher, Object)
+MTS_IMPLEMENT_CLASS(BlockSubscriber, Object)
+NAMESPACE_END(mitsuba)
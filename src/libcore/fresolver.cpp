@@ -9,9 +9,10 @@ FileResolver::FileResolver() : Object() {
 }
 
 FileResolver::FileResolver(const FileResolver &fr)
-  : Object(), m_paths(fr.m_paths) { }
+  : Object(), m_paths(fr.m_paths), m_cache_enabled(fr.m_cache_enabled) { }
 
 void FileResolver::erase(const fs::path &p) {
+    clear_cache();
     m_paths.erase(std::remove(m_paths.begin(), m_paths.end(), p), m_paths.end());
 }
 
@@ -20,14 +21,42 @@ bool FileResolver::contains(const fs::path &p) const {
 }
 
 fs::path FileResolver::resolve(const fs::path &path) const {
-    if (!path.is_absolute()) {
-        for (auto const &base : m_paths) {
-            fs::path combined = base / path;
-            if (fs::exists(combined))
-                return combined;
+    if (path.is_absolute())
+        return path;
+
+    if (m_cache_enabled) {
+        std::lock_guard<std::mutex> guard(m_cache_mutex);
+        auto it = m_cache.find(path.string());
+        if (it != m_cache.end())
+            return it->second;
+    }
+
+    fs::path result = path;
+    for (auto const &base : m_paths) {
+        fs::path combined = base / path;
+        if (fs::exists(combined)) {
+            result = combined;
+            break;
         }
     }
-    return path;
+
+    if (m_cache_enabled) {
+        std::lock_guard<std::mutex> guard(m_cache_mutex);
+        m_cache.emplace(path.string(), result);
+    }
+
+    return result;
+}
+
+void FileResolver::set_cache_enabled(bool value) {
+    m_cache_enabled = value;
+    if (!value)
+        clear_cache();
+}
+
+void FileResolver::clear_cache() {
+    std::lock_guard<std::mutex> guard(m_cache_mutex);
+    m_cache.clear();
 }
 
 std::string FileResolver::to_string() const {
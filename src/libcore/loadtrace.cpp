@@ -0,0 +1,187 @@
+#include <mitsuba/core/loadtrace.h>
+#include <mitsuba/core/logger.h>
+#include <mitsuba/core/string.h>
+#include <mitsuba/core/util.h>
+#include <algorithm>
+#include <fstream>
+#include <mutex>
+#include <unordered_map>
+
+NAMESPACE_BEGIN(mitsuba)
+
+bool LoadTrace::m_enabled = false;
+
+struct LoadTraceState {
+    std::mutex mutex;
+    std::vector<LoadRecord> records;
+    LoadTrace::Clock::time_point origin = LoadTrace::Clock::now();
+    uint32_t loads = 0;
+};
+
+static LoadTraceState *load_trace_state() {
+    static LoadTraceState state;
+    return &state;
+}
+
+void LoadTrace::set_enabled(bool value) {
+    if (value)
+        clear();
+    m_enabled = value;
+}
+
+uint32_t LoadTrace::begin_load() {
+    LoadTraceState *state = load_trace_state();
+    std::lock_guard<std::mutex> guard(state->mutex);
+    return state->loads++;
+}
+
+double LoadTrace::time(Clock::time_point t) {
+    return std::chrono::duration<double, std::milli>(t - load_trace_state()->origin).count();
+}
+
+void LoadTrace::add(LoadRecord &&record) {
+    LoadTraceState *state = load_trace_state();
+    std::lock_guard<std::mutex> guard(state->mutex);
+    state->records.push_back(std::move(record));
+}
+
+std::vector<LoadRecord> LoadTrace::records() {
+    LoadTraceState *state = load_trace_state();
+    std::vector<LoadRecord> result;
+    {
+        std::lock_guard<std::mutex> guard(state->mutex);
+        result = state->records;
+    }
+    std::stable_sort(result.begin(), result.end(),
+                     [](const LoadRecord &a, const LoadRecord &b) { return a.start < b.start; });
+    return result;
+}
+
+std::vector<LoadRecord> LoadTrace::critical_path() {
+    std::vector<LoadRecord> all = records();
+    if (all.empty())
+        return { };
+
+    uint32_t load = 0;
+    for (const LoadRecord &r : all)
+        load = std::max(load, r.load);
+
+    std::unordered_map<std::string, const LoadRecord *> by_id;
+    const LoadRecord *current = nullptr;
+    for (const LoadRecord &r : all) {
+        if (r.load != load)
+            continue;
+        by_id[r.id] = &r;
+        if (!current || r.end() > current->end())
+            current = &r;
+    }
+
+    std::vector<LoadRecord> path;
+    while (current) {
+        path.push_back(*current);
+        const LoadRecord *next = nullptr;
+        for (const std::string &id : current->references) {
+            auto it = by_id.find(id);
+            if (it != by_id.end() && (!next || it->second->end() > next->end()))
+                next = it->second;
+        }
+        current = next;
+    }
+
+    std::reverse(path.begin(), path.end());
+    return path;
+}
+
+void LoadTrace::clear() {
+    LoadTraceState *state = load_trace_state();
+    std::lock_guard<std::mutex> guard(state->mutex);
+    state->records.clear();
+    state->origin = Clock::now();
+    state->loads = 0;
+}
+
+static std::string load_record_name(const LoadRecord &r) {
+    std::string name = tfm::format("%s \"%s\" (%s)", string::to_lower(r.class_name),
+                                   r.id, r.plugin);
+    if (!r.filename.empty())
+        name += ", " + r.filename;
+    return name;
+}
+
+void LoadTrace::print_report(size_t count) {
+    std::vector<LoadRecord> all = records();
+    if (all.empty())
+        return;
+
+    std::vector<LoadRecord> sorted = all;
+    std::sort(sorted.begin(), sorted.end(), [](const LoadRecord &a, const LoadRecord &b) {
+        return a.time + a.prefetch_time > b.time + b.prefetch_time;
+    });
+
+    uint64_t bytes_read = 0, decoded_bytes = 0;
+    for (const LoadRecord &r : all) {
+        bytes_read += r.bytes_read;
+        decoded_bytes += r.decoded_bytes;
+    }
+
+    Log(Info, "Load trace: %i objects, %s read, %s decoded. Slowest objects:", all.size(),
+        util::mem_string(bytes_read), util::mem_string(decoded_bytes));
+    for (size_t i = 0; i < std::min(count, sorted.size()); ++i) {
+        const LoadRecord &r = sorted[i];
+        Log(Info, "  %10s  %10s  %-12s %s", util::time_string((float) r.time, true),
+            r.prefetch_time > 0 ? util::time_string((float) r.prefetch_time, true) : "",
+            r.thread, load_record_name(r));
+    }
+
+    std::vector<LoadRecord> path = critical_path();
+    if (!path.empty()) {
+        Log(Info, "Critical path (%s):",
+            util::time_string((float) (path.back().end() - path.front().start), true));
+        for (const LoadRecord &r : path)
+            Log(Info, "  %10s  at %10s  %s", util::time_string((float) r.time, true),
+                util::time_string((float) r.start, true), load_record_name(r));
+    }
+}
+
+void LoadTrace::write_json(const std::string &filename) {
+    std::ofstream os(filename);
+    if (!os.good())
+        Throw("LoadTrace::write_json(): could not open \"%s\"!", filename);
+
+    auto write_strings = [&](const std::vector<std::string> &values) {
+        os << "[";
+        for (size_t i = 0; i < values.size(); ++i)
+            os << (i == 0 ? "" : ", ") << "\"" << string::json_escape(values[i]) << "\"";
+        os << "]";
+    };
+
+    std::vector<LoadRecord> all = records();
+    os << "{" << std::endl << "  \"objects\": [" << std::endl;
+    for (size_t i = 0; i < all.size(); ++i) {
+        const LoadRecord &r = all[i];
+        os << "    { \"id\": \"" << string::json_escape(r.id) << "\", "
+           << "\"plugin\": \"" << string::json_escape(r.plugin) << "\", "
+           << "\"class\": \"" << string::json_escape(r.class_name) << "\", "
+           << "\"filename\": \"" << string::json_escape(r.filename) << "\", "
+           << "\"thread\": \"" << string::json_escape(r.thread) << "\", "
+           << "\"load\": " << r.load << ", "
+           << "\"start_ms\": " << r.start << ", "
+           << "\"time_ms\": " << r.time << ", "
+           << "\"prefetch_time_ms\": " << r.prefetch_time << ", "
+           << "\"bytes_read\": " << r.bytes_read << ", "
+           << "\"decoded_bytes\": " << r.decoded_bytes << ", "
+           << "\"references\": ";
+        write_strings(r.references);
+        os << " }" << (i + 1 < all.size() ? "," : "") << std::endl;
+    }
+    os << "  ]," << std::endl << "  \"critical_path\": ";
+
+    std::vector<std::string> path;
+    for (const LoadRecord &r : critical_path())
+        path.push_back(r.id);
+    write_strings(path);
+    os << std::endl << "}" << std::endl;
+}
+
+MTS_IMPLEMENT_CLASS(LoadTrace, Object)
+NAMESPACE_END(mitsuba)
@@ -9,6 +9,8 @@
 #include <iostream>
 #include <algorithm>
 #include <mutex>
+#include <atomic>
+#include <condition_variable>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -17,12 +19,116 @@ struct Logger::LoggerPrivate {
     LogLevel error_level = Error;
     std::vector<ref<Appender>> appenders;
     ref<Formatter> formatter;
+
+    /* Asynchronous mode (see Logger::set_asynchronous()): messages are
+       pushed onto an intrusive multi-producer/single-consumer queue (due to
+       D. Vyukov) without taking any locks, and a background thread hands
+       them over to the appenders */
+    struct Message {
+        std::atomic<Message *> next { nullptr };
+        bool is_progress = false;
+        LogLevel level = Info;
+        float progress = 0.f;
+        std::string text, name, eta;
+        const void *ptr = nullptr;
+    };
+
+    std::atomic<bool> async { false };
+    std::atomic<Message *> head;
+    Message *tail;
+    std::mutex consumer_mutex;
+    std::mutex async_mutex;
+    std::mutex wait_mutex;
+    std::condition_variable wait_cond;
+    std::thread worker;
+    bool stop = false;
+
+    LoggerPrivate() {
+        tail = new Message();
+        head.store(tail, std::memory_order_relaxed);
+    }
+
+    ~LoggerPrivate() {
+        drain();
+        delete tail;
+    }
+
+    /// Enqueue a message (lock-free, may be called by any number of threads)
+    void push(Message *msg) {
+        Message *prev = head.exchange(msg, std::memory_order_acq_rel);
+        prev->next.store(msg, std::memory_order_release);
+        wait_cond.notify_one();
+    }
+
+    /// Deliver all queued messages to the appenders
+    void drain() {
+        std::lock_guard<std::mutex> guard(consumer_mutex);
+        Message *next = tail->next.load(std::memory_order_acquire);
+        if (!next)
+            return;
+
+        std::lock_guard<std::mutex> guard2(mutex);
+        while (next) {
+            for (auto entry : appenders) {
+                if (next->is_progress)
+                    entry->log_progress(next->progress, next->name, next->text,
+                                        next->eta, next->ptr);
+                else
+                    entry->append(next->level, next->text);
+            }
+            delete tail;
+            tail = next;
+            next = tail->next.load(std::memory_order_acquire);
+        }
+    }
+
+    void run() {
+        std::unique_lock<std::mutex> lock(wait_mutex);
+        while (!stop) {
+            // Timeout as a backstop against a notification racing with wait()
+            wait_cond.wait_for(lock, std::chrono::milliseconds(50));
+            lock.unlock();
+            drain();
+            lock.lock();
+        }
+    }
 };
 
 Logger::Logger(LogLevel log_level)
     : m_log_level(log_level), d(new LoggerPrivate()) { }
 
-Logger::~Logger() { }
+Logger::~Logger() {
+    set_asynchronous(false);
+}
+
+void Logger::set_asynchronous(bool value) {
+    std::lock_guard<std::mutex> guard(d->async_mutex);
+    if (value == d->async.load(std::memory_order_relaxed))
+        return;
+
+    if (value) {
+        d->stop = false;
+        d->worker = std::thread([d = d.get()]() { d->run(); });
+        d->async.store(true, std::memory_order_release);
+    } else {
+        d->async.store(false, std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> guard2(d->wait_mutex);
+            d->stop = true;
+        }
+        d->wait_cond.notify_one();
+        d->worker.join();
+        d->drain();
+    }
+}
+
+bool Logger::asynchronous() const {
+    return d->async.load(std::memory_order_relaxed);
+}
+
+void Logger::flush() {
+    d->drain();
+}
 
 void Logger::set_formatter(Formatter *formatter) {
     std::lock_guard<std::mutex> guard(d->mutex);
@@ -69,6 +175,14 @@ void Logger::log(LogLevel level, const Class *class_, const char *file,
     std::string text = d->formatter->format(level, class_,
         Thread::thread(), file, line, msg);
 
+    if (d->async.load(std::memory_order_acquire)) {
+        auto message = new LoggerPrivate::Message();
+        message->level = level;
+        message->text = std::move(text);
+        d->push(message);
+        return;
+    }
+
     std::lock_guard<std::mutex> guard(d->mutex);
     for (auto entry : d->appenders)
         entry->append(level, text);
@@ -76,6 +190,18 @@ void Logger::log(LogLevel level, const Class *class_, const char *file,
 
 void Logger::log_progress(float progress, const std::string &name,
     const std::string &formatted, const std::string &eta, const void *ptr) {
+    if (d->async.load(std::memory_order_acquire)) {
+        auto message = new LoggerPrivate::Message();
+        message->is_progress = true;
+        message->progress = progress;
+        message->name = name;
+        message->text = formatted;
+        message->eta = eta;
+        message->ptr = ptr;
+        d->push(message);
+        return;
+    }
+
     std::lock_guard<std::mutex> guard(d->mutex);
     for (auto entry : d->appenders)
         entry->log_progress(progress, name, formatted, eta, ptr);
@@ -87,12 +213,14 @@ void Logger::add_appender(Appender *appender) {
 }
 
 void Logger::remove_appender(Appender *appender) {
+    flush();
     std::lock_guard<std::mutex> guard(d->mutex);
     d->appenders.erase(std::remove(d->appenders.begin(),
         d->appenders.end(), ref<Appender>(appender)), d->appenders.end());
 }
 
 std::string Logger::read_log() {
+    flush();
     std::lock_guard<std::mutex> guard(d->mutex);
     for (auto appender: d->appenders) {
         if (appender->class_()->derives_from(MTS_CLASS(StreamAppender))) {
@@ -106,6 +234,7 @@ std::string Logger::read_log() {
 }
 
 void Logger::clear_appenders() {
+    flush();
     std::lock_guard<std::mutex> guard(d->mutex);
     d->appenders.clear();
 }
@@ -0,0 +1,107 @@
+#include <mitsuba/core/memreport.h>
+#include <mitsuba/core/logger.h>
+#include <mitsuba/core/util.h>
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
+NAMESPACE_BEGIN(mitsuba)
+
+const char *memory_category_name(MemoryCategory category) {
+    switch (category) {
+        case MemoryCategory::Geometry:      return "geometry";
+        case MemoryCategory::Acceleration:  return "acceleration";
+        case MemoryCategory::Textures:      return "textures";
+        case MemoryCategory::Volumes:       return "volumes";
+        case MemoryCategory::Distributions: return "distributions";
+        case MemoryCategory::Film:          return "film";
+        case MemoryCategory::Other:         return "other";
+        default: Throw("memory_category_name(): invalid category!");
+    }
+}
+
+MemoryReport::MemoryReport() {
+    memset(m_host, 0, sizeof(m_host));
+    memset(m_device, 0, sizeof(m_device));
+}
+
+MemoryReport::~MemoryReport() { }
+
+void MemoryReport::visit(const Object *object) {
+    if (!object || !m_visited.insert(object).second)
+        return;
+
+    const Class *parent = m_current;
+    m_current = object->class_();
+    object->account_memory(this);
+    m_current = parent;
+}
+
+void MemoryReport::add(MemoryCategory category, size_t size, bool device) {
+    if (category >= MemoryCategory::Count)
+        Throw("MemoryReport::add(): invalid category!");
+    if (size == 0)
+        return;
+
+    (device ? m_device : m_host)[(size_t) category] += size;
+    m_classes[m_current ? m_current->name() : "<unknown>"] += size;
+}
+
+size_t MemoryReport::host(MemoryCategory category) const {
+    return m_host[(size_t) category];
+}
+
+size_t MemoryReport::device(MemoryCategory category) const {
+    return m_device[(size_t) category];
+}
+
+size_t MemoryReport::total_host() const {
+    size_t sum = 0;
+    for (size_t value : m_host)
+        sum += value;
+    return sum;
+}
+
+size_t MemoryReport::total_device() const {
+    size_t sum = 0;
+    for (size_t value : m_device)
+        sum += value;
+    return sum;
+}
+
+std::string MemoryReport::to_string() const {
+    bool has_device = total_device() > 0;
+
+    std::ostringstream oss;
+    oss << "MemoryReport[" << std::endl;
+    for (uint32_t i = 0; i < (uint32_t) MemoryCategory::Count; ++i) {
+        MemoryCategory category = MemoryCategory(i);
+        oss << "  " << memory_category_name(category) << " = "
+            << util::mem_string(host(category));
+        if (has_device)
+            oss << " (host), " << util::mem_string(device(category)) << " (device)";
+        oss << "," << std::endl;
+    }
+
+    oss << "  total = " << util::mem_string(total_host());
+    if (has_device)
+        oss << " (host), " << util::mem_string(total_device()) << " (device)";
+    oss << "," << std::endl;
+
+    // List the object types in the order of decreasing memory usage
+    std::vector<std::pair<std::string, size_t>> classes(m_classes.begin(), m_classes.end());
+    std::sort(classes.begin(), classes.end(),
+              [](const auto &a, const auto &b) { return a.second > b.second; });
+
+    oss << "  objects = " << m_visited.size() << "," << std::endl
+        << "  types = {" << std::endl;
+    for (size_t i = 0; i < classes.size(); ++i)
+        oss << "    " << classes[i].first << " = " << util::mem_string(classes[i].second)
+            << (i + 1 < classes.size() ? "," : "") << std::endl;
+    oss << "  }" << std::endl
+        << "]";
+    return oss.str();
+}
+
+MTS_IMPLEMENT_CLASS(MemoryReport, Object)
+NAMESPACE_END(mitsuba)
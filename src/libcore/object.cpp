@@ -1,4 +1,5 @@
 #include <mitsuba/core/object.h>
+#include <mitsuba/core/memreport.h>
 #include <cstdlib>
 #include <cstdio>
 #include <sstream>
@@ -24,6 +25,22 @@ void Object::traverse(TraversalCallback * /*callback*/) { }
 
 void Object::parameters_changed(const std::vector<std::string> &/*keys*/) { }
 
+void Object::account_memory(MemoryReport *report) const {
+    /// Forwards the referenced objects to the report and ignores parameters
+    struct MemoryCallback : public TraversalCallback {
+        MemoryCallback(MemoryReport *report) : report(report) { }
+
+        void put_object(const std::string &, Object *obj) override { report->visit(obj); }
+
+        void put_parameter_impl(const std::string &, const std::type_info &, void *) override { }
+
+        MemoryReport *report;
+    };
+
+    MemoryCallback callback(report);
+    const_cast<Object *>(this)->traverse(&callback);
+}
+
 std::string Object::id() const { return std::string(); }
 
 std::string Object::to_string() const {
@@ -4,6 +4,7 @@
 #include <mitsuba/core/properties.h>
 #include <mitsuba/core/filesystem.h>
 #include <mitsuba/core/fresolver.h>
+#include <algorithm>
 #include <mutex>
 #include <unordered_map>
 
@@ -80,11 +81,17 @@ private:
 struct PluginManager::PluginManagerPrivate {
     std::unordered_map<std::string, Plugin *> m_plugins;
     std::vector<std::string> m_python_plugins;
+    /// Classes of plugins that were already looked up, keyed by "name.variant"
+    std::unordered_map<std::string, const Class *> m_classes;
     std::mutex m_mutex;
 
     Plugin *plugin(const std::string &name) {
         std::lock_guard<std::mutex> guard(m_mutex);
+        return plugin_locked(name);
+    }
 
+    /// Variant of \ref plugin() for callers that already hold \c m_mutex
+    Plugin *plugin_locked(const std::string &name) {
         // Plugin already loaded?
         auto it = m_plugins.find(name);
         if (it != m_plugins.end())
@@ -133,17 +140,45 @@ void PluginManager::ensure_plugin_loaded(const std::string &name) {
     (void) d->plugin(name);
 }
 
+void PluginManager::preload_plugins(const std::vector<std::string> &names) {
+    /* Loading is serialized in any case: the dynamic loader holds a global
+       lock, and the classes of every new plugin must be registered in the
+       (shared) class hierarchy */
+    std::lock_guard<std::mutex> guard(d->m_mutex);
+    for (const std::string &name : names) {
+        if (std::find(d->m_python_plugins.begin(), d->m_python_plugins.end(),
+                      name) != d->m_python_plugins.end())
+            continue;
+        try {
+            (void) d->plugin_locked(name);
+        } catch (const std::exception &) {
+            // Reported with more context once the object is created
+        }
+    }
+}
+
 const Class *PluginManager::get_plugin_class(const std::string &name, const std::string &variant) {
-    const Class *plugin_class;
+    std::string key = name + "." + variant;
 
+    /* Class lookups are done while holding the lock, since loading another
+       plugin concurrently modifies the class hierarchy */
+    std::lock_guard<std::mutex> guard(d->m_mutex);
+    auto it_class = d->m_classes.find(key);
+    if (it_class != d->m_classes.end())
+        return it_class->second;
+
+    const Class *plugin_class;
     auto it = std::find(d->m_python_plugins.begin(), d->m_python_plugins.end(), name);
     if (it != d->m_python_plugins.end()) {
         plugin_class = Class::for_name(name, variant);
     } else {
-        const Plugin *plugin = d->plugin(name);
+        const Plugin *plugin = d->plugin_locked(name);
         plugin_class = Class::for_name(plugin->plugin_name, variant);
     }
 
+    if (plugin_class)
+        d->m_classes.emplace(key, plugin_class);
+
     return plugin_class;
 }
 
@@ -156,8 +191,17 @@ std::vector<std::string> PluginManager::loaded_plugins() const {
 }
 
 void PluginManager::register_python_plugin(const std::string &plugin_name) {
+    std::lock_guard<std::mutex> guard(d->m_mutex);
     d->m_python_plugins.push_back(plugin_name);
     Class::static_initialization();
+
+    // A Python plugin may replace a native plugin of the same name
+    for (auto it = d->m_classes.begin(); it != d->m_classes.end(); ) {
+        if (it->first.compare(0, plugin_name.size() + 1, plugin_name + ".") == 0)
+            it = d->m_classes.erase(it);
+        else
+            ++it;
+    }
 }
 
 ref<Object> PluginManager::create_object(const Properties &props, const Class *class_) {
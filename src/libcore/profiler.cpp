@@ -1,5 +1,7 @@
 #include <mitsuba/core/profiler.h>
 #include <mitsuba/core/logger.h>
+#include <mitsuba/core/string.h>
+#include <mitsuba/core/thread.h>
 #include <mitsuba/core/util.h>
 
 #if defined(MTS_ENABLE_PROFILER)
@@ -8,7 +10,11 @@
 #include <stdio.h>
 #include <tbb/tbb.h>
 #include <array>
+#include <fstream>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -50,6 +56,8 @@ static void profiler_callback(int, siginfo_t *, void *) {
     bucket.count++;
 }
 
+bool Profiler::m_enabled = false;
+
 void Profiler::static_initialization() {
     if (!util::detect_debugger()) {
         (void) profiler_flags();
@@ -61,31 +69,40 @@ void Profiler::static_initialization() {
         sigemptyset(&sa.sa_mask);
         if (sigaction(SIGPROF, &sa, nullptr))
             Throw("profiler_start(): failure in sigaction(): %s", strerror(errno));
-
-        itimerval timer;
-        timer.it_interval.tv_sec = 0;
-        timer.it_interval.tv_usec = 1000000 / 100; // 100 Hz sampling
-        timer.it_value = timer.it_interval;
-
-        if (setitimer(ITIMER_PROF, &timer, nullptr))
-            Throw("profiler_start(): failure in setitimer(): %s", strerror(errno));
     }
 }
 
-void Profiler::static_shutdown() {
+/// Start or stop the timer that triggers the sampling callback
+static void profiler_set_timer(bool value) {
     if (util::detect_debugger())
         return;
 
     itimerval timer;
     timer.it_interval.tv_sec = 0;
-    timer.it_interval.tv_usec = 0;
+    timer.it_interval.tv_usec = value ? 1000000 / 100 : 0; // 100 Hz sampling
     timer.it_value = timer.it_interval;
 
     if (setitimer(ITIMER_PROF, &timer, nullptr))
-        Throw("profiler_stop(): failure in setitimer(): %s", strerror(errno));
+        Throw("profiler_set_timer(): failure in setitimer(): %s", strerror(errno));
+}
+
+void Profiler::static_shutdown() {
+    // Keep the enabled state, so that the report can still be printed
+    if (m_enabled)
+        profiler_set_timer(false);
+}
+
+void Profiler::set_enabled(bool value) {
+    if (value == m_enabled)
+        return;
+    m_enabled = value;
+    profiler_set_timer(value);
 }
 
 void Profiler::print_report() {
+    if (!m_enabled)
+        return;
+
     using SampleMap = std::map<std::string, uint64_t>;
 
     uint64_t event_count_total = 0,
@@ -174,6 +191,233 @@ void Profiler::print_report() {
     }
 }
 
+// -----------------------------------------------------------------------
+//  Per-instance call statistics
+// -----------------------------------------------------------------------
+
+bool Profiler::m_instance_statistics = false;
+
+struct InstanceRecord {
+    std::string class_name, id;
+    uint64_t count = 0, time_ns = 0;
+};
+
+struct InstanceKey {
+    const Object *object;
+    ProfilerPhase phase;
+
+    bool operator==(const InstanceKey &k) const {
+        return object == k.object && phase == k.phase;
+    }
+};
+
+struct InstanceKeyHasher {
+    size_t operator()(const InstanceKey &k) const {
+        return std::hash<const void *>{}(k.object) ^ (size_t(k.phase) * 0x9E3779B97F4A7C15ull);
+    }
+};
+
+using InstanceMap = std::unordered_map<InstanceKey, InstanceRecord, InstanceKeyHasher>;
+
+/* Every thread records into its own table. The tables are owned by a global
+   list so that they outlive the threads, and the (uncontended) per-table lock
+   is only needed to safely produce a report. */
+struct InstanceTable {
+    std::mutex mutex;
+    InstanceMap records;
+};
+
+static std::mutex instance_tables_mutex;
+static std::vector<std::shared_ptr<InstanceTable>> instance_tables;
+static thread_local InstanceTable *instance_table = nullptr;
+
+void Profiler::record_instance(const Object *object, ProfilerPhase phase, uint64_t time_ns) {
+    if (unlikely(!instance_table)) {
+        auto table = std::make_shared<InstanceTable>();
+        std::lock_guard<std::mutex> guard(instance_tables_mutex);
+        instance_tables.push_back(table);
+        instance_table = table.get();
+    }
+
+    std::lock_guard<std::mutex> guard(instance_table->mutex);
+    InstanceRecord &record = instance_table->records[InstanceKey{ object, phase }];
+    if (unlikely(record.count == 0)) {
+        // The object may no longer exist when the report is generated
+        record.class_name = object->class_()->name();
+        record.id = object->id();
+    }
+    record.count++;
+    record.time_ns += time_ns;
+}
+
+/// Merge the tables of all threads, sorted by decreasing total time
+static std::vector<std::pair<InstanceKey, InstanceRecord>> instance_results() {
+    InstanceMap merged;
+    std::lock_guard<std::mutex> guard(instance_tables_mutex);
+    for (auto &table : instance_tables) {
+        std::lock_guard<std::mutex> guard2(table->mutex);
+        for (auto &[key, record] : table->records) {
+            InstanceRecord &target = merged[key];
+            if (target.count == 0) {
+                target.class_name = record.class_name;
+                target.id = record.id;
+            }
+            target.count += record.count;
+            target.time_ns += record.time_ns;
+        }
+    }
+
+    std::vector<std::pair<InstanceKey, InstanceRecord>> result(merged.begin(), merged.end());
+    std::sort(result.begin(), result.end(), [](const auto &a, const auto &b) {
+        return a.second.time_ns > b.second.time_ns;
+    });
+    return result;
+}
+
+static std::string instance_name(const InstanceRecord &record) {
+    if (record.id.empty())
+        return record.class_name;
+    return record.class_name + "[id=\"" + record.id + "\"]";
+}
+
+void Profiler::print_instance_report() {
+    auto results = instance_results();
+    if (results.empty())
+        return;
+
+    size_t name_length = 0, phase_length = 0;
+    for (const auto &[key, record] : results) {
+        name_length = std::max(name_length, instance_name(record).length());
+        phase_length = std::max(phase_length, strlen(profiler_phase_id[int(key.phase)]));
+    }
+
+    Log(Info, "\U000023F1  Profile (per instance, inclusive):");
+    for (const auto &[key, record] : results) {
+        std::string name = instance_name(record);
+        const char *phase = profiler_phase_id[int(key.phase)];
+        Log(Info, "    %s%s  %s%s  %10i calls  %10s  %8.1f ns/call", name,
+            std::string(name_length - name.length(), ' '), phase,
+            std::string(phase_length - strlen(phase), ' '), record.count,
+            util::time_string(record.time_ns * 1e-6f, true),
+            record.time_ns / (double) record.count);
+    }
+}
+
+void Profiler::write_instance_report(const std::string &filename) {
+    std::ofstream os(filename);
+    if (!os.good())
+        Throw("write_instance_report(): could not open \"%s\"!", filename);
+
+    auto results = instance_results();
+    os << "[" << std::endl;
+    for (size_t i = 0; i < results.size(); ++i) {
+        const auto &[key, record] = results[i];
+        os << "  { \"class\": \"" << string::json_escape(record.class_name) << "\", "
+           << "\"id\": \"" << string::json_escape(record.id) << "\", "
+           << "\"phase\": \"" << string::json_escape(profiler_phase_id[int(key.phase)]) << "\", "
+           << "\"calls\": " << record.count << ", "
+           << "\"time_ns\": " << record.time_ns << " }"
+           << (i + 1 < results.size() ? "," : "") << std::endl;
+    }
+    os << "]" << std::endl;
+}
+
+void Profiler::clear_instance_statistics() {
+    std::lock_guard<std::mutex> guard(instance_tables_mutex);
+    for (auto &table : instance_tables) {
+        std::lock_guard<std::mutex> guard2(table->mutex);
+        table->records.clear();
+    }
+}
+
+// -----------------------------------------------------------------------
+//  Timeline trace
+// -----------------------------------------------------------------------
+
+uint64_t Profiler::m_trace_mask = 0;
+
+struct TraceEvent {
+    Profiler::Clock::time_point begin, end;
+    ProfilerPhase phase;
+};
+
+/* Like the per-instance statistics, every thread records into its own ring
+   buffer, which is owned by a global list so that it outlives the thread. */
+struct TraceBuffer {
+    std::mutex mutex;
+    std::vector<TraceEvent> events;
+    size_t next = 0;
+    uint32_t id;
+    std::string thread_name;
+};
+
+static std::mutex trace_buffers_mutex;
+static std::vector<std::shared_ptr<TraceBuffer>> trace_buffers;
+static thread_local TraceBuffer *trace_buffer = nullptr;
+static Profiler::Clock::time_point trace_start = Profiler::Clock::now();
+
+void Profiler::record_trace(ProfilerPhase phase, Clock::time_point begin, Clock::time_point end) {
+    if (unlikely(!trace_buffer)) {
+        auto buffer = std::make_shared<TraceBuffer>();
+        buffer->events.reserve(MTS_PROFILE_TRACE_SIZE);
+        Thread *thread = Thread::thread();
+        std::lock_guard<std::mutex> guard(trace_buffers_mutex);
+        buffer->id = (uint32_t) trace_buffers.size() + 1;
+        buffer->thread_name = thread ? thread->name() : tfm::format("thread %i", buffer->id);
+        trace_buffers.push_back(buffer);
+        trace_buffer = buffer.get();
+    }
+
+    std::lock_guard<std::mutex> guard(trace_buffer->mutex);
+    TraceEvent event { begin, end, phase };
+    if (trace_buffer->events.size() < MTS_PROFILE_TRACE_SIZE)
+        trace_buffer->events.push_back(event);
+    else
+        trace_buffer->events[trace_buffer->next] = event;
+    trace_buffer->next = (trace_buffer->next + 1) % MTS_PROFILE_TRACE_SIZE;
+}
+
+void Profiler::write_trace(const std::string &filename) {
+    std::ofstream os(filename);
+    if (!os.good())
+        Throw("write_trace(): could not open \"%s\"!", filename);
+
+    auto microseconds = [](Clock::duration d) {
+        return tfm::format("%.3f", std::chrono::duration<double, std::micro>(d).count());
+    };
+
+    std::lock_guard<std::mutex> guard(trace_buffers_mutex);
+    os << "{ \"displayTimeUnit\": \"ms\", \"traceEvents\": [" << std::endl;
+    bool first = true;
+    for (auto &buffer : trace_buffers) {
+        std::lock_guard<std::mutex> guard2(buffer->mutex);
+        os << (first ? "" : ",\n")
+           << "  { \"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": "
+           << buffer->id << ", \"args\": { \"name\": \""
+           << string::json_escape(buffer->thread_name) << "\" } }";
+        first = false;
+
+        for (const TraceEvent &event : buffer->events) {
+            os << ",\n  { \"name\": \""
+               << string::json_escape(profiler_phase_id[int(event.phase)])
+               << "\", \"cat\": \"mitsuba\", \"ph\": \"X\", \"pid\": 1, \"tid\": "
+               << buffer->id << ", \"ts\": " << microseconds(event.begin - trace_start)
+               << ", \"dur\": " << microseconds(event.end - event.begin) << " }";
+        }
+    }
+    os << std::endl << "] }" << std::endl;
+}
+
+void Profiler::clear_trace() {
+    std::lock_guard<std::mutex> guard(trace_buffers_mutex);
+    for (auto &buffer : trace_buffers) {
+        std::lock_guard<std::mutex> guard2(buffer->mutex);
+        buffer->events.clear();
+        buffer->next = 0;
+    }
+    trace_start = Clock::now();
+}
+
 MTS_IMPLEMENT_CLASS(Profiler, Object)
 NAMESPACE_END(mitsuba)
 #endif
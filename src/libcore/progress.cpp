@@ -1,6 +1,7 @@
 #include <mitsuba/core/progress.h>
 #include <mitsuba/core/logger.h>
 #include <cmath>
+#include <thread>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -23,6 +24,7 @@ ProgressReporter::ProgressReporter(const std::string &label, void *payload)
 
     m_last_update = 0;
     m_last_progress = -1.f;
+    m_busy = false;
 }
 
 ProgressReporter::~ProgressReporter() { }
@@ -30,14 +32,29 @@ ProgressReporter::~ProgressReporter() { }
 void ProgressReporter::update(float progress) {
     progress = std::min(std::max(progress, 0.f), 1.f);
 
-    if (progress == m_last_progress)
+    float last_progress = m_last_progress.load(std::memory_order_relaxed);
+    if (progress == last_progress)
         return;
 
     size_t elapsed = m_timer.value();
-    if (progress != 1.f && (elapsed - m_last_update < 500 ||
-                            std::abs(progress - m_last_progress) < 0.01f))
+    if (progress != 1.f &&
+        (elapsed - m_last_update.load(std::memory_order_relaxed) < 500 ||
+         std::abs(progress - last_progress) < 0.01f))
         return; // Don't refresh too often
 
+    /* Only one thread at a time redraws the progress bar. Others simply skip
+       their update, except for the final one, which must not be lost. */
+    while (m_busy.exchange(true, std::memory_order_acquire)) {
+        if (progress != 1.f)
+            return;
+        std::this_thread::yield();
+    }
+
+    if (progress == m_last_progress.load(std::memory_order_relaxed)) {
+        m_busy.store(false, std::memory_order_release);
+        return;
+    }
+
     float remaining = elapsed / progress * (1 - progress);
     std::string eta = "(" + util::time_string(elapsed) + ", ETA: " + util::time_string(remaining) + ")";
     if (eta.length() > 22)
@@ -53,7 +70,9 @@ void ProgressReporter::update(float progress) {
 
     Thread::thread()->logger()->log_progress(progress, m_label, m_line,
                                              eta, m_payload);
-    m_last_update = elapsed;
+    m_last_update.store(elapsed, std::memory_order_relaxed);
+    m_last_progress.store(progress, std::memory_order_relaxed);
+    m_busy.store(false, std::memory_order_release);
 }
 
 MTS_IMPLEMENT_CLASS(ProgressReporter, Object)
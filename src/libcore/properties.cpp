@@ -3,10 +3,12 @@
 #  define _ENABLE_EXTENDED_ALIGNED_STORAGE
 #endif
 
+#include <algorithm>
 #include <cstdlib>
+#include <functional>
 #include <iostream>
-#include <map>
 #include <sstream>
+#include <vector>
 
 #include <mitsuba/core/logger.h>
 #include <mitsuba/core/properties.h>
@@ -63,8 +65,113 @@ struct SortKey {
     }
 };
 
+/**
+ * Flat storage of the entries of a \ref Properties instance. Names are
+ * hashed once on insertion, and lookups compare the precomputed hashes
+ * before comparing strings. Small property sets (e.g. those of most
+ * BSDFs or textures) are scanned linearly, larger ones (e.g. a scene with
+ * many children) additionally maintain an open addressing hash index.
+ * Iteration happens in the natural sort order of the names (see \ref
+ * SortKey), which determines the order of the children of a scene.
+ */
+struct EntryTable {
+    struct Item {
+        std::string first;
+        Entry second;
+        size_t hash;
+    };
+
+    /// Tables with more entries than this use the hash index
+    static constexpr size_t LinearLimit = 16;
+    static constexpr uint32_t Empty = (uint32_t) -1;
+
+    std::vector<Item> items;
+    std::vector<uint32_t> index;
+
+    static size_t hash_name(const std::string &name) {
+        return std::hash<std::string>()(name);
+    }
+
+    Item *find(const std::string &name) const {
+        size_t hash = hash_name(name);
+        Item *items_ptr = const_cast<Item *>(items.data());
+
+        if (index.empty()) {
+            for (size_t i = 0; i < items.size(); ++i) {
+                if (items_ptr[i].hash == hash && items_ptr[i].first == name)
+                    return items_ptr + i;
+            }
+        } else {
+            size_t mask = index.size() - 1;
+            for (size_t slot = hash & mask; index[slot] != Empty; slot = (slot + 1) & mask) {
+                Item &item = items_ptr[index[slot]];
+                if (item.hash == hash && item.first == name)
+                    return &item;
+            }
+        }
+
+        return nullptr;
+    }
+
+    /// Return the entry with the given name, creating it if needed
+    Entry &operator[](const std::string &name) {
+        if (Item *item = find(name))
+            return item->second;
+
+        items.push_back({ name, Entry(), hash_name(name) });
+        if (items.size() > LinearLimit) {
+            if (2 * items.size() > index.size())
+                rebuild_index();
+            else
+                insert_index((uint32_t) items.size() - 1);
+        }
+        return items.back().second;
+    }
+
+    bool erase(const std::string &name) {
+        Item *item = find(name);
+        if (!item)
+            return false;
+        items.erase(items.begin() + (item - items.data()));
+        index.clear();
+        if (items.size() > LinearLimit)
+            rebuild_index();
+        return true;
+    }
+
+    void insert_index(uint32_t i) {
+        size_t mask = index.size() - 1, slot = items[i].hash & mask;
+        while (index[slot] != Empty)
+            slot = (slot + 1) & mask;
+        index[slot] = i;
+    }
+
+    void rebuild_index() {
+        size_t size = 4 * LinearLimit;
+        while (size < 4 * items.size())
+            size *= 2;
+        index.assign(size, Empty);
+        for (size_t i = 0; i < items.size(); ++i)
+            insert_index((uint32_t) i);
+    }
+
+    size_t size() const { return items.size(); }
+
+    /// Return pointers to all entries in the natural sort order of their names
+    std::vector<Item *> sorted() const {
+        std::vector<Item *> result;
+        result.reserve(items.size());
+        for (const Item &item : items)
+            result.push_back(const_cast<Item *>(&item));
+        std::sort(result.begin(), result.end(), [](const Item *a, const Item *b) {
+            return SortKey()(a->first, b->first);
+        });
+        return result;
+    }
+};
+
 struct Properties::PropertiesPrivate {
-    std::map<std::string, Entry, SortKey> entries;
+    EntryTable entries;
     std::string id, plugin_name;
 };
 
@@ -72,13 +179,14 @@ struct Properties::PropertiesPrivate {
     void Properties::SetterName(const std::string &name, Type const &value, bool error_duplicates) { \
         if (has_property(name) && error_duplicates) \
             Log(Error, "Property \"%s\" was specified multiple times!", name); \
-        d->entries[name].data = (Type) value; \
-        d->entries[name].queried = false; \
+        Entry &entry = d->entries[name]; \
+        entry.data = (Type) value; \
+        entry.queried = false; \
     } \
     \
     Type const & Properties::GetterName(const std::string &name) const { \
         const auto it = d->entries.find(name); \
-        if (it == d->entries.end()) \
+        if (!it) \
             Throw("Property \"%s\" has not been specified!", name); \
         if (!it->second.data.is<Type>()) \
             Throw("The property \"%s\" has the wrong type (expected <" #TagName ">).", name); \
@@ -88,7 +196,7 @@ struct Properties::PropertiesPrivate {
     \
     Type const & Properties::GetterName(const std::string &name, Type const &def_val) const { \
         const auto it = d->entries.find(name); \
-        if (it == d->entries.end()) \
+        if (!it) \
             return def_val; \
         if (!it->second.data.is<Type>()) \
             Throw("The property \"%s\" has the wrong type (expected <" #TagName ">).", name); \
@@ -124,7 +232,7 @@ void Properties::operator=(const Properties &props) {
 }
 
 bool Properties::has_property(const std::string &name) const {
-    return d->entries.find(name) != d->entries.end();
+    return d->entries.find(name) != nullptr;
 }
 
 namespace {
@@ -162,7 +270,7 @@ namespace {
 
 Properties::Type Properties::type(const std::string &name) const {
     const auto it = d->entries.find(name);
-    if (it == d->entries.end())
+    if (!it)
         Throw("type(): Could not find property named \"%s\"!", name);
 
     return it->second.data.visit(PropertyTypeVisitor());
@@ -170,7 +278,7 @@ Properties::Type Properties::type(const std::string &name) const {
 
 bool Properties::mark_queried(const std::string &name) const {
     auto it = d->entries.find(name);
-    if (it == d->entries.end())
+    if (!it)
         return false;
     it->second.queried = true;
     return true;
@@ -178,17 +286,13 @@ bool Properties::mark_queried(const std::string &name) const {
 
 bool Properties::was_queried(const std::string &name) const {
     const auto it = d->entries.find(name);
-    if (it == d->entries.end())
+    if (!it)
         Throw("Could not find property named \"%s\"!", name);
     return it->second.queried;
 }
 
 bool Properties::remove_property(const std::string &name) {
-    const auto it = d->entries.find(name);
-    if (it == d->entries.end())
-        return false;
-    d->entries.erase(it);
-    return true;
+    return d->entries.erase(name);
 }
 
 const std::string &Properties::plugin_name() const {
@@ -211,28 +315,30 @@ void Properties::copy_attribute(const Properties &properties,
                                 const std::string &source_name,
                                 const std::string &target_name) {
     const auto it = properties.d->entries.find(source_name);
-    if (it == properties.d->entries.end())
+    if (!it)
         Throw("copy_attribute(): Could not find parameter \"%s\"!", source_name);
-    d->entries[target_name] = it->second;
+    Entry entry = it->second; // 'it' is invalidated when copying within 'this'
+    d->entries[target_name] = entry;
 }
 
 std::vector<std::string> Properties::property_names() const {
     std::vector<std::string> result;
-    for (const auto &e : d->entries)
-        result.push_back(e.first);
+    result.reserve(d->entries.size());
+    for (const auto *e : d->entries.sorted())
+        result.push_back(e->first);
     return result;
 }
 
 std::vector<std::pair<std::string, NamedReference>> Properties::named_references() const {
     std::vector<std::pair<std::string, NamedReference>> result;
     result.reserve(d->entries.size());
-    for (auto &e : d->entries) {
-        auto type = e.second.data.visit(PropertyTypeVisitor());
+    for (auto *e : d->entries.sorted()) {
+        auto type = e->second.data.visit(PropertyTypeVisitor());
         if (type != Type::NamedReference)
             continue;
-        auto const &value = (const NamedReference &) e.second.data;
-        result.push_back(std::make_pair(e.first, value));
-        e.second.queried = true;
+        auto const &value = (const NamedReference &) e->second.data;
+        result.push_back(std::make_pair(e->first, value));
+        e->second.queried = true;
     }
     return result;
 }
@@ -240,28 +346,28 @@ std::vector<std::pair<std::string, NamedReference>> Properties::named_references
 std::vector<std::pair<std::string, ref<Object>>> Properties::objects(bool mark_queried) const {
     std::vector<std::pair<std::string, ref<Object>>> result;
     result.reserve(d->entries.size());
-    for (auto &e : d->entries) {
-        auto type = e.second.data.visit(PropertyTypeVisitor());
+    for (auto *e : d->entries.sorted()) {
+        auto type = e->second.data.visit(PropertyTypeVisitor());
         if (type != Type::Object)
             continue;
-        result.push_back(std::make_pair(e.first, (const ref<Object> &) e.second));
+        result.push_back(std::make_pair(e->first, (const ref<Object> &) e->second));
         if (mark_queried)
-            e.second.queried = true;
+            e->second.queried = true;
     }
     return result;
 }
 
 std::vector<std::string> Properties::unqueried() const {
     std::vector<std::string> result;
-    for (const auto &e : d->entries) {
-        if (!e.second.queried)
-            result.push_back(e.first);
+    for (const auto *e : d->entries.sorted()) {
+        if (!e->second.queried)
+            result.push_back(e->first);
     }
     return result;
 }
 
 void Properties::merge(const Properties &p) {
-    for (const auto &e : p.d->entries)
+    for (const auto &e : p.d->entries.items)
         d->entries[e.first] = e.second;
 }
 
@@ -271,9 +377,9 @@ bool Properties::operator==(const Properties &p) const {
         d->entries.size() != p.d->entries.size())
         return false;
 
-    for (const auto &e : d->entries) {
+    for (const auto &e : d->entries.items) {
         auto it = p.d->entries.find(e.first);
-        if (it == p.d->entries.end())
+        if (!it)
             return false;
         if (e.second.data != it->second.data)
             return false;
@@ -283,46 +389,35 @@ bool Properties::operator==(const Properties &p) const {
 }
 
 std::string Properties::as_string(const std::string &name) const {
+    const auto it = d->entries.find(name);
+    if (!it)
+        Throw("Property \"%s\" has not been specified!", name);
     std::ostringstream oss;
-    bool found = false;
-    for (auto &e : d->entries) {
-        if (e.first != name)
-            continue;
-        e.second.data.visit(StreamVisitor(oss));
-        found = true;
-        break;
-    }
-    if (!found)
-        Throw("Property \"%s\" has not been specified!", name); \
+    it->second.data.visit(StreamVisitor(oss));
     return oss.str();
 }
 
 std::string Properties::as_string(const std::string &name, const std::string &def_val) const {
-    std::ostringstream oss;
-    bool found = false;
-    for (auto &e : d->entries) {
-        if (e.first != name)
-            continue;
-        e.second.data.visit(StreamVisitor(oss));
-        found = true;
-        break;
-    }
-    if (!found)
+    const auto it = d->entries.find(name);
+    if (!it)
         return def_val;
+    std::ostringstream oss;
+    it->second.data.visit(StreamVisitor(oss));
     return oss.str();
 }
 
 std::ostream &operator<<(std::ostream &os, const Properties &p) {
-    auto it = p.d->entries.begin();
+    auto entries = p.d->entries.sorted();
+    auto it = entries.begin();
 
     os << "Properties[" << std::endl
        << "  plugin_name = \"" << (p.d->plugin_name) << "\"," << std::endl
        << "  id = \"" << p.d->id << "\"," << std::endl
        << "  elements = {" << std::endl;
-    while (it != p.d->entries.end()) {
-        os << "    \"" << it->first << "\" -> ";
-        it->second.data.visit(StreamVisitor(os));
-        if (++it != p.d->entries.end()) os << ",";
+    while (it != entries.end()) {
+        os << "    \"" << (*it)->first << "\" -> ";
+        (*it)->second.data.visit(StreamVisitor(os));
+        if (++it != entries.end()) os << ",";
         os << std::endl;
     }
     os << "  }" << std::endl
@@ -338,7 +433,7 @@ std::ostream &operator<<(std::ostream &os, const Properties &p) {
 // size_t getter
 size_t Properties::size_(const std::string &name) const {
     const auto it = d->entries.find(name);
-    if (it == d->entries.end())
+    if (!it)
         Throw("Property \"%s\" has not been specified!", name);
     if (!it->second.data.is<int64_t>())
         Throw("The property \"%s\" has the wrong type (expected <integer>).", name);
@@ -354,7 +449,7 @@ size_t Properties::size_(const std::string &name) const {
 // size_t getter (with default value)
 size_t Properties::size_(const std::string &name, const size_t &def_val) const {
     const auto it = d->entries.find(name);
-    if (it == d->entries.end())
+    if (!it)
         return def_val;
 
     auto v = (int64_t) it->second.data;
@@ -370,14 +465,15 @@ size_t Properties::size_(const std::string &name, const size_t &def_val) const {
 void Properties::set_float(const std::string &name, const Float &value, bool error_duplicates) {
     if (has_property(name) && error_duplicates)
         Log(Error, "Property \"%s\" was specified multiple times!", name);
-    d->entries[name].data = (Float) value;
-    d->entries[name].queried = false;
+    Entry &entry = d->entries[name];
+    entry.data = (Float) value;
+    entry.queried = false;
 }
 
 /// Float getter (without default)
 Float Properties::float_(const std::string &name) const {
     const auto it = d->entries.find(name);
-    if (it == d->entries.end())
+    if (!it)
         Throw("Property \"%s\" has not been specified!", name);
     if (!(it->second.data.is<Float>() || it->second.data.is<int64_t>()))
         Throw("The property \"%s\" has the wrong type (expected <float>).", name);
@@ -390,7 +486,7 @@ Float Properties::float_(const std::string &name) const {
 /// Float getter (with default)
 Float Properties::float_(const std::string &name, const Float &def_val) const {
     const auto it = d->entries.find(name);
-    if (it == d->entries.end())
+    if (!it)
         return def_val;
     if (!(it->second.data.is<Float>() || it->second.data.is<int64_t>()))
         Throw("The property \"%s\" has the wrong type (expected <float>).", name);
@@ -404,14 +500,15 @@ Float Properties::float_(const std::string &name, const Float &def_val) const {
 void Properties::set_array3f(const std::string &name, const Array3f &value, bool error_duplicates) {
     if (has_property(name) && error_duplicates)
         Log(Error, "Property \"%s\" was specified multiple times!", name);
-    d->entries[name].data = (Array3f) value;
-    d->entries[name].queried = false;
+    Entry &entry = d->entries[name];
+    entry.data = (Array3f) value;
+    entry.queried = false;
 }
 
 /// Array3f getter (without default)
 Array3f Properties::array3f(const std::string &name) const {
     const auto it = d->entries.find(name);
-    if (it == d->entries.end())
+    if (!it)
         Throw("Property \"%s\" has not been specified!", name);
     if (!it->second.data.is<Array3f>())
         Throw("The property \"%s\" has the wrong type (expected <vector> or <point>).", name);
@@ -422,7 +519,7 @@ Array3f Properties::array3f(const std::string &name) const {
 /// Array3f getter (with default)
 Array3f Properties::array3f(const std::string &name, const Array3f &def_val) const {
     const auto it = d->entries.find(name);
-    if (it == d->entries.end())
+    if (!it)
         return def_val;
     if (!it->second.data.is<Array3f>())
         Throw("The property \"%s\" has the wrong type (expected <vector> or <point>).", name);
@@ -436,8 +533,9 @@ void Properties::set_animated_transform(const std::string &name,
                                         bool error_duplicates) {
     if (has_property(name) && error_duplicates)
         Log(Error, "Property \"%s\" was specified multiple times!", name);
-    d->entries[name].data = ref<Object>(value.get());
-    d->entries[name].queried = false;
+    Entry &entry = d->entries[name];
+    entry.data = ref<Object>(value.get());
+    entry.queried = false;
 }
 
 /// AnimatedTransform setter (from a simple Transform).
@@ -451,7 +549,7 @@ void Properties::set_animated_transform(const std::string &name,
 /// AnimatedTransform getter (without default value).
 ref<AnimatedTransform> Properties::animated_transform(const std::string &name) const {
     const auto it = d->entries.find(name);
-    if (it == d->entries.end())
+    if (!it)
         Throw("Property \"%s\" has not been specified!", name);
     if (it->second.data.is<Transform4f>()) {
         // Also accept simple transforms, from which we can build
@@ -476,7 +574,7 @@ ref<AnimatedTransform> Properties::animated_transform(const std::string &name) c
 ref<AnimatedTransform> Properties::animated_transform(
         const std::string &name, ref<AnimatedTransform> def_val) const {
     const auto it = d->entries.find(name);
-    if (it == d->entries.end())
+    if (!it)
         return def_val;
     if (it->second.data.is<Transform4f>()) {
         // Also accept simple transforms, from which we can build
@@ -505,7 +603,7 @@ ref<AnimatedTransform> Properties::animated_transform(
 
 ref<Object> Properties::find_object(const std::string &name) const {
     const auto it = d->entries.find(name);
-    if (it == d->entries.end())
+    if (!it)
         return ref<Object>();
 
     if (!it->second.data.is<ref<Object>>())
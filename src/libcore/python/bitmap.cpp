@@ -30,6 +30,7 @@ MTS_PY_EXPORT(Bitmap) {
         .value("JPEG",    Bitmap::FileFormat::JPEG,    D(Bitmap, FileFormat, JPEG))
         .value("TGA",     Bitmap::FileFormat::TGA,     D(Bitmap, FileFormat, TGA))
         .value("BMP",     Bitmap::FileFormat::BMP,     D(Bitmap, FileFormat, BMP))
+        .value("Tensor",  Bitmap::FileFormat::Tensor,  D(Bitmap, FileFormat, Tensor))
         .value("Unknown", Bitmap::FileFormat::Unknown, D(Bitmap, FileFormat, Unknown))
         .value("Auto",    Bitmap::FileFormat::Auto,    D(Bitmap, FileFormat, Auto));
 
@@ -41,6 +42,16 @@ MTS_PY_EXPORT(Bitmap) {
         .value("Unpremultiply", Bitmap::AlphaTransform::Unpremultiply,
                 D(Bitmap, AlphaTransform, Unpremultiply));
 
+    py::enum_<Bitmap::EXRCompression>(bitmap, "EXRCompression", D(Bitmap, EXRCompression))
+        .value("Default", Bitmap::EXRCompression::Default, D(Bitmap, EXRCompression, Default))
+        .value("None",    Bitmap::EXRCompression::None,    D(Bitmap, EXRCompression, None))
+        .value("RLE",     Bitmap::EXRCompression::RLE,     D(Bitmap, EXRCompression, RLE))
+        .value("ZIPS",    Bitmap::EXRCompression::ZIPS,    D(Bitmap, EXRCompression, ZIPS))
+        .value("ZIP",     Bitmap::EXRCompression::ZIP,     D(Bitmap, EXRCompression, ZIP))
+        .value("PIZ",     Bitmap::EXRCompression::PIZ,     D(Bitmap, EXRCompression, PIZ))
+        .value("DWAA",    Bitmap::EXRCompression::DWAA,    D(Bitmap, EXRCompression, DWAA))
+        .value("DWAB",    Bitmap::EXRCompression::DWAB,    D(Bitmap, EXRCompression, DWAB));
+
     bitmap.def(py::init<Bitmap::PixelFormat, Struct::Type, const Vector2u &, size_t>(),
             "pixel_format"_a, "component_format"_a, "size"_a, "channel_count"_a = 0,
             D(Bitmap, Bitmap))
@@ -83,6 +94,7 @@ MTS_PY_EXPORT(Bitmap) {
         .def_method(Bitmap, has_alpha)
         .def_method(Bitmap, bytes_per_pixel)
         .def_method(Bitmap, buffer_size)
+        .def_method(Bitmap, memory_mapped)
         .def_method(Bitmap, srgb_gamma)
         .def_method(Bitmap, set_srgb_gamma)
         .def_method(Bitmap, premultiplied_alpha)
@@ -152,19 +164,22 @@ MTS_PY_EXPORT(Bitmap) {
             "format"_a = Bitmap::FileFormat::Auto,
             py::call_guard<py::gil_scoped_release>())
         .def("write",
-            py::overload_cast<Stream *, Bitmap::FileFormat, int>(
+            py::overload_cast<Stream *, Bitmap::FileFormat, int, Bitmap::EXRCompression>(
                 &Bitmap::write, py::const_),
             "stream"_a, "format"_a = Bitmap::FileFormat::Auto, "quality"_a = -1,
+            "compression"_a = Bitmap::EXRCompression::Default,
             D(Bitmap, write), py::call_guard<py::gil_scoped_release>())
         .def("write",
-            py::overload_cast<const fs::path &, Bitmap::FileFormat, int>(
+            py::overload_cast<const fs::path &, Bitmap::FileFormat, int, Bitmap::EXRCompression>(
                 &Bitmap::write, py::const_),
             "path"_a, "format"_a = Bitmap::FileFormat::Auto, "quality"_a = -1,
+            "compression"_a = Bitmap::EXRCompression::Default,
             D(Bitmap, write, 2), py::call_guard<py::gil_scoped_release>())
         .def("write_async",
-            py::overload_cast<const fs::path &, Bitmap::FileFormat, int>(
+            py::overload_cast<const fs::path &, Bitmap::FileFormat, int, Bitmap::EXRCompression>(
                 &Bitmap::write_async, py::const_),
             "path"_a, "format"_a = Bitmap::FileFormat::Auto, "quality"_a = -1,
+            "compression"_a = Bitmap::EXRCompression::Default,
             D(Bitmap, write_async))
         .def("split", &Bitmap::split, D(Bitmap, split))
         .def_static("detect_file_format", &Bitmap::detect_file_format, D(Bitmap, detect_file_format))
@@ -28,6 +28,8 @@ MTS_PY_EXPORT(DiscreteDistribution) {
         .def("eval_cdf_normalized", vectorize(&DiscreteDistribution::eval_cdf_normalized),
              "index"_a, "active"_a = true, D(DiscreteDistribution, eval_cdf_normalized))
         .def_method(DiscreteDistribution, update)
+        .def_method(DiscreteDistribution, set_alias_table, "value"_a)
+        .def_method(DiscreteDistribution, has_alias_table)
         .def_method(DiscreteDistribution, sum)
         .def_method(DiscreteDistribution, normalization)
         .def("sample",
@@ -114,6 +116,8 @@ MTS_PY_EXPORT(IrregularContinuousDistribution) {
         .def("eval_cdf_normalized", vectorize(&IrregularContinuousDistribution::eval_cdf_normalized),
              "x"_a, "active"_a = true, D(IrregularContinuousDistribution, eval_cdf_normalized))
         .def_method(IrregularContinuousDistribution, update)
+        .def_method(IrregularContinuousDistribution, set_alias_table, "value"_a)
+        .def_method(IrregularContinuousDistribution, has_alias_table)
         .def_method(IrregularContinuousDistribution, integral)
         .def_method(IrregularContinuousDistribution, normalization)
         .def("sample",
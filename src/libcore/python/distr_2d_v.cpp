@@ -122,6 +122,10 @@ MTS_PY_EXPORT(Marginal2D) {
     bind_warp_marginal<Marginal2D<Float, 1, true>>(m, "MarginalContinuous2D1");
     bind_warp_marginal<Marginal2D<Float, 2, true>>(m, "MarginalContinuous2D2");
     bind_warp_marginal<Marginal2D<Float, 3, true>>(m, "MarginalContinuous2D3");
+
+    // Half precision variants (evaluation only, require enable_sampling=False)
+    bind_warp_marginal<Marginal2D<Float, 0, true, enoki::half>>(m, "MarginalContinuous2D0Half");
+    bind_warp_marginal<Marginal2D<Float, 3, true, enoki::half>>(m, "MarginalContinuous2D3Half");
 }
 
 MTS_PY_EXPORT(DiscreteDistribution2D) {
@@ -26,5 +26,8 @@ MTS_PY_EXPORT(FileResolver) {
         .def_method(FileResolver, resolve)
         .def_method(FileResolver, clear)
         .def_method(FileResolver, prepend)
-        .def_method(FileResolver, append);
+        .def_method(FileResolver, append)
+        .def_method(FileResolver, set_cache_enabled, "value"_a)
+        .def_method(FileResolver, cache_enabled)
+        .def_method(FileResolver, clear_cache);
 }
@@ -0,0 +1,32 @@
+#include <mitsuba/core/loadtrace.h>
+#include <mitsuba/python/python.h>
+
+MTS_PY_EXPORT(LoadTrace) {
+    py::class_<LoadRecord>(m, "LoadRecord", D(LoadRecord))
+        .def_readonly("id", &LoadRecord::id, D(LoadRecord, id))
+        .def_readonly("plugin", &LoadRecord::plugin, D(LoadRecord, plugin))
+        .def_readonly("class_name", &LoadRecord::class_name, D(LoadRecord, class_name))
+        .def_readonly("filename", &LoadRecord::filename, D(LoadRecord, filename))
+        .def_readonly("thread", &LoadRecord::thread, D(LoadRecord, thread))
+        .def_readonly("references", &LoadRecord::references, D(LoadRecord, references))
+        .def_readonly("load", &LoadRecord::load, D(LoadRecord, load))
+        .def_readonly("start", &LoadRecord::start, D(LoadRecord, start))
+        .def_readonly("time", &LoadRecord::time, D(LoadRecord, time))
+        .def_readonly("prefetch_time", &LoadRecord::prefetch_time, D(LoadRecord, prefetch_time))
+        .def_readonly("bytes_read", &LoadRecord::bytes_read, D(LoadRecord, bytes_read))
+        .def_readonly("decoded_bytes", &LoadRecord::decoded_bytes, D(LoadRecord, decoded_bytes))
+        .def_method(LoadRecord, end)
+        .def("__repr__", [](const LoadRecord &r) {
+            return tfm::format("LoadRecord[id=\"%s\", plugin=\"%s\", time=%f]",
+                               r.id, r.plugin, r.time);
+        });
+
+    MTS_PY_CLASS(LoadTrace, Object)
+        .def_static_method(LoadTrace, set_enabled, "value"_a)
+        .def_static_method(LoadTrace, enabled)
+        .def_static_method(LoadTrace, records)
+        .def_static_method(LoadTrace, critical_path)
+        .def_static_method(LoadTrace, clear)
+        .def_static_method(LoadTrace, print_report, "count"_a = 20)
+        .def_static_method(LoadTrace, write_json, "filename"_a);
+}
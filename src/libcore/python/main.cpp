@@ -17,15 +17,20 @@ MTS_PY_DECLARE(ArgParser);
 MTS_PY_DECLARE(Bitmap);
 MTS_PY_DECLARE(Formatter);
 MTS_PY_DECLARE(FileResolver);
+MTS_PY_DECLARE(LoadTrace);
 MTS_PY_DECLARE(Logger);
 MTS_PY_DECLARE(MemoryMappedFile);
+MTS_PY_DECLARE(MemoryReport);
 MTS_PY_DECLARE(Stream);
 MTS_PY_DECLARE(DummyStream);
 MTS_PY_DECLARE(FileStream);
 MTS_PY_DECLARE(MemoryStream);
 MTS_PY_DECLARE(ZStream);
+MTS_PY_DECLARE(BufferedStream);
 MTS_PY_DECLARE(ProgressReporter);
+MTS_PY_DECLARE(ResourceCache);
 MTS_PY_DECLARE(rfilter);
+MTS_PY_DECLARE(TextureCache);
 MTS_PY_DECLARE(Thread);
 MTS_PY_DECLARE(util);
 
@@ -111,13 +116,18 @@ PYBIND11_MODULE(core_ext, m) {
     MTS_PY_IMPORT(Bitmap);
     MTS_PY_IMPORT(Formatter);
     MTS_PY_IMPORT(FileResolver);
+    MTS_PY_IMPORT(LoadTrace);
     MTS_PY_IMPORT(Logger);
     MTS_PY_IMPORT(MemoryMappedFile);
+    MTS_PY_IMPORT(MemoryReport);
     MTS_PY_IMPORT(DummyStream);
     MTS_PY_IMPORT(FileStream);
     MTS_PY_IMPORT(MemoryStream);
     MTS_PY_IMPORT(ZStream);
+    MTS_PY_IMPORT(BufferedStream);
     MTS_PY_IMPORT(ProgressReporter);
+    MTS_PY_IMPORT(ResourceCache);
+    MTS_PY_IMPORT(TextureCache);
     MTS_PY_IMPORT(Thread);
     MTS_PY_IMPORT(util);
 
@@ -0,0 +1,23 @@
+#include <mitsuba/core/memreport.h>
+#include <mitsuba/python/python.h>
+
+MTS_PY_EXPORT(MemoryReport) {
+    py::enum_<MemoryCategory>(m, "MemoryCategory", D(MemoryCategory))
+        .value("Geometry", MemoryCategory::Geometry, D(MemoryCategory, Geometry))
+        .value("Acceleration", MemoryCategory::Acceleration, D(MemoryCategory, Acceleration))
+        .value("Textures", MemoryCategory::Textures, D(MemoryCategory, Textures))
+        .value("Volumes", MemoryCategory::Volumes, D(MemoryCategory, Volumes))
+        .value("Distributions", MemoryCategory::Distributions, D(MemoryCategory, Distributions))
+        .value("Film", MemoryCategory::Film, D(MemoryCategory, Film))
+        .value("Other", MemoryCategory::Other, D(MemoryCategory, Other));
+
+    MTS_PY_CLASS(MemoryReport, Object)
+        .def(py::init<>(), D(MemoryReport, MemoryReport))
+        .def_method(MemoryReport, visit, "object"_a)
+        .def_method(MemoryReport, add, "category"_a, "size"_a, "device"_a = false)
+        .def_method(MemoryReport, host, "category"_a)
+        .def_method(MemoryReport, device, "category"_a)
+        .def_method(MemoryReport, total_host)
+        .def_method(MemoryReport, total_device)
+        .def_method(MemoryReport, object_count);
+}
@@ -1,4 +1,5 @@
 #include <mitsuba/core/logger.h>
+#include <mitsuba/core/memreport.h>
 #include <mitsuba/core/plugin.h>
 #include <mitsuba/python/python.h>
 
@@ -45,7 +46,9 @@ MTS_PY_EXPORT(Object) {
             } catch(std::runtime_error &e){
                 return static_cast<const Class *>(nullptr);
             }
-        }, "name"_a, "variant"_a, py::return_value_policy::reference, D(PluginManager, get_plugin_class));
+        }, "name"_a, "variant"_a, py::return_value_policy::reference, D(PluginManager, get_plugin_class))
+        .def_method(PluginManager, preload_plugins, "names"_a)
+        .def_method(PluginManager, loaded_plugins);
 
     py::class_<TraversalCallback, PyTraversalCallback>(m, "TraversalCallback")
         .def(py::init<>());
@@ -66,6 +69,7 @@ MTS_PY_EXPORT(Object) {
         }, D(Object, expand))
         .def_method(Object, traverse, "cb"_a)
         .def_method(Object, parameters_changed, "keys"_a = py::list())
+        .def_method(Object, account_memory, "report"_a)
         .def_property_readonly("ptr", [](Object *self) { return (uintptr_t) self; })
         .def("class_", &Object::class_, py::return_value_policy::reference, D(Object, class))
         .def("__repr__", &Object::to_string, D(Object, to_string));
@@ -9,6 +9,7 @@
 #define SET_ATTR(T)                                                                                \
     if (strcmp(type.name(), typeid(T).name()) == 0) {                                              \
         *((T *) ptr) = py::cast<T>(handle);                                                        \
+        evaluate();                                                                                \
         return;                                                                                    \
     }
 
@@ -72,6 +73,18 @@ MTS_PY_EXPORT(Object) {
 
     m.def("set_property", [](const void *ptr, void *type_, py::handle handle) {
         const std::type_info &type = *(const std::type_info *) type_;
+
+        /* Store new values in device memory, where kernels access them as
+           inputs. Values that were still unevaluated expressions or literals
+           would otherwise be compiled into the kernels, requiring a new
+           compilation following every update in an optimization loop. */
+        auto evaluate = []() {
+#if defined(MTS_ENABLE_OPTIX)
+            if constexpr (is_cuda_array_v<Float>)
+                cuda_eval();
+#endif
+        };
+
         SET_ATTR(Float);
         SET_ATTR(Int32);
         SET_ATTR(UInt32);
@@ -0,0 +1,11 @@
+#include <mitsuba/core/rescache.h>
+#include <mitsuba/python/python.h>
+
+MTS_PY_EXPORT(ResourceCache) {
+    MTS_PY_CLASS(ResourceCache, Object)
+        .def_static("instance", &ResourceCache::instance, py::return_value_policy::reference,
+                    D(ResourceCache, instance))
+        .def_static("file_key", &ResourceCache::file_key, "path"_a, D(ResourceCache, file_key))
+        .def_method(ResourceCache, size)
+        .def_method(ResourceCache, clear);
+}
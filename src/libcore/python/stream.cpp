@@ -1,4 +1,5 @@
 #include <mitsuba/core/stream.h>
+#include <mitsuba/core/bstream.h>
 #include <mitsuba/core/dstream.h>
 #include <mitsuba/core/fstream.h>
 #include <mitsuba/core/mstream.h>
@@ -106,11 +107,23 @@ MTS_PY_EXPORT(ZStream) {
         .export_values();
 
 
-    c.def(py::init<Stream*, ZStream::EStreamType, int>(), D(ZStream, ZStream),
+    c.def(py::init<Stream*, ZStream::EStreamType, int, size_t>(), D(ZStream, ZStream),
         "child_stream"_a,
         "stream_type"_a = ZStream::EDeflateStream,
-        "level"_a = -1)
+        "level"_a = -1,
+        "parallel_block_size"_a = 0)
         .def("child_stream", [](ZStream &stream) {
             return py::cast(stream.child_stream());
-        }, D(ZStream, child_stream));
+        }, D(ZStream, child_stream))
+        .def_method(ZStream, parallel_block_size);
+}
+
+MTS_PY_EXPORT(BufferedStream) {
+    MTS_PY_CLASS(BufferedStream, Stream)
+        .def(py::init<Stream*, size_t>(), D(BufferedStream, BufferedStream),
+            "child_stream"_a, "buffer_size"_a = detail::kBufferedStreamDefaultSize)
+        .def("child_stream", [](BufferedStream &stream) {
+            return py::cast(stream.child_stream());
+        }, D(BufferedStream, child_stream))
+        .def_method(BufferedStream, buffer_size);
 }
@@ -0,0 +1,22 @@
+#include <mitsuba/core/texcache.h>
+#include <mitsuba/python/python.h>
+
+MTS_PY_EXPORT(TextureCache) {
+    MTS_PY_CLASS(TiledTexture, Object)
+        .def_method(TiledTexture, channel_count)
+        .def_method(TiledTexture, level_count)
+        .def_method(TiledTexture, tile_size)
+        .def_method(TiledTexture, width, "level"_a = 0)
+        .def_method(TiledTexture, height, "level"_a = 0)
+        .def_method(TiledTexture, mean)
+        .def_method(TiledTexture, filename);
+
+    MTS_PY_CLASS(TextureCache, Object)
+        .def_static("instance", &TextureCache::instance, py::return_value_policy::reference,
+                    D(TextureCache, instance))
+        .def_method(TextureCache, open, "filename"_a, "key"_a)
+        .def_method(TextureCache, set_max_memory, "size"_a)
+        .def_method(TextureCache, max_memory)
+        .def_method(TextureCache, memory_usage)
+        .def_method(TextureCache, clear);
+}
@@ -84,6 +84,9 @@ MTS_PY_EXPORT(Thread) {
        .def_method(Thread, priority)
        .def_method(Thread, set_core_affinity)
        .def_method(Thread, core_affinity)
+       .def_method(Thread, set_numa_node)
+       .def_method(Thread, numa_node)
+       .def_static_method(Thread, numa_nodes)
        .def_method(Thread, set_critical)
        .def_method(Thread, is_critical)
        .def_method(Thread, set_name)
@@ -10,9 +10,12 @@
 using Caster = py::object(*)(mitsuba::Object *);
 extern Caster cast_object;
 
+using ObjectList = std::vector<std::pair<std::string, Properties>>;
+
 // Forward declaration
 template <typename Float, typename Spectrum>
-ref<Object> load_dict(const py::dict& dict, std::map<std::string, ref<Object>> &instances);
+std::string parse_dict(const py::dict &dict, const std::string &id, ObjectList &objects,
+                       std::map<std::string, std::string> &instances);
 
 /// Shorthand notation for accessing the MTS_VARIANT string
 #define GET_VARIANT() mitsuba::detail::get_variant<Float, Spectrum>()
@@ -22,7 +25,8 @@ MTS_PY_EXPORT(xml) {
 
     m.def(
         "load_file",
-        [](const std::string &name, bool update_scene, py::kwargs kwargs) {
+        [](const std::string &name, bool update_scene,
+           const std::string &cache_dir, py::kwargs kwargs) {
             xml::ParameterList param;
             if (kwargs) {
                 for (auto [k, v] : kwargs)
@@ -32,9 +36,10 @@ MTS_PY_EXPORT(xml) {
                     );
             }
             py::gil_scoped_release release;
-            return cast_object(xml::load_file(name, GET_VARIANT(), param, update_scene));
+            return cast_object(xml::load_file(name, GET_VARIANT(), param,
+                                              update_scene, cache_dir));
         },
-        "path"_a, "update_scene"_a = false, D(xml, load_file));
+        "path"_a, "update_scene"_a = false, "cache_dir"_a = "", D(xml, load_file));
 
     m.def(
         "load_string",
@@ -55,12 +60,27 @@ MTS_PY_EXPORT(xml) {
     m.def(
         "load_dict",
         [](const py::dict dict) {
-            std::map<std::string, ref<Object>> instances;
-            return cast_object(load_dict<Float, Spectrum>(dict, instances));
+            /* Convert the dictionary into properties while holding the GIL,
+               the objects are then created by the (parallel) instantiation
+               stage of the XML loader */
+            ObjectList objects;
+            std::map<std::string, std::string> instances;
+            std::string root = parse_dict<Float, Spectrum>(dict, "<root>", objects, instances);
+
+            ref<Object> obj;
+            {
+                py::gil_scoped_release release;
+                obj = xml::load_properties(std::move(objects), root, GET_VARIANT(), "<dict>");
+            }
+            return cast_object(obj);
         },
         "dict"_a,
 R"doc(Load a Mitsuba scene or object from an Python dictionary
 
+Like :py:func:`load_file`, independent objects (e.g. meshes and textures)
+are created in parallel, and the GIL is released while they are being
+constructed.
+
 Parameter ``dict``:
     Python dictionary containing the object description
 
@@ -96,8 +116,15 @@ void expand_and_set_object(Properties &props, const std::string &name, const ref
     }
 }
 
+/**
+ * Convert a (nested) dictionary into the properties of the objects it
+ * describes, which are appended to \c objects. Nested dictionaries become
+ * separate objects that are referenced by their path. Returns the identifier
+ * of the object described by \c dict.
+ */
 template <typename Float, typename Spectrum>
-ref<Object> load_dict(const py::dict &dict, std::map<std::string, ref<Object>> &instances) {
+std::string parse_dict(const py::dict &dict, const std::string &id, ObjectList &objects,
+                       std::map<std::string, std::string> &instances) {
 
     MTS_IMPORT_CORE_TYPES()
     using ScalarArray3f = Array<ScalarFloat, 3>;
@@ -210,11 +237,11 @@ ref<Object> load_dict(const py::dict &dict, std::map<std::string, ref<Object>> &
                 for (auto& [k2, value2] : value.template cast<py::dict>()) {
                     std::string key2 = k2.template cast<std::string>();
                     if (key2 == "id") {
-                        std::string id = value2.template cast<std::string>();
-                        if (instances.count(id) == 1)
-                            expand_and_set_object(props, key, instances[id]);
+                        std::string ref_id = value2.template cast<std::string>();
+                        if (instances.count(ref_id) == 1)
+                            props.set_named_reference(key, instances[ref_id]);
                         else
-                            Throw("Referenced id \"%s\" not found: %s", id, key);
+                            Throw("Referenced id \"%s\" not found: %s", ref_id, key);
                     }  else if (key2 != "type") {
                         Throw("Unexpected key in ref dictionary: %s", key2);
                     }
@@ -222,23 +249,25 @@ ref<Object> load_dict(const py::dict &dict, std::map<std::string, ref<Object>> &
                 continue;
             }
 
-            // Load the dictionary recursively
-            ref<Object> obj = load_dict<Float, Spectrum>(dict2, instances);
-            expand_and_set_object(props, key, obj);
+            // Parse the dictionary recursively, the scene's objects are named by their keys
+            std::string child = parse_dict<Float, Spectrum>(
+                dict2, is_scene ? key : id + "." + key, objects, instances);
+            props.set_named_reference(key, child);
 
-            // Add instanced object to the instance map for later references
+            // Add the object to the instance map for later references
             if (is_scene) {
                 // An object can be referenced using its key
                 if (instances.count(key) != 0)
                     Throw("%s has duplicate id: %s", key, key);
-                instances[key] = obj;
+                instances[key] = child;
 
                 // An object can also be referenced using its "id" if it has one
-                std::string id = obj->id();
-                if (!id.empty() && id != key) {
-                    if (instances.count(id) != 0)
-                        Throw("%s has duplicate id: %s", key, id);
-                    instances[id] = obj;
+                const Properties &child_props = objects.back().second;
+                std::string child_id = child_props.id();
+                if (!child_id.empty() && child_id != key) {
+                    if (instances.count(child_id) != 0)
+                        Throw("%s has duplicate id: %s", key, child_id);
+                    instances[child_id] = child;
                 }
             }
 
@@ -262,13 +291,8 @@ ref<Object> load_dict(const py::dict &dict, std::map<std::string, ref<Object>> &
         Throw("Unkown value type: %s", value.get_type());
     }
 
-    // Construct the object with the parsed Properties
-    auto obj = PluginManager::instance()->create_object(props, class_);
-
-    if (!props.unqueried().empty())
-        Throw("Unreferenced attribute %s in %s", props.unqueried()[0], type);
-
-    return obj;
+    objects.emplace_back(id, std::move(props));
+    return id;
 }
 
 #undef SET_PROPS
@@ -0,0 +1,99 @@
+#include <mitsuba/core/rescache.h>
+#include <mitsuba/core/logger.h>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+
+NAMESPACE_BEGIN(mitsuba)
+
+struct ResourceCache::ResourceCachePrivate {
+    /// An entry is created before its resource, which is guarded by 'mutex'
+    struct Entry {
+        std::mutex mutex;
+        ref<Object> object;
+    };
+
+    mutable std::mutex mutex;
+    mutable std::unordered_map<std::string, std::shared_ptr<Entry>> entries;
+    size_t lookups = 0;
+    size_t loads = 0;
+};
+
+ResourceCache::ResourceCache() : d(new ResourceCachePrivate()) { }
+
+ResourceCache::~ResourceCache() { }
+
+std::string ResourceCache::file_key(const fs::path &path) {
+    return tfm::format("%s|%i|%i", fs::absolute(path), fs::file_size(path),
+                       fs::last_write_time(path));
+}
+
+ref<Object> ResourceCache::get(const std::string &key,
+                               const std::function<ref<Object>()> &create) {
+    std::shared_ptr<ResourceCachePrivate::Entry> entry;
+    {
+        std::lock_guard<std::mutex> guard(d->mutex);
+        d->lookups++;
+        auto it = d->entries.find(key);
+        if (it == d->entries.end()) {
+            prune();
+            it = d->entries.emplace(key, std::make_shared<ResourceCachePrivate::Entry>()).first;
+        }
+        entry = it->second;
+    }
+
+    // The resource is created outside of the global lock
+    std::lock_guard<std::mutex> guard(entry->mutex);
+    if (!entry->object) {
+        entry->object = create();
+        std::lock_guard<std::mutex> guard2(d->mutex);
+        d->loads++;
+    } else {
+        Log(Debug, "Sharing the cached resource \"%s\"", key);
+    }
+
+    return entry->object;
+}
+
+void ResourceCache::prune() const {
+    for (auto it = d->entries.begin(); it != d->entries.end();) {
+        /* Entries whose resource is being created are in use, others
+           are released once the cache holds the only reference */
+        const auto &entry = it->second;
+        std::unique_lock<std::mutex> guard(entry->mutex, std::try_to_lock);
+        if (guard.owns_lock() && (!entry->object || entry->object->ref_count() == 1) &&
+            entry.use_count() == 1) {
+            guard.unlock();
+            it = d->entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+size_t ResourceCache::size() const {
+    std::lock_guard<std::mutex> guard(d->mutex);
+    prune();
+    return d->entries.size();
+}
+
+void ResourceCache::clear() {
+    std::lock_guard<std::mutex> guard(d->mutex);
+    d->entries.clear();
+}
+
+std::string ResourceCache::to_string() const {
+    std::lock_guard<std::mutex> guard(d->mutex);
+    std::ostringstream oss;
+    oss << "ResourceCache[" << std::endl
+        << "  resources = " << d->entries.size() << "," << std::endl
+        << "  lookups = " << d->lookups << "," << std::endl
+        << "  loads = " << d->loads << std::endl
+        << "]";
+    return oss.str();
+}
+
+ref<ResourceCache> ResourceCache::m_instance = new ResourceCache();
+
+MTS_IMPLEMENT_CLASS(ResourceCache, Object)
+NAMESPACE_END(mitsuba)
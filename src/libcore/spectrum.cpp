@@ -107,7 +107,7 @@ spectrum_to_rgb(const std::vector<double> &wavelengths,
 // =======================================================================
 using Float = float;
 
-static const Float cie1931_tbl[MTS_CIE_SAMPLES * 3] = {
+static constexpr Float cie1931_tbl[MTS_CIE_SAMPLES * 3] = {
     Float(0.000129900000), Float(0.000232100000), Float(0.000414900000), Float(0.000741600000),
     Float(0.001368000000), Float(0.002236000000), Float(0.004243000000), Float(0.007650000000),
     Float(0.014310000000), Float(0.023190000000), Float(0.043510000000), Float(0.077630000000),
@@ -188,6 +188,28 @@ const Float *cie1931_x_data = cie1931_tbl;
 const Float *cie1931_y_data = cie1931_tbl + MTS_CIE_SAMPLES;
 const Float *cie1931_z_data = cie1931_tbl + MTS_CIE_SAMPLES * 2;
 
+/// Interleaved version of the above table, see \ref cie1931_xyz_data
+struct alignas(16) CIE1931Interleaved {
+    Float data[MTS_CIE_SAMPLES * 8];
+};
+
+static constexpr CIE1931Interleaved cie1931_interleave() {
+    CIE1931Interleaved result { };
+    for (size_t i = 0; i < MTS_CIE_SAMPLES; ++i) {
+        size_t next = i + 1 < MTS_CIE_SAMPLES ? i + 1 : i;
+        for (size_t j = 0; j < 3; ++j) {
+            Float value = cie1931_tbl[j * MTS_CIE_SAMPLES + i];
+            result.data[i * 8 + j]     = value;
+            result.data[i * 8 + 4 + j] = cie1931_tbl[j * MTS_CIE_SAMPLES + next] - value;
+        }
+    }
+    return result;
+}
+
+static constexpr CIE1931Interleaved cie1931_interleaved_tbl = cie1931_interleave();
+
+const Float *cie1931_xyz_data = cie1931_interleaved_tbl.data;
+
 
 void cie_alloc() {
 #if defined(MTS_ENABLE_OPTIX)
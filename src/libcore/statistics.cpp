@@ -0,0 +1,175 @@
+#include <mitsuba/core/statistics.h>
+#include <mitsuba/core/string.h>
+#include <mitsuba/core/util.h>
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+
+NAMESPACE_BEGIN(mitsuba)
+
+bool Statistics::m_enabled = false;
+
+/* Every thread counts rays in its own (never released) storage, the global
+   list is only traversed to produce a report */
+struct StatisticsState {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<RayStatistics>> ray_counts;
+    std::map<std::string, double> times, values;
+    std::vector<float> pass_times;
+};
+
+static StatisticsState *statistics_state() {
+    static StatisticsState state;
+    return &state;
+}
+
+static thread_local RayStatistics *thread_ray_counts = nullptr;
+
+void Statistics::add_rays(RayCounter counter, RayWidth width, uint64_t count) {
+    if (unlikely(!thread_ray_counts)) {
+        StatisticsState *state = statistics_state();
+        std::lock_guard<std::mutex> guard(state->mutex);
+        state->ray_counts.emplace_back(new RayStatistics());
+        thread_ray_counts = state->ray_counts.back().get();
+    }
+    thread_ray_counts->rays[size_t(counter)][size_t(width)] += count;
+    thread_ray_counts->queries[size_t(counter)][size_t(width)]++;
+}
+
+RayStatistics Statistics::ray_statistics() {
+    StatisticsState *state = statistics_state();
+    std::lock_guard<std::mutex> guard(state->mutex);
+    RayStatistics result;
+    for (auto &counts : state->ray_counts) {
+        for (size_t i = 0; i < RayStatistics::CounterCount; ++i) {
+            for (size_t j = 0; j < RayStatistics::WidthCount; ++j) {
+                result.rays[i][j] += counts->rays[i][j];
+                result.queries[i][j] += counts->queries[i][j];
+            }
+        }
+    }
+    return result;
+}
+
+uint64_t Statistics::rays(RayCounter counter) {
+    return ray_statistics().total(counter);
+}
+
+void Statistics::add_time(const std::string &name, float time_ms) {
+    if (!m_enabled)
+        return;
+    StatisticsState *state = statistics_state();
+    std::lock_guard<std::mutex> guard(state->mutex);
+    state->times[name] += time_ms;
+}
+
+void Statistics::add_pass_time(float time_ms) {
+    if (!m_enabled)
+        return;
+    StatisticsState *state = statistics_state();
+    std::lock_guard<std::mutex> guard(state->mutex);
+    state->pass_times.push_back(time_ms);
+}
+
+void Statistics::set_value(const std::string &name, double value) {
+    if (!m_enabled)
+        return;
+    StatisticsState *state = statistics_state();
+    std::lock_guard<std::mutex> guard(state->mutex);
+    state->values[name] = value;
+}
+
+void Statistics::reset() {
+    StatisticsState *state = statistics_state();
+    std::lock_guard<std::mutex> guard(state->mutex);
+    for (auto &counts : state->ray_counts)
+        *counts = RayStatistics();
+    state->times.clear();
+    state->values.clear();
+    state->pass_times.clear();
+}
+
+RayStatistics RayStatistics::operator-(const RayStatistics &other) const {
+    RayStatistics result = *this;
+    for (size_t i = 0; i < CounterCount; ++i) {
+        for (size_t j = 0; j < WidthCount; ++j) {
+            result.rays[i][j] -= std::min(other.rays[i][j], rays[i][j]);
+            result.queries[i][j] -= std::min(other.queries[i][j], queries[i][j]);
+        }
+    }
+    return result;
+}
+
+std::string RayStatistics::to_string() const {
+    std::ostringstream oss;
+    oss << "RayStatistics[primary = " << primary() << ", secondary = " << secondary()
+        << ", shadow = " << shadow();
+
+    // Average width of the ray queries, to judge the SIMD utilization
+    const char *names[WidthCount] = { "scalar", "packet", "wavefront" };
+    for (size_t j = 0; j < WidthCount; ++j) {
+        uint64_t rays_j = 0, queries_j = 0;
+        for (size_t i = 0; i < CounterCount; ++i) {
+            if (i == size_t(RayCounter::Primary))
+                continue; // Primary rays are also counted as intersections
+            rays_j += rays[i][j];
+            queries_j += queries[i][j];
+        }
+        if (queries_j > 0)
+            oss << ", " << names[j] << " = " << rays_j << " rays in " << queries_j
+                << " queries";
+    }
+
+    if (time > 0.0)
+        oss << ", " << util::time_string((float) (time * 1000.0), true) << ", "
+            << rays_per_second() * 1e-6 << " Mrays/s";
+    oss << "]";
+    return oss.str();
+}
+
+std::string Statistics::to_json(const std::string &label) {
+    RayStatistics ray_stats = ray_statistics();
+    uint64_t primary  = ray_stats.primary(),
+             indirect = ray_stats.secondary(),
+             shadow   = ray_stats.shadow(),
+             total    = ray_stats.traced();
+
+    StatisticsState *state = statistics_state();
+    std::lock_guard<std::mutex> guard(state->mutex);
+
+    std::ostringstream oss;
+    oss << "{" << std::endl;
+    if (!label.empty())
+        oss << "  \"label\": \"" << string::json_escape(label) << "\"," << std::endl;
+
+    oss << "  \"times_ms\": {";
+    for (auto it = state->times.begin(); it != state->times.end(); ++it)
+        oss << (it == state->times.begin() ? " " : ", ") << "\""
+            << string::json_escape(it->first) << "\": " << it->second;
+    oss << " }," << std::endl;
+
+    oss << "  \"pass_times_ms\": [";
+    for (size_t i = 0; i < state->pass_times.size(); ++i)
+        oss << (i == 0 ? " " : ", ") << state->pass_times[i];
+    oss << " ]," << std::endl;
+
+    oss << "  \"rays\": { \"primary\": " << primary << ", \"indirect\": " << indirect
+        << ", \"shadow\": " << shadow << ", \"total\": " << total << " }," << std::endl;
+
+    auto render_time = state->times.find("render");
+    if (render_time != state->times.end() && render_time->second > 0)
+        oss << "  \"rays_per_second\": " << total / (render_time->second * 1e-3) << ","
+            << std::endl;
+
+    for (const auto &[name, value] : state->values)
+        oss << "  \"" << string::json_escape(name) << "\": " << value << "," << std::endl;
+
+    oss << "  \"peak_rss_bytes\": " << util::peak_memory_usage() << std::endl;
+    oss << "}";
+    return oss.str();
+}
+
+MTS_IMPLEMENT_CLASS(Statistics, Object)
+NAMESPACE_END(mitsuba)
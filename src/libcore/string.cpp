@@ -1,5 +1,6 @@
 #include <mitsuba/core/string.h>
 #include <mitsuba/core/object.h>
+#include <cstdio>
 
 NAMESPACE_BEGIN(mitsuba)
 NAMESPACE_BEGIN(string)
@@ -59,5 +60,23 @@ bool contains(const std::vector<std::string> &keys, const std::string &key) {
     return false;
 }
 
+std::string json_escape(const std::string &s) {
+    std::string result;
+    result.reserve(s.size());
+    for (char c : s) {
+        if (c == '"' || c == '\\') {
+            result += '\\';
+            result += c;
+        } else if ((unsigned char) c < 0x20) {
+            char buf[8];
+            snprintf(buf, sizeof(buf), "\\u%04x", (int) c);
+            result += buf;
+        } else {
+            result += c;
+        }
+    }
+    return result;
+}
+
 NAMESPACE_END(string)
 NAMESPACE_END(mitsuba)
@@ -10,6 +10,11 @@
 #include <unordered_map>
 #include <ostream>
 #include <map>
+#include <cstring>
+
+#if defined(ENOKI_X86_F16C) || defined(ENOKI_X86_AVX2) || defined(ENOKI_X86_AVX512F)
+#  include <immintrin.h>
+#endif
 
 /// Set this to '1' to view generated conversion code
 #if !defined(MTS_JIT_LOG_ASSEMBLY)
@@ -19,7 +24,7 @@
 NAMESPACE_BEGIN(mitsuba)
 
 // Defined in dither-matrix256.cpp
-extern const float dither_matrix256[65536];
+extern MTS_EXPORT_CORE const float dither_matrix256[65536];
 
 NAMESPACE_BEGIN(detail)
 
@@ -1206,6 +1211,7 @@ size_t hash(const Struct::Field &f) {
     value = hash_combine(value, hash(f.offset));
     value = hash_combine(value, hash(f.flags));
     value = hash_combine(value, hash(f.default_));
+    value = hash_combine(value, hash(f.blend));
     return value;
 }
 
@@ -1214,29 +1220,87 @@ size_t hash(const Struct &s) {
                         hash(s.m_byte_order));
 }
 
-static std::unordered_map<
-           std::pair<ref<const Struct>, ref<const Struct>>, void *,
-    hasher<std::pair<ref<const Struct>, ref<const Struct>>>,
-    comparator<std::pair<ref<const Struct>, ref<const Struct>>>> __cache;
+/// Layouts and flags that fully determine the behavior of a converter
+struct ConverterKey {
+    ref<const Struct> source;
+    ref<const Struct> target;
+    bool dither;
+
+    bool operator==(const ConverterKey &k) const {
+        return *source == *k.source && *target == *k.target && dither == k.dither;
+    }
+};
+
+struct ConverterKeyHasher {
+    size_t operator()(const ConverterKey &k) const {
+        return hash_combine(hash_combine(hash(*k.source), hash(*k.target)),
+                            hash(k.dither));
+    }
+};
+
+/// Compiled kernel and fast path tables shared by all converters of a layout
+struct ConverterRecord {
+    void *func;
+    uint32_t fast_path;
+    bool fast_flat;
+    std::vector<uint32_t> fast_offsets;
+    std::shared_ptr<const float> fast_lut;
+    uint32_t fast_period;
+};
+
+static std::mutex __cache_mutex;
+static std::unordered_map<ConverterKey, ConverterRecord, ConverterKeyHasher> __cache;
 
 StructConverter::StructConverter(const Struct *source, const Struct *target, bool dither)
  : m_source(source), m_target(target) {
-#if MTS_STRUCTCONVERTER_USE_JIT == 1
-    using namespace asmjit;
+#if MTS_STRUCTCONVERTER_USE_JIT == 0
+    m_dither = dither;
+#endif
 
-    // Use the Jit instance to cache structure converters
-    auto jit = Jit::get_instance();
-    std::lock_guard<std::mutex> guard(jit->mutex);
+    /* Converters between identical layouts are created very frequently (e.g.
+       once per loaded bitmap or PLY file). Reuse the state of the first one. */
+    ConverterKey key { source, target, dither };
+    std::lock_guard<std::mutex> guard(__cache_mutex);
 
-    auto key = std::make_pair(ref<const Struct>(source), ref<const Struct>(target));
     auto it = __cache.find(key);
-
     if (it != __cache.end()) {
-        // Cache hit
-        m_func = ptr_as_func<FuncType>(it->second);
+        const ConverterRecord &record = it->second;
+#if MTS_STRUCTCONVERTER_USE_JIT == 1
+        m_func = ptr_as_func<FuncType>(record.func);
+#endif
+        m_fast_path    = (FastPath) record.fast_path;
+        m_fast_flat    = record.fast_flat;
+        m_fast_offsets = record.fast_offsets;
+        m_fast_lut     = record.fast_lut;
+        m_fast_period  = record.fast_period;
         return;
     }
 
+    init_fast_path();
+
+    auto cache_insert = [&]() {
+        void *func = nullptr;
+#if MTS_STRUCTCONVERTER_USE_JIT == 1
+        func = (void *) m_func;
+#endif
+        __cache.emplace(key, ConverterRecord{ func, (uint32_t) m_fast_path,
+                                              m_fast_flat, m_fast_offsets,
+                                              m_fast_lut, m_fast_period });
+    };
+
+#if MTS_STRUCTCONVERTER_USE_JIT == 1
+    using namespace asmjit;
+
+    // No need to generate code if the conversion is handled by a fast path
+    m_func = nullptr;
+    if (m_fast_path != FastPath::None) {
+        cache_insert();
+        return;
+    }
+
+    auto jit = Jit::get_instance();
+    std::lock_guard<std::mutex> jit_guard(jit->mutex);
+
     CodeHolder code;
     code.init(jit->runtime.getCodeInfo());
     #if MTS_JIT_LOG_ASSEMBLY == 1
@@ -1458,12 +1522,243 @@ StructConverter::StructConverter(const Struct *source, const Struct *target, boo
        Log(Info, "Assembly:\n%s", logger.getString());
     #endif
 
-    __cache[key] = (void *) m_func;
-#else
-    m_dither = dither;
 #endif
+
+    cache_insert();
 }
 
+void StructConverter::init_fast_path() {
+    const uint32_t unsupported = Struct::Flags::Assert | Struct::Flags::Weight |
+                                 Struct::Flags::PremultipliedAlpha;
+
+    if (m_source->field_count() == 0 || m_target->field_count() == 0 ||
+        m_target->byte_order() != Struct::host_byte_order())
+        return;
+
+    Struct::Type source_type = (*m_source)[0].type,
+                 target_type = (*m_target)[0].type;
+
+    for (const Struct::Field &f : *m_source) {
+        if (f.type != source_type || (f.flags & unsupported) != 0)
+            return;
+    }
+
+    for (const Struct::Field &f : *m_target) {
+        if (f.type != target_type || (f.flags & unsupported) != 0 ||
+            has_flag(f.flags, Struct::Flags::Gamma) || !f.blend.empty() ||
+            !m_source->has_field(f.name))
+            return;
+    }
+
+    FastPath fast_path;
+    size_t source_elem, target_elem;
+    if (source_type == Struct::Type::UInt8 && target_type == Struct::Type::Float32) {
+        fast_path = FastPath::UInt8ToFloat32;
+        source_elem = 1; target_elem = 4;
+    } else if (source_type == Struct::Type::Float16 && target_type == Struct::Type::Float32) {
+        fast_path = FastPath::Float16ToFloat32;
+        source_elem = 2; target_elem = 4;
+    } else if (source_type == Struct::Type::Float32 && target_type == Struct::Type::Float16) {
+        fast_path = FastPath::Float32ToFloat16;
+        source_elem = 4; target_elem = 2;
+    } else {
+        return;
+    }
+
+    if (fast_path != FastPath::UInt8ToFloat32) {
+        // Floating point conversions are not linearized here
+        if (m_source->byte_order() != Struct::host_byte_order())
+            return;
+        for (const Struct::Field &f : *m_source) {
+            if (has_flag(f.flags, Struct::Flags::Gamma))
+                return;
+        }
+    }
+
+    size_t field_count = m_target->field_count();
+    bool flat = m_source->field_count() == field_count &&
+                m_source->size() == source_elem * field_count &&
+                m_target->size() == target_elem * field_count;
+
+    m_fast_offsets.clear();
+    for (size_t i = 0; i < field_count; ++i) {
+        const Struct::Field &f = (*m_target)[i];
+        const Struct::Field &sf = m_source->field(f.name);
+        m_fast_offsets.push_back((uint32_t) sf.offset);
+        m_fast_offsets.push_back((uint32_t) f.offset);
+        flat &= sf.offset == i * source_elem && f.offset == i * target_elem;
+    }
+
+    if (fast_path == FastPath::UInt8ToFloat32) {
+        std::shared_ptr<float> tables(new float[field_count * 256],
+                                      std::default_delete<float[]>());
+        bool identical = true;
+
+        for (size_t i = 0; i < field_count; ++i) {
+            const Struct::Field &sf = m_source->field((*m_target)[i].name);
+            float *lut = tables.get() + i * 256;
+            for (uint32_t j = 0; j < 256; ++j) {
+                float value = (float) j;
+                if (has_flag(sf.flags, Struct::Flags::Normalized))
+                    value *= float(1.0 / 255.0);
+                if (has_flag(sf.flags, Struct::Flags::Gamma))
+                    value = srgb_to_linear(value);
+                lut[j] = value;
+            }
+            if (i > 0 && memcmp(lut, tables.get(), 256 * sizeof(float)) != 0)
+                identical = false;
+        }
+
+        m_fast_lut = tables;
+        m_fast_period = identical ? 1 : (uint32_t) field_count;
+    }
+
+    m_fast_flat = flat;
+    m_fast_path = fast_path;
+}
+
+void StructConverter::convert_fast_path(size_t count, const uint8_t *src,
+                                        uint8_t *dest) const {
+    const size_t field_count = m_target->field_count(),
+                 source_size = m_source->size(),
+                 target_size = m_target->size();
+
+    switch (m_fast_path) {
+        case FastPath::UInt8ToFloat32: {
+                const float *lut = m_fast_lut.get();
+
+                if (m_fast_flat) {
+                    float *out = (float *) dest;
+                    size_t n = count * field_count, i = 0;
+                    uint32_t period = m_fast_period;
+
+                    /* Gather from the lookup tables, the table index repeats
+                       with the record layout when the period divides the width */
+                    #if defined(ENOKI_X86_AVX512F)
+                        if (16 % period == 0) {
+                            alignas(64) int32_t offsets[16];
+                            for (uint32_t k = 0; k < 16; ++k)
+                                offsets[k] = (int32_t) ((k % period) * 256);
+                            __m512i offset = _mm512_load_si512((const void *) offsets);
+                            for (; i + 16 <= n; i += 16) {
+                                __m512i index = _mm512_add_epi32(
+                                    _mm512_cvtepu8_epi32(_mm_loadu_si128((const __m128i *) (src + i))),
+                                    offset);
+                                _mm512_storeu_ps(out + i, _mm512_i32gather_ps(index, lut, 4));
+                            }
+                        }
+                    #elif defined(ENOKI_X86_AVX2)
+                        if (8 % period == 0) {
+                            alignas(32) int32_t offsets[8];
+                            for (uint32_t k = 0; k < 8; ++k)
+                                offsets[k] = (int32_t) ((k % period) * 256);
+                            __m256i offset = _mm256_load_si256((const __m256i *) offsets);
+                            for (; i + 8 <= n; i += 8) {
+                                __m256i index = _mm256_add_epi32(
+                                    _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *) (src + i))),
+                                    offset);
+                                _mm256_storeu_ps(out + i, _mm256_i32gather_ps(lut, index, 4));
+                            }
+                        }
+                    #endif
+
+                    for (; i < n; ++i)
+                        out[i] = lut[(i % period) * 256 + src[i]];
+                } else {
+                    for (size_t i = 0; i < count; ++i) {
+                        for (size_t k = 0; k < field_count; ++k) {
+                            float value = lut[k * 256 + src[m_fast_offsets[2 * k]]];
+                            memcpy(dest + m_fast_offsets[2 * k + 1], &value, sizeof(float));
+                        }
+                        src += source_size;
+                        dest += target_size;
+                    }
+                }
+            }
+            break;
+
+        case FastPath::Float16ToFloat32: {
+                if (m_fast_flat) {
+                    const uint16_t *in = (const uint16_t *) src;
+                    float *out = (float *) dest;
+                    size_t n = count * field_count, i = 0;
+
+                    #if defined(ENOKI_X86_AVX512F)
+                        for (; i + 16 <= n; i += 16)
+                            _mm512_storeu_ps(out + i, _mm512_cvtph_ps(
+                                _mm256_loadu_si256((const __m256i *) (in + i))));
+                    #elif defined(ENOKI_X86_F16C)
+                        for (; i + 8 <= n; i += 8)
+                            _mm256_storeu_ps(out + i, _mm256_cvtph_ps(
+                                _mm_loadu_si128((const __m128i *) (in + i))));
+                    #endif
+
+                    for (; i < n; ++i)
+                        out[i] = enoki::half::float16_to_float32(in[i]);
+                } else {
+                    for (size_t i = 0; i < count; ++i) {
+                        for (size_t k = 0; k < field_count; ++k) {
+                            uint16_t value;
+                            memcpy(&value, src + m_fast_offsets[2 * k], sizeof(uint16_t));
+                            float result = enoki::half::float16_to_float32(value);
+                            memcpy(dest + m_fast_offsets[2 * k + 1], &result, sizeof(float));
+                        }
+                        src += source_size;
+                        dest += target_size;
+                    }
+                }
+            }
+            break;
+
+        case FastPath::Float32ToFloat16: {
+                if (m_fast_flat) {
+                    const float *in = (const float *) src;
+                    uint16_t *out = (uint16_t *) dest;
+                    size_t n = count * field_count, i = 0;
+
+                    #if defined(ENOKI_X86_AVX512F)
+                        for (; i + 16 <= n; i += 16)
+                            _mm256_storeu_si256((__m256i *) (out + i), _mm512_cvtps_ph(
+                                _mm512_loadu_ps(in + i), _MM_FROUND_TO_NEAREST_INT));
+                    #elif defined(ENOKI_X86_F16C)
+                        for (; i + 8 <= n; i += 8)
+                            _mm_storeu_si128((__m128i *) (out + i), _mm256_cvtps_ph(
+                                _mm256_loadu_ps(in + i), _MM_FROUND_TO_NEAREST_INT));
+                    #endif
+
+                    for (; i < n; ++i)
+                        out[i] = enoki::half::float32_to_float16(in[i]);
+                } else {
+                    for (size_t i = 0; i < count; ++i) {
+                        for (size_t k = 0; k < field_count; ++k) {
+                            float value;
+                            memcpy(&value, src + m_fast_offsets[2 * k], sizeof(float));
+                            uint16_t result = enoki::half::float32_to_float16(value);
+                            memcpy(dest + m_fast_offsets[2 * k + 1], &result, sizeof(uint16_t));
+                        }
+                        src += source_size;
+                        dest += target_size;
+                    }
+                }
+            }
+            break;
+
+        default:
+            Throw("StructConverter: no fast path available!");
+    }
+}
+
+#if MTS_STRUCTCONVERTER_USE_JIT == 1
+bool StructConverter::convert_2d(size_t width, size_t height, const void *src,
+                                 void *dest) const {
+    if (m_fast_path != FastPath::None) {
+        convert_fast_path(width * height, (const uint8_t *) src, (uint8_t *) dest);
+        return true;
+    }
+    return m_func(width, height, src, dest);
+}
+#endif
+
 #if MTS_STRUCTCONVERTER_USE_JIT == 0
 
 bool StructConverter::load(const uint8_t *src, const Struct::Field &f, Value &value) const {
@@ -1722,6 +2017,11 @@ void StructConverter::save(uint8_t *dst, const Struct::Field &f, Value value, si
 bool StructConverter::convert_2d(size_t width, size_t height, const void *src_, void *dest_) const {
     using namespace mitsuba::detail;
 
+    if (m_fast_path != FastPath::None) {
+        convert_fast_path(width * height, (const uint8_t *) src_, (uint8_t *) dest_);
+        return true;
+    }
+
     size_t source_size = m_source->size();
     size_t target_size = m_target->size();
     Struct::Field weight_field, alpha_field;
@@ -76,6 +76,36 @@ def test_read_write_complex_exr(tmpdir):
     assert str(b3) != str(b1)
 
 
+@pytest.mark.parametrize('compression', ['None', 'RLE', 'ZIPS', 'ZIP', 'PIZ', 'DWAA', 'DWAB'])
+def test_write_exr_compression(tmpdir, compression):
+    # Tests the OpenEXR compression methods, writing to a file and to a stream
+    from mitsuba.core import FileStream
+    compression = getattr(Bitmap.EXRCompression, compression)
+    lossy = compression in [Bitmap.EXRCompression.DWAA, Bitmap.EXRCompression.DWAB]
+
+    b1 = Bitmap(Bitmap.PixelFormat.MultiChannel, Struct.Type.Float32, [67, 45], 7)
+    for i in range(7):
+        b1.struct_()[i].name = "ch_%i" % i
+    b2 = np.array(b1, copy=False)
+    b2[:] = np.random.RandomState(0).uniform(1, 2, size=b2.shape)
+
+    tmp_file = os.path.join(str(tmpdir), "out.exr")
+    b1.write(tmp_file, compression=compression)
+    b3 = np.array(Bitmap(tmp_file))
+
+    tmp_file_2 = os.path.join(str(tmpdir), "out_2.exr")
+    stream = FileStream(tmp_file_2, FileStream.ETruncReadWrite)
+    b1.write(stream, Bitmap.FileFormat.OpenEXR, compression=compression)
+    stream.close()
+    b4 = np.array(Bitmap(tmp_file_2))
+
+    assert np.all(b3 == b4)
+    if lossy:
+        assert np.allclose(b3, b2, atol=0.1)
+    else:
+        assert np.all(b3 == b2)
+
+
 def test_convert_rgb_y(tmpdir):
     # Tests RGBA(float64) -> Y (float32) conversion
     b1 = Bitmap(Bitmap.PixelFormat.RGBA, Struct.Type.Float64, [3, 1])
@@ -208,6 +238,51 @@ def test_read_write_ppm(tmpdir):
     os.remove(tmp_file)
 
 
+@pytest.mark.parametrize('pixel_format, channels', [(Bitmap.PixelFormat.Y, 1),
+                                                    (Bitmap.PixelFormat.RGBA, 4),
+                                                    (Bitmap.PixelFormat.MultiChannel, 5)])
+def test_read_write_tensor(tmpdir, pixel_format, channels):
+    np.random.seed(12345)
+
+    b = Bitmap(pixel_format, Struct.Type.Float32, [10, 20], channels)
+    ref = np.float32(np.random.random((20, 10, channels)))
+    np.array(b, copy=False)[:] = ref.reshape(np.array(b, copy=False).shape)
+    tmp_file = os.path.join(str(tmpdir), "out.tensor")
+    b.write(tmp_file)
+
+    # Loading from a file references its (memory-mapped) contents
+    b2 = Bitmap(tmp_file)
+    assert b2.memory_mapped()
+    assert b2.pixel_format() == pixel_format
+    assert b2.size() == b.size()
+    assert b == b2
+
+    # .. with copy-on-write semantics
+    np.array(b2, copy=False)[:] = 0
+    b3 = Bitmap(tmp_file)
+    assert b3 == b
+
+    # Other streams are read as usual
+    b4 = Bitmap(mitsuba.core.FileStream(tmp_file), Bitmap.FileFormat.Tensor)
+    assert not b4.memory_mapped()
+    assert b4 == b
+    del b2, b3, b4
+    os.remove(tmp_file)
+
+
+def test_read_ppm_memory_mapped(tmpdir):
+    b = Bitmap(Bitmap.PixelFormat.RGB, Struct.Type.UInt8, [10, 20])
+    np.array(b, copy=False)[:] = np.uint8(np.arange(600).reshape(20, 10, 3) % 256)
+    tmp_file = os.path.join(str(tmpdir), "out.ppm")
+    b.write(tmp_file)
+    b2 = Bitmap(tmp_file)
+    assert b2.memory_mapped()
+    assert np.all(np.array(b2) == np.array(b))
+    assert not Bitmap(b2).memory_mapped()
+    del b2
+    os.remove(tmp_file)
+
+
 def test_read_bmp():
     b = Bitmap(find_resource('resources/data/common/textures/flower.bmp'))
     ref = [ 136.50910448, 134.07641791,  85.67253731 ]
@@ -340,7 +340,7 @@ def test8_dict_unreferenced_attribute_error(variants_all_rgb):
             "type" : "point",
             "foo": 0.44
         })
-    e.match("Unreferenced attribute")
+    e.match("unreferenced property \"foo\"")
 
 
 
@@ -493,4 +493,42 @@ def test10_dict_expand_nested_object(variant_scalar_rgb):
             }
         },
     })
-    assert str(b0) == str(scene.shapes()[0].bsdf())
\ No newline at end of file
+    assert str(b0) == str(scene.shapes()[0].bsdf())
+
+def test11_dict_many_objects(variant_scalar_rgb):
+    from mitsuba.core import xml, ScalarTransform4f
+
+    # Objects are created in parallel, shared references still resolve to one object
+    scene_dict = {
+        "type" : "scene",
+        "shared_bsdf" : { "type" : "roughconductor", "alpha" : 0.2 },
+    }
+    for i in range(64):
+        scene_dict["shape_%02i" % i] = {
+            "type" : "sphere",
+            "to_world" : ScalarTransform4f.translate([3 * i, 0, 0]),
+            "bsdf" : { "type" : "ref", "id" : "shared_bsdf" } if i % 2 == 0 else {
+                "type" : "diffuse",
+                "reflectance" : { "type" : "rgb", "value" : [i / 64, 0, 0] }
+            }
+        }
+
+    scene = xml.load_dict(scene_dict)
+    shapes = scene.shapes()
+    assert len(shapes) == 64
+    assert ek.allclose(scene.bbox().max, [3 * 63 + 1, 1, 1])
+
+    bsdfs = [s.bsdf() for s in shapes if s.bsdf().class_().name() == "RoughConductor"]
+    assert len(bsdfs) == 32
+    assert all(b is bsdfs[0] for b in bsdfs)
+
+    # Errors of nested objects mention the path of the object
+    with pytest.raises(Exception) as e:
+        xml.load_dict({
+            "type" : "scene",
+            "shape" : {
+                "type" : "sphere",
+                "bsdf" : { "type" : "diffuse", "foo" : 1.0 }
+            }
+        })
+    e.match("shape.bsdf")
@@ -302,3 +302,51 @@ def test18_irrcont_simple_function(variant_packet_rgb):
                 0.48734, 0.654313, 0.786607, 0.899653, 1.])
          * d.normalization())
     )
+
+
+def test19_discr_alias_table(variant_packet_rgb):
+    # Sampling via an alias table follows the same distribution
+    from mitsuba.core import DiscreteDistribution, Float
+    import numpy as np
+
+    x = DiscreteDistribution([1, 3, 0, 2, 4])
+    assert not x.has_alias_table()
+    x.set_alias_table(True)
+    assert x.has_alias_table()
+
+    n = 100000
+    u = ek.linspace(Float, 0.5 / n, 1 - 0.5 / n, n)
+    index, reused, pmf = x.sample_reuse_pmf(u)
+    index = np.array(index)
+    assert np.all(index != 2)
+    assert np.allclose(np.bincount(index, minlength=5) / n, [.1, .3, 0, .2, .4],
+                       atol=1e-3)
+    assert ek.allclose(pmf, x.eval_pmf_normalized(index))
+    assert ek.allclose(x.sample(u), index)
+
+    # The re-scaled sample values are uniformly distributed
+    reused = np.sort(np.array(reused))
+    assert reused[0] >= 0 and reused[-1] < 1
+    assert np.allclose(reused, np.array(u), atol=1e-3)
+
+    # The table follows changes of the PMF
+    x.pmf()[:] = [1, 3, 10, 2, 4]
+    x.update()
+    assert np.count_nonzero(np.array(x.sample(u)) == 2) / n > 0.5
+
+
+def test20_irrcont_alias_table(variant_packet_rgb):
+    from mitsuba.core import IrregularContinuousDistribution, Float
+    import numpy as np
+
+    d = IrregularContinuousDistribution([1, 1.5, 1.8, 5], [1, 3, 0, 1])
+    d.set_alias_table(True)
+    assert d.has_alias_table()
+
+    # The CDF of the samples is uniformly distributed
+    n = 10000
+    u = ek.linspace(Float, 0.5 / n, 1 - 0.5 / n, n)
+    x, pdf = d.sample_pdf(u)
+    assert ek.allclose(pdf, d.eval_pdf_normalized(x, True), rtol=1e-3)
+    cdf = np.sort(np.array(d.eval_cdf_normalized(x)))
+    assert np.allclose(cdf, np.array(u), atol=1e-3)
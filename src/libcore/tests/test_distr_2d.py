@@ -186,3 +186,27 @@ def test05_discrete_distribution_2d(variant_scalar_rgb):
     assert ac(d.sample([1, 0]), ([2, 0], .3, [1, 0]))
     assert ac(d.sample([0, 6 / 10 - 1e-7]), ([0, 0], .1, [0, 1]))
     assert ac(d.sample([0, 6 / 10 + 1e-7]), ([1, 1], .1, [0, 0]))
+
+
+@pytest.mark.parametrize("normalize", [True, False])
+@pytest.mark.parametrize("ndim", [0, 3])
+def test06_half_precision_storage(variant_scalar_rgb, ndim, normalize):
+    # Half precision tables should evaluate to (almost) the same values
+    cls = getattr(mitsuba.core, 'MarginalContinuous2D%i' % ndim)
+    cls_half = getattr(mitsuba.core, 'MarginalContinuous2D%iHalf' % ndim)
+    np.random.seed(ndim)
+
+    shape = np.random.randint(2, 8, ndim + 2)
+    param_res = [sorted(np.random.rand(s)) for s in shape[:-2]]
+    values = np.random.rand(*shape) * 1e6
+
+    ref = cls(values, param_res, normalize, False)
+    instance = cls_half(values, param_res, normalize, False)
+
+    for j in range(10):
+        p = np.random.rand(2)
+        param = [np.random.uniform(r[0], r[-1]) for r in param_res]
+        assert ek.allclose(instance.eval(p, param), ref.eval(p, param), rtol=2e-3)
+
+    with pytest.raises(RuntimeError, match='enable_sampling'):
+        cls_half(values, param_res, normalize, True)
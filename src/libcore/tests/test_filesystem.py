@@ -154,3 +154,34 @@ def test12_truncate_and_file_size():
     assert fs.file_size(p) == 42
     assert fs.remove(p)
     assert not fs.exists(p)
+
+
+def test13_file_resolver_cache(tmpdir):
+    from mitsuba.core import FileResolver
+
+    d1, d2 = tmpdir.mkdir('d1'), tmpdir.mkdir('d2')
+    d2.join('asset.txt').write('')
+
+    fr = FileResolver()
+    fr.clear()
+    fr.append(str(d1))
+    fr.append(str(d2))
+    fr.set_cache_enabled(True)
+    assert fr.cache_enabled()
+    assert fr.resolve('asset.txt') == fs.path(str(d2.join('asset.txt')))
+
+    # Memoized results are returned even if the file system changed ..
+    d1.join('asset.txt').write('')
+    assert fr.resolve('asset.txt') == fs.path(str(d2.join('asset.txt')))
+
+    # .. until the cache is cleared or the search paths are modified
+    fr.clear_cache()
+    assert fr.resolve('asset.txt') == fs.path(str(d1.join('asset.txt')))
+    fr.prepend(str(d2))
+    assert fr.resolve('asset.txt') == fs.path(str(d2.join('asset.txt')))
+
+    # Copies keep the setting but not the memoized results
+    fr2 = FileResolver(fr)
+    assert fr2.cache_enabled()
+    fr.set_cache_enabled(False)
+    assert not fr.cache_enabled()
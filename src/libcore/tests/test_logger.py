@@ -41,3 +41,41 @@ def test01_custom(variant_scalar_rgb):
         for app in appenders:
             logger.add_appender(app)
         logger.set_formatter(formatter)
+
+
+def test02_async(variant_scalar_rgb):
+    from mitsuba.core import Thread, Appender, Log, LogLevel
+
+    # Messages logged in asynchronous mode are delivered in order upon flush()
+    messages = []
+
+    class MyAppender(Appender):
+        def append(self, level, text):
+            messages.append(text)
+
+        def log_progress(self, progress, name, formatted, eta, ptr=None):
+            messages.append(name)
+
+    logger = Thread.thread().logger()
+    appender = MyAppender()
+    logger.add_appender(appender)
+    try:
+        logger.set_asynchronous(True)
+        assert logger.asynchronous()
+        for i in range(100):
+            Log(LogLevel.Info, "Message %i" % i)
+        logger.log_progress(0.5, "progress", "", "")
+        logger.flush()
+        assert len(messages) == 101
+        for i in range(100):
+            assert messages[i].endswith("Message %i" % i)
+        assert messages[100] == "progress"
+
+        # Disabling asynchronous mode delivers all pending messages
+        Log(LogLevel.Info, "Final message")
+        logger.set_asynchronous(False)
+        assert not logger.asynchronous()
+        assert messages[-1].endswith("Final message")
+    finally:
+        logger.set_asynchronous(False)
+        logger.remove_appender(appender)
@@ -0,0 +1,18 @@
+import mitsuba
+import pytest
+
+
+def test01_preload_plugins(variant_scalar_rgb):
+    from mitsuba.core import PluginManager
+
+    pmgr = PluginManager.instance()
+    # Unknown plugins are skipped, the error is raised on instantiation
+    pmgr.preload_plugins(['diffuse', 'box', 'this_plugin_does_not_exist'])
+    loaded = pmgr.loaded_plugins()
+    assert 'diffuse' in loaded and 'box' in loaded
+    assert 'this_plugin_does_not_exist' not in loaded
+
+    cls = pmgr.get_plugin_class('diffuse', 'scalar_rgb')
+    assert cls is not None and cls.name() == 'SmoothDiffuse'
+    assert pmgr.get_plugin_class('diffuse', 'scalar_rgb').name() == cls.name()
+    assert pmgr.get_plugin_class('this_plugin_does_not_exist', 'scalar_rgb') is None
@@ -162,3 +162,28 @@ def test08_animated_transforms(variant_scalar_rgb):
     assert type(p["trafo"]) is Transform4f
     assert type(p["atrafo"]) is AnimatedTransform
 
+
+
+def test09_large_property_sets(variant_scalar_rgb):
+    """Large sets switch to a hash index and keep their natural ordering"""
+    from mitsuba.core import Properties as Prop
+
+    p = Prop()
+    names = ['item_%i' % i for i in range(200)]
+    for i, name in reversed(list(enumerate(names))):
+        p[name] = i
+    assert p.property_names() == names
+
+    for i, name in enumerate(names):
+        assert p[name] == i
+    assert not p.has_property('item_200')
+
+    for name in names[::2]:
+        assert p.remove_property(name)
+    assert p.property_names() == names[1::2]
+    assert all(p[name] == i for i, name in enumerate(names) if i % 2 == 1)
+    assert not any(p.has_property(name) for name in names[::2])
+
+    p2 = Prop(p)
+    p2['item_1'] = 'changed'
+    assert p2 != p and p['item_1'] == 1
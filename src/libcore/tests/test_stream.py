@@ -5,7 +5,8 @@ import mitsuba
 
 mitsuba.set_variant('scalar_rgb')
 
-from mitsuba.core import Stream, DummyStream, FileStream, MemoryStream, ZStream
+from mitsuba.core import Stream, DummyStream, FileStream, MemoryStream, ZStream, \
+    BufferedStream
 from mitsuba.python.test.util import tmpfile, make_tmpfile
 
 parameters = [
@@ -283,3 +284,67 @@ def test08_fstream(rw, tmpfile):
     else:
         with pytest.raises(RuntimeError):
             FileStream(new_name)
+
+
+@pytest.mark.parametrize('buffer_size', [1, 7, 1024])
+def test09_buffered_stream(buffer_size, tmpfile):
+    s = FileStream(tmpfile, FileStream.ETruncReadWrite)
+    b = BufferedStream(s, buffer_size)
+    assert b.buffer_size() == buffer_size
+    assert b.child_stream().can_write()
+
+    write_contents(b)
+    b.write_line('first line')
+    b.write_line('second line\r')
+    b.flush()
+    check_contents(b)
+    assert b.read_line() == 'first line'
+    assert b.read_line() == 'second line'
+    with pytest.raises(RuntimeError):
+        b.read_line()
+
+    # Seeking back into buffered data and overwriting it
+    b.seek(0)
+    assert ek.abs(b.read_single() - contents[0]) < 1e-5
+    b.seek(0)
+    b.write_single(1.5)
+    b.flush()
+    b.seek(0)
+    assert b.read_single() == 1.5
+    assert b.tell() == 4
+
+    size = b.size()
+    b.seek(size - 1)
+    with pytest.raises(RuntimeError):
+        b.read_int64()
+
+    b.close()
+    assert not s.can_read()
+
+
+@pytest.mark.parametrize('stream_type', [ZStream.EDeflateStream, ZStream.EGZipStream])
+def test10_parallel_zstream(stream_type, tmpfile):
+    import zlib
+    import numpy as np
+
+    data = np.random.RandomState(0).randint(0, 4, 100000).astype(np.uint8).tobytes()
+
+    s = FileStream(tmpfile, FileStream.ETruncReadWrite)
+    z = ZStream(s, stream_type, -1, 4096)
+    assert z.parallel_block_size() == 4096
+    # Partial blocks (and flushes) in the middle of the stream are supported
+    z.write(data[:5000])
+    z.flush()
+    z.write(data[5000:])
+    z.close()
+    s.close()
+
+    # The output is a regular zlib/gzip stream ..
+    with open(tmpfile, 'rb') as f:
+        wbits = 15 if stream_type == ZStream.EDeflateStream else 31
+        assert zlib.decompress(f.read(), wbits) == data
+
+    # .. which can also be read back by ZStream
+    s = FileStream(tmpfile)
+    z = ZStream(s, stream_type)
+    assert bytes(z.read(len(data))) == data
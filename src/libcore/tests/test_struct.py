@@ -447,3 +447,61 @@ def test19_alpha_4():
     dst_data = (src_data_float[0], src_data_float[1], src_data[2])
     check_conversion(s, '@BBB', '@BBB',
                      src_data, dst_data)
+
+
+def test20_fast_path_uint8_gamma():
+    # Interleaved sRGB color with a linear alpha channel; many records so
+    # that the vectorized code path is exercised along with the scalar tail
+    src_struct = Struct() \
+        .append('r', Struct.Type.UInt8, Struct.Flags.Normalized | Struct.Flags.Gamma) \
+        .append('g', Struct.Type.UInt8, Struct.Flags.Normalized | Struct.Flags.Gamma) \
+        .append('b', Struct.Type.UInt8, Struct.Flags.Normalized | Struct.Flags.Gamma) \
+        .append('a', Struct.Type.UInt8, Struct.Flags.Normalized | Struct.Flags.Alpha)
+    dst_struct = Struct() \
+        .append('r', Struct.Type.Float32) \
+        .append('g', Struct.Type.Float32) \
+        .append('b', Struct.Type.Float32) \
+        .append('a', Struct.Type.Float32, Struct.Flags.Alpha)
+    s = StructConverter(src_struct, dst_struct)
+
+    src_data = [(i * 7) % 256 for i in range(4 * 37)]
+    dst_data = [from_srgb(v / 255.0) if i % 4 != 3 else v / 255.0
+                for i, v in enumerate(src_data)]
+    check_conversion(s, '@%iB' % len(src_data), '@%if' % len(src_data),
+                     src_data, dst_data, err_thresh=1e-5)
+
+
+def test21_fast_path_half():
+    src_struct = Struct() \
+        .append('x', Struct.Type.Float32) \
+        .append('y', Struct.Type.Float32)
+    dst_struct = Struct() \
+        .append('x', Struct.Type.Float16) \
+        .append('y', Struct.Type.Float16)
+
+    data = [i * 0.25 for i in range(2 * 21)]
+    fmt = '%ie' % len(data)
+    check_conversion(StructConverter(src_struct, dst_struct), '@%if' % len(data),
+                     '@' + fmt, data)
+    check_conversion(StructConverter(dst_struct, src_struct), '@' + fmt,
+                     '@%if' % len(data), data)
+
+
+def test22_converter_cache():
+    def make_target(weights):
+        target = Struct()
+        target.append('v', Struct.Type.Float32)
+        target.field('v').blend = [(weights[0], 'a'), (weights[1], 'b')]
+        return target
+
+    src = Struct() \
+        .append('a', Struct.Type.Float32) \
+        .append('b', Struct.Type.Float32)
+
+    # Converters for identical layouts share their kernel, while layouts
+    # that only differ in their blend weights must not
+    for i in range(2):
+        check_conversion(StructConverter(src, make_target((3.0, 4.0))),
+                         '@ff', '@f', (1.0, 2.0), (11.0,))
+        check_conversion(StructConverter(src, make_target((1.0, 2.0))),
+                         '@ff', '@f', (1.0, 2.0), (5.0,))
@@ -27,3 +27,19 @@ def test01_mem_string(variant_scalar_rgb):
         assert mem_string(2 * 1024 ** 4, precise=True) == '2 TiB'
         assert mem_string(2 * 1024 ** 5, precise=True) == '2 PiB'
         assert mem_string(2 * 1024 ** 6, precise=True) == '2 EiB'
+
+
+def test02_numa_nodes(variant_scalar_rgb):
+    from mitsuba.core import Thread
+
+    nodes = Thread.numa_nodes()
+    assert len(nodes) >= 1 and all(len(node) > 0 for node in nodes)
+    cores = [c for node in nodes for c in node]
+    assert len(cores) == len(set(cores))
+
+    thread = Thread.thread()
+    assert thread.numa_node() == -1
+    thread.set_numa_node(0)
+    assert thread.numa_node() == 0
+    thread.set_numa_node(-1)
+    assert thread.numa_node() == -1
@@ -360,3 +360,175 @@ def test24_properties_duplicated(variant_scalar_rgb):
                             </bsdf>
                         </scene>""")
     e.match(err_str)
+
+
+def test25_scene_cache(variant_scalar_rgb, tmpdir):
+    from mitsuba.core import xml
+    import os
+
+    cache_dir = str(tmpdir.join('cache'))
+    scene_path = str(tmpdir.join('scene.xml'))
+    include_path = str(tmpdir.join('include.xml'))
+
+    with open(scene_path, 'w') as f:
+        f.write("""<scene version="2.0.0">
+                       <default name="x" value="1"/>
+                       <include filename="%s"/>
+                       <shape type="sphere">
+                           <transform name="to_world">
+                               <translate x="$x"/>
+                           </transform>
+                           <bsdf type="diffuse">
+                               <rgb name="reflectance" value="0.2"/>
+                           </bsdf>
+                       </shape>
+                   </scene>""" % include_path)
+
+    def write_include(radius):
+        with open(include_path, 'w') as f:
+            f.write("""<scene version="2.0.0">
+                           <shape type="sphere">
+                               <float name="radius" value="%s"/>
+                           </shape>
+                       </scene>""" % radius)
+
+    def bboxes(scene):
+        return sorted([(list(s.bbox().min), list(s.bbox().max))
+                       for s in scene.shapes()])
+
+    write_include('2')
+    reference = bboxes(xml.load_file(scene_path))
+    scene_a = xml.load_file(scene_path, cache_dir=cache_dir)
+    files = os.listdir(cache_dir)
+    assert len(files) == 1 and files[0].endswith('.xmlcache')
+    assert bboxes(scene_a) == reference
+
+    # The second load must be served from the cache
+    mtime = os.path.getmtime(os.path.join(cache_dir, files[0]))
+    scene_b = xml.load_file(scene_path, cache_dir=cache_dir)
+    assert os.path.getmtime(os.path.join(cache_dir, files[0])) == mtime
+    assert bboxes(scene_b) == reference
+
+    # Modified includes invalidate the cached description
+    write_include('30')
+    scene_c = xml.load_file(scene_path, cache_dir=cache_dir)
+    assert bboxes(scene_c) == bboxes(xml.load_file(scene_path))
+    assert bboxes(scene_c) != reference
+    assert os.listdir(cache_dir) == files
+
+    # Different parameters are stored separately
+    scene_d = xml.load_file(scene_path, cache_dir=cache_dir, x=5)
+    assert bboxes(scene_d) == bboxes(xml.load_file(scene_path, x=5))
+    assert len(os.listdir(cache_dir)) == 2
+
+
+def test26_lazy_instantiation(variant_scalar_rgb):
+    from mitsuba.core import xml
+
+    scene_str = """<scene version="2.0.0" {attr}>
+                       <bsdf type="diffuse" id="unused">
+                           <float name="invalid_parameter" value="1"/>
+                       </bsdf>
+                       <bsdf type="diffuse" id="used">
+                           <rgb name="reflectance" value="0.25"/>
+                       </bsdf>
+                       <shape type="sphere">
+                           <ref id="used"/>
+                       </shape>
+                   </scene>"""
+
+    with pytest.raises(Exception) as e:
+        xml.load_string(scene_str.format(attr=''))
+    e.match('unreferenced property')
+
+    scene = xml.load_string(scene_str.format(attr='lazy="true"'))
+    assert len(scene.shapes()) == 1
+    assert scene.shapes()[0].bsdf() is not None
+
+    with pytest.raises(Exception) as e:
+        xml.load_string(scene_str.format(attr='lazy="maybe"'))
+    e.match('could not parse boolean value')
+
+
+def test27_cyclic_reference(variant_scalar_rgb):
+    from mitsuba.core import xml
+
+    with pytest.raises(Exception) as e:
+        xml.load_string("""<scene version="2.0.0">
+                               <bsdf type="twosided" id="a">
+                                   <ref id="b"/>
+                               </bsdf>
+                               <bsdf type="twosided" id="b">
+                                   <ref id="a"/>
+                               </bsdf>
+                           </scene>""")
+    e.match('cyclic reference to "a"')
+
+
+@fresolver_append_path
+def test28_prefetched_bitmaps(variant_scalar_rgb):
+    from mitsuba.core import xml
+
+    shape = """<shape type="sphere">
+                   <bsdf type="diffuse">
+                       <texture type="bitmap" name="reflectance">
+                           <string name="filename" value="{filename}"/>
+                       </texture>
+                   </bsdf>
+               </shape>"""
+
+    # The images are decoded ahead of the creation of the textures
+    shapes = [shape.format(filename="resources/data/common/textures/carrot.png")] * 20
+    scene = xml.load_string('<scene version="2.0.0">%s</scene>' % ''.join(shapes))
+    assert len(scene.shapes()) == 20
+
+    # Errors are still reported by the plugin that references the file
+    shapes.append(shape.format(filename="resources/data/common/textures/missing.png"))
+    with pytest.raises(Exception) as e:
+        xml.load_string('<scene version="2.0.0">%s</scene>' % ''.join(shapes))
+    e.match('missing.png')
+
+
+@fresolver_append_path
+def test29_load_trace(variant_scalar_rgb, tmpdir):
+    from mitsuba.core import xml, LoadTrace
+    import json
+
+    LoadTrace.set_enabled(True)
+    try:
+        xml.load_string("""<scene version="2.0.0">
+                               <bsdf type="diffuse" id="material">
+                                   <texture type="bitmap" name="reflectance">
+                                       <string name="filename"
+                                               value="resources/data/common/textures/carrot.png"/>
+                                   </texture>
+                               </bsdf>
+                               <shape type="sphere" id="ball">
+                                   <ref id="material"/>
+                               </shape>
+                           </scene>""")
+        records = LoadTrace.records()
+        path = LoadTrace.critical_path()
+        filename = str(tmpdir.join('load.json'))
+        LoadTrace.write_json(filename)
+    finally:
+        LoadTrace.set_enabled(False)
+
+    by_id = { r.id: r for r in records }
+    assert by_id['material'].plugin == 'diffuse'
+    assert by_id['ball'].references == ['material']
+    assert all(r.time >= 0 and r.start >= 0 for r in records)
+
+    texture = [r for r in records if r.plugin == 'bitmap'][0]
+    assert texture.filename.endswith('carrot.png')
+    assert texture.bytes_read > 0 and texture.decoded_bytes > 0
+    assert texture.id in by_id['material'].references
+
+    # The scene is created last and depends on the whole chain
+    assert path[-1].class_name == 'Scene'
+    assert [r.id for r in path[:-1]] == [texture.id, 'material', 'ball']
+
+    with open(filename) as f:
+        data = json.load(f)
+    assert len(data['objects']) == len(records)
+    assert data['critical_path'] == [r.id for r in path]
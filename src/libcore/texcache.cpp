@@ -0,0 +1,370 @@
+#include <mitsuba/core/texcache.h>
+#include <mitsuba/core/bitmap.h>
+#include <mitsuba/core/fstream.h>
+#include <mitsuba/core/logger.h>
+#include <mitsuba/core/mmap.h>
+#include <mitsuba/core/util.h>
+#include <atomic>
+#include <cstring>
+#include <list>
+#include <sstream>
+#include <unordered_map>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/// Header of a tiled texture file, followed by the level resolutions and tiles
+struct TiledTextureHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t key;
+    uint32_t channel_count;
+    uint32_t tile_shift;
+    uint32_t level_count;
+    float mean;
+};
+
+static const char tiled_texture_magic[4] = { 'M', 'T', 'E', 'X' };
+static const uint32_t tiled_texture_version = 1;
+
+/// Number of entries of the per-thread tile micro-cache
+static const size_t micro_cache_size = 16;
+
+struct MicroCacheEntry {
+    uint64_t key = (uint64_t) -1;
+    std::shared_ptr<const float> tile;
+};
+
+static thread_local MicroCacheEntry micro_cache[micro_cache_size];
+
+/// Unique key of a tile, texture IDs are never reused within a process
+static uint64_t tile_key(uint32_t id, uint32_t level, uint32_t index) {
+    return ((uint64_t) id << 40) | ((uint64_t) level << 32) | (uint64_t) index;
+}
+
+// =============================================================
+//! @{ \name TiledTexture
+// =============================================================
+
+TiledTexture::TiledTexture(const fs::path &filename, uint64_t key, uint32_t id)
+    : m_filename(filename), m_id(id) {
+    m_mmap = new MemoryMappedFile(filename);
+    const uint8_t *data = (const uint8_t *) m_mmap->data();
+    size_t size = m_mmap->size();
+
+    TiledTextureHeader header;
+    if (size < sizeof(TiledTextureHeader))
+        Throw("\"%s\": file is too small", filename.string());
+    memcpy(&header, data, sizeof(TiledTextureHeader));
+
+    if (memcmp(header.magic, tiled_texture_magic, 4) != 0 ||
+        header.version != tiled_texture_version)
+        Throw("\"%s\": not a tiled texture file of version %i", filename.string(),
+              tiled_texture_version);
+    if (header.key != key)
+        Throw("\"%s\": key mismatch", filename.string());
+    if (header.channel_count == 0 || header.tile_shift > 12 ||
+        header.level_count == 0 || header.level_count > 32)
+        Throw("\"%s\": invalid header", filename.string());
+
+    m_channel_count = header.channel_count;
+    m_tile_shift = header.tile_shift;
+    m_mean = header.mean;
+
+    size_t offset = sizeof(TiledTextureHeader) +
+                    header.level_count * 2 * sizeof(uint32_t);
+    if (size < offset)
+        Throw("\"%s\": file is too small", filename.string());
+
+    const uint32_t *resolution = (const uint32_t *) (data + sizeof(TiledTextureHeader));
+    for (uint32_t i = 0; i < header.level_count; ++i) {
+        Level level;
+        level.width  = resolution[2 * i];
+        level.height = resolution[2 * i + 1];
+        if (level.width == 0 || level.height == 0)
+            Throw("\"%s\": invalid level resolution", filename.string());
+        level.tiles_x = (level.width + tile_size() - 1) >> m_tile_shift;
+        level.tiles_y = (level.height + tile_size() - 1) >> m_tile_shift;
+        level.offset = offset;
+        offset += (size_t) level.tiles_x * level.tiles_y * tile_bytes();
+        m_levels.push_back(level);
+    }
+
+    if (size != offset)
+        Throw("\"%s\": file size mismatch (expected %i bytes, got %i)",
+              filename.string(), offset, size);
+}
+
+TiledTexture::~TiledTexture() { }
+
+void TiledTexture::fetch(uint32_t level, uint32_t x, uint32_t y, float *out) const {
+    const Level &l = m_levels[level];
+    uint32_t mask  = tile_size() - 1,
+             index = (y >> m_tile_shift) * l.tiles_x + (x >> m_tile_shift);
+
+    uint64_t key = tile_key(m_id, level, index);
+    MicroCacheEntry &entry =
+        micro_cache[(key ^ (key >> 29) ^ (key >> 40)) % micro_cache_size];
+
+    if (unlikely(entry.key != key)) {
+        entry.tile = TextureCache::instance()->tile(this, level, index);
+        entry.key = key;
+    }
+
+    const float *ptr = entry.tile.get() +
+        (((y & mask) << m_tile_shift) + (x & mask)) * m_channel_count;
+    for (uint32_t i = 0; i < m_channel_count; ++i)
+        out[i] = ptr[i];
+}
+
+void TiledTexture::read_tile(uint32_t level, uint32_t index, float *out) const {
+    const Level &l = m_levels[level];
+    memcpy(out, (const uint8_t *) m_mmap->data() + l.offset + (size_t) index * tile_bytes(),
+           tile_bytes());
+}
+
+std::string TiledTexture::to_string() const {
+    std::ostringstream oss;
+    oss << "TiledTexture[" << std::endl
+        << "  filename = \"" << m_filename << "\"," << std::endl
+        << "  resolution = [" << width() << ", " << height() << "]," << std::endl
+        << "  channel_count = " << m_channel_count << "," << std::endl
+        << "  level_count = " << level_count() << "," << std::endl
+        << "  tile_size = " << tile_size() << std::endl
+        << "]";
+    return oss.str();
+}
+
+//! @}
+// =============================================================
+
+// =============================================================
+//! @{ \name TextureCache
+// =============================================================
+
+struct TextureCache::TextureCachePrivate {
+    struct Entry {
+        std::shared_ptr<const float> tile;
+        std::list<uint64_t>::iterator lru;
+        size_t size;
+    };
+
+    mutable std::mutex mutex;
+    std::unordered_map<uint64_t, Entry> tiles;
+    /// Least recently used tiles are at the back
+    std::list<uint64_t> lru;
+    size_t memory_usage = 0;
+    size_t max_memory = (size_t) 1024 * 1024 * 1024;
+    std::atomic<uint32_t> next_id { 0 };
+
+    // Statistics
+    uint64_t lookups = 0, loads = 0, evictions = 0;
+};
+
+TextureCache::TextureCache() : d(new TextureCachePrivate()) { }
+
+TextureCache::~TextureCache() { }
+
+ref<TiledTexture> TextureCache::open(const fs::path &filename, uint64_t key) {
+    if (!fs::is_regular_file(filename))
+        return nullptr;
+
+    try {
+        return new TiledTexture(filename, key, d->next_id++);
+    } catch (const std::exception &e) {
+        Log(Warn, "Ignoring stale or incompatible tiled texture: %s", e.what());
+        return nullptr;
+    }
+}
+
+std::shared_ptr<const float> TextureCache::tile(const TiledTexture *texture,
+                                                uint32_t level, uint32_t index) {
+    uint64_t key = tile_key(texture->m_id, level, index);
+
+    {
+        std::lock_guard<std::mutex> guard(d->mutex);
+        d->lookups++;
+        auto it = d->tiles.find(key);
+        if (it != d->tiles.end()) {
+            d->lru.splice(d->lru.begin(), d->lru, it->second.lru);
+            return it->second.tile;
+        }
+    }
+
+    // Read outside of the lock so that other threads aren't blocked by I/O
+    size_t size = texture->tile_bytes();
+    std::shared_ptr<float> tile(new float[size / sizeof(float)],
+                                std::default_delete<float[]>());
+    texture->read_tile(level, index, tile.get());
+
+    std::lock_guard<std::mutex> guard(d->mutex);
+    auto [it, inserted] = d->tiles.try_emplace(key);
+    if (!inserted) // Another thread loaded the same tile in the meantime
+        return it->second.tile;
+
+    d->lru.push_front(key);
+    it->second = { tile, d->lru.begin(), size };
+    d->memory_usage += size;
+    d->loads++;
+    evict();
+
+    return tile;
+}
+
+void TextureCache::evict() {
+    // Always keep the most recently used tile
+    while (d->memory_usage > d->max_memory && d->lru.size() > 1) {
+        auto it = d->tiles.find(d->lru.back());
+        d->memory_usage -= it->second.size;
+        d->tiles.erase(it);
+        d->lru.pop_back();
+        d->evictions++;
+    }
+}
+
+void TextureCache::set_max_memory(size_t size) {
+    std::lock_guard<std::mutex> guard(d->mutex);
+    d->max_memory = size;
+    evict();
+}
+
+size_t TextureCache::max_memory() const {
+    std::lock_guard<std::mutex> guard(d->mutex);
+    return d->max_memory;
+}
+
+size_t TextureCache::memory_usage() const {
+    std::lock_guard<std::mutex> guard(d->mutex);
+    return d->memory_usage;
+}
+
+void TextureCache::clear() {
+    std::lock_guard<std::mutex> guard(d->mutex);
+    d->tiles.clear();
+    d->lru.clear();
+    d->memory_usage = 0;
+}
+
+void TextureCache::write(const Bitmap *bitmap, const fs::path &filename,
+                         uint64_t key, float mean, uint32_t tile_size) {
+    if (bitmap->component_format() != Struct::Type::Float32)
+        Throw("TextureCache::write(): expected a bitmap with a Float32 "
+              "component format!");
+    if (tile_size == 0 || (tile_size & (tile_size - 1)) != 0)
+        Throw("TextureCache::write(): the tile size must be a power of two!");
+
+    uint32_t channels = (uint32_t) bitmap->channel_count(),
+             tile_shift = 0;
+    while ((1u << tile_shift) < tile_size)
+        tile_shift++;
+
+    // Determine the resolution of all MIP levels
+    std::vector<std::pair<uint32_t, uint32_t>> levels;
+    uint32_t width = (uint32_t) bitmap->width(), height = (uint32_t) bitmap->height();
+    while (true) {
+        levels.emplace_back(width, height);
+        if (width == 1 && height == 1)
+            break;
+        width = std::max(1u, (width + 1) / 2);
+        height = std::max(1u, (height + 1) / 2);
+    }
+
+    TiledTextureHeader header;
+    memcpy(header.magic, tiled_texture_magic, 4);
+    header.version = tiled_texture_version;
+    header.key = key;
+    header.channel_count = channels;
+    header.tile_shift = tile_shift;
+    header.level_count = (uint32_t) levels.size();
+    header.mean = mean;
+
+    fs::path tmp_path = filename;
+    tmp_path.replace_extension(".tmp");
+
+    {
+        ref<FileStream> stream = new FileStream(tmp_path, FileStream::ETruncReadWrite);
+        stream->write(&header, sizeof(TiledTextureHeader));
+        for (auto [w, h] : levels) {
+            stream->write(w);
+            stream->write(h);
+        }
+
+        std::unique_ptr<float[]> tile(new float[channels << (2 * tile_shift)]);
+        std::vector<float> current((const float *) bitmap->data(),
+                                   (const float *) bitmap->data() +
+                                       bitmap->pixel_count() * channels),
+                           next;
+
+        for (size_t l = 0; l < levels.size(); ++l) {
+            auto [w, h] = levels[l];
+
+            // Split the level into tiles, replicating the last row/column
+            for (uint32_t ty = 0; ty < h; ty += tile_size) {
+                for (uint32_t tx = 0; tx < w; tx += tile_size) {
+                    float *out = tile.get();
+                    for (uint32_t y = 0; y < tile_size; ++y) {
+                        uint32_t sy = std::min(ty + y, h - 1);
+                        for (uint32_t x = 0; x < tile_size; ++x) {
+                            uint32_t sx = std::min(tx + x, w - 1);
+                            const float *in = current.data() + ((size_t) sy * w + sx) * channels;
+                            for (uint32_t c = 0; c < channels; ++c)
+                                *out++ = in[c];
+                        }
+                    }
+                    stream->write(tile.get(), sizeof(float) * channels << (2 * tile_shift));
+                }
+            }
+
+            if (l + 1 == levels.size())
+                break;
+
+            // Downsample using a box filter, clamping at odd resolutions
+            auto [nw, nh] = levels[l + 1];
+            next.resize((size_t) nw * nh * channels);
+            for (uint32_t y = 0; y < nh; ++y) {
+                uint32_t y0 = std::min(2 * y, h - 1), y1 = std::min(2 * y + 1, h - 1);
+                for (uint32_t x = 0; x < nw; ++x) {
+                    uint32_t x0 = std::min(2 * x, w - 1), x1 = std::min(2 * x + 1, w - 1);
+                    for (uint32_t c = 0; c < channels; ++c) {
+                        next[((size_t) y * nw + x) * channels + c] = .25f * (
+                            current[((size_t) y0 * w + x0) * channels + c] +
+                            current[((size_t) y0 * w + x1) * channels + c] +
+                            current[((size_t) y1 * w + x0) * channels + c] +
+                            current[((size_t) y1 * w + x1) * channels + c]);
+                    }
+                }
+            }
+            current.swap(next);
+        }
+    }
+
+    if (fs::exists(filename))
+        fs::remove(filename);
+    if (!fs::rename(tmp_path, filename))
+        Throw("TextureCache::write(): unable to rename \"%s\"", tmp_path.string());
+
+    Log(Debug, "Stored tiled texture \"%s\" (%s)", filename.string(),
+        util::mem_string(fs::file_size(filename)));
+}
+
+std::string TextureCache::to_string() const {
+    std::lock_guard<std::mutex> guard(d->mutex);
+    std::ostringstream oss;
+    oss << "TextureCache[" << std::endl
+        << "  memory_usage = " << util::mem_string(d->memory_usage) << "," << std::endl
+        << "  max_memory = " << util::mem_string(d->max_memory) << "," << std::endl
+        << "  tiles = " << d->tiles.size() << "," << std::endl
+        << "  lookups = " << d->lookups << "," << std::endl
+        << "  loads = " << d->loads << "," << std::endl
+        << "  evictions = " << d->evictions << std::endl
+        << "]";
+    return oss.str();
+}
+
+ref<TextureCache> TextureCache::m_instance = new TextureCache();
+
+//! @}
+// =============================================================
+
+MTS_IMPLEMENT_CLASS(TiledTexture, Object)
+MTS_IMPLEMENT_CLASS(TextureCache, Object)
+NAMESPACE_END(mitsuba)
@@ -1,5 +1,7 @@
 #include <mitsuba/core/thread.h>
+#include <mitsuba/core/filesystem.h>
 #include <mitsuba/core/logger.h>
+#include <mitsuba/core/string.h>
 #include <mitsuba/core/tls.h>
 #include <mitsuba/core/util.h>
 #include <mitsuba/core/fresolver.h>
@@ -9,6 +11,7 @@
 #include <thread>
 #include <sstream>
 #include <chrono>
+#include <fstream>
 
 // Required for native thread functions
 #if defined(__LINUX__)
@@ -93,6 +96,7 @@ struct Thread::ThreadPrivate {
     bool tbb_thread = false;
     bool critical = false;
     int core_affinity = -1;
+    int numa_node = -1;
     Thread::EPriority priority;
     ref<Logger> logger;
     ref<Thread> parent;
@@ -169,6 +173,10 @@ int Thread::core_affinity() const {
     return d->core_affinity;
 }
 
+int Thread::numa_node() const {
+    return d->numa_node;
+}
+
 uint32_t Thread::thread_id() {
 #if defined(__WINDOWS__)
     return this_thread_id;
@@ -340,6 +348,90 @@ void Thread::set_core_affinity(int core_id) {
 #endif
 }
 
+const std::vector<std::vector<int>> &Thread::numa_nodes() {
+    static std::vector<std::vector<int>> nodes = []() {
+        std::vector<std::vector<int>> result;
+#if defined(__LINUX__)
+        cpu_set_t available;
+        CPU_ZERO(&available);
+        bool have_mask = sched_getaffinity(0, sizeof(cpu_set_t), &available) == 0;
+
+        // Parse the core lists of all nodes (e.g. "0-15,64-79")
+        for (int node = 0; ; ++node) {
+            fs::path path = "/sys/devices/system/node/node" + std::to_string(node) + "/cpulist";
+            std::ifstream is(path.string());
+            if (!is.good())
+                break;
+            std::string line;
+            std::getline(is, line);
+
+            std::vector<int> cores;
+            for (const std::string &item : string::tokenize(line, ",")) {
+                std::vector<std::string> bounds = string::tokenize(item, "-");
+                if (bounds.empty())
+                    continue;
+                int first = std::stoi(bounds[0]),
+                    last  = bounds.size() > 1 ? std::stoi(bounds[1]) : first;
+                for (int core = first; core <= last; ++core) {
+                    if (!have_mask || core >= CPU_SETSIZE || CPU_ISSET(core, &available))
+                        cores.push_back(core);
+                }
+            }
+            if (!cores.empty())
+                result.push_back(cores);
+        }
+#endif
+        if (result.empty()) {
+            std::vector<int> cores(util::core_count());
+            for (size_t i = 0; i < cores.size(); ++i)
+                cores[i] = (int) i;
+            result.push_back(cores);
+        }
+        return result;
+    }();
+    return nodes;
+}
+
+void Thread::set_numa_node(int node) {
+    d->numa_node = node;
+    if (!d->running)
+        return;
+
+#if defined(__LINUX__)
+    const auto &nodes = numa_nodes();
+    if (node >= (int) nodes.size()) {
+        Log(Warn, "Thread::set_numa_node(): out of bounds: %i nodes available, "
+                  "requested #%i!", nodes.size(), node);
+        return;
+    }
+
+    int max_core = 0;
+    for (const auto &cores : nodes)
+        for (int core : cores)
+            max_core = std::max(max_core, core);
+
+    size_t size = CPU_ALLOC_SIZE(max_core + 1);
+    cpu_set_t *cpuset = CPU_ALLOC(max_core + 1);
+    if (!cpuset) {
+        Log(Warn, "Thread::set_numa_node(): could not allocate cpu_set_t");
+        return;
+    }
+    CPU_ZERO_S(size, cpuset);
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        if (node != -1 && (int) i != node)
+            continue;
+        for (int core : nodes[i])
+            CPU_SET_S(core, size, cpuset);
+    }
+
+    int retval = pthread_setaffinity_np(d->native_handle, size, cpuset);
+    if (retval)
+        Log(Warn, "Thread::set_numa_node(): pthread_setaffinity_np: failed: %s",
+            strerror(retval));
+    CPU_FREE(cpuset);
+#endif
+}
+
 void Thread::start() {
     if (d->running)
         Log(Error, "Thread is already running!");
@@ -394,6 +486,8 @@ void Thread::dispatch() {
 
     if (d->core_affinity != -1)
         set_core_affinity(d->core_affinity);
+    if (d->numa_node != -1)
+        set_numa_node(d->numa_node);
 
     try {
         run();
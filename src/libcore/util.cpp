@@ -12,13 +12,16 @@
 #  include <unistd.h>
 #  include <limits.h>
 #  include <sys/ioctl.h>
+#  include <sys/resource.h>
 #elif defined(__OSX__)
 #  include <sys/sysctl.h>
 #  include <mach-o/dyld.h>
 #  include <unistd.h>
 #  include <sys/ioctl.h>
+#  include <sys/resource.h>
 #elif defined(__WINDOWS__)
 #  include <windows.h>
+#  include <psapi.h>
 #endif
 
 NAMESPACE_BEGIN(mitsuba)
@@ -250,6 +253,24 @@ fs::path library_path() {
     return fs::absolute(result);
 }
 
+uint64_t peak_memory_usage() {
+#if defined(__WINDOWS__)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return 0;
+    return (uint64_t) counters.PeakWorkingSetSize;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+#  if defined(__OSX__)
+    return (uint64_t) usage.ru_maxrss;
+#  else
+    return (uint64_t) usage.ru_maxrss * 1024;
+#  endif
+#endif
+}
+
 int terminal_width() {
     static int cached_width = -1;
 
@@ -1,21 +1,34 @@
+#include <algorithm>
+#include <atomic>
 #include <cctype>
+#include <condition_variable>
+#include <deque>
 #include <fstream>
+#include <mutex>
 #include <set>
 #include <unordered_map>
 
+#include <mitsuba/core/bitmap.h>
 #include <mitsuba/core/class.h>
 #include <mitsuba/core/config.h>
 #include <mitsuba/core/filesystem.h>
 #include <mitsuba/core/fresolver.h>
+#include <mitsuba/core/fstream.h>
+#include <mitsuba/core/hash.h>
+#include <mitsuba/core/loadtrace.h>
 #include <mitsuba/core/logger.h>
 #include <mitsuba/core/math.h>
+#include <mitsuba/core/memreport.h>
 #include <mitsuba/core/object.h>
 #include <mitsuba/core/plugin.h>
 #include <mitsuba/core/profiler.h>
 #include <mitsuba/core/properties.h>
 #include <mitsuba/core/spectrum.h>
+#include <mitsuba/core/statistics.h>
 #include <mitsuba/core/string.h>
+#include <mitsuba/core/timer.h>
 #include <mitsuba/core/transform.h>
+#include <mitsuba/core/util.h>
 #include <mitsuba/core/vector.h>
 #include <mitsuba/core/xml.h>
 #include <pugixml.hpp>
@@ -224,6 +237,20 @@ struct XMLSource {
     }
 };
 
+/**
+ * Recipe of a texture that was specified inline via an <rgb> or <spectrum>
+ * tag. These textures are created while parsing, and the recipe allows the
+ * scene cache to recreate them without storing the objects themselves.
+ */
+struct XMLTexture {
+    std::string name;
+    bool rgb = false;
+    bool within_emitter = false;
+    Color3f color = 0.f;
+    Float value = 1.f;
+    std::vector<Float> wavelengths, values;
+};
+
 struct XMLObject {
     Properties props;
     const Class *class_ = nullptr;
@@ -231,8 +258,8 @@ struct XMLObject {
     std::string alias;
     std::function<std::string(ptrdiff_t)> offset;
     size_t location = 0;
+    std::vector<XMLTexture> textures;
     ref<Object> object;
-    tbb::spin_mutex mutex;
 };
 
 enum class ColorMode {
@@ -267,14 +294,26 @@ struct XMLParseContext {
     Transform4f transform;
     size_t id_counter = 0;
     bool parallelize;
+    bool staged;
     ColorMode color_mode;
+    /// Only create top-level objects once they are referenced (<scene lazy="true">)
+    bool lazy = false;
+
+    /// Inline textures of the object that is currently being parsed
+    std::vector<XMLTexture> textures;
+    /// Files that were read while parsing (scene, includes, spectra)
+    std::vector<fs::path> dependencies;
+    /// Search paths that were added via <path> tags, in order
+    std::vector<fs::path> resource_paths;
 
     XMLParseContext(const std::string &variant) : variant(variant) {
         color_mode = MTS_INVOKE_VARIANT(variant, variant_to_color_mode);
 
-        /* Don't load the scene in parallel when running in GPU mode
-           (The Enoki CUDA backend is currently not multi-threaded) */
-        parallelize = !MTS_INVOKE_VARIANT(variant, check_cuda);
+        /* Don't create objects in parallel when running in GPU mode (The
+           Enoki CUDA backend is currently not multi-threaded). Files are
+           instead read ahead by the asynchronous stage (see prefetch_nodes) */
+        staged = MTS_INVOKE_VARIANT(variant, check_cuda);
+        parallelize = !staged;
     }
 
     std::string variant;
@@ -439,6 +478,22 @@ void upgrade_tree(XMLSource &src, pugi::xml_node &node, const Version &version)
     src.modified = true;
 }
 
+/// Create the texture object described by an <rgb> or <spectrum> tag
+static ref<Object> create_texture(const XMLParseContext &ctx, const XMLTexture &texture) {
+    if (texture.rgb)
+        return create_texture_from_rgb(texture.name, texture.color, ctx.variant,
+                                       texture.within_emitter);
+
+    // Work on copies, the values are rescaled in-place
+    std::vector<float> wavelengths(texture.wavelengths),
+                       values(texture.values);
+    return create_texture_from_spectrum(texture.name, texture.value,
+                                        wavelengths, values, ctx.variant,
+                                        texture.within_emitter,
+                                        ctx.color_mode == ColorMode::Spectral,
+                                        ctx.color_mode == ColorMode::Monochromatic);
+}
+
 static std::pair<std::string, std::string> parse_xml(XMLSource &src, XMLParseContext &ctx,
                                                      pugi::xml_node &node, Tag parent_tag,
                                                      Properties &props, ParameterList &param,
@@ -543,11 +598,22 @@ static std::pair<std::string, std::string> parse_xml(XMLSource &src, XMLParseCon
 
         switch (tag) {
             case Tag::Object: {
-                    check_attributes(src, node, { "type", "id", "name" });
-                    std::string id        = node.attribute("id").value(),
-                                name      = node.attribute("name").value(),
-                                type      = node.attribute("type").value(),
-                                node_name = node.name();
+                    std::string node_name = node.name();
+                    if (depth == 0 && node_name == "scene" && node.attribute("lazy")) {
+                        check_attributes(src, node, { "type", "id", "name", "lazy" });
+                        std::string value = string::to_lower(node.attribute("lazy").value());
+                        if (value != "true" && value != "false")
+                            src.throw_error(node, "could not parse boolean value "
+                                                  "\"%s\" -- must be \"true\" or "
+                                                  "\"false\"", value);
+                        ctx.lazy = value == "true";
+                    } else {
+                        check_attributes(src, node, { "type", "id", "name" });
+                    }
+
+                    std::string id   = node.attribute("id").value(),
+                                name = node.attribute("name").value(),
+                                type = node.attribute("type").value();
 
                     Properties props_nested(type);
                     props_nested.set_id(id);
@@ -562,6 +628,9 @@ static std::pair<std::string, std::string> parse_xml(XMLSource &src, XMLParseCon
                         src.throw_error(node, "could not retrieve class object for "
                                        "tag \"%s\" and variant \"%s\"", node_name, ctx.variant);
 
+                    std::vector<XMLTexture> textures_parent;
+                    std::swap(textures_parent, ctx.textures);
+
                     size_t arg_counter_nested = 0;
                     for (pugi::xml_node &ch: node.children()) {
                         auto [arg_name, nested_id] =
@@ -579,6 +648,8 @@ static std::pair<std::string, std::string> parse_xml(XMLSource &src, XMLParseCon
                     inst.offset = src.offset;
                     inst.src_id = src.id;
                     inst.location = node.offset_debug();
+                    inst.textures = std::move(ctx.textures);
+                    ctx.textures = std::move(textures_parent);
                     return std::make_pair(name, id);
                 }
                 break;
@@ -646,6 +717,7 @@ static std::pair<std::string, std::string> parse_xml(XMLSource &src, XMLParseCon
                     if (!fs::exists(resource_path))
                         src.throw_error(node, "<path>: folder \"%s\" not found", resource_path);
                     fs->prepend(resource_path);
+                    ctx.resource_paths.push_back(resource_path);
                     return std::make_pair("", "");
                 }
                 break;
@@ -658,6 +730,7 @@ static std::pair<std::string, std::string> parse_xml(XMLSource &src, XMLParseCon
                         src.throw_error(node, "included file \"%s\" not found", filename);
 
                     Log(Info, "Loading included XML file \"%s\" ..", filename);
+                    ctx.dependencies.push_back(filename);
 
                     pugi::xml_document doc;
                     pugi::xml_parse_result result = doc.load_file(filename.native().c_str());
@@ -793,10 +866,13 @@ static std::pair<std::string, std::string> parse_xml(XMLSource &src, XMLParseCon
                     }
 
                     if (!within_spectrum) {
-                        std::string name = node.attribute("name").value();
-                        ref<Object> obj = detail::create_texture_from_rgb(
-                            name, color, ctx.variant, within_emitter);
-                        props.set_object(name, obj);
+                        XMLTexture texture;
+                        texture.name = node.attribute("name").value();
+                        texture.rgb = true;
+                        texture.within_emitter = within_emitter;
+                        texture.color = color;
+                        props.set_object(texture.name, create_texture(ctx, texture));
+                        ctx.textures.push_back(std::move(texture));
                     } else {
                         props.set_color("color", color);
                     }
@@ -847,17 +923,21 @@ static std::pair<std::string, std::string> parse_xml(XMLSource &src, XMLParseCon
                                 values.push_back(value);
                             }
                         } else if (has_filename) {
-                            spectrum_from_file(node.attribute("filename").value(), wavelengths, values);
+                            std::string filename = node.attribute("filename").value();
+                            spectrum_from_file(filename, wavelengths, values);
+                            ctx.dependencies.push_back(
+                                Thread::thread()->file_resolver()->resolve(filename));
                         }
                     }
 
-                    ref<Object> obj = detail::create_texture_from_spectrum(
-                        name, const_value, wavelengths, values, ctx.variant,
-                        within_emitter,
-                        ctx.color_mode == ColorMode::Spectral,
-                        ctx.color_mode == ColorMode::Monochromatic);
-
-                    props.set_object(name, obj);
+                    XMLTexture texture;
+                    texture.name = name;
+                    texture.within_emitter = within_emitter;
+                    texture.value = const_value;
+                    texture.wavelengths = std::move(wavelengths);
+                    texture.values = std::move(values);
+                    props.set_object(name, create_texture(ctx, texture));
+                    ctx.textures.push_back(std::move(texture));
                 }
                 break;
 
@@ -973,54 +1053,101 @@ static std::pair<std::string, std::string> parse_xml(XMLSource &src, XMLParseCon
     return std::make_pair("", "");
 }
 
-static ref<Object> instantiate_node(XMLParseContext &ctx, const std::string &id) {
+/// Node of the dependency graph that is built by instantiate_node()
+struct XMLNode {
+    XMLObject *inst = nullptr;
+    /// Referenced nodes, together with the associated property names
+    std::vector<std::pair<std::string, size_t>> references;
+    /// Nodes that reference this node
+    std::vector<size_t> dependents;
+    /// Number of references that still need to be instantiated
+    std::atomic<size_t> pending { 0 };
+    bool visiting = false;
+    /// File that is loaded by the asynchronous prefetch stage (if any)
+    fs::path prefetch_path;
+    /// Whether the file is an image that is decoded ahead of time
+    bool prefetch_bitmap = false;
+    /// State of the prefetch stage, see \ref PrefetchState
+    std::atomic<uint32_t> prefetch { 0 };
+    /// Time spent by the prefetch stage (in milliseconds, only with \ref LoadTrace)
+    double prefetch_time = 0.0;
+};
+
+enum PrefetchState : uint32_t { PrefetchNone = 0, PrefetchQueued, PrefetchRunning, PrefetchDone };
+
+struct XMLGraph {
+    std::deque<XMLNode> nodes;
+    std::unordered_map<const XMLObject *, size_t> index;
+    /// Node indices in dependency order (post-order)
+    std::vector<size_t> order;
+    /// Index of the load in the \ref LoadTrace (if enabled)
+    uint32_t load = 0;
+};
+
+/// Look up an instance and follow aliases until reaching an actual object
+static XMLObject &resolve_instance(XMLParseContext &ctx, const std::string &id) {
     auto it = ctx.instances.find(id);
     if (it == ctx.instances.end())
         Throw("reference to unknown object \"%s\"!", id);
+    while (!it->second.alias.empty()) {
+        std::string alias = it->second.alias;
+        it = ctx.instances.find(alias);
+        if (it == ctx.instances.end())
+            Throw("reference to unknown object \"%s\"!", alias);
+    }
+    return it->second;
+}
 
-    auto &inst = it->second;
-    tbb::spin_mutex::scoped_lock lock(inst.mutex);
+/**
+ * In lazy mode, top-level objects that the scene doesn't consume itself
+ * (e.g. materials, textures and shape groups declared for referencing) are
+ * only created once another object references them
+ */
+static bool is_deferred(XMLParseContext &ctx, const std::string &id) {
+    auto it = ctx.instances.find(id);
+    if (it == ctx.instances.end())
+        return false;
+    const XMLObject &inst = resolve_instance(ctx, id);
+    const std::string &class_name = inst.class_->name();
+    if (class_name == "Shape")
+        return inst.props.plugin_name() == "shapegroup";
+    return class_name != "Emitter" && class_name != "Sensor" &&
+           class_name != "Integrator";
+}
 
-    if (inst.object) {
-        return inst.object;
-    } else if (!inst.alias.empty()) {
-        std::string alias = inst.alias;
-        lock.release();
-        return instantiate_node(ctx, alias);
+/// Recursively add an instance and everything it references to the graph
+static size_t add_node(XMLParseContext &ctx, XMLGraph &graph, XMLObject &inst) {
+    auto it = graph.index.find(&inst);
+    if (it != graph.index.end()) {
+        if (graph.nodes[it->second].visiting)
+            Throw("cyclic reference to \"%s\"!", inst.props.id());
+        return it->second;
     }
 
-    Properties &props = inst.props;
-    const auto &named_references = props.named_references();
-
-    ThreadEnvironment env;
+    size_t index = graph.nodes.size();
+    graph.index[&inst] = index;
+    XMLNode &node = graph.nodes.emplace_back();
+    node.inst = &inst;
+
+    if (!inst.object) {
+        Properties &props = inst.props;
+        auto named_references = props.named_references();
+
+        if (ctx.lazy && inst.class_->name() == "Scene") {
+            auto it_end = std::remove_if(
+                named_references.begin(), named_references.end(),
+                [&](const auto &kv) { return is_deferred(ctx, kv.second); });
+            for (auto it2 = it_end; it2 != named_references.end(); ++it2)
+                props.remove_property(it2->first);
+            named_references.erase(it_end, named_references.end());
+        }
 
-    auto functor = [&](const tbb::blocked_range<uint32_t> &range) {
-        ScopedSetThreadEnvironment set_env(env);
-        for (uint32_t i = range.begin(); i != range.end(); ++i) {
-            auto &kv = named_references[i];
+        node.visiting = true;
+        for (auto &kv : named_references) {
             try {
-                ref<Object> obj;
-                auto instantiate_recursively = [&]() {
-                    obj = instantiate_node(ctx, kv.second);
-                };
-
-                // Potentially isolate from parent tasks to prevent deadlocks
-                if (ctx.parallelize)
-                    tbb::this_task_arena::isolate(instantiate_recursively);
-                else
-                    instantiate_recursively();
-
-                // Give the object a chance to recursively expand into sub-objects
-                std::vector<ref<Object>> children = obj->expand();
-                if (children.empty()) {
-                    props.set_object(kv.first, obj, false);
-                } else if (children.size() == 1) {
-                    props.set_object(kv.first, children[0], false);
-                } else {
-                    int ctr = 0;
-                    for (auto c : children)
-                        props.set_object(kv.first + "_" + std::to_string(ctr++), c, false);
-                }
+                size_t child = add_node(ctx, graph, resolve_instance(ctx, kv.second));
+                node.references.emplace_back(kv.first, child);
+                graph.nodes[child].dependents.push_back(index);
             } catch (const std::exception &e) {
                 if (strstr(e.what(), "Error while loading") == nullptr)
                     Throw("Error while loading \"%s\" (near %s): %s",
@@ -1029,17 +1156,97 @@ static ref<Object> instantiate_node(XMLParseContext &ctx, const std::string &id)
                     throw;
             }
         }
-    };
+        node.visiting = false;
+        node.pending = node.references.size();
+    }
 
-    tbb::blocked_range<uint32_t> range(0u, (uint32_t) named_references.size(), 1);
+    graph.order.push_back(index);
+    return index;
+}
 
-    if (ctx.parallelize)
-        tbb::parallel_for(range, functor);
-    else
-        functor(range);
+/// Add the creation of a graph node to the load trace
+static void trace_node(XMLGraph &graph, XMLNode &node, LoadTrace::Clock::time_point start,
+                       LoadTrace::Clock::time_point end) {
+    XMLObject &inst = *node.inst;
+
+    LoadRecord record;
+    record.id            = inst.props.id();
+    record.plugin        = inst.props.plugin_name();
+    record.class_name    = inst.class_->name();
+    record.thread        = Thread::thread()->name();
+    record.load          = graph.load;
+    record.start         = LoadTrace::time(start);
+    record.time          = LoadTrace::time(end) - record.start;
+    record.prefetch_time = node.prefetch_time;
+
+    // Referenced objects are accounted first, so that only owned memory remains
+    ref<MemoryReport> report = new MemoryReport();
+    for (auto &[name, child] : node.references) {
+        const XMLObject *child_inst = graph.nodes[child].inst;
+        record.references.push_back(child_inst->props.id());
+        report->visit(child_inst->object.get());
+    }
+    size_t referenced = report->total_host() + report->total_device();
+    report->visit(inst.object.get());
+    record.decoded_bytes = report->total_host() + report->total_device() - referenced;
+
+    fs::path path = node.prefetch_path;
+    if (path.empty() && inst.props.has_property("filename") &&
+        inst.props.type("filename") == Properties::Type::String) {
+        try {
+            // Query a copy, which leaves the queried state of the properties alone
+            std::string filename = Properties(inst.props).string("filename");
+            path = Thread::thread()->file_resolver()->resolve(filename);
+        } catch (const std::exception &) { }
+    }
+    if (!path.empty() && fs::is_regular_file(path)) {
+        record.filename   = path.string();
+        record.bytes_read = fs::file_size(path);
+    }
+
+    LoadTrace::add(std::move(record));
+}
+
+/// Create the object of a graph node, whose references must already exist
+static void create_node(XMLGraph &graph, XMLNode &node) {
+    XMLObject &inst = *node.inst;
+    if (inst.object)
+        return;
+
+    bool trace = LoadTrace::enabled();
+    LoadTrace::Clock::time_point start, end;
+
+    Properties &props = inst.props;
+    for (auto &[name, child] : node.references) {
+        try {
+            ref<Object> obj = graph.nodes[child].inst->object;
+
+            // Give the object a chance to recursively expand into sub-objects
+            std::vector<ref<Object>> children = obj->expand();
+            if (children.empty()) {
+                props.set_object(name, obj, false);
+            } else if (children.size() == 1) {
+                props.set_object(name, children[0], false);
+            } else {
+                int ctr = 0;
+                for (auto c : children)
+                    props.set_object(name + "_" + std::to_string(ctr++), c, false);
+            }
+        } catch (const std::exception &e) {
+            if (strstr(e.what(), "Error while loading") == nullptr)
+                Throw("Error while loading \"%s\" (near %s): %s",
+                      inst.src_id, inst.offset(inst.location), e.what());
+            else
+                throw;
+        }
+    }
 
     try {
+        if (trace)
+            start = LoadTrace::Clock::now();
         inst.object = PluginManager::instance()->create_object(props, inst.class_);
+        if (trace)
+            end = LoadTrace::Clock::now();
     } catch (const std::exception &e) {
         Throw("Error while loading \"%s\" (near %s): could not instantiate "
               "%s plugin of type \"%s\": %s", inst.src_id, inst.offset(inst.location),
@@ -1067,7 +1274,607 @@ static ref<Object> instantiate_node(XMLParseContext &ctx, const std::string &id)
               unqueried.size() > 1 ? "properties" : "property", unqueried,
               string::to_lower(inst.class_->name()), props.plugin_name());
     }
-    return inst.object;
+
+    if (trace)
+        trace_node(graph, node, start, end);
+}
+
+/// Read a file once so that subsequent accesses are served from the page cache
+static void read_ahead(const fs::path &path) {
+    std::ifstream is(path.native(), std::ios::binary);
+    char buf[64 * 1024];
+    while (is.read(buf, sizeof(buf)))
+        ;
+}
+
+/**
+ * Select the nodes whose files are loaded by the asynchronous prefetch stage:
+ * the images referenced by bitmap textures and environment maps, and with \c
+ * read_ahead_all, every other referenced file as well. Returns their indices.
+ */
+static std::vector<size_t> prefetch_select(XMLGraph &graph, bool read_ahead_all) {
+    std::vector<size_t> result;
+    for (size_t index : graph.order) {
+        XMLNode &node = graph.nodes[index];
+        XMLObject &inst = *node.inst;
+        if (inst.object || !inst.props.has_property("filename") ||
+            inst.props.type("filename") != Properties::Type::String)
+            continue;
+
+        const std::string &class_name = inst.class_->name(),
+                          &plugin_name = inst.props.plugin_name();
+        bool bitmap = (class_name == "Texture" && plugin_name == "bitmap") ||
+                      (class_name == "Emitter" && plugin_name == "envmap");
+        if (!bitmap && !read_ahead_all)
+            continue;
+
+        try {
+            // Query a copy, the plugin must still mark the property itself
+            std::string filename = Properties(inst.props).string("filename");
+            fs::path path = Thread::thread()->file_resolver()->resolve(filename);
+            if (!fs::is_regular_file(path))
+                continue;
+            // Tiled textures are paged in by the texture cache instead
+            if (bitmap && path.extension() == ".mtex")
+                continue;
+            node.prefetch_path = path;
+        } catch (const std::exception &) {
+            continue;
+        }
+
+        node.prefetch_bitmap = bitmap;
+        node.prefetch = PrefetchQueued;
+        result.push_back(index);
+    }
+    return result;
+}
+
+/**
+ * Load the file of a node on behalf of the prefetch stage. Returns \c false
+ * when another thread already claimed it. Decoded images are handed to the
+ * plugin via the "bitmap" property. Failures are ignored here, the plugins
+ * report them later on.
+ */
+static bool prefetch_node(XMLNode &node) {
+    uint32_t expected = PrefetchQueued;
+    if (!node.prefetch.compare_exchange_strong(expected, PrefetchRunning))
+        return false;
+
+    auto start = LoadTrace::Clock::now();
+    try {
+        if (node.prefetch_bitmap)
+            node.inst->props.set_object("bitmap", new Bitmap(node.prefetch_path), false);
+        else
+            read_ahead(node.prefetch_path);
+    } catch (const std::exception &e) {
+        Log(Debug, "Could not prefetch \"%s\": %s", node.prefetch_path.string(), e.what());
+    }
+    if (LoadTrace::enabled())
+        node.prefetch_time = std::chrono::duration<double, std::milli>(
+            LoadTrace::Clock::now() - start).count();
+
+    node.prefetch = PrefetchDone;
+    return true;
+}
+
+/**
+ * Asynchronous stage that loads the files selected by prefetch_select() while
+ * the other objects are being created, so that decoding hundreds of large
+ * images is neither serialized by the order of the scene description nor
+ * delayed until the texture nodes are reached.
+ *
+ * The files are processed by at most 8 tasks of \c group, which is enough to
+ * saturate the disk and leaves the remaining workers to the creation of the
+ * other objects. \c done is invoked for every node once its file is loaded.
+ */
+static void prefetch_nodes(XMLGraph &graph, const std::vector<size_t> &nodes,
+                           tbb::task_group &group, ThreadEnvironment &env,
+                           std::atomic<size_t> &next,
+                           const std::function<void(size_t)> &done) {
+    size_t task_count = std::min(nodes.size(), (size_t) std::min(util::core_count(), 8));
+    for (size_t i = 0; i < task_count; ++i) {
+        group.run([&]() {
+            ScopedSetThreadEnvironment set_env(env);
+            for (size_t j = next++; j < nodes.size(); j = next++) {
+                if (prefetch_node(graph.nodes[nodes[j]]))
+                    done(nodes[j]);
+            }
+        });
+    }
+}
+
+/**
+ * Instantiate an object along with everything it (transitively) references.
+ *
+ * The references form a directed acyclic graph, which is executed as a task
+ * graph: every object is created by a single task as soon as all objects it
+ * references are available, so that independent objects (e.g. bitmaps and
+ * meshes) are loaded concurrently, and no task ever waits on another one.
+ */
+static ref<Object> instantiate_node(XMLParseContext &ctx, const std::string &id) {
+    XMLGraph graph;
+    size_t root = add_node(ctx, graph, resolve_instance(ctx, id));
+    if (LoadTrace::enabled())
+        graph.load = LoadTrace::begin_load();
+
+    if (ctx.parallelize) {
+        /* Load all referenced plugins up front. Otherwise, the first task
+           that needs a plugin loads it while holding the plugin manager's
+           lock, and every other task creating an object waits for it. */
+        std::vector<std::string> plugins;
+        for (const XMLNode &node : graph.nodes) {
+            if (node.inst->class_->name() != "Scene")
+                plugins.push_back(node.inst->props.plugin_name());
+        }
+        std::sort(plugins.begin(), plugins.end());
+        plugins.erase(std::unique(plugins.begin(), plugins.end()), plugins.end());
+        PluginManager::instance()->preload_plugins(plugins);
+
+        ThreadEnvironment env;
+        tbb::task_group group;
+
+        std::function<void(size_t)> schedule = [&](size_t index) {
+            group.run([&, index]() {
+                ScopedSetThreadEnvironment set_env(env);
+                XMLNode &node = graph.nodes[index];
+                create_node(graph, node);
+                for (size_t dependent : node.dependents) {
+                    if (--graph.nodes[dependent].pending == 0)
+                        schedule(dependent);
+                }
+            });
+        };
+
+        // Nodes with a prefetched file additionally wait for the prefetch stage
+        std::vector<size_t> prefetched = prefetch_select(graph, false);
+        for (size_t index : prefetched)
+            graph.nodes[index].pending++;
+
+        // Collect the leaves first, counters change as soon as tasks run
+        std::vector<size_t> leaves;
+        for (size_t index : graph.order) {
+            if (graph.nodes[index].pending == 0)
+                leaves.push_back(index);
+        }
+
+        std::atomic<size_t> next { 0 };
+        prefetch_nodes(graph, prefetched, group, env, next, [&](size_t index) {
+            if (--graph.nodes[index].pending == 0)
+                schedule(index);
+        });
+        for (size_t index : leaves)
+            schedule(index);
+        group.wait();
+    } else {
+        ThreadEnvironment env;
+        tbb::task_group group;
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::atomic<size_t> next { 0 };
+
+        std::vector<size_t> prefetched = prefetch_select(graph, ctx.staged);
+        prefetch_nodes(graph, prefetched, group, env, next, [&](size_t) {
+            { std::lock_guard<std::mutex> guard(mutex); }
+            cv.notify_all();
+        });
+
+        try {
+            for (size_t index : graph.order) {
+                XMLNode &node = graph.nodes[index];
+                if (node.prefetch_bitmap) {
+                    // Decode the image right away if no task has started on it yet
+                    if (!prefetch_node(node)) {
+                        std::unique_lock<std::mutex> lock(mutex);
+                        cv.wait(lock, [&]() { return node.prefetch == PrefetchDone; });
+                    }
+                } else if (node.prefetch != PrefetchNone) {
+                    // The plugin reads the file anyway, a pending read-ahead is pointless
+                    uint32_t expected = PrefetchQueued;
+                    node.prefetch.compare_exchange_strong(expected, PrefetchDone);
+                }
+                create_node(graph, node);
+            }
+        } catch (...) {
+            group.wait();
+            throw;
+        }
+        group.wait();
+    }
+
+    if (ctx.lazy) {
+        size_t skipped = 0;
+        for (auto &kv : ctx.instances) {
+            if (kv.second.alias.empty() && !kv.second.object)
+                skipped++;
+        }
+        if (skipped > 0)
+            Log(Info, "Lazy instantiation: skipped %i unreferenced object%s.",
+                skipped, skipped > 1 ? "s" : "");
+    }
+
+    return graph.nodes[root].inst->object;
+}
+
+// -----------------------------------------------------------------------------
+//  Binary cache of the parsed scene description (see load_file())
+// -----------------------------------------------------------------------------
+
+static const char xml_cache_magic[4] = { 'M', 'X', 'M', 'L' };
+static const uint32_t xml_cache_version = 2;
+
+/**
+ * Everything apart from the contents of the scene files that influences the
+ * result of parsing: the Mitsuba version, the variant, the scene path, the
+ * parameters given on the command line and the search paths of the file
+ * resolver (which determine how <include> tags are resolved).
+ */
+static std::vector<std::string> cache_key(const fs::path &filename,
+                                          const std::string &variant,
+                                          const ParameterList &param) {
+    std::vector<std::string> key = { MTS_VERSION, variant,
+                                     fs::absolute(filename).string(),
+                                     std::to_string(param.size()) };
+    for (const auto &kv : param) {
+        key.push_back(kv.first);
+        key.push_back(kv.second);
+    }
+    for (const fs::path &path : *Thread::thread()->file_resolver())
+        key.push_back(path.string());
+    return key;
+}
+
+static void write_properties(Stream *stream, const Properties &props_) {
+    // Property lookups mark entries as queried, hence work on a copy
+    Properties props(props_);
+
+    /* Objects can only originate from inline textures at this point, these
+       are recreated from their XMLTexture recipe when loading the cache */
+    std::vector<std::string> names;
+    for (const std::string &name : props.property_names()) {
+        if (props.type(name) != Properties::Type::Object)
+            names.push_back(name);
+    }
+
+    stream->write(props.plugin_name());
+    stream->write(props.id());
+    stream->write((uint32_t) names.size());
+
+    for (const std::string &name : names) {
+        Properties::Type type = props.type(name);
+        stream->write(name);
+        stream->write((uint32_t) type);
+
+        switch (type) {
+            case Properties::Type::Bool:
+                stream->write((uint8_t) (props.bool_(name) ? 1 : 0));
+                break;
+
+            case Properties::Type::Long:
+                stream->write(props.long_(name));
+                break;
+
+            case Properties::Type::Float:
+                stream->write(props.float_(name));
+                break;
+
+            case Properties::Type::Array3f: {
+                    Properties::Array3f value = props.array3f(name);
+                    for (size_t i = 0; i < 3; ++i)
+                        stream->write(value[i]);
+                }
+                break;
+
+            case Properties::Type::Transform: {
+                    const Transform4f &trafo = props.transform(name);
+                    for (size_t i = 0; i < 4; ++i)
+                        for (size_t j = 0; j < 4; ++j)
+                            stream->write(trafo.matrix(i, j));
+                    for (size_t i = 0; i < 4; ++i)
+                        for (size_t j = 0; j < 4; ++j)
+                            stream->write(trafo.inverse_transpose(i, j));
+                }
+                break;
+
+            case Properties::Type::Color: {
+                    const Color3f &color = props.color(name);
+                    for (size_t i = 0; i < 3; ++i)
+                        stream->write(color[i]);
+                }
+                break;
+
+            case Properties::Type::String:
+                stream->write(props.string(name));
+                break;
+
+            case Properties::Type::NamedReference:
+                stream->write((const std::string &) props.named_reference(name));
+                break;
+
+            default:
+                Throw("property \"%s\" cannot be stored in the scene cache", name);
+        }
+    }
+}
+
+static Properties read_properties(Stream *stream) {
+    std::string plugin_name, id;
+    stream->read(plugin_name);
+    stream->read(id);
+
+    Properties props(plugin_name);
+    props.set_id(id);
+
+    uint32_t count;
+    stream->read(count);
+
+    for (uint32_t k = 0; k < count; ++k) {
+        std::string name;
+        uint32_t type;
+        stream->read(name);
+        stream->read(type);
+
+        switch ((Properties::Type) type) {
+            case Properties::Type::Bool: {
+                    uint8_t value;
+                    stream->read(value);
+                    props.set_bool(name, value != 0, false);
+                }
+                break;
+
+            case Properties::Type::Long: {
+                    int64_t value;
+                    stream->read(value);
+                    props.set_long(name, value, false);
+                }
+                break;
+
+            case Properties::Type::Float: {
+                    Float value;
+                    stream->read(value);
+                    props.set_float(name, value, false);
+                }
+                break;
+
+            case Properties::Type::Array3f: {
+                    Properties::Array3f value;
+                    for (size_t i = 0; i < 3; ++i)
+                        stream->read(value[i]);
+                    props.set_array3f(name, value, false);
+                }
+                break;
+
+            case Properties::Type::Transform: {
+                    Matrix4f matrix, inverse_transpose;
+                    for (size_t i = 0; i < 4; ++i)
+                        for (size_t j = 0; j < 4; ++j)
+                            stream->read(matrix(i, j));
+                    for (size_t i = 0; i < 4; ++i)
+                        for (size_t j = 0; j < 4; ++j)
+                            stream->read(inverse_transpose(i, j));
+                    props.set_transform(name, Transform4f(matrix, inverse_transpose), false);
+                }
+                break;
+
+            case Properties::Type::Color: {
+                    Color3f color;
+                    for (size_t i = 0; i < 3; ++i)
+                        stream->read(color[i]);
+                    props.set_color(name, color, false);
+                }
+                break;
+
+            case Properties::Type::String: {
+                    std::string value;
+                    stream->read(value);
+                    props.set_string(name, value, false);
+                }
+                break;
+
+            case Properties::Type::NamedReference: {
+                    std::string value;
+                    stream->read(value);
+                    props.set_named_reference(name, value, false);
+                }
+                break;
+
+            default:
+                Throw("invalid type of property \"%s\"", name);
+        }
+    }
+
+    return props;
+}
+
+/**
+ * Store the parsed scene description in a cache file, which allows
+ * subsequent calls to load_file() to skip the XML parse. Failures are not
+ * fatal and only produce a warning.
+ */
+static void write_cache(const fs::path &path, const std::vector<std::string> &key,
+                        const XMLParseContext &ctx, const std::string &scene_id) {
+    /* Write to a temporary file first so that concurrent readers never
+       observe a partially written cache */
+    fs::path tmp_path = path;
+    tmp_path.replace_extension(".tmp");
+
+    try {
+        if (!fs::exists(path.parent_path()))
+            fs::create_directory(path.parent_path());
+
+        {
+            ref<FileStream> stream = new FileStream(tmp_path, FileStream::ETruncReadWrite);
+            stream->write_array(xml_cache_magic, 4);
+            stream->write(xml_cache_version);
+            stream->write(key);
+
+            stream->write((uint32_t) ctx.dependencies.size());
+            for (const fs::path &dep : ctx.dependencies) {
+                stream->write(fs::absolute(dep).string());
+                stream->write((uint64_t) fs::file_size(dep));
+                stream->write(fs::last_write_time(dep));
+            }
+
+            stream->write((uint32_t) ctx.resource_paths.size());
+            for (const fs::path &resource_path : ctx.resource_paths)
+                stream->write(resource_path.string());
+            stream->write((uint8_t) (ctx.lazy ? 1 : 0));
+
+            stream->write(scene_id);
+            stream->write((uint32_t) ctx.instances.size());
+            for (const auto &kv : ctx.instances) {
+                const XMLObject &inst = kv.second;
+                stream->write(kv.first);
+                stream->write(inst.alias);
+                stream->write(inst.src_id);
+                stream->write((uint64_t) inst.location);
+                if (!inst.alias.empty())
+                    continue;
+
+                stream->write(inst.class_->name());
+                stream->write(inst.class_->variant());
+                write_properties(stream, inst.props);
+
+                stream->write((uint32_t) inst.textures.size());
+                for (const XMLTexture &texture : inst.textures) {
+                    stream->write(texture.name);
+                    stream->write((uint8_t) (texture.rgb ? 1 : 0));
+                    stream->write((uint8_t) (texture.within_emitter ? 1 : 0));
+                    for (size_t i = 0; i < 3; ++i)
+                        stream->write(texture.color[i]);
+                    stream->write(texture.value);
+                    stream->write(texture.wavelengths);
+                    stream->write(texture.values);
+                }
+            }
+            stream->close();
+        }
+
+        if (fs::exists(path))
+            fs::remove(path);
+        if (!fs::rename(tmp_path, path))
+            Throw("unable to rename \"%s\"", tmp_path.string());
+    } catch (const std::exception &e) {
+        Log(Warn, "Could not write scene cache file \"%s\": %s", path.string(), e.what());
+        if (fs::exists(tmp_path))
+            fs::remove(tmp_path);
+        return;
+    }
+
+    Log(Debug, "Stored the parsed scene description in \"%s\"", path.string());
+}
+
+/**
+ * Try to restore the parsed scene description from a cache file. Returns
+ * \c false if the file does not exist, was created with a different key, or
+ * if any of the files that were read while parsing has changed since.
+ */
+static bool read_cache(const fs::path &path, const std::vector<std::string> &key,
+                       XMLParseContext &ctx, std::string &scene_id) {
+    if (!fs::is_regular_file(path))
+        return false;
+
+    try {
+        ref<FileStream> stream = new FileStream(path);
+
+        char magic[4];
+        uint32_t version;
+        std::vector<std::string> key_cached;
+        stream->read_array(magic, 4);
+        stream->read(version);
+        if (memcmp(magic, xml_cache_magic, 4) != 0 || version != xml_cache_version) {
+            Log(Warn, "Ignoring incompatible scene cache file \"%s\"", path.string());
+            return false;
+        }
+        stream->read(key_cached);
+        if (key_cached != key)
+            return false;
+
+        uint32_t dependency_count;
+        stream->read(dependency_count);
+        for (uint32_t i = 0; i < dependency_count; ++i) {
+            std::string dep;
+            uint64_t size, mtime;
+            stream->read(dep);
+            stream->read(size);
+            stream->read(mtime);
+            if (!fs::is_regular_file(dep) || fs::file_size(dep) != size ||
+                fs::last_write_time(dep) != mtime) {
+                Log(Info, "Scene cache file \"%s\" is out of date (\"%s\" has changed)",
+                    path.string(), dep);
+                return false;
+            }
+        }
+
+        uint32_t resource_count;
+        stream->read(resource_count);
+        for (uint32_t i = 0; i < resource_count; ++i) {
+            std::string resource_path;
+            stream->read(resource_path);
+            ctx.resource_paths.push_back(resource_path);
+        }
+
+        uint8_t lazy;
+        stream->read(lazy);
+        ctx.lazy = lazy != 0;
+
+        stream->read(scene_id);
+
+        uint32_t instance_count;
+        stream->read(instance_count);
+        for (uint32_t i = 0; i < instance_count; ++i) {
+            std::string id;
+            uint64_t location;
+            stream->read(id);
+            XMLObject &inst = ctx.instances[id];
+            stream->read(inst.alias);
+            stream->read(inst.src_id);
+            stream->read(location);
+
+            fs::path src_path = inst.src_id;
+            inst.location = (size_t) location;
+            inst.offset = [=](ptrdiff_t pos) { return file_offset(src_path, pos); };
+            if (!inst.alias.empty())
+                continue;
+
+            std::string class_name, class_variant;
+            stream->read(class_name);
+            stream->read(class_variant);
+            inst.class_ = Class::for_name(class_name, class_variant);
+            if (!inst.class_)
+                Throw("could not retrieve class object for \"%s\" and variant \"%s\"",
+                      class_name, class_variant);
+            inst.props = read_properties(stream);
+
+            uint32_t texture_count;
+            stream->read(texture_count);
+            for (uint32_t j = 0; j < texture_count; ++j) {
+                XMLTexture texture;
+                uint8_t rgb, within_emitter;
+                stream->read(texture.name);
+                stream->read(rgb);
+                stream->read(within_emitter);
+                for (size_t k = 0; k < 3; ++k)
+                    stream->read(texture.color[k]);
+                stream->read(texture.value);
+                stream->read(texture.wavelengths);
+                stream->read(texture.values);
+                texture.rgb = rgb != 0;
+                texture.within_emitter = within_emitter != 0;
+                inst.props.set_object(texture.name, create_texture(ctx, texture), false);
+                inst.textures.push_back(std::move(texture));
+            }
+        }
+
+        if (ctx.instances.find(scene_id) == ctx.instances.end())
+            Throw("reference to unknown object \"%s\"", scene_id);
+    } catch (const std::exception &e) {
+        Log(Warn, "Could not load scene cache file \"%s\": %s", path.string(), e.what());
+        ctx.instances.clear();
+        ctx.resource_paths.clear();
+        return false;
+    }
+
+    return true;
 }
 
 ref<Object> create_texture_from_rgb(const std::string &name,
@@ -1191,9 +1998,12 @@ ref<Object> load_string(const std::string &string, const std::string &variant,
         Throw("Error while loading \"%s\" (at %s): %s", src.id,
               src.offset(result.offset), result.description());
 
-    // Make a backup copy of the FileResolver, which will be restored after parsing
+    /* Make a backup copy of the FileResolver, which will be restored after
+       parsing. The copy memoizes lookups for the duration of this load. */
     ref<FileResolver> fs_backup = Thread::thread()->file_resolver();
-    Thread::thread()->set_file_resolver(new FileResolver(*fs_backup));
+    ref<FileResolver> fs_scene = new FileResolver(*fs_backup);
+    fs_scene->set_cache_enabled(true);
+    Thread::thread()->set_file_resolver(fs_scene);
 
     try {
         pugi::xml_node root = doc.document_element();
@@ -1212,7 +2022,8 @@ ref<Object> load_string(const std::string &string, const std::string &variant,
 }
 
 ref<Object> load_file(const fs::path &filename_, const std::string &variant,
-                      ParameterList param, bool write_update) {
+                      ParameterList param, bool write_update,
+                      const fs::path &cache_dir) {
     ScopedPhase sp(ProfilerPhase::InitScene);
     fs::path filename = filename_;
     if (!fs::exists(filename))
@@ -1221,57 +2032,88 @@ ref<Object> load_file(const fs::path &filename_, const std::string &variant,
     Log(Info, "Loading XML file \"%s\" ..", filename);
     Log(Info, "Using variant \"%s\"", variant);
 
-    pugi::xml_document doc;
-    pugi::xml_parse_result result = doc.load_file(filename.native().c_str(),
-                                                  pugi::parse_default |
-                                                  pugi::parse_comments);
-
-    detail::XMLSource src {
-        filename.string(), doc,
-        [=](ptrdiff_t pos) { return detail::file_offset(filename, pos); }
-    };
-
-    if (!result) // There was a parser / file IO error
-        Throw("Error while loading \"%s\" (at %s): %s", src.id,
-              src.offset(result.offset), result.description());
+    fs::path cache_path;
+    std::vector<std::string> cache_key;
+    if (!cache_dir.empty()) {
+        cache_key = detail::cache_key(filename, variant, param);
+        char cache_name[32];
+        snprintf(cache_name, sizeof(cache_name), "%016llx.xmlcache",
+                 (unsigned long long) hash(cache_key));
+        cache_path = cache_dir / fs::path(cache_name);
+    }
 
-    // Make a backup copy of the FileResolver, which will be restored after parsing
+    /* Make a backup copy of the FileResolver, which will be restored after
+       parsing. The copy memoizes lookups for the duration of this load. */
     ref<FileResolver> fs_backup = Thread::thread()->file_resolver();
-    Thread::thread()->set_file_resolver(new FileResolver(*fs_backup));
+    ref<FileResolver> fs_scene = new FileResolver(*fs_backup);
+    fs_scene->set_cache_enabled(true);
+    Thread::thread()->set_file_resolver(fs_scene);
 
     try {
-        pugi::xml_node root = doc.document_element();
         detail::XMLParseContext ctx(variant);
-        Properties prop;
-        size_t arg_counter = 0; // Unused
-        auto scene_id = detail::parse_xml(src, ctx, root, Tag::Invalid, prop,
-                                          param, arg_counter, 0).second;
-
-        if (src.modified && write_update) {
-            fs::path backup = filename;
-            backup.replace_extension(".bak");
-            Log(Info, "Writing updated \"%s\" .. (backup at \"%s\")", filename, backup);
-            if (!fs::rename(filename, backup))
-                Throw("Unable to rename file \"%s\" to \"%s\"!", filename, backup);
-
-            // Update version number
-            root.prepend_attribute("version").set_value(MTS_VERSION);
-            if (root.attribute("type").value() == std::string("scene"))
-                root.remove_attribute("type");
-
-            // Strip anonymous IDs/names
-            for (pugi::xpath_node result2: doc.select_nodes("//*[starts-with(@id, '_unnamed_')]"))
-                result2.node().remove_attribute("id");
-            for (pugi::xpath_node result2: doc.select_nodes("//*[starts-with(@name, '_arg_')]"))
-                result2.node().remove_attribute("name");
-
-            doc.save_file(filename.native().c_str(), "    ");
+        std::string scene_id;
+        Timer timer;
+
+        if (!cache_path.empty() &&
+            detail::read_cache(cache_path, cache_key, ctx, scene_id)) {
+            Log(Info, "Loaded the parsed scene description from \"%s\"", cache_path);
+            ref<FileResolver> fs = Thread::thread()->file_resolver();
+            for (const fs::path &resource_path : ctx.resource_paths)
+                fs->prepend(resource_path);
+        } else {
+            pugi::xml_document doc;
+            pugi::xml_parse_result result = doc.load_file(filename.native().c_str(),
+                                                          pugi::parse_default |
+                                                          pugi::parse_comments);
+
+            detail::XMLSource src {
+                filename.string(), doc,
+                [=](ptrdiff_t pos) { return detail::file_offset(filename, pos); }
+            };
+
+            if (!result) // There was a parser / file IO error
+                Throw("Error while loading \"%s\" (at %s): %s", src.id,
+                      src.offset(result.offset), result.description());
+
+            ctx.dependencies.push_back(filename);
+
+            pugi::xml_node root = doc.document_element();
+            Properties prop;
+            size_t arg_counter = 0; // Unused
+            scene_id = detail::parse_xml(src, ctx, root, Tag::Invalid, prop,
+                                         param, arg_counter, 0).second;
+
+            if (src.modified && write_update) {
+                fs::path backup = filename;
+                backup.replace_extension(".bak");
+                Log(Info, "Writing updated \"%s\" .. (backup at \"%s\")", filename, backup);
+                if (!fs::rename(filename, backup))
+                    Throw("Unable to rename file \"%s\" to \"%s\"!", filename, backup);
+
+                // Update version number
+                root.prepend_attribute("version").set_value(MTS_VERSION);
+                if (root.attribute("type").value() == std::string("scene"))
+                    root.remove_attribute("type");
+
+                // Strip anonymous IDs/names
+                for (pugi::xpath_node result2: doc.select_nodes("//*[starts-with(@id, '_unnamed_')]"))
+                    result2.node().remove_attribute("id");
+                for (pugi::xpath_node result2: doc.select_nodes("//*[starts-with(@name, '_arg_')]"))
+                    result2.node().remove_attribute("name");
+
+                doc.save_file(filename.native().c_str(), "    ");
+
+                // Update for detail::file_offset
+                filename = backup;
+            }
 
-            // Update for detail::file_offset
-            filename = backup;
+            if (!cache_path.empty())
+                detail::write_cache(cache_path, cache_key, ctx, scene_id);
         }
+        Statistics::add_time("load_parse", (float) timer.reset());
 
         ref<Object> obj = detail::instantiate_node(ctx, scene_id);
+        Statistics::add_time("load_instantiate", (float) timer.value());
         Thread::thread()->set_file_resolver(fs_backup.get());
         return obj;
     } catch(...) {
@@ -1280,5 +2122,34 @@ ref<Object> load_file(const fs::path &filename_, const std::string &variant,
     }
 }
 
+ref<Object> load_properties(std::vector<std::pair<std::string, Properties>> objects,
+                            const std::string &root, const std::string &variant,
+                            const std::string &source) {
+    ScopedPhase sp(ProfilerPhase::InitScene);
+    detail::XMLParseContext ctx(variant);
+
+    for (auto &[id, props] : objects) {
+        if (ctx.instances.count(id) != 0)
+            Throw("Error while loading \"%s\": duplicate id \"%s\"", source, id);
+
+        const Class *class_;
+        if (props.plugin_name() == "scene")
+            class_ = Class::for_name("Scene", variant);
+        else
+            class_ = PluginManager::instance()->get_plugin_class(props.plugin_name(), variant);
+        if (!class_)
+            Throw("Error while loading \"%s\": could not retrieve class object for "
+                  "\"%s\" and variant \"%s\"", source, props.plugin_name(), variant);
+
+        detail::XMLObject &inst = ctx.instances[id];
+        inst.props = std::move(props);
+        inst.class_ = class_;
+        inst.src_id = source;
+        inst.offset = [id = id](ptrdiff_t) { return "\"" + id + "\""; };
+    }
+
+    return detail::instantiate_node(ctx, root);
+}
+
 NAMESPACE_END(xml)
 NAMESPACE_END(mitsuba)
@@ -1,13 +1,22 @@
 #include <mitsuba/core/zstream.h>
+#include <mitsuba/core/mstream.h>
+#include <mitsuba/core/util.h>
+#include <tbb/parallel_for.h>
+#include <atomic>
+#include <cstring>
+#include <vector>
 #include <zlib.h>
 
 NAMESPACE_BEGIN(mitsuba)
 
-ZStream::ZStream(Stream *child_stream, EStreamType stream_type, int level)
+ZStream::ZStream(Stream *child_stream, EStreamType stream_type, int level,
+                 size_t parallel_block_size)
     : m_child_stream(child_stream),
       m_deflate_stream(new z_stream()),
       m_inflate_stream(new z_stream()),
-      m_did_write(false) {
+      m_did_write(false), m_stream_type(stream_type), m_level(level),
+      m_block_size(parallel_block_size), m_checksum(0), m_total_in(0),
+      m_header_written(false) {
     m_deflate_stream->zalloc = Z_NULL;
     m_deflate_stream->zfree = Z_NULL;
     m_deflate_stream->opaque = Z_NULL;
@@ -34,6 +43,17 @@ ZStream::ZStream(Stream *child_stream, EStreamType stream_type, int level)
 void ZStream::write(const void *ptr, size_t size) {
     Assert(m_child_stream != nullptr);
 
+    if (m_block_size > 0) {
+        const uint8_t *data = (const uint8_t *) ptr;
+        m_pending.insert(m_pending.end(), data, data + size);
+        m_did_write = true;
+
+        // Accumulate enough blocks to keep all cores busy
+        if (m_pending.size() >= m_block_size * (size_t) util::core_count() * 2)
+            deflate_pending(false, false);
+        return;
+    }
+
     m_deflate_stream->avail_in = (uInt) size;
     m_deflate_stream->next_in = (uint8_t *) ptr;
 
@@ -101,7 +121,10 @@ void ZStream::read(void *ptr, size_t size) {
 void ZStream::flush() {
     Assert(m_child_stream != nullptr);
 
-    if (m_did_write) {
+    if (m_did_write && m_block_size > 0) {
+        deflate_pending(true, false);
+        m_child_stream->flush();
+    } else if (m_did_write) {
         m_deflate_stream->avail_in = 0;
         m_deflate_stream->next_in = NULL;
         int output_size = 0;
@@ -127,7 +150,9 @@ void ZStream::close() {
     if (!m_child_stream)
         return;
 
-    if (m_did_write) {
+    if (m_did_write && m_block_size > 0) {
+        deflate_pending(true, true);
+    } else if (m_did_write) {
         m_deflate_stream->avail_in = 0;
         m_deflate_stream->next_in = NULL;
         int output_size = 0;
@@ -156,6 +181,127 @@ ZStream::~ZStream() {
     close();
 }
 
+void ZStream::deflate_pending(bool partial, bool finish) {
+    /// Size of the deflate window, used to prime each block
+    constexpr size_t window_size = 32768;
+    bool gzip = m_stream_type == EGZipStream;
+
+    size_t size = m_pending.size(),
+           block_count = size / m_block_size;
+    if (partial || finish) {
+        if (block_count * m_block_size < size || (finish && block_count == 0))
+            block_count++;
+    } else {
+        size = block_count * m_block_size;
+    }
+    if (block_count == 0)
+        return;
+
+    if (!m_header_written) {
+        if (gzip) {
+            const uint8_t header[10] = { 0x1f, 0x8b, 8, 0, 0, 0, 0, 0, 0, 0xff };
+            m_child_stream->write(header, sizeof(header));
+            m_checksum = (uint32_t) crc32(0, Z_NULL, 0);
+        } else {
+            const uint8_t header[2] = { 0x78, 0x9c };
+            m_child_stream->write(header, sizeof(header));
+            m_checksum = (uint32_t) adler32(0, Z_NULL, 0);
+        }
+        m_header_written = true;
+    }
+
+    const uint8_t *data = m_pending.data();
+    std::vector<std::vector<uint8_t>> blocks(block_count);
+    std::vector<uint32_t> checksums(block_count);
+    std::atomic<int> error(Z_OK);
+
+    tbb::parallel_for(size_t(0), block_count, [&](size_t i) {
+        size_t offset = i * m_block_size,
+               in_size = std::min(m_block_size, size - offset);
+        bool last = finish && i + 1 == block_count;
+
+        z_stream z;
+        memset(&z, 0, sizeof(z_stream));
+        int retval = deflateInit2(&z, m_level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY);
+        if (retval != Z_OK) {
+            error = retval;
+            return;
+        }
+
+        // Prime the window with the preceding data for a better compression ratio
+        if (i == 0) {
+            if (!m_window.empty())
+                deflateSetDictionary(&z, m_window.data(), (uInt) m_window.size());
+        } else {
+            size_t dict_size = std::min(offset, window_size);
+            deflateSetDictionary(&z, data + offset - dict_size, (uInt) dict_size);
+        }
+
+        /* Non-final blocks end with a sync flush, which byte-aligns the output
+           without setting the final-block bit, so that they can be concatenated */
+        std::vector<uint8_t> &out = blocks[i];
+        out.resize(deflateBound(&z, (uLong) in_size) + 16);
+        z.next_in = (Bytef *) data + offset;
+        z.avail_in = (uInt) in_size;
+        size_t written = 0;
+        while (true) {
+            z.next_out = out.data() + written;
+            z.avail_out = (uInt) (out.size() - written);
+            retval = deflate(&z, last ? Z_FINISH : Z_SYNC_FLUSH);
+            written = out.size() - z.avail_out;
+            if (retval == Z_STREAM_ERROR || retval == Z_STREAM_END || z.avail_out != 0)
+                break;
+            out.resize(out.size() * 2);
+        }
+        deflateEnd(&z);
+
+        if (retval == Z_STREAM_ERROR || (last && retval != Z_STREAM_END)) {
+            error = retval == Z_OK ? Z_BUF_ERROR : retval;
+            return;
+        }
+        out.resize(written);
+
+        checksums[i] = gzip ? (uint32_t) crc32(0, data + offset, (uInt) in_size)
+                            : (uint32_t) adler32(1, data + offset, (uInt) in_size);
+    });
+
+    if (error != Z_OK)
+        Throw("deflate(): parallel compression failed (error code %i)", (int) error);
+
+    for (size_t i = 0; i < block_count; ++i) {
+        z_off_t in_size = (z_off_t) std::min(m_block_size, size - i * m_block_size);
+        m_checksum = gzip ? (uint32_t) crc32_combine(m_checksum, checksums[i], in_size)
+                          : (uint32_t) adler32_combine(m_checksum, checksums[i], in_size);
+        m_child_stream->write(blocks[i].data(), blocks[i].size());
+    }
+    m_total_in += size;
+
+    // Keep the end of the processed data to prime the next batch
+    if (size >= window_size) {
+        m_window.assign(m_pending.begin() + (size - window_size), m_pending.begin() + size);
+    } else {
+        m_window.insert(m_window.end(), m_pending.begin(), m_pending.begin() + size);
+        if (m_window.size() > window_size)
+            m_window.erase(m_window.begin(), m_window.end() - window_size);
+    }
+    m_pending.erase(m_pending.begin(), m_pending.begin() + size);
+
+    if (finish) {
+        uint8_t trailer[8];
+        if (gzip) {
+            for (int i = 0; i < 4; ++i) {
+                trailer[i]     = (uint8_t) (m_checksum >> (8 * i));
+                trailer[i + 4] = (uint8_t) (m_total_in >> (8 * i));
+            }
+            m_child_stream->write(trailer, 8);
+        } else {
+            for (int i = 0; i < 4; ++i)
+                trailer[i] = (uint8_t) (m_checksum >> (24 - 8 * i));
+            m_child_stream->write(trailer, 4);
+        }
+    }
+}
+
 std::string ZStream::to_string() const {
     std::ostringstream oss;
 
@@ -179,4 +325,121 @@ std::string ZStream::to_string() const {
 
 MTS_IMPLEMENT_CLASS(ZStream, Stream)
 
+NAMESPACE_BEGIN(compression)
+
+NAMESPACE_BEGIN(detail)
+/// Memory stream that takes ownership of its buffer
+class BlockMemoryStream final : public MemoryStream {
+public:
+    BlockMemoryStream(std::unique_ptr<uint8_t[]> data, size_t size)
+        : MemoryStream(data.get(), size), m_data(std::move(data)) { }
+
+private:
+    std::unique_ptr<uint8_t[]> m_data;
+};
+NAMESPACE_END(detail)
+
+void write_blocks(Stream *stream, const void *data_, size_t size, Codec codec,
+                  size_t block_size, int level) {
+    if (block_size == 0)
+        Throw("write_blocks(): block size must be positive!");
+    if (codec != Codec::Stored && codec != Codec::Deflate)
+        Throw("write_blocks(): unsupported codec %i!", (uint32_t) codec);
+
+    const uint8_t *data = (const uint8_t *) data_;
+    size_t block_count = (size + block_size - 1) / block_size;
+    std::vector<std::vector<uint8_t>> blocks(block_count);
+    std::atomic<int> error(Z_OK);
+
+    if (codec == Codec::Deflate) {
+        tbb::parallel_for(size_t(0), block_count, [&](size_t i) {
+            size_t offset = i * block_size,
+                   in_size = std::min(block_size, size - offset);
+            uLongf out_size = compressBound((uLong) in_size);
+            blocks[i].resize(out_size);
+            int retval = compress2(blocks[i].data(), &out_size, data + offset,
+                                   (uLong) in_size, level);
+            if (retval != Z_OK)
+                error = retval;
+            blocks[i].resize(out_size);
+        });
+
+        if (error != Z_OK)
+            Throw("write_blocks(): compression failed (error code %i)", (int) error);
+    }
+
+    stream->write((uint32_t) codec);
+    stream->write((uint32_t) block_count);
+    stream->write((uint64_t) size);
+    stream->write((uint64_t) block_size);
+
+    for (size_t i = 0; i < block_count; ++i) {
+        size_t compressed_size = codec == Codec::Stored
+            ? std::min(block_size, size - i * block_size) : blocks[i].size();
+        stream->write((uint64_t) compressed_size);
+    }
+
+    for (size_t i = 0; i < block_count; ++i) {
+        if (codec == Codec::Stored)
+            stream->write(data + i * block_size, std::min(block_size, size - i * block_size));
+        else
+            stream->write(blocks[i].data(), blocks[i].size());
+    }
+}
+
+ref<Stream> read_blocks(Stream *stream) {
+    uint32_t codec = 0, block_count = 0;
+    uint64_t size = 0, block_size = 0;
+    stream->read(codec);
+    stream->read(block_count);
+    stream->read(size);
+    stream->read(block_size);
+
+    if (codec != (uint32_t) Codec::Stored && codec != (uint32_t) Codec::Deflate)
+        Throw("read_blocks(): unsupported codec %i!", codec);
+    if (block_size == 0 || (size + block_size - 1) / block_size != block_count)
+        Throw("read_blocks(): invalid block table!");
+
+    std::vector<uint64_t> offsets(block_count + 1, 0);
+    for (uint32_t i = 0; i < block_count; ++i) {
+        uint64_t compressed_size = 0;
+        stream->read(compressed_size);
+        offsets[i + 1] = offsets[i] + compressed_size;
+    }
+
+    std::unique_ptr<uint8_t[]> compressed(new uint8_t[offsets[block_count]]);
+    stream->read(compressed.get(), offsets[block_count]);
+
+    std::unique_ptr<uint8_t[]> data(new uint8_t[size]);
+    std::atomic<bool> error(false);
+
+    tbb::parallel_for(size_t(0), (size_t) block_count, [&](size_t i) {
+        uint8_t *out = data.get() + i * block_size;
+        const uint8_t *in = compressed.get() + offsets[i];
+        size_t out_size = std::min(block_size, size - i * block_size),
+               in_size = offsets[i + 1] - offsets[i];
+
+        if (codec == (uint32_t) Codec::Stored) {
+            if (in_size != out_size)
+                error = true;
+            else
+                memcpy(out, in, out_size);
+        } else {
+            uLongf dest_size = (uLongf) out_size;
+            int retval = uncompress(out, &dest_size, in, (uLong) in_size);
+            if (retval != Z_OK || dest_size != out_size)
+                error = true;
+        }
+    });
+
+    if (error)
+        Throw("read_blocks(): data error!");
+
+    ref<Stream> result = new detail::BlockMemoryStream(std::move(data), size);
+    result->set_byte_order(stream->byte_order());
+    return result;
+}
+
+NAMESPACE_END(compression)
+
 NAMESPACE_END(mitsuba)
@@ -0,0 +1,440 @@
+#include <mitsuba/render/bvh.h>
+#include <mitsuba/core/memreport.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/timer.h>
+#include <mitsuba/core/util.h>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_invoke.h>
+#include <tbb/parallel_reduce.h>
+#include <algorithm>
+
+NAMESPACE_BEGIN(mitsuba)
+
+MTS_VARIANT struct ShapeBVH<Float, Spectrum>::BuildNode {
+    ScalarBoundingBox3f bbox;
+    std::unique_ptr<BuildNode> left, right;
+    Index prim_offset = 0, prim_count = 0;
+
+    bool leaf() const { return !left; }
+};
+
+MTS_VARIANT ShapeBVH<Float, Spectrum>::ShapeBVH(const Properties &props) {
+    /* BVH construction: Number of bins used by the binned SAH builder */
+    m_bin_count = (uint32_t) props.int_("bvh_bins", 16);
+
+    /* BVH construction: A node containing this many or fewer primitives will
+       not be split */
+    m_max_leaf_size = (uint32_t) props.int_("bvh_max_leaf_size", 4);
+
+    /* BVH construction: Relative cost of a node traversal operation in the
+       surface area heuristic. */
+    m_traversal_cost = props.float_("bvh_traversal_cost", 1.f);
+
+    /* BVH construction: Relative cost of a shape intersection operation in
+       the surface area heuristic. */
+    m_intersection_cost = props.float_("bvh_intersection_cost", 1.f);
+
+    if (m_bin_count < 2)
+        Throw("The BVH builder requires at least two bins!");
+    if (m_max_leaf_size < 1)
+        Throw("The maximum BVH leaf size must be at least one!");
+
+    m_primitive_map.push_back(0);
+}
+
+MTS_VARIANT void ShapeBVH<Float, Spectrum>::add_shape(Shape *shape) {
+    Assert(m_nodes.empty());
+    m_primitive_map.push_back(m_primitive_map.back() +
+                              shape->primitive_count());
+    m_shapes.push_back(shape);
+    m_bbox.expand(shape->bbox());
+}
+
+MTS_VARIANT void ShapeBVH<Float, Spectrum>::build() {
+    Timer timer;
+    Log(Info, "Building a binned SAH BVH (%i primitives) ..",
+        primitive_count());
+
+    Size prim_count = primitive_count();
+    m_nodes.clear();
+    m_indices.clear();
+    if (prim_count == 0)
+        return;
+
+    std::vector<BuildPrimitive> prims(prim_count);
+    tbb::parallel_for(
+        tbb::blocked_range<Size>(0u, prim_count, MTS_BVH_GRAIN_SIZE),
+        [&](const tbb::blocked_range<Size> &range) {
+            for (Size i = range.begin(); i != range.end(); ++i) {
+                BuildPrimitive &prim = prims[i];
+                prim.bbox = bbox(i);
+                prim.center = prim.bbox.center();
+                prim.index = i;
+            }
+        }
+    );
+
+    m_build_prims = prims.data();
+    std::unique_ptr<BuildNode> root =
+        build_recursive(prims.data(), prims.data() + prim_count, 0);
+    m_build_prims = nullptr;
+
+    // Leaves reference contiguous ranges of the partitioned primitive array
+    m_indices.resize(prim_count);
+    for (Size i = 0; i < prim_count; ++i)
+        m_indices[i] = prims[i].index;
+
+    if (root->leaf()) {
+        // Wrap a single leaf into an inner node
+        auto node = std::make_unique<BuildNode>();
+        node->bbox = root->bbox;
+        node->left = std::move(root);
+        root = std::move(node);
+    }
+    collapse(root.get());
+    m_nodes.shrink_to_fit();
+
+    Log(Info, "Finished. (%s of storage, %i nodes, took %s)",
+        util::mem_string(m_indices.size() * sizeof(Index) +
+                         m_nodes.size() * sizeof(BVHNode)),
+        m_nodes.size(),
+        util::time_string(timer.value())
+    );
+}
+
+MTS_VARIANT void ShapeBVH<Float, Spectrum>::update() {
+    bool same_topology = true;
+    for (size_t i = 0; i < m_shapes.size(); ++i) {
+        if (m_primitive_map[i + 1] - m_primitive_map[i] != m_shapes[i]->primitive_count()) {
+            same_topology = false;
+            break;
+        }
+    }
+
+    m_bbox.reset();
+    for (const Shape *shape : m_shapes)
+        m_bbox.expand(shape->bbox());
+
+    if (!same_topology || m_nodes.empty()) {
+        m_primitive_map.resize(1);
+        for (const Shape *shape : m_shapes)
+            m_primitive_map.push_back(m_primitive_map.back() + shape->primitive_count());
+        build();
+        return;
+    }
+
+    Timer timer;
+
+    /* Children are always stored after their parent, hence a reverse sweep
+       visits them before the nodes referencing them */
+    for (size_t n = m_nodes.size(); n-- > 0; ) {
+        BVHNode &node = m_nodes[n];
+
+        for (size_t i = 0; i < Width; ++i) {
+            if (node.child[i] == InvalidNode)
+                continue;
+
+            ScalarBoundingBox3f bbox;
+            if (node.prim_count[i] > 0) {
+                Index prim_start = node.child[i],
+                      prim_end   = prim_start + node.prim_count[i];
+                for (Index j = prim_start; j < prim_end; ++j)
+                    bbox.expand(this->bbox(m_indices[j]));
+            } else {
+                const BVHNode &child = m_nodes[node.child[i]];
+                for (size_t j = 0; j < Width; ++j) {
+                    for (size_t k = 0; k < 3; ++k) {
+                        bbox.min[k] = std::min(bbox.min[k], child.bounds[0][k][j]);
+                        bbox.max[k] = std::max(bbox.max[k], child.bounds[1][k][j]);
+                    }
+                }
+            }
+
+            for (size_t k = 0; k < 3; ++k) {
+                node.bounds[0][k][i] = bbox.min[k];
+                node.bounds[1][k][i] = bbox.max[k];
+            }
+        }
+    }
+
+    Log(Info, "Refit the BVH (%i primitives, took %s)", primitive_count(),
+        util::time_string(timer.value()));
+}
+
+MTS_VARIANT std::unique_ptr<typename ShapeBVH<Float, Spectrum>::BuildNode>
+ShapeBVH<Float, Spectrum>::build_recursive(BuildPrimitive *begin,
+                                           BuildPrimitive *end,
+                                           size_t depth) {
+    using ScalarBoundingBox2 = std::pair<ScalarBoundingBox3f, ScalarBoundingBox3f>;
+
+    /// Per-axis bin statistics
+    struct Bins {
+        std::vector<ScalarBoundingBox3f> bbox[3];
+        std::vector<Size> count[3];
+
+        Bins(uint32_t bin_count) {
+            for (int k = 0; k < 3; ++k) {
+                bbox[k].resize(bin_count);
+                count[k].resize(bin_count, 0u);
+            }
+        }
+
+        void merge(const Bins &other) {
+            for (int k = 0; k < 3; ++k) {
+                for (size_t i = 0; i < bbox[k].size(); ++i) {
+                    bbox[k][i].expand(other.bbox[k][i]);
+                    count[k][i] += other.count[k][i];
+                }
+            }
+        }
+    };
+
+    size_t count = (size_t) (end - begin);
+    bool parallel = count > MTS_BVH_GRAIN_SIZE;
+
+    // Compute the node and centroid bounds
+    auto bounds_func = [](const BuildPrimitive *b, const BuildPrimitive *e,
+                          ScalarBoundingBox2 result) {
+        for (const BuildPrimitive *p = b; p != e; ++p) {
+            result.first.expand(p->bbox);
+            result.second.expand(p->center);
+        }
+        return result;
+    };
+
+    ScalarBoundingBox2 bounds;
+    if (parallel) {
+        bounds = tbb::parallel_reduce(
+            tbb::blocked_range<size_t>(0, count, MTS_BVH_GRAIN_SIZE),
+            ScalarBoundingBox2(),
+            [&](const tbb::blocked_range<size_t> &range, ScalarBoundingBox2 result) {
+                return bounds_func(begin + range.begin(), begin + range.end(), result);
+            },
+            [](ScalarBoundingBox2 a, const ScalarBoundingBox2 &b) {
+                a.first.expand(b.first);
+                a.second.expand(b.second);
+                return a;
+            }
+        );
+    } else {
+        bounds = bounds_func(begin, end, ScalarBoundingBox2());
+    }
+
+    auto node = std::make_unique<BuildNode>();
+    node->bbox = bounds.first;
+
+    auto make_leaf = [&]() {
+        node->prim_offset = Index(begin - m_build_prims);
+        node->prim_count = Index(count);
+        return std::move(node);
+    };
+
+    const ScalarBoundingBox3f &cbox = bounds.second;
+    ScalarVector3f extents = cbox.extents();
+
+    if (count <= m_max_leaf_size || depth + 1 >= MTS_BVH_MAXDEPTH ||
+        hmax(extents) <= 0.f)
+        return make_leaf();
+
+    // Bin the primitive centroids along all three axes
+    ScalarVector3f scale(0.f);
+    for (int k = 0; k < 3; ++k) {
+        if (extents[k] > 0.f)
+            scale[k] = ScalarFloat(m_bin_count) * (1.f - math::Epsilon<ScalarFloat>) / extents[k];
+    }
+
+    auto bin_index = [&](const BuildPrimitive &p, int axis) {
+        uint32_t index = (uint32_t) ((p.center[axis] - cbox.min[axis]) * scale[axis]);
+        return std::min(index, m_bin_count - 1);
+    };
+
+    auto bin_func = [&](const BuildPrimitive *b, const BuildPrimitive *e, Bins &bins) {
+        for (const BuildPrimitive *p = b; p != e; ++p) {
+            for (int k = 0; k < 3; ++k) {
+                uint32_t index = bin_index(*p, k);
+                bins.bbox[k][index].expand(p->bbox);
+                bins.count[k][index]++;
+            }
+        }
+    };
+
+    Bins bins(m_bin_count);
+    if (parallel) {
+        bins = tbb::parallel_reduce(
+            tbb::blocked_range<size_t>(0, count, MTS_BVH_GRAIN_SIZE),
+            Bins(m_bin_count),
+            [&](const tbb::blocked_range<size_t> &range, Bins result) {
+                bin_func(begin + range.begin(), begin + range.end(), result);
+                return result;
+            },
+            [](Bins a, const Bins &b) {
+                a.merge(b);
+                return a;
+            }
+        );
+    } else {
+        bin_func(begin, end, bins);
+    }
+
+    // Sweep over the bins to find the split plane with the lowest SAH cost
+    ScalarFloat best_cost = math::Infinity<ScalarFloat>;
+    int best_axis = -1;
+    uint32_t best_split = 0;
+    std::vector<ScalarFloat> right_area(m_bin_count);
+    std::vector<Size> right_count(m_bin_count);
+
+    for (int k = 0; k < 3; ++k) {
+        if (extents[k] <= 0.f)
+            continue;
+
+        ScalarBoundingBox3f bbox;
+        Size n = 0;
+        for (uint32_t i = m_bin_count - 1; i > 0; --i) {
+            bbox.expand(bins.bbox[k][i]);
+            n += bins.count[k][i];
+            right_area[i] = n > 0 ? bbox.surface_area() : 0.f;
+            right_count[i] = n;
+        }
+
+        bbox.reset();
+        n = 0;
+        for (uint32_t i = 1; i < m_bin_count; ++i) {
+            bbox.expand(bins.bbox[k][i - 1]);
+            n += bins.count[k][i - 1];
+            if (n == 0 || right_count[i] == 0)
+                continue;
+
+            ScalarFloat cost = bbox.surface_area() * n + right_area[i] * right_count[i];
+            if (cost < best_cost) {
+                best_cost = cost;
+                best_axis = k;
+                best_split = i;
+            }
+        }
+    }
+
+    BuildPrimitive *middle = nullptr;
+    if (best_axis >= 0) {
+        ScalarFloat node_area = node->bbox.surface_area(),
+                    split_cost = m_traversal_cost + m_intersection_cost * best_cost /
+                                 node_area,
+                    leaf_cost = m_intersection_cost * ScalarFloat(count);
+
+        // Small nodes that are not worth splitting become leaves
+        if (split_cost >= leaf_cost && count <= Width * m_max_leaf_size)
+            return make_leaf();
+
+        middle = std::partition(begin, end, [&](const BuildPrimitive &p) {
+            return bin_index(p, best_axis) < best_split;
+        });
+    }
+
+    if (middle == nullptr || middle == begin || middle == end) {
+        // Fall back to a median split along the largest axis
+        int axis = (int) cbox.major_axis();
+        middle = begin + count / 2;
+        std::nth_element(begin, middle, end,
+            [axis](const BuildPrimitive &a, const BuildPrimitive &b) {
+                return a.center[axis] < b.center[axis];
+            });
+    }
+
+    if (parallel) {
+        tbb::parallel_invoke(
+            [&] { node->left  = build_recursive(begin, middle, depth + 1); },
+            [&] { node->right = build_recursive(middle, end, depth + 1); }
+        );
+    } else {
+        node->left  = build_recursive(begin, middle, depth + 1);
+        node->right = build_recursive(middle, end, depth + 1);
+    }
+
+    return node;
+}
+
+MTS_VARIANT typename ShapeBVH<Float, Spectrum>::Index
+ShapeBVH<Float, Spectrum>::collapse(const BuildNode *node) {
+    Assert(!node->leaf());
+
+    /* Gather up to 'Width' children by repeatedly opening the inner child
+       with the largest surface area */
+    const BuildNode *children[Width];
+    size_t child_count = 0;
+    children[child_count++] = node->left.get();
+    if (node->right)
+        children[child_count++] = node->right.get();
+
+    while (child_count < Width) {
+        int largest = -1;
+        ScalarFloat largest_area = -1.f;
+        for (size_t i = 0; i < child_count; ++i) {
+            if (children[i]->leaf())
+                continue;
+            ScalarFloat area = children[i]->bbox.surface_area();
+            if (area > largest_area) {
+                largest_area = area;
+                largest = (int) i;
+            }
+        }
+
+        if (largest < 0)
+            break;
+
+        const BuildNode *child = children[largest];
+        children[largest] = child->left.get();
+        children[child_count++] = child->right.get();
+    }
+
+    Index index = Index(m_nodes.size());
+    m_nodes.emplace_back();
+
+    for (size_t i = 0; i < Width; ++i) {
+        ScalarBoundingBox3f bbox;
+        Index child = InvalidNode, prim_count = 0;
+
+        if (i < child_count) {
+            const BuildNode *c = children[i];
+            bbox = c->bbox;
+            if (c->leaf()) {
+                child = c->prim_offset;
+                prim_count = c->prim_count;
+            } else {
+                // Note: may reallocate 'm_nodes'
+                child = collapse(c);
+            }
+        }
+
+        BVHNode &n = m_nodes[index];
+        for (size_t k = 0; k < 3; ++k) {
+            n.bounds[0][k][i] = bbox.min[k];
+            n.bounds[1][k][i] = bbox.max[k];
+        }
+        n.child[i] = child;
+        n.prim_count[i] = prim_count;
+    }
+
+    return index;
+}
+
+MTS_VARIANT std::string ShapeBVH<Float, Spectrum>::to_string() const {
+    std::ostringstream oss;
+    oss << "ShapeBVH[" << std::endl
+        << "  node_count = " << m_nodes.size() << "," << std::endl
+        << "  shapes = [" << std::endl;
+    for (auto shape : m_shapes)
+        oss << "    " << string::indent(shape, 4)
+            << "," << std::endl;
+    oss << "  ]" << std::endl << "]";
+    return oss.str();
+}
+
+MTS_VARIANT void ShapeBVH<Float, Spectrum>::account_memory(MemoryReport *report) const {
+    report->add(MemoryCategory::Acceleration,
+                m_nodes.size() * sizeof(BVHNode) + m_indices.size() * sizeof(Index) +
+                m_primitive_map.size() * sizeof(Size));
+}
+
+MTS_IMPLEMENT_CLASS_VARIANT(ShapeBVH, Object)
+MTS_INSTANTIATE_CLASS(ShapeBVH)
+NAMESPACE_END(mitsuba)
@@ -7,6 +7,24 @@ NAMESPACE_BEGIN(mitsuba)
 MTS_VARIANT Emitter<Float, Spectrum>::Emitter(const Properties &props) : Base(props) { }
 MTS_VARIANT Emitter<Float, Spectrum>::~Emitter() { }
 
+MTS_VARIANT scalar_t<Float> Emitter<Float, Spectrum>::power() const {
+    NotImplementedError("power");
+}
+
+MTS_VARIANT std::pair<typename Emitter<Float, Spectrum>::DirectionSample3f, Spectrum>
+Emitter<Float, Spectrum>::sample_direction_lobe(const Interaction3f &ref, const Point2f &sample,
+                                                const Vector3f & /* lobe_axis */,
+                                                Float /* lobe_exponent */, Mask active) const {
+    return sample_direction(ref, sample, active);
+}
+
+MTS_VARIANT Float
+Emitter<Float, Spectrum>::pdf_direction_lobe(const Interaction3f &ref, const DirectionSample3f &ds,
+                                             const Vector3f & /* lobe_axis */,
+                                             Float /* lobe_exponent */, Mask active) const {
+    return pdf_direction(ref, ds, active);
+}
+
 MTS_IMPLEMENT_CLASS_VARIANT(Emitter, Endpoint, "emitter")
 MTS_INSTANTIATE_CLASS(Emitter)
 NAMESPACE_END(mitsuba)
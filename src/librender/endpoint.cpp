@@ -59,6 +59,13 @@ MTS_VARIANT Float Endpoint<Float, Spectrum>::pdf_direction(const Interaction3f &
     NotImplementedError("pdf_direction");
 }
 
+MTS_VARIANT std::pair<Float, Float>
+Endpoint<Float, Spectrum>::pdf_ray(const PositionSample3f & /*ps*/,
+                                   const Vector3f & /*d*/,
+                                   Mask /*active*/) const {
+    NotImplementedError("pdf_ray");
+}
+
 MTS_VARIANT Spectrum Endpoint<Float, Spectrum>::eval(const SurfaceInteraction3f & /*si*/,
                                                      Mask /*active*/) const {
     NotImplementedError("eval");
@@ -1,10 +1,21 @@
 #include <mitsuba/render/film.h>
+#include <mitsuba/core/bitmap.h>
 #include <mitsuba/core/plugin.h>
 #include <mitsuba/core/properties.h>
+#include <mitsuba/core/string.h>
+#include <mitsuba/render/imageblock.h>
+#include <tbb/enumerable_thread_specific.h>
+#include <algorithm>
+#include <cctype>
 
 NAMESPACE_BEGIN(mitsuba)
 
-MTS_VARIANT Film<Float, Spectrum>::Film(const Properties &props) : Object() {
+MTS_VARIANT struct Film<Float, Spectrum>::SplatBlocks {
+    tbb::enumerable_thread_specific<ref<ImageBlock>> blocks;
+};
+
+MTS_VARIANT Film<Float, Spectrum>::Film(const Properties &props)
+    : Object(), m_splats(new SplatBlocks()) {
     bool is_m_film = string::to_lower(props.plugin_name()) == "mfilm";
 
     // Horizontal and vertical film resolution in pixels
@@ -31,6 +42,14 @@ MTS_VARIANT Film<Float, Spectrum>::Film(const Properties &props) : Object() {
        large reconstruction filters. */
     m_high_quality_edges = props.bool_("high_quality_edges", false);
 
+    /* If set to true, samples are accumulated per pixel and the reconstruction
+       filter is applied when developing the film. */
+    m_deferred_filter = props.bool_("deferred_filter", false);
+
+    /* AOVs (e.g. depth) whose samples are stored in the pixel containing them
+       instead of being blended by the reconstruction filter */
+    m_unfiltered_aovs = string::tokenize(props.string("unfiltered_aovs", ""), ", ");
+
     // Use the provided reconstruction filter, if any.
     for (auto &[name, obj] : props.objects(false)) {
         auto *rfilter = dynamic_cast<ReconstructionFilter *>(obj.get());
@@ -47,10 +66,141 @@ MTS_VARIANT Film<Float, Spectrum>::Film(const Properties &props) : Object() {
         m_filter =
             PluginManager::instance()->create_object<ReconstructionFilter>(Properties("gaussian"));
     }
+
+    if (m_deferred_filter)
+        m_box_filter =
+            PluginManager::instance()->create_object<ReconstructionFilter>(Properties("box"));
 }
 
 MTS_VARIANT Film<Float, Spectrum>::~Film() {}
 
+MTS_VARIANT fs::path Film<Float, Spectrum>::destination_file() const { return { }; }
+
+MTS_VARIANT ref<Bitmap> Film<Float, Spectrum>::snapshot() {
+    NotImplementedError("snapshot");
+}
+
+MTS_VARIANT void Film<Float, Spectrum>::restore(const Bitmap * /* snapshot */) {
+    NotImplementedError("restore");
+}
+
+MTS_VARIANT std::vector<bool>
+Film<Float, Spectrum>::unfiltered_channels(const std::vector<std::string> &channels) const {
+    std::vector<bool> result(channels.size(), false);
+    std::vector<uint32_t> ids = id_channels(channels);
+    bool found = false;
+
+    for (size_t i = 0; i < channels.size(); ++i) {
+        const std::string &name = channels[i];
+        if (name == "W.unfiltered") {
+            result[i] = true;
+            continue;
+        } else if (!ids.empty() && ids[i] != 0) {
+            result[i] = found = true;
+            continue;
+        }
+
+        // The AOV name precedes the first dot (e.g. "nn" in "nn.X")
+        std::string aov = name.substr(0, name.find('.'));
+        if (std::find(m_unfiltered_aovs.begin(), m_unfiltered_aovs.end(), aov) !=
+            m_unfiltered_aovs.end())
+            result[i] = found = true;
+    }
+
+    if (!found)
+        result.clear();
+    return result;
+}
+
+MTS_VARIANT void Film<Float, Spectrum>::add_id_layer(const std::string &name,
+                                                     const std::string &manifest) {
+    for (auto &layer : m_id_layers) {
+        if (layer.first == name) {
+            layer.second = manifest;
+            return;
+        }
+    }
+    m_id_layers.emplace_back(name, manifest);
+}
+
+MTS_VARIANT std::vector<uint32_t>
+Film<Float, Spectrum>::id_channels(const std::vector<std::string> &channels) const {
+    std::vector<uint32_t> result(channels.size(), 0u);
+    bool found = false;
+
+    for (size_t i = 0; i < channels.size(); ++i) {
+        // The channels of layer 'name' are called "nameXY.R" etc. (XY: rank / 2)
+        const std::string &channel = channels[i];
+        std::string prefix = channel.substr(0, channel.find('.'));
+        for (size_t j = 0; j < m_id_layers.size(); ++j) {
+            const std::string &name = m_id_layers[j].first;
+            if (prefix.size() == name.size() + 2 && prefix.compare(0, name.size(), name) == 0 &&
+                std::isdigit((unsigned char) prefix[name.size()]) &&
+                std::isdigit((unsigned char) prefix[name.size() + 1])) {
+                result[i] = (uint32_t) j + 1;
+                found = true;
+            }
+        }
+    }
+
+    if (!found)
+        result.clear();
+    return result;
+}
+
+MTS_VARIANT void Film<Float, Spectrum>::set_priority_map(const Bitmap *map) {
+    ref<Bitmap> priorities;
+    if (map) {
+        if (map->width() == 0 || map->height() == 0)
+            Throw("Film::set_priority_map(): the priority map is empty!");
+        // Only keep the (unmodified) values of the first channel
+        ref<Bitmap> converted = map->convert(map->pixel_format(), Struct::Type::Float32,
+                                             map->srgb_gamma());
+        priorities = new Bitmap(Bitmap::PixelFormat::Y, Struct::Type::Float32, map->size());
+        const float *source = (const float *) converted->data();
+        float *target = (float *) priorities->data();
+        size_t channel_count = converted->channel_count();
+        for (size_t i = 0, n = map->pixel_count(); i < n; ++i)
+            target[i] = source[i * channel_count];
+    }
+
+    std::lock_guard<std::mutex> lock(m_priority_mutex);
+    m_priority_map = priorities;
+}
+
+MTS_VARIANT ref<Bitmap> Film<Float, Spectrum>::priority_map() const {
+    std::lock_guard<std::mutex> lock(m_priority_mutex);
+    return m_priority_map;
+}
+
+MTS_VARIANT typename Film<Float, Spectrum>::ImageBlock *Film<Float, Spectrum>::splat_block() {
+    ref<ImageBlock> &block = m_splats->blocks.local();
+
+    // Blocks are (re-)initialized lazily, e.g. after the crop window changed
+    if (unlikely(!block || any(neq(block->size(), m_crop_size)) ||
+                 any(neq(block->offset(), m_crop_offset)))) {
+        if (!block)
+            block = new ImageBlock(m_crop_size, 5, sample_filter(), false);
+        else
+            block->set_size(m_crop_size);
+        block->set_offset(m_crop_offset);
+        block->clear();
+    }
+
+    return block;
+}
+
+MTS_VARIANT void Film<Float, Spectrum>::configure_block(ImageBlock * /* block */) const { }
+
+MTS_VARIANT void Film<Float, Spectrum>::merge_splats() {
+    for (ref<ImageBlock> &block : m_splats->blocks) {
+        if (!block)
+            continue;
+        put(block);
+        block->clear();
+    }
+}
+
 MTS_VARIANT void Film<Float, Spectrum>::set_crop_window(const ScalarPoint2i &crop_offset,
                                                         const ScalarVector2i &crop_size) {
     if (any(crop_offset < 0 || crop_size <= 0 || crop_offset + crop_size > m_size))
@@ -69,6 +219,8 @@ MTS_VARIANT std::string Film<Float, Spectrum>::to_string() const {
         << "  crop_size = "   << m_crop_size   << "," << std::endl
         << "  crop_offset = " << m_crop_offset << "," << std::endl
         << "  high_quality_edges = " << m_high_quality_edges << "," << std::endl
+        << "  deferred_filter = " << m_deferred_filter << "," << std::endl
+        << "  unfiltered_aovs = " << m_unfiltered_aovs << "," << std::endl
         << "  m_filter = " << m_filter << std::endl
         << "]";
     return oss.str();
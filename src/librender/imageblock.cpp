@@ -1,6 +1,9 @@
 #include <mitsuba/render/imageblock.h>
 #include <mitsuba/core/bitmap.h>
+#include <mitsuba/core/memreport.h>
 #include <mitsuba/core/profiler.h>
+#include <algorithm>
+#include <limits>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -9,8 +12,11 @@ ImageBlock<Float, Spectrum>::ImageBlock(const ScalarVector2i &size, size_t chann
                                         const ReconstructionFilter *filter, bool warn_negative,
                                         bool warn_invalid, bool border, bool normalize)
     : m_offset(0), m_size(0), m_channel_count((uint32_t) channel_count), m_filter(filter),
-      m_weights_x(nullptr), m_weights_y(nullptr), m_warn_negative(warn_negative),
-      m_warn_invalid(warn_invalid), m_normalize(normalize) {
+      m_weights_x(nullptr), m_weights_y(nullptr), m_filter_taps(0),
+      m_warn_negative(warn_negative),
+      m_warn_invalid(warn_invalid), m_normalize(normalize), m_deep_samples(0),
+      m_wavefront_spp(0), m_wavefront_max_gathers(0), m_wavefront_tile(0), m_depth_channel(0),
+      m_deep_merge_tolerance(0.f) {
     m_border_size = (uint32_t)((filter != nullptr && border) ? filter->border_size() : 0);
 
     if (filter) {
@@ -18,8 +24,40 @@ ImageBlock<Float, Spectrum>::ImageBlock(const ScalarVector2i &size, size_t chann
         int filter_size = (int) std::ceil(2 * filter->radius()) + 1;
         m_weights_x = new Float[2 * filter_size];
         m_weights_y = m_weights_x + filter_size;
+
+        if constexpr (!is_cuda_array_v<Float>) {
+            /* The weights of the footprint along each axis only depend on the
+               offset of the sample relative to the first pixel it overlaps.
+               For radii that are a multiple of 0.5, the discretized filter is
+               constant on the sub-pixel intervals of the table below, which
+               therefore reproduces 'eval_discretized' exactly. */
+            ScalarFloat radius = filter->radius();
+            if (radius > .5f + math::RayEpsilon<ScalarFloat> &&
+                std::abs(2.f * radius - std::round(2.f * radius)) < 4.f * math::RayEpsilon<ScalarFloat>) {
+                uint32_t n = ceil2int<uint32_t>((radius - 2.f * math::RayEpsilon<ScalarFloat>) * 2.f);
+                m_filter_taps = n;
+                m_filter_table.resize(MTS_FILTER_OFFSET_RESOLUTION * n);
+
+                for (uint32_t j = 0; j < MTS_FILTER_OFFSET_RESOLUTION; ++j) {
+                    ScalarFloat *weights = m_filter_table.data() + j * n,
+                                offset = (j + .5f) / MTS_FILTER_OFFSET_RESOLUTION - radius,
+                                sum = 0.f;
+
+                    for (uint32_t i = 0; i < n; ++i) {
+                        weights[i] = scalar_cast(hmax(filter->eval_discretized(Float(offset + i))));
+                        sum += weights[i];
+                    }
+
+                    if (normalize && sum != 0.f) {
+                        for (uint32_t i = 0; i < n; ++i)
+                            weights[i] /= sum;
+                    }
+                }
+            }
+        }
     }
 
+    m_filtered_ranges.emplace_back(0u, m_channel_count);
     set_size(size);
 }
 
@@ -36,14 +74,169 @@ MTS_VARIANT void ImageBlock<Float, Spectrum>::clear() {
         memset(m_data.data(), 0, size * sizeof(ScalarFloat));
     else
         m_data = zero<DynamicBuffer<Float>>(size);
+    std::fill(m_deep.begin(), m_deep.end(), 0.f);
+}
+
+MTS_VARIANT void
+ImageBlock<Float, Spectrum>::set_unfiltered_channels(const std::vector<bool> &unfiltered,
+                                                     const std::vector<uint32_t> &id_layers) {
+    m_filtered_ranges.clear();
+    m_unfiltered_ranges.clear();
+    m_id_ranges.clear();
+    if (unfiltered.empty()) {
+        m_filtered_ranges.emplace_back(0u, m_channel_count);
+        return;
+    }
+
+    if (unfiltered.size() != m_channel_count || !unfiltered.back())
+        Throw("ImageBlock::set_unfiltered_channels(): expected %i flags, including the "
+              "sample count in the last channel!", m_channel_count);
+    if (!id_layers.empty() && id_layers.size() != m_channel_count)
+        Throw("ImageBlock::set_unfiltered_channels(): expected %i ID layer numbers!",
+              m_channel_count);
+
+    auto layer = [&](uint32_t i) { return id_layers.empty() ? 0u : id_layers[i]; };
+
+    // Group the channels into ranges, which are splatted in one go
+    for (uint32_t i = 0; i < m_channel_count; ) {
+        uint32_t j = i + 1;
+        while (j < m_channel_count && unfiltered[j] == unfiltered[i] && layer(j) == layer(i))
+            ++j;
+
+        if (layer(i) != 0) {
+            if constexpr (is_array_v<Float>)
+                Throw("ImageBlock::set_unfiltered_channels(): ID layers are only "
+                      "supported in scalar variants!");
+            if (!unfiltered[i] || (j - i) % 2 != 0)
+                Throw("ImageBlock::set_unfiltered_channels(): ID layers must consist "
+                      "of pairs of unfiltered channels!");
+            m_id_ranges.emplace_back(i, j);
+        } else {
+            (unfiltered[i] ? m_unfiltered_ranges : m_filtered_ranges).emplace_back(i, j);
+        }
+        i = j;
+    }
+}
+
+/// Add \c weight to the (ID, weight) pair of \c id in an ID layer with \c size channels
+template <typename Scalar>
+MTS_INLINE void insert_id(Scalar *slots, uint32_t size, Scalar id, Scalar weight) {
+    for (uint32_t k = 0; k < size; k += 2) {
+        if (slots[k + 1] == 0.f) {
+            // First unused pair
+            slots[k] = id;
+            slots[k + 1] = weight;
+            return;
+        } else if (slots[k] == id) {
+            slots[k + 1] += weight;
+            return;
+        }
+    }
+}
+
+MTS_VARIANT void ImageBlock<Float, Spectrum>::set_deep_samples(uint32_t max_samples,
+                                                               uint32_t depth_channel,
+                                                               ScalarFloat merge_tolerance) {
+    if (max_samples != 0) {
+        if constexpr (is_array_v<Float>)
+            Throw("ImageBlock::set_deep_samples(): deep samples are only supported in "
+                  "scalar variants!");
+        if (depth_channel >= m_channel_count)
+            Throw("ImageBlock::set_deep_samples(): invalid depth channel %i!", depth_channel);
+    }
+
+    m_deep_samples = max_samples;
+    m_depth_channel = depth_channel;
+    m_deep_merge_tolerance = merge_tolerance;
+    m_deep.clear();
+    m_deep.shrink_to_fit();
+    if (max_samples != 0)
+        m_deep.resize(hprod(m_size + 2 * m_border_size) * (1 + 6 * max_samples), 0.f);
+}
+
+/**
+ * Merge a deep sample record (depth, count, X, Y, Z, A) into the depth-sorted
+ * list of \c size records of a pixel, see ImageBlock::set_deep_samples()
+ */
+template <typename Scalar>
+void insert_deep(Scalar *records, uint32_t size, const Scalar *sample, Scalar tolerance) {
+    auto merge = [](Scalar *target, const Scalar *source) {
+        Scalar count = target[1] + source[1];
+        target[0] = (target[0] * target[1] + source[0] * source[1]) / count;
+        target[1] = count;
+        for (uint32_t k = 2; k < 6; ++k)
+            target[k] += source[k];
+    };
+
+    // Relative separation of two depths z0 <= z1
+    auto gap = [](Scalar z0, Scalar z1) {
+        return z1 > 0 ? (z1 - z0) / z1 : Scalar(0);
+    };
+
+    uint32_t used = 0, pos = 0;
+    while (used < size && records[6 * used + 1] != 0) {
+        if (records[6 * used] < sample[0])
+            pos = used + 1;
+        ++used;
+    }
+
+    // Separation from the adjacent records, and the closer one of them
+    const Scalar inf = std::numeric_limits<Scalar>::infinity();
+    Scalar gap_prev = pos > 0 ? gap(records[6 * (pos - 1)], sample[0]) : inf,
+           gap_next = pos < used ? gap(sample[0], records[6 * pos]) : inf,
+           gap_min  = std::min(gap_prev, gap_next);
+    Scalar *closest = records + 6 * (pos > 0 && gap_prev <= gap_next ? pos - 1 : pos);
+
+    // Merge the sample into an adjacent record of the same depth bin
+    if (gap_min <= tolerance) {
+        merge(closest, sample);
+        return;
+    }
+
+    if (used == size) {
+        // Out of records: merge the closest pair among the records and the sample
+        uint32_t best = 0;
+        Scalar best_gap = inf;
+        for (uint32_t i = 0; i + 1 < used; ++i) {
+            Scalar g = gap(records[6 * i], records[6 * (i + 1)]);
+            if (g < best_gap) {
+                best = i;
+                best_gap = g;
+            }
+        }
+
+        if (gap_min < best_gap) {
+            merge(closest, sample);
+            return;
+        }
+
+        merge(records + 6 * best, records + 6 * (best + 1));
+        std::copy(records + 6 * (best + 2), records + 6 * used, records + 6 * (best + 1));
+        used--;
+        pos = 0;
+        while (pos < used && records[6 * pos] < sample[0])
+            ++pos;
+    }
+
+    // Insert a new record
+    std::copy_backward(records + 6 * pos, records + 6 * used, records + 6 * (used + 1));
+    std::copy(sample, sample + 6, records + 6 * pos);
 }
 
 MTS_VARIANT void ImageBlock<Float, Spectrum>::set_size(const ScalarVector2i &size) {
     if (size == m_size)
         return;
     m_size = size;
-    m_data = empty<DynamicBuffer<Float>>(
-        m_channel_count * hprod(size + 2 * m_border_size));
+    if (m_deep_samples != 0)
+        m_deep.assign(hprod(size + 2 * m_border_size) * (1 + 6 * m_deep_samples), 0.f);
+    size_t count = m_channel_count * hprod(size + 2 * m_border_size);
+    if constexpr (!is_cuda_array_v<Float>) {
+        /* Blocks are reused for the differently sized tiles at the image
+           boundary and in the subdivided tail, so keep the allocation */
+        set_slices(m_data, count);
+    } else {
+        m_data = empty<DynamicBuffer<Float>>(count);
+    }
 }
 
 MTS_VARIANT void ImageBlock<Float, Spectrum>::put(const ImageBlock *block) {
@@ -52,6 +245,14 @@ MTS_VARIANT void ImageBlock<Float, Spectrum>::put(const ImageBlock *block) {
     if (unlikely(block->channel_count() != channel_count()))
         Throw("ImageBlock::put(): mismatched channel counts!");
 
+    if (unlikely(m_deep_samples != 0))
+        put_deep(block);
+
+    if (unlikely(!m_id_ranges.empty())) {
+        put_ids(block);
+        return;
+    }
+
 
     ScalarVector2i source_size   = block->size() + 2 * block->border_size(),
                    target_size   =        size() + 2 *        border_size();
@@ -76,6 +277,45 @@ MTS_VARIANT void ImageBlock<Float, Spectrum>::put(const ImageBlock *block) {
     }
 }
 
+MTS_VARIANT void ImageBlock<Float, Spectrum>::put_ids(const ImageBlock *block) {
+    if constexpr (!is_array_v<Float>) {
+        ScalarVector2i source_size = block->size() + 2 * block->border_size(),
+                       target_size =        size() + 2 *        border_size();
+
+        // Position of the source block within the target block
+        ScalarPoint2i delta = (block->offset() - block->border_size()) -
+                              (offset() - border_size()),
+                      lo = max(delta, 0),
+                      hi = min(delta + source_size, target_size);
+
+        const ScalarFloat *source = block->data().data();
+        ScalarFloat *target = m_data.data();
+        uint32_t channel_count = m_channel_count;
+
+        for (int y = lo.y(); y < hi.y(); ++y) {
+            for (int x = lo.x(); x < hi.x(); ++x) {
+                const ScalarFloat *src = source + channel_count *
+                    ((y - delta.y()) * source_size.x() + (x - delta.x()));
+                ScalarFloat *dst = target + channel_count * (y * target_size.x() + x);
+
+                for (auto [begin, end] : m_filtered_ranges)
+                    for (uint32_t k = begin; k < end; ++k)
+                        dst[k] += src[k];
+                for (auto [begin, end] : m_unfiltered_ranges)
+                    for (uint32_t k = begin; k < end; ++k)
+                        dst[k] += src[k];
+
+                for (auto [begin, end] : m_id_ranges)
+                    for (uint32_t k = begin; k < end && src[k + 1] != 0.f; k += 2)
+                        insert_id(dst + begin, end - begin, src[k], src[k + 1]);
+            }
+        }
+    } else {
+        ENOKI_MARK_USED(block);
+        Throw("ImageBlock::put(): ID layers are only supported in scalar variants!");
+    }
+}
+
 MTS_VARIANT typename ImageBlock<Float, Spectrum>::Mask
 ImageBlock<Float, Spectrum>::put(const Point2f &pos_, const Float *value, Mask active) {
     ScopedPhase sp(ProfilerPhase::ImageBlockPut);
@@ -114,26 +354,75 @@ ImageBlock<Float, Spectrum>::put(const Point2f &pos_, const Float *value, Mask a
     // Convert to pixel coordinates within the image block
     Point2f pos = pos_ - (m_offset - m_border_size + .5f);
 
-    if (filter_radius > 0.5f + math::RayEpsilon<Float>) {
+    if constexpr (is_cuda_array_v<Float>) {
+        if (m_wavefront_spp != 0 && put_wavefront(pos, value, active))
+            return active;
+    }
+
+    if constexpr (!is_array_v<Float>) {
+        if (!active)
+            return false;
+
+        uint32_t n = 0;
+        if (filter_radius > 0.5f + math::RayEpsilon<Float>)
+            n = ceil2int<uint32_t>((filter_radius - 2.f * math::RayEpsilon<ScalarFloat>) * 2.f);
+
+        // Specialize the footprints of the common filters (box, tent, gaussian, lanczos)
+        switch (n) {
+            case 0:  put_scalar<1>(pos, value, 1); break;
+            case 2:  put_scalar<2>(pos, value, 2); break;
+            case 3:  put_scalar<3>(pos, value, 3); break;
+            case 4:  put_scalar<4>(pos, value, 4); break;
+            case 6:  put_scalar<6>(pos, value, 6); break;
+            default: put_scalar<0>(pos, value, n); break;
+        }
+
+        if (!m_unfiltered_ranges.empty())
+            put_unfiltered(pos, value, true);
+
+        if (unlikely(m_deep_samples != 0))
+            put_deep(pos, value);
+
+        return true;
+    } else if (filter_radius > 0.5f + math::RayEpsilon<Float>) {
         // Determine the affected range of pixels
         Point2u lo = Point2u(max(ceil2int <Point2i>(pos - filter_radius), 0)),
                 hi = Point2u(min(floor2int<Point2i>(pos + filter_radius), size - 1));
 
         uint32_t n = ceil2int<uint32_t>((m_filter->radius() - 2.f * math::RayEpsilon<ScalarFloat>) * 2.f);
 
-        Point2f base = lo - pos;
-        for (uint32_t i = 0; i < n; ++i) {
-            Point2f p = base + i;
-            if constexpr (!is_cuda_array_v<Float>) {
-                m_weights_x[i] = m_filter->eval_discretized(p.x(), active);
-                m_weights_y[i] = m_filter->eval_discretized(p.y(), active);
-            } else {
-                m_weights_x[i] = m_filter->eval(p.x(), active);
-                m_weights_y[i] = m_filter->eval(p.y(), active);
+        bool tabulated = !is_cuda_array_v<Float> && !m_filter_table.empty();
+        if (tabulated) {
+            // Look up the precomputed weights of the sub-pixel offset
+            Point2i lo_u   = ceil2int<Point2i>(pos - filter_radius);
+            Vector2u shift = Vector2u(Point2i(lo) - lo_u),
+                     bin   = Vector2u(clamp(
+                         Vector2i((Point2f(lo_u) - pos + filter_radius) *
+                                  (ScalarFloat) MTS_FILTER_OFFSET_RESOLUTION),
+                         0, MTS_FILTER_OFFSET_RESOLUTION - 1));
+
+            Vector2u index = bin * m_filter_taps + shift;
+            for (uint32_t i = 0; i < n; ++i) {
+                m_weights_x[i] = gather<Float>(m_filter_table.data(), index.x() + i,
+                                               active && shift.x() + i < n);
+                m_weights_y[i] = gather<Float>(m_filter_table.data(), index.y() + i,
+                                               active && shift.y() + i < n);
+            }
+        } else {
+            Point2f base = lo - pos;
+            for (uint32_t i = 0; i < n; ++i) {
+                Point2f p = base + i;
+                if constexpr (!is_cuda_array_v<Float>) {
+                    m_weights_x[i] = m_filter->eval_discretized(p.x(), active);
+                    m_weights_y[i] = m_filter->eval_discretized(p.y(), active);
+                } else {
+                    m_weights_x[i] = m_filter->eval(p.x(), active);
+                    m_weights_y[i] = m_filter->eval(p.y(), active);
+                }
             }
         }
 
-        if (unlikely(m_normalize)) {
+        if (unlikely(m_normalize && !tabulated)) {
             Float wx(0), wy(0);
             for (uint32_t i = 0; i <= n; ++i) {
                 wx += m_weights_x[i];
@@ -155,22 +444,348 @@ ImageBlock<Float, Spectrum>::put(const Point2f &pos_, const Float *value, Mask a
                 Float weight = m_weights_y[yr] * m_weights_x[xr];
 
                 enabled &= x <= hi.x();
-                ENOKI_NOUNROLL for (uint32_t k = 0; k < m_channel_count; ++k)
-                    scatter_add(m_data, value[k] * weight, offset + k, enabled);
+                for (auto [begin, end] : m_filtered_ranges) {
+                    ENOKI_NOUNROLL for (uint32_t k = begin; k < end; ++k)
+                        scatter_add(m_data, value[k] * weight, offset + k, enabled);
+                }
             }
         }
+
+        if (!m_unfiltered_ranges.empty())
+            put_unfiltered(pos, value, active);
     } else {
         Point2u lo = ceil2int<Point2i>(pos - .5f);
         UInt32 offset = m_channel_count * (lo.y() * size.x() + lo.x());
 
         Mask enabled = active && all(lo >= 0u && lo < size);
-        ENOKI_NOUNROLL for (uint32_t k = 0; k < m_channel_count; ++k)
-            scatter_add(m_data, value[k], offset + k, enabled);
+        for (auto [begin, end] : m_filtered_ranges) {
+            ENOKI_NOUNROLL for (uint32_t k = begin; k < end; ++k)
+                scatter_add(m_data, value[k], offset + k, enabled);
+        }
+
+        if (!m_unfiltered_ranges.empty())
+            put_unfiltered(pos, value, active);
     }
 
     return active;
 }
 
+MTS_VARIANT void ImageBlock<Float, Spectrum>::put_unfiltered(const Point2f &pos,
+                                                             const Float *value,
+                                                             Mask active) {
+    ScalarVector2i size = m_size + 2 * m_border_size;
+
+    // Pixel containing the sample ('pos' is relative to the pixel centers)
+    if constexpr (!is_array_v<Float>) {
+        ScalarPoint2i p = ceil2int<ScalarPoint2i>(pos - .5f);
+        if (unlikely(!active || any(p < 0 || p >= size)))
+            return;
+        ScalarFloat *target = m_data.data() + m_channel_count * (p.y() * size.x() + p.x());
+        for (auto [begin, end] : m_unfiltered_ranges)
+            for (uint32_t k = begin; k < end; ++k)
+                target[k] += value[k];
+        for (auto [begin, end] : m_id_ranges) {
+            if (value[begin + 1] != 0.f)
+                insert_id(target + begin, end - begin, value[begin], value[begin + 1]);
+        }
+    } else {
+        Point2u p = ceil2int<Point2i>(pos - .5f);
+        UInt32 offset = m_channel_count * (p.y() * size.x() + p.x());
+
+        Mask enabled = active && all(p >= 0u && p < size);
+        for (auto [begin, end] : m_unfiltered_ranges) {
+            ENOKI_NOUNROLL for (uint32_t k = begin; k < end; ++k)
+                scatter_add(m_data, value[k], offset + k, enabled);
+        }
+    }
+}
+
+MTS_VARIANT bool ImageBlock<Float, Spectrum>::put_wavefront(const Point2f &pos,
+                                                            const Float *value,
+                                                            Mask active) {
+    if constexpr (is_cuda_array_v<Float>) {
+        size_t sample_count = hprod(m_size) * (size_t) m_wavefront_spp;
+        if (m_normalize || slices(pos) != sample_count)
+            return false;
+
+        /* Samples lie inside of their pixel, so they only contribute to the
+           pixels whose centers are less than the filter radius away */
+        ScalarFloat filter_radius = m_filter->radius();
+        bool box = filter_radius <= 0.5f + math::RayEpsilon<Float>;
+        int reach = box ? 0 : (int) std::ceil(filter_radius + .5f) - 1;
+        if (sqr(2 * reach + 1) * m_wavefront_spp > m_wavefront_max_gathers)
+            return false;
+
+        // Store the (masked) sample values in memory, so that they can be gathered
+        std::vector<Float> samples(m_channel_count);
+        for (uint32_t k = 0; k < m_channel_count; ++k)
+            samples[k] = select(active, value[k], 0.f) + zero<Float>(sample_count);
+        Float pos_x = pos.x() + zero<Float>(sample_count),
+              pos_y = pos.y() + zero<Float>(sample_count);
+
+        // One lane per pixel of the block (including the border)
+        ScalarVector2i size = m_size + 2 * m_border_size;
+        UInt32 index = arange<UInt32>(hprod(size));
+        Int32 x = Int32(index % (uint32_t) size.x()),
+              y = Int32(index / (uint32_t) size.x());
+
+        std::vector<Float> result(m_channel_count, 0.f);
+        for (int dy = -reach; dy <= reach; ++dy) {
+            for (int dx = -reach; dx <= reach; ++dx) {
+                // Pixel of the wavefront whose samples are gathered
+                Int32 sx = x - m_border_size + dx,
+                      sy = y - m_border_size + dy;
+                Mask valid = sx >= 0 && sx < m_size.x() && sy >= 0 && sy < m_size.y();
+                UInt32 base = wavefront_index(UInt32(max(sx, 0)), UInt32(max(sy, 0))) *
+                              m_wavefront_spp;
+
+                for (uint32_t s = 0; s < m_wavefront_spp; ++s) {
+                    UInt32 j = base + s;
+
+                    Float weight = 1.f;
+                    if (!box) {
+                        Float px = Float(x) - gather<Float>(pos_x, j, valid),
+                              py = Float(y) - gather<Float>(pos_y, j, valid);
+                        Mask inside = valid && abs(px) <= filter_radius &&
+                                      abs(py) <= filter_radius;
+                        weight = select(inside, m_filter->eval(px, inside) *
+                                                m_filter->eval(py, inside), 0.f);
+                    }
+
+                    for (auto [begin, end] : m_filtered_ranges)
+                        for (uint32_t k = begin; k < end; ++k)
+                            result[k] = fmadd(gather<Float>(samples[k], j, valid),
+                                              weight, result[k]);
+
+                    // The remaining channels are only accumulated into the sample's own pixel
+                    if (dx == 0 && dy == 0) {
+                        for (auto [begin, end] : m_unfiltered_ranges)
+                            for (uint32_t k = begin; k < end; ++k)
+                                result[k] += gather<Float>(samples[k], j, valid);
+                    }
+                }
+            }
+        }
+
+        // Every lane owns its pixel: plain reads and writes, no atomics
+        UInt32 offset = index * m_channel_count;
+        for (uint32_t k = 0; k < m_channel_count; ++k)
+            result[k] += gather<Float>(m_data, offset + k);
+        for (uint32_t k = 0; k < m_channel_count; ++k)
+            scatter(m_data, result[k], offset + k);
+
+        return true;
+    } else {
+        ENOKI_MARK_USED(pos);
+        ENOKI_MARK_USED(value);
+        ENOKI_MARK_USED(active);
+        return false;
+    }
+}
+
+MTS_VARIANT typename ImageBlock<Float, Spectrum>::Point2u
+ImageBlock<Float, Spectrum>::wavefront_pixel(const UInt32 &index) const {
+    uint32_t width = (uint32_t) m_size.x(), height = (uint32_t) m_size.y(),
+             tile = m_wavefront_tile;
+    if (tile == 0 || (tile >= width && tile >= height))
+        return Point2u(index % width, index / width);
+
+    // Band of tiles, then the tile within the band (both may be cropped)
+    UInt32 band   = index / (tile * width),
+           rest   = index - band * (tile * width),
+           band_y = band * tile,
+           band_h = min(height - band_y, tile),
+           column = rest / (tile * band_h);
+    rest -= column * (tile * band_h);
+
+    UInt32 tile_x = column * tile,
+           tile_w = min(width - tile_x, tile),
+           y      = rest / tile_w;
+
+    return Point2u(tile_x + (rest - y * tile_w), band_y + y);
+}
+
+MTS_VARIANT typename ImageBlock<Float, Spectrum>::UInt32
+ImageBlock<Float, Spectrum>::wavefront_index(const UInt32 &x, const UInt32 &y) const {
+    uint32_t width = (uint32_t) m_size.x(), height = (uint32_t) m_size.y(),
+             tile = m_wavefront_tile;
+    if (tile == 0 || (tile >= width && tile >= height))
+        return y * width + x;
+
+    UInt32 band_y = (y / tile) * tile,
+           band_h = min(height - band_y, tile),
+           tile_x = (x / tile) * tile,
+           tile_w = min(width - tile_x, tile);
+
+    return band_y * width + tile_x * band_h + (y - band_y) * tile_w + (x - tile_x);
+}
+
+MTS_VARIANT void ImageBlock<Float, Spectrum>::put_deep(const ScalarPoint2f &pos,
+                                                       const ScalarFloat *value) {
+    ScalarVector2i size = m_size + 2 * m_border_size;
+
+    // Pixel containing the sample ('pos' is relative to the pixel centers)
+    ScalarPoint2i p = ceil2int<ScalarPoint2i>(pos - .5f);
+    if (unlikely(any(p < 0 || p >= size)))
+        return;
+
+    ScalarFloat *pixel = m_deep.data() + (p.y() * size.x() + p.x()) * (1 + 6 * m_deep_samples);
+    pixel[0] += 1.f;
+    if (value[3] == 0.f)
+        return;
+
+    ScalarFloat sample[6] = { value[m_depth_channel], 1.f, value[0], value[1], value[2], value[3] };
+    insert_deep(pixel + 1, m_deep_samples, sample, m_deep_merge_tolerance);
+}
+
+MTS_VARIANT void ImageBlock<Float, Spectrum>::put_deep(const ImageBlock *block) {
+    if (unlikely(block->deep_samples() == 0))
+        Throw("ImageBlock::put(): the source block doesn't record deep samples!");
+
+    ScalarVector2i source_size = block->size() + 2 * block->border_size(),
+                   target_size =        size() + 2 *        border_size();
+
+    // Position of the source block within the target block
+    ScalarPoint2i delta = (block->offset() - block->border_size()) -
+                          (offset() - border_size()),
+                  lo = max(delta, 0),
+                  hi = min(delta + source_size, target_size);
+
+    for (int y = lo.y(); y < hi.y(); ++y) {
+        for (int x = lo.x(); x < hi.x(); ++x) {
+            const ScalarFloat *src = block->deep_pixel(ScalarPoint2i(x, y) - delta);
+            ScalarFloat *dst = m_deep.data() +
+                (y * target_size.x() + x) * (1 + 6 * m_deep_samples);
+
+            dst[0] += src[0];
+            for (uint32_t k = 0; k < block->deep_samples() && src[2 + 6 * k] != 0.f; ++k)
+                insert_deep(dst + 1, m_deep_samples, src + 1 + 6 * k, m_deep_merge_tolerance);
+        }
+    }
+}
+
+/// Accumulate \c weight times \c value into \c target, vectorized over the channels
+template <typename Scalar>
+MTS_INLINE void splat_channels(Scalar *target, const Scalar *value, Scalar weight,
+                               uint32_t channel_count) {
+    using Packet8 = Packet<Scalar, 8>;
+    using Packet4 = Packet<Scalar, 4>;
+
+    uint32_t k = 0;
+    for (; k + 8 <= channel_count; k += 8)
+        store_unaligned(target + k, fmadd(load_unaligned<Packet8>(value + k), weight,
+                                          load_unaligned<Packet8>(target + k)));
+    if (k + 4 <= channel_count) {
+        store_unaligned(target + k, fmadd(load_unaligned<Packet4>(value + k), weight,
+                                          load_unaligned<Packet4>(target + k)));
+        k += 4;
+    }
+    for (; k < channel_count; ++k)
+        target[k] = fmadd(value[k], weight, target[k]);
+}
+
+MTS_VARIANT template <uint32_t Size>
+void ImageBlock<Float, Spectrum>::put_scalar(const ScalarPoint2f &pos, const ScalarFloat *value,
+                                             uint32_t n) {
+    ScalarVector2i size = m_size + 2 * m_border_size;
+    uint32_t channel_count = m_channel_count;
+
+    if constexpr (Size == 1) {
+        // Box filter with a radius of 0.5: the sample only affects a single pixel
+        ENOKI_MARK_USED(n);
+        ScalarPoint2i p = ceil2int<ScalarPoint2i>(pos - .5f);
+        if (unlikely(any(p < 0 || p >= size)))
+            return;
+        ScalarFloat *target = m_data.data() + channel_count * (p.y() * size.x() + p.x());
+        if (likely(m_unfiltered_ranges.empty())) {
+            splat_channels(target, value, 1.f, channel_count);
+        } else {
+            // The unfiltered channels are handled by put_unfiltered()
+            for (auto [begin, end] : m_filtered_ranges)
+                splat_channels(target + begin, value + begin, 1.f, end - begin);
+        }
+        return;
+    } else {
+        if constexpr (Size != 0)
+            n = Size;
+
+        ScalarFloat filter_radius = m_filter->radius();
+
+        // Determine the affected range of pixels
+        ScalarPoint2i lo = max(ceil2int <ScalarPoint2i>(pos - filter_radius), 0),
+                      hi = min(floor2int<ScalarPoint2i>(pos + filter_radius), size - 1);
+        ScalarVector2i count = min(max(hi - lo + 1, 0), ScalarVector2i((int32_t) n));
+        if (unlikely(count.x() == 0 || count.y() == 0))
+            return;
+
+        // Stack storage of the weights for the specialized footprints
+        ScalarFloat weights_storage[Size == 0 ? 1 : 2 * Size];
+        const ScalarFloat *weights_x, *weights_y;
+
+        if (likely(!m_filter_table.empty())) {
+            /* Read the (pre-normalized) weights of the sub-pixel offset from
+               the table, skipping the pixels that were clipped away by 'lo' */
+            ScalarPoint2i lo_u = ceil2int<ScalarPoint2i>(pos - filter_radius);
+            ScalarVector2i shift = lo - lo_u,
+                           bin   = clamp(ScalarVector2i((ScalarPoint2f(lo_u) - pos + filter_radius) *
+                                                        (ScalarFloat) MTS_FILTER_OFFSET_RESOLUTION),
+                                         0, MTS_FILTER_OFFSET_RESOLUTION - 1);
+            count = min(count, (int32_t) n - shift);
+            if (unlikely(count.x() <= 0 || count.y() <= 0))
+                return;
+
+            weights_x = m_filter_table.data() + bin.x() * m_filter_taps + shift.x();
+            weights_y = m_filter_table.data() + bin.y() * m_filter_taps + shift.y();
+        } else {
+            ScalarFloat *wx = Size == 0 ? m_weights_x : weights_storage,
+                        *wy = Size == 0 ? m_weights_y : weights_storage + Size;
+
+            ScalarPoint2f base = lo - pos;
+            for (uint32_t i = 0; i < n; ++i) {
+                wx[i] = m_filter->eval_discretized(base.x() + i);
+                wy[i] = m_filter->eval_discretized(base.y() + i);
+            }
+
+            if (unlikely(m_normalize)) {
+                ScalarFloat sx = 0.f, sy = 0.f;
+                for (uint32_t i = 0; i < n; ++i) {
+                    sx += wx[i];
+                    sy += wy[i];
+                }
+
+                ScalarFloat factor = rcp(sx * sy);
+                for (uint32_t i = 0; i < n; ++i)
+                    wx[i] *= factor;
+            }
+
+            weights_x = wx;
+            weights_y = wy;
+        }
+
+        // Separable splat: traverse the footprint row by row, vectorizing over the channels
+        ScalarFloat *target = m_data.data() + channel_count * (lo.y() * size.x() + lo.x());
+        for (int32_t yr = 0; yr < count.y(); ++yr) {
+            ScalarFloat *row = target + yr * channel_count * size.x();
+            ScalarFloat weight_y = weights_y[yr];
+            for (int32_t xr = 0; xr < count.x(); ++xr) {
+                ScalarFloat *pixel = row + xr * channel_count,
+                            weight = weight_y * weights_x[xr];
+                if (likely(m_unfiltered_ranges.empty())) {
+                    splat_channels(pixel, value, weight, channel_count);
+                } else {
+                    for (auto [begin, end] : m_filtered_ranges)
+                        splat_channels(pixel + begin, value + begin, weight, end - begin);
+                }
+            }
+        }
+    }
+}
+
+MTS_VARIANT void ImageBlock<Float, Spectrum>::account_memory(MemoryReport *report) const {
+    report->add_array(MemoryCategory::Film, m_data);
+    report->add(MemoryCategory::Film, m_deep.size() * sizeof(ScalarFloat));
+}
+
 MTS_VARIANT std::string ImageBlock<Float, Spectrum>::to_string() const {
     std::ostringstream oss;
     oss << "ImageBlock[" << std::endl
@@ -1,23 +1,97 @@
 #include <thread>
 #include <mutex>
+#include <atomic>
 
 #include <enoki/morton.h>
+#include <mitsuba/core/bitmap.h>
+#include <mitsuba/core/filesystem.h>
 #include <mitsuba/core/profiler.h>
 #include <mitsuba/core/progress.h>
 #include <mitsuba/core/spectrum.h>
+#include <mitsuba/core/statistics.h>
+#include <mitsuba/core/string.h>
 #include <mitsuba/core/timer.h>
 #include <mitsuba/core/util.h>
 #include <mitsuba/core/warp.h>
+#include <mitsuba/render/bsdf.h>
 #include <mitsuba/render/film.h>
 #include <mitsuba/render/integrator.h>
 #include <mitsuba/render/sampler.h>
+#include <mitsuba/render/scene.h>
 #include <mitsuba/render/sensor.h>
 #include <mitsuba/render/spiral.h>
 #include <tbb/blocked_range.h>
+#include <tbb/enumerable_thread_specific.h>
 #include <tbb/parallel_for.h>
+#include <tbb/task.h>
+#include <tbb/task_arena.h>
+#include <tbb/task_group.h>
 
 NAMESPACE_BEGIN(mitsuba)
 
+/* Rough estimate of the device memory used per sample of a wavefront (rays,
+   intersection records, sampler state and temporaries of a path tracer) */
+static constexpr size_t wavefront_bytes_per_sample = 512;
+
+/// Primary hit cache entry of the sample that this thread currently renders
+static thread_local void *primary_hit_slot = nullptr;
+
+/// Shadow ray queue of the image block that this thread currently renders
+static thread_local void *shadow_queue_slot = nullptr;
+
+/// Task arena of a NUMA node, whose workers are pinned to the cores of the node
+struct NumaArena {
+    std::unique_ptr<tbb::task_arena> arena;
+    int node;
+    size_t concurrency;
+};
+
+/**
+ * Return one task arena per NUMA node, which share the global thread count in
+ * proportion to the core counts of the nodes. The list is empty on machines
+ * with a single node, or when there are too few threads to be split up.
+ */
+static std::vector<NumaArena> &numa_node_arenas() {
+    static std::vector<NumaArena> arenas;
+    static size_t thread_count = 0;
+    static std::mutex mutex;
+
+    std::lock_guard<std::mutex> guard(mutex);
+    if (thread_count == __global_thread_count)
+        return arenas;
+    thread_count = __global_thread_count;
+    arenas.clear();
+
+    const std::vector<std::vector<int>> &nodes = Thread::numa_nodes();
+    if (nodes.size() < 2 || thread_count < 2 * nodes.size())
+        return arenas;
+
+    size_t core_count = 0, assigned = 0;
+    for (const auto &cores : nodes)
+        core_count += cores.size();
+
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        size_t concurrency =
+            i + 1 == nodes.size()
+                ? thread_count - assigned
+                : std::max((thread_count * nodes[i].size() + core_count / 2) / core_count,
+                           (size_t) 1);
+        concurrency = std::min(concurrency, thread_count - assigned - (nodes.size() - i - 1));
+        assigned += concurrency;
+
+        // Leave all slots to the workers, the calling thread only waits
+        arenas.push_back({ std::make_unique<tbb::task_arena>((int) concurrency, 0),
+                           (int) i, concurrency });
+    }
+    return arenas;
+}
+
+/// Seed offset of a pixel that only depends on its film coordinates and the pass
+static uint64_t pixel_seed(const ScalarVector2i &film_size, uint32_t x, uint32_t y,
+                           uint32_t pass) {
+    return ((uint64_t) pass * (uint64_t) film_size.y() + y) * (uint64_t) film_size.x() + x;
+}
+
 // -----------------------------------------------------------------------------
 
 MTS_VARIANT SamplingIntegrator<Float, Spectrum>::SamplingIntegrator(const Properties &props)
@@ -32,10 +106,86 @@ MTS_VARIANT SamplingIntegrator<Float, Spectrum>::SamplingIntegrator(const Proper
     }
 
     m_samples_per_pass = (uint32_t) props.size_("samples_per_pass", (size_t) -1);
+    m_wavefront_budget = props.size_("wavefront_budget", 4096);
+    m_wavefront_tile_size = (uint32_t) props.size_("wavefront_tile_size", 8);
+
+    /* Seed the sampler with the film coordinates of each pixel and the pass
+       index, so that the result does not depend on the block size, the
+       thread count or the order of the blocks. */
+    m_pixel_seeds = props.bool_("pixel_seeds", false);
     m_timeout = props.float_("timeout", -1.f);
 
+    /* Store the first intersection of every sample and reuse it when a later
+       render traces exactly the same camera ray (e.g. in interactive loops
+       that only modify materials or emitters). */
+    m_primary_cache = props.bool_("primary_cache", false);
+    if (m_primary_cache && is_array_v<Float>) {
+        Log(Warn, "The primary hit cache is only supported in scalar variants, disabling it.");
+        m_primary_cache = false;
+    }
+
+    /* Adaptive sampling: stop rendering pixels whose relative standard error
+       (estimated from the per-pass results) drops below this threshold. */
+    m_adaptive_threshold = props.float_("adaptive_threshold", -1.f);
+    m_adaptive_min_passes = (uint32_t) props.size_("adaptive_min_passes", 4);
+    if (m_adaptive_min_passes < 2)
+        Throw("\"adaptive_min_passes\" must be at least 2!");
+
+    /* Global termination: stop a progressive render once the estimated
+       relative RMSE of the whole image drops below this target. */
+    m_error_target = props.float_("error_target", -1.f);
+
     /// Disable direct visibility of emitters if needed
     m_hide_emitters = props.bool_("hide_emitters", false);
+
+    /* Periodically write the accumulated film to disk (every N passes and/or
+       seconds), so that an interrupted render can be resumed. */
+    m_checkpoint_passes = (uint32_t) props.size_("checkpoint_passes", 0);
+    m_checkpoint_interval = props.float_("checkpoint_interval", -1.f);
+    m_checkpoint_file = props.string("checkpoint_file", "");
+    m_checkpoint_resume = props.bool_("resume", false);
+    m_checkpoint_pending = false;
+
+    /* Measure the wall time of every image block and write it as a per-pixel
+       heatmap, which shows the expensive regions of the image. */
+    m_heatmap = props.bool_("heatmap", false);
+    m_heatmap_file = props.string("heatmap_file", "");
+
+    /* On machines with several NUMA nodes, render with one task arena per
+       node whose workers are pinned to the cores of the node. */
+    m_numa = props.bool_("numa", true);
+
+    /* Scalar variants: defer the shadow rays of emitter samples and trace
+       batches of this many rays at once (see add_unoccluded()). */
+    m_shadow_batch = props.size_("shadow_batch", is_array_v<Float> ? 0 : 1024);
+    if (m_shadow_batch > 0 && is_array_v<Float>) {
+        Log(Warn, "Shadow ray batching is only supported in scalar variants, disabling it.");
+        m_shadow_batch = 0;
+    }
+
+    /* Many-light direct illumination: the number of emitter samples that are
+       resampled down to a single shadow ray (1: plain emitter sampling). */
+    m_ris_candidates = props.size_("ris_candidates", 1);
+    if (m_ris_candidates == 0)
+        Throw("\"ris_candidates\" must be at least 1!");
+
+    /* Sample environment emitters proportionally to the product of their
+       emission and a lobe of the BSDF at the shading point */
+    m_product_sampling = props.bool_("product_sampling", false);
+    m_lobe_exponent = props.float_("lobe_exponent", 20.f);
+    if (!(m_lobe_exponent > 0.f))
+        Throw("\"lobe_exponent\" must be positive!");
+
+    /* Publish every finished image block (with its offset and pass index)
+       at this ZeroMQ address, e.g. for live previews on another machine.
+       Blocks are dropped rather than stalling the render threads. */
+    std::string block_tap = props.string("block_tap", "");
+    if (!block_tap.empty()) {
+        if constexpr (is_cuda_array_v<Float>)
+            Log(Warn, "The block tap is only supported in CPU variants, disabling it.");
+        else
+            m_block_tap = new BlockPublisher(block_tap);
+    }
 }
 
 MTS_VARIANT SamplingIntegrator<Float, Spectrum>::~SamplingIntegrator() { }
@@ -44,10 +194,187 @@ MTS_VARIANT void SamplingIntegrator<Float, Spectrum>::cancel() {
     m_stop = true;
 }
 
+MTS_VARIANT void SamplingIntegrator<Float, Spectrum>::publish_block(const ImageBlock *block,
+                                                                 size_t pass) const {
+    if constexpr (!is_cuda_array_v<Float>) {
+        ScalarVector2i size = block->size() + 2 * block->border_size();
+
+        PublishedBlock header;
+        header.pass           = (uint32_t) pass;
+        header.offset[0]      = block->offset().x();
+        header.offset[1]      = block->offset().y();
+        header.size[0]        = block->size().x();
+        header.size[1]        = block->size().y();
+        header.border         = block->border_size();
+        header.channel_count  = (uint32_t) block->channel_count();
+        header.component_size = (uint32_t) sizeof(ScalarFloat);
+        header.data_size      = hprod(size) * block->channel_count() * sizeof(ScalarFloat);
+
+        m_block_tap->publish(header, block->data().data());
+    } else {
+        ENOKI_MARK_USED(block);
+        ENOKI_MARK_USED(pass);
+    }
+}
+
+MTS_VARIANT typename SamplingIntegrator<Float, Spectrum>::SurfaceInteraction3f
+SamplingIntegrator<Float, Spectrum>::ray_intersect_primary(const Scene *scene,
+                                                           const Ray3f &ray,
+                                                           Mask active) const {
+    if constexpr (!is_array_v<Float>) {
+        PrimaryHit *hit = (PrimaryHit *) primary_hit_slot;
+        if (hit && active) {
+            // Only the first intersection of the sample corresponds to the entry
+            primary_hit_slot = nullptr;
+
+            if (!hit->valid || any(neq(hit->o, ray.o)) || any(neq(hit->d, ray.d)) ||
+                hit->mint != ray.mint || hit->maxt != ray.maxt || hit->time != ray.time) {
+                hit->pi    = scene->ray_intersect_preliminary(ray, active);
+                hit->o     = ray.o;
+                hit->d     = ray.d;
+                hit->mint  = ray.mint;
+                hit->maxt  = ray.maxt;
+                hit->time  = ray.time;
+                hit->valid = true;
+            }
+
+            // Same as Scene::ray_intersect(), minus the traversal
+            SurfaceInteraction3f si;
+            if (hit->pi.is_valid()) {
+                ScopedPhase sp(ProfilerPhase::CreateSurfaceInteraction);
+                si = hit->pi.compute_surface_interaction(ray, HitComputeFlags::All, active);
+            } else {
+                si.wavelengths = ray.wavelengths;
+                si.wi = -ray.d;
+                si.t = math::Infinity<Float>;
+            }
+            return si;
+        }
+    }
+
+    return scene->ray_intersect(ray, active);
+}
+
+MTS_VARIANT void SamplingIntegrator<Float, Spectrum>::add_unoccluded(const Scene *scene,
+                                                                    const Interaction3f &ref,
+                                                                    const DirectionSample3f &ds,
+                                                                    const Spectrum &value,
+                                                                    Spectrum &result,
+                                                                    Mask active) const {
+    active &= neq(ds.pdf, 0.f) && any(neq(depolarize(value), 0.f));
+    if (none_or<false>(active))
+        return;
+
+    // Same shadow ray as in Scene::sample_emitter_direction()
+    Ray3f ray(ref.p, ds.d, math::RayEpsilon<Float> * (1.f + hmax(abs(ref.p))),
+              ds.dist * (1.f - math::ShadowEpsilon<Float>), ref.time, ref.wavelengths);
+
+    if constexpr (!is_array_v<Float>) {
+        ShadowQueue *queue = (ShadowQueue *) shadow_queue_slot;
+        if (queue && queue->owner == this) {
+            queue->rays.push_back(ray);
+            queue->values.push_back(value);
+            queue->targets.push_back((uint32_t) queue->positions.size());
+            return;
+        }
+    }
+
+    result[active && !scene->ray_test(ray, active)] += value;
+}
+
+MTS_VARIANT std::tuple<typename SamplingIntegrator<Float, Spectrum>::DirectionSample3f,
+                       Spectrum, Spectrum, Float>
+SamplingIntegrator<Float, Spectrum>::sample_emitter_ris(const Scene *scene, Sampler *sampler,
+                                                        const SurfaceInteraction3f &si,
+                                                        const BSDFPtr &bsdf,
+                                                        const Vector3f &lobe_axis,
+                                                        const Float &lobe_exponent,
+                                                        Mask active) const {
+    BSDFContext ctx;
+    DirectionSample3f ds = zero<DirectionSample3f>();
+    Spectrum emitter_val(0.f), bsdf_val(0.f);
+    Float bsdf_pdf(0.f), weight(0.f), weight_sum(0.f);
+
+    // Weighted reservoir sampling over the candidates
+    for (size_t i = 0; i < m_ris_candidates; ++i) {
+        DirectionSample3f ds_i;
+        Spectrum emitter_val_i;
+        if (m_product_sampling)
+            std::tie(ds_i, emitter_val_i) = scene->sample_emitter_direction_lobe(
+                si, sampler->next_2d(active), lobe_axis, lobe_exponent, false, active);
+        else
+            std::tie(ds_i, emitter_val_i) = scene->sample_emitter_direction(
+                si, sampler->next_2d(active), false, active);
+        Mask valid = active && neq(ds_i.pdf, 0.f);
+
+        Vector3f wo = si.to_local(ds_i.d);
+        auto [bsdf_val_i, bsdf_pdf_i] = bsdf->eval_pdf(ctx, si, wo, valid);
+        bsdf_val_i = si.to_world_mueller(bsdf_val_i, -wo, si.wi);
+
+        /* Resampling weight: the unshadowed contribution divided by the
+           density of the candidate (which is already part of 'emitter_val') */
+        Float weight_i = select(valid, hmean(depolarize(bsdf_val_i * emitter_val_i)), 0.f);
+        weight_sum += weight_i;
+
+        Mask replace = valid && weight_i > 0.f;
+        if (i > 0)
+            replace &= sampler->next_1d(active) * weight_sum < weight_i;
+
+        masked(ds, replace)          = ds_i;
+        masked(emitter_val, replace) = emitter_val_i;
+        masked(bsdf_val, replace)    = bsdf_val_i;
+        masked(bsdf_pdf, replace)    = bsdf_pdf_i;
+        masked(weight, replace)      = weight_i;
+    }
+
+    Mask selected = weight > 0.f;
+    masked(ds.pdf, !selected) = 0.f;
+    emitter_val *= select(selected, weight_sum / (weight * (ScalarFloat) m_ris_candidates), 0.f);
+
+    return { ds, emitter_val, bsdf_val, bsdf_pdf };
+}
+
+MTS_VARIANT std::pair<typename SamplingIntegrator<Float, Spectrum>::Vector3f, Float>
+SamplingIntegrator<Float, Spectrum>::emitter_lobe(const SurfaceInteraction3f &si,
+                                                  const UInt32 &bsdf_flags) const {
+    if (!m_product_sampling)
+        return { Vector3f(0.f), Float(0.f) };
+
+    Mask reflective = !has_flag(bsdf_flags, BSDFFlags::Transmission),
+         glossy     = has_flag(bsdf_flags, BSDFFlags::GlossyReflection) &&
+                      !has_flag(bsdf_flags, BSDFFlags::DiffuseReflection);
+
+    // Two-sided BSDFs reflect on the side of the incident direction
+    Vector3f n      = mulsign(si.sh_frame.n, Frame3f::cos_theta(si.wi)),
+             mirror = si.to_world(Vector3f(-si.wi.x(), -si.wi.y(), si.wi.z()));
+
+    Float exponent = select(glossy, Float(m_lobe_exponent), Float(1.f));
+    return { select(glossy, mirror, n), select(reflective, exponent, Float(0.f)) };
+}
+
+MTS_VARIANT Float SamplingIntegrator<Float, Spectrum>::pdf_emitter_lobe(
+    const Scene *scene, const Interaction3f &ref, const DirectionSample3f &ds,
+    const Vector3f &lobe_axis, const Float &lobe_exponent, Mask active) const {
+    if (m_product_sampling)
+        return scene->pdf_emitter_direction_lobe(ref, ds, lobe_axis, lobe_exponent, active);
+    else
+        return scene->pdf_emitter_direction(ref, ds, active);
+}
+
 MTS_VARIANT std::vector<std::string> SamplingIntegrator<Float, Spectrum>::aov_names() const {
     return { };
 }
 
+MTS_VARIANT ref<Bitmap> SamplingIntegrator<Float, Spectrum>::heatmap() const {
+    if (m_heatmap_data.empty())
+        return nullptr;
+    ref<Bitmap> bitmap = new Bitmap(Bitmap::PixelFormat::Y, Struct::Type::Float32,
+                                    m_heatmap_size);
+    std::memcpy(bitmap->data(), m_heatmap_data.data(),
+                m_heatmap_data.size() * sizeof(float));
+    return bitmap;
+}
+
 MTS_VARIANT bool SamplingIntegrator<Float, Spectrum>::render(Scene *scene, Sensor *sensor) {
     ScopedPhase sp(ProfilerPhase::Render);
     m_stop = false;
@@ -64,16 +391,70 @@ MTS_VARIANT bool SamplingIntegrator<Float, Spectrum>::render(Scene *scene, Senso
 
     size_t n_passes = (total_spp + samples_per_pass - 1) / samples_per_pass;
 
+    Statistics::set_value("spp", (double) total_spp);
+    Statistics::set_value("passes", (double) n_passes);
+    Statistics::set_value("width", (double) film_size.x());
+    Statistics::set_value("height", (double) film_size.y());
+
     std::vector<std::string> channels = aov_names();
     bool has_aovs = !channels.empty();
 
     // Insert default channels and set up the film
     for (size_t i = 0; i < 5; ++i)
         channels.insert(channels.begin() + i, std::string(1, "XYZAW"[i]));
+
+    /* AOVs that bypass the reconstruction filter (including ID layers) are
+       normalized by a separate channel counting their samples (see
+       Film::unfiltered_channels()) */
+    if (!film->unfiltered_channels(channels).empty())
+        channels.push_back("W.unfiltered");
+    std::vector<bool> unfiltered = film->unfiltered_channels(channels);
+    std::vector<uint32_t> id_layers = film->id_channels(channels);
     film->prepare(channels);
+    film->metadata().remove_property("render_spp");
+    film->metadata().remove_property("render_relative_rmse");
+
+    if (m_primary_cache) {
+        // Discard the cached hits when the geometry or the sample layout changed
+        size_t hit_count = hprod(film->size()) * total_spp;
+        if (hit_count != m_primary_hit_count ||
+            scene->geometry_revision() != m_primary_hit_revision) {
+            m_primary_hits.reset(new PrimaryHit[hit_count]);
+            m_primary_hit_count = hit_count;
+            m_primary_hit_revision = scene->geometry_revision();
+        }
+    }
+
+    m_heatmap_data.clear();
+    bool heatmap = m_heatmap;
+    if (heatmap && (is_cuda_array_v<Float> || m_distributed_role != DistributedRole::None)) {
+        Log(Warn, "Render time heatmaps are only supported by local renders on the CPU.");
+        heatmap = false;
+    }
+    if (m_error_target > 0.f &&
+        (is_cuda_array_v<Float> || m_distributed_role != DistributedRole::None))
+        Log(Warn, "Error targets are only supported by local renders on the CPU.");
+    if (heatmap) {
+        m_heatmap_size = film_size;
+        m_heatmap_data.assign(hprod(film_size), 0.f);
+    }
+
+    /// Spread the render time of a block evenly over its pixels (requires a lock)
+    auto add_block_time = [&](const ImageBlock *block, double ms) {
+        ScalarVector2i offset = block->offset() - film->crop_offset(),
+                       size   = block->size();
+        float per_pixel = float(ms / hprod(size));
+        for (int y = 0; y < size.y(); ++y)
+            for (int x = 0; x < size.x(); ++x)
+                m_heatmap_data[(size_t)(offset.y() + y) * film_size.x() + offset.x() + x] +=
+                    per_pixel;
+    };
 
+    RayStatistics ray_stats_start = Statistics::ray_statistics();
     m_render_timer.reset();
-    if constexpr (!is_cuda_array_v<Float>) {
+    if (m_distributed_role != DistributedRole::None) {
+        render_distributed(scene, sensor, channels, samples_per_pass, n_passes);
+    } else if constexpr (!is_cuda_array_v<Float>) {
         /// Render on the CPU using a spiral pattern
         size_t n_threads = __global_thread_count;
         Log(Info, "Starting render job (%ix%i, %i sample%s,%s %i thread%s)",
@@ -96,84 +477,447 @@ MTS_VARIANT bool SamplingIntegrator<Float, Spectrum>::render(Scene *scene, Senso
             m_block_size = block_size;
         }
 
-        Spiral spiral(film, m_block_size, n_passes);
+        /* In adaptive mode, each work item renders all passes of one block
+           (so that per-pixel statistics can be tracked without further
+           synchronization) and may retire early. */
+        bool adaptive = m_adaptive_threshold > 0.f && n_passes > 1;
+        if (adaptive)
+            Log(Info, "Adaptive sampling enabled (threshold %.4f, at least %i passes).",
+                m_adaptive_threshold, m_adaptive_min_passes);
+
+        bool error_target = m_error_target > 0.f;
+        if (error_target && (adaptive || n_passes < 2)) {
+            Log(Warn, "The error target requires several passes (see \"samples_per_pass\") "
+                "and is not supported with adaptive sampling, disabling it.");
+            error_target = false;
+        }
+        if (error_target)
+            Log(Info, "Rendering until the relative RMSE drops below %.4f (at least %i passes).",
+                m_error_target, m_adaptive_min_passes);
+
+        bool checkpoint = m_checkpoint_passes > 0 || m_checkpoint_interval > 0.f,
+             resume = m_checkpoint_resume;
+        if ((checkpoint || resume) && checkpoint_path(film).empty()) {
+            Log(Warn, "The film has no destination file, disabling checkpoints.");
+            checkpoint = resume = false;
+        }
+        if ((checkpoint || resume) && adaptive) {
+            Log(Warn, "Checkpoints are not supported with adaptive sampling.");
+            checkpoint = resume = false;
+        }
+
+        size_t first_pass = 0;
+        if (resume)
+            first_pass = restore_checkpoint(film, n_passes, samples_per_pass);
+
+        Spiral spiral(film, m_block_size, adaptive ? 1 : n_passes);
+
+        /* The spiral order is precomputed, so that blocks can be directly
+           indexed by the parallel range (leaving TBB free to steal work).
+           Subdivide the last blocks to reduce the tail of the render where
+           most threads would otherwise be idle. */
+        if (n_threads > 1 && m_block_size > 1 && !adaptive)
+            spiral.set_tail_subdivision(n_threads);
+
+        /* With a priority map, the passes are rendered one after the other,
+           so that the order of the blocks can follow updates of the map */
+        bool prioritized = film->priority_map() != nullptr;
+        spiral.set_priority_map(film->priority_map(), film->size());
 
         ThreadEnvironment env;
         ref<ProgressReporter> progress = new ProgressReporter("Rendering");
         std::mutex mutex;
 
-        // Total number of blocks to be handled, including multiple passes.
-        size_t total_blocks = spiral.block_count() * n_passes,
-               blocks_done = 0;
+        std::vector<NumaArena> no_arenas;
+        std::vector<NumaArena> &numa_arenas = m_numa ? numa_node_arenas() : no_arenas;
+        if (!numa_arenas.empty())
+            Log(Info, "Distributing the render threads over %i NUMA nodes.", numa_arenas.size());
 
-        tbb::parallel_for(
-            tbb::blocked_range<size_t>(0, total_blocks, 1),
-            [&](const tbb::blocked_range<size_t> &range) {
-                ScopedSetThreadEnvironment set_env(env);
-                ref<Sampler> sampler = sensor->sampler()->clone();
-                ref<ImageBlock> block = new ImageBlock(m_block_size, channels.size(),
-                                                       film->reconstruction_filter(),
-                                                       !has_aovs);
-                scoped_flush_denormals flush_denormals(true);
-                std::unique_ptr<Float[]> aovs(new Float[channels.size()]);
+        /* Total number of blocks to be handled, including multiple passes.
+           The counters below are atomic so that finished blocks don't
+           serialize the render threads (the mutex only guards the heatmap). */
+        size_t total_blocks = spiral.work_count() * (adaptive ? n_passes : 1);
+        std::atomic<size_t> blocks_done(first_pass * spiral.block_count());
+
+        /* Number of unfinished blocks and completion time of every pass for
+           the statistics (only tracked in non-adaptive mode). The tail blocks
+           belong to the last pass. */
+        std::unique_ptr<std::atomic<size_t>[]> pass_blocks(
+            new std::atomic<size_t>[n_passes]);
+        std::vector<float> pass_done(n_passes, 0.f);
+        for (size_t pass = 0; pass < n_passes; ++pass)
+            pass_blocks[pass] = pass < first_pass ? 0 : spiral.block_count();
+        if (!adaptive)
+            pass_blocks[n_passes - 1] =
+                spiral.work_count() - (n_passes - 1) * spiral.block_count();
 
-                // For each block
-                for (auto i = range.begin(); i != range.end() && !should_stop(); ++i) {
-                    auto [offset, size, block_id] = spiral.next_block();
-                    Assert(hprod(size) != 0);
-                    block->set_size(size);
-                    block->set_offset(offset);
+        /* Sampler, image block and scratch buffers of every thread. They are
+           created on first use and then reused by all ranges and passes that
+           the thread renders, which avoids allocator traffic per TBB chunk. */
+        struct ThreadState {
+            ref<Sampler> sampler;
+            ref<ImageBlock> block;
+            std::unique_ptr<Float[]> aovs;
+            AdaptiveState state;
+            bool busy = false;
+        };
+        tbb::enumerable_thread_specific<ThreadState> thread_states;
 
+        /* Render the blocks handed out by 'next_block' (which returns false
+           once the range is exhausted) on the current thread */
+        auto render_blocks = [&](auto &&next_block) {
+            ScopedSetThreadEnvironment set_env(env);
+
+            // Nested calls (if TBB steals another range while waiting) use fresh state
+            ThreadState nested_ts, &local_ts = thread_states.local();
+            ThreadState &ts = local_ts.busy ? nested_ts : local_ts;
+            ts.busy = true;
+            if (!ts.sampler) {
+                ts.sampler = sensor->sampler()->clone();
+                ts.block = new ImageBlock(m_block_size, channels.size(),
+                                          film->sample_filter(), !has_aovs);
+                ts.block->set_unfiltered_channels(unfiltered, id_layers);
+                film->configure_block(ts.block);
+                ts.aovs.reset(new Float[channels.size()]);
+            }
+            Sampler *sampler = ts.sampler;
+            ImageBlock *block = ts.block;
+            Float *aovs = ts.aovs.get();
+            AdaptiveState &state = ts.state;
+            scoped_flush_denormals flush_denormals(true);
+
+            // For each block
+            size_t i;
+            while (!should_stop() && next_block(i)) {
+                auto [offset, size, block_id] = spiral.block(i);
+                Assert(hprod(size) != 0);
+                block->set_size(size);
+                block->set_offset(offset);
+
+                if (!adaptive) {
+                    size_t pass = std::min(i / spiral.block_count(), n_passes - 1);
+                    sampler->set_pass_index((uint32_t) pass);
+                    auto block_start = std::chrono::steady_clock::now();
                     render_block(scene, sensor, sampler, block,
-                                 aovs.get(), samples_per_pass, block_id);
+                                 aovs, samples_per_pass, block_id);
+                    std::chrono::duration<double, std::milli> block_time =
+                        std::chrono::steady_clock::now() - block_start;
 
                     film->put(block);
+                    if (m_block_tap)
+                        publish_block(block, pass);
 
-                    /* Critical section: update progress bar */ {
+                    if (heatmap) {
                         std::lock_guard<std::mutex> lock(mutex);
-                        blocks_done++;
-                        progress->update(blocks_done / (ScalarFloat) total_blocks);
+                        add_block_time(block, block_time.count());
                     }
+
+                    progress->update(++blocks_done / (ScalarFloat) total_blocks);
+                    if (--pass_blocks[pass] == 0)
+                        pass_done[pass] = (float) m_render_timer.value();
+                    continue;
+                }
+
+                state.reset(hprod(size));
+                for (size_t pass = 0; pass < n_passes && !should_stop(); ++pass) {
+                    sampler->set_pass_index((uint32_t) pass);
+                    auto block_start = std::chrono::steady_clock::now();
+                    render_block(scene, sensor, sampler, block, aovs,
+                                 samples_per_pass, block_id + pass * spiral.block_count(),
+                                 state.pixel_mask.get());
+                    std::chrono::duration<double, std::milli> block_time =
+                        std::chrono::steady_clock::now() - block_start;
+
+                    film->put(block);
+                    if (m_block_tap)
+                        publish_block(block, pass);
+
+                    bool converged = update_adaptive_state(block, pass, state);
+                    size_t done = converged ? n_passes - pass : 1;
+
+                    if (heatmap) {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        add_block_time(block, block_time.count());
+                    }
+
+                    progress->update((blocks_done += done) / (ScalarFloat) total_blocks);
+
+                    if (converged)
+                        break;
                 }
             }
-        );
+            ts.busy = false;
+        };
+
+        auto render_range = [&](size_t range_begin, size_t range_end) {
+            if (numa_arenas.empty()) {
+                tbb::parallel_for(
+                    tbb::blocked_range<size_t>(range_begin, range_end, 1),
+                    [&](const tbb::blocked_range<size_t> &range) {
+                        size_t next = range.begin();
+                        render_blocks([&](size_t &i) {
+                            if (next == range.end())
+                                return false;
+                            i = next++;
+                            return true;
+                        });
+                    }
+                );
+                return;
+            }
+
+            /* One task per worker of every NUMA node arena. The workers are
+               pinned to the cores of their node (so that their samplers and
+               image blocks are allocated in node-local memory) and claim
+               blocks from a shared counter, which balances the load across
+               the nodes. */
+            std::atomic<size_t> next(range_begin);
+            auto claim = [&](size_t &i) {
+                i = next++;
+                return i < range_end;
+            };
+
+            Thread *thread = Thread::thread();
+            int thread_node = thread->numa_node();
+            std::vector<tbb::task_group> groups(numa_arenas.size());
+            for (size_t k = 0; k < numa_arenas.size(); ++k) {
+                numa_arenas[k].arena->execute([&, k]() {
+                    groups[k].run([&, k]() {
+                        const NumaArena &na = numa_arenas[k];
+                        tbb::parallel_for(size_t(0), na.concurrency, [&](size_t) {
+                            Thread *worker = Thread::thread();
+                            if (worker->numa_node() != na.node)
+                                worker->set_numa_node(na.node);
+                            render_blocks(claim);
+                        }, tbb::simple_partitioner());
+                    });
+                });
+            }
+            for (size_t k = 0; k < numa_arenas.size(); ++k)
+                numa_arenas[k].arena->execute([&, k]() { groups[k].wait(); });
+
+            // The calling thread may have joined one of the arenas
+            if (thread->numa_node() != thread_node)
+                thread->set_numa_node(thread_node);
+        };
+
+        // Number of passes whose statistics are recorded (fewer if the error target is met)
+        size_t pass_end = n_passes;
+
+        if (adaptive || !(sequential_passes() || checkpoint || prioritized || first_pass > 0 ||
+                          error_target)) {
+            render_range(0, total_blocks);
+            film->merge_splats();
+        } else {
+            /* Wait for each pass to finish before starting the next one. The
+               subdivided tail blocks are part of the last pass. Checkpoints
+               are also taken between passes, so that they are consistent. */
+            Timer checkpoint_timer;
+            ErrorState error_state;
+            ScalarFloat error = -1.f;
+            size_t passes_done = first_pass;
+            if (error_target)
+                update_error_estimate(film, error_state);
+
+            for (size_t pass = first_pass; pass < n_passes && !should_stop(); ++pass) {
+                ScopedPhase sp_pass(ProfilerPhase::RenderPass);
+                if (prioritized && pass > first_pass)
+                    spiral.set_priority_map(film->priority_map(), film->size());
+                size_t range_end = pass + 1 < n_passes ? (pass + 1) * spiral.block_count()
+                                                       : spiral.work_count();
+                render_range(pass * spiral.block_count(), range_end);
+                film->merge_splats();
+                if (should_stop())
+                    break;
+                if (sequential_passes())
+                    pass_finished(pass, n_passes);
+                passes_done = pass + 1;
+
+                if (error_target) {
+                    error = update_error_estimate(film, error_state);
+                    if (error >= 0.f)
+                        Log(Debug, "Estimated relative RMSE after %i passes: %.4f",
+                            passes_done, error);
+                    if (error >= 0.f && error_state.passes >= m_adaptive_min_passes &&
+                        error <= m_error_target) {
+                        Log(Info, "Reached the error target after %i of %i passes "
+                            "(relative RMSE %.4f).", passes_done, n_passes, error);
+                        pass_end = passes_done;
+                        break;
+                    }
+                }
+
+                bool checkpoint_due =
+                    (m_checkpoint_passes > 0 && (pass + 1) % m_checkpoint_passes == 0) ||
+                    (m_checkpoint_interval > 0.f &&
+                     checkpoint_timer.value() > 1000.f * m_checkpoint_interval);
+                if (checkpoint && checkpoint_due && pass + 1 < n_passes) {
+                    write_checkpoint(film, pass + 1, n_passes, samples_per_pass);
+                    checkpoint_timer.reset();
+                }
+            }
+
+            // Record the outcome in the image (the timeout may have stopped the render)
+            if (error_target) {
+                size_t final_spp = passes_done * samples_per_pass;
+                Statistics::set_value("spp", (double) final_spp);
+                Statistics::set_value("passes", (double) passes_done);
+                film->metadata().set_long("render_spp", (int64_t) final_spp);
+                film->metadata().set_float("render_relative_rmse", error);
+            }
+        }
+
+        if (!adaptive && !should_stop()) {
+            float last = 0.f;
+            for (size_t pass = 0; pass < pass_end; ++pass) {
+                Statistics::add_pass_time(std::max(pass_done[pass] - last, 0.f));
+                last = std::max(pass_done[pass], last);
+            }
+        }
     } else {
         Log(Info, "Start rendering...");
 
         ref<Sampler> sampler = sensor->sampler();
-        sampler->set_samples_per_wavefront((uint32_t) samples_per_pass);
-
         ScalarFloat diff_scale_factor = rsqrt((ScalarFloat) sampler->sample_count());
-        ScalarUInt32 wavefront_size = hprod(film_size) * (uint32_t) samples_per_pass;
-        if (sampler->wavefront_size() != wavefront_size)
-            sampler->seed(0, wavefront_size);
+        std::vector<Float> aovs(channels.size());
 
-        UInt32 idx = arange<UInt32>(wavefront_size);
-        if (samples_per_pass != 1)
-            idx /= (uint32_t) samples_per_pass;
+        /* Partition the frame so that every wavefront fits the memory budget:
+           first into smaller sample batches (if a single row of pixels
+           doesn't fit), then into horizontal slabs of rows */
+        size_t max_wavefront = (size_t) -1;
+        if (m_wavefront_budget > 0)
+            max_wavefront = std::max(m_wavefront_budget * 1024 * 1024 /
+                                     wavefront_bytes_per_sample, (size_t) 1);
 
-        ref<ImageBlock> block = new ImageBlock(film_size, channels.size(),
-                                               film->reconstruction_filter(),
-                                               !has_aovs);
-        block->clear();
-        block->set_offset(sensor->film()->crop_offset());
+        size_t batch_spp = samples_per_pass;
+        while (batch_spp > 1 && (size_t) film_size.x() * batch_spp > max_wavefront) {
+            do {
+                batch_spp--;
+            } while (samples_per_pass % batch_spp != 0);
+        }
+        size_t batch_count = samples_per_pass / batch_spp,
+               slab_rows   = std::min((size_t) film_size.y(),
+                                      std::max(max_wavefront / ((size_t) film_size.x() *
+                                                                batch_spp), (size_t) 1)),
+               slab_count  = (film_size.y() + slab_rows - 1) / slab_rows;
 
-        Vector2f pos = Vector2f(Float(idx % uint32_t(film_size[0])),
-                                Float(idx / uint32_t(film_size[0])));
-        pos += block->offset();
+        sampler->set_samples_per_wavefront((uint32_t) batch_spp);
 
-        std::vector<Float> aovs(channels.size());
+        if (batch_count == 1 && slab_count == 1) {
+            ScalarUInt32 wavefront_size = hprod(film_size) * (uint32_t) samples_per_pass;
+            if (sampler->wavefront_size() != wavefront_size)
+                sampler->seed(0, wavefront_size);
+
+            UInt32 idx = arange<UInt32>(wavefront_size);
+            if (samples_per_pass != 1)
+                idx /= (uint32_t) samples_per_pass;
 
-        for (size_t i = 0; i < n_passes; i++)
-            render_sample(scene, sensor, sampler, block, aovs.data(),
-                          pos, diff_scale_factor);
+            ref<ImageBlock> block = new ImageBlock(film_size, channels.size(),
+                                                   film->sample_filter(),
+                                                   !has_aovs);
+            block->set_unfiltered_channels(unfiltered, id_layers);
+            block->set_wavefront_layout((uint32_t) samples_per_pass);
+            block->set_wavefront_tile_size(m_wavefront_tile_size);
+            film->configure_block(block);
+            block->clear();
+            block->set_offset(sensor->film()->crop_offset());
 
-        film->put(block);
+            Vector2f pos = Vector2f(block->wavefront_pixel(idx));
+            pos += block->offset();
+
+            for (size_t i = 0; i < n_passes; i++) {
+                ScopedPhase sp_pass(ProfilerPhase::RenderPass);
+                sampler->set_pass_index((uint32_t) i);
+                render_sample(scene, sensor, sampler, block, aovs.data(),
+                              pos, diff_scale_factor);
+                if (sequential_passes())
+                    pass_finished(i, n_passes);
+            }
+
+            film->put(block);
+            film->merge_splats();
+        } else {
+            Log(Info, "Splitting the frame into %i slab%s of %i rows with %i sample%s per "
+                "wavefront to fit the wavefront budget of %s.", slab_count,
+                slab_count == 1 ? "" : "s", slab_rows, batch_spp, batch_spp == 1 ? "" : "s",
+                util::mem_string(m_wavefront_budget * 1024 * 1024));
+
+            /* Every wavefront is evaluated before the next one is prepared, and
+               reseeds the sampler with a unique offset */
+            for (size_t i = 0; i < n_passes && !should_stop(); i++) {
+                ScopedPhase sp_pass(ProfilerPhase::RenderPass);
+                sampler->set_pass_index((uint32_t) i);
+                for (size_t batch = 0; batch < batch_count; ++batch) {
+                    for (size_t slab = 0; slab < slab_count; ++slab) {
+                        ScalarVector2i slab_size(
+                            film_size.x(),
+                            (int) std::min(slab_rows, film_size.y() - slab * slab_rows));
+                        ScalarUInt32 wavefront_size = hprod(slab_size) * (uint32_t) batch_spp;
+                        sampler->seed((i * batch_count + batch) * slab_count + slab,
+                                      wavefront_size);
+
+                        UInt32 idx = arange<UInt32>(wavefront_size);
+                        if (batch_spp != 1)
+                            idx /= (uint32_t) batch_spp;
+
+                        ref<ImageBlock> block = new ImageBlock(slab_size, channels.size(),
+                                                               film->sample_filter(),
+                                                               !has_aovs);
+                        block->set_unfiltered_channels(unfiltered, id_layers);
+                        block->set_wavefront_layout((uint32_t) batch_spp);
+                        block->set_wavefront_tile_size(m_wavefront_tile_size);
+                        film->configure_block(block);
+                        block->clear();
+                        block->set_offset(sensor->film()->crop_offset() +
+                                          ScalarVector2i(0, (int) (slab * slab_rows)));
+
+                        Vector2f pos = Vector2f(block->wavefront_pixel(idx));
+                        pos += block->offset();
+
+                        render_sample(scene, sensor, sampler, block, aovs.data(),
+                                      pos, diff_scale_factor);
+                        film->put(block);
+
+                        cuda_eval();
+                        cuda_sync();
+                    }
+                }
+                film->merge_splats();
+                if (sequential_passes())
+                    pass_finished(i, n_passes);
+            }
+        }
+    }
+
+    Statistics::add_time("render", (float) m_render_timer.value());
+
+    if (heatmap && !m_stop) {
+        fs::path path = m_heatmap_file;
+        if (path.empty()) {
+            path = film->destination_file();
+            if (!path.empty())
+                path.replace_extension(".heatmap.exr");
+        }
+        if (!path.empty()) {
+            Log(Info, "Writing render time heatmap \"%s\" ..", path.string());
+            heatmap()->write(path);
+        }
     }
 
-    if (!m_stop)
+    RayStatistics ray_stats = Statistics::ray_statistics() - ray_stats_start;
+    ray_stats.time = m_render_timer.value() * 1e-3;
+    scene->set_ray_statistics(ray_stats);
+
+    if (!m_stop) {
         Log(Info, "Rendering finished. (took %s)",
             util::time_string(m_render_timer.value(), true));
+        if (ray_stats.traced() > 0)
+            Log(Info, "Traced %llu primary, %llu secondary and %llu shadow rays (%.2f Mrays/s)",
+                (unsigned long long) ray_stats.primary(),
+                (unsigned long long) ray_stats.secondary(),
+                (unsigned long long) ray_stats.shadow(),
+                ray_stats.rays_per_second() * 1e-6);
+    }
 
     return !m_stop;
 }
@@ -184,30 +928,98 @@ MTS_VARIANT void SamplingIntegrator<Float, Spectrum>::render_block(const Scene *
                                                                    ImageBlock *block,
                                                                    Float *aovs,
                                                                    size_t sample_count_,
-                                                                   size_t block_id) const {
+                                                                   size_t block_id,
+                                                                   const uint32_t *pixel_mask) const {
+    ScopedPhase sp(ProfilerPhase::RenderBlock);
     block->clear();
-    uint32_t pixel_count  = (uint32_t)(m_block_size * m_block_size),
+
+    /* Only traverse the smallest power-of-two square that covers the block.
+       Seeds are spaced using the maximum block size so that they remain
+       unique when blocks are subdivided. */
+    uint32_t block_size   = math::round_to_power_of_two((uint32_t) hmax(block->size())),
+             pixel_count  = block_size * block_size,
+             seed_stride  = m_block_size * m_block_size,
              sample_count = (uint32_t)(sample_count_ == (size_t) -1
                                            ? sampler->sample_count()
                                            : sample_count_);
 
     ScalarFloat diff_scale_factor = rsqrt((ScalarFloat) sampler->sample_count());
+    ScalarVector2i film_size = sensor->film()->size();
 
     if constexpr (!is_array_v<Float>) {
+        // Defer the shadow rays of the samples, see add_unoccluded()
+        ShadowQueue *queue = nullptr;
+        if (m_shadow_batch > 0) {
+            static thread_local ShadowQueue shadow_queue;
+            queue = &shadow_queue;
+            queue->clear();
+            queue->owner = this;
+            shadow_queue_slot = queue;
+        }
+
         for (uint32_t i = 0; i < pixel_count && !should_stop(); ++i) {
-            sampler->seed(block_id * pixel_count + i);
+            if (!m_pixel_seeds)
+                sampler->seed(block_id * seed_stride + i);
 
             ScalarPoint2u pos = enoki::morton_decode<ScalarPoint2u>(i);
             if (any(pos >= block->size()))
                 continue;
+            if (pixel_mask && !pixel_mask[pos.x() + pos.y() * block->width()])
+                continue;
 
             pos += block->offset();
+            if (m_pixel_seeds)
+                sampler->seed(pixel_seed(film_size, pos.x(), pos.y(), sampler->pass_index()));
+
+            // Cache entries of the samples of this pass, which follow the ones of earlier passes
+            PrimaryHit *hits = nullptr;
+            size_t first_sample = (size_t) sampler->pass_index() * sample_count,
+                   total_spp    = sampler->sample_count();
+            if (m_primary_hits && first_sample + sample_count <= total_spp &&
+                (size_t) hprod(film_size) * total_spp == m_primary_hit_count)
+                hits = m_primary_hits.get() +
+                       ((size_t) pos.y() * film_size.x() + pos.x()) * total_spp + first_sample;
+
             for (uint32_t j = 0; j < sample_count && !should_stop(); ++j) {
+                primary_hit_slot = hits ? hits + j : nullptr;
                 render_sample(scene, sensor, sampler, block, aovs,
                               pos, diff_scale_factor);
             }
+            primary_hit_slot = nullptr;
+        }
+
+        if (queue) {
+            flush_shadow_queue(scene, block, aovs, *queue);
+            shadow_queue_slot = nullptr;
         }
     } else if constexpr (is_array_v<Float> && !is_cuda_array_v<Float>) {
+        ENOKI_MARK_USED(seed_stride);
+
+        if (m_pixel_seeds) {
+            /* Every pixel is seeded separately, hence its samples are rendered
+               together (the packets are only full if the sample count is large) */
+            for (uint32_t i = 0; i < pixel_count && !should_stop(); ++i) {
+                ScalarPoint2u pos = enoki::morton_decode<ScalarPoint2u>(i);
+                if (any(pos >= block->size()))
+                    continue;
+                if (pixel_mask && !pixel_mask[pos.x() + pos.y() * block->width()])
+                    continue;
+
+                pos += block->offset();
+                sampler->seed(pixel_seed(film_size, pos.x(), pos.y(), sampler->pass_index()));
+
+                Vector2f pixel_pos(Float((ScalarFloat) pos.x()), Float((ScalarFloat) pos.y()));
+                for (auto [index, active] : range<UInt32>(sample_count)) {
+                    if (should_stop())
+                        break;
+                    ENOKI_MARK_USED(index);
+                    render_sample(scene, sensor, sampler, block, aovs, pixel_pos,
+                                  diff_scale_factor, active);
+                }
+            }
+            return;
+        }
+
         // Ensure that the sample generation is fully deterministic
         sampler->seed(block_id);
 
@@ -216,6 +1028,12 @@ MTS_VARIANT void SamplingIntegrator<Float, Spectrum>::render_block(const Scene *
                 break;
             Point2u pos = enoki::morton_decode<Point2u>(index / UInt32(sample_count));
             active &= !any(pos >= block->size());
+            if (pixel_mask) {
+                UInt32 pixel_index = pos.x() + pos.y() * UInt32(block->width());
+                active &= neq(gather<UInt32>(pixel_mask, pixel_index, active), 0u);
+                if (none(active))
+                    continue;
+            }
             pos += block->offset();
             render_sample(scene, sensor, sampler, block, aovs, pos, diff_scale_factor, active);
         }
@@ -225,11 +1043,482 @@ MTS_VARIANT void SamplingIntegrator<Float, Spectrum>::render_block(const Scene *
         ENOKI_MARK_USED(aovs);
         ENOKI_MARK_USED(diff_scale_factor);
         ENOKI_MARK_USED(pixel_count);
+        ENOKI_MARK_USED(seed_stride);
+        ENOKI_MARK_USED(film_size);
         ENOKI_MARK_USED(sample_count);
+        ENOKI_MARK_USED(pixel_mask);
         Throw("Not implemented for CUDA arrays.");
     }
 }
 
+MTS_VARIANT bool
+SamplingIntegrator<Float, Spectrum>::update_adaptive_state(const ImageBlock *block,
+                                                           size_t pass,
+                                                           AdaptiveState &state) const {
+    if constexpr (is_cuda_array_v<Float>) {
+        ENOKI_MARK_USED(block);
+        ENOKI_MARK_USED(pass);
+        ENOKI_MARK_USED(state);
+        Throw("Not implemented for CUDA arrays.");
+    } else {
+        const ScalarFloat *data = (const ScalarFloat *) block->data().data();
+        uint32_t channels = (uint32_t) block->channel_count(),
+                 border   = (uint32_t) block->border_size(),
+                 width    = (uint32_t) block->width(),
+                 height   = (uint32_t) block->height(),
+                 stride   = width + 2 * border;
+
+        // Number of passes that active pixels have received so far
+        ScalarFloat n = ScalarFloat(pass + 1);
+        bool converged = true;
+
+        for (uint32_t y = 0; y < height; ++y) {
+            for (uint32_t x = 0; x < width; ++x) {
+                uint32_t i = x + y * width;
+                if (!state.pixel_mask[i])
+                    continue;
+
+                /* Estimate of the pixel luminance computed by this pass. The
+                   block was cleared at the beginning of the pass. */
+                const ScalarFloat *pixel = data + channels * ((y + border) * stride + x + border);
+                ScalarFloat value = pixel[4] > 0.f ? pixel[1] / pixel[4] : 0.f;
+
+                // Welford's online algorithm for the mean and variance
+                ScalarFloat delta = value - state.mean[i];
+                state.mean[i] += delta / n;
+                state.m2[i] += delta * (value - state.mean[i]);
+
+                if (pass + 1 < m_adaptive_min_passes) {
+                    converged = false;
+                    continue;
+                }
+
+                /* Relative standard error of the mean. The small constant
+                   prevents dark pixels from never converging. */
+                ScalarFloat std_error = std::sqrt(state.m2[i] / ((n - 1.f) * n));
+                if (std_error <= m_adaptive_threshold * (std::abs(state.mean[i]) + 1e-3f))
+                    state.pixel_mask[i] = 0;
+                else
+                    converged = false;
+            }
+        }
+
+        return converged;
+    }
+}
+
+MTS_VARIANT typename SamplingIntegrator<Float, Spectrum>::ScalarFloat
+SamplingIntegrator<Float, Spectrum>::update_error_estimate(Film *film,
+                                                           ErrorState &state) const {
+    ref<Bitmap> bitmap = film->bitmap(true);
+    const ScalarFloat *data = (const ScalarFloat *) bitmap->data();
+    size_t channels = bitmap->channel_count(),
+           pixels   = hprod(bitmap->size());
+
+    if (state.y.size() != pixels) {
+        state.y.assign(pixels, 0.f);
+        state.w.assign(pixels, 0.f);
+        state.mean.assign(pixels, 0.f);
+        state.m2.assign(pixels, 0.f);
+        for (size_t i = 0; i < pixels; ++i) {
+            state.y[i] = data[i * channels + 1];
+            state.w[i] = data[i * channels + 4];
+        }
+        state.passes = 0;
+        return -1.f;
+    }
+
+    // Number of passes that contributed to the statistics so far
+    ScalarFloat n = ScalarFloat(++state.passes);
+    double sum = 0.0;
+
+    for (size_t i = 0; i < pixels; ++i) {
+        // Estimate of the pixel luminance computed by the last pass
+        ScalarFloat y = data[i * channels + 1], w = data[i * channels + 4],
+                    dw = w - state.w[i],
+                    value = dw > 0.f ? (y - state.y[i]) / dw : 0.f;
+        state.y[i] = y;
+        state.w[i] = w;
+
+        // Welford's online algorithm for the mean and variance
+        ScalarFloat delta = value - state.mean[i];
+        state.mean[i] += delta / n;
+        state.m2[i] += delta * (value - state.mean[i]);
+
+        // Squared standard error of the mean relative to the pixel value (see adaptive sampling)
+        ScalarFloat scale = std::abs(state.mean[i]) + 1e-3f;
+        if (state.passes > 1)
+            sum += state.m2[i] / ((n - 1.f) * n * scale * scale);
+    }
+
+    if (state.passes < 2)
+        return -1.f;
+    return (ScalarFloat) std::sqrt(sum / (double) pixels);
+}
+
+MTS_VARIANT void SamplingIntegrator<Float, Spectrum>::pass_finished(size_t /* pass */,
+                                                                    size_t /* pass_count */) { }
+
+MTS_VARIANT fs::path SamplingIntegrator<Float, Spectrum>::checkpoint_path(const Film *film) const {
+    if (!m_checkpoint_file.empty())
+        return m_checkpoint_file;
+    fs::path path = film->destination_file();
+    if (!path.empty())
+        path.replace_extension(".checkpoint.exr");
+    return path;
+}
+
+MTS_VARIANT size_t SamplingIntegrator<Float, Spectrum>::restore_checkpoint(
+    Film *film, size_t pass_count, size_t samples_per_pass) const {
+    fs::path path = checkpoint_path(film);
+    if (!fs::exists(path)) {
+        Log(Info, "No checkpoint found at \"%s\", starting from scratch.", path.string());
+        return 0;
+    }
+
+    ref<Bitmap> bitmap = new Bitmap(path);
+    const Properties &metadata = bitmap->metadata();
+    if (!metadata.has_property("checkpoint_passes") ||
+        !metadata.has_property("checkpoint_pass_count") ||
+        !metadata.has_property("checkpoint_samples_per_pass"))
+        Throw("\"%s\" is not a valid checkpoint!", path.string());
+
+    if ((size_t) metadata.int_("checkpoint_pass_count") != pass_count ||
+        (size_t) metadata.int_("checkpoint_samples_per_pass") != samples_per_pass)
+        Throw("The checkpoint \"%s\" was created with a different sample count "
+              "(%i passes of %i samples, expected %i passes of %i samples).",
+              path.string(), metadata.int_("checkpoint_pass_count"),
+              metadata.int_("checkpoint_samples_per_pass"), pass_count, samples_per_pass);
+
+    size_t passes_done = std::min((size_t) metadata.int_("checkpoint_passes"), pass_count);
+    film->restore(bitmap);
+
+    Log(Info, "Resuming from checkpoint \"%s\" after %i of %i passes.", path.string(),
+        passes_done, pass_count);
+    return passes_done;
+}
+
+MTS_VARIANT void SamplingIntegrator<Float, Spectrum>::write_checkpoint(
+    Film *film, size_t passes_done, size_t pass_count, size_t samples_per_pass) {
+    if (m_checkpoint_pending) {
+        Log(Debug, "The previous checkpoint is still being written, skipping.");
+        return;
+    }
+
+    // Only the copy of the film contents happens on the rendering thread
+    ref<Bitmap> bitmap = film->snapshot();
+    Properties &metadata = bitmap->metadata();
+    metadata.set_long("checkpoint_passes", (int64_t) passes_done);
+    metadata.set_long("checkpoint_pass_count", (int64_t) pass_count);
+    metadata.set_long("checkpoint_samples_per_pass", (int64_t) samples_per_pass);
+
+    class CheckpointTask : public tbb::task {
+        ref<const Object> owner;
+        ref<Bitmap> bitmap;
+        fs::path path;
+        std::atomic<bool> *pending;
+
+    public:
+        CheckpointTask(const Object *owner, Bitmap *bitmap, const fs::path &path,
+                       std::atomic<bool> *pending)
+            : owner(owner), bitmap(bitmap), path(path), pending(pending) { }
+
+        tbb::task* execute() override {
+            /* Write to a temporary file first, so that an interruption
+               never leaves a partially written checkpoint behind */
+            fs::path temp_path = path;
+            temp_path.replace_extension(".tmp");
+            try {
+                bitmap->write(temp_path, Bitmap::FileFormat::OpenEXR);
+                if (!fs::rename(temp_path, path)) {
+                    fs::remove(path);
+                    if (!fs::rename(temp_path, path))
+                        Throw("Could not rename \"%s\"!", temp_path.string());
+                }
+            } catch (const std::exception &e) {
+                Log(Warn, "Could not write checkpoint \"%s\": %s", path.string(), e.what());
+            }
+            *pending = false;
+            return nullptr;
+        }
+    };
+
+    fs::path path = checkpoint_path(film);
+    Log(Info, "Writing checkpoint \"%s\" (%i of %i passes) ..", path.string(),
+        passes_done, pass_count);
+
+    m_checkpoint_pending = true;
+    CheckpointTask *t = new (tbb::task::allocate_root())
+        CheckpointTask(this, bitmap, path, &m_checkpoint_pending);
+    tbb::task::enqueue(*t);
+}
+
+MTS_VARIANT void SamplingIntegrator<Float, Spectrum>::render_distributed(
+    const Scene *scene, Sensor *sensor, const std::vector<std::string> &channels,
+    size_t samples_per_pass, size_t pass_count) {
+    ref<Film> film = sensor->film();
+    const ReconstructionFilter *rfilter = film->sample_filter();
+    bool has_aovs = channels.size() > 5;
+
+    // Deep samples aren't part of the blocks exchanged with the workers
+    ref<ImageBlock> probe = new ImageBlock(ScalarVector2i(1), channels.size());
+    film->configure_block(probe);
+    if (probe->deep_samples() != 0)
+        Throw("Deep film output is not supported by distributed rendering!");
+
+    /* The coordinator and the workers must agree on the block size, which
+       also determines the sampler seeds (see render_block()). GPU workers
+       render a whole block per wavefront, hence they use larger blocks. */
+    if (m_block_size == 0)
+        m_block_size = m_distributed_block_size > 0
+                           ? math::round_to_power_of_two(m_distributed_block_size)
+                           : (is_cuda_array_v<Float> ? 256 : MTS_BLOCK_SIZE);
+
+    std::string channel_names;
+    for (const std::string &name : channels)
+        channel_names += (channel_names.empty() ? "" : ",") + name;
+
+    /* Only the color representation of the variant matters, so that CPU and
+       GPU variants (e.g. packet_rgb and gpu_rgb) can render together */
+    std::string color = class_()->variant();
+    color = color.substr(color.find('_') + 1);
+    if (string::starts_with(color, "autodiff_"))
+        color = color.substr(9);
+
+    std::string configuration = tfm::format(
+        "%s, size=%ix%i, offset=%ix%i, channels=%s, block_size=%i, spp=%i, "
+        "passes=%i, filter=%s (radius %f)",
+        color, film->crop_size().x(), film->crop_size().y(),
+        film->crop_offset().x(), film->crop_offset().y(), channel_names,
+        m_block_size, samples_per_pass, pass_count, rfilter->class_()->name(),
+        rfilter->radius());
+
+    if (m_distributed_role == DistributedRole::Worker) {
+        Log(Info, "Connecting to the coordinator at \"%s\" ..", m_distributed_address);
+        size_t blocks_done =
+            render_distributed_worker(scene, sensor, channels, m_distributed_address,
+                                      configuration, samples_per_pass, pass_count);
+        Log(Info, "Rendered %i image block%s for the coordinator.", blocks_done,
+            blocks_done == 1 ? "" : "s");
+        return;
+    }
+
+    // Coordinator: hand out all blocks of all passes
+    Spiral spiral(film, m_block_size, pass_count);
+    std::vector<RenderWorkItem> items(spiral.work_count());
+    for (size_t i = 0; i < items.size(); ++i) {
+        auto [offset, size, block_id] = spiral.block(i);
+        items[i] = RenderWorkItem{ (uint64_t) i, { offset.x(), offset.y() },
+                                   { size.x(), size.y() }, (uint64_t) block_id };
+    }
+
+    Log(Info, "Distributing %i image blocks at \"%s\" (%ix%i, %i sample%s per pass, "
+        "%i pass%s)", items.size(), m_distributed_address, film->crop_size().x(),
+        film->crop_size().y(), samples_per_pass, samples_per_pass == 1 ? "" : "s",
+        pass_count, pass_count == 1 ? "" : "es");
+
+    ref<ProgressReporter> progress = new ProgressReporter("Rendering");
+    ref<ImageBlock> block = new ImageBlock(m_block_size, channels.size(), rfilter,
+                                           !has_aovs);
+    size_t blocks_done = 0;
+
+    ref<RenderCoordinator> coordinator =
+        new RenderCoordinator(m_distributed_address, configuration);
+
+    /* The coordinator can also render blocks itself, using a worker that
+       connects to its own address from a separate thread */
+    std::thread local_worker;
+    std::exception_ptr local_error;
+    ThreadEnvironment env;
+    std::string local_address = m_distributed_address;
+
+    if (m_distributed_local) {
+        for (const char *any : { "tcp://*:", "tcp://0.0.0.0:" })
+            if (string::starts_with(local_address, any))
+                local_address = "tcp://localhost:" + local_address.substr(strlen(any));
+
+        local_worker = std::thread([&]() {
+            Thread::register_external_thread("local");
+            /* scoped */ {
+                ScopedSetThreadEnvironment set_env(env);
+                try {
+                    size_t count = render_distributed_worker(
+                        scene, sensor, channels, local_address, configuration,
+                        samples_per_pass, pass_count);
+                    Log(Info, "Rendered %i image block%s locally.", count,
+                        count == 1 ? "" : "s");
+                } catch (...) {
+                    local_error = std::current_exception();
+                    cancel();
+                }
+            }
+            Thread::unregister_external_thread();
+        });
+    }
+
+    auto join_local = [&]() {
+        if (local_worker.joinable())
+            local_worker.join();
+    };
+
+    bool complete = false;
+    try {
+        complete = coordinator->run(
+            items,
+            [&](const RenderWorkItem &item, const uint8_t *data, size_t size) {
+                block->set_size(ScalarVector2i(item.size[0], item.size[1]));
+                block->set_offset(ScalarPoint2i(item.offset[0], item.offset[1]));
+
+                size_t expected = block->channel_count() *
+                                  hprod(block->size() + 2 * block->border_size()) *
+                                  sizeof(ScalarFloat);
+                if (size != expected) {
+                    Log(Warn, "Discarding image block %i, which has an invalid size "
+                        "(%i bytes, expected %i bytes).", item.index, size, expected);
+                    return;
+                }
+
+                if constexpr (is_cuda_array_v<Float>)
+                    block->data() = DynamicBuffer<Float>::copy((const ScalarFloat *) data,
+                                                               size / sizeof(ScalarFloat));
+                else
+                    memcpy(block->data().data(), data, size);
+                film->put(block);
+                if (m_block_tap)
+                    publish_block(block, std::min((size_t) item.index / spiral.block_count(),
+                                                  pass_count - 1));
+                progress->update(++blocks_done / (ScalarFloat) items.size());
+            },
+            [&]() { return should_stop(); });
+    } catch (...) {
+        cancel();
+        join_local();
+        throw;
+    }
+
+    join_local();
+    if (local_error)
+        std::rethrow_exception(local_error);
+
+    if (!complete && !should_stop())
+        Log(Warn, "Only %i of %i image blocks were rendered.", blocks_done, items.size());
+    Log(Info, "Merged the results of %i worker thread%s.", coordinator->worker_count(),
+        coordinator->worker_count() == 1 ? "" : "s");
+}
+
+MTS_VARIANT size_t SamplingIntegrator<Float, Spectrum>::render_distributed_worker(
+    const Scene *scene, Sensor *sensor, const std::vector<std::string> &channels,
+    const std::string &address, const std::string &configuration,
+    size_t samples_per_pass, size_t pass_count) {
+    ref<Film> film = sensor->film();
+    const ReconstructionFilter *rfilter = film->sample_filter();
+    std::vector<bool> unfiltered = film->unfiltered_channels(channels);
+    std::vector<uint32_t> id_layers = film->id_channels(channels);
+    bool has_aovs = channels.size() > 5;
+
+    // The coordinator hands out the blocks of the spiral pass by pass
+    size_t pass_blocks = Spiral(film, m_block_size, pass_count).block_count(),
+           blocks_done = 0;
+    auto item_pass = [&](const RenderWorkItem &item) {
+        return (uint32_t) std::min((size_t) item.index / pass_blocks, pass_count - 1);
+    };
+
+    if constexpr (is_cuda_array_v<Float>) {
+        /* A GPU worker renders one block per wavefront. Processes that drive
+           different devices of a node are simply separate workers. */
+        ref<Sampler> sampler = sensor->sampler();
+        sampler->set_samples_per_wavefront((uint32_t) samples_per_pass);
+        ScalarFloat diff_scale_factor = rsqrt((ScalarFloat) sampler->sample_count());
+        ref<ImageBlock> block = new ImageBlock(m_block_size, channels.size(), rfilter,
+                                               !has_aovs);
+        block->set_unfiltered_channels(unfiltered, id_layers);
+        block->set_wavefront_layout((uint32_t) samples_per_pass);
+        block->set_wavefront_tile_size(m_wavefront_tile_size);
+        std::vector<Float> aovs(channels.size());
+        std::vector<ScalarFloat> result;
+
+        ref<RenderWorker> worker = new RenderWorker(address, configuration);
+        RenderWorkItem item;
+        const uint8_t *data = nullptr;
+        size_t size = 0;
+
+        while (!should_stop() && worker->next(item, data, size)) {
+            ScalarVector2i block_size(item.size[0], item.size[1]);
+            block->set_size(block_size);
+            block->set_offset(ScalarPoint2i(item.offset[0], item.offset[1]));
+            block->clear();
+
+            ScalarUInt32 wavefront_size = hprod(block_size) * (uint32_t) samples_per_pass;
+            sampler->seed(item.block_id, wavefront_size);
+            sampler->set_pass_index(item_pass(item));
+
+            UInt32 idx = arange<UInt32>(wavefront_size);
+            if (samples_per_pass != 1)
+                idx /= (uint32_t) samples_per_pass;
+            Vector2f pos = Vector2f(block->wavefront_pixel(idx));
+            pos += block->offset();
+
+            render_sample(scene, sensor, sampler, block, aovs.data(), pos,
+                          diff_scale_factor);
+
+            cuda_eval();
+            cuda_sync();
+            result.resize(block->channel_count() *
+                          hprod(block->size() + 2 * block->border_size()));
+            cuda_memcpy_from_device(result.data(), block->data().data(),
+                                    result.size() * sizeof(ScalarFloat));
+
+            data = (const uint8_t *) result.data();
+            size = result.size() * sizeof(ScalarFloat);
+            blocks_done++;
+        }
+    } else {
+        size_t n_threads = __global_thread_count;
+        ThreadEnvironment env;
+        std::mutex mutex;
+
+        // Every thread requests (and renders) one block at a time
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, n_threads, 1),
+            [&](const tbb::blocked_range<size_t> &range) {
+                ScopedSetThreadEnvironment set_env(env);
+                ref<Sampler> sampler = sensor->sampler()->clone();
+                ref<ImageBlock> block = new ImageBlock(m_block_size, channels.size(),
+                                                       rfilter, !has_aovs);
+                block->set_unfiltered_channels(unfiltered, id_layers);
+                scoped_flush_denormals flush_denormals(true);
+                std::unique_ptr<Float[]> aovs(new Float[channels.size()]);
+
+                for (auto i = range.begin(); i != range.end(); ++i) {
+                    ref<RenderWorker> worker = new RenderWorker(address, configuration);
+                    RenderWorkItem item;
+                    const uint8_t *data = nullptr;
+                    size_t size = 0, count = 0;
+
+                    while (!should_stop() && worker->next(item, data, size)) {
+                        block->set_size(ScalarVector2i(item.size[0], item.size[1]));
+                        block->set_offset(ScalarPoint2i(item.offset[0], item.offset[1]));
+                        sampler->set_pass_index(item_pass(item));
+                        render_block(scene, sensor, sampler, block, aovs.get(),
+                                     samples_per_pass, (size_t) item.block_id);
+
+                        data = (const uint8_t *) block->data().data();
+                        size = block->channel_count() *
+                               hprod(block->size() + 2 * block->border_size()) *
+                               sizeof(ScalarFloat);
+                        count++;
+                    }
+
+                    std::lock_guard<std::mutex> lock(mutex);
+                    blocks_done += count;
+                }
+            }
+        );
+    }
+
+    return blocks_done;
+}
+
 MTS_VARIANT void
 SamplingIntegrator<Float, Spectrum>::render_sample(const Scene *scene,
                                                    const Sensor *sensor,
@@ -239,6 +1528,7 @@ SamplingIntegrator<Float, Spectrum>::render_sample(const Scene *scene,
                                                    const Vector2f &pos,
                                                    ScalarFloat diff_scale_factor,
                                                    Mask active) const {
+    sampler->set_pixel(Point2u(pos));
     Vector2f position_sample = pos + sampler->next_2d(active);
 
     Point2f aperture_sample(.5f);
@@ -257,34 +1547,106 @@ SamplingIntegrator<Float, Spectrum>::render_sample(const Scene *scene,
 
     auto [ray, ray_weight] = sensor->sample_ray_differential(
         time, wavelength_sample, adjusted_position, aperture_sample);
+    Statistics::count_rays(RayCounter::Primary, active);
 
     ray.scale_differential(diff_scale_factor);
 
     const Medium *medium = sensor->medium();
     std::pair<Spectrum, Mask> result = sample(scene, sampler, ray, medium, aovs + 5, active);
-    result.first = ray_weight * result.first;
 
-    UnpolarizedSpectrum spec_u = depolarize(result.first);
+    if constexpr (!is_array_v<Float>) {
+        ShadowQueue *queue = (ShadowQueue *) shadow_queue_slot;
+        if (queue && queue->owner == this) {
+            // The sample is splatted once its shadow rays have been traced
+            queue->positions.push_back(position_sample);
+            queue->wavelengths.push_back(ray.wavelengths);
+            queue->ray_weights.push_back(ray_weight);
+            queue->results.push_back(result.first);
+            queue->valid.push_back(result.second);
+            queue->aovs.insert(queue->aovs.end(), aovs + 5,
+                               aovs + block->channel_count());
+
+            if (queue->rays.size() >= m_shadow_batch ||
+                queue->positions.size() >= m_shadow_batch)
+                flush_shadow_queue(scene, block, aovs, *queue);
+
+            sampler->advance();
+            return;
+        }
+    }
+
+    put_sample(block, aovs, position_sample, ray.wavelengths,
+               ray_weight * result.first, result.second, active);
+
+    sampler->advance();
+}
+
+MTS_VARIANT void
+SamplingIntegrator<Float, Spectrum>::put_sample(ImageBlock *block, Float *aovs,
+                                                const Vector2f &position,
+                                                const Wavelength &wavelengths,
+                                                const Spectrum &value, Mask valid,
+                                                Mask active) const {
+    UnpolarizedSpectrum spec_u = depolarize(value);
 
     Color3f xyz;
     if constexpr (is_monochromatic_v<Spectrum>) {
+        ENOKI_MARK_USED(wavelengths);
         xyz = spec_u.x();
     } else if constexpr (is_rgb_v<Spectrum>) {
+        ENOKI_MARK_USED(wavelengths);
         xyz = srgb_to_xyz(spec_u, active);
     } else {
         static_assert(is_spectral_v<Spectrum>);
-        xyz = spectrum_to_xyz(spec_u, ray.wavelengths, active);
+        xyz = spectrum_to_xyz(spec_u, wavelengths, active);
     }
 
     aovs[0] = xyz.x();
     aovs[1] = xyz.y();
     aovs[2] = xyz.z();
-    aovs[3] = select(result.second, Float(1.f), Float(0.f));
+    aovs[3] = select(valid, Float(1.f), Float(0.f));
     aovs[4] = 1.f;
+    if (block->has_unfiltered_channels())
+        aovs[block->channel_count() - 1] = 1.f; // W.unfiltered
+
+    block->put(position, aovs, active);
+}
 
-    block->put(position_sample, aovs, active);
+MTS_VARIANT void
+SamplingIntegrator<Float, Spectrum>::flush_shadow_queue(const Scene *scene, ImageBlock *block,
+                                                        Float *aovs, ShadowQueue &queue) const {
+    if constexpr (!is_array_v<Float>) {
+        size_t ray_count = queue.rays.size();
+        if (ray_count > 0) {
+            if (queue.hit_size < ray_count) {
+                queue.hit.reset(new Mask[ray_count]);
+                queue.hit_size = ray_count;
+            }
 
-    sampler->advance();
+            scene->ray_test_batch(queue.rays.data(), ray_count, queue.hit.get());
+
+            for (size_t i = 0; i < ray_count; ++i) {
+                if (!queue.hit[i])
+                    queue.results[queue.targets[i]] += queue.values[i];
+            }
+        }
+
+        size_t aov_count = block->channel_count() - 5;
+        for (size_t i = 0; i < queue.positions.size(); ++i) {
+            std::copy(queue.aovs.begin() + i * aov_count,
+                      queue.aovs.begin() + (i + 1) * aov_count, aovs + 5);
+            put_sample(block, aovs, queue.positions[i], queue.wavelengths[i],
+                       queue.ray_weights[i] * queue.results[i], queue.valid[i], true);
+        }
+
+        queue.clear();
+    } else {
+        ENOKI_MARK_USED(scene);
+        ENOKI_MARK_USED(block);
+        ENOKI_MARK_USED(aovs);
+        ENOKI_MARK_USED(queue);
+        Throw("Shadow ray batching is only supported in scalar variants.");
+    }
 }
 
 MTS_VARIANT std::pair<Spectrum, typename SamplingIntegrator<Float, Spectrum>::Mask>
@@ -1,6 +1,11 @@
 #include <mitsuba/render/kdtree.h>
 #include <mitsuba/render/mesh.h>
 #include <mitsuba/core/properties.h>
+#include <mitsuba/core/hash.h>
+#include <mitsuba/core/memreport.h>
+#include <mitsuba/core/mmap.h>
+#include <algorithm>
+#include <string_view>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -44,23 +49,175 @@ MTS_VARIANT ShapeKDTree<Float, Spectrum>::ShapeKDTree(const Properties &props)
     if (props.has_property("kd_exact_primitive_threshold"))
         set_exact_primitive_threshold(props.int_("kd_exact_primitive_threshold"));
 
+    /* kd-tree construction: Memory budget, specified as the maximum number
+       of primitive references per primitive (e.g. 2). Primitives stop being
+       duplicated across split planes once it is reached. */
+    if (props.has_property("kd_max_duplication"))
+        set_max_duplication(props.float_("kd_max_duplication"));
+
+    /* kd-tree cache: Directory in which built trees are stored, keyed by a
+       hash of the geometry and the build parameters. Subsequent loads of
+       unchanged geometry then skip the construction. */
+    if (props.has_property("kd_cache_dir"))
+        m_cache_dir = props.string("kd_cache_dir");
+
+    /* kd-tree cache: Reference the nodes and indices in the mapped cache
+       file instead of copying them. Processes that load the same tree then
+       share its physical pages (e.g. with a cache directory in /dev/shm). */
+    m_cache_shared = props.bool_("kd_cache_shared", false);
+
+    /* kd-tree traversal: Test a scalar ray against several triangles of a
+       leaf at once using SIMD instructions (scalar variants only). This
+       requires additional storage for the pre-gathered triangles. */
+    m_use_triangle_packets = props.bool_("kd_triangle_packets", true);
+
+    /* kd-tree traversal: Split packets of rays into groups with the same
+       direction octant, which are traversed separately in a fixed
+       near-to-far order (packet variants only) */
+    m_split_packets = props.bool_("kd_split_packets", true);
+
     m_primitive_map.push_back(0);
 }
 
 MTS_VARIANT void ShapeKDTree<Float, Spectrum>::build() {
     Timer timer;
+    m_geometry_hash = geometry_hash();
+
+    fs::path cache_path;
+    uint64_t key = 0;
+    if (!m_cache_dir.empty()) {
+        key = cache_key(m_geometry_hash);
+        char filename[32];
+        snprintf(filename, sizeof(filename), "%016llx.kdtree", (unsigned long long) key);
+        cache_path = m_cache_dir / fs::path(filename);
+
+        if (load_cache(cache_path, key)) {
+            build_triangle_packets();
+            Log(Info, "Loaded a SAH kd-tree (%i primitives) from \"%s\" (took %s)",
+                primitive_count(), cache_path.string(),
+                util::time_string(timer.value()));
+            return;
+        }
+    }
+
     Log(Info, "Building a SAH kd-tree (%i primitives) ..",
         primitive_count());
 
     Base::build();
 
-    Log(Info, "Finished. (%s of storage, took %s)",
+    if (!cache_path.empty())
+        save_cache(cache_path, key);
+
+    build_triangle_packets();
+
+    size_t packet_size = m_triangle_packets.size() * sizeof(TrianglePacket);
+    if (m_leaf_triangles)
+        packet_size += m_index_count * sizeof(LeafTriangles);
+
+    Log(Info, "Finished. (%s of storage, %.2f references/primitive, took %s, "
+        "peak memory usage: %s)",
         util::mem_string(m_index_count * sizeof(Index) +
-                        m_node_count * sizeof(KDNode)),
-        util::time_string(timer.value())
+                        m_node_count * sizeof(KDNode) + packet_size),
+        m_index_count / (double) std::max(primitive_count(), 1u),
+        util::time_string(timer.value()),
+        util::mem_string(util::peak_memory_usage())
     );
 }
 
+MTS_VARIANT void ShapeKDTree<Float, Spectrum>::build_triangle_packets() {
+    m_triangle_packets.clear();
+    m_leaf_triangles.reset();
+
+    if constexpr (is_array_v<Float>) {
+        // The packet variants trace several rays at once instead
+        return;
+    } else {
+        constexpr size_t Width = MTS_KD_TRIANGLE_PACKET;
+        if (!m_use_triangle_packets)
+            return;
+
+        bool has_meshes = false;
+        /* Deforming meshes are intersected at the time of each ray instead,
+           and alpha tested meshes one triangle at a time */
+        auto is_static_mesh = [](const Shape *shape) {
+            return shape->is_mesh() && !((const Mesh *) shape)->is_deforming() &&
+                   !shape->has_alpha_mask();
+        };
+
+        for (const Shape *shape : m_shapes)
+            has_meshes |= is_static_mesh(shape);
+        if (!has_meshes)
+            return;
+
+        auto is_mesh = [&](Index prim_index) {
+            return is_static_mesh(m_shapes[find_shape(prim_index)]);
+        };
+
+        m_leaf_triangles.reset(new LeafTriangles[m_index_count]);
+        for (Size n = 0; n < m_node_count; ++n) {
+            const KDNode &node = m_nodes[n];
+            if (!node.leaf() || node.primitive_count() == 0)
+                continue;
+
+            Index *start = m_indices.get() + node.primitive_offset(),
+                  *end   = start + node.primitive_count(),
+                  *mid   = std::stable_partition(start, end, is_mesh);
+
+            LeafTriangles &leaf = m_leaf_triangles[node.primitive_offset()];
+            leaf.packet_offset  = (Index) m_triangle_packets.size();
+            leaf.triangle_count = (Index) (mid - start);
+
+            for (Index i = 0; i < leaf.triangle_count; i += Width) {
+                TrianglePacket packet;
+                packet.p0 = std::numeric_limits<ScalarFloat>::quiet_NaN();
+                packet.e1 = packet.e2 = 0.f;
+                packet.prim_index = packet.shape_index = 0u;
+
+                for (size_t k = 0; k < Width && i + k < leaf.triangle_count; ++k) {
+                    Index prim_index  = start[i + k],
+                          shape_index = find_shape(prim_index);
+                    const Mesh *mesh = (const Mesh *) m_shapes[shape_index].get();
+
+                    auto fi = mesh->face_indices(prim_index);
+                    ScalarPoint3f p0 = mesh->vertex_position(fi[0]),
+                                  p1 = mesh->vertex_position(fi[1]),
+                                  p2 = mesh->vertex_position(fi[2]);
+
+                    for (size_t j = 0; j < 3; ++j) {
+                        packet.p0[j][k] = p0[j];
+                        packet.e1[j][k] = p1[j] - p0[j];
+                        packet.e2[j][k] = p2[j] - p0[j];
+                    }
+                    packet.prim_index[k]  = prim_index;
+                    packet.shape_index[k] = shape_index;
+                }
+
+                m_triangle_packets.push_back(packet);
+            }
+        }
+    }
+}
+
+MTS_VARIANT bool ShapeKDTree<Float, Spectrum>::update() {
+    if (ready() && geometry_hash() == m_geometry_hash)
+        return false;
+
+    m_primitive_map.resize(1);
+    m_bbox.reset();
+    for (const Shape *shape : m_shapes) {
+        m_primitive_map.push_back(m_primitive_map.back() +
+                                  shape->primitive_count());
+        m_bbox.expand(shape->bbox());
+    }
+
+    release_cache_mapping();
+    m_nodes.reset();
+    m_indices.reset();
+    m_node_count = m_index_count = 0;
+    build();
+    return true;
+}
+
 MTS_VARIANT void ShapeKDTree<Float, Spectrum>::add_shape(Shape *shape) {
     Assert(!ready());
     m_primitive_map.push_back(m_primitive_map.back() +
@@ -69,6 +226,183 @@ MTS_VARIANT void ShapeKDTree<Float, Spectrum>::add_shape(Shape *shape) {
     m_bbox.expand(shape->bbox());
 }
 
+/// Header of a kd-tree cache file, followed by the nodes and indices
+struct KDTreeCacheHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t key;
+    uint32_t node_count;
+    uint32_t index_count;
+    uint32_t node_size;
+    uint32_t bbox_size;
+};
+
+static const char kdtree_cache_magic[4] = { 'M', 'K', 'D', 'C' };
+static const uint32_t kdtree_cache_version = 1;
+
+MTS_VARIANT uint64_t ShapeKDTree<Float, Spectrum>::cache_key(uint64_t geo_hash) const {
+    size_t value = hash(kdtree_cache_version);
+
+    // Build parameters
+    SurfaceAreaHeuristic3f model = cost_model();
+    value = hash_combine(value, hash(model.query_cost()));
+    value = hash_combine(value, hash(model.traversal_cost()));
+    value = hash_combine(value, hash(model.empty_space_bonus()));
+    value = hash_combine(value, hash(max_depth()));
+    value = hash_combine(value, hash(min_max_bins()));
+    value = hash_combine(value, hash(clip_primitives()));
+    value = hash_combine(value, hash(retract_bad_splits()));
+    value = hash_combine(value, hash(max_bad_refines()));
+    value = hash_combine(value, hash(stop_primitives()));
+    value = hash_combine(value, hash(exact_primitive_threshold()));
+    value = hash_combine(value, hash(max_duplication()));
+    value = hash_combine(value, sizeof(KDNode));
+
+    return hash_combine(value, (size_t) geo_hash);
+}
+
+MTS_VARIANT uint64_t ShapeKDTree<Float, Spectrum>::geometry_hash() const {
+    auto hash_bytes = [](const void *ptr, size_t size) -> size_t {
+        return std::hash<std::string_view>()(
+            std::string_view((const char *) ptr, size));
+    };
+
+    size_t value = hash(m_shapes.size());
+    for (const Shape *shape : m_shapes) {
+        value = hash_combine(value, hash(std::string(shape->class_()->name())));
+        value = hash_combine(value, hash(shape->primitive_count()));
+
+        if (shape->is_mesh()) {
+            const Mesh *mesh = (const Mesh *) shape;
+            value = hash_combine(value, (size_t) mesh->geometry_hash());
+        } else {
+            ScalarBoundingBox3f bbox = shape->bbox();
+            value = hash_combine(value, hash_bytes(&bbox, sizeof(bbox)));
+        }
+    }
+
+    return (uint64_t) value;
+}
+
+MTS_VARIANT bool ShapeKDTree<Float, Spectrum>::load_cache(const fs::path &path,
+                                                          uint64_t key) {
+    if (!fs::is_regular_file(path))
+        return false;
+
+    try {
+        ref<MemoryMappedFile> mmap = new MemoryMappedFile(path);
+        const uint8_t *data = (const uint8_t *) mmap->data();
+        size_t size = mmap->size();
+
+        KDTreeCacheHeader header;
+        if (size < sizeof(KDTreeCacheHeader))
+            return false;
+        memcpy(&header, data, sizeof(KDTreeCacheHeader));
+
+        size_t expected_size = sizeof(KDTreeCacheHeader) + sizeof(ScalarBoundingBox3f) +
+                               header.node_count * sizeof(KDNode) +
+                               header.index_count * sizeof(Index);
+
+        if (memcmp(header.magic, kdtree_cache_magic, 4) != 0 ||
+            header.version != kdtree_cache_version || header.key != key ||
+            header.node_size != sizeof(KDNode) ||
+            header.bbox_size != sizeof(ScalarBoundingBox3f) ||
+            header.node_count == 0 || size != expected_size) {
+            Log(Warn, "Ignoring stale or incompatible kd-tree cache file \"%s\"",
+                path.string());
+            return false;
+        }
+
+        data += sizeof(KDTreeCacheHeader);
+        memcpy(&m_bbox, data, sizeof(ScalarBoundingBox3f));
+        data += sizeof(ScalarBoundingBox3f);
+
+        m_node_count = header.node_count;
+        m_index_count = header.index_count;
+
+        if (m_cache_shared) {
+            // Map once more with copy-on-write semantics, the pages stay shared
+            m_cache_mapping = MemoryMappedFile::map_copy_on_write(path);
+            uint8_t *base = (uint8_t *) m_cache_mapping->data();
+            size_t offset = data - (const uint8_t *) mmap->data();
+            m_nodes.reset((KDNode *) (base + offset));
+            m_indices.reset((Index *) (base + offset + m_node_count * sizeof(KDNode)));
+            return true;
+        }
+
+        m_nodes.reset(new KDNode[m_node_count]);
+        memcpy(m_nodes.get(), data, m_node_count * sizeof(KDNode));
+        data += m_node_count * sizeof(KDNode);
+        m_indices.reset(new Index[m_index_count]);
+        memcpy(m_indices.get(), data, m_index_count * sizeof(Index));
+    } catch (const std::exception &e) {
+        Log(Warn, "Could not load kd-tree cache file \"%s\": %s", path.string(), e.what());
+        return false;
+    }
+
+    return true;
+}
+
+MTS_VARIANT void ShapeKDTree<Float, Spectrum>::release_cache_mapping() {
+    if (!m_cache_mapping)
+        return;
+    // The storage is owned by the mapping, which must not be deleted
+    m_nodes.release();
+    m_indices.release();
+    m_cache_mapping = nullptr;
+}
+
+MTS_VARIANT ShapeKDTree<Float, Spectrum>::~ShapeKDTree() {
+    release_cache_mapping();
+}
+
+MTS_VARIANT void ShapeKDTree<Float, Spectrum>::save_cache(const fs::path &path,
+                                                          uint64_t key) const {
+    KDTreeCacheHeader header;
+    memcpy(header.magic, kdtree_cache_magic, 4);
+    header.version = kdtree_cache_version;
+    header.key = key;
+    header.node_count = m_node_count;
+    header.index_count = m_index_count;
+    header.node_size = (uint32_t) sizeof(KDNode);
+    header.bbox_size = (uint32_t) sizeof(ScalarBoundingBox3f);
+
+    size_t size = sizeof(KDTreeCacheHeader) + sizeof(ScalarBoundingBox3f) +
+                  m_node_count * sizeof(KDNode) + m_index_count * sizeof(Index);
+
+    /* Write to a temporary file first so that concurrent readers never
+       observe a partially written tree */
+    fs::path tmp_path = path;
+    tmp_path.replace_extension(".tmp");
+
+    try {
+        if (!fs::exists(m_cache_dir))
+            fs::create_directory(m_cache_dir);
+
+        {
+            ref<MemoryMappedFile> mmap = new MemoryMappedFile(tmp_path, size);
+            uint8_t *data = (uint8_t *) mmap->data();
+            memcpy(data, &header, sizeof(KDTreeCacheHeader));
+            data += sizeof(KDTreeCacheHeader);
+            memcpy(data, &m_bbox, sizeof(ScalarBoundingBox3f));
+            data += sizeof(ScalarBoundingBox3f);
+            memcpy(data, m_nodes.get(), m_node_count * sizeof(KDNode));
+            data += m_node_count * sizeof(KDNode);
+            memcpy(data, m_indices.get(), m_index_count * sizeof(Index));
+        }
+
+        if (fs::exists(path))
+            fs::remove(path);
+        if (!fs::rename(tmp_path, path))
+            Throw("unable to rename \"%s\"", tmp_path.string());
+    } catch (const std::exception &e) {
+        Log(Warn, "Could not write kd-tree cache file \"%s\": %s", path.string(), e.what());
+        return;
+    }
+
+    Log(Debug, "Stored the kd-tree in \"%s\" (%s)", path.string(), util::mem_string(size));
+}
+
 MTS_VARIANT std::string ShapeKDTree<Float, Spectrum>::to_string() const {
     std::ostringstream oss;
     oss << "ShapeKDTreeKDTree[" << std::endl
@@ -80,6 +414,17 @@ MTS_VARIANT std::string ShapeKDTree<Float, Spectrum>::to_string() const {
     return oss.str();
 }
 
+MTS_VARIANT void ShapeKDTree<Float, Spectrum>::account_memory(MemoryReport *report) const {
+    size_t size = m_node_count * sizeof(KDNode) + m_index_count * sizeof(Index) +
+                  m_triangle_packets.size() * sizeof(TrianglePacket);
+    if (m_leaf_triangles)
+        size += m_index_count * sizeof(LeafTriangles);
+    // Storage in a shared cache file is owned by the page cache
+    if (m_cache_mapping)
+        size -= m_node_count * sizeof(KDNode) + m_index_count * sizeof(Index);
+    report->add(MemoryCategory::Acceleration, size);
+}
+
 MTS_IMPLEMENT_CLASS_VARIANT(ShapeKDTree, TShapeKDTree)
 MTS_INSTANTIATE_CLASS(ShapeKDTree)
 NAMESPACE_END(mitsuba)
@@ -35,7 +35,7 @@ MTS_VARIANT
 typename Medium<Float, Spectrum>::MediumInteraction3f
 Medium<Float, Spectrum>::sample_interaction(const Ray3f &ray, Float sample,
                                             UInt32 channel, Mask active) const {
-    MTS_MASKED_FUNCTION(ProfilerPhase::MediumSample, active);
+    MTS_MASKED_METHOD(ProfilerPhase::MediumSample, active);
 
     // initialize basic medium interaction fields
     MediumInteraction3f mi;
@@ -53,16 +53,8 @@ Medium<Float, Spectrum>::sample_interaction(const Ray3f &ray, Float sample,
     mint = max(ray.mint, mint);
     maxt = min(ray.maxt, maxt);
 
-    auto combined_extinction = get_combined_extinction(mi, active);
-    Float m                  = combined_extinction[0];
-    if constexpr (is_rgb_v<Spectrum>) { // Handle RGB rendering
-        masked(m, eq(channel, 1u)) = combined_extinction[1];
-        masked(m, eq(channel, 2u)) = combined_extinction[2];
-    } else {
-        ENOKI_MARK_USED(channel);
-    }
-
-    Float sampled_t = mint + (-enoki::log(1 - sample) / m);
+    auto [sampled_t, combined_extinction] =
+        sample_distance(mi, ray, mint, maxt, sample, channel, active);
     Mask valid_mi   = active && (sampled_t <= maxt);
     mi.t            = select(valid_mi, sampled_t, math::Infinity<Float>);
     mi.p            = ray(sampled_t);
@@ -74,13 +66,31 @@ Medium<Float, Spectrum>::sample_interaction(const Ray3f &ray, Float sample,
     return mi;
 }
 
+MTS_VARIANT
+std::pair<Float, typename Medium<Float, Spectrum>::UnpolarizedSpectrum>
+Medium<Float, Spectrum>::sample_distance(const MediumInteraction3f &mi,
+                                         const Ray3f & /* ray */, Float mint,
+                                         Float /* maxt */, Float sample,
+                                         UInt32 channel, Mask active) const {
+    auto combined_extinction = get_combined_extinction(mi, active);
+    Float m                  = combined_extinction[0];
+    if constexpr (is_rgb_v<Spectrum>) { // Handle RGB rendering
+        masked(m, eq(channel, 1u)) = combined_extinction[1];
+        masked(m, eq(channel, 2u)) = combined_extinction[2];
+    } else {
+        ENOKI_MARK_USED(channel);
+    }
+
+    return { mint + (-enoki::log(1 - sample) / m), combined_extinction };
+}
+
 MTS_VARIANT
 std::pair<typename Medium<Float, Spectrum>::UnpolarizedSpectrum,
           typename Medium<Float, Spectrum>::UnpolarizedSpectrum>
 Medium<Float, Spectrum>::eval_tr_and_pdf(const MediumInteraction3f &mi,
                                          const SurfaceInteraction3f &si,
                                          Mask active) const {
-    MTS_MASKED_FUNCTION(ProfilerPhase::MediumEvaluate, active);
+    MTS_MASKED_METHOD(ProfilerPhase::MediumEvaluate, active);
 
     Float t      = min(mi.t, si.t) - mi.mint;
     UnpolarizedSpectrum tr  = exp(-t * mi.combined_extinction);
@@ -1,4 +1,10 @@
+#include <mitsuba/core/filesystem.h>
 #include <mitsuba/core/fstream.h>
+#include <mitsuba/core/hash.h>
+#include <mitsuba/core/memreport.h>
+#include <mitsuba/core/mmap.h>
+#include <mitsuba/core/plugin.h>
+#include <mitsuba/core/properties.h>
 #include <mitsuba/core/timer.h>
 #include <mitsuba/core/transform.h>
 #include <mitsuba/core/util.h>
@@ -8,7 +14,17 @@
 #include <mitsuba/render/mesh.h>
 #include <mitsuba/render/records.h>
 #include <mitsuba/render/scene.h>
+#include <mitsuba/render/texture.h>
+#include <enoki/half.h>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_reduce.h>
+#include <tbb/parallel_scan.h>
+#include <algorithm>
+#include <atomic>
 #include <mutex>
+#include <random>
+#include <string_view>
 
 #if defined(MTS_ENABLE_EMBREE)
     #include <embree3/rtcore.h>
@@ -19,8 +35,12 @@
     #include <optix_function_table_definition.h>
 # endif
     #include "../shapes/optix/mesh.cuh"
+    #include <mitsuba/render/optix/shapes.h>
 #endif
 
+/// Number of faces or vertices processed per task by the parallel mesh routines
+#define MTS_MESH_GRAIN_SIZE 16384u
+
 NAMESPACE_BEGIN(mitsuba)
 
 MTS_VARIANT Mesh<Float, Spectrum>::Mesh(const Properties &props) : Base(props) {
@@ -29,6 +49,21 @@ MTS_VARIANT Mesh<Float, Spectrum>::Mesh(const Properties &props) : Base(props) {
        appearance. Default: ``false`` */
     if (props.bool_("face_normals", false))
         m_disable_vertex_normals = true;
+
+    /* When set to ``true``, the mesh is stored in a compact quantized
+       representation after loading (see \ref compress()). Default: ``false`` */
+    m_compress = props.bool_("compress", false);
+
+    /* When set to ``true``, faces are sampled using an alias table, which
+       takes constant time rather than a binary search over the face areas
+       (see \ref DiscreteDistribution::set_alias_table()). Default: ``false`` */
+    m_alias_sampling = props.bool_("alias_sampling", false);
+
+    /* Directory of geometry files that are memory-mapped instead of being
+       copied into every process that loads the same mesh, see \ref
+       load_from_cache(). Default: none */
+    if (props.has_property("shared_cache_dir"))
+        m_shared_cache_dir = props.string("shared_cache_dir");
 }
 
 MTS_VARIANT
@@ -57,6 +92,276 @@ Mesh<Float, Spectrum>::Mesh(const std::string &name, ScalarSize vertex_count,
 
 MTS_VARIANT Mesh<Float, Spectrum>::~Mesh() { }
 
+namespace {
+/// Process-wide cache of loaded mesh files (one per variant), see \ref Mesh::load_from_cache()
+template <typename Mesh> struct MeshCache {
+    std::mutex mutex;
+    std::unordered_map<std::string, ref<Mesh>> meshes;
+
+    // Intentionally leaked to avoid releasing meshes during static destruction
+    static MeshCache &get() {
+        static MeshCache *cache = new MeshCache();
+        return *cache;
+    }
+};
+}  // end namespace
+
+/// Header of a shared geometry file, followed by the faces, positions, normals and UVs
+struct MeshCacheHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t key;
+    uint32_t vertex_count;
+    uint32_t face_count;
+    uint32_t float_size;
+    uint32_t flags;
+};
+
+static const char mesh_cache_magic[4] = { 'M', 'S', 'H', 'C' };
+static const uint32_t mesh_cache_version = 1;
+static const uint32_t mesh_cache_has_normals = 1, mesh_cache_has_texcoords = 2;
+
+/* Compute the offsets of the buffers in a shared geometry file and return its
+   size. Buffers start and end at multiples of the cache line size, so that
+   packet variants can load them with aligned accesses. */
+static size_t mesh_cache_layout(const MeshCacheHeader &header, size_t offsets[4]) {
+    auto align = [](size_t value) { return (value + 63) / 64 * 64; };
+    size_t vertex_size = header.vertex_count * (size_t) header.float_size,
+           sizes[4] = {
+               header.face_count * 3 * sizeof(uint32_t),
+               vertex_size * 3,
+               (header.flags & mesh_cache_has_normals) ? vertex_size * 3 : 0,
+               (header.flags & mesh_cache_has_texcoords) ? vertex_size * 2 : 0
+           };
+
+    size_t offset = align(sizeof(MeshCacheHeader));
+    for (int i = 0; i < 4; ++i) {
+        offsets[i] = offset;
+        offset = align(offset + sizes[i]);
+    }
+    return offset;
+}
+
+MTS_VARIANT fs::path Mesh<Float, Spectrum>::shared_cache_path(uint64_t &key) const {
+    // GPU variants copy the geometry to the device, differentiable ones track it
+    if (m_shared_cache_dir.empty() || m_source_key.empty() || !m_mesh_attributes.empty() ||
+        is_cuda_array_v<Float> || is_diff_array_v<Float>)
+        return fs::path();
+
+    // The file stores vertices that are already transformed to world space
+    ScalarTransform4f to_world = m_to_world;
+    size_t value = hash(mesh_cache_version);
+    value = hash_combine(value, hash(m_source_key));
+    value = hash_combine(value, std::hash<std::string_view>()(std::string_view(
+                                    (const char *) &to_world.matrix, sizeof(to_world.matrix))));
+    value = hash_combine(value, sizeof(InputFloat));
+    key = (uint64_t) value;
+
+    char filename[32];
+    snprintf(filename, sizeof(filename), "%016llx.mesh", (unsigned long long) key);
+    return m_shared_cache_dir / fs::path(filename);
+}
+
+MTS_VARIANT bool Mesh<Float, Spectrum>::load_shared_cache(const fs::path &path, uint64_t key) {
+    if (!fs::is_regular_file(path))
+        return false;
+
+    try {
+        /* Copy-on-write mapping: the pages are shared with all processes that
+           map the file, unless they are modified (e.g. via traverse()) */
+        ref<MemoryMappedFile> mmap = MemoryMappedFile::map_copy_on_write(path);
+        uint8_t *data = (uint8_t *) mmap->data();
+        size_t size = mmap->size();
+
+        MeshCacheHeader header;
+        if (size < sizeof(MeshCacheHeader))
+            return false;
+        memcpy(&header, data, sizeof(MeshCacheHeader));
+
+        size_t offsets[4];
+        if (memcmp(header.magic, mesh_cache_magic, 4) != 0 ||
+            header.version != mesh_cache_version || header.key != key ||
+            header.float_size != sizeof(InputFloat) ||
+            size != mesh_cache_layout(header, offsets)) {
+            Log(Warn, "Ignoring stale or incompatible geometry cache file \"%s\"",
+                path.string());
+            return false;
+        }
+
+        m_vertex_count = header.vertex_count;
+        m_face_count   = header.face_count;
+        m_faces_buf    = DynamicBuffer<UInt32>::map(data + offsets[0], m_face_count * 3);
+        m_vertex_positions_buf = FloatStorage::map(data + offsets[1], m_vertex_count * 3);
+        m_vertex_normals_buf =
+            (header.flags & mesh_cache_has_normals)
+                ? FloatStorage::map(data + offsets[2], m_vertex_count * 3) : FloatStorage();
+        m_vertex_texcoords_buf =
+            (header.flags & mesh_cache_has_texcoords)
+                ? FloatStorage::map(data + offsets[3], m_vertex_count * 2) : FloatStorage();
+        m_shared_mapping = mmap;
+    } catch (const std::exception &e) {
+        Log(Warn, "Could not load geometry cache file \"%s\": %s", path.string(), e.what());
+        return false;
+    }
+
+    recompute_bbox();
+    return true;
+}
+
+MTS_VARIANT bool Mesh<Float, Spectrum>::save_shared_cache(const fs::path &path,
+                                                          uint64_t key) const {
+    MeshCacheHeader header;
+    memcpy(header.magic, mesh_cache_magic, 4);
+    header.version = mesh_cache_version;
+    header.key = key;
+    header.vertex_count = (uint32_t) m_vertex_count;
+    header.face_count = (uint32_t) m_face_count;
+    header.float_size = (uint32_t) sizeof(InputFloat);
+    header.flags = (has_vertex_normals() ? mesh_cache_has_normals : 0) |
+                   (has_vertex_texcoords() ? mesh_cache_has_texcoords : 0);
+
+    size_t offsets[4];
+    size_t size = mesh_cache_layout(header, offsets);
+
+    /* Several processes may store the same mesh at once, hence every one of
+       them writes its own temporary file, which is then renamed into place */
+    fs::path tmp_path = path;
+    tmp_path.replace_extension(tfm::format(".%016llx.tmp",
+        (unsigned long long) std::random_device()() << 32 | std::random_device()()));
+
+    try {
+        if (!fs::exists(m_shared_cache_dir))
+            fs::create_directory(m_shared_cache_dir);
+
+        {
+            ref<MemoryMappedFile> mmap = new MemoryMappedFile(tmp_path, size);
+            uint8_t *data = (uint8_t *) mmap->data();
+            memset(data, 0, size);
+            memcpy(data, &header, sizeof(MeshCacheHeader));
+            memcpy(data + offsets[0], m_faces_buf.data(), m_face_count * 3 * sizeof(uint32_t));
+            memcpy(data + offsets[1], m_vertex_positions_buf.data(),
+                   m_vertex_count * 3 * sizeof(InputFloat));
+            if (header.flags & mesh_cache_has_normals)
+                memcpy(data + offsets[2], m_vertex_normals_buf.data(),
+                       m_vertex_count * 3 * sizeof(InputFloat));
+            if (header.flags & mesh_cache_has_texcoords)
+                memcpy(data + offsets[3], m_vertex_texcoords_buf.data(),
+                       m_vertex_count * 2 * sizeof(InputFloat));
+        }
+
+        if (!fs::rename(tmp_path, path))
+            Throw("unable to rename \"%s\"", tmp_path.string());
+    } catch (const std::exception &e) {
+        Log(Warn, "Could not write geometry cache file \"%s\": %s", path.string(), e.what());
+        if (fs::exists(tmp_path))
+            fs::remove(tmp_path);
+        return false;
+    }
+
+    Log(Debug, "Stored the geometry of \"%s\" in \"%s\" (%s)", m_name, path.string(),
+        util::mem_string(size));
+    return true;
+}
+
+MTS_VARIANT bool Mesh<Float, Spectrum>::load_from_cache(const fs::path &path,
+                                                        const std::string &options) {
+    m_source_key = tfm::format("%s|%s|%i|%s", class_()->name(), fs::absolute(path),
+                               fs::last_write_time(path), options);
+
+    // Map the geometry stored by another process (or an earlier load)
+    uint64_t key = 0;
+    fs::path shared_path = shared_cache_path(key);
+    if (!shared_path.empty() && load_shared_cache(shared_path, key))
+        return true;
+
+    ref<Mesh> source;
+    {
+        MeshCache<Mesh> &cache = MeshCache<Mesh>::get();
+        std::lock_guard<std::mutex> guard(cache.mutex);
+        auto it = cache.meshes.find(m_source_key);
+        if (it != cache.meshes.end())
+            source = it->second;
+    }
+
+    // The cached mesh may have been modified in the meantime
+    if (!source || source->m_source_key != m_source_key)
+        return false;
+
+    // Deep copies, since the vertices may be transformed below
+    auto copy = [](const auto &buf) {
+        using Buffer = std::decay_t<decltype(buf)>;
+        return slices(buf) == 0 ? Buffer() : Buffer::copy(buf.data(), slices(buf));
+    };
+
+    m_vertex_count = source->m_vertex_count;
+    m_face_count   = source->m_face_count;
+    m_faces_buf    = copy(source->m_faces_buf);
+    m_vertex_positions_buf = copy(source->m_vertex_positions_buf);
+    m_vertex_normals_buf   = copy(source->m_vertex_normals_buf);
+    m_vertex_texcoords_buf = copy(source->m_vertex_texcoords_buf);
+    m_mesh_attributes      = source->m_mesh_attributes;
+
+    m_faces_buf.managed();
+    m_vertex_positions_buf.managed();
+    m_vertex_normals_buf.managed();
+    m_vertex_texcoords_buf.managed();
+    if constexpr (is_cuda_array_v<Float>)
+        cuda_sync();
+
+    // Both meshes baked their own transformation into the vertices
+    if (!all_nested(eq(m_to_world.matrix, source->m_to_world.matrix))) {
+        ScalarTransform4f transform = m_to_world * source->m_to_world.inverse();
+        InputFloat *position_ptr = m_vertex_positions_buf.data(),
+                   *normal_ptr   = m_vertex_normals_buf.data();
+        bool has_normals = has_vertex_normals();
+
+        for (ScalarSize i = 0; i < m_vertex_count; ++i) {
+            InputPoint3f p = load_unaligned<InputPoint3f>(position_ptr + 3 * i);
+            store_unaligned(position_ptr + 3 * i, InputPoint3f(transform.transform_affine(p)));
+
+            if (has_normals) {
+                InputNormal3f n = load_unaligned<InputNormal3f>(normal_ptr + 3 * i);
+                store_unaligned(normal_ptr + 3 * i,
+                                InputNormal3f(normalize(transform.transform_affine(n))));
+            }
+        }
+    }
+
+    recompute_bbox();
+    return true;
+}
+
+MTS_VARIANT void Mesh<Float, Spectrum>::add_to_cache() {
+    if (m_source_key.empty())
+        return;
+
+    /* Replace the private buffers by the stored ones, so that this process
+       also shares the pages with the processes that load the mesh later */
+    uint64_t key = 0;
+    fs::path shared_path = shared_cache_path(key);
+    if (!shared_path.empty() && !m_shared_mapping && save_shared_cache(shared_path, key))
+        load_shared_cache(shared_path, key);
+
+    MeshCache<Mesh> &cache = MeshCache<Mesh>::get();
+    std::lock_guard<std::mutex> guard(cache.mutex);
+
+    // Drop the meshes that are no longer referenced anywhere else
+    for (auto it = cache.meshes.begin(); it != cache.meshes.end();) {
+        if (it->second->ref_count() == 1)
+            it = cache.meshes.erase(it);
+        else
+            ++it;
+    }
+
+    cache.meshes.emplace(m_source_key, this);
+}
+
+MTS_VARIANT void Mesh<Float, Spectrum>::clear_cache() {
+    MeshCache<Mesh> &cache = MeshCache<Mesh>::get();
+    std::lock_guard<std::mutex> guard(cache.mutex);
+    cache.meshes.clear();
+}
+
 MTS_VARIANT typename Mesh<Float, Spectrum>::ScalarBoundingBox3f
 Mesh<Float, Spectrum>::bbox() const {
     return m_bbox;
@@ -76,11 +381,24 @@ Mesh<Float, Spectrum>::bbox(ScalarIndex index) const {
                   v1 = vertex_position(fi[1]),
                   v2 = vertex_position(fi[2]);
 
-    return typename Mesh<Float, Spectrum>::ScalarBoundingBox3f(min(min(v0, v1), v2),
-                                                               max(max(v0, v1), v2));
+    ScalarBoundingBox3f result(min(min(v0, v1), v2), max(max(v0, v1), v2));
+
+    /* The mesh is interpolated linearly between keyframes, hence every
+       intermediate triangle lies within the union of the keyframe bounds */
+    for (ScalarSize k = 0; k + 1 < m_keyframe_count; ++k) {
+        ScalarIndex offset = k * m_vertex_count;
+        for (size_t j = 0; j < 3; ++j)
+            result.expand(ScalarPoint3f(gather<InputPoint3f>(
+                m_keyframe_positions_buf, fi[j] + offset)));
+    }
+
+    return result;
 }
 
 MTS_VARIANT void Mesh<Float, Spectrum>::write_ply(const std::string &filename) const {
+    if (m_compressed)
+        Throw("write_ply(): cannot export the compressed mesh \"%s\"!", m_name);
+
     ref<FileStream> stream = new FileStream(filename, FileStream::ETruncReadWrite);
 
     std::vector<std::pair<std::string, const MeshAttribute&>> vertex_attributes;
@@ -140,9 +458,15 @@ MTS_VARIANT void Mesh<Float, Spectrum>::write_ply(const std::string &filename) c
     const InputFloat* normal_ptr   = m_vertex_normals_buf.data();
     const InputFloat* texcoord_ptr = m_vertex_texcoords_buf.data();
 
+    // Compact attributes are written in single precision
+    std::vector<FloatStorage> attribute_bufs;
+    attribute_bufs.reserve(vertex_attributes.size() + face_attributes.size());
+
     std::vector<const InputFloat*> vertex_attributes_ptr;
-    for (const auto&[name, attribute]: vertex_attributes)
-        vertex_attributes_ptr.push_back(attribute.buf.data());
+    for (const auto&[name, attribute]: vertex_attributes) {
+        attribute_bufs.push_back(unpack_attribute(attribute));
+        vertex_attributes_ptr.push_back(attribute_bufs.back().data());
+    }
 
     for (size_t i = 0; i < m_vertex_count; i++) {
         // Write positions
@@ -169,8 +493,10 @@ MTS_VARIANT void Mesh<Float, Spectrum>::write_ply(const std::string &filename) c
     const ScalarIndex* face_ptr = m_faces_buf.data();
 
     std::vector<const InputFloat*> face_attributes_ptr;
-    for (const auto&[name, attribute]: face_attributes)
-        face_attributes_ptr.push_back(attribute.buf.data());
+    for (const auto&[name, attribute]: face_attributes) {
+        attribute_bufs.push_back(unpack_attribute(attribute));
+        face_attributes_ptr.push_back(attribute_bufs.back().data());
+    }
 
     // Write faces data
     uint8_t vertex_indices_count = 3;
@@ -198,6 +524,8 @@ MTS_VARIANT void Mesh<Float, Spectrum>::write_ply(const std::string &filename) c
 }
 
 MTS_VARIANT void Mesh<Float, Spectrum>::recompute_vertex_normals() {
+    if (m_compressed)
+        Throw("recompute_vertex_normals(): the mesh \"%s\" is compressed!", m_name);
     if (!has_vertex_normals())
         Throw("Storing new normals in a Mesh that didn't have normals at "
               "construction time is not implemented yet.");
@@ -206,48 +534,105 @@ MTS_VARIANT void Mesh<Float, Spectrum>::recompute_vertex_normals() {
        by Grit Thuermer and Charles A. Wuethrich, JGT 1998, Vol 3 */
 
     if constexpr (!is_dynamic_v<Float>) {
-        size_t invalid_counter = 0;
-        std::vector<InputNormal3f> normals(m_vertex_count, zero<InputNormal3f>());
+        using Range = tbb::blocked_range<ScalarSize>;
+
+        /* The faces are processed in parallel. To avoid concurrent updates of
+           shared vertices, first build a vertex -> face corner adjacency
+           structure (a counting sort of all corners by vertex), and then let
+           every vertex gather the contributions of its corners. Sorting the
+           corners of each vertex makes the summation order (and hence the
+           result) identical to a sequential traversal of the faces. */
+        std::unique_ptr<std::atomic<ScalarIndex>[]> cursor(
+            new std::atomic<ScalarIndex>[m_vertex_count]());
+
+        tbb::parallel_for(Range(0, m_face_count, MTS_MESH_GRAIN_SIZE),
+            [&](const Range &range) {
+                for (ScalarSize i = range.begin(); i != range.end(); ++i) {
+                    auto fi = face_indices(i);
+                    Assert(fi[0] < m_vertex_count &&
+                           fi[1] < m_vertex_count &&
+                           fi[2] < m_vertex_count);
+                    for (size_t j = 0; j < 3; ++j)
+                        cursor[fi[j]].fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        );
+
+        // Exclusive prefix sum over the per-vertex corner counts
+        std::unique_ptr<ScalarIndex[]> offsets(new ScalarIndex[m_vertex_count + 1]);
+        offsets[m_vertex_count] = tbb::parallel_scan(
+            Range(0, m_vertex_count, MTS_MESH_GRAIN_SIZE), ScalarIndex(0),
+            [&](const Range &range, ScalarIndex sum, bool final_scan) {
+                for (ScalarSize i = range.begin(); i != range.end(); ++i) {
+                    ScalarIndex count = cursor[i].load(std::memory_order_relaxed);
+                    if (final_scan) {
+                        offsets[i] = sum;
+                        cursor[i].store(sum, std::memory_order_relaxed);
+                    }
+                    sum += count;
+                }
+                return sum;
+            },
+            [](ScalarIndex a, ScalarIndex b) { return a + b; }
+        );
 
-        for (ScalarSize i = 0; i < m_face_count; ++i) {
-            auto fi = face_indices(i);
-            Assert(fi[0] < m_vertex_count &&
-                   fi[1] < m_vertex_count &&
-                   fi[2] < m_vertex_count);
+        std::unique_ptr<ScalarIndex[]> corners(new ScalarIndex[3 * (size_t) m_face_count]);
+        tbb::parallel_for(Range(0, m_face_count, MTS_MESH_GRAIN_SIZE),
+            [&](const Range &range) {
+                for (ScalarSize i = range.begin(); i != range.end(); ++i) {
+                    auto fi = face_indices(i);
+                    for (ScalarIndex j = 0; j < 3; ++j)
+                        corners[cursor[fi[j]].fetch_add(1, std::memory_order_relaxed)] = 3 * i + j;
+                }
+            }
+        );
+        cursor.reset();
 
+        // Angle-weighted normal of the face that contains the given corner
+        auto corner_normal = [&](ScalarIndex corner) -> InputNormal3f {
+            auto fi = face_indices(corner / 3);
             InputPoint3f v[3] = { vertex_position(fi[0]),
                                   vertex_position(fi[1]),
                                   vertex_position(fi[2]) };
 
-            InputVector3f side_0 = v[1] - v[0],
-                          side_1 = v[2] - v[0];
-            InputNormal3f n = cross(side_0, side_1);
+            InputNormal3f n = cross(v[1] - v[0], v[2] - v[0]);
             InputFloat length_sqr = squared_norm(n);
-            if (likely(length_sqr > 0)) {
-                n *= rsqrt(length_sqr);
-
-                // Use Enoki to compute the face angles at the same time
-                auto side1 = transpose(Array<Packet<InputFloat, 3>, 3>{ side_0, v[2] - v[1], v[0] - v[2] });
-                auto side2 = transpose(Array<Packet<InputFloat, 3>, 3>{ side_1, v[0] - v[1], v[1] - v[2] });
-                InputVector3f face_angles = unit_angle(normalize(side1), normalize(side2));
-
-                for (size_t j = 0; j < 3; ++j)
-                    normals[fi[j]] += n * face_angles[j];
-            }
-        }
-
-        for (ScalarSize i = 0; i < m_vertex_count; i++) {
-            InputNormal3f n = normals[i];
-            InputFloat length = norm(n);
-            if (likely(length != 0.f)) {
-                n /= length;
-            } else {
-                n = InputNormal3f(1, 0, 0); // Choose some bogus value
-                invalid_counter++;
-            }
+            if (unlikely(!(length_sqr > 0)))
+                return zero<InputNormal3f>();
+            n *= rsqrt(length_sqr);
+
+            ScalarIndex j = corner % 3;
+            InputVector3f side_0 = v[(j + 1) % 3] - v[j],
+                          side_1 = v[(j + 2) % 3] - v[j];
+            return n * unit_angle(normalize(side_0), normalize(side_1));
+        };
 
-            store(m_vertex_normals_buf.data() + 3 * i, n);
-        }
+        size_t invalid_counter = tbb::parallel_reduce(
+            Range(0, m_vertex_count, MTS_MESH_GRAIN_SIZE), size_t(0),
+            [&](const Range &range, size_t invalid) {
+                for (ScalarSize i = range.begin(); i != range.end(); ++i) {
+                    ScalarIndex *begin = corners.get() + offsets[i],
+                                *end   = corners.get() + offsets[i + 1];
+                    std::sort(begin, end);
+
+                    InputNormal3f n = zero<InputNormal3f>();
+                    for (ScalarIndex *it = begin; it != end; ++it)
+                        n += corner_normal(*it);
+
+                    InputFloat length = norm(n);
+                    if (likely(length != 0.f)) {
+                        n /= length;
+                    } else {
+                        n = InputNormal3f(1, 0, 0); // Choose some bogus value
+                        invalid++;
+                    }
+
+                    store(m_vertex_normals_buf.data() + 3 * i, n);
+                }
+                return invalid;
+            },
+            [](size_t a, size_t b) { return a + b; }
+        );
 
         if (invalid_counter > 0)
             Log(Warn, "\"%s\": computed vertex normals (%i invalid vertices!)",
@@ -277,15 +662,288 @@ MTS_VARIANT void Mesh<Float, Spectrum>::recompute_vertex_normals() {
 }
 
 MTS_VARIANT void Mesh<Float, Spectrum>::recompute_bbox() {
-    m_bbox.reset();
-    for (ScalarSize i = 0; i < m_vertex_count; ++i)
-        m_bbox.expand(vertex_position(i));
+    using Range = tbb::blocked_range<ScalarSize>;
+
+    // Vertices of the rest pose, followed by those of the additional keyframes
+    auto expand = [&](const Range &range, ScalarBoundingBox3f bbox) {
+        for (ScalarSize i = range.begin(); i != range.end(); ++i) {
+            if (i < m_vertex_count)
+                bbox.expand(vertex_position(i));
+            else
+                bbox.expand(ScalarPoint3f(gather<InputPoint3f>(
+                    m_keyframe_positions_buf, i - m_vertex_count)));
+        }
+        return bbox;
+    };
+
+    Range range(0, m_keyframe_count * m_vertex_count, MTS_MESH_GRAIN_SIZE);
+    if constexpr (is_cuda_array_v<Float>) {
+        // Element-wise accesses to GPU buffers are not thread-safe
+        m_bbox = expand(range, ScalarBoundingBox3f());
+    } else {
+        m_bbox = tbb::parallel_reduce(
+            range, ScalarBoundingBox3f(), expand,
+            [](ScalarBoundingBox3f a, const ScalarBoundingBox3f &b) {
+                a.expand(b);
+                return a;
+            }
+        );
+    }
+}
+
+MTS_VARIANT void Mesh<Float, Spectrum>::add_keyframe(const FloatStorage &positions,
+                                                     const FloatStorage &normals) {
+    if (m_compressed)
+        Throw("\"%s\": cannot add keyframes to a compressed mesh!", m_name);
+    if (slices(positions) != m_vertex_count * 3)
+        Throw("\"%s\": keyframe %i has %i vertices, expected %i!", m_name,
+              m_keyframe_count, slices(positions) / 3, m_vertex_count);
+
+    bool with_normals = slices(normals) != 0;
+    if (with_normals && slices(normals) != m_vertex_count * 3)
+        Throw("\"%s\": keyframe %i has %i vertex normals, expected %i!", m_name,
+              m_keyframe_count, slices(normals) / 3, m_vertex_count);
+
+    // Normals are only interpolated when they are specified for every keyframe
+    if (m_keyframe_count > 1 && slices(m_keyframe_normals_buf) == 0)
+        with_normals = false;
+    if (!has_vertex_normals())
+        with_normals = false;
+
+    size_t stride = m_vertex_count * 3 * sizeof(InputFloat),
+           count  = m_vertex_count * 3 * (size_t) m_keyframe_count;
+
+    auto append = [&](FloatStorage &buf, const FloatStorage &value) {
+        FloatStorage result = zero<FloatStorage>(count);
+        result.managed();
+        FloatStorage value_m = value;
+        value_m.managed();
+        if constexpr (is_cuda_array_v<Float>)
+            cuda_sync();
+        if (slices(buf) != 0)
+            memcpy(result.data(), buf.data(), stride * (m_keyframe_count - 1));
+        memcpy(result.data() + (count - m_vertex_count * 3), value_m.data(), stride);
+        buf = std::move(result);
+    };
+
+    append(m_keyframe_positions_buf, positions);
+    if (with_normals)
+        append(m_keyframe_normals_buf, normals);
+    else
+        m_keyframe_normals_buf = FloatStorage();
+    m_keyframe_count++;
+    m_source_key.clear();
+
+    recompute_bbox();
+}
+
+MTS_VARIANT void Mesh<Float, Spectrum>::set_motion_range(ScalarFloat start, ScalarFloat end) {
+    if (!(end > start))
+        Throw("\"%s\": invalid motion range [%f, %f]!", m_name, start, end);
+#if defined(MTS_ENABLE_EMBREE)
+    // Embree expects the time steps to lie in the unit interval
+    if (start < 0.f || end > 1.f)
+        Throw("\"%s\": the motion range [%f, %f] must lie within [0, 1]!",
+              m_name, start, end);
+#endif
+    m_motion_start = start;
+    m_motion_end   = end;
+    m_motion_scale = 1.f / (end - start);
+}
+
+MTS_VARIANT void Mesh<Float, Spectrum>::load_keyframes(const Properties &props) {
+    /* Additional keyframes for deformation motion blur (e.g.
+       "frame_1.ply, frame_2.ply, ..."), which are spaced evenly
+       over the interval [motion_start, motion_end]. */
+    std::string keyframes = props.string("keyframes", "");
+    ScalarFloat motion_start = props.float_("motion_start", 0.f),
+                motion_end   = props.float_("motion_end", 1.f);
+    set_motion_range(motion_start, motion_end);
+
+    std::vector<std::string> filenames = string::tokenize(keyframes, ", ");
+    if (filenames.empty())
+        return;
+
+    if (m_compress) {
+        Log(Warn, "\"%s\": compression is not supported for meshes with "
+                  "keyframes, ignoring.", m_name);
+        m_compress = false;
+    }
+
+    /* Only forward the plain parameters: child objects (e.g. an emitter)
+       must not be attached to the temporary keyframe meshes */
+    Properties props_kf(props.plugin_name());
+    for (const std::string &name : props.property_names()) {
+        if (name == "keyframes" || name == "motion_start" || name == "motion_end" ||
+            name == "compress")
+            continue;
+        Properties::Type type = props.type(name);
+        if (type == Properties::Type::Object || type == Properties::Type::NamedReference ||
+            type == Properties::Type::Pointer)
+            continue;
+        props_kf.copy_attribute(props, name, name);
+    }
+    props_kf.set_id(props.id() + "_keyframe");
+
+    for (const std::string &filename : filenames) {
+        props_kf.set_string("filename", filename, false);
+        ref<Object> obj = PluginManager::instance()->create_object<Base>(props_kf);
+        const Mesh *mesh = dynamic_cast<const Mesh *>(obj.get());
+        if (!mesh)
+            Throw("\"%s\": keyframe \"%s\" is not a mesh!", m_name, filename);
+        if (mesh->face_count() != m_face_count)
+            Throw("\"%s\": keyframe \"%s\" has %i faces, expected %i!", m_name,
+                  filename, mesh->face_count(), m_face_count);
+
+        add_keyframe(mesh->vertex_positions_buffer(),
+                     m_disable_vertex_normals ? FloatStorage() : mesh->vertex_normals_buffer());
+    }
+
+    Log(Debug, "\"%s\": loaded %i keyframes spanning the time interval [%f, %f]",
+        m_name, m_keyframe_count, m_motion_start, m_motion_end);
+}
+
+MTS_VARIANT void Mesh<Float, Spectrum>::compress() {
+    if (m_compressed)
+        return;
+
+    if (is_deforming()) {
+        Log(Warn, "\"%s\": mesh compression is not supported for meshes "
+                  "with keyframes, ignoring.", m_name);
+        return;
+    }
+
+#if defined(MTS_ENABLE_EMBREE) || defined(MTS_ENABLE_OPTIX)
+    Log(Warn, "\"%s\": mesh compression requires the native ray tracing "
+              "backend, ignoring.", m_name);
+    return;
+#else
+    if constexpr (is_dynamic_v<Float>) {
+        Log(Warn, "\"%s\": mesh compression is not supported in "
+                  "JIT-compiled variants, ignoring.", m_name);
+        return;
+    } else {
+        constexpr uint32_t Max21 = (1u << 21) - 1;
+        size_t size_before = m_face_count * face_data_bytes() +
+                             m_vertex_count * vertex_data_bytes();
+
+        recompute_bbox();
+        InputPoint3f bbox_min(m_bbox.min);
+        InputVector3f extents = InputPoint3f(m_bbox.max) - bbox_min;
+        InputVector3f inv_scale =
+            select(extents > 0.f, InputFloat(Max21) / extents, 0.f);
+
+        const InputFloat *position_ptr = m_vertex_positions_buf.data(),
+                         *normal_ptr   = m_vertex_normals_buf.data(),
+                         *texcoord_ptr = m_vertex_texcoords_buf.data();
+        bool has_normals   = slices(m_vertex_normals_buf) != 0,
+             has_texcoords = slices(m_vertex_texcoords_buf) != 0;
+
+        m_vertex_positions_packed = zero<PackedStorage64>(m_vertex_count);
+        if (has_normals)
+            m_vertex_normals_packed = zero<PackedStorage32>(m_vertex_count);
+        if (has_texcoords)
+            m_vertex_texcoords_packed = zero<PackedStorage32>(m_vertex_count);
+
+        uint64_t *position_out = (uint64_t *) m_vertex_positions_packed.data();
+        uint32_t *normal_out   = (uint32_t *) m_vertex_normals_packed.data(),
+                 *texcoord_out = (uint32_t *) m_vertex_texcoords_packed.data();
+
+        auto quantize_unit = [](InputFloat value) {
+            return (uint32_t) std::rint(clamp(fmadd(value, .5f, .5f), 0.f, 1.f) * 65535.f);
+        };
+
+        auto to_half = [](InputFloat value) -> uint32_t {
+            // Denormals are flushed to zero to simplify the decoder
+            if (std::abs(value) < 6.103515625e-05f)
+                value = 0.f;
+            return enoki::half::float32_to_float16(value);
+        };
+
+        for (ScalarSize i = 0; i < m_vertex_count; ++i) {
+            InputPoint3f p = load_unaligned<InputPoint3f>(position_ptr + 3 * i);
+            Array<uint64_t, 3> q(clamp(round((p - bbox_min) * inv_scale), 0.f, InputFloat(Max21)));
+            position_out[i] = q.x() | (q.y() << 21) | (q.z() << 42);
+
+            if (has_normals) {
+                InputNormal3f n = load_unaligned<InputNormal3f>(normal_ptr + 3 * i);
+                InputFloat l1 = abs(n.x()) + abs(n.y()) + abs(n.z());
+                InputVector2f o(0.f);
+                if (likely(l1 > 0.f)) {
+                    o = InputVector2f(n.x(), n.y()) / l1;
+                    if (n.z() < 0.f)
+                        o = mulsign(1.f - abs(InputVector2f(o.y(), o.x())), o);
+                }
+                normal_out[i] = quantize_unit(o.x()) | (quantize_unit(o.y()) << 16);
+            }
+
+            if (has_texcoords)
+                texcoord_out[i] = to_half(texcoord_ptr[2 * i]) |
+                                  (to_half(texcoord_ptr[2 * i + 1]) << 16);
+        }
+
+        m_position_scale = select(extents > 0.f, extents / InputFloat(Max21), 0.f);
+        m_position_offset = bbox_min;
+
+        if (m_vertex_count <= Max21 + 1) {
+            const ScalarIndex *face_ptr = m_faces_buf.data();
+            m_faces_packed = zero<PackedStorage64>(m_face_count);
+            uint64_t *face_out = (uint64_t *) m_faces_packed.data();
+            for (ScalarSize i = 0; i < m_face_count; ++i)
+                face_out[i] = (uint64_t) face_ptr[3 * i] |
+                              ((uint64_t) face_ptr[3 * i + 1] << 21) |
+                              ((uint64_t) face_ptr[3 * i + 2] << 42);
+            m_faces_buf = DynamicBuffer<UInt32>();
+            m_compressed_faces = true;
+        }
+
+        m_vertex_positions_buf = FloatStorage();
+        m_vertex_normals_buf = FloatStorage();
+        m_vertex_texcoords_buf = FloatStorage();
+        m_compressed = true;
+
+        // Use the decoded positions from now on
+        recompute_bbox();
+
+        size_t size_after = m_face_count * face_data_bytes() +
+                            m_vertex_count * vertex_data_bytes();
+        Log(Debug, "\"%s\": compressed mesh data (%s -> %s)", m_name,
+            util::mem_string(size_before), util::mem_string(size_after));
+    }
+#endif
+}
+
+MTS_VARIANT uint64_t Mesh<Float, Spectrum>::geometry_hash() const {
+    auto hash_bytes = [](const void *ptr, size_t size) -> size_t {
+        return std::hash<std::string_view>()(
+            std::string_view((const char *) ptr, size));
+    };
+
+    size_t value;
+    if (m_compressed) {
+        value = hash_bytes(m_vertex_positions_packed.data(),
+                           m_vertex_count * sizeof(uint64_t));
+        value = hash_combine(value, hash_bytes(&m_position_scale, sizeof(m_position_scale)));
+        value = hash_combine(value, hash_bytes(&m_position_offset, sizeof(m_position_offset)));
+    } else {
+        value = hash_bytes(m_vertex_positions_buf.data(),
+                           m_vertex_count * 3 * sizeof(InputFloat));
+    }
+
+    if (m_compressed_faces)
+        value = hash_combine(value, hash_bytes(m_faces_packed.data(),
+                                               m_face_count * sizeof(uint64_t)));
+    else
+        value = hash_combine(value, hash_bytes(m_faces_buf.data(),
+                                               m_face_count * 3 * sizeof(ScalarIndex)));
+
+    return (uint64_t) value;
 }
 
 MTS_VARIANT void Mesh<Float, Spectrum>::build_pmf() {
     std::lock_guard<tbb::spin_mutex> lock(m_mutex);
 
-    if (!m_area_pmf.empty())
+    if (m_area_pmf_ready.load(std::memory_order_relaxed))
         return; // already built!
 
     if (m_face_count == 0)
@@ -293,9 +951,15 @@ MTS_VARIANT void Mesh<Float, Spectrum>::build_pmf() {
 
     // TODO could use manage() as area_pmf doesn't need to be differentiable
     if constexpr (!is_dynamic_v<Float>) {
+        using Range = tbb::blocked_range<ScalarIndex>;
+
         std::vector<ScalarFloat> table(m_face_count);
-        for (ScalarIndex i = 0; i < m_face_count; i++)
-            table[i] = face_area(i);
+        tbb::parallel_for(Range(0, m_face_count, MTS_MESH_GRAIN_SIZE),
+            [&](const Range &range) {
+                for (ScalarIndex i = range.begin(); i != range.end(); ++i)
+                    table[i] = face_area(i);
+            }
+        );
 
         m_area_pmf = DiscreteDistribution<Float>(
             table.data(),
@@ -309,6 +973,91 @@ MTS_VARIANT void Mesh<Float, Spectrum>::build_pmf() {
             m_face_count
         );
     }
+
+    if (m_alias_sampling)
+        m_area_pmf.set_alias_table(true);
+
+    m_area_pmf_ready.store(true, std::memory_order_release);
+}
+
+MTS_VARIANT void Mesh<Float, Spectrum>::build_radiance_pmf(const Texture<Float, Spectrum> *texture,
+                                                          uint32_t sample_count) {
+    m_radiance_pmf = DiscreteDistribution<Float>();
+    m_radiance_texture = texture;
+    m_radiance_sample_count = sample_count;
+
+    if (!texture)
+        return;
+
+    if (!has_vertex_texcoords())
+        Throw("build_radiance_pmf(): mesh \"%s\" does not have UV coordinates!", m_name);
+
+    ensure_pmf_built();
+
+    // Stratified samples per face (in a k x k grid mapped onto the triangle)
+    uint32_t k = std::max(1u, (uint32_t) std::ceil(std::sqrt((double) sample_count))),
+             per_face = k * k;
+    size_t total = (size_t) m_face_count * per_face;
+
+    auto eval = [&](const UInt32 &index, const Mask &active) {
+        UInt32 face = index / per_face,
+               j    = index - face * per_face;
+
+        Point2f sample((Float(j % k) + .5f) / k, (Float(j / k) + .5f) / k);
+        Point2f b = warp::square_to_uniform_triangle(sample);
+
+        auto fi = face_indices(face, active);
+        Point2f uv0 = vertex_texcoord(fi[0], active),
+                uv1 = vertex_texcoord(fi[1], active),
+                uv2 = vertex_texcoord(fi[2], active);
+        Point2f uv = uv0 * (1.f - b.x() - b.y()) + uv1 * b.x() + uv2 * b.y();
+
+        return texture->pdf_position(uv, active);
+    };
+
+    std::vector<ScalarFloat> values(total);
+    if constexpr (!is_array_v<Float>) {
+        for (size_t i = 0; i < total; ++i)
+            values[i] = eval((uint32_t) i, true);
+    } else if constexpr (is_dynamic_v<Float>) {
+        const size_t chunk_size = 1 << 22;
+        for (size_t i = 0; i < total; i += chunk_size) {
+            uint32_t n = (uint32_t) std::min(chunk_size, total - i);
+            Float v = eval(arange<UInt32>(n) + (uint32_t) i, true).managed();
+            std::memcpy(values.data() + i, v.data(), n * sizeof(ScalarFloat));
+        }
+    } else {
+        constexpr size_t Width = array_size_v<Float>;
+        for (size_t i = 0; i < total; i += Width) {
+            UInt32 index = arange<UInt32>() + (uint32_t) i;
+            Float v = eval(index, index < (uint32_t) total);
+            for (size_t j = 0; j < Width && i + j < total; ++j)
+                values[i + j] = v.coeff(j);
+        }
+    }
+
+    // Face areas were computed by build_pmf()
+    const ScalarFloat *area = m_area_pmf.pmf().data();
+
+    std::vector<ScalarFloat> weights(m_face_count);
+    double sum = 0.0;
+    for (ScalarIndex i = 0; i < m_face_count; ++i) {
+        double value = 0.0;
+        for (uint32_t j = 0; j < per_face; ++j)
+            value += std::max((ScalarFloat) 0.f, values[(size_t) i * per_face + j]);
+        weights[i] = (ScalarFloat) (area[i] * value / per_face);
+        sum += weights[i];
+    }
+
+    // Mix in 1% of area-based sampling
+    double scale_radiance = sum > 0.0 ? 0.99 / sum : 0.0,
+           scale_area     = (sum > 0.0 ? 0.01 : 1.0) * m_area_pmf.normalization();
+    for (ScalarIndex i = 0; i < m_face_count; ++i)
+        weights[i] = (ScalarFloat) (weights[i] * scale_radiance + area[i] * scale_area);
+
+    m_radiance_pmf = DiscreteDistribution<Float>(weights.data(), m_face_count);
+    if (m_alias_sampling)
+        m_radiance_pmf.set_alias_table(true);
 }
 
 MTS_VARIANT void Mesh<Float, Spectrum>::build_parameterization() {
@@ -323,7 +1072,13 @@ MTS_VARIANT void Mesh<Float, Spectrum>::build_parameterization() {
     ref<Mesh> mesh =
         new Mesh(m_name + "_param", m_vertex_count, m_face_count,
                  props, false, false);
-    mesh->m_faces_buf = m_faces_buf;
+    if (m_compressed_faces) {
+        ScalarIndex *face_out = (ScalarIndex *) mesh->m_faces_buf.data();
+        for (ScalarSize i = 0; i < m_face_count; ++i)
+            store_unaligned(face_out + 3 * i, face_indices(i));
+    } else {
+        mesh->m_faces_buf = m_faces_buf;
+    }
 
     ScalarFloat *pos_out = (ScalarFloat *) mesh->m_vertex_positions_buf.data();
     for (size_t i = 0; i < m_vertex_count; ++i) {
@@ -345,6 +1100,24 @@ Mesh<Float, Spectrum>::primitive_count() const {
 
 MTS_VARIANT typename Mesh<Float, Spectrum>::ScalarFloat
 Mesh<Float, Spectrum>::surface_area() const {
+    if constexpr (!is_dynamic_v<Float>) {
+        /* Only emitters and sensors sample positions on their surface. For
+           all other meshes, sum up the face areas without keeping a table. */
+        if (!m_area_pmf_ready.load(std::memory_order_acquire) &&
+            !is_emitter() && !is_sensor()) {
+            using Range = tbb::blocked_range<ScalarIndex>;
+            return (ScalarFloat) tbb::parallel_reduce(
+                Range(0, m_face_count, MTS_MESH_GRAIN_SIZE), 0.0,
+                [&](const Range &range, double sum) {
+                    for (ScalarIndex i = range.begin(); i != range.end(); ++i)
+                        sum += (double) face_area(i);
+                    return sum;
+                },
+                [](double a, double b) { return a + b; }
+            );
+        }
+    }
+
     ensure_pmf_built();
     return m_area_pmf.sum();
 }
@@ -356,7 +1129,9 @@ Mesh<Float, Spectrum>::sample_position(Float time, const Point2f &sample_, Mask
     using Index = replace_scalar_t<Float, ScalarIndex>;
     Index face_idx;
     Point2f sample = sample_;
-    std::tie(face_idx, sample.y()) = m_area_pmf.sample_reuse(sample.y(), active);
+    const DiscreteDistribution<Float> &face_pmf =
+        m_radiance_pmf.empty() ? m_area_pmf : m_radiance_pmf;
+    std::tie(face_idx, sample.y()) = face_pmf.sample_reuse(sample.y(), active);
 
     Array<Index, 3> fi = face_indices(face_idx, active);
 
@@ -370,8 +1145,14 @@ Mesh<Float, Spectrum>::sample_position(Float time, const Point2f &sample_, Mask
     PositionSample3f ps;
     ps.p     = p0 + e0 * b.x() + e1 * b.y();
     ps.time  = time;
-    ps.pdf   = m_area_pmf.normalization();
     ps.delta = false;
+    ps.prim_index = face_idx;
+
+    if (m_radiance_pmf.empty())
+        ps.pdf = m_area_pmf.normalization();
+    else
+        ps.pdf = 2.f * m_radiance_pmf.eval_pmf_normalized(face_idx, active) /
+                 norm(cross(e0, e1));
 
     if (has_vertex_texcoords()) {
         Point2f uv0 = vertex_texcoord(fi[0], active),
@@ -414,9 +1195,15 @@ Mesh<Float, Spectrum>::eval_parameterization(const Point2f &uv,
     return pi.compute_surface_interaction(ray, HitComputeFlags::All, active);
 }
 
-MTS_VARIANT Float Mesh<Float, Spectrum>::pdf_position(const PositionSample3f &, Mask) const {
+MTS_VARIANT Float Mesh<Float, Spectrum>::pdf_position(const PositionSample3f &ps, Mask active) const {
     ensure_pmf_built();
-    return m_area_pmf.normalization();
+
+    if (m_radiance_pmf.empty()) {
+        return m_area_pmf.normalization();
+    } else {
+        Float area = face_area(ps.prim_index, active);
+        return select(active, m_radiance_pmf.eval_pmf_normalized(ps.prim_index, active) / area, 0.f);
+    }
 }
 
 MTS_VARIANT typename Mesh<Float, Spectrum>::Point3f
@@ -470,9 +1257,9 @@ Mesh<Float, Spectrum>::compute_surface_interaction(const Ray3f &ray,
 
     auto fi = face_indices(pi.prim_index, active);
 
-    Point3f p0 = vertex_position(fi[0], active),
-            p1 = vertex_position(fi[1], active),
-            p2 = vertex_position(fi[2], active);
+    Point3f p0 = vertex_position_at(fi[0], ray.time, active),
+            p1 = vertex_position_at(fi[1], ray.time, active),
+            p2 = vertex_position_at(fi[2], ray.time, active);
 
     Vector3f dp0 = p1 - p0,
              dp1 = p2 - p0;
@@ -512,9 +1299,9 @@ Mesh<Float, Spectrum>::compute_surface_interaction(const Ray3f &ray,
 
     // Shading normal (if available)
     if (has_vertex_normals() && likely(has_flag(flags, HitComputeFlags::ShadingFrame))) {
-        Normal3f n0 = vertex_normal(fi[0], active),
-                 n1 = vertex_normal(fi[1], active),
-                 n2 = vertex_normal(fi[2], active);
+        Normal3f n0 = vertex_normal_at(fi[0], ray.time, active),
+                 n1 = vertex_normal_at(fi[1], ray.time, active),
+                 n2 = vertex_normal_at(fi[2], ray.time, active);
 
         si.sh_frame.n = normalize(n0 * b0 + n1 * b1 + n2 * b2);
 
@@ -562,17 +1349,92 @@ MTS_VARIANT void Mesh<Float, Spectrum>::add_attribute(const std::string& name,
     if constexpr (is_spectral_v<Spectrum>) {
         if (dim == 3 && name.find("color") != std::string::npos) {
             size_t count = is_vertex_attr ? m_vertex_count : m_face_count;
-            InputFloat *ptr = (InputFloat *) buffer.data();
-            for (size_t i = 0; i < count; ++i) {
-                store_unaligned(ptr, srgb_model_fetch(load_unaligned<Color<InputFloat, 3>>(ptr)));
-                ptr += 3;
-            }
+            srgb_model_fetch((InputFloat *) buffer.data(), count);
         }
     }
 
     m_mesh_attributes.insert({ name, { dim, type, buffer } });
 }
 
+MTS_VARIANT void Mesh<Float, Spectrum>::add_attribute(const std::string& name,
+                                                      size_t dim,
+                                                      MeshAttributeFormat format,
+                                                      const PackedStorage32& buffer) {
+    if (format == MeshAttributeFormat::Float32)
+        Throw("add_attribute(): single precision attributes must be "
+              "specified as a FloatStorage buffer.");
+    if (format == MeshAttributeFormat::UNorm8 && dim > 4)
+        Throw("add_attribute(): 8 bit attributes can have at most 4 fields "
+              "(attribute %s has %i).", name, dim);
+
+    if (m_mesh_attributes.find(name) != m_mesh_attributes.end())
+        Throw("add_attribute(): attribute %s already exists.", name.c_str());
+
+    bool is_vertex_attr = name.find("vertex_") == 0;
+    bool is_face_attr   = name.find("face_") == 0;
+    if (!is_vertex_attr && !is_face_attr)
+        Throw("add_attribute(): attribute name must start with either \"vertex_\" of \"face_\".");
+
+    size_t count = is_vertex_attr ? m_vertex_count : m_face_count;
+    if (slices(buffer) != count * attribute_words(format, dim))
+        Throw("add_attribute(): attribute %s has %i words, expected %i!", name,
+              slices(buffer), count * attribute_words(format, dim));
+
+    MeshAttributeType type = is_vertex_attr ? MeshAttributeType::Vertex : MeshAttributeType::Face;
+    MeshAttribute attribute { dim, type, FloatStorage(), format, buffer };
+
+    /* In spectral modes, colors are replaced by spectral upsampling model
+       coefficients, which require single precision storage */
+    if constexpr (is_spectral_v<Spectrum>) {
+        if (dim == 3 && name.find("color") != std::string::npos) {
+            add_attribute(name, dim, unpack_attribute(attribute));
+            return;
+        }
+    }
+
+    m_mesh_attributes.insert({ name, attribute });
+}
+
+MTS_VARIANT typename Mesh<Float, Spectrum>::FloatStorage
+Mesh<Float, Spectrum>::unpack_attribute(const MeshAttribute &attr) const {
+    if (attr.format == MeshAttributeFormat::Float32)
+        return attr.buf;
+
+    size_t count = attr.type == MeshAttributeType::Vertex ? m_vertex_count : m_face_count,
+           words = attribute_words(attr.format, attr.size);
+
+    FloatStorage result = empty<FloatStorage>(count * attr.size);
+    PackedStorage32 packed = attr.packed;
+    result.managed();
+    packed.managed();
+    if constexpr (is_cuda_array_v<Float>)
+        cuda_sync();
+
+    const uint32_t *in = (const uint32_t *) packed.data();
+    InputFloat *out = (InputFloat *) result.data();
+    for (size_t i = 0; i < count; ++i) {
+        const uint32_t *v = in + i * words;
+        for (size_t j = 0; j < attr.size; ++j) {
+            InputFloat value;
+            switch (attr.format) {
+                case MeshAttributeFormat::Float16:
+                    value = enoki::half::float16_to_float32(
+                        (uint16_t) (v[j / 2] >> (16 * (j % 2))));
+                    break;
+                case MeshAttributeFormat::UNorm8:
+                    value = InputFloat((v[0] >> (8 * j)) & 0xffu) * (1.f / 255.f);
+                    break;
+                default:
+                    value = InputFloat(v[j]);
+                    break;
+            }
+            *out++ = value;
+        }
+    }
+
+    return result;
+}
+
 MTS_VARIANT typename Mesh<Float, Spectrum>::UnpolarizedSpectrum
 Mesh<Float, Spectrum>::eval_attribute(const std::string& name,
                                       const SurfaceInteraction3f &si,
@@ -583,9 +1445,9 @@ Mesh<Float, Spectrum>::eval_attribute(const std::string& name,
 
     const auto& attr = it->second;
     if (attr.size == 1)
-        return interpolate_attribute<1, false>(attr.type, attr.buf, si, active);
+        return interpolate_attribute<1, false>(attr, si, active);
     else if (attr.size == 3) {
-        auto result = interpolate_attribute<3, false>(attr.type, attr.buf, si, active);
+        auto result = interpolate_attribute<3, false>(attr, si, active);
         if constexpr (is_monochromatic_v<Spectrum>)
             return luminance(result);
         else
@@ -605,7 +1467,7 @@ Mesh<Float, Spectrum>::eval_attribute_1(const std::string& name,
 
     const auto& attr = it->second;
     if (attr.size == 1)
-        return interpolate_attribute<1, true>(attr.type, attr.buf, si, active);
+        return interpolate_attribute<1, true>(attr, si, active);
     else
         Throw("eval_attribute_1(): Attribute \"%s\" requested but had size %u.", name, attr.size);
 }
@@ -620,7 +1482,7 @@ Mesh<Float, Spectrum>::eval_attribute_3(const std::string& name,
 
     const auto& attr = it->second;
     if (attr.size == 3) {
-        return interpolate_attribute<3, true>(attr.type, attr.buf, si, active);
+        return interpolate_attribute<3, true>(attr, si, active);
     } else
         Throw("eval_attribute_3(): Attribute \"%s\" requested but had size %u.", name, attr.size);
 }
@@ -688,6 +1550,14 @@ Mesh<Float, Spectrum>::bbox(ScalarIndex index, const ScalarBoundingBox3f &clip)
 
     Assert(index <= m_face_count);
 
+    /* Moving triangles sweep a volume that is not captured by clipping the
+       individual keyframes. Fall back to clipping their conservative bounds. */
+    if (is_deforming()) {
+        ScalarBoundingBox3f result = bbox(index);
+        result.clip(clip);
+        return result;
+    }
+
     auto fi = face_indices(index);
     Assert(fi[0] < m_vertex_count);
     Assert(fi[1] < m_vertex_count);
@@ -741,12 +1611,21 @@ MTS_VARIANT std::string Mesh<Float, Spectrum>::to_string() const {
 
     oss << "  disable_vertex_normals = " << m_disable_vertex_normals;
 
+    if (m_compressed)
+        oss << "," << std::endl << "  compressed = " << m_compressed;
+
+    if (is_deforming())
+        oss << "," << std::endl << "  keyframes = " << m_keyframe_count
+            << " (time = [" << m_motion_start << ", " << m_motion_end << "])";
+
     if (!m_mesh_attributes.empty()) {
         oss << "," << std::endl << "  mesh attributes = [" << std::endl;
         size_t i = 0;
+        const char *formats[] = { "float", "half", "uint8", "uint32" };
         for(const auto &[name, attribute]: m_mesh_attributes)
-            oss << "    " << name << ": " << attribute.size
-                << (attribute.size == 1 ? " float" : " floats")
+            oss << "    " << name << ": " << attribute.size << " "
+                << formats[(uint32_t) attribute.format]
+                << (attribute.size == 1 ? "" : "s")
                 << (++i == m_mesh_attributes.size() ? "" : ",") << std::endl;
         oss << "  ]" << std::endl;
     } else {
@@ -758,43 +1637,138 @@ MTS_VARIANT std::string Mesh<Float, Spectrum>::to_string() const {
 }
 
 MTS_VARIANT size_t Mesh<Float, Spectrum>::vertex_data_bytes() const {
-    size_t vertex_data_bytes = 3 * sizeof(InputFloat);
+    size_t vertex_data_bytes;
 
-    if (has_vertex_normals())
-        vertex_data_bytes += 3 * sizeof(InputFloat);
-    if (has_vertex_texcoords())
-        vertex_data_bytes += 2 * sizeof(InputFloat);
+    if (m_compressed) {
+        vertex_data_bytes = sizeof(uint64_t);
+        if (has_vertex_normals())
+            vertex_data_bytes += sizeof(uint32_t);
+        if (has_vertex_texcoords())
+            vertex_data_bytes += sizeof(uint32_t);
+    } else {
+        vertex_data_bytes = 3 * sizeof(InputFloat);
+        if (has_vertex_normals())
+            vertex_data_bytes += 3 * sizeof(InputFloat);
+        if (has_vertex_texcoords())
+            vertex_data_bytes += 2 * sizeof(InputFloat);
+
+        size_t keyframe_dims = 3;
+        if (slices(m_keyframe_normals_buf) != 0)
+            keyframe_dims += 3;
+        vertex_data_bytes += (m_keyframe_count - 1) * keyframe_dims * sizeof(InputFloat);
+    }
 
     for (const auto&[name, attribute]: m_mesh_attributes)
         if (attribute.type == MeshAttributeType::Vertex)
-            vertex_data_bytes += attribute.size * sizeof(InputFloat);
+            vertex_data_bytes += attribute_words(attribute.format, attribute.size) * 4;
 
     return vertex_data_bytes;
 }
 
 MTS_VARIANT size_t Mesh<Float, Spectrum>::face_data_bytes() const {
-    size_t face_data_bytes = 3 * sizeof(ScalarIndex);
+    size_t face_data_bytes = m_compressed_faces ? sizeof(uint64_t) : 3 * sizeof(ScalarIndex);
 
     for (const auto&[name, attribute]: m_mesh_attributes)
         if (attribute.type == MeshAttributeType::Face)
-            face_data_bytes += attribute.size * sizeof(InputFloat);
+            face_data_bytes += attribute_words(attribute.format, attribute.size) * 4;
 
     return face_data_bytes;
 }
 
 #if defined(MTS_ENABLE_EMBREE)
+/// Embree filter callback, which rejects intersections with transparent regions of a mesh
+template <typename Float, typename Spectrum>
+void embree_alpha_filter(const RTCFilterFunctionNArguments *args) {
+    using Mesh = mitsuba::Mesh<Float, Spectrum>;
+    MTS_IMPORT_TYPES()
+
+    const Mesh *mesh = (const Mesh *) args->geometryUserPtr;
+    RTCRayN *rays = args->ray;
+    RTCHitN *hits = args->hit;
+    unsigned int n = args->N;
+
+    for (unsigned int i = 0; i < n; ++i) {
+        if (args->valid[i] != -1)
+            continue;
+
+        // Broadcast the ray to all lanes in the packet variants
+        Ray3f ray = zero<Ray3f>();
+        ray.o = Point3f(RTCRayN_org_x(rays, n, i), RTCRayN_org_y(rays, n, i),
+                        RTCRayN_org_z(rays, n, i));
+        ray.d = Vector3f(RTCRayN_dir_x(rays, n, i), RTCRayN_dir_y(rays, n, i),
+                         RTCRayN_dir_z(rays, n, i));
+        ray.mint = RTCRayN_tnear(rays, n, i);
+        ray.maxt = RTCRayN_tfar(rays, n, i);
+        ray.time = RTCRayN_time(rays, n, i);
+        ray.update();
+
+        // 'tfar' holds the distance of the tentative intersection
+        PreliminaryIntersection3f pi = zero<PreliminaryIntersection3f>();
+        pi.t          = RTCRayN_tfar(rays, n, i);
+        pi.prim_uv    = Point2f(RTCHitN_u(hits, n, i), RTCHitN_v(hits, n, i));
+        pi.prim_index = RTCHitN_primID(hits, n, i);
+        pi.shape      = mesh;
+
+        if (none(mesh->alpha_test(ray, pi)))
+            args->valid[i] = 0;
+    }
+}
+
 MTS_VARIANT RTCGeometry Mesh<Float, Spectrum>::embree_geometry(RTCDevice device) {
     RTCGeometry geom = rtcNewGeometry(device, RTC_GEOMETRY_TYPE_TRIANGLE);
 
+    embree_set_vertex_buffers(geom);
+    rtcSetSharedGeometryBuffer(geom, RTC_BUFFER_TYPE_INDEX, 0, RTC_FORMAT_UINT3,
+                               m_faces_buf.data(), 0, 3 * sizeof(ScalarIndex),
+                               m_face_count);
+
+    // Skip transparent regions during the traversal of both ray types
+    if constexpr (!is_cuda_array_v<Float>) {
+        if (has_alpha_mask()) {
+            rtcSetGeometryUserData(geom, (void *) this);
+            rtcSetGeometryIntersectFilterFunction(geom, embree_alpha_filter<Float, Spectrum>);
+            rtcSetGeometryOccludedFilterFunction(geom, embree_alpha_filter<Float, Spectrum>);
+        }
+    }
+
+    rtcCommitGeometry(geom);
+    return geom;
+}
+
+MTS_VARIANT void Mesh<Float, Spectrum>::embree_set_vertex_buffers(RTCGeometry geom) {
+    /* Keyframes map onto Embree's time steps, which yields a BVH with
+       time-segmented bounds (the keyframes are evenly spaced in both) */
+    rtcSetGeometryTimeStepCount(geom, m_keyframe_count);
+    if (is_deforming())
+        rtcSetGeometryTimeRange(geom, (float) m_motion_start, (float) m_motion_end);
+
     rtcSetSharedGeometryBuffer(geom, RTC_BUFFER_TYPE_VERTEX, 0, RTC_FORMAT_FLOAT3,
                                m_vertex_positions_buf.data(), 0, 3 * sizeof(InputFloat),
                                m_vertex_count);
+    for (ScalarSize k = 1; k < m_keyframe_count; ++k)
+        rtcSetSharedGeometryBuffer(geom, RTC_BUFFER_TYPE_VERTEX, k, RTC_FORMAT_FLOAT3,
+                                   m_keyframe_positions_buf.data(),
+                                   (k - 1) * m_vertex_count * 3 * sizeof(InputFloat),
+                                   3 * sizeof(InputFloat), m_vertex_count);
+}
+
+MTS_VARIANT void Mesh<Float, Spectrum>::embree_update_geometry(RTCGeometry geom) {
+    /* Refitting is sufficient as long as the topology is unchanged, which is
+       assumed when the face buffer has not been replaced */
+    bool same_topology =
+        rtcGetGeometryBufferData(geom, RTC_BUFFER_TYPE_INDEX, 0) == m_faces_buf.data();
+
+    embree_set_vertex_buffers(geom);
     rtcSetSharedGeometryBuffer(geom, RTC_BUFFER_TYPE_INDEX, 0, RTC_FORMAT_UINT3,
                                m_faces_buf.data(), 0, 3 * sizeof(ScalarIndex),
                                m_face_count);
+    for (ScalarSize k = 0; k < m_keyframe_count; ++k)
+        rtcUpdateGeometryBuffer(geom, RTC_BUFFER_TYPE_VERTEX, k);
+    rtcUpdateGeometryBuffer(geom, RTC_BUFFER_TYPE_INDEX, 0);
+    rtcSetGeometryBuildQuality(geom, same_topology ? RTC_BUILD_QUALITY_REFIT
+                                                   : RTC_BUILD_QUALITY_MEDIUM);
 
     rtcCommitGeometry(geom);
-    return geom;
 }
 #endif
 
@@ -803,6 +1777,13 @@ static const uint32_t triangle_input_flags =  OPTIX_GEOMETRY_FLAG_DISABLE_ANYHIT
 
 MTS_VARIANT void Mesh<Float, Spectrum>::optix_prepare_geometry() {
     if constexpr (is_cuda_array_v<Float>) {
+        if (is_deforming()) {
+            std::call_once(m_optix_motion_warning, [&]() {
+                Log(Warn, "\"%s\": deformation motion blur is not supported by "
+                          "the OptiX backend, using the first keyframe.", m_name);
+            });
+        }
+
         m_vertex_buffer_ptr = (void*) m_vertex_positions_buf.data();
 
         if (!m_optix_data_ptr)
@@ -812,13 +1793,84 @@ MTS_VARIANT void Mesh<Float, Spectrum>::optix_prepare_geometry() {
             (const optix::Vector3u *) m_faces_buf.data(),
             (const optix::Vector3f *) m_vertex_positions_buf.data(),
             (const optix::Vector3f *) m_vertex_normals_buf.data(),
-            (const optix::Vector2f *) m_vertex_texcoords_buf.data()
+            (const optix::Vector2f *) m_vertex_texcoords_buf.data(),
+            nullptr, nullptr, nullptr
         };
 
         cuda_memcpy_to_device(m_optix_data_ptr, &data, sizeof(OptixMeshData));
     }
 }
 
+MTS_VARIANT void Mesh<Float, Spectrum>::optix_prepare_batch(OptixMeshBatch &batch) {
+    size_t mesh_count = batch.shapes.size();
+
+    batch.faces            = cuda_malloc(batch.face_count * 3 * sizeof(uint32_t));
+    batch.vertex_positions = cuda_malloc(batch.vertex_count * 3 * sizeof(InputFloat));
+    if (batch.has_normals)
+        batch.vertex_normals = cuda_malloc(batch.vertex_count * 3 * sizeof(InputFloat));
+    if (batch.has_texcoords)
+        batch.vertex_texcoords = cuda_malloc(batch.vertex_count * 2 * sizeof(InputFloat));
+
+    // The mapping from faces to meshes doesn't change, upload it once
+    std::vector<uint32_t> face_mesh(batch.face_count);
+    for (size_t i = 0; i < mesh_count; ++i) {
+        uint32_t end = i + 1 < mesh_count ? batch.face_offsets[i + 1] : batch.face_count;
+        std::fill(face_mesh.begin() + batch.face_offsets[i], face_mesh.begin() + end,
+                  (uint32_t) i);
+    }
+
+    batch.face_mesh        = cuda_malloc(batch.face_count * sizeof(uint32_t));
+    batch.mesh_shape_ptr   = cuda_malloc(mesh_count * sizeof(unsigned long long));
+    batch.mesh_face_offset = cuda_malloc(mesh_count * sizeof(uint32_t));
+    cuda_memcpy_to_device(batch.face_mesh, face_mesh.data(),
+                          batch.face_count * sizeof(uint32_t));
+    cuda_memcpy_to_device(batch.mesh_shape_ptr, batch.shape_ptrs.data(),
+                          mesh_count * sizeof(unsigned long long));
+    cuda_memcpy_to_device(batch.mesh_face_offset, batch.face_offsets.data(),
+                          mesh_count * sizeof(uint32_t));
+
+    OptixMeshData data = {
+        (const optix::Vector3u *) batch.faces,
+        (const optix::Vector3f *) batch.vertex_positions,
+        (const optix::Vector3f *) batch.vertex_normals,
+        (const optix::Vector2f *) batch.vertex_texcoords,
+        (const unsigned int *) batch.face_mesh,
+        (const unsigned long long *) batch.mesh_shape_ptr,
+        (const unsigned int *) batch.mesh_face_offset
+    };
+
+    batch.data_ptr = cuda_malloc(sizeof(OptixMeshData));
+    cuda_memcpy_to_device(batch.data_ptr, &data, sizeof(OptixMeshData));
+}
+
+MTS_VARIANT void Mesh<Float, Spectrum>::optix_fill_batch(OptixMeshBatch &batch,
+                                                         uint32_t index) const {
+    if constexpr (is_cuda_array_v<Float>) {
+        using Index = DynamicBuffer<UInt32>;
+        uint32_t vertex_offset = batch.vertex_offsets[index],
+                 face_offset   = batch.face_offsets[index];
+
+        // The vertex indices are offset by the vertices of the preceding meshes
+        Index faces = Index::map(batch.faces, batch.face_count * 3);
+        scatter(faces, m_faces_buf + vertex_offset,
+                arange<Index>(m_face_count * 3) + face_offset * 3);
+
+        auto copy = [&](void *target, const FloatStorage &source, uint32_t dim) {
+            FloatStorage buffer = FloatStorage::map(target, batch.vertex_count * dim);
+            scatter(buffer, source, arange<Index>(m_vertex_count * dim) + vertex_offset * dim);
+        };
+
+        copy(batch.vertex_positions, m_vertex_positions_buf, 3);
+        if (batch.has_normals)
+            copy(batch.vertex_normals, m_vertex_normals_buf, 3);
+        if (batch.has_texcoords)
+            copy(batch.vertex_texcoords, m_vertex_texcoords_buf, 2);
+    } else {
+        ENOKI_MARK_USED(batch);
+        ENOKI_MARK_USED(index);
+    }
+}
+
 MTS_VARIANT void Mesh<Float, Spectrum>::optix_build_input(OptixBuildInput &build_input) const {
     build_input.type                           = OPTIX_BUILD_INPUT_TYPE_TRIANGLES;
     build_input.triangleArray.vertexFormat     = OPTIX_VERTEX_FORMAT_FLOAT3;
@@ -837,17 +1889,55 @@ MTS_VARIANT void Mesh<Float, Spectrum>::traverse(TraversalCallback *callback) {
 
     callback->put_parameter("vertex_count",         m_vertex_count);
     callback->put_parameter("face_count",           m_face_count);
-    callback->put_parameter("faces_buf",            m_faces_buf);
-    callback->put_parameter("vertex_positions_buf", m_vertex_positions_buf);
-    callback->put_parameter("vertex_normals_buf",   m_vertex_normals_buf);
-    callback->put_parameter("vertex_texcoords_buf", m_vertex_texcoords_buf);
 
+    // Compressed meshes are read-only
+    if (!m_compressed) {
+        callback->put_parameter("faces_buf",            m_faces_buf);
+        callback->put_parameter("vertex_positions_buf", m_vertex_positions_buf);
+        callback->put_parameter("vertex_normals_buf",   m_vertex_normals_buf);
+        callback->put_parameter("vertex_texcoords_buf", m_vertex_texcoords_buf);
+    }
+
+    // Compact attributes are not differentiable and are not exposed
     for(auto &[name, attribute]: m_mesh_attributes)
-        callback->put_parameter(tfm::format("%s_buf", name.c_str()), attribute.buf);
+        if (attribute.format == MeshAttributeFormat::Float32)
+            callback->put_parameter(tfm::format("%s_buf", name.c_str()), attribute.buf);
+}
+
+MTS_VARIANT void Mesh<Float, Spectrum>::account_memory(MemoryReport *report) const {
+    const MemoryCategory geometry = MemoryCategory::Geometry;
+    // Buffers in a shared geometry file are owned by the page cache
+    if (!m_shared_mapping) {
+        report->add_array(geometry, m_faces_buf);
+        report->add_array(geometry, m_vertex_positions_buf);
+        report->add_array(geometry, m_vertex_normals_buf);
+        report->add_array(geometry, m_vertex_texcoords_buf);
+    }
+    report->add_array(geometry, m_faces_packed);
+    report->add_array(geometry, m_vertex_positions_packed);
+    report->add_array(geometry, m_vertex_normals_packed);
+    report->add_array(geometry, m_vertex_texcoords_packed);
+    report->add_array(geometry, m_keyframe_positions_buf);
+    report->add_array(geometry, m_keyframe_normals_buf);
+
+    for (auto &[name, attribute] : m_mesh_attributes) {
+        report->add_array(geometry, attribute.buf);
+        report->add_array(geometry, attribute.packed);
+    }
+
+    for (const DiscreteDistribution<Float> *pmf : { &m_area_pmf, &m_radiance_pmf }) {
+        report->add_array(MemoryCategory::Distributions, pmf->pmf());
+        report->add_array(MemoryCategory::Distributions, pmf->cdf());
+    }
+
+    Base::account_memory(report);
 }
 
 MTS_VARIANT void Mesh<Float, Spectrum>::parameters_changed(const std::vector<std::string> &keys) {
     if (keys.empty() || string::contains(keys, "vertex_positions_buf")) {
+        // The geometry no longer matches the file it was loaded from
+        m_source_key.clear();
+
         if constexpr (is_cuda_array_v<Float>) {
             m_vertex_positions_buf.managed();
             cuda_eval();
@@ -859,8 +1949,14 @@ MTS_VARIANT void Mesh<Float, Spectrum>::parameters_changed(const std::vector<std
         if (has_vertex_normals())
             recompute_vertex_normals();
 
-        if (!m_area_pmf.empty())
+        if (m_area_pmf_ready.load(std::memory_order_relaxed)) {
+            std::lock_guard<tbb::spin_mutex> lock(m_mutex);
             m_area_pmf = DiscreteDistribution<Float>();
+            m_area_pmf_ready.store(false, std::memory_order_relaxed);
+        }
+
+        if (m_radiance_texture)
+            build_radiance_pmf(m_radiance_texture.get(), m_radiance_sample_count);
 
         if (m_parameterization)
             m_parameterization = nullptr;
@@ -24,6 +24,9 @@ const char* (*optixGetErrorName)(OptixResult) = nullptr;
 const char* (*optixGetErrorString)(OptixResult) = nullptr;
 OptixResult (*optixDeviceContextCreate)(CUcontext, const OptixDeviceContextOptions*, OptixDeviceContext*) = nullptr;
 OptixResult (*optixDeviceContextDestroy)(OptixDeviceContext) = nullptr;
+OptixResult (*optixDeviceContextSetCacheEnabled)(OptixDeviceContext, int) = nullptr;
+OptixResult (*optixDeviceContextSetCacheLocation)(OptixDeviceContext, const char*) = nullptr;
+OptixResult (*optixDeviceContextSetCacheDatabaseSizes)(OptixDeviceContext, size_t, size_t) = nullptr;
 OptixResult (*optixModuleCreateFromPTX)(OptixDeviceContext, const OptixModuleCompileOptions*, const OptixPipelineCompileOptions*, const char*, size_t, char*, size_t*, OptixModule*) = nullptr;
 OptixResult (*optixModuleDestroy)(OptixModule) = nullptr;
 OptixResult (*optixProgramGroupCreate)(OptixDeviceContext, const OptixProgramGroupDesc*, unsigned int, const OptixProgramGroupOptions*, char*, size_t*, OptixProgramGroup*) = nullptr;
@@ -47,11 +50,53 @@ static bool optix_init_success = false;
 
 NAMESPACE_BEGIN(mitsuba)
 
+static std::string optix_cache_dir;
+
+/// Set an environment variable unless the user already specified it
+static void set_env_default(const char *name, const std::string &value) {
+    if (getenv(name))
+        return;
+#if defined(_WIN32)
+    _putenv_s(name, value.c_str());
+#else
+    setenv(name, value.c_str(), 0);
+#endif
+}
+
+void optix_set_cache_path(const std::string &path) {
+    if (path.empty())
+        return;
+
+    fs::path dir(path);
+    if (!fs::exists(dir) && !fs::create_directory(dir))
+        Throw("optix_set_cache_path(): could not create the directory \"%s\"!", path);
+    optix_cache_dir = fs::absolute(dir).string();
+
+    /* The CUDA driver caches the machine code of all PTX kernels (including
+       the ones generated by Enoki) in a small per-user directory by default.
+       Relocate it and raise its size limit (4 GiB) so that entries survive
+       across jobs. This only has an effect before the driver is initialized. */
+    set_env_default("CUDA_CACHE_PATH", (fs::path(optix_cache_dir) / "cuda").string());
+    set_env_default("CUDA_CACHE_MAXSIZE", "4294967296");
+
+    Log(Info, "Caching compiled GPU kernels in \"%s\"", optix_cache_dir);
+}
+
+const std::string &optix_cache_path() {
+    return optix_cache_dir;
+}
+
 bool optix_initialize() {
     if (optix_init_attempted)
         return optix_init_success;
     optix_init_attempted = true;
 
+    if (optix_cache_dir.empty()) {
+        const char *cache_dir = getenv("MTS_KERNEL_CACHE");
+        if (cache_dir)
+            optix_set_cache_path(cache_dir);
+    }
+
 #if !defined(MTS_USE_OPTIX_HEADERS)
     Log(LogLevel::Info, "Dynamic loading of the Optix library ..");
 
@@ -164,6 +209,9 @@ bool optix_initialize() {
     LOAD(optixGetErrorString, 1);
     LOAD(optixDeviceContextCreate, 2);
     LOAD(optixDeviceContextDestroy, 3);
+    LOAD(optixDeviceContextSetCacheEnabled, 6);
+    LOAD(optixDeviceContextSetCacheLocation, 7);
+    LOAD(optixDeviceContextSetCacheDatabaseSizes, 8);
     LOAD(optixModuleCreateFromPTX, 12);
     LOAD(optixModuleDestroy, 13);
     LOAD(optixProgramGroupCreate, 14);
@@ -183,13 +231,18 @@ bool optix_initialize() {
 }
 
 void optix_shutdown() {
+    // Scenes share an OptiX context and pipeline, which must be destroyed first
+    optix_release_shared_config();
+
 #if !defined(MTS_USE_OPTIX_HEADERS)
     if (!optix_init_success)
         return;
 
     #define Z(x) x = nullptr
     Z(optixGetErrorName); Z(optixGetErrorString); Z(optixDeviceContextCreate);
-    Z(optixDeviceContextDestroy); Z(optixModuleCreateFromPTX); Z(optixModuleDestroy);
+    Z(optixDeviceContextDestroy); Z(optixDeviceContextSetCacheEnabled);
+    Z(optixDeviceContextSetCacheLocation); Z(optixDeviceContextSetCacheDatabaseSizes);
+    Z(optixModuleCreateFromPTX); Z(optixModuleDestroy);
     Z(optixProgramGroupCreate); Z(optixProgramGroupDestroy);
     Z(optixPipelineCreate); Z(optixPipelineDestroy); Z(optixAccelComputeMemoryUsage);
     Z(optixAccelBuild); Z(optixAccelCompact); Z(optixSbtRecordPackHeader);
@@ -0,0 +1,84 @@
+#include <mitsuba/render/progressive.h>
+#include <mitsuba/render/film.h>
+#include <mitsuba/render/integrator.h>
+#include <mitsuba/render/sampler.h>
+#include <mitsuba/render/scene.h>
+#include <mitsuba/render/sensor.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+MTS_VARIANT ProgressiveRenderer<Float, Spectrum>::ProgressiveRenderer(Scene *scene, Sensor *sensor)
+    : m_scene(scene), m_sensor(sensor) {
+    if (!m_sensor) {
+        if (scene->sensors().empty())
+            Throw("ProgressiveRenderer: the scene does not contain a sensor!");
+        m_sensor = scene->sensors()[0];
+    }
+
+    m_integrator = dynamic_cast<SamplingIntegrator *>(scene->integrator());
+    if (!m_integrator)
+        Throw("ProgressiveRenderer: requires a sampling-based integrator!");
+
+    m_base_seed = m_sensor->sampler()->base_seed();
+}
+
+MTS_VARIANT ProgressiveRenderer<Float, Spectrum>::~ProgressiveRenderer() { }
+
+MTS_VARIANT bool ProgressiveRenderer<Float, Spectrum>::render_pass() {
+    m_restart = false;
+
+    // Every pass uses a different seed, also after a restart
+    Sampler *sampler = m_sensor->sampler();
+    sampler->set_base_seed(m_base_seed + ++m_seed_index);
+    bool success = m_integrator->render(m_scene, m_sensor);
+    sampler->set_base_seed(m_base_seed);
+
+    // Don't accumulate a pass that was interrupted by an edit of the scene
+    if (!success || m_restart)
+        return false;
+
+    ref<Bitmap> frame = m_sensor->film()->bitmap();
+    if (frame->component_format() != Struct::Type::Float32)
+        frame = frame->convert(frame->pixel_format(), Struct::Type::Float32,
+                               frame->srgb_gamma());
+
+    std::lock_guard<std::mutex> guard(m_mutex);
+    if (!m_accum || m_accum->size() != frame->size() ||
+        m_accum->pixel_format() != frame->pixel_format()) {
+        m_accum = frame;
+        m_pass_count = 1;
+        return true;
+    }
+
+    // Running average, updated in place
+    float weight = 1.f / (float) (m_pass_count + 1);
+    float *target = (float *) m_accum->data();
+    const float *source = (const float *) frame->data();
+    size_t count = m_accum->pixel_count() * m_accum->channel_count();
+    for (size_t i = 0; i < count; ++i)
+        target[i] += (source[i] - target[i]) * weight;
+    m_pass_count++;
+
+    return true;
+}
+
+MTS_VARIANT void ProgressiveRenderer<Float, Spectrum>::restart() {
+    m_restart = true;
+    m_integrator->cancel();
+    std::lock_guard<std::mutex> guard(m_mutex);
+    m_pass_count = 0;
+}
+
+MTS_VARIANT std::string ProgressiveRenderer<Float, Spectrum>::to_string() const {
+    std::ostringstream oss;
+    oss << "ProgressiveRenderer[" << std::endl
+        << "  sensor = " << string::indent(m_sensor) << "," << std::endl
+        << "  integrator = " << string::indent(m_integrator) << "," << std::endl
+        << "  pass_count = " << m_pass_count << std::endl
+        << "]";
+    return oss.str();
+}
+
+MTS_IMPLEMENT_CLASS_VARIANT(ProgressiveRenderer, Object)
+MTS_INSTANTIATE_CLASS(ProgressiveRenderer)
+NAMESPACE_END(mitsuba)
@@ -39,6 +39,10 @@ public:
         PYBIND11_OVERLOAD_PURE(ScalarBoundingBox3f, Emitter, bbox,);
     }
 
+    ScalarFloat power() const override {
+        PYBIND11_OVERLOAD(ScalarFloat, Emitter, power,);
+    }
+
 
     std::string to_string() const override {
         PYBIND11_OVERLOAD_PURE(std::string, Emitter, to_string,);
@@ -52,7 +56,15 @@ MTS_PY_EXPORT(Emitter) {
     auto emitter = py::class_<Emitter, PyEmitter, Endpoint, ref<Emitter>>(m, "Emitter", D(Emitter))
         .def(py::init<const Properties&>())
         .def_method(Emitter, is_environment)
-        .def_method(Emitter, flags);
+        .def_method(Emitter, flags)
+        .def_method(Emitter, power)
+        .def_method(Emitter, selection_pmf)
+        .def("sample_direction_lobe", vectorize(&Emitter::sample_direction_lobe),
+            "ref"_a, "sample"_a, "lobe_axis"_a, "lobe_exponent"_a, "active"_a = true,
+            D(Emitter, sample_direction_lobe))
+        .def("pdf_direction_lobe", vectorize(&Emitter::pdf_direction_lobe),
+            "ref"_a, "ds"_a, "lobe_axis"_a, "lobe_exponent"_a, "active"_a = true,
+            D(Emitter, pdf_direction_lobe));
 
     if constexpr (is_cuda_array_v<Float>)
         pybind11_type_alias<UInt64, EmitterPtr>();
@@ -18,6 +18,8 @@ MTS_PY_EXPORT(Endpoint) {
             "it"_a, "sample"_a, "active"_a = true, D(Endpoint, sample_direction))
         .def("pdf_direction", vectorize(&Endpoint::pdf_direction),
             "it"_a, "ds"_a, "active"_a = true, D(Endpoint, pdf_direction))
+        .def("pdf_ray", vectorize(&Endpoint::pdf_ray),
+            "ps"_a, "d"_a, "active"_a = true, D(Endpoint, pdf_ray))
         .def("eval", vectorize(&Endpoint::eval),
             "si"_a, "active"_a = true, D(Endpoint, eval))
         .def_method(Endpoint, world_transform)
@@ -19,11 +19,27 @@ MTS_PY_EXPORT(Film) {
                 &Film::develop, py::const_),
             "offset"_a, "size"_a, "target_offset"_a, "target"_a)
         .def_method(Film, destination_exists, "basename"_a)
+        .def_method(Film, destination_file)
+        .def_method(Film, snapshot)
+        .def_method(Film, restore, "snapshot"_a)
+        .def_method(Film, splat_block)
+        .def_method(Film, configure_block, "block"_a)
+        .def_method(Film, merge_splats)
         .def_method(Film, bitmap, "raw"_a = false)
         .def_method(Film, has_high_quality_edges)
+        .def_method(Film, has_deferred_filter)
+        .def_method(Film, unfiltered_channels, "channels"_a)
+        .def_method(Film, add_id_layer, "name"_a, "manifest"_a = "")
+        .def_method(Film, id_layers)
+        .def_method(Film, id_channels, "channels"_a)
+        .def_method(Film, set_priority_map, "map"_a)
+        .def_method(Film, priority_map)
+        .def("metadata", py::overload_cast<>(&Film::metadata), D(Film, metadata),
+            py::return_value_policy::reference_internal)
         .def_method(Film, size)
         .def_method(Film, crop_size)
         .def_method(Film, crop_offset)
         .def_method(Film, set_crop_window)
-        .def_method(Film, reconstruction_filter);
+        .def_method(Film, reconstruction_filter)
+        .def_method(Film, sample_filter);
 }
@@ -24,7 +24,28 @@ MTS_PY_EXPORT(ImageBlock) {
                     throw std::runtime_error("Incompatible channel count!");
                 ib.put(pos, data.data(), mask);
             }, "pos"_a, "data"_a, "active"_a = true)
+        .def("splat", vectorize(&ImageBlock::splat),
+            "pos"_a, "wavelengths"_a, "value"_a, "active"_a = true, D(ImageBlock, splat))
         .def_method(ImageBlock, clear)
+        .def_method(ImageBlock, set_unfiltered_channels, "unfiltered"_a,
+            "id_layers"_a = std::vector<uint32_t>())
+        .def_method(ImageBlock, has_unfiltered_channels)
+        .def_method(ImageBlock, set_deep_samples, "max_samples"_a, "depth_channel"_a,
+            "merge_tolerance"_a = 0.01f)
+        .def_method(ImageBlock, deep_samples)
+        .def("deep_pixel", [](const ImageBlock &ib, const ScalarPoint2i &p) {
+                if (ib.deep_samples() == 0)
+                    throw std::runtime_error("The block doesn't record deep samples!");
+                ScalarVector2i size = ib.size() + 2 * ib.border_size();
+                if (any(p < 0 || p >= size))
+                    throw std::runtime_error("Pixel out of bounds!");
+                const ScalarFloat *pixel = ib.deep_pixel(p);
+                py::list records;
+                for (uint32_t k = 0; k < ib.deep_samples() && pixel[2 + 6 * k] != 0.f; ++k)
+                    records.append(std::vector<ScalarFloat>(pixel + 1 + 6 * k,
+                                                            pixel + 7 + 6 * k));
+                return std::make_pair(pixel[0], records);
+            }, "p"_a, D(ImageBlock, deep_pixel))
         .def_method(ImageBlock, set_offset, "offset"_a)
         .def_method(ImageBlock, offset)
         .def_method(ImageBlock, size)
@@ -34,7 +55,23 @@ MTS_PY_EXPORT(ImageBlock) {
         .def_method(ImageBlock, warn_negative)
         .def_method(ImageBlock, set_warn_invalid, "value"_a)
         .def_method(ImageBlock, set_warn_negative, "value"_a)
+        .def_method(ImageBlock, set_wavefront_layout, "spp"_a, "max_gathers"_a = 256)
+        .def_method(ImageBlock, wavefront_layout)
+        .def_method(ImageBlock, set_wavefront_tile_size, "tile_size"_a)
+        .def_method(ImageBlock, wavefront_tile_size)
+        .def_method(ImageBlock, wavefront_pixel, "index"_a)
         .def_method(ImageBlock, border_size)
         .def_method(ImageBlock, channel_count)
-        .def("data", py::overload_cast<>(&ImageBlock::data, py::const_), D(ImageBlock, data));
+        .def("data", py::overload_cast<>(&ImageBlock::data, py::const_), D(ImageBlock, data),
+             py::return_value_policy::reference_internal)
+        .def("data_view", [](py::object self, bool cuda) {
+                ImageBlock &ib = py::cast<ImageBlock &>(self);
+                size_t border = 2 * (size_t) ib.border_size();
+                return array_view(ib.data(),
+                                  { ib.height() + border, ib.width() + border,
+                                    ib.channel_count() }, self, cuda);
+            }, "cuda"_a = false,
+            "Return a (height, width, channel_count) view of the pixel buffer "
+            "(including the border) that does not copy any data (a NumPy array, "
+            "or an object implementing __cuda_array_interface__ when 'cuda' is set).");
 }
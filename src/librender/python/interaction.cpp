@@ -13,6 +13,7 @@ MTS_PY_EXPORT(HitComputeFlags) {
         .def_value(HitComputeFlags, NonDifferentiable)
         .def_value(HitComputeFlags, All)
         .def_value(HitComputeFlags, AllNonDifferentiable)
+        .def_value(HitComputeFlags, Connection)
         .def(py::self == py::self)
         .def(py::self | py::self)
         .def(py::self & py::self)
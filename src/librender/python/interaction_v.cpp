@@ -50,6 +50,7 @@ void bind_slicing_operator_surfaceinteraction(PyClass &cl) {
             res.wi          = slice(si.wi, i);
             res.prim_index  = slice(si.prim_index, i);
             res.instance    = si.instance[i];
+            res.instance_index = slice(si.instance_index, i);
             return res;
         })
         .def("__setitem__", [](Class &r, size_t i,
@@ -77,6 +78,7 @@ void bind_slicing_operator_surfaceinteraction(PyClass &cl) {
             slice(r.wi, i)          = slice(r2.wi, 0);
             slice(r.prim_index, i)  = slice(r2.prim_index, 0);
             r.instance[i]                  = slice(r2.instance, 0);
+            slice(r.instance_index, i) = slice(r2.instance_index, 0);
         })
         .def("__len__", [](const Class &r) {
             return slices(r);
@@ -111,6 +113,7 @@ MTS_PY_EXPORT(SurfaceInteraction) {
         .def_field(SurfaceInteraction3f, wi,         D(SurfaceInteraction, wi))
         .def_field(SurfaceInteraction3f, prim_index, D(SurfaceInteraction, prim_index))
         .def_field(SurfaceInteraction3f, instance,   D(SurfaceInteraction, instance))
+        .def_field(SurfaceInteraction3f, instance_index, D(SurfaceInteraction, instance_index))
 
         // Methods
         .def(py::init<>(), D(SurfaceInteraction, SurfaceInteraction))
@@ -211,6 +214,12 @@ MTS_PY_EXPORT(MediumInteraction) {
         .def_field(MediumInteraction3f, medium,     D(MediumInteraction, medium))
         .def_field(MediumInteraction3f, sh_frame,   D(MediumInteraction, sh_frame))
         .def_field(MediumInteraction3f, wi,         D(MediumInteraction, wi))
+        .def_field(MediumInteraction3f, sigma_s,    D(MediumInteraction, sigma_s))
+        .def_field(MediumInteraction3f, sigma_n,    D(MediumInteraction, sigma_n))
+        .def_field(MediumInteraction3f, sigma_t,    D(MediumInteraction, sigma_t))
+        .def_field(MediumInteraction3f, combined_extinction,
+                   D(MediumInteraction, combined_extinction))
+        .def_field(MediumInteraction3f, mint,       D(MediumInteraction, mint))
 
         // Methods
         .def(py::init<>(), D(MediumInteraction, MediumInteraction))
@@ -70,6 +70,7 @@ MTS_PY_DECLARE(mueller);
 MTS_PY_DECLARE(MicrofacetDistribution);
 MTS_PY_DECLARE(PositionSample);
 MTS_PY_DECLARE(PhaseFunction);
+MTS_PY_DECLARE(ProgressiveRenderer);
 MTS_PY_DECLARE(DirectionSample);
 MTS_PY_DECLARE(Sampler);
 MTS_PY_DECLARE(Scene);
@@ -114,6 +115,7 @@ PYBIND11_MODULE(MODULE_NAME, m) {
     MTS_PY_IMPORT_SUBMODULE(mueller);
     MTS_PY_IMPORT(MicrofacetDistribution);
     MTS_PY_IMPORT(PhaseFunction);
+    MTS_PY_IMPORT(ProgressiveRenderer);
     MTS_PY_IMPORT(Sampler);
     MTS_PY_IMPORT(Sensor);
     MTS_PY_IMPORT(ShapeKDTree);
@@ -0,0 +1,19 @@
+#include <mitsuba/render/progressive.h>
+#include <mitsuba/render/scene.h>
+#include <mitsuba/render/sensor.h>
+#include <mitsuba/python/python.h>
+
+MTS_PY_EXPORT(ProgressiveRenderer) {
+    MTS_PY_IMPORT_TYPES(ProgressiveRenderer)
+    MTS_PY_CLASS(ProgressiveRenderer, Object)
+        .def(py::init<Scene *, Sensor *>(), "scene"_a, "sensor"_a = nullptr,
+             D(ProgressiveRenderer, ProgressiveRenderer))
+        .def_method(ProgressiveRenderer, render_pass,
+                    py::call_guard<py::gil_scoped_release>())
+        .def_method(ProgressiveRenderer, restart)
+        .def_method(ProgressiveRenderer, pass_count)
+        .def("bitmap", [](ProgressiveRenderer &r) -> ref<Bitmap> {
+                std::lock_guard<std::mutex> guard(r.mutex());
+                return r.bitmap() ? new Bitmap(*r.bitmap()) : nullptr;
+            }, D(ProgressiveRenderer, bitmap));
+}
@@ -8,9 +8,17 @@ MTS_PY_EXPORT(Sampler) {
         .def_method(Sampler, sample_count)
         .def_method(Sampler, wavefront_size)
         .def_method(Sampler, set_samples_per_wavefront, "samples_per_wavefront"_a)
+        .def_method(Sampler, set_pass_index, "pass_index"_a)
+        .def_method(Sampler, pass_index)
+        .def_method(Sampler, set_base_seed, "base_seed"_a)
+        .def_method(Sampler, base_seed)
+        .def("set_pixel", vectorize(&Sampler::set_pixel), "pixel"_a, D(Sampler, set_pixel))
         .def_method(Sampler, advance)
+        .def_method(Sampler, sample_index)
         .def("seed", vectorize(&Sampler::seed),
              "seed_offset"_a, "wavefront_size"_a = 1, D(Sampler, seed))
+        .def("seek", vectorize(&Sampler::seek), "seed_offset"_a,
+             "sample_index"_a, "wavefront_size"_a = 1, D(Sampler, seek))
         .def("next_1d", vectorize(&Sampler::next_1d),
              "active"_a = true, D(Sampler, next_1d))
         .def("next_2d", vectorize(&Sampler::next_2d),
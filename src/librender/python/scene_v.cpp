@@ -1,3 +1,4 @@
+#include <mitsuba/core/memreport.h>
 #include <mitsuba/core/properties.h>
 #include <mitsuba/render/integrator.h>
 #include <mitsuba/render/mesh.h>
@@ -49,17 +50,70 @@ MTS_PY_EXPORT(Scene) {
         .def("ray_test",
             vectorize(&Scene::ray_test),
             "ray"_a, "active"_a = true)
+        .def("ray_intersect_batch",
+            [](const Scene &scene,
+               py::array_t<ScalarFloat, py::array::c_style | py::array::forcecast> o,
+               py::array_t<ScalarFloat, py::array::c_style | py::array::forcecast> d) {
+                if (o.ndim() != 2 || o.shape(1) != 3 || d.ndim() != 2 || d.shape(1) != 3 ||
+                    o.shape(0) != d.shape(0))
+                    Throw("ray_intersect_batch(): expected two arrays of shape (N, 3)!");
+                size_t count = (size_t) o.shape(0);
+
+                py::array_t<ScalarFloat> t(count), uv(std::vector<size_t>{ count, 2 });
+                py::array_t<uint32_t> shape_index(count), prim_index(count);
+                ScalarFloat *t_ptr = t.mutable_data(), *uv_ptr = uv.mutable_data();
+                uint32_t *shape_ptr = shape_index.mutable_data(),
+                         *prim_ptr  = prim_index.mutable_data();
+                const ScalarFloat *o_ptr = o.data(), *d_ptr = d.data();
+
+                /* critical section */ {
+                    py::gil_scoped_release release;
+
+                    // Static 3D arrays are padded, convert the rays first
+                    std::vector<ScalarPoint3f> o_v(count);
+                    std::vector<ScalarVector3f> d_v(count);
+                    std::vector<ScalarPoint2f> uv_v(count);
+                    for (size_t i = 0; i < count; ++i) {
+                        o_v[i] = ScalarPoint3f(o_ptr[3 * i], o_ptr[3 * i + 1], o_ptr[3 * i + 2]);
+                        d_v[i] = ScalarVector3f(d_ptr[3 * i], d_ptr[3 * i + 1], d_ptr[3 * i + 2]);
+                    }
+
+                    scene.ray_intersect_batch(o_v.data(), d_v.data(), count, t_ptr,
+                                              shape_ptr, prim_ptr, uv_v.data());
+
+                    for (size_t i = 0; i < count; ++i) {
+                        uv_ptr[2 * i]     = uv_v[i].x();
+                        uv_ptr[2 * i + 1] = uv_v[i].y();
+                    }
+                }
+
+                return py::make_tuple(t, shape_index, prim_index, uv);
+            },
+            "o"_a, "d"_a, D(Scene, ray_intersect_batch))
 #if !defined(MTS_ENABLE_EMBREE)
         .def("ray_intersect_naive",
             vectorize(&Scene::ray_intersect_naive),
             "ray"_a, "active"_a = true)
 #endif
+        .def("sample_emitter_ray",
+            vectorize(&Scene::sample_emitter_ray),
+            "time"_a, "wavelength_sample"_a, "sample2"_a, "sample3"_a, "active"_a = true,
+            D(Scene, sample_emitter_ray))
         .def("sample_emitter_direction",
             vectorize(&Scene::sample_emitter_direction),
             "ref"_a, "sample"_a, "test_visibility"_a = true, "mask"_a = true)
         .def("pdf_emitter_direction",
             vectorize(&Scene::pdf_emitter_direction),
             "ref"_a, "ds"_a, "active"_a = true)
+        .def("sample_emitter_direction_lobe",
+            vectorize(&Scene::sample_emitter_direction_lobe),
+            "ref"_a, "sample"_a, "lobe_axis"_a, "lobe_exponent"_a,
+            "test_visibility"_a = true, "mask"_a = true,
+            D(Scene, sample_emitter_direction_lobe))
+        .def("pdf_emitter_direction_lobe",
+            vectorize(&Scene::pdf_emitter_direction_lobe),
+            "ref"_a, "ds"_a, "lobe_axis"_a, "lobe_exponent"_a, "active"_a = true,
+            D(Scene, pdf_emitter_direction_lobe))
         // Accessors
         .def_method(Scene, bbox)
         .def("sensors", py::overload_cast<>(&Scene::sensors), D(Scene, sensors))
@@ -87,5 +141,40 @@ MTS_PY_EXPORT(Scene) {
             },
             D(Scene, integrator))
         .def_method(Scene, shapes_grad_enabled)
+        .def_method(Scene, scattering_hit_flags)
+        .def_method(Scene, memory_report)
+        .def("ray_statistics", [](const Scene &scene) {
+            const RayStatistics &stats = scene.ray_statistics();
+            const char *widths[] = { "scalar", "packet", "wavefront" };
+            // Primary rays are also counted as intersections, remove them from the secondary rays
+            auto counter_dict = [&](RayCounter counter, bool subtract_primary) {
+                py::dict result;
+                uint64_t rays = 0, queries = 0;
+                for (size_t j = 0; j < RayStatistics::WidthCount; ++j) {
+                    uint64_t rays_j    = stats.rays[size_t(counter)][j],
+                             queries_j = stats.queries[size_t(counter)][j];
+                    if (subtract_primary) {
+                        rays_j -= std::min(rays_j, stats.rays[size_t(RayCounter::Primary)][j]);
+                        queries_j -= std::min(queries_j, stats.queries[size_t(RayCounter::Primary)][j]);
+                    }
+                    result[widths[j]] = rays_j;
+                    rays += rays_j;
+                    queries += queries_j;
+                }
+                result["rays"] = rays;
+                result["queries"] = queries;
+                return result;
+            };
+            py::dict result;
+            result["primary"] = counter_dict(RayCounter::Primary, false);
+            result["secondary"] = counter_dict(RayCounter::Intersect, true);
+            result["shadow"] = counter_dict(RayCounter::Shadow, false);
+            result["total"] = stats.traced();
+            result["time"] = stats.time;
+            result["rays_per_second"] = stats.rays_per_second();
+            return result;
+        }, D(Scene, ray_statistics))
+        .def_method(Scene, update_geometry)
+        .def_method(Scene, geometry_revision)
         .def("__repr__", &Scene::to_string);
 }
\ No newline at end of file
@@ -9,6 +9,12 @@
 #include <mitsuba/python/python.h>
 #include <pybind11/numpy.h>
 
+#define MESH_VIEW_DOC(what)                                                    \
+    "Return a view of the " what " of the mesh that does not copy any data "  \
+    "(a NumPy array, or an object implementing __cuda_array_interface__ "     \
+    "when 'cuda' is set). Call parameters_changed() after modifying the mesh " \
+    "through the view."
+
 MTS_PY_EXPORT(Shape) {
     MTS_PY_IMPORT_TYPES(Shape, Mesh)
 
@@ -38,8 +44,13 @@ MTS_PY_EXPORT(Shape) {
             &Shape::bbox, py::const_), D(Shape, bbox, 3), "index"_a, "clip"_a)
         .def_method(Shape, surface_area)
         .def_method(Shape, id)
+        .def_method(Shape, to_world)
         .def_method(Shape, is_mesh)
+        .def_method(Shape, is_instance)
+        .def_method(Shape, is_instancer)
+        .def_method(Shape, is_shapegroup)
         .def_method(Shape, is_medium_transition)
+        .def_method(Shape, has_alpha_mask)
         .def_method(Shape, interior_medium)
         .def_method(Shape, exterior_medium)
         .def_method(Shape, is_emitter)
@@ -49,6 +60,8 @@ MTS_PY_EXPORT(Shape) {
         .def("sensor", py::overload_cast<>(&Shape::sensor, py::const_))
         .def("bsdf", py::overload_cast<>(&Shape::bsdf, py::const_))
         .def_method(Shape, parameters_grad_enabled)
+        .def_method(Shape, dirty)
+        .def_method(Shape, mark_dirty, "value"_a = true)
         .def_method(Shape, primitive_count)
         .def_method(Shape, effective_primitive_count);
 
@@ -65,6 +78,14 @@ MTS_PY_EXPORT(Shape) {
         .def_method(Mesh, has_vertex_texcoords)
         .def_method(Mesh, recompute_vertex_normals)
         .def_method(Mesh, recompute_bbox)
+        .def_method(Mesh, compress)
+        .def_method(Mesh, is_compressed)
+        .def("add_keyframe", &Mesh::add_keyframe, "positions"_a,
+             "normals"_a = typename Mesh::FloatStorage(), D(Mesh, add_keyframe))
+        .def_method(Mesh, set_motion_range, "start"_a, "end"_a)
+        .def_method(Mesh, motion_range)
+        .def_method(Mesh, keyframe_count)
+        .def_method(Mesh, is_deforming)
         .def("write_ply", &Mesh::write_ply, "filename"_a,
              "Export mesh as a binary PLY file")
         .def("vertex_positions_buffer",
@@ -81,13 +102,40 @@ MTS_PY_EXPORT(Shape) {
              py::return_value_policy::reference_internal)
         .def("faces_buffer", py::overload_cast<>(&Mesh::faces_buffer),
              D(Mesh, faces_buffer), py::return_value_policy::reference_internal)
+        .def("vertex_positions_view", [](py::object self, bool cuda) {
+                Mesh &mesh = py::cast<Mesh &>(self);
+                return array_view(mesh.vertex_positions_buffer(),
+                                  { (size_t) mesh.vertex_count(), 3 }, self, cuda);
+            }, "cuda"_a = false, MESH_VIEW_DOC("vertex positions"))
+        .def("vertex_normals_view", [](py::object self, bool cuda) {
+                Mesh &mesh = py::cast<Mesh &>(self);
+                if (!mesh.has_vertex_normals())
+                    throw std::runtime_error("The mesh does not have vertex normals!");
+                return array_view(mesh.vertex_normals_buffer(),
+                                  { (size_t) mesh.vertex_count(), 3 }, self, cuda);
+            }, "cuda"_a = false, MESH_VIEW_DOC("vertex normals"))
+        .def("vertex_texcoords_view", [](py::object self, bool cuda) {
+                Mesh &mesh = py::cast<Mesh &>(self);
+                if (!mesh.has_vertex_texcoords())
+                    throw std::runtime_error("The mesh does not have texture coordinates!");
+                return array_view(mesh.vertex_texcoords_buffer(),
+                                  { (size_t) mesh.vertex_count(), 2 }, self, cuda);
+            }, "cuda"_a = false, MESH_VIEW_DOC("texture coordinates"))
+        .def("faces_view", [](py::object self, bool cuda) {
+                Mesh &mesh = py::cast<Mesh &>(self);
+                return array_view(mesh.faces_buffer(),
+                                  { (size_t) mesh.face_count(), 3 }, self, cuda);
+            }, "cuda"_a = false, MESH_VIEW_DOC("face indices"))
         .def("attribute_buffer", &Mesh::attribute_buffer, "name"_a,
              D(Mesh, attribute_buffer), py::return_value_policy::reference_internal)
+        .def_method(Mesh, has_attribute, "name"_a)
         .def("add_attribute", &Mesh::add_attribute, "name"_a, "size"_a, "buffer"_a,
              D(Mesh, add_attribute), py::return_value_policy::reference_internal)
         .def("ray_intersect_triangle", vectorize(&Mesh::ray_intersect_triangle),
              "index"_a, "ray"_a, "active"_a = true,
              D(Mesh, ray_intersect_triangle))
         .def("eval_parameterization", vectorize(&Mesh::eval_parameterization),
-             "uv"_a, "active"_a = true, D(Mesh, eval_parameterization));
+             "uv"_a, "active"_a = true, D(Mesh, eval_parameterization))
+        .def("build_radiance_pmf", &Mesh::build_radiance_pmf, "texture"_a,
+             "sample_count"_a = 16, D(Mesh, build_radiance_pmf));
 }
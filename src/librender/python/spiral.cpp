@@ -9,6 +9,11 @@ MTS_PY_EXPORT(Spiral) {
             D(Spiral, Spiral))
         .def_method(Spiral, max_block_size)
         .def_method(Spiral, block_count)
+        .def_method(Spiral, work_count)
+        .def_method(Spiral, block, "index"_a)
+        .def_method(Spiral, set_tail_subdivision, "count"_a)
+        .def_method(Spiral, set_priorities, "priorities"_a)
+        .def_method(Spiral, set_priority_map, "map"_a, "film_size"_a)
         .def_method(Spiral, reset)
         .def_method(Spiral, set_passes)
         .def_method(Spiral, next_block);
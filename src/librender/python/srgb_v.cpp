@@ -3,7 +3,18 @@
 
 MTS_PY_EXPORT(srgb) {
     MTS_PY_IMPORT_TYPES()
-    m.def("srgb_model_fetch", &srgb_model_fetch, D(srgb_model_fetch))
+    m.def("srgb_model_fetch", py::overload_cast<const Color<float, 3> &>(&srgb_model_fetch),
+          D(srgb_model_fetch))
+    .def("srgb_model_fetch_array",
+        [](py::array_t<float, py::array::c_style | py::array::forcecast> rgb) {
+            if (rgb.ndim() == 0 || rgb.shape(rgb.ndim() - 1) != 3)
+                Throw("srgb_model_fetch_array(): expected an array of RGB triplets!");
+            py::array_t<float> result(std::vector<size_t>(rgb.shape(), rgb.shape() + rgb.ndim()));
+            std::copy(rgb.data(), rgb.data() + rgb.size(), result.mutable_data());
+            py::gil_scoped_release release;
+            srgb_model_fetch(result.mutable_data(), (size_t) rgb.size() / 3);
+            return result;
+        }, "rgb"_a, D(srgb_model_fetch, 2))
     // .def("srgb_model_eval_rgb", &srgb_model_eval_rgb, D(srgb_model_eval_rgb))
     .def("srgb_model_eval",
         vectorize(&srgb_model_eval<depolarize_t<Spectrum>, Array<Float, 3>>),
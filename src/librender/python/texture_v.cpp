@@ -52,9 +52,15 @@ MTS_PY_EXPORT(Volume) {
         .def("max",
             &Volume::max,
             D(Volume, max))
+        .def("local_max",
+            &Volume::local_max,
+            "bbox"_a, D(Volume, local_max))
         .def("bbox",
             &Volume::bbox,
             D(Volume, bbox))
+        .def("world_to_local",
+            &Volume::world_to_local,
+            D(Volume, world_to_local))
         .def("resolution",
             &Volume::resolution,
             D(Volume, resolution));
@@ -16,6 +16,7 @@ MTS_VARIANT Sampler<Float, Spectrum>::Sampler(const Properties &props) {
     m_sample_index = 0;
     m_samples_per_wavefront = 1;
     m_wavefront_size = 0;
+    m_pass_index = 0;
 }
 
 MTS_VARIANT Sampler<Float, Spectrum>::~Sampler() { }
@@ -33,6 +34,15 @@ MTS_VARIANT void Sampler<Float, Spectrum>::advance() {
     m_sample_index++;
 }
 
+MTS_VARIANT void Sampler<Float, Spectrum>::seek(uint64_t seed_offset, uint32_t sample_index,
+                                                size_t wavefront_size) {
+    seed(seed_offset, wavefront_size);
+    if (sample_index > m_sample_count / m_samples_per_wavefront)
+        Throw("Sampler::seek(): sample index %i exceeds the number of samples (%i)!",
+              sample_index, m_sample_count / m_samples_per_wavefront);
+    m_sample_index = sample_index;
+}
+
 MTS_VARIANT Float Sampler<Float, Spectrum>::next_1d(Mask) {
     NotImplementedError("next_1d");
 }
@@ -52,6 +62,8 @@ Sampler<Float, Spectrum>::set_samples_per_wavefront(uint32_t samples_per_wavefro
         Throw("sample_count should be a multiple of samples_per_wavefront!");
 }
 
+MTS_VARIANT void Sampler<Float, Spectrum>::set_pixel(const Point2u &/*pixel*/) { }
+
 MTS_VARIANT typename Sampler<Float, Spectrum>::UInt32
 Sampler<Float, Spectrum>::compute_per_sequence_seed(uint32_t seed_offset) const {
     UInt32 indices = arange<UInt32>(m_wavefront_size);
@@ -83,15 +95,34 @@ MTS_VARIANT PCG32Sampler<Float, Spectrum>::PCG32Sampler(const Properties &props)
 MTS_VARIANT void PCG32Sampler<Float, Spectrum>::seed(uint64_t seed_offset,
                                                      size_t wavefront_size) {
     Base::seed(seed_offset, wavefront_size);
+    m_seed_value = m_base_seed + seed_offset;
+    seed_rng();
+}
 
-    uint64_t seed_value = m_base_seed + seed_offset;
+MTS_VARIANT void PCG32Sampler<Float, Spectrum>::advance() {
+    Base::advance();
+    seed_rng();
+}
+
+MTS_VARIANT void PCG32Sampler<Float, Spectrum>::seek(uint64_t seed_offset,
+                                                     uint32_t sample_index,
+                                                     size_t wavefront_size) {
+    Base::seek(seed_offset, sample_index, wavefront_size);
+    seed_rng();
+}
 
+MTS_VARIANT void PCG32Sampler<Float, Spectrum>::seed_rng() {
+    /* Every sample draws from its own sequences (one per lane). The first
+       sample uses the same sequences as a plain seed() of the generator. */
     if constexpr (is_dynamic_array_v<Float>) {
-        UInt64 idx = arange<UInt64>(wavefront_size);
-        m_rng.seed(sample_tea_64(UInt64(seed_value), idx),
-                   sample_tea_64(idx, UInt64(seed_value)));
+        UInt64 idx = arange<UInt64>(m_wavefront_size) +
+                     (uint64_t) m_sample_index * (uint64_t) m_wavefront_size;
+        m_rng.seed(sample_tea_64(UInt64(m_seed_value), idx),
+                   sample_tea_64(idx, UInt64(m_seed_value)));
     } else {
-        m_rng.seed(seed_value, PCG32_DEFAULT_STREAM + arange<UInt64>());
+        constexpr uint64_t width = is_array_v<Float> ? array_size_v<Float> : 1;
+        m_rng.seed(m_seed_value, PCG32_DEFAULT_STREAM + arange<UInt64>() +
+                                     (uint64_t) m_sample_index * width);
     }
 }
 
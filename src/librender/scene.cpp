@@ -1,11 +1,26 @@
+#include <mitsuba/core/memreport.h>
+#include <mitsuba/core/profiler.h>
 #include <mitsuba/core/properties.h>
 #include <mitsuba/core/plugin.h>
+#include <mitsuba/core/statistics.h>
+#include <mitsuba/core/thread.h>
+#include <mitsuba/core/timer.h>
 #include <mitsuba/render/bsdf.h>
 #include <mitsuba/render/medium.h>
+#include <mitsuba/render/mesh.h>
 #include <mitsuba/render/scene.h>
 #include <mitsuba/render/kdtree.h>
+#include <mitsuba/render/bvh.h>
 #include <mitsuba/render/integrator.h>
 #include <enoki/stl.h>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
+#include <tbb/task_group.h>
+#include <atomic>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
 
 #if defined(MTS_ENABLE_EMBREE)
 #  include "scene_embree.inl"
@@ -19,6 +34,9 @@
 
 NAMESPACE_BEGIN(mitsuba)
 
+/// Source of the geometry revisions, shared by all scenes
+static std::atomic<uint32_t> geometry_revision_counter { 0 };
+
 MTS_VARIANT Scene<Float, Spectrum>::Scene(const Properties &props) {
     for (auto &kv : props.objects()) {
         m_children.push_back(kv.second.get());
@@ -91,16 +109,128 @@ MTS_VARIANT Scene<Float, Spectrum>::Scene(const Properties &props) {
             create_object<Integrator>(Properties("path"));
     }
 
-    if constexpr (is_cuda_array_v<Float>)
-        accel_init_gpu(props);
-    else
-        accel_init_cpu(props);
+    if (props.bool_("auto_instancing", !is_diff_array_v<Float>))
+        instance_duplicate_meshes();
+
+    Timer timer;
+    {
+        ScopedPhase sp(ProfilerPhase::InitKDTree);
+        if constexpr (is_cuda_array_v<Float>) {
+            accel_build_pending();
+            accel_init_gpu(props);
+        } else {
+            // Also builds the kd-trees of the shape groups
+            accel_init_cpu(props);
+        }
+    }
+    Statistics::add_time("accel_build", (float) timer.value());
 
     // Create emitters' shapes (environment luminaires)
     for (Emitter *emitter: m_emitters)
         emitter->set_scene(this);
 
+    std::string emitter_sampling = props.string("emitter_sampling", "uniform");
+    if (emitter_sampling == "power")
+        m_emitter_power_sampling = true;
+    else if (emitter_sampling != "uniform")
+        Throw("Invalid emitter sampling strategy \"%s\", must be one of: "
+              "\"uniform\", or \"power\"!", emitter_sampling);
+    // Select emitters using an alias table (constant time) instead of a binary search
+    m_emitter_alias_sampling = props.bool_("emitter_alias_sampling", false);
+    update_emitter_sampling();
+    update_scattering_hit_flags();
+
     m_shapes_grad_enabled = false;
+    m_geometry_revision = ++geometry_revision_counter;
+
+    // The acceleration data structure was just built from the current geometry
+    for (auto &s : m_shapes)
+        s->mark_dirty(false);
+
+    if (props.bool_("memory_report", false))
+        Log(Info, "Memory usage of the scene: %s", memory_report());
+}
+
+MTS_VARIANT void Scene<Float, Spectrum>::instance_duplicate_meshes() {
+    using Mesh = mitsuba::Mesh<Float, Spectrum>;
+
+    // Indices into 'm_shapes' of the meshes sharing a file and a BSDF
+    std::map<std::pair<std::string, const BSDF *>, std::vector<size_t>> sets;
+    for (size_t i = 0; i < m_shapes.size(); ++i) {
+        const Shape *shape = m_shapes[i].get();
+        if (!shape->is_mesh() || shape->is_emitter() || shape->is_sensor() ||
+            shape->is_medium_transition())
+            continue;
+        const Mesh *mesh = static_cast<const Mesh *>(shape);
+        if (mesh->source_key().empty() || mesh->is_deforming() || mesh->is_compressed())
+            continue;
+        sets[{ mesh->source_key(), shape->bsdf() }].push_back(i);
+    }
+
+    size_t instance_count = 0, group_count = 0;
+    for (auto &[key, indices] : sets) {
+        if (indices.size() < 2)
+            continue;
+
+        ref<Shape> first = m_shapes[indices[0]];
+        Properties props_group("shapegroup");
+        props_group.set_id(first->id() + "_group");
+        props_group.set_object("shape", first.get());
+        ref<ShapeGroup> group = static_cast<ShapeGroup *>(
+            PluginManager::instance()->create_object<Shape>(props_group).get());
+        m_shapegroups.push_back(group);
+        m_children.push_back(group.get());
+
+        ScalarTransform4f to_group = first->to_world().inverse();
+        for (size_t i : indices) {
+            ref<Shape> shape = m_shapes[i];
+            Properties props_instance("instance");
+            props_instance.set_id(shape->id());
+            props_instance.set_object("shapegroup", group.get());
+            props_instance.set_transform("to_world", shape->to_world() * to_group);
+            m_shapes[i] = PluginManager::instance()->create_object<Shape>(props_instance);
+
+            // The duplicates are released once the caller drops its references
+            for (ref<Object> &child : m_children) {
+                if (child == shape.get())
+                    child = m_shapes[i].get();
+            }
+        }
+        instance_count += indices.size();
+        group_count++;
+    }
+
+    if (instance_count > 0)
+        Log(Info, "Turned %i meshes that share %i distinct files into instances.",
+            instance_count, group_count);
+}
+
+MTS_VARIANT void Scene<Float, Spectrum>::update_emitter_sampling() {
+    if (m_emitters.empty())
+        return;
+
+    std::vector<ScalarFloat> power(m_emitters.size(),
+                                   1.f / (ScalarFloat) m_emitters.size());
+
+    if (m_emitter_power_sampling) {
+        try {
+            for (size_t i = 0; i < m_emitters.size(); ++i)
+                power[i] = m_emitters[i]->power();
+            m_emitter_distr = DiscreteDistribution<Float>(power.data(), power.size());
+            if (m_emitter_alias_sampling)
+                m_emitter_distr.set_alias_table(true);
+            for (size_t i = 0; i < m_emitters.size(); ++i)
+                power[i] *= m_emitter_distr.normalization();
+        } catch (const std::exception &e) {
+            Log(Warn, "Unable to sample emitters proportionally to their power, "
+                      "falling back to uniform sampling (%s)", e.what());
+            m_emitter_power_sampling = false;
+            std::fill(power.begin(), power.end(), 1.f / (ScalarFloat) m_emitters.size());
+        }
+    }
+
+    for (size_t i = 0; i < m_emitters.size(); ++i)
+        m_emitters[i]->set_selection_pmf(power[i]);
 }
 
 MTS_VARIANT Scene<Float, Spectrum>::~Scene() {
@@ -113,6 +243,7 @@ MTS_VARIANT Scene<Float, Spectrum>::~Scene() {
 MTS_VARIANT typename Scene<Float, Spectrum>::SurfaceInteraction3f
 Scene<Float, Spectrum>::ray_intersect(const Ray3f &ray, Mask active) const {
     MTS_MASKED_FUNCTION(ProfilerPhase::RayIntersect, active);
+    Statistics::count_rays(RayCounter::Intersect, active);
 
     if constexpr (is_cuda_array_v<Float>)
         return ray_intersect_gpu(ray, HitComputeFlags::All, active);
@@ -123,6 +254,7 @@ Scene<Float, Spectrum>::ray_intersect(const Ray3f &ray, Mask active) const {
 MTS_VARIANT typename Scene<Float, Spectrum>::SurfaceInteraction3f
 Scene<Float, Spectrum>::ray_intersect(const Ray3f &ray, HitComputeFlags flags, Mask active) const {
     MTS_MASKED_FUNCTION(ProfilerPhase::RayIntersect, active);
+    Statistics::count_rays(RayCounter::Intersect, active);
 
     if constexpr (is_cuda_array_v<Float>)
         return ray_intersect_gpu(ray, flags, active);
@@ -132,6 +264,8 @@ Scene<Float, Spectrum>::ray_intersect(const Ray3f &ray, HitComputeFlags flags, M
 
 MTS_VARIANT typename Scene<Float, Spectrum>::PreliminaryIntersection3f
 Scene<Float, Spectrum>::ray_intersect_preliminary(const Ray3f &ray, Mask active) const {
+    Statistics::count_rays(RayCounter::Intersect, active);
+
     if constexpr (is_cuda_array_v<Float>)
         return ray_intersect_preliminary_gpu(ray, active);
     else
@@ -154,6 +288,7 @@ Scene<Float, Spectrum>::ray_intersect_naive(const Ray3f &ray, Mask active) const
 MTS_VARIANT typename Scene<Float, Spectrum>::Mask
 Scene<Float, Spectrum>::ray_test(const Ray3f &ray, Mask active) const {
     MTS_MASKED_FUNCTION(ProfilerPhase::RayTest, active);
+    Statistics::count_rays(RayCounter::Shadow, active);
 
     if constexpr (is_cuda_array_v<Float>)
         return ray_test_gpu(ray, active);
@@ -161,6 +296,129 @@ Scene<Float, Spectrum>::ray_test(const Ray3f &ray, Mask active) const {
         return ray_test_cpu(ray, active);
 }
 
+MTS_VARIANT void Scene<Float, Spectrum>::ray_test_batch(const Ray3f *rays, size_t count,
+                                                        Mask *hit) const {
+    if constexpr (!is_array_v<Float>) {
+        ScopedPhase sp(ProfilerPhase::RayTest);
+        Statistics::add_rays(RayCounter::Shadow, RayWidth::Scalar, (uint64_t) count);
+        ray_test_batch_cpu(rays, count, hit);
+    } else {
+        for (size_t i = 0; i < count; ++i)
+            hit[i] = ray_test(rays[i]);
+    }
+}
+
+MTS_VARIANT void Scene<Float, Spectrum>::ray_intersect_batch(
+    const ScalarPoint3f *o, const ScalarVector3f *d, size_t count, ScalarFloat *t,
+    uint32_t *shape_index, uint32_t *prim_index, ScalarPoint2f *uv) const {
+    if constexpr (!is_array_v<Float>) {
+        std::unordered_map<const Shape *, uint32_t> shape_map;
+        if (shape_index) {
+            for (size_t i = 0; i < m_shapes.size(); ++i)
+                shape_map[m_shapes[i].get()] = (uint32_t) i;
+        }
+
+        HitComputeFlags flags = uv ? HitComputeFlags::UV : HitComputeFlags::Minimal;
+        Statistics::add_rays(RayCounter::Intersect, RayWidth::Scalar, (uint64_t) count);
+
+        ThreadEnvironment env;
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, count, 1024),
+            [&](const tbb::blocked_range<size_t> &range) {
+                ScopedSetThreadEnvironment set_env(env);
+                ScopedPhase sp(ProfilerPhase::RayIntersect);
+
+                for (size_t i = range.begin(); i != range.end(); ++i) {
+                    Ray3f ray(o[i], d[i], 0.f, Wavelength());
+                    SurfaceInteraction3f si = ray_intersect_cpu(ray, flags, true);
+
+                    t[i] = si.t;
+                    if (!si.is_valid()) {
+                        if (shape_index)
+                            shape_index[i] = (uint32_t) -1;
+                        if (prim_index)
+                            prim_index[i] = 0;
+                        if (uv)
+                            uv[i] = 0.f;
+                        continue;
+                    }
+
+                    if (shape_index) {
+                        auto it = shape_map.find(si.instance ? si.instance : si.shape);
+                        shape_index[i] = it != shape_map.end() ? it->second : (uint32_t) -1;
+                    }
+                    if (prim_index)
+                        prim_index[i] = si.prim_index;
+                    if (uv)
+                        uv[i] = si.uv;
+                }
+            }
+        );
+    } else {
+        ENOKI_MARK_USED(o); ENOKI_MARK_USED(d); ENOKI_MARK_USED(count);
+        ENOKI_MARK_USED(t); ENOKI_MARK_USED(shape_index);
+        ENOKI_MARK_USED(prim_index); ENOKI_MARK_USED(uv);
+        Throw("ray_intersect_batch(): only supported in scalar variants, pass wide "
+              "arrays to ray_intersect() instead!");
+    }
+}
+
+MTS_VARIANT std::pair<typename Scene<Float, Spectrum>::UInt32, Float>
+Scene<Float, Spectrum>::sample_emitter_index(Float &sample, Mask active) const {
+    UInt32 index;
+    Float emitter_pdf;
+
+    if (m_emitter_power_sampling) {
+        // Pick an emitter proportionally to its power, reuse the sample
+        std::tie(index, sample, emitter_pdf) = m_emitter_distr.sample_reuse_pmf(sample, active);
+    } else {
+        emitter_pdf = 1.f / m_emitters.size();
+
+        // Randomly pick an emitter
+        index = min(UInt32(sample * (ScalarFloat) m_emitters.size()),
+                    (uint32_t) m_emitters.size() - 1);
+
+        // Rescale the sample to lie in [0,1) again
+        sample = (sample - index * emitter_pdf) * m_emitters.size();
+    }
+
+    return { index, emitter_pdf };
+}
+
+MTS_VARIANT std::pair<typename Scene<Float, Spectrum>::Ray3f, Spectrum>
+Scene<Float, Spectrum>::sample_emitter_ray(Float time, Float wavelength_sample,
+                                           const Point2f &sample2, const Point2f &sample3,
+                                           Mask active) const {
+    MTS_MASKED_FUNCTION(ProfilerPhase::SampleEmitterRay, active);
+
+    using EmitterPtr = replace_scalar_t<Float, Emitter*>;
+
+    Ray3f ray;
+    Spectrum weight;
+
+    if (likely(!m_emitters.empty())) {
+        if (m_emitters.size() == 1) {
+            // Fast path if there is only one emitter
+            std::tie(ray, weight) =
+                m_emitters[0]->sample_ray(time, wavelength_sample, sample2, sample3, active);
+        } else {
+            auto [index, emitter_pdf] = sample_emitter_index(wavelength_sample, active);
+            EmitterPtr emitter = gather<EmitterPtr>(m_emitters.data(), index, active);
+
+            std::tie(ray, weight) =
+                emitter->sample_ray(time, wavelength_sample, sample2, sample3, active);
+
+            // Account for the discrete probability of sampling this emitter
+            weight *= rcp(emitter_pdf);
+        }
+    } else {
+        ray = zero<Ray3f>();
+        weight = 0.f;
+    }
+
+    return { ray, weight };
+}
+
 MTS_VARIANT std::pair<typename Scene<Float, Spectrum>::DirectionSample3f, Spectrum>
 Scene<Float, Spectrum>::sample_emitter_direction(const Interaction3f &ref, const Point2f &sample_,
                                                  bool test_visibility, Mask active) const {
@@ -177,16 +435,7 @@ Scene<Float, Spectrum>::sample_emitter_direction(const Interaction3f &ref, const
             // Fast path if there is only one emitter
             std::tie(ds, spec) = m_emitters[0]->sample_direction(ref, sample, active);
         } else {
-            ScalarFloat emitter_pdf = 1.f / m_emitters.size();
-
-            // Randomly pick an emitter
-            UInt32 index =
-                min(UInt32(sample.x() * (ScalarFloat) m_emitters.size()),
-                    (uint32_t) m_emitters.size() - 1);
-
-            // Rescale sample.x() to lie in [0,1) again
-            sample.x() = (sample.x() - index*emitter_pdf) * m_emitters.size();
-
+            auto [index, emitter_pdf] = sample_emitter_index(sample.x(), active);
             EmitterPtr emitter = gather<EmitterPtr>(m_emitters.data(), index, active);
 
             // Sample a direction towards the emitter
@@ -224,12 +473,80 @@ Scene<Float, Spectrum>::pdf_emitter_direction(const Interaction3f &ref,
     if (m_emitters.size() == 1) {
         // Fast path if there is only one emitter
         return m_emitters[0]->pdf_direction(ref, ds, active);
+    } else if (m_emitter_power_sampling) {
+        EmitterPtr emitter = reinterpret_array<EmitterPtr>(ds.object);
+        return emitter->pdf_direction(ref, ds, active) * emitter->selection_pmf(active);
     } else {
         return reinterpret_array<EmitterPtr>(ds.object)->pdf_direction(ref, ds, active) *
             (1.f / m_emitters.size());
     }
 }
 
+MTS_VARIANT std::pair<typename Scene<Float, Spectrum>::DirectionSample3f, Spectrum>
+Scene<Float, Spectrum>::sample_emitter_direction_lobe(const Interaction3f &ref,
+                                                      const Point2f &sample_,
+                                                      const Vector3f &lobe_axis,
+                                                      Float lobe_exponent,
+                                                      bool test_visibility,
+                                                      Mask active) const {
+    MTS_MASKED_FUNCTION(ProfilerPhase::SampleEmitterDirection, active);
+
+    using EmitterPtr = replace_scalar_t<Float, Emitter*>;
+
+    Point2f sample(sample_);
+    DirectionSample3f ds;
+    Spectrum spec;
+
+    if (likely(!m_emitters.empty())) {
+        if (m_emitters.size() == 1) {
+            std::tie(ds, spec) = m_emitters[0]->sample_direction_lobe(
+                ref, sample, lobe_axis, lobe_exponent, active);
+        } else {
+            auto [index, emitter_pdf] = sample_emitter_index(sample.x(), active);
+            EmitterPtr emitter = gather<EmitterPtr>(m_emitters.data(), index, active);
+
+            std::tie(ds, spec) = emitter->sample_direction_lobe(ref, sample, lobe_axis,
+                                                                lobe_exponent, active);
+            ds.pdf *= emitter_pdf;
+            spec *= rcp(emitter_pdf);
+        }
+
+        active &= neq(ds.pdf, 0.f);
+
+        if (test_visibility && any_or<true>(active)) {
+            Ray3f ray(ref.p, ds.d, math::RayEpsilon<Float> * (1.f + hmax(abs(ref.p))),
+                      ds.dist * (1.f - math::ShadowEpsilon<Float>), ref.time, ref.wavelengths);
+            spec[ray_test(ray, active)] = 0.f;
+        }
+    } else {
+        ds = zero<DirectionSample3f>();
+        spec = 0.f;
+    }
+
+    return { ds, spec };
+}
+
+MTS_VARIANT Float
+Scene<Float, Spectrum>::pdf_emitter_direction_lobe(const Interaction3f &ref,
+                                                   const DirectionSample3f &ds,
+                                                   const Vector3f &lobe_axis,
+                                                   Float lobe_exponent,
+                                                   Mask active) const {
+    MTS_MASK_ARGUMENT(active);
+    using EmitterPtr = replace_scalar_t<Float, const Emitter *>;
+
+    if (m_emitters.size() == 1) {
+        return m_emitters[0]->pdf_direction_lobe(ref, ds, lobe_axis, lobe_exponent, active);
+    } else {
+        EmitterPtr emitter = reinterpret_array<EmitterPtr>(ds.object);
+        Float pdf = emitter->pdf_direction_lobe(ref, ds, lobe_axis, lobe_exponent, active);
+        if (m_emitter_power_sampling)
+            return pdf * emitter->selection_pmf(active);
+        else
+            return pdf * (1.f / m_emitters.size());
+    }
+}
+
 MTS_VARIANT void Scene<Float, Spectrum>::traverse(TraversalCallback *callback) {
     for (auto& child : m_children) {
         std::string id = child->id();
@@ -239,23 +556,31 @@ MTS_VARIANT void Scene<Float, Spectrum>::traverse(TraversalCallback *callback) {
     }
 }
 
-MTS_VARIANT void Scene<Float, Spectrum>::parameters_changed(const std::vector<std::string> &keys) {
+MTS_VARIANT void Scene<Float, Spectrum>::parameters_changed(const std::vector<std::string> &/*keys*/) {
     if (m_environment)
         m_environment->set_scene(this); // TODO use parameters_changed({"scene"})
 
+    // Emitted power may have changed
+    if (m_emitter_power_sampling)
+        update_emitter_sampling();
+
+    // BSDF parameters (e.g. the roughness of a conductor) may affect the flags
+    update_scattering_hit_flags();
+
+    /* Only rebuild the acceleration data structure when the geometry itself
+       changed, not e.g. when a BSDF or texture parameter of a shape was
+       updated (which also lists the shape among the 'keys') */
     bool update_accel = false;
-    for (auto &s : m_shapes) {
-        if (string::contains(keys, s->id()) || string::contains(keys, s->class_()->name())) {
-            update_accel = true;
-            break;
-        }
-    }
+    for (auto &s : m_shapes)
+        update_accel |= s->dirty();
 
     if (update_accel) {
-        if constexpr (is_cuda_array_v<Float>)
+        if constexpr (is_cuda_array_v<Float>) {
             accel_parameters_changed_gpu();
-        else {
-            // TODO update Embree BVH or Mitsuba kdtree if necessary
+            for (auto &s : m_shapes)
+                s->mark_dirty(false);
+        } else {
+            update_geometry();
         }
     }
 
@@ -269,6 +594,118 @@ MTS_VARIANT void Scene<Float, Spectrum>::parameters_changed(const std::vector<st
     }
 }
 
+MTS_VARIANT void Scene<Float, Spectrum>::accel_build_pending(const std::function<void()> &top_level,
+                                                             size_t top_level_cost) {
+    std::vector<ShapeGroup *> groups;
+    std::unordered_set<ShapeGroup *> visited;
+    auto visit = [&](ShapeGroup *group) {
+        if (!group || !visited.insert(group).second)
+            return;
+        groups.push_back(group);
+        // Levels of detail can't have levels of their own
+        for (size_t i = 0; i < group->lod_count(); ++i) {
+            if (visited.insert(group->lod(i)).second)
+                groups.push_back(group->lod(i));
+        }
+    };
+    for (ShapeGroup *group : m_shapegroups)
+        visit(group);
+    for (Shape *shape : m_shapes)
+        visit(shape->instanced_group());
+
+    std::vector<std::pair<size_t, std::function<void()>>> builds;
+    for (ShapeGroup *group : groups) {
+        if (!group->accel_ready())
+            builds.emplace_back((size_t) group->primitive_count(),
+                                [group]() { group->accel_build(); });
+    }
+    if (top_level)
+        builds.emplace_back(top_level_cost, top_level);
+    if (builds.empty())
+        return;
+
+    std::stable_sort(builds.begin(), builds.end(),
+                     [](const auto &a, const auto &b) { return a.first > b.first; });
+
+    Log(Debug, "Building %i acceleration data structures ..", builds.size());
+    if (builds.size() == 1) {
+        builds[0].second();
+        return;
+    }
+
+    /* Every worker takes the largest remaining build, which parallelizes
+       internally. Exceptions are propagated by wait(). */
+    std::atomic<size_t> next { 0 };
+    size_t workers = std::min(builds.size(),
+                              (size_t) tbb::this_task_arena::max_concurrency());
+    tbb::task_group group;
+    for (size_t i = 0; i < workers; ++i) {
+        group.run([&]() {
+            for (size_t j = next++; j < builds.size(); j = next++)
+                builds[j].second();
+        });
+    }
+    group.wait();
+}
+
+MTS_VARIANT void Scene<Float, Spectrum>::update_scattering_hit_flags() {
+    if constexpr (is_diff_array_v<Float>) {
+        m_scattering_hit_flags = HitComputeFlags::All;
+    } else {
+        uint32_t bsdf_flags = 0;
+        for (const Shape *shape : m_shapes) {
+            if (shape->bsdf())
+                bsdf_flags |= shape->bsdf()->flags();
+        }
+        for (const ShapeGroup *group : m_shapegroups)
+            bsdf_flags |= group->nested_bsdf_flags();
+
+        m_scattering_hit_flags = has_flag(bsdf_flags, BSDFFlags::Anisotropic)
+                                     ? HitComputeFlags::All
+                                     : HitComputeFlags::Connection;
+    }
+}
+
+MTS_VARIANT void Scene<Float, Spectrum>::update_geometry() {
+    m_bbox.reset();
+    for (Shape *shape : m_shapes)
+        m_bbox.expand(shape->bbox());
+
+    Timer timer;
+    if constexpr (is_cuda_array_v<Float>)
+        accel_parameters_changed_gpu(true);
+    else
+        accel_parameters_changed_cpu();
+    Statistics::add_time("accel_update", (float) timer.value());
+    m_geometry_revision = ++geometry_revision_counter;
+
+    for (auto &s : m_shapes)
+        s->mark_dirty(false);
+}
+
+MTS_VARIANT ref<MemoryReport> Scene<Float, Spectrum>::memory_report() const {
+    ref<MemoryReport> report = new MemoryReport();
+    report->visit(this);
+    return report;
+}
+
+MTS_VARIANT void Scene<Float, Spectrum>::account_memory(MemoryReport *report) const {
+    if constexpr (!is_cuda_array_v<Float>)
+        accel_account_memory_cpu(report);
+
+    report->add_array(MemoryCategory::Distributions, m_emitter_distr.pmf());
+    report->add_array(MemoryCategory::Distributions, m_emitter_distr.cdf());
+
+    // The default sensor and integrator created by the scene aren't children
+    for (const Shape *shape : m_shapes)
+        report->visit(shape);
+    for (const Object *child : m_children)
+        report->visit(child);
+    for (const Sensor *sensor : m_sensors)
+        report->visit(sensor);
+    report->visit(m_integrator.get());
+}
+
 MTS_VARIANT std::string Scene<Float, Spectrum>::to_string() const {
     std::ostringstream oss;
     oss << "Scene[" << std::endl
@@ -1,4 +1,6 @@
 #include <embree3/rtcore.h>
+#include <atomic>
+#include <vector>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -21,27 +23,108 @@ NAMESPACE_BEGIN(mitsuba)
 
 static RTCDevice __embree_device = nullptr;
 
-MTS_VARIANT void Scene<Float, Spectrum>::accel_init_cpu(const Properties &/*props*/) {
+/// Memory allocated by Embree (tracked via a memory monitor callback)
+static std::atomic<ssize_t> __embree_memory { 0 };
+
+/**
+ * \brief Embree traversal hint for a packet of rays: packets are only
+ * flagged as coherent when the directions of all active lanes lie in the
+ * same octant, as is the case for camera rays (but usually not for
+ * secondary rays)
+ */
+template <typename Ray3f, typename Mask>
+static RTCIntersectContextFlags embree_coherence(const Ray3f &ray, const Mask &active) {
+    for (size_t i = 0; i < 3; ++i) {
+        Mask negative = ray.d[i] < 0.f;
+        if (!all(negative || !active) && any(negative && active))
+            return RTC_INTERSECT_CONTEXT_FLAG_INCOHERENT;
+    }
+    return RTC_INTERSECT_CONTEXT_FLAG_COHERENT;
+}
+
+static bool embree_memory_monitor(void * /* ptr */, ssize_t bytes, bool /* post */) {
+    __embree_memory += bytes;
+    return true;
+}
+
+MTS_VARIANT void Scene<Float, Spectrum>::accel_init_cpu(const Properties &props) {
     static_assert(is_float_v<scalar_t<Float>>, "Embree is not supported in double precision mode.");
-    if (!__embree_device)
+    if (!__embree_device) {
         __embree_device = rtcNewDevice("");
+        rtcSetDeviceMemoryMonitorFunction(__embree_device, embree_memory_monitor, nullptr);
+    }
+
+    /* Embree: BVH build quality. "low" builds fastest (e.g. for interactive
+       previews), "high" yields the fastest traversal (e.g. for final frames). */
+    std::string quality_str = props.string("embree_build_quality", "medium");
+    RTCBuildQuality quality;
+    if (quality_str == "low")
+        quality = RTC_BUILD_QUALITY_LOW;
+    else if (quality_str == "medium")
+        quality = RTC_BUILD_QUALITY_MEDIUM;
+    else if (quality_str == "high")
+        quality = RTC_BUILD_QUALITY_HIGH;
+    else
+        Throw("Invalid Embree build quality \"%s\", must be one of: \"low\", "
+              "\"medium\", or \"high\"!", quality_str);
+
+    /* Embree: "dynamic" speeds up rebuilds after the geometry changed at the
+       cost of traversal performance, "compact" reduces the memory usage,
+       "robust" avoids optimizations that reduce arithmetic accuracy. */
+    int flags = RTC_SCENE_FLAG_NONE;
+    if (props.bool_("embree_dynamic", true))
+        flags |= RTC_SCENE_FLAG_DYNAMIC;
+    if (props.bool_("embree_compact", false))
+        flags |= RTC_SCENE_FLAG_COMPACT;
+    if (props.bool_("embree_robust", false))
+        flags |= RTC_SCENE_FLAG_ROBUST;
 
     Timer timer;
+    ssize_t memory_before = __embree_memory;
     RTCScene embree_scene = rtcNewScene(__embree_device);
-    rtcSetSceneFlags(embree_scene, RTC_SCENE_FLAG_DYNAMIC);
+    rtcSetSceneFlags(embree_scene, (RTCSceneFlags) flags);
+    rtcSetSceneBuildQuality(embree_scene, quality);
     m_accel = embree_scene;
 
     for (Shape *shape : m_shapes)
          rtcAttachGeometry(embree_scene, shape->embree_geometry(__embree_device));
 
     rtcCommitScene(embree_scene);
-    Log(Info, "Embree ready. (took %s)", util::time_string(timer.value()));
+
+    std::string flags_str;
+    if (flags & RTC_SCENE_FLAG_DYNAMIC)
+        flags_str += ", dynamic";
+    if (flags & RTC_SCENE_FLAG_COMPACT)
+        flags_str += ", compact";
+    if (flags & RTC_SCENE_FLAG_ROBUST)
+        flags_str += ", robust";
+
+    Log(Info, "Embree ready. (%s quality%s, %s of storage, took %s)", quality_str,
+        flags_str,
+        util::mem_string((size_t) std::max(__embree_memory - memory_before, (ssize_t) 0)),
+        util::time_string(timer.value()));
+}
+
+MTS_VARIANT void Scene<Float, Spectrum>::accel_parameters_changed_cpu() {
+    Timer timer;
+    RTCScene embree_scene = (RTCScene) m_accel;
+
+    // Geometry IDs were assigned in order by rtcAttachGeometry()
+    for (size_t i = 0; i < m_shapes.size(); ++i)
+        m_shapes[i]->embree_update_geometry(rtcGetGeometry(embree_scene, (unsigned int) i));
+
+    rtcCommitScene(embree_scene);
+    Log(Info, "Embree updated. (took %s)", util::time_string(timer.value()));
 }
 
 MTS_VARIANT void Scene<Float, Spectrum>::accel_release_cpu() {
     rtcReleaseScene((RTCScene) m_accel);
 }
 
+MTS_VARIANT void Scene<Float, Spectrum>::accel_account_memory_cpu(MemoryReport * /* report */) const {
+    // The BVH is allocated and owned by Embree
+}
+
 MTS_VARIANT typename Scene<Float, Spectrum>::PreliminaryIntersection3f
 Scene<Float, Spectrum>::ray_intersect_preliminary_cpu(const Ray3f &ray, Mask active) const {
     if constexpr (!is_cuda_array_v<Float>) {
@@ -60,7 +143,7 @@ Scene<Float, Spectrum>::ray_intersect_preliminary_cpu(const Ray3f &ray, Mask act
             rh.ray.dir_x = ray.d.x();
             rh.ray.dir_y = ray.d.y();
             rh.ray.dir_z = ray.d.z();
-            rh.ray.time = 0;
+            rh.ray.time = (float) clamp(ray.time, Float(0.f), Float(1.f));
             rh.ray.tfar = ray.maxt;
             rh.ray.mask = 0;
             rh.ray.id = 0;
@@ -90,7 +173,7 @@ Scene<Float, Spectrum>::ray_intersect_preliminary_cpu(const Ray3f &ray, Mask act
                 pi.prim_uv = Point2f(rh.hit.u, rh.hit.v);
             }
         } else {
-            context.flags = RTC_INTERSECT_CONTEXT_FLAG_COHERENT;
+            context.flags = embree_coherence(ray, active);
 
             alignas(alignof(Float)) int valid[MTS_RAY_WIDTH];
             store(valid, select(active, Int32(-1), Int32(0)));
@@ -103,7 +186,7 @@ Scene<Float, Spectrum>::ray_intersect_preliminary_cpu(const Ray3f &ray, Mask act
             store(rh.ray.dir_x, ray.d.x());
             store(rh.ray.dir_y, ray.d.y());
             store(rh.ray.dir_z, ray.d.z());
-            store(rh.ray.time, Float(0));
+            store(rh.ray.time, clamp(ray.time, Float(0.f), Float(1.f)));
             store(rh.ray.tfar, ray.maxt);
             store(rh.ray.mask, UInt32(0));
             store(rh.ray.id, UInt32(0));
@@ -135,6 +218,7 @@ Scene<Float, Spectrum>::ray_intersect_preliminary_cpu(const Ray3f &ray, Mask act
                 masked(pi.shape, hit_not_inst) = shape;
 
                 pi.prim_index = prim_index;
+                pi.shape_index = shape_index;
                 pi.prim_uv = Point2f(load<Float>(rh.hit.u), load<Float>(rh.hit.v));
             }
         }
@@ -160,7 +244,7 @@ Scene<Float, Spectrum>::ray_intersect_cpu(const Ray3f &ray, HitComputeFlags flag
             rh.ray.dir_x = ray.d.x();
             rh.ray.dir_y = ray.d.y();
             rh.ray.dir_z = ray.d.z();
-            rh.ray.time = 0;
+            rh.ray.time = (float) clamp(ray.time, Float(0.f), Float(1.f));
             rh.ray.tfar = ray.maxt;
             rh.ray.mask = 0;
             rh.ray.id = 0;
@@ -199,7 +283,7 @@ Scene<Float, Spectrum>::ray_intersect_cpu(const Ray3f &ray, HitComputeFlags flag
                 si.t = math::Infinity<Float>;
             }
         } else {
-            context.flags = RTC_INTERSECT_CONTEXT_FLAG_COHERENT;
+            context.flags = embree_coherence(ray, active);
 
             alignas(alignof(Float)) int valid[MTS_RAY_WIDTH];
             store(valid, select(active, Int32(-1), Int32(0)));
@@ -212,7 +296,7 @@ Scene<Float, Spectrum>::ray_intersect_cpu(const Ray3f &ray, HitComputeFlags flag
             store(rh.ray.dir_x, ray.d.x());
             store(rh.ray.dir_y, ray.d.y());
             store(rh.ray.dir_z, ray.d.z());
-            store(rh.ray.time, Float(0));
+            store(rh.ray.time, clamp(ray.time, Float(0.f), Float(1.f)));
             store(rh.ray.tfar, ray.maxt);
             store(rh.ray.mask, UInt32(0));
             store(rh.ray.id, UInt32(0));
@@ -277,7 +361,7 @@ Scene<Float, Spectrum>::ray_test_cpu(const Ray3f &ray, Mask active) const {
             ray2.dir_x = ray.d.x();
             ray2.dir_y = ray.d.y();
             ray2.dir_z = ray.d.z();
-            ray2.time = 0;
+            ray2.time = (float) clamp(ray.time, Float(0.f), Float(1.f));
             ray2.tfar = ray.maxt;
             ray2.mask = 0;
             ray2.id = 0;
@@ -285,7 +369,7 @@ Scene<Float, Spectrum>::ray_test_cpu(const Ray3f &ray, Mask active) const {
             rtcOccluded1((RTCScene) m_accel, &context, &ray2);
             return ray2.tfar != ray.maxt;
         } else {
-            context.flags = RTC_INTERSECT_CONTEXT_FLAG_COHERENT;
+            context.flags = embree_coherence(ray, active);
 
             alignas(alignof(Float)) int valid[MTS_RAY_WIDTH];
             store(valid, select(active, Int32(-1), Int32(0)));
@@ -298,7 +382,7 @@ Scene<Float, Spectrum>::ray_test_cpu(const Ray3f &ray, Mask active) const {
             store(ray2.dir_x, ray.d.x());
             store(ray2.dir_y, ray.d.y());
             store(ray2.dir_z, ray.d.z());
-            store(ray2.time, Float(0));
+            store(ray2.time, clamp(ray.time, Float(0.f), Float(1.f)));
             store(ray2.tfar, ray.maxt);
             store(ray2.mask, UInt32(0));
             store(ray2.id, UInt32(0));
@@ -311,4 +395,43 @@ Scene<Float, Spectrum>::ray_test_cpu(const Ray3f &ray, Mask active) const {
     }
 }
 
+MTS_VARIANT void Scene<Float, Spectrum>::ray_test_batch_cpu(const Ray3f *rays, size_t count,
+                                                            Mask *hit) const {
+    if constexpr (!is_array_v<Float>) {
+        RTCIntersectContext context;
+        rtcInitIntersectContext(&context);
+        context.flags = RTC_INTERSECT_CONTEXT_FLAG_COHERENT;
+
+        // Embree's stream interface reorders and packetizes the rays internally
+        static thread_local std::vector<RTCRay> rays2;
+        rays2.resize(count);
+
+        for (size_t i = 0; i < count; ++i) {
+            const Ray3f &ray = rays[i];
+            RTCRay &ray2 = rays2[i];
+            ray2.org_x = ray.o.x();
+            ray2.org_y = ray.o.y();
+            ray2.org_z = ray.o.z();
+            ray2.tnear = ray.mint;
+            ray2.dir_x = ray.d.x();
+            ray2.dir_y = ray.d.y();
+            ray2.dir_z = ray.d.z();
+            ray2.time = (float) clamp(ray.time, Float(0.f), Float(1.f));
+            ray2.tfar = ray.maxt;
+            ray2.mask = 0;
+            ray2.id = (unsigned int) i;
+            ray2.flags = 0;
+        }
+
+        rtcOccluded1M((RTCScene) m_accel, &context, rays2.data(),
+                      (unsigned int) count, sizeof(RTCRay));
+
+        for (size_t i = 0; i < count; ++i)
+            hit[i] = rays2[i].tfar != rays[i].maxt;
+    } else {
+        for (size_t i = 0; i < count; ++i)
+            hit[i] = ray_test_cpu(rays[i], true);
+    }
+}
+
 NAMESPACE_END(mitsuba)
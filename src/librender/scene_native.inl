@@ -1,30 +1,79 @@
 NAMESPACE_BEGIN(mitsuba)
 
 MTS_VARIANT void Scene<Float, Spectrum>::accel_init_cpu(const Properties &props) {
-    ShapeKDTree *kdtree = new ShapeKDTree(props);
-    kdtree->inc_ref();
+    /* Native CPU backend: acceleration data structure used for ray
+       intersection queries ("kdtree" or "bvh"). Instances are best served
+       by the BVH, which references each of them exactly once and thus
+       never transforms a ray twice for the same instance. */
+    bool has_instances = false;
     for (Shape *shape : m_shapes)
-        kdtree->add_shape(shape);
-    kdtree->build();
-    m_accel = kdtree;
+        has_instances |= shape->is_instance() || shape->is_instancer();
+    std::string accel = props.string("accel", has_instances ? "bvh" : "kdtree");
+
+    /* The top-level data structure only depends on the bounding boxes of
+       the instances, hence it is built together with the shape groups */
+    size_t prim_count = 0;
+    for (Shape *shape : m_shapes)
+        prim_count += shape->primitive_count();
+
+    if (accel == "bvh") {
+        ShapeBVH *bvh = new ShapeBVH(props);
+        bvh->inc_ref();
+        for (Shape *shape : m_shapes)
+            bvh->add_shape(shape);
+        m_accel = bvh;
+        m_accel_bvh = true;
+        accel_build_pending([bvh]() { bvh->build(); }, prim_count);
+    } else if (accel == "kdtree") {
+        ShapeKDTree *kdtree = new ShapeKDTree(props);
+        kdtree->inc_ref();
+        for (Shape *shape : m_shapes)
+            kdtree->add_shape(shape);
+        m_accel = kdtree;
+        m_accel_bvh = false;
+        accel_build_pending([kdtree]() { kdtree->build(); }, prim_count);
+    } else {
+        Throw("Unknown acceleration data structure \"%s\" (must be \"kdtree\" "
+              "or \"bvh\")!", accel);
+    }
+}
+
+MTS_VARIANT void Scene<Float, Spectrum>::accel_parameters_changed_cpu() {
+    if (m_accel_bvh)
+        ((ShapeBVH *) m_accel)->update();
+    else
+        ((ShapeKDTree *) m_accel)->update();
 }
 
 MTS_VARIANT void Scene<Float, Spectrum>::accel_release_cpu() {
-    ((ShapeKDTree *) m_accel)->dec_ref();
+    if (m_accel_bvh)
+        ((ShapeBVH *) m_accel)->dec_ref();
+    else
+        ((ShapeKDTree *) m_accel)->dec_ref();
     m_accel = nullptr;
 }
 
+MTS_VARIANT void Scene<Float, Spectrum>::accel_account_memory_cpu(MemoryReport *report) const {
+    if (m_accel_bvh)
+        report->visit((const ShapeBVH *) m_accel);
+    else
+        report->visit((const ShapeKDTree *) m_accel);
+}
+
 MTS_VARIANT typename Scene<Float, Spectrum>::PreliminaryIntersection3f
 Scene<Float, Spectrum>::ray_intersect_preliminary_cpu(const Ray3f &ray, Mask active) const {
+    if (m_accel_bvh) {
+        const ShapeBVH *bvh = (const ShapeBVH *) m_accel;
+        return bvh->template ray_intersect_preliminary<false>(ray, active);
+    }
+
     const ShapeKDTree *kdtree = (const ShapeKDTree *) m_accel;
     return kdtree->template ray_intersect_preliminary<false>(ray, active);
 }
 
 MTS_VARIANT typename Scene<Float, Spectrum>::SurfaceInteraction3f
 Scene<Float, Spectrum>::ray_intersect_cpu(const Ray3f &ray, HitComputeFlags flags, Mask active) const {
-    const ShapeKDTree *kdtree = (const ShapeKDTree *) m_accel;
-
-    PreliminaryIntersection3f pi = kdtree->template ray_intersect_preliminary<false>(ray, active);
+    PreliminaryIntersection3f pi = ray_intersect_preliminary_cpu(ray, active);
     active &= pi.is_valid();
 
     SurfaceInteraction3f si;
@@ -42,9 +91,11 @@ Scene<Float, Spectrum>::ray_intersect_cpu(const Ray3f &ray, HitComputeFlags flag
 
 MTS_VARIANT typename Scene<Float, Spectrum>::SurfaceInteraction3f
 Scene<Float, Spectrum>::ray_intersect_naive_cpu(const Ray3f &ray, Mask active) const {
-    const ShapeKDTree *kdtree = (const ShapeKDTree *) m_accel;
-
-    auto pi = kdtree->template ray_intersect_naive<false>(ray, active);
+    PreliminaryIntersection3f pi;
+    if (m_accel_bvh)
+        pi = ((const ShapeBVH *) m_accel)->template ray_intersect_naive<false>(ray, active);
+    else
+        pi = ((const ShapeKDTree *) m_accel)->template ray_intersect_naive<false>(ray, active);
     active &= pi.is_valid();
 
     SurfaceInteraction3f si;
@@ -62,8 +113,22 @@ Scene<Float, Spectrum>::ray_intersect_naive_cpu(const Ray3f &ray, Mask active) c
 
 MTS_VARIANT typename Scene<Float, Spectrum>::Mask
 Scene<Float, Spectrum>::ray_test_cpu(const Ray3f &ray, Mask active) const {
+    if (m_accel_bvh) {
+        const ShapeBVH *bvh = (const ShapeBVH *) m_accel;
+        return bvh->template ray_intersect_preliminary<true>(ray, active).is_valid();
+    }
+
     const ShapeKDTree *kdtree = (ShapeKDTree *) m_accel;
     return kdtree->template ray_intersect_preliminary<true>(ray, active).is_valid();
 }
 
+MTS_VARIANT void Scene<Float, Spectrum>::ray_test_batch_cpu(const Ray3f *rays, size_t count,
+                                                            Mask *hit) const {
+    /* The kd-tree and BVH traverse one ray at a time. Rays of a batch that
+       originate from neighboring pixels mostly visit the same nodes, which
+       are then still cached. */
+    for (size_t i = 0; i < count; ++i)
+        hit[i] = ray_test_cpu(rays[i], true);
+}
+
 NAMESPACE_END(mitsuba)
@@ -1,6 +1,8 @@
 #include "librender_ptx.h"
 #include <iomanip>
+#include <mutex>
 
+#include <mitsuba/core/filesystem.h>
 #include <mitsuba/render/optix/common.h>
 #include <mitsuba/render/optix/shapes.h>
 #include <mitsuba/render/optix_api.h>
@@ -26,20 +28,212 @@ static void context_log_cb(unsigned int level, const char* tag, const char* mess
     static constexpr size_t ProgramGroupCount = 3 + custom_optix_shapes_count;
 #endif
 
-struct OptixState {
-    OptixDeviceContext context;
+/**
+ * OptiX objects that only depend on the PTX code (device context, module,
+ * program groups and pipeline). They are created by the first scene and shared
+ * by all later scenes of the process, so that e.g. optimization loops which
+ * rebuild scenes don't compile the PTX code over and over again.
+ */
+struct OptixConfig {
+    OptixDeviceContext context = nullptr;
     OptixPipeline pipeline = nullptr;
     OptixModule module = nullptr;
     OptixProgramGroup program_groups[ProgramGroupCount];
+    char *custom_optix_shapes_program_names[2 * custom_optix_shapes_count];
+};
+
+static OptixConfig *optix_shared_config = nullptr;
+static std::mutex optix_shared_config_mutex;
+
+static const OptixConfig &optix_config() {
+    std::lock_guard<std::mutex> guard(optix_shared_config_mutex);
+    if (optix_shared_config)
+        return *optix_shared_config;
+
+    Log(Debug, "Creating the OptiX pipeline ..");
+    optix_shared_config = new OptixConfig();
+    OptixConfig &c = *optix_shared_config;
+
+    // ------------------------
+    //  OptiX context creation
+    // ------------------------
+
+    CUcontext cuCtx = 0;  // zero means take the current context
+    OptixDeviceContextOptions options = {};
+    options.logCallbackFunction       = &context_log_cb;
+#if !defined(MTS_OPTIX_DEBUG)
+    options.logCallbackLevel          = 1;
+#else
+    options.logCallbackLevel          = 3;
+#endif
+    rt_check(optixDeviceContextCreate(cuCtx, &options, &c.context));
+
+    /* OptiX keys its module cache by the PTX code, compile options, device
+       and driver version, so a shared directory can safely serve many jobs */
+    const std::string &cache_path = optix_cache_path();
+    if (!cache_path.empty()) {
+        std::string optix_cache = (fs::path(cache_path) / "optix").string();
+        rt_check(optixDeviceContextSetCacheLocation(c.context, optix_cache.c_str()));
+        rt_check(optixDeviceContextSetCacheDatabaseSizes(c.context, size_t(1) << 30,
+                                                         size_t(1) << 31));
+        rt_check(optixDeviceContextSetCacheEnabled(c.context, 1));
+    }
+
+    // ----------------------------------------------
+    //  Pipeline generation - Create Module from PTX
+    // ----------------------------------------------
+
+    OptixPipelineCompileOptions pipeline_compile_options = {};
+    OptixModuleCompileOptions module_compile_options = {};
+
+    module_compile_options.maxRegisterCount = OPTIX_COMPILE_DEFAULT_MAX_REGISTER_COUNT;
+#if !defined(MTS_OPTIX_DEBUG)
+    module_compile_options.optLevel         = OPTIX_COMPILE_OPTIMIZATION_DEFAULT;
+    module_compile_options.debugLevel       = OPTIX_COMPILE_DEBUG_LEVEL_NONE;
+#else
+    module_compile_options.optLevel         = OPTIX_COMPILE_OPTIMIZATION_LEVEL_0;
+    module_compile_options.debugLevel       = OPTIX_COMPILE_DEBUG_LEVEL_FULL;
+#endif
+
+    pipeline_compile_options.usesMotionBlur        = false;
+    pipeline_compile_options.traversableGraphFlags = OPTIX_TRAVERSABLE_GRAPH_FLAG_ALLOW_ANY;
+    pipeline_compile_options.numPayloadValues      = 3;
+    pipeline_compile_options.numAttributeValues    = 3;
+    pipeline_compile_options.pipelineLaunchParamsVariableName = "params";
+
+#if !defined(MTS_OPTIX_DEBUG)
+    pipeline_compile_options.exceptionFlags = OPTIX_EXCEPTION_FLAG_NONE;
+#else
+    pipeline_compile_options.exceptionFlags =
+            OPTIX_EXCEPTION_FLAG_STACK_OVERFLOW
+            | OPTIX_EXCEPTION_FLAG_TRACE_DEPTH
+            | OPTIX_EXCEPTION_FLAG_USER
+            | OPTIX_EXCEPTION_FLAG_DEBUG;
+#endif
+
+    rt_check_log(optixModuleCreateFromPTX(
+        c.context,
+        &module_compile_options,
+        &pipeline_compile_options,
+        (const char *)optix_rt_ptx,
+        optix_rt_ptx_size,
+        optix_log_buffer,
+        &optix_log_buffer_size,
+        &c.module
+    ));
+
+    // ---------------------------------------------
+    //  Pipeline generation - Create program groups
+    // ---------------------------------------------
+
+    OptixProgramGroupOptions program_group_options = {};
+
+    OptixProgramGroupDesc prog_group_descs[ProgramGroupCount];
+    memset(prog_group_descs, 0, sizeof(prog_group_descs));
+
+    prog_group_descs[0].kind                     = OPTIX_PROGRAM_GROUP_KIND_RAYGEN;
+    prog_group_descs[0].raygen.module            = c.module;
+    prog_group_descs[0].raygen.entryFunctionName = "__raygen__rg";
+
+    prog_group_descs[1].kind                   = OPTIX_PROGRAM_GROUP_KIND_MISS;
+    prog_group_descs[1].miss.module            = c.module;
+    prog_group_descs[1].miss.entryFunctionName = "__miss__ms";
+
+    prog_group_descs[2].kind                         = OPTIX_PROGRAM_GROUP_KIND_HITGROUP;
+    prog_group_descs[2].hitgroup.moduleCH            = c.module;
+    prog_group_descs[2].hitgroup.entryFunctionNameCH = "__closesthit__mesh";
+
+    for (size_t i = 0; i < custom_optix_shapes_count; i++) {
+        prog_group_descs[3+i].kind                         = OPTIX_PROGRAM_GROUP_KIND_HITGROUP;
+
+        std::string name = string::to_lower(custom_optix_shapes[i]);
+        c.custom_optix_shapes_program_names[2*i] = strdup(("__closesthit__" + name).c_str());
+        c.custom_optix_shapes_program_names[2*i+1] = strdup(("__intersection__" + name).c_str());
+
+        prog_group_descs[3+i].hitgroup.moduleCH            = c.module;
+        prog_group_descs[3+i].hitgroup.entryFunctionNameCH = c.custom_optix_shapes_program_names[2*i];
+        prog_group_descs[3+i].hitgroup.moduleIS            = c.module;
+        prog_group_descs[3+i].hitgroup.entryFunctionNameIS = c.custom_optix_shapes_program_names[2*i+1];
+    }
+
+#if defined(MTS_OPTIX_DEBUG)
+    OptixProgramGroupDesc &exception_prog_group_desc = prog_group_descs[ProgramGroupCount-1];
+    exception_prog_group_desc.kind                         = OPTIX_PROGRAM_GROUP_KIND_EXCEPTION;
+    exception_prog_group_desc.hitgroup.moduleCH            = c.module;
+    exception_prog_group_desc.hitgroup.entryFunctionNameCH = "__exception__err";
+#endif
+
+    rt_check_log(optixProgramGroupCreate(
+        c.context,
+        prog_group_descs,
+        ProgramGroupCount,
+        &program_group_options,
+        optix_log_buffer,
+        &optix_log_buffer_size,
+        c.program_groups
+    ));
+
+    // ---------------------------------------
+    //  Pipeline generation - Create pipeline
+    // ---------------------------------------
+
+    OptixPipelineLinkOptions pipeline_link_options = {};
+    pipeline_link_options.maxTraceDepth          = 1;
+#if defined(MTS_OPTIX_DEBUG)
+    pipeline_link_options.debugLevel             = OPTIX_COMPILE_DEBUG_LEVEL_FULL;
+#else
+    pipeline_link_options.debugLevel             = OPTIX_COMPILE_DEBUG_LEVEL_NONE;
+#endif
+    pipeline_link_options.overrideUsesMotionBlur = false;
+    rt_check_log(optixPipelineCreate(
+        c.context,
+        &pipeline_compile_options,
+        &pipeline_link_options,
+        c.program_groups,
+        ProgramGroupCount,
+        optix_log_buffer,
+        &optix_log_buffer_size,
+        &c.pipeline
+    ));
+
+    return c;
+}
+
+void optix_release_shared_config() {
+    std::lock_guard<std::mutex> guard(optix_shared_config_mutex);
+    if (!optix_shared_config)
+        return;
+
+    OptixConfig &c = *optix_shared_config;
+    rt_check(optixPipelineDestroy(c.pipeline));
+    for (size_t i = 0; i < ProgramGroupCount; i++)
+        rt_check(optixProgramGroupDestroy(c.program_groups[i]));
+    for (size_t i = 0; i < 2 * custom_optix_shapes_count; i++)
+        free(c.custom_optix_shapes_program_names[i]);
+    rt_check(optixModuleDestroy(c.module));
+    rt_check(optixDeviceContextDestroy(c.context));
+
+    delete optix_shared_config;
+    optix_shared_config = nullptr;
+}
+
+struct OptixState {
+    OptixDeviceContext context;
+    OptixPipeline pipeline = nullptr;
+    const OptixProgramGroup *program_groups = nullptr;
     OptixShaderBindingTable sbt = {};
     OptixAccelData accel;
     OptixTraversableHandle ias_handle = 0ull;
     void* ias_buffer = nullptr;
 
     void* params;
-    char *custom_optix_shapes_program_names[2 * custom_optix_shapes_count];
 
     enoki::CUDAArray<const void*> shapes_ptr;
+
+    /* Index of the first OptixInstance of every instancer in the IAS and
+       number of entries per instance (0 for the other shapes) */
+    bool has_instancers = false;
+    enoki::CUDAArray<uint32_t> instancer_base, instancer_stride;
 };
 
 MTS_VARIANT void Scene<Float, Spectrum>::accel_init_gpu(const Properties &/*props*/) {
@@ -51,143 +245,18 @@ MTS_VARIANT void Scene<Float, Spectrum>::accel_init_gpu(const Properties &/*prop
         // Copy shapes pointers to the GPU
         s.shapes_ptr = enoki::CUDAArray<const void*>::copy((void**)m_shapes.data(), m_shapes.size());
 
-        // ------------------------
-        //  OptiX context creation
-        // ------------------------
-
-        CUcontext cuCtx = 0;  // zero means take the current context
-        OptixDeviceContextOptions options = {};
-        options.logCallbackFunction       = &context_log_cb;
-    #if !defined(MTS_OPTIX_DEBUG)
-        options.logCallbackLevel          = 1;
-    #else
-        options.logCallbackLevel          = 3;
-    #endif
-        rt_check(optixDeviceContextCreate(cuCtx, &options, &s.context));
-
-        // ----------------------------------------------
-        //  Pipeline generation - Create Module from PTX
-        // ----------------------------------------------
-
-        OptixPipelineCompileOptions pipeline_compile_options = {};
-        OptixModuleCompileOptions module_compile_options = {};
-
-        module_compile_options.maxRegisterCount = OPTIX_COMPILE_DEFAULT_MAX_REGISTER_COUNT;
-    #if !defined(MTS_OPTIX_DEBUG)
-        module_compile_options.optLevel         = OPTIX_COMPILE_OPTIMIZATION_DEFAULT;
-        module_compile_options.debugLevel       = OPTIX_COMPILE_DEBUG_LEVEL_NONE;
-    #else
-        module_compile_options.optLevel         = OPTIX_COMPILE_OPTIMIZATION_LEVEL_0;
-        module_compile_options.debugLevel       = OPTIX_COMPILE_DEBUG_LEVEL_FULL;
-    #endif
-
-        pipeline_compile_options.usesMotionBlur        = false;
-        pipeline_compile_options.traversableGraphFlags = OPTIX_TRAVERSABLE_GRAPH_FLAG_ALLOW_ANY;
-        pipeline_compile_options.numPayloadValues      = 3;
-        pipeline_compile_options.numAttributeValues    = 3;
-        pipeline_compile_options.pipelineLaunchParamsVariableName = "params";
-
-    #if !defined(MTS_OPTIX_DEBUG)
-        pipeline_compile_options.exceptionFlags = OPTIX_EXCEPTION_FLAG_NONE;
-    #else
-        pipeline_compile_options.exceptionFlags =
-                OPTIX_EXCEPTION_FLAG_STACK_OVERFLOW
-                | OPTIX_EXCEPTION_FLAG_TRACE_DEPTH
-                | OPTIX_EXCEPTION_FLAG_USER
-                | OPTIX_EXCEPTION_FLAG_DEBUG;
-    #endif
-
-        rt_check_log(optixModuleCreateFromPTX(
-            s.context,
-            &module_compile_options,
-            &pipeline_compile_options,
-            (const char *)optix_rt_ptx,
-            optix_rt_ptx_size,
-            optix_log_buffer,
-            &optix_log_buffer_size,
-            &s.module
-        ));
-
-        // ---------------------------------------------
-        //  Pipeline generation - Create program groups
-        // ---------------------------------------------
-
-        OptixProgramGroupOptions program_group_options = {};
-
-        OptixProgramGroupDesc prog_group_descs[ProgramGroupCount];
-        memset(prog_group_descs, 0, sizeof(prog_group_descs));
-
-        prog_group_descs[0].kind                     = OPTIX_PROGRAM_GROUP_KIND_RAYGEN;
-        prog_group_descs[0].raygen.module            = s.module;
-        prog_group_descs[0].raygen.entryFunctionName = "__raygen__rg";
-
-        prog_group_descs[1].kind                   = OPTIX_PROGRAM_GROUP_KIND_MISS;
-        prog_group_descs[1].miss.module            = s.module;
-        prog_group_descs[1].miss.entryFunctionName = "__miss__ms";
-
-        prog_group_descs[2].kind                         = OPTIX_PROGRAM_GROUP_KIND_HITGROUP;
-        prog_group_descs[2].hitgroup.moduleCH            = s.module;
-        prog_group_descs[2].hitgroup.entryFunctionNameCH = "__closesthit__mesh";
-
-        for (size_t i = 0; i < custom_optix_shapes_count; i++) {
-            prog_group_descs[3+i].kind                         = OPTIX_PROGRAM_GROUP_KIND_HITGROUP;
-
-            std::string name = string::to_lower(custom_optix_shapes[i]);
-            s.custom_optix_shapes_program_names[2*i] = strdup(("__closesthit__" + name).c_str());
-            s.custom_optix_shapes_program_names[2*i+1] = strdup(("__intersection__" + name).c_str());
-
-            prog_group_descs[3+i].hitgroup.moduleCH            = s.module;
-            prog_group_descs[3+i].hitgroup.entryFunctionNameCH = s.custom_optix_shapes_program_names[2*i];
-            prog_group_descs[3+i].hitgroup.moduleIS            = s.module;
-            prog_group_descs[3+i].hitgroup.entryFunctionNameIS = s.custom_optix_shapes_program_names[2*i+1];
-        }
-
-    #if defined(MTS_OPTIX_DEBUG)
-        OptixProgramGroupDesc &exception_prog_group_desc = prog_group_descs[ProgramGroupCount-1];
-        exception_prog_group_desc.kind                         = OPTIX_PROGRAM_GROUP_KIND_EXCEPTION;
-        exception_prog_group_desc.hitgroup.moduleCH            = s.module;
-        exception_prog_group_desc.hitgroup.entryFunctionNameCH = "__exception__err";
-    #endif
-
-        rt_check_log(optixProgramGroupCreate(
-            s.context,
-            prog_group_descs,
-            ProgramGroupCount,
-            &program_group_options,
-            optix_log_buffer,
-            &optix_log_buffer_size,
-            s.program_groups
-        ));
-
-        // ---------------------------------------
-        //  Pipeline generation - Create pipeline
-        // ---------------------------------------
-
-        OptixPipelineLinkOptions pipeline_link_options = {};
-        pipeline_link_options.maxTraceDepth          = 1;
-    #if defined(MTS_OPTIX_DEBUG)
-        pipeline_link_options.debugLevel             = OPTIX_COMPILE_DEBUG_LEVEL_FULL;
-    #else
-        pipeline_link_options.debugLevel             = OPTIX_COMPILE_DEBUG_LEVEL_NONE;
-    #endif
-        pipeline_link_options.overrideUsesMotionBlur = false;
-        rt_check_log(optixPipelineCreate(
-            s.context,
-            &pipeline_compile_options,
-            &pipeline_link_options,
-            s.program_groups,
-            ProgramGroupCount,
-            optix_log_buffer,
-            &optix_log_buffer_size,
-            &s.pipeline
-        ));
+        // Context, module and pipeline are shared by all scenes
+        const OptixConfig &config = optix_config();
+        s.context        = config.context;
+        s.pipeline       = config.pipeline;
+        s.program_groups = config.program_groups;
 
         // ---------------------------------
         //  Shader Binding Table generation
         // ---------------------------------
 
         std::vector<HitGroupSbtRecord> hg_sbts;
-        fill_hitgroup_records(m_shapes, hg_sbts, s.program_groups);
+        fill_hitgroup_records(m_shapes, s.accel, hg_sbts, s.program_groups);
         for (auto& shapegroup: m_shapegroups)
             shapegroup->optix_fill_hitgroup_records(hg_sbts, s.program_groups);
 
@@ -233,22 +302,40 @@ MTS_VARIANT void Scene<Float, Spectrum>::accel_init_gpu(const Properties &/*prop
     }
 }
 
-MTS_VARIANT void Scene<Float, Spectrum>::accel_parameters_changed_gpu() {
+MTS_VARIANT void Scene<Float, Spectrum>::accel_parameters_changed_gpu(bool refit) {
     if constexpr (is_cuda_array_v<Float>) {
         if (m_shapes.empty())
             return;
 
         OptixState &s = *(OptixState *) m_accel;
 
-        // Build geometry acceleration structures for all the shapes
-        build_gas(s.context, m_shapes, s.accel);
+        // Build (or refit) geometry acceleration structures for all the shapes
+        build_gas(s.context, m_shapes, s.accel, refit);
         for (auto& shapegroup: m_shapegroups)
             shapegroup->optix_build_gas(s.context);
 
         // Gather information about the instance acceleration structures to be built
         std::vector<OptixInstance> ias;
+        std::vector<std::pair<uint32_t, uint32_t>> instancer_ranges(m_shapes.size(), { 0u, 0u });
         prepare_ias(s.context, m_shapes, 0, s.accel, (uint32_t) m_shapes.size(),
-                    ScalarTransform4f(), ias);
+                    ScalarTransform4f(), ias, &instancer_ranges);
+
+        s.has_instancers = false;
+        for (auto &shape : m_shapes)
+            s.has_instancers |= shape->is_instancer();
+        if (s.has_instancers) {
+            std::vector<uint32_t> base(m_shapes.size()), stride(m_shapes.size());
+            for (size_t i = 0; i < m_shapes.size(); ++i)
+                std::tie(base[i], stride[i]) = instancer_ranges[i];
+            s.instancer_base   = enoki::CUDAArray<uint32_t>::copy(base.data(), base.size());
+            s.instancer_stride = enoki::CUDAArray<uint32_t>::copy(stride.data(), stride.size());
+        }
+
+        // Instance transforms may have changed: always rebuild the "master" IAS
+        if (s.ias_buffer) {
+            cuda_free(s.ias_buffer);
+            s.ias_buffer = nullptr;
+        }
 
         // If there is only a single IAS, no need to build the "master" IAS
         if (ias.size() == 1) {
@@ -274,27 +361,10 @@ MTS_VARIANT void Scene<Float, Spectrum>::accel_parameters_changed_gpu() {
         build_input.instanceArray.aabbs = 0;
         build_input.instanceArray.numAabbs = 0;
 
-        OptixAccelBufferSizes buffer_sizes;
-        rt_check(optixAccelComputeMemoryUsage(s.context, &accel_options, &build_input, 1, &buffer_sizes));
-        void* d_temp_buffer = cuda_malloc(buffer_sizes.tempSizeInBytes);
-        s.ias_buffer    = cuda_malloc(buffer_sizes.outputSizeInBytes);
-
-        rt_check(optixAccelBuild(
-            s.context,
-            0, // CUDA stream
-            &accel_options,
-            &build_input,
-            1, // num build inputs
-            (CUdeviceptr)d_temp_buffer,
-            buffer_sizes.tempSizeInBytes,
-            (CUdeviceptr)s.ias_buffer,
-            buffer_sizes.outputSizeInBytes,
-            &s.ias_handle,
-            0, // emitted property list
-            0  // num emitted properties
-        ));
-
-        cuda_free(d_temp_buffer);
+        size_t ias_buffer_size;
+        s.ias_handle = build_compacted_accel(s.context, accel_options, &build_input, 1,
+                                             s.ias_buffer, ias_buffer_size);
+
         cuda_free(d_ias);
     }
 }
@@ -305,25 +375,29 @@ MTS_VARIANT void Scene<Float, Spectrum>::accel_release_gpu() {
         cuda_free((void*)s.sbt.raygenRecord);
         cuda_free((void*)s.params);
         cuda_free(s.ias_buffer);
-        rt_check(optixPipelineDestroy(s.pipeline));
-        for (size_t i = 0; i < ProgramGroupCount; i++)
-            rt_check(optixProgramGroupDestroy(s.program_groups[i]));
-        for (size_t i = 0; i < 2 * custom_optix_shapes_count; i++)
-            free(s.custom_optix_shapes_program_names[i]);
-        rt_check(optixModuleDestroy(s.module));
-        rt_check(optixDeviceContextDestroy(s.context));
+        // The context and pipeline are kept for the next scene, see optix_config()
 
         delete (OptixState *) m_accel;
         m_accel = nullptr;
     }
 }
 
-/// Helper function to launch the OptiX kernel (try twice if unsuccessful)
+/**
+ * \brief Helper function to launch the OptiX kernel (try twice if unsuccessful)
+ *
+ * The launch is asynchronous: the parameters are uploaded with an
+ * asynchronous copy (a synchronous one from pageable memory waits for all
+ * pending work on the device, including the previous launch), and the
+ * outputs are regular Enoki arrays allocated by the caller. The host can
+ * hence already trace and compile the next kernels while the rays are being
+ * traced. Launch, copy and Enoki's kernels are ordered by the default stream,
+ * so that reusing the parameter buffer of the scene is safe.
+ */
 void launch_optix_kernel(const OptixState &s,
                          const OptixParams &params,
                          size_t ray_count) {
 
-    cuda_memcpy_to_device(s.params, &params, sizeof(OptixParams));
+    cuda_memcpy_to_device_async(s.params, &params, sizeof(OptixParams));
 
     unsigned int width = 1, height = (unsigned int) ray_count;
     while (!(height & 1) && width < height) {
@@ -368,6 +442,15 @@ template <typename T> void bind_data(scalar_t<T> **field, T &value) {
     }
 }
 
+/// Map the hit \c OptixInstance back to the index of the instance within its instancer
+template <typename UInt32, typename Mask>
+UInt32 instancer_index(const OptixState &s, const UInt32 &instance_index,
+                       const UInt32 &instance_local, const Mask &active) {
+    UInt32 base   = gather<UInt32>(s.instancer_base, instance_index, active),
+           stride = gather<UInt32>(s.instancer_stride, instance_index, active);
+    return select(active && stride > 0u, (instance_local - base) / max(stride, 1u), 0u);
+}
+
 MTS_VARIANT typename Scene<Float, Spectrum>::PreliminaryIntersection3f
 Scene<Float, Spectrum>::ray_intersect_preliminary_gpu(const Ray3f &ray_, Mask active) const {
     if constexpr (is_cuda_array_v<Float>) {
@@ -386,7 +469,9 @@ Scene<Float, Spectrum>::ray_intersect_preliminary_gpu(const Ray3f &ray_, Mask ac
         // is used to tag IAS that are not related to instancing (e.g. custom
         // shape tree).
         uint32_t max_inst_index = m_shapegroups.empty() ? 0u : (unsigned int) m_shapes.size();
-        UInt32 instance_index = full<UInt32>(max_inst_index, ray_count);
+        UInt32 instance_index = full<UInt32>(max_inst_index, ray_count), instance_local;
+        if (s.has_instancers)
+            instance_local = empty<UInt32>(ray_count);
 
         // Ensure pi and instance_index are allocated before binding the data pointers
         cuda_eval();
@@ -404,6 +489,8 @@ Scene<Float, Spectrum>::ray_intersect_preliminary_gpu(const Ray3f &ray_, Mask ac
         bind_data(params.out_prim_uv, pi.prim_uv);
         bind_data(&params.out_prim_index, pi.prim_index);
         bind_data(&params.out_inst_index, instance_index);
+        if (s.has_instancers)
+            bind_data(&params.out_inst_local, instance_local);
         params.out_shape_ptr = (unsigned long long*)pi.shape.data();
         params.handle = s.ias_handle;
 
@@ -415,6 +502,11 @@ Scene<Float, Spectrum>::ray_intersect_preliminary_gpu(const Ray3f &ray_, Mask ac
             gather<ShapePtr>(reinterpret_array<ShapePtr>(s.shapes_ptr),
                              instance_index, active & valid_instances);
 
+        // Instancers read the index of the hit instance from 'shape_index'
+        if (s.has_instancers)
+            pi.shape_index = instancer_index(s, instance_index, instance_local,
+                                             active & valid_instances);
+
         return pi;
     } else {
         ENOKI_MARK_USED(ray_);
@@ -484,7 +576,9 @@ Scene<Float, Spectrum>::ray_intersect_gpu(const Ray3f &ray_, HitComputeFlags fla
         // is used to tag IAS that are not related to instancing (e.g. custom
         // shape tree).
         uint32_t max_inst_index = m_shapegroups.empty() ? 0u : (unsigned int) m_shapes.size();
-        UInt32 instance_index = full<UInt32>(max_inst_index, ray_count);
+        UInt32 instance_index = full<UInt32>(max_inst_index, ray_count), instance_local;
+        if (s.has_instancers)
+            instance_local = empty<UInt32>(ray_count);
 
         // Ensure si and instance_index are allocated before binding the
         // data pointers
@@ -521,6 +615,8 @@ Scene<Float, Spectrum>::ray_intersect_gpu(const Ray3f &ray_, HitComputeFlags fla
         }
         bind_data(&params.out_prim_index, si.prim_index);
         bind_data(&params.out_inst_index, instance_index);
+        if (s.has_instancers)
+            bind_data(&params.out_inst_local, instance_local);
         params.out_shape_ptr = (unsigned long long*)si.shape.data();
         params.handle = s.ias_handle;
 
@@ -531,13 +627,16 @@ Scene<Float, Spectrum>::ray_intersect_gpu(const Ray3f &ray_, HitComputeFlags fla
         si.duv_dx = si.duv_dy = zero<Point2f>();
 
         if (has_flag(flags, HitComputeFlags::ShadingFrame))
-            si.initialize_sh_frame();
+            si.initialize_sh_frame(has_flag(flags, HitComputeFlags::dPdUV));
 
         // Only gather instance pointers for valid instance indices
         Mask valid_instances = instance_index < m_shapes.size();
         si.instance =
             gather<ShapePtr>(reinterpret_array<ShapePtr>(s.shapes_ptr),
                              instance_index, active & valid_instances);
+        if (s.has_instancers)
+            si.instance_index = instancer_index(s, instance_index, instance_local,
+                                                active & valid_instances);
 
         // Incident direction in local coordinates
         si.wi = select(si.is_valid(), si.to_local(-ray.d), -ray.d);
@@ -4,6 +4,7 @@
 #include <mitsuba/render/bsdf.h>
 #include <mitsuba/render/sensor.h>
 #include <mitsuba/render/medium.h>
+#include <mitsuba/render/texture.h>
 #include <mitsuba/core/plugin.h>
 
 #if defined(MTS_ENABLE_EMBREE)
@@ -79,6 +80,9 @@ MTS_VARIANT Shape<Float, Spectrum>::Shape(const Properties &props) : m_id(props.
             props2.set_float("reflectance", 0.f);
         m_bsdf = PluginManager::instance()->create_object<BSDF>(props2);
     }
+
+    if (!m_emitter && !m_sensor && !is_medium_transition())
+        m_alpha_mask = m_bsdf->alpha_mask();
 }
 
 MTS_VARIANT Shape<Float, Spectrum>::~Shape() {
@@ -249,6 +253,11 @@ MTS_VARIANT RTCGeometry Shape<Float, Spectrum>::embree_geometry(RTCDevice device
         Throw("embree_geometry() should only be called in CPU mode.");
     }
 }
+
+MTS_VARIANT void Shape<Float, Spectrum>::embree_update_geometry(RTCGeometry geom) {
+    // The bounds of user geometry are queried again when committing
+    rtcCommitGeometry(geom);
+}
 #endif
 
 #if defined(MTS_ENABLE_OPTIX)
@@ -333,6 +342,33 @@ Shape<Float, Spectrum>::ray_test(const Ray3f &ray, Mask active) const {
     return ray_intersect_preliminary(ray, active).is_valid();
 }
 
+MTS_VARIANT typename Shape<Float, Spectrum>::PreliminaryIntersection3f
+Shape<Float, Spectrum>::ray_intersect_primitive(ScalarIndex /*index*/, const Ray3f &ray,
+                                                Mask active) const {
+    return ray_intersect_preliminary(ray, active);
+}
+
+MTS_VARIANT typename Shape<Float, Spectrum>::Mask
+Shape<Float, Spectrum>::ray_test_primitive(ScalarIndex /*index*/, const Ray3f &ray,
+                                           Mask active) const {
+    return ray_test(ray, active);
+}
+
+MTS_VARIANT typename Shape<Float, Spectrum>::Mask
+Shape<Float, Spectrum>::alpha_test(const Ray3f &ray, const PreliminaryIntersection3f &pi,
+                                   Mask active) const {
+    Assert(m_alpha_mask);
+    active &= pi.is_valid();
+
+    // Only the texture coordinates are needed to look up the mask
+    SurfaceInteraction3f si = compute_surface_interaction(
+        ray, pi, HitComputeFlags::UV | HitComputeFlags::NonDifferentiable, active);
+    si.time        = ray.time;
+    si.wavelengths = ray.wavelengths;
+
+    return !active || m_alpha_mask->eval_1(si, active) > 0.f;
+}
+
 MTS_VARIANT typename Shape<Float, Spectrum>::SurfaceInteraction3f
 Shape<Float, Spectrum>::compute_surface_interaction(const Ray3f & /*ray*/,
                                                     PreliminaryIntersection3f /*pi*/,
@@ -414,6 +450,7 @@ MTS_VARIANT void Shape<Float, Spectrum>::traverse(TraversalCallback *callback) {
 
 MTS_VARIANT
 void Shape<Float, Spectrum>::parameters_changed(const std::vector<std::string> &/*keys*/) {
+    mark_dirty();
     if (m_emitter)
         m_emitter->parameters_changed({"parent"});
     if (m_sensor)
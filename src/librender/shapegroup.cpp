@@ -1,6 +1,12 @@
+#include <mitsuba/core/memreport.h>
 #include <mitsuba/core/properties.h>
+#include <mitsuba/core/random.h>
+#include <mitsuba/core/string.h>
+#include <mitsuba/render/bsdf.h>
 #include <mitsuba/render/shapegroup.h>
 #include <mitsuba/render/optix_api.h>
+#include <algorithm>
+#include <functional>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -11,7 +17,12 @@ MTS_VARIANT ShapeGroup<Float, Spectrum>::ShapeGroup(const Properties &props) {
     m_kdtree = new ShapeKDTree(props);
 #endif
 
+    m_lod_spread    = props.float_("lod_spread", 1e-3f);
+    m_lod_threshold = props.float_("lod_threshold", 0.f);
+    m_lod_blend     = props.bool_("lod_blend", true);
+
     // Add children to the underlying datastructure
+    std::vector<std::pair<int, ref<ShapeGroup>>> lods;
     for (auto &kv : props.objects()) {
         const Class *c_class = kv.second->class_();
         if (c_class->name() == "Instance") {
@@ -19,6 +30,20 @@ MTS_VARIANT ShapeGroup<Float, Spectrum>::ShapeGroup(const Properties &props) {
         } else if (c_class->derives_from(MTS_CLASS(Base))) {
             Base *shape = static_cast<Base *>(kv.second.get());
             ShapeGroup *shapegroup = dynamic_cast<ShapeGroup *>(kv.second.get());
+            if (shapegroup && string::starts_with(kv.first, "lod_")) {
+                // Coarser level of detail of this group
+                int level = 0;
+                try {
+                    level = std::stoi(kv.first.substr(4));
+                } catch (...) { }
+                if (level < 1)
+                    Throw("Invalid level of detail \"%s\", expected \"lod_1\", "
+                          "\"lod_2\", ..", kv.first);
+                if (shapegroup->lod_count() > 0)
+                    Throw("A level of detail cannot have levels of detail of its own");
+                lods.emplace_back(level, shapegroup);
+                continue;
+            }
             if (shapegroup)
                 Throw("Nested ShapeGroup is not permitted");
             if (shape->is_emitter())
@@ -26,6 +51,8 @@ MTS_VARIANT ShapeGroup<Float, Spectrum>::ShapeGroup(const Properties &props) {
             if (shape->is_sensor())
                 Throw("Instancing of sensors is not supported");
             else {
+                if (shape->bsdf())
+                    m_nested_bsdf_flags |= shape->bsdf()->flags();
 #if defined(MTS_ENABLE_EMBREE) || defined(MTS_ENABLE_OPTIX)
                 m_shapes.push_back(shape);
                 m_bbox.expand(shape->bbox());
@@ -38,14 +65,119 @@ MTS_VARIANT ShapeGroup<Float, Spectrum>::ShapeGroup(const Properties &props) {
             Throw("Tried to add an unsupported object of type \"%s\"", kv.second);
         }
     }
+#if !defined(MTS_ENABLE_EMBREE)
+    // The tree itself is built by the scene, see accel_build()
+    m_bbox = m_kdtree->bbox();
+#endif
+
+    std::sort(lods.begin(), lods.end(),
+              [](const auto &a, const auto &b) { return a.first < b.first; });
+    for (size_t i = 0; i < lods.size(); ++i) {
+        if (lods[i].first != (int) i + 1)
+            Throw("The levels of detail must be numbered consecutively, starting "
+                  "with \"lod_1\"");
+        m_lods.push_back(lods[i].second);
+        m_nested_bsdf_flags |= lods[i].second->nested_bsdf_flags();
+        m_bbox.expand(lods[i].second->bbox());
+    }
+
+    if (!m_lods.empty()) {
+        if (!(m_lod_threshold > 0.f))
+            Throw("Levels of detail require a positive \"lod_threshold\"");
+#if defined(MTS_ENABLE_EMBREE)
+        Log(Warn, "Levels of detail are only supported by the built-in kd-tree, "
+                  "using the full-resolution geometry of \"%s\"", m_id);
+#else
+        if constexpr (is_cuda_array_v<Float>)
+            Log(Warn, "Levels of detail are only supported by the built-in kd-tree, "
+                      "using the full-resolution geometry of \"%s\"", m_id);
+#endif
+    }
+
+    std::vector<ScalarBoundingBox3f> prim_bboxes;
+#if !defined(MTS_ENABLE_EMBREE)
+    prim_bboxes.reserve(m_kdtree->primitive_count());
+    for (ScalarSize i = 0; i < m_kdtree->primitive_count(); ++i)
+        prim_bboxes.push_back(m_kdtree->bbox(i));
+#else
+    for (auto shape : m_shapes)
+        for (ScalarSize i = 0; i < shape->primitive_count(); ++i)
+            prim_bboxes.push_back(shape->bbox(i));
+#endif
+    compute_bbox_cover(prim_bboxes);
+}
+
+MTS_VARIANT void ShapeGroup<Float, Spectrum>::accel_build() {
 #if !defined(MTS_ENABLE_EMBREE)
     if (!m_kdtree->ready())
         m_kdtree->build();
+#endif
+}
 
-    m_bbox = m_kdtree->bbox();
+MTS_VARIANT bool ShapeGroup<Float, Spectrum>::accel_ready() const {
+#if !defined(MTS_ENABLE_EMBREE)
+    return m_kdtree->ready();
+#else
+    return true;
 #endif
 }
 
+MTS_VARIANT void
+ShapeGroup<Float, Spectrum>::compute_bbox_cover(std::vector<ScalarBoundingBox3f> &prim_bboxes) {
+    /// Maximum number of boxes in the cover (must be a power of two)
+    constexpr size_t cover_size = 16;
+
+    m_bbox_cover.clear();
+    if (prim_bboxes.empty())
+        return;
+
+    // Recursive median splits along the axis of largest centroid extent
+    std::function<void(ScalarBoundingBox3f *, ScalarBoundingBox3f *, size_t)> split =
+        [&](ScalarBoundingBox3f *begin, ScalarBoundingBox3f *end, size_t count) {
+            ScalarBoundingBox3f bbox, centroids;
+            for (ScalarBoundingBox3f *b = begin; b != end; ++b) {
+                bbox.expand(*b);
+                centroids.expand(b->center());
+            }
+
+            if (count == 1 || end - begin <= 1) {
+                m_bbox_cover.push_back(bbox);
+                return;
+            }
+
+            uint32_t axis = centroids.major_axis();
+            ScalarBoundingBox3f *middle = begin + (end - begin) / 2;
+            std::nth_element(begin, middle, end,
+                [axis](const ScalarBoundingBox3f &a, const ScalarBoundingBox3f &b) {
+                    return a.center()[axis] < b.center()[axis];
+                });
+
+            split(begin, middle, count / 2);
+            split(middle, end, count / 2);
+        };
+
+    split(prim_bboxes.data(), prim_bboxes.data() + prim_bboxes.size(), cover_size);
+}
+
+MTS_VARIANT typename ShapeGroup<Float, Spectrum>::ScalarBoundingBox3f
+ShapeGroup<Float, Spectrum>::transformed_bbox(const ScalarTransform4f &to_world) const {
+    ScalarBoundingBox3f result;
+
+    /* Transform the center and half-extents of each box, using the absolute
+       value of the linear part for the latter (J. Arvo, Graphics Gems) */
+    const ScalarMatrix4f &m = to_world.matrix;
+    for (const ScalarBoundingBox3f &bbox : m_bbox_cover) {
+        ScalarPoint3f center = to_world.transform_affine(bbox.center());
+        ScalarVector3f half = .5f * bbox.extents(), half_t(0.f);
+        for (size_t i = 0; i < 3; ++i)
+            for (size_t j = 0; j < 3; ++j)
+                half_t[i] += abs(m(i, j)) * half[j];
+        result.expand(ScalarBoundingBox3f(center - half_t, center + half_t));
+    }
+
+    return result;
+}
+
 MTS_VARIANT ShapeGroup<Float, Spectrum>::~ShapeGroup() {
 #if defined(MTS_ENABLE_EMBREE)
     if constexpr (!is_cuda_array_v<Float>)
@@ -54,7 +186,7 @@ MTS_VARIANT ShapeGroup<Float, Spectrum>::~ShapeGroup() {
 }
 
 #if defined(MTS_ENABLE_EMBREE)
-MTS_VARIANT RTCGeometry ShapeGroup<Float, Spectrum>::embree_geometry(RTCDevice device) {
+MTS_VARIANT RTCScene ShapeGroup<Float, Spectrum>::embree_scene(RTCDevice device) {
     if constexpr (!is_cuda_array_v<Float>) {
         // Construct the BVH only once
         if (m_embree_scene == nullptr) {
@@ -63,9 +195,16 @@ MTS_VARIANT RTCGeometry ShapeGroup<Float, Spectrum>::embree_geometry(RTCDevice d
                 rtcAttachGeometry(m_embree_scene, shape->embree_geometry(device));
             rtcCommitScene(m_embree_scene);
         }
+        return m_embree_scene;
+    } else {
+        Throw("embree_scene() should only be called in CPU mode.");
+    }
+}
 
+MTS_VARIANT RTCGeometry ShapeGroup<Float, Spectrum>::embree_geometry(RTCDevice device) {
+    if constexpr (!is_cuda_array_v<Float>) {
         RTCGeometry instance = rtcNewGeometry(device, RTC_GEOMETRY_TYPE_INSTANCE);
-        rtcSetGeometryInstancedScene(instance, m_embree_scene);
+        rtcSetGeometryInstancedScene(instance, embree_scene(device));
         return instance;
     } else {
         Throw("embree_geometry() should only be called in CPU mode.");
@@ -80,7 +219,24 @@ ShapeGroup<Float, Spectrum>::ray_intersect_preliminary(const Ray3f &ray,
     if constexpr (is_cuda_array_v<Float>)
         Throw("ShapeGroup::ray_intersect_preliminary() should only be called in CPU mode.");
 
-    return m_kdtree->template ray_intersect_preliminary<false>(ray, active);
+    if (m_lods.empty())
+        return m_kdtree->template ray_intersect_preliminary<false>(ray, active);
+
+    UInt32 level = lod_level(ray, active);
+    PreliminaryIntersection3f pi;
+
+    Mask active_l = active && eq(level, 0u);
+    if (any(active_l))
+        masked(pi, active_l) =
+            m_kdtree->template ray_intersect_preliminary<false>(ray, active_l);
+
+    for (size_t i = 0; i < m_lods.size(); ++i) {
+        active_l = active && eq(level, (uint32_t) i + 1);
+        if (any(active_l))
+            masked(pi, active_l) = m_lods[i]->ray_intersect_preliminary(ray, active_l);
+    }
+
+    return pi;
 }
 
 MTS_VARIANT typename ShapeGroup<Float, Spectrum>::Mask
@@ -90,10 +246,58 @@ ShapeGroup<Float, Spectrum>::ray_test(const Ray3f &ray, Mask active) const {
     if constexpr (is_cuda_array_v<Float>)
         Throw("ShapeGroup::ray_test() should only be called in CPU mode.");
 
-    return m_kdtree->template ray_intersect_preliminary<true>(ray, active).is_valid();
+    if (m_lods.empty())
+        return m_kdtree->template ray_intersect_preliminary<true>(ray, active).is_valid();
+
+    UInt32 level = lod_level(ray, active);
+    Mask hit = false;
+
+    Mask active_l = active && eq(level, 0u);
+    if (any(active_l))
+        hit |= m_kdtree->template ray_intersect_preliminary<true>(ray, active_l).is_valid() &&
+               active_l;
+
+    for (size_t i = 0; i < m_lods.size(); ++i) {
+        active_l = active && eq(level, (uint32_t) i + 1);
+        if (any(active_l))
+            hit |= m_lods[i]->ray_test(ray, active_l) && active_l;
+    }
+
+    return hit;
 }
 #endif
 
+MTS_VARIANT typename ShapeGroup<Float, Spectrum>::UInt32
+ShapeGroup<Float, Spectrum>::lod_level(const Ray3f &ray, Mask active) const {
+    if (m_lods.empty())
+        return 0u;
+
+    /* Footprint where the ray enters the group. The ray parameter is the
+       distance along the normalized world-space ray, and the length of the
+       local direction converts it into local units. */
+    auto [hit, mint, maxt] = m_bbox.ray_intersect(ray);
+    ENOKI_MARK_USED(maxt);
+    Float footprint = m_lod_spread * max(mint, 0.f) * norm(ray.d);
+
+    // Continuous level: 1 at the threshold, +1 for every doubling of the footprint
+    Float level_f = max(log2(footprint * (1.f / m_lod_threshold)) + 1.f, 0.f);
+    UInt32 level = UInt32(level_f);
+
+    if (m_lod_blend) {
+        // Hash of the ray instead of a sample, which isn't available during traversal
+        using UInt32f = uint32_array_t<float32_array_t<Float>>;
+        UInt32f v0 = reinterpret_array<UInt32f>(float32_array_t<Float>(ray.d.x())) ^
+                     reinterpret_array<UInt32f>(float32_array_t<Float>(ray.o.y())),
+                v1 = reinterpret_array<UInt32f>(float32_array_t<Float>(ray.d.y())) ^
+                     reinterpret_array<UInt32f>(float32_array_t<Float>(ray.o.x())) ^
+                     reinterpret_array<UInt32f>(float32_array_t<Float>(ray.d.z() + ray.o.z()));
+        Float u = Float(sample_tea_float32(UInt32(v0), UInt32(v1)));
+        level += select(u < level_f - Float(level), 1u, 0u);
+    }
+
+    return select(active && hit, min(level, (uint32_t) m_lods.size()), 0u);
+}
+
 MTS_VARIANT typename ShapeGroup<Float, Spectrum>::SurfaceInteraction3f
 ShapeGroup<Float, Spectrum>::compute_surface_interaction(const Ray3f &ray,
                                                          PreliminaryIntersection3f pi,
@@ -148,11 +352,29 @@ MTS_VARIANT void ShapeGroup<Float, Spectrum>::optix_prepare_ias(
 MTS_VARIANT void ShapeGroup<Float, Spectrum>::optix_fill_hitgroup_records(std::vector<HitGroupSbtRecord> &hitgroup_records,
                                                                           const OptixProgramGroup *program_groups) {
     m_sbt_offset = (uint32_t) hitgroup_records.size();
-    fill_hitgroup_records(m_shapes, hitgroup_records, program_groups);
+    fill_hitgroup_records(m_shapes, m_accel, hitgroup_records, program_groups);
 }
 
 #endif
 
+MTS_VARIANT void ShapeGroup<Float, Spectrum>::account_memory(MemoryReport *report) const {
+#if defined(MTS_ENABLE_EMBREE) || defined(MTS_ENABLE_OPTIX)
+    for (const Base *shape : m_shapes)
+        report->visit(shape);
+#endif
+#if !defined(MTS_ENABLE_EMBREE)
+    if (m_kdtree) {
+        report->visit(m_kdtree.get());
+        for (size_t i = 0; i < m_kdtree->shape_count(); ++i)
+            report->visit(m_kdtree->shape(i));
+    }
+#endif
+    for (const ShapeGroup *lod : m_lods)
+        report->visit(lod);
+
+    Base::account_memory(report);
+}
+
 MTS_VARIANT std::string ShapeGroup<Float, Spectrum>::to_string() const {
     std::ostringstream oss;
         oss << "ShapeGroup[" << std::endl
@@ -2,30 +2,154 @@
 #include <mitsuba/render/spiral.h>
 #include <mitsuba/mitsuba.h>
 #include <mutex>
+#include <numeric>
 
 NAMESPACE_BEGIN(mitsuba)
 
 Spiral::Spiral(Vector2i size, Vector2i offset, size_t block_size, size_t passes)
     : m_block_size(block_size),
       m_size(size), m_offset(offset),
+      m_tail_count(0), m_passes(passes),
       m_remaining_passes(passes) {
 
     m_blocks = Vector2i(ceil(Vector2f(m_size) / m_block_size));
     m_block_count = hprod(m_blocks);
 
+    // Reimplementation of the spiraling block generator by Adam Arbree.
+    m_block_list.reserve(m_block_count);
+
+    Direction direction = Direction::Right;
+    Point2i position = m_blocks / 2;
+    int steps_left = 1, steps = 1;
+
+    while (m_block_list.size() < m_block_count) {
+        Vector2i block_offset(position * (int) m_block_size);
+        Vector2i block_size = min((int) m_block_size, m_size - block_offset);
+        Assert(all(block_size > 0));
+        m_block_list.emplace_back(block_offset, block_size);
+
+        if (m_block_list.size() == m_block_count)
+            break;
+
+        // Prepare the next block's position along the spiral.
+        do {
+            switch (direction) {
+                case Direction::Right: ++position.x(); break;
+                case Direction::Down:  ++position.y(); break;
+                case Direction::Left:  --position.x(); break;
+                case Direction::Up:    --position.y(); break;
+            }
+
+            if (--steps_left == 0) {
+                direction = Direction(((int) direction + 1) % 4);
+                if (direction == Direction::Left ||
+                    direction == Direction::Right)
+                    ++steps;
+                steps_left = steps;
+            }
+        } while (any(position < 0 || position >= m_blocks));
+    }
+
     reset();
 }
 
 void Spiral::reset() {
     m_block_counter = 0;
-    m_current_direction = Direction::Right;
-    m_position = m_blocks / 2;
-    m_steps_left = 1;
-    m_steps = 1;
+}
+
+void Spiral::set_tail_subdivision(size_t count) {
+    m_tail_count = std::min(count, m_block_count);
+    m_tail_blocks.clear();
+
+    for (size_t i = m_block_count - m_tail_count; i < m_block_count; ++i) {
+        auto [block_offset, block_size] = m_block_list[m_order.empty() ? i : m_order[i]];
+        Vector2i half = (block_size + 1) / 2;
+
+        for (int y = 0; y < 2; ++y) {
+            for (int x = 0; x < 2; ++x) {
+                Vector2i sub_offset = Vector2i(x, y) * half,
+                         sub_size   = min(half, block_size - sub_offset);
+                if (all(sub_size > 0))
+                    m_tail_blocks.emplace_back(block_offset + sub_offset, sub_size);
+            }
+        }
+    }
+}
+
+void Spiral::set_priorities(const std::vector<float> &priorities) {
+    if (priorities.empty()) {
+        m_order.clear();
+    } else {
+        if (priorities.size() != m_block_count)
+            Throw("Spiral::set_priorities(): expected %i priorities, got %i!",
+                  m_block_count, priorities.size());
+
+        m_order.resize(m_block_count);
+        std::iota(m_order.begin(), m_order.end(), 0u);
+        std::stable_sort(m_order.begin(), m_order.end(), [&](uint32_t a, uint32_t b) {
+            return priorities[a] > priorities[b];
+        });
+    }
+
+    // The subdivided tail consists of the last blocks in the new order
+    if (m_tail_count > 0)
+        set_tail_subdivision(m_tail_count);
+}
+
+void Spiral::set_priority_map(const Bitmap *map, const Vector2i &film_size) {
+    if (!map) {
+        set_priorities({});
+        return;
+    }
+
+    if (map->component_format() != Struct::Type::Float32 ||
+        map->pixel_format() != Bitmap::PixelFormat::Y)
+        Throw("Spiral::set_priority_map(): expected a single channel float32 bitmap!");
+
+    const float *data = (const float *) map->data();
+    Vector2i map_size = Vector2i(map->size());
+    Vector2f scale = Vector2f(map_size) / Vector2f(film_size);
+
+    std::vector<float> priorities(m_block_count);
+    for (size_t i = 0; i < m_block_count; ++i) {
+        const auto &[offset, size] = m_block_list[i];
+
+        // Map pixels overlapping the block (at least one)
+        Vector2i lo = Vector2i(floor(Vector2f(offset + m_offset) * scale)),
+                 hi = Vector2i(ceil(Vector2f(offset + m_offset + size) * scale));
+        lo = clamp(lo, 0, map_size - 1);
+        hi = clamp(max(hi, lo + 1), 1, map_size);
+
+        float priority = -std::numeric_limits<float>::infinity();
+        for (int y = lo.y(); y < hi.y(); ++y)
+            for (int x = lo.x(); x < hi.x(); ++x)
+                priority = std::max(priority, data[(size_t) y * map_size.x() + x]);
+        priorities[i] = priority;
+    }
+
+    set_priorities(priorities);
+}
+
+std::tuple<Spiral::Vector2i, Spiral::Vector2i, size_t> Spiral::block(size_t index) const {
+    size_t regular_count = m_passes * m_block_count - m_tail_count;
+    Assert(index < work_count());
+
+    if (likely(index < regular_count)) {
+        size_t pass = index / m_block_count,
+               block = index % m_block_count;
+        if (!m_order.empty())
+            block = m_order[block];
+        const auto &[offset, size] = m_block_list[block];
+        return { offset + m_offset, size, pass * m_block_count + block };
+    }
+
+    /* Subdivided tail blocks are assigned identifiers following those of
+       the regular blocks of all passes */
+    const auto &[offset, size] = m_tail_blocks[index - regular_count];
+    return { offset + m_offset, size, index + m_tail_count };
 }
 
 std::tuple<Spiral::Vector2i, Spiral::Vector2i, size_t> Spiral::next_block() {
-    // Reimplementation of the spiraling block generator by Adam Arbree.
     std::lock_guard<tbb::spin_mutex> lock(m_mutex);
 
     if (m_block_count == m_block_counter) {
@@ -38,37 +162,13 @@ std::tuple<Spiral::Vector2i, Spiral::Vector2i, size_t> Spiral::next_block() {
     }
 
     // Calculate a unique identifer per block
-    size_t block_id = m_block_counter + (m_remaining_passes - 1) * m_block_count;
-
-    Vector2i offset(m_position * (int) m_block_size);
-    Vector2i size = min((int) m_block_size, m_size - offset);
-    offset += m_offset;
-
-    Assert(all(size > 0));
-
-    ++m_block_counter;
+    size_t block = m_order.empty() ? m_block_counter : m_order[m_block_counter],
+           block_id = block + (m_remaining_passes - 1) * m_block_count;
+    m_block_counter++;
 
-    if (m_block_counter != m_block_count) {
-        // Prepare the next block's position along the spiral.
-        do {
-            switch (m_current_direction) {
-                case Direction::Right: ++m_position.x(); break;
-                case Direction::Down:  ++m_position.y(); break;
-                case Direction::Left:  --m_position.x(); break;
-                case Direction::Up:    --m_position.y(); break;
-            }
-
-            if (--m_steps_left == 0) {
-                m_current_direction = Direction(((int) m_current_direction + 1) % 4);
-                if (m_current_direction == Direction::Left ||
-                    m_current_direction == Direction::Right)
-                    ++m_steps;
-                m_steps_left = m_steps;
-            }
-        } while (any(m_position < 0 || m_position >= m_blocks));
-    }
+    const auto &[offset, size] = m_block_list[block];
 
-    return { offset, size, block_id };
+    return { offset + m_offset, size, block_id };
 }
 
 MTS_IMPLEMENT_CLASS(Spiral, Object)
@@ -11,9 +11,8 @@ NAMESPACE_BEGIN(mitsuba)
 static RGB2Spec *model = nullptr;
 static tbb::spin_mutex model_mutex;
 
-Array<float, 3> srgb_model_fetch(const Color<float, 3> &c) {
-    using Array3f = Array<float, 3>;
-
+/// Load the spectral upsampling model upon first use
+static RGB2Spec *srgb_model() {
     if (unlikely(model == nullptr)) {
         tbb::spin_mutex::scoped_lock sl(model_mutex);
         if (model == nullptr) {
@@ -26,6 +25,12 @@ Array<float, 3> srgb_model_fetch(const Color<float, 3> &c) {
             atexit([]{ rgb2spec_free(model); });
         }
     }
+    return model;
+}
+
+Array<float, 3> srgb_model_fetch(const Color<float, 3> &c) {
+    using Array3f = Array<float, 3>;
+    RGB2Spec *model = srgb_model();
 
     if (c == Array3f(0.f))
         return Array3f(0.f, 0.f, -math::Infinity<float>);
@@ -39,6 +44,104 @@ Array<float, 3> srgb_model_fetch(const Color<float, 3> &c) {
     return Array3f(out[0], out[1], out[2]);
 }
 
+/**
+ * Vectorized version of \c rgb2spec_fetch(), which converts a packet of
+ * consecutive RGB triplets starting at \c data[3 * start] in place
+ */
+template <typename Value>
+static void srgb_model_fetch_packet(const RGB2Spec *model, Value *data,
+                                    size_t start, size_t count) {
+    using FloatP   = Packet<float>;
+    using UInt32P  = uint32_array_t<FloatP>;
+    using MaskP    = mask_t<FloatP>;
+    using ValueP   = Array<Value, FloatP::Size>;
+    using Color3fP = Color<FloatP, 3>;
+
+    uint32_t res = model->res;
+    UInt32P pixel = arange<UInt32P>() + (uint32_t) start,
+            index = pixel * 3u;
+    MaskP active = pixel < (uint32_t) count;
+
+    Color3fP c(FloatP(gather<ValueP>(data, index, active)),
+               FloatP(gather<ValueP>(data, index + 1u, active)),
+               FloatP(gather<ValueP>(data, index + 2u, active)));
+    MaskP black = eq(c.r(), 0.f) && eq(c.g(), 0.f) && eq(c.b(), 0.f),
+          white = eq(c.r(), 1.f) && eq(c.g(), 1.f) && eq(c.b(), 1.f);
+    c = clamp(c, 0.f, 1.f);
+
+    // Determine the largest RGB component and the two following ones
+    FloatP z = c.r(), x = c.g(), y = c.b();
+    UInt32P i = 0u;
+    MaskP m = c.g() >= z;
+    masked(i, m) = 1u; masked(z, m) = c.g(); masked(x, m) = c.b(); masked(y, m) = c.r();
+    m = c.b() >= z;
+    masked(i, m) = 2u; masked(z, m) = c.b(); masked(x, m) = c.r(); masked(y, m) = c.g();
+
+    FloatP scale = (res - 1) / z;
+    x *= scale;
+    y *= scale;
+
+    // Trilinearly interpolated lookup
+    UInt32P xi = min(UInt32P(max(x, 0.f)), res - 2),
+            yi = min(UInt32P(max(y, 0.f)), res - 2),
+            zi = math::find_interval(res, [&](UInt32P idx) {
+                     return gather<FloatP>(model->scale, idx) <= z;
+                 });
+
+    UInt32P offset = (((i * res + zi) * res + yi) * res + xi) * RGB2SPEC_N_COEFFS;
+    uint32_t dx = RGB2SPEC_N_COEFFS, dy = RGB2SPEC_N_COEFFS * res,
+             dz = RGB2SPEC_N_COEFFS * res * res;
+
+    FloatP scale_0 = gather<FloatP>(model->scale, zi),
+           scale_1 = gather<FloatP>(model->scale, zi + 1u);
+    FloatP x1 = x - FloatP(xi), x0 = 1.f - x1,
+           y1 = y - FloatP(yi), y0 = 1.f - y1,
+           z1 = (z - scale_0) / (scale_1 - scale_0), z0 = 1.f - z1;
+
+    auto lookup = [&](uint32_t o) {
+        return gather<FloatP>(model->data, offset + o, active);
+    };
+
+    for (uint32_t j = 0; j < RGB2SPEC_N_COEFFS; ++j) {
+        FloatP v0 = fmadd(fmadd(lookup(j), x0, lookup(j + dx) * x1), y0,
+                          fmadd(lookup(j + dy), x0, lookup(j + dy + dx) * x1) * y1),
+               v1 = fmadd(fmadd(lookup(j + dz), x0, lookup(j + dz + dx) * x1), y0,
+                          fmadd(lookup(j + dz + dy), x0, lookup(j + dz + dy + dx) * x1) * y1);
+        FloatP v = fmadd(v0, z0, v1 * z1);
+
+        if (j == RGB2SPEC_N_COEFFS - 1) {
+            masked(v, black) = -math::Infinity<float>;
+            masked(v, white) = math::Infinity<float>;
+        } else {
+            masked(v, black || white) = 0.f;
+        }
+        scatter(data, ValueP(v), index + j, active);
+    }
+}
+
+template <typename Value>
+static void srgb_model_fetch_impl(Value *data, size_t count) {
+    using FloatP = Packet<float>;
+    const RGB2Spec *model = srgb_model();
+    size_t packets = (count + FloatP::Size - 1) / FloatP::Size;
+
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, packets, 256),
+        [&](const tbb::blocked_range<size_t> &range) {
+            for (size_t i = range.begin(); i != range.end(); ++i)
+                srgb_model_fetch_packet(model, data, i * FloatP::Size, count);
+        }
+    );
+}
+
+void srgb_model_fetch(float *data, size_t count) {
+    srgb_model_fetch_impl(data, count);
+}
+
+void srgb_model_fetch(double *data, size_t count) {
+    srgb_model_fetch_impl(data, count);
+}
+
 #if 0
 Color<float, 3> srgb_model_eval_rgb(const Array<float, 3> &coeff) {
     using Array3f = Array<float, 3>;
@@ -28,3 +28,31 @@ def test02_bs_construct(variant_scalar_rgb):
     assert ek.allclose(bs.pdf, 0.0)
     assert ek.allclose(bs.eta, 1.0)
     assert bs.sampled_type == 0
+
+
+@pytest.mark.parametrize("bsdf_type", ["diffuse", "conductor", "roughconductor",
+                                       "plastic", "roughplastic"])
+def test03_eval_pdf_consistent(variant_scalar_rgb, bsdf_type):
+    from mitsuba.core import Frame3f
+    from mitsuba.render import BSDFContext, SurfaceInteraction3f
+    from mitsuba.core.xml import load_string
+
+    bsdf = load_string("<bsdf version='2.0.0' type='%s'></bsdf>" % bsdf_type)
+
+    si    = SurfaceInteraction3f()
+    si.p  = [0, 0, 0]
+    si.n  = [0, 0, 1]
+    si.wi = ek.normalize([0.3, -0.2, 1])
+    si.sh_frame = Frame3f(si.n)
+
+    ctx = BSDFContext()
+
+    # The fused query must match the separate eval() and pdf() calls
+    for i in range(20):
+        theta = i / 19.0 * (ek.pi / 2) - ek.pi / 4
+        wo = [ek.sin(theta), 0.1, ek.cos(theta)]
+        wo = ek.normalize(wo)
+
+        value, pdf = bsdf.eval_pdf(ctx, si, wo=wo)
+        assert ek.allclose(value, bsdf.eval(ctx, si, wo=wo))
+        assert ek.allclose(pdf, bsdf.pdf(ctx, si, wo=wo))
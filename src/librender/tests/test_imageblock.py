@@ -247,4 +247,206 @@ def test06_put_values_basic(variant_scalar_spectral):
             # we'll just add one sample right in the center of each pixel.
             im.put([j + 0.5, i + 0.5], wavelengths, spectrum, alpha=1.0)
 
-    check_value(im, ref, atol=1e-6)
\ No newline at end of file
+    check_value(im, ref, atol=1e-6)
+
+@pytest.mark.parametrize("rfilter_xml", [
+    '<rfilter version="2.0.0" type="box"/>',
+    '<rfilter version="2.0.0" type="box"><float name="radius" value="1.5"/></rfilter>',
+    '<rfilter version="2.0.0" type="tent"/>',
+    '<rfilter version="2.0.0" type="gaussian"/>',
+    '<rfilter version="2.0.0" type="lanczos"/>',
+    '<rfilter version="2.0.0" type="lanczos"><integer name="lobes" value="4"/></rfilter>'
+])
+@pytest.mark.parametrize("channel_count", [5, 13, 23])
+def test07_put_many_channels(variant_scalar_rgb, rfilter_xml, channel_count):
+    from mitsuba.core.xml import load_string
+    from mitsuba.render import ImageBlock
+
+    """The scalar splatting code is specialized for some footprints and
+    vectorized over the channels, compare it against a reference"""
+
+    rfilter = load_string(rfilter_xml)
+    size = [9, 7]
+    im = ImageBlock(size, channel_count, filter=rfilter, warn_negative=False)
+    im.clear()
+
+    np.random.seed(0)
+    border = im.border_size()
+    ref = np.zeros(shape=(im.height() + 2 * border, im.width() + 2 * border,
+                          channel_count))
+
+    radius = rfilter.radius()
+    for i in range(20):
+        position = np.random.uniform(size=(2,), low=-1, high=10)
+        values = np.random.uniform(size=(channel_count,), low=-1, high=1)
+        im.put(position, list(values))
+
+        if radius <= 0.5 + 1e-4:
+            p = np.ceil(position - 1 + border).astype(np.int)
+            if np.all(p >= 0) and np.all(p < ref.shape[1::-1]):
+                ref[p[1], p[0], :] += values
+            continue
+
+        pos = position - 0.5 + border
+        lo = np.ceil(pos - radius).astype(np.int)
+        hi = np.floor(pos + radius).astype(np.int)
+        for dy in range(lo[1], hi[1] + 1):
+            for dx in range(lo[0], hi[0] + 1):
+                if dx < 0 or dy < 0 or dx >= ref.shape[1] or dy >= ref.shape[0]:
+                    continue
+                weight = rfilter.eval_discretized(dx - pos[0]) * \
+                         rfilter.eval_discretized(dy - pos[1])
+                ref[dy, dx, :] += weight * values
+
+    check_value(im, ref, atol=1e-5)
+
+
+def test08_data_view(variant_scalar_rgb):
+    from mitsuba.render import ImageBlock
+    import numpy as np
+
+    im = ImageBlock([5, 4], 3, border=False)
+    view = im.data_view()
+    assert view.shape == (4, 5, 3)
+
+    # The view aliases the pixel buffer of the block
+    im.put([1.5, 2.5], [1.0, 2.0, 3.0])
+    assert np.allclose(view[2, 1], [1, 2, 3])
+    view[:] = 0
+    assert ek.allclose(im.data(), 0)
+
+
+def test09_deep_samples(variant_scalar_rgb):
+    from mitsuba.core.xml import load_string
+    from mitsuba.render import ImageBlock
+
+    rfilter = load_string("""<rfilter version="2.0.0" type="box"/>""")
+    im = ImageBlock([4, 3], 6, filter=rfilter, border=False)
+    im.set_deep_samples(2, 5, 0.01)
+    assert im.deep_samples() == 2
+    im.clear()
+
+    # (X, depth) of samples with unit alpha: the first two share a depth bin,
+    # and the last one forces the two closest records to be merged
+    for x, depth in [(1, 1.0), (2, 1.005), (3, 5.0), (4, 3.0)]:
+        im.put([1.5, 1.5], [x, 0, 0, 1, 1, depth])
+    # Samples without alpha are only counted
+    im.put([1.5, 1.5], [5, 0, 0, 0, 1, 2.0])
+
+    count, records = im.deep_pixel([1, 1])
+    assert count == 5
+    assert len(records) == 2
+    assert ek.allclose(records[0], [1.0025, 2, 3, 0, 0, 2])
+    assert ek.allclose(records[1], [4.0, 2, 7, 0, 0, 2])
+    assert im.deep_pixel([0, 0]) == (0, [])
+
+    # Merging blocks combines the records of matching depths
+    im2 = ImageBlock([4, 3], 6, filter=rfilter, border=False)
+    im2.set_deep_samples(2, 5, 0.01)
+    im2.clear()
+    im2.put(im)
+    im2.put(im)
+    count, records = im2.deep_pixel([1, 1])
+    assert count == 10
+    assert ek.allclose(records[0], [1.0025, 4, 6, 0, 0, 4])
+    assert ek.allclose(records[1], [4.0, 4, 14, 0, 0, 4])
+
+    with pytest.raises(RuntimeError):
+        im.set_deep_samples(2, 6)
+
+
+@pytest.mark.parametrize("rfilter_xml", [
+    '<rfilter version="2.0.0" type="box"/>',
+    '<rfilter version="2.0.0" type="gaussian"/>'
+])
+@pytest.mark.parametrize("tile_size", [0, 4])
+def test10_put_wavefront(variant_gpu_rgb, rfilter_xml, tile_size):
+    from mitsuba.core import Float, UInt32, Vector2f, PCG32
+    from mitsuba.core.xml import load_string
+    from mitsuba.render import ImageBlock
+
+    """Gathering a wavefront in pixel order must match the atomic splatting"""
+
+    rfilter = load_string(rfilter_xml)
+    size, spp, channel_count = [9, 7], 4, 5
+    count = size[0] * size[1] * spp
+
+    rng = PCG32(count)
+    im = ImageBlock(size, channel_count, filter=rfilter)
+    im.set_wavefront_tile_size(tile_size)
+    pixel = im.wavefront_pixel(ek.arange(UInt32, count) // spp)
+    pos = Vector2f(Float(pixel.x), Float(pixel.y))
+    pos += Vector2f(rng.next_float32(), rng.next_float32()) + [3, 2]
+    values = [rng.next_float32() for k in range(channel_count)]
+    active = rng.next_float32() < 0.9
+
+    result = []
+    for layout in [0, spp]:
+        im = ImageBlock(size, channel_count, filter=rfilter)
+        im.set_offset([3, 2])
+        im.set_wavefront_layout(layout)
+        im.set_wavefront_tile_size(tile_size)
+        im.clear()
+        im.put(pos, values, active)
+        result.append(np.array(im.data()))
+
+    assert ek.allclose(result[0], result[1], atol=1e-5)
+
+
+@pytest.mark.parametrize("rfilter_xml", [
+    '<rfilter version="2.0.0" type="tent"/>',
+    '<rfilter version="2.0.0" type="gaussian"/>',
+    '<rfilter version="2.0.0" type="box"><float name="radius" value="1.5"/></rfilter>',
+    '<rfilter version="2.0.0" type="gaussian"><float name="stddev" value="0.3"/></rfilter>'
+])
+def test11_put_normalized(variant_scalar_rgb, rfilter_xml):
+    from mitsuba.core.xml import load_string
+    from mitsuba.render import ImageBlock
+
+    """Normalized splats read precomputed weights for most filters, compare
+    them against normalized discretized filter evaluations"""
+
+    rfilter = load_string(rfilter_xml)
+    size, channel_count = [9, 7], 3
+    im = ImageBlock(size, channel_count, filter=rfilter, normalize=True)
+    im.clear()
+
+    np.random.seed(1)
+    border = im.border_size()
+    ref = np.zeros(shape=(im.height() + 2 * border, im.width() + 2 * border,
+                          channel_count))
+
+    radius = rfilter.radius()
+    for i in range(20):
+        position = np.random.uniform(size=(2,), low=1, high=6)
+        values = np.random.uniform(size=(channel_count,), low=0, high=1)
+        im.put(position, list(values))
+
+        pos = position - 0.5 + border
+        lo = np.ceil(pos - radius).astype(np.int)
+        hi = np.floor(pos + radius).astype(np.int)
+        wx = np.array([rfilter.eval_discretized(dx - pos[0]) for dx in range(lo[0], hi[0] + 1)])
+        wy = np.array([rfilter.eval_discretized(dy - pos[1]) for dy in range(lo[1], hi[1] + 1)])
+        weights = np.outer(wy, wx) / (np.sum(wx) * np.sum(wy))
+        ref[lo[1]:hi[1] + 1, lo[0]:hi[0] + 1, :] += weights[:, :, None] * values
+
+    check_value(im, ref, atol=1e-5)
+
+
+def test12_wavefront_tiles(variant_scalar_rgb):
+    from mitsuba.render import ImageBlock
+
+    # Tiles at the right and bottom edges are cropped
+    im = ImageBlock([10, 7], 3)
+    im.set_wavefront_tile_size(4)
+    pixels = [tuple(im.wavefront_pixel(i)) for i in range(70)]
+    assert sorted(pixels) == sorted((x, y) for x in range(10) for y in range(7))
+    assert pixels[:6] == [(0, 0), (1, 0), (2, 0), (3, 0), (0, 1), (1, 1)]
+    assert pixels[16] == (4, 0)
+    assert pixels[32:35] == [(8, 0), (9, 0), (8, 1)]
+    assert pixels[40] == (0, 4)
+    assert pixels[69] == (9, 6)
+
+    im.set_wavefront_tile_size(0)
+    assert [tuple(im.wavefront_pixel(i)) for i in range(12)] == \
+        [(x, 0) for x in range(10)] + [(0, 1), (1, 1)]
@@ -148,6 +148,365 @@ def test06_render_timeout(variants_cpu_rgb, int_name):
     assert ek.allclose(timeout, effective, atol=0.5)
 
 
+@pytest.mark.parametrize(*integrators)
+def test07_render_adaptive(variants_cpu_rgb, int_name):
+    from mitsuba.core import Bitmap, Struct
+
+    # Adaptive sampling retires converged pixels but must not bias the image
+    integrator = make_integrator(int_name, """
+        <integer name="samples_per_pass" value="4"/>
+        <float name="adaptive_threshold" value="0.05"/>
+    """)
+    scene = SCENES['teapot']['factory']()
+    sensor = scene.sensors()[0]
+    film = sensor.film()
+    assert integrator.render(scene, sensor)
+
+    integrator_type = {'direct': 'direct', 'depth': 'depth'}.get(int_name, 'full')
+    converted = film.bitmap(raw=True).convert(Bitmap.PixelFormat.RGBA, Struct.Type.Float32, False)
+    means = np.mean(np.array(converted, copy=False), axis=(0, 1))
+    assert ek.allclose(means, SCENES['teapot'][integrator_type], rtol=5e-2)
+
+    with pytest.raises(RuntimeError):
+        make_integrator(int_name, """<integer name="adaptive_min_passes" value="1"/>""")
+
+
+@pytest.mark.parametrize('scene_name', ['teapot', 'box'])
+def test08_render_wavefront(variants_cpu_rgb, scene_name):
+    from mitsuba.core import Bitmap, Struct
+
+    # The wavefront mode of the path tracer must match the reference averages
+    integrator = make_integrator('path', """<boolean name="wavefront" value="true"/>""")
+    scene = SCENES[scene_name]['factory']()
+    sensor = scene.sensors()[0]
+    film = sensor.film()
+    assert integrator.render(scene, sensor)
+
+    converted = film.bitmap(raw=True).convert(Bitmap.PixelFormat.RGBA, Struct.Type.Float32, False)
+    means = np.mean(np.array(converted, copy=False), axis=(0, 1))
+    assert ek.allclose(means, SCENES[scene_name]['full'], rtol=5e-2)
+
+
+@pytest.mark.parametrize('scene_name', ['teapot', 'box'])
+def test09_render_guided(variant_scalar_rgb, scene_name):
+    from mitsuba.core import Bitmap, Struct
+
+    # Path guiding changes the sampling density, but must not bias the image
+    integrator = make_integrator('guided_path', """
+        <integer name="samples_per_pass" value="4"/>
+        <integer name="spatial_threshold" value="1000"/>
+    """)
+    scene = SCENES[scene_name]['factory'](spp=16)
+    sensor = scene.sensors()[0]
+    film = sensor.film()
+    assert integrator.render(scene, sensor)
+
+    converted = film.bitmap(raw=True).convert(Bitmap.PixelFormat.RGBA, Struct.Type.Float32, False)
+    means = np.mean(np.array(converted, copy=False), axis=(0, 1))
+    assert ek.allclose(means, SCENES[scene_name]['full'], rtol=5e-2)
+
+    with pytest.raises(RuntimeError):
+        make_integrator('guided_path', """<float name="bsdf_sampling_fraction" value="0"/>""")
+
+
+def test10_render_checkpoint(variant_scalar_rgb, tmpdir):
+    import time
+    from mitsuba.core import Bitmap
+
+    # A render resumed from a checkpoint must match an uninterrupted render
+    def render(xml="", spp=4):
+        integrator = make_integrator('path', """
+            <integer name="samples_per_pass" value="1"/>""" + xml)
+        scene = SCENES['teapot']['factory'](spp=spp)
+        sensor = scene.sensors()[0]
+        assert integrator.render(scene, sensor)
+        return np.array(sensor.film().bitmap(raw=True), copy=False)
+
+    checkpoint_file = str(tmpdir.join('checkpoint.exr'))
+    ref = render()
+
+    img = render("""
+        <integer name="checkpoint_passes" value="1"/>
+        <string name="checkpoint_file" value="{}"/>""".format(checkpoint_file))
+    assert ek.allclose(img, ref, rtol=1e-5, atol=1e-5)
+
+    # Checkpoints are written asynchronously
+    for i in range(100):
+        if os.path.exists(checkpoint_file):
+            break
+        time.sleep(0.1)
+    checkpoint = Bitmap(checkpoint_file)
+    assert 1 <= checkpoint.metadata()['checkpoint_passes'] <= 3
+    assert checkpoint.metadata()['checkpoint_pass_count'] == 4
+
+    img = render("""
+        <boolean name="resume" value="true"/>
+        <string name="checkpoint_file" value="{}"/>""".format(checkpoint_file))
+    assert ek.allclose(img, ref, rtol=1e-5, atol=1e-5)
+
+    # The sample configuration must match
+    with pytest.raises(RuntimeError, match='different sample count'):
+        render("""
+            <boolean name="resume" value="true"/>
+            <string name="checkpoint_file" value="{}"/>""".format(checkpoint_file), spp=8)
+
+
+def test11_render_wavefront_budget(variant_gpu_rgb):
+    from mitsuba.core import Bitmap, Struct
+
+    # A tiny budget splits the frame into slabs and sample batches
+    integrator = make_integrator('path', """<integer name="wavefront_budget" value="1"/>""")
+    scene = SCENES['teapot']['factory'](spp=16)
+    sensor = scene.sensors()[0]
+    film = sensor.film()
+    assert integrator.render(scene, sensor)
+
+    converted = film.bitmap(raw=True).convert(Bitmap.PixelFormat.RGBA, Struct.Type.Float32, False)
+    means = np.mean(np.array(converted, copy=False), axis=(0, 1))
+    assert ek.allclose(means, SCENES['teapot']['full'], rtol=5e-2)
+
+
+def test12_render_pixel_seeds(variants_cpu_rgb):
+    # With per-pixel seeds, the image doesn't depend on the block size
+    def render(block_size):
+        integrator = make_integrator('path', """
+            <boolean name="pixel_seeds" value="true"/>
+            <integer name="samples_per_pass" value="2"/>
+            <integer name="block_size" value="{}"/>""".format(block_size))
+        scene = SCENES['teapot']['factory'](spp=4)
+        sensor = scene.sensors()[0]
+        assert integrator.render(scene, sensor)
+        return np.array(sensor.film().bitmap(raw=True), copy=False)
+
+    assert np.all(render(4) == render(16))
+
+
+@pytest.mark.parametrize('scene_name', ['teapot', 'box'])
+def test13_render_guided_adrrs(variant_scalar_rgb, scene_name):
+    from mitsuba.core import Bitmap, Struct
+
+    # Adjoint-driven Russian roulette and splitting must not bias the image
+    integrator = make_integrator('guided_path', """
+        <integer name="samples_per_pass" value="4"/>
+        <integer name="spatial_threshold" value="1000"/>
+        <boolean name="adrrs" value="true"/>
+    """)
+    scene = SCENES[scene_name]['factory'](spp=16)
+    sensor = scene.sensors()[0]
+    film = sensor.film()
+    assert integrator.render(scene, sensor)
+
+    converted = film.bitmap(raw=True).convert(Bitmap.PixelFormat.RGBA, Struct.Type.Float32, False)
+    means = np.mean(np.array(converted, copy=False), axis=(0, 1))
+    assert ek.allclose(means, SCENES[scene_name]['full'], rtol=5e-2)
+
+    with pytest.raises(RuntimeError):
+        make_integrator('guided_path', """<integer name="max_split" value="0"/>""")
+
+
+def test14_render_volpathmis_equiangular(variant_scalar_rgb):
+    from mitsuba.core import Bitmap, Struct
+    from mitsuba.core.xml import load_string
+
+    def render(equiangular):
+        scene = load_string("""
+            <scene version="2.0.0">
+                <integrator type="volpathmis">
+                    <integer name="max_depth" value="3"/>
+                    <boolean name="equiangular" value="{equiangular}"/>
+                    <integer name="equiangular_samples" value="4"/>
+                </integrator>
+                <sensor type="perspective">
+                    <transform name="to_world">
+                        <lookat origin="0, 0, 4" target="0, 0, 0" up="0, 1, 0"/>
+                    </transform>
+                    <film type="hdrfilm">
+                        <integer name="width" value="8"/>
+                        <integer name="height" value="8"/>
+                        <rfilter type="box"/>
+                    </film>
+                    <sampler type="independent">
+                        <integer name="sample_count" value="256"/>
+                    </sampler>
+                </sensor>
+                <emitter type="point">
+                    <point name="position" x="0.2" y="0.1" z="0.3"/>
+                    <spectrum name="intensity" value="1"/>
+                </emitter>
+                <shape type="sphere">
+                    <bsdf type="null"/>
+                    <medium name="interior" type="homogeneous">
+                        <float name="sigma_t" value="1"/>
+                        <float name="albedo" value="0.8"/>
+                    </medium>
+                </shape>
+            </scene>
+        """.format(equiangular='true' if equiangular else 'false'))
+        sensor = scene.sensors()[0]
+        assert scene.integrator().render(scene, sensor)
+        converted = sensor.film().bitmap(raw=True).convert(
+            Bitmap.PixelFormat.RGBA, Struct.Type.Float32, False)
+        return np.mean(np.array(converted, copy=False), axis=(0, 1))
+
+    # Equiangular sampling of the point light must converge to the same image
+    reference = render(False)
+    assert np.all(reference[:3] > 0)
+    assert ek.allclose(render(True)[:3], reference[:3], rtol=5e-2)
+
+    with pytest.raises(RuntimeError):
+        make_integrator('volpathmis', """<integer name="equiangular_samples" value="0"/>""")
+
+
+@pytest.mark.parametrize('scene_name', ['teapot', 'box'])
+def test15_render_bdpt(variant_scalar_rgb, scene_name):
+    from mitsuba.core import Bitmap, Struct
+
+    # Light tracing splats and MIS must converge to the path tracer's image
+    integrator = make_integrator('bdpt')
+    scene = SCENES[scene_name]['factory'](spp=16)
+    sensor = scene.sensors()[0]
+    assert integrator.render(scene, sensor)
+
+    converted = sensor.film().bitmap(raw=True).convert(
+        Bitmap.PixelFormat.RGBA, Struct.Type.Float32, False)
+    means = np.mean(np.array(converted, copy=False), axis=(0, 1))
+    assert ek.allclose(means, SCENES[scene_name]['full'], rtol=5e-2)
+
+    integrator = make_integrator('bdpt', """<float name="adaptive_threshold" value="0.1"/>""")
+    with pytest.raises(RuntimeError):
+        integrator.render(scene, sensor)
+
+
+def test16_render_sppm(variant_scalar_rgb):
+    from mitsuba.core import Bitmap, Struct
+
+    # The density estimates must approach the path tracer's image on average
+    integrator = make_integrator('sppm', """<integer name="photon_count" value="100000"/>""")
+    scene = SCENES['box']['factory'](spp=16)
+    sensor = scene.sensors()[0]
+    assert integrator.render(scene, sensor)
+
+    converted = sensor.film().bitmap(raw=True).convert(
+        Bitmap.PixelFormat.RGBA, Struct.Type.Float32, False)
+    means = np.mean(np.array(converted, copy=False), axis=(0, 1))
+    assert ek.allclose(means, SCENES['box']['full'], rtol=1e-1)
+
+    for param in ['<float name="alpha" value="1"/>',
+                  '<float name="initial_radius" value="-1"/>',
+                  '<integer name="photon_count" value="0"/>']:
+        with pytest.raises(RuntimeError):
+            make_integrator('sppm', param)
+
+
+def test17_render_primary_cache(variant_scalar_rgb):
+    # Reused primary hits must give the same image with fewer traced rays
+    def make(cache):
+        return make_integrator('path', """
+            <boolean name="pixel_seeds" value="true"/>
+            <integer name="samples_per_pass" value="2"/>
+            <boolean name="primary_cache" value="{}"/>""".format(cache))
+
+    scene = SCENES['teapot']['factory'](spp=4)
+    sensor = scene.sensors()[0]
+
+    def render(integrator):
+        assert integrator.render(scene, sensor)
+        return np.array(sensor.film().bitmap(raw=True), copy=False).copy(), \
+            scene.ray_statistics()['total']
+
+    reference, _ = render(make('false'))
+    integrator = make('true')
+    first, first_rays = render(integrator)
+    second, second_rays = render(integrator)
+    assert ek.allclose(first, reference, atol=1e-6)
+    assert np.all(second == first)
+    assert second_rays < first_rays
+
+    # Updating the geometry invalidates the cache
+    revision = scene.geometry_revision()
+    scene.update_geometry()
+    assert scene.geometry_revision() != revision
+    third, third_rays = render(integrator)
+    assert np.all(third == first)
+    assert third_rays == first_rays
+
+
+
+def test18_render_batch(variant_scalar_rgb, tmpdir):
+    from mitsuba.core.xml import load_string
+    from mitsuba.python.util import render_batch
+
+    sensor = """
+        <sensor type="perspective">
+            <film type="hdrfilm">
+                <integer name="width" value="4"/>
+                <integer name="height" value="4"/>
+                <rfilter type="box"/>
+            </film>
+            <sampler type="independent">
+                <integer name="sample_count" value="1"/>
+            </sampler>
+        </sensor>"""
+    scene = load_string("""
+        <scene version='2.0.0'>
+            <integrator type="path"/>
+            {0}{0}
+            <emitter type="constant" id="sky">
+                <spectrum name="radiance" value="1"/>
+            </emitter>
+        </scene>""".format(sensor))
+
+    # Two sensors, two parameter sets: the second one doubles the radiance
+    filename = os.path.join(str(tmpdir), 'frame_{update}_{sensor}.exr')
+    images = render_batch(scene, updates=[{}, {'sky.radiance.value': 2.0}],
+                          filename=filename)
+    assert len(images) == 4
+    values = [np.array(image, copy=False)[..., :3] for image in images]
+    assert ek.allclose(values[0], 1) and ek.allclose(values[1], 1)
+    assert ek.allclose(values[2], 2) and ek.allclose(values[3], 2)
+
+    images = render_batch(scene, sensors=[1])
+    assert len(images) == 1 and ek.allclose(np.array(images[0], copy=False)[..., :3], 2)
+
+    # The images are written asynchronously
+    import time
+    files = [filename.format(update=u, sensor=s) for u in range(2) for s in range(2)]
+    for i in range(100):
+        if all(os.path.exists(f) for f in files):
+            break
+        time.sleep(0.05)
+    assert all(os.path.exists(f) for f in files)
+
+
+def test19_render_heatmap(variant_scalar_rgb, tmpdir):
+    from mitsuba.core import Bitmap
+
+    filename = os.path.join(str(tmpdir), 'heatmap.exr')
+    integrator = make_integrator('path', """
+        <boolean name="heatmap" value="true"/>
+        <string name="heatmap_file" value="{}"/>
+        <integer name="block_size" value="8"/>
+        <integer name="samples_per_pass" value="2"/>""".format(filename))
+    assert integrator.heatmap() is None
+
+    scene = SCENES['teapot']['factory'](spp=4)
+    sensor = scene.sensors()[0]
+    assert integrator.render(scene, sensor)
+
+    heatmap = integrator.heatmap()
+    size = sensor.film().crop_size()
+    assert heatmap.width() == size[0] and heatmap.height() == size[1]
+    assert heatmap.channel_count() == 1
+    values = np.array(heatmap, copy=False)
+    assert np.all(values >= 0) and np.sum(values) > 0
+    assert os.path.exists(filename)
+
+    # Disabled by default
+    integrator = make_integrator('path')
+    assert integrator.render(scene, sensor)
+    assert integrator.heatmap() is None
+
+
 def make_reference_renders():
     mitsuba.set_variant('scalar_rgb')
     from mitsuba.core import Bitmap, Struct
@@ -191,3 +550,306 @@ def make_reference_renders():
 
 if __name__ == '__main__':
     make_reference_renders()
+
+
+def test20_progressive_renderer(variant_scalar_rgb):
+    from mitsuba.core.xml import load_string
+    from mitsuba.render import ProgressiveRenderer
+    from mitsuba.python.util import traverse
+
+    scene = load_string("""
+        <scene version='2.0.0'>
+            <integrator type="path"/>
+            <sensor type="perspective">
+                <film type="hdrfilm">
+                    <integer name="width" value="8"/>
+                    <integer name="height" value="8"/>
+                    <rfilter type="box"/>
+                </film>
+                <sampler type="independent">
+                    <integer name="sample_count" value="1"/>
+                </sampler>
+            </sensor>
+            <emitter type="constant" id="sky">
+                <spectrum name="radiance" value="1"/>
+            </emitter>
+        </scene>""")
+
+    renderer = ProgressiveRenderer(scene)
+    assert renderer.bitmap() is None and renderer.pass_count() == 0
+    for i in range(3):
+        assert renderer.render_pass()
+    assert renderer.pass_count() == 3
+    assert ek.allclose(np.array(renderer.bitmap(), copy=False)[..., :3], 1)
+
+    # Edit the scene without reloading it and restart the accumulation
+    params = traverse(scene)
+    params['sky.radiance.value'] = 2.0
+    params.update()
+    renderer.restart()
+    assert renderer.pass_count() == 0
+    assert renderer.render_pass()
+    assert renderer.pass_count() == 1
+    assert ek.allclose(np.array(renderer.bitmap(), copy=False)[..., :3], 2)
+
+    # The sampler seed is restored after every pass
+    assert scene.sensors()[0].sampler().base_seed() == 0
+
+
+def test21_render_volpath_nested_homogeneous(variant_scalar_rgb):
+    from mitsuba.core import Bitmap, Struct
+    from mitsuba.core.xml import load_string
+
+    def render(integrator):
+        scene = load_string("""
+            <scene version="2.0.0">
+                <integrator type="{integrator}">
+                    <integer name="max_depth" value="3"/>
+                </integrator>
+                <sensor type="perspective">
+                    <transform name="to_world">
+                        <lookat origin="0, 0, 4" target="0, 0, 0" up="0, 1, 0"/>
+                    </transform>
+                    <film type="hdrfilm">
+                        <integer name="width" value="8"/>
+                        <integer name="height" value="8"/>
+                        <rfilter type="box"/>
+                    </film>
+                    <sampler type="independent">
+                        <integer name="sample_count" value="256"/>
+                    </sampler>
+                </sensor>
+                <emitter type="point">
+                    <point name="position" x="0.2" y="0.1" z="0.3"/>
+                    <spectrum name="intensity" value="1"/>
+                </emitter>
+                <medium type="homogeneous" id="outer">
+                    <float name="sigma_t" value="1"/>
+                    <float name="albedo" value="0.8"/>
+                </medium>
+                <shape type="sphere">
+                    <bsdf type="null"/>
+                    <ref name="interior" id="outer"/>
+                </shape>
+                <shape type="sphere">
+                    <float name="radius" value="0.5"/>
+                    <bsdf type="null"/>
+                    <ref name="exterior" id="outer"/>
+                    <medium name="interior" type="homogeneous">
+                        <rgb name="sigma_t" value="2, 3, 4"/>
+                        <float name="albedo" value="0.5"/>
+                    </medium>
+                </shape>
+            </scene>
+        """.format(integrator=integrator))
+        sensor = scene.sensors()[0]
+        assert scene.integrator().render(scene, sensor)
+        converted = sensor.film().bitmap(raw=True).convert(
+            Bitmap.PixelFormat.RGBA, Struct.Type.Float32, False)
+        return np.mean(np.array(converted, copy=False), axis=(0, 1))
+
+    # Closed-form shadow ray transmittance through nested media must match
+    # the ratio tracking estimates of the MIS volumetric path tracer
+    reference = render('volpathmis')
+    assert np.all(reference[:3] > 0)
+    assert ek.allclose(render('volpath')[:3], reference[:3], rtol=5e-2)
+
+
+def test22_render_volpath_spectral_mis(variant_scalar_rgb):
+    from mitsuba.core import Bitmap, Struct
+    from mitsuba.core.xml import load_string
+
+    def render(integrator):
+        scene = load_string("""
+            <scene version="2.0.0">
+                {integrator}
+                <sensor type="perspective">
+                    <transform name="to_world">
+                        <lookat origin="0, 0, 4" target="0, 0, 0" up="0, 1, 0"/>
+                    </transform>
+                    <film type="hdrfilm">
+                        <integer name="width" value="8"/>
+                        <integer name="height" value="8"/>
+                        <rfilter type="box"/>
+                    </film>
+                    <sampler type="independent">
+                        <integer name="sample_count" value="256"/>
+                    </sampler>
+                </sensor>
+                <emitter type="constant"/>
+                <shape type="sphere">
+                    <bsdf type="null"/>
+                    <medium name="interior" type="homogeneous">
+                        <rgb name="sigma_t" value="0.5, 2, 8"/>
+                        <float name="albedo" value="0.9"/>
+                    </medium>
+                </shape>
+            </scene>
+        """.format(integrator=integrator))
+        sensor = scene.sensors()[0]
+        assert scene.integrator().render(scene, sensor)
+        converted = sensor.film().bitmap(raw=True).convert(
+            Bitmap.PixelFormat.RGBA, Struct.Type.Float32, False)
+        return np.mean(np.array(converted, copy=False), axis=(0, 1))
+
+    # Chromatic extinction: the one-sample spectral MIS weights must converge
+    # to the same image as the full spectral MIS of volpathmis
+    reference = render('<integrator type="volpathmis"><integer name="max_depth" value="4"/></integrator>')
+    mis = render('<integrator type="volpath"><integer name="max_depth" value="4"/></integrator>')
+    assert np.all(reference[:3] > 0)
+    assert ek.allclose(mis[:3], reference[:3], rtol=5e-2)
+
+    integrator = make_integrator('volpath', """<boolean name="use_spectral_mis" value="false"/>""")
+    assert 'use_spectral_mis = 0' in str(integrator)
+
+
+@pytest.mark.parametrize('int_name', ['direct', 'path'])
+def test23_render_shadow_batch(variant_scalar_rgb, int_name):
+    # Deferred shadow rays must not change the image, only how they are traced
+    scene = SCENES['teapot']['factory'](spp=4)
+    sensor = scene.sensors()[0]
+
+    def render(batch):
+        integrator = make_integrator(int_name, """
+            <integer name="shadow_batch" value="{}"/>""".format(batch))
+        assert integrator.render(scene, sensor)
+        return np.array(sensor.film().bitmap(raw=True), copy=False).copy(), \
+            scene.ray_statistics()['shadow']
+
+    reference, reference_stats = render(0)
+    for batch in [1, 7, 1024]:
+        image, stats = render(batch)
+        assert ek.allclose(image, reference, atol=1e-5)
+        assert stats['rays'] == reference_stats['rays']
+        if batch > 1:
+            assert stats['queries'] < stats['rays']
+
+
+@pytest.mark.parametrize('int_name', ['direct', 'path'])
+def test24_render_ris_candidates(variant_scalar_rgb, int_name):
+    from mitsuba.core import Bitmap, Struct
+    from mitsuba.core.xml import load_string
+
+    emitters = ''.join("""
+        <emitter type="point">
+            <point name="position" x="{x}" y="{y}" z="1"/>
+            <spectrum name="intensity" value="{i}"/>
+        </emitter>""".format(x=x, y=y, i=0.5 + (x + y) % 1)
+        for x in [-1, 0, 1] for y in [-1, 0, 1])
+
+    def render(candidates):
+        scene = load_string("""
+            <scene version="2.0.0">
+                <integrator type="{int_name}">
+                    <integer name="ris_candidates" value="{candidates}"/>
+                </integrator>
+                <sensor type="perspective">
+                    <transform name="to_world">
+                        <lookat origin="0, 0, 4" target="0, 0, 0" up="0, 1, 0"/>
+                    </transform>
+                    <film type="hdrfilm">
+                        <integer name="width" value="8"/>
+                        <integer name="height" value="8"/>
+                        <rfilter type="box"/>
+                    </film>
+                    <sampler type="independent">
+                        <integer name="sample_count" value="256"/>
+                    </sampler>
+                </sensor>
+                {emitters}
+                <shape type="sphere">
+                    <point name="center" x="0" y="0" z="1.5"/>
+                    <float name="radius" value="0.2"/>
+                    <emitter type="area">
+                        <spectrum name="radiance" value="2"/>
+                    </emitter>
+                </shape>
+                <shape type="rectangle">
+                    <transform name="to_world">
+                        <scale value="2"/>
+                    </transform>
+                    <bsdf type="roughconductor"/>
+                </shape>
+            </scene>
+        """.format(int_name=int_name, candidates=candidates, emitters=emitters))
+        sensor = scene.sensors()[0]
+        assert scene.integrator().render(scene, sensor)
+        converted = sensor.film().bitmap(raw=True).convert(
+            Bitmap.PixelFormat.RGBA, Struct.Type.Float32, False)
+        return np.mean(np.array(converted, copy=False), axis=(0, 1))
+
+    # Resampling the emitter candidates changes the noise, but not the expected value
+    reference = render(1)
+    assert np.all(reference[:3] > 0)
+    assert ek.allclose(render(8)[:3], reference[:3], rtol=5e-2)
+
+    with pytest.raises(RuntimeError):
+        make_integrator(int_name, """<integer name="ris_candidates" value="0"/>""")
+
+
+def test25_render_radiance_cache(variant_scalar_rgb):
+    from mitsuba.core import Bitmap, Struct
+
+    # Terminating diffuse paths into the cache trades a small bias for fewer rays
+    def render(int_name, xml=''):
+        integrator = make_integrator(int_name, """
+            <integer name="samples_per_pass" value="4"/>""" + xml)
+        scene = SCENES['box']['factory'](spp=16)
+        sensor = scene.sensors()[0]
+        assert integrator.render(scene, sensor)
+        converted = sensor.film().bitmap(raw=True).convert(
+            Bitmap.PixelFormat.RGBA, Struct.Type.Float32, False)
+        return np.mean(np.array(converted, copy=False), axis=(0, 1)), \
+            scene.ray_statistics()['total']
+
+    means, rays = render('radiance_cache', """<integer name="min_samples" value="4"/>""")
+    path_means, path_rays = render('path')
+    assert ek.allclose(means, SCENES['box']['full'], rtol=1e-1)
+    assert rays < path_rays
+
+    integrator = make_integrator('radiance_cache', """<integer name="cache_size" value="1000"/>""")
+    assert 'cache_size = 1024' in str(integrator)
+
+    for param in ['<float name="cell_size" value="-1"/>',
+                  '<integer name="cache_depth" value="0"/>']:
+        with pytest.raises(RuntimeError):
+            make_integrator('radiance_cache', param)
+
+
+def test26_render_polarized_depolarizing(variant_scalar_mono_polarized):
+    from mitsuba.core import Bitmap, Struct
+
+    # Paths through diffuse surfaces only track the intensity of their throughput
+    # in polarized variants, which must match the unpolarized variant
+    def render():
+        scene = SCENES['box']['factory'](spp=16)
+        sensor = scene.sensors()[0]
+        assert scene.integrator().render(scene, sensor)
+        converted = sensor.film().bitmap(raw=True).convert(
+            Bitmap.PixelFormat.RGBA, Struct.Type.Float32, False)
+        return np.mean(np.array(converted, copy=False), axis=(0, 1))
+
+    polarized = render()
+    mitsuba.set_variant('scalar_mono')
+    assert ek.allclose(polarized, render(), rtol=1e-2)
+
+
+def test27_render_error_target(variant_scalar_rgb):
+    # The render stops after the first pass that meets the error target
+    def render(target):
+        integrator = make_integrator('path', """
+            <integer name="samples_per_pass" value="4"/>
+            <float name="error_target" value="{}"/>""".format(target))
+        scene = SCENES['teapot']['factory'](spp=64)
+        sensor = scene.sensors()[0]
+        assert integrator.render(scene, sensor)
+        return sensor.film().bitmap().metadata()
+
+    metadata = render(1e-6)
+    assert metadata['render_spp'] == 64
+    error = metadata['render_relative_rmse']
+    assert error > 0
+
+    metadata = render(error * 2)
+    assert 16 <= metadata['render_spp'] < 64
+    assert 0 < metadata['render_relative_rmse'] <= error * 2
@@ -131,3 +131,234 @@ def test03_depth_packet_stairs(variant_packet_rgb):
     # TODO: spot-check (here, we only check consistency)
     assert ek.all(res_shadow == res.is_valid())
     compare_results(res_naive, res, atol=1e-6)
+
+
+@fresolver_append_path
+def test04_bvh_scalar_bunny(variant_scalar_rgb):
+    from mitsuba.core import Ray3f
+    from mitsuba.core.xml import load_string
+
+    if mitsuba.core.MTS_ENABLE_EMBREE:
+        pytest.skip("EMBREE enabled")
+
+    scenes = [load_string("""
+        <scene version="0.5.0">
+            <string name="accel" value="%s"/>
+            <shape type="ply">
+                <string name="filename" value="resources/data/common/meshes/bunny_lowres.ply"/>
+            </shape>
+        </scene>
+    """ % accel) for accel in ['kdtree', 'bvh']]
+    b = scenes[0].bbox()
+
+    n = 50
+    inv_n = 1.0 / (n - 1)
+    wavelengths = []
+
+    for x in range(n):
+        for y in range(n):
+            o = [b.min[0] * (1 - x * inv_n) + b.max[0] * x * inv_n,
+                 b.min[1] * (1 - y * inv_n) + b.max[1] * y * inv_n,
+                 b.min[2] - 1]
+            d = [0.1, -0.1, 1]
+            r = Ray3f(o, d, 0.5, wavelengths)
+            r.mint = 0
+            r.maxt = 100
+
+            res_kdtree = scenes[0].ray_intersect(r)
+            res_bvh    = scenes[1].ray_intersect(r)
+            res_shadow = scenes[1].ray_test(r)
+            assert ek.all(res_shadow == res_bvh.is_valid())
+            compare_results(res_kdtree, res_bvh, atol=1e-6)
+
+
+def test05_bvh_packet_stairs(variant_packet_rgb):
+    from mitsuba.core import Ray3f as Ray3fX, Properties
+    from mitsuba.render import Scene
+
+    if mitsuba.core.MTS_ENABLE_EMBREE:
+        pytest.skip("EMBREE enabled")
+
+    props = Properties("scene")
+    props["_unnamed_0"] = create_stairs(11)
+    props["accel"] = "bvh"
+    scene = Scene(props)
+
+    mitsuba.set_variant("scalar_rgb")
+    from mitsuba.core import Ray3f, Vector3f
+
+    n = 4
+    inv_n = 1.0 / (n - 1)
+    rays = Ray3fX.zero(n * n)
+    d = [0, 0, -1]
+    wavelengths = []
+
+    for x in range(n):
+        for y in range(n):
+            o = Vector3f(x * inv_n, y * inv_n, 2)
+            o = o * 0.999 + 0.0005
+            rays[x * n + y] = Ray3f(o, d, 0, 100, 0.5, wavelengths)
+
+    res_naive  = scene.ray_intersect_naive(rays)
+    res        = scene.ray_intersect(rays)
+    res_shadow = scene.ray_test(rays)
+
+    assert ek.all(res_shadow == res.is_valid())
+    compare_results(res_naive, res, atol=1e-6)
+
+
+def test06_kdtree_cache(variant_scalar_rgb, tmpdir):
+    from mitsuba.core import Ray3f, Properties
+    from mitsuba.render import Scene
+    import os
+
+    if mitsuba.core.MTS_ENABLE_EMBREE:
+        pytest.skip("EMBREE enabled")
+
+    cache_dir = str(tmpdir.join('kdtree_cache'))
+
+    def make_scene(shared=False):
+        props = Properties("scene")
+        props["_unnamed_0"] = create_stairs(20)
+        props["kd_cache_dir"] = cache_dir
+        props["kd_cache_shared"] = shared
+        return Scene(props)
+
+    scene_a = make_scene()
+    files = os.listdir(cache_dir)
+    assert len(files) == 1 and files[0].endswith('.kdtree')
+    mtime = os.path.getmtime(os.path.join(cache_dir, files[0]))
+
+    # The second scene must be loaded from the cache, the third one maps it
+    scene_b = make_scene()
+    scene_c = make_scene(shared=True)
+    assert os.listdir(cache_dir) == files
+    assert os.path.getmtime(os.path.join(cache_dir, files[0])) == mtime
+
+    n = 32
+    inv_n = 1.0 / (n - 1)
+    for x in range(n):
+        for y in range(n):
+            r = Ray3f([x * inv_n, y * inv_n, 2], [0, 0, -1], 0.5, [])
+            r.mint = 0
+            r.maxt = 100
+            compare_results(scene_a.ray_intersect(r), scene_b.ray_intersect(r))
+            compare_results(scene_a.ray_intersect(r), scene_c.ray_intersect(r))
+
+    # Different geometry must not reuse the cached tree
+    props = Properties("scene")
+    props["_unnamed_0"] = create_stairs(21)
+    props["kd_cache_dir"] = cache_dir
+    Scene(props)
+    assert len(os.listdir(cache_dir)) == 2
+
+
+@fresolver_append_path
+@pytest.mark.parametrize("packets", [True, False])
+def test07_triangle_packets(variant_scalar_rgb, packets):
+    from mitsuba.core import Ray3f, warp
+    from mitsuba.core.xml import load_string
+    import numpy as np
+
+    if mitsuba.core.MTS_ENABLE_EMBREE:
+        pytest.skip("EMBREE enabled")
+
+    # Leaves that mix triangles and other shapes
+    scene = load_string("""
+        <scene version="0.5.0">
+            <boolean name="kd_triangle_packets" value="%s"/>
+            <shape type="ply">
+                <string name="filename" value="resources/data/common/meshes/bunny_lowres.ply"/>
+            </shape>
+            <shape type="sphere">
+                <float name="radius" value="0.02"/>
+            </shape>
+        </scene>
+    """ % ('true' if packets else 'false'))
+    c = scene.bbox().center()
+    np.random.seed(0)
+
+    for i in range(1000):
+        d = warp.square_to_uniform_sphere(np.random.rand(2))
+        r = Ray3f(c - d, d, 0.5, [])
+        r.mint = 0
+        r.maxt = 100
+
+        res_naive = scene.ray_intersect_naive(r)
+        res = scene.ray_intersect(r)
+        assert ek.all(scene.ray_test(r) == res_naive.is_valid())
+        compare_results(res_naive, res, atol=1e-5)
+        if res.is_valid():
+            assert res.shape == res_naive.shape
+            assert res.prim_index == res_naive.prim_index
+
+
+@fresolver_append_path
+@pytest.mark.parametrize("split_packets", [True, False])
+def test08_packet_octants(variant_packet_rgb, split_packets):
+    from mitsuba.core import Ray3f, Vector3f
+    from mitsuba.core.xml import load_string
+    import numpy as np
+
+    if mitsuba.core.MTS_ENABLE_EMBREE:
+        pytest.skip("EMBREE enabled")
+
+    scene = load_string("""
+        <scene version="0.5.0">
+            <boolean name="kd_split_packets" value="%s"/>
+            <shape type="ply">
+                <string name="filename" value="resources/data/common/meshes/bunny_lowres.ply"/>
+            </shape>
+        </scene>
+    """ % ('true' if split_packets else 'false'))
+
+    # Incoherent rays (all octants), some of them parallel to an axis
+    np.random.seed(0)
+    n = 1024
+    d = np.random.normal(size=(n, 3))
+    d[0::7, 0] = 0
+    d /= np.linalg.norm(d, axis=1)[:, None]
+    d = Vector3f(d)
+    rays = Ray3f(scene.bbox().center() - d, d, 0.5, [])
+    rays.mint = 0
+    rays.maxt = 100
+
+    res_naive  = scene.ray_intersect_naive(rays)
+    res        = scene.ray_intersect(rays)
+    res_shadow = scene.ray_test(rays)
+
+    assert ek.all(res_shadow == res_naive.is_valid())
+    compare_results(res_naive, res, atol=1e-5)
+
+
+@fresolver_append_path
+def test09_max_duplication(variant_scalar_rgb):
+    from mitsuba.core import Ray3f
+    from mitsuba.core.xml import load_string
+    import numpy as np
+
+    if mitsuba.core.MTS_ENABLE_EMBREE:
+        pytest.skip("EMBREE enabled")
+
+    # No primitive duplication at all, the tree must still be correct
+    scene = load_string("""
+        <scene version="0.5.0">
+            <float name="kd_max_duplication" value="1"/>
+            <shape type="ply">
+                <string name="filename" value="resources/data/common/meshes/bunny_lowres.ply"/>
+            </shape>
+        </scene>
+    """)
+    c = scene.bbox().center()
+    np.random.seed(0)
+
+    for i in range(500):
+        d = np.random.normal(size=3)
+        d /= np.linalg.norm(d)
+        r = Ray3f(c - d, d, 0.5, [])
+        r.mint = 0
+        r.maxt = 100
+
+        res_naive = scene.ray_intersect_naive(r)
+        assert ek.all(scene.ray_test(r) == res_naive.is_valid())
+        compare_results(res_naive, scene.ray_intersect(r), atol=1e-5)
@@ -648,3 +648,413 @@ def test16_differentiable_surface_interaction_params_backward(variant_gpu_autodi
     assert ek.allclose(ek.gradient(params[vertex_texcoords_key]),
                        [0, 2, 0, 0, 0, 0, 0, -2], atol=1e-5)
 
+
+
+@fresolver_append_path
+def test17_compressed_mesh(variant_scalar_rgb):
+    from mitsuba.core import Ray3f
+    from mitsuba.core.xml import load_string
+
+    if mitsuba.core.MTS_ENABLE_EMBREE:
+        pytest.skip("EMBREE enabled")
+
+    scenes = [load_string("""
+        <scene version="2.0.0">
+            <shape type="ply">
+                <string name="filename" value="resources/data/common/meshes/bunny_lowres.ply"/>
+                <boolean name="compress" value="%s"/>
+            </shape>
+        </scene>
+    """ % compress) for compress in ['false', 'true']]
+
+    meshes = [s.shapes()[0] for s in scenes]
+    assert not meshes[0].is_compressed()
+    assert meshes[1].is_compressed()
+    assert meshes[1].has_vertex_normals()
+    assert meshes[0].face_count() == meshes[1].face_count()
+    assert ek.allclose(meshes[0].bbox().min, meshes[1].bbox().min, atol=1e-5)
+    assert ek.allclose(meshes[0].bbox().max, meshes[1].bbox().max, atol=1e-5)
+
+    b = scenes[0].bbox()
+    n = 20
+    inv_n = 1.0 / (n - 1)
+    for x in range(n):
+        for y in range(n):
+            o = [b.min[0] * (1 - x * inv_n) + b.max[0] * x * inv_n,
+                 b.min[1] * (1 - y * inv_n) + b.max[1] * y * inv_n,
+                 b.min[2] - 1]
+            r = Ray3f(o, [0, 0, 1], 0.5, [])
+            si_ref = scenes[0].ray_intersect(r)
+            si = scenes[1].ray_intersect(r)
+            if not si_ref.is_valid() or not si.is_valid():
+                continue
+            assert ek.allclose(si_ref.p, si.p, atol=1e-4)
+            assert ek.allclose(si_ref.sh_frame.n, si.sh_frame.n, atol=1e-3)
+
+    with pytest.raises(RuntimeError):
+        meshes[1].write_ply("unused.ply")
+
+
+def test18_ply_parallel_roundtrip(variant_scalar_rgb, tmpdir):
+    from mitsuba.core.xml import load_string
+    from mitsuba.render import Mesh
+    import numpy as np
+
+    # Large enough to be split into several packets by the PLY loader
+    n_vertices, n_faces = 5000, 7000
+    rng = np.random.RandomState(0)
+    positions = rng.uniform(-1, 1, n_vertices * 3).astype(np.float32)
+    faces = rng.randint(0, n_vertices, n_faces * 3).astype(np.uint32)
+
+    m = Mesh("MyMesh", n_vertices, n_faces, has_vertex_texcoords=True)
+    m.vertex_positions_buffer()[:] = positions
+    m.vertex_texcoords_buffer()[:] = rng.uniform(0, 1, n_vertices * 2).astype(np.float32)
+    m.faces_buffer()[:] = faces
+    m.parameters_changed()
+
+    filename = str(tmpdir.join('roundtrip.ply'))
+    m.write_ply(filename)
+
+    m2 = load_string("""
+        <shape type="ply" version="2.0.0">
+            <string name="filename" value="%s"/>
+            <boolean name="face_normals" value="true"/>
+        </shape>
+    """ % filename)
+
+    assert m2.vertex_count() == n_vertices
+    assert m2.face_count() == n_faces
+    assert ek.allclose(m2.vertex_positions_buffer(), m.vertex_positions_buffer())
+    assert ek.allclose(m2.vertex_texcoords_buffer(), m.vertex_texcoords_buffer())
+    assert ek.all(m2.faces_buffer() == m.faces_buffer())
+    assert ek.allclose(m2.bbox().min, m.bbox().min)
+    assert ek.allclose(m2.bbox().max, m.bbox().max)
+
+
+def test19_obj_parallel_parse(variant_scalar_rgb, tmpdir):
+    from mitsuba.core.xml import load_string
+    import numpy as np
+
+    # Grid of quads, large enough to be split into several chunks
+    n = 400
+    lines = []
+    for y in range(n):
+        for x in range(n):
+            lines.append('v %f %f 0' % (x, y))
+    lines.append('vt 0 0')
+    lines.append('vt 1 1')
+    expected_keys = []
+    for y in range(n - 1):
+        for x in range(n - 1):
+            i = y * n + x + 1
+            # Every other row uses a different texture coordinate
+            t = 1 + (y % 2)
+            quad = [(i, t), (i + 1, t), (i + n + 1, t), (i + n, t)]
+            lines.append('f ' + ' '.join('%i/%i' % k for k in quad))
+            expected_keys += [quad[0], quad[1], quad[2], quad[0], quad[2], quad[3]]
+
+    filename = str(tmpdir.join('grid.obj'))
+    with open(filename, 'w') as f:
+        f.write('\n'.join(lines) + '\n')
+    assert len(open(filename).read()) > 2 * 1024 * 1024
+
+    m = load_string("""
+        <shape type="obj" version="2.0.0">
+            <string name="filename" value="%s"/>
+            <boolean name="face_normals" value="true"/>
+        </shape>
+    """ % filename)
+
+    # IDs must be assigned in the order of first use
+    ids = {}
+    for key in expected_keys:
+        if key not in ids:
+            ids[key] = len(ids)
+
+    assert m.vertex_count() == len(ids)
+    assert m.face_count() == len(expected_keys) // 3
+
+    faces = np.array(m.faces_buffer())
+    assert np.all(faces == np.array([ids[k] for k in expected_keys]))
+
+    positions = np.array(m.vertex_positions_buffer()).reshape(-1, 3)
+    texcoords = np.array(m.vertex_texcoords_buffer()).reshape(-1, 2)
+    for (v, t), idx in list(ids.items())[::997]:
+        assert np.allclose(positions[idx], [(v - 1) % n, (v - 1) // n, 0])
+        assert np.allclose(texcoords[idx], [t - 1, 1 - (t - 1)])
+
+
+def test20_serialized_multiple_shapes(variant_scalar_rgb, tmpdir):
+    from mitsuba.core.xml import load_string
+    import numpy as np
+    import struct
+    import zlib
+
+    # Write a version 4 file with two meshes and an end-of-file dictionary
+    meshes = [
+        (np.array([0, 0, 0, 1, 0, 0, 0, 1, 0], dtype=np.float32),
+         np.array([0, 1, 2], dtype=np.uint32)),
+        (np.array([0, 0, 1, 2, 0, 1, 0, 2, 1, 2, 2, 1], dtype=np.float32),
+         np.array([0, 1, 2, 1, 3, 2], dtype=np.uint32))
+    ]
+
+    data, offsets = b'', []
+    for i, (positions, faces) in enumerate(meshes):
+        payload = struct.pack('<I', 0x1000) + b'mesh%i\0' % i + \
+            struct.pack('<QQ', len(positions) // 3, len(faces) // 3) + \
+            positions.tobytes() + faces.tobytes()
+        offsets.append(len(data))
+        data += struct.pack('<hh', 0x041C, 4) + zlib.compress(payload)
+    data += struct.pack('<%iQI' % len(offsets), *offsets, len(offsets))
+
+    filename = str(tmpdir.join('multi.serialized'))
+    with open(filename, 'wb') as f:
+        f.write(data)
+
+    def load(index):
+        return load_string("""
+            <shape type="serialized" version="2.0.0">
+                <string name="filename" value="%s"/>
+                <integer name="shape_index" value="%i"/>
+                <boolean name="face_normals" value="true"/>
+            </shape>
+        """ % (filename, index))
+
+    for index in [1, 0, 1]:
+        m = load(index)
+        positions, faces = meshes[index]
+        assert m.vertex_count() == len(positions) // 3
+        assert ek.allclose(m.vertex_positions_buffer(), positions)
+        assert ek.all(m.faces_buffer() == faces)
+
+    with pytest.raises(Exception):
+        load(2)
+
+
+def test21_serialized_block_compression(variant_scalar_rgb, tmpdir):
+    from mitsuba.core.xml import load_string
+    import numpy as np
+    import struct
+    import zlib
+
+    n = 1000
+    positions = np.random.RandomState(0).uniform(-1, 1, n * 3).astype(np.float32)
+    faces = np.arange(n - n % 3, dtype=np.uint32)
+    payload = struct.pack('<I', 0x1000) + b'blocks\0' + \
+        struct.pack('<QQ', n, len(faces) // 3) + positions.tobytes() + faces.tobytes()
+
+    # Version 5: the payload is split into independently compressed blocks
+    block_size = 1024
+    blocks = [zlib.compress(payload[i:i + block_size])
+              for i in range(0, len(payload), block_size)]
+    data = struct.pack('<hh', 0x041C, 5) + \
+        struct.pack('<IIQQ', 1, len(blocks), len(payload), block_size) + \
+        struct.pack('<%iQ' % len(blocks), *[len(b) for b in blocks]) + b''.join(blocks)
+    data += struct.pack('<QI', 0, 1)
+
+    filename = str(tmpdir.join('blocks.serialized'))
+    with open(filename, 'wb') as f:
+        f.write(data)
+
+    m = load_string("""
+        <shape type="serialized" version="2.0.0">
+            <string name="filename" value="%s"/>
+            <boolean name="face_normals" value="true"/>
+        </shape>
+    """ % filename)
+
+    assert m.vertex_count() == n
+    assert ek.allclose(m.vertex_positions_buffer(), positions)
+    assert ek.all(m.faces_buffer() == faces)
+
+
+def test22_buffer_views(variant_scalar_rgb):
+    from mitsuba.render import Mesh
+    import numpy as np
+
+    m = Mesh("MyMesh", 3, 1)
+    positions, faces = m.vertex_positions_view(), m.faces_view()
+    assert positions.shape == (3, 3) and positions.dtype == np.float32
+    assert faces.shape == (1, 3) and faces.dtype == np.uint32
+
+    # Writes through the views are visible to the mesh (and vice versa)
+    positions[:] = [[0, 0, 0], [1, 0, 0], [0, 2, 0]]
+    faces[:] = [[0, 1, 2]]
+    m.parameters_changed()
+    assert ek.allclose(m.surface_area(), 1)
+    assert ek.allclose(m.vertex_positions_buffer(), positions.ravel())
+
+    m.faces_buffer()[:] = [2, 1, 0]
+    assert np.all(faces == [[2, 1, 0]])
+
+    with pytest.raises(RuntimeError):
+        m.vertex_normals_view()
+
+
+def test23_deforming_mesh(variant_scalar_rgb, tmpdir):
+    from mitsuba.core import Ray3f
+    from mitsuba.core.xml import load_string
+    from mitsuba.render import Mesh
+
+    m = Mesh("MyMesh", 3, 1)
+    m.vertex_positions_buffer()[:] = [-1, -1, 0, 1, -1, 0, 0, 1, 0]
+    m.faces_buffer()[:] = [0, 1, 2]
+    m.parameters_changed()
+    assert not m.is_deforming()
+
+    # Second keyframe: the triangle is shifted by 2 units along +Z
+    m.add_keyframe(Float([-1, -1, 2, 1, -1, 2, 0, 1, 2]))
+    assert m.is_deforming() and m.keyframe_count() == 2
+    assert ek.allclose(m.bbox().min, [-1, -1, 0])
+    assert ek.allclose(m.bbox().max, [1, 1, 2])
+
+    for time in [0, 0.25, 0.5, 1, 2]:
+        ray = Ray3f([0, 0, -1], [0, 0, 1], time, [])
+        pi = m.ray_intersect_triangle(0, ray)
+        assert pi.is_valid()
+        assert ek.allclose(pi.t, 1 + 2 * min(time, 1))
+
+    with pytest.raises(RuntimeError):
+        m.add_keyframe(Float([0, 0, 0]))
+
+    # Keyframes loaded from files, spanning the time interval [0.5, 1]
+    filenames = [str(tmpdir.join('frame_%i.ply' % i)) for i in range(3)]
+    for i, filename in enumerate(filenames):
+        f = Mesh("Frame", 3, 1)
+        f.vertex_positions_buffer()[:] = [-1, -1, i, 1, -1, i, 0, 1, i]
+        f.faces_buffer()[:] = [0, 1, 2]
+        f.write_ply(filename)
+
+    scene = load_string("""
+        <scene version="2.0.0">
+            <shape type="ply">
+                <string name="filename" value="%s"/>
+                <string name="keyframes" value="%s, %s"/>
+                <float name="motion_start" value="0.5"/>
+                <float name="motion_end" value="1"/>
+            </shape>
+        </scene>
+    """ % tuple(filenames))
+
+    mesh = scene.shapes()[0]
+    assert mesh.keyframe_count() == 3
+    assert ek.allclose(mesh.motion_range(), [0.5, 1])
+    assert ek.allclose(scene.bbox().max[2], 2)
+
+    for time, z in [(0, 0), (0.5, 0), (0.625, 0.5), (0.75, 1), (0.875, 1.5), (1, 2)]:
+        si = scene.ray_intersect(Ray3f([0, 0, -1], [0, 0, 1], time, []))
+        assert si.is_valid()
+        assert ek.allclose(si.p, [0, 0, z], atol=1e-5)
+        assert ek.allclose(si.t, 1 + z, atol=1e-5)
+
+
+def test24_large_mesh_normals_bbox_pmf(variant_scalar_rgb):
+    from mitsuba.render import Mesh
+    import numpy as np
+
+    """Checks the (parallel) normal, bbox and area computation on a mesh that
+    spans many work items against a NumPy reference"""
+    res = 150
+    x, y = np.meshgrid(np.linspace(0, 1, res), np.linspace(0, 1, res))
+    z = 0.1 * np.sin(8 * x) * np.cos(5 * y)
+    v = np.stack([x, y, z], axis=-1).reshape(-1, 3)
+
+    idx = np.arange(res * res).reshape(res, res)
+    a, b = idx[:-1, :-1].ravel(), idx[:-1, 1:].ravel()
+    c, d = idx[1:, 1:].ravel(), idx[1:, :-1].ravel()
+    f = np.concatenate([np.stack([a, b, c], -1), np.stack([a, c, d], -1)])
+
+    m = Mesh("grid", len(v), len(f), has_vertex_normals=True)
+    m.vertex_positions_buffer()[:] = v.ravel()
+    m.faces_buffer()[:] = f.ravel()
+    m.recompute_bbox()
+    m.recompute_vertex_normals()
+
+    assert ek.allclose(m.bbox().min, v.min(axis=0), atol=1e-6)
+    assert ek.allclose(m.bbox().max, v.max(axis=0), atol=1e-6)
+
+    # Angle-weighted reference normals
+    p = v[f]
+    fn = np.cross(p[:, 1] - p[:, 0], p[:, 2] - p[:, 0])
+    area = 0.5 * np.linalg.norm(fn, axis=1)
+    fn /= np.linalg.norm(fn, axis=1)[:, None]
+    ref = np.zeros_like(v)
+    for j in range(3):
+        e0 = p[:, (j + 1) % 3] - p[:, j]
+        e1 = p[:, (j + 2) % 3] - p[:, j]
+        e0 /= np.linalg.norm(e0, axis=1)[:, None]
+        e1 /= np.linalg.norm(e1, axis=1)[:, None]
+        angle = np.arccos(np.clip(np.sum(e0 * e1, axis=1), -1, 1))
+        np.add.at(ref, f[:, j], fn * angle[:, None])
+    ref /= np.linalg.norm(ref, axis=1)[:, None]
+
+    normals = np.array(m.vertex_normals_buffer()).reshape(-1, 3)
+    assert np.allclose(normals, ref, atol=1e-4)
+    assert ek.allclose(m.surface_area(), np.sum(area), rtol=1e-4)
+
+
+def test25_lazy_area_pmf(variant_scalar_rgb):
+    from mitsuba.core import Point2f
+    from .mesh_generation import create_stairs
+
+    """The sampling table of a non-emissive mesh is only built when sampling"""
+    m = create_stairs(10)
+    assert 'surface_area' not in str(m)
+    area = m.surface_area()
+    assert 'surface_area' not in str(m)
+
+    ps = m.sample_position(0.0, Point2f(0.3, 0.6))
+    assert 'surface_area' in str(m)
+    assert ek.allclose(m.surface_area(), area)
+    assert ek.allclose(ps.pdf, 1.0 / area)
+
+
+@fresolver_append_path
+def test26_shared_geometry_cache(variant_scalar_rgb, tmpdir):
+    from mitsuba.core import MemoryReport, MemoryCategory
+    from mitsuba.core.xml import load_string
+    import os
+
+    cache_dir = str(tmpdir.join('geometry'))
+
+    def load(shared, offset=0):
+        return load_string("""
+            <shape type="ply" version="2.0.0">
+                <string name="filename" value="resources/data/common/meshes/bunny_lowres.ply"/>
+                <transform name="to_world">
+                    <translate x="%f"/>
+                </transform>
+                %s
+            </shape>""" % (offset, '<string name="shared_cache_dir" value="%s"/>' % cache_dir
+                           if shared else ''))
+
+    def geometry_memory(mesh):
+        report = MemoryReport()
+        report.visit(mesh)
+        return report.host(MemoryCategory.Geometry)
+
+    reference = load(False)
+    a = load(True)
+    files = os.listdir(cache_dir)
+    assert len(files) == 1 and files[0].endswith('.mesh')
+    mtime = os.path.getmtime(os.path.join(cache_dir, files[0]))
+
+    # The second mesh maps the stored file, and neither owns its buffers
+    b = load(True)
+    assert os.listdir(cache_dir) == files
+    assert os.path.getmtime(os.path.join(cache_dir, files[0])) == mtime
+    assert geometry_memory(reference) > 0
+    assert geometry_memory(a) == 0 and geometry_memory(b) == 0
+
+    for mesh in [a, b]:
+        assert mesh.vertex_count() == reference.vertex_count()
+        assert mesh.face_count() == reference.face_count()
+        assert ek.allclose(mesh.vertex_positions_buffer(), reference.vertex_positions_buffer())
+        assert ek.allclose(mesh.vertex_normals_buffer(), reference.vertex_normals_buffer())
+        assert ek.all(ek.eq(mesh.faces_buffer(), reference.faces_buffer()))
+        assert mesh.bbox() == reference.bbox()
+
+    # Another transformation is stored separately
+    c = load(True, offset=1)
+    assert len(os.listdir(cache_dir)) == 2
+    assert ek.allclose(c.bbox().min[0], reference.bbox().min[0] + 1)
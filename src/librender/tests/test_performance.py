@@ -0,0 +1,355 @@
+"""
+Performance regression tests: render a fixed set of reference scenes and
+compare the wall time, the ray throughput and the peak memory usage against
+a baseline that was recorded on the same machine.
+
+The baseline is read from the file given by the MTS_PERF_BASELINE environment
+variable (default: resources/data/tests/perf/baseline.json). Tests without a
+baseline entry are skipped. To record a new one, run
+
+    python src/librender/tests/test_performance.py [--output <file>]
+
+The relative tolerance defaults to 10% and can be changed with the
+MTS_PERF_TOLERANCE environment variable.
+"""
+
+import os
+from os.path import join, realpath, dirname, exists
+import argparse
+import json
+import resource
+import tempfile
+import time
+
+import mitsuba
+import pytest
+import numpy as np
+
+PERF_VARIANTS = ['scalar_rgb', 'packet_rgb', 'scalar_spectral', 'gpu_rgb']
+
+BASELINE_FNAME = os.environ.get('MTS_PERF_BASELINE', realpath(join(
+    dirname(__file__), '../../../resources/data/tests/perf/baseline.json')))
+
+TOLERANCE = float(os.environ.get('MTS_PERF_TOLERANCE', 0.1))
+
+RESOLUTION, SPP, RUNS = 128, 32, 3
+
+
+# ---------------------------------------------------------------------------
+# Reference scenes. Every factory returns the body of a <scene> element
+# and may write auxiliary files (meshes, textures, volumes) to 'data_dir'.
+# ---------------------------------------------------------------------------
+
+BOX = """
+    <bsdf type="diffuse" id="white"/>
+    <bsdf type="diffuse" id="red">
+        <rgb name="reflectance" value=".6, .1, .1"/>
+    </bsdf>
+    <bsdf type="diffuse" id="green">
+        <rgb name="reflectance" value=".1, .6, .1"/>
+    </bsdf>
+    <shape type="rectangle">
+        <transform name="to_world"> <rotate x="1" angle="-90"/> <translate y="-1"/> </transform>
+        <ref id="{floor}"/>
+    </shape>
+    <shape type="rectangle">
+        <transform name="to_world"> <rotate x="1" angle="90"/> <translate y="1"/> </transform>
+        <ref id="white"/>
+    </shape>
+    <shape type="rectangle">
+        <transform name="to_world"> <translate z="-1"/> </transform>
+        <ref id="{back}"/>
+    </shape>
+    <shape type="rectangle">
+        <transform name="to_world"> <rotate y="1" angle="90"/> <translate x="-1"/> </transform>
+        <ref id="red"/>
+    </shape>
+    <shape type="rectangle">
+        <transform name="to_world"> <rotate y="1" angle="-90"/> <translate x="1"/> </transform>
+        <ref id="green"/>
+    </shape>
+"""
+
+LIGHT = """
+    <shape type="rectangle">
+        <transform name="to_world">
+            <rotate x="1" angle="90"/> <scale value=".25"/> <translate y=".99"/>
+        </transform>
+        <emitter type="area">
+            <rgb name="radiance" value="15, 15, 15"/>
+        </emitter>
+    </shape>
+"""
+
+
+def scene_cornell_box(data_dir):
+    return '<integrator type="path"/>' + BOX.format(floor='white', back='white') + LIGHT + """
+        <shape type="sphere">
+            <point name="center" x="-.4" y="-.6" z="-.3"/>
+            <float name="radius" value=".4"/>
+            <bsdf type="conductor"/>
+        </shape>
+        <shape type="sphere">
+            <point name="center" x=".45" y="-.65" z=".3"/>
+            <float name="radius" value=".35"/>
+            <bsdf type="dielectric"/>
+        </shape>"""
+
+
+def write_ply(filename, res=400):
+    """Tessellated and displaced sphere with 2 * res * res triangles"""
+    theta, phi = np.meshgrid(np.linspace(0, np.pi, res + 1),
+                             np.linspace(0, 2 * np.pi, res + 1), indexing='ij')
+    r = .5 + .05 * np.sin(13 * theta) * np.cos(17 * phi)
+    v = np.stack([r * np.sin(theta) * np.cos(phi), r * np.cos(theta) - .4,
+                  r * np.sin(theta) * np.sin(phi)], axis=-1).reshape(-1, 3)
+
+    i = np.arange(res * (res + 1)).reshape(res, res + 1)[:, :-1].ravel()
+    f = np.concatenate([np.stack([i, i + 1, i + res + 2], -1),
+                        np.stack([i, i + res + 2, i + res + 1], -1)])
+
+    faces = np.zeros(len(f), dtype=[('n', 'u1'), ('i', '<i4', 3)])
+    faces['n'], faces['i'] = 3, f
+    with open(filename, 'wb') as fh:
+        fh.write(('ply\nformat binary_little_endian 1.0\n'
+                  'element vertex %i\nproperty float x\nproperty float y\n'
+                  'property float z\nelement face %i\n'
+                  'property list uchar int vertex_indices\nend_header\n'
+                  % (len(v), len(f))).encode())
+        fh.write(v.astype('<f4').tobytes())
+        fh.write(faces.tobytes())
+
+
+def scene_heavy_mesh(data_dir):
+    filename = join(data_dir, 'heavy_mesh.ply')
+    if not exists(filename):
+        write_ply(filename)
+    return '<integrator type="path"/>' + BOX.format(floor='white', back='white') + LIGHT + """
+        <shape type="ply">
+            <string name="filename" value="%s"/>
+            <bsdf type="roughplastic"/>
+        </shape>""" % filename
+
+
+def scene_many_lights(data_dir):
+    lights = ''
+    rng = np.random.RandomState(0)
+    for i in range(64):
+        p, c = rng.uniform(-.9, .9, 3), rng.uniform(0, 20, 3)
+        lights += """
+            <shape type="sphere">
+                <point name="center" x="%f" y="%f" z="%f"/>
+                <float name="radius" value=".02"/>
+                <emitter type="area">
+                    <rgb name="radiance" value="%f, %f, %f"/>
+                </emitter>
+            </shape>""" % (*p, *c)
+    return '<integrator type="path"/>' + BOX.format(floor='white', back='white') + lights
+
+
+def scene_heterogeneous_volume(data_dir):
+    filename = join(data_dir, 'smoke.vol')
+    if not exists(filename):
+        res = 64
+        x, y, z = np.meshgrid(*[np.linspace(-1, 1, res)] * 3, indexing='ij')
+        values = np.maximum(0, 1 - (x**2 + y**2 + z**2)) * \
+            (1 + .5 * np.sin(10 * x) * np.sin(10 * y) * np.sin(10 * z)) * 4
+        with open(filename, 'wb') as f:
+            f.write(b'VOL')
+            f.write(np.uint8(3).tobytes())
+            f.write(np.array([1, res, res, res, 1], dtype=np.int32).tobytes())
+            f.write(np.array([0, 0, 0, 1, 1, 1], dtype=np.float32).tobytes())
+            f.write(values.astype(np.float32).tobytes())
+
+    return """
+        <integrator type="volpath">
+            <integer name="max_depth" value="16"/>
+        </integrator>""" + BOX.format(floor='white', back='white') + LIGHT + """
+        <shape type="sphere">
+            <point name="center" x="0" y="-.35" z="0"/>
+            <float name="radius" value=".6"/>
+            <bsdf type="null"/>
+            <medium type="heterogeneous" name="interior">
+                <volume name="sigma_t" type="gridvolume">
+                    <string name="filename" value="%s"/>
+                    <transform name="to_world">
+                        <translate value="-.5, -.5, -.5"/> <scale value="1.2"/>
+                        <translate y="-.35"/>
+                    </transform>
+                </volume>
+                <rgb name="albedo" value=".8, .8, .8"/>
+            </medium>
+        </shape>""" % filename
+
+
+def scene_textured_interior(data_dir):
+    from mitsuba.core import Bitmap
+
+    filename = join(data_dir, 'texture.exr')
+    if not exists(filename):
+        rng = np.random.RandomState(0)
+        Bitmap(rng.uniform(0, 1, (1024, 1024, 3)).astype(np.float32)).write(filename)
+
+    return '<integrator type="path"/>' + """
+        <bsdf type="diffuse" id="checker">
+            <texture type="checkerboard" name="reflectance">
+                <transform name="to_uv"> <scale value="8"/> </transform>
+            </texture>
+        </bsdf>
+        <bsdf type="diffuse" id="textured">
+            <texture type="bitmap" name="reflectance">
+                <string name="filename" value="%s"/>
+            </texture>
+        </bsdf>""" % filename + BOX.format(floor='checker', back='textured') + LIGHT + """
+        <shape type="sphere">
+            <point name="center" x="0" y="-.6" z="0"/>
+            <float name="radius" value=".4"/>
+            <bsdf type="roughconductor">
+                <float name="alpha" value=".2"/>
+            </bsdf>
+        </shape>"""
+
+
+SCENES = {
+    'cornell_box': scene_cornell_box,
+    'heavy_mesh': scene_heavy_mesh,
+    'many_lights': scene_many_lights,
+    'heterogeneous_volume': scene_heterogeneous_volume,
+    'textured_interior': scene_textured_interior,
+}
+
+
+def load_scene(scene_name, data_dir):
+    from mitsuba.core.xml import load_string
+    return load_string("""
+        <scene version="2.0.0">
+            <sensor type="perspective">
+                <float name="fov" value="40"/>
+                <transform name="to_world">
+                    <lookat origin="0, 0, 3.9" target="0, 0, 0" up="0, 1, 0"/>
+                </transform>
+                <sampler type="independent">
+                    <integer name="sample_count" value="%i"/>
+                </sampler>
+                <film type="hdrfilm">
+                    <integer name="width" value="%i"/>
+                    <integer name="height" value="%i"/>
+                </film>
+            </sensor>
+            %s
+        </scene>""" % (SPP, RESOLUTION, RESOLUTION, SCENES[scene_name](data_dir)))
+
+
+def peak_memory():
+    """Peak resident memory of the process in bytes"""
+    rss = resource.getrusage(resource.RUSAGE_SELF).ru_maxrss
+    return rss if os.uname().sysname == 'Darwin' else rss * 1024
+
+
+def measure(scene_name, data_dir, runs=RUNS):
+    """
+    Render a reference scene in the current variant and return its median
+    wall time (in seconds), ray throughput, and the peak memory usage.
+    """
+    scene = load_scene(scene_name, data_dir)
+    sensor = scene.sensors()[0]
+
+    # The first render warms up caches and the JIT compiler of the GPU variants
+    assert scene.integrator().render(scene, sensor)
+
+    times, rays = [], []
+    for i in range(runs):
+        start = time.perf_counter()
+        assert scene.integrator().render(scene, sensor)
+        times.append(time.perf_counter() - start)
+        rays.append(scene.ray_statistics()['total'])
+
+    i = int(np.argsort(times)[len(times) // 2])
+    return {
+        'wall_time': times[i],
+        'rays_per_second': rays[i] / times[i],
+        'peak_memory': peak_memory(),
+    }
+
+
+def measure_subprocess(variant, scene_name, data_dir):
+    """
+    Run measure() in a separate process, so that the peak memory usage
+    only accounts for the given variant and scene
+    """
+    import subprocess
+    import sys
+
+    env = dict(os.environ, PYTHONPATH=os.pathsep.join(sys.path))
+    output = subprocess.check_output([sys.executable, realpath(__file__), '--measure',
+                                      variant, scene_name, data_dir], env=env)
+    return json.loads(output.decode().splitlines()[-1])
+
+
+def load_baseline():
+    if not exists(BASELINE_FNAME):
+        return {}
+    with open(BASELINE_FNAME) as f:
+        return json.load(f)
+
+
+@pytest.fixture(params=PERF_VARIANTS)
+def variants_perf(request):
+    try:
+        mitsuba.set_variant(request.param)
+    except Exception:
+        pytest.skip('Mitsuba variant "%s" is not enabled!' % request.param)
+    return request.param
+
+
+@pytest.mark.slow
+@pytest.mark.parametrize('scene_name', list(SCENES))
+def test_performance(variants_perf, scene_name, tmpdir):
+    baseline = load_baseline().get(variants_perf, {}).get(scene_name)
+    if baseline is None:
+        pytest.skip('No performance baseline for "%s" in %s.' % (scene_name, variants_perf))
+
+    result = measure_subprocess(variants_perf, scene_name, str(tmpdir))
+    print('%s/%s: %s (baseline: %s)' % (variants_perf, scene_name, result, baseline))
+
+    assert result['wall_time'] <= baseline['wall_time'] * (1 + TOLERANCE)
+    assert result['rays_per_second'] >= baseline['rays_per_second'] * (1 - TOLERANCE)
+    assert result['peak_memory'] <= baseline['peak_memory'] * (1 + TOLERANCE)
+
+
+if __name__ == '__main__':
+    """
+    Record a performance baseline of all reference scenes for every enabled
+    variant of PERF_VARIANTS. Every variant and scene is measured in a separate
+    process, so that the peak memory usage of one does not affect the others.
+    """
+    import sys
+
+    parser = argparse.ArgumentParser(prog='RecordPerformanceBaseline')
+    parser.add_argument('--output', default=BASELINE_FNAME,
+                        help='Baseline file. Default value: %s' % BASELINE_FNAME)
+    parser.add_argument('--measure', nargs=3, metavar=('VARIANT', 'SCENE', 'DATA_DIR'),
+                        help=argparse.SUPPRESS)
+    args = parser.parse_args()
+
+    if args.measure:
+        variant, scene_name, data_dir = args.measure
+        mitsuba.set_variant(variant)
+        print(json.dumps(measure(scene_name, data_dir)))
+        sys.exit(0)
+
+    baseline = {}
+    with tempfile.TemporaryDirectory() as data_dir:
+        for variant in PERF_VARIANTS:
+            if variant not in mitsuba.variants():
+                continue
+            baseline[variant] = {}
+            for scene_name in SCENES:
+                baseline[variant][scene_name] = \
+                    measure_subprocess(variant, scene_name, data_dir)
+                print('%s/%s: %s' % (variant, scene_name, baseline[variant][scene_name]))
+
+    os.makedirs(dirname(realpath(args.output)), exist_ok=True)
+    with open(args.output, 'w') as f:
+        json.dump(baseline, f, indent=2)
+    print('Wrote performance baseline to: ' + args.output)
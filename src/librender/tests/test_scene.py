@@ -102,3 +102,311 @@ def test03_shapes_parameters_grad_enabled(variant_gpu_autodiff_rgb):
     params.set_dirty(shape_param_key)
     params.update()
     assert scene.shapes_grad_enabled() == True
+
+
+@pytest.mark.parametrize("accel", ["kdtree", "bvh"])
+def test04_update_geometry(variant_scalar_rgb, accel):
+    from mitsuba.core import Properties, Ray3f
+    from mitsuba.render import Scene
+    from .mesh_generation import create_stairs
+    import numpy as np
+
+    mesh = create_stairs(10)
+    props = Properties("scene")
+    props["_unnamed_0"] = mesh
+    props["accel"] = accel
+    scene = Scene(props)
+
+    def trace(x, y):
+        ray = Ray3f([x, y, 2], [0, 0, -1], 0.5, [])
+        ray.mint = 0
+        ray.maxt = 100
+        return scene.ray_intersect(ray)
+
+    si_before = [trace(0.5, (i + 0.5) / 10) for i in range(10)]
+    assert all(si.is_valid() for si in si_before)
+
+    # Move all vertices down and to the side
+    v = np.array(mesh.vertex_positions_buffer()).reshape(-1, 3)
+    v += [0.5, 0.0, -0.5]
+    mesh.vertex_positions_buffer()[:] = v.reshape(-1)
+    mesh.parameters_changed()
+    scene.update_geometry()
+
+    assert ek.allclose(scene.bbox().min, [0.5, 0, -0.5], atol=1e-5)
+    for i in range(10):
+        si = trace(0.75, (i + 0.5) / 10)
+        assert si.is_valid()
+        assert ek.allclose(si.t, si_before[i].t + 0.5, atol=1e-5)
+
+    # The part of the stairs that moved away can no longer be hit
+    assert not trace(0.25, 0.5).is_valid()
+
+
+def test05_power_emitter_sampling(variant_scalar_rgb):
+    from mitsuba.core.xml import load_string
+    from mitsuba.render import SurfaceInteraction3f
+
+    def make_scene(strategy):
+        return load_string("""
+            <scene version="2.0.0">
+                <string name="emitter_sampling" value="{}"/>
+                <emitter type="point">
+                    <point name="position" x="0" y="0" z="1"/>
+                    <spectrum name="intensity" value="1"/>
+                </emitter>
+                <emitter type="point">
+                    <point name="position" x="0" y="0" z="-2"/>
+                    <spectrum name="intensity" value="3"/>
+                </emitter>
+            </scene>
+        """.format(strategy))
+
+    scene = make_scene("uniform")
+    assert all(ek.allclose(e.selection_pmf(), 0.5) for e in scene.emitters())
+
+    scene = make_scene("power")
+    emitters = scene.emitters()
+    assert ek.allclose(emitters[0].power() + emitters[1].power(), 16 * ek.pi)
+    for e in emitters:
+        assert ek.allclose(e.selection_pmf(), e.power() / (16 * ek.pi))
+
+    it = SurfaceInteraction3f.zero()
+    for x in [0.1, 0.3, 0.6, 0.9]:
+        ds, spec = scene.sample_emitter_direction(it, [x, 0.5], False)
+        emitter = ds.object
+        pmf = emitter.selection_pmf()
+        assert ek.allclose(ds.pdf, pmf)
+        assert ek.allclose(spec, emitter.power() / (4 * ek.pi * ds.dist**2 * pmf))
+
+    # The brighter emitter is chosen three times as often
+    counts = [0, 0]
+    for i in range(100):
+        ds, _ = scene.sample_emitter_direction(it, [(i + 0.5) / 100, 0.5], False)
+        counts[0 if ds.dist < 1.5 else 1] += 1
+    assert counts == [25, 75]
+
+    with pytest.raises(RuntimeError, match='Invalid emitter sampling'):
+        make_scene("bvh")
+
+
+def test06_ray_statistics(variant_scalar_rgb):
+    from mitsuba.core.xml import load_string
+
+    scene = load_string("""
+        <scene version="2.0.0">
+            <integrator type="path">
+                <integer name="max_depth" value="3"/>
+            </integrator>
+            <sensor type="perspective">
+                <film type="hdrfilm">
+                    <integer name="width" value="8"/>
+                    <integer name="height" value="6"/>
+                </film>
+                <sampler type="independent">
+                    <integer name="sample_count" value="4"/>
+                </sampler>
+            </sensor>
+            <shape type="rectangle">
+                <transform name="to_world">
+                    <rotate x="1" angle="180"/>
+                    <scale value="10"/>
+                    <translate z="2"/>
+                </transform>
+            </shape>
+            <emitter type="point">
+                <point name="position" x="0" y="0" z="0"/>
+            </emitter>
+        </scene>
+    """)
+
+    assert scene.ray_statistics()["total"] == 0
+    assert scene.integrator().render(scene, scene.sensors()[0])
+
+    stats = scene.ray_statistics()
+    assert stats["primary"]["rays"] == 8 * 6 * 4
+    assert stats["primary"]["scalar"] == 8 * 6 * 4
+    assert stats["primary"]["packet"] == 0
+    assert stats["primary"]["queries"] == 8 * 6 * 4
+    # Every camera ray hits the rectangle and tests the visibility of the light
+    assert stats["shadow"]["rays"] == 8 * 6 * 4
+    assert stats["secondary"]["rays"] > 0
+    assert stats["total"] == stats["primary"]["rays"] + \
+        stats["secondary"]["rays"] + stats["shadow"]["rays"]
+    assert stats["time"] > 0
+    assert stats["rays_per_second"] > 0
+
+
+def test07_auto_instancing(variant_scalar_rgb, tmpdir):
+    from mitsuba.core import xml, Ray3f
+
+    # A unit quad in the XY plane
+    filename = str(tmpdir.join('quad.ply'))
+    with open(filename, 'w') as f:
+        f.write('\n'.join(['ply', 'format ascii 1.0', 'element vertex 4',
+                           'property float x', 'property float y',
+                           'property float z', 'element face 2',
+                           'property list uchar int vertex_indices',
+                           'end_header', '0 0 0', '1 0 0', '1 1 0', '0 1 0',
+                           '3 0 1 2', '3 0 2 3']) + '\n')
+
+    def load(auto_instancing):
+        return xml.load_dict({
+            "type" : "scene",
+            "auto_instancing" : auto_instancing,
+            "quad1" : {"type" : "ply", "filename" : filename},
+            "quad2" : {"type" : "ply", "filename" : filename,
+                       "to_world" : mitsuba.core.ScalarTransform4f.translate([2, 0, -1])}
+        })
+
+    def trace(scene, x):
+        return scene.ray_intersect(Ray3f([x, 0.5, 5], [0, 0, -1], 0, []))
+
+    reference = load(False)
+    assert not any(s.is_instance() for s in reference.shapes())
+
+    scene = load(True)
+    assert len(scene.shapes()) == 2
+    assert all(s.is_instance() for s in scene.shapes())
+    assert ek.allclose(scene.bbox().min, reference.bbox().min)
+    assert ek.allclose(scene.bbox().max, reference.bbox().max)
+
+    for x in [0.5, 1.5, 2.5]:
+        si_ref, si = trace(reference, x), trace(scene, x)
+        assert si.is_valid() == si_ref.is_valid()
+        if si.is_valid():
+            assert ek.allclose(si.t, si_ref.t)
+            assert ek.allclose(si.p, si_ref.p)
+
+
+def test08_ray_intersect_batch(variant_scalar_rgb):
+    from mitsuba.core import xml, Ray3f
+    import numpy as np
+
+    scene = xml.load_dict({
+        "type" : "scene",
+        "rect" : {"type" : "rectangle"},
+        "sphere" : {"type" : "sphere", "center" : [3, 0, 0], "radius" : 0.5}
+    })
+
+    # A row of rays along the X axis, pointing down
+    x = np.linspace(-1.5, 3.5, 101)
+    o = np.stack([x, np.full_like(x, 0.25), np.full_like(x, 5)], axis=1)
+    d = np.tile([0, 0, -1], (len(x), 1))
+    t, shape_index, prim_index, uv = scene.ray_intersect_batch(o, d)
+
+    assert t.shape == (len(x),) and uv.shape == (len(x), 2)
+    for i in range(len(x)):
+        si = scene.ray_intersect(Ray3f(o[i], d[i], 0, []))
+        assert si.is_valid() == np.isfinite(t[i])
+        if not si.is_valid():
+            assert shape_index[i] == 0xFFFFFFFF
+            continue
+        assert ek.allclose(t[i], si.t)
+        assert ek.allclose(uv[i], si.uv)
+        assert prim_index[i] == si.prim_index
+        assert scene.shapes()[shape_index[i]].id() == si.shape.id()
+
+    with pytest.raises(RuntimeError):
+        scene.ray_intersect_batch(o[:, :2], d[:, :2])
+
+
+def test09_parameter_update_keeps_accel(variant_scalar_rgb):
+    from mitsuba.core import xml, Ray3f, Transform4f
+    from mitsuba.python.util import traverse
+
+    scene = xml.load_dict({
+        "type" : "scene",
+        "sphere" : {
+            "type" : "sphere",
+            "bsdf" : {"type" : "diffuse"}
+        }
+    })
+    params = traverse(scene)
+    revision = scene.geometry_revision()
+
+    # Updating the BSDF must not rebuild the acceleration data structure
+    params['sphere.bsdf.reflectance.value'] = 0.25
+    params.update()
+    assert scene.geometry_revision() == revision
+    assert not scene.shapes()[0].dirty()
+
+    # .. while moving the shape must
+    params['sphere.to_world'] = Transform4f.translate([0, 0, -1])
+    params.update()
+    assert scene.geometry_revision() != revision
+    assert not scene.shapes()[0].dirty()
+
+    si = scene.ray_intersect(Ray3f([0, 0, 5], [0, 0, -1], 0, []))
+    assert si.is_valid()
+    assert ek.allclose(si.t, 5, atol=1e-5)
+
+
+def test10_memory_report(variant_scalar_rgb):
+    from mitsuba.core import xml, MemoryCategory
+
+    texture = {
+        "type" : "bitmap",
+        "filename" : "resources/data/common/textures/noise_8x8.png"
+    }
+
+    scene = xml.load_dict({
+        "type" : "scene",
+        "accel" : "kdtree",
+        "bunny" : {
+            "type" : "ply",
+            "filename" : "resources/data/common/meshes/bunny_lowres.ply",
+            "bsdf" : { "type" : "diffuse", "reflectance" : texture }
+        },
+        "sphere" : {
+            "type" : "sphere",
+            "bsdf" : { "type" : "diffuse", "reflectance" : texture }
+        },
+        "sensor" : {
+            "type" : "perspective",
+            "film" : { "type" : "hdrfilm", "width" : 16, "height" : 8 }
+        }
+    })
+
+    report = scene.memory_report()
+    mesh = scene.shapes()[0] if scene.shapes()[0].is_mesh() else scene.shapes()[1]
+    assert report.host(MemoryCategory.Geometry) >= \
+        (mesh.vertex_count() + mesh.face_count()) * 3 * 4
+    assert report.host(MemoryCategory.Acceleration) > 0
+
+    # Both BSDFs share the texel data, which is only accounted once
+    assert report.host(MemoryCategory.Textures) == 8 * 8 * 3 * 4
+    assert report.total_device() == 0
+    assert report.total_host() == sum(report.host(MemoryCategory(i)) for i in range(7))
+
+    # The storage of the film (RGBA + weight) is allocated when rendering
+    assert report.host(MemoryCategory.Film) == 0
+    assert scene.integrator().render(scene, scene.sensors()[0])
+    assert scene.memory_report().host(MemoryCategory.Film) >= 16 * 8 * 5 * 4
+
+
+def test11_scattering_hit_flags(variant_scalar_rgb):
+    from mitsuba.core import xml
+    from mitsuba.render import HitComputeFlags
+
+    def load(bsdf):
+        return xml.load_dict({
+            "type" : "scene",
+            "sphere" : { "type" : "sphere", "bsdf" : bsdf }
+        })
+
+    # Isotropic BSDFs don't need the position partials along paths
+    scene = load({ "type" : "roughconductor", "alpha" : 0.2 })
+    assert scene.scattering_hit_flags() == HitComputeFlags.Connection
+
+    # .. while anisotropic ones orient their lobes using the tangents
+    scene = load({ "type" : "roughconductor", "alpha_u" : 0.1, "alpha_v" : 0.3 })
+    assert scene.scattering_hit_flags() == HitComputeFlags.All
+
+    # The same holds for the frames perturbed by bump maps
+    scene = load({
+        "type" : "bumpmap",
+        "texture" : { "type" : "checkerboard" },
+        "bsdf" : { "type" : "diffuse" }
+    })
+    assert scene.scattering_hit_flags() == HitComputeFlags.All
@@ -146,3 +146,53 @@ def test06_rgb2spec_fetch_eval_mean(variant_scalar_spectral):
         assert not ek.any(ek.isnan(coeff)), "{} => coeff = {}".format(rgb, coeff)
         assert not ek.any(ek.isnan(mean)),  "{} => mean = {}".format(rgb, mean)
         assert not ek.any(ek.isnan(value)), "{} => value = {}".format(rgb, value)
+
+
+def test07_spectrum_to_xyz(variant_scalar_spectral):
+    """spectrum_to_xyz: the tabulated fast path must match the per-wavelength
+    evaluation of the color matching functions"""
+    from mitsuba.core import spectrum_to_xyz, cie1931_xyz, MTS_WAVELENGTH_SAMPLES
+    import numpy as np
+
+    np.random.seed(1234)
+    for i in range(20):
+        wavelengths = np.random.uniform(340, 850, MTS_WAVELENGTH_SAMPLES)
+        if i == 0:
+            wavelengths[:2] = [360, 830]
+        values = np.random.uniform(0, 2, MTS_WAVELENGTH_SAMPLES)
+
+        expected = np.zeros(3)
+        for w, v in zip(wavelengths, values):
+            expected += np.array(cie1931_xyz(w)) * v
+        expected /= MTS_WAVELENGTH_SAMPLES
+
+        assert ek.allclose(spectrum_to_xyz(values, wavelengths), expected,
+                           rtol=1e-5, atol=1e-6)
+
+    assert ek.allclose(spectrum_to_xyz([1] * MTS_WAVELENGTH_SAMPLES,
+                                       [500] * MTS_WAVELENGTH_SAMPLES, False), 0)
+
+
+def test08_rgb2spec_fetch_array(variant_scalar_spectral):
+    """The batched lookup must match the scalar one, including the
+    special cases of black and white colors and partial packets"""
+    from mitsuba.render import srgb_model_fetch, srgb_model_fetch_array
+    import numpy as np
+
+    np.random.seed(1234)
+    rgb = np.random.uniform(0, 1, (37, 3)).astype(np.float32)
+    rgb[0] = 0
+    rgb[1] = 1
+    rgb[2] = [0, 0, 0.5]
+    rgb[3] = [0.25, 0.25, 0.25]
+
+    coeff = srgb_model_fetch_array(rgb)
+    assert coeff.shape == rgb.shape
+    for i in range(rgb.shape[0]):
+        expected = np.array(srgb_model_fetch(rgb[i]))
+        assert np.allclose(coeff[i], expected, rtol=1e-4, atol=1e-5), \
+            "{} => {} vs {}".format(rgb[i], coeff[i], expected)
+
+    # Also accepts images
+    image = srgb_model_fetch_array(rgb[:36].reshape(6, 2, 3, 3))
+    assert np.allclose(image.reshape(36, 3), coeff[:36])
@@ -82,3 +82,76 @@ def test03_normal_film(variant_scalar_rgb):
     # Resetting and re-querying the blocks should yield the exact same results.
     s.reset()
     check_first_blocks(extract_blocks(s), expected, n_total=110)
+
+
+def test04_indexed_blocks(variant_scalar_rgb):
+    from mitsuba.render import Spiral
+
+    f = make_film(318, 322)
+    s = Spiral(f.size(), f.crop_offset(), 32, 2)
+    assert s.work_count() == 2 * s.block_count()
+
+    # Random access must agree with the sequential traversal of the first pass
+    blocks = extract_blocks(Spiral(f.size(), f.crop_offset()))
+    for i in range(s.block_count()):
+        for j in [i, i + s.block_count()]:
+            (bo, bs, bi) = s.block(j)
+            assert ek.all(bo == blocks[i][0])
+            assert ek.all(bs == blocks[i][1])
+            assert bi == j
+
+
+def test05_tail_subdivision(variant_scalar_rgb):
+    from mitsuba.render import Spiral
+
+    f = make_film(318, 322)
+    s = Spiral(f.size(), f.crop_offset(), 32, 2)
+    s.set_tail_subdivision(8)
+    assert s.work_count() > 2 * s.block_count()
+
+    # Every pixel must still be covered exactly once per pass
+    coverage = np.zeros((322, 318), dtype=np.int32)
+    ids = set()
+    for i in range(s.work_count()):
+        (bo, bs, bi) = s.block(i)
+        assert bi not in ids
+        ids.add(bi)
+        coverage[bo[1]:bo[1] + bs[1], bo[0]:bo[0] + bs[0]] += 1
+    assert np.all(coverage == 2)
+
+
+def test06_priority_map(variant_scalar_rgb):
+    from mitsuba.core import Bitmap
+    from mitsuba.render import Spiral
+
+    f = make_film(318, 322)
+    s = Spiral(f.size(), f.crop_offset(), 32, 2)
+    s.set_tail_subdivision(8)
+    ids_spiral = sorted(s.block(i)[2] for i in range(s.work_count()))
+
+    # Prioritize the bottom right corner of the film
+    priorities = np.zeros((4, 4, 1), dtype=np.float32)
+    priorities[3, 3] = 1
+    f.set_priority_map(Bitmap(priorities))
+    assert f.priority_map() is not None
+    s.set_priority_map(f.priority_map(), f.size())
+
+    (bo, bs, bi) = s.block(0)
+    assert ek.all(bo + bs > [318 * 3 // 4, 322 * 3 // 4])
+    (bo, bs, bi) = s.block(s.block_count())
+    assert ek.all(bo + bs > [318 * 3 // 4, 322 * 3 // 4])
+
+    # The same blocks (and identifiers) are handed out in a different order
+    coverage = np.zeros((322, 318), dtype=np.int32)
+    for i in range(s.work_count()):
+        (bo, bs, bi) = s.block(i)
+        coverage[bo[1]:bo[1] + bs[1], bo[0]:bo[0] + bs[0]] += 1
+    assert np.all(coverage == 2)
+    assert sorted(s.block(i)[2] for i in range(s.work_count())) == ids_spiral
+
+    # Without a map, the spiral order is restored
+    f.set_priority_map(None)
+    assert f.priority_map() is None
+    s.set_priority_map(None, f.size())
+    blocks = extract_blocks(Spiral(f.size(), f.crop_offset()))
+    assert ek.all(s.block(0)[0] == blocks[0][0])
@@ -55,6 +55,12 @@ GPUTexture::GPUTexture(const Bitmap *bitmap, InterpolationMode min_interpolation
     : Base(convert_pixel_format(bitmap->pixel_format()),
            convert_component_format(bitmap->component_format()), Vector<int, 2>(bitmap->size()),
            min_interpolation_mode, mag_interpolation_mode, wrap_mode) {
+    upload(bitmap);
+}
+
+bool GPUTexture::upload(const Bitmap *bitmap) {
+    if (Vector<int, 2>(bitmap->size()) != m_size)
+        return false;
     ref<const Bitmap> source = bitmap;
     if (convert_pixel_format(bitmap->pixel_format()) != m_pixel_format ||
         convert_component_format(bitmap->component_format()) != m_component_format) {
@@ -62,7 +68,8 @@ GPUTexture::GPUTexture(const Bitmap *bitmap, InterpolationMode min_interpolation
                                  convert_component_format(m_component_format),
                                  bitmap->srgb_gamma());
     }
-    upload((const uint8_t *) source->data());
+    Base::upload((const uint8_t *) source->data());
+    return true;
 }
 
 GPUTexture::~GPUTexture() { }
@@ -6,6 +6,7 @@
 #include <mitsuba/core/fstream.h>
 #include <mitsuba/core/fresolver.h>
 #include <mitsuba/core/formatter.h>
+#include <mitsuba/core/thread.h>
 
 #include <nanogui/layout.h>
 #include <nanogui/label.h>
@@ -99,9 +100,14 @@ MitsubaViewer::MitsubaViewer()
     m_btn_play = new Button(tools, "", FA_PLAY);
     m_btn_play->set_text_color(nanogui::Color(100, 255, 100, 150));
     m_btn_play->set_callback([this]() {
-            m_btn_play->set_icon(FA_PAUSE);
-            m_btn_play->set_text_color(nanogui::Color(255, 255, 255, 150));
-            m_btn_stop->set_enabled(true);
+            if (m_render_active) {
+                stop_interactive();
+            } else {
+                start_interactive();
+                m_btn_play->set_icon(FA_PAUSE);
+                m_btn_play->set_text_color(nanogui::Color(255, 255, 255, 150));
+                m_btn_stop->set_enabled(true);
+            }
         }
     );
     m_btn_play->set_tooltip("Render");
@@ -110,6 +116,12 @@ MitsubaViewer::MitsubaViewer()
     m_btn_stop->set_text_color(nanogui::Color(255, 100, 100, 150));
     m_btn_stop->set_enabled(false);
     m_btn_stop->set_tooltip("Stop rendering");
+    m_btn_stop->set_callback([this]() {
+        stop_interactive();
+        if (m_restart)
+            m_restart();
+        m_btn_stop->set_enabled(false);
+    });
 
     m_btn_reload = new Button(tools, "", FA_SYNC_ALT);
     m_btn_reload->set_tooltip("Reload file");
@@ -236,6 +248,87 @@ MitsubaViewer::MitsubaViewer()
     m_view->reset();
 }
 
+MitsubaViewer::~MitsubaViewer() {
+    m_render_active = false;
+    if (m_restart)
+        m_restart();
+    if (m_render_thread.joinable())
+        m_render_thread.join();
+}
+
+void MitsubaViewer::set_interactive(std::function<ref<Bitmap>()> render_pass,
+                                    std::function<void()> restart,
+                                    std::mutex *bitmap_mutex) {
+    stop_interactive();
+    m_render_pass = std::move(render_pass);
+    m_restart = std::move(restart);
+    m_bitmap_mutex = bitmap_mutex;
+}
+
+void MitsubaViewer::restart_interactive() {
+    if (m_restart)
+        m_restart();
+}
+
+void MitsubaViewer::start_interactive() {
+    if (!m_render_pass || m_render_active)
+        return;
+    if (m_render_thread.joinable())
+        m_render_thread.join();
+
+    m_render_active = true;
+    ThreadEnvironment env;
+    m_render_thread = std::thread([this, env]() {
+        Thread::register_external_thread("ui");
+        /* scoped */ {
+            ScopedSetThreadEnvironment set_env(env);
+            while (m_render_active) {
+                ref<Bitmap> bitmap;
+                try {
+                    bitmap = m_render_pass();
+                } catch (const std::exception &e) {
+                    Log(Warn, "Interactive rendering failed: %s", e.what());
+                    m_render_active = false;
+                    break;
+                }
+
+                /* Skip the upload if the previous one is still pending, the
+                   next pass will show these samples as well */
+                if (!bitmap || m_upload_pending)
+                    continue;
+                m_upload_pending = true;
+                ng::async([this, bitmap]() {
+                    upload_pass(bitmap);
+                    m_upload_pending = false;
+                });
+            }
+        }
+        Thread::unregister_external_thread();
+    });
+}
+
+void MitsubaViewer::stop_interactive() {
+    m_render_active = false;
+    if (m_render_thread.joinable())
+        m_render_thread.join();
+    m_btn_play->set_icon(FA_PLAY);
+    m_btn_play->set_text_color(nanogui::Color(100, 255, 100, 150));
+}
+
+void MitsubaViewer::upload_pass(const Bitmap *bitmap) {
+    std::unique_lock<std::mutex> guard;
+    if (m_bitmap_mutex)
+        guard = std::unique_lock<std::mutex>(*m_bitmap_mutex);
+
+    if (!m_texture || !m_texture->upload(bitmap)) {
+        m_texture = new GPUTexture(bitmap, GPUTexture::InterpolationMode::Trilinear,
+                                   GPUTexture::InterpolationMode::Nearest);
+        m_view->set_image(m_texture);
+        m_view->reset();
+    }
+    redraw();
+}
+
 class TabAppender : public Appender {
 public:
     TabAppender(MitsubaViewer *viewer, MitsubaViewer::Tab *tab)
@@ -12,6 +12,17 @@
 
 NAMESPACE_BEGIN(mitsuba)
 
+/**
+ * Heterogeneous medium with a spatially varying extinction given by the
+ * \c sigma_t volume.
+ *
+ * Free-flight distances are sampled using delta tracking against a coarse
+ * majorant supergrid with <tt>majorant_resolution^3</tt> cells spanning the
+ * bounding box of the medium (default: 16). Each cell bounds the extinction
+ * within it based on \ref Volume::local_max(), which lets sparse regions be
+ * crossed in large steps. A resolution of 0 or 1 uses a single global
+ * majorant.
+ */
 template <typename Float, typename Spectrum>
 class HeterogeneousMedium final : public Medium<Float, Spectrum> {
 public:
@@ -26,22 +37,150 @@ public:
         m_scale = props.float_("scale", 1.0f);
         m_has_spectral_extinction = props.bool_("has_spectral_extinction", true);
 
+        m_aabb = m_sigmat->bbox();
+
+        int majorant_resolution = props.int_("majorant_resolution", 16);
+        if (majorant_resolution < 0)
+            Throw("\"majorant_resolution\" must be non-negative!");
+        m_majorant_res = ScalarVector3i(majorant_resolution > 1 ? majorant_resolution : 0);
+
+        update_majorants();
+    }
+
+    /**
+     * \brief Compute the global majorant and the majorant supergrid
+     *
+     * The supergrid subdivides the bounding box of the medium into cells
+     * that store an upper bound of the (unscaled) extinction within them.
+     */
+    void update_majorants() {
         m_max_density = m_scale * m_sigmat->max();
-        m_aabb        = m_sigmat->bbox();
+        if (m_majorant_res.x() == 0)
+            return;
+
+        ScalarVector3f res(m_majorant_res),
+                       cell_size = m_aabb.extents() / res;
+        m_majorant_scale = rcp(cell_size);
+
+        const ScalarTransform4f &to_local = m_sigmat->world_to_local();
+        std::vector<ScalarFloat> majorants(hprod(m_majorant_res));
+        size_t index = 0;
+        for (int32_t z = 0; z < m_majorant_res.z(); ++z) {
+            for (int32_t y = 0; y < m_majorant_res.y(); ++y) {
+                for (int32_t x = 0; x < m_majorant_res.x(); ++x) {
+                    // Bounding box of the cell in the local space of the volume
+                    ScalarBoundingBox3f bbox;
+                    for (int32_t i = 0; i < 8; ++i) {
+                        ScalarVector3i corner(x + (i & 1), y + ((i >> 1) & 1), z + (i >> 2));
+                        bbox.expand(to_local.transform_affine(
+                            ScalarPoint3f(fmadd(ScalarVector3f(corner), cell_size, m_aabb.min))));
+                    }
+
+                    majorants[index++] = m_sigmat->local_max(bbox);
+                }
+            }
+        }
+
+        m_majorants = DynamicBuffer<Float>::copy(majorants.data(), majorants.size());
     }
 
     UnpolarizedSpectrum
-    get_combined_extinction(const MediumInteraction3f & /* mi */,
+    get_combined_extinction(const MediumInteraction3f &mi,
                             Mask active) const override {
         // TODO: This could be a spectral quantity (at least in RGB mode)
-        MTS_MASKED_FUNCTION(ProfilerPhase::MediumEvaluate, active);
-        return m_max_density;
+        MTS_MASKED_METHOD(ProfilerPhase::MediumEvaluate, active);
+        if (m_majorant_res.x() == 0)
+            return m_max_density;
+
+        Vector3i cell = clamp(floor2int<Vector3i>((mi.p - m_aabb.min) * m_majorant_scale),
+                              0, m_majorant_res - 1);
+        return m_scale * majorant(cell, active);
+    }
+
+    /// Fetch the (unscaled) majorant of a cell of the supergrid
+    MTS_INLINE Float majorant(const Vector3i &cell, Mask active) const {
+        return gather<Float>(
+            m_majorants,
+            fmadd(fmadd(cell.z(), m_majorant_res.y(), cell.y()), m_majorant_res.x(), cell.x()),
+            active);
+    }
+
+    /**
+     * \brief Delta tracking against the majorant supergrid
+     *
+     * Traverses the cells of the supergrid along the ray (3D DDA), so that
+     * free-flight sampling takes large steps through sparse regions. Since the
+     * majorant is the same for all channels, the ratio of transmittance and
+     * free-flight PDF computed by the integrators only depends on the
+     * majorant at the sampled location. When the segment is left without
+     * an interaction, the returned majorant is the average along the
+     * traversed segment, which yields the exact transmittance of it.
+     */
+    std::pair<Float, UnpolarizedSpectrum>
+    sample_distance(const MediumInteraction3f &mi, const Ray3f &ray,
+                    Float mint, Float maxt, Float sample, UInt32 channel,
+                    Mask active) const override {
+        if (m_majorant_res.x() == 0)
+            return Base::sample_distance(mi, ray, mint, maxt, sample, channel, active);
+
+        // Ray in the coordinate system of the supergrid, where cells have unit size
+        ScalarVector3f res(m_majorant_res);
+        Point3f o  = (ray(mint) - m_aabb.min) * m_majorant_scale;
+        Vector3f d = ray.d * m_majorant_scale;
+
+        Vector3f cell  = clamp(floor(o), 0.f, res - 1.f),
+                 step  = select(d >= 0.f, Vector3f(1.f), Vector3f(-1.f)),
+                 delta = abs(rcp(d)),
+                 next  = select(neq(d, 0.f), (cell + max(step, 0.f) - o) / d,
+                                math::Infinity<Float>);
+
+        Float tau       = -enoki::log(1.f - sample),
+              t_max     = maxt - mint,
+              t         = 0.f,
+              depth_sum = 0.f,
+              sampled_t = math::Infinity<Float>,
+              sampled_majorant = 0.f;
+
+        Mask collided = false,
+             valid    = active;
+        while (any_or<true>(valid)) {
+            Float m      = m_scale * majorant(Vector3i(cell), valid),
+                  t_exit = max(min(hmin(next), t_max), t),
+                  depth  = m * (t_exit - t);
+
+            // Collision within the current cell
+            Mask collide = valid && depth >= tau && m > 0.f;
+            masked(sampled_t, collide) = mint + t + tau / m;
+            masked(sampled_majorant, collide) = m;
+            collided |= collide;
+            valid &= !collide;
+
+            masked(tau, valid) -= depth;
+            masked(depth_sum, valid) += depth;
+            masked(t, valid) = t_exit;
+            valid &= t_exit < t_max;
+
+            // Step into the neighboring cell across the closest boundary
+            Mask step_x = valid && next.x() <= min(next.y(), next.z()),
+                 step_y = valid && !step_x && next.y() <= next.z(),
+                 step_z = valid && !step_x && !step_y;
+            masked(cell.x(), step_x) += step.x();
+            masked(next.x(), step_x) += delta.x();
+            masked(cell.y(), step_y) += step.y();
+            masked(next.y(), step_y) += delta.y();
+            masked(cell.z(), step_z) += step.z();
+            masked(next.z(), step_z) += delta.z();
+            valid &= all((cell >= 0.f) & (cell < res));
+        }
+
+        masked(sampled_majorant, active && !collided) = select(t > 0.f, depth_sum / t, 0.f);
+        return { sampled_t, UnpolarizedSpectrum(sampled_majorant) };
     }
 
     std::tuple<UnpolarizedSpectrum, UnpolarizedSpectrum, UnpolarizedSpectrum>
     get_scattering_coefficients(const MediumInteraction3f &mi,
                                 Mask active) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::MediumEvaluate, active);
+        MTS_MASKED_METHOD(ProfilerPhase::MediumEvaluate, active);
         auto sigmat = m_scale * m_sigmat->eval(mi, active);
         auto sigmas = sigmat * m_albedo->eval(mi, active);
         auto sigman = get_combined_extinction(mi, active) - sigmat;
@@ -60,12 +199,17 @@ public:
         Base::traverse(callback);
     }
 
+    void parameters_changed(const std::vector<std::string> &/*keys*/) override {
+        update_majorants();
+    }
+
     std::string to_string() const override {
         std::ostringstream oss;
         oss << "HeterogeneousMedium[" << std::endl
             << "  albedo  = " << string::indent(m_albedo) << std::endl
             << "  sigma_t = " << string::indent(m_sigmat) << std::endl
             << "  scale   = " << string::indent(m_scale) << std::endl
+            << "  majorant_resolution = " << m_majorant_res << std::endl
             << "]";
         return oss.str();
     }
@@ -77,6 +221,12 @@ private:
 
     ScalarBoundingBox3f m_aabb;
     ScalarFloat m_max_density;
+
+    /* Optional: majorant supergrid storing the unscaled maximum extinction
+       of every cell. Disabled when 'm_majorant_res' is zero. */
+    DynamicBuffer<Float> m_majorants;
+    ScalarVector3i m_majorant_res;
+    ScalarVector3f m_majorant_scale;
 };
 
 MTS_IMPLEMENT_CLASS_VARIANT(HeterogeneousMedium, Medium)
@@ -34,14 +34,14 @@ public:
     UnpolarizedSpectrum
     get_combined_extinction(const MediumInteraction3f &mi,
                             Mask active) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::MediumEvaluate, active);
+        MTS_MASKED_METHOD(ProfilerPhase::MediumEvaluate, active);
         return eval_sigmat(mi);
     }
 
     std::tuple<UnpolarizedSpectrum, UnpolarizedSpectrum, UnpolarizedSpectrum>
     get_scattering_coefficients(const MediumInteraction3f &mi,
                                 Mask active) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::MediumEvaluate, active);
+        MTS_MASKED_METHOD(ProfilerPhase::MediumEvaluate, active);
         auto sigmat                = eval_sigmat(mi);
         auto sigmas                = sigmat * m_albedo->eval(mi, active);
         UnpolarizedSpectrum sigman = 0.f;
@@ -73,7 +73,8 @@ public:
     MTS_DECLARE_CLASS()
 private:
     ref<Volume> m_sigmat, m_albedo;
-    ScalarFloat m_scale;
+    /// Stored as an array so that updates of 'scale' don't require recompilation (GPU variants)
+    Float m_scale;
 };
 
 MTS_IMPLEMENT_CLASS_VARIANT(HomogeneousMedium, Medium)
@@ -0,0 +1,74 @@
+import numpy as np
+import pytest
+
+
+def write_grid(filename, values):
+    res = values.shape[::-1]
+    with open(filename, 'wb') as f:
+        f.write(b'VOL')
+        f.write(np.uint8(3).tobytes())
+        f.write(np.array([1, *res, 1], dtype=np.int32).tobytes())
+        f.write(np.array([0, 0, 0, 1, 1, 1], dtype=np.float32).tobytes())
+        f.write(values.astype(np.float32).tobytes())
+
+
+def ratio_tracking(medium, o, d, n):
+    """Estimate the transmittance along a ray through the medium"""
+    from mitsuba.core import Ray3f
+
+    np.random.seed(0)
+    result = 0.0
+    for i in range(n):
+        ray = Ray3f(o, d, 0.0, [])
+        tr = 1.0
+        while True:
+            mi = medium.sample_interaction(ray, np.random.rand(), 0)
+            if not mi.is_valid():
+                break
+            # The majorant bounds the extinction
+            assert mi.sigma_t[0] <= mi.combined_extinction[0] * (1 + 1e-5)
+            tr *= 1.0 - mi.sigma_t[0] / mi.combined_extinction[0]
+            ray = Ray3f(mi.p, d, 0.0, [])
+        result += tr
+    return result / n
+
+
+@pytest.mark.parametrize('volume', ['gridvolume', 'sparsegridvolume'])
+def test01_majorant_grid(variant_scalar_rgb, tmpdir, volume):
+    from mitsuba.core.xml import load_string
+
+    # Dense slab in the lower half (x < 0.5) of an otherwise empty grid
+    values = np.zeros((16, 16, 16))
+    values[:, :, :8] = 2.0
+    filename = str(tmpdir.join('slab.vol'))
+    write_grid(filename, values)
+
+    extra = '<integer name="brick_size" value="4"/>' if volume == 'sparsegridvolume' else ''
+
+    def load(resolution):
+        return load_string("""
+            <medium type="heterogeneous" version="2.0.0">
+                <integer name="majorant_resolution" value="%d"/>
+                <volume name="sigma_t" type="%s">
+                    <string name="filename" value="%s"/>
+                    <string name="filter_type" value="nearest"/>
+                    %s
+                </volume>
+            </medium>""" % (resolution, volume, filename, extra))
+
+    o, d = [-1, 0.5, 0.5], [1, 0, 0]
+    expected = np.exp(-2.0 * 0.5)
+    n = 2000
+
+    for resolution in [0, 16]:
+        medium = load(resolution)
+        assert np.isclose(ratio_tracking(medium, o, d, n), expected, atol=0.03)
+
+    # The supergrid bounds empty space by zero
+    from mitsuba.render import MediumInteraction3f
+    medium = load(16)
+    mi = MediumInteraction3f()
+    mi.p = [0.75, 0.5, 0.5]
+    assert medium.get_combined_extinction(mi)[0] == 0
+    mi.p = [0.25, 0.5, 0.5]
+    assert np.isclose(medium.get_combined_extinction(mi)[0], 2.0)
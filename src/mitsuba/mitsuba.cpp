@@ -1,19 +1,29 @@
 #include <mitsuba/core/argparser.h>
 #include <mitsuba/core/bitmap.h>
+#include <mitsuba/core/distributed.h>
 #include <mitsuba/core/filesystem.h>
 #include <mitsuba/core/fresolver.h>
 #include <mitsuba/core/fstream.h>
 #include <mitsuba/core/jit.h>
+#include <mitsuba/core/loadtrace.h>
 #include <mitsuba/core/logger.h>
+#include <mitsuba/core/mstream.h>
 #include <mitsuba/core/profiler.h>
+#include <mitsuba/core/statistics.h>
+#include <mitsuba/core/string.h>
 #include <mitsuba/core/thread.h>
+#include <mitsuba/core/timer.h>
 #include <mitsuba/core/util.h>
 #include <mitsuba/core/vector.h>
 #include <mitsuba/core/xml.h>
 #include <mitsuba/render/integrator.h>
 #include <mitsuba/render/records.h>
 #include <mitsuba/render/scene.h>
+#include <tbb/task_group.h>
 #include <tbb/task_scheduler_init.h>
+#include <fstream>
+#include <list>
+#include <thread>
 
 #if defined(MTS_ENABLE_OPTIX)
 #include <mitsuba/render/optix_api.h>
@@ -59,7 +69,11 @@ Options:
 
     -s <index>, --sensor <index>
         Index of the sensor to render with (following the declaration
-        order in the scene file). Default value: 0.
+        order in the scene file). Default value: 0. A comma-separated
+        list of indices and ranges (e.g. "0,3,5-9") or "all" renders
+        several sensors in sequence without reloading the scene. Their
+        images are then written as "<output>_<index>.exr", in the
+        background while the next sensor renders.
 
     -u, --update
         When specified, Mitsuba will update the scene's
@@ -68,47 +82,342 @@ Options:
     -a <path1>;<path2>;..
         Add one or more entries to the resource search path.
 
+    -c <directory>, --cache <directory>
+        Store binary snapshots of the parsed scene descriptions in the
+        specified directory, and reuse them while the scene files are
+        unchanged. This skips the XML parse when re-rendering large scenes.
+
     -o <filename>, --output <filename>
         Write the output image to the file "filename".
+
+    -P, --profile
+        Record a sampling profile of the rendering phases (scene loading,
+        ray intersections, BSDF and texture evaluations, ...) and print it
+        after rendering. The profiler adds no overhead when disabled.
+
+    -p, --profile-instances
+        Count and time the calls of every BSDF, emitter, texture, medium
+        and phase function instance, and print a report after rendering.
+
+    --profile-json <filename>
+        Like -p, but also write the per-instance report to a JSON file.
+
+    --trace <filename>
+        Record a timeline of scene loading, kd-tree construction, render
+        passes, image blocks and film development on every thread, and
+        write it to a JSON file in the Chrome trace event format (this can
+        be opened with chrome://tracing or https://ui.perfetto.dev).
+
+    --load-report <filename>
+        Record the creation time, thread, file size and decoded size of
+        every object of the scene, print the slowest objects and the
+        critical path of the loading, and write all of them to a JSON file.
+
+    --stats <filename>
+        Write machine-readable statistics of every rendered scene to a
+        JSON file: loading (parsing, object creation including the
+        acceleration data structure) and render times, the time per pass,
+        the number of primary, indirect and shadow rays, the ray
+        throughput, the sample count and the peak memory usage.
+
+    --coordinator <address>
+        Distribute the render over worker processes (e.g. on other
+        machines) that connect to the given ZeroMQ address, e.g.
+        "tcp://*:5555", and merge their results into the film.
+
+    --worker <address>
+        Render image blocks for the coordinator at the given address,
+        e.g. "tcp://render01:5555". The worker must load the same scene
+        and does not write an output image.
+
+    --device <index>
+        Render on the GPU with the given index (GPU variants). To render
+        on all GPUs of a machine, start one worker per device.
+
+    --hybrid <mode>
+        Render on the CPU and the GPU at the same time: the scene is also
+        loaded in the given GPU mode (e.g. "gpu_rgb"), which must have the
+        same color representation as the CPU mode selected with -m. Both
+        devices request image blocks from a shared queue, so that each
+        renders as many as its throughput allows, and their results are
+        merged into the film of the CPU scene.
+
+    --kernel-cache <dir>
+        Store the compiled OptiX pipeline and CUDA kernels in the given
+        directory (GPU variants), so that later jobs with the same scene
+        structure skip compilation. Can be shared by the machines of a
+        render farm. Equivalent to setting MTS_KERNEL_CACHE.
+
+    --server <address>
+        Run as a render server at the given ZeroMQ address, e.g.
+        "tcp://*:5556". The server keeps the most recently used scenes
+        (including their acceleration data structures) loaded, and
+        renders the requests of clients submitted with --submit. Scenes
+        are reloaded when their file changes. Scene files passed on the
+        command line are loaded in advance.
+
+    --submit <address>
+        Send the scene files to the render server at the given address
+        instead of rendering them locally, along with the -D and -s
+        options. The paths must be valid on the server. The images are
+        written to the local output files as they arrive.
 )";
 }
 
 std::function<void(void)> develop_callback;
 std::mutex develop_callback_mutex;
 
+/// Parse the argument of -s/--sensor: "all", or a list of indices and ranges like "0,3,5-9"
+static std::vector<size_t> parse_sensor_list(const std::string &spec, size_t sensor_count) {
+    std::vector<size_t> result;
+    if (spec == "all") {
+        for (size_t i = 0; i < sensor_count; ++i)
+            result.push_back(i);
+        return result;
+    }
+
+    for (const std::string &token : string::tokenize(spec, ",")) {
+        auto sep = token.find('-', 1);
+        char *end_ptr = nullptr;
+        long first = std::strtol(token.c_str(), &end_ptr, 10), last = first;
+        if (sep != std::string::npos && end_ptr == token.c_str() + sep)
+            last = std::strtol(token.c_str() + sep + 1, &end_ptr, 10);
+        if (token.empty() || *end_ptr != '\0' || first < 0 || last < first)
+            Throw("-s/--sensor: could not parse \"%s\"!", spec);
+        if ((size_t) last >= sensor_count)
+            Throw("Specified sensor index %i is out of bounds (the scene has %i sensors)!",
+                  last, sensor_count);
+        for (long i = first; i <= last; ++i)
+            result.push_back((size_t) i);
+    }
+    return result;
+}
+
+/// Block size of hybrid renders, which must suit both the CPU and the GPU
+static const uint32_t hybrid_block_size = 128;
+
 template <typename Float, typename Spectrum>
-bool render(Object *scene_, size_t sensor_i, filesystem::path filename) {
+bool render(Object *scene_, const std::string &sensor_spec, filesystem::path filename,
+            DistributedRole role, const std::string &address, bool hybrid = false,
+            RenderServer *server = nullptr) {
     auto *scene = dynamic_cast<Scene<Float, Spectrum> *>(scene_);
     if (!scene)
         Throw("Root element of the input file must be a <scene> tag!");
-    if (sensor_i >= scene->sensors().size())
-        Throw("Specified sensor index is out of bounds!");
-    auto sensor = scene->sensors()[sensor_i];
-    auto film = sensor->film();
-
-    filename.replace_extension("exr");
-    film->set_destination_file(filename);
+    std::vector<size_t> sensors = parse_sensor_list(sensor_spec, scene->sensors().size());
 
     auto integrator = scene->integrator();
     if (!integrator)
         Throw("No integrator specified for scene: %s", scene);
 
-    /* critical section */ {
-        std::lock_guard<std::mutex> guard(develop_callback_mutex);
-        develop_callback = [&]() { film->develop(); };
-    }
-    bool success = integrator->render(scene, sensor.get());
-    /* critical section */ {
-        std::lock_guard<std::mutex> guard(develop_callback_mutex);
-        develop_callback = nullptr;
+    auto *sampling_integrator =
+        dynamic_cast<SamplingIntegrator<Float, Spectrum> *>(integrator.get());
+    if (role != DistributedRole::None && !sampling_integrator)
+        Throw("Distributed rendering requires a sampling-based integrator!");
+
+    /* Images are written by background tasks while the next sensor renders.
+       A film that is referenced by several sensors must be written before
+       it is cleared again. */
+    ThreadEnvironment env;
+    tbb::task_group writes;
+    std::vector<const Film<Float, Spectrum> *> pending;
+    bool success = true;
+
+    for (size_t sensor_i : sensors) {
+        auto sensor = scene->sensors()[sensor_i];
+        ref<Film<Float, Spectrum>> film = sensor->film();
+        if (std::find(pending.begin(), pending.end(), film.get()) != pending.end()) {
+            writes.wait();
+            pending.clear();
+        }
+
+        fs::path dest = filename;
+        if (sensors.size() > 1) {
+            dest.replace_extension("");
+            dest = fs::path(dest.string() + "_" + std::to_string(sensor_i));
+        }
+        dest.replace_extension("exr");
+        film->set_destination_file(dest);
+
+        /* The coordinator of a hybrid render also renders on the CPU. Every
+           sensor has its own address, so that the GPU worker can't pick up
+           the blocks of another sensor. */
+        if (role != DistributedRole::None)
+            sampling_integrator->set_distributed(
+                role, hybrid ? address + "/" + std::to_string(sensor_i) : address,
+                hybrid && role == DistributedRole::Coordinator,
+                hybrid ? hybrid_block_size : 0);
+
+        // Workers have no image to write on SIGHUP (e.g. the GPU thread of a hybrid render)
+        bool holds_result = role != DistributedRole::Worker;
+        if (holds_result) {
+            std::lock_guard<std::mutex> guard(develop_callback_mutex);
+            develop_callback = [&]() { film->develop(); };
+        }
+        bool sensor_success = integrator->render(scene, sensor.get());
+        if (holds_result) {
+            std::lock_guard<std::mutex> guard(develop_callback_mutex);
+            develop_callback = nullptr;
+        }
+
+        if (!sensor_success) {
+            Log(Warn, "\U0000274C Rendering failed, result not saved.");
+            success = false;
+            break;
+        } else if (server) {
+            // Stream the image to the client of the render server
+            ref<MemoryStream> stream = new MemoryStream();
+            film->bitmap()->write(stream, Bitmap::FileFormat::OpenEXR);
+            std::vector<uint8_t> data(stream->size());
+            stream->seek(0);
+            stream->read(data.data(), data.size());
+            server->send_image(sensor_i, data.data(), data.size());
+        } else if (role != DistributedRole::Worker) { // The coordinator holds the result
+            pending.push_back(film.get());
+            writes.run([film, &env]() {
+                ScopedSetThreadEnvironment set_env(env);
+                film->develop();
+            });
+        }
     }
-    if (success)
-        film->develop();
-    else
-        Log(Warn, "\U0000274C Rendering failed, result not saved.");
+
+    writes.wait();
     return success;
 }
 
+/// Scene kept loaded by the render server
+struct CachedScene {
+    std::string key;
+    fs::path filename;
+    uint64_t mtime;
+    ref<Object> scene;
+};
+
+/// Number of scenes that the render server keeps loaded
+static const size_t server_cache_size = 8;
+
+/**
+ * Return the scene for the given file and parameters from the cache of the
+ * render server, loading it if it isn't cached or if the file has changed.
+ * The cache is ordered from the most to the least recently used scene.
+ */
+static ref<Object> load_cached(std::list<CachedScene> &cache, const fs::path &filename,
+                               const std::string &mode, xml::ParameterList params,
+                               const std::string &cache_dir) {
+    std::sort(params.begin(), params.end());
+    std::string key = mode + "\n" + fs::absolute(filename).string();
+    for (const auto &param : params)
+        key += "\n" + param.first + "=" + param.second;
+    uint64_t mtime = fs::last_write_time(filename);
+
+    for (auto it = cache.begin(); it != cache.end(); ++it) {
+        if (it->key != key)
+            continue;
+        if (it->mtime == mtime) {
+            cache.splice(cache.begin(), cache, it);
+            return cache.front().scene;
+        }
+        Log(Info, "Scene file \"%s\" has changed, reloading it.", filename.string());
+        cache.erase(it);
+        break;
+    }
+
+    // Add the scene file's directory to the search path while loading it
+    ref<Thread> thread = Thread::thread();
+    ref<FileResolver> fr = thread->file_resolver(),
+                      fr2 = new FileResolver(*fr);
+    fs::path scene_dir = filename.parent_path();
+    if (!fr2->contains(scene_dir))
+        fr2->append(scene_dir);
+    thread->set_file_resolver(fr2);
+
+    ref<Object> scene;
+    try {
+        scene = xml::load_file(filename.string(), mode, params, false, cache_dir);
+    } catch (...) {
+        thread->set_file_resolver(fr);
+        throw;
+    }
+    thread->set_file_resolver(fr);
+
+    cache.push_front({ key, filename, mtime, scene });
+    if (cache.size() > server_cache_size)
+        cache.pop_back();
+    return scene;
+}
+
+/// Process the requests of render clients until the process is terminated
+static void run_server(const std::string &address, const std::vector<fs::path> &preload,
+                       const std::string &mode, const xml::ParameterList &params,
+                       const std::string &cache_dir) {
+    std::list<CachedScene> cache;
+    for (const fs::path &filename : preload)
+        load_cached(cache, filename, mode, params, cache_dir);
+
+    ref<RenderServer> server = new RenderServer(address);
+    Log(Info, "Render server listening at \"%s\".", address);
+
+    RenderRequest request;
+    while (server->next(request, []() { return false; })) {
+        Log(Info, "Rendering \"%s\" (sensors: %s).", request.scene, request.sensors);
+        try {
+            // Parameters of the request override the ones of the command line
+            xml::ParameterList request_params = params;
+            for (const auto &param : request.parameters) {
+                auto it = std::find_if(request_params.begin(), request_params.end(),
+                                       [&](const auto &p) { return p.first == param.first; });
+                if (it != request_params.end())
+                    it->second = param.second;
+                else
+                    request_params.push_back(param);
+            }
+
+            Timer timer;
+            ref<Object> scene =
+                load_cached(cache, request.scene, mode, request_params, cache_dir);
+            Log(Info, "Scene ready after %s.", util::time_string(timer.value()));
+
+            bool success = MTS_INVOKE_VARIANT(mode, render, scene.get(), request.sensors,
+                                              fs::path(), DistributedRole::None,
+                                              std::string(), false, server.get());
+            server->finish(success ? "" : "rendering failed");
+        } catch (const std::exception &e) {
+            Log(Warn, "Request failed: %s", e.what());
+            server->finish(e.what());
+        }
+    }
+}
+
+/// Render a scene on a render server and write the images it sends back
+static void submit(const std::string &address, const std::string &scene,
+                   const std::string &sensor_spec, const xml::ParameterList &params,
+                   fs::path filename) {
+    RenderRequest request;
+    request.scene = scene;
+    request.sensors = sensor_spec;
+    request.parameters = params;
+
+    ref<RenderClient> client = new RenderClient(address);
+    client->submit(request);
+
+    // Image names follow the ones of a local render
+    bool single = !sensor_spec.empty() &&
+                  std::all_of(sensor_spec.begin(), sensor_spec.end(), ::isdigit);
+    filename.replace_extension("");
+
+    size_t sensor;
+    std::vector<uint8_t> data;
+    while (client->receive(sensor, data)) {
+        fs::path dest = single ? filename
+                               : fs::path(filename.string() + "_" + std::to_string(sensor));
+        dest.replace_extension("exr");
+        Log(Info, "Writing image \"%s\" ..", dest.string());
+        std::ofstream os(dest.string(), std::ios::binary);
+        os.write((const char *) data.data(), (std::streamsize) data.size());
+        if (!os.good())
+            Throw("Could not write \"%s\"!", dest.string());
+    }
+}
+
 #if !defined(__WINDOWS__)
 // Handle the hang-up signal and write a partially rendered image to disk
 void hup_signal_handler(int signal) {
@@ -142,6 +451,20 @@ int main(int argc, char *argv[]) {
     auto arg_help      = parser.add(StringVec{ "-h", "--help" });
     auto arg_mode      = parser.add(StringVec{ "-m", "--mode" }, true);
     auto arg_paths     = parser.add(StringVec{ "-a" }, true);
+    auto arg_cache     = parser.add(StringVec{ "-c", "--cache" }, true);
+    auto arg_profile   = parser.add(StringVec{ "-P", "--profile" }, false);
+    auto arg_instances = parser.add(StringVec{ "-p", "--profile-instances" }, false);
+    auto arg_json      = parser.add(StringVec{ "--profile-json" }, true);
+    auto arg_stats     = parser.add(StringVec{ "--stats" }, true);
+    auto arg_trace     = parser.add(StringVec{ "--trace" }, true);
+    auto arg_load      = parser.add(StringVec{ "--load-report" }, true);
+    auto arg_coord     = parser.add(StringVec{ "--coordinator" }, true);
+    auto arg_worker    = parser.add(StringVec{ "--worker" }, true);
+    auto arg_device    = parser.add(StringVec{ "--device" }, true);
+    auto arg_hybrid    = parser.add(StringVec{ "--hybrid" }, true);
+    auto arg_kcache    = parser.add(StringVec{ "--kernel-cache" }, true);
+    auto arg_server    = parser.add(StringVec{ "--server" }, true);
+    auto arg_submit    = parser.add(StringVec{ "--submit" }, true);
     auto arg_extra     = parser.add("", true);
     bool print_profile = false;
     xml::ParameterList params;
@@ -161,14 +484,17 @@ int main(int argc, char *argv[]) {
         // Parse all command line options
         parser.parse(argc, argv);
 
+        auto logger = Thread::thread()->logger();
         if (*arg_verbose) {
-            auto logger = Thread::thread()->logger();
             if (arg_verbose->next())
                 logger->set_log_level(Trace);
             else
                 logger->set_log_level(Debug);
         }
 
+        // Don't let rendering threads wait on the console
+        logger->set_asynchronous(true);
+
         while (arg_define && *arg_define) {
             std::string value = arg_define->as_string();
             auto sep = value.find('=');
@@ -179,15 +505,59 @@ int main(int argc, char *argv[]) {
             arg_define = arg_define->next();
         }
         std::string mode = (*arg_mode ? arg_mode->as_string() : MTS_DEFAULT_VARIANT);
+        std::string hybrid_mode = (*arg_hybrid ? arg_hybrid->as_string() : "");
+        if (!hybrid_mode.empty() &&
+            (string::starts_with(mode, "gpu") || !string::starts_with(hybrid_mode, "gpu")))
+            Throw("--hybrid: expected a CPU mode (-m) and a GPU mode (--hybrid)!");
 
 #if defined(MTS_ENABLE_OPTIX)
-        if (string::starts_with(mode, "gpu")) {
+        if (string::starts_with(mode, "gpu") || !hybrid_mode.empty()) {
+            /* Enoki and OptiX use the first visible device: restrict the
+               process to the requested one before they are initialized */
+            if (*arg_device) {
+                std::string device = std::to_string(arg_device->as_int());
+#if defined(__WINDOWS__)
+                _putenv_s("CUDA_VISIBLE_DEVICES", device.c_str());
+#else
+                setenv("CUDA_VISIBLE_DEVICES", device.c_str(), 1);
+#endif
+            }
+            if (*arg_kcache)
+                optix_set_cache_path(arg_kcache->as_string());
             cie_alloc();
             optix_initialize();
         }
 #endif
 
-        size_t sensor_i  = (*arg_sensor_i ? arg_sensor_i->as_int() : 0);
+        std::string sensor_spec = (*arg_sensor_i ? arg_sensor_i->as_string() : "0");
+
+        if (*arg_instances || *arg_json)
+            Profiler::set_instance_statistics(true);
+
+        if (*arg_stats)
+            Statistics::set_enabled(true);
+
+        if (*arg_profile || *arg_trace)
+            Profiler::set_enabled(true);
+
+        if (*arg_trace)
+            Profiler::set_tracing(true);
+
+        if (*arg_load)
+            LoadTrace::set_enabled(true);
+
+        DistributedRole role = DistributedRole::None;
+        std::string address;
+        if (*arg_coord && *arg_worker)
+            Throw("--coordinator and --worker are mutually exclusive!");
+        if (*arg_coord) {
+            role = DistributedRole::Coordinator;
+            address = arg_coord->as_string();
+        } else if (*arg_worker) {
+            role = DistributedRole::Worker;
+            address = arg_worker->as_string();
+        }
+        std::vector<std::string> stats;
 
         // Initialize Intel Thread Building Blocks with the requested number of threads
         if (*arg_threads)
@@ -212,7 +582,14 @@ int main(int argc, char *argv[]) {
             }
         }
 
-        if (!*arg_extra || *arg_help) {
+        if (*arg_server && (*arg_submit || role != DistributedRole::None))
+            Throw("--server cannot be combined with --submit, --coordinator or --worker!");
+        if (!hybrid_mode.empty() && (*arg_server || *arg_submit || role != DistributedRole::None))
+            Throw("--hybrid cannot be combined with --server, --submit, --coordinator "
+                  "or --worker!");
+        std::string cache_dir = *arg_cache ? arg_cache->as_string() : "";
+
+        if ((!*arg_extra && !*arg_server) || *arg_help) {
             help((int) __global_thread_count);
         } else {
             Log(Info, "%s", util::info_build((int) __global_thread_count));
@@ -224,6 +601,18 @@ int main(int argc, char *argv[]) {
 #endif
         }
 
+        if (*arg_server) {
+            std::vector<fs::path> preload;
+            for (auto arg = arg_extra; arg && *arg; arg = arg->next())
+                preload.push_back(arg->as_string());
+            run_server(arg_server->as_string(), preload, mode, params, cache_dir);
+            arg_extra = nullptr;
+        } else if (*arg_submit) {
+            for (; arg_extra && *arg_extra; arg_extra = arg_extra->next())
+                submit(arg_submit->as_string(), arg_extra->as_string(), sensor_spec, params,
+                       *arg_output ? arg_output->as_string() : arg_extra->as_string());
+        }
+
         while (arg_extra && *arg_extra) {
             filesystem::path filename(arg_extra->as_string());
             ref<FileResolver> fr2 = new FileResolver(*fr);
@@ -237,13 +626,72 @@ int main(int argc, char *argv[]) {
             if (*arg_output)
                 filename = arg_output->as_string();
 
+            Statistics::reset();
+            Timer timer;
+
             // Try and parse a scene from the passed file.
             ref<Object> parsed =
-                xml::load_file(arg_extra->as_string(), mode, params, *arg_update);
-
-            bool success = MTS_INVOKE_VARIANT(mode, render, parsed.get(),
-                                              sensor_i, filename);
+                xml::load_file(arg_extra->as_string(), mode, params, *arg_update, cache_dir);
+
+            bool success;
+            if (!hybrid_mode.empty()) {
+                /* The GPU scene renders as a worker of the CPU scene, which
+                   coordinates the render and holds the result */
+                ref<Object> parsed_gpu =
+                    xml::load_file(arg_extra->as_string(), hybrid_mode, params, false, cache_dir);
+                std::string hybrid_address = "inproc://hybrid";
+                std::string gpu_error;
+                ThreadEnvironment env;
+
+                std::thread gpu_thread([&]() {
+                    Thread::register_external_thread("gpu");
+                    /* scoped */ {
+                        ScopedSetThreadEnvironment set_env(env);
+                        try {
+                            MTS_INVOKE_VARIANT(hybrid_mode, render, parsed_gpu.get(),
+                                               sensor_spec, filename, DistributedRole::Worker,
+                                               hybrid_address, true);
+                        } catch (const std::exception &e) {
+                            gpu_error = e.what();
+                        }
+                    }
+                    Thread::unregister_external_thread();
+                });
+
+                try {
+                    success = MTS_INVOKE_VARIANT(mode, render, parsed.get(), sensor_spec,
+                                                 filename, DistributedRole::Coordinator,
+                                                 hybrid_address, true);
+                } catch (...) {
+                    gpu_thread.join();
+                    throw;
+                }
+                gpu_thread.join();
+
+                if (!gpu_error.empty())
+                    Log(Warn, "Rendering on the GPU failed, the CPU rendered the remaining "
+                        "image blocks: %s", gpu_error);
+            } else {
+                success = MTS_INVOKE_VARIANT(mode, render, parsed.get(),
+                                             sensor_spec, filename, role, address);
+            }
             print_profile = print_profile || success;
+
+            if (*arg_stats) {
+                Statistics::add_time("total", (float) timer.value());
+                stats.push_back(Statistics::to_json(arg_extra->as_string()));
+
+                // Rewrite the whole file, so that it is complete after every frame
+                std::ofstream os(arg_stats->as_string());
+                if (!os.good())
+                    Throw("Could not write statistics to \"%s\"!", arg_stats->as_string());
+                os << "[" << std::endl;
+                for (size_t i = 0; i < stats.size(); ++i)
+                    os << "  " << string::indent(stats[i]) << (i + 1 < stats.size() ? "," : "")
+                       << std::endl;
+                os << "]" << std::endl;
+            }
+
             arg_extra = arg_extra->next();
         }
     } catch (const std::exception &e) {
@@ -252,6 +700,9 @@ int main(int argc, char *argv[]) {
         error_msg = std::string("Caught a critical exception of unknown type!");
     }
 
+    // Deliver pending log messages before printing anything else
+    Thread::thread()->logger()->set_asynchronous(false);
+
     if (!error_msg.empty()) {
         /* Strip zero-width spaces from the message (Mitsuba uses these
            to properly format chains of multiple exceptions) */
@@ -279,9 +730,35 @@ int main(int argc, char *argv[]) {
 #endif
     }
 
+    if (*arg_trace) {
+        try {
+            Profiler::write_trace(arg_trace->as_string());
+        } catch (const std::exception &e) {
+            std::cerr << e.what() << std::endl;
+        }
+    }
+
+    if (*arg_load) {
+        LoadTrace::print_report();
+        try {
+            LoadTrace::write_json(arg_load->as_string());
+        } catch (const std::exception &e) {
+            std::cerr << e.what() << std::endl;
+        }
+    }
+
     Profiler::static_shutdown();
-    if (print_profile)
+    if (print_profile) {
         Profiler::print_report();
+        Profiler::print_instance_report();
+        if (*arg_json) {
+            try {
+                Profiler::write_instance_report(arg_json->as_string());
+            } catch (const std::exception &e) {
+                std::cerr << e.what() << std::endl;
+            }
+        }
+    }
     Bitmap::static_shutdown();
     Logger::static_shutdown();
     Thread::static_shutdown();
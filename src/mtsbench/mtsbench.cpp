@@ -0,0 +1,555 @@
+#include <mitsuba/core/argparser.h>
+#include <mitsuba/core/bitmap.h>
+#include <mitsuba/core/distr_2d.h>
+#include <mitsuba/core/filesystem.h>
+#include <mitsuba/core/fresolver.h>
+#include <mitsuba/core/jit.h>
+#include <mitsuba/core/logger.h>
+#include <mitsuba/core/plugin.h>
+#include <mitsuba/core/profiler.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/random.h>
+#include <mitsuba/core/string.h>
+#include <mitsuba/core/struct.h>
+#include <mitsuba/core/thread.h>
+#include <mitsuba/core/util.h>
+#include <mitsuba/core/warp.h>
+#include <mitsuba/core/xml.h>
+#include <mitsuba/render/film.h>
+#include <mitsuba/render/imageblock.h>
+#include <mitsuba/render/integrator.h>
+#include <mitsuba/render/mesh.h>
+#include <mitsuba/render/scene.h>
+#include <mitsuba/render/sensor.h>
+#include <tbb/task_scheduler_init.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+
+#if defined(MTS_ENABLE_OPTIX)
+#include <mitsuba/render/optix_api.h>
+#endif
+
+/*
+ * Benchmark suite for the performance-critical parts of Mitsuba. Every
+ * benchmark runs a fixed workload several times and reports the median time
+ * and throughput. The results can be written to a JSON file, whose layout
+ * follows the one of Google Benchmark so that existing tooling for comparing
+ * runs can be used.
+ */
+
+using namespace mitsuba;
+
+static void help(int thread_count) {
+    std::cout << util::info_build(thread_count) << std::endl;
+    std::cout << R"(
+Usage: mtsbench [options]
+
+Options:
+
+    -h, --help
+        Display this help text.
+
+    -m, --mode
+        Rendering mode (variant) to benchmark. The micro-benchmarks of
+        individual components only run in scalar modes, the end-to-end
+        rendering benchmark runs in every mode.
+
+        Default: )" MTS_DEFAULT_VARIANT R"(
+
+        Available modes:
+              )" << string::indent(MTS_VARIANTS, 14) << R"(
+
+    -t <count>, --threads <count>
+        Number of threads used by the multi-threaded benchmarks.
+
+    -f <string>, --filter <string>
+        Only run the benchmarks whose name contains the given string.
+
+    -r <count>, --repetitions <count>
+        Number of timed repetitions of every benchmark. Default: 5.
+
+    -o <filename>, --output <filename>
+        Write the results to a JSON file.
+)";
+}
+
+struct BenchmarkResult {
+    std::string name;
+    size_t repetitions;
+    double median_ms, min_ms, max_ms;
+    double items_per_second;
+};
+
+class Benchmarks {
+public:
+    Benchmarks(const std::string &filter, size_t repetitions)
+        : m_filter(filter), m_repetitions(repetitions) { }
+
+    /// Is the benchmark \c name selected by the filter?
+    bool enabled(const std::string &name) const {
+        return m_filter.empty() || name.find(m_filter) != std::string::npos;
+    }
+
+    /**
+     * \brief Time a benchmark
+     *
+     * \c setup is invoked before every repetition and excluded from the
+     * measurement, \c func performs \c items units of work. A first untimed
+     * run warms up caches and JIT-compiled code.
+     */
+    template <typename Setup, typename Func>
+    void run(const std::string &name, size_t items, Setup setup, Func func) {
+        if (!enabled(name))
+            return;
+
+        std::vector<double> times;
+        for (size_t i = 0; i <= m_repetitions; ++i) {
+            setup();
+            auto start = std::chrono::high_resolution_clock::now();
+            func();
+            auto end = std::chrono::high_resolution_clock::now();
+            if (i > 0)
+                times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+        }
+        std::sort(times.begin(), times.end());
+
+        BenchmarkResult result;
+        result.name             = name;
+        result.repetitions      = times.size();
+        result.median_ms        = times[times.size() / 2];
+        result.min_ms           = times.front();
+        result.max_ms           = times.back();
+        result.items_per_second = items / (result.median_ms * 1e-3);
+        m_results.push_back(result);
+
+        std::cout << tfm::format("%-40s %12.3f ms %16.0f items/s", name,
+                                 result.median_ms, result.items_per_second)
+                  << std::endl;
+    }
+
+    template <typename Func> void run(const std::string &name, size_t items, Func func) {
+        run(name, items, []() { }, func);
+    }
+
+    /// Write the results in the JSON format of Google Benchmark
+    void write_json(const fs::path &filename, const std::string &variant,
+                    size_t thread_count) const {
+        std::ofstream os(filename.string());
+        if (!os.good())
+            Throw("Could not write benchmark results to \"%s\"!", filename);
+
+        os << "{" << std::endl
+           << "  \"context\": {" << std::endl
+           << "    \"variant\": \"" << variant << "\"," << std::endl
+           << "    \"num_threads\": " << thread_count << "," << std::endl
+           << "    \"repetitions\": " << m_repetitions << std::endl
+           << "  }," << std::endl
+           << "  \"benchmarks\": [" << std::endl;
+        for (size_t i = 0; i < m_results.size(); ++i) {
+            const BenchmarkResult &r = m_results[i];
+            os << "    {" << std::endl
+               << "      \"name\": \"" << r.name << "\"," << std::endl
+               << "      \"iterations\": " << r.repetitions << "," << std::endl
+               << "      \"real_time\": " << r.median_ms << "," << std::endl
+               << "      \"min_time\": " << r.min_ms << "," << std::endl
+               << "      \"max_time\": " << r.max_ms << "," << std::endl
+               << "      \"time_unit\": \"ms\"," << std::endl
+               << "      \"items_per_second\": " << r.items_per_second << std::endl
+               << "    }" << (i + 1 < m_results.size() ? "," : "") << std::endl;
+        }
+        os << "  ]" << std::endl << "}" << std::endl;
+    }
+
+private:
+    std::string m_filter;
+    size_t m_repetitions;
+    std::vector<BenchmarkResult> m_results;
+};
+
+/// Tessellated and displaced sphere with 2 * res * res triangles
+template <typename Float, typename Spectrum>
+ref<Mesh<Float, Spectrum>> make_mesh(uint32_t res) {
+    MTS_IMPORT_TYPES(Mesh)
+    using InputFloat = typename Mesh::InputFloat;
+
+    uint32_t vertex_count = (res + 1) * (res + 1), face_count = 2 * res * res;
+    ref<Mesh> mesh = new Mesh("bench_mesh", vertex_count, face_count);
+
+    InputFloat *positions = (InputFloat *) mesh->vertex_positions_buffer().data();
+    for (uint32_t y = 0; y <= res; ++y) {
+        for (uint32_t x = 0; x <= res; ++x) {
+            float theta = math::Pi<float> * y / res, phi = 2.f * math::Pi<float> * x / res,
+                  r = 1.f + .1f * std::sin(13.f * theta) * std::cos(17.f * phi);
+            *positions++ = r * std::sin(theta) * std::cos(phi);
+            *positions++ = r * std::sin(theta) * std::sin(phi);
+            *positions++ = r * std::cos(theta);
+        }
+    }
+
+    ScalarUInt32 *faces = (ScalarUInt32 *) mesh->faces_buffer().data();
+    for (uint32_t y = 0; y < res; ++y) {
+        for (uint32_t x = 0; x < res; ++x) {
+            uint32_t i00 = y * (res + 1) + x, i10 = i00 + 1,
+                     i01 = i00 + res + 1, i11 = i01 + 1;
+            *faces++ = i00; *faces++ = i10; *faces++ = i11;
+            *faces++ = i00; *faces++ = i11; *faces++ = i01;
+        }
+    }
+
+    mesh->recompute_bbox();
+    return mesh;
+}
+
+/// Micro-benchmarks of individual components (scalar variants only)
+template <typename Float, typename Spectrum>
+void run_micro_benchmarks(Benchmarks &bench) {
+    MTS_IMPORT_TYPES(Scene, Sensor, Integrator, ImageBlock, ReconstructionFilter)
+    PluginManager *pmgr = PluginManager::instance();
+    PCG32<UInt32> rng;
+
+    // ------------------------------------------------------------------
+    // Kd-tree construction and ray queries
+    // ------------------------------------------------------------------
+
+    const uint32_t mesh_res = 512, ray_count = 1000000;
+    ref<Scene> scene;
+    auto make_scene = [&]() {
+        Properties props("scene");
+        props.set_object("mesh", make_mesh<Float, Spectrum>(mesh_res).get());
+        props.set_object("sensor", pmgr->create_object<Sensor>(Properties("perspective")).get());
+        props.set_object("integrator", pmgr->create_object<Integrator>(Properties("path")).get());
+        return new Scene(props);
+    };
+
+    bench.run("kdtree/build", 2 * mesh_res * mesh_res,
+              [&]() { scene = nullptr; }, [&]() { scene = make_scene(); });
+
+    if (bench.enabled("kdtree/")) {
+        if (!scene)
+            scene = make_scene();
+
+        // Rays between random points on a sphere that encloses the mesh
+        std::vector<Ray3f> rays;
+        rays.reserve(ray_count);
+        for (uint32_t i = 0; i < ray_count; ++i) {
+            Point3f o = 2.f * warp::square_to_uniform_sphere(
+                                  Point2f(rng.next_float32(), rng.next_float32())),
+                    t = .5f * warp::square_to_uniform_sphere(
+                                  Point2f(rng.next_float32(), rng.next_float32()));
+            rays.emplace_back(o, normalize(t - o), 0.f, zero<Wavelength>());
+        }
+
+        size_t hits = 0;
+        bench.run("kdtree/ray_intersect", ray_count, [&]() {
+            for (const Ray3f &ray : rays)
+                hits += scene->ray_intersect(ray).is_valid();
+        });
+        bench.run("kdtree/ray_intersect_preliminary", ray_count, [&]() {
+            for (const Ray3f &ray : rays)
+                hits += scene->ray_intersect_preliminary(ray).is_valid();
+        });
+        bench.run("kdtree/ray_test", ray_count, [&]() {
+            for (const Ray3f &ray : rays)
+                hits += scene->ray_test(ray);
+        });
+        Log(Debug, "%i hits", hits);
+    }
+    scene = nullptr;
+
+    // ------------------------------------------------------------------
+    // ImageBlock::put() throughput per reconstruction filter
+    // ------------------------------------------------------------------
+
+    const uint32_t sample_count = 1000000, block_size = 256, channels = 5;
+    std::vector<Point2f> positions(sample_count);
+    for (Point2f &p : positions)
+        p = Point2f(rng.next_float32(), rng.next_float32()) * (float) block_size;
+    Float value[channels] = { .5f, .25f, .125f, 1.f, 1.f };
+
+    for (const char *filter : { "box", "tent", "gaussian", "mitchell", "catmullrom", "lanczos" }) {
+        std::string name = std::string("imageblock/put/") + filter;
+        if (!bench.enabled(name))
+            continue;
+        ref<ReconstructionFilter> rfilter =
+            pmgr->create_object<ReconstructionFilter>(Properties(filter));
+        ref<ImageBlock> block =
+            new ImageBlock(ScalarVector2i(block_size), channels, rfilter.get());
+        bench.run(name, sample_count, [&]() { block->clear(); }, [&]() {
+            for (const Point2f &p : positions)
+                block->put(p, value);
+        });
+    }
+
+    // ------------------------------------------------------------------
+    // Bitmap loading, conversion and resampling
+    // ------------------------------------------------------------------
+
+    const uint32_t bitmap_size = 2048;
+    const size_t pixel_count = (size_t) bitmap_size * bitmap_size;
+    ref<Bitmap> bitmap = new Bitmap(Bitmap::PixelFormat::RGBA, Struct::Type::Float32,
+                                    ScalarVector2u(bitmap_size));
+    float *data = (float *) bitmap->data();
+    for (size_t i = 0; i < pixel_count * 4; ++i)
+        data[i] = rng.next_float32();
+
+    for (const char *ext : { "exr", "png" }) {
+        std::string name = std::string("bitmap/load_") + ext;
+        if (!bench.enabled(name))
+            continue;
+        fs::path filename = std::string("mtsbench_tmp.") + ext;
+        if (std::string(ext) == "exr")
+            bitmap->write(filename);
+        else
+            bitmap->convert(Bitmap::PixelFormat::RGBA, Struct::Type::UInt8, true)
+                ->write(filename);
+        bench.run(name, pixel_count, [&]() { ref<Bitmap> b = new Bitmap(filename); });
+        fs::remove(filename);
+    }
+
+    bench.run("bitmap/convert_srgb8", pixel_count, [&]() {
+        bitmap->convert(Bitmap::PixelFormat::RGBA, Struct::Type::UInt8, true);
+    });
+    bench.run("bitmap/convert_half", pixel_count, [&]() {
+        bitmap->convert(Bitmap::PixelFormat::RGB, Struct::Type::Float16, false);
+    });
+
+    if (bench.enabled("bitmap/resample")) {
+        ref<Bitmap::ReconstructionFilter> rfilter =
+            pmgr->create_object<Bitmap::ReconstructionFilter>(Properties("lanczos"));
+        bench.run("bitmap/resample_half", pixel_count, [&]() {
+            bitmap->resample(ScalarVector2u(bitmap_size / 2), rfilter.get());
+        });
+        bench.run("bitmap/resample_double", pixel_count, [&]() {
+            bitmap->resample(ScalarVector2u(bitmap_size * 2), rfilter.get());
+        });
+    }
+
+    // ------------------------------------------------------------------
+    // StructConverter (JIT-compiled where available)
+    // ------------------------------------------------------------------
+
+    if (bench.enabled("struct_converter/")) {
+        ref<Struct> s1 = new Struct(), s2 = new Struct(), s3 = new Struct();
+        for (const char *ch : { "r", "g", "b", "a" }) {
+            s1->append(ch, Struct::Type::Float32);
+            s2->append(ch, Struct::Type::UInt8, Struct::Flags::Normalized | Struct::Flags::Gamma);
+            s3->append(ch, Struct::Type::Float16);
+        }
+
+        std::unique_ptr<uint8_t[]> target(new uint8_t[pixel_count * 8]);
+        ref<StructConverter> to_srgb8 = new StructConverter(s1, s2),
+                             to_half  = new StructConverter(s1, s3);
+        bench.run("struct_converter/float32_to_srgb8", pixel_count, [&]() {
+            to_srgb8->convert(pixel_count, data, target.get());
+        });
+        bench.run("struct_converter/float32_to_float16", pixel_count, [&]() {
+            to_half->convert(pixel_count, data, target.get());
+        });
+    }
+
+    // ------------------------------------------------------------------
+    // Hierarchical2D sample warping
+    // ------------------------------------------------------------------
+
+    if (bench.enabled("hierarchical2d/")) {
+        const uint32_t width = 1024, height = 512;
+        std::vector<ScalarFloat> pdf(width * height);
+        for (ScalarFloat &v : pdf)
+            v = rng.next_float32();
+
+        std::vector<Point2f> samples(sample_count);
+        for (Point2f &p : samples)
+            p = Point2f(rng.next_float32(), rng.next_float32());
+
+        Hierarchical2D<Float, 0> distr;
+        bench.run("hierarchical2d/build", width * height, [&]() {
+            distr = Hierarchical2D<Float, 0>(pdf.data(), ScalarVector2u(width, height));
+        });
+
+        Float accum = 0.f;
+        bench.run("hierarchical2d/sample", sample_count, [&]() {
+            for (const Point2f &p : samples)
+                accum += distr.sample(p).second;
+        });
+        bench.run("hierarchical2d/eval", sample_count, [&]() {
+            for (const Point2f &p : samples)
+                accum += distr.eval(p);
+        });
+        Log(Debug, "%f", accum);
+    }
+}
+
+/// End-to-end render of a fixed reference scene (all variants)
+template <typename Float, typename Spectrum>
+void run_render_benchmark(Benchmarks &bench, const std::string &variant) {
+    MTS_IMPORT_TYPES(Scene)
+    const uint32_t size = 256, spp = 16;
+
+    std::string name = "render/path/" + variant;
+    if (!bench.enabled(name))
+        return;
+
+    ref<Object> parsed = xml::load_string(tfm::format(R"(
+        <scene version="2.0.0">
+            <integrator type="path">
+                <integer name="max_depth" value="6"/>
+            </integrator>
+            <sensor type="perspective">
+                <float name="fov" value="40"/>
+                <transform name="to_world">
+                    <lookat origin="0, 0, 3.9" target="0, 0, 0" up="0, 1, 0"/>
+                </transform>
+                <sampler type="independent">
+                    <integer name="sample_count" value="%i"/>
+                </sampler>
+                <film type="hdrfilm">
+                    <integer name="width" value="%i"/>
+                    <integer name="height" value="%i"/>
+                    <rfilter type="gaussian"/>
+                </film>
+            </sensor>
+            <bsdf type="diffuse" id="white"/>
+            <bsdf type="diffuse" id="red">
+                <rgb name="reflectance" value=".6, .1, .1"/>
+            </bsdf>
+            <bsdf type="diffuse" id="green">
+                <rgb name="reflectance" value=".1, .6, .1"/>
+            </bsdf>
+            <shape type="rectangle">
+                <transform name="to_world">
+                    <rotate x="1" angle="-90"/> <translate y="-1"/>
+                </transform>
+                <ref id="white"/>
+            </shape>
+            <shape type="rectangle">
+                <transform name="to_world">
+                    <rotate x="1" angle="90"/> <translate y="1"/>
+                </transform>
+                <ref id="white"/>
+            </shape>
+            <shape type="rectangle">
+                <transform name="to_world"> <translate z="-1"/> </transform>
+                <ref id="white"/>
+            </shape>
+            <shape type="rectangle">
+                <transform name="to_world">
+                    <rotate y="1" angle="90"/> <translate x="-1"/>
+                </transform>
+                <ref id="red"/>
+            </shape>
+            <shape type="rectangle">
+                <transform name="to_world">
+                    <rotate y="1" angle="-90"/> <translate x="1"/>
+                </transform>
+                <ref id="green"/>
+            </shape>
+            <shape type="rectangle">
+                <transform name="to_world">
+                    <rotate x="1" angle="90"/> <scale value=".25"/> <translate y=".99"/>
+                </transform>
+                <emitter type="area">
+                    <rgb name="radiance" value="15, 15, 15"/>
+                </emitter>
+            </shape>
+            <shape type="sphere">
+                <point name="center" x="-.4" y="-.6" z="-.3"/>
+                <float name="radius" value=".4"/>
+                <bsdf type="conductor"/>
+            </shape>
+            <shape type="sphere">
+                <point name="center" x=".45" y="-.65" z=".3"/>
+                <float name="radius" value=".35"/>
+                <bsdf type="dielectric"/>
+            </shape>
+        </scene>)", spp, size, size), variant);
+
+    ref<Scene> scene = dynamic_cast<Scene *>(parsed.get());
+    ref<Sensor<Float, Spectrum>> sensor = scene->sensors()[0];
+
+    bench.run(name, (size_t) size * size * spp, [&]() {
+        if (!scene->integrator()->render(scene, sensor))
+            Throw("Rendering failed!");
+    });
+}
+
+template <typename Float, typename Spectrum>
+bool run_benchmarks(Benchmarks &bench, const std::string &variant) {
+    if constexpr (!is_array_v<Float>)
+        run_micro_benchmarks<Float, Spectrum>(bench);
+    run_render_benchmark<Float, Spectrum>(bench, variant);
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    Jit::static_initialization();
+    Class::static_initialization();
+    Thread::static_initialization();
+    Logger::static_initialization();
+    Bitmap::static_initialization();
+    Profiler::static_initialization();
+
+    // Ensure that the mitsuba-render shared library is loaded
+    librender_nop();
+
+    ArgParser parser;
+    using StringVec  = std::vector<std::string>;
+    auto arg_threads = parser.add(StringVec{ "-t", "--threads" }, true);
+    auto arg_verbose = parser.add(StringVec{ "-v", "--verbose" }, false);
+    auto arg_mode    = parser.add(StringVec{ "-m", "--mode" }, true);
+    auto arg_filter  = parser.add(StringVec{ "-f", "--filter" }, true);
+    auto arg_reps    = parser.add(StringVec{ "-r", "--repetitions" }, true);
+    auto arg_output  = parser.add(StringVec{ "-o", "--output" }, true);
+    auto arg_help    = parser.add(StringVec{ "-h", "--help" });
+    int exit_code = 0;
+
+    try {
+        parser.parse(argc, argv);
+
+        auto logger = Thread::thread()->logger();
+        logger->set_log_level(*arg_verbose ? Debug : Warn);
+
+        if (*arg_threads)
+            __global_thread_count = arg_threads->as_int();
+        if (__global_thread_count < 1)
+            Throw("Thread count must be >= 1!");
+        tbb::task_scheduler_init init((int) __global_thread_count);
+
+        if (*arg_help) {
+            help((int) __global_thread_count);
+        } else {
+            std::string mode = *arg_mode ? arg_mode->as_string() : MTS_DEFAULT_VARIANT;
+#if defined(MTS_ENABLE_OPTIX)
+            if (string::starts_with(mode, "gpu")) {
+                cie_alloc();
+                optix_initialize();
+            }
+#endif
+            ref<FileResolver> fr = Thread::thread()->file_resolver();
+            fs::path base_path = util::library_path().parent_path();
+            if (!fr->contains(base_path))
+                fr->append(base_path);
+
+            int repetitions = *arg_reps ? arg_reps->as_int() : 5;
+            if (repetitions < 1)
+                Throw("Repetition count must be >= 1!");
+
+            Benchmarks bench(*arg_filter ? arg_filter->as_string() : "", (size_t) repetitions);
+            MTS_INVOKE_VARIANT(mode, run_benchmarks, bench, mode);
+
+            if (*arg_output)
+                bench.write_json(arg_output->as_string(), mode, __global_thread_count);
+        }
+    } catch (const std::exception &e) {
+        std::cerr << "Caught a critical exception: " << e.what() << std::endl;
+        exit_code = -1;
+    }
+
+    Profiler::static_shutdown();
+    Bitmap::static_shutdown();
+    Logger::static_shutdown();
+    Thread::static_shutdown();
+    Class::static_shutdown();
+    Jit::static_shutdown();
+    return exit_code;
+}
@@ -0,0 +1,167 @@
+#include <mitsuba/core/argparser.h>
+#include <mitsuba/core/bitmap.h>
+#include <mitsuba/core/filesystem.h>
+#include <mitsuba/core/fresolver.h>
+#include <mitsuba/core/jit.h>
+#include <mitsuba/core/logger.h>
+#include <mitsuba/core/plugin.h>
+#include <mitsuba/core/profiler.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/string.h>
+#include <mitsuba/core/thread.h>
+#include <mitsuba/core/timer.h>
+#include <mitsuba/core/util.h>
+#include <mitsuba/render/scene.h>
+#include <mitsuba/render/texture.h>
+#include <tbb/task_scheduler_init.h>
+
+/*
+ * Offline conversion of images into the tiled, MIP-mapped texture format
+ * (.mtex) of the texture cache. The conversion is performed by the 'bitmap'
+ * texture plugin of the selected variant, hence the resulting files store
+ * exactly the data that the plugin would otherwise compute at load time
+ * (linear colors, or spectral upsampling coefficients in spectral variants).
+ */
+
+using namespace mitsuba;
+
+static void help(int thread_count) {
+    std::cout << util::info_build(thread_count) << std::endl;
+    std::cout << R"(
+Usage: mtsimgconvert [options] <One or more image files>
+
+Converts PNG, JPEG, OpenEXR, or any other image format supported by the bitmap
+texture plugin into tiled texture files, which can be loaded by specifying them
+as the 'filename' of a bitmap texture.
+
+Options:
+
+    -h, --help
+        Display this help text.
+
+    -m, --mode
+        Rendering mode for which the textures are converted. Only single
+        precision scalar modes support tiled textures.
+
+        Default: )" MTS_DEFAULT_VARIANT R"(
+
+        Available modes:
+              )" << string::indent(MTS_VARIANTS, 14) << R"(
+
+    -r, --raw
+        Disable the transformation of the stored color data (e.g. sRGB to
+        linear, spectral upsampling), see the 'raw' parameter of the
+        bitmap texture.
+
+    -o <filename>, --output <filename>
+        Name of the output file when converting a single image.
+        Default: the name of the image, with the extension ".mtex".
+
+    -t <count>, --threads <count>
+        Number of threads used for decoding the images.
+
+    -v, --verbose
+        Be more verbose.
+)";
+}
+
+template <typename Float, typename Spectrum>
+void convert(const fs::path &input, const fs::path &output, bool raw) {
+    using Texture = mitsuba::Texture<Float, Spectrum>;
+
+    Properties props("bitmap");
+    props.set_string("filename", input.string());
+    props.set_string("tiled_filename", output.string());
+    props.set_bool("raw", raw);
+    ref<Texture> texture = PluginManager::instance()->create_object<Texture>(props);
+}
+
+int main(int argc, char *argv[]) {
+    Jit::static_initialization();
+    Class::static_initialization();
+    Thread::static_initialization();
+    Logger::static_initialization();
+    Bitmap::static_initialization();
+    Profiler::static_initialization();
+
+    // Ensure that the mitsuba-render shared library is loaded
+    librender_nop();
+
+    ArgParser parser;
+    using StringVec  = std::vector<std::string>;
+    auto arg_threads = parser.add(StringVec{ "-t", "--threads" }, true);
+    auto arg_verbose = parser.add(StringVec{ "-v", "--verbose" }, false);
+    auto arg_mode    = parser.add(StringVec{ "-m", "--mode" }, true);
+    auto arg_raw     = parser.add(StringVec{ "-r", "--raw" }, false);
+    auto arg_output  = parser.add(StringVec{ "-o", "--output" }, true);
+    auto arg_help    = parser.add(StringVec{ "-h", "--help" });
+    auto arg_extra   = parser.add("", true);
+    int exit_code = 0;
+
+    try {
+        parser.parse(argc, argv);
+
+        auto logger = Thread::thread()->logger();
+        logger->set_log_level(*arg_verbose ? Debug : Info);
+
+        if (*arg_threads)
+            __global_thread_count = arg_threads->as_int();
+        if (__global_thread_count < 1)
+            Throw("Thread count must be >= 1!");
+        tbb::task_scheduler_init init((int) __global_thread_count);
+
+        if (!*arg_extra || *arg_help) {
+            help((int) __global_thread_count);
+        } else {
+            std::string mode = *arg_mode ? arg_mode->as_string() : MTS_DEFAULT_VARIANT;
+            if (!string::starts_with(mode, "scalar") || string::ends_with(mode, "double"))
+                Throw("Tiled textures are only supported by single precision "
+                      "scalar modes, \"%s\" is not one of them!", mode);
+
+            ref<FileResolver> fr = Thread::thread()->file_resolver();
+            fs::path base_path = util::library_path().parent_path();
+            if (!fr->contains(base_path))
+                fr->append(base_path);
+
+            if (*arg_output && arg_extra->next() && *arg_extra->next())
+                Throw("The output filename can only be specified when "
+                      "converting a single image!");
+
+            for (; arg_extra && *arg_extra; arg_extra = arg_extra->next()) {
+                fs::path input = arg_extra->as_string(), output;
+                if (*arg_output) {
+                    output = arg_output->as_string();
+                } else {
+                    output = input;
+                    output.replace_extension(".mtex");
+                }
+                if (output == input)
+                    Throw("\"%s\": the output would overwrite the input!", input.string());
+
+                // Always convert anew, an existing file may be stale
+                if (fs::exists(output))
+                    fs::remove(output);
+
+                Timer timer;
+                MTS_INVOKE_VARIANT(mode, convert, input, output, (bool) *arg_raw);
+                if (!fs::exists(output))
+                    Throw("\"%s\": the conversion failed!", input.string());
+
+                Log(Info, "\"%s\": wrote \"%s\" (%s, took %s)", input.string(),
+                    output.string(), util::mem_string(fs::file_size(output)),
+                    util::time_string(timer.value()));
+            }
+        }
+    } catch (const std::exception &e) {
+        std::cerr << "Caught a critical exception: " << e.what() << std::endl;
+        exit_code = -1;
+    }
+
+    Profiler::static_shutdown();
+    Bitmap::static_shutdown();
+    Logger::static_shutdown();
+    Thread::static_shutdown();
+    Class::static_shutdown();
+    Jit::static_shutdown();
+    return exit_code;
+}
@@ -56,7 +56,7 @@ public:
     std::pair<Vector3f, Float> sample(const PhaseFunctionContext & /* ctx */,
                                       const MediumInteraction3f &mi, const Point2f &sample,
                                       Mask active) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::PhaseFunctionSample, active);
+        MTS_MASKED_METHOD(ProfilerPhase::PhaseFunctionSample, active);
 
         Float cos_theta;
         if (std::abs(m_g) < math::Epsilon<ScalarFloat>) {
@@ -76,7 +76,7 @@ public:
 
     Float eval(const PhaseFunctionContext & /* ctx */, const MediumInteraction3f &mi,
                const Vector3f &wo, Mask active) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::PhaseFunctionEvaluate, active);
+        MTS_MASKED_METHOD(ProfilerPhase::PhaseFunctionEvaluate, active);
         return eval_hg(dot(wo, mi.wi));
     }
 
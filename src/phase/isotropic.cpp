@@ -30,7 +30,7 @@ public:
     std::pair<Vector3f, Float> sample(const PhaseFunctionContext & /* ctx */,
                                       const MediumInteraction3f & /* mi */, const Point2f &sample,
                                       Mask active) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::PhaseFunctionSample, active);
+        MTS_MASKED_METHOD(ProfilerPhase::PhaseFunctionSample, active);
 
         auto wo  = warp::square_to_uniform_sphere(sample);
         auto pdf = warp::square_to_uniform_sphere_pdf(wo);
@@ -39,7 +39,7 @@ public:
 
     Float eval(const PhaseFunctionContext & /* ctx */, const MediumInteraction3f & /* mi */,
                const Vector3f &wo, Mask active) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::PhaseFunctionEvaluate, active);
+        MTS_MASKED_METHOD(ProfilerPhase::PhaseFunctionEvaluate, active);
         return warp::square_to_uniform_sphere_pdf(wo);
     }
 
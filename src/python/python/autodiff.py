@@ -91,6 +91,254 @@ def _render_helper(scene, spp=None, sensor_index=0):
     return values / (weight + 1e-8)
 
 
+def _mis_weight(pdf_a, pdf_b):
+    from mitsuba.core import Float
+    pdf_a *= pdf_a
+    pdf_b *= pdf_b
+    return ek.select(pdf_a > 0, pdf_a / (pdf_a + pdf_b), Float(0))
+
+
+def _sample_replay(scene, sampler, ray, max_depth, rr_depth, L=None,
+                   delta_L=None):
+    """
+    Internally used function: trace one path per lane using a path tracer
+    with emitter sampling and multiple importance sampling.
+
+    When ``delta_L`` is ``None``, this returns the (detached) radiance of
+    every path. Otherwise, the same paths are replayed given their primal
+    radiance ``L``, and the adjoint radiance ``delta_L`` is backpropagated
+    into the scene parameters one vertex at a time. The computation graph of
+    a vertex is released before moving on to the next one, which bounds the
+    memory usage independently of the path length.
+    """
+    from mitsuba.core import Float, Spectrum, Mask
+    from mitsuba.render import (BSDF, BSDFContext, BSDFFlags,
+                                DirectionSample3f, Emitter, has_flag)
+
+    primal = delta_L is None
+    L = Spectrum(0.0) if primal else Spectrum(ek.detach(L))
+
+    def accumulate(L, Lo, Lr_ind=None):
+        # Primal mode adds the contributions of this vertex to the radiance,
+        # the adjoint mode removes them to obtain the radiance of the rest
+        # of the path, and backpropagates the adjoint radiance.
+        if primal:
+            return L + ek.detach(Lo)
+        if Lr_ind is not None:
+            Lo = Lo + Lr_ind
+        contrib = delta_L[0] * Lo[0]
+        for i in range(1, len(Lo)):
+            contrib += delta_L[i] * Lo[i]
+        if ek.requires_gradient(contrib):
+            ek.backward(contrib)
+        return L
+
+    ctx = BSDFContext()
+    beta = Spectrum(1.0)
+    eta = Float(1.0)
+    emission_weight = Float(1.0)
+    active = Mask(True)
+
+    si = scene.ray_intersect(ray)
+    emitter = si.emitter(scene)
+
+    depth = 1
+    while True:
+        # Emitter hit by the previous ray (weighted by the MIS weight of BSDF sampling)
+        Le = beta * emission_weight * ek.select(
+            active, Emitter.eval_vec(emitter, si, active), Spectrum(0.0))
+        active &= si.is_valid()
+
+        # Russian roulette, which is replayed using the same samples
+        if rr_depth >= 0 and depth > rr_depth:
+            q = ek.min(ek.hmax(beta) * eta * eta, 0.95)
+            active &= sampler.next_1d(active) < q
+            beta *= ek.rcp(q)
+
+        if (max_depth >= 0 and depth >= max_depth) or not ek.any(active):
+            L = accumulate(L, Le)
+            break
+
+        bsdf = si.bsdf(ray)
+
+        # Emitter sampling
+        active_e = active & has_flag(BSDF.flags_vec(bsdf), BSDFFlags.Smooth)
+        ds, emitter_val = scene.sample_emitter_direction(
+            si, sampler.next_2d(active_e), True, active_e)
+        active_e &= ek.neq(ds.pdf, 0.0)
+        wo = si.to_local(ds.d)
+        bsdf_val = BSDF.eval_vec(bsdf, ctx, si, wo, active_e)
+        bsdf_pdf = BSDF.pdf_vec(bsdf, ctx, si, wo, active_e)
+        mis = ek.detach(ek.select(ds.delta, Float(1),
+                                  _mis_weight(ds.pdf, bsdf_pdf)))
+        Lr_dir = ek.select(active_e, beta * mis * bsdf_val * emitter_val,
+                           Spectrum(0.0))
+
+        # BSDF sampling
+        bs, bsdf_weight = BSDF.sample_vec(bsdf, ctx, si, sampler.next_1d(active),
+                                          sampler.next_2d(active), active)
+        delta = has_flag(bs.sampled_type, BSDFFlags.Delta)
+
+        if primal:
+            L = accumulate(L, Le + Lr_dir)
+        else:
+            # Radiance reflected along the sampled direction (i.e. the rest of
+            # the path), differentiated w.r.t. the BSDF value. Delta lobes
+            # cannot be evaluated, their sample weight is used instead.
+            L = L - ek.detach(Le + Lr_dir)
+            bsdf_eval = ek.select(delta, bsdf_weight,
+                                  BSDF.eval_vec(bsdf, ctx, si, bs.wo, active))
+            bsdf_eval_det = ek.detach(bsdf_eval)
+            Lr_ind = ek.select(ek.neq(bsdf_eval_det, 0),
+                               L * bsdf_eval / bsdf_eval_det, Spectrum(0.0))
+            L = accumulate(L, Le + Lr_dir, Lr_ind)
+
+        beta *= ek.detach(bsdf_weight)
+        active &= ek.any(ek.neq(beta, 0))
+        eta *= ek.detach(bs.eta)
+
+        # Intersect the BSDF ray and compute the MIS weight of emitters it may hit
+        ray = si.spawn_ray(si.to_world(bs.wo))
+        si_bsdf = scene.ray_intersect(ray, active)
+        emitter = si_bsdf.emitter(scene, active)
+        ds = DirectionSample3f(si_bsdf, si)
+        ds.object = emitter
+        emitter_pdf = ek.select(ek.neq(emitter, 0) & ~delta,
+                                scene.pdf_emitter_direction(si, ds, active),
+                                Float(0))
+        emission_weight = ek.detach(_mis_weight(bs.pdf, emitter_pdf))
+
+        si = si_bsdf
+        depth += 1
+
+    return L
+
+
+def render_replay(scene, optimizer, loss_fn, spp=None, spp_per_pass=None,
+                  sensor_index=0, max_depth=-1, rr_depth=5, seed=0):
+    """
+    Render the scene `scene` and backpropagate the gradient of the objective
+    ``loss_fn(image)`` into the parameters of ``optimizer`` using *path
+    replay*. Returns the (detached) image and objective value.
+
+    Unlike :py:func:`render()`, this function does not record the
+    computation graph of the whole rendering. The primal image is first
+    rendered without gradients. The paths are then retraced with the same
+    samples, and the adjoint radiance is backpropagated one path vertex at a
+    time, using the primal radiance of the path to account for the remainder
+    of it. This is the approach of path replay backpropagation
+    :cite:`Vicini2021PathReplay`, which keeps the memory usage independent
+    of the path length. The samples are additionally processed in passes of
+    ``spp_per_pass`` samples per pixel, which also bounds it independently
+    of the total sample count.
+
+    The paths are traced by a path tracer with emitter sampling and multiple
+    importance sampling, regardless of the integrator of the scene. Only
+    parameters of BSDFs, emitters and textures are differentiated: shape
+    parameters and visibility discontinuities are not supported. Samples are
+    reconstructed using a box filter, and only RGB and monochromatic variants
+    are supported. The parameter gradients accumulate, the next
+    ``optimizer.step()`` consumes them.
+
+    Parameter ``optimizer`` (:py:class:`mitsuba.python.autodiff.Optimizer`):
+        Optimizer referencing the differentiable scene parameters
+
+    Parameter ``loss_fn`` (``function``):
+        Objective function, takes the image (in the same layout as the
+        output of :py:func:`render()`) and returns a differentiable value
+
+    Parameter ``spp`` (``None`` or ``int``):
+        Total number of samples per pixel, overriding the value that is
+        specified in the scene when not ``None``.
+
+    Parameter ``spp_per_pass`` (``None`` or ``int``):
+        Number of samples per pixel of each pass, which must divide ``spp``.
+        Memory usage is roughly proportional to this value. By default, all
+        samples are traced in a single pass.
+
+    Parameter ``sensor_index`` (``int``):
+        Index of the sensor to be used
+
+    Parameter ``max_depth`` (``int``):
+        Longest path depth, or ``-1`` for infinite paths
+
+    Parameter ``rr_depth`` (``int``):
+        Depth at which Russian roulette starts, or ``-1`` to disable it
+
+    Parameter ``seed`` (``int``):
+        Seed of the sampler, the passes use consecutive seeds
+    """
+    from mitsuba.core import Float, UInt32, Vector2f, is_monochromatic, is_rgb
+
+    if not (is_rgb or is_monochromatic):
+        raise Exception('render_replay(): only RGB and monochromatic variants '
+                        'are supported!')
+
+    sensor = scene.sensors()[sensor_index]
+    film = sensor.film()
+    sampler = sensor.sampler()
+    film_size = film.crop_size()
+    pixel_count = ek.hprod(film_size)
+    channel_count = 1 if is_monochromatic else 3
+
+    if spp is None:
+        spp = sampler.sample_count()
+    if spp_per_pass is None:
+        spp_per_pass = spp
+    if spp_per_pass <= 0 or spp % spp_per_pass != 0:
+        raise Exception('render_replay(): spp_per_pass must divide spp!')
+    pass_count = spp // spp_per_pass
+
+    def trace(pass_index, L=None, delta_image=None):
+        # Generate the camera rays of a pass, always with the same samples
+        sample_count = pixel_count * spp_per_pass
+        sampler.seed(seed + pass_index, sample_count)
+
+        idx = ek.arange(UInt32, sample_count) // spp_per_pass
+        scale = Vector2f(1.0 / film_size[0], 1.0 / film_size[1])
+        pos = Vector2f(Float(idx % int(film_size[0])),
+                       Float(idx // int(film_size[0])))
+        pos += sampler.next_2d()
+
+        rays, weights = sensor.sample_ray_differential(
+            time=0, sample1=sampler.next_1d(), sample2=pos * scale, sample3=0)
+        weights = ek.detach(weights)
+
+        delta_L = None
+        if delta_image is not None:
+            delta_L = weights * (1.0 / spp)
+            for i in range(channel_count):
+                delta_L[i] *= ek.gather(delta_image, idx * channel_count + i)
+
+        L = _sample_replay(scene, sampler, rays, max_depth, rr_depth,
+                           L=L, delta_L=delta_L)
+        return L, weights, idx
+
+    # 1. Render the primal image without recording any gradients
+    image = ek.zero(Float, pixel_count * channel_count)
+    with optimizer.disable_gradients():
+        for i in range(pass_count):
+            L, weights, idx = trace(i)
+            for k in range(channel_count):
+                ek.scatter_add(image, L[k] * weights[k] * (1.0 / spp),
+                               idx * channel_count + k)
+
+    # 2. Differentiate the objective w.r.t. the image
+    image = ek.detach(image)
+    ek.set_requires_gradient(image)
+    loss = loss_fn(image)
+    ek.backward(loss)
+    delta_image = ek.detach(ek.gradient(image))
+
+    # 3. Replay the paths of every pass, first to recompute their radiance
+    for i in range(pass_count):
+        with optimizer.disable_gradients():
+            L, _, _ = trace(i)
+        trace(i, L=L, delta_image=delta_image)
+
+    return ek.detach(image), ek.detach(loss)
+
+
 def write_bitmap(filename, data, resolution, write_async=True):
     """
     Write the linearized RGB image in `data` to a PNG/EXR/.. file with
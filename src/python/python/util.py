@@ -188,3 +188,56 @@ def traverse(node: 'mitsuba.core.Object') -> ParameterMap:
     node.traverse(cb)
 
     return ParameterMap(cb.properties, cb.hierarchy)
+
+
+def render_batch(scene: 'mitsuba.render.Scene', sensors=None, updates=None,
+                 filename: str = None) -> list:
+    """
+    Render several sensors and/or parameter sets of a scene one after the
+    other, reusing the loaded scene and its acceleration data structure.
+
+    Parameter ``sensors`` (``None`` or a list of ``int``):
+       Indices of the sensors to render. All sensors of the scene are
+       rendered if ``sensors=None``.
+
+    Parameter ``updates`` (``None`` or a list of ``dict``):
+       Sequence of parameter sets. Each of them maps keys of
+       :py:func:`~mitsuba.python.util.traverse()` to new values, which are
+       applied on top of the previous set before all sensors are rendered
+       again. Changing sensor and emitter parameters does not require a
+       rebuild of the acceleration data structure.
+
+    Parameter ``filename`` (``None`` or ``str``):
+       When specified, every image is also written to disk in the background
+       while the next one renders. The string may refer to the fields
+       ``{sensor}`` and ``{update}``, e.g., ``'frame_{update}_{sensor}.exr'``.
+
+    Returns a list containing the developed :py:class:`mitsuba.core.Bitmap`
+    of every rendered image, ordered by parameter set and then by sensor.
+    """
+    integrator = scene.integrator()
+    if integrator is None:
+        raise Exception('render_batch(): no integrator specified for the scene!')
+    if sensors is None:
+        sensors = range(len(scene.sensors()))
+    params = traverse(scene) if updates else None
+
+    result = []
+    for update_i, update in enumerate(updates if updates else [None]):
+        if update:
+            for k, v in update.items():
+                params[k] = v
+            params.update()
+
+        for sensor_i in sensors:
+            sensor = scene.sensors()[sensor_i]
+            if not integrator.render(scene, sensor):
+                raise Exception('render_batch(): rendering of sensor %i failed!' % sensor_i)
+
+            bitmap = sensor.film().bitmap()
+            if filename is not None:
+                bitmap.write_async(filename.format(sensor=sensor_i,
+                                                   update=update_i))
+            result.append(bitmap)
+
+    return result
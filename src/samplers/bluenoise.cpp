@@ -0,0 +1,144 @@
+#include <mitsuba/core/profiler.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/spectrum.h>
+#include <mitsuba/core/qmc.h>
+#include <mitsuba/render/sampler.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/// 256x256 blue noise threshold matrix with values in [-1/2, 1/2] (see libcore)
+extern MTS_EXPORT_CORE const float dither_matrix256[65536];
+
+/**!
+
+.. _sampler-bluenoise:
+
+Blue noise dithered sampler (:monosp:`bluenoise`)
+-------------------------------------------------
+
+.. pluginparameters::
+
+ * - sample_count
+   - |int|
+   - Number of samples per pixel. This value should be a power of two. (Default: 4)
+ * - seed
+   - |int|
+   - Seed offset (Default: 0)
+
+This plugin distributes the error of a render as blue noise in screen space, following the dithered
+sampling approach of Georgiev and Fajardo :cite:`Georgiev2016Blue`. This is mainly useful for
+previews at very low sample counts (1-4 samples per pixel), where the high-frequency error of a
+blue noise distribution is perceived as considerably less distracting than the white noise of
+the :ref:`independent <sampler-independent>` sampler.
+
+All pixels share the same scrambled (0, 2)-sequence, which is toroidally shifted (i.e. Cranley-
+Patterson rotated) by a per-pixel offset. The offsets are read from Mitsuba's 256x256 dither matrix,
+whose neighboring entries differ as much as possible. Each dimension uses a differently shifted
+copy of the matrix, and a new sequence and shift are used in every rendering pass. The estimate
+of every pixel remains unbiased, but the errors of neighboring pixels are negatively correlated
+and hence mostly consist of high frequencies.
+
+Since the mask only decorrelates pixels that are less than 256 pixels apart, this sampler is less
+suitable for high-quality renders with many samples per pixel, where :ref:`ldsampler
+<sampler-ldsampler>` or :ref:`sobol <sampler-sobol>` are preferable.
+
+ */
+
+template <typename Float, typename Spectrum>
+class BlueNoiseSampler final : public Sampler<Float, Spectrum> {
+public:
+    MTS_IMPORT_BASE(Sampler, m_sample_count, m_base_seed, seeded, m_samples_per_wavefront,
+                    m_dimension_index, m_pass_index, current_sample_index)
+    MTS_IMPORT_TYPES()
+
+    BlueNoiseSampler(const Properties &props = Properties()) : Base(props) {
+        ScalarUInt32 sample_count = math::round_to_power_of_two(m_sample_count);
+        if (m_sample_count != sample_count)
+            Log(Warn, "Sample count should be a power of two, rounding to %i", sample_count);
+        m_sample_count = sample_count;
+
+        // Convert the thresholds in [-1/2, 1/2] into toroidal shifts in [0, 1)
+        std::unique_ptr<ScalarFloat[]> offsets(new ScalarFloat[mask_size * mask_size]);
+        for (size_t i = 0; i < mask_size * mask_size; ++i)
+            offsets[i] = ScalarFloat(std::rint((dither_matrix256[i] + .5f) * 65535.f) / 65536.f);
+        m_offsets = DynamicBuffer<Float>::copy(offsets.get(), mask_size * mask_size);
+        m_pixel = zero<Point2u>();
+    }
+
+    BlueNoiseSampler(const BlueNoiseSampler &sampler)
+        : Base(Properties()), m_offsets(sampler.m_offsets) {
+        m_sample_count          = sampler.m_sample_count;
+        m_samples_per_wavefront = sampler.m_samples_per_wavefront;
+        m_base_seed             = sampler.m_base_seed;
+        m_pixel                 = zero<Point2u>();
+    }
+
+    ref<Sampler<Float, Spectrum>> clone() override {
+        return new BlueNoiseSampler(*this);
+    }
+
+    void set_pixel(const Point2u &pixel) override { m_pixel = pixel; }
+
+    Float next_1d(Mask active = true) override {
+        Assert(seeded());
+
+        /* The sequence (and its shift) only depend on the dimension and the
+           pass, which makes it identical for all pixels */
+        uint32_t seed = sequence_seed();
+        UInt32 i = permute(current_sample_index(), m_sample_count, UInt32(seed));
+
+        Float value = radical_inverse_2(i, UInt32(sample_tea_32(seed, 0x48bc48ebu)));
+        return shift(value, sample_tea_32(seed, 0x98bc51abu), active);
+    }
+
+    Point2f next_2d(Mask active = true) override {
+        Assert(seeded());
+
+        uint32_t seed = sequence_seed();
+        UInt32 i = permute(current_sample_index(), m_sample_count, UInt32(seed));
+
+        Float x = radical_inverse_2(i, UInt32(sample_tea_32(seed, 0x98bc51abu))),
+              y = sobol_2(i, UInt32(sample_tea_32(seed, 0x04223e2du)));
+
+        return Point2f(shift(x, sample_tea_32(seed, 0x33e3a8c1u), active),
+                       shift(y, sample_tea_32(seed, 0x6a3b7f15u), active));
+    }
+
+    std::string to_string() const override {
+        std::ostringstream oss;
+        oss << "BlueNoiseSampler [" << std::endl
+            << "  sample_count = " << m_sample_count << std::endl
+            << "]";
+        return oss.str();
+    }
+
+    MTS_DECLARE_CLASS()
+private:
+    /// Seed of the current dimension of the sequence shared by all pixels
+    uint32_t sequence_seed() {
+        return sample_tea_32(sample_tea_32((uint32_t) m_base_seed, m_pass_index),
+                             m_dimension_index++);
+    }
+
+    /// Rotate a sample by the offset of the current pixel in a shifted copy of the mask
+    Float shift(const Float &value, uint32_t mask_shift, const Mask &active) const {
+        UInt32 x = (m_pixel.x() + (mask_shift & 0xffu)) & (mask_size - 1),
+               y = (m_pixel.y() + ((mask_shift >> 8) & 0xffu)) & (mask_size - 1);
+
+        Float result = value + gather<Float>(m_offsets, y * mask_size + x, active);
+        return select(result >= 1.f, result - 1.f, result);
+    }
+
+private:
+    static constexpr uint32_t mask_size = 256;
+
+    /// Per-pixel toroidal shifts in [0, 1)
+    DynamicBuffer<Float> m_offsets;
+
+    /// Pixel of the upcoming sample
+    Point2u m_pixel;
+};
+
+MTS_IMPLEMENT_CLASS_VARIANT(BlueNoiseSampler, Sampler)
+MTS_EXPORT_PLUGIN(BlueNoiseSampler, "Blue Noise Sampler");
+NAMESPACE_END(mitsuba)
@@ -0,0 +1,109 @@
+#include <mitsuba/core/profiler.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/random.h>
+#include <mitsuba/core/spectrum.h>
+#include <mitsuba/render/sampler.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+
+.. _sampler-counter:
+
+Counter-based sampler (:monosp:`counter`)
+-----------------------------------------
+
+.. pluginparameters::
+
+ * - sample_count
+   - |int|
+   - Number of samples per pixel (Default: 4)
+ * - seed
+   - |int|
+   - Seed offset (Default: 0)
+
+Like the :ref:`independent <sampler-independent>` sampler, this plugin produces
+independent and uniformly distributed pseudorandom numbers. Instead of
+advancing a random number generator, it evaluates every sample component as a
+hash (based on the Tiny Encryption Algorithm by David Wheeler and Roger
+Needham) of the seed, the index of the sequence, the index of the sample and
+its dimension.
+
+The sampler therefore keeps no per-sample state: in GPU variants, seeding it
+doesn't allocate a 64-bit random number generator state for every entry of
+the wavefront, and sample components are not read from and written back to
+device memory when they are generated. This substantially reduces the memory
+footprint of large wavefronts. Because any sample component can be
+recomputed from its indices, the generated sequences are also fully
+deterministic across runs and machines.
+
+.. code-block:: xml
+
+    <sampler type="counter">
+        <integer name="sample_count" value="64"/>
+    </sampler>
+
+ */
+
+template <typename Float, typename Spectrum>
+class CounterSampler final : public Sampler<Float, Spectrum> {
+public:
+    MTS_IMPORT_BASE(Sampler, m_sample_count, m_base_seed, seeded, m_samples_per_wavefront,
+                    m_dimension_index, current_sample_index, compute_per_sequence_seed)
+    MTS_IMPORT_TYPES()
+
+    CounterSampler(const Properties &props = Properties()) : Base(props) {
+        m_seed_offset = 0;
+    }
+
+    ref<Sampler<Float, Spectrum>> clone() override {
+        CounterSampler *sampler          = new CounterSampler();
+        sampler->m_sample_count          = m_sample_count;
+        sampler->m_samples_per_wavefront = m_samples_per_wavefront;
+        sampler->m_base_seed             = m_base_seed;
+        return sampler;
+    }
+
+    void seed(uint64_t seed_offset, size_t wavefront_size) override {
+        Base::seed(seed_offset, wavefront_size);
+        m_seed_offset = (uint32_t) (seed_offset ^ (seed_offset >> 32));
+    }
+
+    Float next_1d(Mask /* active */ = true) override {
+        Assert(seeded());
+
+        /* Recompute the per-sequence seed on the fly rather than storing it,
+           which would require one entry per lane of the wavefront */
+        UInt32 hash = sample_tea_32(compute_per_sequence_seed(m_seed_offset),
+                                    current_sample_index()),
+               dim  = UInt32(m_dimension_index++);
+
+        if constexpr (std::is_same_v<ScalarFloat, double>)
+            return sample_tea_float64(hash, dim);
+        else
+            return sample_tea_float32(hash, dim);
+    }
+
+    Point2f next_2d(Mask active = true) override {
+        Float f1 = next_1d(active),
+              f2 = next_1d(active);
+        return Point2f(f1, f2);
+    }
+
+    std::string to_string() const override {
+        std::ostringstream oss;
+        oss << "CounterSampler[" << std::endl
+            << "  sample_count = " << m_sample_count << std::endl
+            << "]";
+        return oss.str();
+    }
+
+    MTS_DECLARE_CLASS()
+private:
+    /// Seed offset of the current sequences
+    uint32_t m_seed_offset;
+};
+
+MTS_IMPLEMENT_CLASS_VARIANT(CounterSampler, Sampler)
+MTS_EXPORT_PLUGIN(CounterSampler, "Counter-based Sampler");
+NAMESPACE_END(mitsuba)
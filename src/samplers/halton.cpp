@@ -0,0 +1,254 @@
+#include <mitsuba/core/profiler.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/spectrum.h>
+#include <mitsuba/core/qmc.h>
+#include <mitsuba/render/sampler.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+
+.. _sampler-halton:
+
+Halton sampler (:monosp:`halton`)
+---------------------------------
+
+.. pluginparameters::
+
+ * - sample_count
+   - |int|
+   - Number of samples per pixel (Default: 4)
+ * - scramble
+   - |int|
+   - Permutation applied to the digits of the sequence: :monosp:`-1` selects the Faure
+     permutations :cite:`Faure1992Good`, :monosp:`0` disables scrambling, and any other value
+     is used as the seed of random permutations. (Default: -1)
+
+This plugin implements a sampler based on the Halton sequence, whose :math:`i`-th dimension
+is the radical inverse of the sample index in the :math:`i`-th prime base. In contrast to the
+(0, 2)-sequence of :ref:`ldsampler <sampler-ldsampler>`, which is reused (with different
+scramblings) by every sample dimension, all dimensions of the Halton sequence are part of one
+jointly low-discrepancy point set. This makes it a good choice for deep light paths, whose
+integrands depend on many dimensions at once.
+
+The sequence is shared by the whole image: its first two dimensions are scaled by
+:math:`2^7` and :math:`3^5` and cover a tile of :math:`128\times 243` pixels, and each pixel
+of the film uses the points of the sequence that fall within its footprint in this tile. The
+index of the first such point is computed from the pixel coordinates in constant time (by
+inverting the radical inverse and applying the Chinese remainder theorem), and the following
+ones are spaced :math:`128\cdot 243` indices apart. The samples of later rendering passes
+continue the same sequence.
+
+The higher dimensions are scrambled using permutations of their digits, which removes the
+correlation between dimensions with large prime bases. The permutations of the first 256 prime
+bases are precomputed once (see :monosp:`RadicalInverse` in :monosp:`qmc.h`) and stored in a
+single compact table; dimensions beyond these reuse the bases starting from the third one.
+
+.. code-block:: xml
+
+    <sampler type="halton">
+        <integer name="sample_count" value="64"/>
+    </sampler>
+
+ */
+
+template <typename Float, typename Spectrum>
+class HaltonSampler final : public Sampler<Float, Spectrum> {
+public:
+    MTS_IMPORT_BASE(Sampler, m_sample_count, m_base_seed, seeded, m_samples_per_wavefront,
+                    m_dimension_index, m_pass_index, current_sample_index)
+    MTS_IMPORT_TYPES()
+
+    HaltonSampler(const Properties &props = Properties()) : Base(props) {
+        m_scramble = props.int_("scramble", -1);
+        if (m_scramble < -1)
+            Throw("halton: invalid scramble value %i, must be -1 (Faure permutations), "
+                  "0 (no scrambling) or a positive seed!", m_scramble);
+
+        ref<RadicalInverse> inverse = new RadicalInverse(max_base, m_scramble == 0 ? -1 : m_scramble);
+
+        std::vector<uint32_t> permutations;
+        for (size_t i = 0; i < inverse->bases(); ++i) {
+            uint32_t value = (uint32_t) inverse->base(i);
+            const uint16_t *perm = inverse->permutation(i);
+
+            PrimeBase base;
+            base.divisor = enoki::divisor<uint64_t>(value);
+            base.value = value;
+            base.offset = (uint32_t) permutations.size();
+            base.recip = ScalarFloat(1) / ScalarFloat(value);
+            /* The infinitely many leading zero digits of the index are also
+               permuted, which adds a constant to the scrambled value */
+            base.correction = ScalarFloat(perm[0]) / ScalarFloat(value - 1);
+            m_bases.push_back(base);
+
+            if (m_scramble != 0)
+                permutations.insert(permutations.end(), perm, perm + value);
+        }
+
+        if (!permutations.empty())
+            m_permutations = DynamicBuffer<UInt32>::copy(permutations.data(), permutations.size());
+
+        // Multipliers that map the residues modulo 2^7 and 3^5 to an index of the tile
+        for (uint32_t m = scale_3; m < tile_size; m += scale_3)
+            if (m % scale_2 == 1)
+                m_crt_2 = m;
+        for (uint32_t m = scale_2; m < tile_size; m += scale_2)
+            if (m % scale_3 == 1)
+                m_crt_3 = m;
+
+        m_pixel_offset = 0u;
+    }
+
+    HaltonSampler(const HaltonSampler &sampler)
+        : Base(Properties()), m_bases(sampler.m_bases),
+          m_permutations(sampler.m_permutations) {
+        m_sample_count          = sampler.m_sample_count;
+        m_samples_per_wavefront = sampler.m_samples_per_wavefront;
+        m_base_seed             = sampler.m_base_seed;
+        m_scramble              = sampler.m_scramble;
+        m_crt_2                 = sampler.m_crt_2;
+        m_crt_3                 = sampler.m_crt_3;
+        m_pixel_offset          = 0u;
+    }
+
+    ref<Sampler<Float, Spectrum>> clone() override {
+        return new HaltonSampler(*this);
+    }
+
+    void set_pixel(const Point2u &pixel) override {
+        /* The first 7 base-2 (and 5 base-3) digits of the first two dimensions
+           select the pixel in the tile. Reverse them to obtain the residues of
+           the matching sequence indices and combine these residues. */
+        UInt32 x = pixel.x() % scale_2, y = pixel.y() % scale_3,
+               residue_2 = 0u, residue_3 = 0u;
+
+        for (uint32_t i = 0; i < 7; ++i) {
+            residue_2 = (residue_2 << 1) | (x & 1u);
+            x = sr<1>(x);
+        }
+
+        for (uint32_t i = 0; i < 5; ++i) {
+            UInt32 next = y / 3u;
+            residue_3 = residue_3 * 3u + (y - next * 3u);
+            y = next;
+        }
+
+        m_pixel_offset = (residue_2 * m_crt_2 + residue_3 * m_crt_3) % tile_size;
+    }
+
+    Float next_1d(Mask active = true) override {
+        Assert(seeded());
+        return sample(m_dimension_index++, sequence_index(), active);
+    }
+
+    Point2f next_2d(Mask active = true) override {
+        Assert(seeded());
+
+        UInt64 index = sequence_index();
+        Float x = sample(m_dimension_index++, index, active),
+              y = sample(m_dimension_index++, index, active);
+
+        return Point2f(x, y);
+    }
+
+    std::string to_string() const override {
+        std::ostringstream oss;
+        oss << "HaltonSampler [" << std::endl
+            << "  sample_count = " << m_sample_count << "," << std::endl
+            << "  scramble = " << m_scramble << std::endl
+            << "]";
+        return oss.str();
+    }
+
+    MTS_DECLARE_CLASS()
+private:
+    /// Index of the current sample of the current pixel in the Halton sequence
+    UInt64 sequence_index() const {
+        UInt64 sample_index = UInt64(current_sample_index()) +
+                              (uint64_t) m_pass_index * (uint64_t) m_sample_count;
+        return UInt64(m_pixel_offset) + sample_index * (uint64_t) tile_size;
+    }
+
+    /// Evaluate the given dimension of the sequence
+    Float sample(uint32_t dim, const UInt64 &index, const Mask &active) const {
+        /* The first two dimensions are only defined up to the pixel, drop the
+           digits that select it to obtain the position within the pixel */
+        if (dim == 0)
+            return radical_inverse(0, sr<7>(index), false, active);
+        else if (dim == 1)
+            return radical_inverse(1, index / (uint64_t) scale_3, false, active);
+
+        uint32_t base_count = (uint32_t) m_bases.size();
+        if (dim >= base_count)
+            dim = 2 + (dim - 2) % (base_count - 2);
+
+        return radical_inverse(dim, index, m_scramble != 0, active);
+    }
+
+    /// Radical inverse (with optional digit permutations) in the given prime base
+    Float radical_inverse(uint32_t base_index, UInt64 index, bool scrambled,
+                          const Mask &active) const {
+        const PrimeBase &base = m_bases[base_index];
+
+        UInt64 value = zero<UInt64>();
+        Float factor = Float(1.f);
+
+        auto digits = neq(index, zero<UInt64>());
+
+        while (any(digits)) {
+            auto digits_f = reinterpret_array<mask_t<Float>>(digits);
+            UInt64 next = base.divisor(index);
+            UInt64 digit = index - next * (uint64_t) base.value;
+
+            if (scrambled)
+                digit = UInt64(gather<UInt32>(m_permutations, UInt32(digit) + base.offset,
+                                              active && digits_f));
+
+            masked(value, digits) = value * (uint64_t) base.value + digit;
+            masked(factor, digits_f) = factor * base.recip;
+            index = next;
+            digits = neq(index, zero<UInt64>());
+        }
+
+        Float result = Float(value);
+        if (scrambled)
+            result += base.correction;
+
+        return min(math::OneMinusEpsilon<Float>, result * factor);
+    }
+
+private:
+    /// Largest prime base of the sequence (the first 256 primes)
+    static constexpr size_t max_base = 1619;
+
+    /// Scales of the first two dimensions and the size of the resulting pixel tile
+    static constexpr uint32_t scale_2 = 128, scale_3 = 243, tile_size = scale_2 * scale_3;
+
+    struct PrimeBase {
+        enoki::divisor<uint64_t> divisor;
+        uint32_t value;
+        /// Offset of the permutation of this base in \ref m_permutations
+        uint32_t offset;
+        ScalarFloat recip;
+        /// Value of the (permuted) infinite sequence of leading zero digits
+        ScalarFloat correction;
+    };
+
+    std::vector<PrimeBase> m_bases;
+
+    /// Digit permutations of all prime bases, stored back to back
+    DynamicBuffer<UInt32> m_permutations;
+
+    int m_scramble;
+
+    /// Multipliers of the Chinese remainder theorem for the residues modulo 2^7 and 3^5
+    uint32_t m_crt_2, m_crt_3;
+
+    /// Index of the first sample of the current pixel in the sequence
+    UInt32 m_pixel_offset;
+};
+
+MTS_IMPLEMENT_CLASS_VARIANT(HaltonSampler, Sampler)
+MTS_EXPORT_PLUGIN(HaltonSampler, "Halton Sampler");
+NAMESPACE_END(mitsuba)
@@ -0,0 +1,62 @@
+import mitsuba
+import pytest
+import enoki as ek
+import numpy as np
+
+from .utils import check_uniform_scalar_sampler, check_uniform_wavefront_sampler
+
+def test01_bluenoise_scalar(variant_scalar_rgb):
+    from mitsuba.core import xml
+
+    sampler = xml.load_dict({
+        "type" : "bluenoise",
+        "sample_count" : 1024,
+    })
+
+    check_uniform_scalar_sampler(sampler)
+
+
+def test02_bluenoise_wavefront(variant_gpu_rgb):
+    from mitsuba.core import xml
+
+    sampler = xml.load_dict({
+        "type" : "bluenoise",
+        "sample_count" : 1024,
+    })
+
+    check_uniform_wavefront_sampler(sampler)
+
+
+def test03_bluenoise_screen_space(variant_scalar_rgb):
+    from mitsuba.core import xml
+
+    sampler = xml.load_dict({
+        "type" : "bluenoise",
+        "sample_count" : 1,
+    })
+
+    # At 1 spp, the samples of a 256x256 tile are stratified in every dimension
+    res = 16
+    hist_1d = np.zeros(res)
+    hist_2d = np.zeros((res, res))
+    first = None
+    for y in range(256):
+        for x in range(256):
+            sampler.seed(y * 256 + x)
+            sampler.set_pixel([x, y])
+            v_1d = sampler.next_1d()
+            hist_1d[int(v_1d * res)] += 1
+            v_2d = sampler.next_2d()
+            hist_2d[int(v_2d.x * res), int(v_2d.y * res)] += 1
+
+    assert np.all(hist_1d == 65536 / res)
+    assert ek.allclose(hist_2d, 65536 / (res * res), rtol=0.2)
+
+    # A new pass uses a different sequence
+    sampler.seed(0)
+    sampler.set_pixel([0, 0])
+    v_0 = sampler.next_1d()
+    sampler.set_pass_index(1)
+    sampler.seed(0)
+    sampler.set_pixel([0, 0])
+    assert sampler.next_1d() != v_0
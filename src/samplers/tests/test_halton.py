@@ -0,0 +1,94 @@
+import mitsuba
+import pytest
+import enoki as ek
+import numpy as np
+
+from .utils import check_uniform_scalar_sampler, check_uniform_wavefront_sampler
+
+
+def radical_inverse(base, index):
+    value, factor = 0, 1.0
+    while index > 0:
+        factor /= base
+        value = value * base + index % base
+        index //= base
+    return value * factor
+
+
+def test01_halton_scalar(variant_scalar_rgb):
+    from mitsuba.core import xml
+
+    sampler = xml.load_dict({
+        "type" : "halton",
+        "sample_count" : 1024,
+    })
+
+    # Prime bases other than 2 don't stratify power-of-two bins
+    check_uniform_scalar_sampler(sampler, res=8, atol=5.0)
+
+
+def test02_halton_wavefront(variant_gpu_rgb):
+    from mitsuba.core import xml
+
+    sampler = xml.load_dict({
+        "type" : "halton",
+        "sample_count" : 1024,
+    })
+
+    check_uniform_wavefront_sampler(sampler, res=8, atol=5.0)
+
+
+def test03_halton_reference(variant_scalar_rgb):
+    from mitsuba.core import xml
+
+    sampler = xml.load_dict({
+        "type" : "halton",
+        "sample_count" : 4,
+        "scramble" : 0,
+    })
+
+    # Find the first point of the sequence that falls into the pixel
+    x, y = 37, 150
+    offset = next(n for n in range(128 * 243)
+                  if int(radical_inverse(2, n) * 128) == x and
+                     int(radical_inverse(3, n) * 243) == y)
+
+    for pass_index in range(2):
+        sampler.set_pass_index(pass_index)
+        sampler.seed(0)
+        for i in range(sampler.sample_count()):
+            n = offset + (pass_index * sampler.sample_count() + i) * 128 * 243
+            sampler.set_pixel([x, y])
+            p = sampler.next_2d()
+            assert ek.allclose(p, [radical_inverse(2, n) * 128 - x,
+                                   radical_inverse(3, n) * 243 - y], atol=1e-5)
+            for base in [5, 7, 11, 13]:
+                assert ek.allclose(sampler.next_1d(), radical_inverse(base, n), atol=1e-5)
+            sampler.advance()
+
+
+@pytest.mark.parametrize("scramble", [-1, 0, 3])
+def test04_halton_stratification(variant_scalar_rgb, scramble):
+    from mitsuba.core import xml
+
+    def histogram(sample_count, res, dim):
+        sampler = xml.load_dict({
+            "type" : "halton",
+            "sample_count" : sample_count,
+            "scramble" : scramble,
+        })
+        sampler.seed(0)
+
+        hist = np.zeros(res)
+        for i in range(sample_count):
+            sampler.set_pixel([5, 17])
+            for d in range(dim):
+                sampler.next_2d()
+            p = sampler.next_2d()
+            hist[int(p.x * res[0]), int(p.y * res[1])] += 1
+            sampler.advance()
+        return hist
+
+    # The samples of a pixel are stratified, and so are the scrambled higher dimensions
+    assert np.all(histogram(1296, (16, 81), 0) == 1)
+    assert np.all(histogram(1225, (25, 49), 1) == 1)
@@ -0,0 +1,56 @@
+import mitsuba
+import pytest
+import enoki as ek
+
+
+@pytest.mark.parametrize("sampler_type", ["independent", "stratified", "multijitter",
+                                          "orthogonal", "ldsampler"])
+def test01_seek_scalar(variant_scalar_rgb, sampler_type):
+    from mitsuba.core import xml
+
+    sampler = xml.load_dict({
+        "type" : sampler_type,
+        "sample_count" : 16,
+    })
+    sample_count = sampler.sample_count()
+
+    # The samples draw a varying number of dimensions, as paths of different length would
+    def draw(i):
+        values = [sampler.next_1d() for _ in range(1 + i % 4)]
+        values += list(sampler.next_2d())
+        return values
+
+    sampler.seed(42)
+    reference = []
+    for i in range(sample_count):
+        reference.append(draw(i))
+        sampler.advance()
+    assert sampler.sample_index() == sample_count
+
+    for i in [sample_count - 1, 0, 5, sample_count // 2]:
+        sampler.seek(42, i)
+        assert sampler.sample_index() == i
+        for j in range(i, sample_count):
+            assert draw(j) == reference[j]
+            sampler.advance()
+
+    with pytest.raises(RuntimeError, match='.*exceeds the number of samples.*'):
+        sampler.seek(42, sample_count + 1)
+
+
+def test02_seek_packet(variant_packet_rgb):
+    from mitsuba.core import xml
+
+    sampler = xml.load_dict({
+        "type" : "multijitter",
+        "sample_count" : 16,
+    })
+
+    sampler.seed(7)
+    for i in range(3):
+        sampler.next_1d()
+        sampler.advance()
+    reference = sampler.next_2d()
+
+    sampler.seek(7, 3)
+    assert ek.all_nested(ek.eq(sampler.next_2d(), reference))
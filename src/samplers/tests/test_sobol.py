@@ -0,0 +1,74 @@
+import mitsuba
+import pytest
+import enoki as ek
+import numpy as np
+
+from .utils import check_uniform_scalar_sampler, check_uniform_wavefront_sampler
+
+def test01_sobol_scalar(variant_scalar_rgb):
+    from mitsuba.core import xml
+
+    sampler = xml.load_dict({
+        "type" : "sobol",
+        "sample_count" : 1024,
+    })
+
+    check_uniform_scalar_sampler(sampler)
+
+
+def test02_sobol_wavefront(variant_gpu_rgb):
+    from mitsuba.core import xml
+
+    sampler = xml.load_dict({
+        "type" : "sobol",
+        "sample_count" : 1024,
+    })
+
+    check_uniform_wavefront_sampler(sampler)
+
+
+def test03_sobol_stratification(variant_scalar_rgb):
+    from mitsuba.core import xml
+
+    sampler = xml.load_dict({
+        "type" : "sobol",
+        "sample_count" : 256,
+    })
+
+    # Every dimension of the sequence is a scrambled (0, 8, 2)-net
+    sampler.seed(5)
+    dim_count = 8
+    hist_1d = np.zeros((dim_count, 256))
+    hist_2d = np.zeros((dim_count, 16, 16))
+
+    for i in range(sampler.sample_count()):
+        for d in range(dim_count):
+            v_1d = sampler.next_1d()
+            hist_1d[d, int(v_1d * 256)] += 1
+            v_2d = sampler.next_2d()
+            hist_2d[d, int(v_2d.x * 16), int(v_2d.y * 16)] += 1
+        sampler.advance()
+
+    assert np.all(hist_1d == 1)
+    assert np.all(hist_2d == 1)
+
+
+def test04_sobol_scrambling(variant_scalar_rgb):
+    from mitsuba.core import xml
+
+    sampler = xml.load_dict({
+        "type" : "sobol",
+        "sample_count" : 64,
+    })
+
+    def first_samples(seed):
+        sampler.seed(seed)
+        values = []
+        for i in range(sampler.sample_count()):
+            values.append(sampler.next_1d())
+            sampler.advance()
+        return values
+
+    # The sequences of different pixels are decorrelated, but deterministic
+    assert first_samples(0) == first_samples(0)
+    assert first_samples(0) != first_samples(1)
@@ -0,0 +1,202 @@
+#include <mitsuba/core/filesystem.h>
+#include <mitsuba/core/fwd.h>
+#include <mitsuba/core/plugin.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/timer.h>
+#include <mitsuba/core/transform.h>
+#include <mitsuba/core/util.h>
+#include <mitsuba/core/warp.h>
+#include <mitsuba/render/fwd.h>
+#include <mitsuba/render/mesh.h>
+#include <mitsuba/render/sensor.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+
+.. _sensor-meterarray:
+
+Meter array (:monosp:`meterarray`)
+----------------------------------
+
+.. pluginparameters::
+
+ * - filename
+   - |string|
+   - Filename of a PLY file whose vertices specify the locations (``x``,
+     ``y``, ``z``) and orientations (``nx``, ``ny``, ``nz``) of the meters.
+ * - quantity
+   - |string|
+   - Measured quantity: :monosp:`radiance` along the orientation of every
+     meter, or :monosp:`irradiance` on a small surface facing it.
+     (Default: :monosp:`radiance`)
+ * - to_world
+   - |transform|
+   - Optional transformation that is applied to the meter locations and
+     orientations. (Default: none)
+
+This sensor plugin evaluates a large number of independent radiance or
+irradiance meters in a single rendering pass, as needed e.g. by daylighting
+simulations with thousands of light sensors. Every meter behaves like a
+:ref:`radiancemeter <sensor-radiancemeter>` (or, with
+:monosp:`quantity="irradiance"`, like an irradiance meter on an infinitesimal
+surface element) and writes its measurement to one film pixel: meter
+:math:`i` maps to the pixel :math:`(i \bmod w, \lfloor i / w \rfloor)` of a
+film with width :math:`w`. The film must therefore have at least as many
+pixels as there are meters, and the remaining pixels stay black.
+
+The meters are stored in flat arrays, so that all of them are traced together
+by the integrator rather than through separate sensor objects and render
+calls. Use a box reconstruction filter with a radius of 0.5 (or lower) to
+keep the measurements of neighboring meters apart.
+
+.. code-block:: xml
+
+    <sensor type="meterarray">
+        <string name="filename" value="meters.ply"/>
+        <string name="quantity" value="irradiance"/>
+        <film type="hdrfilm">
+            <integer name="width" value="1000"/>
+            <integer name="height" value="100"/>
+            <rfilter type="box"/>
+        </film>
+    </sensor>
+*/
+
+MTS_VARIANT class MeterArray final : public Sensor<Float, Spectrum> {
+public:
+    MTS_IMPORT_BASE(Sensor, m_film, m_needs_sample_3)
+    MTS_IMPORT_TYPES(Mesh)
+
+    using InputFloat    = float;
+    using InputVector3f = Vector<replace_scalar_t<Float, InputFloat>, 3>;
+    using FloatStorage  = DynamicBuffer<replace_scalar_t<Float, InputFloat>>;
+
+    MeterArray(const Properties &props) : Base(props) {
+        std::string quantity = props.string("quantity", "radiance");
+        if (quantity == "radiance")
+            m_irradiance = false;
+        else if (quantity == "irradiance")
+            m_irradiance = true;
+        else
+            Throw("meterarray: invalid quantity \"%s\", must be \"radiance\" or "
+                  "\"irradiance\"!", quantity);
+
+        Timer timer;
+
+        /* Reuse the parallel PLY loader, which also applies the 'to_world'
+           transformation to the locations and orientations */
+        Properties props_ply("ply");
+        props_ply.set_string("filename", props.string("filename"));
+        if (props.has_property("to_world"))
+            props_ply.copy_attribute(props, "to_world", "to_world");
+        ref<Mesh> mesh = PluginManager::instance()->create_object<Mesh>(props_ply);
+        std::string name = fs::path(props.string("filename")).filename().string();
+
+        m_meter_count = mesh->vertex_count();
+        if (m_meter_count == 0)
+            Throw("meterarray: \"%s\" does not contain any meters!", name);
+
+        ScalarVector2i size = m_film->size();
+        if ((size_t) size.x() * (size_t) size.y() < m_meter_count)
+            Throw("meterarray: the film has %i pixels, which is not enough for %i meters!",
+                  size.x() * size.y(), m_meter_count);
+
+        if (m_film->reconstruction_filter()->radius() >
+            0.5f + math::RayEpsilon<Float>)
+            Log(Warn, "This sensor should be used with a reconstruction filter "
+                      "with a radius of 0.5 or lower (e.g. default box)");
+
+        // Vertex normals are recomputed (as zero) when the file doesn't have any
+        const InputFloat *normals = mesh->vertex_normals_buffer().data();
+        for (size_t i = 0; i < m_meter_count; ++i) {
+            ScalarVector3f n(normals[i * 3], normals[i * 3 + 1], normals[i * 3 + 2]);
+            if (!(squared_norm(n) > 0.f))
+                Throw("meterarray: meter %i of \"%s\" has no orientation (the PLY file "
+                      "must specify vertex normals)!", i, name);
+        }
+
+        m_origins = FloatStorage::copy(mesh->vertex_positions_buffer().data(),
+                                       m_meter_count * 3);
+        m_directions = FloatStorage::copy(normals, m_meter_count * 3);
+
+        m_needs_sample_3 = m_irradiance;
+
+        Log(Debug, "\"%s\": loaded %i meters (took %s)", name, m_meter_count,
+            util::time_string(timer.value()));
+    }
+
+    std::pair<Ray3f, Spectrum> sample_ray(Float time, Float wavelength_sample,
+                                          const Point2f &position_sample,
+                                          const Point2f &aperture_sample,
+                                          Mask active) const override {
+        MTS_MASKED_FUNCTION(ProfilerPhase::EndpointSampleRay, active);
+
+        // 1. Find the meter associated with the pixel
+        ScalarVector2i size = m_film->size();
+        Point2i pixel = min(Point2i(position_sample * ScalarVector2f(m_film->crop_size())) +
+                                m_film->crop_offset(), Point2i(size - 1));
+        UInt32 index = UInt32(pixel.y()) * (uint32_t) size.x() + UInt32(pixel.x());
+        Mask valid = active && index < (uint32_t) m_meter_count;
+        index = min(index, (uint32_t) m_meter_count - 1);
+
+        Point3f origin(gather<InputVector3f>(m_origins, index, valid));
+        Vector3f n(gather<InputVector3f>(m_directions, index, valid));
+
+        // 2. Sample spectrum
+        auto [wavelengths, wav_weight] =
+            sample_wavelength<Float, Spectrum>(wavelength_sample);
+        Spectrum weight = unpolarized<Spectrum>(select(valid, wav_weight, 0.f));
+
+        // 3. Set the direction, cosine-weighted for irradiance measurements
+        Vector3f d = n;
+        if (m_irradiance) {
+            d = Frame3f(n).to_world(warp::square_to_cosine_hemisphere(aperture_sample));
+            weight *= math::Pi<ScalarFloat>;
+        }
+
+        Ray3f ray(origin, d, time, wavelengths);
+        return std::make_pair(ray, weight);
+    }
+
+    std::pair<RayDifferential3f, Spectrum>
+    sample_ray_differential(Float time, Float wavelength_sample,
+                            const Point2f &position_sample,
+                            const Point2f &aperture_sample,
+                            Mask active) const override {
+        MTS_MASKED_FUNCTION(ProfilerPhase::EndpointSampleRay, active);
+        auto [ray, weight] = sample_ray(time, wavelength_sample, position_sample,
+                                        aperture_sample, active);
+
+        // Neighboring pixels belong to unrelated meters, there are no differentials
+        RayDifferential3f result(ray);
+        result.has_differentials = false;
+        return std::make_pair(result, weight);
+    }
+
+    ScalarBoundingBox3f bbox() const override {
+        // Return an invalid bounding box
+        return ScalarBoundingBox3f();
+    }
+
+    std::string to_string() const override {
+        std::ostringstream oss;
+        oss << "MeterArray[" << std::endl
+            << "  meter_count = " << m_meter_count << "," << std::endl
+            << "  quantity = " << (m_irradiance ? "irradiance" : "radiance") << "," << std::endl
+            << "  film = " << m_film << "," << std::endl
+            << "]";
+        return oss.str();
+    }
+
+    MTS_DECLARE_CLASS()
+private:
+    size_t m_meter_count;
+    bool m_irradiance;
+    FloatStorage m_origins;
+    FloatStorage m_directions;
+};
+
+MTS_IMPLEMENT_CLASS_VARIANT(MeterArray, Sensor)
+MTS_EXPORT_PLUGIN(MeterArray, "Meter array");
+NAMESPACE_END(mitsuba)
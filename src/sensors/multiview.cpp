@@ -0,0 +1,230 @@
+#include <mitsuba/core/fwd.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/string.h>
+#include <mitsuba/render/film.h>
+#include <mitsuba/render/fwd.h>
+#include <mitsuba/render/sensor.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+
+.. _sensor-multiview:
+
+Multi-view sensor (:monosp:`multiview`)
+---------------------------------------
+
+.. pluginparameters::
+
+ * - (Nested plugins)
+   - |sensor|
+   - The sensors that specify the individual views (e.g. the two
+     eyes of a stereo pair, the six faces of a cube map or the cameras of a
+     light field array).
+ * - columns
+   - |int|
+   - Number of views per row of the film. (Default: number of views, i.e.
+     all views are placed next to each other)
+
+This meta-sensor renders several views of a scene in a single job: the film
+is split into a grid of equally sized regions, and every region is rendered
+by one of the nested sensors. Since all views are part of the same rendering
+pass, they share the scene setup, the acceleration data structure and (on
+the GPU) the compiled kernels, which amortizes these costs over the views.
+
+The views are assigned to the regions in row-major order and in the order of
+their names (unnamed sensors in the order in which they are specified). The
+width and height of the film must be multiples of the number of columns and
+rows, and the film of every nested sensor must have the size of one region,
+so that its field of view and aspect ratio are computed consistently.
+
+The names of the views and their regions are stored in the metadata of the
+developed image: ``views`` lists the view names separated by commas, and
+``view.<name>.window`` specifies the region of a view as ``x y width height``.
+Views can hence be extracted by a post-processing step, e.g. using the crop
+operation of :monosp:`Bitmap`. Use a box reconstruction filter with a radius
+of 0.5 (or lower) to keep the views from bleeding into each other.
+
+.. code-block:: xml
+
+    <sensor type="multiview">
+        <sensor name="left" type="perspective">
+            <transform name="to_world">
+                <lookat origin="-0.03, 0, 5" target="-0.03, 0, 0" up="0, 1, 0"/>
+            </transform>
+            <film type="hdrfilm">
+                <integer name="width" value="640"/>
+                <integer name="height" value="480"/>
+            </film>
+        </sensor>
+        <sensor name="right" type="perspective">
+            <!-- ... -->
+        </sensor>
+        <film type="hdrfilm">
+            <integer name="width" value="1280"/>
+            <integer name="height" value="480"/>
+            <rfilter type="box"/>
+        </film>
+    </sensor>
+*/
+
+MTS_VARIANT class MultiViewSensor final : public Sensor<Float, Spectrum> {
+public:
+    MTS_IMPORT_BASE(Sensor, m_film, m_needs_sample_3)
+    MTS_IMPORT_TYPES()
+
+    MultiViewSensor(const Properties &props) : Base(props) {
+        m_needs_sample_3 = false;
+        for (auto &[name, obj] : props.objects()) {
+            Base *sensor = dynamic_cast<Base *>(obj.get());
+            if (!sensor)
+                continue;
+            m_views.push_back(sensor);
+            // Unnamed views are labeled by their index
+            m_names.push_back(string::starts_with(name, "_arg_")
+                                  ? tfm::format("view%i", m_names.size())
+                                  : name);
+            props.mark_queried(name);
+        }
+
+        if (m_views.empty())
+            Throw("multiview: at least one nested sensor must be specified!");
+
+        m_columns = props.size_("columns", m_views.size());
+        if (m_columns == 0 || m_columns > m_views.size())
+            Throw("multiview: invalid number of columns %i, must be between 1 and %i!",
+                  m_columns, m_views.size());
+        m_rows = (m_views.size() + m_columns - 1) / m_columns;
+
+        ScalarVector2i size = m_film->size();
+        if (size.x() % m_columns != 0 || size.y() % m_rows != 0)
+            Throw("multiview: the film size (%ix%i) must be divisible into a "
+                  "grid of %ix%i views!", size.x(), size.y(), m_columns, m_rows);
+        m_view_size = ScalarVector2i(size.x() / (int) m_columns, size.y() / (int) m_rows);
+
+        std::string views;
+        Properties &metadata = m_film->metadata();
+        for (size_t i = 0; i < m_views.size(); ++i) {
+            ScalarVector2i view_size = m_views[i]->film()->size();
+            if (view_size != m_view_size)
+                Throw("multiview: the film of view \"%s\" has size %ix%i, but the "
+                      "views are rendered with a size of %ix%i!", m_names[i],
+                      view_size.x(), view_size.y(), m_view_size.x(), m_view_size.y());
+
+            m_needs_sample_3 |= m_views[i]->needs_aperture_sample();
+
+            ScalarPoint2i offset = view_offset(i);
+            metadata.set_string("view." + m_names[i] + ".window",
+                                tfm::format("%i %i %i %i", offset.x(), offset.y(),
+                                            m_view_size.x(), m_view_size.y()));
+            views += (i == 0 ? "" : ",") + m_names[i];
+        }
+        metadata.set_string("views", views);
+    }
+
+    std::pair<Ray3f, Spectrum> sample_ray(Float time, Float wavelength_sample,
+                                          const Point2f &position_sample,
+                                          const Point2f &aperture_sample,
+                                          Mask active) const override {
+        MTS_MASKED_FUNCTION(ProfilerPhase::EndpointSampleRay, active);
+        return dispatch<Ray3f>(position_sample, active,
+            [&](const Base *view, const Point2f &local, Mask view_active) {
+                return view->sample_ray(time, wavelength_sample, local,
+                                        aperture_sample, view_active);
+            });
+    }
+
+    std::pair<RayDifferential3f, Spectrum>
+    sample_ray_differential(Float time, Float wavelength_sample,
+                            const Point2f &position_sample,
+                            const Point2f &aperture_sample,
+                            Mask active) const override {
+        MTS_MASKED_FUNCTION(ProfilerPhase::EndpointSampleRay, active);
+        return dispatch<RayDifferential3f>(position_sample, active,
+            [&](const Base *view, const Point2f &local, Mask view_active) {
+                return view->sample_ray_differential(time, wavelength_sample, local,
+                                                     aperture_sample, view_active);
+            });
+    }
+
+    ScalarBoundingBox3f bbox() const override {
+        ScalarBoundingBox3f result;
+        for (const auto &view : m_views)
+            result.expand(view->bbox());
+        return result;
+    }
+
+    void traverse(TraversalCallback *callback) override {
+        Base::traverse(callback);
+        for (size_t i = 0; i < m_views.size(); ++i)
+            callback->put_object(m_names[i], m_views[i].get());
+    }
+
+    std::string to_string() const override {
+        std::ostringstream oss;
+        oss << "MultiViewSensor[" << std::endl
+            << "  views = [" << std::endl;
+        for (size_t i = 0; i < m_views.size(); ++i)
+            oss << "    " << m_names[i] << " = " << string::indent(m_views[i], 4)
+                << (i + 1 < m_views.size() ? "," : "") << std::endl;
+        oss << "  ]," << std::endl
+            << "  columns = " << m_columns << "," << std::endl
+            << "  film = " << m_film << "," << std::endl
+            << "]";
+        return oss.str();
+    }
+
+    MTS_DECLARE_CLASS()
+private:
+    /// Upper left pixel of the region of the given view
+    ScalarPoint2i view_offset(size_t index) const {
+        return ScalarPoint2i(int(index % m_columns), int(index / m_columns)) * m_view_size;
+    }
+
+    /**
+     * \brief Map a position on the film to the view that renders it and
+     * invoke \c func with the position in the unit square of that view
+     */
+    template <typename RayType, typename Func>
+    std::pair<RayType, Spectrum> dispatch(const Point2f &position_sample, Mask active,
+                                          const Func &func) const {
+        Point2f pixel = position_sample * ScalarVector2f(m_film->crop_size()) +
+                        ScalarPoint2f(m_film->crop_offset());
+
+        Point2i cell = clamp(Point2i(floor(pixel / ScalarVector2f(m_view_size))),
+                             0, ScalarPoint2i((int) m_columns - 1, (int) m_rows - 1));
+        UInt32 index = UInt32(cell.y()) * (uint32_t) m_columns + UInt32(cell.x());
+
+        Point2f local = (pixel - Point2f(cell * m_view_size)) / ScalarVector2f(m_view_size);
+
+        if constexpr (!is_array_v<Float>) {
+            if (index >= m_views.size())
+                return { zero<RayType>(), zero<Spectrum>() };
+            return func(m_views[index].get(), local, active);
+        } else {
+            RayType ray = zero<RayType>();
+            Spectrum weight = zero<Spectrum>();
+            for (size_t i = 0; i < m_views.size(); ++i) {
+                Mask view_active = active && eq(index, (uint32_t) i);
+                if (none_or<false>(view_active))
+                    continue;
+                auto [view_ray, view_weight] = func(m_views[i].get(), local, view_active);
+                masked(ray, view_active) = view_ray;
+                masked(weight, view_active) = view_weight;
+                if constexpr (std::is_same_v<RayType, RayDifferential3f>)
+                    ray.has_differentials |= view_ray.has_differentials;
+            }
+            return { ray, weight };
+        }
+    }
+
+private:
+    std::vector<ref<Base>> m_views;
+    std::vector<std::string> m_names;
+    size_t m_columns, m_rows;
+    ScalarVector2i m_view_size;
+};
+
+MTS_IMPLEMENT_CLASS_VARIANT(MultiViewSensor, Sensor)
+MTS_EXPORT_PLUGIN(MultiViewSensor, "Multi-view sensor");
+NAMESPACE_END(mitsuba)
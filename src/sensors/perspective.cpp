@@ -215,6 +215,52 @@ public:
         return std::make_pair(ray, wav_weight);
     }
 
+    std::pair<DirectionSample3f, Spectrum>
+    sample_direction(const Interaction3f &it, const Point2f & /*sample*/,
+                     Mask active) const override {
+        MTS_MASKED_FUNCTION(ProfilerPhase::EndpointSampleDirection, active);
+
+        // Transform the reference point into the local coordinate system
+        auto trafo = m_world_transform->eval(it.time, active);
+        Point3f ref_p = trafo.inverse().transform_affine(it.p);
+
+        Float dist = norm(ref_p), inv_dist = rcp(dist);
+        Vector3f local_d = Vector3f(ref_p) * inv_dist;
+
+        // Position of the reference point on the (cropped) film
+        Point3f screen_p = m_camera_to_sample * ref_p;
+        Point2f film_p = (Point2f(screen_p.x(), screen_p.y()) - m_principal_point_offset) *
+                             ScalarVector2f(m_film->crop_size()) +
+                         ScalarVector2f(m_film->crop_offset());
+
+        Float inv_z = rcp(local_d.z());
+        active &= local_d.z() > 0.f && dist >= m_near_clip * inv_z && dist <= m_far_clip * inv_z;
+
+        DirectionSample3f ds;
+        ds.p      = trafo.translation();
+        ds.n      = trafo * Vector3f(0.f, 0.f, 1.f);
+        ds.uv     = film_p;
+        ds.time   = it.time;
+        ds.pdf    = 1.f;
+        ds.delta  = true;
+        ds.object = this;
+        ds.d      = (ds.p - it.p) * inv_dist;
+        ds.dist   = dist;
+
+        /* The cosine foreshortening of the image plane is part of importance(),
+           which hence also equals the solid angle density of sample_ray() */
+        Float weight = importance(local_d) * sqr(inv_dist);
+        return { ds, Spectrum(select(active, weight, 0.f)) };
+    }
+
+    std::pair<Float, Float> pdf_ray(const PositionSample3f &ps, const Vector3f &d,
+                                    Mask active) const override {
+        MTS_MASKED_FUNCTION(ProfilerPhase::EndpointEvaluate, active);
+
+        auto trafo = m_world_transform->eval(ps.time, active);
+        return { 1.f, importance(trafo.inverse() * d) };
+    }
+
     ScalarBoundingBox3f bbox() const override {
         return m_world_transform->translation_bounds();
     }
@@ -0,0 +1,95 @@
+import pytest
+
+import enoki as ek
+import mitsuba
+
+
+def write_meters(tmpdir, normals=True):
+    # Three meters along the X axis, oriented along +Z, +X and -Y
+    lines = ['ply', 'format ascii 1.0', 'element vertex 3',
+             'property float x', 'property float y', 'property float z']
+    if normals:
+        lines += ['property float nx', 'property float ny', 'property float nz']
+    lines.append('end_header')
+    for i, n in enumerate(['0 0 1', '1 0 0', '0 -1 0']):
+        lines.append('%i 0 0%s' % (i, (' ' + n) if normals else ''))
+    filename = str(tmpdir.join('meters.ply'))
+    with open(filename, 'w') as f:
+        f.write('\n'.join(lines) + '\n')
+    return filename
+
+
+def make_sensor(filename, quantity="radiance", width=2, height=2):
+    from mitsuba.core.xml import load_dict
+
+    return load_dict({
+        "type": "meterarray",
+        "filename": filename,
+        "quantity": quantity,
+        "film": {
+            "type": "hdrfilm",
+            "width": width,
+            "height": height,
+            "pixel_format": "rgb",
+            "rfilter": {"type": "box"}
+        },
+        "sampler": {"type": "independent", "sample_count": 4}
+    })
+
+
+def test_construct(variant_scalar_rgb, tmpdir):
+    filename = write_meters(tmpdir)
+    assert make_sensor(filename) is not None
+
+    # Not enough pixels for all meters
+    with pytest.raises(RuntimeError):
+        make_sensor(filename, width=1, height=2)
+
+    # Missing orientations
+    with pytest.raises(RuntimeError):
+        make_sensor(write_meters(tmpdir, normals=False))
+
+    with pytest.raises(RuntimeError):
+        make_sensor(filename, quantity="flux")
+
+
+def test_sample_ray(variant_scalar_rgb, tmpdir):
+    sensor = make_sensor(write_meters(tmpdir))
+    directions = [[0, 0, 1], [1, 0, 0], [0, -1, 0]]
+
+    # Pixels are assigned to the meters in scanline order
+    for i, pos in enumerate([[0.25, 0.25], [0.75, 0.25], [0.25, 0.75]]):
+        ray, weight = sensor.sample_ray(0., 0.5, pos, [0.5, 0.5], True)
+        assert ek.allclose(ray.o, [i, 0, 0])
+        assert ek.allclose(ray.d, directions[i])
+        assert ek.all(weight > 0)
+
+    # The last pixel has no meter
+    ray, weight = sensor.sample_ray(0., 0.5, [0.75, 0.75], [0.5, 0.5], True)
+    assert ek.allclose(weight, 0)
+
+    ray, _ = sensor.sample_ray_differential(0., 0.5, [0.25, 0.25], [0.5, 0.5], True)
+    assert not ray.has_differentials
+
+
+@pytest.mark.parametrize("quantity", ["radiance", "irradiance"])
+def test_render(variant_scalar_rgb, tmpdir, quantity):
+    from mitsuba.core.xml import load_dict
+    import numpy as np
+
+    radiance = 2.0
+    scene = load_dict({
+        "type": "scene",
+        "integrator": {"type": "path"},
+        "sensor": make_sensor(write_meters(tmpdir), quantity),
+        "emitter": {"type": "constant",
+                    "radiance": {"type": "uniform", "value": radiance}}
+    })
+
+    sensor = scene.sensors()[0]
+    scene.integrator().render(scene, sensor)
+    img = np.array(sensor.film().bitmap()).reshape(4, 3)
+
+    expected = radiance * (ek.pi if quantity == "irradiance" else 1)
+    assert np.allclose(img[:3], expected, rtol=1e-4)
+    assert np.allclose(img[3], 0)
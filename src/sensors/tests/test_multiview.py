@@ -0,0 +1,88 @@
+import pytest
+
+import enoki as ek
+import mitsuba
+
+
+def view_dict(x, width=16, height=12):
+    from mitsuba.core import ScalarTransform4f
+
+    return {
+        "type": "perspective",
+        "fov": 40,
+        "to_world": ScalarTransform4f.look_at(origin=[x, 0, 5], target=[x, 0, 0],
+                                              up=[0, 1, 0]),
+        "film": {"type": "hdrfilm", "width": width, "height": height}
+    }
+
+
+def make_sensor(columns=None, width=32, height=12):
+    from mitsuba.core.xml import load_dict
+
+    d = {
+        "type": "multiview",
+        "left": view_dict(-1),
+        "right": view_dict(1),
+        "film": {"type": "hdrfilm", "width": width, "height": height,
+                 "rfilter": {"type": "box"}}
+    }
+    if columns is not None:
+        d["columns"] = columns
+    return load_dict(d)
+
+
+def test01_construct(variant_scalar_rgb):
+    sensor = make_sensor()
+    assert sensor is not None
+    assert not sensor.needs_aperture_sample()
+
+    metadata = sensor.film().metadata()
+    assert metadata["views"] == "left,right"
+    assert metadata["view.left.window"] == "0 0 16 12"
+    assert metadata["view.right.window"] == "16 0 16 12"
+
+    # Views on top of each other
+    metadata = make_sensor(columns=1, width=16, height=24).film().metadata()
+    assert metadata["view.right.window"] == "0 12 16 12"
+
+    # The film can't be split into views of the size of the nested films
+    with pytest.raises(RuntimeError):
+        make_sensor(width=30)
+
+    with pytest.raises(RuntimeError):
+        make_sensor(columns=3)
+
+
+@pytest.mark.parametrize("local", [[0.25, 0.5], [0.7, 0.1], [0.05, 0.95]])
+def test02_sample_ray(variant_scalar_rgb, local):
+    from mitsuba.core.xml import load_dict
+
+    sensor = make_sensor()
+    for i, x in enumerate([-1, 1]):
+        view = load_dict(view_dict(x))
+        ray, weight = sensor.sample_ray(0.0, 0.5, [(local[0] + i) / 2, local[1]], [0.5, 0.5])
+        ref_ray, ref_weight = view.sample_ray(0.0, 0.5, local, [0.5, 0.5])
+        assert ek.allclose(ray.o, ref_ray.o)
+        assert ek.allclose(ray.d, ref_ray.d)
+        assert ek.allclose(weight, ref_weight)
+
+
+def test03_sample_ray_wavefront(variant_packet_rgb):
+    from mitsuba.core.xml import load_dict
+
+    sensor = make_sensor()
+    views = [load_dict(view_dict(x)) for x in [-1, 1]]
+
+    position = [[0.1, 0.6, 0.4, 0.9], [0.5, 0.2, 0.7, 0.3]]
+    ray, _ = sensor.sample_ray_differential(0.0, 0.5, position, [0.5, 0.5])
+    assert ray.has_differentials
+
+    for v in range(2):
+        local = [[x * 2 - v for x in position[0]], position[1]]
+        ref_ray, _ = views[v].sample_ray(0.0, 0.5, local, [0.5, 0.5])
+        for i in range(4):
+            if int(position[0][i] >= 0.5) != v:
+                continue
+            for k in range(3):
+                assert ek.allclose(ray.o[k][i], ref_ray.o[k][i], atol=1e-5)
+                assert ek.allclose(ray.d[k][i], ref_ray.d[k][i], atol=1e-5)
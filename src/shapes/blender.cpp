@@ -1,5 +1,17 @@
 #include <mitsuba/render/mesh.h>
+#include <mitsuba/core/hash.h>
+#include <mitsuba/core/profiler.h>
+#include <mitsuba/core/timer.h>
+#include <mitsuba/core/util.h>
 #include <enoki/color.h>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_reduce.h>
+#include <atomic>
+#include <unordered_map>
+
+/// Number of loop triangles that are converted by one task
+#define MTS_BLENDER_CHUNK_SIZE 65536
 
 // Blender Mesh format types for the exporter
 NAMESPACE_BEGIN(blender)
@@ -56,6 +68,13 @@ Blender mesh loader
 This plugins converts a Blender Mesh to mitsuba's mesh layout. It is used in the Blender exporter Add-on.
 It expects as input pointers to Blender mesh data structures, see GeometryExporter.save_mesh
 in the mitsuba2-blender addon for an example.
+
+The loop triangles are converted in parallel chunks. Blender vertices are split into
+several Mitsuba vertices when their loops use different texture coordinates, or when they
+belong to flat shaded faces. Each chunk collects these corners in its own hash map, and the
+maps are merged afterwards. Meshes that only contain smooth shaded faces and have neither
+texture coordinates nor vertex colors never need to be split: their vertices keep the order
+(and, when all of them are used, the indices) of the Blender mesh.
  */
 
 template <typename Float, typename Spectrum>
@@ -76,7 +95,42 @@ public:
     using typename Base::InputNormal3f;
     using typename Base::FloatStorage;
 
-    using ScalarIndex3 = std::array<ScalarIndex, 3>;
+    /// Key that defines a unique vertex
+    struct Key {
+        /// Index of the vertex in the Blender mesh
+        ScalarIndex vertex;
+        /* Polygon of flat shaded corners (comparing face normals is ambiguous
+           due to numerical precision), or -1 for smooth shading, whose normal
+           only depends on the vertex */
+        ScalarIndex poly;
+        InputVector2f uv;
+
+        bool operator==(const Key &other) const {
+            return vertex == other.vertex && poly == other.poly && uv == other.uv;
+        }
+        bool operator!=(const Key &other) const { return !operator==(other); }
+    };
+
+    struct KeyHasher {
+        size_t operator()(const Key &k) const {
+            return hash_combine(hash_combine(hash(k.vertex), hash(k.poly)),
+                                hash_combine(hash(k.uv.x()), hash(k.uv.y())));
+        }
+    };
+
+    /// Range of loop triangles that is converted by one task
+    struct BlenderChunk {
+        size_t begin = 0, end = 0;
+        /// Loop triangles of the range that belong to the exported material
+        std::vector<ScalarIndex> triangles;
+        /// Corners whose key differs from the first use of the same vertex
+        std::vector<size_t> secondary;
+        /// First corner of the chunk for each key of \c secondary
+        std::unordered_map<Key, size_t, KeyHasher> secondary_map;
+        bool flat = false;
+        std::string error;
+        size_t corner_offset = 0, id_offset = 0, id_count = 0;
+    };
 
     /**
     * This constructor created a Mesh object from the part of a blender mesh assigned to a certain material.
@@ -85,6 +139,7 @@ public:
     * \param props Contains counters and pointers to blender's data structures
     */
     BlenderMesh(const Properties &props) : Base(props) {
+        ScopedPhase sp(ProfilerPhase::LoadGeometry);
 
         auto fail = [&](const char *descr, auto... args) {
             Throw(("Error while loading Blender mesh \"%s\": " + std::string(descr))
@@ -111,13 +166,10 @@ public:
         const blender::MVert *verts =
             reinterpret_cast<const blender::MVert *>(props.long_("verts"));
 
-        bool has_cols = false;
         std::vector<std::pair<std::string, const blender::MLoopCol *>> cols;
         for (std::string &s : props.property_names()){
-            if (s.rfind("vertex_", 0) == 0){
+            if (s.rfind("vertex_", 0) == 0)
                 cols.push_back({s, reinterpret_cast<const blender::MLoopCol *>(props.long_(s))});
-                has_cols = true;
-            }
         }
 
         bool has_uvs = props.has_property("uvs");
@@ -127,192 +179,329 @@ public:
         else
             Log(Warn, "Mesh %s has no texture coordinates!", m_name);
 
-        // Temporary buffers for vertices, normals, etc.
-        std::vector<std::array<InputFloat, 3>> tmp_vertices; // Store as vector for alignement issues
-        std::vector<std::array<InputFloat, 3>> tmp_normals; // Same here
-        std::vector<InputVector2f> tmp_uvs;
-        std::vector<std::vector<std::array<InputFloat, 3>>> tmp_cols; // And same here
-        std::vector<ScalarIndex3> tmp_triangles;
-
-        tmp_vertices.reserve(vertex_count);
-        tmp_normals.reserve(vertex_count);
-        tmp_triangles.reserve(loop_tri_count);
+        Timer timer;
 
-        if (has_uvs)
-            tmp_uvs.reserve(vertex_count);
-        if (has_cols) {
-            tmp_cols.reserve(cols.size());
-            for (size_t p = 0; p < cols.size(); p++) {
-                tmp_cols.push_back(std::vector<std::array<InputFloat, 3>>());
-                tmp_cols[p].reserve(vertex_count);
-            }
-        }
-
-        ScalarIndex vertex_ctr = 0;
-
-        // Hash map key to define a unique vertex
-        struct Key {
-            InputNormal3f normal;
-            bool smooth{ false };
-            size_t poly{ 0 }; // store the polygon face for flat shading, since
-                              // comparing normals is ambiguous due to numerical
-                              // precision
-            InputVector2f uv{ 0.0f, 0.0f };
-            bool operator==(const Key &other) const {
-                return (smooth ? normal == other.normal : poly == other.poly) &&
-                       uv == other.uv;
-            }
-            bool operator!=(const Key &other) const {
-                return (smooth ? normal != other.normal : poly != other.poly) ||
-                       uv != other.uv;
-            }
+        // Position and (transformed) normals of a vertex of the Blender mesh
+        auto position = [&](size_t vert_index) {
+            const blender::MVert &vert = verts[vert_index];
+            return InputPoint3f(vert.co[0], vert.co[1], vert.co[2]);
         };
-
-        // Hash map entry
-        struct VertexBinding {
-            Key key;
-            // Index of the vertex in the vertex array
-            ScalarIndex value{ 0 };
-            VertexBinding *next{ nullptr };
-            bool is_init{ false };
+        auto smooth_normal = [&](size_t vert_index) {
+            const blender::MVert &vert = verts[vert_index];
+            return InputNormal3f(m_to_world.transform_affine(
+                InputNormal3f(vert.no[0], vert.no[1], vert.no[2])));
+        };
+        auto flat_normal = [&](const blender::MLoopTri &tri_loop) {
+            InputPoint3f p0 = position(loops[tri_loop.tri[0]].v),
+                         p1 = position(loops[tri_loop.tri[1]].v),
+                         p2 = position(loops[tri_loop.tri[2]].v);
+            return InputNormal3f(m_to_world.transform_affine(cross(p1 - p0, p2 - p0)));
         };
 
-        // Hash Map to avoid adding duplicate vertices
-        std::vector<VertexBinding> vertex_map(vertex_count);
-
-        size_t duplicates_ctr = 0;
-        for (size_t tri_loop_id = 0; tri_loop_id < loop_tri_count; tri_loop_id++) {
+        // Key of corner 'i' of a loop triangle
+        auto corner_key = [&](ScalarIndex tri_loop_id, int i) {
             const blender::MLoopTri &tri_loop = tri_loops[tri_loop_id];
-            const blender::MPoly &face        = polygons[tri_loop.poly];
-
-            // We only export the part of the mesh corresponding to the given
-            // material id
-            if (face.mat_nr != mat_nr)
-                continue;
-
-            ScalarIndex3 triangle;
-
-            const blender::MVert &v0 = verts[loops[tri_loop.tri[0]].v];
-            const blender::MVert &v1 = verts[loops[tri_loop.tri[1]].v];
-            const blender::MVert &v2 = verts[loops[tri_loop.tri[2]].v];
-
-            Array<InputPoint3f, 3> face_points;
-            face_points[0] = InputPoint3f(v0.co[0], v0.co[1], v0.co[2]);
-            face_points[1] = InputPoint3f(v1.co[0], v1.co[1], v1.co[2]);
-            face_points[2] = InputPoint3f(v2.co[0], v2.co[1], v2.co[2]);
-
-            InputNormal3f normal;
-            if (!(blender::ME_SMOOTH & face.flag)) {
-                // Flat shading, use per face normals
-                const InputVector3f e1 = face_points[1] - face_points[0];
-                const InputVector3f e2 = face_points[2] - face_points[0];
-                normal = m_to_world.transform_affine(cross(e1, e2));
-                if(unlikely(all(eq(normal, 0.f))))
-                    continue; // Degenerate triangle, ignore it
-                else
-                    normal = normalize(normal);
-            }
+            const size_t loop_index = tri_loop.tri[i];
+            Key key;
+            key.vertex = loops[loop_index].v;
+            key.poly = (blender::ME_SMOOTH & polygons[tri_loop.poly].flag)
+                           ? ScalarIndex(-1) : tri_loop.poly;
+            key.uv = InputVector2f(0.f);
+            if (has_uvs)
+                key.uv = InputVector2f(uvs[loop_index].uv[0], 1.0f - uvs[loop_index].uv[1]);
+            return key;
+        };
 
-            InputFloat color_factor = rcp(255.f);
+        size_t chunk_count = std::max((size_t) 1, (loop_tri_count + MTS_BLENDER_CHUNK_SIZE - 1) /
+                                                      MTS_BLENDER_CHUNK_SIZE);
+        std::vector<BlenderChunk> chunks(chunk_count);
+        for (size_t i = 0; i < chunk_count; ++i) {
+            chunks[i].begin = i * MTS_BLENDER_CHUNK_SIZE;
+            chunks[i].end = std::min(loop_tri_count, (i + 1) * MTS_BLENDER_CHUNK_SIZE);
+        }
 
-            for (int i = 0; i < 3; i++) {
-                const size_t loop_index = tri_loop.tri[i];
-                const size_t vert_index = loops[loop_index].v;
-                if (unlikely((vert_index >= vertex_count)))
-                    fail("reference to invalid vertex %i!", vert_index);
+        /* Pass 1: select the loop triangles of the material, skip degenerate
+           flat shaded ones and validate all vertex references */
+        tbb::parallel_for(size_t(0), chunk_count, [&](size_t i) {
+            BlenderChunk &chunk = chunks[i];
+            chunk.triangles.reserve(chunk.end - chunk.begin);
+            for (size_t tri_loop_id = chunk.begin; tri_loop_id < chunk.end; ++tri_loop_id) {
+                const blender::MLoopTri &tri_loop = tri_loops[tri_loop_id];
+                const blender::MPoly &face        = polygons[tri_loop.poly];
+
+                // We only export the part of the mesh corresponding to the given material id
+                if (face.mat_nr != mat_nr)
+                    continue;
+
+                bool smooth = blender::ME_SMOOTH & face.flag;
+                for (int j = 0; j < 3; j++) {
+                    const size_t vert_index = loops[tri_loop.tri[j]].v;
+                    if (unlikely(vert_index >= vertex_count)) {
+                        chunk.error = tfm::format("reference to invalid vertex %i!", vert_index);
+                        return;
+                    }
+                    if (smooth && unlikely(all(eq(smooth_normal(vert_index), 0.f)))) {
+                        chunk.error = "Mesh has invalid normals!";
+                        return;
+                    }
+                }
 
-                const blender::MVert &vert = verts[vert_index];
+                // Degenerate triangle, ignore it
+                if (!smooth && unlikely(all(eq(flat_normal(tri_loop), 0.f))))
+                    continue;
 
-                Key vert_key;
-                if (blender::ME_SMOOTH & face.flag) {
-                    // Smooth shading, store per vertex normals
-                    normal = m_to_world.transform_affine(InputNormal3f(vert.no[0], vert.no[1], vert.no[2]));
-                    if(unlikely(all(eq(normal, 0.f))))
-                        fail("Mesh has invalid normals!");
-                    else
-                        normal = normalize(normal);
-                    vert_key.smooth = true;
-                } else {
-                    // vert_key.smooth = false (default), flat shading
-                    // Store the referenced polygon (face)
-                    vert_key.poly = tri_loop.poly;
-                }
+                chunk.flat |= !smooth;
+                chunk.triangles.push_back((ScalarIndex) tri_loop_id);
+            }
+        });
+
+        size_t corner_count = 0;
+        bool flat = false;
+        for (BlenderChunk &chunk : chunks) {
+            if (!chunk.error.empty())
+                fail("%s", chunk.error);
+            chunk.corner_offset = corner_count;
+            corner_count += chunk.triangles.size() * 3;
+            flat |= chunk.flat;
+        }
 
-                vert_key.normal = normal;
+        if (corner_count == 0)
+            return;
 
-                if (has_uvs) {
-                    const blender::MLoopUV &loop_uv = uvs[loop_index];
-                    const InputVector2f uv(loop_uv.uv[0], 1.0f - loop_uv.uv[1]);
-                    vert_key.uv = uv;
-                }
+        // Pass 2: find the first corner referencing each vertex
+        std::unique_ptr<std::atomic<size_t>[]> first_corner(
+            new std::atomic<size_t>[vertex_count]);
+        for (size_t i = 0; i < vertex_count; ++i)
+            first_corner[i].store((size_t) -1, std::memory_order_relaxed);
+
+        tbb::parallel_for(size_t(0), chunk_count, [&](size_t i) {
+            const BlenderChunk &chunk = chunks[i];
+            for (size_t j = 0; j < chunk.triangles.size() * 3; ++j) {
+                const blender::MLoopTri &tri_loop = tri_loops[chunk.triangles[j / 3]];
+                size_t c = chunk.corner_offset + j;
+                std::atomic<size_t> &first = first_corner[loops[tri_loop.tri[j % 3]].v];
+                size_t value = first.load(std::memory_order_relaxed);
+                while (c < value && !first.compare_exchange_weak(value, c))
+                    ;
+            }
+        });
+
+        // Return the chunk containing the corner with global index 'c'
+        auto corner_chunk = [&](size_t c) -> const BlenderChunk & {
+            auto it = std::upper_bound(
+                chunks.begin(), chunks.end(), c,
+                [](size_t c, const BlenderChunk &chunk) { return c < chunk.corner_offset; });
+            return *(it - 1);
+        };
+        auto global_corner_key = [&](size_t c) {
+            const BlenderChunk &chunk = corner_chunk(c);
+            size_t j = c - chunk.corner_offset;
+            return corner_key(chunk.triangles[j / 3], (int) (j % 3));
+        };
 
-                // Vertex index in the blender mesh is the map index
-                VertexBinding *map_entry = &vertex_map[vert_index];
-                while (vert_key != map_entry->key && map_entry->next != nullptr)
-                    map_entry = map_entry->next;
-
-                if (map_entry->is_init && map_entry->key == vert_key) {
-                    triangle[i] = map_entry->value;
-                    duplicates_ctr++;
-                } else {
-                    if (map_entry->is_init) {
-                        // Add a new entry
-                        map_entry->next = new VertexBinding();
-                        map_entry       = map_entry->next;
-                    }
-                    ScalarSize vert_id = vertex_ctr++;
-                    map_entry->key     = vert_key;
-                    map_entry->value   = vert_id;
-                    map_entry->is_init = true;
-                    // Add stuff to the temporary buffers
-                    InputPoint3f pt = m_to_world.transform_affine(face_points[i]);
-                    tmp_vertices.push_back({pt.x(), pt.y(), pt.z()});
-                    tmp_normals.push_back({normal.x(), normal.y(), normal.z()});
-                    if (has_uvs)
-                        tmp_uvs.push_back(vert_key.uv);
-                    if (has_cols) {
-                        for (size_t p = 0; p < cols.size(); p++) {
-                            const blender::MLoopCol &loop_col = cols[p].second[loop_index];
-                            // Blender stores vertex colors in sRGB space
-                            tmp_cols[p].push_back({
-                                srgb_to_linear(loop_col.r * color_factor),
-                                srgb_to_linear(loop_col.g * color_factor),
-                                srgb_to_linear(loop_col.b * color_factor)
-                            });
-                        }
+        /* Vertices only need to be split by their key if a mesh has flat
+           shaded faces, texture coordinates or vertex colors */
+        bool direct = !flat && !has_uvs && cols.empty();
+
+        // Maps each secondary key to its first corner and (later) its vertex ID
+        std::unordered_map<Key, std::pair<size_t, ScalarIndex>, KeyHasher> secondary_map;
+
+        if (!direct) {
+            /* Pass 3: collect corners that use a vertex with different texture
+               coordinates or normals than its first use in per-chunk maps */
+            tbb::parallel_for(size_t(0), chunk_count, [&](size_t i) {
+                BlenderChunk &chunk = chunks[i];
+                for (size_t j = 0; j < chunk.triangles.size() * 3; ++j) {
+                    Key key = corner_key(chunk.triangles[j / 3], (int) (j % 3));
+                    size_t first = first_corner[key.vertex].load(std::memory_order_relaxed);
+                    if (first != chunk.corner_offset + j && global_corner_key(first) != key) {
+                        chunk.secondary.push_back(j);
+                        chunk.secondary_map.emplace(key, chunk.corner_offset + j);
                     }
-                    triangle[i] = vert_id;
                 }
+            });
+
+            // Merge the maps in chunk order, which keeps the first corner of every key
+            for (BlenderChunk &chunk : chunks) {
+                for (auto &kv : chunk.secondary_map)
+                    secondary_map.emplace(kv.first, std::make_pair(kv.second, ScalarIndex(0)));
+                chunk.secondary_map.clear();
             }
-            tmp_triangles.push_back(triangle);
         }
-        Log(Info, "%s: Removed %i duplicates", m_name, duplicates_ctr);
 
-        if (vertex_ctr == 0)
-            return;
+        /* Invoke 'func(j, key, primary, first)' for the corners of a chunk, where
+           'first' specifies whether the corner creates a new vertex */
+        auto for_each_corner = [&](const BlenderChunk &chunk, auto func) {
+            auto secondary_it = chunk.secondary.begin();
+            for (size_t j = 0; j < chunk.triangles.size() * 3; ++j) {
+                Key key = corner_key(chunk.triangles[j / 3], (int) (j % 3));
+                size_t c = chunk.corner_offset + j;
+                bool primary = secondary_it == chunk.secondary.end() || *secondary_it != j;
+                if (!primary)
+                    ++secondary_it;
+                bool first = primary
+                    ? first_corner[key.vertex].load(std::memory_order_relaxed) == c
+                    : secondary_map.find(key)->second.first == c;
+                func(j, key, primary, first);
+            }
+        };
 
-        m_face_count = (ScalarSize) tmp_triangles.size();
-        m_faces_buf = DynamicBuffer<UInt32>::copy(tmp_triangles.data(), m_face_count * 3);
+        /* Vertex IDs of the primary corners. Meshes without splits keep the
+           order of the Blender vertices (and their indices, if all of them are
+           used), otherwise vertices are numbered in the order of first use. */
+        std::vector<ScalarIndex> primary_id;
+        ScalarIndex vertex_ctr = 0;
+        bool identity = direct;
+        if (direct) {
+            for (size_t i = 0; i < vertex_count && identity; ++i)
+                identity = first_corner[i].load(std::memory_order_relaxed) != (size_t) -1;
+
+            if (identity) {
+                vertex_ctr = (ScalarIndex) vertex_count;
+            } else {
+                primary_id.resize(vertex_count);
+                for (size_t i = 0; i < vertex_count; ++i) {
+                    if (first_corner[i].load(std::memory_order_relaxed) != (size_t) -1)
+                        primary_id[i] = vertex_ctr++;
+                }
+            }
+        } else {
+            primary_id.resize(vertex_count);
+
+            // Pass 4: count the new vertices per chunk
+            tbb::parallel_for(size_t(0), chunk_count, [&](size_t i) {
+                BlenderChunk &chunk = chunks[i];
+                for_each_corner(chunk, [&](size_t, const Key &, bool, bool first) {
+                    chunk.id_count += first ? 1 : 0;
+                });
+            });
+
+            for (BlenderChunk &chunk : chunks) {
+                chunk.id_offset = vertex_ctr;
+                vertex_ctr += (ScalarIndex) chunk.id_count;
+            }
+        }
 
         m_vertex_count = vertex_ctr;
-        m_vertex_positions_buf = FloatStorage::copy(tmp_vertices.data(), m_vertex_count * 3);
-        m_vertex_normals_buf = FloatStorage::copy(tmp_normals.data(), m_vertex_count * 3);
+        m_face_count = (ScalarSize) (corner_count / 3);
 
+        m_faces_buf = empty<DynamicBuffer<UInt32>>(m_face_count * 3);
+        m_vertex_positions_buf = empty<FloatStorage>(m_vertex_count * 3);
+        m_vertex_normals_buf = empty<FloatStorage>(m_vertex_count * 3);
         if (has_uvs)
-            m_vertex_texcoords_buf = FloatStorage::copy(tmp_uvs.data(), m_vertex_count * 2);
-        if (has_cols) {
-            for (size_t p = 0; p < cols.size(); p++) {
-                add_attribute(
-                    cols[p].first, 3,
-                    FloatStorage::copy(tmp_cols[p].data(), m_vertex_count * 3));
-            }
-        }
+            m_vertex_texcoords_buf = empty<FloatStorage>(m_vertex_count * 2);
+        std::vector<FloatStorage> col_bufs;
+        for (size_t p = 0; p < cols.size(); p++)
+            col_bufs.push_back(empty<FloatStorage>(m_vertex_count * 3));
 
         m_faces_buf.managed();
         m_vertex_positions_buf.managed();
         m_vertex_normals_buf.managed();
         if (has_uvs)
             m_vertex_texcoords_buf.managed();
+        for (FloatStorage &buf : col_bufs)
+            buf.managed();
+
+        if constexpr (is_cuda_array_v<Float>)
+            cuda_sync();
+
+        InputFloat color_factor = rcp(255.f);
+
+        // Write the attributes of a new vertex, given the corner that created it
+        auto write_vertex = [&](ScalarIndex id, ScalarIndex tri_loop_id, int i,
+                                const Key &key, ScalarBoundingBox3f &bbox) {
+            const blender::MLoopTri &tri_loop = tri_loops[tri_loop_id];
+            const size_t loop_index = tri_loop.tri[i];
+
+            InputPoint3f p = m_to_world.transform_affine(position(key.vertex));
+            InputNormal3f n = normalize(key.poly == ScalarIndex(-1) ? smooth_normal(key.vertex)
+                                                                    : flat_normal(tri_loop));
+            store_unaligned(m_vertex_positions_buf.data() + id * 3, p);
+            store_unaligned(m_vertex_normals_buf.data() + id * 3, n);
+            bbox.expand(ScalarPoint3f(p));
+
+            if (has_uvs)
+                store_unaligned(m_vertex_texcoords_buf.data() + id * 2, key.uv);
+
+            for (size_t p2 = 0; p2 < cols.size(); p2++) {
+                const blender::MLoopCol &loop_col = cols[p2].second[loop_index];
+                // Blender stores vertex colors in sRGB space
+                InputFloat *col_ptr = col_bufs[p2].data() + id * 3;
+                col_ptr[0] = srgb_to_linear(loop_col.r * color_factor);
+                col_ptr[1] = srgb_to_linear(loop_col.g * color_factor);
+                col_ptr[2] = srgb_to_linear(loop_col.b * color_factor);
+            }
+        };
+
+        auto merge_bbox = [](ScalarBoundingBox3f a, const ScalarBoundingBox3f &b) {
+            a.expand(b);
+            return a;
+        };
+
+        if (direct) {
+            // Pass 4: write the vertices in the order of the Blender mesh
+            m_bbox = tbb::parallel_reduce(
+                tbb::blocked_range<size_t>(0, vertex_count, MTS_BLENDER_CHUNK_SIZE),
+                ScalarBoundingBox3f(),
+                [&](const tbb::blocked_range<size_t> &range, ScalarBoundingBox3f bbox) {
+                    for (size_t v = range.begin(); v != range.end(); ++v) {
+                        size_t c = first_corner[v].load(std::memory_order_relaxed);
+                        if (c == (size_t) -1)
+                            continue;
+                        const BlenderChunk &chunk = corner_chunk(c);
+                        size_t j = c - chunk.corner_offset;
+                        ScalarIndex tri_loop_id = chunk.triangles[j / 3];
+                        write_vertex(identity ? (ScalarIndex) v : primary_id[v], tri_loop_id,
+                                     (int) (j % 3), corner_key(tri_loop_id, (int) (j % 3)),
+                                     bbox);
+                    }
+                    return bbox;
+                },
+                merge_bbox);
+        } else {
+            /* Pass 5: assign vertex IDs in the order of their first use and
+               write the vertex attributes */
+            std::vector<ScalarBoundingBox3f> bboxes(chunk_count);
+            tbb::parallel_for(size_t(0), chunk_count, [&](size_t i) {
+                BlenderChunk &chunk = chunks[i];
+                ScalarIndex id = (ScalarIndex) chunk.id_offset;
+                for_each_corner(chunk, [&](size_t j, const Key &key, bool primary, bool first) {
+                    if (!first)
+                        return;
+                    if (primary)
+                        primary_id[key.vertex] = id;
+                    else
+                        secondary_map.find(key)->second.second = id;
+                    write_vertex(id++, chunk.triangles[j / 3], (int) (j % 3), key, bboxes[i]);
+                });
+            });
+            for (const ScalarBoundingBox3f &bbox : bboxes)
+                m_bbox.expand(bbox);
+        }
+
+        // Write the face indices
+        tbb::parallel_for(size_t(0), chunk_count, [&](size_t i) {
+            const BlenderChunk &chunk = chunks[i];
+            ScalarIndex *face_ptr = m_faces_buf.data() + chunk.corner_offset;
+            if (direct) {
+                for (size_t j = 0; j < chunk.triangles.size() * 3; ++j) {
+                    ScalarIndex v = loops[tri_loops[chunk.triangles[j / 3]].tri[j % 3]].v;
+                    face_ptr[j] = identity ? v : primary_id[v];
+                }
+            } else {
+                for_each_corner(chunk, [&](size_t j, const Key &key, bool primary, bool) {
+                    face_ptr[j] = primary ? primary_id[key.vertex]
+                                          : secondary_map.find(key)->second.second;
+                });
+            }
+        });
+
+        for (size_t p = 0; p < cols.size(); p++)
+            add_attribute(cols[p].first, 3, col_bufs[p]);
+
+        Log(Info, "%s: Removed %i duplicates", m_name, corner_count - m_vertex_count);
+        Log(Debug, "\"%s\": converted %i faces, %i vertices (took %s)", m_name, m_face_count,
+            m_vertex_count, util::time_string(timer.value()));
 
         if constexpr (is_cuda_array_v<Float>)
             cuda_sync();
@@ -0,0 +1,497 @@
+#include <mitsuba/core/fresolver.h>
+#include <mitsuba/core/fwd.h>
+#include <mitsuba/core/math.h>
+#include <mitsuba/core/mmap.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/thread.h>
+#include <mitsuba/core/timer.h>
+#include <mitsuba/core/transform.h>
+#include <mitsuba/core/util.h>
+#include <mitsuba/render/fwd.h>
+#include <mitsuba/render/interaction.h>
+#include <mitsuba/render/shape.h>
+#include <cstdlib>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+
+.. _shape-bsplinecurve:
+
+B-spline curves (:monosp:`bsplinecurve`)
+----------------------------------------------------
+
+.. pluginparameters::
+
+ * - filename
+   - |string|
+   - Filename of the curve file that should be loaded
+ * - flat
+   - |bool|
+   - Render the curves as flat ribbons that always face the incident ray
+     instead of round tubes. (Default: |false|)
+ * - to_world
+   - |transform|
+   - Specifies an optional linear object-to-world transformation. The radii
+     are scaled by the cube root of its determinant. (Default: none, i.e.
+     object space = world space)
+
+This shape plugin loads a set of strands (e.g. hair or fur) that are
+described by uniform cubic B-spline curves with per-vertex radii. Compared
+to a tessellation into cylinders or triangle ribbons, this requires an order
+of magnitude less memory, and acceleration data structures are much faster
+to build.
+
+Curve files are plain text files that contain one control point per line,
+given by its position, its radius and optionally texture coordinates (i.e.
+``x y z radius`` or ``x y z radius u v``). Strands are separated by blank
+lines, and lines starting with ``#`` are ignored. Every strand needs at
+least 4 control points; as usual for B-splines, the curve does not pass
+through its first and last control point. When no texture coordinates are
+given, the ``u`` coordinate of the surface parameterization goes from 0 to
+1 along each strand, and ``v`` goes around the tube (or across the ribbon).
+
+When Mitsuba is compiled with Embree, the curves are mapped onto Embree's
+native B-spline curves. The kd-tree and BVH instead intersect every curve
+segment as a sequence of linear pieces, which is a close approximation of
+the curve for thin strands. The GPU variants don't support curves yet.
+
+.. code-block:: xml
+
+    <shape type="bsplinecurve">
+        <string name="filename" value="hair.txt"/>
+    </shape>
+ */
+
+template <typename Float, typename Spectrum>
+class BSplineCurve final : public Shape<Float, Spectrum> {
+public:
+    MTS_IMPORT_BASE(Shape, m_to_world, set_children, get_children_string)
+    MTS_IMPORT_TYPES()
+
+    using typename Base::ScalarIndex;
+    using typename Base::ScalarSize;
+
+    using InputFloat    = float;
+    using FloatStorage  = DynamicBuffer<replace_scalar_t<Float, InputFloat>>;
+    using IndexStorage  = DynamicBuffer<UInt32>;
+    using Vector4f      = Vector<Float, 4>;
+    using ScalarVector4f = Vector<ScalarFloat, 4>;
+
+    /// Number of linear pieces per segment used by the native intersection routine
+    static constexpr size_t PieceCount = 8;
+
+    BSplineCurve(const Properties &props) : Base(props) {
+        if constexpr (is_cuda_array_v<Float>)
+            Throw("bsplinecurve: curves are not supported by the GPU variants yet!");
+
+        m_flat = props.bool_("flat", false);
+
+        auto fs = Thread::thread()->file_resolver();
+        fs::path file_path = fs->resolve(props.string("filename"));
+        m_name = file_path.filename().string();
+
+        auto fail = [&](const char *descr, auto... args) {
+            Throw(("Error while loading curve file \"%s\": " + std::string(descr))
+                      .c_str(), m_name, args...);
+        };
+
+        Log(Debug, "Loading curves from \"%s\" ..", m_name);
+        if (!fs::exists(file_path))
+            fail("file not found");
+
+        ref<MemoryMappedFile> mmap = new MemoryMappedFile(file_path);
+        Timer timer;
+
+        std::vector<InputFloat> vertices, texcoords, segment_u;
+        std::vector<ScalarIndex> segments;
+        size_t strand_start = 0, line_number = 0, strand_count = 0;
+        bool has_texcoords = false;
+        ScalarFloat radius_scale = std::cbrt(std::abs(det(m_to_world.matrix)));
+
+        // Turn the control points [strand_start, vertex count) into segments
+        auto end_strand = [&]() {
+            size_t count = vertices.size() / 4 - strand_start;
+            if (count == 0)
+                return;
+            if (count < 4)
+                fail("strand ending on line %i has fewer than 4 control points", line_number);
+            for (size_t i = 0; i + 3 < count; ++i) {
+                segments.push_back((ScalarIndex) (strand_start + i));
+                segment_u.push_back(InputFloat(i) / InputFloat(count - 3));
+                segment_u.push_back(InputFloat(i + 1) / InputFloat(count - 3));
+            }
+            strand_start += count;
+            strand_count++;
+        };
+
+        const char *ptr = (const char *) mmap->data(),
+                   *eof = ptr + mmap->size();
+
+        while (ptr < eof) {
+            const char *eol = ptr;
+            while (eol < eof && *eol != '\n')
+                ++eol;
+            std::string line(ptr, eol);
+            ptr = eol + 1;
+            line_number++;
+
+            size_t first = line.find_first_not_of(" \t\r");
+            if (first == std::string::npos) {
+                end_strand();
+                continue;
+            } else if (line[first] == '#') {
+                continue;
+            }
+
+            float values[6];
+            size_t value_count = 0;
+            const char *cur = line.c_str();
+            while (value_count < 6) {
+                char *next;
+                values[value_count] = std::strtof(cur, &next);
+                if (next == cur)
+                    break;
+                cur = next;
+                value_count++;
+            }
+
+            if (value_count != 4 && value_count != 6)
+                fail("line %i: expected \"x y z radius [u v]\"", line_number);
+            if (vertices.empty())
+                has_texcoords = value_count == 6;
+            else if (has_texcoords != (value_count == 6))
+                fail("line %i: either all or none of the control points must "
+                     "specify texture coordinates", line_number);
+
+            ScalarPoint3f p = m_to_world.transform_affine(
+                ScalarPoint3f(values[0], values[1], values[2]));
+            vertices.insert(vertices.end(), { (InputFloat) p.x(), (InputFloat) p.y(),
+                                              (InputFloat) p.z(),
+                                              (InputFloat) (values[3] * radius_scale) });
+            if (has_texcoords)
+                texcoords.insert(texcoords.end(), { values[4], values[5] });
+        }
+        end_strand();
+
+        if (segments.empty())
+            fail("the file does not contain any strands");
+
+        m_vertex_count  = vertices.size() / 4;
+        m_segment_count = segments.size();
+
+        m_vertices = FloatStorage::copy(vertices.data(), vertices.size());
+        m_segments = IndexStorage::copy(segments.data(), segments.size());
+        m_segment_u = FloatStorage::copy(segment_u.data(), segment_u.size());
+        if (has_texcoords)
+            m_texcoords = FloatStorage::copy(texcoords.data(), texcoords.size());
+
+        for (ScalarIndex i = 0; i < m_segment_count; ++i)
+            m_bbox.expand(bbox(i));
+
+        Log(Debug, "\"%s\": read %i strands with %i segments (%s in %s)", m_name,
+            strand_count, m_segment_count,
+            util::mem_string(vertices.size() * sizeof(InputFloat) +
+                             segments.size() * sizeof(ScalarIndex) +
+                             (segment_u.size() + texcoords.size()) * sizeof(InputFloat)),
+            util::time_string(timer.value()));
+
+        set_children();
+    }
+
+    // =============================================================
+    //! @{ \name Curve evaluation
+    // =============================================================
+
+    /// Return the control point (position and radius) with index \c index
+    template <typename Index>
+    MTS_INLINE auto control_point(Index index, mask_t<Index> active = true) const {
+        using Result = Vector<replace_scalar_t<Index, ScalarFloat>, 4>;
+        return Result(gather<Vector<replace_scalar_t<Index, InputFloat>, 4>>(
+            m_vertices, index, active));
+    }
+
+    /// Evaluate the uniform cubic B-spline basis (or its derivative) at \c t
+    template <bool Derivative = false, typename Value>
+    static MTS_INLINE Array<Value, 4> basis(const Value &t) {
+        Value t2 = t * t, s = 1.f - t;
+        if constexpr (!Derivative) {
+            Value t3 = t2 * t;
+            return Array<Value, 4>(s * s * s, 3.f * t3 - 6.f * t2 + 4.f,
+                                   -3.f * t3 + 3.f * t2 + 3.f * t + 1.f, t3) * (1.f / 6.f);
+        } else {
+            return Array<Value, 4>(-s * s, 3.f * t2 - 4.f * t,
+                                   -3.f * t2 + 2.f * t + 1.f, t2) * .5f;
+        }
+    }
+
+    //! @}
+    // =============================================================
+
+    // =============================================================
+    //! @{ \name Ray tracing routines
+    // =============================================================
+
+    PreliminaryIntersection3f ray_intersect_primitive(ScalarIndex index, const Ray3f &ray,
+                                                      Mask active) const override {
+        MTS_MASK_ARGUMENT(active);
+
+        ScalarIndex first = m_segments.data()[index];
+        ScalarVector4f c[4];
+        for (size_t k = 0; k < 4; ++k)
+            c[k] = control_point(first + (ScalarIndex) k);
+
+        auto eval = [&](ScalarFloat t) {
+            Array<ScalarFloat, 4> b = basis(t);
+            return c[0] * b[0] + c[1] * b[1] + c[2] * b[2] + c[3] * b[3];
+        };
+
+        PreliminaryIntersection3f pi = zero<PreliminaryIntersection3f>();
+        pi.t = math::Infinity<Float>;
+
+        Float A = squared_norm(ray.d);
+
+        /* Intersect the ray with every linear piece of the segment. Each
+           piece is a tube (or ribbon) whose radius varies linearly, the
+           closest approach of the ray to its centerline determines the hit. */
+        ScalarVector4f p_prev = eval(0.f);
+        for (size_t k = 0; k < PieceCount; ++k) {
+            ScalarVector4f p_next = eval(ScalarFloat(k + 1) / ScalarFloat(PieceCount));
+
+            ScalarPoint3f a = head<3>(p_prev);
+            ScalarVector3f u = head<3>(p_next) - a;
+            ScalarFloat C = squared_norm(u);
+
+            Vector3f w0 = ray.o - a;
+            Float B = dot(ray.d, u), D = dot(ray.d, w0), E = dot(u, w0),
+                  denom = A * C - B * B;
+
+            // Parameters of closest approach along the piece and along the ray
+            Float w = clamp(select(denom > 1e-8f * A * C, (A * E - B * D) / denom, 0.f), 0.f, 1.f),
+                  s = (w * B - D) / A;
+
+            Float dist2 = squared_norm(fmadd(ray.d, s, w0) - u * w),
+                  r     = lerp(p_prev.w(), p_next.w(), w),
+                  r2    = r * r;
+
+            Float t = s;
+            if (!m_flat) {
+                /* Distance along the ray from the closest approach to the tube
+                   surface (clamped for rays running along the centerline) */
+                Float d_perp2 = max(A - B * B * rcp(max(C, math::Epsilon<ScalarFloat>)), 1e-2f * A),
+                      offset  = sqrt(max(r2 - dist2, 0.f) / d_perp2);
+                t = s - offset;
+                masked(t, t < ray.mint) = s + offset;
+            }
+
+            Mask hit = active && dist2 <= r2 && t >= ray.mint && t <= ray.maxt && t < pi.t;
+            masked(pi.t, hit) = t;
+            masked(pi.prim_uv, hit) =
+                Point2f((ScalarFloat(k) + w) * (1.f / ScalarFloat(PieceCount)), 0.f);
+
+            p_prev = p_next;
+        }
+
+        pi.prim_index = index;
+        pi.shape = this;
+
+        return pi;
+    }
+
+    Mask ray_test_primitive(ScalarIndex index, const Ray3f &ray, Mask active) const override {
+        MTS_MASK_ARGUMENT(active);
+        return ray_intersect_primitive(index, ray, active).is_valid();
+    }
+
+    PreliminaryIntersection3f ray_intersect_preliminary(const Ray3f &ray_,
+                                                        Mask active) const override {
+        MTS_MASK_ARGUMENT(active);
+
+        // Brute force, the acceleration data structures intersect the segments individually
+        Ray3f ray(ray_);
+        PreliminaryIntersection3f pi = zero<PreliminaryIntersection3f>();
+        pi.t = math::Infinity<Float>;
+
+        for (ScalarIndex i = 0; i < m_segment_count; ++i) {
+            PreliminaryIntersection3f pi_i = ray_intersect_primitive(i, ray, active);
+            Mask hit = pi_i.is_valid();
+            masked(pi.t, hit) = pi_i.t;
+            masked(pi.prim_uv, hit) = pi_i.prim_uv;
+            masked(pi.prim_index, hit) = UInt32(i);
+            masked(ray.maxt, hit) = pi_i.t;
+        }
+
+        pi.shape = this;
+        return pi;
+    }
+
+    Mask ray_test(const Ray3f &ray, Mask active) const override {
+        MTS_MASK_ARGUMENT(active);
+
+        Mask hit = false;
+        for (ScalarIndex i = 0; i < m_segment_count && any(active && !hit); ++i)
+            hit |= ray_test_primitive(i, ray, active && !hit);
+        return hit;
+    }
+
+    SurfaceInteraction3f compute_surface_interaction(const Ray3f &ray,
+                                                     PreliminaryIntersection3f pi,
+                                                     HitComputeFlags flags,
+                                                     Mask active) const override {
+        MTS_MASK_ARGUMENT(active);
+
+        active &= pi.is_valid();
+
+        UInt32 first = gather<UInt32>(m_segments, pi.prim_index, active);
+        Float t = clamp(pi.prim_uv.x(), 0.f, 1.f);
+        Array<Float, 4> b = basis(t), db = basis<true>(t);
+
+        Vector4f c[4];
+        for (size_t k = 0; k < 4; ++k)
+            c[k] = control_point(first + UInt32(k), active);
+
+        Vector4f pc = c[0] * b[0] + c[1] * b[1] + c[2] * b[2] + c[3] * b[3],
+                 dc = c[0] * db[0] + c[1] * db[1] + c[2] * db[2] + c[3] * db[3];
+
+        Point3f center = head<3>(pc);
+        Float radius = pc.w();
+        Vector3f tangent = head<3>(dc),
+                 tn = normalize(tangent);
+
+        SurfaceInteraction3f si = zero<SurfaceInteraction3f>();
+        si.t = select(active, pi.t, math::Infinity<Float>);
+        si.p = ray(pi.t);
+
+        Vector3f rel = si.p - center;
+        Float v;
+        if (m_flat) {
+            // Ribbons face the incident ray
+            si.n = normalize(fmadd(tn, dot(ray.d, tn), -ray.d));
+            Vector3f side = cross(tn, si.n);
+            v = clamp(.5f + .5f * dot(rel, side) / radius, 0.f, 1.f);
+            si.dp_dv = side * (2.f * radius);
+        } else {
+            si.n = normalize(fnmadd(tn, dot(rel, tn), rel));
+
+            /* Mitigate roundoff error issues by moving the computed
+               intersection point onto the tube */
+            si.p = fmadd(si.n, radius, fmadd(tn, dot(rel, tn), center));
+
+            auto [s1, s2] = coordinate_system(tn);
+            Float phi = atan2(dot(si.n, s2), dot(si.n, s1));
+            masked(phi, phi < 0.f) += 2.f * math::Pi<Float>;
+            v = phi * math::InvTwoPi<Float>;
+            si.dp_dv = cross(tn, si.n) * (2.f * math::Pi<Float> * radius);
+        }
+
+        if (m_texcoords.size() > 0) {
+            Point2f uv = zero<Point2f>();
+            for (size_t k = 0; k < 4; ++k)
+                uv += Point2f(gather<Point<replace_scalar_t<Float, InputFloat>, 2>>(
+                          m_texcoords, first + UInt32(k), active)) * b[k];
+            si.uv = uv;
+        } else {
+            Point2f range(gather<Point<replace_scalar_t<Float, InputFloat>, 2>>(
+                m_segment_u, pi.prim_index, active));
+            si.uv = Point2f(lerp(range.x(), range.y(), t), v);
+        }
+
+        si.dp_du = tangent;
+        si.sh_frame.n = si.n;
+        si.time = ray.time;
+
+        if (has_flag(flags, HitComputeFlags::dNSdUV)) {
+            si.dn_du = zero<Vector3f>();
+            si.dn_dv = zero<Vector3f>();
+            if (!m_flat)
+                si.dn_dv = si.dp_dv / radius;
+        }
+
+        return si;
+    }
+
+    //! @}
+    // =============================================================
+
+    // =============================================================
+    //! @{ \name Miscellaneous query routines
+    // =============================================================
+
+    ScalarBoundingBox3f bbox() const override { return m_bbox; }
+
+    /// The curve lies in the convex hull of the control points of each segment
+    ScalarBoundingBox3f bbox(ScalarIndex index) const override {
+        ScalarIndex first = m_segments.data()[index];
+        ScalarBoundingBox3f result;
+        ScalarFloat radius = 0.f;
+        for (ScalarIndex k = 0; k < 4; ++k) {
+            ScalarVector4f c = control_point(first + k);
+            result.expand(ScalarPoint3f(head<3>(c)));
+            radius = std::max(radius, c.w());
+        }
+        result.min -= radius;
+        result.max += radius;
+        return result;
+    }
+
+    ScalarSize primitive_count() const override { return m_segment_count; }
+
+    ScalarSize effective_primitive_count() const override { return m_segment_count; }
+
+    //! @}
+    // =============================================================
+
+#if defined(MTS_ENABLE_EMBREE)
+    RTCGeometry embree_geometry(RTCDevice device) override {
+        if constexpr (!is_cuda_array_v<Float>) {
+            RTCGeometry geom = rtcNewGeometry(device, m_flat ? RTC_GEOMETRY_TYPE_FLAT_BSPLINE_CURVE
+                                                             : RTC_GEOMETRY_TYPE_ROUND_BSPLINE_CURVE);
+            rtcSetSharedGeometryBuffer(geom, RTC_BUFFER_TYPE_VERTEX, 0, RTC_FORMAT_FLOAT4,
+                                       m_vertices.data(), 0, 4 * sizeof(InputFloat),
+                                       m_vertex_count);
+            rtcSetSharedGeometryBuffer(geom, RTC_BUFFER_TYPE_INDEX, 0, RTC_FORMAT_UINT,
+                                       m_segments.data(), 0, sizeof(ScalarIndex),
+                                       m_segment_count);
+            rtcCommitGeometry(geom);
+            return geom;
+        } else {
+            Throw("embree_geometry() should only be called in CPU mode.");
+        }
+    }
+#endif
+
+    std::string to_string() const override {
+        std::ostringstream oss;
+        oss << "BSplineCurve[" << std::endl
+            << "  name = \"" << m_name << "\"," << std::endl
+            << "  flat = " << m_flat << "," << std::endl
+            << "  vertex_count = " << m_vertex_count << "," << std::endl
+            << "  segment_count = " << m_segment_count << "," << std::endl
+            << "  " << string::indent(get_children_string()) << std::endl
+            << "]";
+        return oss.str();
+    }
+
+    MTS_DECLARE_CLASS()
+private:
+    std::string m_name;
+    ScalarBoundingBox3f m_bbox;
+
+    /// World-space control points and radii (4 values per vertex)
+    FloatStorage m_vertices;
+    /// Index of the first control point of each segment
+    IndexStorage m_segments;
+    /// Range of the strand parameter covered by each segment
+    FloatStorage m_segment_u;
+    /// Optional per-vertex texture coordinates
+    FloatStorage m_texcoords;
+
+    ScalarSize m_vertex_count = 0;
+    ScalarSize m_segment_count = 0;
+
+    bool m_flat;
+};
+
+MTS_IMPLEMENT_CLASS_VARIANT(BSplineCurve, Shape)
+MTS_EXPORT_PLUGIN(BSplineCurve, "B-spline curves");
+NAMESPACE_END(mitsuba)
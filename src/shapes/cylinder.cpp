@@ -1,6 +1,7 @@
 #include <mitsuba/core/fwd.h>
 #include <mitsuba/core/math.h>
 #include <mitsuba/core/properties.h>
+#include <mitsuba/core/string.h>
 #include <mitsuba/core/transform.h>
 #include <mitsuba/core/util.h>
 #include <mitsuba/core/warp.h>
@@ -394,7 +395,11 @@ public:
         Base::traverse(callback);
     }
 
-    void parameters_changed(const std::vector<std::string> &/*keys*/) override {
+    void parameters_changed(const std::vector<std::string> &keys) override {
+        // Updates of the BSDF, emitter, etc. leave the geometry unchanged
+        if (!keys.empty() && !string::contains(keys, "to_world"))
+            return;
+
         update();
         Base::parameters_changed();
 #if defined(MTS_ENABLE_OPTIX)
@@ -228,7 +228,11 @@ public:
         Base::traverse(callback);
     }
 
-    void parameters_changed(const std::vector<std::string> &/*keys*/) override {
+    void parameters_changed(const std::vector<std::string> &keys) override {
+        // Updates of the BSDF, emitter, etc. leave the geometry unchanged
+        if (!keys.empty() && !string::contains(keys, "to_world"))
+            return;
+
         update();
         Base::parameters_changed();
 #if defined(MTS_ENABLE_OPTIX)
@@ -0,0 +1,683 @@
+#include <mitsuba/core/fwd.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/string.h>
+#include <mitsuba/core/util.h>
+#include <mitsuba/render/fwd.h>
+#include <mitsuba/render/interaction.h>
+#include <mitsuba/render/mesh.h>
+#include <mitsuba/render/shape.h>
+#include <mitsuba/render/texture.h>
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+
+.. _shape-displaced:
+
+Displaced mesh (:monosp:`displaced`)
+------------------------------------
+
+.. pluginparameters::
+
+ * - (Nested plugin)
+   - :paramtype:`shape`
+   - Triangle mesh (e.g. :ref:`ply <shape-ply>` or :ref:`obj <shape-obj>`) with vertex
+     normals and texture coordinates, which is displaced along its interpolated normals
+ * - displacement
+   - |texture| or |float|
+   - Scalar displacement texture, evaluated at the texture coordinates of the mesh
+ * - scale
+   - |float|
+   - Scale factor that is applied to the displacement texture. (Default: 1)
+ * - max_displacement
+   - |float|
+   - Bound on the absolute displacement, used to compute the bounds of the patches.
+     (Default: the absolute value of :paramtype:`scale`, which is correct for textures
+     with values between 0 and 1)
+ * - edge_length
+   - |float|
+   - Target edge length of the micro-triangles in world units. (Default: 1/1000 of the
+     diagonal of the bounding box of the mesh)
+ * - lod_spread
+   - |float|
+   - Angle (in radians) subtended by a ray, from which its footprint at a given distance is
+     estimated. Should match the angle of a pixel of the sensor, e.g. its field of view
+     divided by the film width. (Default: 0.001)
+ * - max_level
+   - |int|
+   - Maximum number of subdivisions of the edges of a triangle of the mesh (at most 10).
+     (Default: 8, i.e. up to 65536 micro-triangles per triangle)
+ * - cache_size
+   - |int|
+   - Memory budget of the micro-geometry cache in MiB. (Default: 256)
+
+This shape displaces the triangles of a nested mesh by a texture at render
+time, without storing the displaced micro-geometry of the entire mesh. Every
+triangle of the mesh (a *patch*) is a primitive of the acceleration data
+structure, whose bounds are expanded by :paramtype:`max_displacement`. When a
+ray reaches the bounds of a patch, the patch is tessellated into a regular
+grid of micro-triangles at a level that depends on the distance traveled by the
+ray: the edges of the micro-triangles are approximately as long as the
+footprint of the ray, but no shorter than :paramtype:`edge_length`. Distant
+patches hence only require coarse micro-geometry.
+
+Tessellated patches are kept in a thread-safe cache with a memory budget of
+:paramtype:`cache_size`, from which the least recently used patches are evicted
+(and re-tessellated when they are needed again). The memory footprint is
+therefore proportional to the visible part of the surface and its resolution
+rather than to the full-resolution displaced mesh. Within a patch, rays are
+traversed through a hierarchy of bounding boxes over the micro-triangles.
+
+The displaced surface is faceted: its shading normals are the normals of the
+micro-triangles. The BSDF of the nested mesh is ignored, the BSDF is instead
+specified on this shape. Area emitters and the GPU variants are not supported.
+
+.. code-block:: xml
+
+    <shape type="displaced">
+        <shape type="ply">
+            <string name="filename" value="terrain.ply"/>
+        </shape>
+        <texture type="bitmap" name="displacement">
+            <string name="filename" value="height.exr"/>
+            <boolean name="raw" value="true"/>
+        </texture>
+        <float name="scale" value="0.2"/>
+        <bsdf type="diffuse"/>
+    </shape>
+ */
+
+template <typename Float, typename Spectrum>
+class DisplacedMesh final : public Shape<Float, Spectrum> {
+public:
+    MTS_IMPORT_BASE(Shape, set_children, get_children_string, is_emitter)
+    MTS_IMPORT_TYPES(Mesh, Texture)
+
+    using typename Base::ScalarIndex;
+    using typename Base::ScalarSize;
+    using BoundingBox3f = BoundingBox<Point3f>;
+
+    /// Micro-geometry of a tessellated triangle of the mesh
+    struct Patch {
+        /// Number of segments per edge of the triangle
+        uint32_t n;
+        /// Displaced vertices of the barycentric grid (row by row)
+        std::unique_ptr<ScalarPoint3f[]> vertices;
+        /// Quadtree over the cells of the grid, one array per depth (the leaves come last)
+        std::vector<std::unique_ptr<ScalarBoundingBox3f[]>> nodes;
+        /// Size of the patch in bytes
+        size_t size;
+    };
+
+    DisplacedMesh(const Properties &props) : Base(props) {
+        if constexpr (is_cuda_array_v<Float>)
+            Throw("displaced: displaced meshes are not supported by the GPU variants yet!");
+
+        for (auto &[name, obj] : props.objects(false)) {
+            Mesh *mesh = dynamic_cast<Mesh *>(obj.get());
+            if (!mesh)
+                continue;
+            if (m_mesh)
+                Throw("displaced: only a single nested mesh can be specified!");
+            m_mesh = mesh;
+            props.mark_queried(name);
+        }
+
+        if (!m_mesh)
+            Throw("displaced: a nested mesh must be specified!");
+        if (!m_mesh->has_vertex_normals() || !m_mesh->has_vertex_texcoords())
+            Throw("displaced: the mesh \"%s\" must have vertex normals and texture "
+                  "coordinates!", m_mesh->id());
+        if (is_emitter())
+            Throw("displaced: area emitters are not supported!");
+
+        m_displacement = props.texture<Texture>("displacement");
+        m_scale = props.float_("scale", 1.f);
+        m_bound = props.float_("max_displacement", std::abs(m_scale));
+        m_edge_length = props.float_("edge_length", norm(m_mesh->bbox().extents()) * 1e-3f);
+        m_lod_spread = props.float_("lod_spread", 1e-3f);
+        m_max_level = (uint32_t) props.int_("max_level", 8);
+        m_cache_max = props.size_("cache_size", 256) * 1024 * 1024;
+
+        if (!(m_bound >= 0.f))
+            Throw("displaced: \"max_displacement\" must be nonnegative!");
+        if (!(m_edge_length > 0.f))
+            Throw("displaced: \"edge_length\" must be positive!");
+        if (m_max_level > 10)
+            Throw("displaced: \"max_level\" must be at most 10!");
+
+        m_bbox = m_mesh->bbox();
+        m_bbox.min -= m_bound;
+        m_bbox.max += m_bound;
+
+        m_cache_id = m_next_cache_id++;
+
+        set_children();
+    }
+
+    // =============================================================
+    //! @{ \name Tessellation
+    // =============================================================
+
+    /// Return the corners of triangle \c index of the mesh
+    MTS_INLINE auto corners(const UInt32 &index, Mask active = true) const {
+        auto fi = m_mesh->face_indices(index, active);
+        return std::make_tuple(Point3f(m_mesh->vertex_position(fi[0], active)),
+                               Point3f(m_mesh->vertex_position(fi[1], active)),
+                               Point3f(m_mesh->vertex_position(fi[2], active)));
+    }
+
+    /**
+     * \brief Return the subdivision level of triangle \c index for \c ray
+     *
+     * The level is chosen such that the edges of the micro-triangles are
+     * approximately as long as the footprint of the ray where it enters the
+     * bounds of the patch. It only depends on the origin and direction of the
+     * ray, hence intersection and shading agree on the level.
+     */
+    UInt32 level(const UInt32 &index, const Ray3f &ray, Mask active) const {
+        auto [p0, p1, p2] = corners(index, active);
+
+        BoundingBox3f bbox(min(min(p0, p1), p2) - m_bound, max(max(p0, p1), p2) + m_bound);
+        auto [hit, mint, maxt] = bbox.ray_intersect(ray);
+        ENOKI_MARK_USED(hit);
+        ENOKI_MARK_USED(maxt);
+
+        Float edge = sqrt(max(max(squared_norm(p1 - p0), squared_norm(p2 - p1)),
+                              squared_norm(p0 - p2))),
+              target = max(m_edge_length, m_lod_spread * max(mint, 0.f) * norm(ray.d));
+
+        Float l = clamp(ceil(log2(edge / target)), 0.f, (ScalarFloat) m_max_level);
+        return select(active, UInt32(l), 0u);
+    }
+
+    /// Return the displaced position at barycentric coordinates \c b of triangle \c index
+    Point3f displace(const UInt32 &index, const Point2f &b, Mask active) const {
+        auto fi = m_mesh->face_indices(index, active);
+        Float b0 = 1.f - b.x() - b.y();
+
+        Point3f p = Point3f(m_mesh->vertex_position(fi[0], active)) * b0 +
+                    Point3f(m_mesh->vertex_position(fi[1], active)) * b.x() +
+                    Point3f(m_mesh->vertex_position(fi[2], active)) * b.y();
+
+        Normal3f n = normalize(Normal3f(m_mesh->vertex_normal(fi[0], active)) * b0 +
+                               Normal3f(m_mesh->vertex_normal(fi[1], active)) * b.x() +
+                               Normal3f(m_mesh->vertex_normal(fi[2], active)) * b.y());
+
+        SurfaceInteraction3f si = zero<SurfaceInteraction3f>();
+        si.p = p;
+        si.n = n;
+        si.sh_frame = Frame3f(n);
+        si.uv = texcoord(fi, b, active);
+
+        Float h = m_displacement->eval_1(si, active);
+        return p + Vector3f(n) * (m_scale * h);
+    }
+
+    /// Interpolate the texture coordinates of the face \c fi
+    template <typename FaceIndices>
+    MTS_INLINE Point2f texcoord(const FaceIndices &fi, const Point2f &b, Mask active) const {
+        Float b0 = 1.f - b.x() - b.y();
+        return Point2f(m_mesh->vertex_texcoord(fi[0], active)) * b0 +
+               Point2f(m_mesh->vertex_texcoord(fi[1], active)) * b.x() +
+               Point2f(m_mesh->vertex_texcoord(fi[2], active)) * b.y();
+    }
+
+    /// Index of the vertex (i, j) of a barycentric grid with \c n segments per edge
+    static MTS_INLINE uint32_t vertex_index(uint32_t n, uint32_t i, uint32_t j) {
+        return j * (2 * n + 3 - j) / 2 + i;
+    }
+
+    /// Tessellate triangle \c index of the mesh with <tt>2^level</tt> segments per edge
+    std::shared_ptr<const Patch> tessellate(ScalarIndex index, uint32_t level) const {
+        std::shared_ptr<Patch> patch = std::make_shared<Patch>();
+        uint32_t n = 1u << level,
+                 vertex_count = (n + 1) * (n + 2) / 2;
+        patch->n = n;
+
+        // Barycentric coordinates of the grid vertices
+        std::unique_ptr<ScalarFloat[]> b1(new ScalarFloat[vertex_count]),
+                                       b2(new ScalarFloat[vertex_count]),
+                                       positions(new ScalarFloat[vertex_count * 3]);
+        for (uint32_t j = 0; j <= n; ++j) {
+            for (uint32_t i = 0; i + j <= n; ++i) {
+                uint32_t k = vertex_index(n, i, j);
+                b1[k] = ScalarFloat(i) / ScalarFloat(n);
+                b2[k] = ScalarFloat(j) / ScalarFloat(n);
+            }
+        }
+
+        /* Displace the vertices in packets. This uses the same code path as
+           compute_surface_interaction(), which recomputes the vertices of the
+           intersected micro-triangle. */
+        for (auto [k, active] : range<UInt32>(vertex_count)) {
+            Point2f b(gather<Float>(b1.get(), k, active), gather<Float>(b2.get(), k, active));
+            Point3f p = displace(UInt32(index), b, active);
+            for (size_t c = 0; c < 3; ++c)
+                scatter(positions.get(), p[c], k * 3u + (uint32_t) c, active);
+        }
+
+        patch->vertices.reset(new ScalarPoint3f[vertex_count]);
+        for (uint32_t k = 0; k < vertex_count; ++k)
+            patch->vertices[k] = ScalarPoint3f(positions[k * 3], positions[k * 3 + 1],
+                                               positions[k * 3 + 2]);
+
+        // Leaves of the quadtree: the (up to) two micro-triangles of every cell
+        patch->nodes.resize(level + 1);
+        std::unique_ptr<ScalarBoundingBox3f[]> &leaves = patch->nodes[level];
+        leaves.reset(new ScalarBoundingBox3f[n * n]);
+        for (uint32_t j = 0; j < n; ++j) {
+            for (uint32_t i = 0; i + j < n; ++i) {
+                ScalarBoundingBox3f &bbox = leaves[j * n + i];
+                bbox.expand(patch->vertices[vertex_index(n, i, j)]);
+                bbox.expand(patch->vertices[vertex_index(n, i + 1, j)]);
+                bbox.expand(patch->vertices[vertex_index(n, i, j + 1)]);
+                if (i + j + 1 < n)
+                    bbox.expand(patch->vertices[vertex_index(n, i + 1, j + 1)]);
+            }
+        }
+
+        // Inner nodes, bottom-up
+        size_t node_count = (size_t) n * n;
+        for (uint32_t depth = level; depth-- > 0; ) {
+            uint32_t size = 1u << depth;
+            const ScalarBoundingBox3f *children = patch->nodes[depth + 1].get();
+            std::unique_ptr<ScalarBoundingBox3f[]> &nodes = patch->nodes[depth];
+            nodes.reset(new ScalarBoundingBox3f[size * size]);
+            for (uint32_t y = 0; y < size; ++y) {
+                for (uint32_t x = 0; x < size; ++x) {
+                    ScalarBoundingBox3f &bbox = nodes[y * size + x];
+                    for (uint32_t k = 0; k < 4; ++k) {
+                        const ScalarBoundingBox3f &child =
+                            children[(2 * y + (k >> 1)) * (2 * size) + 2 * x + (k & 1)];
+                        if (child.valid())
+                            bbox.expand(child);
+                    }
+                }
+            }
+            node_count += (size_t) size * size;
+        }
+
+        patch->size = sizeof(Patch) + vertex_count * sizeof(ScalarPoint3f) +
+                      node_count * sizeof(ScalarBoundingBox3f);
+        return patch;
+    }
+
+    /// Look up (or create) the tessellation of a triangle in the micro-geometry cache
+    std::shared_ptr<const Patch> patch(ScalarIndex index, uint32_t level) const {
+        uint64_t key = ((uint64_t) index << 4) | level;
+
+        // Per-thread micro-cache, which avoids the lock for coherent rays
+        struct MicroCache {
+            uint64_t owner = (uint64_t) -1, key = 0;
+            std::shared_ptr<const Patch> patch;
+        };
+        static thread_local MicroCache micro;
+        if (micro.owner == m_cache_id && micro.key == key)
+            return micro.patch;
+
+        std::shared_ptr<const Patch> result;
+        {
+            std::lock_guard<std::mutex> guard(m_cache_mutex);
+            auto it = m_cache.find(key);
+            if (it != m_cache.end()) {
+                m_cache_lru.splice(m_cache_lru.begin(), m_cache_lru, it->second.lru);
+                result = it->second.patch;
+            }
+        }
+
+        if (!result) {
+            // Tessellate outside of the lock so that other threads aren't blocked
+            std::shared_ptr<const Patch> patch = tessellate(index, level);
+
+            std::lock_guard<std::mutex> guard(m_cache_mutex);
+            auto [it, inserted] = m_cache.try_emplace(key);
+            if (inserted) { // Otherwise, another thread created the same patch in the meantime
+                m_cache_lru.push_front(key);
+                it->second = { patch, m_cache_lru.begin() };
+                m_cache_usage += patch->size;
+                m_cache_builds++;
+
+                // Always keep the most recently used patch
+                while (m_cache_usage > m_cache_max && m_cache_lru.size() > 1) {
+                    auto it2 = m_cache.find(m_cache_lru.back());
+                    m_cache_usage -= it2->second.patch->size;
+                    m_cache.erase(it2);
+                    m_cache_lru.pop_back();
+                    m_cache_evictions++;
+                }
+            }
+            result = it->second.patch;
+        }
+
+        micro.owner = m_cache_id;
+        micro.key = key;
+        micro.patch = result;
+        return result;
+    }
+
+    //! @}
+    // =============================================================
+
+    // =============================================================
+    //! @{ \name Ray tracing routines
+    // =============================================================
+
+    /// Intersect a micro-triangle (Moeller-Trumbore), returns (hit, t, u, v)
+    static MTS_INLINE std::tuple<Mask, Float, Float, Float>
+    intersect_triangle(const Ray3f &ray, const ScalarPoint3f &p0, const ScalarPoint3f &p1,
+                       const ScalarPoint3f &p2, Mask active) {
+        ScalarVector3f e1 = p1 - p0, e2 = p2 - p0;
+
+        Vector3f pvec = cross(ray.d, e2);
+        Float inv_det = rcp(dot(e1, pvec));
+
+        Vector3f tvec = ray.o - p0;
+        Float u = dot(tvec, pvec) * inv_det;
+        active &= u >= 0.f && u <= 1.f;
+
+        Vector3f qvec = cross(tvec, e1);
+        Float v = dot(ray.d, qvec) * inv_det;
+        active &= v >= 0.f && u + v <= 1.f;
+
+        Float t = dot(e2, qvec) * inv_det;
+        active &= t >= ray.mint && t <= ray.maxt;
+
+        return { active, t, u, v };
+    }
+
+    /**
+     * \brief Intersect the micro-triangles of a patch
+     *
+     * The barycentric coordinates of the intersection with respect to the
+     * triangle of the mesh are stored in \c prim_uv. For shadow rays, only
+     * the validity of the result is meaningful.
+     */
+    template <bool ShadowRay>
+    PreliminaryIntersection3f intersect_patch(const Patch &patch, ScalarIndex index,
+                                              Ray3f ray, Mask active) const {
+        uint32_t n = patch.n,
+                 depth_count = (uint32_t) patch.nodes.size();
+        const ScalarPoint3f *v = patch.vertices.get();
+
+        PreliminaryIntersection3f pi = zero<PreliminaryIntersection3f>();
+        pi.t = math::Infinity<Float>;
+
+        struct Entry { uint32_t depth, x, y; };
+        Entry stack[4 * 11];
+        size_t stack_size = 0;
+        stack[stack_size++] = { 0, 0, 0 };
+
+        while (stack_size > 0) {
+            Entry e = stack[--stack_size];
+            const ScalarBoundingBox3f &bbox = patch.nodes[e.depth][e.y * (1u << e.depth) + e.x];
+            if (!bbox.valid())
+                continue;
+
+            auto [hit, mint, maxt] = bbox.ray_intersect(ray);
+            Mask visit = active && hit && maxt >= ray.mint && mint <= ray.maxt;
+            if (none(visit))
+                continue;
+
+            if (e.depth + 1 < depth_count) {
+                for (uint32_t k = 0; k < 4; ++k)
+                    stack[stack_size++] = { e.depth + 1, 2 * e.x + (k & 1), 2 * e.y + (k >> 1) };
+                continue;
+            }
+
+            // Leaf: lower and (if present) upper micro-triangle of the cell
+            uint32_t i = e.x, j = e.y;
+            for (uint32_t upper = 0; upper < 2; ++upper) {
+                if (upper && i + j + 1 >= n)
+                    break;
+
+                const ScalarPoint3f &p0 = v[upper ? vertex_index(n, i + 1, j) : vertex_index(n, i, j)],
+                                    &p1 = v[upper ? vertex_index(n, i + 1, j + 1) : vertex_index(n, i + 1, j)],
+                                    &p2 = v[vertex_index(n, i, j + 1)];
+
+                auto [tri_hit, t, tu, tv] = intersect_triangle(ray, p0, p1, p2, visit);
+                if (none(tri_hit))
+                    continue;
+
+                masked(pi.t, tri_hit) = t;
+                masked(ray.maxt, tri_hit) = t;
+
+                if constexpr (ShadowRay) {
+                    active &= !tri_hit;
+                    visit &= !tri_hit;
+                } else {
+                    ScalarFloat inv_n = 1.f / ScalarFloat(n);
+                    Point2f b = upper ? Point2f(ScalarFloat(i + 1) - tv, ScalarFloat(j) + tu + tv)
+                                      : Point2f(ScalarFloat(i) + tu, ScalarFloat(j) + tv);
+                    masked(pi.prim_uv, tri_hit) = b * inv_n;
+                }
+            }
+
+            if constexpr (ShadowRay) {
+                if (none(active))
+                    break;
+            }
+        }
+
+        pi.prim_index = index;
+        pi.shape = this;
+        return pi;
+    }
+
+    template <bool ShadowRay>
+    PreliminaryIntersection3f intersect_primitive(ScalarIndex index, const Ray3f &ray,
+                                                  Mask active) const {
+        PreliminaryIntersection3f pi = zero<PreliminaryIntersection3f>();
+        pi.t = math::Infinity<Float>;
+
+        // Lanes of a packet may require different subdivision levels
+        UInt32 levels = level(UInt32(index), ray, active);
+        Mask remaining = active;
+        while (any(remaining)) {
+            uint32_t l = hmin(select(remaining, levels, UInt32(m_max_level)));
+            Mask active_l = remaining && eq(levels, l);
+            remaining &= !active_l;
+
+            std::shared_ptr<const Patch> p = patch(index, l);
+            masked(pi, active_l) = intersect_patch<ShadowRay>(*p, index, ray, active_l);
+        }
+
+        return pi;
+    }
+
+    PreliminaryIntersection3f ray_intersect_primitive(ScalarIndex index, const Ray3f &ray,
+                                                      Mask active) const override {
+        MTS_MASK_ARGUMENT(active);
+        return intersect_primitive<false>(index, ray, active);
+    }
+
+    Mask ray_test_primitive(ScalarIndex index, const Ray3f &ray, Mask active) const override {
+        MTS_MASK_ARGUMENT(active);
+        return intersect_primitive<true>(index, ray, active).is_valid();
+    }
+
+    PreliminaryIntersection3f ray_intersect_preliminary(const Ray3f &ray_,
+                                                        Mask active) const override {
+        MTS_MASK_ARGUMENT(active);
+
+        // Brute force over the patches, the acceleration data structures intersect them individually
+        Ray3f ray(ray_);
+        PreliminaryIntersection3f pi = zero<PreliminaryIntersection3f>();
+        pi.t = math::Infinity<Float>;
+
+        for (ScalarIndex i = 0; i < m_mesh->face_count(); ++i) {
+            auto [hit, mint, maxt] = bbox(i).ray_intersect(ray);
+            Mask active_i = active && hit && maxt >= ray.mint && mint <= ray.maxt;
+            if (none(active_i))
+                continue;
+
+            PreliminaryIntersection3f pi_i = ray_intersect_primitive(i, ray, active_i);
+            Mask valid = pi_i.is_valid();
+            masked(pi, valid) = pi_i;
+            masked(ray.maxt, valid) = pi_i.t;
+        }
+
+        pi.shape = this;
+        return pi;
+    }
+
+    Mask ray_test(const Ray3f &ray, Mask active) const override {
+        MTS_MASK_ARGUMENT(active);
+
+        Mask hit = false;
+        for (ScalarIndex i = 0; i < m_mesh->face_count() && any(active && !hit); ++i)
+            hit |= ray_test_primitive(i, ray, active && !hit);
+        return hit;
+    }
+
+    SurfaceInteraction3f compute_surface_interaction(const Ray3f &ray,
+                                                     PreliminaryIntersection3f pi,
+                                                     HitComputeFlags flags,
+                                                     Mask active) const override {
+        MTS_MASK_ARGUMENT(active);
+
+        active &= pi.is_valid();
+
+        // Locate the intersected micro-triangle in the grid of the same level
+        UInt32 index = pi.prim_index;
+        Float n = Float(UInt32(1u) << level(index, ray, active)),
+              x = pi.prim_uv.x() * n,
+              y = pi.prim_uv.y() * n,
+              i = clamp(floor(x), 0.f, n - 1.f),
+              j = clamp(floor(y), 0.f, n - 1.f - i),
+              fx = x - i,
+              fy = y - j;
+        Mask upper = fx + fy > 1.f && i + j + 1.f < n;
+
+        Float up = select(upper, Float(1.f), Float(0.f));
+        Point2f g0(i + up, j), g1(i + 1.f, j + up), g2(i, j + 1.f);
+        Float u = select(upper, fx + fy - 1.f, fx),
+              v = select(upper, 1.f - fx, fy);
+
+        Point3f q0 = displace(index, g0 / n, active),
+                q1 = displace(index, g1 / n, active),
+                q2 = displace(index, g2 / n, active);
+        Vector3f dp0 = q1 - q0,
+                 dp1 = q2 - q0;
+
+        SurfaceInteraction3f si = zero<SurfaceInteraction3f>();
+        si.t = select(active, pi.t, math::Infinity<Float>);
+        si.p = q0 * (1.f - u - v) + q1 * u + q2 * v;
+        si.n = normalize(cross(dp0, dp1));
+
+        auto fi = m_mesh->face_indices(index, active);
+        si.uv = texcoord(fi, pi.prim_uv, active);
+        std::tie(si.dp_du, si.dp_dv) = coordinate_system(si.n);
+
+        if (likely(has_flag(flags, HitComputeFlags::dPdUV))) {
+            Point2f uv0 = texcoord(fi, g0 / n, active),
+                    uv1 = texcoord(fi, g1 / n, active),
+                    uv2 = texcoord(fi, g2 / n, active);
+            Vector2f duv0 = uv1 - uv0,
+                     duv1 = uv2 - uv0;
+
+            Float det     = fmsub(duv0.x(), duv1.y(), duv0.y() * duv1.x()),
+                  inv_det = rcp(det);
+
+            Mask valid = neq(det, 0.f);
+
+            si.dp_du[valid] = fmsub( duv1.y(), dp0, duv0.y() * dp1) * inv_det;
+            si.dp_dv[valid] = fnmadd(duv1.x(), dp0, duv0.x() * dp1) * inv_det;
+        }
+
+        // The micro-triangles are flat
+        si.sh_frame.n = si.n;
+        si.dn_du = si.dn_dv = zero<Vector3f>();
+        si.time = ray.time;
+
+        return si;
+    }
+
+    //! @}
+    // =============================================================
+
+    // =============================================================
+    //! @{ \name Miscellaneous query routines
+    // =============================================================
+
+    ScalarBoundingBox3f bbox() const override { return m_bbox; }
+
+    ScalarBoundingBox3f bbox(ScalarIndex index) const override {
+        ScalarBoundingBox3f bbox = m_mesh->bbox(index);
+        bbox.min -= m_bound;
+        bbox.max += m_bound;
+        return bbox;
+    }
+
+    ScalarFloat surface_area() const override { return m_mesh->surface_area(); }
+
+    ScalarSize primitive_count() const override { return m_mesh->face_count(); }
+
+    ScalarSize effective_primitive_count() const override { return m_mesh->face_count(); }
+
+    //! @}
+    // =============================================================
+
+    std::string to_string() const override {
+        size_t usage, patches, builds, evictions;
+        {
+            std::lock_guard<std::mutex> guard(m_cache_mutex);
+            usage = m_cache_usage;
+            patches = m_cache.size();
+            builds = m_cache_builds;
+            evictions = m_cache_evictions;
+        }
+
+        std::ostringstream oss;
+        oss << "DisplacedMesh[" << std::endl
+            << "  mesh = " << string::indent(m_mesh) << "," << std::endl
+            << "  displacement = " << string::indent(m_displacement) << "," << std::endl
+            << "  scale = " << m_scale << "," << std::endl
+            << "  max_displacement = " << m_bound << "," << std::endl
+            << "  edge_length = " << m_edge_length << "," << std::endl
+            << "  lod_spread = " << m_lod_spread << "," << std::endl
+            << "  max_level = " << m_max_level << "," << std::endl
+            << "  cache = [" << patches << " patches, " << util::mem_string(usage) << " of "
+            << util::mem_string(m_cache_max) << ", " << builds << " tessellations, "
+            << evictions << " evictions]," << std::endl
+            << "  " << string::indent(get_children_string()) << std::endl
+            << "]";
+        return oss.str();
+    }
+
+    MTS_DECLARE_CLASS()
+private:
+    struct CacheEntry {
+        std::shared_ptr<const Patch> patch;
+        std::list<uint64_t>::iterator lru;
+    };
+
+    ref<Mesh> m_mesh;
+    ref<Texture> m_displacement;
+    ScalarBoundingBox3f m_bbox;
+    ScalarFloat m_scale;
+    ScalarFloat m_bound;
+    ScalarFloat m_edge_length;
+    ScalarFloat m_lod_spread;
+    uint32_t m_max_level;
+
+    // Micro-geometry cache, the least recently used patches are at the back
+    mutable std::mutex m_cache_mutex;
+    mutable std::unordered_map<uint64_t, CacheEntry> m_cache;
+    mutable std::list<uint64_t> m_cache_lru;
+    mutable size_t m_cache_usage = 0;
+    mutable size_t m_cache_builds = 0, m_cache_evictions = 0;
+    size_t m_cache_max;
+
+    /// Identifies the cache of this shape in the per-thread micro-caches
+    uint64_t m_cache_id;
+    static inline std::atomic<uint64_t> m_next_cache_id { 0 };
+};
+
+MTS_IMPLEMENT_CLASS_VARIANT(DisplacedMesh, Shape)
+MTS_EXPORT_PLUGIN(DisplacedMesh, "Displaced mesh");
+NAMESPACE_END(mitsuba)
@@ -1,5 +1,7 @@
 #include <mitsuba/core/fwd.h>
+#include <mitsuba/core/memreport.h>
 #include <mitsuba/core/properties.h>
+#include <mitsuba/core/string.h>
 #include <mitsuba/render/fwd.h>
 #include <mitsuba/render/shape.h>
 #include <mitsuba/core/transform.h>
@@ -85,10 +87,7 @@ public:
         if (!bbox.valid())
             return bbox;
 
-        ScalarBoundingBox3f result;
-        for (int i = 0; i < 8; ++i)
-            result.expand(m_to_world * bbox.corner(i));
-        return result;
+        return m_shapegroup->transformed_bbox(m_to_world);
     }
 
     ScalarSize primitive_count() const override { return 1; }
@@ -97,6 +96,8 @@ public:
         return m_shapegroup->primitive_count();
     }
 
+    ShapeGroup *instanced_group() override { return m_shapegroup.get(); }
+
     //! @}
     // =============================================================
 
@@ -135,7 +136,7 @@ public:
 
         if (likely(has_flag(flags, HitComputeFlags::ShadingFrame))) {
             si.sh_frame.n = normalize(m_to_world.transform_affine(si.sh_frame.n));
-            si.initialize_sh_frame();
+            si.initialize_sh_frame(has_flag(flags, HitComputeFlags::dPdUV));
         }
 
         if (likely(has_flag(flags, HitComputeFlags::dPdUV))) {
@@ -177,7 +178,24 @@ public:
         return oss.str();
     }
 
+    void account_memory(MemoryReport *report) const override {
+        report->visit(m_shapegroup.get());
+        Base::account_memory(report);
+    }
+
+    void parameters_changed(const std::vector<std::string> &keys = {}) override {
+        if (keys.empty() || string::contains(keys, "to_world")) {
+            m_to_object = m_to_world.inverse();
+            Base::parameters_changed(keys);
+        }
+    }
+
 #if defined(MTS_ENABLE_EMBREE)
+    void embree_update_geometry(RTCGeometry geom) override {
+        rtcSetGeometryTransform(geom, 0, RTC_FORMAT_FLOAT4X4_COLUMN_MAJOR, &m_to_world.matrix);
+        rtcCommitGeometry(geom);
+    }
+
     RTCGeometry embree_geometry(RTCDevice device) override {
         if constexpr (!is_cuda_array_v<Float>) {
             RTCGeometry instance = m_shapegroup->embree_geometry(device);
@@ -0,0 +1,595 @@
+#include <mitsuba/core/filesystem.h>
+#include <mitsuba/core/fwd.h>
+#include <mitsuba/core/memreport.h>
+#include <mitsuba/core/plugin.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/string.h>
+#include <mitsuba/core/timer.h>
+#include <mitsuba/core/transform.h>
+#include <mitsuba/core/util.h>
+#include <mitsuba/render/fwd.h>
+#include <mitsuba/render/interaction.h>
+#include <mitsuba/render/mesh.h>
+#include <mitsuba/render/shape.h>
+#include <mitsuba/render/shapegroup.h>
+#include <mitsuba/render/srgb.h>
+
+#if defined(MTS_ENABLE_EMBREE)
+    #include <embree3/rtcore.h>
+#endif
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+
+.. _shape-instancer:
+
+Instancer (:monosp:`instancer`)
+-------------------------------
+
+.. pluginparameters::
+
+ * - (Nested plugin)
+   - :paramtype:`shapegroup`
+   - A reference to a shape group that should be instantiated.
+ * - filename
+   - |string|
+   - Filename of a PLY file whose vertices specify the transformations of the instances
+ * - to_world
+   - |transform|
+   - Specifies an optional linear object-to-world transformation that is applied on top of the
+     transformations of the individual instances. (Default: none, i.e. object space = world space)
+
+This plugin replicates a :ref:`shape group <shape-shapegroup>` many times, e.g. to scatter
+thousands of trees or rocks over a terrain. It is equivalent to a list of
+:ref:`instance <shape-instance>` shapes, but the instances are loaded from a single file and
+only occupy the storage of their transformations (96 bytes each) instead of a full shape object
+with its own properties per instance.
+
+Every vertex of the PLY file describes one instance, whose faces (if any) are ignored. The
+vertex fields ``x``, ``y`` and ``z`` specify the translation of the instance. Its linear part
+(rotation, scale and shear) is given by the images of the local coordinate axes in the fields
+``xaxis_x``, ``xaxis_y``, ``xaxis_z``, ``yaxis_x``, ``yaxis_y``, ``yaxis_z``, ``zaxis_x``,
+``zaxis_y`` and ``zaxis_z``, i.e. the columns of its matrix. Missing axes default to the
+identity. Two optional per-instance attributes can be provided as well:
+
+- ``r``, ``g``, ``b``: a color, exposed as the ``instance_color`` attribute.
+- ``id``: an integer identifier (exact up to :math:`2^{24}`), exposed as the ``instance_id``
+  attribute.
+
+These attributes can be evaluated with the :ref:`mesh_attribute <texture-meshattribute>`
+texture by the materials within the shape group, e.g. to vary the color of every instance:
+
+.. code-block:: xml
+
+    <shape type="shapegroup" id="tree">
+        <shape type="ply">
+            <string name="filename" value="tree.ply"/>
+            <bsdf type="diffuse">
+                <texture type="mesh_attribute" name="reflectance">
+                    <string name="name" value="instance_color"/>
+                </texture>
+            </bsdf>
+        </shape>
+    </shape>
+
+    <shape type="instancer">
+        <ref id="tree"/>
+        <string name="filename" value="forest.ply"/>
+    </shape>
+
+The native CPU acceleration data structures store the instances of the plugin as individual
+primitives, which reference the transformations in the shared buffers. With Embree, the
+instances are the primitives of a single user geometry that traces into the (shared) Embree
+scene of the shape group, and in the GPU variants, one batch of OptiX instances is directly
+created from the transformation buffer. No per-instance shape objects are created in either
+case, and the per-instance attributes are available with all acceleration data structures.
+
+.. warning::
+
+    The restrictions of the :ref:`instance <shape-instance>` plugin apply: all instances share
+    the materials of the shape group, which cannot contain emitters, sensors, or subsurface
+    scattering models.
+ */
+
+template <typename Float, typename Spectrum>
+class Instancer final : public Shape<Float, Spectrum> {
+public:
+    MTS_IMPORT_BASE(Shape, m_id)
+    MTS_IMPORT_TYPES(Mesh, ShapeGroup)
+
+    using typename Base::ScalarIndex;
+    using typename Base::ScalarSize;
+
+    using InputFloat   = float;
+    using FloatStorage = DynamicBuffer<replace_scalar_t<Float, InputFloat>>;
+
+    Instancer(const Properties &props) {
+        m_id = props.id();
+
+        for (auto &kv : props.objects()) {
+            Base *shape = dynamic_cast<Base *>(kv.second.get());
+            if (shape && shape->is_shapegroup()) {
+                if (m_shapegroup)
+                    Throw("Only a single shapegroup can be specified per instancer.");
+                m_shapegroup = (ShapeGroup *) shape;
+            } else {
+                Throw("Only a shapegroup can be specified in an instancer.");
+            }
+        }
+
+        if (!m_shapegroup)
+            Throw("A reference to a 'shapegroup' must be specified!");
+
+        Timer timer;
+
+        // Reuse the parallel PLY loader, only the vertices are needed
+        Properties props_ply("ply");
+        props_ply.set_string("filename", props.string("filename"));
+        props_ply.set_bool("face_normals", true);
+        ref<Mesh> mesh = PluginManager::instance()->create_object<Mesh>(props_ply);
+        m_name = fs::path(props.string("filename")).filename().string();
+
+        m_instance_count = mesh->vertex_count();
+        if (m_instance_count == 0)
+            Throw("instancer: \"%s\" does not contain any instances!", m_name);
+
+        FloatStorage axes[3];
+        const char *axis_names[3] = { "vertex_xaxis", "vertex_yaxis", "vertex_zaxis" };
+        for (size_t k = 0; k < 3; ++k) {
+            if (mesh->has_attribute(axis_names[k]))
+                axes[k] = mesh->attribute_values(axis_names[k]);
+        }
+        const InputFloat *positions = mesh->vertex_positions_buffer().data();
+
+        ScalarTransform4f to_world = props.transform("to_world", ScalarTransform4f());
+        std::unique_ptr<InputFloat[]> to_world_buf(new InputFloat[m_instance_count * 12]),
+                                      to_object_buf(new InputFloat[m_instance_count * 12]);
+
+        for (ScalarSize i = 0; i < m_instance_count; ++i) {
+            ScalarMatrix4f m = identity<ScalarMatrix4f>();
+            for (size_t k = 0; k < 3; ++k) {
+                m(k, 3) = positions[i * 3 + k];
+                if (axes[k].size() > 0)
+                    for (size_t j = 0; j < 3; ++j)
+                        m(j, k) = axes[k].data()[i * 3 + j];
+            }
+
+            if (!(abs(det(m)) > 0.f))
+                Throw("instancer: instance %i of \"%s\" has a singular transformation!",
+                      i, m_name);
+
+            ScalarTransform4f trafo = to_world * ScalarTransform4f(m),
+                              inv   = trafo.inverse();
+            for (size_t k = 0; k < 3; ++k) {
+                for (size_t j = 0; j < 4; ++j) {
+                    to_world_buf[i * 12 + k * 4 + j]  = (InputFloat) trafo.matrix(k, j);
+                    to_object_buf[i * 12 + k * 4 + j] = (InputFloat) inv.matrix(k, j);
+                }
+            }
+
+            if (m_shapegroup->bbox().valid())
+                m_bbox.expand(m_shapegroup->transformed_bbox(trafo));
+        }
+
+#if defined(MTS_ENABLE_EMBREE)
+        if constexpr (!is_cuda_array_v<Float>) {
+            // See embree_trace() for the encoding of the hits of the instances
+            if ((uint64_t) m_instance_count * m_shapegroup->shape_count() > 0xFFFFFFFFull)
+                Throw("instancer: \"%s\" has too many instances of a group with %i shapes!",
+                      m_name, m_shapegroup->shape_count());
+        }
+#endif
+
+        m_to_world_buf  = FloatStorage::copy(to_world_buf.get(), m_instance_count * 12);
+        m_to_object_buf = FloatStorage::copy(to_object_buf.get(), m_instance_count * 12);
+
+        if (mesh->has_attribute("vertex_color")) {
+            FloatStorage colors = mesh->attribute_values("vertex_color");
+            size_t dim = colors.size() / m_instance_count;
+            std::unique_ptr<InputFloat[]> buf(new InputFloat[m_instance_count * 3]);
+            for (ScalarSize i = 0; i < m_instance_count; ++i)
+                for (size_t k = 0; k < 3; ++k)
+                    buf[i * 3 + k] = colors.data()[i * dim + k];
+            m_colors = FloatStorage::copy(buf.get(), m_instance_count * 3);
+        }
+
+        if (mesh->has_attribute("vertex_id"))
+            m_ids = mesh->attribute_values("vertex_id");
+
+        Log(Debug, "\"%s\": loaded %i instances (%s in %s)", m_name, m_instance_count,
+            util::mem_string(m_instance_count * 24 * sizeof(InputFloat)),
+            util::time_string(timer.value()));
+    }
+
+    /**
+     * \brief Return the transformation of the instance with index \c index
+     *
+     * When \c inverse is set, the world-to-object transformation is returned.
+     */
+    template <typename Index>
+    MTS_INLINE auto instance_transform(Index index, bool inverse,
+                                       mask_t<Index> active = true) const {
+        using Value  = replace_scalar_t<Index, ScalarFloat>;
+        using Row    = Vector<replace_scalar_t<Index, InputFloat>, 4>;
+        using Result = Transform<Point<Value, 4>>;
+        using Matrix = typename Result::Matrix;
+
+        const FloatStorage &fwd = inverse ? m_to_object_buf : m_to_world_buf,
+                           &bwd = inverse ? m_to_world_buf : m_to_object_buf;
+
+        auto gather_matrix = [&](const FloatStorage &buf) {
+            Matrix m = identity<Matrix>();
+            for (uint32_t k = 0; k < 3; ++k) {
+                Vector<Value, 4> row(gather<Row>(buf, index * 3u + k, active));
+                for (size_t j = 0; j < 4; ++j)
+                    m(k, j) = row[j];
+            }
+            return m;
+        };
+
+        return Result(gather_matrix(fwd), transpose(gather_matrix(bwd)));
+    }
+
+    // =============================================================
+    //! @{ \name Ray tracing routines
+    // =============================================================
+
+    PreliminaryIntersection3f ray_intersect_primitive(ScalarIndex index, const Ray3f &ray,
+                                                      Mask active) const override {
+        MTS_MASK_ARGUMENT(active);
+
+        PreliminaryIntersection3f pi = m_shapegroup->ray_intersect_preliminary(
+            instance_transform(index, true).transform_affine(ray), active);
+        pi.instance = this;
+        pi.shape_index = index;
+        return pi;
+    }
+
+    Mask ray_test_primitive(ScalarIndex index, const Ray3f &ray, Mask active) const override {
+        MTS_MASK_ARGUMENT(active);
+        return m_shapegroup->ray_test(
+            instance_transform(index, true).transform_affine(ray), active);
+    }
+
+    PreliminaryIntersection3f ray_intersect_preliminary(const Ray3f &ray_,
+                                                        Mask active) const override {
+        MTS_MASK_ARGUMENT(active);
+
+        // Brute force, the acceleration data structures intersect the instances individually
+        Ray3f ray(ray_);
+        PreliminaryIntersection3f pi = zero<PreliminaryIntersection3f>();
+        pi.t = math::Infinity<Float>;
+
+        for (ScalarIndex i = 0; i < m_instance_count; ++i) {
+            PreliminaryIntersection3f pi_i = ray_intersect_primitive(i, ray, active);
+            Mask hit = pi_i.is_valid() && pi_i.t < pi.t;
+            masked(pi, hit) = pi_i;
+            masked(ray.maxt, hit) = pi_i.t;
+        }
+
+        return pi;
+    }
+
+    Mask ray_test(const Ray3f &ray, Mask active) const override {
+        MTS_MASK_ARGUMENT(active);
+
+        Mask hit = false;
+        for (ScalarIndex i = 0; i < m_instance_count && any(active && !hit); ++i)
+            hit |= ray_test_primitive(i, ray, active && !hit);
+        return hit;
+    }
+
+    SurfaceInteraction3f compute_surface_interaction(const Ray3f &ray,
+                                                     PreliminaryIntersection3f pi,
+                                                     HitComputeFlags flags,
+                                                     Mask active) const override {
+        MTS_MASK_ARGUMENT(active);
+
+        UInt32 index = pi.shape_index;
+#if defined(MTS_ENABLE_EMBREE)
+        if constexpr (!is_cuda_array_v<Float>) {
+            // Embree folds the index of the instance into the geometry ID, see embree_trace()
+            uint32_t count = (uint32_t) m_shapegroup->shape_count();
+            index = pi.shape_index / count;
+            pi.shape_index -= index * count;
+        }
+#endif
+
+        Transform4f to_world  = instance_transform(index, false, active),
+                    to_object = instance_transform(index, true, active);
+
+        SurfaceInteraction3f si = m_shapegroup->compute_surface_interaction(
+            to_object.transform_affine(ray), pi, flags, active);
+
+        si.p = to_world.transform_affine(si.p);
+        si.n = normalize(to_world.transform_affine(si.n));
+
+        if (likely(has_flag(flags, HitComputeFlags::ShadingFrame))) {
+            si.sh_frame.n = normalize(to_world.transform_affine(si.sh_frame.n));
+            si.initialize_sh_frame(has_flag(flags, HitComputeFlags::dPdUV));
+        }
+
+        if (likely(has_flag(flags, HitComputeFlags::dPdUV))) {
+            si.dp_du = to_world.transform_affine(si.dp_du);
+            si.dp_dv = to_world.transform_affine(si.dp_dv);
+        }
+
+        if (has_flag(flags, HitComputeFlags::dNGdUV) || has_flag(flags, HitComputeFlags::dNSdUV)) {
+            Normal3f n = has_flag(flags, HitComputeFlags::dNGdUV) ? si.n : si.sh_frame.n;
+
+            // Determine the length of the transformed normal before it was re-normalized
+            Normal3f tn = to_world.transform_affine(
+                normalize(to_object.transform_affine(n)));
+            Float inv_len = rcp(norm(tn));
+            tn *= inv_len;
+
+            // Apply transform to dn_du and dn_dv
+            si.dn_du = to_world.transform_affine(Normal3f(si.dn_du)) * inv_len;
+            si.dn_dv = to_world.transform_affine(Normal3f(si.dn_dv)) * inv_len;
+
+            si.dn_du -= tn * dot(tn, si.dn_du);
+            si.dn_dv -= tn * dot(tn, si.dn_dv);
+        }
+
+        si.instance = this;
+        si.instance_index = index;
+
+        return si;
+    }
+
+    //! @}
+    // =============================================================
+
+    // =============================================================
+    //! @{ \name Per-instance attributes
+    // =============================================================
+
+    UnpolarizedSpectrum eval_attribute(const std::string &name,
+                                       const SurfaceInteraction3f &si,
+                                       Mask active) const override {
+        if (name == "instance_id")
+            return eval_attribute_1(name, si, active);
+
+        Color3f color = eval_attribute_3(name, si, active);
+        if constexpr (is_monochromatic_v<Spectrum>)
+            return luminance(color);
+        else if constexpr (is_spectral_v<Spectrum>)
+            // The PLY loader stores the spectral upsampling coefficients of colors
+            return srgb_model_eval<UnpolarizedSpectrum>(color, si.wavelengths);
+        else
+            return color;
+    }
+
+    Float eval_attribute_1(const std::string &name, const SurfaceInteraction3f &si,
+                           Mask active) const override {
+        if (name != "instance_id" || m_ids.size() == 0)
+            Throw("Invalid attribute requested %s.", name.c_str());
+        return Float(gather<replace_scalar_t<Float, InputFloat>>(m_ids, si.instance_index, active));
+    }
+
+    Color3f eval_attribute_3(const std::string &name, const SurfaceInteraction3f &si,
+                             Mask active) const override {
+        if (name != "instance_color" || m_colors.size() == 0)
+            Throw("Invalid attribute requested %s.", name.c_str());
+        return Color3f(gather<replace_scalar_t<Color3f, InputFloat>>(
+            m_colors, si.instance_index, active));
+    }
+
+    //! @}
+    // =============================================================
+
+    // =============================================================
+    //! @{ \name Miscellaneous query routines
+    // =============================================================
+
+    ScalarBoundingBox3f bbox() const override { return m_bbox; }
+
+    ScalarBoundingBox3f bbox(ScalarIndex index) const override {
+        return m_shapegroup->transformed_bbox(instance_transform(index, false));
+    }
+
+    ScalarSize primitive_count() const override { return m_instance_count; }
+
+    ScalarSize effective_primitive_count() const override {
+        return m_instance_count * m_shapegroup->primitive_count();
+    }
+
+    ShapeGroup *instanced_group() override { return m_shapegroup.get(); }
+
+    //! @}
+    // =============================================================
+
+#if defined(MTS_ENABLE_EMBREE)
+    /**
+     * The instances are the primitives of a user geometry, whose callbacks
+     * trace the transformed rays through the Embree scene of the group. Only
+     * a single level of instance IDs is available: the hit reports the
+     * instancer as the instance and \c primitive_index * \c shape_count +
+     * \c shape_index as the geometry ID.
+     */
+    RTCGeometry embree_geometry(RTCDevice device) override {
+        if constexpr (!is_cuda_array_v<Float>) {
+            m_embree_group = m_shapegroup->embree_scene(device);
+
+            RTCGeometry geom = rtcNewGeometry(device, RTC_GEOMETRY_TYPE_USER);
+            rtcSetGeometryUserPrimitiveCount(geom, (unsigned int) m_instance_count);
+            rtcSetGeometryUserData(geom, (void *) this);
+            rtcSetGeometryBoundsFunction(geom, embree_bbox, nullptr);
+            rtcSetGeometryIntersectFunction(geom, embree_intersect);
+            rtcSetGeometryOccludedFunction(geom, embree_occluded);
+            rtcCommitGeometry(geom);
+            return geom;
+        } else {
+            Throw("embree_geometry() should only be called in CPU mode.");
+        }
+    }
+
+    static void embree_bbox(const RTCBoundsFunctionArguments *args) {
+        const Instancer *instancer = (const Instancer *) args->geometryUserPtr;
+        ScalarBoundingBox3f bbox = instancer->bbox(args->primID);
+        RTCBounds *bounds_o = args->bounds_o;
+        bounds_o->lower_x = bbox.min.x();
+        bounds_o->lower_y = bbox.min.y();
+        bounds_o->lower_z = bbox.min.z();
+        bounds_o->upper_x = bbox.max.x();
+        bounds_o->upper_y = bbox.max.y();
+        bounds_o->upper_z = bbox.max.z();
+    }
+
+    template <bool ShadowRay>
+    static void embree_trace(const Instancer *instancer, RTCIntersectContext *context,
+                             const int *valid, unsigned int n, unsigned int geom_id,
+                             unsigned int prim_id, RTCRayN *rays, RTCHitN *hits) {
+        auto to_object = instancer->instance_transform(prim_id, true);
+        uint32_t shape_count = (uint32_t) instancer->m_shapegroup->shape_count();
+
+        for (unsigned int i = 0; i < n; ++i) {
+            if (!valid[i])
+                continue;
+
+            ScalarPoint3f o = to_object.transform_affine(ScalarPoint3f(
+                RTCRayN_org_x(rays, n, i), RTCRayN_org_y(rays, n, i), RTCRayN_org_z(rays, n, i)));
+            ScalarVector3f d = to_object.transform_affine(ScalarVector3f(
+                RTCRayN_dir_x(rays, n, i), RTCRayN_dir_y(rays, n, i), RTCRayN_dir_z(rays, n, i)));
+
+            RTCRayHit rh;
+            rh.ray.org_x = o.x();
+            rh.ray.org_y = o.y();
+            rh.ray.org_z = o.z();
+            rh.ray.tnear = RTCRayN_tnear(rays, n, i);
+            rh.ray.dir_x = d.x();
+            rh.ray.dir_y = d.y();
+            rh.ray.dir_z = d.z();
+            rh.ray.time  = RTCRayN_time(rays, n, i);
+            rh.ray.tfar  = RTCRayN_tfar(rays, n, i);
+            rh.ray.mask  = RTCRayN_mask(rays, n, i);
+            rh.ray.id    = 0;
+            rh.ray.flags = 0;
+            rh.hit.geomID = RTC_INVALID_GEOMETRY_ID;
+
+            // The hits within the group are reported on behalf of the instancer
+            unsigned int inst_id = context->instID[0];
+            context->instID[0] = geom_id;
+
+            if constexpr (ShadowRay) {
+                rtcOccluded1(instancer->m_embree_group, context, &rh.ray);
+                if (rh.ray.tfar < 0.f)
+                    RTCRayN_tfar(rays, n, i) = -math::Infinity<float>;
+            } else {
+                rtcIntersect1(instancer->m_embree_group, context, &rh);
+                if (rh.hit.geomID != RTC_INVALID_GEOMETRY_ID) {
+                    RTCRayN_tfar(rays, n, i)       = rh.ray.tfar;
+                    RTCHitN_Ng_x(hits, n, i)       = rh.hit.Ng_x;
+                    RTCHitN_Ng_y(hits, n, i)       = rh.hit.Ng_y;
+                    RTCHitN_Ng_z(hits, n, i)       = rh.hit.Ng_z;
+                    RTCHitN_u(hits, n, i)          = rh.hit.u;
+                    RTCHitN_v(hits, n, i)          = rh.hit.v;
+                    RTCHitN_primID(hits, n, i)     = rh.hit.primID;
+                    RTCHitN_geomID(hits, n, i)     = prim_id * shape_count + rh.hit.geomID;
+                    RTCHitN_instID(hits, n, i, 0)  = geom_id;
+                }
+            }
+
+            context->instID[0] = inst_id;
+        }
+    }
+
+    static void embree_intersect(const RTCIntersectFunctionNArguments *args) {
+        embree_trace<false>((const Instancer *) args->geometryUserPtr, args->context,
+                            args->valid, args->N, args->geomID, args->primID,
+                            RTCRayHitN_RayN(args->rayhit, args->N),
+                            RTCRayHitN_HitN(args->rayhit, args->N));
+    }
+
+    static void embree_occluded(const RTCOccludedFunctionNArguments *args) {
+        embree_trace<true>((const Instancer *) args->geometryUserPtr, args->context,
+                           args->valid, args->N, args->geomID, args->primID,
+                           args->ray, nullptr);
+    }
+#endif
+
+#if defined(MTS_ENABLE_OPTIX)
+    /**
+     * The instances are emitted as one batch of \c OptixInstance records of
+     * the group, which are directly created from the transformation buffer
+     */
+    void optix_prepare_ias(const OptixDeviceContext &context,
+                           std::vector<OptixInstance> &instances,
+                           uint32_t instance_id,
+                           const ScalarTransform4f &transf) override {
+        m_to_world_buf.managed();
+        m_to_object_buf.managed();
+        if constexpr (is_cuda_array_v<Float>)
+            cuda_sync();
+
+        const InputFloat *to_world  = m_to_world_buf.data(),
+                         *to_object = m_to_object_buf.data();
+
+        instances.reserve(instances.size() + m_instance_count * 2);
+        for (ScalarSize i = 0; i < m_instance_count; ++i) {
+            ScalarMatrix4f m = identity<ScalarMatrix4f>(), mi = identity<ScalarMatrix4f>();
+            for (size_t k = 0; k < 3; ++k) {
+                for (size_t j = 0; j < 4; ++j) {
+                    m(k, j)  = to_world[i * 12 + k * 4 + j];
+                    mi(k, j) = to_object[i * 12 + k * 4 + j];
+                }
+            }
+            m_shapegroup->optix_prepare_ias(context, instances, instance_id,
+                                            transf * ScalarTransform4f(m, transpose(mi)));
+        }
+    }
+
+    void optix_fill_hitgroup_records(std::vector<HitGroupSbtRecord> &,
+                                     const OptixProgramGroup *) override {
+        /* no op */
+    }
+#endif
+
+    void account_memory(MemoryReport *report) const override {
+        report->add_array(MemoryCategory::Geometry, m_to_world_buf);
+        report->add_array(MemoryCategory::Geometry, m_to_object_buf);
+        report->add_array(MemoryCategory::Geometry, m_colors);
+        report->add_array(MemoryCategory::Geometry, m_ids);
+        report->visit(m_shapegroup.get());
+        Base::account_memory(report);
+    }
+
+    std::string to_string() const override {
+        std::ostringstream oss;
+        oss << "Instancer[" << std::endl
+            << "  name = \"" << m_name << "\"," << std::endl
+            << "  instance_count = " << m_instance_count << "," << std::endl
+            << "  instances = [" << util::mem_string(m_instance_count * 24 * sizeof(InputFloat))
+            << " of transformations]," << std::endl
+            << "  colors = " << (m_colors.size() > 0) << "," << std::endl
+            << "  ids = " << (m_ids.size() > 0) << "," << std::endl
+            << "  shapegroup = " << string::indent(m_shapegroup) << std::endl
+            << "]";
+        return oss.str();
+    }
+
+    MTS_DECLARE_CLASS()
+private:
+    std::string m_name;
+    ref<ShapeGroup> m_shapegroup;
+    ScalarBoundingBox3f m_bbox;
+    ScalarSize m_instance_count = 0;
+
+    /// Object-to-world and world-to-object transformations (3x4 row-major, 12 values per instance)
+    FloatStorage m_to_world_buf;
+    FloatStorage m_to_object_buf;
+
+    /// Optional per-instance colors (3 values per instance) and identifiers
+    FloatStorage m_colors;
+    FloatStorage m_ids;
+
+#if defined(MTS_ENABLE_EMBREE)
+    /// Embree scene of the group, shared by all instances
+    RTCScene m_embree_group = nullptr;
+#endif
+};
+
+MTS_IMPLEMENT_CLASS_VARIANT(Instancer, Shape)
+MTS_EXPORT_PLUGIN(Instancer, "Instancer")
+NAMESPACE_END(mitsuba)
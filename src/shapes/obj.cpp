@@ -1,9 +1,18 @@
 #include <mitsuba/render/mesh.h>
 #include <mitsuba/core/fresolver.h>
+#include <mitsuba/core/profiler.h>
 #include <mitsuba/core/properties.h>
 #include <mitsuba/core/mmap.h>
 #include <mitsuba/core/util.h>
 #include <mitsuba/core/timer.h>
+#include <mitsuba/core/hash.h>
+#include <tbb/parallel_for.h>
+#include <algorithm>
+#include <atomic>
+#include <unordered_map>
+
+/// Approximate size of the chunks that are parsed in parallel
+#define MTS_OBJ_CHUNK_SIZE (1024 * 1024)
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -27,10 +36,39 @@ Wavefront OBJ mesh loader (:monosp:`obj`)
  * - flip_tex_coords
    - |bool|
    - Treat the vertical component of the texture as inverted? Most OBJ files use this convention. (Default: |true|)
+ * - compress
+   - |bool|
+   - Store the mesh in a compact quantized representation (21 bit positions
+     relative to the bounding box, octahedral normals and half precision
+     texture coordinates). This roughly halves the memory usage of large meshes
+     at a small cost in precision. Only supported by the native CPU ray
+     tracing backend. (Default: |false|)
+ * - alias_sampling
+   - |bool|
+   - Sample faces (e.g. of area emitters) using an alias table, which takes constant time
+     instead of a binary search over the face areas. (Default: |false|)
+ * - shared_cache_dir
+   - |string|
+   - Directory in which the loaded geometry is stored, so that other
+     processes (e.g. several renders of the same set on one machine) that
+     load this file with the same options and transformation memory-map it
+     and share its physical pages instead of holding their own copy. Use a
+     directory in :monosp:`/dev/shm` to keep the geometry in shared memory.
+     Not supported by the GPU and differentiable variants, or by meshes with
+     custom attributes. (Default: none)
  * - to_world
    - |transform|
    - Specifies an optional linear object-to-world transformation.
      (Default: none, i.e. object space = world space)
+ * - keyframes
+   - |string|
+   - Optional comma-separated list of files containing further keyframes of
+     the vertex positions for deformation motion blur. They must share the
+     topology of the main file and are spaced evenly in time, with linear
+     interpolation in between. (Default: none)
+ * - motion_start, motion_end
+   - |float|
+   - Time interval spanned by the main file and the keyframes. (Default: 0 and 1)
 
 This plugin implements a simple loader for Wavefront OBJ files. It handles
 meshes containing triangles and quadrilaterals, and it also imports vertex normals
@@ -77,7 +115,8 @@ public:
     MTS_IMPORT_BASE(Mesh, m_name, m_bbox, m_to_world, m_vertex_count, m_face_count,
                     m_vertex_positions_buf, m_vertex_normals_buf, m_vertex_texcoords_buf,
                     m_faces_buf, m_disable_vertex_normals, recompute_vertex_normals,
-                    has_vertex_normals, set_children)
+                    has_vertex_normals, m_compress, compress, load_keyframes,
+                    load_from_cache, add_to_cache, set_children)
     MTS_IMPORT_TYPES()
 
     using typename Base::ScalarSize;
@@ -89,11 +128,44 @@ public:
     using typename Base::InputNormal3f;
     using typename Base::FloatStorage;
 
+    using ScalarIndex3 = std::array<ScalarIndex, 3>;
+
+    /// Contents of a contiguous range of lines of the OBJ file
+    struct OBJChunk {
+        const char *begin = nullptr, *end = nullptr;
+
+        /// Temporary buffers for vertices, normals, and texture coordinates
+        std::vector<InputPoint3f> vertices;
+        std::vector<InputNormal3f> normals;
+        std::vector<InputVector2f> texcoords;
+
+        /// (position, texcoord, normal) index triplets, three per triangle
+        std::vector<ScalarIndex3> corners;
+
+        /// Corners whose key differs from the first use of the same position
+        std::vector<size_t> secondary;
+
+        ScalarBoundingBox3f bbox;
+        std::string error;
+
+        // Offsets of the chunk contents within the whole file
+        size_t vertex_offset = 0, normal_offset = 0, texcoord_offset = 0,
+               corner_offset = 0, id_offset = 0, id_count = 0;
+    };
+
+    struct KeyHasher {
+        size_t operator()(const ScalarIndex3 &k) const {
+            return hash_combine(hash_combine(hash(k[0]), hash(k[1])), hash(k[2]));
+        }
+    };
+
     InputFloat strtof(const char *nptr, char **endptr) {
             return std::strtof(nptr, endptr);
     }
 
     OBJMesh(const Properties &props) : Base(props) {
+        ScopedPhase sp(ProfilerPhase::LoadGeometry);
+
         /* Causes all texture coordinates to be vertically flipped.
            Enabled by default, for consistence with the Mitsuba 1 behavior. */
         bool flip_tex_coords = props.bool_("flip_tex_coords", true);
@@ -112,36 +184,269 @@ public:
         if (!fs::exists(file_path))
             fail("file not found");
 
+        /* Files that are referenced by several shapes are only loaded once,
+           and the scene turns the duplicates into instances */
+        bool cacheable = !m_compress && !props.has_property("keyframes");
+        std::string options = tfm::format("face_normals=%i,flip_tex_coords=%i",
+                                          m_disable_vertex_normals, flip_tex_coords);
+        if (cacheable && load_from_cache(file_path, options)) {
+            Log(Debug, "\"%s\": reusing previously loaded geometry", m_name);
+            load_keyframes(props);
+            set_children();
+            return;
+        }
+
         ref<MemoryMappedFile> mmap = new MemoryMappedFile(file_path);
+        Timer timer;
 
-        using ScalarIndex3 = std::array<ScalarIndex, 3>;
+        /* Split the file into chunks at line boundaries. Each chunk is parsed
+           independently, after which the vertex indices are merged using
+           prefix sums over the chunk sizes. */
+        const char *ptr = (const char *) mmap->data();
+        const char *eof = ptr + mmap->size();
 
-        struct VertexBinding {
-            ScalarIndex3 key {{ 0, 0, 0 }};
-            ScalarIndex value { 0 };
-            VertexBinding *next { nullptr };
+        size_t chunk_count = std::max((size_t) 1, mmap->size() / MTS_OBJ_CHUNK_SIZE);
+        std::vector<OBJChunk> chunks(chunk_count);
+        for (size_t i = 0; i < chunk_count; ++i) {
+            chunks[i].begin = i == 0 ? ptr : chunks[i - 1].end;
+            const char *end = ptr + (mmap->size() * (i + 1)) / chunk_count;
+            if (end < chunks[i].begin)
+                end = chunks[i].begin;
+            if (end != eof) {
+                advance<false>(&end, eof, "\n");
+                if (end != eof)
+                    ++end;
+            }
+            chunks[i].end = end;
+        }
+
+        tbb::parallel_for(size_t(0), chunk_count, [&](size_t i) {
+            parse_chunk(chunks[i], flip_tex_coords);
+        });
+
+        size_t vertex_count = 0, normal_count = 0, texcoord_count = 0, corner_count = 0;
+        for (OBJChunk &chunk : chunks) {
+            if (!chunk.error.empty())
+                fail("%s", chunk.error);
+            chunk.vertex_offset   = vertex_count;
+            chunk.normal_offset   = normal_count;
+            chunk.texcoord_offset = texcoord_count;
+            chunk.corner_offset   = corner_count;
+            vertex_count   += chunk.vertices.size();
+            normal_count   += chunk.normals.size();
+            texcoord_count += chunk.texcoords.size();
+            corner_count   += chunk.corners.size();
+            m_bbox.expand(chunk.bbox);
+        }
+
+        // Return the key of the corner with global index 'c'
+        auto corner_key = [&](size_t c) -> const ScalarIndex3 & {
+            auto it = std::upper_bound(
+                chunks.begin(), chunks.end(), c,
+                [](size_t c, const OBJChunk &chunk) { return c < chunk.corner_offset; });
+            const OBJChunk &chunk = *(it - 1);
+            return chunk.corners[c - chunk.corner_offset];
         };
 
-        /// Temporary buffers for vertices, normals, and texture coordinates
-        std::vector<InputVector3f> vertices;
-        std::vector<InputNormal3f> normals;
-        std::vector<InputVector2f> texcoords;
-        std::vector<ScalarIndex3> triangles;
-        std::vector<VertexBinding> vertex_map;
+        /* Pass 1: find the first corner referencing each vertex position and
+           validate all indices */
+        std::unique_ptr<std::atomic<size_t>[]> first_corner(
+            new std::atomic<size_t>[vertex_count]);
+        for (size_t i = 0; i < vertex_count; ++i)
+            first_corner[i].store((size_t) -1, std::memory_order_relaxed);
+
+        tbb::parallel_for(size_t(0), chunk_count, [&](size_t i) {
+            OBJChunk &chunk = chunks[i];
+            for (size_t j = 0; j < chunk.corners.size(); ++j) {
+                const ScalarIndex3 &key = chunk.corners[j];
+                if (unlikely(key[0] - 1 >= vertex_count)) {
+                    chunk.error = tfm::format("reference to invalid vertex %i!", key[0]);
+                    return;
+                }
+                if (unlikely(key[1] > texcoord_count)) {
+                    chunk.error = tfm::format("reference to invalid texture coordinate %i!", key[1]);
+                    return;
+                }
+                if (unlikely(!m_disable_vertex_normals && key[2] > normal_count)) {
+                    chunk.error = tfm::format("reference to invalid normal %i!", key[2]);
+                    return;
+                }
+
+                size_t c = chunk.corner_offset + j;
+                std::atomic<size_t> &first = first_corner[key[0] - 1];
+                size_t value = first.load(std::memory_order_relaxed);
+                while (c < value && !first.compare_exchange_weak(value, c))
+                    ;
+            }
+        });
+
+        for (OBJChunk &chunk : chunks)
+            if (!chunk.error.empty())
+                fail("%s", chunk.error);
+
+        /* Pass 2: collect corners that use a position with different texture
+           coordinates or normals than its first use (this is rare) */
+        tbb::parallel_for(size_t(0), chunk_count, [&](size_t i) {
+            OBJChunk &chunk = chunks[i];
+            for (size_t j = 0; j < chunk.corners.size(); ++j) {
+                const ScalarIndex3 &key = chunk.corners[j];
+                size_t first = first_corner[key[0] - 1].load(std::memory_order_relaxed);
+                if (first != chunk.corner_offset + j && corner_key(first) != key)
+                    chunk.secondary.push_back(j);
+            }
+        });
+
+        // Maps each secondary key to its first corner and (later) its vertex ID
+        std::unordered_map<ScalarIndex3, std::pair<size_t, ScalarIndex>, KeyHasher> secondary_map;
+        for (const OBJChunk &chunk : chunks)
+            for (size_t j : chunk.secondary)
+                secondary_map.emplace(chunk.corners[j],
+                                      std::make_pair(chunk.corner_offset + j, ScalarIndex(0)));
+
+        /* Invoke 'func(j, key, primary, first)' for the corners of a chunk, where
+           'first' specifies whether the corner creates a new vertex */
+        auto for_each_corner = [&](const OBJChunk &chunk, auto func) {
+            auto secondary_it = chunk.secondary.begin();
+            for (size_t j = 0; j < chunk.corners.size(); ++j) {
+                const ScalarIndex3 &key = chunk.corners[j];
+                size_t c = chunk.corner_offset + j;
+                bool primary = secondary_it == chunk.secondary.end() || *secondary_it != j;
+                if (!primary)
+                    ++secondary_it;
+                bool first = primary
+                    ? first_corner[key[0] - 1].load(std::memory_order_relaxed) == c
+                    : secondary_map.find(key)->second.first == c;
+                func(j, key, primary, first);
+            }
+        };
 
-        size_t vertex_guess = mmap->size() / 100;
-        vertices.reserve(vertex_guess);
-        normals.reserve(vertex_guess);
-        texcoords.reserve(vertex_guess);
-        triangles.reserve(vertex_guess * 2);
-        vertex_map.resize(vertex_guess);
+        // Pass 3: count the new vertices per chunk
+        tbb::parallel_for(size_t(0), chunk_count, [&](size_t i) {
+            OBJChunk &chunk = chunks[i];
+            for_each_corner(chunk, [&](size_t, const ScalarIndex3 &, bool, bool first) {
+                chunk.id_count += first ? 1 : 0;
+            });
+        });
 
         ScalarIndex vertex_ctr = 0;
+        for (OBJChunk &chunk : chunks) {
+            chunk.id_offset = vertex_ctr;
+            vertex_ctr += (ScalarIndex) chunk.id_count;
+        }
 
-        const char *ptr = (const char *) mmap->data();
-        const char *eof = ptr + mmap->size();
+        m_vertex_count = vertex_ctr;
+        m_face_count = (ScalarSize) (corner_count / 3);
+
+        m_faces_buf = empty<DynamicBuffer<UInt32>>(m_face_count * 3);
+        m_vertex_positions_buf = empty<FloatStorage>(m_vertex_count * 3);
+        if (!m_disable_vertex_normals)
+            m_vertex_normals_buf = empty<FloatStorage>(m_vertex_count * 3);
+        if (texcoord_count > 0)
+            m_vertex_texcoords_buf = empty<FloatStorage>(m_vertex_count * 2);
+
+        // TODO this is needed for the bbox(..) methods, but is it slower?
+        m_faces_buf.managed();
+        m_vertex_positions_buf.managed();
+        m_vertex_normals_buf.managed();
+        m_vertex_texcoords_buf.managed();
+
+        if constexpr (is_cuda_array_v<Float>)
+            cuda_sync();
+
+        // Return a vertex attribute given its global (1-based) index
+        auto lookup = [&](auto member, size_t OBJChunk::*offset, size_t index) {
+            auto it = std::upper_bound(
+                chunks.begin(), chunks.end(), index,
+                [&](size_t index, const OBJChunk &chunk) { return index < chunk.*offset; });
+            const OBJChunk &chunk = *(it - 1);
+            return (chunk.*member)[index - chunk.*offset];
+        };
+
+        /* Pass 4: assign vertex IDs in the order of their first use and write
+           the vertex attributes */
+        std::vector<ScalarIndex> primary_id(vertex_count);
+        tbb::parallel_for(size_t(0), chunk_count, [&](size_t i) {
+            OBJChunk &chunk = chunks[i];
+            ScalarIndex id = (ScalarIndex) chunk.id_offset;
+            for_each_corner(chunk, [&](size_t, const ScalarIndex3 &key, bool primary, bool first) {
+                if (!first)
+                    return;
+                if (primary)
+                    primary_id[key[0] - 1] = id;
+                else
+                    secondary_map.find(key)->second.second = id;
+
+                InputFloat* position_ptr = m_vertex_positions_buf.data() + id * 3;
+                InputFloat* normal_ptr   = m_vertex_normals_buf.data() + id * 3;
+                InputFloat* texcoord_ptr = m_vertex_texcoords_buf.data() + id * 2;
+
+                store_unaligned(position_ptr,
+                                lookup(&OBJChunk::vertices, &OBJChunk::vertex_offset, key[0] - 1));
+
+                if (key[1])
+                    store_unaligned(texcoord_ptr,
+                                    lookup(&OBJChunk::texcoords, &OBJChunk::texcoord_offset, key[1] - 1));
+
+                if (!m_disable_vertex_normals && key[2])
+                    store_unaligned(normal_ptr,
+                                    lookup(&OBJChunk::normals, &OBJChunk::normal_offset, key[2] - 1));
+
+                id++;
+            });
+        });
+
+        // Pass 5: write the face indices
+        tbb::parallel_for(size_t(0), chunk_count, [&](size_t i) {
+            OBJChunk &chunk = chunks[i];
+            ScalarIndex *face_ptr = m_faces_buf.data() + chunk.corner_offset;
+            for_each_corner(chunk, [&](size_t j, const ScalarIndex3 &key, bool primary, bool) {
+                face_ptr[j] = primary ? primary_id[key[0] - 1]
+                                      : secondary_map.find(key)->second.second;
+            });
+        });
+
+        size_t vertex_data_bytes = 3 * sizeof(InputFloat);
+        if (has_vertex_normals())
+            vertex_data_bytes += 3 * sizeof(InputFloat);
+        if (texcoord_count > 0)
+            vertex_data_bytes += 2 * sizeof(InputFloat);
+
+        Log(Debug, "\"%s\": read %i faces, %i vertices (%s in %s)",
+            m_name, m_face_count, m_vertex_count,
+            util::mem_string(m_face_count * 3 * sizeof(ScalarIndex) +
+                             m_vertex_count * vertex_data_bytes),
+            util::time_string(timer.value())
+        );
+
+        if (!m_disable_vertex_normals && normal_count == 0) {
+            Timer timer2;
+            recompute_vertex_normals();
+            Log(Debug, "\"%s\": computed vertex normals (took %s)", m_name,
+                util::time_string(timer2.value()));
+        }
+
+        load_keyframes(props);
+
+        if (m_compress)
+            compress();
+
+        set_children();
+
+        if (cacheable)
+            add_to_cache();
+    }
+
+private:
+    /// Parse the 'v', 'vn', 'vt' and 'f' records of a chunk of the OBJ file
+    void parse_chunk(OBJChunk &chunk, bool flip_tex_coords) {
+        const char *ptr = chunk.begin, *eof = chunk.end;
         char buf[1025];
-        Timer timer;
+
+        size_t vertex_guess = (eof - ptr) / 100;
+        chunk.vertices.reserve(vertex_guess);
+        chunk.normals.reserve(vertex_guess);
+        chunk.texcoords.reserve(vertex_guess);
+        chunk.corners.reserve(vertex_guess * 6);
 
         while (ptr < eof) {
             // Determine the offset of the next newline
@@ -150,8 +455,11 @@ public:
 
             // Copy buf into a 0-terminated buffer
             size_t size = next - ptr;
-            if (size >= sizeof(buf) - 1)
-                fail("file contains an excessively long line! (%i characters)", size);
+            if (size >= sizeof(buf) - 1) {
+                chunk.error = tfm::format(
+                    "file contains an excessively long line! (%i characters)", size);
+                return;
+            }
             memcpy(buf, ptr, size);
             buf[size] = '\0';
 
@@ -170,10 +478,12 @@ public:
                     parse_error |= cur == orig;
                 }
                 p = m_to_world.transform_affine(p);
-                if (unlikely(!all(enoki::isfinite(p))))
-                    fail("mesh contains invalid vertex position data");
-                m_bbox.expand(p);
-                vertices.push_back(p);
+                if (unlikely(!all(enoki::isfinite(p)))) {
+                    chunk.error = "mesh contains invalid vertex position data";
+                    return;
+                }
+                chunk.bbox.expand(p);
+                chunk.vertices.push_back(p);
             } else if (cur[0] == 'v' && cur[1] == 'n' && (cur[2] == ' ' || cur[2] == '\t')) {
                 // Vertex normal
                 InputNormal3f n;
@@ -184,9 +494,11 @@ public:
                     parse_error |= cur == orig;
                 }
                 n = normalize(m_to_world.transform_affine(n));
-                if (unlikely(!all(enoki::isfinite(n))))
-                    fail("mesh contains invalid vertex normal data");
-                normals.push_back(n);
+                if (unlikely(!all(enoki::isfinite(n)))) {
+                    chunk.error = "mesh contains invalid vertex normal data";
+                    return;
+                }
+                chunk.normals.push_back(n);
             } else if (cur[0] == 'v' && cur[1] == 't' && (cur[2] == ' ' || cur[2] == '\t')) {
                 // Texture coordinate
                 InputVector2f uv;
@@ -199,14 +511,14 @@ public:
                 if (flip_tex_coords)
                     uv.y() = 1.f - uv.y();
 
-                texcoords.push_back(uv);
+                chunk.texcoords.push_back(uv);
             } else if (cur[0] == 'f' && (cur[1] == ' ' || cur[1] == '\t')) {
                 // Face specification
                 cur += 2;
                 size_t vertex_index = 0;
                 size_t type_index = 0;
                 ScalarIndex3 key {{ (ScalarIndex) 0, (ScalarIndex) 0, (ScalarIndex) 0 }};
-                ScalarIndex3 tri;
+                ScalarIndex3 tri[3];
 
                 while (true) {
                     const char *next2;
@@ -228,122 +540,29 @@ public:
 
                     if (*next2 == ' ' || *next2 == '\t' || *next2 == '\0' || *next2 == '\r') {
                         type_index = 0;
-                        size_t map_index = key[0] - 1;
-
-                        if (unlikely(map_index >= vertices.size()))
-                            fail("reference to invalid vertex %i!", key[0]);
-                        if (unlikely(vertex_map.size() < vertices.size()))
-                            vertex_map.resize(vertices.size());
-
-                        // Hash table lookup
-                        VertexBinding *entry = &vertex_map[map_index];
-                        while (entry->key != key && entry->next != nullptr)
-                            entry = entry->next;
-
-                        ScalarIndex id;
-                        if (entry->key == key) {
-                            // Hit
-                            id = entry->value;
-                        } else {
-                            // Miss
-                            if (entry->key != ScalarIndex3{{0, 0, 0}}) {
-                                entry->next = new VertexBinding();
-                                entry = entry->next;
-                            }
-                            entry->key = key;
-                            id = entry->value = vertex_ctr++;
-                        }
 
                         if (vertex_index < 3) {
-                            tri[vertex_index] = id;
+                            tri[vertex_index] = key;
                         } else {
                             tri[1] = tri[2];
-                            tri[2] = id;
+                            tri[2] = key;
                         }
                         vertex_index++;
 
                         if (vertex_index >= 3)
-                            triangles.push_back(tri);
+                            chunk.corners.insert(chunk.corners.end(), tri, tri + 3);
                     }
 
                     cur = next2;
                 }
             }
 
-            if (unlikely(parse_error))
-                fail("could not parse line \"%s\"", buf);
-            ptr = next + 1;
-        }
-
-        m_vertex_count = vertex_ctr;
-        m_face_count = (ScalarSize) triangles.size();
-
-        m_faces_buf = DynamicBuffer<UInt32>::copy(triangles.data(), m_face_count * 3);
-        m_vertex_positions_buf = empty<FloatStorage>(m_vertex_count * 3);
-        if (!m_disable_vertex_normals)
-            m_vertex_normals_buf = empty<FloatStorage>(m_vertex_count * 3);
-        if (!texcoords.empty())
-            m_vertex_texcoords_buf = empty<FloatStorage>(m_vertex_count * 2);
-
-        // TODO this is needed for the bbox(..) methods, but is it slower?
-        m_faces_buf.managed();
-        m_vertex_positions_buf.managed();
-        m_vertex_normals_buf.managed();
-        m_vertex_texcoords_buf.managed();
-
-        if constexpr (is_cuda_array_v<Float>)
-            cuda_sync();
-
-        for (const auto& v_ : vertex_map) {
-            const VertexBinding *v = &v_;
-
-            while (v && v->key != ScalarIndex3{{0, 0, 0}}) {
-                InputFloat* position_ptr   = m_vertex_positions_buf.data() + v->value * 3;
-                InputFloat* normal_ptr   = m_vertex_normals_buf.data() + v->value * 3;
-                InputFloat* texcoord_ptr = m_vertex_texcoords_buf.data() + v->value * 2;
-                auto key = v->key;
-
-                store_unaligned(position_ptr, vertices[key[0] - 1]);
-
-                if (key[1]) {
-                    size_t map_index = key[1] - 1;
-                    if (unlikely(map_index >= texcoords.size()))
-                        fail("reference to invalid texture coordinate %i!", key[1]);
-                    store_unaligned(texcoord_ptr, texcoords[map_index]);
-                }
-
-                if (!m_disable_vertex_normals && key[2]) {
-                    size_t map_index = key[2] - 1;
-                    if (unlikely(map_index >= normals.size()))
-                        fail("reference to invalid normal %i!", key[2]);
-                    store_unaligned(normal_ptr, normals[key[2] - 1]);
-                }
-
-                v = v->next;
+            if (unlikely(parse_error)) {
+                chunk.error = tfm::format("could not parse line \"%s\"", buf);
+                return;
             }
+            ptr = next + 1;
         }
-
-        size_t vertex_data_bytes = 3 * sizeof(InputFloat);
-        if (has_vertex_normals())
-            vertex_data_bytes += 3 * sizeof(InputFloat);
-        if (!texcoords.empty())
-            vertex_data_bytes += 2 * sizeof(InputFloat);
-
-        Log(Debug, "\"%s\": read %i faces, %i vertices (%s in %s)",
-            m_name, m_face_count, m_vertex_count,
-            util::mem_string(m_face_count * 3 * sizeof(ScalarIndex) +
-                             m_vertex_count * vertex_data_bytes),
-            util::time_string(timer.value())
-        );
-
-        if (!m_disable_vertex_normals && normals.empty()) {
-            Timer timer2;
-            recompute_vertex_normals();
-            Log(Debug, "\"%s\": computed vertex normals (took %s)", m_name,
-                util::time_string(timer2.value()));
-        }
-
-        set_children();
     }
 
     MTS_DECLARE_CLASS()
@@ -7,6 +7,11 @@ struct OptixMeshData {
     const optix::Vector3f *vertex_positions;
     const optix::Vector3f *vertex_normals;
     const optix::Vector2f *vertex_texcoords;
+    /* Only set for batches of small meshes, which share the buffers above:
+       mesh of every face, and shape pointer and first face of every mesh */
+    const unsigned int *face_mesh;
+    const unsigned long long *mesh_shape_ptr;
+    const unsigned int *mesh_face_offset;
 };
 
 #ifdef __CUDACC__
@@ -31,7 +36,16 @@ extern "C" __global__ void __closesthit__mesh() {
     } else {
         const OptixHitGroupData *sbt_data = (OptixHitGroupData *) optixGetSbtDataPointer();
         OptixMeshData *mesh = (OptixMeshData *)sbt_data->data;
-        unsigned int prim_index = optixGetPrimitiveIndex();
+        unsigned int face_index = optixGetPrimitiveIndex();
+
+        // Map the faces of a batch back to their mesh
+        unsigned long long shape_ptr = sbt_data->shape_ptr;
+        unsigned int prim_index = face_index;
+        if (mesh->face_mesh != nullptr) {
+            unsigned int mesh_index = mesh->face_mesh[face_index];
+            shape_ptr  = mesh->mesh_shape_ptr[mesh_index];
+            prim_index = face_index - mesh->mesh_face_offset[mesh_index];
+        }
 
         float t = optixGetRayTmax();
         float2 float2_uv = optixGetTriangleBarycentrics();
@@ -39,7 +53,7 @@ extern "C" __global__ void __closesthit__mesh() {
 
         // Early return for ray_intersect_preliminary call
         if (params.is_ray_intersect_preliminary()) {
-            write_output_pi_params(params, launch_index, sbt_data->shape_ptr, prim_index, prim_uv, t);
+            write_output_pi_params(params, launch_index, shape_ptr, prim_index, prim_uv, t);
             return;
         }
 
@@ -51,7 +65,7 @@ extern "C" __global__ void __closesthit__mesh() {
               b1 = uv.x(),
               b2 = uv.y();
 
-        Vector3u face = load_3d(mesh->faces, prim_index);
+        Vector3u face = load_3d(mesh->faces, face_index);
 
         Vector3f p0 = load_3d(mesh->vertex_positions, face.x()),
                  p1 = load_3d(mesh->vertex_positions, face.y()),
@@ -111,7 +125,7 @@ extern "C" __global__ void __closesthit__mesh() {
             }
         }
 
-        write_output_si_params(params, launch_index, sbt_data->shape_ptr,
+        write_output_si_params(params, launch_index, shape_ptr,
                                prim_index, p, uv, ns, ng, dp_du, dp_dv, dn_du, dn_dv, t);
     }
 }
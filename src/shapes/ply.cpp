@@ -1,11 +1,16 @@
 #include <mitsuba/render/mesh.h>
 #include <mitsuba/core/fstream.h>
 #include <mitsuba/core/mstream.h>
+#include <mitsuba/core/mmap.h>
+#include <mitsuba/core/profiler.h>
 #include <mitsuba/core/fresolver.h>
 #include <mitsuba/core/properties.h>
 #include <mitsuba/core/util.h>
 #include <mitsuba/core/timer.h>
 #include <enoki/half.h>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <atomic>
 #include <unordered_map>
 #include <unordered_set>
 #include <fstream>
@@ -29,10 +34,39 @@ PLY (Stanford Triangle Format) mesh loader (:monosp:`ply`)
    - When set to |true|, any existing or computed vertex normals are
      discarded and *face normals* will instead be used during rendering.
      This gives the rendered object a faceted appearance. (Default: |false|)
+ * - compress
+   - |bool|
+   - Store the mesh in a compact quantized representation (21 bit positions
+     relative to the bounding box, octahedral normals and half precision
+     texture coordinates). This roughly halves the memory usage of large meshes
+     at a small cost in precision. Only supported by the native CPU ray
+     tracing backend. (Default: |false|)
+ * - alias_sampling
+   - |bool|
+   - Sample faces (e.g. of area emitters) using an alias table, which takes constant time
+     instead of a binary search over the face areas. (Default: |false|)
+ * - shared_cache_dir
+   - |string|
+   - Directory in which the loaded geometry is stored, so that other
+     processes (e.g. several renders of the same set on one machine) that
+     load this file with the same options and transformation memory-map it
+     and share its physical pages instead of holding their own copy. Use a
+     directory in :monosp:`/dev/shm` to keep the geometry in shared memory.
+     Not supported by the GPU and differentiable variants, or by meshes with
+     custom attributes. (Default: none)
  * - to_world
    - |transform|
    - Specifies an optional linear object-to-world transformation.
      (Default: none, i.e. object space = world space)
+ * - keyframes
+   - |string|
+   - Optional comma-separated list of files containing further keyframes of
+     the vertex positions for deformation motion blur. They must share the
+     topology of the main file and are spaced evenly in time, with linear
+     interpolation in between. (Default: none)
+ * - motion_start, motion_end
+   - |float|
+   - Time interval spanned by the main file and the keyframes. (Default: 0 and 1)
 
 .. subfigstart::
 .. subfigure:: ../../resources/data/docs/images/render/shape_ply_bunny.jpg
@@ -46,6 +80,7 @@ This plugin implements a fast loader for the Stanford PLY format (both the
 ASCII and binary format, which is preferred for performance reasons). The
 current plugin implementation supports triangle meshes with optional UV
 coordinates, vertex normals and other custom vertex or face attributes.
+Binary files are memory-mapped and converted using multiple threads.
 
 Consecutive attributes with names sharing a common prefix and using one of the following schemes:
 
@@ -55,7 +90,13 @@ will be group together under a single multidimentional attribute named ``{vertex
 
 RGB color attributes can also be defined without a prefix, following the naming scheme ``{r|g|b|a}``
 or ``{red|green|blue|alpha}``. Those attributes will be group together under a single
-multidimentional attribute named ``{vertex|face}_color``.
+multidimentional attribute named ``{vertex|face}_color``. A single field named ``radius``
+is loaded as the attribute ``{vertex|face}_radius``.
+
+Attributes are kept in a compact form when the file stores them as such: 8 bit color
+components (e.g. ``uchar red``) are stored using one byte per channel and mapped to the
+[0, 1] range, half precision fields remain in half precision, and other unsigned integer
+fields (e.g. IDs) are stored as 32 bit integers. All other attributes use single precision.
 
 .. note::
 
@@ -69,7 +110,9 @@ public:
     MTS_IMPORT_BASE(Mesh, m_name, m_bbox, m_to_world, m_vertex_count, m_face_count,
                     m_vertex_positions_buf, m_vertex_normals_buf, m_vertex_texcoords_buf,
                     m_faces_buf, add_attribute, m_disable_vertex_normals, has_vertex_normals,
-                    has_vertex_texcoords, recompute_vertex_normals, set_children)
+                    has_vertex_texcoords, recompute_vertex_normals, m_compress, compress,
+                    load_keyframes, load_from_cache, add_to_cache,
+                    set_children)
     MTS_IMPORT_TYPES()
 
     using typename Base::ScalarSize;
@@ -81,6 +124,8 @@ public:
     using typename Base::InputVector3f;
     using typename Base::InputNormal3f;
     using typename Base::FloatStorage;
+    using typename Base::PackedStorage32;
+    using typename Base::MeshAttributeFormat;
 
     struct PLYElement {
         std::string name;
@@ -97,10 +142,67 @@ public:
     struct PLYAttributeDescriptor {
         std::string name;
         size_t dim;
+        MeshAttributeFormat format;
+        /// Offset of the first field in the converted record
+        size_t offset;
         FloatStorage buf;
+        PackedStorage32 packed;
+
+        void allocate(size_t count) {
+            if (format == MeshAttributeFormat::Float32) {
+                buf = empty<FloatStorage>(count * dim);
+                buf.managed();
+            } else {
+                packed = empty<PackedStorage32>(count * Base::attribute_words(format, dim));
+                packed.managed();
+            }
+        }
+
+        /// Copy the fields of element \c index from a converted record
+        void store(size_t index, const uint8_t *src) {
+            switch (format) {
+                case MeshAttributeFormat::Float32:
+                    memcpy(buf.data() + index * dim, src, dim * sizeof(InputFloat));
+                    break;
+
+                case MeshAttributeFormat::UInt32:
+                    memcpy((uint32_t *) packed.data() + index * dim, src, dim * sizeof(uint32_t));
+                    break;
+
+                case MeshAttributeFormat::UNorm8: {
+                        uint32_t value = 0;
+                        for (size_t j = 0; j < dim; ++j)
+                            value |= (uint32_t) src[j] << (8 * j);
+                        ((uint32_t *) packed.data())[index] = value;
+                    }
+                    break;
+
+                case MeshAttributeFormat::Float16: {
+                        uint32_t *out = (uint32_t *) packed.data() + index * ((dim + 1) / 2);
+                        for (size_t j = 0; j < dim; ++j) {
+                            uint16_t value;
+                            memcpy(&value, src + 2 * j, sizeof(uint16_t));
+                            if (j % 2 == 0)
+                                out[j / 2] = value;
+                            else
+                                out[j / 2] |= (uint32_t) value << 16;
+                        }
+                    }
+                    break;
+            }
+        }
+
+        void add_to(PLYMesh *mesh) const {
+            if (format == MeshAttributeFormat::Float32)
+                mesh->add_attribute(name, dim, buf);
+            else
+                mesh->add_attribute(name, dim, format, packed);
+        }
     };
 
     PLYMesh(const Properties &props) : Base(props) {
+        ScopedPhase sp(ProfilerPhase::LoadGeometry);
+
         /// Process vertex/index records in large batches
         constexpr size_t elements_per_packet = 1024;
 
@@ -116,6 +218,17 @@ public:
         if (!fs::exists(file_path))
             fail("file not found");
 
+        /* Files that are referenced by several shapes are only loaded once,
+           and the scene turns the duplicates into instances */
+        bool cacheable = !m_compress && !props.has_property("keyframes");
+        std::string options = tfm::format("face_normals=%i", m_disable_vertex_normals);
+        if (cacheable && load_from_cache(file_path, options)) {
+            Log(Debug, "\"%s\": reusing previously loaded geometry", m_name);
+            load_keyframes(props);
+            set_children();
+            return;
+        }
+
         ref<Stream> stream = new FileStream(file_path);
         Timer timer;
 
@@ -134,6 +247,66 @@ public:
             fail(e.what());
         }
 
+        /* Binary files are memory-mapped so that the element blocks can be
+           converted in parallel. ASCII files were already translated into a
+           binary memory stream above and are processed sequentially. */
+        ref<MemoryMappedFile> mmap;
+        const uint8_t *data = nullptr;
+        size_t data_offset = 0, data_size = 0;
+        if (!header.ascii) {
+            data_offset = stream->tell();
+            stream->close();
+            stream = nullptr;
+            try {
+                mmap = new MemoryMappedFile(file_path);
+            } catch (const std::exception &e) {
+                fail(e.what());
+            }
+            data = (const uint8_t *) mmap->data();
+            data_size = mmap->size();
+        }
+
+        /* Invoke 'func(packet_index, count, ptr)' for each packet of the
+           current element block, where 'ptr' points to 'count' consecutive
+           elements of size 'struct_size' */
+        auto for_each_packet = [&](size_t el_count, size_t struct_size, auto func) {
+            size_t packet_count = (el_count + elements_per_packet - 1) / elements_per_packet;
+            auto packet_size = [&](size_t i) {
+                return std::min(elements_per_packet, el_count - i * elements_per_packet);
+            };
+
+            if (data) {
+                if (data_offset + el_count * struct_size > data_size)
+                    fail("invalid file -- unexpected end of file");
+                const uint8_t *base = data + data_offset;
+                tbb::parallel_for(
+                    tbb::blocked_range<size_t>(0, packet_count),
+                    [&](const tbb::blocked_range<size_t> &range) {
+                        for (size_t i = range.begin(); i != range.end(); ++i)
+                            func(i, packet_size(i),
+                                 base + i * elements_per_packet * struct_size);
+                    }
+                );
+                data_offset += el_count * struct_size;
+            } else {
+                std::unique_ptr<uint8_t[]> buf(new uint8_t[struct_size * elements_per_packet]);
+                for (size_t i = 0; i < packet_count; ++i) {
+                    stream->read(buf.get(), packet_size(i) * struct_size);
+                    func(i, packet_size(i), buf.get());
+                }
+            }
+        };
+
+        /* Errors raised within worker threads are recorded here and
+           reported once the parallel section has finished */
+        std::atomic<bool> invalid_contents(false), invalid_values(false);
+        auto check_errors = [&]() {
+            if (invalid_contents)
+                fail("incompatible contents -- is this a triangle mesh?");
+            if (invalid_values)
+                fail("mesh contains invalid vertex positions/normal data");
+        };
+
         bool has_vertex_normals = false;
         bool has_vertex_texcoords = false;
 
@@ -184,11 +357,15 @@ public:
                 size_t i_struct_size = el.struct_->size();
                 size_t o_struct_size = vertex_struct->size();
 
+                /* When the file already stores the data in the expected
+                   layout, the records are read without any conversion */
                 ref<StructConverter> conv;
-                try {
-                    conv = new StructConverter(el.struct_, vertex_struct);
-                } catch (const std::exception &e) {
-                    fail(e.what());
+                if (!same_layout(el.struct_, vertex_struct)) {
+                    try {
+                        conv = new StructConverter(el.struct_, vertex_struct);
+                    } catch (const std::exception &e) {
+                        fail(e.what());
+                    }
                 }
 
                 m_vertex_count = (ScalarSize) el.count;
@@ -198,10 +375,8 @@ public:
                 if (has_vertex_texcoords)
                     m_vertex_texcoords_buf = empty<FloatStorage>(m_vertex_count * 2);
 
-                for (auto& descr: vertex_attributes_descriptors) {
-                    descr.buf = empty<FloatStorage>(m_vertex_count * descr.dim);
-                    descr.buf.managed();
-                }
+                for (auto& descr: vertex_attributes_descriptors)
+                    descr.allocate(m_vertex_count);
 
                 m_vertex_positions_buf.managed();
                 m_vertex_normals_buf.managed();
@@ -210,74 +385,73 @@ public:
                 if constexpr (is_cuda_array_v<Float>)
                     cuda_sync();
 
-                size_t packet_count     = el.count / elements_per_packet;
-                size_t remainder_count  = el.count % elements_per_packet;
-                size_t i_packet_size    = i_struct_size * elements_per_packet;
-                size_t i_remainder_size = i_struct_size * remainder_count;
-                size_t o_packet_size    = o_struct_size * elements_per_packet;
-
-                std::unique_ptr<uint8_t[]> buf(new uint8_t[i_packet_size]);
-                std::unique_ptr<uint8_t[]> buf_o(new uint8_t[o_packet_size]);
-
-                InputFloat* position_ptr = m_vertex_positions_buf.data();
-                InputFloat* normal_ptr   = m_vertex_normals_buf.data();
-                InputFloat* texcoord_ptr = m_vertex_texcoords_buf.data();
-
-                for (size_t i = 0; i <= packet_count; ++i) {
-                    uint8_t *target = (uint8_t *) buf_o.get();
-                    size_t psize = (i != packet_count) ? i_packet_size : i_remainder_size;
-                    size_t count = (i != packet_count) ? elements_per_packet : remainder_count;
-                    stream->read(buf.get(), psize);
-                    if (unlikely(!conv->convert(count, buf.get(), buf_o.get())))
-                        fail("incompatible contents -- is this a triangle mesh?");
-
-                    for (size_t j = 0; j < count; ++j) {
-                        InputPoint3f p = enoki::load<InputPoint3f>(target);
-                        p = m_to_world.transform_affine(p);
-                        if (unlikely(!all(enoki::isfinite(p))))
-                            fail("mesh contains invalid vertex positions/normal data");
-                        m_bbox.expand(p);
-                        store_unaligned(position_ptr, p);
-                        position_ptr += 3;
-
-                        if (has_vertex_normals) {
-                            InputNormal3f n = enoki::load<InputNormal3f>(
-                                target + sizeof(InputFloat) * 3);
-                            n = normalize(m_to_world.transform_affine(n));
-                            store_unaligned(normal_ptr, n);
-                            normal_ptr += 3;
+                size_t normal_offset   = sizeof(InputFloat) * 3,
+                       texcoord_offset = sizeof(InputFloat) * (m_disable_vertex_normals ? 3 : 6);
+
+                std::vector<ScalarBoundingBox3f> packet_bbox(
+                    (el.count + elements_per_packet - 1) / elements_per_packet);
+
+                for_each_packet(el.count, i_struct_size,
+                    [&](size_t i, size_t count, const uint8_t *src) {
+                        std::unique_ptr<uint8_t[]> buf_o;
+                        const uint8_t *target = src;
+                        if (conv) {
+                            buf_o.reset(new uint8_t[o_struct_size * count]);
+                            if (unlikely(!conv->convert(count, src, buf_o.get()))) {
+                                invalid_contents = true;
+                                return;
+                            }
+                            target = buf_o.get();
                         }
 
-                        if (has_vertex_texcoords) {
-                            InputVector2f uv = enoki::load<InputVector2f>(
-                                target + (m_disable_vertex_normals
-                                              ? sizeof(InputFloat) * 3
-                                              : sizeof(InputFloat) * 6));
-                            store_unaligned(texcoord_ptr, uv);
-                            texcoord_ptr += 2;
-                        }
+                        size_t offset = i * elements_per_packet;
+                        InputFloat* position_ptr = m_vertex_positions_buf.data() + offset * 3;
+                        InputFloat* normal_ptr   = m_vertex_normals_buf.data() + offset * 3;
+                        InputFloat* texcoord_ptr = m_vertex_texcoords_buf.data() + offset * 2;
+                        ScalarBoundingBox3f bbox;
+
+                        for (size_t j = 0; j < count; ++j) {
+                            InputPoint3f p = load_packed<InputPoint3f>(target);
+                            p = m_to_world.transform_affine(p);
+                            if (unlikely(!all(enoki::isfinite(p)))) {
+                                invalid_values = true;
+                                return;
+                            }
+                            bbox.expand(p);
+                            store_unaligned(position_ptr, p);
+                            position_ptr += 3;
+
+                            if (has_vertex_normals) {
+                                InputNormal3f n =
+                                    load_packed<InputNormal3f>(target + normal_offset);
+                                n = normalize(m_to_world.transform_affine(n));
+                                store_unaligned(normal_ptr, n);
+                                normal_ptr += 3;
+                            }
 
-                        size_t target_offset =
-                            sizeof(InputFloat) *
-                            (!m_disable_vertex_normals
-                                 ? (has_vertex_texcoords ? 8 : 6)
-                                 : (has_vertex_texcoords ? 5 : 3));
-
-                        for (size_t k = 0; k < vertex_attributes_descriptors.size(); ++k) {
-                            auto& descr = vertex_attributes_descriptors[k];
-                            memcpy(descr.buf.data() + (i * elements_per_packet + j) * descr.dim,
-                                   target + target_offset,
-                                   descr.dim * sizeof(InputFloat));
-                            target_offset += descr.dim * sizeof(InputFloat);
+                            if (has_vertex_texcoords) {
+                                InputVector2f uv =
+                                    load_packed<InputVector2f>(target + texcoord_offset);
+                                store_unaligned(texcoord_ptr, uv);
+                                texcoord_ptr += 2;
+                            }
+
+                            for (auto &descr : vertex_attributes_descriptors)
+                                descr.store(offset + j, target + descr.offset);
+
+                            target += o_struct_size;
                         }
 
-                        target += o_struct_size;
+                        packet_bbox[i] = bbox;
                     }
-                }
+                );
+                check_errors();
 
-                for (auto& descr: vertex_attributes_descriptors) {
-                    add_attribute(descr.name, descr.dim, descr.buf);
-                }
+                for (const ScalarBoundingBox3f &bbox : packet_bbox)
+                    m_bbox.expand(bbox);
+
+                for (auto& descr: vertex_attributes_descriptors)
+                    descr.add_to(this);
             } else if (el.name == "face") {
                 std::string field_name;
                 if (el.struct_->has_field("vertex_index.count"))
@@ -314,59 +488,47 @@ public:
                 m_faces_buf = empty<DynamicBuffer<UInt32>>(m_face_count * 3);
                 m_faces_buf.managed();
 
-                for (auto& descr: face_attributes_descriptors) {
-                    descr.buf = empty<FloatStorage>(m_face_count * descr.dim);
-                    descr.buf.managed();
-                }
+                for (auto& descr: face_attributes_descriptors)
+                    descr.allocate(m_face_count);
 
-                ScalarIndex* face_ptr = m_faces_buf.data();
-
-                size_t packet_count     = el.count / elements_per_packet;
-                size_t remainder_count  = el.count % elements_per_packet;
-                size_t i_packet_size    = i_struct_size * elements_per_packet;
-                size_t i_remainder_size = i_struct_size * remainder_count;
-                size_t o_packet_size    = o_struct_size * elements_per_packet;
-
-                std::unique_ptr<uint8_t[]> buf(new uint8_t[i_packet_size]);
-                std::unique_ptr<uint8_t[]> buf_o(new uint8_t[o_packet_size]);
-
-                for (size_t i = 0; i <= packet_count; ++i) {
-                    uint8_t *target = (uint8_t *) buf_o.get();
-                    size_t psize = (i != packet_count) ? i_packet_size : i_remainder_size;
-                    size_t count = (i != packet_count) ? elements_per_packet : remainder_count;
-
-                    stream->read(buf.get(), psize);
-                    if (unlikely(!conv->convert(count, buf.get(), buf_o.get())))
-                        fail("incompatible contents -- is this a triangle mesh?");
-
-                    for (size_t j = 0; j < count; ++j) {
-                        ScalarIndex3 fi = enoki::load<ScalarIndex3>(target);
-                        store_unaligned(face_ptr, fi);
-                        face_ptr += 3;
-
-                        size_t target_offset = sizeof(InputFloat) * 3;
-                        for (size_t k = 0; k < face_attributes_descriptors.size(); ++k) {
-                            auto& descr = face_attributes_descriptors[k];
-                            memcpy(descr.buf.data() + (i * elements_per_packet + j) * descr.dim,
-                                   target + target_offset,
-                                   descr.dim * sizeof(InputFloat));
-                            target_offset += descr.dim * sizeof(InputFloat);
+                for_each_packet(el.count, i_struct_size,
+                    [&](size_t i, size_t count, const uint8_t *src) {
+                        std::unique_ptr<uint8_t[]> buf_o(new uint8_t[o_struct_size * count]);
+                        if (unlikely(!conv->convert(count, src, buf_o.get()))) {
+                            invalid_contents = true;
+                            return;
                         }
 
-                        target += o_struct_size;
+                        size_t offset = i * elements_per_packet;
+                        const uint8_t *target = buf_o.get();
+                        ScalarIndex* face_ptr = m_faces_buf.data() + offset * 3;
+
+                        for (size_t j = 0; j < count; ++j) {
+                            ScalarIndex3 fi = load_packed<ScalarIndex3>(target);
+                            store_unaligned(face_ptr, fi);
+                            face_ptr += 3;
+
+                            for (auto &descr : face_attributes_descriptors)
+                                descr.store(offset + j, target + descr.offset);
+
+                            target += o_struct_size;
+                        }
                     }
-                }
+                );
+                check_errors();
 
-                for (auto& descr: face_attributes_descriptors) {
-                    add_attribute(descr.name, descr.dim, descr.buf);
-                }
+                for (auto& descr: face_attributes_descriptors)
+                    descr.add_to(this);
             } else {
                 Log(Warn, "\"%s\": Skipping unknown element \"%s\"", m_name, el.name);
-                stream->seek(stream->tell() + el.struct_->size() * el.count);
+                if (data)
+                    data_offset += el.struct_->size() * el.count;
+                else
+                    stream->seek(stream->tell() + el.struct_->size() * el.count);
             }
         }
 
-        if (stream->tell() != stream->size())
+        if (data ? data_offset != data_size : stream->tell() != stream->size())
             fail("invalid file -- trailing content");
 
         Log(Debug, "\"%s\": read %i faces, %i vertices (%s in %s)",
@@ -383,10 +545,42 @@ public:
                 util::time_string(timer2.value()));
         }
 
+        load_keyframes(props);
+
+        if (m_compress)
+            compress();
+
         set_children();
+
+        if (cacheable)
+            add_to_cache();
     }
 
 private:
+    /// Load an array of values stored contiguously at a potentially unaligned address
+    template <typename T> static T load_packed(const uint8_t *ptr) {
+        using Value = scalar_t<T>;
+        Value tmp[array_size_v<T>];
+        memcpy(tmp, ptr, sizeof(tmp));
+        T result;
+        for (size_t i = 0; i < array_size_v<T>; ++i)
+            result[i] = tmp[i];
+        return result;
+    }
+
+    /// Check whether two structures have identical memory layouts
+    static bool same_layout(const Struct *s1, const Struct *s2) {
+        if (s1->size() != s2->size() || s1->field_count() != s2->field_count() ||
+            s1->byte_order() != Struct::host_byte_order())
+            return false;
+        for (size_t i = 0; i < s1->field_count(); ++i) {
+            const Struct::Field &f1 = (*s1)[i], &f2 = (*s2)[i];
+            if (f1.name != f2.name || f1.type != f2.type || f1.offset != f2.offset)
+                return false;
+        }
+        return true;
+    }
+
     PLYHeader parse_ply_header(Stream *stream) {
         Struct::ByteOrder byte_order = Struct::host_byte_order();
         bool ply_tag_seen = false;
@@ -625,6 +819,37 @@ private:
         return out;
     }
 
+    /// Compact storage format of an attribute whose fields have the given type
+    static MeshAttributeFormat attribute_format(Struct::Type type, bool is_color) {
+        if (type == Struct::Type::Float16)
+            return MeshAttributeFormat::Float16;
+        else if (type == Struct::Type::UInt8 && is_color)
+            return MeshAttributeFormat::UNorm8;
+        else if (!is_color && (type == Struct::Type::UInt8 ||
+                               type == Struct::Type::UInt16 ||
+                               type == Struct::Type::UInt32))
+            return MeshAttributeFormat::UInt32;
+        return MeshAttributeFormat::Float32;
+    }
+
+    /// Type of the fields of an attribute in the converted records
+    static Struct::Type field_type(MeshAttributeFormat format) {
+        switch (format) {
+            case MeshAttributeFormat::Float16: return Struct::Type::Float16;
+            case MeshAttributeFormat::UNorm8:  return Struct::Type::UInt8;
+            case MeshAttributeFormat::UInt32:  return Struct::Type::UInt32;
+            default:                           return struct_type_v<InputFloat>;
+        }
+    }
+
+    static void add_descriptor(std::vector<PLYAttributeDescriptor> &descriptors,
+                               const Struct *target_struct, const std::string &name,
+                               size_t dim, MeshAttributeFormat format,
+                               const std::string &first_field) {
+        descriptors.push_back({ name, dim, format, target_struct->field(first_field).offset,
+                                FloatStorage(), PackedStorage32() });
+    }
+
     void find_other_fields(const std::string& type, std::vector<PLYAttributeDescriptor> &vertex_attributes_descriptors, ref<Struct> target_struct,
         ref<Struct> ref_struct, std::unordered_set<std::string> &reserved_names) {
 
@@ -641,16 +866,16 @@ private:
         }
         if (ref_struct->has_field("r") && ref_struct->has_field("g") && ref_struct->has_field("b")) {
             // vertex_attribute_structs.push_back(new Struct());
-            size_t field_count = 3;
-            for (auto name : { "r", "g", "b" })
-                target_struct->append(name, struct_type_v<InputFloat>);
-            if (ref_struct->has_field("a")) {
-                target_struct->append("a", struct_type_v<InputFloat>);
-                ++field_count;
-            }
-            vertex_attributes_descriptors.push_back({ type + "color", field_count, FloatStorage() });
-
-            if (!ref_struct->field("r").is_float())
+            size_t field_count = ref_struct->has_field("a") ? 4 : 3;
+            MeshAttributeFormat format =
+                attribute_format(ref_struct->field("r").type, true);
+            for (auto name : { "r", "g", "b", "a" })
+                if (ref_struct->has_field(name))
+                    target_struct->append(name, field_type(format));
+            add_descriptor(vertex_attributes_descriptors, target_struct,
+                           type + "color", field_count, format, "r");
+
+            if (format != MeshAttributeFormat::UNorm8 && !ref_struct->field("r").is_float())
                 Log(Warn, "Mesh attribute \"%s\" has integer fields: color attributes are expected to be in the [0, 1] range.",
                     (type + "color").c_str());
         }
@@ -691,18 +916,23 @@ private:
                 return;
             }
 
-            if (!Struct::is_float(current_type) && current_postfix_level_index == 3)
+            bool is_color = current_postfix_index == 1;
+            MeshAttributeFormat format = attribute_format(current_type, is_color);
+
+            if (!Struct::is_float(current_type) && current_postfix_level_index == 3 &&
+                format != MeshAttributeFormat::UNorm8)
                 Log(Warn, "Attribute \"%s\" has integer fields: color attributes are expected to be in the [0, 1] range.",
                     (type + current_prefix).c_str());
 
+            std::string first_field = current_prefix + "_" + postfixes[0][current_postfix_index];
             for(size_t i = 0; i < current_postfix_level_index; ++i)
                 target_struct->append(current_prefix + "_" + postfixes[i][current_postfix_index],
-                                      struct_type_v<InputFloat>);
+                                      field_type(format));
 
-            std::string color_postfix = (current_postfix_index == 1) ? "_color" : "";
-            vertex_attributes_descriptors.push_back(
-                { type + current_prefix + color_postfix,
-                  current_postfix_level_index, FloatStorage() });
+            std::string color_postfix = is_color ? "_color" : "";
+            add_descriptor(vertex_attributes_descriptors, target_struct,
+                           type + current_prefix + color_postfix,
+                           current_postfix_level_index, format, first_field);
 
             prefixes_encountered.insert(current_prefix);
             // Reset state
@@ -717,6 +947,18 @@ private:
 
             current_type = field.type;
 
+            /* A single "radius" or "id" field (e.g. of a point cloud or of the
+               instances of an instancer) is exposed as a one-dimensional
+               attribute, see the pointcloud and instancer plugins */
+            if (field.name == "radius" || field.name == "id") {
+                if (reading_attribute)
+                    flush_attribute();
+                target_struct->append(field.name, struct_type_v<InputFloat>);
+                add_descriptor(vertex_attributes_descriptors, target_struct, type + field.name,
+                               1, MeshAttributeFormat::Float32, field.name);
+                continue;
+            }
+
             auto pos = field.name.find_last_of('_');
             if (pos == std::string::npos) {
                 Log(Warn, "Attribute without postifx are not handled for now: attribute \"%s\" ignored.", field.name.c_str());
@@ -0,0 +1,380 @@
+#include <mitsuba/core/filesystem.h>
+#include <mitsuba/core/fwd.h>
+#include <mitsuba/core/math.h>
+#include <mitsuba/core/plugin.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/timer.h>
+#include <mitsuba/core/transform.h>
+#include <mitsuba/core/util.h>
+#include <mitsuba/render/fwd.h>
+#include <mitsuba/render/interaction.h>
+#include <mitsuba/render/mesh.h>
+#include <mitsuba/render/shape.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+
+.. _shape-pointcloud:
+
+Point cloud (:monosp:`pointcloud`)
+----------------------------------
+
+.. pluginparameters::
+
+ * - filename
+   - |string|
+   - Filename of a PLY file whose vertices specify the centers of the points
+ * - mode
+   - |string|
+   - Shape of the individual points: ``sphere``, or ``disk`` for flat disks that
+     always face the incident ray. (Default: ``sphere``)
+ * - radius
+   - |float|
+   - Radius of all points, used when the file does not specify per-point radii.
+     (Default: 1)
+ * - to_world
+   - |transform|
+   - Specifies an optional linear object-to-world transformation. The radii
+     are scaled by the cube root of its determinant. (Default: none, i.e.
+     object space = world space)
+
+This shape plugin stores a large number of spheres or disks (e.g. the output
+of a particle simulation) as a single shape. Every point only occupies 16 bytes
+(its center and radius), while an equivalent set of :ref:`sphere <shape-sphere>`
+shapes carries a full shape object with its own properties, transform and BSDF
+reference per point. The points are individual primitives of the acceleration
+data structure, and all of them share the BSDF (and media) of the shape.
+
+The centers are loaded from the vertices of a PLY file, whose faces (if any)
+are ignored. Per-point radii are read from an optional vertex field named
+``radius``. When Mitsuba is compiled with Embree, the points are mapped onto
+Embree's native sphere and disk primitives. The GPU variants don't support
+point clouds yet.
+
+.. code-block:: xml
+
+    <shape type="pointcloud">
+        <string name="filename" value="particles.ply"/>
+        <float name="radius" value="0.01"/>
+        <bsdf type="diffuse"/>
+    </shape>
+ */
+
+template <typename Float, typename Spectrum>
+class PointCloud final : public Shape<Float, Spectrum> {
+public:
+    MTS_IMPORT_BASE(Shape, m_to_world, set_children, get_children_string)
+    MTS_IMPORT_TYPES(Mesh)
+
+    using typename Base::ScalarIndex;
+    using typename Base::ScalarSize;
+
+    using InputFloat     = float;
+    using FloatStorage   = DynamicBuffer<replace_scalar_t<Float, InputFloat>>;
+    using Vector4f       = Vector<Float, 4>;
+    using ScalarVector4f = Vector<ScalarFloat, 4>;
+
+    PointCloud(const Properties &props) : Base(props) {
+        if constexpr (is_cuda_array_v<Float>)
+            Throw("pointcloud: point clouds are not supported by the GPU variants yet!");
+
+        std::string mode = props.string("mode", "sphere");
+        if (mode == "sphere")
+            m_disk = false;
+        else if (mode == "disk")
+            m_disk = true;
+        else
+            Throw("pointcloud: invalid mode \"%s\", must be \"sphere\" or \"disk\"!", mode);
+
+        ScalarFloat radius = props.float_("radius", 1.f);
+        Timer timer;
+
+        /* Reuse the parallel PLY loader, which also applies the 'to_world'
+           transformation to the centers. Only the vertices are needed. */
+        Properties props_ply("ply");
+        props_ply.set_string("filename", props.string("filename"));
+        props_ply.set_bool("face_normals", true);
+        if (props.has_property("to_world"))
+            props_ply.copy_attribute(props, "to_world", "to_world");
+        ref<Mesh> mesh = PluginManager::instance()->create_object<Mesh>(props_ply);
+        m_name = fs::path(props.string("filename")).filename().string();
+
+        m_point_count = mesh->vertex_count();
+        if (m_point_count == 0)
+            Throw("pointcloud: \"%s\" does not contain any points!", m_name);
+
+        const InputFloat *positions = mesh->vertex_positions_buffer().data(),
+                         *radii = nullptr;
+        if (mesh->has_attribute("vertex_radius"))
+            radii = mesh->attribute_buffer("vertex_radius").data();
+
+        ScalarFloat radius_scale = std::cbrt(std::abs(det(m_to_world.matrix)));
+
+        std::unique_ptr<InputFloat[]> points(new InputFloat[m_point_count * 4]);
+        for (ScalarSize i = 0; i < m_point_count; ++i) {
+            InputFloat r = (InputFloat) ((radii ? radii[i] : radius) * radius_scale);
+            if (!(r >= 0.f))
+                Throw("pointcloud: point %i has an invalid radius (%f)!", i, r);
+            for (size_t k = 0; k < 3; ++k)
+                points[i * 4 + k] = positions[i * 3 + k];
+            points[i * 4 + 3] = r;
+
+            ScalarPoint3f p(positions[i * 3], positions[i * 3 + 1], positions[i * 3 + 2]);
+            m_bbox.expand(ScalarBoundingBox3f(p - r, p + r));
+            m_surface_area += (m_disk ? 1.f : 4.f) * math::Pi<ScalarFloat> * sqr(r);
+        }
+        m_points = FloatStorage::copy(points.get(), m_point_count * 4);
+
+        Log(Debug, "\"%s\": loaded %i points (%s in %s)", m_name, m_point_count,
+            util::mem_string(m_point_count * 4 * sizeof(InputFloat)),
+            util::time_string(timer.value()));
+
+        set_children();
+    }
+
+    /// Return the center and radius of the point with index \c index
+    template <typename Index>
+    MTS_INLINE auto point(Index index, mask_t<Index> active = true) const {
+        using Result = Vector<replace_scalar_t<Index, ScalarFloat>, 4>;
+        return Result(gather<Vector<replace_scalar_t<Index, InputFloat>, 4>>(
+            m_points, index, active));
+    }
+
+    // =============================================================
+    //! @{ \name Ray tracing routines
+    // =============================================================
+
+    PreliminaryIntersection3f ray_intersect_primitive(ScalarIndex index, const Ray3f &ray,
+                                                      Mask active) const override {
+        MTS_MASK_ARGUMENT(active);
+
+        ScalarVector4f c = point(index);
+        ScalarPoint3f center = head<3>(c);
+        ScalarFloat radius = c.w();
+
+        Float t;
+        if (m_disk) {
+            // The disk lies in the plane through its center facing the ray
+            Vector3f o = ray.o - center;
+            t = -dot(o, ray.d) * rcp(squared_norm(ray.d));
+            active &= squared_norm(fmadd(ray.d, t, o)) <= sqr(radius) &&
+                      t >= ray.mint && t <= ray.maxt;
+        } else {
+            using Double = std::conditional_t<is_cuda_array_v<Float>, Float, Float64>;
+            using Double3 = Vector<Double, 3>;
+
+            Double mint = Double(ray.mint),
+                   maxt = Double(ray.maxt);
+
+            Double3 o = Double3(ray.o) - Double3(center),
+                    d(ray.d);
+
+            Double A = squared_norm(d),
+                   B = scalar_t<Double>(2.f) * dot(o, d),
+                   C = squared_norm(o) - sqr((scalar_t<Double>) radius);
+
+            auto [solution_found, near_t, far_t] = math::solve_quadratic(A, B, C);
+
+            // The sphere doesn't intersect the segment, or fully contains it
+            Mask out_bounds = !(near_t <= maxt && far_t >= mint),
+                 in_bounds  = near_t < mint && far_t > maxt;
+
+            active &= solution_found && !out_bounds && !in_bounds;
+            t = select(near_t < mint, Float(far_t), Float(near_t));
+        }
+
+        PreliminaryIntersection3f pi = zero<PreliminaryIntersection3f>();
+        pi.t = select(active, t, math::Infinity<Float>);
+        pi.prim_index = index;
+        pi.shape = this;
+
+        return pi;
+    }
+
+    Mask ray_test_primitive(ScalarIndex index, const Ray3f &ray, Mask active) const override {
+        MTS_MASK_ARGUMENT(active);
+        return ray_intersect_primitive(index, ray, active).is_valid();
+    }
+
+    PreliminaryIntersection3f ray_intersect_preliminary(const Ray3f &ray_,
+                                                        Mask active) const override {
+        MTS_MASK_ARGUMENT(active);
+
+        // Brute force, the acceleration data structures intersect the points individually
+        Ray3f ray(ray_);
+        PreliminaryIntersection3f pi = zero<PreliminaryIntersection3f>();
+        pi.t = math::Infinity<Float>;
+
+        for (ScalarIndex i = 0; i < m_point_count; ++i) {
+            PreliminaryIntersection3f pi_i = ray_intersect_primitive(i, ray, active);
+            Mask hit = pi_i.is_valid();
+            masked(pi.t, hit) = pi_i.t;
+            masked(pi.prim_index, hit) = UInt32(i);
+            masked(ray.maxt, hit) = pi_i.t;
+        }
+
+        pi.shape = this;
+        return pi;
+    }
+
+    Mask ray_test(const Ray3f &ray, Mask active) const override {
+        MTS_MASK_ARGUMENT(active);
+
+        Mask hit = false;
+        for (ScalarIndex i = 0; i < m_point_count && any(active && !hit); ++i)
+            hit |= ray_test_primitive(i, ray, active && !hit);
+        return hit;
+    }
+
+    SurfaceInteraction3f compute_surface_interaction(const Ray3f &ray,
+                                                     PreliminaryIntersection3f pi,
+                                                     HitComputeFlags flags,
+                                                     Mask active) const override {
+        MTS_MASK_ARGUMENT(active);
+
+        active &= pi.is_valid();
+
+        Vector4f c = point(pi.prim_index, active);
+        Point3f center = head<3>(c);
+        Float radius = c.w();
+
+        SurfaceInteraction3f si = zero<SurfaceInteraction3f>();
+        si.t = select(active, pi.t, math::Infinity<Float>);
+        si.p = ray(pi.t);
+
+        Vector3f rel = si.p - center;
+        if (m_disk) {
+            si.n = -normalize(ray.d);
+
+            // Polar coordinates within the disk
+            auto [s1, s2] = coordinate_system(si.n);
+            Float r   = norm(rel),
+                  phi = atan2(dot(rel, s2), dot(rel, s1));
+            masked(phi, phi < 0.f) += 2.f * math::Pi<Float>;
+            si.uv = Point2f(r / radius, phi * math::InvTwoPi<Float>);
+
+            if (has_flag(flags, HitComputeFlags::dPdUV)) {
+                auto [sin_phi, cos_phi] = sincos(phi);
+                si.dp_du = (s1 * cos_phi + s2 * sin_phi) * radius;
+                si.dp_dv = (s2 * cos_phi - s1 * sin_phi) * (2.f * math::Pi<Float> * r);
+            }
+        } else {
+            si.n = normalize(rel);
+
+            // Re-project onto the sphere to improve accuracy
+            si.p = fmadd(si.n, radius, center);
+
+            // Spherical coordinates with respect to the world axes
+            Float rd_2  = sqr(si.n.x()) + sqr(si.n.y()),
+                  theta = unit_angle_z(si.n),
+                  phi   = atan2(si.n.y(), si.n.x());
+            masked(phi, phi < 0.f) += 2.f * math::Pi<Float>;
+            si.uv = Point2f(phi * math::InvTwoPi<Float>, theta * math::InvPi<Float>);
+
+            if (has_flag(flags, HitComputeFlags::dPdUV)) {
+                Float rd      = sqrt(rd_2),
+                      inv_rd  = rcp(rd),
+                      cos_phi = si.n.x() * inv_rd,
+                      sin_phi = si.n.y() * inv_rd;
+
+                si.dp_du = Vector3f(-si.n.y(), si.n.x(), 0.f) *
+                           (2.f * math::Pi<Float> * radius);
+                si.dp_dv = Vector3f(si.n.z() * cos_phi, si.n.z() * sin_phi, -rd) *
+                           (math::Pi<Float> * radius);
+
+                Mask singularity_mask = active && eq(rd, 0.f);
+                if (unlikely(any(singularity_mask)))
+                    si.dp_dv[singularity_mask] = Vector3f(1.f, 0.f, 0.f);
+            }
+        }
+
+        if (!has_flag(flags, HitComputeFlags::dPdUV))
+            std::tie(si.dp_du, si.dp_dv) = coordinate_system(si.n);
+
+        si.sh_frame.n = si.n;
+        si.time = ray.time;
+
+        if (has_flag(flags, HitComputeFlags::dNSdUV)) {
+            si.dn_du = si.dn_dv = zero<Vector3f>();
+            if (!m_disk) {
+                si.dn_du = si.dp_du / radius;
+                si.dn_dv = si.dp_dv / radius;
+            }
+        }
+
+        return si;
+    }
+
+    //! @}
+    // =============================================================
+
+    // =============================================================
+    //! @{ \name Miscellaneous query routines
+    // =============================================================
+
+    ScalarBoundingBox3f bbox() const override { return m_bbox; }
+
+    ScalarBoundingBox3f bbox(ScalarIndex index) const override {
+        ScalarVector4f c = point(index);
+        ScalarPoint3f center = head<3>(c);
+        return ScalarBoundingBox3f(center - c.w(), center + c.w());
+    }
+
+    ScalarFloat surface_area() const override { return m_surface_area; }
+
+    ScalarSize primitive_count() const override { return m_point_count; }
+
+    ScalarSize effective_primitive_count() const override { return m_point_count; }
+
+    //! @}
+    // =============================================================
+
+#if defined(MTS_ENABLE_EMBREE) && RTC_VERSION >= 30900
+    /* The points map onto Embree's native point primitives, which share the
+       packed centers and radii and avoid the user geometry callbacks */
+    RTCGeometry embree_geometry(RTCDevice device) override {
+        if constexpr (!is_cuda_array_v<Float>) {
+            RTCGeometry geom = rtcNewGeometry(device, m_disk ? RTC_GEOMETRY_TYPE_DISC_POINT
+                                                             : RTC_GEOMETRY_TYPE_SPHERE_POINT);
+            rtcSetSharedGeometryBuffer(geom, RTC_BUFFER_TYPE_VERTEX, 0, RTC_FORMAT_FLOAT4,
+                                       m_points.data(), 0, 4 * sizeof(InputFloat),
+                                       m_point_count);
+            rtcCommitGeometry(geom);
+            return geom;
+        } else {
+            Throw("embree_geometry() should only be called in CPU mode.");
+        }
+    }
+#endif
+
+    std::string to_string() const override {
+        std::ostringstream oss;
+        oss << "PointCloud[" << std::endl
+            << "  name = \"" << m_name << "\"," << std::endl
+            << "  mode = " << (m_disk ? "disk" : "sphere") << "," << std::endl
+            << "  point_count = " << m_point_count << "," << std::endl
+            << "  points = [" << util::mem_string(m_point_count * 4 * sizeof(InputFloat))
+            << " of point data]," << std::endl
+            << "  surface_area = " << m_surface_area << "," << std::endl
+            << "  " << string::indent(get_children_string()) << std::endl
+            << "]";
+        return oss.str();
+    }
+
+    MTS_DECLARE_CLASS()
+private:
+    std::string m_name;
+    ScalarBoundingBox3f m_bbox;
+
+    /// World-space centers and radii (4 values per point)
+    FloatStorage m_points;
+    ScalarSize m_point_count = 0;
+    ScalarFloat m_surface_area = 0.f;
+
+    bool m_disk;
+};
+
+MTS_IMPLEMENT_CLASS_VARIANT(PointCloud, Shape)
+MTS_EXPORT_PLUGIN(PointCloud, "Point cloud");
+NAMESPACE_END(mitsuba)
@@ -1,9 +1,16 @@
 #include <mitsuba/render/mesh.h>
 #include <mitsuba/core/fstream.h>
+#include <mitsuba/core/mmap.h>
+#include <mitsuba/core/mstream.h>
+#include <mitsuba/core/profiler.h>
 #include <mitsuba/core/zstream.h>
 #include <mitsuba/core/fresolver.h>
 #include <mitsuba/core/properties.h>
 #include <mitsuba/core/timer.h>
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -28,10 +35,30 @@ Serialized mesh loader (:monosp:`serialized`)
    - When set to |true|, any existing or computed vertex normals are
      discarded and \emph{face normals} will instead be used during rendering.
      This gives the rendered object a faceted appearance.(Default: |false|)
+ * - compress
+   - |bool|
+   - Store the mesh in a compact quantized representation (21 bit positions
+     relative to the bounding box, octahedral normals and half precision
+     texture coordinates). This roughly halves the memory usage of large meshes
+     at a small cost in precision. Only supported by the native CPU ray
+     tracing backend. (Default: |false|)
+ * - alias_sampling
+   - |bool|
+   - Sample faces (e.g. of area emitters) using an alias table, which takes constant time
+     instead of a binary search over the face areas. (Default: |false|)
  * - to_world
    - |transform|
    - Specifies an optional linear object-to-world transformation.
      (Default: none, i.e. object space = world space)
+ * - keyframes
+   - |string|
+   - Optional comma-separated list of files containing further keyframes of
+     the vertex positions for deformation motion blur. They must share the
+     topology of the main file and are spaced evenly in time, with linear
+     interpolation in between. (Default: none)
+ * - motion_start, motion_end
+   - |float|
+   - Time interval spanned by the main file and the keyframes. (Default: 0 and 1)
 
 The serialized mesh format represents the most space and time-efficient way
 of getting geometry information into Mitsuba 2. It stores indexed triangle meshes
@@ -59,11 +86,13 @@ follows:
         * - :monosp:`uint16`
           - File format identifier: :code:`0x041C`
         * - :monosp:`uint16`
-          - File version identifier. Currently set to :code:`0x0004`
+          - File version identifier. Currently set to :code:`0x0004` or :code:`0x0005`
         * - :math:`\rightarrow`
           - From this point on, the stream is compressed by the :monosp:`DEFLATE` algorithm.
         * - :math:`\rightarrow`
-          - The used encoding is that of the :monosp:`zlib` library.
+          - The used encoding is that of the :monosp:`zlib` library. Version :code:`0x0005`
+            instead splits the remainder into independently compressed blocks that are
+            decompressed in parallel (see below).
         * - :monosp:`uint32`
           - An 32-bit integer whose bits can be used to specify the following flags:
 
@@ -97,6 +126,17 @@ follows:
             :monosp:`uint32` or in :monosp:`uint64` format (the latter is used when the number of
             vertices exceeds :code:`0xFFFFFFFF`).
 
+Block compression
+*****************
+
+In version :code:`0x0005` files, the mesh data following the uncompressed header is
+stored in a container of independently compressed blocks: a :monosp:`uint32` codec
+identifier (:code:`0`: stored, :code:`1`: :monosp:`zlib`), the :monosp:`uint32`
+number of blocks, the :monosp:`uint64` uncompressed size, the :monosp:`uint64`
+uncompressed block size, the :monosp:`uint64` compressed size of every block and
+finally the block contents. The uncompressed contents are identical to those
+of version :code:`0x0004`.
+
 Multiple shapes
 ***************
 
@@ -106,6 +146,8 @@ where every one is structured according to the above description.
 Hence, after each mesh, the stream briefly reverts back to an
 uncompressed format, followed by an uncompressed header, and so on.
 This is neccessary for efficient read access to arbitrary sub-meshes.
+When many sub-meshes are loaded from the same file, it is opened and indexed
+only once, and the sub-meshes are decompressed in parallel.
 
 End-of-file dictionary
 **********************
@@ -137,6 +179,127 @@ at the end of the file, which specifies the starting position of each sub-mesh:
 #define MTS_FILEFORMAT_HEADER     0x041C
 #define MTS_FILEFORMAT_VERSION_V3 0x0003
 #define MTS_FILEFORMAT_VERSION_V4 0x0004
+#define MTS_FILEFORMAT_VERSION_V5 0x0005
+
+/**
+ * \brief Memory-mapped .serialized file along with its end-of-file dictionary
+ *
+ * Instances are cached and shared by all shapes that reference the same
+ * file, which is therefore only opened and indexed once even when thousands
+ * of sub-meshes are loaded from it. The shapes themselves are instantiated
+ * in parallel by the scene loader and inflate their data concurrently from
+ * the read-only mapping.
+ */
+class SerializedFile {
+public:
+    SerializedFile(const fs::path &path) {
+        m_mmap = new MemoryMappedFile(path);
+        m_size = m_mmap->size();
+
+        ref<MemoryStream> stream = new MemoryStream(m_mmap->data(), m_size);
+        stream->set_byte_order(Stream::ELittleEndian);
+
+        short format = 0;
+        stream->read(format);
+        stream->read(m_version);
+
+        if (format != MTS_FILEFORMAT_HEADER)
+            Throw("encountered an invalid file format!");
+
+        if (m_version != MTS_FILEFORMAT_VERSION_V3 &&
+            m_version != MTS_FILEFORMAT_VERSION_V4 &&
+            m_version != MTS_FILEFORMAT_VERSION_V5)
+            Throw("encountered an incompatible file version!");
+
+        /* Read the positions of all substreams, which are stored at the end
+           of the file. The first mesh always starts at the beginning. */
+        m_offsets.push_back(0);
+
+        uint32_t count = 0;
+        stream->seek(m_size - sizeof(uint32_t));
+        stream->read(count);
+
+        size_t offset_size = m_version == MTS_FILEFORMAT_VERSION_V3 ? sizeof(uint32_t)
+                                                                    : sizeof(uint64_t);
+        if (count == 0 || (size_t) count * offset_size + sizeof(uint32_t) > m_size)
+            return; // No valid dictionary, only the first mesh can be accessed
+
+        stream->seek(m_size - offset_size * count - sizeof(uint32_t));
+        m_offsets.resize(count);
+        for (uint32_t i = 0; i < count; ++i) {
+            if (m_version != MTS_FILEFORMAT_VERSION_V3) {
+                uint64_t offset = 0;
+                stream->read(offset);
+                m_offsets[i] = offset;
+            } else {
+                uint32_t offset = 0;
+                stream->read(offset);
+                m_offsets[i] = offset;
+            }
+        }
+        m_offsets[0] = 0;
+    }
+
+    /// Return the cached index of the given file, creating it if necessary
+    static std::shared_ptr<SerializedFile> open(const fs::path &path) {
+        /// Maximum number of files kept open by the cache
+        constexpr size_t max_cached_files = 8;
+
+        static std::mutex mutex;
+        static std::unordered_map<std::string,
+                                  std::pair<std::shared_ptr<SerializedFile>, size_t>> cache;
+        static size_t timestamp = 0;
+
+        std::string key = fs::absolute(path).string();
+        size_t size = fs::file_size(path);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = cache.find(key);
+        // A modified file is detected by a change of its size
+        if (it != cache.end() && it->second.first->m_size == size) {
+            it->second.second = ++timestamp;
+            return it->second.first;
+        }
+
+        auto file = std::make_shared<SerializedFile>(path);
+        cache[key] = { file, ++timestamp };
+
+        // Evict the least recently used file
+        if (cache.size() > max_cached_files) {
+            auto lru = std::min_element(cache.begin(), cache.end(),
+                [](const auto &a, const auto &b) { return a.second.second < b.second.second; });
+            cache.erase(lru);
+        }
+
+        return file;
+    }
+
+    /// Return a stream positioned at the compressed contents of the given mesh
+    ref<Stream> shape_stream(uint32_t index) const {
+        if (index >= m_offsets.size())
+            Throw("Unable to unserialize mesh, shape index is out of range! "
+                  "(requested %i out of 0..%i)", index, m_offsets.size() - 1);
+
+        // Skip the uncompressed header
+        size_t offset = m_offsets[index] + sizeof(short) * 2;
+        if (offset > m_size)
+            Throw("invalid offset of mesh %i in the end-of-file dictionary!", index);
+
+        ref<Stream> stream =
+            new MemoryStream((uint8_t *) m_mmap->data() + offset, m_size - offset);
+        stream->set_byte_order(Stream::ELittleEndian);
+        return stream;
+    }
+
+    /// Return the file format version
+    short version() const { return m_version; }
+
+private:
+    ref<MemoryMappedFile> m_mmap;
+    size_t m_size = 0;
+    short m_version = 0;
+    std::vector<uint64_t> m_offsets;
+};
 
 template <typename Float, typename Spectrum>
 class SerializedMesh final : public Mesh<Float, Spectrum> {
@@ -144,7 +307,8 @@ public:
     MTS_IMPORT_BASE(Mesh,m_name, m_bbox, m_to_world, m_vertex_count, m_face_count,
                     m_vertex_positions_buf, m_vertex_normals_buf, m_vertex_texcoords_buf,
                     m_faces_buf, m_disable_vertex_normals, has_vertex_normals, has_vertex_texcoords,
-                    recompute_vertex_normals, vertex_position, vertex_normal, set_children)
+                    recompute_vertex_normals, vertex_position, vertex_normal, m_compress,
+                    compress, load_keyframes, set_children)
     MTS_IMPORT_TYPES()
 
     using typename Base::ScalarSize;
@@ -172,6 +336,8 @@ public:
     }
 
     SerializedMesh(const Properties &props) : Base(props) {
+        ScopedPhase sp(ProfilerPhase::LoadGeometry);
+
         auto fail = [&](const std::string &descr) {
             Throw("Error while loading serialized file \"%s\": %s!", m_name, descr);
         };
@@ -191,61 +357,27 @@ public:
 
         m_name = tfm::format("%s@%i", file_path.filename(), shape_index);
 
-        ref<Stream> stream = new FileStream(file_path);
         Timer timer;
-        stream->set_byte_order(Stream::ELittleEndian);
-
-        short format = 0, version = 0;
-        stream->read(format);
-        stream->read(version);
-
-        if (format != MTS_FILEFORMAT_HEADER)
-            fail("encountered an invalid file format!");
-
-        if (version != MTS_FILEFORMAT_VERSION_V3 &&
-            version != MTS_FILEFORMAT_VERSION_V4)
-            fail("encountered an incompatible file version!");
-
-        if (shape_index != 0) {
-            size_t file_size = stream->size();
-
-            /* Determine the position of the requested substream. This
-               is stored at the end of the file */
-            stream->seek(file_size - sizeof(uint32_t));
-
-            uint32_t count = 0;
-            stream->read(count);
-
-            if (shape_index > (int) count)
-                fail(tfm::format("Unable to unserialize mesh, shape index is "
-                                 "out of range! (requested %i out of 0..%i)",
-                                 shape_index, count - 1));
-
-            // Seek to the correct position
-            if (version == MTS_FILEFORMAT_VERSION_V4) {
-                stream->seek(file_size -
-                             sizeof(uint64_t) * (count - shape_index) -
-                             sizeof(uint32_t));
-                size_t offset = 0;
-                stream->read(offset);
-                stream->seek(offset);
-            } else {
-                Assert(version == MTS_FILEFORMAT_VERSION_V3);
-                stream->seek(file_size -
-                             sizeof(uint32_t) * (count - shape_index + 1));
-                uint32_t offset = 0;
-                stream->read(offset);
-                stream->seek(offset);
-            }
-            stream->skip(sizeof(short) * 2); // Skip the header
+        ref<Stream> stream;
+        short version = 0;
+        try {
+            std::shared_ptr<SerializedFile> file = SerializedFile::open(file_path);
+            stream = file->shape_stream((uint32_t) shape_index);
+            version = file->version();
+        } catch (const std::exception &e) {
+            fail(e.what());
         }
 
-        stream = new ZStream(stream);
+        // Version 5 files store each mesh as independently compressed blocks
+        if (version == MTS_FILEFORMAT_VERSION_V5)
+            stream = compression::read_blocks(stream);
+        else
+            stream = new ZStream(stream);
         stream->set_byte_order(Stream::ELittleEndian);
 
         uint32_t flags = 0;
         stream->read(flags);
-        if (version == MTS_FILEFORMAT_VERSION_V4) {
+        if (version >= MTS_FILEFORMAT_VERSION_V4) {
             char ch = 0;
             m_name = "";
             do {
@@ -335,6 +467,11 @@ public:
                 util::time_string(timer2.value()));
         }
 
+        load_keyframes(props);
+
+        if (m_compress)
+            compress();
+
         set_children();
     }
 
@@ -15,6 +15,24 @@ Shape group (:monosp:`shapegroup`)
  * - (Nested plugin)
    - :paramtype:`shape`
    - One or more shapes that should be made available for geometry instancing
+ * - lod_1, lod_2, ...
+   - :paramtype:`shapegroup`
+   - Optional coarser levels of detail of the group's geometry (see below)
+ * - lod_threshold
+   - |float|
+   - Ray footprint in local units (e.g. the edge length of a triangle of the
+     full-resolution geometry) at which :monosp:`lod_1` is used. Every following
+     level is used for a footprint that is twice as large. Required when levels of
+     detail are specified.
+ * - lod_spread
+   - |float|
+   - Angle (in radians) subtended by a ray, from which its footprint at a given
+     distance is estimated. Should match the angle of a pixel of the sensor, e.g.
+     its field of view divided by the film width. (Default: 0.001)
+ * - lod_blend
+   - |bool|
+   - Choose the level of each ray stochastically between the two nearest ones to
+     hide the transitions between them. (Default: |true|)
 
 This plugin implements a container for shapes that should be made available for geometry instancing.
 Any shapes placed in a shapegroup will not be visible on their own—instead, the renderer will
@@ -54,6 +72,38 @@ where only a few distinct types of trees have to be kept in memory. An example i
         </transform>
     </shape>
 
+**Levels of detail**: distant instances of detailed geometry (e.g. trees in a
+landscape) can have many triangles per pixel, which makes them expensive to
+intersect without any visible benefit. A shape group can therefore carry
+coarser versions of its geometry as nested shape groups named
+:monosp:`lod_1`, :monosp:`lod_2`, and so on. The level of every ray is chosen
+from its footprint where it enters the bounding box of the instance, which is
+estimated from the angular spread :paramtype:`lod_spread` and the distance
+traveled by the ray. To keep shading consistent, all levels should share the
+same BSDFs. Levels of detail are only supported by the built-in kd-tree (i.e.
+not with Embree or OptiX), which otherwise always use the full-resolution
+geometry.
+
+.. code-block:: xml
+
+    <shape type="shapegroup" id="tree">
+        <float name="lod_threshold" value="0.01"/>
+        <float name="lod_spread" value="0.0008"/>
+        <shape type="ply">
+            <string name="filename" value="tree.ply"/>
+        </shape>
+        <shape type="shapegroup" name="lod_1">
+            <shape type="ply">
+                <string name="filename" value="tree_lod1.ply"/>
+            </shape>
+        </shape>
+        <shape type="shapegroup" name="lod_2">
+            <shape type="ply">
+                <string name="filename" value="tree_lod2.ply"/>
+            </shape>
+        </shape>
+    </shape>
+
  */
 
 template <typename Float, typename Spectrum>
@@ -1,6 +1,7 @@
 #include <mitsuba/core/fwd.h>
 #include <mitsuba/core/math.h>
 #include <mitsuba/core/properties.h>
+#include <mitsuba/core/string.h>
 #include <mitsuba/core/transform.h>
 #include <mitsuba/core/util.h>
 #include <mitsuba/core/warp.h>
@@ -410,7 +411,11 @@ public:
         Base::traverse(callback);
     }
 
-    void parameters_changed(const std::vector<std::string> &/*keys*/) override {
+    void parameters_changed(const std::vector<std::string> &keys) override {
+        // Updates of the BSDF, emitter, etc. leave the geometry unchanged
+        if (!keys.empty() && !string::contains(keys, "to_world"))
+            return;
+
         update();
         Base::parameters_changed();
 #if defined(MTS_ENABLE_OPTIX)
@@ -418,6 +423,31 @@ public:
 #endif
     }
 
+#if defined(MTS_ENABLE_EMBREE) && RTC_VERSION >= 30900
+    /* Spheres map onto Embree's native point spheres, which avoids the user
+       geometry callbacks (and virtual function calls) per candidate */
+    RTCGeometry embree_geometry(RTCDevice device) override {
+        if constexpr (!is_cuda_array_v<Float>) {
+            RTCGeometry geom = rtcNewGeometry(device, RTC_GEOMETRY_TYPE_SPHERE_POINT);
+            rtcSetNewGeometryBuffer(geom, RTC_BUFFER_TYPE_VERTEX, 0, RTC_FORMAT_FLOAT4,
+                                    4 * sizeof(float), 1);
+            embree_update_geometry(geom);
+            return geom;
+        } else {
+            Throw("embree_geometry() should only be called in CPU mode.");
+        }
+    }
+
+    void embree_update_geometry(RTCGeometry geom) override {
+        float *data = (float *) rtcGetGeometryBufferData(geom, RTC_BUFFER_TYPE_VERTEX, 0);
+        for (size_t i = 0; i < 3; ++i)
+            data[i] = (float) m_center[i];
+        data[3] = (float) m_radius;
+        rtcUpdateGeometryBuffer(geom, RTC_BUFFER_TYPE_VERTEX, 0);
+        rtcCommitGeometry(geom);
+    }
+#endif
+
 #if defined(MTS_ENABLE_OPTIX)
     using Base::m_optix_data_ptr;
 
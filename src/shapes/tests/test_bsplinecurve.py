@@ -0,0 +1,71 @@
+import mitsuba
+import pytest
+import enoki as ek
+
+
+def write_strands(tmpdir, texcoords=False):
+    # Two straight strands along the X axis (at y = 0 and y = 2)
+    lines = ['# x y z radius [u v]']
+    for y in [0, 2]:
+        for x in range(5):
+            lines.append('%i %i 0 0.1%s' % (x, y, ' 0.25 0.75' if texcoords else ''))
+        lines.append('')
+    filename = str(tmpdir.join('strands.txt'))
+    with open(filename, 'w') as f:
+        f.write('\n'.join(lines))
+    return filename
+
+
+def test01_create(variant_scalar_rgb, tmpdir):
+    from mitsuba.core import xml
+
+    s = xml.load_dict({"type" : "bsplinecurve", "filename" : write_strands(tmpdir)})
+    assert s is not None
+    assert s.primitive_count() == 4
+
+    b = s.bbox()
+    assert ek.allclose(b.min, [-0.1, -0.1, -0.1])
+    assert ek.allclose(b.max, [4.1, 2.1, 0.1])
+
+
+def test02_ray_intersect(variant_scalar_rgb, tmpdir):
+    from mitsuba.core import xml, Ray3f
+
+    filename = write_strands(tmpdir)
+    for flat in [False, True]:
+        s = xml.load_dict({"type" : "bsplinecurve", "filename" : filename,
+                           "flat" : flat})
+
+        # The curve spans x in [1, 3] since it doesn't pass through the end points
+        ray = Ray3f(o=[2.5, 0.05, 5], d=[0, 0, -1], time=0.0, wavelengths=[])
+        si = s.ray_intersect(ray)
+        assert si.is_valid()
+        t = 5 if flat else 5 - ek.sqrt(0.1**2 - 0.05**2)
+        assert ek.allclose(si.t, t, atol=1e-4)
+        assert ek.allclose(si.uv[0], 0.75, atol=1e-4)
+        assert ek.allclose(si.n, [0, 0, 1] if flat else [0, 0.5, ek.sqrt(0.75)],
+                           atol=1e-3)
+
+        # Missing the tube and the end of the curve
+        assert not s.ray_test(Ray3f(o=[2.5, 0.15, 5], d=[0, 0, -1], time=0.0,
+                                    wavelengths=[]))
+        assert not s.ray_test(Ray3f(o=[0.5, 0, 5], d=[0, 0, -1], time=0.0,
+                                    wavelengths=[]))
+
+
+def test03_scene_texcoords(variant_scalar_rgb, tmpdir):
+    from mitsuba.core import xml, Ray3f
+
+    scene = xml.load_dict({
+        "type" : "scene",
+        "curves" : {"type" : "bsplinecurve",
+                    "filename" : write_strands(tmpdir, texcoords=True)}
+    })
+
+    ray = Ray3f(o=[1.5, 2, 5], d=[0, 0, -1], time=0.0, wavelengths=[])
+    si = scene.ray_intersect(ray)
+    assert si.is_valid()
+    assert ek.allclose(si.t, 4.9, atol=1e-3)
+    assert ek.allclose(si.p, [1.5, 2, 0.1], atol=1e-3)
+    assert ek.allclose(si.uv, [0.25, 0.75])
+    assert scene.ray_test(ray)
@@ -0,0 +1,78 @@
+import mitsuba
+import pytest
+import enoki as ek
+
+
+def write_square(tmpdir):
+    # Unit square in the XY plane facing +Z, with normals and texture coordinates
+    lines = ['v 0 0 0', 'v 1 0 0', 'v 1 1 0', 'v 0 1 0',
+             'vt 0 0', 'vt 1 0', 'vt 1 1', 'vt 0 1',
+             'vn 0 0 1',
+             'f 1/1/1 2/2/1 3/3/1', 'f 1/1/1 3/3/1 4/4/1']
+    filename = str(tmpdir.join('square.obj'))
+    with open(filename, 'w') as f:
+        f.write('\n'.join(lines) + '\n')
+    return filename
+
+
+def create(tmpdir, **kwargs):
+    from mitsuba.core import xml
+
+    d = {
+        'type' : 'scene',
+        'shape' : dict({
+            'type' : 'displaced',
+            'mesh' : { 'type' : 'obj', 'filename' : write_square(tmpdir) },
+            'displacement' : 0.5,
+        }, **kwargs)
+    }
+    return xml.load_dict(d)
+
+
+def test01_create(variant_scalar_rgb, tmpdir):
+    scene = create(tmpdir)
+    s = scene.shapes()[0]
+    assert s.primitive_count() == 2
+    assert ek.allclose(s.surface_area(), 1.0)
+
+    # The bounds are expanded by the maximum displacement
+    b = s.bbox()
+    assert ek.allclose(b.min, [-1, -1, -1])
+    assert ek.allclose(b.max, [2, 2, 1])
+
+
+def test02_ray_intersect(variant_scalar_rgb, tmpdir):
+    from mitsuba.core import Ray3f
+
+    for max_level in [0, 3, 8]:
+        scene = create(tmpdir, max_level=max_level)
+
+        # The surface is displaced by 0.5 along the normal
+        for x, y in [[0.3, 0.4], [0.9, 0.05], [0.5, 0.5]]:
+            ray = Ray3f([x, y, 2], [0, 0, -1], 0.0, [])
+            si = scene.ray_intersect(ray)
+            assert si.is_valid()
+            assert ek.allclose(si.t, 1.5)
+            assert ek.allclose(si.p, [x, y, 0.5])
+            assert ek.allclose(si.n, [0, 0, 1])
+            assert ek.allclose(si.uv, [x, y], atol=1e-5)
+            assert scene.ray_test(ray)
+
+        # Rays outside of the mesh miss the displaced surface
+        ray = Ray3f([1.5, 0.5, 2], [0, 0, -1], 0.0, [])
+        assert not scene.ray_intersect(ray).is_valid()
+        assert not scene.ray_test(ray)
+
+        # Rays that stop above the displaced surface
+        ray = Ray3f([0.5, 0.5, 2], [0, 0, -1], 0.0, 1.4, 0.0, [])
+        assert not scene.ray_test(ray)
+
+
+def test03_error(variant_scalar_rgb, tmpdir):
+    from mitsuba.core import xml
+
+    with pytest.raises(RuntimeError, match='.*nested mesh must be specified.*'):
+        xml.load_dict({ 'type' : 'displaced', 'displacement' : 0.5 })
+
+    with pytest.raises(RuntimeError, match='.*must be at most 10.*'):
+        create(tmpdir, max_level=11)
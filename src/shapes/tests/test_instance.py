@@ -205,3 +205,45 @@ def test03_ray_intersect_instance(variants_all_rgb):
     ray = Ray3f([0.5, 0.5, -12], [0.0, 0.0, 1.0], 0.0, [])
     pi = scene.ray_intersect_preliminary(ray)
     assert 'instance = nullptr' in str(pi) or 'instance = [nullptr]' in str(pi)
+
+
+def test04_instance_tight_bbox(variant_scalar_rgb):
+    from mitsuba.core import xml, Ray3f, ScalarTransform4f as T
+
+    """Rotated instances should be bounded by their transformed contents"""
+
+    scene = xml.load_dict({
+        'type' : 'scene',
+
+        'group_0' : {
+            'type' : 'shapegroup',
+            'shape_0' : {
+                'type' : 'rectangle',
+                'to_world' : T.translate([1, 1, 0]) * T.scale(0.5)
+            },
+            'shape_1' : {
+                'type' : 'rectangle',
+                'to_world' : T.translate([-1, -1, 0]) * T.scale(0.5)
+            }
+        },
+
+        'instance' : {
+            'type' : 'instance',
+            "group" : {
+                "type" : "ref",
+                "id" : "group_0"
+            },
+            'to_world' : T.rotate([0, 0, 1], 45)
+        }
+    })
+
+    bbox = scene.bbox()
+    # Transforming the corners of the group bbox would yield [-2.12, 2.12]
+    assert ek.allclose(bbox.min.x, -0.5 * 2**0.5, atol=1e-5)
+    assert ek.allclose(bbox.max.x, 0.5 * 2**0.5, atol=1e-5)
+    assert ek.allclose(bbox.max.y, 1.5 * 2**0.5, atol=1e-5)
+
+    ray = Ray3f([0, 2**0.5, -1], [0, 0, 1], 0.0, [])
+    assert scene.ray_test(ray)
+    ray = Ray3f([1, 0, -1], [0, 0, 1], 0.0, [])
+    assert not scene.ray_test(ray)
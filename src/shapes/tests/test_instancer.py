@@ -0,0 +1,88 @@
+import mitsuba
+import enoki as ek
+
+
+def write_instances(tmpdir):
+    # Three instances along the X axis, the second one is scaled by 2
+    lines = ['ply', 'format ascii 1.0', 'element vertex 3',
+             'property float x', 'property float y', 'property float z',
+             'property float xaxis_x', 'property float xaxis_y', 'property float xaxis_z',
+             'property float yaxis_x', 'property float yaxis_y', 'property float yaxis_z',
+             'property float zaxis_x', 'property float zaxis_y', 'property float zaxis_z',
+             'property float r', 'property float g', 'property float b',
+             'property int id', 'end_header']
+    for i in range(3):
+        s = 2 if i == 1 else 1
+        lines.append('%i 0 0 %i 0 0 0 %i 0 0 0 %i %g 0.5 0 %i' % (i * 4, s, s, s, 0.5 * i, 10 + i))
+    filename = str(tmpdir.join('instances.ply'))
+    with open(filename, 'w') as f:
+        f.write('\n'.join(lines) + '\n')
+    return filename
+
+
+def example_scene(filename):
+    from mitsuba.core import xml
+
+    return xml.load_dict({
+        'type' : 'scene',
+        'group' : {
+            'type' : 'shapegroup',
+            'shape' : { 'type' : 'sphere' }
+        },
+        'instancer' : {
+            'type' : 'instancer',
+            'group' : { 'type' : 'ref', 'id' : 'group' },
+            'filename' : filename
+        }
+    })
+
+
+def test01_create(variant_scalar_rgb, tmpdir):
+    scene = example_scene(write_instances(tmpdir))
+
+    b = scene.bbox()
+    assert ek.allclose(b.min, [-1, -2, -2])
+    assert ek.allclose(b.max, [9, 2, 2])
+
+    shapes = scene.shapes()
+    assert len(shapes) == 1
+    assert shapes[0].is_instancer()
+    assert shapes[0].primitive_count() == 3
+
+
+def test02_ray_intersect(variant_scalar_rgb, tmpdir):
+    from mitsuba.core import Ray3f
+
+    scene = example_scene(write_instances(tmpdir))
+
+    for i in range(3):
+        s = 2 if i == 1 else 1
+        ray = Ray3f(o=[i * 4, 0, 5], d=[0, 0, -1], time=0.0, wavelengths=[])
+        si = scene.ray_intersect(ray)
+        assert si.is_valid()
+        assert ek.allclose(si.t, 5 - s)
+        assert ek.allclose(si.p, [i * 4, 0, s])
+        assert ek.allclose(si.n, [0, 0, 1])
+
+        # Off-center ray that only hits the scaled instance
+        ray = Ray3f(o=[i * 4 + 1.5, 0, 5], d=[0, 0, -1], time=0.0, wavelengths=[])
+        assert scene.ray_test(ray) == (i == 1)
+
+    ray = Ray3f(o=[6.5, 0, 5], d=[0, 0, -1], time=0.0, wavelengths=[])
+    assert not scene.ray_intersect(ray).is_valid()
+
+
+def test03_instance_attributes(variant_scalar_rgb, tmpdir):
+    from mitsuba.core import xml, Ray3f
+
+    scene = example_scene(write_instances(tmpdir))
+
+    color = xml.load_dict({ 'type' : 'mesh_attribute', 'name' : 'instance_color' })
+    ident = xml.load_dict({ 'type' : 'mesh_attribute', 'name' : 'instance_id' })
+
+    for i in range(3):
+        ray = Ray3f(o=[i * 4, 0, 5], d=[0, 0, -1], time=0.0, wavelengths=[])
+        si = scene.ray_intersect(ray)
+        assert si.instance_index == i
+        assert ek.allclose(color.eval(si), [0.5 * i, 0.5, 0])
+        assert ek.allclose(ident.eval_1(si), 10 + i)
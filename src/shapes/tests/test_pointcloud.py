@@ -0,0 +1,74 @@
+import mitsuba
+import pytest
+import enoki as ek
+
+
+def write_points(tmpdir, radii=True):
+    # Three points along the X axis, with radii 0.1, 0.2 and 0.3
+    lines = ['ply', 'format ascii 1.0', 'element vertex 3',
+             'property float x', 'property float y', 'property float z']
+    if radii:
+        lines.append('property float radius')
+    lines.append('end_header')
+    for i in range(3):
+        lines.append('%i 0 0%s' % (i, ' %g' % (0.1 * (i + 1)) if radii else ''))
+    filename = str(tmpdir.join('points.ply'))
+    with open(filename, 'w') as f:
+        f.write('\n'.join(lines) + '\n')
+    return filename
+
+
+def test01_create(variant_scalar_rgb, tmpdir):
+    from mitsuba.core import xml
+
+    s = xml.load_dict({"type" : "pointcloud", "filename" : write_points(tmpdir)})
+    assert s is not None
+    assert s.primitive_count() == 3
+    assert ek.allclose(s.surface_area(), 4 * ek.pi * (0.01 + 0.04 + 0.09))
+
+    b = s.bbox()
+    assert ek.allclose(b.min, [-0.1, -0.3, -0.3])
+    assert ek.allclose(b.max, [2.3, 0.3, 0.3])
+
+    # Without per-point radii, the 'radius' parameter is used for all points
+    s = xml.load_dict({"type" : "pointcloud", "radius" : 0.5,
+                       "filename" : write_points(tmpdir, radii=False)})
+    assert ek.allclose(s.bbox().max, [2.5, 0.5, 0.5])
+
+
+def test02_ray_intersect(variant_scalar_rgb, tmpdir):
+    from mitsuba.core import xml, Ray3f
+
+    filename = write_points(tmpdir)
+    for mode in ['sphere', 'disk']:
+        scene = xml.load_dict({
+            "type" : "scene",
+            "points" : {"type" : "pointcloud", "filename" : filename, "mode" : mode}
+        })
+
+        for i in range(3):
+            r = 0.1 * (i + 1)
+            ray = Ray3f(o=[i, r / 2, 5], d=[0, 0, -1], time=0.0, wavelengths=[])
+            si = scene.ray_intersect(ray)
+            assert si.is_valid()
+            assert si.prim_index == i
+
+            if mode == 'sphere':
+                z = ek.sqrt(r * r - (r / 2)**2)
+                assert ek.allclose(si.t, 5 - z, atol=1e-4)
+                assert ek.allclose(si.n, [0, 0.5, z / r], atol=1e-4)
+            else:
+                assert ek.allclose(si.t, 5, atol=1e-4)
+                assert ek.allclose(si.n, [0, 0, 1], atol=1e-4)
+
+        # Passing between the points
+        assert not scene.ray_test(Ray3f(o=[0.5, 0, 5], d=[0, 0, -1], time=0.0,
+                                        wavelengths=[]))
+
+
+def test03_invalid_mode(variant_scalar_rgb, tmpdir):
+    from mitsuba.core import xml
+
+    with pytest.raises(RuntimeError):
+        xml.load_dict({"type" : "pointcloud", "filename" : write_points(tmpdir),
+                       "mode" : "cube"})
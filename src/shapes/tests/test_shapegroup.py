@@ -2,6 +2,8 @@ import mitsuba
 import pytest
 import enoki as ek
 
+from mitsuba.python.test.util import fresolver_append_path
+
 def test01_create(variant_scalar_rgb):
     from mitsuba.core import xml, ScalarTransform4f
 
@@ -74,3 +76,101 @@ def test02_error(variant_scalar_rgb):
                 'sensor' : { 'type' : 'perspective' }
             },
         })
+
+
+def test03_lod(variant_scalar_rgb):
+    from mitsuba.core import xml, Ray3f
+
+    scene = xml.load_dict({
+        'type' : 'scene',
+        'group_0' : {
+            'type' : 'shapegroup',
+            'lod_threshold' : 0.01,
+            'lod_spread' : 1e-3,
+            'lod_blend' : False,
+            'shape' : { 'type' : 'sphere', 'radius' : 1.0 },
+            'lod_1' : {
+                'type' : 'shapegroup',
+                'shape' : { 'type' : 'sphere', 'radius' : 0.5 }
+            }
+        },
+        'instance' : {
+            'type' : 'instance',
+            'group' : { 'type' : 'ref', 'id' : 'group_0' }
+        }
+    })
+
+    # Close rays intersect the full-resolution geometry
+    ray = Ray3f([0, 0, -3], [0, 0, 1], 0.0, [])
+    assert ek.allclose(scene.ray_intersect_preliminary(ray).t, 2.0)
+    assert scene.ray_test(ray)
+
+    # Distant rays have a large footprint and use the coarser level
+    ray = Ray3f([0, 0, -1000], [0, 0, 1], 0.0, [])
+    assert ek.allclose(scene.ray_intersect_preliminary(ray).t, 999.5)
+    assert scene.ray_test(ray)
+
+    ray = Ray3f([0.75, 0, -1000], [0, 0, 1], 0.0, [])
+    assert not scene.ray_intersect_preliminary(ray).is_valid()
+    assert not scene.ray_test(ray)
+
+
+def test04_lod_error(variant_scalar_rgb):
+    from mitsuba.core import xml
+
+    with pytest.raises(RuntimeError, match='.*positive "lod_threshold".*'):
+        xml.load_dict({
+            'type' : 'shapegroup',
+            'shape' : { 'type' : 'sphere' },
+            'lod_1' : {
+                'type' : 'shapegroup',
+                'shape' : { 'type' : 'sphere' }
+            }
+        })
+
+    with pytest.raises(RuntimeError, match='.*numbered consecutively.*'):
+        xml.load_dict({
+            'type' : 'shapegroup',
+            'lod_threshold' : 0.01,
+            'shape' : { 'type' : 'sphere' },
+            'lod_2' : {
+                'type' : 'shapegroup',
+                'shape' : { 'type' : 'sphere' }
+            }
+        })
+
+
+@fresolver_append_path
+def test05_deferred_build(variant_scalar_rgb):
+    from mitsuba.core import xml, Ray3f, ScalarTransform4f
+
+    # The kd-trees of the groups are built by the scene, including groups
+    # that are only referenced by an instance
+    scene = xml.load_dict({
+        'type' : 'scene',
+        'accel' : 'kdtree',
+        'group_0' : {
+            'type' : 'shapegroup',
+            'shape' : { 'type' : 'obj', 'filename' : 'resources/data/common/meshes/rectangle.obj' }
+        },
+        'instance_0' : {
+            'type' : 'instance',
+            'group' : { 'type' : 'ref', 'id' : 'group_0' },
+            'to_world' : ScalarTransform4f.translate([-2, 0, 0])
+        },
+        'instance_1' : {
+            'type' : 'instance',
+            'group' : {
+                'type' : 'shapegroup',
+                'shape' : { 'type' : 'sphere', 'radius' : 0.5 }
+            },
+            'to_world' : ScalarTransform4f.translate([2, 0, 0])
+        }
+    })
+
+    ray = Ray3f([-2, 0, -3], [0, 0, 1], 0.0, [])
+    assert ek.allclose(scene.ray_intersect_preliminary(ray).t, 3.0)
+
+    ray = Ray3f([2, 0, -3], [0, 0, 1], 0.0, [])
+    assert ek.allclose(scene.ray_intersect_preliminary(ray).t, 2.5)
+    assert scene.ray_test(ray)
@@ -197,3 +197,28 @@ def test06_differentiable_surface_interaction_ray_backward(variant_gpu_autodiff_
     si = pi.compute_surface_interaction(ray)
     ek.backward(si.t)
     assert ek.allclose(ek.gradient(ray.o), [0, 0, -1])
+
+
+def test07_ray_intersect_connection_flags(variant_scalar_rgb):
+    from mitsuba.core import xml, Ray3f
+    from mitsuba.render import HitComputeFlags
+
+    s = xml.load_dict({"type" : "sphere", "radius" : 2.0})
+    ray = Ray3f(o=[0.3, 0.4, -8], d=[0.0, 0.0, 1.0], time=0.0, wavelengths=[])
+
+    si = s.ray_intersect(ray, HitComputeFlags.All)
+    si_c = s.ray_intersect(ray, HitComputeFlags.Connection)
+    assert ek.allclose(si_c.p, si.p)
+    assert ek.allclose(si_c.n, si.n)
+    assert ek.allclose(si_c.uv, si.uv)
+    assert ek.allclose(si_c.dp_du, [0, 0, 0])
+
+    # Without the position partials, the shading frame is still orthonormal
+    frame = si_c.sh_frame
+    assert ek.allclose(frame.n, si.sh_frame.n)
+    assert ek.allclose(ek.dot(frame.s, frame.n), 0, atol=1e-6)
+    assert ek.allclose(ek.cross(frame.n, frame.s), frame.t)
+    assert ek.allclose(si_c.wi.z(), si.wi.z())
+
+    # Requesting non-differentiable fields does not imply normal partials
+    assert int(HitComputeFlags.AllNonDifferentiable & HitComputeFlags.dNSdUV) == 0
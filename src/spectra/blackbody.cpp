@@ -90,12 +90,12 @@ public:
     }
 
     UnpolarizedSpectrum eval(const SurfaceInteraction3f &si, Mask active) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::TextureEvaluate, active);
+        MTS_MASKED_METHOD(ProfilerPhase::TextureEvaluate, active);
         return eval_impl(si.wavelengths, active);
     }
 
     Wavelength pdf_spectrum(const SurfaceInteraction3f &si, Mask active_) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::TextureEvaluate, active_);
+        MTS_MASKED_METHOD(ProfilerPhase::TextureEvaluate, active_);
 
         if constexpr (is_spectral_v<Spectrum>) {
             mask_t<Wavelength> active = active_;
@@ -148,7 +148,7 @@ public:
     std::pair<Wavelength, UnpolarizedSpectrum>
     sample_spectrum(const SurfaceInteraction3f & /* si */,
                     const Wavelength &sample_, Mask active_) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::TextureSample, active_);
+        MTS_MASKED_METHOD(ProfilerPhase::TextureSample, active_);
 
         using WavelengthMask = mask_t<Wavelength>;
 
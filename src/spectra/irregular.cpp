@@ -13,7 +13,17 @@ Irregular spectrum (:monosp:`irregular`)
 ----------------------------------------
 
 This spectrum returns linearly interpolated reflectance or emission values from *irregularly*
-placed samples.
+placed samples. When the boolean :monosp:`alias_sampling` parameter is set, wavelengths are
+sampled using an alias table over the intervals between the samples instead of a binary search,
+which is faster for finely discretized spectra. (Default: |false|)
+
+Evaluating an irregular spectrum requires a binary search over the sample positions. When the
+integer :monosp:`resample` parameter is set to a value :math:`n > 1`, the data is instead
+resampled at load time onto :math:`n` uniformly spaced wavelengths spanning the same range, and
+the spectrum then behaves like a :ref:`regular <spectrum-regular>` spectrum: evaluation becomes a
+direct lookup followed by a linear interpolation. Since both representations are piecewise
+linear, the maximum deviation from the original data occurs at the original sample positions; it
+is computed exactly and reported in the log. (Default: 0, i.e. disabled)
 
  */
 
@@ -62,6 +72,15 @@ public:
                 wavelengths, values, size
             );
         }
+
+        if (props.bool_("alias_sampling", false))
+            m_distr.set_alias_table(true);
+
+        m_resample = props.size_("resample", 0);
+        if (m_resample == 1)
+            Throw("IrregularSpectrum: 'resample' must either be 0 (disabled) or larger than 1!");
+        if (m_resample > 0)
+            resample();
     }
 
     void traverse(TraversalCallback *callback) override {
@@ -71,13 +90,16 @@ public:
 
     void parameters_changed(const std::vector<std::string> &/*keys*/) override {
         m_distr.update();
+        if (m_resample > 0)
+            resample();
     }
 
     UnpolarizedSpectrum eval(const SurfaceInteraction3f &si, Mask active) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::TextureEvaluate, active);
+        MTS_MASKED_METHOD(ProfilerPhase::TextureEvaluate, active);
 
         if constexpr (is_spectral_v<Spectrum>)
-            return m_distr.eval_pdf(si.wavelengths, active);
+            return m_resample > 0 ? m_regular.eval_pdf(si.wavelengths, active)
+                                 : m_distr.eval_pdf(si.wavelengths, active);
         else {
             ENOKI_MARK_USED(si);
             NotImplementedError("eval");
@@ -85,10 +107,11 @@ public:
     }
 
     Wavelength pdf_spectrum(const SurfaceInteraction3f &si, Mask active) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::TextureEvaluate, active);
+        MTS_MASKED_METHOD(ProfilerPhase::TextureEvaluate, active);
 
         if constexpr (is_spectral_v<Spectrum>)
-            return m_distr.eval_pdf_normalized(si.wavelengths, active);
+            return m_resample > 0 ? m_regular.eval_pdf_normalized(si.wavelengths, active)
+                                 : m_distr.eval_pdf_normalized(si.wavelengths, active);
         else {
             ENOKI_MARK_USED(si);
             NotImplementedError("pdf");
@@ -98,10 +121,13 @@ public:
     std::pair<Wavelength, UnpolarizedSpectrum> sample_spectrum(const SurfaceInteraction3f & /*si*/,
                                                       const Wavelength &sample,
                                                       Mask active) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::TextureSample, active);
+        MTS_MASKED_METHOD(ProfilerPhase::TextureSample, active);
 
         if constexpr (is_spectral_v<Spectrum>)
-            return { m_distr.sample(sample, active), m_distr.integral() };
+            if (m_resample > 0)
+                return { m_regular.sample(sample, active), m_regular.integral() };
+            else
+                return { m_distr.sample(sample, active), m_distr.integral() };
         else {
             ENOKI_MARK_USED(sample);
             NotImplementedError("sample");
@@ -109,20 +135,70 @@ public:
     }
 
     ScalarFloat mean() const override {
-        return m_distr.integral() / (MTS_WAVELENGTH_MAX - MTS_WAVELENGTH_MIN);
+        ScalarFloat integral = m_resample > 0 ? m_regular.integral() : m_distr.integral();
+        return integral / (MTS_WAVELENGTH_MAX - MTS_WAVELENGTH_MIN);
     }
 
     std::string to_string() const override {
         std::ostringstream oss;
         oss << "IrregularSpectrum[" << std::endl
-            << "  distr = " << string::indent(m_distr) << std::endl
-            << "]";
+            << "  distr = " << string::indent(m_distr);
+        if (m_resample > 0)
+            oss << "," << std::endl
+                << "  resampled = " << string::indent(m_regular);
+        oss << std::endl << "]";
         return oss.str();
     }
 
     MTS_DECLARE_CLASS()
+private:
+    /**
+     * \brief Resample the irregular data onto \c m_resample uniformly spaced
+     * wavelengths and log the resulting worst-case interpolation error
+     */
+    void resample() {
+        const ScalarFloat *nodes = m_distr.nodes().managed().data(),
+                          *values = m_distr.pdf().managed().data();
+        size_t size = m_distr.nodes().size();
+        ScalarVector2f range(nodes[0], nodes[size - 1]);
+        ScalarFloat step = (range.y() - range.x()) / (m_resample - 1);
+
+        // Linearly interpolate the original data at the new sample positions
+        std::vector<ScalarFloat> data(m_resample);
+        size_t index = 0;
+        for (size_t i = 0; i < m_resample; ++i) {
+            ScalarFloat x = i + 1 < m_resample ? range.x() + step * i : range.y();
+            while (index + 2 < size && nodes[index + 1] < x)
+                ++index;
+            ScalarFloat t = (x - nodes[index]) / (nodes[index + 1] - nodes[index]);
+            data[i] = enoki::lerp(values[index], values[index + 1], enoki::clamp(t, 0.f, 1.f));
+        }
+
+        m_regular = ContinuousDistribution<Wavelength>(range, data.data(), data.size());
+
+        /* Both representations are piecewise linear, and their difference
+           vanishes at the new sample positions. The largest deviation is
+           therefore attained at one of the original sample positions. */
+        ScalarFloat max_error = 0.f, max_value = 0.f;
+        for (size_t i = 0; i < size; ++i) {
+            ScalarFloat x = (nodes[i] - range.x()) / step;
+            size_t j = std::min((size_t) std::max(x, 0.f), m_resample - 2);
+            ScalarFloat t = x - (ScalarFloat) j,
+                        approx = enoki::lerp(data[j], data[j + 1], t);
+            max_error = std::max(max_error, std::abs(approx - values[i]));
+            max_value = std::max(max_value, std::abs(values[i]));
+        }
+
+        Log(Info, "IrregularSpectrum: resampled %i samples onto %i uniformly spaced "
+                  "wavelengths (max. abs. error: %g, max. rel. error: %.2f%%)",
+            size, m_resample, max_error,
+            max_value > 0.f ? 100.f * max_error / max_value : 0.f);
+    }
+
 private:
     IrregularContinuousDistribution<Wavelength> m_distr;
+    ContinuousDistribution<Wavelength> m_regular;
+    size_t m_resample;
 };
 
 MTS_IMPLEMENT_CLASS_VARIANT(IrregularSpectrum, Texture)
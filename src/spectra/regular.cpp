@@ -66,7 +66,7 @@ public:
     }
 
     UnpolarizedSpectrum eval(const SurfaceInteraction3f &si, Mask active) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::TextureEvaluate, active);
+        MTS_MASKED_METHOD(ProfilerPhase::TextureEvaluate, active);
 
         if constexpr (is_spectral_v<Spectrum>)
             return m_distr.eval_pdf(si.wavelengths, active);
@@ -75,7 +75,7 @@ public:
     }
 
     Wavelength pdf_spectrum(const SurfaceInteraction3f &si, Mask active) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::TextureEvaluate, active);
+        MTS_MASKED_METHOD(ProfilerPhase::TextureEvaluate, active);
 
         if constexpr (is_spectral_v<Spectrum>)
             return m_distr.eval_pdf_normalized(si.wavelengths, active);
@@ -86,7 +86,7 @@ public:
     std::pair<Wavelength, UnpolarizedSpectrum>
     sample_spectrum(const SurfaceInteraction3f & /*si*/,
                     const Wavelength &sample, Mask active) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::TextureSample, active);
+        MTS_MASKED_METHOD(ProfilerPhase::TextureSample, active);
 
         if constexpr (is_spectral_v<Spectrum>)
             return { m_distr.sample(sample, active), m_distr.integral() };
@@ -32,6 +32,7 @@ public:
 
         if constexpr (is_spectral_v<Spectrum>) {
             m_value = srgb_model_fetch(color);
+            update_constant();
         } else if constexpr (is_rgb_v<Spectrum>) {
             m_value = color;
         } else {
@@ -41,12 +42,15 @@ public:
     }
 
     UnpolarizedSpectrum eval(const SurfaceInteraction3f &si, Mask active) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::TextureEvaluate, active);
+        MTS_MASKED_METHOD(ProfilerPhase::TextureEvaluate, active);
 
-        if constexpr (is_spectral_v<Spectrum>)
+        if constexpr (is_spectral_v<Spectrum>) {
+            if (m_constant)
+                return UnpolarizedSpectrum(m_constant_value);
             return srgb_model_eval<UnpolarizedSpectrum>(m_value, si.wavelengths);
-        else
+        } else {
             return m_value;
+        }
     }
 
     ScalarFloat mean() const override {
@@ -63,6 +67,8 @@ public:
     void parameters_changed(const std::vector<std::string> &/*keys*/) override {
         if constexpr (!is_spectral_v<Spectrum>)
             m_value = clamp(m_value, 0.f, 1.f);
+        else
+            update_constant();
     }
 
     std::string to_string() const override {
@@ -75,6 +81,26 @@ public:
 
     MTS_DECLARE_CLASS()
 protected:
+    /**
+     * \brief Detect spectra that don't depend on the wavelength (e.g. of gray
+     * colors), which are then evaluated once instead of per lane and wavelength
+     *
+     * Differentiable variants always evaluate the model, so that gradients
+     * propagate to the coefficients.
+     */
+    void update_constant() {
+        m_constant = false;
+        if constexpr (!is_diff_array_v<Float>) {
+            ScalarFloat value = srgb_model_constant(ScalarColor3f(
+                scalar_cast(hmean(m_value.x())), scalar_cast(hmean(m_value.y())),
+                scalar_cast(hmean(m_value.z()))));
+            if (!std::isnan(value)) {
+                m_constant = true;
+                m_constant_value = value;
+            }
+        }
+    }
+
     /**
      * Depending on the compiled variant, this plugin either stores coefficients
      * for a spectral upsampling model, or a plain RGB/monochromatic value.
@@ -82,6 +108,10 @@ protected:
     static constexpr size_t ChannelCount = is_monochromatic_v<Spectrum> ? 1 : 3;
 
     Color<Float, ChannelCount> m_value;
+
+    /// Value of wavelength-independent spectra (spectral variants only)
+    ScalarFloat m_constant_value = 0.f;
+    bool m_constant = false;
 };
 
 MTS_IMPLEMENT_CLASS_VARIANT(SRGBReflectanceSpectrum, Texture)
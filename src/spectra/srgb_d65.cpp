@@ -36,7 +36,9 @@ public:
             if (scale != 0.f)
                 color /= scale;
 
-            m_value = srgb_model_fetch(color);
+            Array<float, 3> coeff = srgb_model_fetch(color);
+            m_value = coeff;
+            m_constant_value = srgb_model_constant(coeff);
 
             Properties props2("d65");
             props2.set_float("scale", props.float_("scale", 1.f) * scale);
@@ -51,19 +53,28 @@ public:
     }
 
     UnpolarizedSpectrum eval(const SurfaceInteraction3f &si, Mask active) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::TextureEvaluate, active);
+        MTS_MASKED_METHOD(ProfilerPhase::TextureEvaluate, active);
 
-        if constexpr (is_spectral_v<Spectrum>)
+        if constexpr (is_spectral_v<Spectrum>) {
+            // Gray colors only scale the illuminant
+            if (!std::isnan(m_constant_value) && !is_diff_array_v<Float>)
+                return m_d65->eval(si, active) * m_constant_value;
             return m_d65->eval(si, active) *
                    srgb_model_eval<UnpolarizedSpectrum>(m_value, si.wavelengths);
-        else
+        } else {
             return m_value;
+        }
     }
 
     void traverse(TraversalCallback *callback) override {
         callback->put_parameter("value", m_value);
     }
 
+    void parameters_changed(const std::vector<std::string> &/*keys*/) override {
+        // Edited coefficients always take the general path
+        m_constant_value = std::numeric_limits<ScalarFloat>::quiet_NaN();
+    }
+
     std::string to_string() const override {
         std::ostringstream oss;
         oss << "SRGBEmitterSpectrum[" << std::endl
@@ -82,6 +93,9 @@ private:
 
     Color<Float, ChannelCount> m_value;
     ref<Texture> m_d65;
+
+    /// Value of wavelength-independent spectra, or NaN (spectral variants only)
+    ScalarFloat m_constant_value = std::numeric_limits<ScalarFloat>::quiet_NaN();
 };
 
 MTS_IMPLEMENT_CLASS_VARIANT(SRGBEmitterSpectrum, Texture)
@@ -45,3 +45,33 @@ def test02_sample_spectrum(variant_scalar_spectral, obj):
         obj.sample_spectrum(si, .5),
         [576.777, 212.5]
     )
+
+
+def test03_resample(variant_scalar_spectral):
+    from mitsuba.core.xml import load_string
+    from mitsuba.render import SurfaceInteraction3f
+
+    # 151 samples over [500, 650]: the original nodes fall on the uniform grid
+    obj = load_string('''
+        <spectrum version='2.0.0' type='irregular'>
+            <string name="wavelengths" value="500, 600, 650"/>
+            <string name="values" value="1, 2, .5"/>
+            <integer name="resample" value="151"/>
+        </spectrum>''')
+
+    si = SurfaceInteraction3f()
+    values = [0, 1, 1.5, 2, .5, 0]
+    for i in range(6):
+        si.wavelengths = 450 + 50 * i
+        assert ek.allclose(obj.eval(si), values[i])
+        assert ek.allclose(obj.pdf_spectrum(si), values[i] / 212.5)
+
+    assert ek.allclose(obj.sample_spectrum(si, .5), [576.777, 212.5])
+
+    with pytest.raises(RuntimeError):
+        load_string('''
+            <spectrum version='2.0.0' type='irregular'>
+                <string name="wavelengths" value="500, 600, 650"/>
+                <string name="values" value="1, 2, .5"/>
+                <integer name="resample" value="1"/>
+            </spectrum>''')
@@ -0,0 +1,39 @@
+import mitsuba
+import pytest
+import enoki as ek
+
+
+def spectrum(plugin, color):
+    return mitsuba.core.xml.load_string('''
+        <spectrum version='2.0.0' type='%s'>
+            <rgb name="color" value="%s"/>
+        </spectrum>''' % (plugin, color))
+
+
+def test01_constant_gray(variant_scalar_spectral):
+    from mitsuba.render import SurfaceInteraction3f, srgb_model_eval, srgb_model_fetch
+
+    si = SurfaceInteraction3f()
+    for color in [[0, 0, 0], [0.2, 0.2, 0.2], [0.5, 0.5, 0.5], [1, 1, 1]]:
+        obj = spectrum('srgb', '%f, %f, %f' % tuple(color))
+        coeff = srgb_model_fetch(color)
+        for wavelength in [370, 450, 550, 650, 800]:
+            si.wavelengths = wavelength
+            # Flat spectra are evaluated once, but must match the model
+            assert ek.allclose(obj.eval(si), srgb_model_eval(coeff, si.wavelengths),
+                               atol=1e-5)
+
+
+def test02_varying_color(variant_scalar_spectral):
+    from mitsuba.render import SurfaceInteraction3f, srgb_model_eval, srgb_model_fetch
+
+    si = SurfaceInteraction3f()
+    obj = spectrum('srgb', '0.8, 0.3, 0.1')
+    coeff = srgb_model_fetch([0.8, 0.3, 0.1])
+    values = []
+    for wavelength in [450, 550, 650]:
+        si.wavelengths = wavelength
+        value = obj.eval(si)
+        assert ek.allclose(value, srgb_model_eval(coeff, si.wavelengths))
+        values.append(value[0])
+    assert values[0] < values[2]
@@ -1,12 +1,18 @@
 #include <mitsuba/core/bitmap.h>
 #include <mitsuba/core/fresolver.h>
+#include <mitsuba/core/hash.h>
+#include <mitsuba/core/memreport.h>
 #include <mitsuba/core/plugin.h>
+#include <mitsuba/core/profiler.h>
 #include <mitsuba/core/properties.h>
+#include <mitsuba/core/rescache.h>
 #include <mitsuba/core/spectrum.h>
 #include <mitsuba/core/distr_2d.h>
+#include <mitsuba/core/texcache.h>
 #include <mitsuba/render/interaction.h>
 #include <mitsuba/render/texture.h>
 #include <mitsuba/render/srgb.h>
+#include <atomic>
 #include <mutex>
 #include <tbb/spin_mutex.h>
 
@@ -23,7 +29,8 @@ Bitmap texture (:monosp:`bitmap`)
 
  * - filename
    - |string|
-   - Filename of the bitmap to be loaded
+   - Filename of the bitmap to be loaded. A filename containing ``<UDIM>``
+     specifies a UDIM texture set (see below).
 
  * - filter_type
    - |string|
@@ -35,6 +42,24 @@ Bitmap texture (:monosp:`bitmap`)
      - ``nearest``: disable filtering and interpolation. In this mode, the plugin
        performs nearest neighbor lookups of texture values.
 
+     - ``trilinear``: build a MIP map pyramid when loading the texture and
+       interpolate bilinearly within the two levels that best match the UV
+       footprint of the lookup, which is derived from the ray differentials.
+
+     - ``anisotropic``: like ``trilinear``, but selects the level from the
+       smaller axis of the footprint and averages several Gaussian-weighted
+       lookups along the larger axis. This keeps textures seen at grazing
+       angles sharp.
+
+     Lookups without UV partials (e.g. after the first bounce) fall back to
+     bilinear interpolation.
+
+ * - max_anisotropy
+   - |float|
+   - Maximum number of lookups along the larger footprint axis of the
+     ``anisotropic`` filter. More eccentric footprints are blurred along
+     their smaller axis. (Default: 8)
+
  * - wrap_mode
    - |string|
    - Controls the behavior of texture evaluations that fall outside of the
@@ -46,6 +71,28 @@ Bitmap texture (:monosp:`bitmap`)
 
      - ``clamp``: clamp coordinates to the edge of the texture.
 
+ * - interpolate_coefficients
+   - |bool|
+   - Spectral variants only: interpolate the spectral upsampling coefficients
+     of neighboring texels and evaluate the resulting spectrum once, instead
+     of evaluating the spectrum of every texel and interpolating the results.
+     This is considerably faster, but only approximates the interpolated
+     spectrum, since the model is nonlinear in its coefficients. (Default: false)
+
+ * - cache
+   - |bool|
+   - Scalar variants only: remember the most recent lookups of every thread, so that
+     repeated queries of the same texture at the same surface interaction (e.g. a roughness
+     texture shared by several BSDF lobes, or evaluated once for sampling and
+     once for emitter sampling) do not filter the texture again. (Default: true)
+
+ * - precompute_gradient
+   - |bool|
+   - Precompute the texel differences of the bilinear interpolant, so that the gradient
+     of the texture (e.g. used by :ref:`bumpmap <bsdf-bumpmap>`) is evaluated with a single
+     lookup instead of four. This stores four additional values per texel, and is not
+     supported by tiled textures. (Default: false)
+
  * - raw
    - |bool|
    - Should the transformation to the stored color data (e.g. sRGB to linear,
@@ -58,8 +105,29 @@ Bitmap texture (:monosp:`bitmap`)
      values. A 4x4 matrix can also be provided, in which case the extra row and
      column are ignored.
 
+ * - tiled
+   - |bool|
+   - Stream the texture through the global texture cache instead of keeping
+     it resident in memory (see below). Only supported by single precision
+     scalar variants. (Default: false)
+
+ * - cache_dir
+   - |string|
+   - Directory in which the tiled representation of the texture is stored when
+     :paramtype:`tiled` is enabled. (Default: the directory of the image file)
+
+ * - tiled_filename
+   - |string|
+   - Explicit path of the tiled representation, which implies
+     :paramtype:`tiled`. Unlike the files in :paramtype:`cache_dir`, it doesn't
+     depend on the source image and can be loaded on its own (see below).
+     (Default: none)
+
 This plugin provides a bitmap texture that performs interpolated lookups given
-a JPEG, PNG, OpenEXR, RGBE, TGA, or BMP input file.
+a JPEG, PNG, OpenEXR, RGBE, PFM, PPM, TGA, BMP, or tensor input file.
+Uncompressed PPM and tensor files are memory-mapped instead of being read, and
+tensor files that already store linear floating point data with 1 or 3
+channels are used without an intermediate conversion.
 
 When loading the plugin, the data is first converted into a usable color representation
 for the renderer:
@@ -74,26 +142,128 @@ These conversions can alternatively be disabled with the :paramtype:`raw` flag,
 e.g. when textured data is already in linear space or does not represent colors
 at all.
 
+Scenes with large texture sets may not fit into memory. When :paramtype:`tiled`
+is enabled, the converted texture is written once into a tiled MIP map file
+(``.mtex``) in :paramtype:`cache_dir`. Subsequent runs reuse this file without
+decoding the original image. Tiles are then loaded on demand by a global
+texture cache with a bounded memory budget (1 GiB by default, see
+``TextureCache.set_max_memory()``) that evicts the least recently used tiles.
+When ray differentials are available, bilinear lookups additionally
+interpolate between MIP levels according to the UV footprint.
+
+UDIM texture sets split the UV space into unit squares that are stored in
+separate files, which are numbered as :math:`1001 + \lfloor u \rfloor + 10
+\lfloor v \rfloor` for :math:`u \in [0, 10)`. When the filename contains
+``<UDIM>``, e.g. ``wood.<UDIM>.exr``, the plugin substitutes this number and
+only loads the texture of a square once a lookup falls into it for the first
+time. Every square is then a separate bitmap texture with the other parameters
+of the plugin (with :paramtype:`wrap_mode` defaulting to ``clamp``), which is
+streamed through the texture cache in single precision variants as if
+:paramtype:`tiled` was enabled. Squares without a file evaluate to zero. UDIM
+texture sets are only supported by scalar variants.
+
+Tiled textures can also be created offline using the ``mtsimgconvert``
+executable, e.g. ``mtsimgconvert -m scalar_spectral wood.exr`` writes
+``wood.mtex``. Specifying such a file as the :paramtype:`filename` loads it
+directly: no image is decoded, converted, or resampled at render time, and the
+tiles are read from a memory mapping of the file. The file must have been
+created for the same kind of variant (RGB/monochrome or spectral) and the same
+:paramtype:`raw` setting.
+
+Bitmap textures that load the same (unmodified) file with the same
+:paramtype:`raw` setting and MIP mapping configuration share a single copy of
+the converted texel data, e.g. when every object of a material library has its
+own copy of a material. This does not apply to differentiable variants, where
+each texture is optimized separately.
+
 */
 
-enum class FilterType { Nearest, Bilinear };
+enum class FilterType { Nearest, Bilinear, Trilinear, Anisotropic };
 enum class WrapMode { Repeat, Mirror, Clamp };
 
 // Forward declaration of specialized bitmap texture
 template <typename Float, typename Spectrum, uint32_t Channels, bool Raw>
 class BitmapTextureImpl;
 
+// Forward declaration of the lazily loaded UDIM texture set
+template <typename Float, typename Spectrum>
+class BitmapTextureUDIM;
+
+/**
+ * \brief Texel data of a bitmap texture and its MIP map pyramid
+ *
+ * Bitmap textures that load the same file with the same options share one
+ * instance through the \ref ResourceCache.
+ */
+template <typename Float, typename Spectrum>
+struct BitmapTextureStorage : public Object {
+    MTS_IMPORT_TYPES()
+
+    BitmapTextureStorage(const Bitmap *bitmap, const std::vector<ref<Bitmap>> &levels,
+                         ScalarFloat mean)
+        : resolution(bitmap->size()),
+          channel_count((uint32_t) bitmap->channel_count()), mean(mean) {
+        data = DynamicBuffer<Float>::copy(bitmap->data(),
+                                          hprod(resolution) * channel_count);
+
+        if (!levels.empty()) {
+            std::vector<int32_t> info = { resolution.x(), resolution.y(), 0 };
+            size_t pixel_count = 0;
+            for (const Bitmap *level : levels) {
+                info.push_back((int32_t) level->width());
+                info.push_back((int32_t) level->height());
+                info.push_back((int32_t) pixel_count);
+                pixel_count += level->pixel_count();
+            }
+
+            std::unique_ptr<ScalarFloat[]> values(new ScalarFloat[pixel_count * channel_count]);
+            ScalarFloat *ptr = values.get();
+            for (const Bitmap *level : levels) {
+                memcpy(ptr, level->data(),
+                       level->pixel_count() * channel_count * sizeof(ScalarFloat));
+                ptr += level->pixel_count() * channel_count;
+            }
+
+            mip_data = DynamicBuffer<Float>::copy(values.get(), pixel_count * channel_count);
+            level_info = DynamicBuffer<Int32>::copy(info.data(), info.size());
+            level_count = (uint32_t) levels.size() + 1;
+        }
+    }
+
+    ScalarVector2i resolution;
+    uint32_t channel_count;
+    ScalarFloat mean;
+    DynamicBuffer<Float> data;
+    DynamicBuffer<Float> mip_data;
+    DynamicBuffer<Int32> level_info;
+    uint32_t level_count = 1;
+
+    void account_memory(MemoryReport *report) const override {
+        report->add_array(MemoryCategory::Textures, data);
+        report->add_array(MemoryCategory::Textures, mip_data);
+        report->add_array(MemoryCategory::Textures, level_info);
+    }
+};
+
 /// Bilinearly interpolated bitmap texture.
 template <typename Float, typename Spectrum>
 class BitmapTexture final : public Texture<Float, Spectrum> {
 public:
     MTS_IMPORT_TYPES(Texture)
+    using Storage = BitmapTextureStorage<Float, Spectrum>;
 
     BitmapTexture(const Properties &props) : Texture(props) {
+        ScopedPhase sp(ProfilerPhase::LoadTexture);
         m_transform = props.transform("to_uv", ScalarTransform4f()).extract();
 
+        const std::string &filename = props.string("filename");
+        if (filename.find("<UDIM>") != std::string::npos) {
+            m_udim = new BitmapTextureUDIM<Float, Spectrum>(props, filename, m_transform);
+            return;
+        }
+
         FileResolver* fs = Thread::thread()->file_resolver();
-        fs::path file_path = fs->resolve(props.string("filename"));
+        fs::path file_path = fs->resolve(filename);
         m_name = file_path.filename().string();
         Log(Debug, "Loading bitmap texture from \"%s\" ..", m_name);
 
@@ -102,9 +272,21 @@ public:
             m_filter_type = FilterType::Nearest;
         else if (filter_type == "bilinear")
             m_filter_type = FilterType::Bilinear;
+        else if (filter_type == "trilinear")
+            m_filter_type = FilterType::Trilinear;
+        else if (filter_type == "anisotropic")
+            m_filter_type = FilterType::Anisotropic;
         else
-            Throw("Invalid filter type \"%s\", must be one of: \"nearest\", or "
-                  "\"bilinear\"!", filter_type);
+            Throw("Invalid filter type \"%s\", must be one of: \"nearest\", "
+                  "\"bilinear\", \"trilinear\", or \"anisotropic\"!", filter_type);
+
+        m_max_anisotropy = props.float_("max_anisotropy", 8.f);
+        if (!(m_max_anisotropy >= 1.f))
+            Throw("\"max_anisotropy\" must be at least 1!");
+
+        m_interpolate_coefficients = props.bool_("interpolate_coefficients", false);
+        m_cache = props.bool_("cache", true);
+        m_precompute_gradient = props.bool_("precompute_gradient", false);
 
         std::string wrap_mode = props.string("wrap_mode", "repeat");
         if (wrap_mode == "repeat")
@@ -117,11 +299,147 @@ public:
             Throw("Invalid wrap mode \"%s\", must be one of: \"repeat\", "
                   "\"mirror\", or \"clamp\"!", wrap_mode);
 
-        m_bitmap = new Bitmap(file_path);
+        /* Should Mitsuba disable transformations to the stored color data?
+           (e.g. sRGB to linear, spectral upsampling, etc.) */
+        m_raw = props.bool_("raw", false);
+
+        // Look for an up-to-date tiled version of this texture
+        fs::path tiled_path;
+        uint64_t tiled_key = 0;
+        bool native = file_path.extension() == ".mtex",
+             explicit_path = props.has_property("tiled_filename");
+        if (props.bool_("tiled", false) || native || explicit_path) {
+            if constexpr (is_array_v<Float> || !std::is_same_v<ScalarFloat, float>) {
+                if (native)
+                    Throw("Tiled texture \"%s\" can only be loaded by single "
+                          "precision scalar variants!", m_name);
+                Log(Warn, "Tiled textures are only supported by single precision "
+                          "scalar variants, loading \"%s\" into memory.", m_name);
+            } else {
+                if (native) {
+                    tiled_path = file_path;
+                    tiled_key = tiled_layout_key();
+                } else if (explicit_path) {
+                    tiled_path = fs->resolve(props.string("tiled_filename"));
+                    tiled_key = tiled_layout_key();
+                } else {
+                    fs::path cache_dir = props.string("cache_dir",
+                                                      file_path.parent_path().string());
+                    tiled_key = tiled_cache_key(file_path);
+                    char filename[32];
+                    snprintf(filename, sizeof(filename), ".%016llx.mtex",
+                             (unsigned long long) tiled_key);
+                    tiled_path = cache_dir / fs::path(m_name + filename);
+                }
+
+                m_tiled = TextureCache::instance()->open(tiled_path, tiled_key);
+                if (m_tiled) {
+                    Log(Debug, "Using tiled texture \"%s\"", tiled_path.string());
+                    m_channel_count = m_tiled->channel_count();
+                    m_mean = m_tiled->mean();
+                    return;
+                }
+
+                if (native)
+                    Throw("\"%s\" is not a tiled texture that was created for "
+                          "this kind of variant with raw=%s!", m_name, m_raw);
+            }
+        }
+
+        bool mipmap = m_filter_type == FilterType::Trilinear ||
+                      m_filter_type == FilterType::Anisotropic;
+
+        if (!tiled_path.empty()) {
+            // Store a tiled version (which has its own MIP map pyramid)
+            std::vector<ref<Bitmap>> levels;
+            ScalarFloat mean;
+            ref<Bitmap> bitmap = load_bitmap(props, file_path, false, levels, mean);
+            try {
+                fs::path cache_dir = tiled_path.parent_path();
+                if (!cache_dir.empty() && !fs::exists(cache_dir))
+                    fs::create_directory(cache_dir);
+                TextureCache::write(bitmap, tiled_path, tiled_key, (float) mean);
+                m_tiled = TextureCache::instance()->open(tiled_path, tiled_key);
+            } catch (const std::exception &e) {
+                Log(Warn, "Could not create tiled texture \"%s\": %s",
+                    tiled_path.string(), e.what());
+            }
+
+            if (m_tiled) {
+                m_channel_count = m_tiled->channel_count();
+                m_mean = m_tiled->mean();
+            } else {
+                m_storage = new Storage(bitmap, levels, mean);
+            }
+        } else {
+            auto load = [&]() -> ref<Storage> {
+                std::vector<ref<Bitmap>> levels;
+                ScalarFloat mean;
+                ref<Bitmap> bitmap = load_bitmap(props, file_path, mipmap, levels, mean);
+                return new Storage(bitmap, levels, mean);
+            };
+
+            /* Textures that load the same file with the same options share
+               their texel data, except for bitmaps decoded ahead of time and
+               in differentiable variants (where each texture is optimized
+               separately). */
+            if (!is_diff_array_v<Float> && !props.has_property("bitmap")) {
+                std::string key = tfm::format(
+                    "bitmap|%s|%s|raw=%i|mipmap=%i|wrap_mode=%i",
+                    ResourceCache::file_key(file_path), class_()->variant(),
+                    m_raw, mipmap, mipmap ? (int) m_wrap_mode : -1);
+                m_storage = ResourceCache::instance()->get<Storage>(key, load);
+            } else {
+                m_storage = load();
+            }
+        }
+
+        if (m_storage) {
+            m_channel_count = m_storage->channel_count;
+            m_mean = m_storage->mean;
+        }
+
+        if (mipmap)
+            Log(Debug, "Created %i MIP levels for texture \"%s\"",
+                m_tiled ? m_tiled->level_count() : m_storage->level_count, m_name);
+    }
+
+    /**
+     * Recursively expand into an implementation specialized to the
+     * actual loaded image.
+     */
+    std::vector<ref<Object>> expand() const override {
+        if (m_udim)
+            return { m_udim };
+        Properties props;
+        props.set_id(this->id());
+        return { ref<Object>(expand_1()) };
+    }
+
+    MTS_DECLARE_CLASS()
+
+protected:
+    /**
+     * \brief Load the image and convert it into the working floating point
+     * representation, optionally along with a MIP map pyramid
+     */
+    ref<Bitmap> load_bitmap(const Properties &props, const fs::path &file_path,
+                            bool mipmap, std::vector<ref<Bitmap>> &levels,
+                            ScalarFloat &mean) const {
+        ref<Bitmap> bitmap;
+        if (props.has_property("bitmap")) {
+            // Decoded ahead of time by the staged scene loader of the GPU variants
+            ref<Object> object = props.object("bitmap");
+            bitmap = dynamic_cast<Bitmap *>(object.get());
+            if (!bitmap)
+                Throw("Property \"bitmap\" must be a Bitmap instance!");
+        } else {
+            bitmap = new Bitmap(file_path);
+        }
 
         /* Convert to linear RGB float bitmap, will be converted
            into spectral profile coefficients below (in place) */
-        Bitmap::PixelFormat pixel_format = m_bitmap->pixel_format();
+        Bitmap::PixelFormat pixel_format = bitmap->pixel_format();
         switch (pixel_format) {
             case Bitmap::PixelFormat::Y:
             case Bitmap::PixelFormat::YA:
@@ -140,40 +458,68 @@ public:
                       "format (Y[A], RGB[A], XYZ[A] are supported).");
         }
 
-        /* Should Mitsuba disable transformations to the stored color data?
-           (e.g. sRGB to linear, spectral upsampling, etc.) */
-        m_raw = props.bool_("raw", false);
         if (m_raw) {
             /* Don't undo gamma correction in the conversion below.
                This is needed, e.g., for normal maps. */
-            m_bitmap->set_srgb_gamma(false);
+            bitmap->set_srgb_gamma(false);
         }
 
-        // Convert the image into the working floating point representation
-        m_bitmap = m_bitmap->convert(pixel_format, struct_type_v<ScalarFloat>, false);
+        /* Convert the image into the working floating point representation.
+           Bitmaps loaded here that are already stored in it can be used
+           directly, since the changes below don't affect other objects. */
+        if (props.has_property("bitmap") || bitmap->pixel_format() != pixel_format ||
+            bitmap->component_format() != struct_type_v<ScalarFloat> ||
+            bitmap->srgb_gamma())
+            bitmap = bitmap->convert(pixel_format, struct_type_v<ScalarFloat>, false);
 
-        if (any(m_bitmap->size() < 2)) {
+        if (any(bitmap->size() < 2)) {
             Log(Warn, "Image must be at least 2x2 pixels in size, up-sampling..");
             using ReconstructionFilter = Bitmap::ReconstructionFilter;
             ref<ReconstructionFilter> rfilter =
                 PluginManager::instance()->create_object<ReconstructionFilter>(Properties("tent"));
-            m_bitmap = m_bitmap->resample(max(m_bitmap->size(), 2), rfilter);
+            bitmap = bitmap->resample(max(bitmap->size(), 2), rfilter);
+        }
+
+        /* Build the MIP map pyramid from the linear image data (i.e. prior to
+           the conversion into spectral coefficients below) */
+        if (mipmap) {
+            using ReconstructionFilter = Bitmap::ReconstructionFilter;
+            ref<ReconstructionFilter> rfilter =
+                PluginManager::instance()->create_object<ReconstructionFilter>(Properties("box"));
+
+            FilterBoundaryCondition bc = FilterBoundaryCondition::Repeat;
+            if (m_wrap_mode == WrapMode::Mirror)
+                bc = FilterBoundaryCondition::Mirror;
+            else if (m_wrap_mode == WrapMode::Clamp)
+                bc = FilterBoundaryCondition::Clamp;
+
+            const Bitmap *level = bitmap;
+            while (level->width() > 1 || level->height() > 1) {
+                levels.push_back(level->resample(max(level->size() / 2u, 1u),
+                                                   rfilter, { bc, bc }));
+                level = levels.back();
+            }
+        }
+
+        if (is_spectral_v<Spectrum> && !m_raw && bitmap->channel_count() == 3) {
+            for (Bitmap *level : levels)
+                srgb_model_fetch((ScalarFloat *) level->data(), level->pixel_count());
         }
 
-        ScalarFloat *ptr = (ScalarFloat *) m_bitmap->data();
-        size_t pixel_count = m_bitmap->pixel_count();
+        ScalarFloat *ptr = (ScalarFloat *) bitmap->data();
+        size_t pixel_count = bitmap->pixel_count();
         bool bad = false;
 
-        double mean = 0.0;
-        if (m_bitmap->channel_count() == 3) {
+        double sum = 0.0;
+        if (bitmap->channel_count() == 3) {
             if (is_spectral_v<Spectrum> && !m_raw) {
-                for (size_t i = 0; i < pixel_count; ++i) {
-                    ScalarColor3f value = load_unaligned<ScalarColor3f>(ptr);
-                    if (!all(value >= 0 && value <= 1))
+                for (size_t i = 0; i < pixel_count * 3; ++i) {
+                    if (!(ptr[i] >= 0 && ptr[i] <= 1))
                         bad = true;
-                    value = srgb_model_fetch(value);
-                    mean += (double) srgb_model_mean(value);
-                    store_unaligned(ptr, value);
+                }
+                srgb_model_fetch(ptr, pixel_count);
+                for (size_t i = 0; i < pixel_count; ++i) {
+                    sum += (double) srgb_model_mean(load_unaligned<ScalarColor3f>(ptr));
                     ptr += 3;
                 }
             } else {
@@ -181,20 +527,20 @@ public:
                     ScalarColor3f value = load_unaligned<ScalarColor3f>(ptr);
                     if (!all(value >= 0 && value <= 1))
                         bad = true;
-                    mean += (double) luminance(value);
+                    sum += (double) luminance(value);
                     ptr += 3;
                 }
             }
-        } else if (m_bitmap->channel_count() == 1) {
+        } else if (bitmap->channel_count() == 1) {
             for (size_t i = 0; i < pixel_count; ++i) {
                 ScalarFloat value = ptr[i];
                 if (!(value >= 0 && value <= 1))
                     bad = true;
-                mean += (double) value;
+                sum += (double) value;
             }
         } else {
             Throw("Unsupported channel count: %d (expected 1 or 3)",
-                  m_bitmap->channel_count());
+                  bitmap->channel_count());
         }
 
         if (bad)
@@ -202,24 +548,35 @@ public:
                 "BitmapTexture: texture named \"%s\" contains pixels that "
                 "exceed the [0, 1] range!", m_name);
 
-        m_mean = ScalarFloat(mean / pixel_count);
+        mean = ScalarFloat(sum / pixel_count);
+        return bitmap;
+    }
+
+    /// Key of the tiled texture file, changes whenever the source image does
+    uint64_t tiled_cache_key(const fs::path &file_path) const {
+        size_t value = hash(std::string("mtex"));
+        value = hash_combine(value, hash(fs::absolute(file_path).string()));
+        value = hash_combine(value, hash(fs::file_size(file_path)));
+        value = hash_combine(value, hash(fs::last_write_time(file_path)));
+        value = hash_combine(value, hash(m_raw));
+        value = hash_combine(value, hash(is_spectral_v<Spectrum>));
+        return (uint64_t) value;
     }
 
     /**
-     * Recursively expand into an implementation specialized to the
-     * actual loaded image.
+     * Key of tiled texture files with an explicit path, which only captures
+     * the layout of the data (see \c mtsimgconvert) so that the files can be
+     * loaded without the source image
      */
-    std::vector<ref<Object>> expand() const override {
-        Properties props;
-        props.set_id(this->id());
-        return { ref<Object>(expand_1()) };
+    uint64_t tiled_layout_key() const {
+        size_t value = hash(std::string("mtex-layout"));
+        value = hash_combine(value, hash(m_raw));
+        value = hash_combine(value, hash(is_spectral_v<Spectrum>));
+        return (uint64_t) value;
     }
 
-    MTS_DECLARE_CLASS()
-
-protected:
     Object* expand_1() const {
-        return m_bitmap->channel_count() == 1 ? expand_2<1>() : expand_2<3>();
+        return m_channel_count == 1 ? expand_2<1>() : expand_2<3>();
     }
 
     template <uint32_t Channels> Object* expand_2() const {
@@ -229,17 +586,26 @@ protected:
     template <uint32_t Channels, bool Raw> Object* expand_3() const {
         Properties props;
         return new BitmapTextureImpl<Float, Spectrum, Channels, Raw>(
-            props, m_bitmap, m_name, m_transform, m_mean, m_filter_type, m_wrap_mode);
+            props, m_storage, m_tiled, m_name, m_transform, m_mean,
+            m_filter_type, m_wrap_mode, m_max_anisotropy, m_interpolate_coefficients,
+            m_cache, m_precompute_gradient);
     }
 
 protected:
-    ref<Bitmap> m_bitmap;
+    ref<Storage> m_storage;
+    ref<TiledTexture> m_tiled;
+    ref<Object> m_udim;
+    uint32_t m_channel_count;
     std::string m_name;
     ScalarTransform3f m_transform;
     bool m_raw;
     ScalarFloat m_mean;
     FilterType m_filter_type;
     WrapMode m_wrap_mode;
+    ScalarFloat m_max_anisotropy;
+    bool m_interpolate_coefficients;
+    bool m_cache;
+    bool m_precompute_gradient;
 };
 
 template <typename Float, typename Spectrum, uint32_t Channels, bool Raw>
@@ -247,25 +613,57 @@ class BitmapTextureImpl final : public Texture<Float, Spectrum> {
 public:
     MTS_IMPORT_TYPES(Texture)
 
+    /// Storage representation underlying this texture
+    using StorageType = std::conditional_t<Channels == 1, Float, Color3f>;
+
+    /// Interpolated value (spectra are evaluated before interpolation)
+    using ResultType = std::conditional_t<is_spectral_v<Spectrum> && !Raw && Channels == 3,
+                                          UnpolarizedSpectrum, StorageType>;
+
+    using Storage = BitmapTextureStorage<Float, Spectrum>;
+
     BitmapTextureImpl(const Properties &props,
-                      const Bitmap *bitmap,
+                      const Storage *storage,
+                      const TiledTexture *tiled,
                       const std::string &name,
                       const ScalarTransform3f &transform,
                       ScalarFloat mean,
                       FilterType filter_type,
-                      WrapMode wrap_mode)
+                      WrapMode wrap_mode,
+                      ScalarFloat max_anisotropy,
+                      bool interpolate_coefficients,
+                      bool cache,
+                      bool precompute_gradient)
         : Texture(props),
-          m_resolution(ScalarVector2i(bitmap->size())),
-          m_inv_resolution_x((int) bitmap->width()),
-          m_inv_resolution_y((int) bitmap->height()),
+          m_resolution(storage ? storage->resolution
+                               : ScalarVector2i(tiled->width(), tiled->height())),
+          m_inv_resolution_x(m_resolution.x()),
+          m_inv_resolution_y(m_resolution.y()),
           m_name(name), m_transform(transform), m_mean(mean),
-          m_filter_type(filter_type), m_wrap_mode(wrap_mode){
-        m_data = DynamicBuffer<Float>::copy(bitmap->data(),
-            hprod(m_resolution) * Channels);
+          m_filter_type(filter_type), m_wrap_mode(wrap_mode),
+          m_max_anisotropy(max_anisotropy),
+          m_interpolate_coefficients(interpolate_coefficients), m_cache(cache),
+          m_tiled(tiled), m_storage(storage) {
+        if (storage) {
+            m_data = share(storage->data);
+            if (storage->level_count > 1) {
+                m_mip_data = share(storage->mip_data);
+                m_level_info = share(storage->level_info);
+                m_level_count = storage->level_count;
+            }
+        }
+
+        if (precompute_gradient && m_filter_type != FilterType::Nearest) {
+            if (m_tiled)
+                Log(Warn, "Tiled texture \"%s\" doesn't support precomputed gradients!",
+                    m_name);
+            else if constexpr (Channels == 1 || !is_spectral_v<Spectrum> || Raw)
+                rebuild_gradient();
+        }
     }
 
     UnpolarizedSpectrum eval(const SurfaceInteraction3f &si, Mask active) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::TextureEvaluate, active);
+        MTS_MASKED_METHOD(ProfilerPhase::TextureEvaluate, active);
 
         if constexpr (Channels == 3 && is_spectral_v<Spectrum> && Raw) {
             ENOKI_MARK_USED(si);
@@ -283,7 +681,7 @@ public:
     }
 
     Float eval_1(const SurfaceInteraction3f &si, Mask active = true) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::TextureEvaluate, active);
+        MTS_MASKED_METHOD(ProfilerPhase::TextureEvaluate, active);
 
         if constexpr (Channels == 3 && is_spectral_v<Spectrum> && !Raw) {
             ENOKI_MARK_USED(si);
@@ -302,7 +700,7 @@ public:
     }
 
     Vector2f eval_1_grad(const SurfaceInteraction3f& si, Mask active = true) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::TextureEvaluate, active);
+        MTS_MASKED_METHOD(ProfilerPhase::TextureEvaluate, active);
 
         if constexpr (Channels == 3 && is_spectral_v<Spectrum> && !Raw) {
             ENOKI_MARK_USED(si);
@@ -312,7 +710,7 @@ public:
                   to_string());
         }
         else {
-            if (m_filter_type == FilterType::Bilinear) {
+            if (m_filter_type != FilterType::Nearest) {
                 // Storage representation underlying this texture
                 using StorageType = std::conditional_t<Channels == 1, Float, Color3f>;
                 using Int4 = Array<Int32, 4>;
@@ -332,27 +730,45 @@ public:
                 // Interpolation weights
                 Point2f w1 = uv - Point2f(uv_i), w0 = 1.f - w1;
 
-                // Apply wrap mode
-                Int24 uv_i_w = wrap(Int24(Int4(0, 1, 0, 1) + uv_i.x(),
-                                          Int4(0, 0, 1, 1) + uv_i.y()));
+                // Partials w.r.t. pixel coordinate x and y
+                Vector2f df_xy;
 
-                Int4 index = uv_i_w.x() + uv_i_w.y() * m_resolution.x();
+                if (slices(m_grad_data) > 0) {
+                    // Single lookup of the precomputed differences
+                    auto [cell, reversed] = gradient_cell(uv_i);
 
-                auto convert_to_monochrome = [](const auto& a) {
-                    if constexpr (Channels == 3)
-                        return luminance(a);
-                    else
-                        return a;
-                };
+                    Vector4f diff = gather<Vector4f>(
+                        m_grad_data, cell.x() + cell.y() * (m_resolution.x() + 1), active);
 
-                Float f00 = convert_to_monochrome(gather<StorageType>(m_data, index.x(), active));
-                Float f10 = convert_to_monochrome(gather<StorageType>(m_data, index.y(), active));
-                Float f01 = convert_to_monochrome(gather<StorageType>(m_data, index.z(), active));
-                Float f11 = convert_to_monochrome(gather<StorageType>(m_data, index.w(), active));
+                    // Weights of the lower texel of the cell along each axis
+                    Point2f w_lo = select(reversed, w1, w0),
+                            w_hi = select(reversed, w0, w1);
 
-                // Partials w.r.t. pixel coordinate x and y
-                Vector2f df_xy{ fmadd(w0.y(), f10 - f00, w1.y() * (f11 - f01)),
-                                fmadd(w0.x(), f01 - f00, w1.x() * (f11 - f10)) };
+                    df_xy = Vector2f(fmadd(w_lo.y(), diff.x(), w_hi.y() * diff.y()),
+                                     fmadd(w_lo.x(), diff.z(), w_hi.x() * diff.w()));
+                    masked(df_xy, reversed) = -df_xy;
+                } else {
+                    // Apply wrap mode
+                    Int24 uv_i_w = wrap(Int24(Int4(0, 1, 0, 1) + uv_i.x(),
+                                              Int4(0, 0, 1, 1) + uv_i.y()));
+
+                    Int4 index = uv_i_w.x() + uv_i_w.y() * m_resolution.x();
+
+                    auto convert_to_monochrome = [](const auto& a) {
+                        if constexpr (Channels == 3)
+                            return luminance(a);
+                        else
+                            return a;
+                    };
+
+                    Float f00 = convert_to_monochrome(fetch(index.x(), active));
+                    Float f10 = convert_to_monochrome(fetch(index.y(), active));
+                    Float f01 = convert_to_monochrome(fetch(index.z(), active));
+                    Float f11 = convert_to_monochrome(fetch(index.w(), active));
+
+                    df_xy = Vector2f(fmadd(w0.y(), f10 - f00, w1.y() * (f11 - f01)),
+                                     fmadd(w0.x(), f01 - f00, w1.x() * (f11 - f10)));
+                }
 
                 // Partials w.r.t. u and v (include uv transform by transpose multiply)
                 Matrix uv_tm = m_transform.matrix;
@@ -366,7 +782,7 @@ public:
     }
 
     Color3f eval_3(const SurfaceInteraction3f &si, Mask active = true) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::TextureEvaluate, active);
+        MTS_MASKED_METHOD(ProfilerPhase::TextureEvaluate, active);
 
         if constexpr (Channels != 3) {
             ENOKI_MARK_USED(si);
@@ -391,25 +807,358 @@ public:
                       m_inv_resolution_y(value.y())),
               mod = value - div * m_resolution;
 
-            masked(mod, mod < 0) += T(m_resolution);
+            // The division truncates, the copies left of the origin are offset by one
+            auto negative = mod < 0;
+            masked(mod, negative) += T(m_resolution);
 
             if (m_wrap_mode == WrapMode::Mirror)
-                mod = select(eq(div & 1, 0) ^ (value < 0), mod, m_resolution - 1 - mod);
+                mod = select(eq(div & 1, 0) ^ negative, mod, m_resolution - 1 - mod);
 
             return mod;
         }
     }
 
-    MTS_INLINE auto interpolate(const SurfaceInteraction3f &si, Mask active) const {
-        // Storage representation underlying this texture
+    /**
+     * \brief Map the lower texel of a bilinear lookup to its cell in \ref
+     * m_grad_data
+     *
+     * Also returns whether the lookup traverses the cell in reverse order
+     * along each axis, which happens in the mirrored copies of the image.
+     */
+    std::pair<Vector2i, mask_t<Vector2f>> gradient_cell(const Vector2i &uv_i) const {
+        using Mask2 = mask_t<Vector2f>;
+
+        if (m_wrap_mode == WrapMode::Clamp)
+            return { clamp(uv_i, -1, m_resolution - 1) + 1, Mask2(false) };
+
+        Vector2i div(m_inv_resolution_x(uv_i.x()), m_inv_resolution_y(uv_i.y())),
+                 mod = uv_i - div * m_resolution;
+
+        auto negative = mod < 0;
+        masked(div, negative) -= 1;
+        masked(mod, negative) += m_resolution;
+
+        if (m_wrap_mode == WrapMode::Repeat)
+            return { mod + 1, Mask2(false) };
+
+        // Every other copy of the image is mirrored
+        auto odd = neq(div & 1, 0);
+        return { select(odd, m_resolution - 1 - mod, mod + 1),
+                 reinterpret_array<Mask2>(odd) };
+    }
+
+    /// Look up texels by their index within the finest resolution level
+    MTS_INLINE auto fetch(const Int32 &index, const Mask &active) const {
         using StorageType = std::conditional_t<Channels == 1, Float, Color3f>;
 
+        if constexpr (!is_array_v<Float> && std::is_same_v<Float, float>) {
+            if (m_tiled) {
+                float value[Channels] = { };
+                if (active)
+                    m_tiled->fetch(0, (uint32_t) index % (uint32_t) m_resolution.x(),
+                                   (uint32_t) index / (uint32_t) m_resolution.x(), value);
+                if constexpr (Channels == 1)
+                    return StorageType(value[0]);
+                else
+                    return StorageType(value[0], value[1], value[2]);
+            }
+        }
+
+        return gather<StorageType>(m_data, index, active);
+    }
+
+    /// Apply the wrap mode to a single coordinate at the given resolution
+    int32_t wrap_scalar(int32_t value, int32_t res) const {
+        if (m_wrap_mode == WrapMode::Clamp)
+            return std::min(std::max(value, 0), res - 1);
+
+        int32_t div = value / res, mod = value - div * res;
+        bool negative = mod < 0;
+        if (negative)
+            mod += res;
+        if (m_wrap_mode == WrapMode::Mirror && !(((div & 1) == 0) ^ negative))
+            mod = res - 1 - mod;
+        return mod;
+    }
+
+    /**
+     * \brief Bilinearly interpolate four texels with the given weights
+     *
+     * In spectral variants, the stored coefficients are either evaluated per
+     * texel, or interpolated and evaluated once when
+     * \c m_interpolate_coefficients is set.
+     */
+    MTS_INLINE ResultType bilerp(const StorageType &v00, const StorageType &v10,
+                                 const StorageType &v01, const StorageType &v11,
+                                 const Point2f &w0, const Point2f &w1,
+                                 const Wavelength &wavelengths) const {
+        if constexpr (is_spectral_v<Spectrum> && !Raw && Channels == 3) {
+            if (m_interpolate_coefficients) {
+                StorageType v0 = fmadd(w0.x(), v00, w1.x() * v10),
+                            v1 = fmadd(w0.x(), v01, w1.x() * v11);
+
+                return srgb_model_eval<UnpolarizedSpectrum>(
+                    fmadd(w0.y(), v0, w1.y() * v1), wavelengths);
+            }
+
+            // Evaluate spectral upsampling model from stored coefficients
+            UnpolarizedSpectrum c00, c10, c01, c11, c0, c1;
+
+            c00 = srgb_model_eval<UnpolarizedSpectrum>(v00, wavelengths);
+            c10 = srgb_model_eval<UnpolarizedSpectrum>(v10, wavelengths);
+            c01 = srgb_model_eval<UnpolarizedSpectrum>(v01, wavelengths);
+            c11 = srgb_model_eval<UnpolarizedSpectrum>(v11, wavelengths);
+
+            c0 = fmadd(w0.x(), c00, w1.x() * c10);
+            c1 = fmadd(w0.x(), c01, w1.x() * c11);
+
+            return fmadd(w0.y(), c0, w1.y() * c1);
+        } else {
+            ENOKI_MARK_USED(wavelengths);
+            StorageType v0 = fmadd(w0.x(), v00, w1.x() * v10),
+                        v1 = fmadd(w0.x(), v01, w1.x() * v11);
+
+            return fmadd(w0.y(), v0, w1.y() * v1);
+        }
+    }
+
+    /// Bilinearly interpolate a MIP level of a tiled texture (scalar variants)
+    ResultType eval_tiled_level(uint32_t level, Point2f uv,
+                                const Wavelength &wavelengths) const {
+        int32_t width  = (int32_t) m_tiled->width(level),
+                height = (int32_t) m_tiled->height(level);
+
+        uv = fmadd(uv, Vector2f(Float(width), Float(height)), -.5f);
+        Vector2i uv_i = floor2int<Vector2i>(uv);
+        Point2f w1 = uv - Point2f(uv_i),
+                w0 = 1.f - w1;
+
+        auto texel = [&](int32_t x, int32_t y) -> StorageType {
+            float value[Channels];
+            m_tiled->fetch(level, (uint32_t) wrap_scalar(x, width),
+                           (uint32_t) wrap_scalar(y, height), value);
+            if constexpr (Channels == 1)
+                return value[0];
+            else
+                return StorageType(value[0], value[1], value[2]);
+        };
+
+        return bilerp(texel(uv_i.x(),     uv_i.y()),
+                      texel(uv_i.x() + 1, uv_i.y()),
+                      texel(uv_i.x(),     uv_i.y() + 1),
+                      texel(uv_i.x() + 1, uv_i.y() + 1),
+                      w0, w1, wavelengths);
+    }
+
+    /// Apply the wrap mode to coordinates of a MIP level with varying resolution
+    template <typename T> T wrap_level(const T &value, const Int32 &res) const {
+        if (m_wrap_mode == WrapMode::Clamp) {
+            return clamp(value, 0, res - 1);
+        } else {
+            T div = value / res,
+              mod = value - div * res;
+
+            auto negative = mod < 0;
+            masked(mod, negative) += T(res);
+
+            if (m_wrap_mode == WrapMode::Mirror)
+                mod = select(eq(div & 1, 0) ^ negative, mod, res - 1 - mod);
+
+            return mod;
+        }
+    }
+
+    /// Bilinearly interpolate the (per-lane) MIP level of a resident texture
+    ResultType eval_level(const Int32 &level, Point2f uv,
+                          const Wavelength &wavelengths, Mask active) const {
+        using Int4 = Array<Int32, 4>;
+
+        Int32 base   = level * 3,
+              width  = gather<Int32>(m_level_info, base, active),
+              height = gather<Int32>(m_level_info, base + 1, active),
+              offset = gather<Int32>(m_level_info, base + 2, active);
+
+        uv = fmadd(uv, Vector2f(Float(width), Float(height)), -.5f);
+        Vector2i uv_i = floor2int<Vector2i>(uv);
+        Point2f w1 = uv - Point2f(uv_i),
+                w0 = 1.f - w1;
+
+        Int4 x = wrap_level(Int4(0, 1, 0, 1) + uv_i.x(), width),
+             y = wrap_level(Int4(0, 0, 1, 1) + uv_i.y(), height),
+             index = offset + x + y * width;
+
+        // Level 0 is stored in 'm_data', all coarser levels in 'm_mip_data'
+        Mask finest = eq(level, 0);
+        auto texel = [&](const Int32 &i) -> StorageType {
+            return select(finest, fetch(i, active && finest),
+                          gather<StorageType>(m_mip_data, i, active && !finest));
+        };
+
+        return bilerp(texel(index.x()), texel(index.y()),
+                      texel(index.z()), texel(index.w()),
+                      w0, w1, wavelengths);
+    }
+
+    /// Trilinearly interpolate between the two MIP levels enclosing \c level
+    ResultType eval_trilinear(const Point2f &uv, const Float &level,
+                              const Wavelength &wavelengths, Mask active) const {
+        if constexpr (!is_array_v<Float>) {
+            if (m_tiled) {
+                uint32_t level_0 = (uint32_t) level,
+                         level_1 = std::min(level_0 + 1, m_tiled->level_count() - 1);
+                Float t = level - Float(level_0);
+                return fmadd(1.f - t, eval_tiled_level(level_0, uv, wavelengths),
+                             t * eval_tiled_level(level_1, uv, wavelengths));
+            }
+        }
+
+        Int32 level_0 = floor2int<Int32>(level),
+              level_1 = min(level_0 + 1, Int32(m_level_count - 1));
+        Float t = level - Float(level_0);
+
+        return fmadd(1.f - t, eval_level(level_0, uv, wavelengths, active),
+                     t * eval_level(level_1, uv, wavelengths, active));
+    }
+
+    /**
+     * \brief Filtered lookup over the footprint spanned by the UV partials
+     *
+     * The trilinear filter selects the MIP level from the larger axis of the
+     * footprint. The anisotropic filter selects it from the smaller axis and
+     * averages Gaussian-weighted trilinear probes along the larger one.
+     */
+    ResultType interpolate_mip(const SurfaceInteraction3f &si, const Point2f &uv,
+                               Mask active) const {
+        ScalarVector2f res(m_resolution);
+        uint32_t level_count = m_level_count;
+        if constexpr (!is_array_v<Float>) {
+            if (m_tiled)
+                level_count = m_tiled->level_count();
+        }
+        Float max_level = Float(level_count - 1);
+
+        // Footprint of the lookup (half-widths in UV space)
+        Vector2f duv_dx = m_transform * si.duv_dx,
+                 duv_dy = m_transform * si.duv_dy;
+
+        if (m_filter_type != FilterType::Anisotropic) {
+            Float width = 2.f * max(hmax(abs(duv_dx * res)), hmax(abs(duv_dy * res))),
+                  level = clamp(log2(max(width, 1.f)), 0.f, max_level);
+            return eval_trilinear(uv, level, si.wavelengths, active);
+        }
+
+        Mask swap = squared_norm(duv_dy * res) > squared_norm(duv_dx * res);
+        Vector2f major = select(swap, duv_dy, duv_dx),
+                 minor = select(swap, duv_dx, duv_dy);
+
+        Float major_length = norm(major * res),
+              minor_length = norm(minor * res);
+
+        // Blur along the minor axis when the footprint is too eccentric
+        minor_length = max(minor_length, major_length / m_max_anisotropy);
+
+        Float probe_count = clamp(ceil(major_length / max(minor_length, 1e-8f)),
+                                  1.f, m_max_anisotropy),
+              level = clamp(log2(max(2.f * minor_length, 1.f)), 0.f, max_level);
+
+        ResultType result(0.f);
+        Float weight_sum(0.f);
+        uint32_t max_probes = (uint32_t) ceil(m_max_anisotropy);
+
+        for (uint32_t i = 0; i < max_probes; ++i) {
+            Mask probe_active = active && Float(i) < probe_count;
+            if (none_or<false>(probe_active))
+                break;
+
+            // Probe position relative to the center, in [-1/2, 1/2]
+            Float offset = (Float(i) + .5f) / probe_count - .5f,
+                  weight = select(probe_active, exp(-8.f * sqr(offset)), 0.f);
+
+            result += eval_trilinear(Point2f(fmadd(major, 2.f * offset, uv)), level,
+                                     si.wavelengths, probe_active) * weight;
+            weight_sum += weight;
+        }
+
+        return result / select(weight_sum > 0.f, weight_sum, 1.f);
+    }
+
+    /// Entry of the per-thread lookup cache
+    struct CacheEntry {
+        const BitmapTextureImpl *texture = nullptr;
+        uint32_t revision = 0;
+        Point2f uv;
+        Vector2f duv_dx, duv_dy;
+        Wavelength wavelengths;
+        ResultType value;
+    };
+
+    /// Number of entries of the (direct-mapped) per-thread lookup cache
+    static constexpr size_t cache_size = 16;
+
+    /// Generate a new revision number for the lookup cache
+    static uint32_t next_revision() {
+        static std::atomic<uint32_t> counter { 0 };
+        return ++counter;
+    }
+
+    /**
+     * \brief Look up a texture value, consulting the per-thread cache first
+     * (scalar variants)
+     *
+     * The cache is indexed by the address of the texture and stores the
+     * last lookup of a texture along with all inputs it depends on. This
+     * catches repeated queries at the same surface interaction, which
+     * e.g. occur when a texture is referenced by several BSDF parameters,
+     * or when \ref eval() is called for emitter sampling after \ref sample().
+     */
+    MTS_INLINE ResultType interpolate(const SurfaceInteraction3f &si, Mask active) const {
+        if constexpr (!is_array_v<Float>) {
+            if (m_cache) {
+                static thread_local CacheEntry cache[cache_size];
+                CacheEntry &entry = cache[((uintptr_t) this / sizeof(void *)) % cache_size];
+
+                bool hit = entry.texture == this && entry.revision == m_revision &&
+                           all(eq(entry.uv, si.uv)) && all(eq(entry.duv_dx, si.duv_dx)) &&
+                           all(eq(entry.duv_dy, si.duv_dy));
+                if constexpr (is_spectral_v<Spectrum>)
+                    hit &= all(eq(entry.wavelengths, si.wavelengths));
+
+                if (likely(hit))
+                    return entry.value;
+
+                entry.texture     = this;
+                entry.revision    = m_revision;
+                entry.uv          = si.uv;
+                entry.duv_dx      = si.duv_dx;
+                entry.duv_dy      = si.duv_dy;
+                entry.wavelengths = si.wavelengths;
+                entry.value       = interpolate_uncached(si, active);
+                return entry.value;
+            }
+        }
+
+        return interpolate_uncached(si, active);
+    }
+
+    MTS_INLINE ResultType interpolate_uncached(const SurfaceInteraction3f &si, Mask active) const {
         if constexpr (!is_array_v<Mask>)
             active = true;
 
         Point2f uv = m_transform.transform_affine(si.uv);
 
-        if (m_filter_type == FilterType::Bilinear) {
+        // Filter over the lookup footprint when MIP levels are available
+        if (m_filter_type != FilterType::Nearest && si.has_uv_partials()) {
+            bool has_levels = m_level_count > 1;
+            if constexpr (!is_array_v<Float>) {
+                if (m_tiled)
+                    has_levels = true;
+            }
+
+            if (has_levels)
+                return interpolate_mip(si, uv, active);
+        }
+
+        if (m_filter_type != FilterType::Nearest) {
             using Int4  = Array<Int32, 4>;
             using Int24 = Array<Int4, 2>;
 
@@ -430,31 +1179,12 @@ public:
             Int4 index = uv_i_w.x() + uv_i_w.y() * m_resolution.x();
 
             /// TODO: merge into a single gather with the upcoming Enoki
-            StorageType v00 = gather<StorageType>(m_data, index.x(), active),
-                        v10 = gather<StorageType>(m_data, index.y(), active),
-                        v01 = gather<StorageType>(m_data, index.z(), active),
-                        v11 = gather<StorageType>(m_data, index.w(), active);
-
-            // Bilinear interpolation
-            if constexpr (is_spectral_v<Spectrum> && !Raw && Channels == 3) {
-                // Evaluate spectral upsampling model from stored coefficients
-                UnpolarizedSpectrum c00, c10, c01, c11, c0, c1;
-
-                c00 = srgb_model_eval<UnpolarizedSpectrum>(v00, si.wavelengths);
-                c10 = srgb_model_eval<UnpolarizedSpectrum>(v10, si.wavelengths);
-                c01 = srgb_model_eval<UnpolarizedSpectrum>(v01, si.wavelengths);
-                c11 = srgb_model_eval<UnpolarizedSpectrum>(v11, si.wavelengths);
+            StorageType v00 = fetch(index.x(), active),
+                        v10 = fetch(index.y(), active),
+                        v01 = fetch(index.z(), active),
+                        v11 = fetch(index.w(), active);
 
-                c0 = fmadd(w0.x(), c00, w1.x() * c10);
-                c1 = fmadd(w0.x(), c01, w1.x() * c11);
-
-                return fmadd(w0.y(), c0, w1.y() * c1);
-            } else {
-                StorageType v0 = fmadd(w0.x(), v00, w1.x() * v10),
-                            v1 = fmadd(w0.x(), v01, w1.x() * v11);
-
-                return fmadd(w0.y(), v0, w1.y() * v1);
-            }
+            return bilerp(v00, v10, v01, v11, w0, w1, si.wavelengths);
         } else {
             // Scale to bitmap resolution, no shift
             uv *= m_resolution;
@@ -465,7 +1195,7 @@ public:
 
             Int32 index = uv_i_w.x() + uv_i_w.y() * m_resolution.x();
 
-            StorageType v = gather<StorageType>(m_data, index, active);
+            StorageType v = fetch(index, active);
             if constexpr (is_spectral_v<Spectrum> && !Raw && Channels == 3)
                 return srgb_model_eval<UnpolarizedSpectrum>(v, si.wavelengths);
             else
@@ -524,7 +1254,7 @@ public:
             }
         }
 
-        if (m_filter_type == FilterType::Bilinear) {
+        if (m_filter_type != FilterType::Nearest) {
             using Int4  = Array<Int32, 4>;
             using Int24 = Array<Int4, 2>;
 
@@ -559,15 +1289,53 @@ public:
     }
 
     void traverse(TraversalCallback *callback) override {
-        callback->put_parameter("data", m_data);
+        if (!m_tiled) {
+            /* The data may be modified in place through the parameter map,
+               detach it from the storage that is shared with other textures */
+            if constexpr (!is_cuda_array_v<Float>) {
+                if (m_data.data() == m_storage->data.data())
+                    m_data = DynamicBuffer<Float>::copy(m_data.data(), m_data.size());
+            }
+            callback->put_parameter("data", m_data);
+        }
         callback->put_parameter("resolution", m_resolution);
         callback->put_parameter("transform", m_transform);
     }
 
+    void account_memory(MemoryReport *report) const override {
+        // Buffers that were modified or rebuilt no longer refer to the shared storage
+        if (m_storage) {
+            report->visit(m_storage.get());
+            if (m_data.data() != m_storage->data.data())
+                report->add_array(MemoryCategory::Textures, m_data);
+            if (m_mip_data.data() != m_storage->mip_data.data()) {
+                report->add_array(MemoryCategory::Textures, m_mip_data);
+                report->add_array(MemoryCategory::Textures, m_level_info);
+            }
+        } else {
+            report->add_array(MemoryCategory::Textures, m_data);
+            report->add_array(MemoryCategory::Textures, m_mip_data);
+            report->add_array(MemoryCategory::Textures, m_level_info);
+        }
+        report->add_array(MemoryCategory::Textures, m_grad_data);
+
+        if (m_distr2d)
+            report->add(MemoryCategory::Distributions, m_distr2d->memory_usage(),
+                        is_cuda_array_v<Float>);
+    }
+
     void parameters_changed(const std::vector<std::string> &keys = {}) override {
+        m_revision = next_revision();
+
         if (keys.empty() || string::contains(keys, "data")) {
             /// Convert m_data into a managed array (available in CPU/GPU address space)
             rebuild_internals(true, m_distr2d != nullptr);
+
+            if (m_level_count > 1)
+                rebuild_levels();
+
+            if (slices(m_grad_data) > 0)
+                rebuild_gradient();
         }
     }
 
@@ -585,6 +1353,7 @@ public:
             << "  name = \"" << m_name << "\"," << std::endl
             << "  resolution = \"" << m_resolution << "\"," << std::endl
             << "  raw = " << (int) Raw << "," << std::endl
+            << "  tiled = " << (int) (m_tiled != nullptr) << "," << std::endl
             << "  mean = " << m_mean << "," << std::endl
             << "  transform = " << string::indent(m_transform) << std::endl
             << "]";
@@ -594,17 +1363,135 @@ public:
     MTS_DECLARE_CLASS()
 
 protected:
+    /**
+     * \brief Reference a buffer of the (possibly shared) storage
+     *
+     * CUDA arrays are reference counted, other buffers are mapped and remain
+     * valid as long as \ref m_storage is alive.
+     */
+    template <typename Buffer> static Buffer share(const Buffer &buffer) {
+        if constexpr (!is_cuda_array_v<Float>)
+            return Buffer::map((void *) buffer.data(), buffer.size());
+        else
+            return buffer;
+    }
+
+    /**
+     * \brief Recompute the coarser MIP levels from \c m_data following an
+     * update
+     *
+     * Unlike the initial pyramid, this box-filters the stored representation,
+     * i.e. the coefficients of the spectral model in spectral modes.
+     */
+    void rebuild_levels() {
+        int32_t width = m_resolution.x(), height = m_resolution.y();
+        std::vector<int32_t> info = { width, height, 0 };
+        std::vector<ScalarFloat> data,
+            current(m_data.data(), m_data.data() + hprod(m_resolution) * Channels),
+            next;
+
+        for (uint32_t l = 1; l < m_level_count; ++l) {
+            int32_t next_width  = std::max(width / 2, 1),
+                    next_height = std::max(height / 2, 1);
+            next.resize((size_t) next_width * next_height * Channels);
+
+            for (int32_t y = 0; y < next_height; ++y) {
+                int32_t y0 = std::min(2 * y, height - 1),
+                        y1 = std::min(2 * y + 1, height - 1);
+                for (int32_t x = 0; x < next_width; ++x) {
+                    int32_t x0 = std::min(2 * x, width - 1),
+                            x1 = std::min(2 * x + 1, width - 1);
+                    for (uint32_t c = 0; c < Channels; ++c)
+                        next[((size_t) y * next_width + x) * Channels + c] = .25f * (
+                            current[((size_t) y0 * width + x0) * Channels + c] +
+                            current[((size_t) y0 * width + x1) * Channels + c] +
+                            current[((size_t) y1 * width + x0) * Channels + c] +
+                            current[((size_t) y1 * width + x1) * Channels + c]);
+                }
+            }
+
+            info.push_back(next_width);
+            info.push_back(next_height);
+            info.push_back((int32_t) (data.size() / Channels));
+            data.insert(data.end(), next.begin(), next.end());
+            current.swap(next);
+            width = next_width;
+            height = next_height;
+        }
+
+        m_mip_data = DynamicBuffer<Float>::copy(data.data(), data.size());
+        m_level_info = DynamicBuffer<Int32>::copy(info.data(), info.size());
+    }
+
+    /**
+     * \brief Precompute the texel differences of the bilinear interpolant
+     * for \ref eval_1_grad()
+     *
+     * The cell \c (x, y) spans the (wrapped) texels <tt>x - 1 .. x</tt> and
+     * <tt>y - 1 .. y</tt>, hence the cells of clamped lookups beyond the
+     * image boundary are also included.
+     */
+    void rebuild_gradient() {
+        int32_t width = m_resolution.x(), height = m_resolution.y();
+
+        DynamicBuffer<Float> texels = m_data.managed();
+        if constexpr (is_cuda_array_v<Float>)
+            cuda_sync();
+
+        auto value = [&](int32_t x, int32_t y) {
+            const ScalarFloat *ptr = texels.data() + ((size_t) y * width + x) * Channels;
+            if constexpr (Channels == 3)
+                return luminance(load_unaligned<ScalarColor3f>(ptr));
+            else
+                return *ptr;
+        };
+
+        std::vector<ScalarFloat> data((size_t) (width + 1) * (height + 1) * 4);
+        ScalarFloat *out = data.data();
+        for (int32_t y = 0; y <= height; ++y) {
+            int32_t y0 = wrap_scalar(y - 1, height), y1 = wrap_scalar(y, height);
+            for (int32_t x = 0; x <= width; ++x) {
+                int32_t x0 = wrap_scalar(x - 1, width), x1 = wrap_scalar(x, width);
+                ScalarFloat f00 = value(x0, y0), f10 = value(x1, y0),
+                            f01 = value(x0, y1), f11 = value(x1, y1);
+
+                // Horizontal differences of both rows, vertical ones of both columns
+                *out++ = f10 - f00;
+                *out++ = f11 - f01;
+                *out++ = f01 - f00;
+                *out++ = f11 - f10;
+            }
+        }
+
+        m_grad_data = DynamicBuffer<Float>::copy(data.data(), data.size());
+    }
+
     /**
      * \brief Recompute mean and 2D sampling distribution (if requested)
      * following an update
      */
     void rebuild_internals(bool init_mean, bool init_distr) {
         // Recompute the mean texture value following an update
-        m_data = m_data.managed();
-        const ScalarFloat *ptr = m_data.data();
+        size_t pixel_count = (size_t) hprod(m_resolution);
+        std::unique_ptr<ScalarFloat[]> tiled_data;
+
+        if (m_tiled) {
+            /* Tiled textures are not resident: temporarily page in the
+               finest level through the texture cache (scalar variants) */
+            if constexpr (std::is_same_v<ScalarFloat, float>) {
+                tiled_data.reset(new ScalarFloat[pixel_count * Channels]);
+                for (size_t i = 0; i < pixel_count; ++i)
+                    m_tiled->fetch(0, uint32_t(i % m_resolution.x()),
+                                   uint32_t(i / m_resolution.x()),
+                                   tiled_data.get() + i * Channels);
+            }
+        } else {
+            m_data = m_data.managed();
+        }
+
+        const ScalarFloat *ptr = m_tiled ? tiled_data.get() : m_data.data();
 
         double mean = 0.0;
-        size_t pixel_count = (size_t) hprod(m_resolution);
         bool bad = false;
 
         if (Channels == 3) {
@@ -662,13 +1549,202 @@ protected:
     ScalarFloat m_mean;
     FilterType m_filter_type;
     WrapMode m_wrap_mode;
+    ScalarFloat m_max_anisotropy;
+    bool m_interpolate_coefficients;
+
+    /* Optional: per-thread cache of recent lookups (scalar variants). The
+       revision is globally unique and renewed whenever the parameters change,
+       which also invalidates entries of a previous texture at the same address. */
+    bool m_cache;
+    uint32_t m_revision = next_revision();
+
+    /* Optional: coarser MIP levels. 'm_level_info' stores the width, height,
+       and pixel offset of every level, where level 0 refers to 'm_data' */
+    DynamicBuffer<Float> m_mip_data;
+    DynamicBuffer<Int32> m_level_info;
+    uint32_t m_level_count = 1;
+
+    // Optional: texel differences for eval_1_grad(), see \ref rebuild_gradient()
+    DynamicBuffer<Float> m_grad_data;
+
+    // Optional: tiled representation that is paged in by the texture cache
+    ref<const TiledTexture> m_tiled;
+
+    // Texel data referenced by the buffers above (unless the texture is tiled)
+    ref<const Storage> m_storage;
 
     // Optional: distribution for importance sampling
     mutable tbb::spin_mutex m_mutex;
     std::unique_ptr<DiscreteDistribution2D<Float>> m_distr2d;
 };
 
+/**
+ * UDIM texture set, whose unit squares in UV space are separate bitmap
+ * textures that are only created once a lookup falls into them
+ */
+template <typename Float, typename Spectrum>
+class BitmapTextureUDIM final : public Texture<Float, Spectrum> {
+public:
+    MTS_IMPORT_TYPES(Texture)
+
+    /// Number of squares along the U axis, and maximum number of rows
+    static constexpr uint32_t TilesU = 10, TilesV = 100;
+
+    BitmapTextureUDIM(const Properties &props, const std::string &filename,
+                      const ScalarTransform3f &transform)
+        : Texture(props), m_transform(transform), m_tile_props(props),
+          m_tiles(TilesU * TilesV), m_once(new std::once_flag[TilesU * TilesV]) {
+        if constexpr (is_array_v<Float>)
+            Throw("UDIM texture sets are only supported by scalar variants!");
+
+        size_t pos = filename.find("<UDIM>");
+        m_prefix = filename.substr(0, pos);
+        m_suffix = filename.substr(pos + 6);
+        m_name = fs::path(filename).filename().string();
+
+        // Tile paths are resolved when they are first accessed, possibly by another thread
+        m_resolver = new FileResolver(*Thread::thread()->file_resolver());
+
+        /* The other parameters are forwarded to the textures of the squares,
+           which only query them once they are created */
+        for (const std::string &name : props.property_names())
+            props.mark_queried(name);
+        m_tile_props.remove_property("filename");
+        m_tile_props.remove_property("to_uv");
+        m_tile_props.remove_property("tiled_filename");
+        if (!m_tile_props.has_property("wrap_mode"))
+            m_tile_props.set_string("wrap_mode", "clamp");
+        if (!m_tile_props.has_property("tiled") && std::is_same_v<ScalarFloat, float>)
+            m_tile_props.set_bool("tiled", true);
+
+        // Check that the pattern matches anything (without loading any images)
+        bool found = false;
+        for (uint32_t i = 0; i < TilesU * TilesV && !found; ++i)
+            found = fs::is_regular_file(tile_path(i));
+        if (!found)
+            Throw("UDIM texture set \"%s\" doesn't contain any images!", filename);
+    }
+
+    UnpolarizedSpectrum eval(const SurfaceInteraction3f &si, Mask active) const override {
+        MTS_MASKED_METHOD(ProfilerPhase::TextureEvaluate, active);
+        auto [tile, si_tile] = lookup(si);
+        return tile ? tile->eval(si_tile, active) : UnpolarizedSpectrum(0.f);
+    }
+
+    Float eval_1(const SurfaceInteraction3f &si, Mask active = true) const override {
+        MTS_MASKED_METHOD(ProfilerPhase::TextureEvaluate, active);
+        auto [tile, si_tile] = lookup(si);
+        return tile ? tile->eval_1(si_tile, active) : Float(0.f);
+    }
+
+    Vector2f eval_1_grad(const SurfaceInteraction3f &si, Mask active = true) const override {
+        MTS_MASKED_METHOD(ProfilerPhase::TextureEvaluate, active);
+        auto [tile, si_tile] = lookup(si);
+        if (!tile)
+            return Vector2f(0.f);
+        // Chain rule for the UV transformation of the texture set
+        Vector2f grad = tile->eval_1_grad(si_tile, active);
+        return Vector2f(transpose(m_transform.matrix) * Vector3f(grad.x(), grad.y(), 0.f));
+    }
+
+    Color3f eval_3(const SurfaceInteraction3f &si, Mask active = true) const override {
+        MTS_MASKED_METHOD(ProfilerPhase::TextureEvaluate, active);
+        auto [tile, si_tile] = lookup(si);
+        return tile ? tile->eval_3(si_tile, active) : Color3f(0.f);
+    }
+
+    /// Average over all squares of the set, which loads every one of them
+    ScalarFloat mean() const override {
+        double mean = 0.0;
+        size_t count = 0;
+        for (uint32_t i = 0; i < TilesU * TilesV; ++i) {
+            if (const Base *t = tile(i)) {
+                mean += (double) t->mean();
+                count++;
+            }
+        }
+        return ScalarFloat(count > 0 ? mean / count : 0.0);
+    }
+
+    bool is_spatially_varying() const override { return true; }
+
+    std::string to_string() const override {
+        size_t loaded = 0;
+        for (uint32_t i = 0; i < TilesU * TilesV; ++i)
+            loaded += m_tiles[i] ? 1 : 0;
+
+        std::ostringstream oss;
+        oss << "BitmapTextureUDIM[" << std::endl
+            << "  name = \"" << m_name << "\"," << std::endl
+            << "  loaded = " << loaded << "," << std::endl
+            << "  transform = " << string::indent(m_transform) << std::endl
+            << "]";
+        return oss.str();
+    }
+
+    MTS_DECLARE_CLASS()
+
+protected:
+    /// Path of the image with the given index (UDIM number - 1001)
+    fs::path tile_path(uint32_t index) const {
+        return m_resolver->resolve(m_prefix + std::to_string(1001 + index) + m_suffix);
+    }
+
+    /// Return the texture of a square, creating it upon first access
+    const Base *tile(uint32_t index) const {
+        std::call_once(m_once[index], [&]() {
+            fs::path path = tile_path(index);
+            if (!fs::is_regular_file(path))
+                return;
+
+            Properties props(m_tile_props);
+            props.set_string("filename", path.string());
+            ref<Base> texture = PluginManager::instance()->create_object<Base>(props);
+            auto unqueried = props.unqueried();
+            if (!unqueried.empty())
+                Log(Warn, "UDIM texture set \"%s\": unreferenced properties %s",
+                    m_name, unqueried);
+
+            std::vector<ref<Object>> children = texture->expand();
+            m_tiles[index] = children.empty() ? texture : (Base *) children[0].get();
+            Log(Debug, "UDIM texture set \"%s\": loaded \"%s\"", m_name,
+                path.filename().string());
+        });
+        return m_tiles[index].get();
+    }
+
+    /**
+     * Find the square that contains the lookup and return the interaction
+     * in its local UV coordinates
+     */
+    std::pair<const Base *, SurfaceInteraction3f> lookup(const SurfaceInteraction3f &si) const {
+        SurfaceInteraction3f si_tile(si);
+        Point2f uv = m_transform.transform_affine(si.uv);
+        si_tile.duv_dx = m_transform * si.duv_dx;
+        si_tile.duv_dy = m_transform * si.duv_dy;
+
+        const Base *result = nullptr;
+        if constexpr (!is_array_v<Float>) {
+            Point2i uv_i = floor2int<Point2i>(uv);
+            if (uv_i.x() >= 0 && uv_i.x() < (int32_t) TilesU &&
+                uv_i.y() >= 0 && uv_i.y() < (int32_t) TilesV)
+                result = tile((uint32_t) (uv_i.y() * TilesU + uv_i.x()));
+            si_tile.uv = uv - Point2f(uv_i);
+        }
+        return { result, si_tile };
+    }
+
+protected:
+    ScalarTransform3f m_transform;
+    std::string m_prefix, m_suffix, m_name;
+    ref<FileResolver> m_resolver;
+    Properties m_tile_props;
+    mutable std::vector<ref<Base>> m_tiles;
+    std::unique_ptr<std::once_flag[]> m_once;
+};
+
 MTS_IMPLEMENT_CLASS_VARIANT(BitmapTexture, Texture)
+MTS_IMPLEMENT_CLASS_VARIANT(BitmapTextureUDIM, Texture)
 MTS_EXPORT_PLUGIN(BitmapTexture, "Bitmap texture")
 
 
@@ -44,7 +44,7 @@ public:
     }
 
     UnpolarizedSpectrum eval(const SurfaceInteraction3f &it, Mask active) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::TextureEvaluate, active);
+        MTS_MASKED_METHOD(ProfilerPhase::TextureEvaluate, active);
 
         Point2f uv = m_transform.transform_affine(it.uv);
         mask_t<Point2f> mask = uv - floor(uv) > .5f;
@@ -65,7 +65,7 @@ public:
     }
 
     Float eval_1(const SurfaceInteraction3f &it, Mask active) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::TextureEvaluate, active);
+        MTS_MASKED_METHOD(ProfilerPhase::TextureEvaluate, active);
 
         Point2f uv = m_transform.transform_affine(it.uv);
         mask_t<Point2f> mask = (uv - floor(uv)) > .5f;
@@ -15,7 +15,7 @@ public:
     }
 
     UnpolarizedSpectrum eval(const Interaction3f &it, Mask active) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::TextureEvaluate, active);
+        MTS_MASKED_METHOD(ProfilerPhase::TextureEvaluate, active);
         return eval_impl(it, active);
     }
 
@@ -1,9 +1,12 @@
 #include <enoki/stl.h>
+#include <enoki/half.h>
 
+#include <mitsuba/core/memreport.h>
 #include <mitsuba/core/properties.h>
 #include <mitsuba/core/spectrum.h>
 #include <mitsuba/core/string.h>
 #include <mitsuba/core/transform.h>
+#include <mitsuba/core/util.h>
 #include <mitsuba/render/srgb.h>
 #include <mitsuba/render/texture.h>
 #include <mitsuba/render/volume_texture.h>
@@ -14,6 +17,77 @@ NAMESPACE_BEGIN(mitsuba)
 
 enum class FilterType { Nearest, Trilinear };
 enum class WrapMode { Repeat, Mirror, Clamp };
+enum class GridStorage { Float32, Float16, UInt16, UInt8 };
+
+/// Voxel data stored at reduced precision (see the \c storage parameter)
+template <typename Float> struct CompactGridData {
+    using ScalarFloat = scalar_t<Float>;
+
+    GridStorage storage = GridStorage::Float32;
+    DynamicBuffer<replace_scalar_t<Float, enoki::half>> data_f16;
+    DynamicBuffer<replace_scalar_t<Float, uint16_t>> data_u16;
+    DynamicBuffer<replace_scalar_t<Float, uint8_t>> data_u8;
+
+    /// Per-channel dequantization parameters: <tt>value = offset + scale * q</tt>
+    Array<ScalarFloat, 4> offset = 0.f, scale = 1.f;
+};
+
+/// Side length (log2) of the voxel blocks whose maxima bound subregions
+constexpr int32_t BlockShift = 3;
+
+/**
+ * Compute the maximum of every block of voxels, considering \c count
+ * channels starting at \c first out of \c stride channels per voxel.
+ */
+template <typename ScalarFloat>
+std::vector<ScalarFloat> grid_block_max(const ScalarFloat *data, const Vector<int32_t, 3> &shape,
+                                        uint32_t stride, uint32_t first, uint32_t count) {
+    Vector<int32_t, 3> block_res = ((shape - 1) >> BlockShift) + 1;
+    std::vector<ScalarFloat> result(hprod(block_res), -math::Infinity<ScalarFloat>);
+    for (int32_t z = 0; z < shape.z(); ++z) {
+        for (int32_t y = 0; y < shape.y(); ++y) {
+            for (int32_t x = 0; x < shape.x(); ++x) {
+                const ScalarFloat *voxel =
+                    data + (((size_t) z * shape.y() + y) * shape.x() + x) * stride + first;
+                ScalarFloat &value = result[
+                    ((size_t) (z >> BlockShift) * block_res.y() + (y >> BlockShift)) *
+                    block_res.x() + (x >> BlockShift)];
+                for (uint32_t i = 0; i < count; ++i)
+                    value = std::max(value, voxel[i]);
+            }
+        }
+    }
+    return result;
+}
+
+/**
+ * Reorder an x-fastest grid into cubic bricks with a side length of
+ * <tt>2^shift</tt> voxels. The bricks are stored in x-fastest order, and so
+ * are the voxels within each brick. Partial bricks at the boundary are
+ * zero-padded.
+ */
+template <typename T>
+std::vector<T> grid_to_bricks(const T *data, const Vector<int32_t, 3> &shape,
+                              uint32_t channels, int32_t shift) {
+    int32_t brick_size = 1 << shift, mask = brick_size - 1;
+    Vector<int32_t, 3> brick_res = ((shape - 1) >> shift) + 1;
+    std::vector<T> result(((size_t) hprod(brick_res) << (3 * shift)) * channels, T(0));
+    for (int32_t z = 0; z < shape.z(); ++z) {
+        for (int32_t y = 0; y < shape.y(); ++y) {
+            for (int32_t x = 0; x < shape.x(); ++x) {
+                size_t brick = ((size_t) (z >> shift) * brick_res.y() + (y >> shift)) *
+                               brick_res.x() + (x >> shift),
+                       local = ((size_t) (z & mask) * brick_size + (y & mask)) *
+                               brick_size + (x & mask),
+                       src = ((size_t) z * shape.y() + y) * shape.x() + x,
+                       dst = (brick << (3 * shift)) + local;
+                for (uint32_t i = 0; i < channels; ++i)
+                    result[dst * channels + i] = data[src * channels + i];
+            }
+        }
+    }
+    return result;
+}
 
 
 // Forward declaration of specialized GridVolume
@@ -27,11 +101,34 @@ class GridVolumeImpl;
  * spectral upsampling is applied at loading time to convert RGB values
  * to spectra that can be used in the renderer.
  *
+ * Since every voxel stores the coefficients of the spectral upsampling model,
+ * a trilinear lookup normally evaluates this model at all eight corners. When
+ * the \c interpolate_coefficients flag is set, the coefficients (and scale
+ * factors) are interpolated instead and the model is evaluated only once.
+ * This is faster, but approximate, as the model is nonlinear in its
+ * coefficients.
+ *
  * Data layout:
  * The data must be ordered so that the following C-style (row-major) indexing
  * operation makes sense after the file has been mapped into memory:
  *     data[((zpos*yres + ypos)*xres + xpos)*channels + chan]}
  *     where (xpos, ypos, zpos, chan) denotes the lookup location.
+ *
+ * In this layout, the voxels of neighboring z-slices are far apart in memory,
+ * which is unfavorable for the incoherent lookups performed while tracking
+ * through large grids. When the \c brick_size parameter is set to a power of
+ * two (e.g. 4 or 8), the grid is reordered at load time into cubic bricks of
+ * that size, so that the eight voxels of a trilinear lookup usually share a
+ * cache line or page. Note that the \c data parameter exposed via
+ * \c traverse() then also uses the bricked order (default: 0, i.e. disabled).
+ *
+ * The \c storage parameter selects the precision of the voxel data in memory:
+ * \c float32 (the default), \c float16, or \c uint16 / \c uint8, which
+ * quantize every channel linearly between its minimum and maximum value. The
+ * values are decoded during the lookup. The global and block maxima are
+ * computed from the decoded values, so they remain valid majorants. Reduced
+ * precision grids are not differentiable and do not expose their data via
+ * \c traverse(); they are unsupported in GPU variants.
  */
 template <typename Float, typename Spectrum>
 class GridVolume final : public Volume<Float, Spectrum> {
@@ -61,19 +158,42 @@ public:
                   "\"mirror\", or \"clamp\"!", wrap_mode);
 
 
-        auto [metadata, raw_data] = read_binary_volume_data<Float>(props.string("filename"));
-        m_metadata                = metadata;
+        int32_t brick_size = props.int_("brick_size", 0);
+        if (brick_size < 0 || (brick_size & (brick_size - 1)) != 0)
+            Throw("Invalid brick size %i, must be zero (disabled) or a power of two!",
+                  brick_size);
+        m_brick_shift = 0;
+        while ((1 << m_brick_shift) < brick_size)
+            ++m_brick_shift;
+
+        std::string storage = props.string("storage", "float32");
+        if (storage == "float32")
+            m_compact.storage = GridStorage::Float32;
+        else if (storage == "float16")
+            m_compact.storage = GridStorage::Float16;
+        else if (storage == "uint16")
+            m_compact.storage = GridStorage::UInt16;
+        else if (storage == "uint8")
+            m_compact.storage = GridStorage::UInt8;
+        else
+            Throw("Invalid storage type \"%s\", must be one of: \"float32\", "
+                  "\"float16\", \"uint16\", or \"uint8\"!", storage);
+        if (is_cuda_array_v<Float> && m_compact.storage != GridStorage::Float32)
+            Throw("Reduced-precision grid storage is unsupported in GPU variants!");
+
+        MappedVolumeData volume   = map_binary_volume_data(props.string("filename"));
+        m_metadata                = volume.meta;
         m_raw                     = props.bool_("raw", false);
         ScalarUInt32 size         = hprod(m_metadata.shape);
         // Apply spectral conversion if necessary
         if (is_spectral_v<Spectrum> && m_metadata.channel_count == 3 && !m_raw) {
-            ScalarFloat *ptr = raw_data.get();
+            const float *ptr = volume.data;
             auto scaled_data = std::unique_ptr<ScalarFloat[]>(new ScalarFloat[size * 4]);
             ScalarFloat *scaled_data_ptr = scaled_data.get();
             double mean = 0.0;
             ScalarFloat max = 0.0;
             for (ScalarUInt32 i = 0; i < size; ++i) {
-                ScalarColor3f rgb = load_unaligned<ScalarColor3f>(ptr);
+                ScalarColor3f rgb(ptr[0], ptr[1], ptr[2]);
                 // TODO: Make this scaling optional if the RGB values are between 0 and 1
                 ScalarFloat scale = hmax(rgb) * 2.f;
                 ScalarColor3f rgb_norm = rgb / std::max((ScalarFloat) 1e-8, scale);
@@ -86,14 +206,128 @@ public:
             }
             m_metadata.mean = mean;
             m_metadata.max = max;
-            m_data = DynamicBuffer<Float>::copy(scaled_data.get(), size * 4);
+            upload(scaled_data.get(), 4, true);
+        } else if constexpr (std::is_same_v<ScalarFloat, float>) {
+            upload(volume.data, (uint32_t) m_metadata.channel_count, false, volume.mmap);
         } else {
-            m_data = DynamicBuffer<Float>::copy(raw_data.get(), size * m_metadata.channel_count);
+            std::vector<ScalarFloat> data(volume.data, volume.data + size * m_metadata.channel_count);
+            upload(data.data(), (uint32_t) m_metadata.channel_count, false);
         }
 
         // Mark values which are only used in the implementation class as queried
         props.mark_queried("use_grid_bbox");
         props.mark_queried("max_value");
+        props.mark_queried("interpolate_coefficients");
+    }
+
+    /**
+     * Upload the voxel data, converting it to the requested storage precision
+     * and reordering it into bricks if requested, and compute the block maxima.
+     * When \c srgb_model is set, the data holds spectral model coefficients
+     * that are bounded by the scale factor in the fourth channel.
+     *
+     * When the data resides in the memory-mapped file \c mmap and can be used
+     * as is, it is referenced directly instead of being copied.
+     */
+    void upload(const ScalarFloat *data, uint32_t channels, bool srgb_model,
+                MemoryMappedFile *mmap = nullptr) {
+        std::vector<ScalarFloat> decoded;
+        if constexpr (!is_cuda_array_v<Float>) {
+            switch (m_compact.storage) {
+                case GridStorage::Float16:
+                    encode<enoki::half>(m_compact.data_f16, data, channels, decoded);
+                    break;
+                case GridStorage::UInt16:
+                    encode<uint16_t>(m_compact.data_u16, data, channels, decoded);
+                    break;
+                case GridStorage::UInt8:
+                    encode<uint8_t>(m_compact.data_u8, data, channels, decoded);
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        size_t count = (size_t) hprod(m_metadata.shape) * channels;
+        if (decoded.empty()) {
+            /* Packets are accessed with aligned loads, which is only possible
+               when the payload offset within the (page-aligned) mapping permits */
+            bool reference = false;
+            if constexpr (!is_cuda_array_v<Float>) {
+                reference = mmap && m_brick_shift == 0 &&
+                            (uintptr_t) data % alignof(Packet<ScalarFloat>) == 0;
+                if (reference) {
+                    m_data = DynamicBuffer<Float>::map((void *) data, count);
+                    m_mmap = mmap;
+                    Log(Debug, "Referencing the memory-mapped data of \"%s\" (%s)",
+                        m_metadata.filename, util::mem_string(count * sizeof(ScalarFloat)));
+                }
+            }
+
+            if (reference) {
+                // Nothing to do
+            } else if (m_brick_shift == 0) {
+                m_data = DynamicBuffer<Float>::copy(data, count);
+            } else {
+                std::vector<ScalarFloat> bricks =
+                    grid_to_bricks(data, m_metadata.shape, channels, m_brick_shift);
+                m_data = DynamicBuffer<Float>::copy(bricks.data(), bricks.size());
+            }
+        } else {
+            // Bound the values that are actually reconstructed by lookups
+            data = decoded.data();
+            ScalarFloat max = -math::Infinity<ScalarFloat>;
+            for (size_t i = srgb_model ? 3 : 0; i < count; i += srgb_model ? 4 : 1)
+                max = std::max(max, data[i]);
+            m_metadata.max = max;
+        }
+
+        if (srgb_model)
+            m_block_max = grid_block_max(data, m_metadata.shape, 4, 3, 1);
+        else
+            m_block_max = grid_block_max(data, m_metadata.shape, channels, 0, channels);
+    }
+
+    /// Convert the voxel data to the storage type \c T, and also return the decoded values
+    template <typename T, typename Buffer>
+    void encode(Buffer &buffer, const ScalarFloat *data, uint32_t channels,
+                std::vector<ScalarFloat> &decoded) {
+        size_t count = (size_t) hprod(m_metadata.shape) * channels;
+        std::vector<T> values(count);
+        decoded.resize(count);
+
+        if constexpr (std::is_same_v<T, enoki::half>) {
+            for (size_t i = 0; i < count; ++i) {
+                if (std::abs(data[i]) > 65504.f)
+                    Throw("Value %f of the grid volume \"%s\" exceeds the range of "
+                          "the float16 storage type!", data[i], m_metadata.filename);
+                values[i] = T(data[i]);
+                decoded[i] = (ScalarFloat) values[i];
+            }
+        } else {
+            ScalarFloat q_max = (ScalarFloat) std::numeric_limits<T>::max();
+            for (uint32_t c = 0; c < channels; ++c) {
+                ScalarFloat lo = math::Infinity<ScalarFloat>,
+                            hi = -math::Infinity<ScalarFloat>;
+                for (size_t i = c; i < count; i += channels) {
+                    lo = std::min(lo, data[i]);
+                    hi = std::max(hi, data[i]);
+                }
+
+                ScalarFloat scale = (hi - lo) / q_max;
+                m_compact.offset[c] = lo;
+                m_compact.scale[c] = scale;
+                for (size_t i = c; i < count; i += channels) {
+                    ScalarFloat q = scale > 0.f ? std::round((data[i] - lo) / scale) : 0.f;
+                    values[i] = (T) std::min(std::max(q, 0.f), q_max);
+                    decoded[i] = fmadd((ScalarFloat) values[i], scale, lo);
+                }
+            }
+        }
+
+        if (m_brick_shift > 0)
+            values = grid_to_bricks(values.data(), m_metadata.shape, channels, m_brick_shift);
+        buffer = Buffer::copy(values.data(), values.size());
     }
 
     template <uint32_t Channels, bool Raw> using Impl = GridVolumeImpl<Float, Spectrum, Channels, Raw>;
@@ -105,12 +339,12 @@ public:
         ref<Object> result;
         switch (m_metadata.channel_count) {
             case 1:
-                result = m_raw ? (Object *) new Impl<1, true>(m_props, m_metadata, m_data, m_filter_type, m_wrap_mode)
-                               : (Object *) new Impl<1, false>(m_props, m_metadata, m_data, m_filter_type, m_wrap_mode);
+                result = m_raw ? (Object *) new Impl<1, true>(m_props, m_metadata, m_data, m_block_max, m_compact, m_mmap, m_filter_type, m_wrap_mode, m_brick_shift)
+                               : (Object *) new Impl<1, false>(m_props, m_metadata, m_data, m_block_max, m_compact, m_mmap, m_filter_type, m_wrap_mode, m_brick_shift);
                 break;
             case 3:
-                result = m_raw ? (Object *) new Impl<3, true>(m_props, m_metadata, m_data, m_filter_type, m_wrap_mode)
-                               : (Object *) new Impl<3, false>(m_props, m_metadata, m_data, m_filter_type, m_wrap_mode);
+                result = m_raw ? (Object *) new Impl<3, true>(m_props, m_metadata, m_data, m_block_max, m_compact, m_mmap, m_filter_type, m_wrap_mode, m_brick_shift)
+                               : (Object *) new Impl<3, false>(m_props, m_metadata, m_data, m_block_max, m_compact, m_mmap, m_filter_type, m_wrap_mode, m_brick_shift);
                 break;
             default:
                 Throw("Unsupported channel count: %d (expected 1 or 3)", m_metadata.channel_count);
@@ -122,10 +356,15 @@ public:
 protected:
     bool m_raw;
     DynamicBuffer<Float> m_data;
+    CompactGridData<Float> m_compact;
+    /// File mapping referenced by \c m_data (if any)
+    ref<MemoryMappedFile> m_mmap;
+    std::vector<ScalarFloat> m_block_max;
     VolumeMetadata m_metadata;
     Properties m_props;
     FilterType m_filter_type;
     WrapMode m_wrap_mode;
+    int32_t m_brick_shift;
 };
 
 template <typename Float, typename Spectrum, uint32_t Channels, bool Raw>
@@ -136,19 +375,27 @@ public:
 
     GridVolumeImpl(const Properties &props, const VolumeMetadata &meta,
                const DynamicBuffer<Float> &data,
+               const std::vector<ScalarFloat> &block_max,
+               const CompactGridData<Float> &compact,
+               MemoryMappedFile *mmap,
                FilterType filter_type,
-               WrapMode wrap_mode)
+               WrapMode wrap_mode,
+               int32_t brick_shift)
         : Base(props),
-            m_data(data),
+            m_data(map_or_copy(data, mmap)),
+            m_compact(compact),
+            m_mmap(mmap),
+            m_block_max(block_max),
             m_metadata(meta),
             m_inv_resolution_x((int) m_metadata.shape.x()),
             m_inv_resolution_y((int) m_metadata.shape.y()),
             m_inv_resolution_z((int) m_metadata.shape.z()),
-            m_filter_type(filter_type), m_wrap_mode(wrap_mode){
-
-
+            m_filter_type(filter_type), m_wrap_mode(wrap_mode),
+            m_brick_shift(brick_shift) {
 
         m_size     = hprod(m_metadata.shape);
+        m_brick_res = ((m_metadata.shape - 1) >> m_brick_shift) + 1;
+        m_data_size = m_data.size();
         if (props.bool_("use_grid_bbox", false)) {
             m_world_to_local = m_metadata.transform * m_world_to_local;
             update_bbox();
@@ -158,6 +405,18 @@ public:
             m_fixed_max    = true;
             m_metadata.max = props.float_("max_value");
         }
+
+        m_interpolate_coefficients = props.bool_("interpolate_coefficients", false);
+    }
+
+    /// Reference data that resides in the file mapping \c mmap, copy it otherwise
+    static DynamicBuffer<Float> map_or_copy(const DynamicBuffer<Float> &data,
+                                            MemoryMappedFile *mmap) {
+        if constexpr (!is_cuda_array_v<Float>) {
+            if (mmap)
+                return DynamicBuffer<Float>::map((void *) data.data(), data.size());
+        }
+        return data;
     }
 
     UnpolarizedSpectrum eval(const Interaction3f &it, Mask active) const override {
@@ -218,7 +477,7 @@ public:
     }
 
     MTS_INLINE auto eval_impl(const Interaction3f &it, Mask active) const {
-        MTS_MASKED_FUNCTION(ProfilerPhase::TextureEvaluate, active);
+        MTS_MASKED_METHOD(ProfilerPhase::TextureEvaluate, active);
 
         using StorageType = Array<Float, Channels>;
         constexpr bool uses_srgb_model = is_spectral_v<Spectrum> && !Raw && Channels == 3;
@@ -249,6 +508,51 @@ public:
         }
     }
 
+    /// Compute the storage index of the (wrapped) voxel positions \c p
+    template <typename T> MTS_INLINE auto voxel_index(const T &p) const {
+        if (m_brick_shift == 0) {
+            // (z * ny + y) * nx + x
+            return fmadd(fmadd(p.z(), m_metadata.shape.y(), p.y()),
+                         m_metadata.shape.x(), p.x());
+        }
+
+        // Index of the brick, followed by the position within the brick
+        int32_t mask = (1 << m_brick_shift) - 1;
+        T b = p >> m_brick_shift, l = p & mask;
+        auto brick = fmadd(fmadd(b.z(), m_brick_res.y(), b.y()), m_brick_res.x(), b.x());
+        auto local = (((l.z() << m_brick_shift) + l.y()) << m_brick_shift) + l.x();
+        return (brick << (3 * m_brick_shift)) + local;
+    }
+
+    /// Fetch the voxels at \c index, decoding reduced-precision storage
+    template <typename StorageType, typename Index>
+    MTS_INLINE StorageType fetch(const Index &index, const Mask &active) const {
+        if constexpr (!is_cuda_array_v<Float>) {
+            constexpr size_t Size = array_size_v<StorageType>;
+            StorageType scale(head<Size>(m_compact.scale)),
+                        offset(head<Size>(m_compact.offset));
+
+            switch (m_compact.storage) {
+                case GridStorage::Float16:
+                    return StorageType(gather<replace_scalar_t<StorageType, enoki::half>>(
+                        m_compact.data_f16, index, active));
+
+                case GridStorage::UInt16:
+                    return fmadd(StorageType(gather<replace_scalar_t<StorageType, uint16_t>>(
+                        m_compact.data_u16, index, active)), scale, offset);
+
+                case GridStorage::UInt8:
+                    return fmadd(StorageType(gather<replace_scalar_t<StorageType, uint8_t>>(
+                        m_compact.data_u8, index, active)), scale, offset);
+
+                default:
+                    break;
+            }
+        }
+
+        return gather<StorageType>(m_data, index, active);
+    }
+
     /**
      * Taking a 3D point in [0, 1)^3, estimates the grid's value at that
      * point using trilinear interpolation.
@@ -265,9 +569,6 @@ public:
         if constexpr (!is_array_v<Mask>)
             active = true;
 
-        const uint32_t nx = m_metadata.shape.x();
-        const uint32_t ny = m_metadata.shape.y();
-
         if (m_filter_type == FilterType::Trilinear) {
             using Int8  = Array<Int32, 8>;
             using Int38 = Array<Int8, 3>;
@@ -287,18 +588,32 @@ public:
                                       Int8(0, 0, 1, 1, 0, 0, 1, 1) + p_i.y(),
                                       Int8(0, 0, 0, 0, 1, 1, 1, 1) + p_i.z()));
 
-            // (z * ny + y) * nx + x
-            Int8 index = fmadd(fmadd(pi_i_w.z(), ny, pi_i_w.y()), nx, pi_i_w.x());
+            Int8 index = voxel_index(pi_i_w);
 
             // Load 8 grid positions to perform trilinear interpolation
-            auto d000 = gather<StorageType>(m_data, index[0], active),
-                 d100 = gather<StorageType>(m_data, index[1], active),
-                 d010 = gather<StorageType>(m_data, index[2], active),
-                 d110 = gather<StorageType>(m_data, index[3], active),
-                 d001 = gather<StorageType>(m_data, index[4], active),
-                 d101 = gather<StorageType>(m_data, index[5], active),
-                 d011 = gather<StorageType>(m_data, index[6], active),
-                 d111 = gather<StorageType>(m_data, index[7], active);
+            auto d000 = fetch<StorageType>(index[0], active),
+                 d100 = fetch<StorageType>(index[1], active),
+                 d010 = fetch<StorageType>(index[2], active),
+                 d110 = fetch<StorageType>(index[3], active),
+                 d001 = fetch<StorageType>(index[4], active),
+                 d101 = fetch<StorageType>(index[5], active),
+                 d011 = fetch<StorageType>(index[6], active),
+                 d111 = fetch<StorageType>(index[7], active);
+
+            if constexpr (uses_srgb_model) {
+                if (m_interpolate_coefficients) {
+                    // Interpolate coefficients and scale, evaluate the model once
+                    StorageType d00 = fmadd(w0.x(), d000, w1.x() * d100),
+                                d01 = fmadd(w0.x(), d001, w1.x() * d101),
+                                d10 = fmadd(w0.x(), d010, w1.x() * d110),
+                                d11 = fmadd(w0.x(), d011, w1.x() * d111);
+                    StorageType d0  = fmadd(w0.y(), d00, w1.y() * d10),
+                                d1  = fmadd(w0.y(), d01, w1.y() * d11);
+                    StorageType d   = fmadd(w0.z(), d0, w1.z() * d1);
+
+                    return d.w() * srgb_model_eval<UnpolarizedSpectrum>(head<3>(d), wavelengths);
+                }
+            }
 
             ResultType v000, v001, v010, v011, v100, v101, v110, v111;
             Float scale = 1.f;
@@ -347,9 +662,9 @@ public:
             Vector3i p_i   = floor2int<Vector3i>(p),
                     p_i_w = wrap(p_i);
 
-            Int32 index = fmadd(fmadd(p_i_w.z(), ny, p_i_w.y()), nx, p_i_w.x());
+            Int32 index = voxel_index(p_i_w);
 
-            StorageType v = gather<StorageType>(m_data, index, active);
+            StorageType v = fetch<StorageType>(index, active);
 
             if constexpr (uses_srgb_model)
                 return v.w() * srgb_model_eval<UnpolarizedSpectrum>(head<3>(v), wavelengths);
@@ -360,18 +675,59 @@ public:
     }
 
     ScalarFloat max() const override { return m_metadata.max; }
+
+    ScalarFloat local_max(const ScalarBoundingBox3f &bbox) const override {
+        // Block maxima are unavailable after data updates and for user-specified maxima
+        if (m_fixed_max || m_block_max.empty() || m_wrap_mode != WrapMode::Clamp)
+            return max();
+
+        // Voxels that can influence lookups within the region
+        const ScalarVector3i &shape = m_metadata.shape;
+        ScalarVector3i block_res = ((shape - 1) >> BlockShift) + 1,
+                       lo = floor2int<ScalarVector3i>(bbox.min * ScalarVector3f(shape) - .5f),
+                       hi = floor2int<ScalarVector3i>(bbox.max * ScalarVector3f(shape) - .5f) + 1;
+        lo = clamp(lo, 0, shape - 1) >> BlockShift;
+        hi = clamp(hi, 0, shape - 1) >> BlockShift;
+
+        ScalarFloat result = -math::Infinity<ScalarFloat>;
+        for (int32_t z = lo.z(); z <= hi.z(); ++z)
+            for (int32_t y = lo.y(); y <= hi.y(); ++y)
+                for (int32_t x = lo.x(); x <= hi.x(); ++x)
+                    result = std::max(result,
+                        m_block_max[((size_t) z * block_res.y() + y) * block_res.x() + x]);
+        return result;
+    }
     ScalarVector3i resolution() const override { return m_metadata.shape; };
     auto data_size() const { return m_data.size(); }
 
     void traverse(TraversalCallback *callback) override {
-        callback->put_parameter("data", m_data);
+        // Reduced-precision data can't be updated in place
+        if (m_compact.storage == GridStorage::Float32)
+            callback->put_parameter("data", m_data);
         callback->put_parameter("size", m_size);
         Base::traverse(callback);
     }
 
+    void account_memory(MemoryReport *report) const override {
+        // Memory-mapped voxels are included, they occupy the page cache instead
+        report->add_array(MemoryCategory::Volumes, m_data);
+        report->add_array(MemoryCategory::Volumes, m_compact.data_f16);
+        report->add_array(MemoryCategory::Volumes, m_compact.data_u16);
+        report->add_array(MemoryCategory::Volumes, m_compact.data_u8);
+        report->add(MemoryCategory::Volumes, m_block_max.size() * sizeof(ScalarFloat));
+        Base::account_memory(report);
+    }
+
     void parameters_changed(const std::vector<std::string> &/*keys*/) override {
+        if (m_compact.storage != GridStorage::Float32)
+            return;
+
         auto new_size = data_size();
-        if (m_size != new_size) {
+        if (m_brick_shift > 0) {
+            if (new_size != m_data_size)
+                Throw("Unsupported GridVolume data size update: %d -> %d. The data of a "
+                      "bricked grid cannot be resized.", m_data_size, new_size);
+        } else if (m_size != new_size) {
             // Only support a special case: resolution doubling along all axes
             if (new_size != m_size * 8)
                 Throw("Unsupported GridVolume data size update: %d -> %d. Expected %d or %d "
@@ -382,6 +738,9 @@ public:
             m_size = (ScalarUInt32) new_size;
         }
 
+        // Data lives in 'm_data' from now on, only the global maximum is tracked
+        m_block_max.clear();
+
         auto sum = hsum(hsum(detach(m_data)));
         m_metadata.mean = (double) enoki::slice(sum, 0) / (double) (m_size * 3);
         if (!m_fixed_max) {
@@ -405,13 +764,20 @@ public:
     MTS_DECLARE_CLASS()
 protected:
     DynamicBuffer<Float> m_data;
+    CompactGridData<Float> m_compact;
+    ref<MemoryMappedFile> m_mmap;
+    std::vector<ScalarFloat> m_block_max;
     bool m_fixed_max = false;
     VolumeMetadata m_metadata;
     enoki::divisor<int32_t> m_inv_resolution_x, m_inv_resolution_y, m_inv_resolution_z;
 
     ScalarUInt32 m_size;
+    size_t m_data_size;
     FilterType m_filter_type;
     WrapMode m_wrap_mode;
+    int32_t m_brick_shift;
+    ScalarVector3i m_brick_res;
+    bool m_interpolate_coefficients;
 };
 
 MTS_IMPLEMENT_CLASS_VARIANT(GridVolume, Volume)
@@ -16,7 +16,8 @@ Mesh attribute texture (:monosp:`mesh_attribute`)
 
  * - name
    - |string|
-   - Name of the attribute to evaluate. It should always start with ``"vertex_"`` or ``"face_"``.
+   - Name of the attribute to evaluate. It should always start with ``"vertex_"``, ``"face_"``
+     or ``"instance_"``.
  * - scale
    - |float|
    - Scaling factor applied to the interpolated attribute value during evalutation.
@@ -48,6 +49,12 @@ whose reflectance is specified using the ``vertex_color`` attribute of that mesh
         </bsdf>
     </shape>
 
+Attributes whose name starts with ``"instance_"`` are not looked up on the intersected
+shape, but on the instance that contains it. The :ref:`instancer <shape-instancer>` plugin
+provides the per-instance attributes ``instance_color`` and ``instance_id``, so that e.g.
+every instance of a forest of trees can be tinted differently. Surfaces that are not part of
+such an instance evaluate to zero.
+
 .. note::
 
     For spectral variants of the renderer (e.g. ``scalar_spectral``), when a mesh attribute name
@@ -64,8 +71,10 @@ public:
     MeshAttribute(const Properties &props)
     : Texture(props) {
         m_name = props.string("name");
-        if (m_name.find("vertex_") == std::string::npos && m_name.find("face_") == std::string::npos)
-            Throw("Invalid mesh attribute name: must be start with either \"vertex_\" or \"face_\" but was \"%s\".", m_name.c_str());
+        m_instance = m_name.find("instance_") == 0;
+        if (m_name.find("vertex_") == std::string::npos && m_name.find("face_") == std::string::npos &&
+            !m_instance)
+            Throw("Invalid mesh attribute name: must be start with either \"vertex_\", \"face_\" or \"instance_\" but was \"%s\".", m_name.c_str());
 
         m_scale = props.float_("scale", 1.f);
     }
@@ -73,17 +82,35 @@ public:
     const std::string& name() const { return m_name; }
 
     UnpolarizedSpectrum eval(const SurfaceInteraction3f &si, Mask active) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::TextureEvaluate, active);
+        MTS_MASKED_METHOD(ProfilerPhase::TextureEvaluate, active);
+        if (m_instance) {
+            active &= neq(si.instance, nullptr);
+            if (none_or<false>(active))
+                return 0.f;
+            return select(active, si.instance->eval_attribute(m_name, si, active) * m_scale, 0.f);
+        }
         return si.shape->eval_attribute(m_name, si, active) * m_scale;
     }
 
     Float eval_1(const SurfaceInteraction3f &si, Mask active = true) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::TextureEvaluate, active);
+        MTS_MASKED_METHOD(ProfilerPhase::TextureEvaluate, active);
+        if (m_instance) {
+            active &= neq(si.instance, nullptr);
+            if (none_or<false>(active))
+                return 0.f;
+            return select(active, si.instance->eval_attribute_1(m_name, si, active) * m_scale, 0.f);
+        }
         return si.shape->eval_attribute_1(m_name, si, active) * m_scale;
     }
 
     Color3f eval_3(const SurfaceInteraction3f &si, Mask active = true) const override {
-        MTS_MASKED_FUNCTION(ProfilerPhase::TextureEvaluate, active);
+        MTS_MASKED_METHOD(ProfilerPhase::TextureEvaluate, active);
+        if (m_instance) {
+            active &= neq(si.instance, nullptr);
+            if (none_or<false>(active))
+                return 0.f;
+            return select(active, si.instance->eval_attribute_3(m_name, si, active) * m_scale, 0.f);
+        }
         return si.shape->eval_attribute_3(m_name, si, active) * m_scale;
     }
 
@@ -104,6 +131,8 @@ public:
 protected:
     std::string m_name;
     float m_scale;
+    /// Is the attribute looked up on the parent instance?
+    bool m_instance;
 };
 
 MTS_IMPLEMENT_CLASS_VARIANT(MeshAttribute, Texture)
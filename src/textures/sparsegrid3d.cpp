@@ -0,0 +1,266 @@
+#include <mitsuba/core/memreport.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/string.h>
+#include <mitsuba/core/transform.h>
+#include <mitsuba/core/util.h>
+#include <mitsuba/render/texture.h>
+#include <algorithm>
+#include <limits>
+
+#include "volume_data.h"
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+
+.. _texture-sparsegridvolume:
+
+Sparse grid volume (:monosp:`sparsegridvolume`)
+-----------------------------------------------
+
+.. pluginparameters::
+
+ * - filename
+   - |string|
+   - Filename of the volume to be loaded. Both dense (version 3) and sparse
+     (version 4) Mitsuba volume files are supported.
+
+ * - filter_type
+   - |string|
+   - Specifies how voxel values are interpolated: ``trilinear`` (default) or
+     ``nearest``.
+
+ * - brick_size
+   - |int|
+   - Side length of the bricks used when converting a dense volume file. Must
+     be a power of two. Sparse files specify their own brick size. (Default: 8)
+
+ * - threshold
+   - |float|
+   - Bricks of a dense volume file whose values are all less than or equal to
+     this value are discarded. (Default: 0)
+
+ * - use_grid_bbox
+   - |bool|
+   - Map the volume onto the bounding box stored in the file instead of the
+     unit cube. (Default: false)
+
+This plugin stores a single-channel volume (e.g. the density of smoke or
+clouds) as a set of cubic bricks. Bricks that don't contain any non-zero
+voxels are not stored at all, which drastically reduces the memory footprint
+of volumes that are mostly empty. An indirection table maps every brick of the
+grid to its data, or marks it as empty. Lookups clamp to the edge of the grid.
+
+The sparse (version 4) file format shares the header of dense Mitsuba volume
+files up to and including the bounding box. It continues with the brick size
+and the number of stored bricks (both ``int32``). Every brick then consists of
+its integer brick grid coordinates (3x ``int32``) followed by
+``brick_size^3`` ``float32`` values in x-fastest order. Dense files are
+converted one slab of bricks at a time, so that the full dense grid never has
+to be held in memory.
+
+The maximum of every brick is tracked separately. Media can query it through
+``local_max()`` to obtain tighter bounds than the global maximum.
+
+*/
+
+enum class FilterType { Nearest, Trilinear };
+
+template <typename Float, typename Spectrum>
+class SparseGridVolume final : public Volume<Float, Spectrum> {
+public:
+    MTS_IMPORT_BASE(Volume, update_bbox, m_world_to_local)
+    MTS_IMPORT_TYPES()
+
+    SparseGridVolume(const Properties &props) : Base(props) {
+        std::string filter_type = props.string("filter_type", "trilinear");
+        if (filter_type == "nearest")
+            m_filter_type = FilterType::Nearest;
+        else if (filter_type == "trilinear")
+            m_filter_type = FilterType::Trilinear;
+        else
+            Throw("Invalid filter type \"%s\", must be one of: \"nearest\", or "
+                  "\"trilinear\"!", filter_type);
+
+        SparseVolumeData volume = read_sparse_volume_data(
+            props.string("filename"), (uint32_t) props.int_("brick_size", 8),
+            props.float_("threshold", 0.f));
+
+        m_metadata   = volume.meta;
+        m_brick_size = (int32_t) volume.brick_size;
+        m_brick_shift = 0;
+        while ((1 << m_brick_shift) < m_brick_size)
+            ++m_brick_shift;
+        m_brick_res   = (m_metadata.shape + m_brick_size - 1) / m_brick_size;
+        m_brick_count = (ScalarUInt32) (volume.coords.size() / 3);
+
+        // Build the indirection table and the per-brick maxima
+        size_t brick_voxels = (size_t) m_brick_size * m_brick_size * m_brick_size;
+        if (volume.data.size() > (size_t) std::numeric_limits<int32_t>::max())
+            Throw("Sparse volume \"%s\" is too large (%s)", m_metadata.filename,
+                  util::mem_string(volume.data.size() * sizeof(float)));
+
+        std::vector<int32_t> index(hprod(m_brick_res), -1);
+        m_brick_max.resize(index.size(), 0.f);
+        for (size_t i = 0; i < m_brick_count; ++i) {
+            const int32_t *coord = volume.coords.data() + 3 * i;
+            size_t brick = ((size_t) coord[2] * m_brick_res.y() + coord[1]) *
+                           m_brick_res.x() + coord[0];
+            if (index[brick] >= 0)
+                Throw("Sparse volume \"%s\" contains brick (%d, %d, %d) twice!",
+                      m_metadata.filename, coord[0], coord[1], coord[2]);
+            index[brick] = (int32_t) (i * brick_voxels);
+
+            const float *values = volume.data.data() + i * brick_voxels;
+            m_brick_max[brick] = *std::max_element(values, values + brick_voxels);
+        }
+
+        m_brick_index = DynamicBuffer<Int32>::copy(index.data(), index.size());
+        m_data = DynamicBuffer<Float>::copy(volume.data.data(), volume.data.size());
+
+        if (props.bool_("use_grid_bbox", false)) {
+            m_world_to_local = m_metadata.transform * m_world_to_local;
+            update_bbox();
+        }
+    }
+
+    UnpolarizedSpectrum eval(const Interaction3f &it, Mask active) const override {
+        return UnpolarizedSpectrum(eval_impl(it, active));
+    }
+
+    Float eval_1(const Interaction3f &it, Mask active = true) const override {
+        return eval_impl(it, active);
+    }
+
+    Vector3f eval_3(const Interaction3f &it, Mask active = true) const override {
+        ENOKI_MARK_USED(it);
+        ENOKI_MARK_USED(active);
+        Throw("eval_3(): The SparseGridVolume texture %s was queried for a 3D vector, but it "
+              "has only a single channel!", to_string());
+    }
+
+    MTS_INLINE Float eval_impl(const Interaction3f &it, Mask active) const {
+        MTS_MASKED_METHOD(ProfilerPhase::TextureEvaluate, active);
+
+        if constexpr (!is_array_v<Mask>)
+            active = true;
+
+        Point3f p = m_world_to_local * it.p;
+        if (none_or<false>(active))
+            return 0.f;
+
+        if (m_filter_type == FilterType::Trilinear) {
+            // Scale to volume resolution and apply shift
+            p = fmadd(p, m_metadata.shape, -.5f);
+
+            // Integer voxel positions for trilinear interpolation
+            Vector3i p_i = floor2int<Vector3i>(p);
+
+            // Interpolation weights
+            Point3f w1 = p - Point3f(p_i),
+                    w0 = 1.f - w1;
+
+            auto corner = [&](int32_t x, int32_t y, int32_t z) {
+                return fetch(p_i + ScalarVector3i(x, y, z), active);
+            };
+
+            Float d00 = fmadd(w0.x(), corner(0, 0, 0), w1.x() * corner(1, 0, 0)),
+                  d10 = fmadd(w0.x(), corner(0, 1, 0), w1.x() * corner(1, 1, 0)),
+                  d01 = fmadd(w0.x(), corner(0, 0, 1), w1.x() * corner(1, 0, 1)),
+                  d11 = fmadd(w0.x(), corner(0, 1, 1), w1.x() * corner(1, 1, 1));
+            Float d0  = fmadd(w0.y(), d00, w1.y() * d10),
+                  d1  = fmadd(w0.y(), d01, w1.y() * d11);
+
+            return select(active, fmadd(w0.z(), d0, w1.z() * d1), 0.f);
+        } else {
+            // Scale to volume resolution, no shift
+            p *= m_metadata.shape;
+            return select(active, fetch(floor2int<Vector3i>(p), active), 0.f);
+        }
+    }
+
+    /// Look up a voxel (clamped to the grid), voxels of empty bricks are zero
+    MTS_INLINE Float fetch(Vector3i v, Mask active) const {
+        v = clamp(v, 0, m_metadata.shape - 1);
+
+        Vector3i brick = v >> m_brick_shift,
+                 local = v & (m_brick_size - 1);
+
+        Int32 slot = gather<Int32>(
+            m_brick_index,
+            fmadd(fmadd(brick.z(), m_brick_res.y(), brick.y()), m_brick_res.x(), brick.x()),
+            active);
+        active &= slot >= 0;
+
+        Int32 index = slot + (((local.z() << m_brick_shift) + local.y()) << m_brick_shift) +
+                      local.x();
+
+        return gather<Float>(m_data, index, active);
+    }
+
+    ScalarFloat max() const override { return m_metadata.max; }
+
+    ScalarFloat local_max(const ScalarBoundingBox3f &bbox) const override {
+        // Voxels that can influence lookups within the region
+        ScalarVector3f shape(m_metadata.shape);
+        ScalarVector3i lo = floor2int<ScalarVector3i>(bbox.min * shape - .5f),
+                       hi = floor2int<ScalarVector3i>(bbox.max * shape - .5f) + 1;
+        lo = clamp(lo, 0, m_metadata.shape - 1) >> m_brick_shift;
+        hi = clamp(hi, 0, m_metadata.shape - 1) >> m_brick_shift;
+
+        ScalarFloat result = 0.f;
+        for (int32_t z = lo.z(); z <= hi.z(); ++z)
+            for (int32_t y = lo.y(); y <= hi.y(); ++y)
+                for (int32_t x = lo.x(); x <= hi.x(); ++x)
+                    result = std::max(result,
+                        m_brick_max[((size_t) z * m_brick_res.y() + y) * m_brick_res.x() + x]);
+        return result;
+    }
+
+    ScalarVector3i resolution() const override { return m_metadata.shape; };
+
+    void account_memory(MemoryReport *report) const override {
+        report->add_array(MemoryCategory::Volumes, m_data);
+        report->add_array(MemoryCategory::Volumes, m_brick_index);
+        report->add(MemoryCategory::Volumes, m_brick_max.size() * sizeof(ScalarFloat));
+        Base::account_memory(report);
+    }
+
+    std::string to_string() const override {
+        std::ostringstream oss;
+        oss << "SparseGridVolume[" << std::endl
+            << "  world_to_local = " << m_world_to_local << "," << std::endl
+            << "  dimensions = " << m_metadata.shape << "," << std::endl
+            << "  brick_size = " << m_brick_size << "," << std::endl
+            << "  bricks = " << m_brick_count << " of " << hprod(m_brick_res) << "," << std::endl
+            << "  mean = " << m_metadata.mean << "," << std::endl
+            << "  max = " << m_metadata.max << "," << std::endl
+            << "  memory = " << util::mem_string(m_data.size() * sizeof(ScalarFloat) +
+                                                 m_brick_index.size() * sizeof(int32_t))
+            << std::endl
+            << "]";
+        return oss.str();
+    }
+
+    MTS_DECLARE_CLASS()
+protected:
+    /// Brick data, <tt>brick_size^3</tt> values per stored brick
+    DynamicBuffer<Float> m_data;
+
+    /// Offset of every brick of the grid into \c m_data, or -1 if it is empty
+    DynamicBuffer<Int32> m_brick_index;
+
+    /// Maximum value of every brick of the grid
+    std::vector<ScalarFloat> m_brick_max;
+
+    VolumeMetadata m_metadata;
+    ScalarVector3i m_brick_res;
+    int32_t m_brick_size;
+    int32_t m_brick_shift;
+    ScalarUInt32 m_brick_count;
+    FilterType m_filter_type;
+};
+
+MTS_IMPLEMENT_CLASS_VARIANT(SparseGridVolume, Volume)
+MTS_EXPORT_PLUGIN(SparseGridVolume, "Sparse grid volume texture")
+NAMESPACE_END(mitsuba)
@@ -59,4 +59,316 @@ def test02_eval_grad(variant_scalar_rgb):
             fv = bitmap.eval_1(si)
             gradient_finite_difference = Vector2f((fu - f)/delta, (fv - f)/delta)
             gradient_analytic = bitmap.eval_1_grad(si)
-            assert ek.allclose(0, ek.abs(gradient_finite_difference/gradient_analytic - 1.0), atol = 1e04)
\ No newline at end of file
+            assert ek.allclose(0, ek.abs(gradient_finite_difference/gradient_analytic - 1.0), atol = 1e04)
+
+@fresolver_append_path
+def test03_tiled(variant_scalar_rgb, tmpdir):
+    from mitsuba.core import TextureCache
+    from mitsuba.core.xml import load_string
+    from mitsuba.render import SurfaceInteraction3f
+    import numpy as np
+    import enoki as ek
+    import os
+
+    cache_dir = str(tmpdir.join('texture_cache'))
+
+    def load(tiled):
+        return load_string("""
+        <texture type="bitmap" version="2.0.0">
+            <string name="filename" value="resources/data/common/textures/carrot.png"/>
+            <boolean name="tiled" value="%s"/>
+            <string name="cache_dir" value="%s"/>
+        </texture>""" % (tiled, cache_dir)).expand()[0]
+
+    # Use a tiny budget so that tiles are evicted during the lookups below
+    cache = TextureCache.instance()
+    max_memory = cache.max_memory()
+    cache.set_max_memory(64 * 1024)
+
+    try:
+        resident = load('false')
+        tiled = load('true')
+        files = os.listdir(cache_dir)
+        assert len(files) == 1 and files[0].endswith('.mtex')
+        mtime = os.path.getmtime(os.path.join(cache_dir, files[0]))
+
+        # The second texture must reuse the tiled file
+        tiled_2 = load('true')
+        assert os.path.getmtime(os.path.join(cache_dir, files[0])) == mtime
+
+        si = SurfaceInteraction3f()
+        for uv in np.random.rand(100, 2):
+            si.uv = uv
+            assert ek.allclose(resident.eval(si), tiled.eval(si), atol=1e-6)
+            assert ek.allclose(tiled.eval(si), tiled_2.eval(si))
+
+        assert cache.memory_usage() <= 64 * 1024
+
+        # A footprint covering the whole texture selects the coarsest level
+        si.duv_dx = [1, 0]
+        si.duv_dy = [0, 1]
+        si.uv = [0.1, 0.2]
+        value = tiled.eval(si)
+        si.uv = [0.7, 0.4]
+        assert ek.allclose(value, tiled.eval(si))
+    finally:
+        cache.set_max_memory(max_memory)
+
+
+@fresolver_append_path
+@pytest.mark.parametrize('filter_type', ['trilinear', 'anisotropic'])
+def test04_mipmap(variant_scalar_rgb, filter_type):
+    from mitsuba.core.xml import load_string
+    from mitsuba.render import SurfaceInteraction3f
+    import numpy as np
+    import enoki as ek
+
+    def load(filter_type):
+        return load_string("""
+        <texture type="bitmap" version="2.0.0">
+            <string name="filename" value="resources/data/common/textures/noise_8x8.png"/>
+            <string name="filter_type" value="%s"/>
+        </texture>""" % filter_type).expand()[0]
+
+    bilinear, mipmap = load('bilinear'), load(filter_type)
+
+    si = SurfaceInteraction3f()
+    uvs = np.random.rand(20, 2)
+
+    # Lookups without UV partials or with a tiny footprint are bilinear
+    for duv in [0, 1e-5]:
+        si.duv_dx = [duv, 0]
+        si.duv_dy = [0, duv]
+        for uv in uvs:
+            si.uv = uv
+            assert ek.allclose(bilinear.eval(si), mipmap.eval(si), atol=1e-6)
+
+    # A footprint covering the whole texture selects the coarsest level
+    si.duv_dx = [1, 0]
+    si.duv_dy = [0, 1]
+    si.uv = uvs[0]
+    value = mipmap.eval(si)
+    for uv in uvs[1:]:
+        si.uv = uv
+        assert ek.allclose(value, mipmap.eval(si), atol=1e-6)
+
+
+@fresolver_append_path
+def test05_interpolate_coefficients(variant_scalar_spectral):
+    from mitsuba.core.xml import load_string
+    from mitsuba.render import SurfaceInteraction3f
+    import numpy as np
+    import enoki as ek
+
+    def load(interpolate_coefficients):
+        return load_string("""
+        <texture type="bitmap" version="2.0.0">
+            <string name="filename" value="resources/data/common/textures/noise_8x8.png"/>
+            <boolean name="interpolate_coefficients" value="%s"/>
+        </texture>""" % interpolate_coefficients).expand()[0]
+
+    reference, fast = load('false'), load('true')
+
+    si = SurfaceInteraction3f()
+    si.wavelengths = [400, 500, 600, 700]
+
+    # Both approaches agree at texel centers
+    for i in range(8):
+        si.uv = [(i + .5) / 8, (7 - i + .5) / 8]
+        assert ek.allclose(reference.eval(si), fast.eval(si), atol=1e-6)
+
+    # .. and approximately in between
+    for uv in np.random.rand(20, 2):
+        si.uv = uv
+        value = fast.eval(si)
+        assert ek.all((value >= 0) & (value <= 1))
+        assert ek.allclose(reference.eval(si), value, atol=0.1)
+
+
+@fresolver_append_path
+def test06_cache(variants_scalar_all):
+    from mitsuba.core.xml import load_string
+    from mitsuba.python.util import traverse
+    from mitsuba.render import SurfaceInteraction3f
+    import numpy as np
+    import enoki as ek
+
+    def load(cache):
+        return load_string("""
+        <texture type="bitmap" version="2.0.0">
+            <string name="filename" value="resources/data/common/textures/noise_8x8.png"/>
+            <boolean name="cache" value="%s"/>
+        </texture>""" % cache).expand()[0]
+
+    reference, cached = load('false'), load('true')
+
+    si = SurfaceInteraction3f()
+    if 'spectral' in variants_scalar_all:
+        si.wavelengths = [400, 500, 600, 700]
+
+    # Repeated and interleaved lookups must match the uncached texture
+    for uv in np.random.rand(10, 2):
+        for i in range(2):
+            si.uv = uv
+            assert ek.allclose(reference.eval(si), cached.eval(si))
+            si.uv = 1 - uv
+            assert ek.allclose(reference.eval(si), cached.eval(si))
+
+    if 'spectral' in variants_scalar_all:
+        si.wavelengths = [450, 550, 650, 750]
+        assert ek.allclose(reference.eval(si), cached.eval(si))
+
+    # Updating the parameters invalidates previously cached values
+    value = cached.eval(si)
+    for texture in [reference, cached]:
+        params = traverse(texture)
+        params['data'] = ek.zero(type(params['data']), len(params['data']))
+        params.update()
+    assert ek.allclose(reference.eval(si), cached.eval(si))
+    assert not ek.allclose(value, cached.eval(si))
+
+
+@fresolver_append_path
+def test07_native_tiled(variant_scalar_rgb, tmpdir):
+    from mitsuba.core.xml import load_string
+    from mitsuba.render import SurfaceInteraction3f
+    import numpy as np
+    import enoki as ek
+
+    tiled_filename = str(tmpdir.join('carrot.mtex'))
+
+    def load(extra):
+        return load_string("""
+        <texture type="bitmap" version="2.0.0">
+            %s
+        </texture>""" % extra).expand()[0]
+
+    source = '<string name="filename" value="resources/data/common/textures/carrot.png"/>'
+    resident = load(source)
+
+    # Write the tiled representation to an explicit location (as done by mtsimgconvert)
+    load(source + '<string name="tiled_filename" value="%s"/>' % tiled_filename)
+
+    # .. which can then be loaded without the source image
+    native = load('<string name="filename" value="%s"/>' % tiled_filename)
+
+    si = SurfaceInteraction3f()
+    for uv in np.random.rand(100, 2):
+        si.uv = uv
+        assert ek.allclose(resident.eval(si), native.eval(si), atol=1e-6)
+
+    # The layout of the data must match the one expected by the plugin
+    with pytest.raises(Exception) as e:
+        load('<string name="filename" value="%s"/><boolean name="raw" value="true"/>'
+             % tiled_filename)
+    e.match('is not a tiled texture')
+
+
+def test08_udim(variant_scalar_rgb, tmpdir):
+    from mitsuba.core import Bitmap
+    from mitsuba.core.xml import load_string
+    from mitsuba.render import SurfaceInteraction3f
+    import numpy as np
+    import enoki as ek
+    import os
+
+    colors = { 1001 : [0.2, 0.4, 0.6], 1012 : [0.8, 0.1, 0.3] }
+    for number, color in colors.items():
+        data = np.tile(np.array(color, dtype=np.float32), (4, 4, 1))
+        Bitmap(data).write(os.path.join(str(tmpdir), 'wood.%i.exr' % number))
+
+    texture = load_string("""
+        <texture type="bitmap" version="2.0.0">
+            <string name="filename" value="%s"/>
+            <boolean name="raw" value="true"/>
+        </texture>""" % os.path.join(str(tmpdir), 'wood.<UDIM>.exr')).expand()[0]
+
+    si = SurfaceInteraction3f()
+    si.uv = [0.5, 0.25]
+    assert ek.allclose(texture.eval_3(si), colors[1001], atol=1e-5)
+    si.uv = [1.75, 1.5]
+    assert ek.allclose(texture.eval_3(si), colors[1012], atol=1e-5)
+
+    # Squares without an image evaluate to zero
+    si.uv = [2.5, 0.5]
+    assert ek.allclose(texture.eval_3(si), 0)
+
+    # Only the squares that were looked up have been loaded
+    assert 'loaded = 2' in str(texture)
+
+    with pytest.raises(Exception) as e:
+        load_string("""
+            <texture type="bitmap" version="2.0.0">
+                <string name="filename" value="%s"/>
+            </texture>""" % os.path.join(str(tmpdir), 'stone.<UDIM>.exr'))
+    e.match("doesn't contain any images")
+
+
+def test09_shared(variant_scalar_rgb, tmpdir):
+    from mitsuba.core import Bitmap, ResourceCache, ScalarTransform4f
+    from mitsuba.core.xml import load_dict
+    from mitsuba.render import SurfaceInteraction3f
+    import numpy as np
+    import enoki as ek
+
+    filename = str(tmpdir.join('shared.exr'))
+    Bitmap(np.full((4, 4, 3), 0.25, dtype=np.float32)).write(filename)
+
+    def load(**kwargs):
+        props = { 'type' : 'bitmap', 'filename' : filename, 'raw' : True }
+        props.update(kwargs)
+        return load_dict(props).expand()[0]
+
+    cache = ResourceCache.instance()
+    cache.clear()
+
+    # Textures with the same file and options share their data
+    textures = [load(), load(to_uv=ScalarTransform4f.scale(2)), load()]
+    assert cache.size() == 1
+    others = [load(raw=False), load(filter_type='trilinear')]
+    assert cache.size() == 3
+    del others
+    assert cache.size() == 1
+
+    # Modified files are loaded again
+    Bitmap(np.full((8, 8, 3), 0.75, dtype=np.float32)).write(filename)
+    updated = load()
+    assert cache.size() == 2
+
+    si = SurfaceInteraction3f()
+    si.uv = [0.5, 0.5]
+    for texture in textures:
+        assert ek.allclose(texture.eval_3(si), 0.25)
+    assert ek.allclose(updated.eval_3(si), 0.75)
+
+    # Resources are released along with the last texture referencing them
+    del textures, updated
+    assert cache.size() == 0
+
+
+@fresolver_append_path
+@pytest.mark.parametrize('wrap_mode', ['repeat', 'clamp', 'mirror'])
+def test10_precompute_gradient(variant_scalar_rgb, wrap_mode):
+    from mitsuba.render import SurfaceInteraction3f
+    from mitsuba.core.xml import load_dict
+    from mitsuba.core import ScalarTransform4f
+    import numpy as np
+    import enoki as ek
+
+    def load(precompute):
+        return load_dict({
+            'type' : 'bitmap',
+            'filename' : 'resources/data/common/textures/noise_8x8.png',
+            'wrap_mode' : wrap_mode,
+            'precompute_gradient' : precompute,
+            'to_uv' : ScalarTransform4f.rotate([0, 0, 1], 30)
+        }).expand()[0]
+
+    reference, precomputed = load(False), load(True)
+
+    # Also covers lookups beyond the boundary and in mirrored copies of the image
+    si = SurfaceInteraction3f()
+    for uv in np.random.rand(100, 2) * 4 - 2:
+        si.uv = uv
+        assert ek.allclose(precomputed.eval_1_grad(si), reference.eval_1_grad(si),
+                           rtol=1e-5, atol=1e-4)
@@ -125,4 +125,48 @@ def test03_invalid_attribute(variant_scalar_rgb):
 
     with pytest.raises(Exception) as e:
         texture.eval(si)
-    e.match("Invalid attribute requested")
\ No newline at end of file
+    e.match("Invalid attribute requested")
+
+def test04_compact_ply_attributes(variant_scalar_rgb, tmpdir):
+    from mitsuba.core import xml
+
+    """8 bit colors, half precision values and integer IDs are stored
+    compactly and decoded on evaluation"""
+    filename = str(tmpdir.join('compact.ply'))
+    with open(filename, 'w') as f:
+        f.write('\n'.join([
+            'ply', 'format ascii 1.0', 'element vertex 4',
+            'property float x', 'property float y', 'property float z',
+            'property float u', 'property float v',
+            'property uchar red', 'property uchar green', 'property uchar blue',
+            'property half w_x', 'property half w_y', 'property half w_z',
+            'property ushort id_0',
+            'element face 2', 'property list uchar int vertex_indices',
+            'end_header',
+            '0 0 0 0 0 0 0 51 0 0 0.5 7',
+            '1 0 0 1 0 255 0 51 1 0 0.5 7',
+            '0 1 0 0 1 0 255 51 0 1 0.5 7',
+            '1 1 0 1 1 255 255 51 1 1 0.5 7',
+            '3 0 1 2', '3 1 3 2']) + '\n')
+
+    mesh = xml.load_dict({"type" : "ply", "filename" : filename})
+    assert 'vertex_color: 3 uint8s' in str(mesh)
+    assert 'vertex_w: 3 halfs' in str(mesh)
+    assert 'vertex_id: 1 uint32' in str(mesh)
+
+    color, w, id_ = [xml.load_dict({"type" : "mesh_attribute", "name" : name})
+                     for name in ['vertex_color', 'vertex_w', 'vertex_id']]
+
+    for u, v in [(0.0, 0.0), (1.0, 0.0), (0.0, 1.0), (1.0, 1.0), (0.3, 0.4)]:
+        si = mesh.eval_parameterization([u, v])
+        assert ek.allclose(color.eval_3(si), [u, v, 0.2], atol=1e-5)
+        assert ek.allclose(w.eval_3(si), [u, v, 0.5], atol=1e-5)
+        assert ek.allclose(id_.eval_1(si), 7)
+
+    # Exported meshes store the decoded values in single precision
+    filename_out = str(tmpdir.join('compact_out.ply'))
+    mesh.write_ply(filename_out)
+    mesh2 = xml.load_dict({"type" : "ply", "filename" : filename_out})
+    assert 'vertex_color: 3 floats' in str(mesh2)
+    si = mesh2.eval_parameterization([0.3, 0.4])
+    assert ek.allclose(color.eval_3(si), [0.3, 0.4, 0.2], atol=1e-5)
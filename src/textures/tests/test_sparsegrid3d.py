@@ -0,0 +1,162 @@
+import numpy as np
+import pytest
+
+
+def write_volume(filename, values, brick_size=None):
+    """Write a dense (version 3) or sparse (version 4) single-channel volume"""
+    res = values.shape[::-1]
+    with open(filename, 'wb') as f:
+        f.write(b'VOL')
+        f.write(np.uint8(3 if brick_size is None else 4).tobytes())
+        f.write(np.array([1, *res, 1], dtype=np.int32).tobytes())
+        f.write(np.array([0, 0, 0, 1, 1, 1], dtype=np.float32).tobytes())
+        if brick_size is None:
+            f.write(values.astype(np.float32).tobytes())
+            return
+
+        bricks = []
+        for bz in range(0, res[2], brick_size):
+            for by in range(0, res[1], brick_size):
+                for bx in range(0, res[0], brick_size):
+                    brick = np.zeros((brick_size,) * 3, dtype=np.float32)
+                    block = values[bz:bz + brick_size, by:by + brick_size,
+                                   bx:bx + brick_size]
+                    brick[:block.shape[0], :block.shape[1], :block.shape[2]] = block
+                    if np.any(brick > 0):
+                        bricks.append(((bx // brick_size, by // brick_size,
+                                        bz // brick_size), brick))
+        f.write(np.array([brick_size, len(bricks)], dtype=np.int32).tobytes())
+        for coord, brick in bricks:
+            f.write(np.array(coord, dtype=np.int32).tobytes())
+            f.write(brick.tobytes())
+
+
+def load_volume(plugin, filename, extra=''):
+    from mitsuba.core.xml import load_string
+    volume = load_string("""
+        <volume type="%s" version="2.0.0">
+            <string name="filename" value="%s"/>
+            %s
+        </volume>""" % (plugin, filename, extra))
+    expanded = volume.expand()
+    return expanded[0] if len(expanded) > 0 else volume
+
+
+@pytest.mark.parametrize('filter_type', ['trilinear', 'nearest'])
+def test01_eval(variant_scalar_rgb, tmpdir, filter_type):
+    from mitsuba.render import Interaction3f
+
+    # Mostly empty grid with a non-power-of-two resolution
+    values = np.zeros((12, 10, 9), dtype=np.float32)
+    values[1:5, 2:6, 0:3] = np.random.rand(4, 4, 3) + 0.5
+
+    dense_file = str(tmpdir.join('dense.vol'))
+    sparse_file = str(tmpdir.join('sparse.vol'))
+    write_volume(dense_file, values)
+    write_volume(sparse_file, values, brick_size=4)
+
+    extra = '<string name="filter_type" value="%s"/>' % filter_type
+    reference = load_volume('gridvolume', dense_file, extra)
+    for volume in [load_volume('sparsegridvolume', dense_file,
+                               extra + '<integer name="brick_size" value="2"/>'),
+                   load_volume('sparsegridvolume', sparse_file, extra)]:
+        assert np.isclose(volume.max(), values.max())
+        assert volume.resolution() == [9, 10, 12]
+
+        it = Interaction3f()
+        for p in np.random.rand(100, 3):
+            it.p = p
+            assert np.isclose(volume.eval_1(it), reference.eval_1(it), atol=1e-6)
+
+
+def test02_local_max(variant_scalar_rgb, tmpdir):
+    from mitsuba.core import BoundingBox3f
+
+    values = np.zeros((16, 16, 16), dtype=np.float32)
+    values[1, 2, 3] = 2
+    values[12, 12, 12] = 5
+
+    filename = str(tmpdir.join('sparse.vol'))
+    write_volume(filename, values, brick_size=4)
+    volume = load_volume('sparsegridvolume', filename)
+
+    assert volume.max() == 5
+    assert volume.local_max(BoundingBox3f([0, 0, 0], [1, 1, 1])) == 5
+    assert volume.local_max(BoundingBox3f([0, 0, 0], [0.4, 0.4, 0.4])) == 2
+    assert volume.local_max(BoundingBox3f([0.3, 0.3, 0.3], [0.7, 0.7, 0.7])) == 0
+    assert volume.local_max(BoundingBox3f([0.7, 0.7, 0.7], [1, 1, 1])) == 5
+
+
+@pytest.mark.parametrize('filter_type', ['trilinear', 'nearest'])
+@pytest.mark.parametrize('wrap_mode', ['clamp', 'repeat'])
+def test03_bricked_gridvolume(variant_scalar_rgb, tmpdir, filter_type, wrap_mode):
+    from mitsuba.render import Interaction3f
+
+    # Non-power-of-two resolution, so that the boundary bricks are partial
+    values = np.random.RandomState(0).rand(7, 10, 9).astype(np.float32)
+    filename = str(tmpdir.join('dense.vol'))
+    write_volume(filename, values)
+
+    extra = '<string name="filter_type" value="%s"/>' % filter_type + \
+        '<string name="wrap_mode" value="%s"/>' % wrap_mode
+    reference = load_volume('gridvolume', filename, extra)
+    for brick_size in [2, 4, 8]:
+        volume = load_volume('gridvolume', filename, extra +
+                             '<integer name="brick_size" value="%i"/>' % brick_size)
+
+        it = Interaction3f()
+        for p in np.random.RandomState(1).uniform(-0.5, 1.5, (100, 3)):
+            it.p = p
+            assert np.isclose(volume.eval_1(it), reference.eval_1(it), atol=1e-6)
+
+    with pytest.raises(RuntimeError):
+        load_volume('gridvolume', filename, '<integer name="brick_size" value="3"/>')
+
+
+@pytest.mark.parametrize('storage,atol', [('float16', 1e-3), ('uint16', 1e-4), ('uint8', 1e-2)])
+def test04_compact_gridvolume(variant_scalar_rgb, tmpdir, storage, atol):
+    from mitsuba.core import BoundingBox3f
+    from mitsuba.render import Interaction3f
+
+    values = np.random.RandomState(0).rand(7, 10, 9).astype(np.float32) + 1
+    filename = str(tmpdir.join('dense.vol'))
+    write_volume(filename, values)
+
+    reference = load_volume('gridvolume', filename)
+    for extra in ['', '<integer name="brick_size" value="4"/>']:
+        volume = load_volume('gridvolume', filename, extra +
+                             '<string name="storage" value="%s"/>' % storage)
+        full = BoundingBox3f([0, 0, 0], [1, 1, 1])
+        assert volume.max() >= values.max() - atol
+        assert volume.local_max(full) == volume.max()
+
+        it = Interaction3f()
+        for p in np.random.RandomState(1).rand(100, 3):
+            it.p = p
+            assert np.isclose(volume.eval_1(it), reference.eval_1(it), atol=atol)
+
+    with pytest.raises(RuntimeError):
+        load_volume('gridvolume', filename, '<string name="storage" value="int4"/>')
+
+
+def test05_mapped_gridvolume(variant_scalar_rgb, tmpdir):
+    from mitsuba.render import Interaction3f
+
+    values = np.random.RandomState(0).rand(7, 10, 9).astype(np.float32)
+    filename = str(tmpdir.join('dense.vol'))
+    write_volume(filename, values)
+
+    # The (memory-mapped) file contents are used as is
+    volume = load_volume('gridvolume', filename, '<string name="filter_type" value="nearest"/>')
+    assert np.isclose(volume.max(), values.max())
+    it = Interaction3f()
+    it.p = [0.5 / 9, 1.5 / 10, 2.5 / 7]
+    assert np.isclose(volume.eval_1(it), values[2, 1, 0])
+
+    # Truncated payloads are detected
+    with open(filename, 'rb') as f:
+        data = f.read()
+    with open(filename, 'wb') as f:
+        f.write(data[:-4])
+    with pytest.raises(RuntimeError):
+        load_volume('gridvolume', filename)
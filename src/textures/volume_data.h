@@ -1,11 +1,14 @@
 #pragma once
 
+#include <cstring>
 #include <fstream>
 #include <sstream>
+#include <vector>
 
 /// @file Helper functions for volume data handling.
 #include <mitsuba/core/fresolver.h>
 #include <mitsuba/core/math.h>
+#include <mitsuba/core/mmap.h>
 #include <mitsuba/core/thread.h>
 #include <mitsuba/core/transform.h>
 #include <mitsuba/render/volume_texture.h>
@@ -34,28 +37,165 @@ auto bbox_transform(const BoundingBox<Point<Float, 3>> &bbox) {
 
 NAMESPACE_END(detail)
 
+/// Header and memory-mapped payload of a dense volume, see \ref map_binary_volume_data()
+struct MappedVolumeData {
+    VolumeMetadata meta;
+
+    /// Copy-on-write mapping of the volume file
+    ref<MemoryMappedFile> mmap;
+
+    /// Voxel values (\c float32, x-fastest, interleaved channels) within \c mmap
+    const float *data;
+};
+
+/**
+ * Maps a dense Mitsuba binary volume file (version 3) into memory.
+ *
+ * The file consists of the characters 'VOL', the version (\c uint8), the data
+ * type (\c int32, only 1 = \c float32 is supported), the resolution (3x
+ * \c int32), the channel count (\c int32) and the bounding box (6x \c float32),
+ * followed by the voxel values in x-fastest order with interleaved channels.
+ *
+ * Instead of reading the payload into a separate buffer, the file is mapped
+ * with copy-on-write semantics. This avoids a transient copy of the whole grid,
+ * and the pages are shared with other processes that load the same file.
+ */
+inline MappedVolumeData map_binary_volume_data(const std::string &filename) {
+    using Float = float;
+    MTS_IMPORT_CORE_TYPES()
+
+    MappedVolumeData result;
+    VolumeMetadata &meta = result.meta;
+    auto fs       = Thread::thread()->file_resolver();
+    meta.filename = fs->resolve(filename).string();
+    result.mmap = MemoryMappedFile::map_copy_on_write(meta.filename);
+
+    const uint8_t *ptr = (const uint8_t *) result.mmap->data();
+    size_t offset = 0, file_size = result.mmap->size();
+    auto read = [&](auto &value) {
+        if (offset + sizeof(value) > file_size)
+            Throw("Unexpected end of volume file %s", filename);
+        memcpy(&value, ptr + offset, sizeof(value));
+        offset += sizeof(value);
+    };
+
+    char header[3] = { 0, 0, 0 };
+    read(header);
+    if (header[0] != 'V' || header[1] != 'O' || header[2] != 'L')
+        Throw("Invalid volume file %s", filename);
+    read(meta.version);
+    if (meta.version != 3)
+        Throw("Invalid version, currently only version 3 is supported (found %d)", meta.version);
+
+    read(meta.data_type);
+    if (meta.data_type != 1)
+        Throw("Wrong type, currently only type == 1 (Float32) data is supported (found type = %d)",
+              meta.data_type);
+
+    int32_t res[3], channel_count;
+    read(res);
+    meta.shape = ScalarVector3i(res[0], res[1], res[2]);
+    size_t size = hprod(meta.shape);
+    if (size < 8)
+        Throw("Invalid grid dimensions: %d x %d x %d < 8 (must have at "
+              "least one value at each corner)",
+              meta.shape.x(), meta.shape.y(), meta.shape.z());
+
+    read(channel_count);
+    meta.channel_count = (size_t) channel_count;
+
+    // Transform specified in the volume file
+    float dims[6];
+    read(dims);
+    meta.bbox      = ScalarBoundingBox3f(ScalarPoint3f(dims[0], dims[1], dims[2]),
+                                    ScalarPoint3f(dims[3], dims[4], dims[5]));
+    meta.transform = detail::bbox_transform(meta.bbox);
+    meta.mean      = 0.;
+    meta.max       = -math::Infinity<ScalarFloat>;
+
+    size_t count = size * meta.channel_count;
+    if (offset + count * sizeof(float) > file_size)
+        Throw("Unexpected end of volume file %s", filename);
+    result.data = (const float *) (ptr + offset);
+
+    for (size_t i = 0; i < count; ++i) {
+        float value = result.data[i];
+        meta.mean += (double) value;
+        meta.max = std::max(meta.max, value);
+    }
+    meta.mean /= double(count);
+
+    Log(Debug, "Mapped grid volume data from file %s: dimensions %s, mean value %f, max value %f",
+        filename, meta.shape, meta.mean, meta.max);
+
+    return result;
+}
+
 /**
- * Reads a Mitsuba binary volume file.
+ * Reads a Mitsuba binary volume file (see \ref map_binary_volume_data())
+ * into a newly allocated buffer.
  */
-// TODO: document data format.
-// TODO: what if Float is a GPU array, should we upload to it directly?
 template <typename Float>
 std::pair<VolumeMetadata, std::unique_ptr<scalar_t<Float>[]>>
 read_binary_volume_data(const std::string &filename) {
     MTS_IMPORT_CORE_TYPES()
 
+    MappedVolumeData volume = map_binary_volume_data(filename);
+    size_t count = hprod(volume.meta.shape) * volume.meta.channel_count;
+    auto raw_data = std::unique_ptr<ScalarFloat[]>(new ScalarFloat[count]);
+    for (size_t i = 0; i < count; ++i)
+        raw_data[i] = (ScalarFloat) volume.data[i];
+
+    return { volume.meta, std::move(raw_data) };
+}
+
+/// Bricks of a sparse volume, see \ref read_sparse_volume_data()
+struct SparseVolumeData {
     VolumeMetadata meta;
+
+    /// Side length of a brick in voxels (a power of two)
+    uint32_t brick_size;
+
+    /// Brick grid coordinates (x, y, z) of every stored brick
+    std::vector<int32_t> coords;
+
+    /// Voxel values, <tt>brick_size^3</tt> per brick in x-fastest order
+    std::vector<float> data;
+};
+
+/**
+ * Reads a Mitsuba binary volume file into a sparse set of bricks.
+ *
+ * Besides dense files (version 3), this function supports a sparse variant
+ * (version 4) that shares the header of dense files up to and including the
+ * bounding box. It is followed by the brick size and the number of stored
+ * bricks (both \c int32). Every brick then consists of its brick grid
+ * coordinates (3x \c int32) and <tt>brick_size^3</tt> \c float32 values in
+ * x-fastest order. Voxels that are not covered by any brick are zero.
+ *
+ * Dense files are converted slab by slab, dropping bricks whose values are
+ * all less than or equal to \c threshold.
+ */
+inline SparseVolumeData read_sparse_volume_data(const std::string &filename,
+                                                uint32_t brick_size,
+                                                float threshold) {
+    using Float = float;
+    MTS_IMPORT_CORE_TYPES()
+
+    SparseVolumeData result;
+    VolumeMetadata &meta = result.meta;
     auto fs       = Thread::thread()->file_resolver();
     meta.filename = fs->resolve(filename).string();
     std::ifstream f(meta.filename, std::ios::binary);
 
     char header[3];
     f.read(header, sizeof(char) * 3);
-    if (header[0] != 'V' || header[1] != 'O' || header[2] != 'L')
+    if (!f || header[0] != 'V' || header[1] != 'O' || header[2] != 'L')
         Throw("Invalid volume file %s", filename);
     meta.version = detail::read<uint8_t>(f);
-    if (meta.version != 3)
-        Throw("Invalid version, currently only version 3 is supported (found %d)", meta.version);
+    if (meta.version != 3 && meta.version != 4)
+        Throw("Invalid version, currently only versions 3 (dense) and 4 (sparse) are "
+              "supported (found %d)", meta.version);
 
     meta.data_type = detail::read<int32_t>(f);
     if (meta.data_type != 1)
@@ -72,33 +212,99 @@ read_binary_volume_data(const std::string &filename) {
               meta.shape.x(), meta.shape.y(), meta.shape.z());
 
     meta.channel_count = detail::read<int32_t>(f);
+    if (meta.channel_count != 1)
+        Throw("Sparse volumes must have a single channel (found %d)", meta.channel_count);
 
-    // Transform specified in the volume file
     float dims[6];
     f.read(reinterpret_cast<char *>(dims), sizeof(float) * 6);
     meta.bbox      = ScalarBoundingBox3f(ScalarPoint3f(dims[0], dims[1], dims[2]),
-                                    ScalarPoint3f(dims[3], dims[4], dims[5]));
+                                         ScalarPoint3f(dims[3], dims[4], dims[5]));
     meta.transform = detail::bbox_transform(meta.bbox);
     meta.mean      = 0.;
-    meta.max       = -math::Infinity<ScalarFloat>;
+    meta.max       = 0.f;
+
+    if (meta.version == 4)
+        brick_size = (uint32_t) detail::read<int32_t>(f);
+    if (brick_size < 2 || brick_size > 64 || (brick_size & (brick_size - 1)) != 0)
+        Throw("Invalid brick size %d, must be a power of two between 2 and 64", brick_size);
+    result.brick_size = brick_size;
 
-    auto raw_data = std::unique_ptr<ScalarFloat[]>(new ScalarFloat[size * meta.channel_count]);
-    size_t k      = 0;
-    for (size_t i = 0; i < size; ++i) {
-        for (size_t j = 0; j < meta.channel_count; ++j) {
-            auto val    = detail::read<float>(f);
-            raw_data[k] = val;
-            meta.mean += (double) val;
-            meta.max = std::max(meta.max, val);
-            ++k;
+    size_t brick_voxels = (size_t) brick_size * brick_size * brick_size;
+    ScalarVector3i brick_res = (meta.shape + (int32_t) brick_size - 1) / (int32_t) brick_size;
+
+    auto add_brick = [&](const ScalarVector3i &coord, const float *values) {
+        for (size_t i = 0; i < brick_voxels; ++i) {
+            meta.mean += (double) values[i];
+            meta.max = std::max(meta.max, values[i]);
+        }
+        result.coords.insert(result.coords.end(), { coord.x(), coord.y(), coord.z() });
+        result.data.insert(result.data.end(), values, values + brick_voxels);
+    };
+
+    std::vector<float> brick(brick_voxels);
+    if (meta.version == 4) {
+        int32_t brick_count = detail::read<int32_t>(f);
+        for (int32_t i = 0; i < brick_count; ++i) {
+            ScalarVector3i coord;
+            for (size_t j = 0; j < 3; ++j)
+                coord[j] = detail::read<int32_t>(f);
+            if (any((coord < 0) | (coord >= brick_res)))
+                Throw("Invalid brick coordinates %s in volume file %s", coord, filename);
+            f.read(reinterpret_cast<char *>(brick.data()), sizeof(float) * brick_voxels);
+            if (!f)
+                Throw("Unexpected end of volume file %s", filename);
+
+            // Voxels beyond the grid resolution don't contribute
+            for (uint32_t z = 0; z < brick_size; ++z)
+                for (uint32_t y = 0; y < brick_size; ++y)
+                    for (uint32_t x = 0; x < brick_size; ++x)
+                        if (any(coord * (int32_t) brick_size +
+                                ScalarVector3i((int32_t) x, (int32_t) y, (int32_t) z) >= meta.shape))
+                            brick[(z * brick_size + y) * brick_size + x] = 0.f;
+
+            add_brick(coord, brick.data());
+        }
+    } else {
+        // Convert a dense grid, reading one slab of bricks at a time
+        size_t slice_size = (size_t) meta.shape.x() * meta.shape.y();
+        std::vector<float> slab(slice_size * brick_size);
+        for (int32_t bz = 0; bz < brick_res.z(); ++bz) {
+            int32_t depth = std::min((int32_t) brick_size,
+                                     meta.shape.z() - bz * (int32_t) brick_size);
+            f.read(reinterpret_cast<char *>(slab.data()), sizeof(float) * slice_size * depth);
+            if (!f)
+                Throw("Unexpected end of volume file %s", filename);
+
+            for (int32_t by = 0; by < brick_res.y(); ++by) {
+                for (int32_t bx = 0; bx < brick_res.x(); ++bx) {
+                    bool empty = true;
+                    for (uint32_t z = 0; z < brick_size; ++z) {
+                        for (uint32_t y = 0; y < brick_size; ++y) {
+                            for (uint32_t x = 0; x < brick_size; ++x) {
+                                int32_t gx = bx * (int32_t) brick_size + (int32_t) x,
+                                        gy = by * (int32_t) brick_size + (int32_t) y;
+                                float value = 0.f;
+                                if ((int32_t) z < depth && gx < meta.shape.x() &&
+                                    gy < meta.shape.y())
+                                    value = slab[((size_t) z * meta.shape.y() + gy) * meta.shape.x() + gx];
+                                brick[(z * brick_size + y) * brick_size + x] = value;
+                                empty &= value <= threshold;
+                            }
+                        }
+                    }
+                    if (!empty)
+                        add_brick(ScalarVector3i(bx, by, bz), brick.data());
+                }
+            }
         }
     }
-    meta.mean /= double(size * meta.channel_count);
+    meta.mean /= double(size);
 
-    Log(Debug, "Loaded grid volume data from file %s: dimensions %s, mean value %f, max value %f",
-        filename, meta.shape, meta.mean, meta.max);
+    Log(Debug, "Loaded sparse volume data from file %s: dimensions %s, %d of %d bricks "
+        "of size %d^3, mean value %f, max value %f", filename, meta.shape,
+        result.coords.size() / 3, hprod(brick_res), brick_size, meta.mean, meta.max);
 
-    return { meta, std::move(raw_data) };
+    return result;
 }
 
 NAMESPACE_END(mitsuba)